@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Assertions.h>
+#include <AK/Noncopyable.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Types.h>
+#include <AK/kmalloc.h>
+
+namespace AK {
+
+// Hands out memory for lots of small objects by bumping a pointer through large chunks, instead of
+// going to the heap for every single one of them. Objects can still be destroyed one by one, e.g.
+// when the last reference to a RefCounted object goes away, but their memory only goes back to the
+// heap in bulk: a chunk is freed once the arena is gone and none of its objects are alive anymore.
+// An arena, and the objects allocated in it, must only be used from one thread at a time.
+class Arena {
+    AK_MAKE_NONCOPYABLE(Arena);
+    AK_MAKE_NONMOVABLE(Arena);
+
+public:
+    static constexpr size_t default_chunk_size = 16 * KiB;
+    static constexpr size_t default_alignment = 2 * sizeof(void*);
+
+    explicit Arena(size_t chunk_size = default_chunk_size)
+        : m_chunk_size(chunk_size)
+    {
+    }
+
+    ~Arena() { clear(); }
+
+    // Memory from here is never given back on its own, it all goes away together with the arena.
+    // Returns nullptr if we run out of memory.
+    void* allocate(size_t size, size_t alignment = default_alignment)
+    {
+        return allocate_impl(size, alignment, false);
+    }
+
+    // Memory for an object that may outlive the arena, and must be given back with deallocate().
+    // Returns nullptr if we run out of memory.
+    void* allocate_object(size_t size, size_t alignment = default_alignment)
+    {
+        return allocate_impl(size, alignment, true);
+    }
+
+    // Gives memory from allocate_object() back, or from the heap if it was allocated by allocate_outside_of_arena().
+    static void deallocate(void* ptr)
+    {
+        if (!ptr)
+            return;
+        auto* chunk = chunk_of(ptr);
+        if (!chunk) {
+            kfree(static_cast<u8*>(ptr) - default_alignment);
+            return;
+        }
+        VERIFY(chunk->live_objects);
+        if (--chunk->live_objects == 0 && !chunk->arena)
+            kfree(chunk);
+    }
+
+    // For objects of types that live in arenas, which sometimes get created on their own.
+    static void* allocate_outside_of_arena(size_t size)
+    {
+        auto* memory = static_cast<u8*>(kmalloc(default_alignment + size));
+        if (!memory)
+            return nullptr;
+        auto* ptr = memory + default_alignment;
+        chunk_of(ptr) = nullptr;
+        return ptr;
+    }
+
+    // Forgets about all chunks. Those without live objects are freed right away, the others once their last object goes away.
+    void clear()
+    {
+        for (auto* chunk = m_current_chunk; chunk;) {
+            auto* next = chunk->next;
+            chunk->arena = nullptr;
+            if (!chunk->live_objects)
+                kfree(chunk);
+            chunk = next;
+        }
+        m_current_chunk = nullptr;
+        m_bytes_allocated = 0;
+        m_bytes_reserved = 0;
+    }
+
+    size_t bytes_allocated() const { return m_bytes_allocated; }
+    size_t bytes_reserved() const { return m_bytes_reserved; }
+
+private:
+    struct Chunk;
+
+    void* allocate_impl(size_t size, size_t alignment, bool is_object)
+    {
+        VERIFY(alignment && (alignment & (alignment - 1)) == 0);
+        alignment = max(alignment, alignof(Chunk*));
+
+        if (!m_current_chunk || !m_current_chunk->can_fit(size, alignment)) {
+            size_t chunk_size = max(m_chunk_size, sizeof(Chunk) + sizeof(Chunk*) + alignment + size);
+            auto* memory = kmalloc(chunk_size);
+            if (!memory)
+                return nullptr;
+            m_current_chunk = new (memory) Chunk(*this, chunk_size, m_current_chunk);
+            m_bytes_reserved += chunk_size;
+        }
+
+        auto* ptr = m_current_chunk->allocate(size, alignment);
+        if (is_object)
+            ++m_current_chunk->live_objects;
+        m_bytes_allocated += size;
+        return ptr;
+    }
+
+    struct Chunk {
+        Chunk(Arena& arena, size_t size, Chunk* next)
+            : arena(&arena)
+            , next(next)
+            , size(size)
+            , used(sizeof(Chunk))
+        {
+        }
+
+        // Every allocation is preceded by a pointer back to its chunk.
+        FlatPtr start_of_allocation(size_t alignment) const
+        {
+            return round_up_to_power_of_two((FlatPtr)this + used + sizeof(Chunk*), alignment);
+        }
+
+        bool can_fit(size_t size, size_t alignment) const
+        {
+            return start_of_allocation(alignment) + size <= (FlatPtr)this + this->size;
+        }
+
+        void* allocate(size_t size, size_t alignment)
+        {
+            auto start = start_of_allocation(alignment);
+            used = start + size - (FlatPtr)this;
+            auto* ptr = (void*)start;
+            chunk_of(ptr) = this;
+            return ptr;
+        }
+
+        Arena* arena { nullptr };
+        Chunk* next { nullptr };
+        size_t size { 0 };
+        size_t used { 0 };
+        size_t live_objects { 0 };
+    };
+
+    static Chunk*& chunk_of(void* ptr) { return *(static_cast<Chunk**>(ptr) - 1); }
+
+    size_t m_chunk_size { default_chunk_size };
+    Chunk* m_current_chunk { nullptr };
+    size_t m_bytes_allocated { 0 };
+    size_t m_bytes_reserved { 0 };
+};
+
+}
+
+// Lets a class be created with `new (arena) T(...)`, which returns nullptr if the arena runs out of memory.
+// Plain `new T(...)` keeps working and allocates from the heap, and `delete` does the right thing for both.
+#define AK_MAKE_ARENA_ALLOCATED                                                                               \
+public:                                                                                                       \
+    static void* operator new(size_t size, AK::Arena& arena) noexcept { return arena.allocate_object(size); } \
+    static void* operator new(size_t size) { return AK::Arena::allocate_outside_of_arena(size); }             \
+    static void* operator new(size_t size, const std::nothrow_t&) noexcept                                    \
+    {                                                                                                         \
+        return AK::Arena::allocate_outside_of_arena(size);                                                    \
+    }                                                                                                         \
+    static void operator delete(void* ptr) noexcept { AK::Arena::deallocate(ptr); }                           \
+    static void operator delete(void* ptr, AK::Arena&) noexcept { AK::Arena::deallocate(ptr); }               \
+    static void operator delete(void* ptr, const std::nothrow_t&) noexcept { AK::Arena::deallocate(ptr); }    \
+                                                                                                              \
+private:
+
+using AK::Arena;
@@ -190,10 +190,13 @@ public:
             }
 
             if (m_next_byte.has_value()) {
-                m_next_byte.value() |= ((bits >> n_written) & 1) << m_bit_offset;
-                ++n_written;
+                // Fill up as much of the partial byte as we can at once
+                auto n_bits = min(count - n_written, 8 - m_bit_offset);
+                m_next_byte.value() |= ((bits >> n_written) & ((1u << n_bits) - 1)) << m_bit_offset;
+                n_written += n_bits;
+                m_bit_offset += n_bits;
 
-                if (m_bit_offset++ == 7) {
+                if (m_bit_offset == 8) {
                     m_stream << m_next_byte.value();
                     m_next_byte.clear();
                 }
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteSearch.h>
+#include <AK/Platform.h>
+
+#if !defined(KERNEL) && (ARCH(I386) || ARCH(X86_64))
+#    define AK_HAVE_SSE2_SEARCH
+#    include <AK/SIMD.h>
+#    include <cpuid.h>
+#endif
+
+namespace AK {
+
+static constexpr u64 word_lsbs = 0x0101010101010101ull;
+static constexpr u64 word_msbs = 0x8080808080808080ull;
+
+static ALWAYS_INLINE u64 load_word(u8 const* data)
+{
+    u64 word;
+    __builtin_memcpy(&word, data, sizeof(word));
+    return word;
+}
+
+// Bit 7 of the lowest byte that's zero is set, and maybe some above it, which doesn't matter as we only look at the lowest.
+static ALWAYS_INLINE u64 zero_bytes_in_word(u64 word)
+{
+    return (word - word_lsbs) & ~word & word_msbs;
+}
+
+static Optional<size_t> find_byte_scalar(ReadonlyBytes haystack, size_t start, u8 needle)
+{
+    size_t i = start;
+    for (; i + sizeof(u64) <= haystack.size(); i += sizeof(u64)) {
+        if (auto matches = zero_bytes_in_word(load_word(haystack.data() + i) ^ (word_lsbs * needle)))
+            return i + __builtin_ctzll(matches) / 8;
+    }
+    for (; i < haystack.size(); ++i) {
+        if (haystack[i] == needle)
+            return i;
+    }
+    return {};
+}
+
+static size_t count_leading_ascii_bytes_scalar(ReadonlyBytes bytes, size_t start)
+{
+    size_t i = start;
+    for (; i + sizeof(u64) <= bytes.size(); i += sizeof(u64)) {
+        if (auto non_ascii = load_word(bytes.data() + i) & word_msbs)
+            return i + __builtin_ctzll(non_ascii) / 8;
+    }
+    while (i < bytes.size() && bytes[i] < 0x80)
+        ++i;
+    return i;
+}
+
+#ifdef AK_HAVE_SSE2_SEARCH
+
+static bool has_sse2()
+{
+#    if ARCH(X86_64)
+    return true;
+#    else
+    static int s_has_sse2 = -1;
+    if (s_has_sse2 < 0) {
+        unsigned eax, ebx, ecx, edx;
+        s_has_sse2 = __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (edx & bit_SSE2);
+    }
+    return s_has_sse2;
+#    endif
+}
+
+static constexpr size_t vector_size = sizeof(SIMD::c8x16);
+
+[[gnu::target("sse2")]] static ALWAYS_INLINE SIMD::c8x16 load_vector(u8 const* data)
+{
+    SIMD::c8x16 vector;
+    __builtin_memcpy(&vector, data, sizeof(vector));
+    return vector;
+}
+
+[[gnu::target("sse2")]] static ALWAYS_INLINE u32 equal_bytes(SIMD::c8x16 a, SIMD::c8x16 b)
+{
+    return __builtin_ia32_pmovmskb128((SIMD::c8x16)(a == b));
+}
+
+[[gnu::target("sse2")]] static Optional<size_t> find_byte_sse2(ReadonlyBytes haystack, u8 needle)
+{
+    auto needles = SIMD::c8x16 {} + (char)needle;
+    size_t i = 0;
+    for (; i + vector_size <= haystack.size(); i += vector_size) {
+        if (auto matches = equal_bytes(load_vector(haystack.data() + i), needles))
+            return i + __builtin_ctz(matches);
+    }
+    return find_byte_scalar(haystack, i, needle);
+}
+
+[[gnu::target("sse2")]] static size_t count_leading_ascii_bytes_sse2(ReadonlyBytes bytes)
+{
+    size_t i = 0;
+    for (; i + vector_size <= bytes.size(); i += vector_size) {
+        if (auto non_ascii = (u32)__builtin_ia32_pmovmskb128(load_vector(bytes.data() + i)))
+            return i + __builtin_ctz(non_ascii);
+    }
+    return count_leading_ascii_bytes_scalar(bytes, i);
+}
+
+// Compares the first and the last byte of the needle against 16 positions at once, and only looks
+// at the rest of the needle where both of them match. See http://0x80.pl/articles/simd-strfind.html
+[[gnu::target("sse2")]] static Optional<size_t> memmem_sse2(ReadonlyBytes haystack, ReadonlyBytes needle)
+{
+    auto firsts = SIMD::c8x16 {} + (char)needle[0];
+    auto lasts = SIMD::c8x16 {} + (char)needle[needle.size() - 1];
+    auto last_offset = needle.size() - 1;
+    auto possible_starts = haystack.size() - needle.size() + 1;
+
+    size_t i = 0;
+    for (; i + vector_size <= possible_starts; i += vector_size) {
+        auto candidates = equal_bytes(load_vector(haystack.data() + i), firsts) & equal_bytes(load_vector(haystack.data() + i + last_offset), lasts);
+        for (; candidates; candidates &= candidates - 1) {
+            auto start = i + __builtin_ctz(candidates);
+            if (!__builtin_memcmp(haystack.data() + start + 1, needle.data() + 1, needle.size() - 2))
+                return start;
+        }
+    }
+    for (; i < possible_starts; ++i) {
+        if (!__builtin_memcmp(haystack.data() + i, needle.data(), needle.size()))
+            return i;
+    }
+    return {};
+}
+
+#endif
+
+Optional<size_t> find_byte(ReadonlyBytes haystack, u8 needle)
+{
+#ifdef AK_HAVE_SSE2_SEARCH
+    if (has_sse2())
+        return find_byte_sse2(haystack, needle);
+#endif
+    return find_byte_scalar(haystack, 0, needle);
+}
+
+size_t count_leading_ascii_bytes(ReadonlyBytes bytes)
+{
+#ifdef AK_HAVE_SSE2_SEARCH
+    if (has_sse2())
+        return count_leading_ascii_bytes_sse2(bytes);
+#endif
+    return count_leading_ascii_bytes_scalar(bytes, 0);
+}
+
+namespace Detail {
+
+bool vectorized_memmem([[maybe_unused]] ReadonlyBytes haystack, [[maybe_unused]] ReadonlyBytes needle, [[maybe_unused]] Optional<size_t>& result)
+{
+#ifdef AK_HAVE_SSE2_SEARCH
+    VERIFY(needle.size() >= 2 && needle.size() <= haystack.size());
+    if (has_sse2()) {
+        result = memmem_sse2(haystack, needle);
+        return true;
+    }
+#endif
+    return false;
+}
+
+}
+
+}
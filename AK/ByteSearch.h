@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Optional.h>
+#include <AK/Span.h>
+#include <AK/Types.h>
+
+namespace AK {
+
+// These look at 16 bytes at a time with SSE2 where the CPU has it, and at a machine word at a time
+// everywhere else, including the kernel, which doesn't get to use the vector registers.
+
+Optional<size_t> find_byte(ReadonlyBytes haystack, u8 needle);
+
+// How many of the bytes at the start are ASCII, i.e. below 0x80.
+size_t count_leading_ascii_bytes(ReadonlyBytes);
+
+namespace Detail {
+
+// Looks for a needle of at least two bytes. Returns false if there's nothing better than
+// the scalar algorithms in MemMem.h to do it with, in which case the caller has to search.
+bool vectorized_memmem(ReadonlyBytes haystack, ReadonlyBytes needle, Optional<size_t>& result);
+
+}
+
+}
+
+using AK::count_leading_ascii_bytes;
+using AK::find_byte;
@@ -8,6 +8,8 @@
 
 #include <AK/AllOf.h>
 #include <AK/AnyOf.h>
+#include <AK/NumericLimits.h>
+#include <AK/Span.h>
 #include <AK/StdLibExtras.h>
 #include <AK/StringView.h>
 
@@ -28,6 +30,7 @@ struct Array {
     constexpr static size_t size() { return Size; }
     constexpr const T& operator[](size_t index) const { return __data[index]; }
     constexpr T& operator[](size_t index) { return __data[index]; }
+    constexpr const T* data() const { return __data; }
     using ConstIterator = SimpleIterator<const Array, const T>;
     using Iterator = SimpleIterator<Array, T>;
 
@@ -142,6 +145,89 @@ consteval auto count_fmt_params(const char (&fmt)[N])
 #endif
 
 namespace AK::Format::Detail {
+
+// A literal and the replacement field that follows it, as offsets into the format string. The literal still has
+// its escaped braces in it, and the field is resolved to the index of the argument it refers to.
+struct FormatSegment {
+    u16 literal_start { 0 };
+    u16 literal_length { 0 };
+    u16 flags_start { 0 };
+    u16 flags_length { 0 };
+    u16 index { 0 };
+    bool has_field { false };
+    // The field has no flags and refers to an integer, so it can be formatted without going through its Formatter.
+    bool is_plain_integer { false };
+};
+
+template<typename T>
+inline constexpr bool is_formatted_as_plain_integer = IsIntegral<T> && !IsSame<T, bool> && !IsSame<T, char> && !IsSame<T, char8_t> && !IsSame<T, char16_t> && !IsSame<T, char32_t>;
+
+#ifdef ENABLE_COMPILETIME_FORMAT_CHECK
+// Splits an already checked format string into segments, so that formatting it doesn't have to parse it again.
+// Returns 0 if the format string doesn't fit into them, in which case it's parsed at runtime instead. That happens
+// for the rare format string that refers to an argument more than once or takes a width or precision from one.
+template<size_t N, typename... Args>
+consteval size_t precompile_format_string(const char (&fmt)[N], Array<FormatSegment, sizeof...(Args) + 1>& segments)
+{
+    constexpr bool is_plain_integer[] = { is_formatted_as_plain_integer<Args>..., false };
+
+    size_t length = 0;
+    while (length < N && fmt[length] != '\0')
+        ++length;
+    if (length > NumericLimits<u16>::max())
+        return 0;
+
+    size_t count = 0;
+    size_t next_implicit_argument_index = 0;
+    size_t literal_start = 0;
+    for (size_t i = 0; i < length;) {
+        if ((fmt[i] == '{' || fmt[i] == '}') && i + 1 < length && fmt[i + 1] == fmt[i]) {
+            i += 2;
+            continue;
+        }
+        if (fmt[i] != '{') {
+            ++i;
+            continue;
+        }
+        if (count == segments.size() - 1)
+            return 0;
+
+        auto& segment = segments[count++];
+        segment.literal_start = literal_start;
+        segment.literal_length = i - literal_start;
+        segment.has_field = true;
+
+        ++i;
+        size_t index = 0;
+        bool saw_explicit_index = false;
+        for (; fmt[i] >= '0' && fmt[i] <= '9'; ++i) {
+            index = index * 10 + (fmt[i] - '0');
+            saw_explicit_index = true;
+        }
+        if (!saw_explicit_index)
+            index = next_implicit_argument_index++;
+        segment.index = index;
+
+        if (fmt[i] == ':')
+            ++i;
+        segment.flags_start = i;
+        for (; fmt[i] != '}'; ++i) {
+            if (fmt[i] == '{')
+                return 0;
+        }
+        segment.flags_length = i - segment.flags_start;
+        segment.is_plain_integer = segment.flags_length == 0 && is_plain_integer[index];
+
+        literal_start = ++i;
+    }
+
+    auto& segment = segments[count++];
+    segment.literal_start = literal_start;
+    segment.literal_length = length - literal_start;
+    return count;
+}
+#endif
+
 template<typename... Args>
 struct CheckedFormatString {
     template<size_t N>
@@ -150,6 +236,7 @@ struct CheckedFormatString {
     {
 #ifdef ENABLE_COMPILETIME_FORMAT_CHECK
         check_format_parameter_consistency<N, sizeof...(Args)>(fmt);
+        m_segment_count = precompile_format_string<N, Args...>(fmt, m_segments);
 #endif
     }
 
@@ -161,6 +248,16 @@ struct CheckedFormatString {
 
     auto view() const { return m_string; }
 
+    // Empty unless the format string was checked at compile time.
+    Span<const FormatSegment> segments() const
+    {
+#ifdef ENABLE_COMPILETIME_FORMAT_CHECK
+        return { m_segments.data(), m_segment_count };
+#else
+        return {};
+#endif
+    }
+
 private:
 #ifdef ENABLE_COMPILETIME_FORMAT_CHECK
     template<size_t N, size_t param_count>
@@ -216,6 +313,10 @@ private:
 #endif
 
     StringView m_string;
+#ifdef ENABLE_COMPILETIME_FORMAT_CHECK
+    Array<FormatSegment, sizeof...(Args) + 1> m_segments {};
+    size_t m_segment_count { 0 };
+#endif
 };
 }
 
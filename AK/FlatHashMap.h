@@ -0,0 +1,429 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Forward.h>
+#include <AK/HashFunctions.h>
+#include <AK/HashTable.h>
+#include <AK/Optional.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Traits.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+#include <AK/kmalloc.h>
+
+namespace AK {
+
+// A hash map in the style of Abseil's Swiss tables: next to the entries, there is an array with one control
+// byte for each of them, which says whether the slot is empty, deleted or full, and for full slots holds
+// 7 bits of the hash of their key. Lookups look at a group of 8 control bytes at a time, with plain integer
+// arithmetic on a u64 so it works in the kernel too, and only touch the entries whose bits match. Deleted
+// slots are reused, and only stay behind as tombstones in groups that had filled up completely.
+//
+// Unlike HashMap, it has no ordered variant, and references to entries are invalidated by any insertion.
+template<typename K, typename V, typename KeyTraits>
+class FlatHashMap {
+    struct Entry {
+        K key;
+        V value;
+    };
+
+    static constexpr size_t group_width = 8;
+    static constexpr size_t minimum_capacity = group_width;
+
+    static constexpr u8 control_empty = 0x80;
+    static constexpr u8 control_deleted = 0xfe;
+
+    static constexpr u64 lsbs = 0x0101010101010101ull;
+    static constexpr u64 msbs = 0x8080808080808080ull;
+
+    struct Hash {
+        size_t h1;
+        u8 h2;
+    };
+
+    static Hash split_hash(unsigned hash)
+    {
+        // Traits often only have a weak hash, and the sharded tables in the kernel already pick their shard
+        // by the low bits of int_hash(), so take our bits from the top of a multiplicative hash instead.
+        u64 mixed = (u64)hash * 0x9e3779b97f4a7c15ull;
+        return { (size_t)(mixed >> 25), (u8)(mixed >> 57) };
+    }
+
+    // Bit 7 of every byte of the result is set where the byte of the group is what we're looking for. A byte
+    // right after a match can be reported as a match too, which is fine since the keys are compared anyway.
+    static u64 match_byte(u64 group, u8 byte) { return ((group ^ (lsbs * byte)) - lsbs) & ~(group ^ (lsbs * byte)) & msbs; }
+    static u64 match_empty(u64 group) { return group & ~(group << 6) & msbs; }
+    static u64 match_empty_or_deleted(u64 group) { return group & msbs; }
+    static size_t first_index_in_mask(u64 mask) { return __builtin_ctzll(mask) / 8; }
+
+public:
+    using KeyType = K;
+    using ValueType = V;
+
+    template<typename MapType, typename EntryType>
+    class IteratorBase {
+        friend class FlatHashMap;
+
+    public:
+        bool operator==(const IteratorBase& other) const { return m_index == other.m_index; }
+        bool operator!=(const IteratorBase& other) const { return m_index != other.m_index; }
+        EntryType& operator*() { return m_map->m_entries[m_index]; }
+        EntryType* operator->() { return &m_map->m_entries[m_index]; }
+        void operator++()
+        {
+            ++m_index;
+            skip_to_full_slot();
+        }
+
+    private:
+        IteratorBase(MapType& map, size_t index)
+            : m_map(&map)
+            , m_index(index)
+        {
+        }
+
+        void skip_to_full_slot()
+        {
+            while (m_index < m_map->m_capacity && (m_map->m_control[m_index] & 0x80))
+                ++m_index;
+        }
+
+        MapType* m_map { nullptr };
+        size_t m_index { 0 };
+    };
+
+    using IteratorType = IteratorBase<FlatHashMap, Entry>;
+    using ConstIteratorType = IteratorBase<const FlatHashMap, const Entry>;
+
+    FlatHashMap() = default;
+
+    ~FlatHashMap()
+    {
+        destroy_entries();
+        free_storage();
+    }
+
+    FlatHashMap(const FlatHashMap& other)
+    {
+        ensure_capacity(other.size());
+        for (auto& entry : other)
+            set(entry.key, entry.value);
+    }
+
+    FlatHashMap& operator=(const FlatHashMap& other)
+    {
+        FlatHashMap temporary(other);
+        swap(*this, temporary);
+        return *this;
+    }
+
+    FlatHashMap(FlatHashMap&& other) noexcept
+        : m_control(exchange(other.m_control, nullptr))
+        , m_entries(exchange(other.m_entries, nullptr))
+        , m_size(exchange(other.m_size, 0))
+        , m_capacity(exchange(other.m_capacity, 0))
+        , m_deleted_count(exchange(other.m_deleted_count, 0))
+    {
+    }
+
+    FlatHashMap& operator=(FlatHashMap&& other) noexcept
+    {
+        FlatHashMap temporary(move(other));
+        swap(*this, temporary);
+        return *this;
+    }
+
+    friend void swap(FlatHashMap& a, FlatHashMap& b) noexcept
+    {
+        swap(a.m_control, b.m_control);
+        swap(a.m_entries, b.m_entries);
+        swap(a.m_size, b.m_size);
+        swap(a.m_capacity, b.m_capacity);
+        swap(a.m_deleted_count, b.m_deleted_count);
+    }
+
+    [[nodiscard]] bool is_empty() const { return !m_size; }
+    [[nodiscard]] size_t size() const { return m_size; }
+    [[nodiscard]] size_t capacity() const { return m_capacity; }
+    void clear() { *this = FlatHashMap(); }
+
+    void ensure_capacity(size_t capacity)
+    {
+        VERIFY(capacity >= size());
+        auto new_capacity = capacity_for(capacity);
+        if (new_capacity > m_capacity)
+            rehash(new_capacity);
+    }
+
+    HashSetResult set(const K& key, const V& value) { return set_impl(key, value); }
+    HashSetResult set(const K& key, V&& value) { return set_impl(key, move(value)); }
+
+    [[nodiscard]] IteratorType begin()
+    {
+        IteratorType it(*this, 0);
+        it.skip_to_full_slot();
+        return it;
+    }
+    [[nodiscard]] IteratorType end() { return IteratorType(*this, m_capacity); }
+    [[nodiscard]] ConstIteratorType begin() const
+    {
+        ConstIteratorType it(*this, 0);
+        it.skip_to_full_slot();
+        return it;
+    }
+    [[nodiscard]] ConstIteratorType end() const { return ConstIteratorType(*this, m_capacity); }
+
+    [[nodiscard]] IteratorType find(const K& key)
+    {
+        return IteratorType(*this, lookup(KeyTraits::hash(key), [&](auto& entry) { return KeyTraits::equals(key, entry.key); }));
+    }
+    template<typename TUnaryPredicate>
+    [[nodiscard]] IteratorType find(unsigned hash, TUnaryPredicate predicate)
+    {
+        return IteratorType(*this, lookup(hash, move(predicate)));
+    }
+    [[nodiscard]] ConstIteratorType find(const K& key) const
+    {
+        return ConstIteratorType(*this, lookup(KeyTraits::hash(key), [&](auto& entry) { return KeyTraits::equals(key, entry.key); }));
+    }
+    template<typename TUnaryPredicate>
+    [[nodiscard]] ConstIteratorType find(unsigned hash, TUnaryPredicate predicate) const
+    {
+        return ConstIteratorType(*this, lookup(hash, move(predicate)));
+    }
+
+    [[nodiscard]] bool contains(const K& key) const { return find(key) != end(); }
+
+    Optional<typename Traits<V>::PeekType> get(const K& key) const requires(!IsPointer<typename Traits<V>::PeekType>)
+    {
+        auto it = find(key);
+        if (it == end())
+            return {};
+        return (*it).value;
+    }
+
+    Optional<typename Traits<V>::ConstPeekType> get(const K& key) const requires(IsPointer<typename Traits<V>::PeekType>)
+    {
+        auto it = find(key);
+        if (it == end())
+            return {};
+        return (*it).value;
+    }
+
+    Optional<typename Traits<V>::PeekType> get(const K& key) requires(!IsConst<typename Traits<V>::PeekType>)
+    {
+        auto it = find(key);
+        if (it == end())
+            return {};
+        return (*it).value;
+    }
+
+    V& ensure(const K& key)
+    {
+        auto it = find(key);
+        if (it != end())
+            return it->value;
+        auto index = insert_new(key, V());
+        return m_entries[index].value;
+    }
+
+    bool remove(const K& key)
+    {
+        auto it = find(key);
+        if (it == end())
+            return false;
+        remove(it);
+        return true;
+    }
+
+    void remove(IteratorType it)
+    {
+        VERIFY(it.m_index < m_capacity);
+        auto index = it.m_index;
+        VERIFY(!(m_control[index] & 0x80));
+        m_entries[index].~Entry();
+        --m_size;
+
+        // Lookups stop at the first group with an empty slot. If this group already has one, no key can
+        // have been put past it, so the slot can become empty again. Otherwise it has to stay a tombstone.
+        auto group_start = index & ~(group_width - 1);
+        if (match_empty(load_group(group_start))) {
+            m_control[index] = control_empty;
+        } else {
+            m_control[index] = control_deleted;
+            ++m_deleted_count;
+        }
+    }
+
+    [[nodiscard]] Vector<K> keys() const
+    {
+        Vector<K> list;
+        list.ensure_capacity(size());
+        for (auto& it : *this)
+            list.unchecked_append(it.key);
+        return list;
+    }
+
+private:
+    // Tables are at most 7/8 full, counting the tombstones.
+    static size_t maximum_load(size_t capacity) { return capacity - capacity / 8; }
+
+    static size_t capacity_for(size_t size)
+    {
+        size_t capacity = minimum_capacity;
+        while (maximum_load(capacity) < size)
+            capacity *= 2;
+        return capacity;
+    }
+
+    u64 load_group(size_t group_start) const
+    {
+        u64 group;
+        __builtin_memcpy(&group, m_control + group_start, sizeof(group));
+        return group;
+    }
+
+    // Visits the groups of a table in a triangular sequence, which hits every one of them once since there are a power of two.
+    struct ProbeSequence {
+        ProbeSequence(size_t h1, size_t group_mask)
+            : group(h1 & group_mask)
+            , mask(group_mask)
+        {
+        }
+
+        size_t group_start() const { return group * group_width; }
+        void next()
+        {
+            ++step;
+            group = (group + step) & mask;
+        }
+
+        size_t group { 0 };
+        size_t mask { 0 };
+        size_t step { 0 };
+    };
+
+    size_t group_mask() const { return m_capacity / group_width - 1; }
+
+    template<typename TPredicate>
+    size_t lookup(unsigned hash, TPredicate predicate) const
+    {
+        if (is_empty())
+            return m_capacity;
+        auto [h1, h2] = split_hash(hash);
+        ProbeSequence probe(h1, group_mask());
+        for (;;) {
+            auto group = load_group(probe.group_start());
+            for (auto matches = match_byte(group, h2); matches; matches &= matches - 1) {
+                auto index = probe.group_start() + first_index_in_mask(matches);
+                if (m_control[index] == h2 && predicate(m_entries[index]))
+                    return index;
+            }
+            if (match_empty(group))
+                return m_capacity;
+            probe.next();
+        }
+    }
+
+    size_t find_free_slot(size_t h1) const
+    {
+        ProbeSequence probe(h1, group_mask());
+        for (;;) {
+            if (auto free_slots = match_empty_or_deleted(load_group(probe.group_start())))
+                return probe.group_start() + first_index_in_mask(free_slots);
+            probe.next();
+        }
+    }
+
+    template<typename U>
+    HashSetResult set_impl(const K& key, U&& value)
+    {
+        auto it = find(key);
+        if (it != end()) {
+            it->value = forward<U>(value);
+            return HashSetResult::ReplacedExistingEntry;
+        }
+        insert_new(key, forward<U>(value));
+        return HashSetResult::InsertedNewEntry;
+    }
+
+    // The key must not be in the table yet.
+    template<typename U>
+    size_t insert_new(const K& key, U&& value)
+    {
+        if (m_size + m_deleted_count + 1 > maximum_load(m_capacity)) {
+            // If it's mostly tombstones that filled up the table, this just gets rid of them.
+            rehash(capacity_for((m_size + 1) * 2));
+        }
+        auto [h1, h2] = split_hash(KeyTraits::hash(key));
+        auto index = find_free_slot(h1);
+        if (m_control[index] == control_deleted)
+            --m_deleted_count;
+        m_control[index] = h2;
+        new (&m_entries[index]) Entry { key, forward<U>(value) };
+        ++m_size;
+        return index;
+    }
+
+    static size_t entries_offset(size_t capacity) { return round_up_to_power_of_two(capacity, alignof(Entry)); }
+    static size_t size_in_bytes(size_t capacity) { return entries_offset(capacity) + capacity * sizeof(Entry); }
+
+    void rehash(size_t new_capacity)
+    {
+        auto* old_control = m_control;
+        auto* old_entries = m_entries;
+        auto old_capacity = m_capacity;
+
+        // The control bytes and the entries share one allocation, with the control bytes up front.
+        auto* storage = static_cast<u8*>(kmalloc(size_in_bytes(new_capacity)));
+        VERIFY(storage);
+        m_control = storage;
+        m_entries = reinterpret_cast<Entry*>(storage + entries_offset(new_capacity));
+        __builtin_memset(m_control, control_empty, new_capacity);
+        m_capacity = new_capacity;
+        m_deleted_count = 0;
+
+        for (size_t i = 0; i < old_capacity; ++i) {
+            if (old_control[i] & 0x80)
+                continue;
+            auto& entry = old_entries[i];
+            auto [h1, h2] = split_hash(KeyTraits::hash(entry.key));
+            auto index = find_free_slot(h1);
+            m_control[index] = h2;
+            new (&m_entries[index]) Entry { move(entry) };
+            entry.~Entry();
+        }
+
+        if (old_control)
+            kfree_sized(old_control, size_in_bytes(old_capacity));
+    }
+
+    void destroy_entries()
+    {
+        for (size_t i = 0; i < m_capacity; ++i) {
+            if (!(m_control[i] & 0x80))
+                m_entries[i].~Entry();
+        }
+    }
+
+    void free_storage()
+    {
+        if (m_control)
+            kfree_sized(m_control, size_in_bytes(m_capacity));
+    }
+
+    u8* m_control { nullptr };
+    Entry* m_entries { nullptr };
+    size_t m_size { 0 };
+    size_t m_capacity { 0 };
+    size_t m_deleted_count { 0 };
+};
+
+}
+
+using AK::FlatHashMap;
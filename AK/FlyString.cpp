@@ -5,8 +5,10 @@
  */
 
 #include <AK/FlyString.h>
+#include <AK/Atomic.h>
 #include <AK/HashTable.h>
 #include <AK/Optional.h>
+#include <AK/ScopeGuard.h>
 #include <AK/Singleton.h>
 #include <AK/String.h>
 #include <AK/StringUtils.h>
@@ -14,26 +16,94 @@
 
 namespace AK {
 
+// Every impl in the table has its hash computed already, so it's compared before the characters are.
 struct FlyStringImplTraits : public Traits<StringImpl*> {
-    static unsigned hash(const StringImpl* s) { return s ? s->hash() : 0; }
+    static unsigned hash(const StringImpl* s) { return s ? s->existing_hash() : 0; }
     static bool equals(const StringImpl* a, const StringImpl* b)
     {
         VERIFY(a);
         VERIFY(b);
-        return *a == *b;
+        return a->existing_hash() == b->existing_hash() && *a == *b;
     }
 };
 
-static AK::Singleton<HashTable<StringImpl*, FlyStringImplTraits>> s_table;
+// FlyStrings can be created from any thread, so the interned impls are spread over a number of tables that
+// are locked separately, which keeps threads that intern at the same time from waiting on each other.
+// A table is only ever held for a single lookup or insertion, so spinning is cheaper than a real mutex.
+class FlyStringTable {
+public:
+    static constexpr size_t shard_count = 16;
+
+    class Shard {
+    public:
+        void lock()
+        {
+            while (m_locked.exchange(true, AK::MemoryOrder::memory_order_acquire)) {
+                while (m_locked.load(AK::MemoryOrder::memory_order_relaxed)) {
+#if ARCH(I386) || ARCH(X86_64)
+                    __builtin_ia32_pause();
+#endif
+                }
+            }
+        }
+
+        void unlock() { m_locked.store(false, AK::MemoryOrder::memory_order_release); }
+
+        HashTable<StringImpl*, FlyStringImplTraits>& impls() { return m_impls; }
+
+    private:
+        Atomic<bool> m_locked { false };
+        HashTable<StringImpl*, FlyStringImplTraits> m_impls;
+    };
+
+    // The table picks a bucket by the low bits of the hash, so the shard is picked by the high ones.
+    Shard& shard_for(unsigned hash) { return m_shards[hash >> (sizeof(hash) * 8 - 4)]; }
+
+private:
+    static_assert(shard_count == 1 << 4);
+
+    // Padded to a cache line each, so threads spinning on one shard's lock don't slow down the neighbouring ones.
+    // (The table is heap-allocated, and there's no aligned operator new everywhere, so they can't be aligned.)
+    struct PaddedShard : public Shard {
+        u8 padding[64 - sizeof(Shard) % 64];
+    };
+    PaddedShard m_shards[shard_count];
+};
+
+static AK::Singleton<FlyStringTable> s_table;
 
-static HashTable<StringImpl*, FlyStringImplTraits>& fly_impls()
+template<typename Callback>
+static decltype(auto) with_locked_shard(unsigned hash, Callback callback)
 {
-    return *s_table;
+    auto& shard = s_table->shard_for(hash);
+    shard.lock();
+    ScopeGuard unlock_guard = [&] { shard.unlock(); };
+    return callback(shard.impls());
 }
 
 void FlyString::did_destroy_impl(Badge<StringImpl>, StringImpl& impl)
 {
-    fly_impls().remove(&impl);
+    with_locked_shard(impl.existing_hash(), [&](auto& impls) {
+        // Someone may have found this impl after its last reference went away and replaced it already.
+        auto it = impls.find(impl.existing_hash(), [&](auto* candidate) { return candidate == &impl; });
+        if (it != impls.end())
+            impls.remove(it);
+    });
+}
+
+template<typename Predicate>
+static RefPtr<StringImpl> find_fly_impl(HashTable<StringImpl*, FlyStringImplTraits>& impls, unsigned hash, Predicate predicate)
+{
+    auto it = impls.find(hash, [&](auto* candidate) { return candidate->existing_hash() == hash && predicate(*candidate); });
+    if (it == impls.end())
+        return {};
+    VERIFY((*it)->is_fly());
+    // The impl may be about to be destroyed by another thread, which will take it out of the table once it gets to lock it.
+    if (!(*it)->try_ref()) {
+        impls.remove(it);
+        return {};
+    }
+    return adopt_ref(**it);
 }
 
 FlyString::FlyString(const String& string)
@@ -44,33 +114,32 @@ FlyString::FlyString(const String& string)
         m_impl = string.impl();
         return;
     }
-    auto it = fly_impls().find(const_cast<StringImpl*>(string.impl()));
-    if (it == fly_impls().end()) {
-        fly_impls().set(const_cast<StringImpl*>(string.impl()));
-        string.impl()->set_fly({}, true);
-        m_impl = string.impl();
-    } else {
-        VERIFY((*it)->is_fly());
-        m_impl = *it;
-    }
+    auto* impl = const_cast<StringImpl*>(string.impl());
+    auto hash = impl->hash();
+    m_impl = with_locked_shard(hash, [&](auto& impls) -> RefPtr<StringImpl> {
+        if (auto existing = find_fly_impl(impls, hash, [&](auto& candidate) { return candidate == *impl; }))
+            return existing;
+        impls.set(impl);
+        impl->set_fly({}, true);
+        return impl;
+    });
 }
 
 FlyString::FlyString(StringView const& string)
 {
     if (string.is_null())
         return;
-    auto it = fly_impls().find(string.hash(), [&](auto& candidate) {
-        return string == candidate;
-    });
-    if (it == fly_impls().end()) {
+    auto hash = string.hash();
+    m_impl = with_locked_shard(hash, [&](auto& impls) -> RefPtr<StringImpl> {
+        if (auto existing = find_fly_impl(impls, hash, [&](auto& candidate) { return string == StringView { candidate.characters(), candidate.length() }; }))
+            return existing;
         auto new_string = string.to_string();
-        fly_impls().set(new_string.impl());
-        new_string.impl()->set_fly({}, true);
-        m_impl = new_string.impl();
-    } else {
-        VERIFY((*it)->is_fly());
-        m_impl = *it;
-    }
+        auto* impl = new_string.impl();
+        impl->hash();
+        impls.set(impl);
+        impl->set_fly({}, true);
+        return impl;
+    });
 }
 
 template<typename T>
@@ -44,6 +44,13 @@ static constexpr size_t convert_unsigned_to_string(u64 value, Array<u8, 128>& bu
     }
 
     size_t used = 0;
+    // Dividing by a constant is a lot cheaper than dividing by a variable, and most numbers are formatted in decimal.
+    if (base == 10) {
+        while (value > 0) {
+            buffer[used++] = '0' + value % 10;
+            value /= 10;
+        }
+    }
     while (value > 0) {
         if (upper_case)
             buffer[used++] = uppercase_lookup[value % base];
@@ -81,6 +88,49 @@ void vformat_impl(TypeErasedFormatParams& params, FormatBuilder& builder, Format
     vformat_impl(params, builder, parser);
 }
 
+void put_plain_integer(FormatBuilder& builder, const TypeErasedParameter& parameter)
+{
+    switch (parameter.type) {
+    case TypeErasedParameter::Type::UInt8:
+        return builder.put_u64(*static_cast<const u8*>(parameter.value));
+    case TypeErasedParameter::Type::UInt16:
+        return builder.put_u64(*static_cast<const u16*>(parameter.value));
+    case TypeErasedParameter::Type::UInt32:
+        return builder.put_u64(*static_cast<const u32*>(parameter.value));
+    case TypeErasedParameter::Type::UInt64:
+        return builder.put_u64(*static_cast<const u64*>(parameter.value));
+    case TypeErasedParameter::Type::Int8:
+        return builder.put_i64(*static_cast<const i8*>(parameter.value));
+    case TypeErasedParameter::Type::Int16:
+        return builder.put_i64(*static_cast<const i16*>(parameter.value));
+    case TypeErasedParameter::Type::Int32:
+        return builder.put_i64(*static_cast<const i32*>(parameter.value));
+    case TypeErasedParameter::Type::Int64:
+        return builder.put_i64(*static_cast<const i64*>(parameter.value));
+    case TypeErasedParameter::Type::Custom:
+        break;
+    }
+    VERIFY_NOT_REACHED();
+}
+
+void vformat_segments(TypeErasedFormatParams& params, FormatBuilder& builder, StringView fmtstr)
+{
+    for (auto& segment : params.segments()) {
+        builder.put_literal(fmtstr.substring_view(segment.literal_start, segment.literal_length));
+        if (!segment.has_field)
+            continue;
+
+        auto& parameter = params.parameters().at(segment.index);
+        if (segment.is_plain_integer) {
+            put_plain_integer(builder, parameter);
+            continue;
+        }
+
+        FormatParser argparser { fmtstr.substring_view(segment.flags_start, segment.flags_length) };
+        parameter.formatter(params, builder, argparser, parameter.value);
+    }
+}
+
 } // namespace AK::{anonymous}
 
 FormatParser::FormatParser(StringView input)
@@ -180,11 +230,15 @@ void FormatBuilder::put_padding(char fill, size_t amount)
 }
 void FormatBuilder::put_literal(StringView value)
 {
+    // Braces are escaped by doubling them, so everything up to and including the first one of each pair is appended.
+    size_t start = 0;
     for (size_t i = 0; i < value.length(); ++i) {
-        m_builder.append(value[i]);
-        if (value[i] == '{' || value[i] == '}')
-            ++i;
+        if (value[i] == '{' || value[i] == '}') {
+            m_builder.append(value.substring_view(start, i + 1 - start));
+            start = min(++i + 1, value.length());
+        }
     }
+    m_builder.append(value.substring_view(start));
 }
 void FormatBuilder::put_string(
     StringView value,
@@ -280,8 +334,7 @@ void FormatBuilder::put_u64(
         }
     };
     const auto put_digits = [&]() {
-        for (size_t i = 0; i < used_by_digits; ++i)
-            m_builder.append(buffer[i]);
+        m_builder.append(reinterpret_cast<const char*>(buffer.data()), used_by_digits);
     };
 
     if (align == Align::Left) {
@@ -455,8 +508,13 @@ void FormatBuilder::put_hexdump(ReadonlyBytes bytes, size_t width, char fill)
 void vformat(StringBuilder& builder, StringView fmtstr, TypeErasedFormatParams params)
 {
     FormatBuilder fmtbuilder { builder };
-    FormatParser parser { fmtstr };
 
+    if (!params.segments().is_empty()) {
+        vformat_segments(params, fmtbuilder, fmtstr);
+        return;
+    }
+
+    FormatParser parser { fmtstr };
     vformat_impl(params, fmtbuilder, parser);
 }
 
@@ -235,8 +235,13 @@ public:
     void set_parameters(Span<const TypeErasedParameter> parameters) { m_parameters = parameters; }
     size_t take_next_index() { return m_next_index++; }
 
+    // If these are set, they describe the format string that these parameters are formatted with.
+    Span<const Format::Detail::FormatSegment> segments() const { return m_segments; }
+    void set_segments(Span<const Format::Detail::FormatSegment> segments) { m_segments = segments; }
+
 private:
     Span<const TypeErasedParameter> m_parameters;
+    Span<const Format::Detail::FormatSegment> m_segments;
     size_t m_next_index { 0 };
 };
 
@@ -260,6 +265,12 @@ public:
         this->set_parameters(m_data);
     }
 
+    explicit VariadicFormatParams(CheckedFormatString<Parameters...> const& fmtstr, const Parameters&... parameters)
+        : VariadicFormatParams(parameters...)
+    {
+        this->set_segments(fmtstr.segments());
+    }
+
 private:
     Array<TypeErasedParameter, sizeof...(Parameters)> m_data;
 };
@@ -488,10 +499,10 @@ void vformat(StringBuilder&, StringView fmtstr, TypeErasedFormatParams);
 void vout(FILE*, StringView fmtstr, TypeErasedFormatParams, bool newline = false);
 
 template<typename... Parameters>
-void out(FILE* file, CheckedFormatString<Parameters...>&& fmtstr, const Parameters&... parameters) { vout(file, fmtstr.view(), VariadicFormatParams { parameters... }); }
+void out(FILE* file, CheckedFormatString<Parameters...>&& fmtstr, const Parameters&... parameters) { vout(file, fmtstr.view(), VariadicFormatParams { fmtstr, parameters... }); }
 
 template<typename... Parameters>
-void outln(FILE* file, CheckedFormatString<Parameters...>&& fmtstr, const Parameters&... parameters) { vout(file, fmtstr.view(), VariadicFormatParams { parameters... }, true); }
+void outln(FILE* file, CheckedFormatString<Parameters...>&& fmtstr, const Parameters&... parameters) { vout(file, fmtstr.view(), VariadicFormatParams { fmtstr, parameters... }, true); }
 
 inline void outln(FILE* file) { fputc('\n', file); }
 
@@ -533,7 +544,7 @@ void vdbgln(StringView fmtstr, TypeErasedFormatParams);
 template<typename... Parameters>
 void dbgln(CheckedFormatString<Parameters...>&& fmtstr, const Parameters&... parameters)
 {
-    vdbgln(fmtstr.view(), VariadicFormatParams { parameters... });
+    vdbgln(fmtstr.view(), VariadicFormatParams { fmtstr, parameters... });
 }
 
 inline void dbgln() { dbgln(""); }
@@ -546,7 +557,7 @@ void vdmesgln(StringView fmtstr, TypeErasedFormatParams);
 template<typename... Parameters>
 void dmesgln(CheckedFormatString<Parameters...>&& fmt, const Parameters&... parameters)
 {
-    vdmesgln(fmt.view(), VariadicFormatParams { parameters... });
+    vdmesgln(fmt.view(), VariadicFormatParams { fmt, parameters... });
 }
 
 void v_critical_dmesgln(StringView fmtstr, TypeErasedFormatParams);
@@ -556,7 +567,7 @@ void v_critical_dmesgln(StringView fmtstr, TypeErasedFormatParams);
 template<typename... Parameters>
 void critical_dmesgln(CheckedFormatString<Parameters...>&& fmt, const Parameters&... parameters)
 {
-    v_critical_dmesgln(fmt.view(), VariadicFormatParams { parameters... });
+    v_critical_dmesgln(fmt.view(), VariadicFormatParams { fmt, parameters... });
 }
 #endif
 
@@ -18,6 +18,7 @@ class ByteBuffer;
 class Bitmap;
 using ByteBuffer = AK::Detail::ByteBuffer<32>;
 class IPv4Address;
+class IPv6Address;
 class JsonArray;
 class JsonObject;
 class JsonValue;
@@ -67,6 +68,12 @@ class DoublyLinkedList;
 template<typename T, size_t capacity>
 class CircularQueue;
 
+template<typename T, size_t Capacity>
+class MPMCQueue;
+
+template<typename T, size_t Capacity>
+class SPSCQueue;
+
 template<typename T>
 struct Traits;
 
@@ -82,6 +89,9 @@ class HashMap;
 template<typename K, typename V, typename KeyTraits = Traits<K>>
 using OrderedHashMap = HashMap<K, V, KeyTraits, true>;
 
+template<typename K, typename V, typename KeyTraits = Traits<K>>
+class FlatHashMap;
+
 template<typename T>
 class Badge;
 
@@ -137,6 +147,7 @@ using AK::CircularQueue;
 using AK::DoublyLinkedList;
 using AK::DuplexMemoryStream;
 using AK::FixedArray;
+using AK::FlatHashMap;
 using AK::FlyString;
 using AK::Function;
 using AK::HashMap;
@@ -145,9 +156,11 @@ using AK::InputBitStream;
 using AK::InputMemoryStream;
 using AK::InputStream;
 using AK::IPv4Address;
+using AK::IPv6Address;
 using AK::JsonArray;
 using AK::JsonObject;
 using AK::JsonValue;
+using AK::MPMCQueue;
 using AK::NonnullOwnPtr;
 using AK::NonnullOwnPtrVector;
 using AK::NonnullRefPtr;
@@ -161,6 +174,7 @@ using AK::ReadonlyBytes;
 using AK::RefPtr;
 using AK::SinglyLinkedList;
 using AK::Span;
+using AK::SPSCQueue;
 using AK::StackInfo;
 using AK::String;
 using AK::StringBuilder;
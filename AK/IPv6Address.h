@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/Optional.h>
+#include <AK/String.h>
+#include <AK/StringBuilder.h>
+#include <AK/StringView.h>
+#include <AK/Vector.h>
+
+namespace AK {
+
+class [[gnu::packed]] IPv6Address {
+public:
+    constexpr IPv6Address() = default;
+
+    constexpr IPv6Address(const u8 data[16])
+    {
+        for (size_t i = 0; i < 16; ++i)
+            m_data[i] = data[i];
+    }
+
+    constexpr u8 operator[](int i) const
+    {
+        VERIFY(i >= 0 && i < 16);
+        return m_data[i];
+    }
+
+    constexpr u16 group(size_t index) const
+    {
+        VERIFY(index < 8);
+        return (u16(m_data[index * 2]) << 8) | m_data[index * 2 + 1];
+    }
+
+    const u8* data() const { return m_data.data(); }
+
+    // Uses the shortest form from RFC 5952, i.e. the longest run of zero groups is left out.
+    String to_string() const
+    {
+        size_t longest_run_start = 8;
+        size_t longest_run_length = 1;
+        for (size_t start = 0; start < 8;) {
+            size_t length = 0;
+            while (start + length < 8 && group(start + length) == 0)
+                ++length;
+            if (length > longest_run_length) {
+                longest_run_start = start;
+                longest_run_length = length;
+            }
+            start += length ? length : 1;
+        }
+
+        StringBuilder builder;
+        for (size_t index = 0; index < 8; ++index) {
+            if (index == longest_run_start) {
+                builder.append("::");
+                index += longest_run_length - 1;
+                continue;
+            }
+            if (index > 0 && index != longest_run_start + longest_run_length)
+                builder.append(':');
+            builder.appendff("{:x}", group(index));
+        }
+        return builder.to_string();
+    }
+
+    // Every nibble on its own, last to first, like they are used in ip6.arpa names.
+    String to_string_reversed() const
+    {
+        StringBuilder builder;
+        for (size_t i = 16; i > 0; --i) {
+            if (i != 16)
+                builder.append('.');
+            builder.appendff("{:x}.{:x}", m_data[i - 1] & 0xf, m_data[i - 1] >> 4);
+        }
+        return builder.to_string();
+    }
+
+    static Optional<IPv6Address> from_string(const StringView& string)
+    {
+        if (string.is_null())
+            return {};
+
+        auto parse_groups = [](const StringView& part, Vector<u16, 8>& groups) -> bool {
+            if (part.is_empty())
+                return true;
+            for (auto& group_string : part.split_view(':', true)) {
+                if (group_string.is_empty() || group_string.length() > 4)
+                    return false;
+                u16 value = 0;
+                for (auto ch : group_string) {
+                    u8 digit;
+                    if (ch >= '0' && ch <= '9')
+                        digit = ch - '0';
+                    else if (ch >= 'a' && ch <= 'f')
+                        digit = ch - 'a' + 10;
+                    else if (ch >= 'A' && ch <= 'F')
+                        digit = ch - 'A' + 10;
+                    else
+                        return false;
+                    value = (value << 4) | digit;
+                }
+                groups.append(value);
+            }
+            return true;
+        };
+
+        Vector<u16, 8> head;
+        Vector<u16, 8> tail;
+        auto double_colon = string.find("::"sv);
+        if (double_colon.has_value()) {
+            if (!parse_groups(string.substring_view(0, double_colon.value()), head))
+                return {};
+            if (!parse_groups(string.substring_view(double_colon.value() + 2), tail))
+                return {};
+            if (head.size() + tail.size() > 7)
+                return {};
+        } else {
+            if (!parse_groups(string, head) || head.size() != 8)
+                return {};
+        }
+
+        u8 data[16] {};
+        for (size_t i = 0; i < head.size(); ++i) {
+            data[i * 2] = head[i] >> 8;
+            data[i * 2 + 1] = head[i] & 0xff;
+        }
+        size_t tail_start = 8 - tail.size();
+        for (size_t i = 0; i < tail.size(); ++i) {
+            data[(tail_start + i) * 2] = tail[i] >> 8;
+            data[(tail_start + i) * 2 + 1] = tail[i] & 0xff;
+        }
+        return IPv6Address(data);
+    }
+
+    constexpr bool operator==(const IPv6Address& other) const = default;
+    constexpr bool operator!=(const IPv6Address& other) const = default;
+
+    constexpr bool is_zero() const
+    {
+        for (auto byte : m_data) {
+            if (byte != 0)
+                return false;
+        }
+        return true;
+    }
+
+    // fe80::/10
+    constexpr bool is_link_local() const { return m_data[0] == 0xfe && (m_data[1] & 0xc0) == 0x80; }
+    // ff00::/8
+    constexpr bool is_multicast() const { return m_data[0] == 0xff; }
+
+    // The multicast group that neighbor solicitations for this address are sent to, ff02::1:ffXX:XXXX.
+    constexpr IPv6Address solicited_node_multicast_address() const
+    {
+        u8 data[16] { 0xff, 0x02, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01, 0xff, m_data[13], m_data[14], m_data[15] };
+        return IPv6Address(data);
+    }
+
+private:
+    Array<u8, 16> m_data {};
+};
+
+static_assert(sizeof(IPv6Address) == 16);
+
+template<>
+struct Traits<IPv6Address> : public GenericTraits<IPv6Address> {
+    static unsigned hash(const IPv6Address& address)
+    {
+        unsigned hash = 0;
+        for (size_t i = 0; i < 16; i += 4)
+            hash = pair_int_hash(hash, (address[i] << 24) | (address[i + 1] << 16) | (address[i + 2] << 8) | address[i + 3]);
+        return hash;
+    }
+};
+
+template<>
+struct Formatter<IPv6Address> : Formatter<String> {
+    void format(FormatBuilder& builder, IPv6Address value)
+    {
+        return Formatter<String>::format(builder, value.to_string());
+    }
+};
+
+}
+
+using AK::IPv6Address;
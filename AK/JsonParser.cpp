@@ -16,8 +16,28 @@ constexpr bool is_space(int ch)
     return ch == '\t' || ch == '\n' || ch == '\r' || ch == ' ';
 }
 
+Optional<StringView> JsonParser::peek_string_without_escapes() const
+{
+    if (peek() != '"')
+        return {};
+    for (size_t index = m_index + 1; index < m_input.length(); ++index) {
+        char ch = m_input[index];
+        if (ch == '"')
+            return m_input.substring_view(m_index + 1, index - m_index - 1);
+        if (ch == '\\' || is_ascii_c0_control(ch))
+            return {};
+    }
+    return {};
+}
+
 String JsonParser::consume_and_unescape_string()
 {
+    // Most strings don't have any escapes in them, so they can be copied straight out of the input.
+    if (auto string = peek_string_without_escapes(); string.has_value()) {
+        m_index += string->length() + 2;
+        return *string;
+    }
+
     if (!consume_specific('"'))
         return {};
     StringBuilder final_sb;
@@ -120,6 +140,20 @@ String JsonParser::consume_and_unescape_string()
     return final_sb.to_string();
 }
 
+String JsonParser::consume_object_key()
+{
+    // The objects in an array tend to all have the same keys. We keep the last key that started with each
+    // character around, so when it comes up again it can be handed out instead of another copy of it.
+    auto string = peek_string_without_escapes();
+    if (!string.has_value() || string->is_empty())
+        return consume_and_unescape_string();
+    auto& last_string = m_last_string_starting_with_character[(u8)string->characters_without_null_termination()[0]];
+    if (last_string != *string)
+        last_string = *string;
+    m_index += string->length() + 2;
+    return last_string;
+}
+
 Optional<JsonValue> JsonParser::parse_object()
 {
     JsonObject object;
@@ -130,7 +164,7 @@ Optional<JsonValue> JsonParser::parse_object()
         if (peek() == '}')
             break;
         ignore_while(is_space);
-        auto name = consume_and_unescape_string();
+        auto name = consume_object_key();
         if (name.is_null())
             return {};
         ignore_while(is_space);
@@ -23,7 +23,9 @@ public:
 private:
     Optional<JsonValue> parse_helper();
 
+    Optional<StringView> peek_string_without_escapes() const;
     String consume_and_unescape_string();
+    String consume_object_key();
     Optional<JsonValue> parse_array();
     Optional<JsonValue> parse_object();
     Optional<JsonValue> parse_number();
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/CharacterTypes.h>
+#include <AK/JsonParser.h>
+#include <AK/JsonPullParser.h>
+
+namespace AK {
+
+constexpr bool is_space(int ch)
+{
+    return ch == '\t' || ch == '\n' || ch == '\r' || ch == ' ';
+}
+
+bool JsonPullParser::Token::string_equals(StringView const& other) const
+{
+    if (m_type != TokenType::Key && m_type != TokenType::String)
+        return false;
+    if (!m_has_escapes)
+        return raw_string() == other;
+    return to_string() == other;
+}
+
+String JsonPullParser::Token::to_string() const
+{
+    if (m_type != TokenType::Key && m_type != TokenType::String)
+        return {};
+    if (!m_has_escapes)
+        return raw_string();
+    // The literal has already been checked to be a valid string, so the regular parser can take care of unescaping it.
+    auto value = JsonParser(m_literal).parse();
+    if (!value.has_value() || !value->is_string())
+        return {};
+    return value->as_string();
+}
+
+JsonPullParser::Token JsonPullParser::fail()
+{
+    m_expect = Expect::Nothing;
+    m_containers.clear();
+    return TokenType::Error;
+}
+
+JsonPullParser::Token JsonPullParser::did_consume_value(Token token)
+{
+    m_expect = m_containers.is_empty() ? Expect::Done : Expect::CommaOrEnd;
+    return token;
+}
+
+JsonPullParser::Token JsonPullParser::consume_string(TokenType type)
+{
+    size_t start = m_index;
+    ignore();
+    bool has_escapes = false;
+    for (;;) {
+        if (is_eof())
+            return fail();
+        char ch = consume();
+        if (ch == '"')
+            break;
+        if (is_ascii_c0_control(ch))
+            return fail();
+        if (ch == '\\') {
+            if (is_eof())
+                return fail();
+            ignore();
+            has_escapes = true;
+        }
+    }
+    return Token { type, m_input.substring_view(start, m_index - start), has_escapes };
+}
+
+JsonPullParser::Token JsonPullParser::consume_number()
+{
+    size_t start = m_index;
+    ignore_while([](char ch) { return is_ascii_digit(ch) || ch == '-' || ch == '+' || ch == '.' || ch == 'e' || ch == 'E'; });
+    auto literal = m_input.substring_view(start, m_index - start);
+    if (literal == "-")
+        return fail();
+    return did_consume_value({ TokenType::Number, literal });
+}
+
+JsonPullParser::Token JsonPullParser::consume_literal(StringView const& literal, TokenType type)
+{
+    size_t start = m_index;
+    if (!consume_specific(literal))
+        return fail();
+    return did_consume_value({ type, m_input.substring_view(start, literal.length()) });
+}
+
+JsonPullParser::Token JsonPullParser::next()
+{
+    for (;;) {
+        ignore_while(is_space);
+        switch (m_expect) {
+        case Expect::Nothing:
+            return TokenType::Error;
+
+        case Expect::Done:
+            if (!is_eof())
+                return fail();
+            return TokenType::End;
+
+        case Expect::CommaOrEnd: {
+            bool in_object = m_containers.last() == TokenType::ObjectStart;
+            if (consume_specific(',')) {
+                m_expect = in_object ? Expect::Key : Expect::Value;
+                continue;
+            }
+            if (!consume_specific(in_object ? '}' : ']'))
+                return fail();
+            m_containers.take_last();
+            return did_consume_value(in_object ? TokenType::ObjectEnd : TokenType::ArrayEnd);
+        }
+
+        case Expect::KeyOrObjectEnd:
+            if (consume_specific('}')) {
+                m_containers.take_last();
+                return did_consume_value(TokenType::ObjectEnd);
+            }
+            [[fallthrough]];
+        case Expect::Key: {
+            if (peek() != '"')
+                return fail();
+            auto key = consume_string(TokenType::Key);
+            if (key.is_error())
+                return key;
+            ignore_while(is_space);
+            if (!consume_specific(':'))
+                return fail();
+            m_expect = Expect::Value;
+            return key;
+        }
+
+        case Expect::ValueOrArrayEnd:
+            if (consume_specific(']')) {
+                m_containers.take_last();
+                return did_consume_value(TokenType::ArrayEnd);
+            }
+            [[fallthrough]];
+        case Expect::Value:
+            switch (peek()) {
+            case '{':
+                ignore();
+                m_containers.append(TokenType::ObjectStart);
+                m_expect = Expect::KeyOrObjectEnd;
+                return TokenType::ObjectStart;
+            case '[':
+                ignore();
+                m_containers.append(TokenType::ArrayStart);
+                m_expect = Expect::ValueOrArrayEnd;
+                return TokenType::ArrayStart;
+            case '"': {
+                auto string = consume_string(TokenType::String);
+                if (string.is_error())
+                    return string;
+                return did_consume_value(string);
+            }
+            case 't':
+                return consume_literal("true", TokenType::True);
+            case 'f':
+                return consume_literal("false", TokenType::False);
+            case 'n':
+                return consume_literal("null", TokenType::Null);
+            default:
+                if (peek() == '-' || is_ascii_digit(peek()))
+                    return consume_number();
+                return fail();
+            }
+        }
+        VERIFY_NOT_REACHED();
+    }
+}
+
+bool JsonPullParser::skip_value(Token const& token)
+{
+    if (token.is_error() || token.is(TokenType::End))
+        return false;
+    if (!token.is(TokenType::ObjectStart) && !token.is(TokenType::ArrayStart))
+        return true;
+    size_t depth = m_containers.size();
+    while (m_containers.size() >= depth) {
+        auto skipped = next();
+        if (skipped.is_error() || skipped.is(TokenType::End))
+            return false;
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/GenericLexer.h>
+#include <AK/Optional.h>
+#include <AK/String.h>
+#include <AK/StringView.h>
+#include <AK/Vector.h>
+
+namespace AK {
+
+// Hands out the tokens of a JSON document one at a time, without building a JsonValue tree or allocating.
+// Strings and numbers are views into the input, so the input has to outlive the tokens.
+class JsonPullParser : private GenericLexer {
+public:
+    enum class TokenType {
+        ObjectStart,
+        ObjectEnd,
+        ArrayStart,
+        ArrayEnd,
+        Key,
+        String,
+        Number,
+        True,
+        False,
+        Null,
+        End,
+        Error,
+    };
+
+    class Token {
+    public:
+        Token() = default;
+        Token(TokenType type, StringView literal = {}, bool has_escapes = false)
+            : m_type(type)
+            , m_literal(literal)
+            , m_has_escapes(has_escapes)
+        {
+        }
+
+        TokenType type() const { return m_type; }
+        bool is(TokenType type) const { return m_type == type; }
+        bool is_error() const { return m_type == TokenType::Error; }
+
+        // Keys and strings including their quotes, and numbers, true, false and null as they appear in the input.
+        StringView literal() const { return m_literal; }
+
+        // The contents of a key or string, which still has its escapes in it if it has any.
+        StringView raw_string() const { return m_literal.substring_view(1, m_literal.length() - 2); }
+        bool has_escapes() const { return m_has_escapes; }
+
+        // Compares the contents of a key or string without allocating, as long as it doesn't have any escapes.
+        bool string_equals(StringView const&) const;
+
+        // Only allocates a new string if there are escapes to be resolved.
+        String to_string() const;
+
+        template<typename T>
+        Optional<T> to_number() const
+        {
+            if (m_type != TokenType::Number)
+                return {};
+            if constexpr (IsSigned<T>)
+                return m_literal.to_int<T>();
+            else
+                return m_literal.to_uint<T>();
+        }
+
+        bool to_bool() const { return m_type == TokenType::True; }
+
+    private:
+        TokenType m_type { TokenType::Error };
+        StringView m_literal;
+        bool m_has_escapes { false };
+    };
+
+    explicit JsonPullParser(StringView const& input)
+        : GenericLexer(input)
+    {
+    }
+
+    // Once this returned End or Error, it keeps on returning it.
+    Token next();
+
+    // Skips everything up to the end of the object or array started by the given token. Any other token is a complete
+    // value already, so there's nothing to skip.
+    bool skip_value(Token const&);
+
+    // Skips the value of the key that was just returned.
+    bool skip_next_value() { return skip_value(next()); }
+
+    size_t depth() const { return m_containers.size(); }
+
+private:
+    enum class Expect {
+        Value,
+        ValueOrArrayEnd,
+        Key,
+        KeyOrObjectEnd,
+        CommaOrEnd,
+        Done,
+        // After an error.
+        Nothing,
+    };
+
+    Token fail();
+    Token did_consume_value(Token);
+    Token consume_string(TokenType);
+    Token consume_number();
+    Token consume_literal(StringView const&, TokenType);
+
+    Vector<TokenType, 16> m_containers;
+    Expect m_expect { Expect::Value };
+};
+
+}
+
+using AK::JsonPullParser;
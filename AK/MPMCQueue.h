@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Noncopyable.h>
+#include <AK/Optional.h>
+#include <AK/StdLibExtras.h>
+
+namespace AK {
+
+// A bounded queue that any number of threads can enqueue to and dequeue from at the same time, without any locking.
+// Every slot has a sequence number that says whose turn it is: a producer that got to claim position n may write
+// to the slot once its sequence number is n, and a consumer may read from it once it's n + 1. Consumers then set
+// it to n + Capacity, handing the slot to the producer that claims it in the next round.
+template<typename T, size_t Capacity>
+class MPMCQueue {
+    AK_MAKE_NONCOPYABLE(MPMCQueue);
+    AK_MAKE_NONMOVABLE(MPMCQueue);
+
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    MPMCQueue()
+    {
+        for (size_t i = 0; i < Capacity; ++i)
+            m_slots[i].sequence.store(i, AK::MemoryOrder::memory_order_relaxed);
+    }
+
+    ~MPMCQueue()
+    {
+        while (try_dequeue().has_value())
+            ;
+    }
+
+    template<typename U = T>
+    [[nodiscard]] bool try_enqueue(U&& value)
+    {
+        auto position = m_enqueue_position.load(AK::MemoryOrder::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &m_slots[position & (Capacity - 1)];
+            auto sequence = slot->sequence.load(AK::MemoryOrder::memory_order_acquire);
+            auto difference = (ssize_t)(sequence - position);
+            if (difference == 0) {
+                if (m_enqueue_position.compare_exchange_strong(position, position + 1, AK::MemoryOrder::memory_order_relaxed))
+                    break;
+            } else if (difference < 0) {
+                // The slot still holds the element from a round ago, so the queue is full.
+                return false;
+            } else {
+                position = m_enqueue_position.load(AK::MemoryOrder::memory_order_relaxed);
+            }
+        }
+        new (slot->storage) T(forward<U>(value));
+        slot->sequence.store(position + 1, AK::MemoryOrder::memory_order_release);
+        return true;
+    }
+
+    [[nodiscard]] Optional<T> try_dequeue()
+    {
+        auto position = m_dequeue_position.load(AK::MemoryOrder::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &m_slots[position & (Capacity - 1)];
+            auto sequence = slot->sequence.load(AK::MemoryOrder::memory_order_acquire);
+            auto difference = (ssize_t)(sequence - (position + 1));
+            if (difference == 0) {
+                if (m_dequeue_position.compare_exchange_strong(position, position + 1, AK::MemoryOrder::memory_order_relaxed))
+                    break;
+            } else if (difference < 0) {
+                // Nothing has been written to the slot yet, so the queue is empty.
+                return {};
+            } else {
+                position = m_dequeue_position.load(AK::MemoryOrder::memory_order_relaxed);
+            }
+        }
+        auto* element = reinterpret_cast<T*>(slot->storage);
+        Optional<T> value = move(*element);
+        element->~T();
+        slot->sequence.store(position + Capacity, AK::MemoryOrder::memory_order_release);
+        return value;
+    }
+
+    // This is only a snapshot when called while other threads use the queue.
+    size_t size() const
+    {
+        auto enqueued = m_enqueue_position.load(AK::MemoryOrder::memory_order_acquire);
+        auto dequeued = m_dequeue_position.load(AK::MemoryOrder::memory_order_acquire);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+    bool is_empty() const { return size() == 0; }
+    constexpr size_t capacity() const { return Capacity; }
+
+private:
+    struct Slot {
+        Atomic<size_t> sequence { 0 };
+        alignas(T) u8 storage[sizeof(T)];
+    };
+
+    alignas(64) Atomic<size_t> m_enqueue_position { 0 };
+    alignas(64) Atomic<size_t> m_dequeue_position { 0 };
+    alignas(64) Slot m_slots[Capacity];
+};
+
+}
+
+using AK::MPMCQueue;
@@ -8,6 +8,7 @@
 
 #include <AK/Array.h>
 #include <AK/Assertions.h>
+#include <AK/ByteSearch.h>
 #include <AK/Span.h>
 #include <AK/Types.h>
 #include <AK/Vector.h>
@@ -114,6 +115,13 @@ static inline Optional<size_t> memmem_optional(const void* haystack, size_t hays
         return {};
     }
 
+    if (needle_length == 1)
+        return find_byte({ haystack, haystack_length }, *(const u8*)needle);
+
+    Optional<size_t> result;
+    if (Detail::vectorized_memmem({ haystack, haystack_length }, { needle, needle_length }, result))
+        return result;
+
     if (needle_length < 32) {
         auto ptr = bitap_bitwise(haystack, haystack_length, needle, needle_length);
         if (ptr)
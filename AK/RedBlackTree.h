@@ -43,6 +43,15 @@ protected:
     BaseRedBlackTree() = default; // These are protected to ensure no one instantiates the leaky base red black tree directly
     virtual ~BaseRedBlackTree() {};
 
+    // Called whenever the children of a node change, so augmented trees can recompute the summary they keep of each subtree.
+    virtual void update_subtree_augmentation(Node*) { }
+
+    void propagate_subtree_augmentation(Node* node)
+    {
+        for (; node; node = node->parent)
+            update_subtree_augmentation(node);
+    }
+
     void rotate_left(Node* subtree_root)
     {
         VERIFY(subtree_root);
@@ -68,6 +77,10 @@ protected:
         } else { // we are the right child
             parent->right_child = pivot;
         }
+
+        // subtree_root is now a child of pivot, so it has to be brought up to date first
+        update_subtree_augmentation(subtree_root);
+        update_subtree_augmentation(pivot);
     }
 
     void rotate_right(Node* subtree_root)
@@ -95,6 +108,10 @@ protected:
         } else { // we are the right child
             parent->right_child = pivot;
         }
+
+        // subtree_root is now a child of pivot, so it has to be brought up to date first
+        update_subtree_augmentation(subtree_root);
+        update_subtree_augmentation(pivot);
     }
 
     static Node* find(Node* node, K key)
@@ -143,6 +160,7 @@ protected:
             m_root = node;
             m_size = 1;
             m_minimum = node;
+            update_subtree_augmentation(node);
             return;
         } else if (node->key < parent->key) { // we are the left child
             parent->left_child = node;
@@ -150,6 +168,7 @@ protected:
             parent->right_child = node;
         }
         node->parent = parent;
+        propagate_subtree_augmentation(node);
 
         if (node->parent->parent) // no fixups to be done for a height <= 2 tree
             insert_fixups(node);
@@ -273,6 +292,9 @@ protected:
             m_root = child;
         }
 
+        // everything that changed is on the path from the unlinked node's parent to the root, and fixup rotations maintain the augmentation themselves
+        propagate_subtree_augmentation(node->parent);
+
         // if the node is red then child must be black, and just replacing the node with its child should result in a valid tree (no change to black height)
         if (node->color != Color::Red)
             remove_fixups(child, node->parent);
@@ -419,7 +441,12 @@ private:
     typename TreeType::Node* m_prev { nullptr };
 };
 
-template<Integral K, typename V>
+// An augmentation keeps a summary of every subtree in its root, which makes searches like
+// "the leftmost node whose value is at least this large" O(log n). It has to provide:
+//     using Type = ...;
+//     static Type value(V const&);     // the summary of a single node
+//     static Type combine(Type, Type); // associative
+template<Integral K, typename V, typename Augmentation = void>
 class RedBlackTree final : public BaseRedBlackTree<K> {
 public:
     RedBlackTree() = default;
@@ -446,6 +473,35 @@ public:
         return &node->value;
     }
 
+    // Returns the value with the smallest key whose augmentation satisfies the predicate.
+    // The predicate must hold for a subtree's summary iff it holds for one of the nodes in it.
+    template<typename Predicate>
+    [[nodiscard]] V* find_smallest_matching_augmentation(Predicate predicate) requires(!IsVoid<Augmentation>)
+    {
+        auto* node = static_cast<Node*>(this->m_root);
+        if (!node || !predicate(node->subtree_augmentation))
+            return nullptr;
+        while (node) {
+            auto* left_child = static_cast<Node*>(node->left_child);
+            if (left_child && predicate(left_child->subtree_augmentation)) {
+                node = left_child;
+                continue;
+            }
+            if (predicate(Augmentation::value(node->value)))
+                return &node->value;
+            node = static_cast<Node*>(node->right_child);
+        }
+        VERIFY_NOT_REACHED();
+    }
+
+    // Must be called after modifying a value in place in a way that changes its augmentation.
+    void update_augmentation(K key) requires(!IsVoid<Augmentation>)
+    {
+        auto* node = BaseTree::find(this->m_root, key);
+        VERIFY(node);
+        BaseTree::propagate_subtree_augmentation(node);
+    }
+
     void insert(K key, const V& value)
     {
         insert(key, V(value));
@@ -526,7 +582,29 @@ public:
     }
 
 private:
-    struct Node : BaseRedBlackTree<K>::Node {
+    virtual void update_subtree_augmentation(typename BaseTree::Node* base_node) override
+    {
+        if constexpr (!IsVoid<Augmentation>) {
+            auto* node = static_cast<Node*>(base_node);
+            auto augmentation = Augmentation::value(node->value);
+            if (node->left_child)
+                augmentation = Augmentation::combine(static_cast<Node*>(node->left_child)->subtree_augmentation, augmentation);
+            if (node->right_child)
+                augmentation = Augmentation::combine(augmentation, static_cast<Node*>(node->right_child)->subtree_augmentation);
+            node->subtree_augmentation = augmentation;
+        }
+    }
+
+    template<typename A>
+    struct SubtreeAugmentation {
+        typename A::Type subtree_augmentation {};
+    };
+
+    struct NoSubtreeAugmentation {
+    };
+
+    struct Node : BaseRedBlackTree<K>::Node
+        , Conditional<IsVoid<Augmentation>, NoSubtreeAugmentation, SubtreeAugmentation<Augmentation>> {
 
         V value;
 
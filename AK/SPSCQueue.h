@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Noncopyable.h>
+#include <AK/Optional.h>
+#include <AK/StdLibExtras.h>
+
+namespace AK {
+
+// A bounded queue that one thread can enqueue to while another one dequeues from, without any locking.
+// Each side keeps a copy of the other side's index and only reloads it once the queue looks full or empty,
+// so the two threads only ever touch each other's cache line when they have to.
+template<typename T, size_t Capacity>
+class SPSCQueue {
+    AK_MAKE_NONCOPYABLE(SPSCQueue);
+    AK_MAKE_NONMOVABLE(SPSCQueue);
+
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SPSCQueue() = default;
+
+    ~SPSCQueue()
+    {
+        while (try_dequeue().has_value())
+            ;
+    }
+
+    // Only to be called by the producer.
+    template<typename U = T>
+    [[nodiscard]] bool try_enqueue(U&& value)
+    {
+        auto tail = m_producer.index.load(AK::MemoryOrder::memory_order_relaxed);
+        if (tail - m_producer.cached_other_index == Capacity) {
+            m_producer.cached_other_index = m_consumer.index.load(AK::MemoryOrder::memory_order_acquire);
+            if (tail - m_producer.cached_other_index == Capacity)
+                return false;
+        }
+        new (slot(tail)) T(forward<U>(value));
+        m_producer.index.store(tail + 1, AK::MemoryOrder::memory_order_release);
+        return true;
+    }
+
+    // Only to be called by the consumer.
+    [[nodiscard]] Optional<T> try_dequeue()
+    {
+        auto head = m_consumer.index.load(AK::MemoryOrder::memory_order_relaxed);
+        if (head == m_consumer.cached_other_index) {
+            m_consumer.cached_other_index = m_producer.index.load(AK::MemoryOrder::memory_order_acquire);
+            if (head == m_consumer.cached_other_index)
+                return {};
+        }
+        auto* element = slot(head);
+        Optional<T> value = move(*element);
+        element->~T();
+        m_consumer.index.store(head + 1, AK::MemoryOrder::memory_order_release);
+        return value;
+    }
+
+    // These are only a snapshot when called while the other side is active.
+    size_t size() const { return m_producer.index.load(AK::MemoryOrder::memory_order_acquire) - m_consumer.index.load(AK::MemoryOrder::memory_order_acquire); }
+    bool is_empty() const { return size() == 0; }
+    constexpr size_t capacity() const { return Capacity; }
+
+private:
+    T* slot(size_t index) { return reinterpret_cast<T*>(m_storage) + (index & (Capacity - 1)); }
+
+    // The index that only this side writes to, and what it last saw of the other side's.
+    struct alignas(64) Side {
+        Atomic<size_t> index { 0 };
+        size_t cached_other_index { 0 };
+    };
+
+    Side m_producer;
+    Side m_consumer;
+    alignas(T) u8 m_storage[sizeof(T) * Capacity];
+};
+
+}
+
+using AK::SPSCQueue;
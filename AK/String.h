@@ -268,7 +268,7 @@ public:
     template<typename... Parameters>
     [[nodiscard]] static String formatted(CheckedFormatString<Parameters...>&& fmtstr, const Parameters&... parameters)
     {
-        return vformatted(fmtstr.view(), VariadicFormatParams { parameters... });
+        return vformatted(fmtstr.view(), VariadicFormatParams { fmtstr, parameters... });
     }
 
     template<typename T>
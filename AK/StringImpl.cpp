@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
 #include <AK/CharacterTypes.h>
 #include <AK/FlyString.h>
 #include <AK/HashTable.h>
@@ -33,7 +34,7 @@ StringImpl::StringImpl(ConstructWithInlineBufferTag, size_t length)
 
 StringImpl::~StringImpl()
 {
-    if (m_fly)
+    if (is_fly())
         FlyString::did_destroy_impl({}, *this);
 }
 
@@ -48,6 +49,26 @@ NonnullRefPtr<StringImpl> StringImpl::create_uninitialized(size_t length, char*&
     return new_stringimpl;
 }
 
+static Atomic<StringImpl*> s_single_character_stringimpls[256];
+
+// Strings of a single character are common enough, e.g. as separators or the parts of split
+// strings, that there is only ever one impl for each of them, just like for the empty string.
+static StringImpl& single_character_stringimpl(char ch)
+{
+    auto& slot = s_single_character_stringimpls[(u8)ch];
+    if (auto* stringimpl = slot.load(AK::MemoryOrder::memory_order_acquire))
+        return *stringimpl;
+
+    char* buffer;
+    auto new_stringimpl = StringImpl::create_uninitialized(1, buffer);
+    buffer[0] = ch;
+    // If another thread got there first, its impl is used and ours is freed again.
+    StringImpl* stringimpl = nullptr;
+    if (slot.compare_exchange_strong(stringimpl, new_stringimpl.ptr(), AK::MemoryOrder::memory_order_acq_rel))
+        return new_stringimpl.leak_ref();
+    return *stringimpl;
+}
+
 RefPtr<StringImpl> StringImpl::create(const char* cstring, size_t length, ShouldChomp should_chomp)
 {
     if (!cstring)
@@ -65,6 +86,8 @@ RefPtr<StringImpl> StringImpl::create(const char* cstring, size_t length, Should
 
     if (!length)
         return the_empty_stringimpl();
+    if (length == 1)
+        return single_character_stringimpl(cstring[0]);
 
     char* buffer;
     auto new_stringimpl = create_uninitialized(length, buffer);
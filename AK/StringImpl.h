@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
 #include <AK/Badge.h>
 #include <AK/RefCounted.h>
 #include <AK/RefPtr.h>
@@ -75,8 +76,8 @@ public:
         return m_hash;
     }
 
-    bool is_fly() const { return m_fly; }
-    void set_fly(Badge<FlyString>, bool fly) const { m_fly = fly; }
+    bool is_fly() const { return m_fly.load(AK::MemoryOrder::memory_order_relaxed); }
+    void set_fly(Badge<FlyString>, bool fly) const { m_fly.store(fly, AK::MemoryOrder::memory_order_relaxed); }
 
 private:
     enum ConstructTheEmptyStringImplTag {
@@ -98,7 +99,7 @@ private:
     size_t m_length { 0 };
     mutable unsigned m_hash { 0 };
     mutable bool m_has_hash { false };
-    mutable bool m_fly { false };
+    mutable Atomic<bool> m_fly { false };
     char m_inline_buffer[0];
 };
 
@@ -5,6 +5,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ByteSearch.h>
 #include <AK/CharacterTypes.h>
 #include <AK/MemMem.h>
 #include <AK/Memory.h>
@@ -325,11 +326,8 @@ Optional<size_t> find(StringView const& haystack, char needle, size_t start)
 {
     if (start >= haystack.length())
         return {};
-    for (size_t i = start; i < haystack.length(); ++i) {
-        if (haystack[i] == needle)
-            return i;
-    }
-    return {};
+    auto index = find_byte(haystack.bytes().slice(start), needle);
+    return index.has_value() ? (*index + start) : index;
 }
 
 Optional<size_t> find(StringView const& haystack, StringView const& needle, size_t start)
@@ -6,6 +6,7 @@
  */
 
 #include <AK/Assertions.h>
+#include <AK/ByteSearch.h>
 #include <AK/Format.h>
 #include <AK/Utf8View.h>
 
@@ -126,6 +127,14 @@ bool Utf8View::validate(size_t& valid_bytes) const
 {
     valid_bytes = 0;
     for (auto ptr = begin_ptr(); ptr < end_ptr(); ptr++) {
+        // Most text is mostly ASCII, so we skip over that in bulk.
+        if (*ptr < 0x80) {
+            auto ascii_bytes = count_leading_ascii_bytes({ ptr, (size_t)(end_ptr() - ptr) });
+            valid_bytes += ascii_bytes;
+            ptr += ascii_bytes - 1;
+            continue;
+        }
+
         size_t code_point_length_in_bytes;
         u32 value;
         bool first_byte_makes_sense = decode_first_byte(*ptr, code_point_length_in_bytes, value);
@@ -16,6 +16,7 @@
 #include <AK/StdLibExtras.h>
 #include <AK/Traits.h>
 #include <AK/TypedTransfer.h>
+#include <AK/VectorInstrumentation.h>
 #include <AK/kmalloc.h>
 
 // NOTE: We can't include <initializer_list> during the toolchain bootstrap,
@@ -60,13 +61,26 @@ private:
 
 public:
     using ValueType = T;
+#ifdef AK_VECTOR_GROWTH_INSTRUMENTATION
+    Vector(VectorInstrumentation::Location location = VectorInstrumentation::Location::current())
+        : m_capacity(inline_capacity)
+        , m_instrumentation_site(VectorInstrumentation::did_construct(location, inline_capacity, sizeof(StorageType)))
+    {
+    }
+#else
     Vector()
         : m_capacity(inline_capacity)
     {
     }
+#endif
 
 #ifndef SERENITY_LIBC_BUILD
+#    ifdef AK_VECTOR_GROWTH_INSTRUMENTATION
+    Vector(std::initializer_list<T> list, VectorInstrumentation::Location location = VectorInstrumentation::Location::current()) requires(!IsLvalueReference<T>)
+        : m_instrumentation_site(VectorInstrumentation::did_construct(location, inline_capacity, sizeof(StorageType)))
+#    else
     Vector(std::initializer_list<T> list) requires(!IsLvalueReference<T>)
+#    endif
     {
         ensure_capacity(list.size());
         for (auto& item : list)
@@ -78,6 +92,9 @@ public:
         : m_size(other.m_size)
         , m_capacity(other.m_capacity)
         , m_outline_buffer(other.m_outline_buffer)
+#ifdef AK_VECTOR_GROWTH_INSTRUMENTATION
+        , m_instrumentation_site(exchange(other.m_instrumentation_site, 0))
+#endif
     {
         if constexpr (inline_capacity > 0) {
             if (!m_outline_buffer) {
@@ -92,7 +109,12 @@ public:
         other.reset_capacity();
     }
 
+#ifdef AK_VECTOR_GROWTH_INSTRUMENTATION
+    Vector(Vector const& other, VectorInstrumentation::Location location = VectorInstrumentation::Location::current())
+        : m_instrumentation_site(VectorInstrumentation::did_construct(location, inline_capacity, sizeof(StorageType)))
+#else
     Vector(Vector const& other)
+#endif
     {
         ensure_capacity(other.size());
         TypedTransfer<StorageType>::copy(data(), other.data(), other.size());
@@ -100,7 +122,12 @@ public:
     }
 
     template<size_t other_inline_capacity>
+#ifdef AK_VECTOR_GROWTH_INSTRUMENTATION
+    Vector(Vector<T, other_inline_capacity> const& other, VectorInstrumentation::Location location = VectorInstrumentation::Location::current())
+        : m_instrumentation_site(VectorInstrumentation::did_construct(location, inline_capacity, sizeof(StorageType)))
+#else
     Vector(Vector<T, other_inline_capacity> const& other)
+#endif
     {
         ensure_capacity(other.size());
         TypedTransfer<StorageType>::copy(data(), other.data(), other.size());
@@ -109,6 +136,9 @@ public:
 
     ~Vector()
     {
+#ifdef AK_VECTOR_GROWTH_INSTRUMENTATION
+        VectorInstrumentation::did_destroy(m_instrumentation_site, m_size);
+#endif
         clear();
     }
 
@@ -317,6 +347,10 @@ public:
             other.m_outline_buffer = nullptr;
             other.m_size = 0;
             other.reset_capacity();
+#ifdef AK_VECTOR_GROWTH_INSTRUMENTATION
+            // The contents are what's interesting about a Vector, and they live on in this one.
+            other.m_instrumentation_site = 0;
+#endif
         }
         return *this;
     }
@@ -635,6 +669,9 @@ public:
                 at(i).~StorageType();
             }
         }
+#ifdef AK_VECTOR_GROWTH_INSTRUMENTATION
+        VectorInstrumentation::did_allocate(m_instrumentation_site, !m_outline_buffer);
+#endif
         if (m_outline_buffer)
             kfree_sized(m_outline_buffer, m_capacity * sizeof(StorageType));
         m_outline_buffer = new_buffer;
@@ -780,6 +817,9 @@ private:
 
     alignas(StorageType) unsigned char m_inline_buffer_storage[sizeof(StorageType) * inline_capacity];
     StorageType* m_outline_buffer { nullptr };
+#ifdef AK_VECTOR_GROWTH_INSTRUMENTATION
+    VectorInstrumentation::SiteIndex m_instrumentation_site { 0 };
+#endif
 };
 
 template<class... Args>
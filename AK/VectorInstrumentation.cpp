@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/VectorInstrumentation.h>
+
+#ifdef AK_VECTOR_GROWTH_INSTRUMENTATION
+#    include <AK/Atomic.h>
+#    include <AK/StdLibExtras.h>
+#    include <stdio.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+
+namespace AK::VectorInstrumentation {
+
+// Final sizes are counted in power-of-two buckets: 0, 1, 2-3, 4-7, and so on, with the last one taking everything larger.
+static constexpr size_t size_bucket_count = 17;
+
+struct Site {
+    enum class State : u8 {
+        Empty,
+        Claiming,
+        Ready,
+    };
+
+    // Vectors are created and destroyed from all threads and before anything else is set up, so the sites live in a
+    // fixed table that is only ever appended to, and that never allocates (let alone creates a Vector).
+    Atomic<State> state { State::Empty };
+    const char* file { nullptr };
+    u32 line { 0 };
+    u32 inline_capacity { 0 };
+    u32 element_size { 0 };
+
+    Atomic<u64> constructed { 0 };
+    Atomic<u64> destroyed { 0 };
+    Atomic<u64> allocations { 0 };
+    Atomic<u64> spilled { 0 };
+    Atomic<u64> max_size { 0 };
+    Atomic<u64> final_sizes[size_bucket_count] {};
+
+    bool matches(Location location, size_t inline_capacity_, size_t element_size_) const
+    {
+        return file == location.file && line == location.line && inline_capacity == inline_capacity_ && element_size == element_size_;
+    }
+};
+
+static constexpr size_t site_capacity = 4096;
+static Site s_sites[site_capacity];
+
+static Site* site_for(SiteIndex index)
+{
+    return index ? &s_sites[index - 1] : nullptr;
+}
+
+SiteIndex did_construct(Location location, size_t inline_capacity, size_t element_size)
+{
+    auto hash = (FlatPtr)location.file ^ (location.line * 2654435761u) ^ (inline_capacity << 16) ^ element_size;
+    for (size_t probe = 0; probe < site_capacity; ++probe) {
+        size_t index = (hash + probe) % site_capacity;
+        auto& site = s_sites[index];
+        auto state = site.state.load(AK::MemoryOrder::memory_order_acquire);
+        if (state == Site::State::Empty) {
+            if (site.state.compare_exchange_strong(state, Site::State::Claiming, AK::MemoryOrder::memory_order_acquire)) {
+                site.file = location.file;
+                site.line = location.line;
+                site.inline_capacity = inline_capacity;
+                site.element_size = element_size;
+                site.state.store(Site::State::Ready, AK::MemoryOrder::memory_order_release);
+            }
+        }
+        // Someone else is filling in this site, and it might turn out to be ours.
+        while (state == Site::State::Claiming)
+            state = site.state.load(AK::MemoryOrder::memory_order_acquire);
+        if (site.matches(location, inline_capacity, element_size)) {
+            site.constructed.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+            return index + 1;
+        }
+    }
+    return 0;
+}
+
+void did_allocate(SiteIndex index, bool is_first_allocation)
+{
+    auto* site = site_for(index);
+    if (!site)
+        return;
+    site->allocations.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+    if (is_first_allocation)
+        site->spilled.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+}
+
+void did_destroy(SiteIndex index, size_t size)
+{
+    auto* site = site_for(index);
+    if (!site)
+        return;
+    site->destroyed.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+    size_t bucket = size ? min<size_t>(64 - __builtin_clzll(size), size_bucket_count - 1) : 0;
+    site->final_sizes[bucket].fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+    auto max_size = site->max_size.load(AK::MemoryOrder::memory_order_relaxed);
+    while (size > max_size && !site->max_size.compare_exchange_strong(max_size, size, AK::MemoryOrder::memory_order_relaxed))
+        ;
+}
+
+[[gnu::destructor]] static void write_report()
+{
+    mkdir("/tmp/vector-growth", 0777);
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/vector-growth/%d", getpid());
+    auto* file = fopen(path, "w");
+    if (!file)
+        return;
+
+    fprintf(file, "# file\tline\tinline_capacity\telement_size\tconstructed\tdestroyed\tallocations\tspilled\tmax_size\tfinal_sizes...\n");
+    for (auto& site : s_sites) {
+        if (site.state.load(AK::MemoryOrder::memory_order_acquire) != Site::State::Ready)
+            continue;
+        fprintf(file, "%s\t%u\t%u\t%u\t%llu\t%llu\t%llu\t%llu\t%llu", site.file, site.line, site.inline_capacity, site.element_size,
+            (unsigned long long)site.constructed.load(), (unsigned long long)site.destroyed.load(),
+            (unsigned long long)site.allocations.load(), (unsigned long long)site.spilled.load(),
+            (unsigned long long)site.max_size.load());
+        for (auto& count : site.final_sizes)
+            fprintf(file, "\t%llu", (unsigned long long)count.load());
+        fputc('\n', file);
+    }
+    fclose(file);
+}
+
+}
+#endif
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+// With ENABLE_VECTOR_GROWTH_INSTRUMENTATION, every Vector remembers where it was declared, and each of these
+// places keeps count of how often its Vectors had to allocate and how large they were when they got destroyed.
+// Every process writes these counts to /tmp/vector-growth/<pid> when it exits, and Meta/vector-growth-report.py
+// sums them up to show which Vectors could do with a (larger) inline capacity.
+#if defined(ENABLE_VECTOR_GROWTH_INSTRUMENTATION) && !defined(KERNEL) && !defined(_DYNAMIC_LOADER)
+#    define AK_VECTOR_GROWTH_INSTRUMENTATION
+#endif
+
+#ifdef AK_VECTOR_GROWTH_INSTRUMENTATION
+namespace AK::VectorInstrumentation {
+
+struct Location {
+    static constexpr Location current(const char* file = __builtin_FILE(), u32 line = __builtin_LINE()) { return { file, line }; }
+
+    const char* file { nullptr };
+    u32 line { 0 };
+};
+
+// 0 stands for a Vector that isn't counted, either because it was moved from or because there were too many places.
+using SiteIndex = u32;
+
+SiteIndex did_construct(Location, size_t inline_capacity, size_t element_size);
+void did_allocate(SiteIndex, bool is_first_allocation);
+void did_destroy(SiteIndex, size_t size);
+
+}
+#endif
@@ -295,6 +295,69 @@ struct [[gnu::packed]] MADT {
     MADTEntryHeader entries[];
 };
 
+// https://uefi.org/specs/ACPI/6.4/05_ACPI_Software_Programming_Model/ACPI_Software_Programming_Model.html#system-resource-affinity-table-srat
+enum class SRATEntryType {
+    ProcessorLocalAPICAffinity = 0x0,
+    MemoryAffinity = 0x1,
+    ProcessorLocalx2APICAffinity = 0x2,
+    GICCAffinity = 0x3,
+    GICITSAffinity = 0x4,
+    GenericInitiatorAffinity = 0x5
+};
+
+struct [[gnu::packed]] SRATEntryHeader {
+    u8 type;
+    u8 length;
+};
+
+namespace SRATEntries {
+
+static constexpr u32 AFFINITY_ENABLED_FLAG = 1 << 0;
+
+// https://uefi.org/specs/ACPI/6.4/05_ACPI_Software_Programming_Model/ACPI_Software_Programming_Model.html#processor-local-apic-sapic-affinity-structure
+struct [[gnu::packed]] ProcessorLocalAPICAffinity {
+    SRATEntryHeader h;
+    u8 proximity_domain_low;
+    u8 apic_id;
+    u32 flags;
+    u8 local_sapic_eid;
+    u8 proximity_domain_high[3];
+    u32 clock_domain;
+};
+
+// https://uefi.org/specs/ACPI/6.4/05_ACPI_Software_Programming_Model/ACPI_Software_Programming_Model.html#memory-affinity-structure
+struct [[gnu::packed]] MemoryAffinity {
+    SRATEntryHeader h;
+    u32 proximity_domain;
+    u16 reserved1;
+    u32 base_address_low;
+    u32 base_address_high;
+    u32 length_low;
+    u32 length_high;
+    u32 reserved2;
+    u32 flags;
+    u64 reserved3;
+};
+
+// https://uefi.org/specs/ACPI/6.4/05_ACPI_Software_Programming_Model/ACPI_Software_Programming_Model.html#processor-local-x2apic-affinity-structure
+struct [[gnu::packed]] ProcessorLocalx2APICAffinity {
+    SRATEntryHeader h;
+    u16 reserved1;
+    u32 proximity_domain;
+    u32 x2apic_id;
+    u32 flags;
+    u32 clock_domain;
+    u32 reserved2;
+};
+}
+
+struct [[gnu::packed]] SRAT {
+    SDTHeader h;
+    u32 table_revision;
+    u64 reserved;
+    SRATEntryHeader entries[];
+};
+
 struct [[gnu::packed]] AMLTable {
     SDTHeader h;
     char aml_code[];
@@ -0,0 +1,16 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+// Reading from /dev/mempressure yields one of these as a u32.
+enum class MemoryPressureLevel : u32 {
+    None = 0,
+    Low = 1,
+    Critical = 2,
+};
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+// The kernel writes perfcore files in a binary format: the magic and the version, followed by a stream of
+// records that each start with their PerfcoreRecordType. Numbers are unsigned LEB128 varints, and strings
+// are their length followed by that many bytes. Records only ever refer back to stacks and strings that
+// came before them, so files can be written and read in a single pass.
+//
+// Stack:  The number of frames, then their addresses, innermost first. Stacks are numbered from 0.
+// String: Used by events for names and paths. Strings are numbered from 0 as well.
+// Event:  type (PERF_EVENT_*), pid, tid, milliseconds since the previous event (zigzag-encoded, events from
+//         different processors don't arrive in order), lost samples and the stack id, followed by:
+//         - malloc, munmap, kmalloc, kfree: address, size
+//         - free: address
+//         - mmap: address, size, name string id
+//         - process_create: parent pid, executable string id
+//         - process_exec: executable string id
+//         - thread_create: parent tid
+//         - context_switch: next pid, next tid
+//         - pmc_sample: counter, an index into perfcore_pmc_counter_names
+//
+// Profiler still reads the JSON format perfcore files used to be in.
+
+static constexpr char perfcore_magic[] = { 'P', 'E', 'R', 'F', 'C', 'O', 'R', 'E' };
+static constexpr u8 perfcore_version = 1;
+
+enum class PerfcoreRecordType : u8 {
+    Stack = 1,
+    String = 2,
+    Event = 3,
+};
+
+// In the order of the PERF_EVENT_PMC_* flags.
+static constexpr const char* perfcore_pmc_counter_names[] = { "cycles", "cache_misses", "branch_misses", "llc_loads" };
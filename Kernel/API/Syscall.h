@@ -16,6 +16,8 @@
 constexpr int syscall_vector = 0x82;
 
 extern "C" {
+struct epoll_event;
+struct mmsghdr;
 struct pollfd;
 struct timeval;
 struct timespec;
@@ -194,7 +196,21 @@ enum class NeedsBigProcessLock {
     S(emuctl, NeedsBigProcessLock::Yes)                     \
     S(statvfs, NeedsBigProcessLock::Yes)                    \
     S(fstatvfs, NeedsBigProcessLock::Yes)                   \
-    S(kill_thread, NeedsBigProcessLock::Yes)
+    S(kill_thread, NeedsBigProcessLock::Yes)                \
+    S(sched_setattr, NeedsBigProcessLock::Yes)              \
+    S(sched_getattr, NeedsBigProcessLock::Yes)              \
+    S(posix_spawn, NeedsBigProcessLock::Yes)                \
+    S(map_time_page, NeedsBigProcessLock::Yes)              \
+    S(posix_fadvise, NeedsBigProcessLock::Yes)              \
+    S(sendfile, NeedsBigProcessLock::Yes)                   \
+    S(splice, NeedsBigProcessLock::Yes)                     \
+    S(get_dir_entries_with_stat, NeedsBigProcessLock::Yes)  \
+    S(epoll_create, NeedsBigProcessLock::Yes)               \
+    S(epoll_ctl, NeedsBigProcessLock::Yes)                  \
+    S(epoll_wait, NeedsBigProcessLock::Yes)                 \
+    S(accept4_batch, NeedsBigProcessLock::Yes)              \
+    S(sendmmsg, NeedsBigProcessLock::Yes)                   \
+    S(recvmmsg, NeedsBigProcessLock::Yes)
 
 namespace Syscall {
 
@@ -293,6 +309,20 @@ struct SC_accept4_params {
     int flags;
 };
 
+struct SC_accept4_batch_params {
+    int sockfd;
+    int* fds;
+    size_t count;
+    int flags;
+};
+
+struct SC_mmsg_params {
+    int sockfd;
+    struct mmsghdr* msgs;
+    unsigned message_count;
+    int flags;
+};
+
 struct SC_getsockopt_params {
     int sockfd;
     int level;
@@ -395,6 +425,74 @@ struct SC_execve_params {
     StringListArgument environment;
 };
 
+enum class PosixSpawnFileActionType : int {
+    Open,
+    Close,
+    Dup2,
+    Chdir,
+    Fchdir,
+};
+
+struct SC_posix_spawn_file_action {
+    PosixSpawnFileActionType type;
+    int fd;
+    int new_fd;
+    int options;
+    u16 mode;
+    StringArgument path;
+};
+
+struct SC_posix_spawn_params {
+    StringArgument path;
+    StringListArgument arguments;
+    StringListArgument environment;
+    const SC_posix_spawn_file_action* file_actions;
+    size_t file_action_count;
+    int flags;
+    pid_t pgroup;
+    int sched_priority;
+    u32 sigdefault;
+    u32 sigmask;
+};
+
+struct SC_posix_fadvise_params {
+    int fd;
+    i64 offset;
+    i64 len;
+    int advice;
+};
+
+struct SC_sendfile_params {
+    int out_fd;
+    int in_fd;
+    i64* offset;
+    size_t count;
+};
+
+struct SC_splice_params {
+    int fd_in;
+    i64* off_in;
+    int fd_out;
+    i64* off_out;
+    size_t len;
+    unsigned flags;
+};
+
+struct SC_epoll_ctl_params {
+    int epfd;
+    int op;
+    int fd;
+    struct epoll_event* event;
+};
+
+struct SC_epoll_wait_params {
+    int epfd;
+    struct epoll_event* events;
+    int maxevents;
+    const struct timespec* timeout;
+    const u32* sigmask;
+};
+
 struct SC_readlink_params {
     StringArgument path;
     MutableBufferArgument<char, size_t> buffer;
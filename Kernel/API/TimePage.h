@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+#ifdef KERNEL
+#    include <Kernel/UnixTypes.h>
+#else
+#    include <time.h>
+#endif
+
+namespace Kernel {
+
+// Only the coarse clocks can be read from the time page, the precise ones have to query a hardware timer.
+inline bool time_page_supports(clockid_t clock_id)
+{
+    return clock_id == CLOCK_REALTIME_COARSE || clock_id == CLOCK_MONOTONIC_COARSE;
+}
+
+// The kernel increments update2 before and stores the same value to update1 after changing the clocks,
+// so a reader that loads update1, then the clocks, then update2 and sees the same value in both got a consistent copy.
+struct TimePage {
+    volatile u32 update1;
+    struct timespec clocks[CLOCK_ID_COUNT];
+    volatile u32 update2;
+};
+
+}
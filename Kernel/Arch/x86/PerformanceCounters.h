@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/Types.h>
+
+namespace Kernel {
+
+struct RegisterState;
+class Thread;
+
+// The events we can take samples of, in the same order as their PERF_EVENT_PMC_* flags.
+enum class PerformanceCounterEvent : u8 {
+    Cycles,
+    CacheMisses,
+    BranchMisses,
+    LastLevelCacheLoads,
+    __Count,
+};
+
+static constexpr size_t performance_counter_event_count = (size_t)PerformanceCounterEvent::__Count;
+
+// What the counters of a thread were at when it was last switched out, so every thread only
+// counts its own events no matter which processor it runs on or who ran there in between.
+struct PerformanceCounterState {
+    Array<u32, performance_counter_event_count> values {};
+    u32 configuration { 0 };
+    bool is_running { false };
+};
+
+// Takes samples of the current thread every so many cycles, cache misses etc., using the
+// architectural performance monitoring counters of Intel CPUs.
+class PerformanceCounters {
+public:
+    static void initialize();
+    static bool is_supported();
+
+    // Starts counting those of the events from the PERF_EVENT_PMC_* flags in the mask that the CPU supports,
+    // and returns which ones those were. Every call has to be paired with a call to disable().
+    static u64 enable(u64 event_mask);
+    static void disable();
+
+    // Called with interrupts disabled right before the processor switches to another thread.
+    static void switch_threads(Thread& from, Thread& to);
+    static void handle_overflow_interrupt(const RegisterState&);
+};
+
+}
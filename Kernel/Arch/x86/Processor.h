@@ -26,6 +26,9 @@ struct ProcessorMessageEntry;
 enum class ProcessorSpecificDataID {
     MemoryManager,
     Scheduler,
+    KmallocCache,
+    SlabCacheMagazines,
+    Tracepoints,
     __Count,
 };
 
@@ -133,6 +136,10 @@ class Processor {
     ProcessorInfo* m_info;
     Thread* m_current_thread;
     Thread* m_idle_thread;
+    // The thread whose FPU state was last loaded into this processor's FPU.
+    Thread* m_fpu_owner;
+    // The page directory currently loaded on this processor, or 0 if unknown.
+    Atomic<FlatPtr> m_active_cr3;
 
     Atomic<ProcessorMessageEntry*> m_message_queue;
 
@@ -190,6 +197,11 @@ public:
         s_idle_cpu_mask.fetch_and(~(1u << m_cpu), AK::MemoryOrder::memory_order_relaxed);
     }
 
+    static u32 idle_cpu_mask()
+    {
+        return s_idle_cpu_mask.load(AK::MemoryOrder::memory_order_relaxed);
+    }
+
     static u32 count()
     {
         // NOTE: because this value never changes once all APs are booted,
@@ -212,6 +224,7 @@ public:
 
     static void flush_tlb_local(VirtualAddress vaddr, size_t page_count);
     static void flush_tlb(const PageDirectory*, VirtualAddress, size_t);
+    static void load_cr3(FlatPtr);
 
     Descriptor& get_gdt_entry(u16 selector);
     void flush_gdt();
@@ -387,11 +400,15 @@ public:
         return s_clean_fpu_state;
     }
 
+    bool fpu_holds_state_of(Thread const&) const;
+    void load_fpu_state_of_current_thread();
+
     static void smp_enable();
     bool smp_process_pending_messages();
 
     static void smp_unicast(u32 cpu, Function<void()>, bool async);
     static void smp_broadcast_flush_tlb(const PageDirectory*, VirtualAddress, size_t);
+    static void smp_multicast_message(u32 cpu_mask, ProcessorMessage& msg);
     static u32 smp_wake_n_idle_processors(u32 wake_count);
 
     static void deferred_call_queue(Function<void()> callback);
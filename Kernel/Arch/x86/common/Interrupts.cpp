@@ -257,9 +257,9 @@ void general_protection_fault_handler(TrapFrame* trap)
 EH_ENTRY_NO_CODE(7, fpu_exception);
 void fpu_exception_handler(TrapFrame*)
 {
-    // Just clear the TS flag. We've already restored the FPU state eagerly.
-    // FIXME: It would be nice if we didn't have to do this at all.
-    asm volatile("clts");
+    // The current thread is using the FPU for the first time since it was
+    // switched in, give it its FPU state back.
+    Processor::current().load_fpu_state_of_current_thread();
 }
 
 // 14: Page Fault
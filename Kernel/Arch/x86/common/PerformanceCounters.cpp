@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <Kernel/Arch/x86/CPUID.h>
+#include <Kernel/Arch/x86/MSR.h>
+#include <Kernel/Arch/x86/PerformanceCounters.h>
+#include <Kernel/PerformanceManager.h>
+#include <Kernel/Sections.h>
+#include <Kernel/SpinLock.h>
+#include <Kernel/Thread.h>
+#include <Kernel/UnixTypes.h>
+
+#define MSR_IA32_PMC0 0xc1
+#define MSR_IA32_PERFEVTSEL0 0x186
+#define MSR_IA32_PERF_GLOBAL_CTRL 0x38f
+#define MSR_IA32_PERF_GLOBAL_OVF_CTRL 0x390
+
+#define PERFEVTSEL_USR (1 << 16)
+#define PERFEVTSEL_OS (1 << 17)
+#define PERFEVTSEL_INT (1 << 20)
+#define PERFEVTSEL_EN (1 << 22)
+
+namespace Kernel {
+
+struct PerformanceCounterEventInfo {
+    u8 event_select;
+    u8 unit_mask;
+    // The bit of CPUID.0AH:EBX that is set if the CPU can't count the event.
+    u8 unavailable_bit;
+    // How many events there are between two samples. The counters are reloaded with the negated
+    // period, which has to fit into 32 bits as the upper bits are sign-extended on writes.
+    u32 sampling_period;
+};
+
+static constexpr PerformanceCounterEventInfo s_events[performance_counter_event_count] = {
+    { 0x3c, 0x00, 0, 1'000'000 },
+    { 0x2e, 0x41, 4, 10'000 },
+    { 0xc5, 0x00, 6, 10'000 },
+    { 0x2e, 0x4f, 3, 10'000 },
+};
+
+READONLY_AFTER_INIT static u8 s_version;
+READONLY_AFTER_INIT static u8 s_counter_count;
+READONLY_AFTER_INIT static u8 s_counter_width;
+READONLY_AFTER_INIT static u8 s_available_events;
+
+static SpinLock<u8> s_lock;
+static size_t s_enable_count;
+static u32 s_generation;
+// The events that are being counted in the lowest byte, and how often that has changed above it.
+static Atomic<u32> s_configuration;
+
+static constexpr u32 configuration_events_mask = 0xff;
+
+UNMAP_AFTER_INIT void PerformanceCounters::initialize()
+{
+    if (CPUID(0).eax() < 0xa)
+        return;
+    CPUID cpuid(0xa);
+    s_version = cpuid.eax() & 0xff;
+    s_counter_width = (cpuid.eax() >> 16) & 0xff;
+    if (!s_version || s_counter_width < 32)
+        return;
+    s_counter_count = min((cpuid.eax() >> 8) & 0xff, performance_counter_event_count);
+    u8 available_bits = (cpuid.eax() >> 24) & 0xff;
+    for (size_t i = 0; i < performance_counter_event_count; ++i) {
+        auto bit = s_events[i].unavailable_bit;
+        if (bit < available_bits && !(cpuid.ebx() & (1 << bit)))
+            s_available_events |= 1 << i;
+    }
+    dmesgln("PerformanceCounters: Version {}, {} counters with {} bits, events: {:#x}", s_version, s_counter_count, s_counter_width, s_available_events);
+}
+
+bool PerformanceCounters::is_supported()
+{
+    return s_counter_count && s_available_events;
+}
+
+u64 PerformanceCounters::enable(u64 event_mask)
+{
+    ScopedSpinLock lock(s_lock);
+    ++s_enable_count;
+    u32 events = 0;
+    size_t counters_used = 0;
+    for (size_t i = 0; i < performance_counter_event_count && counters_used < s_counter_count; ++i) {
+        if ((event_mask & (PERF_EVENT_PMC_CYCLES << i)) && (s_available_events & (1 << i))) {
+            events |= 1 << i;
+            ++counters_used;
+        }
+    }
+    s_configuration.store((++s_generation << 8) | events);
+    return (u64)events * PERF_EVENT_PMC_CYCLES;
+}
+
+void PerformanceCounters::disable()
+{
+    ScopedSpinLock lock(s_lock);
+    if (!s_enable_count || --s_enable_count)
+        return;
+    s_configuration.store(++s_generation << 8);
+}
+
+template<typename Callback>
+static void for_each_event(u32 configuration, Callback callback)
+{
+    size_t counter = 0;
+    for (size_t i = 0; i < performance_counter_event_count; ++i) {
+        if (configuration & (1u << i))
+            callback(counter++, i);
+    }
+}
+
+static bool should_count(Thread& thread)
+{
+    if (thread.is_idle_thread() || thread.is_profiling_suppressed())
+        return false;
+    return g_profiling_all_threads || thread.process().is_profiling();
+}
+
+static void save_counters(PerformanceCounterState& state)
+{
+    if (s_version >= 2)
+        MSR(MSR_IA32_PERF_GLOBAL_CTRL).set(0);
+    for_each_event(state.configuration, [&](size_t counter, size_t) {
+        MSR(MSR_IA32_PERFEVTSEL0 + counter).set(0);
+        state.values[counter] = MSR(MSR_IA32_PMC0 + counter).get();
+    });
+    state.is_running = false;
+}
+
+static void load_counters(PerformanceCounterState& state, u32 configuration)
+{
+    if (state.configuration != configuration) {
+        state.configuration = configuration;
+        for_each_event(configuration, [&](size_t counter, size_t event) {
+            state.values[counter] = -s_events[event].sampling_period;
+        });
+    }
+    u64 enabled_counters = 0;
+    for_each_event(configuration, [&](size_t counter, size_t event) {
+        MSR(MSR_IA32_PMC0 + counter).set(state.values[counter]);
+        MSR(MSR_IA32_PERFEVTSEL0 + counter).set(s_events[event].event_select | (s_events[event].unit_mask << 8) | PERFEVTSEL_USR | PERFEVTSEL_OS | PERFEVTSEL_INT | PERFEVTSEL_EN);
+        enabled_counters |= 1ull << counter;
+    });
+    if (s_version >= 2)
+        MSR(MSR_IA32_PERF_GLOBAL_CTRL).set(enabled_counters);
+    state.is_running = true;
+}
+
+void PerformanceCounters::switch_threads(Thread& from, Thread& to)
+{
+    auto& from_state = from.performance_counter_state();
+    if (from_state.is_running)
+        save_counters(from_state);
+    auto configuration = s_configuration.load(AK::MemoryOrder::memory_order_relaxed);
+    if (!(configuration & configuration_events_mask) || !should_count(to))
+        return;
+    load_counters(to.performance_counter_state(), configuration);
+}
+
+void PerformanceCounters::handle_overflow_interrupt(const RegisterState& regs)
+{
+    auto* current_thread = Thread::current();
+    if (!current_thread || !current_thread->performance_counter_state().is_running)
+        return;
+    auto& state = current_thread->performance_counter_state();
+
+    auto configuration = s_configuration.load(AK::MemoryOrder::memory_order_relaxed);
+    if (configuration != state.configuration) {
+        // Profiling was stopped or changed since this thread was switched in, so the counters have to be set up again.
+        save_counters(state);
+        if ((configuration & configuration_events_mask) && should_count(*current_thread))
+            load_counters(state, configuration);
+        return;
+    }
+
+    u64 overflowed_counters = 0;
+    for_each_event(configuration, [&](size_t counter, size_t event) {
+        MSR pmc(MSR_IA32_PMC0 + counter);
+        // The counters count up from the negated sampling period, so they've overflowed once the highest bit is clear.
+        if (pmc.get() & (1ull << (s_counter_width - 1)))
+            return;
+        PerformanceManager::add_pmc_sample_event(*current_thread, regs, (PerformanceCounterEvent)event);
+        pmc.set((u32)-s_events[event].sampling_period);
+        overflowed_counters |= 1ull << counter;
+    });
+    if (s_version >= 2 && overflowed_counters)
+        MSR(MSR_IA32_PERF_GLOBAL_OVF_CTRL).set(overflowed_counters);
+}
+
+}
@@ -29,6 +29,13 @@ namespace Kernel {
 
 READONLY_AFTER_INIT FPUState Processor::s_clean_fpu_state;
 
+// CR0.TS: Any FPU instruction raises #NM while this is set
+static constexpr FlatPtr cr0_task_switched = 1 << 3;
+
+// Invalidating more user pages than this one by one is slower than flushing
+// all non-global TLB entries at once by reloading CR3.
+static constexpr size_t s_max_invlpg_user_page_count = 32;
+
 READONLY_AFTER_INIT static ProcessorContainer s_processors {};
 READONLY_AFTER_INIT Atomic<u32> Processor::g_total_processors;
 static volatile bool s_smp_enabled;
@@ -304,8 +311,13 @@ UNMAP_AFTER_INIT void Processor::early_initialize(u32 cpu)
     m_message_queue = nullptr;
     m_idle_thread = nullptr;
     m_current_thread = nullptr;
+    m_fpu_owner = nullptr;
+    m_active_cr3 = 0;
     m_info = nullptr;
 
+    for (auto& specific_data : m_processor_specific_data)
+        specific_data = nullptr;
+
     m_halt_requested = false;
     if (cpu == 0) {
         s_smp_enabled = false;
@@ -644,6 +656,11 @@ void Processor::check_invoke_scheduler()
 
 void Processor::flush_tlb_local(VirtualAddress vaddr, size_t page_count)
 {
+    if (page_count > s_max_invlpg_user_page_count && is_user_range(vaddr, page_count * PAGE_SIZE)) {
+        flush_entire_tlb_local();
+        return;
+    }
+
     auto ptr = vaddr.as_ptr();
     while (page_count > 0) {
         // clang-format off
@@ -665,6 +682,15 @@ void Processor::flush_tlb(const PageDirectory* page_directory, VirtualAddress va
         flush_tlb_local(vaddr, page_count);
 }
 
+void Processor::load_cr3(FlatPtr cr3)
+{
+    // Publish the new page directory before loading it. A shootdown that
+    // doesn't see it yet must have updated the page tables before we load
+    // CR3, which flushes everything it would have invalidated anyway.
+    Processor::current().m_active_cr3.store(cr3, AK::MemoryOrder::memory_order_seq_cst);
+    write_cr3(cr3);
+}
+
 void Processor::smp_return_to_pool(ProcessorMessage& msg)
 {
     ProcessorMessage* next = nullptr;
@@ -949,15 +975,58 @@ void Processor::smp_unicast(u32 cpu, Function<void()> callback, bool async)
     smp_unicast_message(cpu, msg, async);
 }
 
+void Processor::smp_multicast_message(u32 cpu_mask, ProcessorMessage& msg)
+{
+    auto& cur_proc = Processor::current();
+    VERIFY(!(cpu_mask & (1u << cur_proc.get_id())));
+
+    dbgln_if(SMP_DEBUG, "SMP[{}]: Multicast message {} to cpu mask: {:#x}", cur_proc.get_id(), VirtualAddress(&msg), cpu_mask);
+
+    msg.refs.store(__builtin_popcount(cpu_mask), AK::MemoryOrder::memory_order_release);
+    VERIFY(msg.refs > 0);
+    for_each(
+        [&](Processor& proc) {
+            if (!(cpu_mask & (1u << proc.get_id())))
+                return;
+            // Skip the IPI if the target already had messages queued
+            if (proc.smp_queue_message(msg))
+                APIC::the().send_ipi(proc.get_id());
+        });
+}
+
 void Processor::smp_broadcast_flush_tlb(const PageDirectory* page_directory, VirtualAddress vaddr, size_t page_count)
 {
+    // User mappings can only be cached in the TLB of processors that have
+    // this page directory loaded right now, loading a different one flushes
+    // them. There's no need to interrupt everyone else.
+    auto& cur_proc = Processor::current();
+    bool is_user_flush = is_user_address(vaddr);
+    AK::atomic_thread_fence(AK::MemoryOrder::memory_order_seq_cst);
+    u32 cpu_mask = 0;
+    for_each(
+        [&](Processor& proc) {
+            if (&proc == &cur_proc)
+                return;
+            if (is_user_flush) {
+                auto active_cr3 = proc.m_active_cr3.load(AK::MemoryOrder::memory_order_seq_cst);
+                if (active_cr3 != 0 && active_cr3 != page_directory->cr3())
+                    return;
+            }
+            cpu_mask |= 1u << proc.get_id();
+        });
+
+    if (cpu_mask == 0) {
+        flush_tlb_local(vaddr, page_count);
+        return;
+    }
+
     auto& msg = smp_get_from_pool();
     msg.async = false;
     msg.type = ProcessorMessage::FlushTlb;
     msg.flush_tlb.page_directory = page_directory;
     msg.flush_tlb.ptr = vaddr.as_ptr();
     msg.flush_tlb.page_count = page_count;
-    smp_broadcast_message(msg);
+    smp_multicast_message(cpu_mask, msg);
     // While the other processors handle this request, we'll flush ours
     flush_tlb_local(vaddr, page_count);
     // Now wait until everybody is done as well
@@ -1203,12 +1272,18 @@ extern "C" void enter_thread_context(Thread* from_thread, Thread* to_thread)
     auto& from_regs = from_thread->regs();
     auto& to_regs = to_thread->regs();
 
-    if (has_fxsr)
-        asm volatile("fxsave %0"
-                     : "=m"(from_thread->fpu_state()));
-    else
-        asm volatile("fnsave %0"
-                     : "=m"(from_thread->fpu_state()));
+    // CR0.TS is only clear if from_thread touched the FPU since it was switched
+    // in, otherwise its saved FPU state is still up to date.
+    // NOTE: When assuming a new context after exec, from_thread == to_thread and
+    //       its FPU state was reset, so we must not overwrite it.
+    if (from_thread != to_thread && !(read_cr0() & cr0_task_switched)) {
+        if (has_fxsr)
+            asm volatile("fxsave %0"
+                         : "=m"(from_thread->fpu_state()));
+        else
+            asm volatile("fnsave %0"
+                         : "=m"(from_thread->fpu_state()));
+    }
 
 #if ARCH(I386)
     from_regs.fs = get_fs();
@@ -1237,19 +1312,46 @@ extern "C" void enter_thread_context(Thread* from_thread, Thread* to_thread)
 #endif
 
     if (from_regs.cr3 != to_regs.cr3)
-        write_cr3(to_regs.cr3);
+        Processor::load_cr3(to_regs.cr3);
 
     to_thread->set_cpu(processor.get_id());
     processor.restore_in_critical(to_thread->saved_critical());
 
-    if (has_fxsr)
-        asm volatile("fxrstor %0" ::"m"(to_thread->fpu_state()));
+    // Most threads don't touch the FPU during most of their time slices, so
+    // we only load their FPU state once they do, see fpu_exception_handler().
+    // If the FPU still holds to_thread's state we don't have to load it at all.
+    if (processor.fpu_holds_state_of(*to_thread))
+        asm volatile("clts");
     else
-        asm volatile("frstor %0" ::"m"(to_thread->fpu_state()));
+        write_cr0(read_cr0() | cr0_task_switched);
 
     // TODO: ioperm?
 }
 
+bool Processor::fpu_holds_state_of(Thread const& thread) const
+{
+    // The thread may have run (and used the FPU) elsewhere since it last
+    // loaded its state into our FPU, in which case that state is stale.
+    return m_fpu_owner == &thread && thread.fpu_state_cpu() == m_cpu;
+}
+
+void Processor::load_fpu_state_of_current_thread()
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    asm volatile("clts");
+    auto* current_thread = Processor::current_thread();
+    if (fpu_holds_state_of(*current_thread))
+        return;
+
+    // The previous owner's state was saved when it was switched out
+    if (has_feature(CPUFeature::FXSR))
+        asm volatile("fxrstor %0" ::"m"(current_thread->fpu_state()));
+    else
+        asm volatile("frstor %0" ::"m"(current_thread->fpu_state()));
+    m_fpu_owner = current_thread;
+    current_thread->set_fpu_state_cpu(m_cpu);
+}
+
 extern "C" FlatPtr do_init_context(Thread* thread, u32 flags)
 {
     VERIFY_INTERRUPTS_DISABLED();
@@ -5,9 +5,11 @@
  */
 
 #include <Kernel/Bus/PCI/Access.h>
+#include <Kernel/Arch/x86/CPU.h>
 #include <Kernel/Bus/PCI/IOAccess.h>
 #include <Kernel/Debug.h>
 #include <Kernel/IO.h>
+#include <Kernel/Interrupts/APIC.h>
 #include <Kernel/Sections.h>
 
 namespace Kernel {
@@ -227,6 +229,73 @@ u8 get_interrupt_line(Address address)
     return read8(address, PCI_INTERRUPT_LINE);
 }
 
+bool has_capability(Address address, u8 capability_id)
+{
+    for (auto& capability : get_physical_id(address).capabilities()) {
+        if (capability.id() == capability_id)
+            return true;
+    }
+    return false;
+}
+
+void enable_message_signalled_interrupt(Address address, u8 interrupt_number, u32 processor)
+{
+    for (auto& capability : get_physical_id(address).capabilities()) {
+        if (capability.id() != PCI_CAPABILITY_MSI)
+            continue;
+        u16 message_control = capability.read16(2);
+        bool is_64bit = message_control & (1 << 7);
+        bool has_per_vector_masking = message_control & (1 << 8);
+        // The message data and mask bits come after the upper half of the address, if there is one.
+        size_t data_offset = is_64bit ? 0xc : 0x8;
+        capability.write32(4, APIC::the().message_signalled_interrupt_address(processor));
+        if (is_64bit)
+            capability.write32(8, 0);
+        capability.write16(data_offset, interrupt_number + IRQ_VECTOR_BASE);
+        if (has_per_vector_masking)
+            capability.write32(data_offset + 4, 0);
+        // We only ever ask for a single vector, so Multiple Message Enable stays at zero.
+        capability.write16(2, (message_control & ~(0x7 << 4)) | 1);
+        disable_interrupt_line(address);
+        return;
+    }
+    VERIFY_NOT_REACHED();
+}
+
+void disable_message_signalled_interrupt(Address address)
+{
+    for (auto& capability : get_physical_id(address).capabilities()) {
+        if (capability.id() != PCI_CAPABILITY_MSI)
+            continue;
+        capability.write16(2, capability.read16(2) & ~1);
+        return;
+    }
+}
+
+void enable_extended_message_signalled_interrupts(Address address)
+{
+    for (auto& capability : get_physical_id(address).capabilities()) {
+        if (capability.id() != PCI_CAPABILITY_MSIX)
+            continue;
+        // Set MSI-X Enable and clear Function Mask, the vectors can still be masked one by one in the table.
+        auto message_control = capability.read16(2);
+        capability.write16(2, (message_control | (1 << 15)) & ~(1 << 14));
+        disable_interrupt_line(address);
+        return;
+    }
+    VERIFY_NOT_REACHED();
+}
+
+void disable_extended_message_signalled_interrupts(Address address)
+{
+    for (auto& capability : get_physical_id(address).capabilities()) {
+        if (capability.id() != PCI_CAPABILITY_MSIX)
+            continue;
+        capability.write16(2, capability.read16(2) & ~(1 << 15));
+        return;
+    }
+}
+
 u32 get_BAR0(Address address)
 {
     return read32(address, PCI_BAR0);
@@ -219,6 +219,13 @@ void enumerate(Function<void(Address, ID)> callback);
 void enable_interrupt_line(Address);
 void disable_interrupt_line(Address);
 u8 get_interrupt_line(Address);
+bool has_capability(Address, u8 capability_id);
+// Points the device's single MSI vector at the interrupt number on the given processor, and stops it from using its interrupt line.
+void enable_message_signalled_interrupt(Address, u8 interrupt_number, u32 processor);
+void disable_message_signalled_interrupt(Address);
+// The vectors have to be set up in the device's MSIXTable.
+void enable_extended_message_signalled_interrupts(Address);
+void disable_extended_message_signalled_interrupts(Address);
 void raw_access(Address, u32, size_t, u32);
 u32 get_BAR0(Address);
 u32 get_BAR1(Address);
@@ -251,6 +258,7 @@ class IOAccess;
 class MMIOSegment;
 class DeviceController;
 class Device;
+class MSIXTable;
 
 }
 
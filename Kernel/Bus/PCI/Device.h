@@ -20,6 +20,8 @@ protected:
     Device(Address pci_address, u8 interrupt_vector);
     ~Device();
 
+    bool try_to_enable_message_signalled_interrupts(Optional<u32> processor = {}) { return IRQHandler::try_to_enable_message_signalled_interrupts(pci_address(), processor); }
+
 private:
     Address m_pci_address;
 };
@@ -16,19 +16,11 @@ DeviceController::DeviceController(Address address)
 
 bool DeviceController::is_msi_capable() const
 {
-    for (const auto& capability : PCI::get_physical_id(pci_address()).capabilities()) {
-        if (capability.id() == PCI_CAPABILITY_MSI)
-            return true;
-    }
-    return false;
+    return has_capability(pci_address(), PCI_CAPABILITY_MSI);
 }
 bool DeviceController::is_msix_capable() const
 {
-    for (const auto& capability : PCI::get_physical_id(pci_address()).capabilities()) {
-        if (capability.id() == PCI_CAPABILITY_MSIX)
-            return true;
-    }
-    return false;
+    return has_capability(pci_address(), PCI_CAPABILITY_MSIX);
 }
 
 void DeviceController::enable_pin_based_interrupts() const
@@ -40,21 +32,21 @@ void DeviceController::disable_pin_based_interrupts() const
     PCI::disable_interrupt_line(pci_address());
 }
 
-void DeviceController::enable_message_signalled_interrupts()
+void DeviceController::enable_message_signalled_interrupts(u8 interrupt_number, u32 processor)
 {
-    TODO();
+    PCI::enable_message_signalled_interrupt(pci_address(), interrupt_number, processor);
 }
 void DeviceController::disable_message_signalled_interrupts()
 {
-    TODO();
+    PCI::disable_message_signalled_interrupt(pci_address());
 }
 void DeviceController::enable_extended_message_signalled_interrupts()
 {
-    TODO();
+    PCI::enable_extended_message_signalled_interrupts(pci_address());
 }
 void DeviceController::disable_extended_message_signalled_interrupts()
 {
-    TODO();
+    PCI::disable_extended_message_signalled_interrupts(pci_address());
 }
 
 }
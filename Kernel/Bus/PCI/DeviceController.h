@@ -21,7 +21,7 @@ public:
     bool is_msi_capable() const;
     bool is_msix_capable() const;
 
-    void enable_message_signalled_interrupts();
+    void enable_message_signalled_interrupts(u8 interrupt_number, u32 processor);
     void disable_message_signalled_interrupts();
 
     void enable_extended_message_signalled_interrupts();
@@ -19,8 +19,12 @@ enum VendorID {
 };
 
 enum DeviceID {
+    VirtIONetwork = 0x1000,
+    VirtIOBlock = 0x1001,
     VirtIOConsole = 0x1003,
     VirtIOEntropy = 0x1005,
+    VirtIONetworkNonTransitional = 0x1041,
+    VirtIOBlockNonTransitional = 0x1042,
     VirtIOGPU = 0x1050,
 };
 
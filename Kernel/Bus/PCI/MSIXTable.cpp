@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Arch/x86/CPU.h>
+#include <Kernel/Bus/PCI/MSIXTable.h>
+#include <Kernel/Interrupts/APIC.h>
+#include <Kernel/VM/MemoryManager.h>
+
+namespace Kernel {
+namespace PCI {
+
+static constexpr u32 vector_control_masked = 1;
+
+UNMAP_AFTER_INIT OwnPtr<MSIXTable> MSIXTable::try_create(Address address)
+{
+    for (auto& capability : get_physical_id(address).capabilities()) {
+        if (capability.id() != PCI_CAPABILITY_MSIX)
+            continue;
+        size_t entry_count = (capability.read16(2) & 0x7ff) + 1;
+        u32 table_offset_and_bar = capability.read32(4);
+        u8 bar = table_offset_and_bar & 0x7;
+        if (bar > 5)
+            return {};
+        u64 bar_address = get_BAR(address, bar) & ~0xfu;
+        // Bits 2:1 of a memory BAR say whether it's a 64-bit one, taking up the next BAR as well.
+        if (((get_BAR(address, bar) >> 1) & 0x3) == 0x2) {
+            if (bar == 5)
+                return {};
+            bar_address |= (u64)get_BAR(address, bar + 1) << 32;
+        }
+        auto table_address = PhysicalAddress(bar_address + (table_offset_and_bar & ~0x7u));
+        size_t table_size = entry_count * sizeof(Entry);
+        auto region = MM.allocate_kernel_region(table_address.page_base(), page_round_up(table_address.offset_in_page() + table_size), "MSI-X Table", Region::Access::Read | Region::Access::Write, Region::Cacheable::No);
+        if (!region)
+            return {};
+        return adopt_own_if_nonnull(new (nothrow) MSIXTable(region.release_nonnull(), table_address.offset_in_page(), entry_count));
+    }
+    return {};
+}
+
+UNMAP_AFTER_INIT MSIXTable::MSIXTable(NonnullOwnPtr<Region> table_region, size_t table_offset, size_t entry_count)
+    : m_table_region(move(table_region))
+    , m_table_offset(table_offset)
+    , m_entry_count(entry_count)
+{
+    for (size_t index = 0; index < m_entry_count; index++)
+        mask_entry(index);
+}
+
+volatile MSIXTable::Entry& MSIXTable::entry(size_t index)
+{
+    VERIFY(index < m_entry_count);
+    return reinterpret_cast<volatile Entry*>(m_table_region->vaddr().offset(m_table_offset).as_ptr())[index];
+}
+
+void MSIXTable::set_entry(size_t index, u8 interrupt_number, u32 processor)
+{
+    auto& table_entry = entry(index);
+    table_entry.vector_control = vector_control_masked;
+    table_entry.message_address_low = APIC::the().message_signalled_interrupt_address(processor);
+    table_entry.message_address_high = 0;
+    table_entry.message_data = interrupt_number + IRQ_VECTOR_BASE;
+    table_entry.vector_control = 0;
+}
+
+void MSIXTable::mask_entry(size_t index)
+{
+    entry(index).vector_control = vector_control_masked;
+}
+
+}
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Types.h>
+#include <Kernel/Bus/PCI/Definitions.h>
+#include <Kernel/VM/Region.h>
+
+namespace Kernel {
+
+// The MSI-X table of a device, which says where each of its interrupt vectors is delivered.
+// Entries start out masked, set_entry() points one at an interrupt number on a processor and unmasks it.
+class PCI::MSIXTable {
+public:
+    static OwnPtr<MSIXTable> try_create(Address);
+
+    size_t entry_count() const { return m_entry_count; }
+    void set_entry(size_t index, u8 interrupt_number, u32 processor);
+    void mask_entry(size_t index);
+
+private:
+    MSIXTable(NonnullOwnPtr<Region>, size_t table_offset, size_t entry_count);
+
+    struct [[gnu::packed]] Entry {
+        u32 message_address_low;
+        u32 message_address_high;
+        u32 message_data;
+        u32 vector_control;
+    };
+
+    volatile Entry& entry(size_t index);
+
+    NonnullOwnPtr<Region> m_table_region;
+    size_t m_table_offset { 0 };
+    size_t m_entry_count { 0 };
+};
+
+}
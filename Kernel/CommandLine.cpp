@@ -125,6 +125,18 @@ UNMAP_AFTER_INIT bool CommandLine::is_legacy_time_enabled() const
     return lookup("time"sv).value_or("modern"sv) == "legacy"sv;
 }
 
+// Not UNMAP_AFTER_INIT, block devices may show up later on as well.
+String CommandLine::io_scheduler() const
+{
+    return lookup("io_scheduler"sv).value_or("deadline"sv);
+}
+
+// Not UNMAP_AFTER_INIT, every new TCP socket looks at this.
+String CommandLine::tcp_congestion_control() const
+{
+    return lookup("tcp_congestion_control"sv).value_or("cubic"sv);
+}
+
 UNMAP_AFTER_INIT bool CommandLine::is_force_pio() const
 {
     return contains("force_pio"sv);
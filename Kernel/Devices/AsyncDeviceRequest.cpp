@@ -12,6 +12,7 @@ namespace Kernel {
 AsyncDeviceRequest::AsyncDeviceRequest(Device& device)
     : m_device(device)
     , m_process(*Process::current())
+    , m_io_priority(m_process->io_priority())
 {
 }
 
@@ -135,6 +136,8 @@ void AsyncDeviceRequest::complete(RequestResult result)
         VERIFY(m_result == Started);
         m_result = result;
     }
+    TRACEPOINT(DeviceRequestComplete, this, result);
+    did_complete(result);
     if (Processor::current().in_irq()) {
         ref(); // Make sure we don't get freed
         Processor::deferred_call_queue([this]() {
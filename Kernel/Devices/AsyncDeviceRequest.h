@@ -10,6 +10,7 @@
 #include <AK/NonnullRefPtr.h>
 #include <Kernel/Process.h>
 #include <Kernel/Thread.h>
+#include <Kernel/Tracepoints.h>
 #include <Kernel/UserOrKernelBuffer.h>
 #include <Kernel/VM/ProcessPagingScope.h>
 #include <Kernel/WaitQueue.h>
@@ -56,6 +57,10 @@ public:
 
     virtual const char* name() const = 0;
     virtual void start() = 0;
+    virtual bool is_block_device_request() const { return false; }
+
+    // Taken from the process that made the request.
+    IOPriority io_priority() const { return m_io_priority; }
 
     void add_sub_request(NonnullRefPtr<AsyncDeviceRequest>);
 
@@ -68,6 +73,7 @@ public:
         m_result = Started;
         requests_lock.unlock();
 
+        TRACEPOINT(DeviceRequestStart, this, is_block_device_request());
         start();
     }
 
@@ -121,6 +127,9 @@ protected:
 
     RequestResult get_request_result() const;
 
+    // Called once the driver has completed the request, possibly in IRQ context.
+    virtual void did_complete(RequestResult) { }
+
 private:
     void sub_request_finished(AsyncDeviceRequest&);
     void request_finished();
@@ -149,6 +158,7 @@ private:
     AsyncDeviceSubRequestList m_sub_requests_complete;
     WaitQueue m_queue;
     NonnullRefPtr<Process> m_process;
+    const IOPriority m_io_priority;
     void* m_private { nullptr };
     mutable SpinLock<u8> m_lock;
 };
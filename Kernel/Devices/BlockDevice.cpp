@@ -5,10 +5,11 @@
  */
 
 #include <Kernel/Devices/BlockDevice.h>
+#include <Kernel/VM/ScatterGatherList.h>
 
 namespace Kernel {
 
-AsyncBlockDeviceRequest::AsyncBlockDeviceRequest(Device& block_device, RequestType request_type, u64 block_index, u32 block_count, const UserOrKernelBuffer& buffer, size_t buffer_size)
+AsyncBlockDeviceRequest::AsyncBlockDeviceRequest(Device& block_device, RequestType request_type, u64 block_index, u32 block_count, const UserOrKernelBuffer& buffer, size_t buffer_size, RefPtr<UserScatterGatherList> direct_scatter_list)
     : AsyncDeviceRequest(block_device)
     , m_block_device(static_cast<BlockDevice&>(block_device))
     , m_request_type(request_type)
@@ -16,14 +17,31 @@ AsyncBlockDeviceRequest::AsyncBlockDeviceRequest(Device& block_device, RequestTy
     , m_block_count(block_count)
     , m_buffer(buffer)
     , m_buffer_size(buffer_size)
+    , m_direct_scatter_list(move(direct_scatter_list))
 {
 }
 
+AsyncBlockDeviceRequest::~AsyncBlockDeviceRequest()
+{
+    if (m_start_time.has_value())
+        m_block_device.io_statistics().did_cancel();
+}
+
 void AsyncBlockDeviceRequest::start()
 {
+    m_start_time = m_block_device.io_statistics().did_start();
     m_block_device.start_request(*this);
 }
 
+void AsyncBlockDeviceRequest::did_complete(RequestResult result)
+{
+    if (!m_start_time.has_value())
+        return;
+    auto direction = m_request_type == Read ? IOStatistics::Direction::Read : IOStatistics::Direction::Write;
+    bool success = result == Success;
+    m_block_device.io_statistics().did_finish(direction, m_start_time.release_value(), success ? m_buffer_size : 0, success);
+}
+
 BlockDevice::~BlockDevice()
 {
 }
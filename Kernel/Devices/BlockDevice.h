@@ -6,11 +6,14 @@
 
 #pragma once
 
+#include <AK/Optional.h>
 #include <Kernel/Devices/Device.h>
+#include <Kernel/IOStatistics.h>
 
 namespace Kernel {
 
 class BlockDevice;
+class UserScatterGatherList;
 
 class AsyncBlockDeviceRequest final : public AsyncDeviceRequest {
 public:
@@ -19,7 +22,9 @@ public:
         Write
     };
     AsyncBlockDeviceRequest(Device& block_device, RequestType request_type,
-        u64 block_index, u32 block_count, const UserOrKernelBuffer& buffer, size_t buffer_size);
+        u64 block_index, u32 block_count, const UserOrKernelBuffer& buffer, size_t buffer_size,
+        RefPtr<UserScatterGatherList> direct_scatter_list = nullptr);
+    virtual ~AsyncBlockDeviceRequest() override;
 
     RequestType request_type() const { return m_request_type; }
     u64 block_index() const { return m_block_index; }
@@ -27,8 +32,12 @@ public:
     UserOrKernelBuffer& buffer() { return m_buffer; }
     const UserOrKernelBuffer& buffer() const { return m_buffer; }
     size_t buffer_size() const { return m_buffer_size; }
+    // If set, the pages behind buffer() that the controller may DMA into directly. Controllers that can't
+    // use them just bounce the data through buffer() as usual.
+    const RefPtr<UserScatterGatherList>& direct_scatter_list() const { return m_direct_scatter_list; }
 
     virtual void start() override;
+    virtual bool is_block_device_request() const override { return true; }
     virtual const char* name() const override
     {
         switch (m_request_type) {
@@ -42,12 +51,17 @@ public:
     }
 
 private:
+    virtual void did_complete(RequestResult) override;
+
     BlockDevice& m_block_device;
     const RequestType m_request_type;
     const u64 m_block_index;
     const u32 m_block_count;
     UserOrKernelBuffer m_buffer;
     const size_t m_buffer_size;
+    RefPtr<UserScatterGatherList> m_direct_scatter_list;
+    // Set while the request is with the driver.
+    Optional<Time> m_start_time;
 };
 
 class BlockDevice : public Device {
@@ -62,9 +76,12 @@ public:
 
     virtual void start_request(AsyncBlockDeviceRequest&) = 0;
 
+    IOStatistics& io_statistics() { return m_io_statistics; }
+    const IOStatistics& io_statistics() const { return m_io_statistics; }
+
 protected:
     BlockDevice(unsigned major, unsigned minor, size_t block_size = PAGE_SIZE)
-        : Device(major, minor)
+        : Device(major, minor, IOScheduler::create_default())
         , m_block_size(block_size)
     {
     }
@@ -73,6 +90,7 @@ private:
     virtual bool is_block_device() const final { return true; }
 
     size_t m_block_size { 0 };
+    IOStatistics m_io_statistics;
 };
 
 }
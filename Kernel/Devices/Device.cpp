@@ -32,8 +32,14 @@ Device* Device::get_device(unsigned major, unsigned minor)
 }
 
 Device::Device(unsigned major, unsigned minor)
+    : Device(major, minor, make<FIFOIOScheduler>())
+{
+}
+
+Device::Device(unsigned major, unsigned minor, NonnullOwnPtr<IOScheduler> io_scheduler)
     : m_major(major)
     , m_minor(minor)
+    , m_io_scheduler(move(io_scheduler))
 {
     u32 device_id = encoded_device(major, minor);
     auto it = all_devices().find(device_id);
@@ -63,15 +69,33 @@ String Device::absolute_path(const FileDescription&) const
 void Device::process_next_queued_request(Badge<AsyncDeviceRequest>, const AsyncDeviceRequest& completed_request)
 {
     ScopedSpinLock lock(m_requests_lock);
-    VERIFY(!m_requests.is_empty());
-    VERIFY(m_requests.first().ptr() == &completed_request);
-    m_requests.remove(m_requests.begin());
-    if (!m_requests.is_empty()) {
-        auto* next_request = m_requests.first().ptr();
-        next_request->do_start(move(lock));
+    VERIFY(m_requests_in_flight > 0);
+    // With more than one request in flight, they don't necessarily complete in order.
+    auto it = m_requests.begin();
+    for (; !it.is_end(); ++it) {
+        if (it->ptr() == &completed_request)
+            break;
+    }
+    VERIFY(!it.is_end());
+    m_requests.remove(it);
+    --m_requests_in_flight;
+
+    if (auto next = m_io_scheduler->dequeue()) {
+        m_requests.append(next);
+        ++m_requests_in_flight;
+        next->do_start(move(lock));
     }
 
     evaluate_block_conditions();
 }
 
+void Device::set_io_scheduler(NonnullOwnPtr<IOScheduler> io_scheduler)
+{
+    ScopedSpinLock lock(m_requests_lock);
+    while (auto request = m_io_scheduler->dequeue())
+        io_scheduler->enqueue(request.release_nonnull());
+    swap(m_io_scheduler, io_scheduler);
+    // The old scheduler is destroyed once we let go of the lock.
+}
+
 }
@@ -18,6 +18,7 @@
 #include <AK/Function.h>
 #include <AK/HashMap.h>
 #include <Kernel/Devices/AsyncDeviceRequest.h>
+#include <Kernel/Devices/IOScheduler.h>
 #include <Kernel/FileSystem/File.h>
 #include <Kernel/Mutex.h>
 #include <Kernel/UnixTypes.h>
@@ -48,20 +49,37 @@ public:
 
     void process_next_queued_request(Badge<AsyncDeviceRequest>, const AsyncDeviceRequest&);
 
+    // How many requests may be handed to start_request() before the first of them completes.
+    virtual size_t max_requests_in_flight() const { return 1; }
+
+    // Requests that queued up before the old scheduler got to them are handed over to the new one.
+    void set_io_scheduler(NonnullOwnPtr<IOScheduler>);
+
+    template<typename Callback>
+    void with_io_scheduler(Callback callback) const
+    {
+        ScopedSpinLock lock(m_requests_lock);
+        callback(const_cast<const IOScheduler&>(*m_io_scheduler));
+    }
+
     template<typename AsyncRequestType, typename... Args>
     NonnullRefPtr<AsyncRequestType> make_request(Args&&... args)
     {
         auto request = adopt_ref(*new AsyncRequestType(*this, forward<Args>(args)...));
         ScopedSpinLock lock(m_requests_lock);
-        bool was_empty = m_requests.is_empty();
-        m_requests.append(request);
-        if (was_empty)
+        if (m_requests_in_flight < max_requests_in_flight()) {
+            m_requests.append(request);
+            ++m_requests_in_flight;
             request->do_start(move(lock));
+        } else {
+            m_io_scheduler->enqueue(request);
+        }
         return request;
     }
 
 protected:
     Device(unsigned major, unsigned minor);
+    Device(unsigned major, unsigned minor, NonnullOwnPtr<IOScheduler>);
     void set_uid(uid_t uid) { m_uid = uid; }
     void set_gid(gid_t gid) { m_gid = gid; }
 
@@ -73,8 +91,11 @@ private:
     uid_t m_uid { 0 };
     gid_t m_gid { 0 };
 
-    SpinLock<u8> m_requests_lock;
+    mutable SpinLock<u8> m_requests_lock;
+    // The requests that have been started, the rest wait in m_io_scheduler.
     DoublyLinkedList<RefPtr<AsyncDeviceRequest>> m_requests;
+    size_t m_requests_in_flight { 0 };
+    NonnullOwnPtr<IOScheduler> m_io_scheduler;
 };
 
 }
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/JsonArraySerializer.h>
+#include <AK/JsonObjectSerializer.h>
+#include <Kernel/CommandLine.h>
+#include <Kernel/Devices/BlockDevice.h>
+#include <Kernel/Devices/IOScheduler.h>
+#include <Kernel/FileSystem/SysFS.h>
+#include <Kernel/FileSystem/SysFSComponent.h>
+#include <Kernel/KBufferBuilder.h>
+#include <Kernel/Panic.h>
+#include <Kernel/Sections.h>
+#include <Kernel/Time/TimeManagement.h>
+
+namespace Kernel {
+
+OwnPtr<IOScheduler> IOScheduler::create(StringView name)
+{
+    if (name == "fifo"sv)
+        return make<FIFOIOScheduler>();
+    if (name == "deadline"sv)
+        return make<DeadlineIOScheduler>();
+    return {};
+}
+
+NonnullOwnPtr<IOScheduler> IOScheduler::create_default()
+{
+    auto name = kernel_command_line().io_scheduler();
+    auto scheduler = create(name);
+    if (!scheduler)
+        PANIC("Unknown I/O scheduler: {}", name);
+    return scheduler.release_nonnull();
+}
+
+static bool is_continued_by(const AsyncDeviceRequest& first, const AsyncDeviceRequest& second)
+{
+    if (!first.is_block_device_request() || !second.is_block_device_request())
+        return false;
+    auto& first_block_request = static_cast<const AsyncBlockDeviceRequest&>(first);
+    auto& second_block_request = static_cast<const AsyncBlockDeviceRequest&>(second);
+    return first_block_request.request_type() == second_block_request.request_type()
+        && first_block_request.block_index() + first_block_request.block_count() == second_block_request.block_index();
+}
+
+void FIFOIOScheduler::enqueue(NonnullRefPtr<AsyncDeviceRequest> request)
+{
+    for (size_t index = m_queue.size(); index > 0; --index) {
+        if (is_continued_by(m_queue[index - 1], request)) {
+            m_queue.insert(index, move(request));
+            return;
+        }
+    }
+    for (size_t index = 0; index < m_queue.size(); ++index) {
+        if (is_continued_by(request, m_queue[index])) {
+            m_queue.insert(index, move(request));
+            return;
+        }
+    }
+    m_queue.append(move(request));
+}
+
+RefPtr<AsyncDeviceRequest> FIFOIOScheduler::dequeue()
+{
+    if (m_queue.is_empty())
+        return {};
+    return m_queue.take_first();
+}
+
+// In milliseconds, indexed by priority.
+static constexpr i64 read_deadlines[] = { 250, 500, 5000 };
+static constexpr i64 write_deadlines[] = { 2500, 5000, 30000 };
+
+void DeadlineIOScheduler::enqueue(NonnullRefPtr<AsyncDeviceRequest> request)
+{
+    u64 position = 0;
+    bool is_write = false;
+    if (request->is_block_device_request()) {
+        auto& block_request = static_cast<const AsyncBlockDeviceRequest&>(*request);
+        position = block_request.block_index();
+        is_write = block_request.request_type() == AsyncBlockDeviceRequest::Write;
+    }
+    auto priority = to_underlying(request->io_priority());
+    auto deadline_ms = is_write ? write_deadlines[priority] : read_deadlines[priority];
+    auto deadline = TimeManagement::the().monotonic_time() + Time::from_milliseconds(deadline_ms);
+
+    auto& queue = m_queues[priority][is_write ? 1 : 0];
+    size_t index = queue.size();
+    while (index > 0 && queue[index - 1].position > position)
+        --index;
+    queue.insert(index, QueuedRequest { move(request), position, deadline });
+    ++m_queued_count;
+}
+
+RefPtr<AsyncDeviceRequest> DeadlineIOScheduler::take(Vector<QueuedRequest>& queue, size_t index)
+{
+    auto queued_request = queue.take(index);
+    --m_queued_count;
+    m_next_position = queued_request.position;
+    if (queued_request.request->is_block_device_request())
+        m_next_position += static_cast<const AsyncBlockDeviceRequest&>(*queued_request.request).block_count();
+    return move(queued_request.request);
+}
+
+RefPtr<AsyncDeviceRequest> DeadlineIOScheduler::dequeue()
+{
+    if (m_queued_count == 0)
+        return {};
+
+    // Anything that has waited for too long goes first, whatever its priority.
+    Vector<QueuedRequest>* expired_queue = nullptr;
+    size_t expired_index = 0;
+    auto now = TimeManagement::the().monotonic_time();
+    for (auto& queues : m_queues) {
+        for (auto& queue : queues) {
+            for (size_t index = 0; index < queue.size(); ++index) {
+                if (queue[index].deadline > now)
+                    continue;
+                if (!expired_queue || queue[index].deadline < (*expired_queue)[expired_index].deadline) {
+                    expired_queue = &queue;
+                    expired_index = index;
+                }
+            }
+        }
+    }
+    if (expired_queue)
+        return take(*expired_queue, expired_index);
+
+    for (auto& queues : m_queues) {
+        auto& reads = queues[0];
+        auto& writes = queues[1];
+        if (reads.is_empty() && writes.is_empty())
+            continue;
+        Vector<QueuedRequest>* queue;
+        if (!reads.is_empty() && (writes.is_empty() || m_writes_starved < max_writes_starved)) {
+            if (!writes.is_empty())
+                ++m_writes_starved;
+            queue = &reads;
+        } else {
+            m_writes_starved = 0;
+            queue = &writes;
+        }
+        // Carry on from where the last request ended, and start over at the beginning once we run off the end.
+        size_t index = 0;
+        while (index < queue->size() && (*queue)[index].position < m_next_position)
+            ++index;
+        if (index == queue->size())
+            index = 0;
+        return take(*queue, index);
+    }
+    VERIFY_NOT_REACHED();
+}
+
+class IOSchedulersSysFSComponent final : public SysFSComponent {
+public:
+    static NonnullRefPtr<IOSchedulersSysFSComponent> must_create()
+    {
+        return adopt_ref(*new (nothrow) IOSchedulersSysFSComponent);
+    }
+
+    virtual mode_t permissions() const override { return S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH; }
+
+    virtual KResultOr<size_t> read_bytes(off_t offset, size_t count, UserOrKernelBuffer& buffer, FileDescription*) const override
+    {
+        KBufferBuilder builder;
+        {
+            JsonArraySerializer array { builder };
+            Device::for_each([&array](auto& device) {
+                if (!device.is_block_device())
+                    return;
+                auto device_object = array.add_object();
+                device_object.add("device_name", device.device_name());
+                device_object.add("major", device.major());
+                device_object.add("minor", device.minor());
+                StringView scheduler_name;
+                size_t queued_count = 0;
+                device.with_io_scheduler([&](auto& scheduler) {
+                    scheduler_name = scheduler.name();
+                    queued_count = scheduler.queued_count();
+                });
+                device_object.add("scheduler", scheduler_name);
+                device_object.add("queued_requests", queued_count);
+            });
+        }
+        auto data = builder.build();
+        if (!data)
+            return ENOMEM;
+        if (static_cast<size_t>(offset) >= data->size())
+            return 0;
+        auto nread = min(static_cast<size_t>(data->size() - offset), count);
+        if (!buffer.write(data->data() + offset, nread))
+            return EFAULT;
+        return nread;
+    }
+
+    // Takes "<device name> <scheduler>".
+    virtual KResultOr<size_t> write_bytes(off_t offset, size_t count, UserOrKernelBuffer const& buffer, FileDescription*) override
+    {
+        char value_buffer[64];
+        if (offset != 0 || count >= sizeof(value_buffer))
+            return EINVAL;
+        if (!buffer.read(value_buffer, count))
+            return EFAULT;
+        auto parts = StringView(value_buffer, count).trim_whitespace().split_view(' ');
+        if (parts.size() != 2)
+            return EINVAL;
+        Device* found_device = nullptr;
+        Device::for_each([&](auto& device) {
+            if (device.is_block_device() && device.device_name() == parts[0])
+                found_device = &device;
+        });
+        if (!found_device)
+            return ENODEV;
+        auto scheduler = IOScheduler::create(parts[1]);
+        if (!scheduler)
+            return EINVAL;
+        found_device->set_io_scheduler(scheduler.release_nonnull());
+        return count;
+    }
+
+private:
+    IOSchedulersSysFSComponent()
+        : SysFSComponent("io_schedulers"sv)
+    {
+    }
+};
+
+UNMAP_AFTER_INIT void IOScheduler::initialize_sysfs_component()
+{
+    SysFSComponentRegistry::the().register_new_component(IOSchedulersSysFSComponent::must_create());
+}
+
+}
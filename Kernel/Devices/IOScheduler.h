@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullRefPtr.h>
+#include <AK/OwnPtr.h>
+#include <AK/StringView.h>
+#include <AK/Time.h>
+#include <AK/Vector.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+class AsyncDeviceRequest;
+
+// Holds the requests of a device that couldn't be started right away, and decides which of them
+// is started next once the device has room for another one.
+// All functions are called with the requests lock of the device held.
+class IOScheduler {
+    AK_MAKE_NONCOPYABLE(IOScheduler);
+    AK_MAKE_NONMOVABLE(IOScheduler);
+
+public:
+    // Returns nullptr if there is no scheduler by that name.
+    static OwnPtr<IOScheduler> create(StringView name);
+    static NonnullOwnPtr<IOScheduler> create_default();
+    static void initialize_sysfs_component();
+
+    virtual ~IOScheduler() = default;
+
+    virtual StringView name() const = 0;
+    virtual void enqueue(NonnullRefPtr<AsyncDeviceRequest>) = 0;
+    virtual RefPtr<AsyncDeviceRequest> dequeue() = 0;
+    virtual size_t queued_count() const = 0;
+
+protected:
+    IOScheduler() = default;
+};
+
+// Starts requests in the order they arrived in, except that a block request which directly
+// continues (or precedes) one that is already queued is queued right next to it.
+// I/O priorities are ignored.
+class FIFOIOScheduler final : public IOScheduler {
+public:
+    FIFOIOScheduler() = default;
+
+    virtual StringView name() const override { return "fifo"sv; }
+    virtual void enqueue(NonnullRefPtr<AsyncDeviceRequest>) override;
+    virtual RefPtr<AsyncDeviceRequest> dequeue() override;
+    virtual size_t queued_count() const override { return m_queue.size(); }
+
+private:
+    Vector<NonnullRefPtr<AsyncDeviceRequest>> m_queue;
+};
+
+// Keeps the queued requests of every I/O priority sorted by their position on the device, and
+// sweeps across them in one direction, so adjacent ranges are started back to back.
+// Requests of a higher priority always go first, and reads are preferred over writes.
+// To make sure nothing starves, a request that has been queued for longer than its deadline
+// is started before anything else.
+class DeadlineIOScheduler final : public IOScheduler {
+public:
+    DeadlineIOScheduler() = default;
+
+    virtual StringView name() const override { return "deadline"sv; }
+    virtual void enqueue(NonnullRefPtr<AsyncDeviceRequest>) override;
+    virtual RefPtr<AsyncDeviceRequest> dequeue() override;
+    virtual size_t queued_count() const override { return m_queued_count; }
+
+private:
+    struct QueuedRequest {
+        NonnullRefPtr<AsyncDeviceRequest> request;
+        u64 position { 0 };
+        Time deadline;
+    };
+
+    static constexpr size_t priority_count = to_underlying(IOPriority::Idle) + 1;
+    // How many times in a row reads may be picked over waiting writes of the same priority.
+    static constexpr size_t max_writes_starved = 2;
+
+    RefPtr<AsyncDeviceRequest> take(Vector<QueuedRequest>&, size_t index);
+
+    // Indexed by priority, then 0 for reads and 1 for writes.
+    Vector<QueuedRequest> m_queues[priority_count][2];
+    size_t m_queued_count { 0 };
+    size_t m_writes_starved { 0 };
+    // Where the last request we started ended.
+    u64 m_next_position { 0 };
+};
+
+}
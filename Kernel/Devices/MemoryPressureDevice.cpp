@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Singleton.h>
+#include <Kernel/Devices/MemoryPressureDevice.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/Sections.h>
+
+namespace Kernel {
+
+static AK::Singleton<MemoryPressureDevice> s_the;
+
+MemoryPressureDevice& MemoryPressureDevice::the()
+{
+    return *s_the;
+}
+
+bool MemoryPressureDevice::is_initialized()
+{
+    return s_the.is_initialized();
+}
+
+UNMAP_AFTER_INIT MemoryPressureDevice::MemoryPressureDevice()
+    : CharacterDevice(1, 9)
+{
+}
+
+UNMAP_AFTER_INIT MemoryPressureDevice::~MemoryPressureDevice()
+{
+}
+
+KResultOr<NonnullRefPtr<FileDescription>> MemoryPressureDevice::open(int options)
+{
+    auto watcher_or_error = MemoryPressureWatcher::try_create();
+    if (watcher_or_error.is_error())
+        return watcher_or_error.error();
+    auto description = FileDescription::create(*watcher_or_error.value());
+    if (!description.is_error()) {
+        description.value()->set_rw_mode(options);
+        description.value()->set_file_flags(options);
+    }
+    return description;
+}
+
+void MemoryPressureDevice::set_level(MemoryPressureLevel level)
+{
+    if (m_level.exchange(level) == level)
+        return;
+    ScopedSpinLock locker(m_watchers_lock);
+    for (auto& watcher : m_watchers)
+        watcher.notify_level_changed();
+}
+
+void MemoryPressureDevice::register_watcher(Badge<MemoryPressureWatcher>, MemoryPressureWatcher& watcher)
+{
+    ScopedSpinLock locker(m_watchers_lock);
+    m_watchers.append(watcher);
+}
+
+void MemoryPressureDevice::unregister_watcher(Badge<MemoryPressureWatcher>, MemoryPressureWatcher& watcher)
+{
+    ScopedSpinLock locker(m_watchers_lock);
+    m_watchers.remove(watcher);
+}
+
+KResultOr<NonnullRefPtr<MemoryPressureWatcher>> MemoryPressureWatcher::try_create()
+{
+    auto watcher = adopt_ref_if_nonnull(new (nothrow) MemoryPressureWatcher);
+    if (!watcher)
+        return ENOMEM;
+    MemoryPressureDevice::the().register_watcher({}, *watcher);
+    return watcher.release_nonnull();
+}
+
+MemoryPressureWatcher::~MemoryPressureWatcher()
+{
+    MemoryPressureDevice::the().unregister_watcher({}, *this);
+}
+
+KResultOr<size_t> MemoryPressureWatcher::read(FileDescription&, u64, UserOrKernelBuffer& buffer, size_t size)
+{
+    if (size < sizeof(MemoryPressureLevel))
+        return EINVAL;
+    m_level_changed = false;
+    auto level = MemoryPressureDevice::the().level();
+    if (!buffer.write(&level, sizeof(level)))
+        return EFAULT;
+    return sizeof(level);
+}
+
+void MemoryPressureWatcher::notify_level_changed()
+{
+    m_level_changed = true;
+    evaluate_block_conditions();
+}
+
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Badge.h>
+#include <AK/IntrusiveList.h>
+#include <Kernel/API/MemoryPressure.h>
+#include <Kernel/Devices/CharacterDevice.h>
+#include <Kernel/SpinLock.h>
+
+namespace Kernel {
+
+class MemoryPressureDevice;
+
+class MemoryPressureWatcher final : public File {
+    friend class MemoryPressureDevice;
+
+public:
+    static KResultOr<NonnullRefPtr<MemoryPressureWatcher>> try_create();
+    virtual ~MemoryPressureWatcher() override;
+
+    virtual bool can_read(const FileDescription&, size_t) const override { return m_level_changed; }
+    virtual KResultOr<size_t> read(FileDescription&, u64, UserOrKernelBuffer&, size_t) override;
+    virtual bool can_write(const FileDescription&, size_t) const override { return true; }
+    virtual KResultOr<size_t> write(FileDescription&, u64, const UserOrKernelBuffer&, size_t) override { return EIO; }
+
+    virtual String absolute_path(const FileDescription&) const override { return "mempressure"; }
+    virtual StringView class_name() const override { return "MemoryPressureWatcher"; }
+
+private:
+    MemoryPressureWatcher() = default;
+
+    void notify_level_changed();
+
+    // Start out readable, so a freshly opened watcher can learn the current level right away.
+    Atomic<bool> m_level_changed { true };
+    IntrusiveListNode<MemoryPressureWatcher> m_list_node;
+};
+
+// Every open() of /dev/mempressure vends a MemoryPressureWatcher, which becomes readable
+// whenever the memory pressure level has changed since it was last read.
+class MemoryPressureDevice final : public CharacterDevice {
+    AK_MAKE_ETERNAL
+public:
+    MemoryPressureDevice();
+    virtual ~MemoryPressureDevice() override;
+
+    static void initialize()
+    {
+        the();
+    }
+    static MemoryPressureDevice& the();
+    static bool is_initialized();
+
+    MemoryPressureLevel level() const { return m_level; }
+    void set_level(MemoryPressureLevel);
+
+    void register_watcher(Badge<MemoryPressureWatcher>, MemoryPressureWatcher&);
+    void unregister_watcher(Badge<MemoryPressureWatcher>, MemoryPressureWatcher&);
+
+    // ^CharacterDevice
+    virtual KResultOr<NonnullRefPtr<FileDescription>> open(int options) override;
+    virtual KResultOr<size_t> read(FileDescription&, u64, UserOrKernelBuffer&, size_t) override { return 0; }
+    virtual KResultOr<size_t> write(FileDescription&, u64, const UserOrKernelBuffer&, size_t) override { return EIO; }
+    virtual bool can_read(const FileDescription&, size_t) const override { return true; }
+    virtual bool can_write(const FileDescription&, size_t) const override { return true; }
+
+    // ^Device
+    virtual mode_t required_mode() const override { return 0444; }
+    virtual String device_name() const override { return "mempressure"; }
+
+private:
+    // ^CharacterDevice
+    virtual StringView class_name() const override { return "MemoryPressureDevice"; }
+
+    Atomic<MemoryPressureLevel> m_level { MemoryPressureLevel::None };
+    SpinLock<u8> m_watchers_lock;
+    IntrusiveList<MemoryPressureWatcher, RawPtr<MemoryPressureWatcher>, &MemoryPressureWatcher::m_list_node> m_watchers;
+};
+
+}
@@ -14,20 +14,62 @@ inline void DoubleBuffer::compute_lockfree_metadata()
 {
     InterruptDisabler disabler;
     m_empty = m_read_buffer_index >= m_read_buffer->size && m_write_buffer->size == 0;
-    m_space_for_writing = m_capacity - m_write_buffer->size;
+    // Whatever we can grow into counts as well, writing only fails to get it if we run out of memory.
+    m_space_for_writing = m_maximum_capacity - m_write_buffer->size;
 }
 
-DoubleBuffer::DoubleBuffer(size_t capacity)
+DoubleBuffer::DoubleBuffer(size_t capacity, size_t maximum_capacity)
     : m_write_buffer(&m_buffer1)
     , m_read_buffer(&m_buffer2)
     , m_storage(KBuffer::create_with_size(capacity * 2, Region::Access::Read | Region::Access::Write, "DoubleBuffer"))
     , m_capacity(capacity)
+    , m_maximum_capacity(max(capacity, maximum_capacity))
 {
     m_buffer1.data = m_storage.data();
     m_buffer1.size = 0;
     m_buffer2.data = m_storage.data() + capacity;
     m_buffer2.size = 0;
-    m_space_for_writing = capacity;
+    m_space_for_writing = m_maximum_capacity;
+}
+
+bool DoubleBuffer::try_grow(size_t minimum_capacity)
+{
+    VERIFY(m_lock.is_locked());
+    if (minimum_capacity > m_maximum_capacity)
+        return false;
+    size_t new_capacity = m_capacity;
+    while (new_capacity < minimum_capacity)
+        new_capacity *= 2;
+    new_capacity = min(new_capacity, m_maximum_capacity);
+
+    auto new_storage = KBufferImpl::try_create_with_size(new_capacity * 2, Region::Access::Read | Region::Access::Write, "DoubleBuffer");
+    if (!new_storage)
+        return false;
+
+    // The unread part of the read buffer stays in front of everything that has been written since.
+    size_t unread_size = m_read_buffer->size - m_read_buffer_index;
+    memcpy(new_storage->data(), m_read_buffer->data + m_read_buffer_index, unread_size);
+    memcpy(new_storage->data() + new_capacity, m_write_buffer->data, m_write_buffer->size);
+    m_buffer1 = { new_storage->data(), unread_size };
+    m_buffer2 = { new_storage->data() + new_capacity, m_write_buffer->size };
+    m_read_buffer = &m_buffer1;
+    m_write_buffer = &m_buffer2;
+    m_read_buffer_index = 0;
+    m_storage = KBuffer(move(new_storage));
+    m_capacity = new_capacity;
+    compute_lockfree_metadata();
+    return true;
+}
+
+bool DoubleBuffer::try_ensure_space_for_writing(size_t size)
+{
+    if (m_storage.is_null())
+        return false;
+    MutexLocker locker(m_lock);
+    size_t needed_capacity = m_write_buffer->size + size;
+    if (needed_capacity <= m_capacity)
+        return true;
+    return try_grow(needed_capacity);
 }
 
 void DoubleBuffer::flip()
@@ -46,7 +88,9 @@ KResultOr<size_t> DoubleBuffer::write(const UserOrKernelBuffer& data, size_t siz
     if (!size || m_storage.is_null())
         return 0;
     MutexLocker locker(m_lock);
-    size_t bytes_to_write = min(size, m_space_for_writing);
+    if (m_write_buffer->size + size > m_capacity && m_capacity < m_maximum_capacity)
+        try_grow(min(m_write_buffer->size + size, m_maximum_capacity));
+    size_t bytes_to_write = min(size, m_capacity - m_write_buffer->size);
     u8* write_ptr = m_write_buffer->data + m_write_buffer->size;
     if (!data.read(write_ptr, bytes_to_write))
         return EFAULT;
@@ -57,6 +101,27 @@ KResultOr<size_t> DoubleBuffer::write(const UserOrKernelBuffer& data, size_t siz
     return bytes_to_write;
 }
 
+KResult DoubleBuffer::write_record(ReadonlyBytes header, const UserOrKernelBuffer& data, size_t size)
+{
+    if (m_storage.is_null())
+        return ENOMEM;
+    size_t record_size = header.size() + size;
+    if (record_size > m_maximum_capacity)
+        return EMSGSIZE;
+    MutexLocker locker(m_lock);
+    if (m_write_buffer->size + record_size > m_capacity && !try_grow(m_write_buffer->size + record_size))
+        return EAGAIN;
+    u8* write_ptr = m_write_buffer->data + m_write_buffer->size;
+    memcpy(write_ptr, header.data(), header.size());
+    if (size && !data.read(write_ptr + header.size(), size))
+        return EFAULT;
+    m_write_buffer->size += record_size;
+    compute_lockfree_metadata();
+    if (m_unblock_callback && !m_empty)
+        m_unblock_callback();
+    return KSuccess;
+}
+
 KResultOr<size_t> DoubleBuffer::read(UserOrKernelBuffer& data, size_t size)
 {
     if (!size || m_storage.is_null())
@@ -76,6 +141,21 @@ KResultOr<size_t> DoubleBuffer::read(UserOrKernelBuffer& data, size_t size)
     return nread;
 }
 
+size_t DoubleBuffer::discard(size_t size)
+{
+    if (!size || m_storage.is_null())
+        return 0;
+    MutexLocker locker(m_lock);
+    if (m_read_buffer_index >= m_read_buffer->size && m_write_buffer->size != 0)
+        flip();
+    size_t ndiscarded = min(m_read_buffer->size - m_read_buffer_index, size);
+    m_read_buffer_index += ndiscarded;
+    compute_lockfree_metadata();
+    if (m_unblock_callback && m_space_for_writing > 0)
+        m_unblock_callback();
+    return ndiscarded;
+}
+
 KResultOr<size_t> DoubleBuffer::peek(UserOrKernelBuffer& data, size_t size)
 {
     if (!size || m_storage.is_null())
@@ -16,13 +16,16 @@ namespace Kernel {
 
 class DoubleBuffer {
 public:
-    explicit DoubleBuffer(size_t capacity = 65536);
+    // A buffer with a maximum capacity that is larger than its capacity grows (by doubling) as it needs more space.
+    explicit DoubleBuffer(size_t capacity = 65536, size_t maximum_capacity = 0);
 
     [[nodiscard]] KResultOr<size_t> write(const UserOrKernelBuffer&, size_t);
     [[nodiscard]] KResultOr<size_t> write(const u8* data, size_t size)
     {
         return write(UserOrKernelBuffer::for_kernel_buffer(const_cast<u8*>(data)), size);
     }
+    // Writes the header followed by the data all at once, or nothing at all if they don't fit.
+    [[nodiscard]] KResult write_record(ReadonlyBytes header, const UserOrKernelBuffer& data, size_t size);
     [[nodiscard]] KResultOr<size_t> read(UserOrKernelBuffer&, size_t);
     [[nodiscard]] KResultOr<size_t> read(u8* data, size_t size)
     {
@@ -36,10 +39,16 @@ public:
         return peek(buffer, size);
     }
 
+    // Throws away up to `size` bytes that would have been read next, and returns how many it threw away.
+    size_t discard(size_t size);
+
     bool is_empty() const { return m_empty; }
 
     size_t space_for_writing() const { return m_space_for_writing; }
 
+    // Makes sure that the next writes can take `size` bytes in total, growing the buffer if it has to.
+    [[nodiscard]] bool try_ensure_space_for_writing(size_t size);
+
     void set_unblock_callback(Function<void()> callback)
     {
         VERIFY(!m_unblock_callback);
@@ -49,6 +58,7 @@ public:
 private:
     void flip();
     void compute_lockfree_metadata();
+    bool try_grow(size_t minimum_capacity);
 
     struct InnerBuffer {
         u8* data { nullptr };
@@ -63,6 +73,7 @@ private:
     KBuffer m_storage;
     Function<void()> m_unblock_callback;
     size_t m_capacity { 0 };
+    size_t m_maximum_capacity { 0 };
     size_t m_read_buffer_index { 0 };
     size_t m_space_for_writing { 0 };
     bool m_empty { true };
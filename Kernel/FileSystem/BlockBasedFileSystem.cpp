@@ -4,105 +4,26 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include <AK/IntrusiveList.h>
 #include <Kernel/Debug.h>
 #include <Kernel/FileSystem/BlockBasedFileSystem.h>
+#include <Kernel/FileSystem/DiskCache.h>
 #include <Kernel/Process.h>
+#include <Kernel/Tasks/SyncTask.h>
+#include <Kernel/Time/TimeManagement.h>
 
 namespace Kernel {
 
-struct CacheEntry {
-    IntrusiveListNode<CacheEntry> list_node;
-    BlockBasedFileSystem::BlockIndex block_index { 0 };
-    u8* data { nullptr };
-    bool has_data { false };
-};
-
-class DiskCache {
-public:
-    explicit DiskCache(BlockBasedFileSystem& fs)
-        : m_fs(fs)
-        , m_cached_block_data(KBuffer::create_with_size(m_entry_count * m_fs.block_size()))
-        , m_entries(KBuffer::create_with_size(m_entry_count * sizeof(CacheEntry)))
-    {
-        for (size_t i = 0; i < m_entry_count; ++i) {
-            entries()[i].data = m_cached_block_data.data() + i * m_fs.block_size();
-            m_clean_list.append(entries()[i]);
-        }
-    }
-
-    ~DiskCache() = default;
-
-    bool is_dirty() const { return m_dirty; }
-    void set_dirty(bool b) { m_dirty = b; }
-
-    void mark_all_clean()
-    {
-        while (auto* entry = m_dirty_list.first())
-            m_clean_list.prepend(*entry);
-        m_dirty = false;
-    }
-
-    void mark_dirty(CacheEntry& entry)
-    {
-        m_dirty_list.prepend(entry);
-        m_dirty = true;
-    }
-
-    void mark_clean(CacheEntry& entry)
-    {
-        m_clean_list.prepend(entry);
-    }
-
-    CacheEntry& get(BlockBasedFileSystem::BlockIndex block_index) const
-    {
-        if (auto it = m_hash.find(block_index); it != m_hash.end()) {
-            auto& entry = const_cast<CacheEntry&>(*it->value);
-            VERIFY(entry.block_index == block_index);
-            return entry;
-        }
-
-        if (m_clean_list.is_empty()) {
-            // Not a single clean entry! Flush writes and try again.
-            // NOTE: We want to make sure we only call FileBackedFileSystem flush here,
-            //       not some FileBackedFileSystem subclass flush!
-            m_fs.flush_writes_impl();
-            return get(block_index);
-        }
-
-        VERIFY(m_clean_list.last());
-        auto& new_entry = *m_clean_list.last();
-        m_clean_list.prepend(new_entry);
+// Dirty blocks are written back by SyncTask once they are this old, or once more than
+// background_dirty_ratio percent of the cache is dirty. Writers that push the cache past
+// throttle_dirty_ratio percent have to write back a batch of old blocks themselves.
+static constexpr auto dirty_expire_interval = Time::from_seconds(5);
+static constexpr size_t background_dirty_ratio = 10;
+static constexpr size_t throttle_dirty_ratio = 20;
+static constexpr size_t writeback_batch_size = 32;
+static constexpr size_t throttle_batch_size = 8;
 
-        m_hash.remove(new_entry.block_index);
-        m_hash.set(block_index, &new_entry);
-
-        new_entry.block_index = block_index;
-        new_entry.has_data = false;
-
-        return new_entry;
-    }
-
-    const CacheEntry* entries() const { return (const CacheEntry*)m_entries.data(); }
-    CacheEntry* entries() { return (CacheEntry*)m_entries.data(); }
-
-    template<typename Callback>
-    void for_each_dirty_entry(Callback callback)
-    {
-        for (auto& entry : m_dirty_list)
-            callback(entry);
-    }
-
-private:
-    BlockBasedFileSystem& m_fs;
-    size_t m_entry_count { 10000 };
-    mutable HashMap<BlockBasedFileSystem::BlockIndex, CacheEntry*> m_hash;
-    mutable IntrusiveList<CacheEntry, RawPtr<CacheEntry>, &CacheEntry::list_node> m_clean_list;
-    mutable IntrusiveList<CacheEntry, RawPtr<CacheEntry>, &CacheEntry::list_node> m_dirty_list;
-    KBuffer m_cached_block_data;
-    KBuffer m_entries;
-    bool m_dirty { false };
-};
+// Runs of uncached blocks are read from the device in pieces of at most this size.
+static constexpr size_t max_coalesced_bytes = 64 * KiB;
 
 BlockBasedFileSystem::BlockBasedFileSystem(FileDescription& file_description)
     : FileBackedFileSystem(file_description)
@@ -120,37 +41,80 @@ KResult BlockBasedFileSystem::write_block(BlockIndex index, const UserOrKernelBu
     VERIFY(offset + count <= block_size());
     dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::write_block {}, size={}", index, count);
 
-    MutexLocker locker(m_cache_lock);
+    auto& shard = cache().shard_for(index);
+    MutexLocker locker(shard.lock());
 
     if (!allow_cache) {
-        flush_specific_block_if_needed(index);
+        // Don't leave a (possibly dirty) copy of this block behind in the cache.
+        if (auto* entry = shard.find(index)) {
+            if (entry->is_dirty)
+                shard.flush(*entry);
+            shard.invalidate(*entry);
+        }
         auto base_offset = index.value() * block_size() + offset;
-        auto nwritten = file_description().write(base_offset, data, count);
+        auto nwritten = write_to_backing_device(base_offset, data, count);
         if (nwritten.is_error())
             return nwritten.error();
         VERIFY(nwritten.value() == count);
         return KSuccess;
     }
 
-    auto& entry = cache().get(index);
-    if (count < block_size()) {
+    auto& entry = shard.get(index);
+    if (count < block_size() && !entry.has_data) {
         // Fill the cache first.
-        auto result = read_block(index, nullptr, block_size());
-        if (result.is_error())
+        if (auto result = fill_entry(entry); result.is_error())
             return result;
     }
     if (!data.read(entry.data + offset, count))
         return EFAULT;
 
-    cache().mark_dirty(entry);
+    shard.mark_dirty(entry);
+    entry.has_data = true;
+
+    auto dirty_count = shard.dirty_count();
+    if (dirty_count * 100 >= shard.capacity() * throttle_dirty_ratio) {
+        // SyncTask isn't keeping up, so this writer has to pay for (some of) its own dirt.
+        dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::write_block: Throttling writer, {} dirty blocks", dirty_count);
+        shard.flush_oldest(throttle_batch_size);
+    } else if (dirty_count * 100 >= shard.capacity() * background_dirty_ratio) {
+        SyncTask::wake();
+    }
+    return KSuccess;
+}
+
+KResult BlockBasedFileSystem::write_pinned_block(BlockIndex index, const UserOrKernelBuffer& data, size_t count, size_t offset)
+{
+    VERIFY(m_logical_block_size);
+    VERIFY(offset + count <= block_size());
+    dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::write_pinned_block {}, size={}", index, count);
+
+    auto& shard = cache().shard_for(index);
+    MutexLocker locker(shard.lock());
+
+    auto& entry = shard.get(index);
+    if (count < block_size() && !entry.has_data) {
+        if (auto result = fill_entry(entry); result.is_error())
+            return result;
+    }
+    if (!data.read(entry.data + offset, count))
+        return EFAULT;
     entry.has_data = true;
+    shard.pin(entry);
     return KSuccess;
 }
 
+void BlockBasedFileSystem::unpin_block(BlockIndex index)
+{
+    auto& shard = cache().shard_for(index);
+    MutexLocker locker(shard.lock());
+    if (auto* entry = shard.find(index))
+        shard.unpin(*entry);
+}
+
 bool BlockBasedFileSystem::raw_read(BlockIndex index, UserOrKernelBuffer& buffer)
 {
     auto base_offset = index.value() * m_logical_block_size;
-    auto nread = file_description().read(buffer, base_offset, m_logical_block_size);
+    auto nread = read_from_backing_device(buffer, base_offset, m_logical_block_size);
     VERIFY(!nread.is_error());
     VERIFY(nread.value() == m_logical_block_size);
     return true;
@@ -159,7 +123,7 @@ bool BlockBasedFileSystem::raw_read(BlockIndex index, UserOrKernelBuffer& buffer
 bool BlockBasedFileSystem::raw_write(BlockIndex index, const UserOrKernelBuffer& buffer)
 {
     auto base_offset = index.value() * m_logical_block_size;
-    auto nwritten = file_description().write(base_offset, buffer, m_logical_block_size);
+    auto nwritten = write_to_backing_device(base_offset, buffer, m_logical_block_size);
     VERIFY(!nwritten.is_error());
     VERIFY(nwritten.value() == m_logical_block_size);
     return true;
@@ -191,12 +155,27 @@ KResult BlockBasedFileSystem::write_blocks(BlockIndex index, unsigned count, con
 {
     VERIFY(m_logical_block_size);
     dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::write_blocks {}, count={}", index, count);
+    if (allow_cache) {
+        // Writeback merges neighbouring dirty blocks, there's no need to do it here.
+        for (unsigned i = 0; i < count; ++i) {
+            auto result = write_block(BlockIndex { index.value() + i }, data.offset(i * block_size()), block_size(), 0, allow_cache);
+            if (result.is_error())
+                return result;
+        }
+        return KSuccess;
+    }
+
+    // Every block is overwritten as a whole, so cached copies can simply be dropped.
     for (unsigned i = 0; i < count; ++i) {
-        auto result = write_block(BlockIndex { index.value() + i }, data.offset(i * block_size()), block_size(), 0, allow_cache);
-        if (result.is_error())
-            return result;
+        BlockIndex block_index { index.value() + i };
+        auto& shard = cache().shard_for(block_index);
+        MutexLocker locker(shard.lock());
+        if (auto* entry = shard.find(block_index)) {
+            shard.mark_clean(*entry);
+            shard.invalidate(*entry);
+        }
     }
-    return KSuccess;
+    return write_to_device(index, count, data);
 }
 
 KResult BlockBasedFileSystem::read_block(BlockIndex index, UserOrKernelBuffer* buffer, size_t count, size_t offset, bool allow_cache) const
@@ -205,33 +184,145 @@ KResult BlockBasedFileSystem::read_block(BlockIndex index, UserOrKernelBuffer* b
     VERIFY(offset + count <= block_size());
     dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::read_block {}", index);
 
-    MutexLocker locker(m_cache_lock);
+    auto& shard = cache().shard_for(index);
+    MutexLocker locker(shard.lock());
 
     if (!allow_cache) {
-        const_cast<BlockBasedFileSystem*>(this)->flush_specific_block_if_needed(index);
+        auto* entry = shard.find(index);
+        if (entry && entry->is_dirty)
+            shard.flush(*entry);
+        // A pinned block is newer than what's on the device, and mustn't be written back just yet.
+        if (entry && entry->is_pinned) {
+            if (buffer && !buffer->write(entry->data + offset, count))
+                return EFAULT;
+            return KSuccess;
+        }
         auto base_offset = index.value() * block_size() + offset;
-        auto nread = file_description().read(*buffer, base_offset, count);
+        auto nread = read_from_backing_device(*buffer, base_offset, count);
         if (nread.is_error())
             return nread.error();
         VERIFY(nread.value() == count);
         return KSuccess;
     }
 
-    auto& entry = cache().get(index);
+    auto& entry = shard.get(index);
     if (!entry.has_data) {
-        auto base_offset = index.value() * block_size();
-        auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
-        auto nread = file_description().read(entry_data_buffer, base_offset, block_size());
-        if (nread.is_error())
-            return nread.error();
-        VERIFY(nread.value() == block_size());
-        entry.has_data = true;
+        if (auto result = fill_entry(entry); result.is_error())
+            return result;
     }
     if (buffer && !buffer->write(entry.data + offset, count))
         return EFAULT;
     return KSuccess;
 }
 
+KResult BlockBasedFileSystem::fill_entry(CacheEntry& entry) const
+{
+    auto base_offset = entry.block_index.value() * block_size();
+    auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
+    auto nread = read_from_backing_device(entry_data_buffer, base_offset, block_size());
+    if (nread.is_error())
+        return nread.error();
+    VERIFY(nread.value() == block_size());
+    entry.has_data = true;
+    return KSuccess;
+}
+
+KResultOr<size_t> BlockBasedFileSystem::read_from_backing_device(UserOrKernelBuffer& buffer, u64 offset, size_t count) const
+{
+    auto start_time = io_statistics().did_start();
+    auto result = file_description().read(buffer, offset, count);
+    io_statistics().did_finish(IOStatistics::Direction::Read, start_time, result.is_error() ? 0 : result.value(), !result.is_error());
+    return result;
+}
+
+KResultOr<size_t> BlockBasedFileSystem::write_to_backing_device(u64 offset, const UserOrKernelBuffer& buffer, size_t count)
+{
+    auto start_time = io_statistics().did_start();
+    auto result = file_description().write(offset, buffer, count);
+    io_statistics().did_finish(IOStatistics::Direction::Write, start_time, result.is_error() ? 0 : result.value(), !result.is_error());
+    return result;
+}
+
+KResult BlockBasedFileSystem::read_from_device(BlockIndex index, size_t count, UserOrKernelBuffer& buffer) const
+{
+    // The device may split the request up, keep going until we have everything.
+    auto base_offset = index.value() * block_size();
+    size_t nread = 0;
+    while (nread < count * block_size()) {
+        auto buffer_offset = buffer.offset(nread);
+        auto result = read_from_backing_device(buffer_offset, base_offset + nread, count * block_size() - nread);
+        if (result.is_error())
+            return result.error();
+        if (result.value() == 0)
+            return EIO;
+        nread += result.value();
+    }
+    return KSuccess;
+}
+
+KResult BlockBasedFileSystem::write_to_device(BlockIndex index, size_t count, const UserOrKernelBuffer& buffer)
+{
+    auto base_offset = index.value() * block_size();
+    size_t nwritten = 0;
+    while (nwritten < count * block_size()) {
+        auto result = write_to_backing_device(base_offset + nwritten, buffer.offset(nwritten), count * block_size() - nwritten);
+        if (result.is_error())
+            return result.error();
+        if (result.value() == 0)
+            return EIO;
+        nwritten += result.value();
+    }
+    return KSuccess;
+}
+
+KResultOr<bool> BlockBasedFileSystem::read_block_if_cached(BlockIndex index, UserOrKernelBuffer& buffer) const
+{
+    auto& shard = cache().shard_for(index);
+    MutexLocker locker(shard.lock());
+    auto* entry = shard.find(index);
+    if (!entry || !entry->has_data)
+        return false;
+    shard.get(index);
+    if (!buffer.write(entry->data, block_size()))
+        return EFAULT;
+    return true;
+}
+
+bool BlockBasedFileSystem::is_block_cached(BlockIndex index) const
+{
+    auto& shard = cache().shard_for(index);
+    MutexLocker locker(shard.lock());
+    auto* entry = shard.find(index);
+    return entry && entry->has_data;
+}
+
+KResult BlockBasedFileSystem::read_uncached_blocks(BlockIndex index, size_t count, UserOrKernelBuffer& buffer) const
+{
+    // Read the whole run with as few device requests as possible, then put it in the cache.
+    auto bounce_buffer = ByteBuffer::create_uninitialized(count * block_size());
+    auto bounce_user_or_kernel_buffer = UserOrKernelBuffer::for_kernel_buffer(bounce_buffer.data());
+    if (auto result = read_from_device(index, count, bounce_user_or_kernel_buffer); result.is_error())
+        return result;
+
+    for (size_t i = 0; i < count; ++i) {
+        BlockIndex block_index { index.value() + i };
+        auto* block_data = bounce_buffer.data() + i * block_size();
+        auto& shard = cache().shard_for(block_index);
+        MutexLocker locker(shard.lock());
+        auto& entry = shard.get(block_index);
+        if (entry.has_data) {
+            // Someone got to this block while we were reading, their version wins.
+            memcpy(block_data, entry.data, block_size());
+        } else {
+            memcpy(entry.data, block_data, block_size());
+            entry.has_data = true;
+        }
+    }
+    if (!buffer.write(bounce_buffer.data(), count * block_size()))
+        return EFAULT;
+    return KSuccess;
+}
+
 KResult BlockBasedFileSystem::read_blocks(BlockIndex index, unsigned count, UserOrKernelBuffer& buffer, bool allow_cache) const
 {
     VERIFY(m_logical_block_size);
@@ -239,51 +330,63 @@ KResult BlockBasedFileSystem::read_blocks(BlockIndex index, unsigned count, User
         return EINVAL;
     if (count == 1)
         return read_block(index, &buffer, block_size(), 0, allow_cache);
-    auto out = buffer;
-    for (unsigned i = 0; i < count; ++i) {
-        auto result = read_block(BlockIndex { index.value() + i }, &out, block_size(), 0, allow_cache);
-        if (result.is_error())
-            return result;
-        out = out.offset(block_size());
+    dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::read_blocks {}, count={}", index, count);
+
+    if (!allow_cache) {
+        for (unsigned i = 0; i < count; ++i) {
+            BlockIndex block_index { index.value() + i };
+            auto& shard = cache().shard_for(block_index);
+            MutexLocker locker(shard.lock());
+            if (auto* entry = shard.find(block_index); entry && entry->is_dirty)
+                shard.flush(*entry);
+        }
+        return read_from_device(index, count, buffer);
     }
 
+    auto max_run_length = max(max_coalesced_bytes / block_size(), static_cast<size_t>(1));
+    for (size_t i = 0; i < count;) {
+        BlockIndex block_index { index.value() + i };
+        auto out = buffer.offset(i * block_size());
+        auto cached_or_error = read_block_if_cached(block_index, out);
+        if (cached_or_error.is_error())
+            return cached_or_error.error();
+        if (cached_or_error.value()) {
+            ++i;
+            continue;
+        }
+
+        // Merge this miss with the ones right after it into a single read.
+        size_t run_length = 1;
+        while (i + run_length < count && run_length < max_run_length && !is_block_cached(BlockIndex { block_index.value() + run_length }))
+            ++run_length;
+        if (auto result = read_uncached_blocks(block_index, run_length, out); result.is_error())
+            return result;
+        i += run_length;
+    }
     return KSuccess;
 }
 
-void BlockBasedFileSystem::flush_specific_block_if_needed(BlockIndex index)
+void BlockBasedFileSystem::flush_writes_impl()
 {
-    MutexLocker locker(m_cache_lock);
-    if (!cache().is_dirty())
-        return;
-    Vector<CacheEntry*, 32> cleaned_entries;
-    cache().for_each_dirty_entry([&](CacheEntry& entry) {
-        if (entry.block_index != index) {
-            size_t base_offset = entry.block_index.value() * block_size();
-            auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
-            [[maybe_unused]] auto rc = file_description().write(base_offset, entry_data_buffer, block_size());
-            cleaned_entries.append(&entry);
-        }
-    });
-    // NOTE: We make a separate pass to mark entries clean since marking them clean
-    //       moves them out of the dirty list which would disturb the iteration above.
-    for (auto* entry : cleaned_entries)
-        cache().mark_clean(*entry);
+    size_t count = 0;
+    for (auto& shard : cache().shards()) {
+        MutexLocker locker(shard.lock());
+        count += shard.flush_all();
+    }
+    if (count)
+        dbgln("{}: Flushed {} blocks to disk", class_name(), count);
 }
 
-void BlockBasedFileSystem::flush_writes_impl()
+size_t BlockBasedFileSystem::flush_oldest_writes(size_t max_count, Optional<Time> dirtied_before)
 {
-    MutexLocker locker(m_cache_lock);
-    if (!cache().is_dirty())
-        return;
-    u32 count = 0;
-    cache().for_each_dirty_entry([&](CacheEntry& entry) {
-        auto base_offset = entry.block_index.value() * block_size();
-        auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
-        [[maybe_unused]] auto rc = file_description().write(base_offset, entry_data_buffer, block_size());
-        ++count;
-    });
-    cache().mark_all_clean();
-    dbgln("{}: Flushed {} blocks to disk", class_name(), count);
+    size_t count = 0;
+    for (auto& shard : cache().shards()) {
+        if (count >= max_count)
+            break;
+        MutexLocker locker(shard.lock());
+        count += shard.flush_oldest(max_count - count, dirtied_before);
+    }
+    return count;
 }
 
 void BlockBasedFileSystem::flush_writes()
@@ -291,10 +394,42 @@ void BlockBasedFileSystem::flush_writes()
     flush_writes_impl();
 }
 
+void BlockBasedFileSystem::flush_old_writes()
+{
+    // Go in batches, so that writers get a chance at the shard lock in between.
+    auto expired = TimeManagement::the().monotonic_time() - dirty_expire_interval;
+    size_t count = 0;
+    for (auto& shard : cache().shards()) {
+        for (;;) {
+            MutexLocker locker(shard.lock());
+            auto flushed = shard.flush_oldest(writeback_batch_size, expired);
+            count += flushed;
+            if (flushed < writeback_batch_size)
+                break;
+        }
+
+        for (;;) {
+            MutexLocker locker(shard.lock());
+            if (shard.dirty_count() * 100 < shard.capacity() * background_dirty_ratio)
+                break;
+            auto flushed = shard.flush_oldest(writeback_batch_size);
+            count += flushed;
+            if (flushed == 0)
+                break;
+        }
+    }
+
+    if (count)
+        dbgln_if(BBFS_DEBUG, "{}: Wrote back {} blocks", class_name(), count);
+}
+
 DiskCache& BlockBasedFileSystem::cache() const
 {
-    if (!m_cache)
-        m_cache = make<DiskCache>(const_cast<BlockBasedFileSystem&>(*this));
+    if (!m_cache) {
+        MutexLocker locker(m_cache_lock);
+        if (!m_cache)
+            m_cache = make<DiskCache>(const_cast<BlockBasedFileSystem&>(*this));
+    }
     return *m_cache;
 }
 
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <AK/Optional.h>
+#include <AK/Time.h>
 #include <Kernel/FileSystem/FileBackedFileSystem.h>
 
 namespace Kernel {
@@ -19,7 +21,13 @@ public:
     u64 logical_block_size() const { return m_logical_block_size; };
 
     virtual void flush_writes() override;
+    virtual void flush_old_writes() override;
     void flush_writes_impl();
+    size_t flush_oldest_writes(size_t max_count, Optional<Time> dirtied_before = {});
+
+    // All accesses to the underlying device go through these, so they show up in io_statistics().
+    KResultOr<size_t> read_from_backing_device(UserOrKernelBuffer&, u64 offset, size_t count) const;
+    KResultOr<size_t> write_to_backing_device(u64 offset, const UserOrKernelBuffer&, size_t count);
 
 protected:
     explicit BlockBasedFileSystem(FileDescription&);
@@ -36,12 +44,22 @@ protected:
     KResult write_block(BlockIndex, const UserOrKernelBuffer&, size_t count, size_t offset = 0, bool allow_cache = true);
     KResult write_blocks(BlockIndex, unsigned count, const UserOrKernelBuffer&, bool allow_cache = true);
 
+    // Like write_block(), but the block stays in the cache and isn't written back before unpin_block().
+    KResult write_pinned_block(BlockIndex, const UserOrKernelBuffer&, size_t count, size_t offset = 0);
+    void unpin_block(BlockIndex);
+
     u64 m_logical_block_size { 512 };
 
 private:
     DiskCache& cache() const;
-    void flush_specific_block_if_needed(BlockIndex index);
-
+    KResult fill_entry(CacheEntry&) const;
+    KResult read_from_device(BlockIndex, size_t count, UserOrKernelBuffer&) const;
+    KResult write_to_device(BlockIndex, size_t count, const UserOrKernelBuffer&);
+    KResultOr<bool> read_block_if_cached(BlockIndex, UserOrKernelBuffer&) const;
+    bool is_block_cached(BlockIndex) const;
+    KResult read_uncached_blocks(BlockIndex, size_t count, UserOrKernelBuffer&) const;
+
+    // Only guards the creation of m_cache, the cache itself is locked per shard.
     mutable Mutex m_cache_lock;
     mutable OwnPtr<DiskCache> m_cache;
 };
@@ -12,6 +12,8 @@
 
 namespace Kernel {
 
+DEFINE_SLAB_CACHE(Custody);
+
 KResultOr<NonnullRefPtr<Custody>> Custody::try_create(Custody* parent, StringView name, Inode& inode, int mount_flags)
 {
     auto name_kstring = KString::try_create(name);
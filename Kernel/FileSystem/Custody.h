@@ -10,7 +10,7 @@
 #include <AK/RefPtr.h>
 #include <AK/String.h>
 #include <Kernel/Forward.h>
-#include <Kernel/Heap/SlabAllocator.h>
+#include <Kernel/Heap/SlabCache.h>
 #include <Kernel/KResult.h>
 #include <Kernel/KString.h>
 
@@ -19,7 +19,7 @@ namespace Kernel {
 // FIXME: Custody needs some locking.
 
 class Custody : public RefCounted<Custody> {
-    MAKE_SLAB_ALLOCATED(Custody)
+    MAKE_SLAB_CACHED(Custody)
 public:
     static KResultOr<NonnullRefPtr<Custody>> try_create(Custody* parent, StringView name, Inode&, int mount_flags);
 
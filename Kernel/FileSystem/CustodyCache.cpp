@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Singleton.h>
+#include <Kernel/Debug.h>
+#include <Kernel/FileSystem/CustodyCache.h>
+#include <Kernel/FileSystem/Inode.h>
+
+namespace Kernel {
+
+static AK::Singleton<CustodyCache> s_the;
+
+CustodyCache& CustodyCache::the()
+{
+    return *s_the;
+}
+
+CustodyCache::EntryMap::IteratorType CustodyCache::find(InodeIdentifier directory, StringView name)
+{
+    VERIFY(m_lock.is_locked());
+    return m_entries.find(KeyTraits::hash(directory, name), [&](auto& entry) {
+        return entry.key.directory == directory && entry.key.name == name;
+    });
+}
+
+void CustodyCache::remove_entries(EntryMap::IteratorType it, Vector<NonnullOwnPtr<Entry>>& removed_entries)
+{
+    VERIFY(m_lock.is_locked());
+    for (auto& entry : it->value) {
+        m_lru_list.remove(*entry);
+        removed_entries.append(move(entry));
+    }
+    m_entry_count -= it->value.size();
+    m_entries.remove(it);
+}
+
+Optional<RefPtr<Custody>> CustodyCache::lookup(Custody& parent, StringView name)
+{
+    MutexLocker locker(m_lock);
+    auto it = find(parent.inode().identifier(), name);
+    if (it == m_entries.end())
+        return {};
+    for (auto& entry : it->value) {
+        if (entry->parent.ptr() != &parent)
+            continue;
+        m_lru_list.prepend(*entry);
+        return entry->child;
+    }
+    return {};
+}
+
+void CustodyCache::add(Custody& parent, StringView name, RefPtr<Custody> child, u64 generation)
+{
+    // Evicted entries may hold the last reference to a custody and its inode, so they are only destroyed after we let go of the lock.
+    Vector<NonnullOwnPtr<Entry>> removed_entries;
+    MutexLocker locker(m_lock);
+    if (generation != this->generation())
+        return;
+
+    auto directory = parent.inode().identifier();
+    auto it = find(directory, name);
+    if (it == m_entries.end()) {
+        m_entries.set(Key { directory, name }, {});
+        it = find(directory, name);
+    }
+    for (auto& entry : it->value) {
+        if (entry->parent.ptr() == &parent) {
+            entry->child = move(child);
+            m_lru_list.prepend(*entry);
+            return;
+        }
+    }
+
+    auto entry = adopt_own_if_nonnull(new (nothrow) Entry(Key { directory, String(name) }, parent, move(child)));
+    if (!entry)
+        return;
+    m_lru_list.prepend(*entry);
+    it->value.append(entry.release_nonnull());
+    ++m_entry_count;
+
+    while (m_entry_count > max_entry_count) {
+        auto& victim = *m_lru_list.last();
+        auto victim_it = find(victim.key.directory, victim.key.name);
+        VERIFY(victim_it != m_entries.end());
+        auto& victim_entries = victim_it->value;
+        for (size_t i = 0; i < victim_entries.size(); ++i) {
+            if (victim_entries[i].ptr() != &victim)
+                continue;
+            m_lru_list.remove(victim);
+            removed_entries.append(victim_entries.take(i));
+            --m_entry_count;
+            break;
+        }
+        if (victim_entries.is_empty())
+            m_entries.remove(victim_it);
+    }
+}
+
+void CustodyCache::invalidate(InodeIdentifier directory, StringView name)
+{
+    Vector<NonnullOwnPtr<Entry>> removed_entries;
+    MutexLocker locker(m_lock);
+    bump_generation();
+    auto it = find(directory, name);
+    if (it == m_entries.end())
+        return;
+    dbgln_if(CUSTODY_CACHE_DEBUG, "CustodyCache: Invalidating '{}' in directory {}", name, directory);
+    remove_entries(it, removed_entries);
+}
+
+void CustodyCache::invalidate_directory(InodeIdentifier directory)
+{
+    Vector<NonnullOwnPtr<Entry>> removed_entries;
+    MutexLocker locker(m_lock);
+    bump_generation();
+    // NOTE: This walks the whole cache, but it's only needed when a directory is deleted.
+    Vector<String> names;
+    for (auto& it : m_entries) {
+        if (it.key.directory == directory)
+            names.append(it.key.name);
+    }
+    for (auto& name : names)
+        remove_entries(find(directory, name), removed_entries);
+}
+
+void CustodyCache::clear()
+{
+    Vector<NonnullOwnPtr<Entry>> removed_entries;
+    MutexLocker locker(m_lock);
+    bump_generation();
+    for (auto& it : m_entries) {
+        for (auto& entry : it.value) {
+            m_lru_list.remove(*entry);
+            removed_entries.append(move(entry));
+        }
+    }
+    m_entries.clear();
+    m_entry_count = 0;
+}
+
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/Optional.h>
+#include <AK/String.h>
+#include <Kernel/FileSystem/Custody.h>
+#include <Kernel/FileSystem/InodeIdentifier.h>
+#include <Kernel/Mutex.h>
+
+namespace Kernel {
+
+// The custody cache remembers what looking up a name in a directory custody resulted in, including names
+// that don't exist, so path resolution doesn't have to go to the file system for every path component.
+// Only directories on file systems that support watchers are cached, since entries are invalidated
+// through the same child added/removed hooks that feed the InodeWatchers.
+class CustodyCache {
+public:
+    static CustodyCache& the();
+
+    // Bumped by every invalidation. Grab it before doing the slow lookup, and hand it back to add(),
+    // so a result that raced with a change to the directory is never cached.
+    u64 generation() const { return m_generation.load(AK::MemoryOrder::memory_order_acquire); }
+
+    // Returns an empty Optional on a miss, and a null custody if the name is known not to exist.
+    Optional<RefPtr<Custody>> lookup(Custody& parent, StringView name);
+    void add(Custody& parent, StringView name, RefPtr<Custody> child, u64 generation);
+
+    void invalidate(InodeIdentifier directory, StringView name);
+    void invalidate_directory(InodeIdentifier directory);
+    void clear();
+
+private:
+    struct Key {
+        InodeIdentifier directory;
+        String name;
+
+        bool operator==(Key const& other) const { return directory == other.directory && name == other.name; }
+    };
+
+    struct KeyTraits : public GenericTraits<Key> {
+        static unsigned hash(Key const& key) { return hash(key.directory, key.name); }
+        static unsigned hash(InodeIdentifier directory, StringView name)
+        {
+            return pair_int_hash(pair_int_hash(directory.fsid(), u64_hash(directory.index().value())), name.hash());
+        }
+    };
+
+    struct Entry {
+        Entry(Key key, NonnullRefPtr<Custody> parent, RefPtr<Custody> child)
+            : key(move(key))
+            , parent(move(parent))
+            , child(move(child))
+        {
+        }
+
+        Key key;
+        NonnullRefPtr<Custody> parent;
+        RefPtr<Custody> child;
+        IntrusiveListNode<Entry> m_list_node;
+
+        using List = IntrusiveList<Entry, RawPtr<Entry>, &Entry::m_list_node>;
+    };
+
+    // Several custodies can refer to the same directory, e.g. through bind mounts or a chroot.
+    using EntryList = Vector<NonnullOwnPtr<Entry>, 1>;
+    using EntryMap = HashMap<Key, EntryList, KeyTraits>;
+
+    EntryMap::IteratorType find(InodeIdentifier directory, StringView name);
+    void remove_entries(EntryMap::IteratorType, Vector<NonnullOwnPtr<Entry>>& removed_entries);
+    void bump_generation() { m_generation.fetch_add(1, AK::MemoryOrder::memory_order_acq_rel); }
+
+    static constexpr size_t max_entry_count = 4096;
+
+    Mutex m_lock { "CustodyCache" };
+    Atomic<u64> m_generation { 0 };
+    EntryMap m_entries;
+    Entry::List m_lru_list;
+    size_t m_entry_count { 0 };
+};
+
+}
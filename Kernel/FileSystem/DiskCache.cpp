@@ -0,0 +1,513 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/AnyOf.h>
+#include <AK/JsonArraySerializer.h>
+#include <AK/JsonObjectSerializer.h>
+#include <Kernel/Arch/x86/Processor.h>
+#include <Kernel/Debug.h>
+#include <Kernel/FileSystem/DiskCache.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/FileSystem/SysFS.h>
+#include <Kernel/FileSystem/SysFSComponent.h>
+#include <Kernel/KBufferBuilder.h>
+#include <Kernel/Sections.h>
+#include <Kernel/VM/MemoryManager.h>
+
+namespace Kernel {
+
+// Every cache gets at least this many entries, and may grow up to RAM / max_capacity_ram_divisor.
+static constexpr size_t min_capacity_in_entries = 1024;
+static constexpr size_t max_capacity_ram_divisor = 8;
+static constexpr size_t max_shard_count = 16;
+static constexpr size_t max_victim_scan_length = 64;
+static constexpr size_t forced_writeback_batch_size = 32;
+
+static Mutex s_all_caches_lock { "DiskCache" };
+static DiskCache::List* s_all_caches;
+
+DiskCacheShard::DiskCacheShard(DiskCache& cache)
+    : m_cache(cache)
+{
+}
+
+DiskCacheShard::~DiskCacheShard()
+{
+    while (auto* ghost = m_recent_ghost_list.first())
+        forget_ghost(*ghost);
+    while (auto* ghost = m_frequent_ghost_list.first())
+        forget_ghost(*ghost);
+}
+
+void DiskCacheShard::move_to_list(CacheEntry& entry, CacheEntry::List list)
+{
+    switch (entry.list) {
+    case CacheEntry::List::Free:
+        break;
+    case CacheEntry::List::Recent:
+        --m_recent_count;
+        break;
+    case CacheEntry::List::Frequent:
+        --m_frequent_count;
+        break;
+    case CacheEntry::List::Pinned:
+        --m_pinned_count;
+        break;
+    }
+
+    entry.list = list;
+    switch (list) {
+    case CacheEntry::List::Free:
+        m_free_list.prepend(entry);
+        break;
+    case CacheEntry::List::Recent:
+        ++m_recent_count;
+        m_recent_list.prepend(entry);
+        break;
+    case CacheEntry::List::Frequent:
+        ++m_frequent_count;
+        m_frequent_list.prepend(entry);
+        break;
+    case CacheEntry::List::Pinned:
+        ++m_pinned_count;
+        m_pinned_list.prepend(entry);
+        break;
+    }
+}
+
+CacheEntry* DiskCacheShard::find(BlockBasedFileSystem::BlockIndex block_index)
+{
+    auto it = m_entries.find(block_index);
+    if (it == m_entries.end())
+        return nullptr;
+    return it->value;
+}
+
+CacheEntry& DiskCacheShard::get(BlockBasedFileSystem::BlockIndex block_index)
+{
+    if (auto* entry = find(block_index)) {
+        VERIFY(entry->block_index == block_index);
+        ++m_hit_count;
+        if (!entry->is_pinned)
+            move_to_list(*entry, CacheEntry::List::Frequent);
+        return *entry;
+    }
+    ++m_miss_count;
+
+    auto list = CacheEntry::List::Recent;
+    bool after_frequent_ghost_hit = false;
+    if (auto it = m_ghosts.find(block_index); it != m_ghosts.end()) {
+        // We evicted this block not too long ago. Make more room for the list it was evicted from.
+        auto& ghost = *it->value;
+        if (ghost.was_frequent) {
+            auto delta = max(m_recent_ghost_count / m_frequent_ghost_count, static_cast<size_t>(1));
+            m_target_recent_count -= min(delta, m_target_recent_count);
+            after_frequent_ghost_hit = true;
+        } else {
+            auto delta = max(m_frequent_ghost_count / m_recent_ghost_count, static_cast<size_t>(1));
+            m_target_recent_count = min(m_target_recent_count + delta, capacity());
+        }
+        forget_ghost(ghost);
+        list = CacheEntry::List::Frequent;
+    } else if (m_recent_count + m_recent_ghost_count >= capacity() && m_recent_ghost_count) {
+        forget_ghost(*m_recent_ghost_list.last());
+    } else if (resident_count() + ghost_count() >= 2 * capacity() && m_frequent_ghost_count) {
+        forget_ghost(*m_frequent_ghost_list.last());
+    }
+
+    auto& entry = take_entry(after_frequent_ghost_hit);
+    entry.block_index = block_index;
+    entry.has_data = false;
+    m_entries.set(block_index, &entry);
+    move_to_list(entry, list);
+    return entry;
+}
+
+CacheEntry& DiskCacheShard::take_entry(bool after_frequent_ghost_hit)
+{
+    for (;;) {
+        if (auto* entry = m_free_list.first())
+            return *entry;
+        if (m_cache.may_grow() && grow())
+            continue;
+        if (auto* victim = find_victim(after_frequent_ghost_hit)) {
+            evict(*victim);
+            return *victim;
+        }
+        // Everything we looked at is dirty, write back the oldest entries and try again.
+        dbgln_if(BBFS_DEBUG, "DiskCacheShard: No clean entry to evict, writing back {} entries", forced_writeback_batch_size);
+        if (flush_oldest(forced_writeback_batch_size))
+            continue;
+        // Whatever is left is pinned, going over the limit is the only way forward.
+        dbgln("DiskCacheShard: All {} entries are pinned, growing beyond the limit", capacity());
+        VERIFY(grow());
+    }
+}
+
+CacheEntry* DiskCacheShard::find_victim(bool after_frequent_ghost_hit)
+{
+    auto find_clean_lru_entry = [](EntryList& list) -> CacheEntry* {
+        size_t scanned = 0;
+        for (auto it = list.rbegin(); it != list.rend() && scanned < max_victim_scan_length; ++it, ++scanned) {
+            if (!it->is_dirty)
+                return &*it;
+        }
+        return nullptr;
+    };
+
+    bool prefer_recent = m_recent_count && (m_recent_count > m_target_recent_count || (after_frequent_ghost_hit && m_recent_count == m_target_recent_count));
+    auto& preferred_list = prefer_recent ? m_recent_list : m_frequent_list;
+    auto& other_list = prefer_recent ? m_frequent_list : m_recent_list;
+    if (auto* victim = find_clean_lru_entry(preferred_list))
+        return victim;
+    return find_clean_lru_entry(other_list);
+}
+
+void DiskCacheShard::evict(CacheEntry& entry)
+{
+    VERIFY(!entry.is_dirty);
+    VERIFY(entry.list != CacheEntry::List::Free);
+    ++m_eviction_count;
+    m_entries.remove(entry.block_index);
+    remember_ghost(entry.block_index, entry.list == CacheEntry::List::Frequent);
+    move_to_list(entry, CacheEntry::List::Free);
+}
+
+void DiskCacheShard::invalidate(CacheEntry& entry)
+{
+    VERIFY(!entry.is_dirty);
+    entry.is_pinned = false;
+    m_entries.remove(entry.block_index);
+    move_to_list(entry, CacheEntry::List::Free);
+}
+
+void DiskCacheShard::remember_ghost(BlockBasedFileSystem::BlockIndex block_index, bool was_frequent)
+{
+    auto* ghost = new (nothrow) GhostEntry;
+    if (!ghost)
+        return;
+    ghost->block_index = block_index;
+    ghost->was_frequent = was_frequent;
+    m_ghosts.set(block_index, ghost);
+    if (was_frequent) {
+        ++m_frequent_ghost_count;
+        m_frequent_ghost_list.prepend(*ghost);
+    } else {
+        ++m_recent_ghost_count;
+        m_recent_ghost_list.prepend(*ghost);
+    }
+    trim_ghosts();
+}
+
+void DiskCacheShard::forget_ghost(GhostEntry& ghost)
+{
+    if (ghost.was_frequent) {
+        --m_frequent_ghost_count;
+        m_frequent_ghost_list.remove(ghost);
+    } else {
+        --m_recent_ghost_count;
+        m_recent_ghost_list.remove(ghost);
+    }
+    m_ghosts.remove(ghost.block_index);
+    delete &ghost;
+}
+
+void DiskCacheShard::trim_ghosts()
+{
+    while (ghost_count() > capacity()) {
+        auto& list = m_frequent_ghost_count > m_recent_ghost_count ? m_frequent_ghost_list : m_recent_ghost_list;
+        forget_ghost(*list.last());
+    }
+}
+
+void DiskCacheShard::mark_dirty(CacheEntry& entry)
+{
+    // Keep the entry where it is if it's already dirty, its age counts from the first write.
+    // Pinned entries become dirty once they're unpinned.
+    if (entry.is_dirty || entry.is_pinned)
+        return;
+    entry.is_dirty = true;
+    entry.dirtied_at = TimeManagement::the().monotonic_time();
+    ++m_dirty_count;
+    m_dirty_list.prepend(entry);
+}
+
+void DiskCacheShard::mark_clean(CacheEntry& entry)
+{
+    if (!entry.is_dirty)
+        return;
+    entry.is_dirty = false;
+    --m_dirty_count;
+    m_dirty_list.remove(entry);
+}
+
+void DiskCacheShard::pin(CacheEntry& entry)
+{
+    VERIFY(entry.has_data);
+    if (entry.is_pinned)
+        return;
+    mark_clean(entry);
+    entry.is_pinned = true;
+    move_to_list(entry, CacheEntry::List::Pinned);
+}
+
+void DiskCacheShard::unpin(CacheEntry& entry)
+{
+    if (!entry.is_pinned)
+        return;
+    entry.is_pinned = false;
+    move_to_list(entry, CacheEntry::List::Recent);
+    mark_dirty(entry);
+}
+
+size_t DiskCacheShard::flush(CacheEntry& entry)
+{
+    VERIFY(entry.is_dirty);
+    auto& fs = m_cache.fs();
+    auto block_size = fs.block_size();
+
+    auto is_dirty_block = [&](u64 block_index) {
+        auto* neighbour = find(BlockBasedFileSystem::BlockIndex { block_index });
+        return neighbour && neighbour->is_dirty;
+    };
+    auto first = entry.block_index.value();
+    auto end = first + 1;
+    while (first > 0 && end - first < DiskCache::blocks_per_shard_run && is_dirty_block(first - 1))
+        --first;
+    while (end - first < DiskCache::blocks_per_shard_run && is_dirty_block(end))
+        ++end;
+    size_t count = end - first;
+
+    if (count == 1) {
+        auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
+        [[maybe_unused]] auto rc = fs.write_to_backing_device(first * block_size, entry_data_buffer, block_size);
+        mark_clean(entry);
+        return 1;
+    }
+
+    dbgln_if(BBFS_DEBUG, "DiskCacheShard: Writing back blocks {} to {} together", first, end - 1);
+    if (m_writeback_buffer.size() < count * block_size)
+        m_writeback_buffer.resize(DiskCache::blocks_per_shard_run * block_size);
+    for (auto block_index = first; block_index < end; ++block_index)
+        memcpy(m_writeback_buffer.data() + (block_index - first) * block_size, find(BlockBasedFileSystem::BlockIndex { block_index })->data, block_size);
+
+    // The device may split the request up, keep going until it has taken everything.
+    auto buffer = UserOrKernelBuffer::for_kernel_buffer(m_writeback_buffer.data());
+    size_t nwritten = 0;
+    while (nwritten < count * block_size) {
+        auto result = fs.write_to_backing_device(first * block_size + nwritten, buffer.offset(nwritten), count * block_size - nwritten);
+        if (result.is_error() || result.value() == 0)
+            break;
+        nwritten += result.value();
+    }
+
+    for (auto block_index = first; block_index < end; ++block_index)
+        mark_clean(*find(BlockBasedFileSystem::BlockIndex { block_index }));
+    return count;
+}
+
+size_t DiskCacheShard::flush_oldest(size_t max_count, Optional<Time> dirtied_before)
+{
+    size_t count = 0;
+    while (count < max_count) {
+        auto* entry = m_dirty_list.last();
+        if (!entry)
+            break;
+        if (dirtied_before.has_value() && entry->dirtied_at >= dirtied_before.value())
+            break;
+        count += flush(*entry);
+    }
+    return count;
+}
+
+size_t DiskCacheShard::flush_all()
+{
+    return flush_oldest(NumericLimits<size_t>::max());
+}
+
+bool DiskCacheShard::grow()
+{
+    auto block_size = m_cache.fs().block_size();
+    auto chunk = adopt_own_if_nonnull(new (nothrow) Chunk);
+    if (!chunk)
+        return false;
+    chunk->data = KBuffer::try_create_with_size(entries_per_chunk * block_size, Region::Access::Read | Region::Access::Write, "DiskCache");
+    if (!chunk->data)
+        return false;
+    if (!m_chunks.try_ensure_capacity(m_chunks.size() + 1))
+        return false;
+
+    for (size_t i = 0; i < entries_per_chunk; ++i) {
+        auto& entry = chunk->entries[i];
+        entry.data = chunk->data->data() + i * block_size;
+        m_free_list.append(entry);
+    }
+    m_chunks.unchecked_append(chunk.release_nonnull());
+    m_cache.did_change_capacity(entries_per_chunk);
+    return true;
+}
+
+size_t DiskCacheShard::shrink(size_t min_capacity)
+{
+    size_t released_entry_count = 0;
+    while (capacity() > min_capacity && capacity() > entries_per_chunk) {
+        // Give up the most recently added chunk; whatever it caches, hot or not, has to go.
+        // Pinned entries can't go anywhere, so they keep their chunk around.
+        auto& chunk = m_chunks.last();
+        if (any_of(chunk.entries, [](auto& entry) { return entry.is_pinned; }))
+            break;
+        for (auto& entry : chunk.entries) {
+            if (entry.is_dirty)
+                flush(entry);
+            if (entry.list != CacheEntry::List::Free)
+                m_entries.remove(entry.block_index);
+            move_to_list(entry, CacheEntry::List::Free);
+            m_free_list.remove(entry);
+        }
+        m_chunks.take_last();
+        m_cache.did_change_capacity(-static_cast<ssize_t>(entries_per_chunk));
+        released_entry_count += entries_per_chunk;
+    }
+    m_target_recent_count = min(m_target_recent_count, capacity());
+    trim_ghosts();
+    return released_entry_count;
+}
+
+DiskCache::DiskCache(BlockBasedFileSystem& fs)
+    : m_fs(fs)
+{
+    size_t shard_count = 1;
+    while (shard_count < Processor::count() * 2 && shard_count < max_shard_count)
+        shard_count *= 2;
+
+    auto ram_in_entries = MM.get_system_memory_info().user_physical_pages * PAGE_SIZE / fs.block_size();
+    m_min_capacity = max(min_capacity_in_entries, shard_count * DiskCacheShard::entries_per_chunk);
+    m_max_capacity = max(m_min_capacity, static_cast<size_t>(ram_in_entries / max_capacity_ram_divisor));
+
+    auto min_shard_capacity = m_min_capacity / shard_count;
+    for (size_t i = 0; i < shard_count; ++i) {
+        auto shard = make<DiskCacheShard>(*this);
+        MutexLocker locker(shard->lock());
+        while (shard->capacity() < min_shard_capacity)
+            VERIFY(shard->grow());
+        m_shards.append(move(shard));
+    }
+
+    dbgln_if(BBFS_DEBUG, "DiskCache: {} shards, {} to {} entries of {} bytes", shard_count, m_min_capacity, m_max_capacity, fs.block_size());
+
+    MutexLocker locker(s_all_caches_lock);
+    if (!s_all_caches)
+        s_all_caches = new DiskCache::List;
+    s_all_caches->append(*this);
+}
+
+DiskCache::~DiskCache()
+{
+    MutexLocker locker(s_all_caches_lock);
+    s_all_caches->remove(*this);
+}
+
+bool DiskCache::may_grow() const
+{
+    if (m_capacity + DiskCacheShard::entries_per_chunk > m_max_capacity)
+        return false;
+    return MM.memory_pressure_level() == MemoryPressureLevel::None;
+}
+
+size_t DiskCache::shrink()
+{
+    if (m_capacity <= m_min_capacity)
+        return 0;
+    auto target_capacity = m_capacity - (m_capacity - m_min_capacity) / 4;
+    auto min_shard_capacity = max(target_capacity / m_shards.size(), m_min_capacity / m_shards.size());
+
+    size_t released_entry_count = 0;
+    for (auto& shard : m_shards) {
+        MutexLocker locker(shard.lock());
+        released_entry_count += shard.shrink(min_shard_capacity);
+    }
+    return released_entry_count * m_fs.block_size() / PAGE_SIZE;
+}
+
+size_t DiskCache::shrink_all()
+{
+    MutexLocker locker(s_all_caches_lock);
+    if (!s_all_caches)
+        return 0;
+    size_t released_page_count = 0;
+    for (auto& cache : *s_all_caches)
+        released_page_count += cache.shrink();
+    return released_page_count;
+}
+
+class DiskCacheSysFSComponent final : public SysFSComponent {
+public:
+    static NonnullRefPtr<DiskCacheSysFSComponent> must_create()
+    {
+        return adopt_ref(*new (nothrow) DiskCacheSysFSComponent);
+    }
+
+    virtual KResultOr<size_t> read_bytes(off_t offset, size_t count, UserOrKernelBuffer& buffer, FileDescription*) const override
+    {
+        KBufferBuilder builder;
+        {
+            JsonArraySerializer array { builder };
+            MutexLocker locker(s_all_caches_lock);
+            if (s_all_caches) {
+                for (auto& cache : *s_all_caches) {
+                    u64 hits = 0;
+                    u64 misses = 0;
+                    u64 evictions = 0;
+                    size_t capacity = 0;
+                    size_t dirty = 0;
+                    size_t pinned = 0;
+                    for (auto& shard : cache.shards()) {
+                        MutexLocker shard_locker(shard.lock());
+                        hits += shard.hit_count();
+                        misses += shard.miss_count();
+                        evictions += shard.eviction_count();
+                        capacity += shard.capacity();
+                        dirty += shard.dirty_count();
+                        pinned += shard.pinned_count();
+                    }
+                    auto object = array.add_object();
+                    object.add("fsid", cache.fs().fsid());
+                    object.add("class_name", cache.fs().class_name());
+                    object.add("block_size", cache.fs().block_size());
+                    object.add("shards", cache.shards().size());
+                    object.add("capacity", capacity);
+                    object.add("dirty", dirty);
+                    object.add("pinned", pinned);
+                    object.add("hits", hits);
+                    object.add("misses", misses);
+                    object.add("evictions", evictions);
+                }
+            }
+        }
+        auto data = builder.build();
+        if (!data)
+            return ENOMEM;
+        if (static_cast<size_t>(offset) >= data->size())
+            return 0;
+        auto nread = min(static_cast<size_t>(data->size() - offset), count);
+        if (!buffer.write(data->data() + offset, nread))
+            return EFAULT;
+        return nread;
+    }
+
+private:
+    DiskCacheSysFSComponent()
+        : SysFSComponent("block_cache"sv)
+    {
+    }
+};
+
+UNMAP_AFTER_INIT void DiskCache::initialize_sysfs_component()
+{
+    SysFSComponentRegistry::the().register_new_component(DiskCacheSysFSComponent::must_create());
+}
+
+}
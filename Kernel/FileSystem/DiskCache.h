@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/Atomic.h>
+#include <AK/ByteBuffer.h>
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/Optional.h>
+#include <AK/Time.h>
+#include <Kernel/FileSystem/BlockBasedFileSystem.h>
+#include <Kernel/KBuffer.h>
+#include <Kernel/Mutex.h>
+
+namespace Kernel {
+
+struct CacheEntry {
+    enum class List : u8 {
+        Free,
+        Recent,
+        Frequent,
+        Pinned,
+    };
+
+    IntrusiveListNode<CacheEntry> list_node;
+    IntrusiveListNode<CacheEntry> dirty_list_node;
+    BlockBasedFileSystem::BlockIndex block_index { 0 };
+    u8* data { nullptr };
+    Time dirtied_at;
+    List list { List::Free };
+    bool has_data { false };
+    bool is_dirty { false };
+    bool is_pinned { false };
+};
+
+class DiskCache;
+
+// One lock's worth of a DiskCache. Entries are replaced with ARC: blocks used once (recent)
+// compete with blocks used again (frequent), and hits on recently evicted blocks ("ghosts")
+// shift the balance towards whichever list would have kept them.
+// All functions except the constructor must be called with lock() held.
+class DiskCacheShard {
+    AK_MAKE_NONCOPYABLE(DiskCacheShard);
+    AK_MAKE_NONMOVABLE(DiskCacheShard);
+
+public:
+    static constexpr size_t entries_per_chunk = 64;
+
+    explicit DiskCacheShard(DiskCache&);
+    ~DiskCacheShard();
+
+    Mutex& lock() { return m_lock; }
+
+    CacheEntry& get(BlockBasedFileSystem::BlockIndex);
+    CacheEntry* find(BlockBasedFileSystem::BlockIndex);
+    void invalidate(CacheEntry&);
+
+    void mark_dirty(CacheEntry&);
+    void mark_clean(CacheEntry&);
+    // Pinned entries are neither written back nor evicted until they are unpinned, which leaves them dirty.
+    void pin(CacheEntry&);
+    void unpin(CacheEntry&);
+    size_t pinned_count() const { return m_pinned_count; }
+    bool is_dirty() const { return m_dirty_count != 0; }
+    size_t dirty_count() const { return m_dirty_count; }
+    size_t capacity() const { return m_chunks.size() * entries_per_chunk; }
+
+    // Writes back the entry together with its dirty neighbours, returns the number of written entries.
+    size_t flush(CacheEntry&);
+    // Writes back (at most max_count of) the entries that have been dirty the longest.
+    size_t flush_oldest(size_t max_count, Optional<Time> dirtied_before = {});
+    size_t flush_all();
+
+    bool grow();
+    size_t shrink(size_t min_capacity);
+
+    u64 hit_count() const { return m_hit_count; }
+    u64 miss_count() const { return m_miss_count; }
+    u64 eviction_count() const { return m_eviction_count; }
+
+private:
+    struct GhostEntry {
+        IntrusiveListNode<GhostEntry> list_node;
+        BlockBasedFileSystem::BlockIndex block_index { 0 };
+        bool was_frequent { false };
+    };
+    using GhostList = IntrusiveList<GhostEntry, RawPtr<GhostEntry>, &GhostEntry::list_node>;
+
+    struct Chunk {
+        OwnPtr<KBuffer> data;
+        Array<CacheEntry, entries_per_chunk> entries;
+    };
+
+    using EntryList = IntrusiveList<CacheEntry, RawPtr<CacheEntry>, &CacheEntry::list_node>;
+    using DirtyList = IntrusiveList<CacheEntry, RawPtr<CacheEntry>, &CacheEntry::dirty_list_node>;
+
+    void move_to_list(CacheEntry&, CacheEntry::List);
+    CacheEntry& take_entry(bool after_frequent_ghost_hit);
+    CacheEntry* find_victim(bool after_frequent_ghost_hit);
+    void evict(CacheEntry&);
+    void remember_ghost(BlockBasedFileSystem::BlockIndex, bool was_frequent);
+    void forget_ghost(GhostEntry&);
+    void trim_ghosts();
+    size_t resident_count() const { return m_recent_count + m_frequent_count; }
+    size_t ghost_count() const { return m_recent_ghost_count + m_frequent_ghost_count; }
+
+    DiskCache& m_cache;
+    Mutex m_lock { "DiskCacheShard" };
+    ByteBuffer m_writeback_buffer;
+
+    NonnullOwnPtrVector<Chunk> m_chunks;
+    HashMap<BlockBasedFileSystem::BlockIndex, CacheEntry*> m_entries;
+    HashMap<BlockBasedFileSystem::BlockIndex, GhostEntry*> m_ghosts;
+
+    EntryList m_free_list;
+    EntryList m_recent_list;
+    EntryList m_frequent_list;
+    EntryList m_pinned_list;
+    GhostList m_recent_ghost_list;
+    GhostList m_frequent_ghost_list;
+    DirtyList m_dirty_list;
+
+    size_t m_recent_count { 0 };
+    size_t m_frequent_count { 0 };
+    size_t m_pinned_count { 0 };
+    size_t m_recent_ghost_count { 0 };
+    size_t m_frequent_ghost_count { 0 };
+    size_t m_dirty_count { 0 };
+    // ARC's "p": how many of the resident entries should be recent ones.
+    size_t m_target_recent_count { 0 };
+
+    u64 m_hit_count { 0 };
+    u64 m_miss_count { 0 };
+    u64 m_eviction_count { 0 };
+};
+
+// The block cache of a BlockBasedFileSystem. Blocks are spread over a power-of-two number of
+// shards (scaled with the processor count), so that accesses to different blocks rarely contend.
+// The cache starts small, grows while memory is plentiful, and is shrunk by ReclaimTask.
+class DiskCache {
+    AK_MAKE_NONCOPYABLE(DiskCache);
+    AK_MAKE_NONMOVABLE(DiskCache);
+
+public:
+    // Neighbouring blocks share a shard, so that runs of them can be written back together.
+    static constexpr size_t blocks_per_shard_run = 16;
+
+    explicit DiskCache(BlockBasedFileSystem&);
+    ~DiskCache();
+
+    BlockBasedFileSystem& fs() { return m_fs; }
+    DiskCacheShard& shard_for(BlockBasedFileSystem::BlockIndex block_index) { return m_shards[(block_index.value() / blocks_per_shard_run) & (m_shards.size() - 1)]; }
+    NonnullOwnPtrVector<DiskCacheShard>& shards() { return m_shards; }
+
+    bool may_grow() const;
+    void did_change_capacity(ssize_t delta) { m_capacity += delta; }
+
+    // Shrinks every block cache by a quarter of what it has grown beyond its minimum, returns the number of freed pages.
+    static size_t shrink_all();
+    static void initialize_sysfs_component();
+
+private:
+    size_t shrink();
+
+    BlockBasedFileSystem& m_fs;
+    NonnullOwnPtrVector<DiskCacheShard> m_shards;
+    Atomic<size_t> m_capacity { 0 };
+    size_t m_min_capacity { 0 };
+    size_t m_max_capacity { 0 };
+
+    IntrusiveListNode<DiskCache> m_list_node;
+
+public:
+    using List = IntrusiveList<DiskCache, RawPtr<DiskCache>, &DiskCache::m_list_node>;
+};
+
+}
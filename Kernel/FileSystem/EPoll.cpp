@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Debug.h>
+#include <Kernel/FileSystem/EPoll.h>
+#include <Kernel/FileSystem/FileDescription.h>
+
+namespace Kernel {
+
+static constexpr u32 supported_events = EPOLLIN | EPOLLPRI | EPOLLOUT | EPOLLERR | EPOLLHUP | EPOLLRDHUP | EPOLLONESHOT | EPOLLET;
+
+KResultOr<NonnullRefPtr<EPoll>> EPoll::create()
+{
+    auto epoll = adopt_ref_if_nonnull(new (nothrow) EPoll);
+    if (epoll)
+        return epoll.release_nonnull();
+    return ENOMEM;
+}
+
+EPoll::~EPoll()
+{
+    for (auto& it : m_interests)
+        forget_interest(*it.value);
+}
+
+EPoll::Interest::Interest(EPoll& epoll, int fd, FileDescription& description, const epoll_event& event)
+    : epoll(epoll)
+    , fd(fd)
+    , file(description.file())
+    , description(description)
+    , events(event.events)
+    , data(event.data)
+{
+}
+
+u32 EPoll::Interest::ready_events(FileDescription& description) const
+{
+    using BlockFlags = Thread::FileBlocker::BlockFlags;
+    // Errors and hangups are always reported, just like with poll().
+    BlockFlags block_flags = BlockFlags::Exception;
+    if (events & EPOLLIN)
+        block_flags |= BlockFlags::Read;
+    if (events & EPOLLOUT)
+        block_flags |= BlockFlags::Write;
+    if (events & EPOLLPRI)
+        block_flags |= BlockFlags::ReadPriority;
+
+    auto unblock_flags = description.should_unblock(block_flags);
+    u32 ready_events = 0;
+    if (has_flag(unblock_flags, BlockFlags::Read))
+        ready_events |= EPOLLIN;
+    if (has_flag(unblock_flags, BlockFlags::Write))
+        ready_events |= EPOLLOUT;
+    if (has_flag(unblock_flags, BlockFlags::ReadPriority))
+        ready_events |= EPOLLPRI;
+    if (has_flag(unblock_flags, BlockFlags::ReadHangUp))
+        ready_events |= EPOLLRDHUP;
+    if (has_flag(unblock_flags, BlockFlags::WriteError))
+        ready_events |= EPOLLERR;
+    if (has_flag(unblock_flags, BlockFlags::WriteHangUp))
+        ready_events |= EPOLLHUP;
+    return ready_events;
+}
+
+bool EPoll::can_read(const FileDescription&, size_t) const
+{
+    ScopedSpinLock lock(m_ready_lock);
+    return !m_ready_list.is_empty();
+}
+
+String EPoll::absolute_path(const FileDescription&) const
+{
+    return String::formatted("EPoll:({})", m_interests.size());
+}
+
+KResult EPoll::add_interest(int fd, FileDescription& description, const epoll_event& event)
+{
+    // Nesting could make the notifications go around in circles, so we don't allow it at all.
+    if (description.is_epoll())
+        return EINVAL;
+    if (event.events & ~supported_events)
+        return EINVAL;
+
+    MutexLocker locker(m_interests_lock);
+    if (auto it = m_interests.find(fd); it != m_interests.end()) {
+        if (it->value->description.strong_ref())
+            return EEXIST;
+        // The fd has been closed and reused since, so the old interest is stale.
+        forget_interest(*it->value);
+        m_interests.remove(it);
+    }
+
+    auto interest = adopt_own_if_nonnull(new (nothrow) Interest(*this, fd, description, event));
+    if (!interest)
+        return ENOMEM;
+    auto& new_interest = *interest;
+    m_interests.set(fd, interest.release_nonnull());
+    description.block_condition().add_watcher(new_interest);
+    dbgln_if(EPOLL_DEBUG, "EPoll @ {}: Added interest in fd {} for events {:#x}", this, fd, event.events);
+
+    // Whatever state the file is in already needs to be looked at by the next wait.
+    interest_may_be_ready(new_interest);
+    return KSuccess;
+}
+
+KResult EPoll::modify_interest(int fd, FileDescription& description, const epoll_event& event)
+{
+    if (event.events & ~supported_events)
+        return EINVAL;
+
+    MutexLocker locker(m_interests_lock);
+    auto it = m_interests.find(fd);
+    if (it == m_interests.end() || it->value->description.strong_ref() != &description)
+        return ENOENT;
+    auto& interest = *it->value;
+    interest.events = event.events;
+    interest.data = event.data;
+    interest.is_disabled = false;
+    dbgln_if(EPOLL_DEBUG, "EPoll @ {}: Modified interest in fd {} to events {:#x}", this, fd, event.events);
+    interest_may_be_ready(interest);
+    return KSuccess;
+}
+
+KResult EPoll::remove_interest(int fd, FileDescription& description)
+{
+    MutexLocker locker(m_interests_lock);
+    auto it = m_interests.find(fd);
+    if (it == m_interests.end() || it->value->description.strong_ref() != &description)
+        return ENOENT;
+    forget_interest(*it->value);
+    m_interests.remove(it);
+    dbgln_if(EPOLL_DEBUG, "EPoll @ {}: Removed interest in fd {}", this, fd);
+    return KSuccess;
+}
+
+void EPoll::interest_may_be_ready(Interest& interest)
+{
+    {
+        ScopedSpinLock lock(m_ready_lock);
+        // If it's still waiting to be looked at, whoever does that will see the new state anyway.
+        if (interest.ready_list_node.is_in_list())
+            return;
+        m_ready_list.append(interest);
+    }
+    evaluate_block_conditions();
+}
+
+void EPoll::forget_interest(Interest& interest)
+{
+    interest.file->block_condition().remove_watcher(interest);
+    ScopedSpinLock lock(m_ready_lock);
+    interest.ready_list_node.remove();
+}
+
+size_t EPoll::collect_ready_events(Span<epoll_event> events)
+{
+    MutexLocker locker(m_interests_lock);
+
+    // Take everything off the ready list first, so that interests which change their state while
+    // we look at the others land on the ready list again instead of being looked at twice.
+    ReadyList candidates;
+    {
+        ScopedSpinLock lock(m_ready_lock);
+        while (!m_ready_list.is_empty())
+            candidates.append(*m_ready_list.first());
+    }
+
+    size_t event_count = 0;
+    while (event_count < events.size()) {
+        Interest* interest;
+        {
+            ScopedSpinLock lock(m_ready_lock);
+            interest = candidates.first();
+            if (!interest)
+                break;
+            candidates.remove(*interest);
+        }
+
+        auto description = interest->description.strong_ref();
+        if (!description) {
+            int fd = interest->fd;
+            dbgln_if(EPOLL_DEBUG, "EPoll @ {}: Forgetting about closed fd {}", this, fd);
+            forget_interest(*interest);
+            m_interests.remove(fd);
+            continue;
+        }
+        if (interest->is_disabled)
+            continue;
+
+        auto ready_events = interest->ready_events(*description);
+        if (!ready_events)
+            continue;
+        events[event_count++] = { ready_events, interest->data };
+
+        if (interest->events & EPOLLONESHOT) {
+            // Nothing more is reported until the interest gets modified again.
+            interest->is_disabled = true;
+        } else if (!(interest->events & EPOLLET)) {
+            // Level-triggered interests are looked at again until they're not ready anymore.
+            ScopedSpinLock lock(m_ready_lock);
+            if (!interest->ready_list_node.is_in_list())
+                m_ready_list.append(*interest);
+        }
+    }
+
+    // Whatever didn't fit is left for the next wait.
+    ScopedSpinLock lock(m_ready_lock);
+    while (!candidates.is_empty())
+        m_ready_list.append(*candidates.first());
+    return event_count;
+}
+
+}
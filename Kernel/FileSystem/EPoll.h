@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Span.h>
+#include <AK/WeakPtr.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/Forward.h>
+#include <Kernel/Mutex.h>
+#include <Kernel/UnixTypes.h>
+
+namespace Kernel {
+
+// A list of file descriptions someone is interested in, which keeps track of those that may have
+// become ready, so that waiting for them only ever has to look at those instead of all of them.
+// Interests are level-triggered unless they ask for EPOLLET, in which case an event is only
+// reported again after the state of the file has changed once more.
+class EPoll final : public File {
+public:
+    static KResultOr<NonnullRefPtr<EPoll>> create();
+    virtual ~EPoll() override;
+
+    // Readable when there are interests that may be ready, which doesn't mean any of them actually is.
+    virtual bool can_read(const FileDescription&, size_t) const override;
+    virtual KResultOr<size_t> read(FileDescription&, u64, UserOrKernelBuffer&, size_t) override { return EINVAL; }
+    virtual bool can_write(const FileDescription&, size_t) const override { return false; }
+    virtual KResultOr<size_t> write(FileDescription&, u64, const UserOrKernelBuffer&, size_t) override { return EINVAL; }
+
+    virtual String absolute_path(const FileDescription&) const override;
+    virtual StringView class_name() const override { return "EPoll"; }
+    virtual bool is_epoll() const override { return true; }
+
+    KResult add_interest(int fd, FileDescription&, const epoll_event&);
+    KResult modify_interest(int fd, FileDescription&, const epoll_event&);
+    KResult remove_interest(int fd, FileDescription&);
+
+    // Fills the span with the events of interests that are ready, and returns how many it found.
+    size_t collect_ready_events(Span<epoll_event>);
+
+private:
+    struct Interest final : public FileBlockCondition::Watcher {
+        Interest(EPoll&, int fd, FileDescription&, const epoll_event&);
+
+        virtual void file_state_changed() override { epoll.interest_may_be_ready(*this); }
+        u32 ready_events(FileDescription&) const;
+
+        EPoll& epoll;
+        int fd { -1 };
+        // Keeps the block condition we're watching alive. The description may go away at any time,
+        // and once it's gone we forget about the interest the next time we come across it.
+        NonnullRefPtr<File> file;
+        WeakPtr<FileDescription> description;
+        u32 events { 0 };
+        epoll_data_t data {};
+        bool is_disabled { false };
+        IntrusiveListNode<Interest> ready_list_node;
+    };
+    using ReadyList = IntrusiveList<Interest, RawPtr<Interest>, &Interest::ready_list_node>;
+
+    EPoll() { }
+
+    void interest_may_be_ready(Interest&);
+    void forget_interest(Interest&);
+
+    Mutex m_interests_lock;
+    HashMap<int, NonnullOwnPtr<Interest>> m_interests;
+
+    mutable SpinLock<u8> m_ready_lock;
+    ReadyList m_ready_list;
+};
+
+}
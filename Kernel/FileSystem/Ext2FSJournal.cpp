@@ -0,0 +1,454 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteBuffer.h>
+#include <Kernel/Debug.h>
+#include <Kernel/FileSystem/Ext2FSJournal.h>
+#include <Kernel/FileSystem/Ext2FileSystem.h>
+#include <Kernel/Thread.h>
+
+namespace Kernel {
+
+// Transactions are committed early once they pin this many blocks in the disk cache:
+// new handles wait, and the last running operation commits once it's done.
+static constexpr size_t max_transaction_blocks = 256;
+
+KResultOr<NonnullOwnPtr<Ext2FSJournal>> Ext2FSJournal::try_create(Ext2FS& fs, Vector<BlockIndex>&& journal_blocks)
+{
+    auto journal = adopt_own_if_nonnull(new (nothrow) Ext2FSJournal(fs, move(journal_blocks)));
+    if (!journal)
+        return ENOMEM;
+    if (auto result = journal->load_super_block(); result.is_error())
+        return result;
+    return journal.release_nonnull();
+}
+
+Ext2FSJournal::Ext2FSJournal(Ext2FS& fs, Vector<BlockIndex>&& journal_blocks)
+    : m_fs(fs)
+    , m_journal_blocks(move(journal_blocks))
+{
+    update_wait_queues();
+}
+
+KResult Ext2FSJournal::read_log_block(u32 position, u8* buffer)
+{
+    VERIFY(position < m_journal_blocks.size());
+    auto user_or_kernel_buffer = UserOrKernelBuffer::for_kernel_buffer(buffer);
+    return m_fs.read_block(m_journal_blocks[position], &user_or_kernel_buffer, m_fs.block_size(), 0, false);
+}
+
+KResult Ext2FSJournal::write_log_blocks(u32 position, size_t count, const u8* buffer)
+{
+    // The journal inode is usually contiguous on disk, so write as much of it in one go as we can.
+    auto block_size = m_fs.block_size();
+    while (count) {
+        VERIFY(position < m_max_length);
+        size_t run_length = 1;
+        while (run_length < count && position + run_length < m_max_length && m_journal_blocks[position + run_length].value() == m_journal_blocks[position].value() + run_length)
+            ++run_length;
+        auto user_or_kernel_buffer = UserOrKernelBuffer::for_kernel_buffer(const_cast<u8*>(buffer));
+        if (auto result = m_fs.write_blocks(m_journal_blocks[position], run_length, user_or_kernel_buffer, false); result.is_error())
+            return result;
+        buffer += run_length * block_size;
+        count -= run_length;
+        position += run_length;
+        if (position == m_max_length)
+            position = m_first;
+    }
+    return KSuccess;
+}
+
+KResult Ext2FSJournal::load_super_block()
+{
+    if (m_journal_blocks.is_empty())
+        return EINVAL;
+    m_super_block_buffer = ByteBuffer::create_zeroed(m_fs.block_size());
+    if (auto result = read_log_block(0, m_super_block_buffer.data()); result.is_error())
+        return result;
+
+    auto& super_block = *reinterpret_cast<const Journal::SuperBlock*>(m_super_block_buffer.data());
+    if (super_block.header.magic != Journal::magic) {
+        dmesgln("Ext2FSJournal: Bad magic in journal super block");
+        return EINVAL;
+    }
+    switch (static_cast<Journal::BlockType>(static_cast<u32>(super_block.header.block_type))) {
+    case Journal::BlockType::SuperBlockV1:
+        m_version = 1;
+        break;
+    case Journal::BlockType::SuperBlockV2:
+        m_version = 2;
+        break;
+    default:
+        dmesgln("Ext2FSJournal: Unknown journal super block type {}", static_cast<u32>(super_block.header.block_type));
+        return EINVAL;
+    }
+
+    if (super_block.block_size != m_fs.block_size()) {
+        dmesgln("Ext2FSJournal: Journal block size {} doesn't match the file system's", static_cast<u32>(super_block.block_size));
+        return EINVAL;
+    }
+
+    m_max_length = super_block.max_length;
+    m_first = super_block.first;
+    if (m_max_length > m_journal_blocks.size() || m_first == 0 || m_first >= m_max_length || max_transaction_block_count() < 8) {
+        dmesgln("Ext2FSJournal: Journal of {} blocks starting at {} doesn't fit the journal inode's {} blocks", m_max_length, m_first, m_journal_blocks.size());
+        return EINVAL;
+    }
+
+    if (m_version == 2) {
+        m_features_incompat = super_block.feature_incompat;
+        if (m_features_incompat & ~Journal::supported_features_incompat) {
+            dmesgln("Ext2FSJournal: Unsupported journal features {:#x}", m_features_incompat & ~Journal::supported_features_incompat);
+            return ENOTSUP;
+        }
+        memcpy(m_uuid, super_block.uuid, sizeof(m_uuid));
+    }
+    if (super_block.error != 0)
+        dmesgln("Ext2FSJournal: Journal has recorded error {}", static_cast<i32>(static_cast<u32>(super_block.error)));
+
+    m_start = super_block.start;
+    m_sequence = super_block.sequence;
+    m_head = m_first;
+
+    dbgln_if(EXT2_DEBUG, "Ext2FSJournal: Version {}, {} blocks from {}, start {}, sequence {}", m_version, m_max_length, m_first, m_start, m_sequence);
+    return KSuccess;
+}
+
+KResult Ext2FSJournal::write_super_block()
+{
+    auto& super_block = *reinterpret_cast<Journal::SuperBlock*>(m_super_block_buffer.data());
+    super_block.start = m_start;
+    super_block.sequence = m_sequence;
+    return write_log_blocks(0, 1, m_super_block_buffer.data());
+}
+
+KResultOr<u32> Ext2FSJournal::do_pass(Pass pass, u32 end_sequence)
+{
+    auto block_size = m_fs.block_size();
+    auto block = ByteBuffer::create_uninitialized(block_size);
+    auto logged_block = ByteBuffer::create_uninitialized(block_size);
+    bool has_64bit_block_numbers = m_features_incompat & Journal::feature_incompat_64bit;
+
+    u32 position = m_start;
+    u32 sequence = m_sequence;
+    size_t replayed_block_count = 0;
+    for (;;) {
+        if (pass != Pass::Scan && sequence == end_sequence)
+            break;
+        if (auto result = read_log_block(position, block.data()); result.is_error())
+            return result;
+        auto& header = *reinterpret_cast<const Journal::Header*>(block.data());
+        // Anything that doesn't continue the current transaction is where the log ends.
+        if (header.magic != Journal::magic || header.sequence != sequence)
+            break;
+        position = next_position(position);
+
+        auto block_type = static_cast<Journal::BlockType>(static_cast<u32>(header.block_type));
+        if (block_type == Journal::BlockType::Commit) {
+            ++sequence;
+            continue;
+        }
+
+        if (block_type == Journal::BlockType::Revoke) {
+            if (pass != Pass::Revoke)
+                continue;
+            auto& revoke_header = *reinterpret_cast<const Journal::RevokeHeader*>(block.data());
+            size_t byte_count = min(static_cast<size_t>(revoke_header.byte_count), static_cast<size_t>(block_size));
+            size_t record_size = has_64bit_block_numbers ? sizeof(u64) : sizeof(u32);
+            for (size_t offset = sizeof(Journal::RevokeHeader); offset + record_size <= byte_count; offset += record_size) {
+                u64 block_number = has_64bit_block_numbers ? static_cast<u64>(*reinterpret_cast<const BigEndian<u64>*>(block.data() + offset)) : static_cast<u64>(*reinterpret_cast<const BigEndian<u32>*>(block.data() + offset));
+                auto& revoked_sequence = m_revoked_blocks.ensure(block_number);
+                revoked_sequence = max(revoked_sequence, sequence);
+            }
+            continue;
+        }
+
+        if (block_type != Journal::BlockType::Descriptor) {
+            dbgln("Ext2FSJournal: Unexpected block type {} in transaction {}", static_cast<u32>(header.block_type), sequence);
+            break;
+        }
+
+        // The logged blocks follow their descriptor block in the order of its tags.
+        for (size_t tag_offset = sizeof(Journal::Header); tag_offset + tag_size() <= block_size;) {
+            auto& tag = *reinterpret_cast<const Journal::BlockTag*>(block.data() + tag_offset);
+            u64 block_number = tag.block_number;
+            if (has_64bit_block_numbers)
+                block_number |= static_cast<u64>(*reinterpret_cast<const BigEndian<u32>*>(block.data() + tag_offset + sizeof(Journal::BlockTag))) << 32;
+            u16 flags = tag.flags;
+            tag_offset += tag_size();
+            if (!(flags & Journal::tag_flag_same_uuid))
+                tag_offset += sizeof(m_uuid);
+
+            if (pass == Pass::Replay) {
+                auto it = m_revoked_blocks.find(block_number);
+                bool is_revoked = it != m_revoked_blocks.end() && it->value >= sequence;
+                if (block_number >= m_fs.super_block().s_blocks_count) {
+                    dbgln("Ext2FSJournal: Not replaying block {} beyond the end of the file system", block_number);
+                } else if (!is_revoked) {
+                    if (auto result = read_log_block(position, logged_block.data()); result.is_error())
+                        return result;
+                    if (flags & Journal::tag_flag_escape)
+                        *reinterpret_cast<BigEndian<u32>*>(logged_block.data()) = Journal::magic;
+                    auto buffer = UserOrKernelBuffer::for_kernel_buffer(logged_block.data());
+                    if (auto result = m_fs.write_block(block_number, buffer, block_size, 0, false); result.is_error())
+                        return result;
+                    ++replayed_block_count;
+                }
+            }
+            position = next_position(position);
+            if (flags & Journal::tag_flag_last_tag)
+                break;
+        }
+    }
+
+    if (pass == Pass::Replay)
+        dmesgln("Ext2FSJournal: Replayed {} block(s) from {} transaction(s)", replayed_block_count, end_sequence - m_sequence);
+    return sequence;
+}
+
+KResult Ext2FSJournal::recover()
+{
+    MutexLocker locker(m_lock);
+    if (!needs_recovery())
+        return KSuccess;
+
+    dmesgln("Ext2FSJournal: Recovering from transaction {} at log block {}", m_sequence, m_start);
+    auto end_sequence_or_error = do_pass(Pass::Scan, 0);
+    if (end_sequence_or_error.is_error())
+        return end_sequence_or_error.error();
+    auto end_sequence = end_sequence_or_error.value();
+    for (auto pass : { Pass::Revoke, Pass::Replay }) {
+        if (auto result = do_pass(pass, end_sequence); result.is_error())
+            return result.error();
+    }
+    m_revoked_blocks.clear();
+
+    // The replayed blocks went straight to the device, so the log can be forgotten.
+    m_sequence = end_sequence;
+    m_start = 0;
+    m_head = m_first;
+    return write_super_block();
+}
+
+void Ext2FSJournal::update_wait_queues()
+{
+    bool handles_have_to_wait = m_transaction_is_full || m_committing_thread;
+    m_handle_wait_queue.should_block(handles_have_to_wait);
+    if (!handles_have_to_wait)
+        m_handle_wait_queue.wake_all();
+    m_idle_wait_queue.should_block(!m_open_handles.is_empty());
+    if (m_open_handles.is_empty())
+        m_idle_wait_queue.wake_all();
+}
+
+void Ext2FSJournal::start_handle()
+{
+    auto* current_thread = Thread::current();
+    MutexLocker locker(m_lock);
+    // A nested handle belongs to an operation that is already running, which has to be able to finish.
+    // The same goes for whatever a commit does while writing out the metadata.
+    if (auto it = m_open_handles.find(current_thread); it != m_open_handles.end()) {
+        ++it->value;
+        return;
+    }
+    while (m_committing_thread != current_thread && (m_committing_thread || m_transaction_is_full)) {
+        if (!m_committing_thread && m_open_handles.is_empty()) {
+            // The transaction filled up without any operation running, so there's nobody else to commit it.
+            locker.unlock();
+            if (auto result = commit(); result.is_error())
+                dbgln("Ext2FSJournal: Failed to commit a full transaction: {}", result.error());
+            locker.lock();
+            continue;
+        }
+        locker.unlock();
+        m_handle_wait_queue.wait_forever("Ext2FSJournal");
+        locker.lock();
+    }
+    m_open_handles.set(current_thread, 1);
+    update_wait_queues();
+}
+
+void Ext2FSJournal::stop_handle()
+{
+    bool should_commit = false;
+    {
+        MutexLocker locker(m_lock);
+        auto it = m_open_handles.find(Thread::current());
+        VERIFY(it != m_open_handles.end());
+        if (--it->value != 0)
+            return;
+        m_open_handles.remove(it);
+        // The last operation to finish commits a full transaction, unless a commit is already waiting for it.
+        should_commit = m_open_handles.is_empty() && m_transaction_is_full && !m_committing_thread;
+        update_wait_queues();
+    }
+    if (should_commit) {
+        if (auto result = commit(); result.is_error())
+            dbgln("Ext2FSJournal: Failed to commit a full transaction: {}", result.error());
+    }
+}
+
+KResult Ext2FSJournal::write_metadata_block(BlockIndex block_index, const UserOrKernelBuffer& buffer, size_t count, size_t offset)
+{
+    MutexLocker locker(m_lock);
+    bool is_new_block = !m_transaction_block_set.contains(block_index);
+    if (is_new_block && m_transaction_blocks.size() >= max_log_transaction_block_count()) {
+        dbgln("Ext2FSJournal: Transaction {} doesn't fit in the log anymore, can't add block {}", m_sequence, block_index);
+        return ENOSPC;
+    }
+    if (auto result = m_fs.write_pinned_block(block_index, buffer, count, offset); result.is_error())
+        return result;
+    if (!is_new_block)
+        return KSuccess;
+    m_transaction_block_set.set(block_index);
+    m_transaction_blocks.append(block_index);
+    if (!m_transaction_is_full && m_transaction_blocks.size() >= min(max_transaction_blocks, max_transaction_block_count())) {
+        m_transaction_is_full = true;
+        update_wait_queues();
+    }
+    return KSuccess;
+}
+
+KResult Ext2FSJournal::commit()
+{
+    auto* current_thread = Thread::current();
+    MutexLocker locker(m_lock);
+    VERIFY(!m_open_handles.contains(current_thread));
+
+    // Whoever is committing already gets everything we would have committed.
+    if (m_committing_thread) {
+        while (m_committing_thread) {
+            locker.unlock();
+            m_handle_wait_queue.wait_forever("Ext2FSJournal");
+            locker.lock();
+        }
+        return KSuccess;
+    }
+
+    m_committing_thread = current_thread;
+    update_wait_queues();
+    while (!m_open_handles.is_empty()) {
+        locker.unlock();
+        m_idle_wait_queue.wait_forever("Ext2FSJournal");
+        locker.lock();
+    }
+
+    // No operation is halfway done now. What they changed in memory only goes into this transaction as well,
+    // so that it doesn't get committed without the bitmaps and inodes that go along with its blocks.
+    locker.unlock();
+    m_fs.flush_dirty_inodes();
+    m_fs.write_dirty_metadata();
+    locker.lock();
+
+    auto result = commit_transaction();
+    m_committing_thread = nullptr;
+    m_transaction_is_full = false;
+    update_wait_queues();
+    return result;
+}
+
+KResult Ext2FSJournal::commit_transaction()
+{
+    if (m_transaction_blocks.is_empty())
+        return KSuccess;
+
+    dbgln_if(EXT2_DEBUG, "Ext2FSJournal: Committing transaction {} with {} block(s) at log block {}", m_sequence, m_transaction_blocks.size(), m_head);
+    auto block_size = m_fs.block_size();
+    bool has_64bit_block_numbers = m_features_incompat & Journal::feature_incompat_64bit;
+
+    // Ordered mode: file data has to be on the device before the metadata that points at it is committed.
+    // This also writes back the previous transaction's blocks, which aren't pinned anymore.
+    m_fs.flush_writes_impl();
+
+    // Nothing in the log is needed anymore, so the log can start right where this transaction goes.
+    m_start = m_head;
+    if (auto result = write_super_block(); result.is_error())
+        return result;
+
+    // Each descriptor block is followed by the blocks it describes, its first tag also carries the UUID.
+    auto tags_per_descriptor = (block_size - sizeof(Journal::Header) - sizeof(m_uuid)) / tag_size();
+    auto run = ByteBuffer::create_uninitialized((1 + tags_per_descriptor) * block_size);
+    u32 position = m_head;
+    for (size_t i = 0; i < m_transaction_blocks.size(); i += tags_per_descriptor) {
+        auto count = min(tags_per_descriptor, m_transaction_blocks.size() - i);
+        memset(run.data(), 0, block_size);
+        auto& header = *reinterpret_cast<Journal::Header*>(run.data());
+        header.magic = Journal::magic;
+        header.block_type = static_cast<u32>(Journal::BlockType::Descriptor);
+        header.sequence = m_sequence;
+
+        u8* tag_pointer = run.data() + sizeof(Journal::Header);
+        for (size_t j = 0; j < count; ++j) {
+            auto block_index = m_transaction_blocks[i + j];
+            VERIFY(has_64bit_block_numbers || block_index.value() <= NumericLimits<u32>::max());
+            u8* data = run.data() + (1 + j) * block_size;
+            auto data_buffer = UserOrKernelBuffer::for_kernel_buffer(data);
+            if (auto result = m_fs.read_block(block_index, &data_buffer, block_size); result.is_error())
+                return result;
+
+            u16 flags = 0;
+            // A logged block that looks like a journal block would confuse recovery, so it's escaped.
+            if (*reinterpret_cast<BigEndian<u32>*>(data) == Journal::magic) {
+                memset(data, 0, sizeof(u32));
+                flags |= Journal::tag_flag_escape;
+            }
+            if (j != 0)
+                flags |= Journal::tag_flag_same_uuid;
+            if (j == count - 1)
+                flags |= Journal::tag_flag_last_tag;
+
+            auto& tag = *reinterpret_cast<Journal::BlockTag*>(tag_pointer);
+            tag.block_number = static_cast<u32>(block_index.value());
+            tag.checksum = 0;
+            tag.flags = flags;
+            tag_pointer += sizeof(Journal::BlockTag);
+            if (has_64bit_block_numbers) {
+                *reinterpret_cast<BigEndian<u32>*>(tag_pointer) = static_cast<u32>(block_index.value() >> 32);
+                tag_pointer += sizeof(u32);
+            }
+            if (j == 0) {
+                memcpy(tag_pointer, m_uuid, sizeof(m_uuid));
+                tag_pointer += sizeof(m_uuid);
+            }
+        }
+
+        if (auto result = write_log_blocks(position, 1 + count, run.data()); result.is_error())
+            return result;
+        for (size_t j = 0; j < 1 + count; ++j)
+            position = next_position(position);
+    }
+
+    // Every block of the transaction has been written by now, the commit block makes it count.
+    memset(run.data(), 0, block_size);
+    auto& commit_header = *reinterpret_cast<Journal::Header*>(run.data());
+    commit_header.magic = Journal::magic;
+    commit_header.block_type = static_cast<u32>(Journal::BlockType::Commit);
+    commit_header.sequence = m_sequence;
+    if (auto result = write_log_blocks(position, 1, run.data()); result.is_error())
+        return result;
+    position = next_position(position);
+
+    m_head = position;
+    ++m_sequence;
+    for (auto block_index : m_transaction_blocks)
+        m_fs.unpin_block(block_index);
+    m_transaction_blocks.clear();
+    m_transaction_block_set.clear();
+    return KSuccess;
+}
+
+KResult Ext2FSJournal::shut_down()
+{
+    if (auto result = commit(); result.is_error())
+        return result;
+    MutexLocker locker(m_lock);
+    m_fs.flush_writes_impl();
+    m_start = 0;
+    m_head = m_first;
+    return write_super_block();
+}
+
+}
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Endian.h>
+#include <AK/HashMap.h>
+#include <AK/HashTable.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Vector.h>
+#include <Kernel/FileSystem/BlockBasedFileSystem.h>
+#include <Kernel/KResult.h>
+#include <Kernel/Mutex.h>
+#include <Kernel/WaitQueue.h>
+
+namespace Kernel {
+
+class Ext2FS;
+
+// The on-disk format of the ext3/JBD2 journal. Everything in it is big-endian.
+namespace Journal {
+
+static constexpr u32 magic = 0xc03b3998;
+
+enum class BlockType : u32 {
+    Descriptor = 1,
+    Commit = 2,
+    SuperBlockV1 = 3,
+    SuperBlockV2 = 4,
+    Revoke = 5,
+};
+
+static constexpr u32 feature_incompat_revoke = 0x1;
+static constexpr u32 feature_incompat_64bit = 0x2;
+static constexpr u32 supported_features_incompat = feature_incompat_revoke | feature_incompat_64bit;
+
+static constexpr u16 tag_flag_escape = 0x1;
+static constexpr u16 tag_flag_same_uuid = 0x2;
+static constexpr u16 tag_flag_last_tag = 0x8;
+
+struct [[gnu::packed]] Header {
+    BigEndian<u32> magic;
+    BigEndian<u32> block_type;
+    BigEndian<u32> sequence;
+};
+
+struct [[gnu::packed]] SuperBlock {
+    Header header;
+    BigEndian<u32> block_size;
+    BigEndian<u32> max_length;
+    BigEndian<u32> first;
+    BigEndian<u32> sequence;
+    BigEndian<u32> start;
+    BigEndian<u32> error;
+    // Only valid in version 2 super blocks.
+    BigEndian<u32> feature_compat;
+    BigEndian<u32> feature_incompat;
+    BigEndian<u32> feature_ro_compat;
+    u8 uuid[16];
+};
+
+// Followed by the upper half of the block number if the 64bit feature is set,
+// and by a 16 byte UUID unless tag_flag_same_uuid is set.
+struct [[gnu::packed]] BlockTag {
+    BigEndian<u32> block_number;
+    BigEndian<u16> checksum;
+    BigEndian<u16> flags;
+};
+
+struct [[gnu::packed]] RevokeHeader {
+    Header header;
+    BigEndian<u32> byte_count;
+};
+
+}
+
+// An ext3-compatible journal in ordered mode: metadata blocks are pinned in the disk cache
+// until commit() has written them to the log, file data is written in place before that.
+// Every commit starts by checkpointing the previous transaction, so the log never holds more
+// than one of our transactions and revoke records are only needed when replaying foreign logs.
+//
+// Every operation that changes metadata runs with a handle open (see Ext2FSJournalHandle), and
+// transactions are only committed while no handle is open, so a transaction never ends halfway
+// through an operation.
+class Ext2FSJournal {
+    AK_MAKE_NONCOPYABLE(Ext2FSJournal);
+    AK_MAKE_NONMOVABLE(Ext2FSJournal);
+
+public:
+    using BlockIndex = BlockBasedFileSystem::BlockIndex;
+
+    static KResultOr<NonnullOwnPtr<Ext2FSJournal>> try_create(Ext2FS&, Vector<BlockIndex>&& journal_blocks);
+
+    bool needs_recovery() const { return m_start != 0; }
+    KResult recover();
+
+    // Writes to a metadata block go through here, its new contents become part of the running transaction.
+    KResult write_metadata_block(BlockIndex, const UserOrKernelBuffer&, size_t count, size_t offset);
+
+    // Handles nest: a thread that already has one open never waits for a new one.
+    void start_handle();
+    void stop_handle();
+
+    // Waits for the open handles to be stopped, then writes all metadata that is only dirty in memory
+    // to the transaction and commits it. New handles wait until the commit is done.
+    KResult commit();
+    // Commits and checkpoints everything, leaving the log empty.
+    KResult shut_down();
+
+private:
+    enum class Pass {
+        Scan,
+        Revoke,
+        Replay,
+    };
+
+    Ext2FSJournal(Ext2FS&, Vector<BlockIndex>&& journal_blocks);
+
+    KResult load_super_block();
+    KResult write_super_block();
+
+    u32 next_position(u32 position) const { return position + 1 < m_max_length ? position + 1 : m_first; }
+    size_t tag_size() const { return sizeof(Journal::BlockTag) + ((m_features_incompat & Journal::feature_incompat_64bit) ? sizeof(u32) : 0); }
+    size_t max_transaction_block_count() const { return (m_max_length - m_first) / 4; }
+    // The operations that are already running may take a transaction past max_transaction_block_count(),
+    // but never past what fits in the log along with its descriptor and commit blocks.
+    size_t max_log_transaction_block_count() const { return (m_max_length - m_first) * 3 / 4; }
+
+    void update_wait_queues();
+    KResult commit_transaction();
+
+    KResult read_log_block(u32 position, u8* buffer);
+    KResult write_log_blocks(u32 position, size_t count, const u8* buffer);
+    KResultOr<u32> do_pass(Pass, u32 end_sequence);
+
+    Ext2FS& m_fs;
+    Vector<BlockIndex> m_journal_blocks;
+    Mutex m_lock { "Ext2FSJournal" };
+
+    u32 m_version { 2 };
+    u32 m_max_length { 0 };
+    u32 m_first { 0 };
+    // Where the log starts and which sequence number it starts with, 0 if it's empty.
+    u32 m_start { 0 };
+    u32 m_sequence { 0 };
+    u32 m_features_incompat { 0 };
+    u8 m_uuid[16] {};
+    ByteBuffer m_super_block_buffer;
+
+    // Where the next transaction goes.
+    u32 m_head { 0 };
+
+    Vector<BlockIndex> m_transaction_blocks;
+    HashTable<BlockIndex> m_transaction_block_set;
+
+    // How many handles each thread has open.
+    HashMap<Thread*, size_t> m_open_handles;
+    // New handles wait while either is set.
+    bool m_transaction_is_full { false };
+    Thread* m_committing_thread { nullptr };
+    // Blocks while new handles have to wait.
+    WaitQueue m_handle_wait_queue;
+    // Blocks while handles are open, for commit() to wait on.
+    WaitQueue m_idle_wait_queue;
+
+    // Only used while recovering: the latest sequence number that revoked each block.
+    HashMap<BlockIndex, u32> m_revoked_blocks;
+};
+
+// Keeps the journal from committing while the metadata change in progress is incomplete.
+class Ext2FSJournalHandle {
+    AK_MAKE_NONCOPYABLE(Ext2FSJournalHandle);
+    AK_MAKE_NONMOVABLE(Ext2FSJournalHandle);
+
+public:
+    explicit Ext2FSJournalHandle(Ext2FSJournal* journal)
+        : m_journal(journal)
+    {
+        if (m_journal)
+            m_journal->start_handle();
+    }
+
+    ~Ext2FSJournalHandle()
+    {
+        if (m_journal)
+            m_journal->stop_handle();
+    }
+
+private:
+    Ext2FSJournal* m_journal { nullptr };
+};
+
+}
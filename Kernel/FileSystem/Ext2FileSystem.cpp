@@ -7,10 +7,13 @@
 
 #include <AK/HashMap.h>
 #include <AK/MemoryStream.h>
+#include <AK/NonnullRefPtrVector.h>
+#include <AK/QuickSort.h>
 #include <AK/StdLibExtras.h>
 #include <AK/StringView.h>
 #include <Kernel/Debug.h>
 #include <Kernel/Devices/BlockDevice.h>
+#include <Kernel/FileSystem/Ext2FSJournal.h>
 #include <Kernel/FileSystem/Ext2FileSystem.h>
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/FileSystem/ext2_fs.h>
@@ -22,6 +25,9 @@ namespace Kernel {
 
 static constexpr size_t max_block_size = 4096;
 static constexpr size_t max_inline_symlink_length = 60;
+static constexpr size_t min_preallocation_blocks = 8;
+static constexpr size_t max_preallocation_blocks = 256;
+static constexpr size_t max_write_size_per_transaction = 1 * MiB;
 
 struct Ext2FSDirectoryEntry {
     String name;
@@ -54,6 +60,241 @@ static unsigned divide_rounded_up(unsigned a, unsigned b)
     return (a / b) + (a % b != 0);
 }
 
+// The directory index ("htree") hash functions, as specified by the ext2/ext3 dir_index feature.
+// The signed variants exist because the legacy implementation hashed bytes as plain (signed) chars.
+
+template<typename CharType>
+static u32 directory_index_legacy_hash(StringView name)
+{
+    u32 hash0 = 0x12a3fe2d;
+    u32 hash1 = 0x37abe8f9;
+    for (auto ch : name) {
+        u32 hash = hash1 + (hash0 ^ (static_cast<i32>(static_cast<CharType>(ch)) * 7152373));
+        if (hash & 0x80000000)
+            hash -= 0x7fffffff;
+        hash1 = hash0;
+        hash0 = hash;
+    }
+    return hash0 << 1;
+}
+
+template<typename CharType>
+static void directory_index_string_to_hash_buffer(char const* characters, size_t length, u32* buffer, int count)
+{
+    u32 pad = static_cast<u32>(length) | (static_cast<u32>(length) << 8);
+    pad |= pad << 16;
+
+    u32 value = pad;
+    length = min(length, static_cast<size_t>(count) * 4);
+    for (size_t i = 0; i < length; ++i) {
+        value = static_cast<u32>(static_cast<i32>(static_cast<CharType>(characters[i]))) + (value << 8);
+        if ((i % 4) == 3) {
+            *buffer++ = value;
+            value = pad;
+            --count;
+        }
+    }
+    if (--count >= 0)
+        *buffer++ = value;
+    while (--count >= 0)
+        *buffer++ = pad;
+}
+
+static constexpr u32 rotate_left(u32 value, unsigned shift)
+{
+    return (value << shift) | (value >> (32 - shift));
+}
+
+static void directory_index_half_md4_transform(u32 buffer[4], u32 const input[8])
+{
+    auto f = [](u32 x, u32 y, u32 z) { return z ^ (x & (y ^ z)); };
+    auto g = [](u32 x, u32 y, u32 z) { return (x & y) + ((x ^ y) & z); };
+    auto h = [](u32 x, u32 y, u32 z) { return x ^ y ^ z; };
+    auto round = [](auto function, u32& a, u32 b, u32 c, u32 d, u32 x, unsigned shift) {
+        a = rotate_left(a + function(b, c, d) + x, shift);
+    };
+
+    constexpr u32 k2 = 013240474631;
+    constexpr u32 k3 = 015666365641;
+    u32 a = buffer[0], b = buffer[1], c = buffer[2], d = buffer[3];
+
+    round(f, a, b, c, d, input[0], 3);
+    round(f, d, a, b, c, input[1], 7);
+    round(f, c, d, a, b, input[2], 11);
+    round(f, b, c, d, a, input[3], 19);
+    round(f, a, b, c, d, input[4], 3);
+    round(f, d, a, b, c, input[5], 7);
+    round(f, c, d, a, b, input[6], 11);
+    round(f, b, c, d, a, input[7], 19);
+
+    round(g, a, b, c, d, input[1] + k2, 3);
+    round(g, d, a, b, c, input[3] + k2, 5);
+    round(g, c, d, a, b, input[5] + k2, 9);
+    round(g, b, c, d, a, input[7] + k2, 13);
+    round(g, a, b, c, d, input[0] + k2, 3);
+    round(g, d, a, b, c, input[2] + k2, 5);
+    round(g, c, d, a, b, input[4] + k2, 9);
+    round(g, b, c, d, a, input[6] + k2, 13);
+
+    round(h, a, b, c, d, input[3] + k3, 3);
+    round(h, d, a, b, c, input[7] + k3, 9);
+    round(h, c, d, a, b, input[2] + k3, 11);
+    round(h, b, c, d, a, input[6] + k3, 15);
+    round(h, a, b, c, d, input[1] + k3, 3);
+    round(h, d, a, b, c, input[5] + k3, 9);
+    round(h, c, d, a, b, input[0] + k3, 11);
+    round(h, b, c, d, a, input[4] + k3, 15);
+
+    buffer[0] += a;
+    buffer[1] += b;
+    buffer[2] += c;
+    buffer[3] += d;
+}
+
+static void directory_index_tea_transform(u32 buffer[4], u32 const input[4])
+{
+    u32 sum = 0;
+    u32 b0 = buffer[0], b1 = buffer[1];
+    u32 a = input[0], b = input[1], c = input[2], d = input[3];
+    for (int n = 0; n < 16; ++n) {
+        sum += 0x9E3779B9;
+        b0 += ((b1 << 4) + a) ^ (b1 + sum) ^ ((b1 >> 5) + b);
+        b1 += ((b0 << 4) + c) ^ (b0 + sum) ^ ((b0 >> 5) + d);
+    }
+    buffer[0] += b0;
+    buffer[1] += b1;
+}
+
+template<typename CharType>
+static u32 directory_index_hash_impl(StringView name, u8 hash_version, u32 buffer[4])
+{
+    u32 input[8];
+    switch (hash_version) {
+    case EXT2_HASH_LEGACY:
+        return directory_index_legacy_hash<CharType>(name);
+    case EXT2_HASH_HALF_MD4:
+        for (size_t offset = 0; offset < name.length(); offset += 32) {
+            directory_index_string_to_hash_buffer<CharType>(name.characters_without_null_termination() + offset, name.length() - offset, input, 8);
+            directory_index_half_md4_transform(buffer, input);
+        }
+        return buffer[1];
+    case EXT2_HASH_TEA:
+        for (size_t offset = 0; offset < name.length(); offset += 16) {
+            directory_index_string_to_hash_buffer<CharType>(name.characters_without_null_termination() + offset, name.length() - offset, input, 4);
+            directory_index_tea_transform(buffer, input);
+        }
+        return buffer[0];
+    }
+    VERIFY_NOT_REACHED();
+}
+
+static u32 directory_index_hash(StringView name, u8 hash_version, u32 const seed[4])
+{
+    u32 buffer[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+    if (seed[0] || seed[1] || seed[2] || seed[3])
+        __builtin_memcpy(buffer, seed, sizeof(buffer));
+
+    u32 hash;
+    if (hash_version >= EXT2_HASH_LEGACY_UNSIGNED)
+        hash = directory_index_hash_impl<u8>(name, hash_version - EXT2_HASH_LEGACY_UNSIGNED, buffer);
+    else
+        hash = directory_index_hash_impl<i8>(name, hash_version, buffer);
+
+    // The lowest bit marks hash collisions that continue into the next leaf block, and the
+    // largest hash value is reserved as the end-of-directory marker.
+    hash &= ~1u;
+    if (hash == (0x7fffffffu << 1))
+        hash = (0x7fffffffu - 1) << 1;
+    return hash;
+}
+
+struct Ext2FSDirectoryIndexFrame {
+    u64 block_index { 0 };
+    ByteBuffer block;
+    size_t entries_offset { 0 };
+    size_t entry { 0 };
+
+    ext2_dx_countlimit& countlimit() { return *reinterpret_cast<ext2_dx_countlimit*>(block.data() + entries_offset); }
+    ext2_dx_entry* entries() { return reinterpret_cast<ext2_dx_entry*>(block.data() + entries_offset); }
+    u64 target_block() { return entries()[entry].block & 0x0fffffff; }
+};
+
+struct Ext2FSDirectoryIndexPath {
+    u8 hash_version { 0 };
+    u32 hash { 0 };
+    Vector<Ext2FSDirectoryIndexFrame, 2> frames;
+};
+
+static constexpr size_t directory_index_root_entries_offset = 32;
+static constexpr size_t directory_index_node_entries_offset = 8;
+static constexpr u8 directory_index_max_indirect_levels = 1;
+
+static ext2_dir_entry_2* find_directory_entry_in_block(ByteBuffer& block, StringView name, ext2_dir_entry_2** previous_entry = nullptr)
+{
+    ext2_dir_entry_2* previous = nullptr;
+    for (size_t offset = 0; offset + 8 <= block.size();) {
+        auto* entry = reinterpret_cast<ext2_dir_entry_2*>(block.data() + offset);
+        if (entry->rec_len < 8 || offset + entry->rec_len > block.size())
+            break;
+        if (entry->inode != 0 && name == StringView(entry->name, entry->name_len)) {
+            if (previous_entry)
+                *previous_entry = previous;
+            return entry;
+        }
+        previous = entry;
+        offset += entry->rec_len;
+    }
+    return nullptr;
+}
+
+static void write_directory_entry(u8* data, InodeIndex inode_index, u16 record_length, StringView name, u8 file_type)
+{
+    auto* entry = reinterpret_cast<ext2_dir_entry_2*>(data);
+    entry->inode = inode_index.value();
+    entry->rec_len = record_length;
+    entry->name_len = name.length();
+    entry->file_type = file_type;
+    __builtin_memcpy(entry->name, name.characters_without_null_termination(), name.length());
+    __builtin_memset(entry->name + name.length(), 0, record_length - 8 - name.length());
+}
+
+static bool insert_directory_entry_into_block(ByteBuffer& block, StringView name, InodeIndex inode_index, u8 file_type)
+{
+    auto needed_length = EXT2_DIR_REC_LEN(name.length());
+    for (size_t offset = 0; offset + 8 <= block.size();) {
+        auto* entry = reinterpret_cast<ext2_dir_entry_2*>(block.data() + offset);
+        if (entry->rec_len < 8 || offset + entry->rec_len > block.size())
+            return false;
+        size_t used_length = entry->inode ? EXT2_DIR_REC_LEN(entry->name_len) : 0;
+        if (entry->rec_len - used_length >= needed_length) {
+            u16 record_length = entry->rec_len - used_length;
+            if (used_length)
+                entry->rec_len = used_length;
+            write_directory_entry(block.data() + offset + used_length, inode_index, record_length, name, file_type);
+            return true;
+        }
+        offset += entry->rec_len;
+    }
+    return false;
+}
+
+// Packs the given entries into a single directory block, the last entry absorbing the remaining space.
+static void pack_directory_block(u8* block, size_t block_size, Span<Ext2FSDirectoryEntry const> entries)
+{
+    if (entries.is_empty()) {
+        write_directory_entry(block, 0, block_size, {}, 0);
+        return;
+    }
+    size_t offset = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        auto& entry = entries[i];
+        size_t record_length = i + 1 < entries.size() ? EXT2_DIR_REC_LEN(entry.name.length()) : block_size - offset;
+        VERIFY(offset + record_length <= block_size);
+        write_directory_entry(block + offset, entry.inode_index, record_length, entry.name, entry.file_type);
+        offset += record_length;
+    }
+}
+
 NonnullRefPtr<Ext2FS> Ext2FS::create(FileDescription& file_description)
 {
     return adopt_ref(*new Ext2FS(file_description));
@@ -70,14 +311,98 @@ Ext2FS::~Ext2FS()
 
 bool Ext2FS::flush_super_block()
 {
-    MutexLocker locker(m_lock);
     VERIFY((sizeof(ext2_super_block) % logical_block_size()) == 0);
-    auto super_block_buffer = UserOrKernelBuffer::for_kernel_buffer((u8*)&m_super_block);
+    ext2_super_block super_block;
+    {
+        ScopedSpinLock locker(m_super_block_lock);
+        super_block = m_super_block;
+        m_super_block_dirty = false;
+    }
+    auto super_block_buffer = UserOrKernelBuffer::for_kernel_buffer((u8*)&super_block);
+    if (m_journal) {
+        // It lives 1 KiB into the device, which may well be in the middle of block 0.
+        constexpr size_t super_block_offset = 1024;
+        return !write_metadata_block(super_block_offset / block_size(), super_block_buffer, sizeof(ext2_super_block), super_block_offset % block_size()).is_error();
+    }
     bool success = raw_write_blocks(2, (sizeof(ext2_super_block) / logical_block_size()), super_block_buffer);
     VERIFY(success);
     return true;
 }
 
+KResult Ext2FS::write_metadata_block(BlockIndex index, const UserOrKernelBuffer& buffer, size_t count, size_t offset)
+{
+    if (m_journal)
+        return m_journal->write_metadata_block(index, buffer, count, offset);
+    return write_block(index, buffer, count, offset);
+}
+
+KResult Ext2FS::write_metadata_blocks(BlockIndex index, unsigned count, const UserOrKernelBuffer& buffer)
+{
+    if (!m_journal)
+        return write_blocks(index, count, buffer);
+    for (unsigned i = 0; i < count; ++i) {
+        if (auto result = m_journal->write_metadata_block(index.value() + i, buffer.offset(i * block_size()), block_size(), 0); result.is_error())
+            return result;
+    }
+    return KSuccess;
+}
+
+KResult Ext2FS::initialize_journal()
+{
+    if (!(m_super_block.s_feature_compat & EXT3_FEATURE_COMPAT_HAS_JOURNAL))
+        return KSuccess;
+
+    bool needs_recovery = m_super_block.s_feature_incompat & EXT3_FEATURE_INCOMPAT_RECOVER;
+    if ((m_super_block.s_feature_incompat & EXT3_FEATURE_INCOMPAT_JOURNAL_DEV) || m_super_block.s_journal_dev || !m_super_block.s_journal_inum) {
+        dmesgln("Ext2FS: External journals are not supported");
+        if (needs_recovery)
+            return ENOTSUP;
+        return KSuccess;
+    }
+
+    auto journal_inode = static_ptr_cast<Ext2FSInode>(get_inode({ fsid(), m_super_block.s_journal_inum }));
+    if (!journal_inode) {
+        dmesgln("Ext2FS: Failed to load journal inode {}", m_super_block.s_journal_inum);
+        return EIO;
+    }
+    auto journal_or_error = Ext2FSJournal::try_create(*this, journal_inode->compute_block_list());
+    journal_inode = nullptr;
+    uncache_inode(m_super_block.s_journal_inum);
+    if (journal_or_error.is_error())
+        return journal_or_error.error();
+    auto journal = journal_or_error.release_value();
+
+    if (needs_recovery || journal->needs_recovery()) {
+        if (auto result = journal->recover(); result.is_error()) {
+            dmesgln("Ext2FS: Failed to recover the journal: {}", result.error());
+            return result;
+        }
+
+        // Recovery may have rewritten any of the metadata we've already looked at.
+        VERIFY((sizeof(ext2_super_block) % logical_block_size()) == 0);
+        auto super_block_buffer = UserOrKernelBuffer::for_kernel_buffer((u8*)&m_super_block);
+        if (!raw_read_blocks(2, (sizeof(ext2_super_block) / logical_block_size()), super_block_buffer))
+            return EIO;
+        auto blocks_to_read = ceil_div(m_block_group_count * sizeof(ext2_group_desc), block_size());
+        auto buffer = UserOrKernelBuffer::for_kernel_buffer(m_cached_group_descriptor_table->data());
+        if (auto result = read_blocks(block_size() == 1024 ? 2 : 1, blocks_to_read, buffer); result.is_error())
+            return result;
+        for (auto& group : m_block_groups) {
+            group.block_bitmap = nullptr;
+            group.inode_bitmap = nullptr;
+        }
+        for (auto& shard : m_inode_cache)
+            shard.inodes.clear();
+    }
+
+    // Note in the super block that the journal is in use, before anything goes into it.
+    m_super_block.s_feature_incompat |= EXT3_FEATURE_INCOMPAT_RECOVER;
+    flush_super_block();
+    m_journal = move(journal);
+    dmesgln("Ext2FS: Journaling metadata in ordered mode");
+    return KSuccess;
+}
+
 const ext2_group_desc& Ext2FS::group_descriptor(GroupIndex group_index) const
 {
     // FIXME: Should this fail gracefully somehow?
@@ -86,6 +411,23 @@ const ext2_group_desc& Ext2FS::group_descriptor(GroupIndex group_index) const
     return block_group_descriptors()[group_index.value() - 1];
 }
 
+Ext2FS::BlockGroup& Ext2FS::block_group(GroupIndex group_index) const
+{
+    VERIFY(group_index <= m_block_group_count);
+    VERIFY(group_index > 0);
+    return m_block_groups[group_index.value() - 1];
+}
+
+bool Ext2FS::update_super_block_counter(u32& counter, ssize_t delta)
+{
+    ScopedSpinLock locker(m_super_block_lock);
+    if (delta < 0 && static_cast<size_t>(-delta) > counter)
+        return false;
+    counter += delta;
+    m_super_block_dirty = true;
+    return true;
+}
+
 bool Ext2FS::initialize()
 {
     MutexLocker locker(m_lock);
@@ -138,6 +480,13 @@ bool Ext2FS::initialize()
         return false;
     }
 
+    if (!m_block_groups.try_ensure_capacity(m_block_group_count)) {
+        dbgln("Ext2FS: Failed to allocate memory for block groups");
+        return false;
+    }
+    for (unsigned i = 0; i < m_block_group_count; ++i)
+        m_block_groups.unchecked_append(make<BlockGroup>());
+
     if constexpr (EXT2_DEBUG) {
         for (unsigned i = 1; i <= m_block_group_count; ++i) {
             auto& group = group_descriptor(i);
@@ -145,6 +494,11 @@ bool Ext2FS::initialize()
         }
     }
 
+    if (auto result = initialize_journal(); result.is_error()) {
+        dmesgln("Ext2FS: Failed to initialize the journal: {}", result.error());
+        return false;
+    }
+
     m_root_inode = static_ptr_cast<Ext2FSInode>(get_inode({ fsid(), EXT2_ROOT_INO }));
     if (!m_root_inode) {
         dbgln("Ext2FS: failed to acquire root inode");
@@ -225,7 +579,7 @@ KResult Ext2FSInode::write_indirect_block(BlockBasedFileSystem::BlockIndex block
         stream << static_cast<u32>(blocks_indices[i].value());
     stream.fill_to_end(0);
 
-    return fs().write_block(block, buffer, stream.size());
+    return fs().write_metadata_block(block, buffer, stream.size());
 }
 
 KResult Ext2FSInode::grow_doubly_indirect_block(BlockBasedFileSystem::BlockIndex block, size_t old_blocks_length, Span<BlockBasedFileSystem::BlockIndex> blocks_indices, Vector<Ext2FS::BlockIndex>& new_meta_blocks, unsigned& meta_blocks)
@@ -267,7 +621,7 @@ KResult Ext2FSInode::grow_doubly_indirect_block(BlockBasedFileSystem::BlockIndex
     }
 
     // Write out the doubly indirect block.
-    return fs().write_block(block, buffer, stream.size());
+    return fs().write_metadata_block(block, buffer, stream.size());
 }
 
 KResult Ext2FSInode::shrink_doubly_indirect_block(BlockBasedFileSystem::BlockIndex block, size_t old_blocks_length, size_t new_blocks_length, unsigned& meta_blocks)
@@ -347,7 +701,7 @@ KResult Ext2FSInode::grow_triply_indirect_block(BlockBasedFileSystem::BlockIndex
     }
 
     // Write out the triply indirect block.
-    return fs().write_block(block, buffer, stream.size());
+    return fs().write_metadata_block(block, buffer, stream.size());
 }
 
 KResult Ext2FSInode::shrink_triply_indirect_block(BlockBasedFileSystem::BlockIndex block, size_t old_blocks_length, size_t new_blocks_length, unsigned& meta_blocks)
@@ -645,9 +999,12 @@ Vector<Ext2FS::BlockIndex> Ext2FSInode::compute_block_list_impl_internal(const e
 
 void Ext2FS::free_inode(Ext2FSInode& inode)
 {
-    MutexLocker locker(m_lock);
     VERIFY(inode.m_raw_inode.i_links_count == 0);
     dbgln_if(EXT2_DEBUG, "Ext2FS[{}]::free_inode(): Inode {} has no more links, time to delete!", fsid(), inode.index());
+    Ext2FSJournalHandle journal_handle(m_journal.ptr());
+
+    if (auto result = discard_preallocation(inode.index()); result.is_error())
+        dbgln("Ext2FS[{}]::free_inode(): Failed to discard preallocated blocks for inode {}: {}", fsid(), inode.index(), result.error());
 
     // Mark all blocks used by this inode as free.
     for (auto block_index : inode.compute_block_list_with_meta_blocks()) {
@@ -661,7 +1018,9 @@ void Ext2FS::free_inode(Ext2FSInode& inode)
 
     // If the inode being freed is a directory, update block group directory counter.
     if (inode.is_directory()) {
-        auto& bgd = const_cast<ext2_group_desc&>(group_descriptor(group_index_from_inode(inode.index())));
+        auto group_index = group_index_from_inode(inode.index());
+        MutexLocker group_locker(block_group(group_index).lock);
+        auto& bgd = const_cast<ext2_group_desc&>(group_descriptor(group_index));
         --bgd.bg_used_dirs_count;
         dbgln_if(EXT2_DEBUG, "Ext2FS[{}]::free_inode(): Decremented bg_used_dirs_count to {} for inode {}", fsid(), bgd.bg_used_dirs_count, inode.index());
         m_block_group_descriptors_dirty = true;
@@ -679,45 +1038,104 @@ void Ext2FS::free_inode(Ext2FSInode& inode)
 
 void Ext2FS::flush_block_group_descriptor_table()
 {
-    MutexLocker locker(m_lock);
     auto blocks_to_write = ceil_div(m_block_group_count * sizeof(ext2_group_desc), block_size());
     auto first_block_of_bgdt = block_size() == 1024 ? 2 : 1;
-    auto buffer = UserOrKernelBuffer::for_kernel_buffer((u8*)block_group_descriptors());
-    if (auto result = write_blocks(first_block_of_bgdt, blocks_to_write, buffer); result.is_error())
+
+    // Take a consistent copy of each descriptor, without holding any group's lock across the write.
+    auto snapshot = ByteBuffer::create_uninitialized(blocks_to_write * block_size());
+    memcpy(snapshot.data(), block_group_descriptors(), snapshot.size());
+    auto* descriptors = reinterpret_cast<ext2_group_desc*>(snapshot.data());
+    for (unsigned i = 1; i <= m_block_group_count; ++i) {
+        MutexLocker group_locker(block_group(i).lock);
+        descriptors[i - 1] = group_descriptor(i);
+    }
+
+    auto buffer = UserOrKernelBuffer::for_kernel_buffer(snapshot.data());
+    if (auto result = write_metadata_blocks(first_block_of_bgdt, blocks_to_write, buffer); result.is_error())
         dbgln("Ext2FS[{}]::flush_block_group_descriptor_table(): Failed to write blocks: {}", fsid(), result.error());
 }
 
 void Ext2FS::flush_writes()
 {
+    flush_metadata_to_cache();
+    if (m_journal) {
+        if (auto result = m_journal->commit(); result.is_error())
+            dbgln("Ext2FS[{}]::flush_writes(): Failed to commit the journal: {}", fsid(), result.error());
+    }
+    BlockBasedFileSystem::flush_writes();
+}
+
+void Ext2FS::flush_old_writes()
+{
+    flush_metadata_to_cache();
+    if (m_journal) {
+        if (auto result = m_journal->commit(); result.is_error())
+            dbgln("Ext2FS[{}]::flush_old_writes(): Failed to commit the journal: {}", fsid(), result.error());
+    }
+    BlockBasedFileSystem::flush_old_writes();
+}
+
+void Ext2FS::write_dirty_metadata()
+{
+    // Only one flush at a time, allocations can carry on meanwhile.
+    MutexLocker locker(m_lock);
+    // Preallocation windows only live in memory, never let them reach the on-disk bitmaps.
+    if (auto result = discard_all_preallocations(); result.is_error())
+        dbgln("Ext2FS[{}]::write_dirty_metadata(): Failed to discard preallocated blocks: {}", fsid(), result.error());
+    bool super_block_dirty;
     {
-        MutexLocker locker(m_lock);
-        if (m_super_block_dirty) {
-            flush_super_block();
-            m_super_block_dirty = false;
-        }
-        if (m_block_group_descriptors_dirty) {
-            flush_block_group_descriptor_table();
-            m_block_group_descriptors_dirty = false;
-        }
-        for (auto& cached_bitmap : m_cached_bitmaps) {
-            if (cached_bitmap->dirty) {
-                auto buffer = UserOrKernelBuffer::for_kernel_buffer(cached_bitmap->buffer.data());
-                if (auto result = write_block(cached_bitmap->bitmap_block_index, buffer, block_size()); result.is_error()) {
-                    dbgln("Ext2FS[{}]::flush_writes(): Failed to write blocks: {}", fsid(), result.error());
-                }
-                cached_bitmap->dirty = false;
-                dbgln_if(EXT2_DEBUG, "Ext2FS[{}]::flush_writes(): Flushed bitmap block {}", fsid(), cached_bitmap->bitmap_block_index);
+        ScopedSpinLock super_block_locker(m_super_block_lock);
+        super_block_dirty = m_super_block_dirty;
+    }
+    if (super_block_dirty)
+        flush_super_block();
+    if (m_block_group_descriptors_dirty.exchange(false))
+        flush_block_group_descriptor_table();
+    for (auto& group : m_block_groups) {
+        MutexLocker group_locker(group.lock);
+        for (auto* cached_bitmap : { group.block_bitmap.ptr(), group.inode_bitmap.ptr() }) {
+            if (!cached_bitmap || !cached_bitmap->dirty)
+                continue;
+            auto buffer = UserOrKernelBuffer::for_kernel_buffer(cached_bitmap->buffer.data());
+            if (auto result = write_metadata_block(cached_bitmap->bitmap_block_index, buffer, block_size()); result.is_error()) {
+                dbgln("Ext2FS[{}]::write_dirty_metadata(): Failed to write blocks: {}", fsid(), result.error());
             }
+            cached_bitmap->dirty = false;
+            dbgln_if(EXT2_DEBUG, "Ext2FS[{}]::write_dirty_metadata(): Flushed bitmap block {}", fsid(), cached_bitmap->bitmap_block_index);
         }
+    }
+}
+
+void Ext2FS::flush_dirty_inodes()
+{
+    NonnullRefPtrVector<Ext2FSInode> dirty_inodes;
+    for (auto& shard : m_inode_cache) {
+        MutexLocker shard_locker(shard.lock);
+        for (auto& it : shard.inodes) {
+            if (it.value && it.value->is_metadata_dirty())
+                dirty_inodes.append(*it.value);
+        }
+    }
+    for (auto& inode : dirty_inodes)
+        inode.flush_metadata();
+}
+
+void Ext2FS::flush_metadata_to_cache()
+{
+    write_dirty_metadata();
 
-        // Uncache Inodes that are only kept alive by the index-to-inode lookup cache.
-        // We don't uncache Inodes that are being watched by at least one InodeWatcher.
+    // Uncache Inodes that are only kept alive by the index-to-inode lookup cache.
+    // We don't uncache Inodes that are being watched by at least one InodeWatcher.
 
-        // FIXME: It would be better to keep a capped number of Inodes around.
-        //        The problem is that they are quite heavy objects, and use a lot of heap memory
-        //        for their (child name lookup) and (block list) caches.
+    // FIXME: It would be better to keep a capped number of Inodes around.
+    //        The problem is that they are quite heavy objects, and use a lot of heap memory
+    //        for their (child name lookup) and (block list) caches.
+    // Declared out here, so that the inodes only die once no lock is held: freeing one may wait for the journal.
+    Vector<RefPtr<Ext2FSInode>> uncached_inodes;
+    for (auto& shard : m_inode_cache) {
+        MutexLocker shard_locker(shard.lock);
         Vector<InodeIndex> unused_inodes;
-        for (auto& it : m_inode_cache) {
+        for (auto& it : shard.inodes) {
             // NOTE: If we're asked to look up an inode by number (via get_inode) and it turns out
             //       to not exist, we remember the fact that it doesn't exist by caching a nullptr.
             //       This seems like a reasonable time to uncache ideas about unknown inodes, so do that.
@@ -731,11 +1149,12 @@ void Ext2FS::flush_writes()
                 continue;
             unused_inodes.append(it.key);
         }
-        for (auto index : unused_inodes)
-            uncache_inode(index);
+        for (auto index : unused_inodes) {
+            auto it = shard.inodes.find(index);
+            uncached_inodes.append(move(it->value));
+            shard.inodes.remove(it);
+        }
     }
-
-    BlockBasedFileSystem::flush_writes();
 }
 
 Ext2FSInode::Ext2FSInode(Ext2FS& fs, InodeIndex index)
@@ -800,12 +1219,13 @@ void Ext2FSInode::flush_metadata()
 
 RefPtr<Inode> Ext2FS::get_inode(InodeIdentifier inode) const
 {
-    MutexLocker locker(m_lock);
     VERIFY(inode.fsid() == fsid());
 
+    auto& shard = inode_cache_shard(inode.index());
+    MutexLocker locker(shard.lock);
     {
-        auto it = m_inode_cache.find(inode.index());
-        if (it != m_inode_cache.end())
+        auto it = shard.inodes.find(inode.index());
+        if (it != shard.inodes.end())
             return (*it).value;
     }
 
@@ -814,7 +1234,7 @@ RefPtr<Inode> Ext2FS::get_inode(InodeIdentifier inode) const
         return {};
 
     if (!state_or_error.value()) {
-        m_inode_cache.set(inode.index(), nullptr);
+        shard.inodes.set(inode.index(), nullptr);
         return {};
     }
 
@@ -829,11 +1249,23 @@ RefPtr<Inode> Ext2FS::get_inode(InodeIdentifier inode) const
         // FIXME: Propagate the actual error.
         return nullptr;
     }
-    m_inode_cache.set(inode.index(), new_inode);
+    shard.inodes.set(inode.index(), new_inode);
     return new_inode;
 }
 
 KResultOr<size_t> Ext2FSInode::read_bytes(off_t offset, size_t count, UserOrKernelBuffer& buffer, FileDescription* description) const
+{
+    bool allow_cache = !description || !description->is_direct();
+    return read_bytes_impl(offset, count, buffer, allow_cache);
+}
+
+KResultOr<size_t> Ext2FSInode::read_bytes_for_page_cache(off_t offset, size_t count, UserOrKernelBuffer& buffer) const
+{
+    // The page cache keeps the file data around itself, so don't keep a second copy in the disk cache.
+    return read_bytes_impl(offset, count, buffer, false);
+}
+
+KResultOr<size_t> Ext2FSInode::read_bytes_impl(off_t offset, size_t count, UserOrKernelBuffer& buffer, bool allow_cache) const
 {
     MutexLocker inode_locker(m_inode_lock);
     VERIFY(offset >= 0);
@@ -861,8 +1293,6 @@ KResultOr<size_t> Ext2FSInode::read_bytes(off_t offset, size_t count, UserOrKern
         return EIO;
     }
 
-    bool allow_cache = !description || !description->is_direct();
-
     const int block_size = fs().block_size();
 
     BlockBasedFileSystem::BlockIndex first_block_logical_index = offset / block_size;
@@ -886,6 +1316,21 @@ KResultOr<size_t> Ext2FSInode::read_bytes(off_t offset, size_t count, UserOrKern
             // This is a hole, act as if it's filled with zeroes.
             if (!buffer_offset.memset(0, num_bytes_to_copy))
                 return EFAULT;
+        } else if (offset_into_block == 0 && num_bytes_to_copy == (size_t)block_size) {
+            // Read whole blocks that are next to each other on disk in one go.
+            size_t run_length = 1;
+            while (bi.value() + run_length <= last_block_logical_index.value()
+                && remaining_count >= (off_t)((run_length + 1) * block_size)
+                && m_block_list[bi.value() + run_length].value() == block_index.value() + run_length)
+                ++run_length;
+            if (auto result = fs().read_blocks(block_index, run_length, buffer_offset, allow_cache); result.is_error()) {
+                dmesgln("Ext2FSInode[{}]::read_bytes(): Failed to read {} blocks at {} (index {})", identifier(), run_length, block_index.value(), bi);
+                return result.error();
+            }
+            remaining_count -= run_length * block_size;
+            nread += run_length * block_size;
+            bi = bi.value() + run_length - 1;
+            continue;
         } else {
             if (auto result = fs().read_block(block_index, &buffer_offset, num_bytes_to_copy, offset_into_block, allow_cache); result.is_error()) {
                 dmesgln("Ext2FSInode[{}]::read_bytes(): Failed to read block {} (index {})", identifier(), block_index.value(), bi);
@@ -919,7 +1364,7 @@ KResult Ext2FSInode::resize(u64 new_size)
 
     if (blocks_needed_after > blocks_needed_before) {
         auto additional_blocks_needed = blocks_needed_after - blocks_needed_before;
-        if (additional_blocks_needed > fs().super_block().s_free_blocks_count)
+        if (additional_blocks_needed > fs().free_block_count())
             return ENOSPC;
     }
 
@@ -927,12 +1372,22 @@ KResult Ext2FSInode::resize(u64 new_size)
         m_block_list = this->compute_block_list();
 
     if (blocks_needed_after > blocks_needed_before) {
-        auto blocks_or_error = fs().allocate_blocks(fs().group_index_from_inode(index()), blocks_needed_after - blocks_needed_before);
+        // Growing regular files get a preallocation window proportional to their size, so that
+        // a stream of small appends still ends up contiguous on disk.
+        BlockBasedFileSystem::BlockIndex goal;
+        if (!m_block_list.is_empty() && m_block_list.last().value())
+            goal = m_block_list.last().value() + 1;
+        size_t preallocation_count = 0;
+        if (Kernel::is_regular_file(m_raw_inode.i_mode))
+            preallocation_count = clamp(static_cast<size_t>(blocks_needed_after), min_preallocation_blocks, max_preallocation_blocks);
+        auto blocks_or_error = fs().allocate_blocks_for_inode(index(), blocks_needed_after - blocks_needed_before, goal, preallocation_count);
         if (blocks_or_error.is_error())
             return blocks_or_error.error();
         if (!m_block_list.try_extend(blocks_or_error.release_value()))
             return ENOMEM;
     } else if (blocks_needed_after < blocks_needed_before) {
+        if (auto result = fs().discard_preallocation(index()); result.is_error())
+            return result;
         if constexpr (EXT2_VERY_DEBUG) {
             dbgln("Ext2FSInode[{}]::resize(): Shrinking inode, old block list is {} entries:", identifier(), m_block_list.size());
             for (auto block_index : m_block_list) {
@@ -982,9 +1437,29 @@ KResultOr<size_t> Ext2FSInode::write_bytes(off_t offset, size_t count, const Use
 {
     VERIFY(offset >= 0);
 
+    // Large writes are split up, so that the metadata each part changes fits in a single journal transaction.
+    size_t nwritten = 0;
+    while (nwritten < count) {
+        auto count_to_write = min(count - nwritten, max_write_size_per_transaction);
+        auto result = write_bytes_in_one_transaction(offset + nwritten, count_to_write, data.offset(nwritten), description);
+        if (result.is_error()) {
+            if (nwritten)
+                break;
+            return result;
+        }
+        nwritten += result.value();
+        if (result.value() < count_to_write)
+            break;
+    }
+    return nwritten;
+}
+
+KResultOr<size_t> Ext2FSInode::write_bytes_in_one_transaction(off_t offset, size_t count, const UserOrKernelBuffer& data, FileDescription* description)
+{
     if (count == 0)
         return 0;
 
+    Ext2FSJournalHandle journal_handle(fs().m_journal.ptr());
     MutexLocker inode_locker(m_inode_lock);
 
     if (auto result = prepare_to_write_data(); result.is_error())
@@ -1035,7 +1510,10 @@ KResultOr<size_t> Ext2FSInode::write_bytes(off_t offset, size_t count, const Use
         size_t offset_into_block = (bi == first_block_logical_index) ? offset_into_first_block : 0;
         size_t num_bytes_to_copy = min((size_t)block_size - offset_into_block, (size_t)remaining_count);
         dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::write_bytes(): Writing block {} (offset_into_block: {})", identifier(), m_block_list[bi.value()], offset_into_block);
-        if (auto result = fs().write_block(m_block_list[bi.value()], data.offset(nwritten), num_bytes_to_copy, offset_into_block, allow_cache); result.is_error()) {
+        // Directory contents are metadata as far as the journal is concerned.
+        auto result = is_directory() ? fs().write_metadata_block(m_block_list[bi.value()], data.offset(nwritten), num_bytes_to_copy, offset_into_block)
+                                     : fs().write_block(m_block_list[bi.value()], data.offset(nwritten), num_bytes_to_copy, offset_into_block, allow_cache);
+        if (result.is_error()) {
             dbgln("Ext2FSInode[{}]::write_bytes(): Failed to write block {} (index {})", identifier(), m_block_list[bi.value()], bi);
             return result;
         }
@@ -1113,6 +1591,378 @@ KResult Ext2FSInode::traverse_as_directory(Function<bool(FileSystem::DirectoryEn
 KResult Ext2FSInode::write_directory(Vector<Ext2FSDirectoryEntry>& entries)
 {
     MutexLocker locker(m_inode_lock);
+
+    if (fs().has_directory_index_feature()) {
+        size_t linear_size = 0;
+        for (auto& entry : entries)
+            linear_size += EXT2_DIR_REC_LEN(entry.name.length());
+        if (linear_size > fs().block_size()) {
+            auto result = write_indexed_directory(entries);
+            if (result.error() != -EOVERFLOW)
+                return result;
+        }
+    }
+
+    return write_linear_directory(entries);
+}
+
+KResult Ext2FSInode::read_directory_block(u64 block_index, ByteBuffer& block) const
+{
+    auto block_size = fs().block_size();
+    if ((block_index + 1) * block_size > size())
+        return EIO;
+    block = ByteBuffer::create_uninitialized(block_size);
+    auto buffer = UserOrKernelBuffer::for_kernel_buffer(block.data());
+    auto result = read_bytes(block_index * block_size, block_size, buffer, nullptr);
+    if (result.is_error())
+        return result.error();
+    if (result.value() != block_size)
+        return EIO;
+    return KSuccess;
+}
+
+KResult Ext2FSInode::write_directory_block(u64 block_index, ByteBuffer const& block)
+{
+    auto buffer = UserOrKernelBuffer::for_kernel_buffer(const_cast<u8*>(block.data()));
+    auto result = write_bytes(block_index * fs().block_size(), block.size(), buffer, nullptr);
+    if (result.is_error())
+        return result.error();
+    if (result.value() != block.size())
+        return EIO;
+    return KSuccess;
+}
+
+u8 Ext2FSInode::directory_index_hash_version(u8 hash_version) const
+{
+    if (fs().super_block().s_flags & EXT2_FLAGS_UNSIGNED_HASH)
+        return hash_version + EXT2_HASH_LEGACY_UNSIGNED;
+    return hash_version;
+}
+
+KResult Ext2FSInode::read_directory_index_node(u64 block_index, Ext2FSDirectoryIndexFrame& frame) const
+{
+    if (auto result = read_directory_block(block_index, frame.block); result.is_error())
+        return result;
+    auto& fake_entry = *reinterpret_cast<ext2_dir_entry_2 const*>(frame.block.data());
+    if (fake_entry.inode != 0 || fake_entry.rec_len != frame.block.size())
+        return EIO;
+    frame.block_index = block_index;
+    frame.entries_offset = directory_index_node_entries_offset;
+    frame.entry = 0;
+    auto& countlimit = frame.countlimit();
+    if (countlimit.limit != (frame.block.size() - frame.entries_offset) / sizeof(ext2_dx_entry) || countlimit.count == 0 || countlimit.count > countlimit.limit)
+        return EIO;
+    return KSuccess;
+}
+
+KResult Ext2FSInode::probe_directory_index(StringView name, Ext2FSDirectoryIndexPath& path) const
+{
+    path.frames.clear();
+
+    Ext2FSDirectoryIndexFrame root;
+    if (auto result = read_directory_block(0, root.block); result.is_error())
+        return result;
+
+    auto block_size = fs().block_size();
+    auto& dot = *reinterpret_cast<ext2_dir_entry_2 const*>(root.block.data());
+    auto& dot_dot = *reinterpret_cast<ext2_dir_entry_2 const*>(root.block.data() + 12);
+    auto& root_info = *reinterpret_cast<ext2_dx_root_info const*>(root.block.data() + 24);
+    if (dot.rec_len != 12 || dot_dot.rec_len != block_size - 12)
+        return EIO;
+    if (root_info.reserved_zero != 0 || root_info.info_length != 8)
+        return EIO;
+    if (root_info.hash_version > EXT2_HASH_TEA || root_info.indirect_levels > directory_index_max_indirect_levels)
+        return ENOTSUP;
+
+    root.entries_offset = directory_index_root_entries_offset;
+    auto& countlimit = root.countlimit();
+    if (countlimit.limit != (block_size - root.entries_offset) / sizeof(ext2_dx_entry) || countlimit.count == 0 || countlimit.count > countlimit.limit)
+        return EIO;
+
+    path.hash_version = root_info.hash_version;
+    path.hash = directory_index_hash(name, directory_index_hash_version(path.hash_version), fs().super_block().s_hash_seed);
+    path.frames.append(move(root));
+
+    for (size_t level = 0;; ++level) {
+        auto& frame = path.frames.last();
+        auto* entries = frame.entries();
+
+        // Find the last entry whose hash is not greater than ours; the first entry has no hash
+        // and covers everything below the second one.
+        size_t low = 1;
+        size_t high = frame.countlimit().count - 1;
+        frame.entry = 0;
+        while (low <= high) {
+            auto middle = (low + high) / 2;
+            if (entries[middle].hash > path.hash) {
+                high = middle - 1;
+            } else {
+                frame.entry = middle;
+                low = middle + 1;
+            }
+        }
+
+        if (level == root_info.indirect_levels)
+            return KSuccess;
+
+        Ext2FSDirectoryIndexFrame node;
+        if (auto result = read_directory_index_node(frame.target_block(), node); result.is_error())
+            return result;
+        path.frames.append(move(node));
+    }
+}
+
+KResultOr<bool> Ext2FSInode::advance_directory_index(Ext2FSDirectoryIndexPath& path) const
+{
+    // Entries with the same hash may spill over into the next leaf, which is then
+    // indexed under that same hash (with the collision bit set).
+    size_t level = path.frames.size();
+    while (level > 0 && path.frames[level - 1].entry + 1 >= path.frames[level - 1].countlimit().count)
+        --level;
+    if (level == 0)
+        return false;
+
+    auto& frame = path.frames[level - 1];
+    if ((frame.entries()[frame.entry + 1].hash & ~1u) != path.hash)
+        return false;
+    ++frame.entry;
+
+    for (; level < path.frames.size(); ++level) {
+        if (auto result = read_directory_index_node(path.frames[level - 1].target_block(), path.frames[level]); result.is_error())
+            return result;
+    }
+    return true;
+}
+
+KResultOr<InodeIndex> Ext2FSInode::find_in_directory_index(StringView name, Ext2FSDirectoryIndexPath& path, ByteBuffer& leaf) const
+{
+    // "." and ".." live in front of the index root, not in any leaf.
+    if (name == "."sv || name == ".."sv) {
+        if (auto result = read_directory_block(0, leaf); result.is_error())
+            return result;
+        if (auto* entry = find_directory_entry_in_block(leaf, name))
+            return InodeIndex(entry->inode);
+        return ENOENT;
+    }
+
+    if (auto result = probe_directory_index(name, path); result.is_error())
+        return result;
+
+    for (;;) {
+        if (auto result = read_directory_block(path.frames.last().target_block(), leaf); result.is_error())
+            return result;
+        if (auto* entry = find_directory_entry_in_block(leaf, name))
+            return InodeIndex(entry->inode);
+        auto advanced_or_error = advance_directory_index(path);
+        if (advanced_or_error.is_error())
+            return advanced_or_error.error();
+        if (!advanced_or_error.value())
+            return ENOENT;
+    }
+}
+
+KResult Ext2FSInode::add_child_to_directory_index(Ext2FSDirectoryIndexPath& path, ByteBuffer& leaf, StringView name, InodeIndex inode_index, u8 file_type)
+{
+    auto& parent = path.frames.last();
+    auto leaf_block_index = parent.target_block();
+
+    if (insert_directory_entry_into_block(leaf, name, inode_index, file_type)) {
+        dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::add_child_to_directory_index(): Inserted '{}' into leaf block {}", identifier(), name, leaf_block_index);
+        return write_directory_block(leaf_block_index, leaf);
+    }
+
+    auto& countlimit = parent.countlimit();
+    if (countlimit.count >= countlimit.limit) {
+        // The index node is full as well, so rebuild the whole index with room to grow.
+        dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::add_child_to_directory_index(): Index node {} is full, rebuilding the index", identifier(), parent.block_index);
+        Vector<Ext2FSDirectoryEntry> entries;
+        KResult result = traverse_as_directory([&](auto& entry) {
+            entries.append({ entry.name, entry.inode.index(), entry.file_type });
+            return true;
+        });
+        if (result.is_error())
+            return result;
+        entries.empend(name, inode_index, file_type);
+        return write_directory(entries);
+    }
+
+    // Split the full leaf in two halves by hash order, and index the upper half in the parent.
+    struct HashedEntry {
+        u32 hash;
+        Ext2FSDirectoryEntry entry;
+    };
+    Vector<HashedEntry> hashed_entries;
+    auto hash_version = directory_index_hash_version(path.hash_version);
+    size_t total_length = 0;
+    auto add_hashed_entry = [&](StringView entry_name, InodeIndex entry_inode_index, u8 entry_file_type) {
+        total_length += EXT2_DIR_REC_LEN(entry_name.length());
+        hashed_entries.append({ directory_index_hash(entry_name, hash_version, fs().super_block().s_hash_seed), { entry_name, entry_inode_index, entry_file_type } });
+    };
+    for (size_t offset = 0; offset + 8 <= leaf.size();) {
+        auto* entry = reinterpret_cast<ext2_dir_entry_2*>(leaf.data() + offset);
+        if (entry->rec_len < 8 || offset + entry->rec_len > leaf.size())
+            return EIO;
+        if (entry->inode != 0)
+            add_hashed_entry({ entry->name, entry->name_len }, entry->inode, entry->file_type);
+        offset += entry->rec_len;
+    }
+    add_hashed_entry(name, inode_index, file_type);
+    quick_sort(hashed_entries, [](auto& a, auto& b) { return a.hash < b.hash; });
+
+    size_t split = 0;
+    for (size_t length = 0; split + 1 < hashed_entries.size() && length < total_length / 2; ++split)
+        length += EXT2_DIR_REC_LEN(hashed_entries[split].entry.name.length());
+    split = max(split, static_cast<size_t>(1));
+    auto split_hash = hashed_entries[split].hash;
+    if (split_hash == hashed_entries[split - 1].hash)
+        split_hash |= 1;
+
+    Vector<Ext2FSDirectoryEntry> lower_entries;
+    Vector<Ext2FSDirectoryEntry> upper_entries;
+    for (size_t i = 0; i < hashed_entries.size(); ++i)
+        (i < split ? lower_entries : upper_entries).append(move(hashed_entries[i].entry));
+
+    auto block_size = fs().block_size();
+    u64 new_block_index = size() / block_size;
+    if (auto result = resize(size() + block_size); result.is_error())
+        return result;
+
+    pack_directory_block(leaf.data(), block_size, lower_entries);
+    auto new_leaf = ByteBuffer::create_uninitialized(block_size);
+    pack_directory_block(new_leaf.data(), block_size, upper_entries);
+
+    auto* entries = parent.entries();
+    for (size_t i = countlimit.count; i > parent.entry + 1; --i)
+        entries[i] = entries[i - 1];
+    entries[parent.entry + 1] = { split_hash, static_cast<u32>(new_block_index) };
+    ++countlimit.count;
+
+    dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::add_child_to_directory_index(): Split leaf block {} at hash {:#x} into new block {}", identifier(), leaf_block_index, split_hash, new_block_index);
+
+    if (auto result = write_directory_block(leaf_block_index, leaf); result.is_error())
+        return result;
+    if (auto result = write_directory_block(new_block_index, new_leaf); result.is_error())
+        return result;
+    return write_directory_block(parent.block_index, parent.block);
+}
+
+KResult Ext2FSInode::write_indexed_directory(Vector<Ext2FSDirectoryEntry>& entries)
+{
+    auto block_size = fs().block_size();
+    auto& super_block = fs().super_block();
+    u8 hash_version = super_block.s_def_hash_version <= EXT2_HASH_TEA ? super_block.s_def_hash_version : EXT2_HASH_HALF_MD4;
+    auto effective_hash_version = directory_index_hash_version(hash_version);
+
+    InodeIndex parent_index = index();
+    struct HashedEntry {
+        u32 hash;
+        Ext2FSDirectoryEntry entry;
+    };
+    Vector<HashedEntry> hashed_entries;
+    for (auto& entry : entries) {
+        if (entry.name == ".")
+            continue;
+        if (entry.name == "..") {
+            parent_index = entry.inode_index;
+            continue;
+        }
+        hashed_entries.append({ directory_index_hash(entry.name, effective_hash_version, super_block.s_hash_seed), entry });
+    }
+    quick_sort(hashed_entries, [](auto& a, auto& b) { return a.hash < b.hash; });
+
+    // Leave a quarter of every leaf and index node free, so that most future insertions
+    // don't have to split anything.
+    struct Leaf {
+        u32 hash;
+        size_t first_entry;
+        size_t entry_count;
+    };
+    Vector<Leaf> leaves;
+    size_t leaf_fill_limit = block_size * 3 / 4;
+    size_t leaf_length = 0;
+    for (size_t i = 0; i < hashed_entries.size(); ++i) {
+        auto record_length = EXT2_DIR_REC_LEN(hashed_entries[i].entry.name.length());
+        if (leaves.is_empty() || leaf_length + record_length > leaf_fill_limit) {
+            u32 hash = hashed_entries[i].hash;
+            if (i > 0 && hash == hashed_entries[i - 1].hash)
+                hash |= 1;
+            leaves.append({ hash, i, 0 });
+            leaf_length = 0;
+        }
+        ++leaves.last().entry_count;
+        leaf_length += record_length;
+    }
+    if (leaves.is_empty())
+        leaves.append({ 0, 0, 0 });
+
+    size_t root_limit = (block_size - directory_index_root_entries_offset) / sizeof(ext2_dx_entry);
+    size_t node_limit = (block_size - directory_index_node_entries_offset) / sizeof(ext2_dx_entry);
+    size_t leaves_per_node = node_limit * 3 / 4;
+    u8 indirect_levels = leaves.size() > root_limit ? 1 : 0;
+    size_t node_count = indirect_levels ? ceil_div(leaves.size(), leaves_per_node) : 0;
+    if (node_count > root_limit)
+        return EOVERFLOW;
+
+    size_t first_leaf_block = 1 + node_count;
+    size_t block_count = first_leaf_block + leaves.size();
+    auto directory_data = ByteBuffer::create_zeroed(block_count * block_size);
+
+    auto write_index_entries = [&](u8* block, size_t entries_offset, size_t limit, size_t count, auto entry_for_index) {
+        auto& countlimit = *reinterpret_cast<ext2_dx_countlimit*>(block + entries_offset);
+        auto* dx_entries = reinterpret_cast<ext2_dx_entry*>(block + entries_offset);
+        for (size_t i = 0; i < count; ++i)
+            dx_entries[i] = entry_for_index(i);
+        countlimit.limit = limit;
+        countlimit.count = count;
+    };
+
+    auto* root = directory_data.data();
+    write_directory_entry(root, index(), 12, ".", EXT2_FT_DIR);
+    write_directory_entry(root + 12, parent_index, block_size - 12, "..", EXT2_FT_DIR);
+    auto& root_info = *reinterpret_cast<ext2_dx_root_info*>(root + 24);
+    root_info.hash_version = hash_version;
+    root_info.info_length = 8;
+    root_info.indirect_levels = indirect_levels;
+
+    if (indirect_levels == 0) {
+        write_index_entries(root, directory_index_root_entries_offset, root_limit, leaves.size(), [&](size_t i) {
+            return ext2_dx_entry { leaves[i].hash, static_cast<u32>(first_leaf_block + i) };
+        });
+    } else {
+        write_index_entries(root, directory_index_root_entries_offset, root_limit, node_count, [&](size_t i) {
+            return ext2_dx_entry { leaves[i * leaves_per_node].hash, static_cast<u32>(1 + i) };
+        });
+        for (size_t node = 0; node < node_count; ++node) {
+            auto* block = directory_data.data() + (1 + node) * block_size;
+            write_directory_entry(block, 0, block_size, {}, 0);
+            size_t first_leaf = node * leaves_per_node;
+            write_index_entries(block, directory_index_node_entries_offset, node_limit, min(leaves_per_node, leaves.size() - first_leaf), [&](size_t i) {
+                return ext2_dx_entry { leaves[first_leaf + i].hash, static_cast<u32>(first_leaf_block + first_leaf + i) };
+            });
+        }
+    }
+
+    Vector<Ext2FSDirectoryEntry> leaf_entries;
+    for (size_t i = 0; i < leaves.size(); ++i) {
+        leaf_entries.clear_with_capacity();
+        for (size_t j = 0; j < leaves[i].entry_count; ++j)
+            leaf_entries.append(hashed_entries[leaves[i].first_entry + j].entry);
+        pack_directory_block(directory_data.data() + (first_leaf_block + i) * block_size, block_size, leaf_entries);
+    }
+
+    dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::write_indexed_directory(): Writing {} entries into {} leaves and {} index nodes", identifier(), hashed_entries.size(), leaves.size(), node_count);
+
+    if (auto result = resize(directory_data.size()); result.is_error())
+        return result;
+    if (auto result = write_directory_block(0, directory_data); result.is_error())
+        return result;
+    m_raw_inode.i_flags |= EXT2_INDEX_FL;
+    set_metadata_dirty(true);
+    return KSuccess;
+}
+
+KResult Ext2FSInode::write_linear_directory(Vector<Ext2FSDirectoryEntry>& entries)
+{
     auto block_size = fs().block_size();
 
     // Calculate directory size and record length of entries so that
@@ -1167,6 +2017,10 @@ KResult Ext2FSInode::write_directory(Vector<Ext2FSDirectoryEntry>& entries)
     set_metadata_dirty(true);
     if (static_cast<size_t>(result.value()) != directory_data.size())
         return EIO;
+    if (m_raw_inode.i_flags & EXT2_INDEX_FL) {
+        m_raw_inode.i_flags &= ~EXT2_INDEX_FL;
+        set_metadata_dirty(true);
+    }
     return KSuccess;
 }
 
@@ -1179,6 +2033,7 @@ KResultOr<NonnullRefPtr<Inode>> Ext2FSInode::create_child(StringView name, mode_
 
 KResult Ext2FSInode::add_child(Inode& child, const StringView& name, mode_t mode)
 {
+    Ext2FSJournalHandle journal_handle(fs().m_journal.ptr());
     MutexLocker locker(m_inode_lock);
     VERIFY(is_directory());
 
@@ -1187,6 +2042,27 @@ KResult Ext2FSInode::add_child(Inode& child, const StringView& name, mode_t mode
 
     dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::add_child(): Adding inode {} with name '{}' and mode {:o} to directory {}", identifier(), child.index(), name, mode, index());
 
+    if (is_indexed_directory()) {
+        Ext2FSDirectoryIndexPath path;
+        ByteBuffer leaf;
+        auto existing_or_error = find_in_directory_index(name, path, leaf);
+        if (!existing_or_error.is_error()) {
+            dbgln("Ext2FSInode[{}]::add_child(): Name '{}' already exists", identifier(), name);
+            return EEXIST;
+        }
+        if (existing_or_error.error() == -ENOENT) {
+            if (auto result = child.increment_link_count(); result.is_error())
+                return result;
+            if (auto result = add_child_to_directory_index(path, leaf, name, child.index(), to_ext2_file_type(mode)); result.is_error())
+                return result;
+            if (!m_lookup_cache.is_empty())
+                m_lookup_cache.set(name, child.index());
+            did_add_child(child.identifier(), name);
+            return KSuccess;
+        }
+        dbgln("Ext2FSInode[{}]::add_child(): Can't use directory index ({}), rewriting the directory", identifier(), existing_or_error.error());
+    }
+
     Vector<Ext2FSDirectoryEntry> entries;
     bool name_already_exists = false;
     KResult result = traverse_as_directory([&](auto& entry) {
@@ -1225,10 +2101,23 @@ KResult Ext2FSInode::add_child(Inode& child, const StringView& name, mode_t mode
 
 KResult Ext2FSInode::remove_child(const StringView& name)
 {
+    Ext2FSJournalHandle journal_handle(fs().m_journal.ptr());
     MutexLocker locker(m_inode_lock);
     dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::remove_child(): Removing '{}'", identifier(), name);
     VERIFY(is_directory());
 
+    // Removing "." and ".." only happens to empty directories, which are cheap to rewrite linearly.
+    if (is_indexed_directory() && name != "."sv && name != ".."sv) {
+        Ext2FSDirectoryIndexPath path;
+        ByteBuffer leaf;
+        auto child_inode_index_or_error = find_in_directory_index(name, path, leaf);
+        if (!child_inode_index_or_error.is_error())
+            return remove_child_from_directory_index(name, child_inode_index_or_error.value(), path, leaf);
+        if (child_inode_index_or_error.error() == -ENOENT)
+            return ENOENT;
+        dbgln("Ext2FSInode[{}]::remove_child(): Can't use directory index ({}), rewriting the directory", identifier(), child_inode_index_or_error.error());
+    }
+
     if (auto populate_result = populate_lookup_cache(); populate_result.is_error())
         return populate_result;
 
@@ -1263,6 +2152,31 @@ KResult Ext2FSInode::remove_child(const StringView& name)
     return KSuccess;
 }
 
+KResult Ext2FSInode::remove_child_from_directory_index(StringView name, InodeIndex child_inode_index, Ext2FSDirectoryIndexPath& path, ByteBuffer& leaf)
+{
+    // Leaves are never merged back together, the freed space is simply reused by later insertions.
+    ext2_dir_entry_2* previous_entry = nullptr;
+    auto* entry = find_directory_entry_in_block(leaf, name, &previous_entry);
+    VERIFY(entry);
+    if (previous_entry)
+        previous_entry->rec_len += entry->rec_len;
+    else
+        entry->inode = 0;
+
+    if (auto result = write_directory_block(path.frames.last().target_block(), leaf); result.is_error())
+        return result;
+
+    m_lookup_cache.remove(name);
+
+    InodeIdentifier child_id { fsid(), child_inode_index };
+    auto child_inode = fs().get_inode(child_id);
+    if (auto result = child_inode->decrement_link_count(); result.is_error())
+        return result;
+
+    did_remove_child(child_id, name);
+    return KSuccess;
+}
+
 u64 Ext2FS::inodes_per_block() const
 {
     return EXT2_INODES_PER_BLOCK(&super_block());
@@ -1289,12 +2203,41 @@ bool Ext2FS::write_ext2_inode(InodeIndex inode, const ext2_inode& e2inode)
     if (!find_block_containing_inode(inode, block_index, offset))
         return false;
     auto buffer = UserOrKernelBuffer::for_kernel_buffer(const_cast<u8*>((const u8*)&e2inode));
-    return write_block(block_index, buffer, inode_size(), offset) >= 0;
+    return write_metadata_block(block_index, buffer, inode_size(), offset) >= 0;
+}
+
+KResult Ext2FS::allocate_block_run(GroupIndex group_index, CachedBitmap& cached_bitmap, size_t first_bit_index, size_t count, Vector<BlockIndex>& blocks)
+{
+    VERIFY(block_group(group_index).lock.own_lock());
+    auto& bgd = const_cast<ext2_group_desc&>(group_descriptor(group_index));
+    if (count > bgd.bg_free_blocks_count)
+        return EIO;
+
+    auto block_bitmap = cached_bitmap.bitmap(blocks_per_group());
+    BlockIndex first_block_in_group = (group_index.value() - 1) * blocks_per_group() + first_block_index().value();
+    for (size_t i = 0; i < count; ++i) {
+        if (block_bitmap.get(first_bit_index + i)) {
+            dbgln("Ext2FS: Block {} in group {} is already allocated", first_block_in_group.value() + first_bit_index + i, group_index);
+            return EIO;
+        }
+    }
+    if (!update_super_block_counter(m_super_block.s_free_blocks_count, -static_cast<ssize_t>(count)))
+        return EIO;
+    for (size_t i = 0; i < count; ++i) {
+        block_bitmap.set(first_bit_index + i, true);
+        blocks.unchecked_append(first_block_in_group.value() + first_bit_index + i);
+    }
+    dbgln_if(EXT2_DEBUG, "Ext2FS: allocated {} block(s) starting at {} [{}]", count, first_block_in_group.value() + first_bit_index, group_index);
+
+    cached_bitmap.dirty = true;
+    bgd.bg_free_blocks_count -= count;
+    m_block_group_descriptors_dirty = true;
+    return KSuccess;
 }
 
-auto Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count) -> KResultOr<Vector<BlockIndex>>
+auto Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count, BlockIndex goal) -> KResultOr<Vector<BlockIndex>>
 {
-    dbgln_if(EXT2_DEBUG, "Ext2FS: allocate_blocks(preferred group: {}, count {})", preferred_group_index, count);
+    dbgln_if(EXT2_DEBUG, "Ext2FS: allocate_blocks(preferred group: {}, count {}, goal {})", preferred_group_index, count, goal);
     if (count == 0)
         return Vector<BlockIndex> {};
 
@@ -1302,63 +2245,201 @@ auto Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count) ->
     if (!blocks.try_ensure_capacity(count))
         return ENOMEM;
 
-    MutexLocker locker(m_lock);
-    auto group_index = preferred_group_index;
+    if (count > unreserved_free_block_count())
+        return ENOSPC;
+
+    // Other threads allocate from other groups at the same time, so we may still come up short.
+    auto give_back_blocks = [&](KResult result) -> KResult {
+        for (auto block_index : blocks) {
+            if (auto free_result = set_block_allocation_state(block_index, false); free_result.is_error())
+                dbgln("Ext2FS: Failed to give back block {} in allocate_blocks()", block_index);
+        }
+        return result;
+    };
 
-    if (!group_descriptor(preferred_group_index).bg_free_blocks_count) {
-        group_index = 1;
+    int blocks_in_group = min(blocks_per_group(), super_block().s_blocks_count);
+
+    // Continue right after the caller's previous block if we can, so that files grow contiguously.
+    if (goal.value() > first_block_index().value() && goal.value() < super_block().s_blocks_count) {
+        auto goal_group_index = group_index_from_block_index(goal);
+        auto& group = block_group(goal_group_index);
+        MutexLocker group_locker(group.lock);
+        auto& bgd = group_descriptor(goal_group_index);
+        if (bgd.bg_free_blocks_count) {
+            auto cached_bitmap_or_error = get_bitmap_block(group.block_bitmap, bgd.bg_block_bitmap);
+            if (cached_bitmap_or_error.is_error())
+                return cached_bitmap_or_error.error();
+            auto& cached_bitmap = *cached_bitmap_or_error.value();
+            auto block_bitmap = cached_bitmap.bitmap(blocks_in_group);
+
+            size_t first_bit_index = (goal.value() - first_block_index().value()) % blocks_per_group();
+            size_t run_length = 0;
+            while (run_length < count && first_bit_index + run_length < block_bitmap.size() && !block_bitmap.get(first_bit_index + run_length))
+                ++run_length;
+            if (auto result = allocate_block_run(goal_group_index, cached_bitmap, first_bit_index, run_length, blocks); result.is_error())
+                return result;
+            preferred_group_index = goal_group_index;
+        }
     }
 
+    // Then take the longest free runs, going around the groups once starting at the preferred one.
+    auto group_index = preferred_group_index.value() ? preferred_group_index : GroupIndex { 1 };
+    size_t groups_left = m_block_group_count;
     while (blocks.size() < count) {
-        bool found_a_group = false;
-        if (group_descriptor(group_index).bg_free_blocks_count) {
-            found_a_group = true;
-        } else {
-            if (group_index == preferred_group_index)
-                group_index = 1;
-            for (; group_index <= m_block_group_count; group_index = GroupIndex { group_index.value() + 1 }) {
-                if (group_descriptor(group_index).bg_free_blocks_count) {
-                    found_a_group = true;
-                    break;
+        size_t allocated_blocks = 0;
+        {
+            auto& group = block_group(group_index);
+            MutexLocker group_locker(group.lock);
+            auto& bgd = group_descriptor(group_index);
+            if (bgd.bg_free_blocks_count) {
+                auto cached_bitmap_or_error = get_bitmap_block(group.block_bitmap, bgd.bg_block_bitmap);
+                if (cached_bitmap_or_error.is_error())
+                    return give_back_blocks(cached_bitmap_or_error.error());
+                auto& cached_bitmap = *cached_bitmap_or_error.value();
+
+                auto block_bitmap = cached_bitmap.bitmap(blocks_in_group);
+
+                size_t free_region_size = 0;
+                auto first_unset_bit_index = block_bitmap.find_longest_range_of_unset_bits(count - blocks.size(), free_region_size);
+                if (first_unset_bit_index.has_value() && free_region_size) {
+                    dbgln_if(EXT2_DEBUG, "Ext2FS: allocating free region of size: {} [{}]", free_region_size, group_index);
+                    if (auto result = allocate_block_run(group_index, cached_bitmap, first_unset_bit_index.value(), free_region_size, blocks); result.is_error()) {
+                        dbgln("Ext2FS: Failed to allocate {} blocks in group {} in allocate_blocks()", free_region_size, group_index);
+                        return give_back_blocks(result);
+                    }
+                    allocated_blocks = free_region_size;
                 }
             }
         }
+        if (allocated_blocks)
+            continue;
+        if (--groups_left == 0)
+            return give_back_blocks(ENOSPC);
+        group_index = group_index.value() % m_block_group_count + 1;
+    }
 
-        VERIFY(found_a_group);
-        auto& bgd = group_descriptor(group_index);
+    VERIFY(blocks.size() == count);
+    return blocks;
+}
 
-        auto cached_bitmap_or_error = get_bitmap_block(bgd.bg_block_bitmap);
-        if (cached_bitmap_or_error.is_error())
-            return cached_bitmap_or_error.error();
-        auto& cached_bitmap = *cached_bitmap_or_error.value();
+auto Ext2FS::allocate_blocks_for_inode(InodeIndex inode_index, size_t count, BlockIndex goal, size_t preallocation_count) -> KResultOr<Vector<BlockIndex>>
+{
+    dbgln_if(EXT2_DEBUG, "Ext2FS: allocate_blocks_for_inode(inode: {}, count {}, goal {}, preallocation {})", inode_index, count, goal, preallocation_count);
+    if (count == 0)
+        return Vector<BlockIndex> {};
 
-        int blocks_in_group = min(blocks_per_group(), super_block().s_blocks_count);
-        auto block_bitmap = cached_bitmap.bitmap(blocks_in_group);
-
-        BlockIndex first_block_in_group = (group_index.value() - 1) * blocks_per_group() + first_block_index().value();
-        size_t free_region_size = 0;
-        auto first_unset_bit_index = block_bitmap.find_longest_range_of_unset_bits(count - blocks.size(), free_region_size);
-        VERIFY(first_unset_bit_index.has_value());
-        dbgln_if(EXT2_DEBUG, "Ext2FS: allocating free region of size: {} [{}]", free_region_size, group_index);
-        for (size_t i = 0; i < free_region_size; ++i) {
-            BlockIndex block_index = (first_unset_bit_index.value() + i) + first_block_in_group.value();
-            if (auto result = set_block_allocation_state(block_index, true); result.is_error()) {
-                dbgln("Ext2FS: Failed to allocate block {} in allocate_blocks()", block_index);
-                return result;
+    Vector<BlockIndex> blocks;
+    if (!blocks.try_ensure_capacity(count))
+        return ENOMEM;
+
+    // Hand out the inode's preallocation window first, as long as the file still ends right in front of it.
+    bool window_is_stale = false;
+    {
+        MutexLocker preallocation_locker(m_preallocation_lock);
+        if (auto it = m_preallocations.find(inode_index); it != m_preallocations.end()) {
+            auto& preallocation = it->value;
+            if (preallocation.first_block == goal) {
+                auto taken = min(count, preallocation.count);
+                for (size_t i = 0; i < taken; ++i)
+                    blocks.unchecked_append(preallocation.first_block.value() + i);
+                preallocation.first_block = preallocation.first_block.value() + taken;
+                preallocation.count -= taken;
+                m_preallocated_block_count -= taken;
+                goal = preallocation.first_block;
+                if (preallocation.count == 0)
+                    m_preallocations.remove(it);
+            } else {
+                window_is_stale = true;
             }
-            blocks.unchecked_append(block_index);
-            dbgln_if(EXT2_DEBUG, "  allocated > {}", block_index);
         }
     }
+    if (window_is_stale) {
+        if (auto result = discard_preallocation(inode_index); result.is_error())
+            return result;
+    }
+
+    auto needed = count - blocks.size();
+    if (needed == 0)
+        return blocks;
+
+    // Windows are only a hint, give them all back before failing an allocation.
+    size_t free_blocks = unreserved_free_block_count();
+    if (needed > free_blocks) {
+        if (auto result = discard_all_preallocations(); result.is_error())
+            return result;
+        free_blocks = unreserved_free_block_count();
+        if (needed > free_blocks)
+            return ENOSPC;
+    }
+
+    auto extra = min(preallocation_count, free_blocks - needed);
+    auto new_blocks_or_error = allocate_blocks(group_index_from_inode(inode_index), needed + extra, goal);
+    // Someone else may have taken the blocks we wanted for the window in the meantime.
+    if (new_blocks_or_error.is_error() && new_blocks_or_error.error() == ENOSPC && extra)
+        new_blocks_or_error = allocate_blocks(group_index_from_inode(inode_index), needed, goal);
+    if (new_blocks_or_error.is_error())
+        return new_blocks_or_error.error();
+    auto new_blocks = new_blocks_or_error.release_value();
+
+    for (size_t i = 0; i < needed; ++i)
+        blocks.unchecked_append(new_blocks[i]);
+
+    // Keep whatever directly follows the last handed out block as the new window, and give back the rest.
+    size_t window = 0;
+    while (needed + window < new_blocks.size() && new_blocks[needed + window].value() == blocks.last().value() + 1 + window)
+        ++window;
+    for (size_t i = needed + window; i < new_blocks.size(); ++i) {
+        if (auto result = set_block_allocation_state(new_blocks[i], false); result.is_error())
+            return result;
+    }
+    if (window) {
+        MutexLocker preallocation_locker(m_preallocation_lock);
+        m_preallocations.set(inode_index, { blocks.last().value() + 1, window });
+        m_preallocated_block_count += window;
+    }
 
-    VERIFY(blocks.size() == count);
     return blocks;
 }
 
+KResult Ext2FS::discard_preallocation(InodeIndex inode_index)
+{
+    Preallocation preallocation;
+    {
+        MutexLocker locker(m_preallocation_lock);
+        auto it = m_preallocations.find(inode_index);
+        if (it == m_preallocations.end())
+            return KSuccess;
+        preallocation = it->value;
+        m_preallocations.remove(it);
+        m_preallocated_block_count -= preallocation.count;
+    }
+
+    dbgln_if(EXT2_DEBUG, "Ext2FS: Discarding {} preallocated block(s) starting at {} for inode {}", preallocation.count, preallocation.first_block, inode_index);
+    for (size_t i = 0; i < preallocation.count; ++i) {
+        if (auto result = set_block_allocation_state(preallocation.first_block.value() + i, false); result.is_error())
+            return result;
+    }
+    return KSuccess;
+}
+
+KResult Ext2FS::discard_all_preallocations()
+{
+    for (;;) {
+        InodeIndex inode_index;
+        {
+            MutexLocker locker(m_preallocation_lock);
+            if (m_preallocations.is_empty())
+                return KSuccess;
+            inode_index = m_preallocations.begin()->key;
+        }
+        if (auto result = discard_preallocation(inode_index); result.is_error())
+            return result;
+    }
+}
+
 KResultOr<InodeIndex> Ext2FS::allocate_inode(GroupIndex preferred_group)
 {
     dbgln_if(EXT2_DEBUG, "Ext2FS: allocate_inode(preferred_group: {})", preferred_group);
-    MutexLocker locker(m_lock);
 
     // FIXME: We shouldn't refuse to allocate an inode if there is no group that can house the whole thing.
     //        In those cases we should just spread it across multiple groups.
@@ -1367,62 +2448,74 @@ KResultOr<InodeIndex> Ext2FS::allocate_inode(GroupIndex preferred_group)
         return bgd.bg_free_inodes_count && bgd.bg_free_blocks_count >= 1;
     };
 
-    GroupIndex group_index;
-    if (preferred_group.value() && is_suitable_group(preferred_group)) {
-        group_index = preferred_group;
-    } else {
-        for (unsigned i = 1; i <= m_block_group_count; ++i) {
-            if (is_suitable_group(i)) {
-                group_index = i;
-                break;
-            }
-        }
-    }
-
-    if (!group_index) {
-        dmesgln("Ext2FS: allocate_inode: no suitable group found for new inode");
-        return ENOSPC;
-    }
+    // The counts are only a hint until we hold the group's lock, so check again once we do.
+    auto try_allocate_in_group = [&](GroupIndex group_index) -> KResultOr<InodeIndex> {
+        auto& group = block_group(group_index);
+        MutexLocker group_locker(group.lock);
+        if (!is_suitable_group(group_index))
+            return InodeIndex { 0 };
 
-    dbgln_if(EXT2_DEBUG, "Ext2FS: allocate_inode: found suitable group [{}] for new inode :^)", group_index);
+        dbgln_if(EXT2_DEBUG, "Ext2FS: allocate_inode: found suitable group [{}] for new inode :^)", group_index);
 
-    auto& bgd = group_descriptor(group_index);
-    unsigned inodes_in_group = min(inodes_per_group(), super_block().s_inodes_count);
-    InodeIndex first_inode_in_group = (group_index.value() - 1) * inodes_per_group() + 1;
+        auto& bgd = group_descriptor(group_index);
+        unsigned inodes_in_group = min(inodes_per_group(), super_block().s_inodes_count);
+        InodeIndex first_inode_in_group = (group_index.value() - 1) * inodes_per_group() + 1;
 
-    auto cached_bitmap_or_error = get_bitmap_block(bgd.bg_inode_bitmap);
-    if (cached_bitmap_or_error.is_error())
-        return cached_bitmap_or_error.error();
-    auto& cached_bitmap = *cached_bitmap_or_error.value();
-    auto inode_bitmap = cached_bitmap.bitmap(inodes_in_group);
-    for (size_t i = 0; i < inode_bitmap.size(); ++i) {
-        if (inode_bitmap.get(i))
-            continue;
-        inode_bitmap.set(i, true);
+        auto cached_bitmap_or_error = get_bitmap_block(group.inode_bitmap, bgd.bg_inode_bitmap);
+        if (cached_bitmap_or_error.is_error())
+            return cached_bitmap_or_error.error();
+        auto& cached_bitmap = *cached_bitmap_or_error.value();
+        auto inode_bitmap = cached_bitmap.bitmap(inodes_in_group);
+        for (size_t i = 0; i < inode_bitmap.size(); ++i) {
+            if (inode_bitmap.get(i))
+                continue;
+            if (!update_super_block_counter(m_super_block.s_free_inodes_count, -1))
+                return ENOSPC;
+            inode_bitmap.set(i, true);
+            cached_bitmap.dirty = true;
+            const_cast<ext2_group_desc&>(bgd).bg_free_inodes_count--;
+            m_block_group_descriptors_dirty = true;
+            return InodeIndex(first_inode_in_group.value() + i);
+        }
 
-        auto inode_index = InodeIndex(first_inode_in_group.value() + i);
+        dmesgln("Ext2FS: allocate_inode found no available inode, despite bgd claiming there are inodes :(");
+        return EIO;
+    };
 
-        cached_bitmap.dirty = true;
-        m_super_block.s_free_inodes_count--;
-        m_super_block_dirty = true;
-        const_cast<ext2_group_desc&>(bgd).bg_free_inodes_count--;
-        m_block_group_descriptors_dirty = true;
+    auto allocate = [&]() -> KResultOr<InodeIndex> {
+        if (preferred_group.value()) {
+            auto inode_index_or_error = try_allocate_in_group(preferred_group);
+            if (inode_index_or_error.is_error() || inode_index_or_error.value() != 0)
+                return inode_index_or_error;
+        }
+        for (unsigned i = 1; i <= m_block_group_count; ++i) {
+            if (i == preferred_group.value() || !is_suitable_group(i))
+                continue;
+            auto inode_index_or_error = try_allocate_in_group(i);
+            if (inode_index_or_error.is_error() || inode_index_or_error.value() != 0)
+                return inode_index_or_error;
+        }
+        dmesgln("Ext2FS: allocate_inode: no suitable group found for new inode");
+        return ENOSPC;
+    };
 
-        // In case the inode cache had this cached as "non-existent", uncache that info.
-        m_inode_cache.remove(inode_index.value());
+    auto inode_index_or_error = allocate();
+    if (inode_index_or_error.is_error())
+        return inode_index_or_error.error();
+    auto inode_index = inode_index_or_error.value();
 
-        return inode_index;
-    }
+    // In case the inode cache had this cached as "non-existent", uncache that info.
+    // NOTE: This must happen after letting go of the group's lock, see InodeCacheShard.
+    uncache_inode(inode_index);
 
-    dmesgln("Ext2FS: allocate_inode found no available inode, despite bgd claiming there are inodes :(");
-    return EIO;
+    return inode_index;
 }
 
 Ext2FS::GroupIndex Ext2FS::group_index_from_block_index(BlockIndex block_index) const
 {
     if (!block_index)
         return 0;
-    return (block_index.value() - 1) / blocks_per_group() + 1;
+    return (block_index.value() - first_block_index().value()) / blocks_per_group() + 1;
 }
 
 auto Ext2FS::group_index_from_inode(InodeIndex inode) const -> GroupIndex
@@ -1434,57 +2527,56 @@ auto Ext2FS::group_index_from_inode(InodeIndex inode) const -> GroupIndex
 
 KResultOr<bool> Ext2FS::get_inode_allocation_state(InodeIndex index) const
 {
-    MutexLocker locker(m_lock);
     if (index == 0)
         return EINVAL;
     auto group_index = group_index_from_inode(index);
+    auto& group = block_group(group_index);
+    MutexLocker group_locker(group.lock);
     auto& bgd = group_descriptor(group_index);
     unsigned index_in_group = index.value() - ((group_index.value() - 1) * inodes_per_group());
     unsigned bit_index = (index_in_group - 1) % inodes_per_group();
 
-    auto cached_bitmap_or_error = const_cast<Ext2FS&>(*this).get_bitmap_block(bgd.bg_inode_bitmap);
+    auto cached_bitmap_or_error = const_cast<Ext2FS&>(*this).get_bitmap_block(group.inode_bitmap, bgd.bg_inode_bitmap);
     if (cached_bitmap_or_error.is_error())
         return cached_bitmap_or_error.error();
     return cached_bitmap_or_error.value()->bitmap(inodes_per_group()).get(bit_index);
 }
 
-KResult Ext2FS::update_bitmap_block(BlockIndex bitmap_block, size_t bit_index, bool new_state, u32& super_block_counter, u16& group_descriptor_counter)
+KResult Ext2FS::update_bitmap_block(CachedBitmap& cached_bitmap, size_t bit_index, bool new_state, u32& super_block_counter, u16& group_descriptor_counter)
 {
-    auto cached_bitmap_or_error = get_bitmap_block(bitmap_block);
-    if (cached_bitmap_or_error.is_error())
-        return cached_bitmap_or_error.error();
-    auto& cached_bitmap = *cached_bitmap_or_error.value();
     bool current_state = cached_bitmap.bitmap(blocks_per_group()).get(bit_index);
     if (current_state == new_state) {
-        dbgln("Ext2FS: Bit {} in bitmap block {} had unexpected state {}", bit_index, bitmap_block, current_state);
+        dbgln("Ext2FS: Bit {} in bitmap block {} had unexpected state {}", bit_index, cached_bitmap.bitmap_block_index, current_state);
         return EIO;
     }
+    if (!update_super_block_counter(super_block_counter, new_state ? -1 : 1))
+        return EIO;
     cached_bitmap.bitmap(blocks_per_group()).set(bit_index, new_state);
     cached_bitmap.dirty = true;
 
-    if (new_state) {
-        --super_block_counter;
+    if (new_state)
         --group_descriptor_counter;
-    } else {
-        ++super_block_counter;
+    else
         ++group_descriptor_counter;
-    }
 
-    m_super_block_dirty = true;
     m_block_group_descriptors_dirty = true;
     return KSuccess;
 }
 
 KResult Ext2FS::set_inode_allocation_state(InodeIndex inode_index, bool new_state)
 {
-    MutexLocker locker(m_lock);
     auto group_index = group_index_from_inode(inode_index);
     unsigned index_in_group = inode_index.value() - ((group_index.value() - 1) * inodes_per_group());
     unsigned bit_index = (index_in_group - 1) % inodes_per_group();
 
     dbgln_if(EXT2_DEBUG, "Ext2FS: set_inode_allocation_state: Inode {} -> {}", inode_index, new_state);
+    auto& group = block_group(group_index);
+    MutexLocker group_locker(group.lock);
     auto& bgd = const_cast<ext2_group_desc&>(group_descriptor(group_index));
-    return update_bitmap_block(bgd.bg_inode_bitmap, bit_index, new_state, m_super_block.s_free_inodes_count, bgd.bg_free_inodes_count);
+    auto cached_bitmap_or_error = get_bitmap_block(group.inode_bitmap, bgd.bg_inode_bitmap);
+    if (cached_bitmap_or_error.is_error())
+        return cached_bitmap_or_error.error();
+    return update_bitmap_block(*cached_bitmap_or_error.value(), bit_index, new_state, m_super_block.s_free_inodes_count, bgd.bg_free_inodes_count);
 }
 
 Ext2FS::BlockIndex Ext2FS::first_block_index() const
@@ -1492,12 +2584,10 @@ Ext2FS::BlockIndex Ext2FS::first_block_index() const
     return block_size() == 1024 ? 1 : 0;
 }
 
-KResultOr<Ext2FS::CachedBitmap*> Ext2FS::get_bitmap_block(BlockIndex bitmap_block_index)
+KResultOr<Ext2FS::CachedBitmap*> Ext2FS::get_bitmap_block(OwnPtr<CachedBitmap>& cached_bitmap, BlockIndex bitmap_block_index)
 {
-    for (auto& cached_bitmap : m_cached_bitmaps) {
-        if (cached_bitmap->bitmap_block_index == bitmap_block_index)
-            return cached_bitmap;
-    }
+    if (cached_bitmap)
+        return cached_bitmap.ptr();
 
     auto block = KBuffer::create_with_size(block_size(), Region::Access::Read | Region::Access::Write, "Ext2FS: Cached bitmap block");
     auto buffer = UserOrKernelBuffer::for_kernel_buffer(block.data());
@@ -1508,29 +2598,32 @@ KResultOr<Ext2FS::CachedBitmap*> Ext2FS::get_bitmap_block(BlockIndex bitmap_bloc
     auto new_bitmap = adopt_own_if_nonnull(new (nothrow) CachedBitmap(bitmap_block_index, move(block)));
     if (!new_bitmap)
         return ENOMEM;
-    if (!m_cached_bitmaps.try_append(move(new_bitmap)))
-        return ENOMEM;
-    return m_cached_bitmaps.last();
+    cached_bitmap = move(new_bitmap);
+    return cached_bitmap.ptr();
 }
 
 KResult Ext2FS::set_block_allocation_state(BlockIndex block_index, bool new_state)
 {
     VERIFY(block_index != 0);
-    MutexLocker locker(m_lock);
 
     auto group_index = group_index_from_block_index(block_index);
     unsigned index_in_group = (block_index.value() - first_block_index().value()) - ((group_index.value() - 1) * blocks_per_group());
     unsigned bit_index = index_in_group % blocks_per_group();
+    auto& group = block_group(group_index);
+    MutexLocker group_locker(group.lock);
     auto& bgd = const_cast<ext2_group_desc&>(group_descriptor(group_index));
 
     dbgln_if(EXT2_DEBUG, "Ext2FS: Block {} state -> {} (in bitmap block {})", block_index, new_state, bgd.bg_block_bitmap);
-    return update_bitmap_block(bgd.bg_block_bitmap, bit_index, new_state, m_super_block.s_free_blocks_count, bgd.bg_free_blocks_count);
+    auto cached_bitmap_or_error = get_bitmap_block(group.block_bitmap, bgd.bg_block_bitmap);
+    if (cached_bitmap_or_error.is_error())
+        return cached_bitmap_or_error.error();
+    return update_bitmap_block(*cached_bitmap_or_error.value(), bit_index, new_state, m_super_block.s_free_blocks_count, bgd.bg_free_blocks_count);
 }
 
 KResult Ext2FS::create_directory(Ext2FSInode& parent_inode, const String& name, mode_t mode, uid_t uid, gid_t gid)
 {
-    MutexLocker locker(m_lock);
     VERIFY(is_directory(mode));
+    Ext2FSJournalHandle journal_handle(m_journal.ptr());
 
     auto inode_or_error = create_inode(parent_inode, name, mode, 0, uid, gid);
     if (inode_or_error.is_error())
@@ -1550,7 +2643,9 @@ KResult Ext2FS::create_directory(Ext2FSInode& parent_inode, const String& name,
     if (auto result = parent_inode.increment_link_count(); result.is_error())
         return result;
 
-    auto& bgd = const_cast<ext2_group_desc&>(group_descriptor(group_index_from_inode(inode->identifier().index())));
+    auto group_index = group_index_from_inode(inode->identifier().index());
+    MutexLocker group_locker(block_group(group_index).lock);
+    auto& bgd = const_cast<ext2_group_desc&>(group_descriptor(group_index));
     ++bgd.bg_used_dirs_count;
     m_block_group_descriptors_dirty = true;
 
@@ -1565,6 +2660,7 @@ KResultOr<NonnullRefPtr<Inode>> Ext2FS::create_inode(Ext2FSInode& parent_inode,
     if (parent_inode.m_raw_inode.i_links_count == 0)
         return ENOENT;
 
+    Ext2FSJournalHandle journal_handle(m_journal.ptr());
     ext2_inode e2inode {};
     auto now = kgettimeofday().to_truncated_seconds();
     e2inode.i_mode = mode;
@@ -1626,6 +2722,25 @@ RefPtr<Inode> Ext2FSInode::lookup(StringView name)
 {
     VERIFY(is_directory());
     dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]:lookup(): Looking up '{}'", identifier(), name);
+
+    if (is_indexed_directory()) {
+        Optional<InodeIndex> inode_index;
+        {
+            MutexLocker locker(m_inode_lock);
+            if (m_lookup_cache.is_empty()) {
+                Ext2FSDirectoryIndexPath path;
+                ByteBuffer leaf;
+                auto inode_index_or_error = find_in_directory_index(name, path, leaf);
+                if (!inode_index_or_error.is_error())
+                    inode_index = inode_index_or_error.value();
+                else if (inode_index_or_error.error() == -ENOENT)
+                    return {};
+            }
+        }
+        if (inode_index.has_value())
+            return fs().get_inode({ fsid(), inode_index.value() });
+    }
+
     if (populate_lookup_cache().is_error())
         return {};
 
@@ -1710,8 +2825,14 @@ KResult Ext2FSInode::decrement_link_count()
 
 void Ext2FS::uncache_inode(InodeIndex index)
 {
-    MutexLocker locker(m_lock);
-    m_inode_cache.remove(index);
+    // Declared before the locker, so that the inode only dies once the shard is unlocked again.
+    RefPtr<Ext2FSInode> inode;
+    auto& shard = inode_cache_shard(index);
+    MutexLocker locker(shard.lock);
+    if (auto it = shard.inodes.find(index); it != shard.inodes.end()) {
+        inode = move(it->value);
+        shard.inodes.remove(it);
+    }
 }
 
 KResult Ext2FSInode::chmod(mode_t mode)
@@ -1737,6 +2858,7 @@ KResult Ext2FSInode::chown(uid_t uid, gid_t gid)
 
 KResult Ext2FSInode::truncate(u64 size)
 {
+    Ext2FSJournalHandle journal_handle(fs().m_journal.ptr());
     MutexLocker locker(m_inode_lock);
     if (static_cast<u64>(m_raw_inode.i_size) == size)
         return KSuccess;
@@ -1761,25 +2883,28 @@ KResultOr<int> Ext2FSInode::get_block_address(int index)
 
 unsigned Ext2FS::total_block_count() const
 {
-    MutexLocker locker(m_lock);
     return super_block().s_blocks_count;
 }
 
 unsigned Ext2FS::free_block_count() const
 {
-    MutexLocker locker(m_lock);
+    return unreserved_free_block_count() + m_preallocated_block_count;
+}
+
+size_t Ext2FS::unreserved_free_block_count() const
+{
+    ScopedSpinLock locker(m_super_block_lock);
     return super_block().s_free_blocks_count;
 }
 
 unsigned Ext2FS::total_inode_count() const
 {
-    MutexLocker locker(m_lock);
     return super_block().s_inodes_count;
 }
 
 unsigned Ext2FS::free_inode_count() const
 {
-    MutexLocker locker(m_lock);
+    ScopedSpinLock locker(m_super_block_lock);
     return super_block().s_free_inodes_count;
 }
 
@@ -1787,12 +2912,38 @@ KResult Ext2FS::prepare_to_unmount()
 {
     MutexLocker locker(m_lock);
 
-    for (auto& it : m_inode_cache) {
-        if (it.value->ref_count() > 1)
-            return EBUSY;
+    for (auto& shard : m_inode_cache) {
+        MutexLocker shard_locker(shard.lock);
+        for (auto& it : shard.inodes) {
+            if (it.value && it.value->ref_count() > 1)
+                return EBUSY;
+        }
+    }
+
+    if (auto result = discard_all_preallocations(); result.is_error())
+        return result;
+
+    if (m_journal) {
+        // Committing waits for the running operations and other commits, which may need our lock to get anywhere.
+        locker.unlock();
+        flush_metadata_to_cache();
+        auto result = m_journal->shut_down();
+        locker.lock();
+        if (result.is_error())
+            return result;
+        m_journal = nullptr;
+        // The log is empty, so there's nothing left to recover.
+        {
+            ScopedSpinLock super_block_locker(m_super_block_lock);
+            m_super_block.s_feature_incompat &= ~EXT3_FEATURE_INCOMPAT_RECOVER;
+        }
+        flush_super_block();
     }
 
-    m_inode_cache.clear();
+    for (auto& shard : m_inode_cache) {
+        MutexLocker shard_locker(shard.lock);
+        shard.inodes.clear();
+    }
     m_root_inode = nullptr;
     return KSuccess;
 }
@@ -6,12 +6,16 @@
 
 #pragma once
 
+#include <AK/Array.h>
+#include <AK/Atomic.h>
 #include <AK/BitmapView.h>
 #include <AK/HashMap.h>
+#include <AK/NonnullOwnPtrVector.h>
 #include <Kernel/FileSystem/BlockBasedFileSystem.h>
 #include <Kernel/FileSystem/Inode.h>
 #include <Kernel/FileSystem/ext2_fs.h>
 #include <Kernel/KBuffer.h>
+#include <Kernel/SpinLock.h>
 #include <Kernel/UnixTypes.h>
 
 struct ext2_group_desc;
@@ -21,7 +25,10 @@ struct ext2_super_block;
 namespace Kernel {
 
 class Ext2FS;
+class Ext2FSJournal;
 struct Ext2FSDirectoryEntry;
+struct Ext2FSDirectoryIndexFrame;
+struct Ext2FSDirectoryIndexPath;
 
 class Ext2FSInode final : public Inode {
     friend class Ext2FS;
@@ -32,6 +39,7 @@ public:
     u64 size() const;
     bool is_symlink() const { return Kernel::is_symlink(m_raw_inode.i_mode); }
     bool is_directory() const { return Kernel::is_directory(m_raw_inode.i_mode); }
+    bool is_indexed_directory() const { return is_directory() && (m_raw_inode.i_flags & EXT2_INDEX_FL); }
 
     // ^Inode (RefCounted magic)
     virtual void one_ref_left() override;
@@ -39,6 +47,7 @@ public:
 private:
     // ^Inode
     virtual KResultOr<size_t> read_bytes(off_t, size_t, UserOrKernelBuffer& buffer, FileDescription*) const override;
+    virtual KResultOr<size_t> read_bytes_for_page_cache(off_t, size_t, UserOrKernelBuffer& buffer) const override;
     virtual InodeMetadata metadata() const override;
     virtual KResult traverse_as_directory(Function<bool(FileSystem::DirectoryEntryView const&)>) const override;
     virtual RefPtr<Inode> lookup(StringView name) override;
@@ -57,9 +66,22 @@ private:
     virtual KResult truncate(u64) override;
     virtual KResultOr<int> get_block_address(int) override;
 
+    KResultOr<size_t> read_bytes_impl(off_t, size_t, UserOrKernelBuffer& buffer, bool allow_cache) const;
     KResult write_directory(Vector<Ext2FSDirectoryEntry>&);
+    KResult write_linear_directory(Vector<Ext2FSDirectoryEntry>&);
+    KResult write_indexed_directory(Vector<Ext2FSDirectoryEntry>&);
+    KResult read_directory_block(u64 block_index, ByteBuffer&) const;
+    KResult write_directory_block(u64 block_index, ByteBuffer const&);
+    u8 directory_index_hash_version(u8) const;
+    KResult read_directory_index_node(u64 block_index, Ext2FSDirectoryIndexFrame&) const;
+    KResult probe_directory_index(StringView name, Ext2FSDirectoryIndexPath&) const;
+    KResultOr<bool> advance_directory_index(Ext2FSDirectoryIndexPath&) const;
+    KResultOr<InodeIndex> find_in_directory_index(StringView name, Ext2FSDirectoryIndexPath&, ByteBuffer& leaf) const;
+    KResult add_child_to_directory_index(Ext2FSDirectoryIndexPath&, ByteBuffer& leaf, StringView name, InodeIndex, u8 file_type);
+    KResult remove_child_from_directory_index(StringView name, InodeIndex, Ext2FSDirectoryIndexPath&, ByteBuffer& leaf);
     KResult populate_lookup_cache() const;
     KResult resize(u64);
+    KResultOr<size_t> write_bytes_in_one_transaction(off_t, size_t, const UserOrKernelBuffer& data, FileDescription*);
     KResult write_indirect_block(BlockBasedFileSystem::BlockIndex, Span<BlockBasedFileSystem::BlockIndex>);
     KResult grow_doubly_indirect_block(BlockBasedFileSystem::BlockIndex, size_t, Span<BlockBasedFileSystem::BlockIndex>, Vector<BlockBasedFileSystem::BlockIndex>&, unsigned&);
     KResult shrink_doubly_indirect_block(BlockBasedFileSystem::BlockIndex, size_t, size_t, unsigned&);
@@ -82,6 +104,7 @@ private:
 
 class Ext2FS final : public BlockBasedFileSystem {
     friend class Ext2FSInode;
+    friend class Ext2FSJournal;
 
 public:
     enum class FeaturesReadOnly : u32 {
@@ -113,6 +136,7 @@ private:
     explicit Ext2FS(FileDescription&);
 
     const ext2_super_block& super_block() const { return m_super_block; }
+    bool has_directory_index_feature() const { return m_super_block.s_rev_level > 0 && (m_super_block.s_feature_compat & EXT2_FEATURE_COMPAT_DIR_INDEX); }
     const ext2_group_desc& group_descriptor(GroupIndex) const;
     ext2_group_desc* block_group_descriptors() { return (ext2_group_desc*)m_cached_group_descriptor_table->data(); }
     const ext2_group_desc* block_group_descriptors() const { return (const ext2_group_desc*)m_cached_group_descriptor_table->data(); }
@@ -127,16 +151,29 @@ private:
 
     bool flush_super_block();
 
+    KResult initialize_journal();
+    // Metadata goes through the journal if there is one.
+    KResult write_metadata_block(BlockIndex, const UserOrKernelBuffer&, size_t count, size_t offset = 0);
+    KResult write_metadata_blocks(BlockIndex, unsigned count, const UserOrKernelBuffer&);
+
     virtual StringView class_name() const override { return "Ext2FS"sv; }
     virtual Ext2FSInode& root_inode() override;
     RefPtr<Inode> get_inode(InodeIdentifier) const;
     KResultOr<NonnullRefPtr<Inode>> create_inode(Ext2FSInode& parent_inode, const String& name, mode_t, dev_t, uid_t, gid_t);
     KResult create_directory(Ext2FSInode& parent_inode, const String& name, mode_t, uid_t, gid_t);
     virtual void flush_writes() override;
+    virtual void flush_old_writes() override;
+    void flush_metadata_to_cache();
+    // Writes the super block, group descriptors and bitmaps, which are only updated in memory as we go.
+    void write_dirty_metadata();
+    void flush_dirty_inodes();
 
     BlockIndex first_block_index() const;
     KResultOr<InodeIndex> allocate_inode(GroupIndex preferred_group = 0);
-    KResultOr<Vector<BlockIndex>> allocate_blocks(GroupIndex preferred_group_index, size_t count);
+    KResultOr<Vector<BlockIndex>> allocate_blocks(GroupIndex preferred_group_index, size_t count, BlockIndex goal = 0);
+    KResultOr<Vector<BlockIndex>> allocate_blocks_for_inode(InodeIndex, size_t count, BlockIndex goal, size_t preallocation_count);
+    KResult discard_preallocation(InodeIndex);
+    KResult discard_all_preallocations();
     GroupIndex group_index_from_inode(InodeIndex) const;
     GroupIndex group_index_from_block_index(BlockIndex) const;
 
@@ -159,13 +196,27 @@ private:
 
     u64 m_block_group_count { 0 };
 
+    // Guards the super block's free counts and m_super_block_dirty.
+    mutable SpinLock<u8> m_super_block_lock;
     mutable ext2_super_block m_super_block;
     mutable OwnPtr<KBuffer> m_cached_group_descriptor_table;
 
-    mutable HashMap<InodeIndex, RefPtr<Ext2FSInode>> m_inode_cache;
+    bool update_super_block_counter(u32& counter, ssize_t delta);
+    // Free blocks that aren't held back in a preallocation window.
+    size_t unreserved_free_block_count() const;
+
+    // Lookups of inodes in different shards never contend with each other.
+    // A shard's lock may be held while taking a block group's lock, but never the other way around.
+    static constexpr size_t inode_cache_shard_count = 16;
+    struct InodeCacheShard {
+        Mutex lock { "Ext2FS::InodeCacheShard" };
+        HashMap<InodeIndex, RefPtr<Ext2FSInode>> inodes;
+    };
+    InodeCacheShard& inode_cache_shard(InodeIndex index) const { return m_inode_cache[index.value() % inode_cache_shard_count]; }
+    mutable Array<InodeCacheShard, inode_cache_shard_count> m_inode_cache;
 
     bool m_super_block_dirty { false };
-    bool m_block_group_descriptors_dirty { false };
+    Atomic<bool> m_block_group_descriptors_dirty { false };
 
     struct CachedBitmap {
         CachedBitmap(BlockIndex bi, KBuffer&& buf)
@@ -179,11 +230,32 @@ private:
         BitmapView bitmap(u32 blocks_per_group) { return BitmapView { buffer.data(), blocks_per_group }; }
     };
 
-    KResultOr<CachedBitmap*> get_bitmap_block(BlockIndex);
-    KResult update_bitmap_block(BlockIndex bitmap_block, size_t bit_index, bool new_state, u32& super_block_counter, u16& group_descriptor_counter);
+    // A block group's bitmaps and descriptor are only touched with its lock held,
+    // so that allocations in different groups can proceed in parallel.
+    struct BlockGroup {
+        Mutex lock { "Ext2FS::BlockGroup" };
+        OwnPtr<CachedBitmap> block_bitmap;
+        OwnPtr<CachedBitmap> inode_bitmap;
+    };
+    BlockGroup& block_group(GroupIndex) const;
 
-    Vector<OwnPtr<CachedBitmap>> m_cached_bitmaps;
+    KResultOr<CachedBitmap*> get_bitmap_block(OwnPtr<CachedBitmap>&, BlockIndex);
+    KResult update_bitmap_block(CachedBitmap&, size_t bit_index, bool new_state, u32& super_block_counter, u16& group_descriptor_counter);
+    KResult allocate_block_run(GroupIndex, CachedBitmap&, size_t first_bit_index, size_t count, Vector<BlockIndex>&);
+
+    mutable NonnullOwnPtrVector<BlockGroup> m_block_groups;
+
+    // Blocks that are marked as allocated, but are only reserved for an inode's next appends.
+    struct Preallocation {
+        BlockIndex first_block;
+        size_t count { 0 };
+    };
+    // Only held while looking at the windows, never while (de)allocating their blocks.
+    Mutex m_preallocation_lock { "Ext2FS::Preallocations" };
+    HashMap<InodeIndex, Preallocation> m_preallocations;
+    Atomic<size_t> m_preallocated_block_count { 0 };
     RefPtr<Ext2FSInode> m_root_inode;
+    OwnPtr<Ext2FSJournal> m_journal;
 };
 
 inline Ext2FS& Ext2FSInode::fs()
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/IntrusiveList.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/RefCounted.h>
 #include <AK/String.h>
@@ -23,6 +24,20 @@ class File;
 
 class FileBlockCondition : public Thread::BlockCondition {
 public:
+    // Gets told about every change of the file's state, without blocking on it.
+    // This is how an EPoll finds out which of its files may have become ready.
+    class Watcher {
+    public:
+        virtual ~Watcher() = default;
+
+        // Called with the watcher lock held, so this must not add or remove watchers.
+        virtual void file_state_changed() = 0;
+
+    private:
+        friend class FileBlockCondition;
+        IntrusiveListNode<Watcher> m_watcher_list_node;
+    };
+
     FileBlockCondition() { }
 
     virtual bool should_add_blocker(Thread::Blocker& b, void* data) override
@@ -40,7 +55,29 @@ public:
             auto& blocker = static_cast<Thread::FileBlocker&>(b);
             return blocker.unblock(false, data);
         });
+        lock.unlock();
+
+        ScopedSpinLock watchers_lock(m_watchers_lock);
+        for (auto& watcher : m_watchers)
+            watcher.file_state_changed();
+    }
+
+    void add_watcher(Watcher& watcher)
+    {
+        ScopedSpinLock lock(m_watchers_lock);
+        m_watchers.append(watcher);
+    }
+
+    // Once this returns, the watcher won't be called anymore.
+    void remove_watcher(Watcher& watcher)
+    {
+        ScopedSpinLock lock(m_watchers_lock);
+        m_watchers.remove(watcher);
     }
+
+private:
+    SpinLock<u8> m_watchers_lock;
+    IntrusiveList<Watcher, RawPtr<Watcher>, &Watcher::m_watcher_list_node> m_watchers;
 };
 
 // File is the base class for anything that can be referenced by a FileDescription.
@@ -110,6 +147,7 @@ public:
     virtual bool is_character_device() const { return false; }
     virtual bool is_socket() const { return false; }
     virtual bool is_inode_watcher() const { return false; }
+    virtual bool is_epoll() const { return false; }
 
     virtual FileBlockCondition& block_condition() { return m_block_condition; }
 
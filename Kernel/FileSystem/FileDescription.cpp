@@ -9,6 +9,7 @@
 #include <Kernel/Debug.h>
 #include <Kernel/Devices/BlockDevice.h>
 #include <Kernel/FileSystem/Custody.h>
+#include <Kernel/FileSystem/EPoll.h>
 #include <Kernel/FileSystem/FIFO.h>
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/FileSystem/FileSystem.h>
@@ -20,10 +21,13 @@
 #include <Kernel/TTY/TTY.h>
 #include <Kernel/UnixTypes.h>
 #include <Kernel/VM/MemoryManager.h>
+#include <Kernel/VM/PageCache.h>
 #include <LibC/errno_numbers.h>
 
 namespace Kernel {
 
+DEFINE_SLAB_CACHE(FileDescription);
+
 KResultOr<NonnullRefPtr<FileDescription>> FileDescription::create(Custody& custody)
 {
     auto inode_file = InodeFile::create(custody.inode());
@@ -220,7 +224,23 @@ KResultOr<NonnullOwnPtr<KBuffer>> FileDescription::read_entire_file()
     return m_inode->read_entire(this);
 }
 
-KResultOr<size_t> FileDescription::get_dir_entries(UserOrKernelBuffer& output_buffer, size_t size)
+RefPtr<Inode> FileDescription::resolve_directory_entry_for_stat(StringView name)
+{
+    RefPtr<Inode> inode;
+    if (name == ".")
+        inode = m_inode;
+    else if (name == ".." && m_custody) // Go by the path we were opened with, like stat("dir/..") would.
+        inode = m_custody->parent() ? m_custody->parent()->inode() : *m_inode;
+    else
+        inode = m_inode->lookup(name);
+    if (!inode)
+        return {};
+    if (auto mount = VirtualFileSystem::the().find_mount_for_host(inode->identifier()))
+        return mount->guest();
+    return inode;
+}
+
+KResultOr<size_t> FileDescription::get_dir_entries(UserOrKernelBuffer& output_buffer, size_t size, IncludeStat include_stat)
 {
     MutexLocker locker(m_lock, Mutex::Mode::Shared);
     if (!is_directory())
@@ -254,8 +274,10 @@ KResultOr<size_t> FileDescription::get_dir_entries(UserOrKernelBuffer& output_bu
         return true;
     };
 
-    KResult result = VirtualFileSystem::the().traverse_directory_inode(*m_inode, [&flush_stream_to_output_buffer, &stream, this](auto& entry) {
+    auto serialize_entry = [&flush_stream_to_output_buffer, &stream, this](FileSystem::DirectoryEntryView const& entry, struct stat const* entry_stat) {
         size_t serialized_size = sizeof(ino_t) + sizeof(u8) + sizeof(size_t) + sizeof(char) * entry.name.length();
+        if (entry_stat)
+            serialized_size += sizeof(struct stat);
         if (serialized_size > stream.remaining()) {
             if (!flush_stream_to_output_buffer()) {
                 return false;
@@ -265,8 +287,45 @@ KResultOr<size_t> FileDescription::get_dir_entries(UserOrKernelBuffer& output_bu
         stream << m_inode->fs().internal_file_type_to_directory_entry_type(entry);
         stream << (u32)entry.name.length();
         stream << entry.name.bytes();
+        if (entry_stat)
+            stream << ReadonlyBytes { entry_stat, sizeof(struct stat) };
         return true;
-    });
+    };
+
+    KResult result = KSuccess;
+    if (include_stat == IncludeStat::No) {
+        result = VirtualFileSystem::the().traverse_directory_inode(*m_inode, [&serialize_entry](auto& entry) {
+            return serialize_entry(entry, nullptr);
+        });
+    } else {
+        // Looking up the entries takes the directory's lock, so collect them before stat'ing them.
+        struct Entry {
+            NonnullOwnPtr<KString> name;
+            InodeIdentifier inode;
+            u8 file_type;
+        };
+        Vector<Entry> entries;
+        result = VirtualFileSystem::the().traverse_directory_inode(*m_inode, [&entries, &error](auto& entry) {
+            auto name = KString::try_create(entry.name);
+            if (!name || !entries.try_append({ name.release_nonnull(), entry.inode, entry.file_type })) {
+                error = ENOMEM;
+                return false;
+            }
+            return true;
+        });
+        // Like stat() by path, looking at the entries needs search permission on the directory. Without it, every
+        // entry gets a zeroed stat, so userspace tries for itself and gets the EACCES it would have gotten anyway.
+        bool may_search = metadata.may_execute(*Process::current());
+        for (size_t i = 0; !result.is_error() && !error && i < entries.size(); ++i) {
+            auto& entry = entries[i];
+            // An entry that went away in the meantime gets a zeroed stat, st_mode 0 tells userspace to look for itself.
+            struct stat entry_stat {};
+            if (auto inode = may_search ? resolve_directory_entry_for_stat(entry.name->view()) : nullptr)
+                (void)inode->metadata().stat(entry_stat);
+            if (!serialize_entry({ entry.name->view(), entry.inode, entry.file_type }, &entry_stat))
+                break;
+        }
+    }
     flush_stream_to_output_buffer();
 
     if (result.is_error()) {
@@ -340,6 +399,18 @@ InodeWatcher* FileDescription::inode_watcher()
     return static_cast<InodeWatcher*>(m_file.ptr());
 }
 
+bool FileDescription::is_epoll() const
+{
+    return m_file->is_epoll();
+}
+
+EPoll* FileDescription::epoll()
+{
+    if (!is_epoll())
+        return nullptr;
+    return static_cast<EPoll*>(m_file.ptr());
+}
+
 bool FileDescription::is_master_pty() const
 {
     return m_file->is_master_pty();
@@ -444,6 +515,41 @@ KResult FileDescription::chown(uid_t uid, gid_t gid)
     return m_file->chown(*this, uid, gid);
 }
 
+KResult FileDescription::advise(off_t offset, off_t length, int advice)
+{
+    MutexLocker locker(m_lock);
+    switch (advice) {
+    case POSIX_FADV_NORMAL:
+        m_readahead_state.advice = ReadaheadAdvice::Normal;
+        return KSuccess;
+    case POSIX_FADV_SEQUENTIAL:
+        m_readahead_state.advice = ReadaheadAdvice::Sequential;
+        return KSuccess;
+    case POSIX_FADV_RANDOM:
+        m_readahead_state.advice = ReadaheadAdvice::Random;
+        m_readahead_state.window_page_count = 0;
+        return KSuccess;
+    case POSIX_FADV_NOREUSE:
+        return KSuccess;
+    case POSIX_FADV_WILLNEED:
+    case POSIX_FADV_DONTNEED:
+        break;
+    default:
+        return EINVAL;
+    }
+
+    // Only regular files on disk go through the page cache, for anything else there's nothing to do.
+    if (!m_inode || !m_inode->metadata().is_regular_file() || !m_inode->fs().is_file_backed())
+        return KSuccess;
+    // A length of zero means "until the end of the file".
+    u64 count = length ? static_cast<u64>(length) : NumericLimits<u64>::max() - offset;
+    if (advice == POSIX_FADV_WILLNEED)
+        PageCache::the().read_ahead(*m_inode, offset, count);
+    else
+        PageCache::the().discard(*m_inode, offset, count);
+    return KSuccess;
+}
+
 FileBlockCondition& FileDescription::block_condition()
 {
     return m_file->block_condition();
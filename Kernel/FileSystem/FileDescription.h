@@ -12,7 +12,9 @@
 #include <Kernel/FileSystem/FIFO.h>
 #include <Kernel/FileSystem/Inode.h>
 #include <Kernel/FileSystem/InodeMetadata.h>
+#include <Kernel/FileSystem/ReadaheadState.h>
 #include <Kernel/FileSystem/VirtualFileSystem.h>
+#include <Kernel/Heap/SlabCache.h>
 #include <Kernel/KBuffer.h>
 #include <Kernel/VirtualAddress.h>
 
@@ -23,8 +25,10 @@ public:
     virtual ~FileDescriptionData() = default;
 };
 
-class FileDescription : public RefCounted<FileDescription> {
-    MAKE_SLAB_ALLOCATED(FileDescription)
+class FileDescription
+    : public RefCounted<FileDescription>
+    , public Weakable<FileDescription> {
+    MAKE_SLAB_CACHED(FileDescription)
 public:
     static KResultOr<NonnullRefPtr<FileDescription>> create(Custody&);
     static KResultOr<NonnullRefPtr<FileDescription>> create(File&);
@@ -60,7 +64,12 @@ public:
     bool can_read() const;
     bool can_write() const;
 
-    KResultOr<size_t> get_dir_entries(UserOrKernelBuffer& buffer, size_t);
+    enum class IncludeStat {
+        No,
+        Yes,
+    };
+    // With IncludeStat::Yes, each entry is followed by a struct stat for it, as if by lstat(), except that mount points are followed.
+    KResultOr<size_t> get_dir_entries(UserOrKernelBuffer& buffer, size_t, IncludeStat = IncludeStat::No);
 
     KResultOr<NonnullOwnPtr<KBuffer>> read_entire_file();
 
@@ -85,6 +94,9 @@ public:
     const InodeWatcher* inode_watcher() const;
     InodeWatcher* inode_watcher();
 
+    bool is_epoll() const;
+    EPoll* epoll();
+
     bool is_master_pty() const;
     const MasterPTY* master_pty() const;
     MasterPTY* master_pty();
@@ -125,6 +137,9 @@ public:
 
     KResult chown(uid_t, gid_t);
 
+    ReadaheadState& readahead_state() { return m_readahead_state; }
+    KResult advise(off_t offset, off_t length, int advice);
+
     FileBlockCondition& block_condition();
 
     KResult apply_flock(Process const&, Userspace<flock const*>);
@@ -135,6 +150,7 @@ private:
     explicit FileDescription(File&);
 
     KResult attach();
+    RefPtr<Inode> resolve_directory_entry_for_stat(StringView name);
 
     void evaluate_block_conditions()
     {
@@ -149,6 +165,8 @@ private:
 
     OwnPtr<FileDescriptionData> m_data;
 
+    ReadaheadState m_readahead_state;
+
     u32 m_file_flags { 0 };
 
     bool m_readable : 1 { false };
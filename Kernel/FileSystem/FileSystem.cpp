@@ -49,21 +49,31 @@ FileSystem::DirectoryEntryView::DirectoryEntryView(const StringView& n, InodeIde
 {
 }
 
+static NonnullRefPtrVector<FileSystem, 32> collect_file_systems()
+{
+    NonnullRefPtrVector<FileSystem, 32> file_systems;
+    InterruptDisabler disabler;
+    for (auto& it : all_file_systems())
+        file_systems.append(*it.value);
+    return file_systems;
+}
+
 void FileSystem::sync()
 {
     Inode::sync();
 
-    NonnullRefPtrVector<FileSystem, 32> file_systems;
-    {
-        InterruptDisabler disabler;
-        for (auto& it : all_file_systems())
-            file_systems.append(*it.value);
-    }
-
-    for (auto& fs : file_systems)
+    for (auto& fs : collect_file_systems())
         fs.flush_writes();
 }
 
+void FileSystem::writeback()
+{
+    Inode::sync();
+
+    for (auto& fs : collect_file_systems())
+        fs.flush_old_writes();
+}
+
 void FileSystem::lock_all()
 {
     for (auto& it : all_file_systems()) {
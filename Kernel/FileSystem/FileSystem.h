@@ -11,6 +11,7 @@
 #include <AK/StringView.h>
 #include <Kernel/FileSystem/InodeIdentifier.h>
 #include <Kernel/Forward.h>
+#include <Kernel/IOStatistics.h>
 #include <Kernel/KResult.h>
 #include <Kernel/Mutex.h>
 #include <Kernel/UnixTypes.h>
@@ -29,6 +30,7 @@ public:
     unsigned fsid() const { return m_fsid; }
     static FileSystem* from_fsid(u32);
     static void sync();
+    static void writeback();
     static void lock_all();
 
     virtual bool initialize() = 0;
@@ -54,12 +56,18 @@ public:
     };
 
     virtual void flush_writes() { }
+    // Background writeback: only needs to flush what has been dirty for a while, or what
+    // the file system considers too much to keep around. Defaults to flushing everything.
+    virtual void flush_old_writes() { flush_writes(); }
 
     u64 block_size() const { return m_block_size; }
     size_t fragment_size() const { return m_fragment_size; }
 
     virtual bool is_file_backed() const { return false; }
 
+    // Traffic between the file system and whatever backs it.
+    IOStatistics& io_statistics() const { return m_io_statistics; }
+
     // Converts file types that are used internally by the filesystem to DT_* types
     virtual u8 internal_file_type_to_directory_entry_type(const DirectoryEntryView& entry) const { return entry.file_type; }
 
@@ -76,6 +84,7 @@ private:
     u64 m_block_size { 0 };
     size_t m_fragment_size { 0 };
     bool m_readonly { false };
+    mutable IOStatistics m_io_statistics;
 };
 
 inline FileSystem* InodeIdentifier::fs()
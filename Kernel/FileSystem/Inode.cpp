@@ -11,6 +11,7 @@
 #include <AK/StringView.h>
 #include <Kernel/API/InodeWatcherEvent.h>
 #include <Kernel/FileSystem/Custody.h>
+#include <Kernel/FileSystem/CustodyCache.h>
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/FileSystem/Inode.h>
 #include <Kernel/FileSystem/InodeWatcher.h>
@@ -18,6 +19,7 @@
 #include <Kernel/KBufferBuilder.h>
 #include <Kernel/Net/LocalSocket.h>
 #include <Kernel/Process.h>
+#include <Kernel/VM/PageCache.h>
 #include <Kernel/VM/SharedInodeVMObject.h>
 
 namespace Kernel {
@@ -216,6 +218,8 @@ void Inode::set_metadata_dirty(bool metadata_dirty)
 
 void Inode::did_add_child(InodeIdentifier const&, String const& name)
 {
+    CustodyCache::the().invalidate(identifier(), name);
+
     MutexLocker locker(m_inode_lock);
 
     for (auto& watcher : m_watchers) {
@@ -225,6 +229,8 @@ void Inode::did_add_child(InodeIdentifier const&, String const& name)
 
 void Inode::did_remove_child(InodeIdentifier const&, String const& name)
 {
+    CustodyCache::the().invalidate(identifier(), name);
+
     MutexLocker locker(m_inode_lock);
 
     if (name == "." || name == "..") {
@@ -247,10 +253,15 @@ void Inode::did_modify_contents()
 
 void Inode::did_delete_self()
 {
+    if (is_directory())
+        CustodyCache::the().invalidate_directory(identifier());
+
     MutexLocker locker(m_inode_lock);
     for (auto& watcher : m_watchers) {
         watcher->notify_inode_event({}, identifier(), InodeWatcherEvent::Type::Deleted);
     }
+    // Don't let the page cache keep a deleted inode (and its blocks) alive.
+    PageCache::the().evict(*this);
 }
 
 KResult Inode::prepare_to_write_data()
@@ -52,6 +52,8 @@ public:
     virtual void detach(FileDescription&) { }
     virtual void did_seek(FileDescription&, off_t) { }
     virtual KResultOr<size_t> read_bytes(off_t, size_t, UserOrKernelBuffer& buffer, FileDescription*) const = 0;
+    // Used to fill the page cache. File systems that cache blocks themselves can skip that for data read this way.
+    virtual KResultOr<size_t> read_bytes_for_page_cache(off_t offset, size_t count, UserOrKernelBuffer& buffer) const { return read_bytes(offset, count, buffer, nullptr); }
     virtual KResult traverse_as_directory(Function<bool(FileSystem::DirectoryEntryView const&)>) const = 0;
     virtual RefPtr<Inode> lookup(StringView name) = 0;
     virtual KResultOr<size_t> write_bytes(off_t, size_t, const UserOrKernelBuffer& data, FileDescription*) = 0;
@@ -65,6 +67,10 @@ public:
 
     virtual KResultOr<int> get_block_address(int) { return ENOTSUP; }
 
+    // File systems that keep file contents in physical pages can hand them to shared mappings directly,
+    // instead of having them read into pages of their own.
+    virtual RefPtr<PhysicalPage> physical_page_for_shared_mapping(size_t) { return {}; }
+
     LocalSocket* socket() { return m_socket.ptr(); }
     const LocalSocket* socket() const { return m_socket.ptr(); }
     bool bind_socket(LocalSocket&);
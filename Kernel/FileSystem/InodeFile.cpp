@@ -10,6 +10,7 @@
 #include <Kernel/FileSystem/InodeFile.h>
 #include <Kernel/FileSystem/VirtualFileSystem.h>
 #include <Kernel/Process.h>
+#include <Kernel/VM/PageCache.h>
 #include <Kernel/VM/PrivateInodeVMObject.h>
 #include <Kernel/VM/SharedInodeVMObject.h>
 #include <LibC/errno_numbers.h>
@@ -31,10 +32,14 @@ KResultOr<size_t> InodeFile::read(FileDescription& description, u64 offset, User
     if (Checked<off_t>::addition_would_overflow(offset, count))
         return EOVERFLOW;
 
-    auto result = m_inode->read_bytes(offset, count, buffer, &description);
+    // Regular files on disk are read through the page cache, O_DIRECT asks us not to.
+    bool use_page_cache = m_inode->metadata().is_regular_file() && m_inode->fs().is_file_backed() && !description.is_direct();
+    auto result = use_page_cache ? PageCache::the().read_bytes(*m_inode, offset, count, buffer) : m_inode->read_bytes(offset, count, buffer, &description);
     if (result.is_error())
         return result.error();
     auto nread = result.value();
+    if (use_page_cache)
+        PageCache::the().did_read(*m_inode, description.readahead_state(), offset, nread);
     if (nread > 0) {
         Thread::current()->did_file_read(nread);
         evaluate_block_conditions();
@@ -53,6 +58,7 @@ KResultOr<size_t> InodeFile::write(FileDescription& description, u64 offset, con
 
     auto nwritten = result.value();
     if (nwritten > 0) {
+        PageCache::the().invalidate(*m_inode, offset, nwritten);
         auto mtime_result = m_inode->set_mtime(kgettimeofday().to_truncated_seconds());
         Thread::current()->did_file_write(nwritten);
         evaluate_block_conditions();
@@ -117,6 +123,7 @@ KResult InodeFile::truncate(u64 size)
 {
     if (auto result = m_inode->truncate(size); result.is_error())
         return result;
+    PageCache::the().invalidate(*m_inode, size, NumericLimits<u64>::max() - size);
     if (auto result = m_inode->set_mtime(kgettimeofday().to_truncated_seconds()); result.is_error())
         return result;
     return KSuccess;
@@ -593,14 +593,28 @@ KResult Plan9FS::post_message_and_explicitly_ignore_reply(Message& message)
     return post_message(message, {});
 }
 
-KResult Plan9FS::post_message_and_wait_for_a_reply(Message& message)
+KResultOr<NonnullRefPtr<Plan9FS::ReceiveCompletion>> Plan9FS::post_message_expecting_a_reply(Message& message)
 {
-    auto request_type = message.type();
-    auto tag = message.tag();
-    auto completion = adopt_ref(*new ReceiveCompletion(tag));
+    auto completion = adopt_ref_if_nonnull(new (nothrow) ReceiveCompletion(message.tag()));
+    if (!completion)
+        return ENOMEM;
     auto result = post_message(message, completion);
     if (result.is_error())
         return result;
+    return completion.release_nonnull();
+}
+
+KResult Plan9FS::post_message_and_wait_for_a_reply(Message& message)
+{
+    auto completion_or_error = post_message_expecting_a_reply(message);
+    if (completion_or_error.is_error())
+        return completion_or_error.error();
+    return wait_for_a_reply(message, completion_or_error.release_value());
+}
+
+KResult Plan9FS::wait_for_a_reply(Message& message, NonnullRefPtr<ReceiveCompletion> completion)
+{
+    auto request_type = message.type();
     if (Thread::current()->block<Plan9FS::Blocker>({}, *this, message, completion).was_interrupted())
         return EINTR;
 
@@ -640,6 +654,61 @@ size_t Plan9FS::adjust_buffer_size(size_t size) const
     return min(size, max_size);
 }
 
+template<typename BuildRequest, typename HandleReply>
+KResultOr<size_t> Plan9FS::do_pipelined_transfer(size_t size, BuildRequest build_request, HandleReply handle_reply)
+{
+    struct Request {
+        NonnullOwnPtr<Message> message;
+        NonnullRefPtr<ReceiveCompletion> completion;
+        size_t size;
+    };
+    Vector<Request, max_requests_in_flight> requests_in_flight;
+
+    size_t requested = 0;
+    size_t transferred = 0;
+    KResult error = KSuccess;
+    for (;;) {
+        while (!error.is_error() && requested < size && requests_in_flight.size() < max_requests_in_flight) {
+            auto chunk_size = adjust_buffer_size(size - requested);
+            auto message_or_error = build_request(requested, chunk_size);
+            if (message_or_error.is_error()) {
+                error = message_or_error.error();
+                break;
+            }
+            auto message = message_or_error.release_value();
+            auto completion_or_error = post_message_expecting_a_reply(*message);
+            if (completion_or_error.is_error()) {
+                error = completion_or_error.error();
+                break;
+            }
+            requests_in_flight.append({ move(message), completion_or_error.release_value(), chunk_size });
+            requested += chunk_size;
+        }
+        if (requests_in_flight.is_empty())
+            break;
+
+        // Replies to the requests we stop waiting for are simply dropped when they come in.
+        auto request = requests_in_flight.take_first();
+        auto result = wait_for_a_reply(*request.message, request.completion);
+        if (result.is_error()) {
+            error = result;
+            break;
+        }
+        auto nhandled_or_error = handle_reply(*request.message, transferred, request.size);
+        if (nhandled_or_error.is_error()) {
+            error = nhandled_or_error.error();
+            break;
+        }
+        transferred += nhandled_or_error.value();
+        if (nhandled_or_error.value() < request.size)
+            break;
+    }
+
+    if (transferred == 0 && error.is_error())
+        return error;
+    return transferred;
+}
+
 void Plan9FS::thread_main()
 {
     dbgln("Plan9FS: Thread running");
@@ -734,37 +803,37 @@ KResultOr<size_t> Plan9FSInode::read_bytes(off_t offset, size_t size, UserOrKern
     if (result.is_error())
         return result;
 
-    size = fs().adjust_buffer_size(size);
-
-    Plan9FS::Message message { fs(), Plan9FS::Message::Type::Treadlink };
-    StringView data;
-
     // Try readlink first.
-    bool readlink_succeded = false;
     if (fs().m_remote_protocol_version >= Plan9FS::ProtocolVersion::v9P2000L && offset == 0) {
+        Plan9FS::Message message { fs(), Plan9FS::Message::Type::Treadlink };
         message << fid();
         result = fs().post_message_and_wait_for_a_reply(message);
         if (result.is_success()) {
-            readlink_succeded = true;
+            StringView data;
             message >> data;
+            size_t nread = min(data.length(), fs().adjust_buffer_size(size));
+            if (!buffer.write(data.characters_without_null_termination(), nread))
+                return EFAULT;
+            return nread;
         }
     }
 
-    if (!readlink_succeded) {
-        message = Plan9FS::Message { fs(), Plan9FS::Message::Type::Tread };
-        message << fid() << (u64)offset << (u32)size;
-        result = fs().post_message_and_wait_for_a_reply(message);
-        if (result.is_error())
-            return result.error();
-        data = message.read_data();
-    }
-
-    // Guard against the server returning more data than requested.
-    size_t nread = min(data.length(), size);
-    if (!buffer.write(data.characters_without_null_termination(), nread))
-        return EFAULT;
-
-    return nread;
+    auto build_request = [&](size_t chunk_offset, size_t chunk_size) -> KResultOr<NonnullOwnPtr<Plan9FS::Message>> {
+        auto message = adopt_own_if_nonnull(new (nothrow) Plan9FS::Message { fs(), Plan9FS::Message::Type::Tread });
+        if (!message)
+            return ENOMEM;
+        *message << fid() << (u64)(offset + chunk_offset) << (u32)chunk_size;
+        return message.release_nonnull();
+    };
+    auto handle_reply = [&](Plan9FS::Message& reply, size_t chunk_offset, size_t chunk_size) -> KResultOr<size_t> {
+        auto data = reply.read_data();
+        // Guard against the server returning more data than requested.
+        size_t nread = min(data.length(), chunk_size);
+        if (!buffer.write(data.characters_without_null_termination(), chunk_offset, nread))
+            return EFAULT;
+        return nread;
+    };
+    return fs().do_pipelined_transfer(size, build_request, handle_reply);
 }
 
 KResultOr<size_t> Plan9FSInode::write_bytes(off_t offset, size_t size, const UserOrKernelBuffer& data, FileDescription*)
@@ -773,22 +842,23 @@ KResultOr<size_t> Plan9FSInode::write_bytes(off_t offset, size_t size, const Use
     if (result.is_error())
         return result.error();
 
-    size = fs().adjust_buffer_size(size);
-
-    auto data_copy = data.copy_into_string(size); // FIXME: this seems ugly
-    if (data_copy.is_null())
-        return EFAULT;
-
-    Plan9FS::Message message { fs(), Plan9FS::Message::Type::Twrite };
-    message << fid() << (u64)offset;
-    message.append_data(data_copy);
-    result = fs().post_message_and_wait_for_a_reply(message);
-    if (result.is_error())
-        return result.error();
-
-    u32 nwritten;
-    message >> nwritten;
-    return nwritten;
+    auto build_request = [&](size_t chunk_offset, size_t chunk_size) -> KResultOr<NonnullOwnPtr<Plan9FS::Message>> {
+        auto data_copy = data.offset(chunk_offset).copy_into_string(chunk_size); // FIXME: this seems ugly
+        if (data_copy.is_null())
+            return EFAULT;
+        auto message = adopt_own_if_nonnull(new (nothrow) Plan9FS::Message { fs(), Plan9FS::Message::Type::Twrite });
+        if (!message)
+            return ENOMEM;
+        *message << fid() << (u64)(offset + chunk_offset);
+        message->append_data(data_copy);
+        return message.release_nonnull();
+    };
+    auto handle_reply = [&](Plan9FS::Message& reply, size_t, size_t chunk_size) -> KResultOr<size_t> {
+        u32 nwritten;
+        reply >> nwritten;
+        return min(static_cast<size_t>(nwritten), chunk_size);
+    };
+    return fs().do_pipelined_transfer(size, build_request, handle_reply);
 }
 
 InodeMetadata Plan9FSInode::metadata() const
@@ -121,6 +121,14 @@ private:
     KResult read_and_dispatch_one_message();
     KResult post_message_and_wait_for_a_reply(Message&);
     KResult post_message_and_explicitly_ignore_reply(Message&);
+    KResultOr<NonnullRefPtr<ReceiveCompletion>> post_message_expecting_a_reply(Message&);
+    KResult wait_for_a_reply(Message&, NonnullRefPtr<ReceiveCompletion>);
+
+    // Splits a transfer of size bytes into messages of at most the negotiated size and keeps
+    // up to max_requests_in_flight of them outstanding, so that large reads and writes aren't
+    // bounded by the round-trip latency. Stops at the first error or short reply.
+    template<typename BuildRequest, typename HandleReply>
+    KResultOr<size_t> do_pipelined_transfer(size_t size, BuildRequest, HandleReply);
 
     ProtocolVersion parse_protocol_version(const StringView&) const;
     size_t adjust_buffer_size(size_t size) const;
@@ -132,8 +140,12 @@ private:
     Atomic<u16> m_next_tag { (u16)-1 };
     Atomic<u32> m_next_fid { 1 };
 
+    // What we ask for in Tversion, the server may lower it.
+    static constexpr size_t max_message_size_to_negotiate = 512 * KiB;
+    static constexpr size_t max_requests_in_flight = 8;
+
     ProtocolVersion m_remote_protocol_version { ProtocolVersion::v9P2000 };
-    size_t m_max_message_size { 4 * KiB };
+    size_t m_max_message_size { max_message_size_to_negotiate };
 
     Mutex m_send_lock { "Plan9FS send" };
     Plan9FSBlockCondition m_completion_blocker;
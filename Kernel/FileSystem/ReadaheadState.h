@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+namespace Kernel {
+
+// What userspace told us (with posix_fadvise() or madvise()) about how it's going to access a file.
+enum class ReadaheadAdvice : u8 {
+    Normal,
+    Sequential,
+    Random,
+};
+
+// Kept per FileDescription, so that the page cache can tell sequential readers apart and read ahead of them.
+struct ReadaheadState {
+    // Where a sequential read would continue.
+    u64 next_offset { 0 };
+    // Everything before this has already been asked for.
+    u64 end_offset { 0 };
+    size_t window_page_count { 0 };
+    ReadaheadAdvice advice { ReadaheadAdvice::Normal };
+};
+
+}
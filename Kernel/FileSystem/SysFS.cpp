@@ -116,7 +116,7 @@ InodeMetadata SysFSInode::metadata() const
     MutexLocker locker(m_inode_lock);
     InodeMetadata metadata;
     metadata.inode = { fsid(), m_associated_component->component_index() };
-    metadata.mode = S_IFREG | S_IRUSR | S_IRGRP | S_IROTH;
+    metadata.mode = S_IFREG | m_associated_component->permissions();
     metadata.uid = 0;
     metadata.gid = 0;
     metadata.size = m_associated_component->size();
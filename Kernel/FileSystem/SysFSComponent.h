@@ -26,6 +26,7 @@ public:
     virtual RefPtr<SysFSComponent> lookup(StringView) { VERIFY_NOT_REACHED(); };
     virtual KResultOr<size_t> write_bytes(off_t, size_t, UserOrKernelBuffer const&, FileDescription*) { return -EROFS; }
     virtual size_t size() const { return 0; }
+    virtual mode_t permissions() const { return S_IRUSR | S_IRGRP | S_IROTH; }
 
     virtual NonnullRefPtr<Inode> to_inode(SysFS const&) const;
 
@@ -6,6 +6,7 @@
 
 #include <Kernel/FileSystem/TmpFS.h>
 #include <Kernel/Process.h>
+#include <Kernel/VM/MemoryManager.h>
 #include <LibC/limits.h>
 
 namespace Kernel {
@@ -139,11 +140,69 @@ KResultOr<size_t> TmpFSInode::read_bytes(off_t offset, size_t size, UserOrKernel
     if (static_cast<off_t>(size) > m_metadata.size - offset)
         size = m_metadata.size - offset;
 
-    if (!buffer.write(m_content->data() + offset, size))
-        return EFAULT;
+    // The buffer may be in userspace, so bounce through the stack instead of copying from a quickmapped page.
+    u8 page_buffer[PAGE_SIZE];
+    for (size_t nread = 0; nread < size;) {
+        auto position = offset + nread;
+        auto& page = *m_content->physical_pages()[position / PAGE_SIZE];
+        auto offset_in_page = position % PAGE_SIZE;
+        auto chunk_size = min(PAGE_SIZE - offset_in_page, size - nread);
+        if (page.is_shared_zero_page()) {
+            memset(page_buffer, 0, chunk_size);
+        } else {
+            memcpy(page_buffer, MM.quickmap_page(page.paddr()) + offset_in_page, chunk_size);
+            MM.unquickmap_page();
+        }
+        if (!buffer.write(page_buffer, nread, chunk_size))
+            return EFAULT;
+        nread += chunk_size;
+    }
     return size;
 }
 
+KResult TmpFSInode::ensure_content_size(size_t size)
+{
+    if (m_content && m_content->size() >= size)
+        return KSuccess;
+
+    // Grow 2x to accommodate repeated write() calls. Only the page pointers move over to the new VMObject,
+    // the contents stay where they are, and pages are only allocated once something is written to them.
+    size_t old_page_count = m_content ? m_content->page_count() : 0;
+    auto new_size = max(page_round_up(size), old_page_count * PAGE_SIZE * 2);
+    auto new_content = AnonymousVMObject::try_create_with_size(new_size, AllocationStrategy::None);
+    if (!new_content)
+        return ENOMEM;
+    for (size_t i = 0; i < old_page_count; ++i)
+        new_content->physical_pages()[i] = move(m_content->physical_pages()[i]);
+    m_content = move(new_content);
+    return KSuccess;
+}
+
+KResultOr<PhysicalPage*> TmpFSInode::ensure_content_page(size_t page_index)
+{
+    auto& page_slot = m_content->physical_pages()[page_index];
+    if (page_slot->is_shared_zero_page()) {
+        auto new_page = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::Yes);
+        if (!new_page)
+            return ENOMEM;
+        page_slot = move(new_page);
+    }
+    return page_slot.ptr();
+}
+
+void TmpFSInode::zero_content_tail(size_t old_size, size_t new_size)
+{
+    // The rest of the last page may still hold data from before a truncate, or written through a shared mapping.
+    auto end = min(page_round_up(old_size), new_size);
+    if (old_size >= end)
+        return;
+    auto& page = *m_content->physical_pages()[old_size / PAGE_SIZE];
+    if (!page.is_shared_zero_page()) {
+        memset(MM.quickmap_page(page) + old_size % PAGE_SIZE, 0, end - old_size);
+        MM.unquickmap_page();
+    }
+}
+
 KResultOr<size_t> TmpFSInode::write_bytes(off_t offset, size_t size, const UserOrKernelBuffer& buffer, FileDescription*)
 {
     MutexLocker locker(m_inode_lock);
@@ -163,36 +222,44 @@ KResultOr<size_t> TmpFSInode::write_bytes(off_t offset, size_t size, const UserO
         return ENOMEM;                                                   // we won't be able to resize to this capacity
 
     if (new_size > old_size) {
-        if (m_content && static_cast<off_t>(m_content->capacity()) >= new_size) {
-            m_content->set_size(new_size);
-        } else {
-            // Grow the content buffer 2x the new sizeto accommodate repeating write() calls.
-            // Note that we're not actually committing physical memory to the buffer
-            // until it's needed. We only grow VM here.
-
-            // FIXME: Fix this so that no memcpy() is necessary, and we can just grow the
-            //        KBuffer and it will add physical pages as needed while keeping the
-            //        existing ones.
-            auto tmp = KBuffer::try_create_with_size(new_size * 2);
-            if (!tmp)
-                return ENOMEM;
-            tmp->set_size(new_size);
-            if (m_content)
-                memcpy(tmp->data(), m_content->data(), old_size);
-            m_content = move(tmp);
-        }
+        if (auto result = ensure_content_size(new_size); result.is_error())
+            return result;
+        zero_content_tail(old_size, offset);
         m_metadata.size = new_size;
         set_metadata_dirty(true);
         set_metadata_dirty(false);
     }
 
-    if (!buffer.read(m_content->data() + offset, size)) // TODO: partial reads?
-        return EFAULT;
+    u8 page_buffer[PAGE_SIZE];
+    for (size_t nwritten = 0; nwritten < size;) {
+        auto position = offset + nwritten;
+        auto page_or_error = ensure_content_page(position / PAGE_SIZE);
+        if (page_or_error.is_error())
+            return page_or_error.error();
+        auto offset_in_page = position % PAGE_SIZE;
+        auto chunk_size = min(PAGE_SIZE - offset_in_page, size - nwritten);
+        if (!buffer.read(page_buffer, nwritten, chunk_size)) // TODO: partial reads?
+            return EFAULT;
+        memcpy(MM.quickmap_page(*page_or_error.value()) + offset_in_page, page_buffer, chunk_size);
+        MM.unquickmap_page();
+        nwritten += chunk_size;
+    }
 
     did_modify_contents();
     return size;
 }
 
+RefPtr<PhysicalPage> TmpFSInode::physical_page_for_shared_mapping(size_t page_index)
+{
+    MutexLocker locker(m_inode_lock);
+    if (!m_content || page_index >= ceil_div(static_cast<size_t>(m_metadata.size), static_cast<size_t>(PAGE_SIZE)))
+        return {};
+    auto page_or_error = ensure_content_page(page_index);
+    if (page_or_error.is_error())
+        return {};
+    return page_or_error.value();
+}
+
 RefPtr<Inode> TmpFSInode::lookup(StringView name)
 {
     MutexLocker locker(m_inode_lock, Mutex::Mode::Shared);
@@ -326,24 +393,21 @@ KResult TmpFSInode::truncate(u64 size)
     MutexLocker locker(m_inode_lock);
     VERIFY(!is_directory());
 
-    if (size == 0)
+    if (size > NumericLimits<size_t>::max() / 2)
+        return ENOMEM;
+
+    size_t old_size = m_metadata.size;
+    if (size == 0) {
         m_content.clear();
-    else if (!m_content) {
-        m_content = KBuffer::try_create_with_size(size);
-        if (!m_content)
-            return ENOMEM;
-    } else if (static_cast<size_t>(size) < m_content->capacity()) {
-        size_t prev_size = m_metadata.size;
-        m_content->set_size(size);
-        if (prev_size < static_cast<size_t>(size))
-            memset(m_content->data() + prev_size, 0, size - prev_size);
+    } else if (size > old_size) {
+        if (auto result = ensure_content_size(size); result.is_error())
+            return result;
+        zero_content_tail(old_size, size);
     } else {
-        size_t prev_size = m_metadata.size;
-        auto tmp = KBuffer::try_create_with_size(size);
-        if (!tmp)
-            return ENOMEM;
-        memcpy(tmp->data(), m_content->data(), prev_size);
-        m_content = move(tmp);
+        // Give back the pages past the new end, but keep the VMObject itself for the file to grow back into.
+        auto& zero_page = MM.shared_zero_page();
+        for (size_t i = ceil_div(static_cast<size_t>(size), static_cast<size_t>(PAGE_SIZE)); i < m_content->page_count(); ++i)
+            m_content->physical_pages()[i] = zero_page;
     }
 
     m_metadata.size = size;
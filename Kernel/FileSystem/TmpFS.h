@@ -8,7 +8,7 @@
 
 #include <Kernel/FileSystem/FileSystem.h>
 #include <Kernel/FileSystem/Inode.h>
-#include <Kernel/KBuffer.h>
+#include <Kernel/VM/AnonymousVMObject.h>
 
 namespace Kernel {
 
@@ -68,6 +68,7 @@ public:
     virtual KResult set_ctime(time_t) override;
     virtual KResult set_mtime(time_t) override;
     virtual void one_ref_left() override;
+    virtual RefPtr<PhysicalPage> physical_page_for_shared_mapping(size_t page_index) override;
 
 private:
     TmpFSInode(TmpFS& fs, InodeMetadata metadata, InodeIdentifier parent);
@@ -75,6 +76,10 @@ private:
     static RefPtr<TmpFSInode> create_root(TmpFS&);
     void notify_watchers();
 
+    KResult ensure_content_size(size_t);
+    KResultOr<PhysicalPage*> ensure_content_page(size_t page_index);
+    void zero_content_tail(size_t old_size, size_t new_size);
+
     struct Child {
         NonnullOwnPtr<KString> name;
         NonnullRefPtr<TmpFSInode> inode;
@@ -87,7 +92,9 @@ private:
     InodeMetadata m_metadata;
     InodeIdentifier m_parent;
 
-    OwnPtr<KBuffer> m_content;
+    // File contents live in the pages of this VMObject, which may be larger than the file.
+    // Pages that were never written to are the shared zero page.
+    RefPtr<AnonymousVMObject> m_content;
 
     Child::List m_children;
 };
@@ -9,6 +9,7 @@
 #include <Kernel/Debug.h>
 #include <Kernel/Devices/BlockDevice.h>
 #include <Kernel/FileSystem/Custody.h>
+#include <Kernel/FileSystem/CustodyCache.h>
 #include <Kernel/FileSystem/FileBackedFileSystem.h>
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/FileSystem/FileSystem.h>
@@ -62,6 +63,8 @@ KResult VirtualFileSystem::mount(FileSystem& fs, Custody& mount_point, int flags
     // FIXME: check that this is not already a mount point
     Mount mount { fs, &mount_point, flags };
     m_mounts.append(move(mount));
+    // Cached custodies have the old mount table baked into them.
+    CustodyCache::the().clear();
     return KSuccess;
 }
 
@@ -73,6 +76,7 @@ KResult VirtualFileSystem::bind_mount(Custody& source, Custody& mount_point, int
     // FIXME: check that this is not already a mount point
     Mount mount { source.inode(), mount_point, flags };
     m_mounts.append(move(mount));
+    CustodyCache::the().clear();
     return KSuccess;
 }
 
@@ -87,6 +91,7 @@ KResult VirtualFileSystem::remount(Custody& mount_point, int new_flags)
         return ENODEV;
 
     mount->set_flags(new_flags);
+    CustodyCache::the().clear();
     return KSuccess;
 }
 
@@ -98,12 +103,15 @@ KResult VirtualFileSystem::unmount(Inode& guest_inode)
     for (size_t i = 0; i < m_mounts.size(); ++i) {
         auto& mount = m_mounts.at(i);
         if (&mount.guest() == &guest_inode) {
+            // Cached custodies keep inodes alive, which would make the file system look busy.
+            CustodyCache::the().clear();
             if (auto result = mount.guest_fs().prepare_to_unmount(); result.is_error()) {
                 dbgln("VirtualFileSystem: Failed to unmount!");
                 return result;
             }
             dbgln("VirtualFileSystem: found fs {} at mount index {}! Unmounting...", mount.guest_fs().fsid(), i);
             m_mounts.unstable_take(i);
+            CustodyCache::the().clear();
             return KSuccess;
         }
     }
@@ -905,6 +913,45 @@ static bool safe_to_follow_symlink(const Inode& inode, const InodeMetadata& pare
     return false;
 }
 
+KResultOr<NonnullRefPtr<Custody>> VirtualFileSystem::lookup_child_custody(Custody& parent, StringView name)
+{
+    // Only file systems that tell us about added and removed children can be cached.
+    bool is_cacheable = parent.inode().fs().supports_watchers();
+    u64 cache_generation = 0;
+    if (is_cacheable) {
+        cache_generation = CustodyCache::the().generation();
+        if (auto cached_custody = CustodyCache::the().lookup(parent, name); cached_custody.has_value()) {
+            if (!cached_custody.value())
+                return ENOENT;
+            return cached_custody.release_value().release_nonnull();
+        }
+    }
+
+    auto child_inode = parent.inode().lookup(name);
+    if (!child_inode) {
+        if (is_cacheable)
+            CustodyCache::the().add(parent, name, nullptr, cache_generation);
+        return ENOENT;
+    }
+
+    int mount_flags_for_child = parent.mount_flags();
+
+    // See if there's something mounted on the child; in that case
+    // we would need to return the guest inode, not the host inode.
+    if (auto mount = find_mount_for_host(child_inode->identifier())) {
+        child_inode = mount->guest();
+        mount_flags_for_child = mount->flags();
+    }
+
+    auto new_custody_or_error = Custody::try_create(&parent, name, *child_inode, mount_flags_for_child);
+    if (new_custody_or_error.is_error())
+        return new_custody_or_error.error();
+
+    if (is_cacheable)
+        CustodyCache::the().add(parent, name, new_custody_or_error.value(), cache_generation);
+    return new_custody_or_error.release_value();
+}
+
 KResultOr<NonnullRefPtr<Custody>> VirtualFileSystem::resolve_path_without_veil(StringView path, Custody& base, RefPtr<Custody>* out_parent, int options, int symlink_recursion_level)
 {
     if (symlink_recursion_level >= symlink_recursion_limit)
@@ -946,33 +993,21 @@ KResultOr<NonnullRefPtr<Custody>> VirtualFileSystem::resolve_path_without_veil(S
         }
 
         // Okay, let's look up this part.
-        auto child_inode = parent.inode().lookup(part);
-        if (!child_inode) {
-            if (out_parent) {
+        auto child_custody_or_error = lookup_child_custody(parent, part);
+        if (child_custody_or_error.is_error()) {
+            if (child_custody_or_error.error() == ENOENT && out_parent) {
                 // ENOENT with a non-null parent custody signals to caller that
                 // we found the immediate parent of the file, but the file itself
                 // does not exist yet.
                 *out_parent = have_more_parts ? nullptr : &parent;
             }
-            return ENOENT;
+            return child_custody_or_error.error();
         }
 
-        int mount_flags_for_child = parent.mount_flags();
-
-        // See if there's something mounted on the child; in that case
-        // we would need to return the guest inode, not the host inode.
-        if (auto mount = find_mount_for_host(child_inode->identifier())) {
-            child_inode = mount->guest();
-            mount_flags_for_child = mount->flags();
-        }
-
-        auto new_custody_or_error = Custody::try_create(&parent, part, *child_inode, mount_flags_for_child);
-        if (new_custody_or_error.is_error())
-            return new_custody_or_error.error();
-
-        custody = new_custody_or_error.release_value();
+        custody = child_custody_or_error.release_value();
+        auto& child_inode = custody->inode();
 
-        if (child_inode->metadata().is_symlink()) {
+        if (child_inode.metadata().is_symlink()) {
             if (!have_more_parts) {
                 if (options & O_NOFOLLOW)
                     return ELOOP;
@@ -980,13 +1015,13 @@ KResultOr<NonnullRefPtr<Custody>> VirtualFileSystem::resolve_path_without_veil(S
                     break;
             }
 
-            if (!safe_to_follow_symlink(*child_inode, parent_metadata))
+            if (!safe_to_follow_symlink(child_inode, parent_metadata))
                 return EACCES;
 
             if (auto result = validate_path_against_process_veil(*custody, options); result.is_error())
                 return result;
 
-            auto symlink_target = child_inode->resolve_as_link(parent, out_parent, options, symlink_recursion_level + 1);
+            auto symlink_target = child_inode.resolve_as_link(parent, out_parent, options, symlink_recursion_level + 1);
             if (symlink_target.is_error() || !have_more_parts)
                 return symlink_target;
 
@@ -81,6 +81,8 @@ private:
 
     bool is_vfs_root(InodeIdentifier) const;
 
+    KResultOr<NonnullRefPtr<Custody>> lookup_child_custody(Custody& parent, StringView name);
+
     KResult traverse_directory_inode(Inode&, Function<bool(FileSystem::DirectoryEntryView const&)>);
 
     Mount* find_mount_for_host(InodeIdentifier);
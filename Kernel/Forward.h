@@ -20,6 +20,7 @@ class DevFSRootDirectoryInode;
 class Device;
 class DiskCache;
 class DoubleBuffer;
+class EPoll;
 class File;
 class FileDescription;
 class FileSystem;
@@ -82,6 +83,7 @@ class ScopedSpinLock;
 template<typename T>
 class KResultOr;
 
+struct CacheEntry;
 struct InodeMetadata;
 struct TrapFrame;
 
@@ -16,6 +16,7 @@
 #include <Kernel/FileSystem/Custody.h>
 #include <Kernel/FileSystem/FileBackedFileSystem.h>
 #include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/Heap/SlabCache.h>
 #include <Kernel/Heap/kmalloc.h>
 #include <Kernel/Interrupts/GenericInterruptHandler.h>
 #include <Kernel/Interrupts/InterruptManagement.h>
@@ -30,6 +31,7 @@
 #include <Kernel/ProcessExposed.h>
 #include <Kernel/Sections.h>
 #include <Kernel/TTY/TTY.h>
+#include <Kernel/Tracepoints.h>
 
 namespace Kernel {
 
@@ -57,6 +59,10 @@ private:
             obj.add("bytes_in", adapter.bytes_in());
             obj.add("packets_out", adapter.packets_out());
             obj.add("bytes_out", adapter.bytes_out());
+            obj.add("receive_queue_full", adapter.receive_queue_full());
+            obj.add("packets_dropped", adapter.packets_dropped());
+            obj.add("receive_errors", adapter.receive_errors());
+            obj.add("send_errors", adapter.send_errors());
             obj.add("link_up", adapter.link_up());
             obj.add("mtu", adapter.mtu());
         });
@@ -85,6 +91,29 @@ private:
     }
 };
 
+class ProcFSRoute final : public ProcFSGlobalInformation {
+public:
+    static NonnullRefPtr<ProcFSRoute> must_create();
+
+private:
+    ProcFSRoute();
+    virtual bool output(KBufferBuilder& builder) override
+    {
+        JsonArraySerializer array { builder };
+        RoutingTable::the().for_each_route([&array](auto& route) {
+            auto obj = array.add_object();
+            obj.add("destination", route.destination.to_string());
+            obj.add("prefix_length", route.prefix_length);
+            obj.add("gateway", route.gateway.to_string());
+            obj.add("interface", route.adapter->name());
+            obj.add("origin", route.origin == Route::Origin::Static ? "static" : "adapter");
+            obj.add("local", route.is_local);
+        });
+        array.finish();
+        return true;
+    }
+};
+
 class ProcFSTCP final : public ProcFSGlobalInformation {
 public:
     static NonnullRefPtr<ProcFSTCP> must_create();
@@ -107,6 +136,20 @@ private:
             obj.add("bytes_in", socket.bytes_in());
             obj.add("packets_out", socket.packets_out());
             obj.add("bytes_out", socket.bytes_out());
+            obj.add("bytes_acked", socket.bytes_acked());
+            obj.add("unacked_bytes", socket.unacked_bytes());
+            obj.add("peer_window_size", socket.peer_window_size());
+            obj.add("congestion_control", socket.congestion_control().name());
+            obj.add("congestion_window", socket.congestion_control().congestion_window());
+            obj.add("slow_start_threshold", socket.congestion_control().slow_start_threshold());
+            obj.add("retransmit_timeout_ms", socket.retransmit_timeout().to_milliseconds());
+            obj.add("retransmitted_segments", socket.retransmitted_segments());
+            obj.add("retransmit_timeouts", socket.retransmit_timeouts());
+            obj.add("fast_retransmits", socket.fast_retransmits());
+            if (auto rtt = socket.smoothed_rtt(); rtt.has_value()) {
+                obj.add("smoothed_rtt_us", rtt.value().to_microseconds());
+                obj.add("rtt_variance_us", socket.rtt_variance().value().to_microseconds());
+            }
         });
         array.finish();
         return true;
@@ -182,6 +225,10 @@ UNMAP_AFTER_INIT NonnullRefPtr<ProcFSARP> ProcFSARP::must_create()
 {
     return adopt_ref_if_nonnull(new (nothrow) ProcFSARP).release_nonnull();
 }
+UNMAP_AFTER_INIT NonnullRefPtr<ProcFSRoute> ProcFSRoute::must_create()
+{
+    return adopt_ref_if_nonnull(new (nothrow) ProcFSRoute).release_nonnull();
+}
 UNMAP_AFTER_INIT NonnullRefPtr<ProcFSTCP> ProcFSTCP::must_create()
 {
     return adopt_ref_if_nonnull(new (nothrow) ProcFSTCP).release_nonnull();
@@ -200,6 +247,7 @@ UNMAP_AFTER_INIT NonnullRefPtr<ProcFSNetworkDirectory> ProcFSNetworkDirectory::m
     auto directory = adopt_ref(*new (nothrow) ProcFSNetworkDirectory(parent_directory));
     directory->m_components.append(ProcFSAdapters::must_create());
     directory->m_components.append(ProcFSARP::must_create());
+    directory->m_components.append(ProcFSRoute::must_create());
     directory->m_components.append(ProcFSTCP::must_create());
     directory->m_components.append(ProcFSLocalNet::must_create());
     directory->m_components.append(ProcFSUDP::must_create());
@@ -214,6 +262,10 @@ UNMAP_AFTER_INIT ProcFSARP::ProcFSARP()
     : ProcFSGlobalInformation("arp"sv)
 {
 }
+UNMAP_AFTER_INIT ProcFSRoute::ProcFSRoute()
+    : ProcFSGlobalInformation("route"sv)
+{
+}
 UNMAP_AFTER_INIT ProcFSTCP::ProcFSTCP()
     : ProcFSGlobalInformation("tcp"sv)
 {
@@ -288,6 +340,25 @@ private:
     mutable Mutex m_lock;
 };
 
+class ProcFSTracepointsEnabled : public ProcFSSystemBoolean {
+public:
+    static NonnullRefPtr<ProcFSTracepointsEnabled> must_create(const ProcFSSystemDirectory&);
+    virtual bool value() const override
+    {
+        MutexLocker locker(m_lock);
+        return g_tracepoints_enabled;
+    }
+    virtual void set_value(bool new_value) override
+    {
+        MutexLocker locker(m_lock);
+        g_tracepoints_enabled = new_value;
+    }
+
+private:
+    ProcFSTracepointsEnabled();
+    mutable Mutex m_lock;
+};
+
 UNMAP_AFTER_INIT NonnullRefPtr<ProcFSDumpKmallocStacks> ProcFSDumpKmallocStacks::must_create(const ProcFSSystemDirectory&)
 {
     return adopt_ref_if_nonnull(new (nothrow) ProcFSDumpKmallocStacks).release_nonnull();
@@ -300,6 +371,10 @@ UNMAP_AFTER_INIT NonnullRefPtr<ProcFSCapsLockRemap> ProcFSCapsLockRemap::must_cr
 {
     return adopt_ref_if_nonnull(new (nothrow) ProcFSCapsLockRemap).release_nonnull();
 }
+UNMAP_AFTER_INIT NonnullRefPtr<ProcFSTracepointsEnabled> ProcFSTracepointsEnabled::must_create(const ProcFSSystemDirectory&)
+{
+    return adopt_ref_if_nonnull(new (nothrow) ProcFSTracepointsEnabled).release_nonnull();
+}
 
 UNMAP_AFTER_INIT ProcFSDumpKmallocStacks::ProcFSDumpKmallocStacks()
     : ProcFSSystemBoolean("kmalloc_stacks"sv)
@@ -316,6 +391,11 @@ UNMAP_AFTER_INIT ProcFSCapsLockRemap::ProcFSCapsLockRemap()
 {
 }
 
+UNMAP_AFTER_INIT ProcFSTracepointsEnabled::ProcFSTracepointsEnabled()
+    : ProcFSSystemBoolean("tracepoints"sv)
+{
+}
+
 class ProcFSSelfProcessDirectory final : public ProcFSExposedLink {
 public:
     static NonnullRefPtr<ProcFSSelfProcessDirectory> must_create();
@@ -386,6 +466,16 @@ private:
         json.add("user_physical_uncommitted", system_memory.user_physical_pages_uncommitted);
         json.add("super_physical_allocated", system_memory.super_physical_pages_used);
         json.add("super_physical_available", system_memory.super_physical_pages - system_memory.super_physical_pages_used);
+        {
+            auto numa_nodes = json.add_array("numa_nodes");
+            for (auto& node : MemoryManager::the().numa_node_info()) {
+                auto node_object = numa_nodes.add_object();
+                node_object.add("node", node.node);
+                node_object.add("proximity_domain", node.proximity_domain);
+                node_object.add("user_physical_pages", node.user_physical_pages);
+                node_object.add("user_physical_available", node.user_physical_pages_free);
+            }
+        }
         json.add("kmalloc_call_count", stats.kmalloc_call_count);
         json.add("kfree_call_count", stats.kfree_call_count);
         slab_alloc_stats([&json](size_t slab_size, size_t num_allocated, size_t num_free) {
@@ -398,6 +488,35 @@ private:
     }
 };
 
+class ProcFSSlabInfo final : public ProcFSGlobalInformation {
+public:
+    static NonnullRefPtr<ProcFSSlabInfo> must_create();
+
+private:
+    ProcFSSlabInfo();
+    virtual bool output(KBufferBuilder& builder) override
+    {
+        JsonArraySerializer array { builder };
+        SlabCache::for_each([&array](auto& cache) {
+            auto stats = cache.stats();
+            auto obj = array.add_object();
+            obj.add("name", cache.name());
+            obj.add("object_size", stats.object_size);
+            obj.add("slab_size", stats.slab_size);
+            obj.add("slab_count", stats.slab_count);
+            obj.add("object_count", stats.object_count);
+            obj.add("allocated_count", stats.allocated_count);
+            obj.add("magazine_count", stats.magazine_count);
+            // How much of the memory taken up by slabs is not used by allocated objects.
+            auto slab_bytes = stats.slab_count * stats.slab_size;
+            auto allocated_bytes = stats.allocated_count * stats.object_size;
+            obj.add("unused_bytes", slab_bytes - min(slab_bytes, allocated_bytes));
+        });
+        array.finish();
+        return true;
+    }
+};
+
 class ProcFSOverallProcesses final : public ProcFSGlobalInformation {
 public:
     static NonnullRefPtr<ProcFSOverallProcesses> must_create();
@@ -655,6 +774,21 @@ private:
         return true;
     }
 };
+class ProcFSSchedulingLatency final : public ProcFSGlobalInformation {
+public:
+    static NonnullRefPtr<ProcFSSchedulingLatency> must_create();
+
+private:
+    ProcFSSchedulingLatency();
+    virtual bool output(KBufferBuilder& builder) override
+    {
+        JsonArraySerializer array { builder };
+        for (auto& bucket : Scheduler::scheduling_latency_histogram().buckets)
+            array.add(bucket.load());
+        array.finish();
+        return true;
+    }
+};
 class ProcFSCommandLine final : public ProcFSGlobalInformation {
 public:
     static NonnullRefPtr<ProcFSCommandLine> must_create();
@@ -709,7 +843,21 @@ private:
         if (!g_global_perf_events)
             return false;
 
-        return g_global_perf_events->to_json(builder);
+        return g_global_perf_events->to_perfcore(builder);
+    }
+};
+
+class ProcFSTracepoints final : public ProcFSGlobalInformation {
+public:
+    static NonnullRefPtr<ProcFSTracepoints> must_create();
+
+    virtual mode_t required_mode() const override { return 0400; }
+
+private:
+    ProcFSTracepoints();
+    virtual bool output(KBufferBuilder& builder) override
+    {
+        return Tracepoints::to_json(builder);
     }
 };
 
@@ -743,6 +891,10 @@ UNMAP_AFTER_INIT NonnullRefPtr<ProcFSMemoryStatus> ProcFSMemoryStatus::must_crea
 {
     return adopt_ref_if_nonnull(new (nothrow) ProcFSMemoryStatus).release_nonnull();
 }
+UNMAP_AFTER_INIT NonnullRefPtr<ProcFSSlabInfo> ProcFSSlabInfo::must_create()
+{
+    return adopt_ref_if_nonnull(new (nothrow) ProcFSSlabInfo).release_nonnull();
+}
 UNMAP_AFTER_INIT NonnullRefPtr<ProcFSOverallProcesses> ProcFSOverallProcesses::must_create()
 {
     return adopt_ref_if_nonnull(new (nothrow) ProcFSOverallProcesses).release_nonnull();
@@ -775,6 +927,10 @@ UNMAP_AFTER_INIT NonnullRefPtr<ProcFSUptime> ProcFSUptime::must_create()
 {
     return adopt_ref_if_nonnull(new (nothrow) ProcFSUptime).release_nonnull();
 }
+UNMAP_AFTER_INIT NonnullRefPtr<ProcFSSchedulingLatency> ProcFSSchedulingLatency::must_create()
+{
+    return adopt_ref_if_nonnull(new (nothrow) ProcFSSchedulingLatency).release_nonnull();
+}
 UNMAP_AFTER_INIT NonnullRefPtr<ProcFSCommandLine> ProcFSCommandLine::must_create()
 {
     return adopt_ref_if_nonnull(new (nothrow) ProcFSCommandLine).release_nonnull();
@@ -787,6 +943,10 @@ UNMAP_AFTER_INIT NonnullRefPtr<ProcFSProfile> ProcFSProfile::must_create()
 {
     return adopt_ref_if_nonnull(new (nothrow) ProcFSProfile).release_nonnull();
 }
+UNMAP_AFTER_INIT NonnullRefPtr<ProcFSTracepoints> ProcFSTracepoints::must_create()
+{
+    return adopt_ref_if_nonnull(new (nothrow) ProcFSTracepoints).release_nonnull();
+}
 
 UNMAP_AFTER_INIT NonnullRefPtr<ProcFSKernelBase> ProcFSKernelBase::must_create()
 {
@@ -805,6 +965,10 @@ UNMAP_AFTER_INIT ProcFSMemoryStatus::ProcFSMemoryStatus()
     : ProcFSGlobalInformation("memstat"sv)
 {
 }
+UNMAP_AFTER_INIT ProcFSSlabInfo::ProcFSSlabInfo()
+    : ProcFSGlobalInformation("slabinfo"sv)
+{
+}
 UNMAP_AFTER_INIT ProcFSOverallProcesses::ProcFSOverallProcesses()
     : ProcFSGlobalInformation("all"sv)
 {
@@ -837,6 +1001,10 @@ UNMAP_AFTER_INIT ProcFSUptime::ProcFSUptime()
     : ProcFSGlobalInformation("uptime"sv)
 {
 }
+UNMAP_AFTER_INIT ProcFSSchedulingLatency::ProcFSSchedulingLatency()
+    : ProcFSGlobalInformation("scheduling_latency"sv)
+{
+}
 UNMAP_AFTER_INIT ProcFSCommandLine::ProcFSCommandLine()
     : ProcFSGlobalInformation("cmdline"sv)
 {
@@ -849,6 +1017,10 @@ UNMAP_AFTER_INIT ProcFSProfile::ProcFSProfile()
     : ProcFSGlobalInformation("profile"sv)
 {
 }
+UNMAP_AFTER_INIT ProcFSTracepoints::ProcFSTracepoints()
+    : ProcFSGlobalInformation("tracepoints"sv)
+{
+}
 
 UNMAP_AFTER_INIT ProcFSKernelBase::ProcFSKernelBase()
     : ProcFSGlobalInformation("kernel_base"sv)
@@ -861,6 +1033,7 @@ UNMAP_AFTER_INIT NonnullRefPtr<ProcFSSystemDirectory> ProcFSSystemDirectory::mus
     directory->m_components.append(ProcFSDumpKmallocStacks::must_create(directory));
     directory->m_components.append(ProcFSUBSanDeadly::must_create(directory));
     directory->m_components.append(ProcFSCapsLockRemap::must_create(directory));
+    directory->m_components.append(ProcFSTracepointsEnabled::must_create(directory));
     return directory;
 }
 
@@ -875,6 +1048,7 @@ UNMAP_AFTER_INIT NonnullRefPtr<ProcFSRootDirectory> ProcFSRootDirectory::must_cr
     directory->m_components.append(ProcFSSelfProcessDirectory::must_create());
     directory->m_components.append(ProcFSDiskUsage::must_create());
     directory->m_components.append(ProcFSMemoryStatus::must_create());
+    directory->m_components.append(ProcFSSlabInfo::must_create());
     directory->m_components.append(ProcFSOverallProcesses::must_create());
     directory->m_components.append(ProcFSCPUInformation::must_create());
     directory->m_components.append(ProcFSDmesg::must_create());
@@ -883,9 +1057,11 @@ UNMAP_AFTER_INIT NonnullRefPtr<ProcFSRootDirectory> ProcFSRootDirectory::must_cr
     directory->m_components.append(ProcFSPCI::must_create());
     directory->m_components.append(ProcFSDevices::must_create());
     directory->m_components.append(ProcFSUptime::must_create());
+    directory->m_components.append(ProcFSSchedulingLatency::must_create());
     directory->m_components.append(ProcFSCommandLine::must_create());
     directory->m_components.append(ProcFSModules::must_create());
     directory->m_components.append(ProcFSProfile::must_create());
+    directory->m_components.append(ProcFSTracepoints::must_create());
     directory->m_components.append(ProcFSKernelBase::must_create());
 
     directory->m_components.append(ProcFSNetworkDirectory::must_create(*directory));
@@ -10,6 +10,22 @@
 
 namespace Kernel::Graphics::VirtIOGPU {
 
+static Protocol::Rect united(Protocol::Rect const& a, Protocol::Rect const& b)
+{
+    if (a.width == 0 || a.height == 0)
+        return b;
+    if (b.width == 0 || b.height == 0)
+        return a;
+    auto left = min(a.x, b.x);
+    auto top = min(a.y, b.y);
+    return {
+        .x = left,
+        .y = top,
+        .width = max(a.x + a.width, b.x + b.width) - left,
+        .height = max(a.y + a.height, b.y + b.height) - top,
+    };
+}
+
 FrameBufferDevice::FrameBufferDevice(GPU& virtio_gpu, ScanoutID scanout)
     : BlockDevice(29, GraphicsManagement::the().allocate_minor_device_number())
     , m_gpu(virtio_gpu)
@@ -193,34 +209,50 @@ KResult FrameBufferDevice::ioctl(FileDescription&, unsigned request, Userspace<v
         if (m_are_writes_active && flush_rects.count > 0) {
             auto& buffer = buffer_from_index(flush_rects.buffer_index);
             MutexLocker locker(m_gpu.operation_lock());
-            for (unsigned i = 0; i < flush_rects.count; i++) {
+
+            auto read_dirty_rect = [&](unsigned index) -> Optional<Protocol::Rect> {
                 FBRect user_dirty_rect;
-                if (!copy_from_user(&user_dirty_rect, &flush_rects.rects[i]))
-                    return EFAULT;
-                Protocol::Rect dirty_rect {
+                if (!copy_from_user(&user_dirty_rect, &flush_rects.rects[index]))
+                    return {};
+                return Protocol::Rect {
                     .x = user_dirty_rect.x,
                     .y = user_dirty_rect.y,
                     .width = user_dirty_rect.width,
                     .height = user_dirty_rect.height
                 };
-                transfer_framebuffer_data_to_host(dirty_rect, buffer);
-                if (&buffer == m_current_buffer) {
-                    // Flushing directly to screen
-                    flush_displayed_image(dirty_rect, buffer);
-                    buffer.dirty_rect = {};
-                } else {
-                    if (buffer.dirty_rect.width == 0 || buffer.dirty_rect.height == 0) {
-                        buffer.dirty_rect = dirty_rect;
-                    } else {
-                        auto current_dirty_right = buffer.dirty_rect.x + buffer.dirty_rect.width;
-                        auto current_dirty_bottom = buffer.dirty_rect.y + buffer.dirty_rect.height;
-                        buffer.dirty_rect.x = min(buffer.dirty_rect.x, dirty_rect.x);
-                        buffer.dirty_rect.y = min(buffer.dirty_rect.y, dirty_rect.y);
-                        buffer.dirty_rect.width = max(current_dirty_right, dirty_rect.x + dirty_rect.width) - buffer.dirty_rect.x;
-                        buffer.dirty_rect.height = max(current_dirty_bottom, dirty_rect.y + dirty_rect.height) - buffer.dirty_rect.y;
-                    }
+            };
+
+            Protocol::Rect bounding_rect {};
+            u64 total_area = 0;
+            for (unsigned i = 0; i < flush_rects.count; i++) {
+                auto dirty_rect = read_dirty_rect(i);
+                if (!dirty_rect.has_value())
+                    return EFAULT;
+                total_area += (u64)dirty_rect->width * dirty_rect->height;
+                bounding_rect = united(bounding_rect, *dirty_rect);
+            }
+
+            // Every command has the host stop the VM and then wait for us to see its response, which costs a lot
+            // more than the host copying some pixels that didn't change. Unless the rects are far apart, one
+            // transfer of the area that covers all of them is cheaper than a transfer for each of them.
+            if (flush_rects.count == 1 || (u64)bounding_rect.width * bounding_rect.height <= 2 * total_area) {
+                transfer_framebuffer_data_to_host(bounding_rect, buffer);
+            } else {
+                for (unsigned i = 0; i < flush_rects.count; i++) {
+                    auto dirty_rect = read_dirty_rect(i);
+                    if (!dirty_rect.has_value())
+                        return EFAULT;
+                    transfer_framebuffer_data_to_host(*dirty_rect, buffer);
                 }
             }
+
+            if (&buffer == m_current_buffer) {
+                // Flushing directly to screen
+                flush_displayed_image(bounding_rect, buffer);
+                buffer.dirty_rect = {};
+            } else {
+                buffer.dirty_rect = united(buffer.dirty_rect, bounding_rect);
+            }
         }
         return KSuccess;
     }
@@ -55,6 +55,14 @@ public:
     }
     ~Heap() = default;
 
+    // How many chunks an allocation of `size` bytes takes up, including its header.
+    static constexpr size_t chunks_for_size(size_t size) { return (size + sizeof(AllocationHeader) + CHUNK_SIZE - 1) / CHUNK_SIZE; }
+    static constexpr size_t usable_size_for_chunks(size_t chunks) { return chunks * CHUNK_SIZE - sizeof(AllocationHeader); }
+    static size_t allocation_size_in_chunks(const void* ptr)
+    {
+        return ((const AllocationHeader*)((const u8*)ptr - sizeof(AllocationHeader)))->allocation_size_in_chunks;
+    }
+
     static size_t calculate_memory_for_bytes(size_t bytes)
     {
         size_t needed_chunks = (sizeof(AllocationHeader) + bytes + CHUNK_SIZE - 1) / CHUNK_SIZE;
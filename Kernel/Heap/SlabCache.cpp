@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Memory.h>
+#include <Kernel/Arch/x86/InterruptDisabler.h>
+#include <Kernel/Arch/x86/Processor.h>
+#include <Kernel/Heap/SlabAllocator.h>
+#include <Kernel/Heap/SlabCache.h>
+#include <Kernel/Heap/kmalloc.h>
+
+#define SANITIZE_SLABS
+
+namespace Kernel {
+
+// FIXME: Make this grow as needed, it only has to be larger than the number of types that have a cache.
+static constexpr size_t max_slab_caches = 32;
+static constexpr size_t magazine_capacity = 16;
+static constexpr size_t minimum_objects_per_slab = 8;
+static constexpr size_t minimum_slab_size = 4 * KiB;
+
+static SlabCache* s_slab_caches[max_slab_caches];
+static Atomic<size_t> s_slab_cache_count;
+
+struct SlabCacheMagazines {
+    static ProcessorSpecificDataID processor_specific_data_id() { return ProcessorSpecificDataID::SlabCacheMagazines; }
+
+    struct Magazine {
+        size_t count { 0 };
+        void* objects[magazine_capacity];
+    };
+    Magazine magazines[max_slab_caches];
+};
+
+// Has to be called with interrupts disabled, so that we stay on this processor and nobody else uses its magazines.
+static SlabCacheMagazines::Magazine* current_magazine(size_t index)
+{
+    if (!Processor::is_initialized())
+        return nullptr;
+    auto* magazines = Processor::current().get_specific<SlabCacheMagazines>();
+    if (!magazines)
+        return nullptr;
+    return &magazines->magazines[index];
+}
+
+SlabCache::SlabCache(StringView name, size_t object_size, size_t object_alignment)
+    : m_name(name)
+    , m_object_size(object_size)
+    , m_alignment(max(object_alignment, alignof(FreeObject)))
+{
+    m_stride = round_up_to_power_of_two(max(object_size, sizeof(FreeObject)), m_alignment);
+    m_objects_per_slab = max(minimum_objects_per_slab, (minimum_slab_size - sizeof(Slab)) / m_stride);
+    // There's room for aligning the first object, kmalloc doesn't know about the alignment we need.
+    m_slab_size = sizeof(Slab) + m_alignment + m_objects_per_slab * m_stride;
+
+    m_index = s_slab_cache_count.fetch_add(1);
+    VERIFY(m_index < max_slab_caches);
+    s_slab_caches[m_index] = this;
+}
+
+void SlabCache::enable_processor_magazines()
+{
+    ProcessorSpecific<SlabCacheMagazines>::initialize();
+}
+
+void SlabCache::for_each(Function<void(const SlabCache&)> callback)
+{
+    auto count = min(s_slab_cache_count.load(), max_slab_caches);
+    for (size_t i = 0; i < count; ++i)
+        callback(*s_slab_caches[i]);
+}
+
+bool SlabCache::grow()
+{
+    VERIFY(!m_lock.is_locked());
+    auto* memory = (u8*)kmalloc(m_slab_size);
+    if (!memory)
+        return false;
+
+    auto* slab = (Slab*)memory;
+    FlatPtr first_object = round_up_to_power_of_two((FlatPtr)(slab + 1), m_alignment);
+
+    ScopedSpinLock lock(m_lock);
+    slab->next = m_slabs;
+    m_slabs = slab;
+    ++m_slab_count;
+    for (size_t i = m_objects_per_slab; i > 0; --i) {
+        auto* object = (FreeObject*)(first_object + (i - 1) * m_stride);
+        object->next = m_free_objects;
+        m_free_objects = object;
+    }
+    m_free_count += m_objects_per_slab;
+    return true;
+}
+
+void* SlabCache::take_free_object()
+{
+    VERIFY(m_lock.is_locked());
+    auto* object = m_free_objects;
+    if (!object)
+        return nullptr;
+    m_free_objects = object->next;
+    --m_free_count;
+    return object;
+}
+
+void SlabCache::put_free_object(void* ptr)
+{
+    VERIFY(m_lock.is_locked());
+    auto* object = (FreeObject*)ptr;
+    object->next = m_free_objects;
+    m_free_objects = object;
+    ++m_free_count;
+}
+
+void* SlabCache::allocate()
+{
+    void* ptr = nullptr;
+    {
+        InterruptDisabler disabler;
+        if (auto* magazine = current_magazine(m_index); magazine && magazine->count > 0) {
+            ptr = magazine->objects[--magazine->count];
+            --m_magazine_count;
+        }
+    }
+
+    while (!ptr) {
+        {
+            ScopedSpinLock lock(m_lock);
+            ptr = take_free_object();
+            if (ptr) {
+                // Fill up half of the magazine while we're here, so we don't have to come back for the next few.
+                if (auto* magazine = current_magazine(m_index)) {
+                    while (magazine->count < magazine_capacity / 2) {
+                        auto* object = take_free_object();
+                        if (!object)
+                            break;
+                        magazine->objects[magazine->count++] = object;
+                        ++m_magazine_count;
+                    }
+                }
+                break;
+            }
+        }
+        if (!grow())
+            return nullptr;
+    }
+
+#ifdef SANITIZE_SLABS
+    memset(ptr, SLAB_ALLOC_SCRUB_BYTE, m_object_size);
+#endif
+    return ptr;
+}
+
+void SlabCache::deallocate(void* ptr)
+{
+    VERIFY(ptr);
+#ifdef SANITIZE_SLABS
+    memset(ptr, SLAB_DEALLOC_SCRUB_BYTE, m_object_size);
+#endif
+
+    {
+        InterruptDisabler disabler;
+        if (auto* magazine = current_magazine(m_index); magazine && magazine->count < magazine_capacity) {
+            magazine->objects[magazine->count++] = ptr;
+            ++m_magazine_count;
+            return;
+        }
+    }
+
+    ScopedSpinLock lock(m_lock);
+    // Give back half of a full magazine, so that the next few objects freed on this processor stay here again.
+    if (auto* magazine = current_magazine(m_index)) {
+        while (magazine->count > magazine_capacity / 2) {
+            put_free_object(magazine->objects[--magazine->count]);
+            --m_magazine_count;
+        }
+    }
+    put_free_object(ptr);
+}
+
+SlabCache::Stats SlabCache::stats() const
+{
+    ScopedSpinLock lock(m_lock);
+    Stats stats;
+    stats.object_size = m_object_size;
+    stats.slab_size = m_slab_size;
+    stats.slab_count = m_slab_count;
+    stats.object_count = m_slab_count * m_objects_per_slab;
+    stats.magazine_count = m_magazine_count;
+    stats.allocated_count = stats.object_count - min(stats.object_count, m_free_count + stats.magazine_count);
+    return stats;
+}
+
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Function.h>
+#include <AK/StringView.h>
+#include <AK/Types.h>
+#include <Kernel/SpinLock.h>
+
+namespace Kernel {
+
+// A pool for the objects of one type. They are carved out of slabs that are allocated from kmalloc as
+// needed, and freed objects are kept in a small magazine on each processor first, so that allocating and
+// freeing them usually doesn't have to take the lock of the cache.
+class SlabCache {
+    AK_MAKE_NONCOPYABLE(SlabCache);
+    AK_MAKE_NONMOVABLE(SlabCache);
+
+public:
+    SlabCache(StringView name, size_t object_size, size_t object_alignment);
+
+    StringView name() const { return m_name; }
+    size_t object_size() const { return m_object_size; }
+
+    // Returns nullptr if we're out of memory.
+    void* allocate();
+    void deallocate(void*);
+
+    struct Stats {
+        size_t object_size { 0 };
+        size_t slab_size { 0 };
+        size_t slab_count { 0 };
+        // Every object in every slab, whether it is allocated or not.
+        size_t object_count { 0 };
+        size_t allocated_count { 0 };
+        size_t magazine_count { 0 };
+    };
+    Stats stats() const;
+
+    static void for_each(Function<void(const SlabCache&)>);
+    // Has to be called once on every processor, until then all objects come straight from the slabs.
+    static void enable_processor_magazines();
+
+private:
+    struct FreeObject {
+        FreeObject* next;
+    };
+    struct Slab {
+        Slab* next;
+    };
+
+    bool grow();
+    void* take_free_object();
+    void put_free_object(void*);
+
+    StringView m_name;
+    size_t m_object_size { 0 };
+    size_t m_stride { 0 };
+    size_t m_alignment { 0 };
+    size_t m_objects_per_slab { 0 };
+    size_t m_slab_size { 0 };
+    size_t m_index { 0 };
+
+    mutable SpinLock<u8> m_lock;
+    Slab* m_slabs { nullptr };
+    FreeObject* m_free_objects { nullptr };
+    size_t m_slab_count { 0 };
+    size_t m_free_count { 0 };
+    Atomic<size_t, AK::MemoryOrder::memory_order_relaxed> m_magazine_count { 0 };
+};
+
+#define MAKE_SLAB_CACHED(type)                                                          \
+public:                                                                                 \
+    [[nodiscard]] void* operator new(size_t size)                                       \
+    {                                                                                   \
+        VERIFY(size == sizeof(type));                                                   \
+        void* ptr = s_slab_cache.allocate();                                            \
+        VERIFY(ptr);                                                                    \
+        return ptr;                                                                     \
+    }                                                                                   \
+    [[nodiscard]] void* operator new(size_t size, const std::nothrow_t&) noexcept       \
+    {                                                                                   \
+        VERIFY(size == sizeof(type));                                                   \
+        return s_slab_cache.allocate();                                                 \
+    }                                                                                   \
+    void operator delete(void* ptr) noexcept                                            \
+    {                                                                                   \
+        if (!ptr)                                                                       \
+            return;                                                                     \
+        s_slab_cache.deallocate(ptr);                                                   \
+    }                                                                                   \
+                                                                                        \
+private:                                                                                \
+    static SlabCache s_slab_cache;
+
+// Goes into the .cpp file of a type that uses MAKE_SLAB_CACHED.
+#define DEFINE_SLAB_CACHE(type) \
+    SlabCache type::s_slab_cache { #type, sizeof(type), alignof(type) }
+
+}
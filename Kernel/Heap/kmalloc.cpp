@@ -10,8 +10,10 @@
  */
 
 #include <AK/Assertions.h>
+#include <AK/Atomic.h>
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/Types.h>
+#include <Kernel/Arch/x86/InterruptDisabler.h>
 #include <Kernel/Debug.h>
 #include <Kernel/Heap/Heap.h>
 #include <Kernel/Heap/kmalloc.h>
@@ -182,6 +184,38 @@ struct KmallocGlobalHeap {
     }
 };
 
+using KmallocSubheap = KmallocGlobalHeap::HeapType::HeapType;
+
+// Small allocations are taken from, and given back to, a cache on each processor, so that most of them
+// don't have to take the global lock. The blocks in a cache are still allocated in the global heap, and
+// blocks of the cached sizes go back there if the cache is full already.
+static constexpr size_t kmalloc_cache_size_classes_in_chunks[] = { 1, 2, 3, 4, 6, 8, 12, 16 };
+static constexpr size_t kmalloc_cache_size_class_count = sizeof(kmalloc_cache_size_classes_in_chunks) / sizeof(size_t);
+static constexpr size_t kmalloc_cache_max_chunks = kmalloc_cache_size_classes_in_chunks[kmalloc_cache_size_class_count - 1];
+static constexpr size_t kmalloc_cache_max_blocks_per_size_class = 64;
+
+struct KmallocProcessorCache {
+    static Kernel::ProcessorSpecificDataID processor_specific_data_id() { return Kernel::ProcessorSpecificDataID::KmallocCache; }
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    struct SizeClass {
+        FreeBlock* free_blocks { nullptr };
+        size_t count { 0 };
+    };
+    SizeClass size_classes[kmalloc_cache_size_class_count];
+};
+
+static constexpr size_t kmalloc_cache_size_class_for_chunks(size_t chunks)
+{
+    for (size_t i = 0; i < kmalloc_cache_size_class_count; ++i) {
+        if (kmalloc_cache_size_classes_in_chunks[i] >= chunks)
+            return i;
+    }
+    VERIFY_NOT_REACHED();
+}
+
 READONLY_AFTER_INIT static KmallocGlobalHeap* g_kmalloc_global;
 alignas(KmallocGlobalHeap) static u8 g_kmalloc_global_heap[sizeof(KmallocGlobalHeap)];
 
@@ -190,8 +224,9 @@ __attribute__((section(".heap"))) static u8 kmalloc_eternal_heap[ETERNAL_RANGE_S
 __attribute__((section(".heap"))) static u8 kmalloc_pool_heap[POOL_SIZE];
 
 static size_t g_kmalloc_bytes_eternal = 0;
-static size_t g_kmalloc_call_count;
-static size_t g_kfree_call_count;
+static Atomic<size_t, AK::MemoryOrder::memory_order_relaxed> g_kmalloc_call_count;
+static Atomic<size_t, AK::MemoryOrder::memory_order_relaxed> g_kfree_call_count;
+static Atomic<size_t, AK::MemoryOrder::memory_order_relaxed> g_kmalloc_bytes_cached;
 static size_t g_nested_kfree_calls;
 bool g_dump_kmalloc_stacks;
 
@@ -208,6 +243,69 @@ void kmalloc_enable_expand()
     g_kmalloc_global->allocate_backup_memory();
 }
 
+void kmalloc_enable_processor_cache()
+{
+    Kernel::ProcessorSpecific<KmallocProcessorCache>::initialize();
+}
+
+// Has to be called with interrupts disabled, so that we stay on this processor and nobody else uses its cache.
+static KmallocProcessorCache* current_kmalloc_cache()
+{
+    if (!Kernel::Processor::is_initialized())
+        return nullptr;
+    return Kernel::Processor::current().get_specific<KmallocProcessorCache>();
+}
+
+static void* kmalloc_from_processor_cache(size_t size_class_index)
+{
+    KmallocProcessorCache::FreeBlock* block;
+    {
+        Kernel::InterruptDisabler disabler;
+        auto* cache = current_kmalloc_cache();
+        if (!cache)
+            return nullptr;
+        auto& size_class = cache->size_classes[size_class_index];
+        block = size_class.free_blocks;
+        if (!block)
+            return nullptr;
+        size_class.free_blocks = block->next;
+        --size_class.count;
+        g_kmalloc_bytes_cached -= kmalloc_cache_size_classes_in_chunks[size_class_index] * CHUNK_SIZE;
+    }
+    auto chunks = kmalloc_cache_size_classes_in_chunks[size_class_index];
+    if constexpr (KMALLOC_SCRUB_BYTE != 0)
+        __builtin_memset(block, KMALLOC_SCRUB_BYTE, KmallocSubheap::usable_size_for_chunks(chunks));
+    return block;
+}
+
+static bool kfree_to_processor_cache(void* ptr)
+{
+    auto chunks = KmallocSubheap::allocation_size_in_chunks(ptr);
+    if (chunks > kmalloc_cache_max_chunks)
+        return false;
+    auto size_class_index = kmalloc_cache_size_class_for_chunks(chunks);
+    if (kmalloc_cache_size_classes_in_chunks[size_class_index] != chunks)
+        return false;
+
+    if constexpr (KFREE_SCRUB_BYTE != 0)
+        __builtin_memset(ptr, KFREE_SCRUB_BYTE, KmallocSubheap::usable_size_for_chunks(chunks));
+    auto* block = (KmallocProcessorCache::FreeBlock*)ptr;
+    {
+        Kernel::InterruptDisabler disabler;
+        auto* cache = current_kmalloc_cache();
+        if (!cache)
+            return false;
+        auto& size_class = cache->size_classes[size_class_index];
+        if (size_class.count == kmalloc_cache_max_blocks_per_size_class)
+            return false;
+        block->next = size_class.free_blocks;
+        size_class.free_blocks = block;
+        ++size_class.count;
+        g_kmalloc_bytes_cached += chunks * CHUNK_SIZE;
+    }
+    return true;
+}
+
 static inline void kmalloc_verify_nospinlock_held()
 {
     // Catch bad callers allocating under spinlock.
@@ -246,17 +344,29 @@ void* kmalloc_eternal(size_t size)
 void* kmalloc(size_t size)
 {
     kmalloc_verify_nospinlock_held();
-    ScopedSpinLock lock(s_lock);
     ++g_kmalloc_call_count;
 
-    if (g_dump_kmalloc_stacks && Kernel::g_kernel_symbols_available) {
-        dbgln("kmalloc({})", size);
-        Kernel::dump_backtrace();
+    void* ptr = nullptr;
+    size_t allocation_size = size;
+    if (auto chunks = KmallocSubheap::chunks_for_size(size); chunks <= kmalloc_cache_max_chunks && !g_dump_kmalloc_stacks) {
+        auto size_class_index = kmalloc_cache_size_class_for_chunks(chunks);
+        ptr = kmalloc_from_processor_cache(size_class_index);
+        // Whatever we get from the global heap instead should fit into the cache once it's freed.
+        allocation_size = KmallocSubheap::usable_size_for_chunks(kmalloc_cache_size_classes_in_chunks[size_class_index]);
     }
 
-    void* ptr = g_kmalloc_global->m_heap.allocate(size);
     if (!ptr) {
-        PANIC("kmalloc: Out of memory (requested size: {})", size);
+        ScopedSpinLock lock(s_lock);
+
+        if (g_dump_kmalloc_stacks && Kernel::g_kernel_symbols_available) {
+            dbgln("kmalloc({})", size);
+            Kernel::dump_backtrace();
+        }
+
+        ptr = g_kmalloc_global->m_heap.allocate(allocation_size);
+        if (!ptr) {
+            PANIC("kmalloc: Out of memory (requested size: {})", size);
+        }
     }
 
     Thread* current_thread = Thread::current();
@@ -280,8 +390,18 @@ void kfree(void* ptr)
         return;
 
     kmalloc_verify_nospinlock_held();
-    ScopedSpinLock lock(s_lock);
     ++g_kfree_call_count;
+
+    if (kfree_to_processor_cache(ptr)) {
+        Thread* current_thread = Thread::current();
+        if (!current_thread)
+            current_thread = Processor::idle_thread();
+        if (current_thread)
+            PerformanceManager::add_kfree_perf_event(*current_thread, 0, (FlatPtr)ptr);
+        return;
+    }
+
+    ScopedSpinLock lock(s_lock);
     ++g_nested_kfree_calls;
 
     if (g_nested_kfree_calls == 1) {
@@ -298,7 +418,10 @@ void kfree(void* ptr)
 
 size_t kmalloc_good_size(size_t size)
 {
-    return size;
+    auto chunks = KmallocSubheap::chunks_for_size(size);
+    if (chunks > kmalloc_cache_max_chunks)
+        return size;
+    return KmallocSubheap::usable_size_for_chunks(kmalloc_cache_size_classes_in_chunks[kmalloc_cache_size_class_for_chunks(chunks)]);
 }
 
 [[gnu::malloc, gnu::alloc_size(1), gnu::alloc_align(2)]] static void* kmalloc_aligned_cxx(size_t size, size_t alignment)
@@ -377,8 +500,10 @@ void operator delete[](void* ptr, size_t size) noexcept
 void get_kmalloc_stats(kmalloc_stats& stats)
 {
     ScopedSpinLock lock(s_lock);
-    stats.bytes_allocated = g_kmalloc_global->m_heap.allocated_bytes();
-    stats.bytes_free = g_kmalloc_global->m_heap.free_bytes() + g_kmalloc_global->backup_memory_bytes();
+    // What's sitting in the processor caches is free as far as anyone else is concerned.
+    size_t bytes_cached = g_kmalloc_bytes_cached;
+    stats.bytes_allocated = g_kmalloc_global->m_heap.allocated_bytes() - min(bytes_cached, g_kmalloc_global->m_heap.allocated_bytes());
+    stats.bytes_free = g_kmalloc_global->m_heap.free_bytes() + g_kmalloc_global->backup_memory_bytes() + bytes_cached;
     stats.bytes_eternal = g_kmalloc_bytes_eternal;
     stats.kmalloc_call_count = g_kmalloc_call_count;
     stats.kfree_call_count = g_kfree_call_count;
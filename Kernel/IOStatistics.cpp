@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/JsonArraySerializer.h>
+#include <AK/JsonObjectSerializer.h>
+#include <Kernel/Devices/BlockDevice.h>
+#include <Kernel/FileSystem/FileBackedFileSystem.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/FileSystem/SysFS.h>
+#include <Kernel/FileSystem/SysFSComponent.h>
+#include <Kernel/FileSystem/VirtualFileSystem.h>
+#include <Kernel/IOStatistics.h>
+#include <Kernel/KBufferBuilder.h>
+#include <Kernel/Sections.h>
+#include <Kernel/Time/TimeManagement.h>
+
+namespace Kernel {
+
+Time IOStatistics::did_start()
+{
+    auto depth = ++m_queue_depth;
+    auto max_depth = m_max_queue_depth.load();
+    while (depth > max_depth && !m_max_queue_depth.compare_exchange_strong(max_depth, depth))
+        ;
+    return TimeManagement::the().monotonic_time(TimePrecision::Precise);
+}
+
+void IOStatistics::did_finish(Direction direction, Time start_time, size_t byte_count, bool success)
+{
+    auto latency_us = (TimeManagement::the().monotonic_time(TimePrecision::Precise) - start_time).to_microseconds();
+    if (latency_us < 0)
+        latency_us = 0;
+
+    size_t bucket = 0;
+    while (bucket < latency_bucket_count - 1 && latency_us >= (first_latency_bucket_bound_us << bucket))
+        ++bucket;
+
+    auto& counters = direction == Direction::Read ? m_reads : m_writes;
+    ++counters.operation_count;
+    counters.byte_count += byte_count;
+    if (!success)
+        ++counters.error_count;
+    counters.total_latency_us += static_cast<u64>(latency_us);
+    ++counters.latency_histogram[bucket];
+    --m_queue_depth;
+}
+
+void IOStatistics::did_cancel()
+{
+    --m_queue_depth;
+}
+
+template<typename Serializer>
+static void serialize_file_systems(Serializer& array)
+{
+    VirtualFileSystem::the().for_each_mount([&array](auto& mount) {
+        auto& fs = mount.guest_fs();
+        auto fs_object = array.add_object();
+        fs_object.add("fsid", fs.fsid());
+        fs_object.add("class_name", fs.class_name());
+        fs_object.add("mount_point", mount.absolute_path());
+        if (fs.is_file_backed())
+            fs_object.add("source", static_cast<const FileBackedFileSystem&>(fs).file_description().absolute_path());
+        else
+            fs_object.add("source", "none");
+        fs.io_statistics().serialize(fs_object);
+    });
+}
+
+template<typename Serializer>
+static void serialize_block_devices(Serializer& array)
+{
+    Device::for_each([&array](auto& device) {
+        if (!device.is_block_device())
+            return;
+        auto& block_device = static_cast<const BlockDevice&>(device);
+        auto device_object = array.add_object();
+        device_object.add("device_name", block_device.device_name());
+        device_object.add("major", block_device.major());
+        device_object.add("minor", block_device.minor());
+        device_object.add("block_size", block_device.block_size());
+        block_device.io_statistics().serialize(device_object);
+    });
+}
+
+class IOStatisticsSysFSComponent final : public SysFSComponent {
+public:
+    enum class Type {
+        FileSystems,
+        BlockDevices,
+    };
+
+    static NonnullRefPtr<IOStatisticsSysFSComponent> must_create(StringView name, Type type)
+    {
+        return adopt_ref(*new (nothrow) IOStatisticsSysFSComponent(name, type));
+    }
+
+    virtual KResultOr<size_t> read_bytes(off_t offset, size_t count, UserOrKernelBuffer& buffer, FileDescription*) const override
+    {
+        KBufferBuilder builder;
+        {
+            JsonArraySerializer array { builder };
+            if (m_type == Type::FileSystems)
+                serialize_file_systems(array);
+            else
+                serialize_block_devices(array);
+        }
+        auto data = builder.build();
+        if (!data)
+            return ENOMEM;
+        if (static_cast<size_t>(offset) >= data->size())
+            return 0;
+        auto nread = min(static_cast<size_t>(data->size() - offset), count);
+        if (!buffer.write(data->data() + offset, nread))
+            return EFAULT;
+        return nread;
+    }
+
+private:
+    IOStatisticsSysFSComponent(StringView name, Type type)
+        : SysFSComponent(name)
+        , m_type(type)
+    {
+    }
+
+    Type m_type;
+};
+
+class IOStatisticsSysFSDirectory final : public SysFSDirectory {
+public:
+    static NonnullRefPtr<IOStatisticsSysFSDirectory> must_create()
+    {
+        return adopt_ref(*new (nothrow) IOStatisticsSysFSDirectory);
+    }
+
+private:
+    IOStatisticsSysFSDirectory()
+        : SysFSDirectory("io_statistics", SysFSComponentRegistry::the().root_directory())
+    {
+        m_components.append(IOStatisticsSysFSComponent::must_create("file_systems"sv, IOStatisticsSysFSComponent::Type::FileSystems));
+        m_components.append(IOStatisticsSysFSComponent::must_create("block_devices"sv, IOStatisticsSysFSComponent::Type::BlockDevices));
+    }
+};
+
+UNMAP_AFTER_INIT void IOStatistics::initialize_sysfs_directory()
+{
+    SysFSComponentRegistry::the().register_new_component(IOStatisticsSysFSDirectory::must_create());
+}
+
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/Atomic.h>
+#include <AK/StringView.h>
+#include <AK/Time.h>
+
+namespace Kernel {
+
+// Counters for the I/O going to a file system's backing device or through a block device.
+// Everything is updated with relaxed atomics, so it's safe to account from IRQ context.
+class IOStatistics {
+public:
+    enum class Direction {
+        Read,
+        Write,
+    };
+
+    // Bucket i counts the operations that took less than 16us << i, the last one everything slower.
+    static constexpr size_t latency_bucket_count = 18;
+    static constexpr i64 first_latency_bucket_bound_us = 16;
+
+    // Returns the time to pass to did_finish() or did_cancel() once the operation is over.
+    Time did_start();
+    void did_finish(Direction, Time start_time, size_t byte_count, bool success);
+    // For operations that never made it to the device.
+    void did_cancel();
+
+    // Exposes the statistics of all mounted file systems and all block devices in /sys/io_statistics.
+    static void initialize_sysfs_directory();
+
+    template<typename Serializer>
+    void serialize(Serializer& object) const
+    {
+        object.add("queue_depth", m_queue_depth.load());
+        object.add("max_queue_depth", m_max_queue_depth.load());
+        serialize_counters(object, "read"sv, m_reads);
+        serialize_counters(object, "write"sv, m_writes);
+    }
+
+private:
+    struct Counters {
+        Atomic<u64, AK::MemoryOrder::memory_order_relaxed> operation_count { 0 };
+        Atomic<u64, AK::MemoryOrder::memory_order_relaxed> byte_count { 0 };
+        Atomic<u64, AK::MemoryOrder::memory_order_relaxed> error_count { 0 };
+        Atomic<u64, AK::MemoryOrder::memory_order_relaxed> total_latency_us { 0 };
+        Array<Atomic<u64, AK::MemoryOrder::memory_order_relaxed>, latency_bucket_count> latency_histogram {};
+    };
+
+    template<typename Serializer>
+    static void serialize_counters(Serializer& object, StringView name, Counters const& counters)
+    {
+        auto counters_object = object.add_object(name);
+        counters_object.add("operations", counters.operation_count.load());
+        counters_object.add("bytes", counters.byte_count.load());
+        counters_object.add("errors", counters.error_count.load());
+        counters_object.add("total_latency_us", counters.total_latency_us.load());
+        auto histogram = counters_object.add_array("latency_histogram");
+        for (auto& bucket : counters.latency_histogram)
+            histogram.add(bucket.load());
+    }
+
+    Atomic<u32, AK::MemoryOrder::memory_order_relaxed> m_queue_depth { 0 };
+    Atomic<u32, AK::MemoryOrder::memory_order_relaxed> m_max_queue_depth { 0 };
+    Counters m_reads;
+    Counters m_writes;
+};
+
+}
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/Types.h>
 #include <Kernel/Time/HardwareTimer.h>
 #include <Kernel/VM/MemoryManager.h>
@@ -34,6 +35,9 @@ public:
     static u8 spurious_interrupt_vector();
     Thread* get_idle_thread(u32 cpu) const;
     u32 enabled_processor_count() const { return m_processor_enabled_cnt; }
+    u8 physical_apic_id(u32 cpu) const { return m_physical_apic_ids[cpu]; }
+    // What message signalled interrupts have to be addressed to, to be delivered with fixed delivery to this processor.
+    u32 message_signalled_interrupt_address(u32 cpu) const { return 0xfee00000 | ((u32)physical_apic_id(cpu) << 12); }
 
     APICTimer* initialize_timers(HardwareTimerBase&);
     APICTimer* get_timer() const { return m_apic_timer; }
@@ -45,6 +49,7 @@ public:
     void setup_local_timer(u32, TimerMode, bool);
     u32 get_timer_current_count();
     u32 get_timer_divisor();
+    void unmask_performance_counter_interrupt();
 
 private:
     class ICRReg {
@@ -96,6 +101,7 @@ private:
     Atomic<u8> m_apic_ap_continue { 0 };
     u32 m_processor_cnt { 0 };
     u32 m_processor_enabled_cnt { 0 };
+    Array<u8, 8> m_physical_apic_ids {};
     APICTimer* m_apic_timer { nullptr };
 
     static PhysicalAddress get_base();
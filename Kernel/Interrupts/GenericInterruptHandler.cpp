@@ -68,4 +68,15 @@ void GenericInterruptHandler::change_interrupt_number(u8 number)
     register_generic_interrupt_handler(InterruptManagement::acquire_mapped_interrupt_number(interrupt_number()), *this);
 }
 
+void GenericInterruptHandler::change_to_unmapped_interrupt_number(u8 number)
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    bool was_registered = m_registered;
+    unregister_interrupt_handler();
+    m_interrupt_number = number;
+    m_disable_remap = true;
+    if (was_registered)
+        register_interrupt_handler();
+}
+
 }
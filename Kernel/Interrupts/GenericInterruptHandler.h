@@ -48,6 +48,9 @@ public:
     virtual StringView controller() const = 0;
 
     virtual bool eoi() = 0;
+
+    // Whether the interrupt has to stay on the processor it's routed to, like the ones that keep time.
+    virtual bool has_fixed_affinity() const { return false; }
     ALWAYS_INLINE void increment_invoking_counter()
     {
         m_invoking_count++;
@@ -55,6 +58,8 @@ public:
 
 protected:
     void change_interrupt_number(u8 number);
+    // Message signalled interrupts have interrupt numbers of their own that no IRQ line is mapped to.
+    void change_to_unmapped_interrupt_number(u8 number);
     GenericInterruptHandler(u8 interrupt_number, bool disable_remap = false);
 
     void disable_remap() { m_disable_remap = true; }
@@ -42,6 +42,7 @@ public:
     IOAPIC(PhysicalAddress, u32 gsi_base);
     virtual void enable(const GenericInterruptHandler&) override;
     virtual void disable(const GenericInterruptHandler&) override;
+    virtual bool set_affinity(const GenericInterruptHandler&, u32 processor) override;
     virtual void hard_disable() override;
     virtual void eoi(const GenericInterruptHandler&) const override;
     virtual void spurious_eoi(const GenericInterruptHandler&) const override;
@@ -23,6 +23,8 @@ public:
 
     virtual void enable(const GenericInterruptHandler&) = 0;
     virtual void disable(const GenericInterruptHandler&) = 0;
+    // Routes the interrupt to the given processor, returns false if this controller can't do that.
+    virtual bool set_affinity(const GenericInterruptHandler&, u32) { return false; }
     virtual void hard_disable() { m_hard_disabled = true; }
     virtual bool is_vector_enabled(u8 number) const = 0;
     virtual bool is_enabled() const = 0;
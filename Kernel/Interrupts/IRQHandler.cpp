@@ -5,7 +5,9 @@
  */
 
 #include <Kernel/Arch/x86/InterruptDisabler.h>
+#include <Kernel/Bus/PCI/MSIXTable.h>
 #include <Kernel/Debug.h>
+#include <Kernel/Interrupts/APIC.h>
 #include <Kernel/Interrupts/IRQHandler.h>
 #include <Kernel/Interrupts/InterruptManagement.h>
 
@@ -25,6 +27,10 @@ IRQHandler::~IRQHandler()
 bool IRQHandler::eoi()
 {
     dbgln_if(IRQ_DEBUG, "EOI IRQ {}", interrupt_number());
+    if (m_message_signalled) {
+        APIC::the().eoi();
+        return true;
+    }
     if (!m_shared_with_others) {
         VERIFY(!m_responsible_irq_controller.is_null());
         m_responsible_irq_controller->eoi(*this);
@@ -39,7 +45,7 @@ void IRQHandler::enable_irq()
     if (!is_registered())
         register_interrupt_handler();
     m_enabled = true;
-    if (!m_shared_with_others)
+    if (!m_shared_with_others && !m_message_signalled)
         m_responsible_irq_controller->enable(*this);
 }
 
@@ -47,15 +53,52 @@ void IRQHandler::disable_irq()
 {
     dbgln_if(IRQ_DEBUG, "Disable IRQ {}", interrupt_number());
     m_enabled = false;
-    if (!m_shared_with_others)
+    if (!m_shared_with_others && !m_message_signalled)
         m_responsible_irq_controller->disable(*this);
 }
 
 void IRQHandler::change_irq_number(u8 irq)
 {
+    VERIFY(!m_message_signalled);
     InterruptDisabler disabler;
     change_interrupt_number(irq);
     m_responsible_irq_controller = InterruptManagement::the().get_responsible_irq_controller(irq);
 }
 
+bool IRQHandler::try_to_enable_message_signalled_interrupts(PCI::Address address, Optional<u32> processor)
+{
+    VERIFY(!m_message_signalled);
+    if (!APIC::initialized())
+        return false;
+    // Plain MSI is preferred, since some devices need more than their MSI-X table to be set up to use their vectors.
+    OwnPtr<PCI::MSIXTable> msix_table;
+    bool use_msi = PCI::has_capability(address, PCI_CAPABILITY_MSI);
+    if (!use_msi && PCI::has_capability(address, PCI_CAPABILITY_MSIX))
+        msix_table = PCI::MSIXTable::try_create(address);
+    if (!use_msi && !msix_table)
+        return false;
+    auto interrupt_number = InterruptManagement::allocate_message_signalled_interrupt_number();
+    if (!interrupt_number.has_value())
+        return false;
+    auto target_processor = processor.has_value() ? processor.value() : InterruptManagement::next_message_signalled_interrupt_processor();
+
+    {
+        InterruptDisabler disabler;
+        // The IRQ line doesn't get disabled at its controller, the device just stops using it.
+        change_to_unmapped_interrupt_number(interrupt_number.value());
+        m_responsible_irq_controller = nullptr;
+        m_message_signalled = true;
+        // The interrupt number is ours once something is registered to it, and the device may interrupt as soon as it's set up.
+        register_interrupt_handler();
+    }
+    if (msix_table) {
+        msix_table->set_entry(0, interrupt_number.value(), target_processor);
+        PCI::enable_extended_message_signalled_interrupts(address);
+    } else {
+        PCI::enable_message_signalled_interrupt(address, interrupt_number.value(), target_processor);
+    }
+    dbgln_if(IRQ_DEBUG, "{}: Using {} on interrupt number {} for processor {}", address, msix_table ? "MSI-X" : "MSI", interrupt_number.value(), target_processor);
+    return true;
+}
+
 }
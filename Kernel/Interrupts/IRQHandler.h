@@ -8,7 +8,9 @@
 
 #include <AK/RefPtr.h>
 #include <AK/String.h>
+#include <AK/Optional.h>
 #include <AK/Types.h>
+#include <Kernel/Bus/PCI/Definitions.h>
 #include <Kernel/Interrupts/GenericInterruptHandler.h>
 #include <Kernel/Interrupts/IRQController.h>
 
@@ -28,19 +30,27 @@ public:
 
     virtual HandlerType type() const override { return HandlerType::IRQHandler; }
     virtual StringView purpose() const override { return "IRQ Handler"; }
-    virtual StringView controller() const override { return m_responsible_irq_controller->model(); }
+    virtual StringView controller() const override { return m_message_signalled ? "MSI"sv : m_responsible_irq_controller->model(); }
 
     virtual size_t sharing_devices_count() const override { return 0; }
     virtual bool is_shared_handler() const override { return false; }
     virtual bool is_sharing_with_others() const override { return m_shared_with_others; }
 
+    bool is_message_signalled() const { return m_message_signalled; }
+
 protected:
     void change_irq_number(u8 irq);
     explicit IRQHandler(u8 irq);
 
+    // Moves the interrupt of the PCI device from its IRQ line to a message signalled one (MSI, or the first
+    // MSI-X vector), which isn't shared with anyone and goes straight to the given processor, or to the next
+    // one in line if none is given. Returns false and keeps the IRQ line if either the device or the system can't do that.
+    bool try_to_enable_message_signalled_interrupts(PCI::Address, Optional<u32> processor = {});
+
 private:
     bool m_shared_with_others { false };
     bool m_enabled { false };
+    bool m_message_signalled { false };
     RefPtr<IRQController> m_responsible_irq_controller;
 };
 
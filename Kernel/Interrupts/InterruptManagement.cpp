@@ -4,12 +4,18 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/JsonArraySerializer.h>
+#include <AK/JsonObjectSerializer.h>
+#include <AK/QuickSort.h>
 #include <Kernel/ACPI/MultiProcessorParser.h>
 #include <Kernel/API/Syscall.h>
 #include <Kernel/Arch/x86/InterruptDisabler.h>
 #include <Kernel/Arch/x86/Interrupts.h>
 #include <Kernel/CommandLine.h>
+#include <Kernel/Debug.h>
+#include <Kernel/FileSystem/SysFS.h>
 #include <Kernel/IO.h>
+#include <Kernel/KBufferBuilder.h>
 #include <Kernel/Interrupts/APIC.h>
 #include <Kernel/Interrupts/IOAPIC.h>
 #include <Kernel/Interrupts/InterruptManagement.h>
@@ -82,6 +88,89 @@ u8 InterruptManagement::acquire_irq_number(u8 mapped_interrupt_vector)
     return InterruptManagement::the().get_irq_vector(mapped_interrupt_vector);
 }
 
+// Interrupt vectors 0x90 up to the APIC's own ones at 0xfb, which keeps clear of the IRQ lines and the syscall vector.
+static constexpr u8 first_message_signalled_interrupt_number = 0x90 - IRQ_VECTOR_BASE;
+static constexpr u8 last_message_signalled_interrupt_number = 0xfa - IRQ_VECTOR_BASE;
+
+UNMAP_AFTER_INIT Optional<u8> InterruptManagement::allocate_message_signalled_interrupt_number()
+{
+    for (u8 interrupt_number = first_message_signalled_interrupt_number; interrupt_number <= last_message_signalled_interrupt_number; interrupt_number++) {
+        if (GenericInterruptHandler::from(interrupt_number).type() == HandlerType::UnhandledInterruptHandler)
+            return interrupt_number;
+    }
+    return {};
+}
+
+// Interrupts that the IOAPIC delivers and that we're allowed to move around.
+static bool is_movable_irq_handler(GenericInterruptHandler& handler)
+{
+    if (handler.type() != HandlerType::IRQHandler && handler.type() != HandlerType::SharedIRQHandler)
+        return false;
+    return handler.controller() == "IOAPIC"sv && !handler.has_fixed_affinity();
+}
+
+KResult InterruptManagement::set_irq_affinity(u8 irq, u32 processor)
+{
+    if (!APIC::initialized() || processor >= Processor::count())
+        return EINVAL;
+    if (irq >= GENERIC_INTERRUPT_HANDLERS_COUNT)
+        return EINVAL;
+    auto& handler = GenericInterruptHandler::from(acquire_mapped_interrupt_number(irq));
+    if (handler.type() == HandlerType::UnhandledInterruptHandler)
+        return ENOENT;
+    if (!is_movable_irq_handler(handler))
+        return ENOTSUP;
+
+    ScopedSpinLock lock(m_irq_affinity_lock);
+    if (!get_responsible_irq_controller(handler.interrupt_number())->set_affinity(handler, processor))
+        return ENOTSUP;
+    m_irq_affinity[irq] = processor;
+    dbgln_if(IRQ_DEBUG, "IRQ {} now goes to processor {}", irq, processor);
+    return KSuccess;
+}
+
+void InterruptManagement::balance_irqs()
+{
+    struct IRQLoad {
+        u8 irq;
+        u32 invocations;
+        u32 processor;
+    };
+    Vector<IRQLoad, 32> loads;
+    for (size_t index = 0; index < GENERIC_INTERRUPT_HANDLERS_COUNT; index++) {
+        auto& handler = GenericInterruptHandler::from(index);
+        if (!is_movable_irq_handler(handler))
+            continue;
+        u8 irq = handler.interrupt_number();
+        u32 invoking_count = handler.get_invoking_count();
+        loads.append({ irq, invoking_count - m_last_invoking_count[irq], irq_affinity(irq) });
+        m_last_invoking_count[irq] = invoking_count;
+    }
+    // Hand out the busiest IRQs first, each to whichever processor got the least interrupts so far.
+    // An IRQ only moves if that's actually better than where it is already.
+    quick_sort(loads, [](auto& a, auto& b) { return a.invocations > b.invocations; });
+    Vector<u64, 8> processor_loads;
+    processor_loads.resize(Processor::count());
+    for (auto& load : loads) {
+        if (load.invocations == 0)
+            continue;
+        u32 target = load.processor;
+        for (u32 processor = 0; processor < processor_loads.size(); processor++) {
+            if (processor_loads[processor] < processor_loads[target])
+                target = processor;
+        }
+        processor_loads[target] += load.invocations;
+        if (target != load.processor)
+            (void)set_irq_affinity(load.irq, target);
+    }
+}
+
+UNMAP_AFTER_INIT u32 InterruptManagement::next_message_signalled_interrupt_processor()
+{
+    static u32 s_next_processor = 0;
+    return s_next_processor++ % Processor::count();
+}
+
 u8 InterruptManagement::get_mapped_interrupt_vector(u8 original_irq)
 {
     // FIXME: For SMP configuration (with IOAPICs) use a better routing scheme to make redirections more efficient.
@@ -221,4 +310,132 @@ UNMAP_AFTER_INIT void InterruptManagement::locate_apic_data()
     }
 }
 
+class IRQAffinitySysFSComponent final : public SysFSComponent {
+public:
+    static NonnullRefPtr<IRQAffinitySysFSComponent> must_create()
+    {
+        return adopt_ref(*new (nothrow) IRQAffinitySysFSComponent);
+    }
+
+    virtual mode_t permissions() const override { return S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH; }
+
+    virtual KResultOr<size_t> read_bytes(off_t offset, size_t count, UserOrKernelBuffer& buffer, FileDescription*) const override
+    {
+        KBufferBuilder builder;
+        {
+            JsonArraySerializer array { builder };
+            for (size_t index = 0; index < GENERIC_INTERRUPT_HANDLERS_COUNT; index++) {
+                auto& handler = GenericInterruptHandler::from(index);
+                if (handler.type() != HandlerType::IRQHandler && handler.type() != HandlerType::SharedIRQHandler)
+                    continue;
+                if (handler.controller() != "IOAPIC"sv)
+                    continue;
+                auto object = array.add_object();
+                object.add("irq", handler.interrupt_number());
+                object.add("purpose", handler.purpose());
+                object.add("processor", InterruptManagement::the().irq_affinity(handler.interrupt_number()));
+                object.add("movable", !handler.has_fixed_affinity());
+                object.add("call_count", (unsigned)handler.get_invoking_count());
+            }
+        }
+        auto data = builder.build();
+        if (!data)
+            return ENOMEM;
+        if (static_cast<size_t>(offset) >= data->size())
+            return 0;
+        auto nread = min(static_cast<size_t>(data->size() - offset), count);
+        if (!buffer.write(data->data() + offset, nread))
+            return EFAULT;
+        return nread;
+    }
+
+    // Takes "<irq> <processor>".
+    virtual KResultOr<size_t> write_bytes(off_t offset, size_t count, UserOrKernelBuffer const& buffer, FileDescription*) override
+    {
+        char value_buffer[32];
+        if (offset != 0 || count >= sizeof(value_buffer))
+            return EINVAL;
+        if (!buffer.read(value_buffer, count))
+            return EFAULT;
+        auto parts = StringView(value_buffer, count).trim_whitespace().split_view(' ');
+        if (parts.size() != 2)
+            return EINVAL;
+        auto irq = parts[0].to_uint();
+        auto processor = parts[1].to_uint();
+        if (!irq.has_value() || !processor.has_value() || irq.value() > NumericLimits<u8>::max())
+            return EINVAL;
+        if (auto result = InterruptManagement::the().set_irq_affinity(irq.value(), processor.value()); result.is_error())
+            return result;
+        return count;
+    }
+
+private:
+    IRQAffinitySysFSComponent()
+        : SysFSComponent("affinity"sv)
+    {
+    }
+};
+
+class IRQBalancingSysFSComponent final : public SysFSComponent {
+public:
+    static NonnullRefPtr<IRQBalancingSysFSComponent> must_create()
+    {
+        return adopt_ref(*new (nothrow) IRQBalancingSysFSComponent);
+    }
+
+    virtual mode_t permissions() const override { return S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH; }
+
+    virtual KResultOr<size_t> read_bytes(off_t offset, size_t count, UserOrKernelBuffer& buffer, FileDescription*) const override
+    {
+        auto value = String::formatted("{}\n", InterruptManagement::the().is_irq_balancing_enabled() ? 1 : 0);
+        if ((size_t)offset >= value.length())
+            return 0;
+        auto nread = min(value.length() - offset, count);
+        if (!buffer.write(value.characters() + offset, nread))
+            return EFAULT;
+        return nread;
+    }
+
+    virtual KResultOr<size_t> write_bytes(off_t offset, size_t count, UserOrKernelBuffer const& buffer, FileDescription*) override
+    {
+        char value_buffer[16];
+        if (offset != 0 || count >= sizeof(value_buffer))
+            return EINVAL;
+        if (!buffer.read(value_buffer, count))
+            return EFAULT;
+        auto new_value = StringView(value_buffer, count).trim_whitespace().to_uint();
+        if (!new_value.has_value() || new_value.value() > 1)
+            return EINVAL;
+        InterruptManagement::the().set_irq_balancing_enabled(new_value.value());
+        return count;
+    }
+
+private:
+    IRQBalancingSysFSComponent()
+        : SysFSComponent("balance"sv)
+    {
+    }
+};
+
+class InterruptsSysFSDirectory final : public SysFSDirectory {
+public:
+    static NonnullRefPtr<InterruptsSysFSDirectory> must_create()
+    {
+        return adopt_ref(*new (nothrow) InterruptsSysFSDirectory);
+    }
+
+private:
+    InterruptsSysFSDirectory()
+        : SysFSDirectory("interrupts", SysFSComponentRegistry::the().root_directory())
+    {
+        m_components.append(IRQAffinitySysFSComponent::must_create());
+        m_components.append(IRQBalancingSysFSComponent::must_create());
+    }
+};
+
+UNMAP_AFTER_INIT void InterruptManagement::initialize_sysfs_directory()
+{
+    SysFSComponentRegistry::the().register_new_component(InterruptsSysFSDirectory::must_create());
+}
+
 }
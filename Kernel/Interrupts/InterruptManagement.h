@@ -6,16 +6,22 @@
 
 #pragma once
 
+#include <AK/Array.h>
+#include <AK/Atomic.h>
 #include <AK/Function.h>
 #include <AK/NonnullOwnPtr.h>
+#include <AK/Optional.h>
 #include <AK/OwnPtr.h>
 #include <AK/RefCounted.h>
 #include <AK/RefPtr.h>
 #include <AK/Types.h>
 #include <Kernel/ACPI/Definitions.h>
+#include <Kernel/Arch/x86/CPU.h>
 #include <Kernel/Interrupts/GenericInterruptHandler.h>
 #include <Kernel/Interrupts/IOAPIC.h>
 #include <Kernel/Interrupts/IRQController.h>
+#include <Kernel/KResult.h>
+#include <Kernel/SpinLock.h>
 
 namespace Kernel {
 
@@ -48,6 +54,11 @@ public:
     static bool initialized();
     static u8 acquire_mapped_interrupt_number(u8 original_irq);
     static u8 acquire_irq_number(u8 mapped_interrupt_vector);
+    // Finds an interrupt number that no IRQ line maps to and that isn't used by anything yet.
+    // Whoever gets it has to register a handler for it right away.
+    static Optional<u8> allocate_message_signalled_interrupt_number();
+    // The processor the next message signalled interrupt should go to, so they are spread over all of them.
+    static u32 next_message_signalled_interrupt_processor();
 
     virtual void switch_to_pic_mode();
     virtual void switch_to_ioapic_mode();
@@ -63,6 +74,18 @@ public:
     void enumerate_interrupt_handlers(Function<void(GenericInterruptHandler&)>);
     IRQController& get_interrupt_controller(int index);
 
+    // Only IRQs that go through an IOAPIC can be moved to another processor, everything starts out on the BSP.
+    KResult set_irq_affinity(u8 irq, u32 processor);
+    u32 irq_affinity(u8 irq) const { return m_irq_affinity[irq]; }
+
+    bool is_irq_balancing_enabled() const { return m_irq_balancing_enabled.load(); }
+    void set_irq_balancing_enabled(bool enabled) { m_irq_balancing_enabled.store(enabled); }
+    // Spreads the IRQs over all processors by how often they fired since the last call.
+    void balance_irqs();
+
+    // Exposes the affinity of every IRQ in /sys/interrupts, where it can be changed as well.
+    static void initialize_sysfs_directory();
+
 protected:
     virtual ~InterruptManagement() = default;
 
@@ -75,6 +98,12 @@ private:
     Vector<ISAInterruptOverrideMetadata> m_isa_interrupt_overrides;
     Vector<PCIInterruptOverrideMetadata> m_pci_interrupt_overrides;
     PhysicalAddress m_madt;
+
+    SpinLock<u8> m_irq_affinity_lock;
+    Array<u32, GENERIC_INTERRUPT_HANDLERS_COUNT> m_irq_affinity {};
+    // Only touched by balance_irqs().
+    Array<u32, GENERIC_INTERRUPT_HANDLERS_COUNT> m_last_invoking_count {};
+    Atomic<u32, AK::MemoryOrder::memory_order_relaxed> m_irq_balancing_enabled { 0 };
 };
 
 }
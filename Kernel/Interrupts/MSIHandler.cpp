@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Arch/x86/CPU.h>
+#include <Kernel/Interrupts/APIC.h>
+#include <Kernel/Interrupts/MSIHandler.h>
+
+namespace Kernel {
+
+MSIHandler::MSIHandler(u8 interrupt_number)
+    : GenericInterruptHandler(interrupt_number, true)
+{
+}
+
+MSIHandler::~MSIHandler()
+{
+}
+
+bool MSIHandler::eoi()
+{
+    APIC::the().eoi();
+    return true;
+}
+
+}
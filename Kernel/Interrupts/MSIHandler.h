@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2020, Liav A. <liavalb@hotmail.co.il>
+ * Copyright (c) 2021, the SerenityOS developers.
  *
  * SPDX-License-Identifier: BSD-2-Clause
  */
@@ -8,31 +8,27 @@
 
 #include <AK/Types.h>
 #include <Kernel/Interrupts/GenericInterruptHandler.h>
-#include <Kernel/PCI/Definitions.h>
 
 namespace Kernel {
 
-class MSIHandler final : public GenericInterruptHandler {
+// Handles a message signalled interrupt, like one vector of a device's MSI-X table. These are delivered
+// straight to a local APIC, so they get an interrupt number of their own that no IRQ line is mapped to.
+// Use this for devices with several vectors, IRQHandler can switch a single interrupt over to MSI itself.
+class MSIHandler : public GenericInterruptHandler {
 public:
     virtual ~MSIHandler();
 
-    virtual void handle_interrupt(RegisterState&) override { }
-
-    void enable_irq();
-    void disable_irq();
-
     virtual bool eoi() override;
 
+    virtual HandlerType type() const override { return HandlerType::IRQHandler; }
+    virtual StringView controller() const override { return "MSI"; }
+
     virtual size_t sharing_devices_count() const override { return 0; }
     virtual bool is_shared_handler() const override { return false; }
-    virtual bool is_sharing_with_others() const override { return m_shared_with_others; }
+    virtual bool is_sharing_with_others() const override { return false; }
 
 protected:
-    void change_irq_number(u8 irq);
-    explicit MSIHandler(PCI::Address);
-
-private:
-    bool m_shared_with_others;
-    bool m_enabled;
+    explicit MSIHandler(u8 interrupt_number);
 };
+
 }
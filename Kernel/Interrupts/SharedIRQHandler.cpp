@@ -42,6 +42,15 @@ bool SharedIRQHandler::eoi()
     return true;
 }
 
+bool SharedIRQHandler::has_fixed_affinity() const
+{
+    for (auto& handler : m_handlers) {
+        if (handler.has_fixed_affinity())
+            return true;
+    }
+    return false;
+}
+
 void SharedIRQHandler::enumerate_handlers(Function<void(GenericInterruptHandler&)>& callback)
 {
     for (auto& handler : m_handlers) {
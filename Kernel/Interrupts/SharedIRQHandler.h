@@ -30,6 +30,7 @@ public:
     virtual size_t sharing_devices_count() const override { return m_handlers.size_slow(); }
     virtual bool is_shared_handler() const override { return true; }
     virtual bool is_sharing_with_others() const override { return false; }
+    virtual bool has_fixed_affinity() const override;
 
     virtual HandlerType type() const override { return HandlerType::SharedIRQHandler; }
     virtual StringView purpose() const override { return "Shared IRQ Handler"; }
@@ -32,7 +32,7 @@ public:
     {
         // FIXME: This really not ideal, but vformat expects StringBuilder.
         StringBuilder builder;
-        vformat(builder, fmtstr.view(), AK::VariadicFormatParams { parameters... });
+        vformat(builder, fmtstr.view(), AK::VariadicFormatParams { fmtstr, parameters... });
         append_bytes(builder.string_view().bytes());
     }
 
@@ -6,87 +6,162 @@
 
 #include <Kernel/StdLib.h>
 
-extern "C" {
+// The kernel can't use SSE, so everything is moved a word at a time:
+// - Up to two words are moved with two loads and stores that overlap in the middle.
+// - Up to rep_threshold bytes are moved in a loop, with one more (overlapping) word for the remainder.
+// - Anything larger is left to "rep movs" and "rep stos" once the destination is aligned, which is fast
+//   whether or not the CPU has ERMS, so there's no need to check for it (which the Prekernel couldn't do anyway).
+static constexpr size_t rep_threshold = 256;
 
-void* memcpy(void* dest_ptr, const void* src_ptr, size_t n)
+template<typename T>
+static ALWAYS_INLINE T load(const u8* src)
+{
+    T value;
+    __builtin_memcpy(&value, src, sizeof(T));
+    return value;
+}
+
+template<typename T>
+static ALWAYS_INLINE void store(u8* dest, T value)
+{
+    __builtin_memcpy(dest, &value, sizeof(T));
+}
+
+template<typename T>
+static ALWAYS_INLINE bool copy_head_and_tail(u8* dest, const u8* src, size_t n)
+{
+    if (n < sizeof(T))
+        return false;
+    auto head = load<T>(src);
+    auto tail = load<T>(src + n - sizeof(T));
+    store(dest, head);
+    store(dest + n - sizeof(T), tail);
+    return true;
+}
+
+// Everything is loaded before anything is stored, so this works for overlapping buffers too.
+static ALWAYS_INLINE void copy_small(u8* dest, const u8* src, size_t n)
+{
+    if (copy_head_and_tail<u64>(dest, src, n) || copy_head_and_tail<u32>(dest, src, n) || copy_head_and_tail<u16>(dest, src, n))
+        return;
+    if (n)
+        *dest = *src;
+}
+
+static void copy_large(u8* dest, const u8* src, size_t n)
 {
-    size_t dest = (size_t)dest_ptr;
-    size_t src = (size_t)src_ptr;
-    // FIXME: Support starting at an unaligned address.
-    if (!(dest & 0x3) && !(src & 0x3) && n >= 12) {
-        size_t size_ts = n / sizeof(size_t);
+    // The head and tail are stored last, as storing them first could overwrite bytes of src that haven't been copied yet.
+    auto head = load<FlatPtr>(src);
+    auto tail = load<FlatPtr>(src + n - sizeof(FlatPtr));
+    auto* original_dest = dest;
+    size_t offset = sizeof(FlatPtr) - ((FlatPtr)dest % sizeof(FlatPtr));
+    size_t count = (n - offset) / sizeof(FlatPtr);
+    dest += offset;
+    src += offset;
 #if ARCH(I386)
-        asm volatile(
-            "rep movsl\n"
-            : "=S"(src), "=D"(dest)
-            : "S"(src), "D"(dest), "c"(size_ts)
-            : "memory");
+    asm volatile("rep movsl"
+                 : "+D"(dest), "+S"(src), "+c"(count)::"memory");
 #else
-        asm volatile(
-            "rep movsq\n"
-            : "=S"(src), "=D"(dest)
-            : "S"(src), "D"(dest), "c"(size_ts)
-            : "memory");
+    asm volatile("rep movsq"
+                 : "+D"(dest), "+S"(src), "+c"(count)::"memory");
 #endif
-        n -= size_ts * sizeof(size_t);
-        if (n == 0)
-            return dest_ptr;
+    store(original_dest, head);
+    store(original_dest + n - sizeof(FlatPtr), tail);
+}
+
+extern "C" {
+
+void* memcpy(void* dest_ptr, const void* src_ptr, size_t n)
+{
+    auto* dest = (u8*)dest_ptr;
+    auto* src = (const u8*)src_ptr;
+    if (n <= 2 * sizeof(FlatPtr)) {
+        copy_small(dest, src, n);
+    } else if (n <= rep_threshold) {
+        auto tail = load<FlatPtr>(src + n - sizeof(FlatPtr));
+        for (size_t i = 0; i < n - sizeof(FlatPtr); i += sizeof(FlatPtr))
+            store(dest + i, load<FlatPtr>(src + i));
+        store(dest + n - sizeof(FlatPtr), tail);
+    } else {
+        copy_large(dest, src, n);
     }
-    asm volatile(
-        "rep movsb\n" ::"S"(src), "D"(dest), "c"(n)
-        : "memory");
     return dest_ptr;
 }
 
-void* memmove(void* dest, const void* src, size_t n)
+void* memmove(void* dest_ptr, const void* src_ptr, size_t n)
 {
-    if (dest < src)
-        return memcpy(dest, src, n);
-
-    u8* pd = (u8*)dest;
-    const u8* ps = (const u8*)src;
-    for (pd += n, ps += n; n--;)
-        *--pd = *--ps;
-    return dest;
+    auto* dest = (u8*)dest_ptr;
+    auto* src = (const u8*)src_ptr;
+    // memcpy() copies front to back, which is fine unless dest starts within src.
+    if ((FlatPtr)dest - (FlatPtr)src >= n)
+        return memcpy(dest_ptr, src_ptr, n);
+    if (n <= 2 * sizeof(FlatPtr)) {
+        copy_small(dest, src, n);
+        return dest_ptr;
+    }
+    auto head = load<FlatPtr>(src);
+    for (size_t i = n; i > sizeof(FlatPtr); i -= sizeof(FlatPtr))
+        store(dest + i - sizeof(FlatPtr), load<FlatPtr>(src + i - sizeof(FlatPtr)));
+    store(dest, head);
+    return dest_ptr;
 }
 
 void* memset(void* dest_ptr, int c, size_t n)
 {
-    size_t dest = (size_t)dest_ptr;
-    // FIXME: Support starting at an unaligned address.
-    if (!(dest & 0x3) && n >= 12) {
-        size_t size_ts = n / sizeof(size_t);
-        size_t expanded_c = explode_byte((u8)c);
+    auto* dest = (u8*)dest_ptr;
+    auto value = explode_byte((u8)c);
+    if (n < sizeof(FlatPtr)) {
+        if (n >= 4) {
+            store(dest, (u32)value);
+            store(dest + n - 4, (u32)value);
+        } else if (n >= 2) {
+            store(dest, (u16)value);
+            store(dest + n - 2, (u16)value);
+        } else if (n) {
+            *dest = (u8)c;
+        }
+        return dest_ptr;
+    }
+    store(dest, value);
+    store(dest + n - sizeof(FlatPtr), value);
+    if (n <= rep_threshold) {
+        for (size_t i = sizeof(FlatPtr); i < n - sizeof(FlatPtr); i += sizeof(FlatPtr))
+            store(dest + i, value);
+        return dest_ptr;
+    }
+    size_t offset = sizeof(FlatPtr) - ((FlatPtr)dest % sizeof(FlatPtr));
+    size_t count = (n - offset) / sizeof(FlatPtr);
+    dest += offset;
 #if ARCH(I386)
-        asm volatile(
-            "rep stosl\n"
-            : "=D"(dest)
-            : "D"(dest), "c"(size_ts), "a"(expanded_c)
-            : "memory");
+    asm volatile("rep stosl"
+                 : "+D"(dest), "+c"(count)
+                 : "a"(value)
+                 : "memory");
 #else
-        asm volatile(
-            "rep stosq\n"
-            : "=D"(dest)
-            : "D"(dest), "c"(size_ts), "a"(expanded_c)
-            : "memory");
+    asm volatile("rep stosq"
+                 : "+D"(dest), "+c"(count)
+                 : "a"(value)
+                 : "memory");
 #endif
-        n -= size_ts * sizeof(size_t);
-        if (n == 0)
-            return dest_ptr;
-    }
-    asm volatile(
-        "rep stosb\n"
-        : "=D"(dest), "=c"(n)
-        : "0"(dest), "1"(n), "a"(c)
-        : "memory");
     return dest_ptr;
 }
 
 size_t strlen(const char* str)
 {
-    size_t len = 0;
-    while (*(str++))
-        ++len;
-    return len;
+    // Whole aligned words are read at a time, which may go past the end of the string, but never into the next page.
+    using AlignedWord [[gnu::may_alias]] = FlatPtr;
+    auto* p = str;
+    for (; (FlatPtr)p % sizeof(FlatPtr); ++p) {
+        if (!*p)
+            return p - str;
+    }
+    for (;; p += sizeof(FlatPtr)) {
+        auto word = *(const AlignedWord*)p;
+        if ((word - explode_byte(0x01)) & ~word & explode_byte(0x80))
+            break;
+    }
+    while (*p)
+        ++p;
+    return p - str;
 }
 }
@@ -119,6 +119,11 @@ namespace Kernel {
 #define INTERRUPT_TXD_LOW (1 << 15)
 #define INTERRUPT_SRPD (1 << 16)
 
+// These are turned off while the NetworkTask is polling the receive ring.
+static constexpr u32 receive_interrupts = INTERRUPT_RXT0 | INTERRUPT_RXO;
+// At most 8000 interrupts per second, in units of 256 nanoseconds.
+static constexpr u32 interrupt_throttling_interval = 488;
+
 // https://www.intel.com/content/dam/doc/manual/pci-pci-x-family-gbe-controllers-software-dev-manual.pdf Section 5.2
 UNMAP_AFTER_INIT static bool is_valid_device_id(u16 device_id)
 {
@@ -181,8 +186,15 @@ UNMAP_AFTER_INIT void E1000NetworkAdapter::setup_link()
 
 UNMAP_AFTER_INIT void E1000NetworkAdapter::setup_interrupts()
 {
-    out32(REG_INTERRUPT_RATE, 6000); // Interrupt rate of 1.536 milliseconds
-    out32(REG_INTERRUPT_MASK_SET, INTERRUPT_LSC | INTERRUPT_RXT0 | INTERRUPT_RXO);
+    // With MSI, the interrupt isn't shared with anyone and doesn't have to end up on the BSP.
+    if (try_to_enable_message_signalled_interrupts())
+        dmesgln("E1000: Using message signalled interrupts");
+    // While there's a steady stream of frames, polling keeps the interrupts off anyway, so the throttling only
+    // has to keep bursts from interrupting us too often. The per-frame timers would just add latency on top.
+    out32(REG_INTERRUPT_RATE, interrupt_throttling_interval);
+    out32(REG_RDTR, 0);
+    out32(REG_RADV, 0);
+    out32(REG_INTERRUPT_MASK_SET, INTERRUPT_LSC | receive_interrupts);
     in32(REG_INTERRUPT_CAUSE_READ);
     enable_irq();
 }
@@ -249,9 +261,12 @@ bool E1000NetworkAdapter::handle_irq(const RegisterState&)
     }
     if (status & INTERRUPT_RXO) {
         dbgln_if(E1000_DEBUG, "E1000: RX buffer overrun");
+        count_dropped_packet();
     }
-    if (status & INTERRUPT_RXT0) {
-        receive();
+    if (status & receive_interrupts) {
+        // The NetworkTask takes it from here, and turns these back on once it has emptied the ring.
+        out32(REG_INTERRUPT_MASK_CLEAR, receive_interrupts);
+        schedule_receive_polling();
     }
 
     m_wait_queue.wake_all();
@@ -447,11 +462,30 @@ void E1000NetworkAdapter::send_raw(ReadonlyBytes payload)
     dbgln_if(E1000_DEBUG, "E1000: Sent packet, status is now {:#02x}!", (u8)descriptor.status);
 }
 
-void E1000NetworkAdapter::receive()
+bool E1000NetworkAdapter::has_received_frame()
+{
+    auto* rx_descriptors = (e1000_rx_desc*)m_rx_descriptors_region->vaddr().as_ptr();
+    auto rx_current = (in32(REG_RXDESCTAIL) + 1) % number_of_rx_descriptors;
+    return rx_descriptors[rx_current].status & 1;
+}
+
+void E1000NetworkAdapter::enable_receive_interrupts()
+{
+    // Whatever the hardware has noted down while we were polling has been taken care of already.
+    out32(REG_INTERRUPT_CAUSE_READ, receive_interrupts);
+    out32(REG_INTERRUPT_MASK_SET, receive_interrupts);
+    if (has_received_frame()) {
+        out32(REG_INTERRUPT_MASK_CLEAR, receive_interrupts);
+        schedule_receive_polling();
+    }
+}
+
+size_t E1000NetworkAdapter::receive_frames(size_t budget)
 {
     auto* rx_descriptors = (e1000_tx_desc*)m_rx_descriptors_region->vaddr().as_ptr();
     u32 rx_current;
-    for (;;) {
+    size_t frame_count = 0;
+    for (; frame_count < budget; ++frame_count) {
         rx_current = in32(REG_RXDESCTAIL) % number_of_rx_descriptors;
         rx_current = (rx_current + 1) % number_of_rx_descriptors;
         if (!(rx_descriptors[rx_current].status & 1))
@@ -464,6 +498,7 @@ void E1000NetworkAdapter::receive()
         rx_descriptors[rx_current].status = 0;
         out32(REG_RXDESCTAIL, rx_current);
     }
+    return frame_count;
 }
 
 }
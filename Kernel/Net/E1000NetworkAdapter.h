@@ -74,9 +74,12 @@ protected:
     u16 in16(u16 address);
     u32 in32(u16 address);
 
-    void receive();
+    virtual size_t receive_frames(size_t budget) override;
+    virtual void enable_receive_interrupts() override;
+    bool has_received_frame();
 
-    static constexpr size_t number_of_rx_descriptors = 32;
+    // The ring has to hold everything that arrives until the NetworkTask gets around to polling it.
+    static constexpr size_t number_of_rx_descriptors = 128;
     static constexpr size_t number_of_tx_descriptors = 8;
 
     IOAddress m_io_base;
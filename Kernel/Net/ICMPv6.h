@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/MACAddress.h>
+#include <Kernel/Net/ICMP.h>
+#include <Kernel/Net/IPv6.h>
+
+namespace Kernel {
+
+struct ICMPv6Type {
+    enum {
+        EchoRequest = 128,
+        EchoReply = 129,
+        RouterSolicitation = 133,
+        RouterAdvertisement = 134,
+        NeighborSolicitation = 135,
+        NeighborAdvertisement = 136,
+    };
+};
+
+// ICMPv6 has the same header as ICMP, only the types and the checksum are different.
+using ICMPv6Header = ICMPHeader;
+using ICMPv6EchoPacket = ICMPEchoPacket;
+
+struct NeighborDiscoveryOption {
+    enum : u8 {
+        SourceLinkLayerAddress = 1,
+        TargetLinkLayerAddress = 2,
+    };
+};
+
+// Used for both solicitations and advertisements, which look the same apart from the flags.
+struct [[gnu::packed]] NeighborDiscoveryPacket {
+    enum Flags : u32 {
+        Router = 1u << 31,
+        Solicited = 1u << 30,
+        Override = 1u << 29,
+    };
+
+    ICMPv6Header header;
+    NetworkOrdered<u32> flags;
+    IPv6Address target;
+
+    const u8* options() const { return (const u8*)(this + 1); }
+};
+
+static_assert(sizeof(NeighborDiscoveryPacket) == 24);
+
+// The only option we ever send is our own link-layer address, which is 8 bytes long on Ethernet.
+struct [[gnu::packed]] LinkLayerAddressOption {
+    u8 type { 0 };
+    u8 length_in_units_of_8_bytes { 1 };
+    MACAddress address;
+};
+
+static_assert(sizeof(LinkLayerAddressOption) == 8);
+
+}
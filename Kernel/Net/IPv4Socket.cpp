@@ -63,9 +63,6 @@ IPv4Socket::IPv4Socket(int type, int protocol)
 {
     dbgln_if(IPV4_SOCKET_DEBUG, "IPv4Socket({}) created with type={}, protocol={}", this, type, protocol);
     m_buffer_mode = type == SOCK_STREAM ? BufferMode::Bytes : BufferMode::Packets;
-    if (m_buffer_mode == BufferMode::Bytes) {
-        m_scratch_buffer = KBuffer::create_with_size(65536);
-    }
     MutexLocker locker(all_sockets().lock());
     all_sockets().resource().set(this);
 }
@@ -210,7 +207,7 @@ KResultOr<size_t> IPv4Socket::sendto(FileDescription&, const UserOrKernelBuffer&
     if (!is_connected() && m_peer_address.is_zero())
         return EPIPE;
 
-    auto routing_decision = route_to(m_peer_address, m_local_address, bound_interface());
+    auto routing_decision = route_to_peer();
     if (routing_decision.is_zero())
         return EHOSTUNREACH;
 
@@ -248,7 +245,7 @@ KResultOr<size_t> IPv4Socket::sendto(FileDescription&, const UserOrKernelBuffer&
 KResultOr<size_t> IPv4Socket::receive_byte_buffered(FileDescription& description, UserOrKernelBuffer& buffer, size_t buffer_length, int flags, Userspace<sockaddr*>, Userspace<socklen_t*>)
 {
     MutexLocker locker(lock());
-    if (m_receive_buffer.is_empty()) {
+    if (m_receive_segments.is_empty()) {
         if (protocol_is_disconnected())
             return 0;
         if (!description.is_blocking())
@@ -268,19 +265,50 @@ KResultOr<size_t> IPv4Socket::receive_byte_buffered(FileDescription& description
         }
     }
 
-    KResultOr<size_t> nreceived_or_error { 0 };
-    if (flags & MSG_PEEK)
-        nreceived_or_error = m_receive_buffer.peek(buffer, buffer_length);
-    else
-        nreceived_or_error = m_receive_buffer.read(buffer, buffer_length);
+    auto nreceived_or_error = read_from_receive_segments(buffer, buffer_length, flags & MSG_PEEK);
 
     if (!nreceived_or_error.is_error() && nreceived_or_error.value() > 0 && !(flags & MSG_PEEK))
         Thread::current()->did_ipv4_socket_read(nreceived_or_error.value());
 
-    set_can_read(!m_receive_buffer.is_empty());
+    set_can_read(!m_receive_segments.is_empty());
     return nreceived_or_error;
 }
 
+KResultOr<size_t> IPv4Socket::read_from_receive_segments(UserOrKernelBuffer& buffer, size_t buffer_length, bool peek)
+{
+    VERIFY(lock().is_locked());
+    size_t nread = 0;
+    size_t offset = m_first_receive_segment_offset;
+    bool did_fault = false;
+    auto it = m_receive_segments.begin();
+    while (nread < buffer_length && !it.is_end()) {
+        auto bytes = it->bytes().slice(offset);
+        auto count = min(bytes.size(), buffer_length - nread);
+        if (!buffer.write(bytes.data(), nread, count)) {
+            did_fault = true;
+            break;
+        }
+        nread += count;
+        offset += count;
+        if (offset < it->size())
+            break;
+        offset = 0;
+        if (peek) {
+            ++it;
+        } else {
+            m_receive_segments.take_first();
+            it = m_receive_segments.begin();
+        }
+    }
+    if (!peek) {
+        m_first_receive_segment_offset = offset;
+        m_receive_segments_size -= nread;
+    }
+    if (did_fault && nread == 0)
+        return EFAULT;
+    return nread;
+}
+
 KResultOr<size_t> IPv4Socket::receive_packet_buffered(FileDescription& description, UserOrKernelBuffer& buffer, size_t buffer_length, int flags, Userspace<sockaddr*> addr, Userspace<socklen_t*> addr_length, Time& packet_timestamp)
 {
     MutexLocker locker(lock());
@@ -365,12 +393,12 @@ KResultOr<size_t> IPv4Socket::receive_packet_buffered(FileDescription& descripti
 
     if (type() == SOCK_RAW) {
         size_t bytes_written = min(packet.data.value().size(), buffer_length);
-        if (!buffer.write(packet.data.value().data(), bytes_written))
+        if (!buffer.write(packet.data.value().bytes().data(), bytes_written))
             return EFAULT;
         return bytes_written;
     }
 
-    return protocol_receive(ReadonlyBytes { packet.data.value().data(), packet.data.value().size() }, buffer, buffer_length, flags);
+    return protocol_receive(packet.data.value().bytes(), buffer, buffer_length, flags);
 }
 
 KResultOr<size_t> IPv4Socket::recvfrom(FileDescription& description, UserOrKernelBuffer& buffer, size_t buffer_length, int flags, Userspace<sockaddr*> user_addr, Userspace<socklen_t*> user_addr_length, Time& packet_timestamp)
@@ -396,7 +424,7 @@ KResultOr<size_t> IPv4Socket::recvfrom(FileDescription& description, UserOrKerne
     return nreceived;
 }
 
-bool IPv4Socket::did_receive(const IPv4Address& source_address, u16 source_port, ReadonlyBytes packet, const Time& packet_timestamp)
+bool IPv4Socket::did_receive(const IPv4Address& source_address, u16 source_port, const PacketBufferView& packet)
 {
     MutexLocker locker(lock());
 
@@ -406,26 +434,23 @@ bool IPv4Socket::did_receive(const IPv4Address& source_address, u16 source_port,
     auto packet_size = packet.size();
 
     if (buffer_mode() == BufferMode::Bytes) {
-        size_t space_in_receive_buffer = m_receive_buffer.space_for_writing();
-        if (packet_size > space_in_receive_buffer) {
+        auto payload = protocol_payload(packet.bytes());
+        if (payload.size() > receive_buffer_space() || m_receive_segments.size() >= maximum_queued_packets) {
             dbgln("IPv4Socket({}): did_receive refusing packet since buffer is full.", this);
             VERIFY(m_can_read);
             return false;
         }
-        auto scratch_buffer = UserOrKernelBuffer::for_kernel_buffer(m_scratch_buffer.value().data());
-        auto nreceived_or_error = protocol_receive(ReadonlyBytes { packet.data(), packet.size() }, scratch_buffer, m_scratch_buffer.value().size(), 0);
-        if (nreceived_or_error.is_error())
-            return false;
-        auto nwritten_or_error = m_receive_buffer.write(scratch_buffer, nreceived_or_error.value());
-        if (nwritten_or_error.is_error())
-            return false;
-        set_can_read(!m_receive_buffer.is_empty());
+        if (!payload.is_empty()) {
+            m_receive_segments.append(packet.slice(payload.data() - packet.bytes().data(), payload.size()));
+            m_receive_segments_size += payload.size();
+        }
+        set_can_read(!m_receive_segments.is_empty());
     } else {
-        if (m_receive_queue.size() > 2000) {
+        if (m_receive_queue.size() > maximum_queued_packets) {
             dbgln("IPv4Socket({}): did_receive refusing packet since queue is full.", this);
             return false;
         }
-        m_receive_queue.append({ source_address, source_port, packet_timestamp, KBuffer::copy(packet.data(), packet.size()) });
+        m_receive_queue.append({ source_address, source_port, packet.timestamp(), packet });
         set_can_read(true);
     }
     m_bytes_received += packet_size;
@@ -586,20 +611,46 @@ KResult IPv4Socket::ioctl(FileDescription&, unsigned request, Userspace<void*> a
         if (!adapter)
             return ENODEV;
 
+        if (!Process::current()->is_superuser())
+            return EPERM;
+
+        auto destination = IPv4Address(((sockaddr_in&)route.rt_dst).sin_addr.s_addr);
+        auto genmask = IPv4Address(((sockaddr_in&)route.rt_genmask).sin_addr.s_addr);
+        auto gateway = IPv4Address(((sockaddr_in&)route.rt_gateway).sin_addr.s_addr);
+        bool has_gateway = route.rt_flags & RTF_GATEWAY;
+        // The default route is the gateway of the adapter, so it goes away along with its address.
+        bool is_default_route = destination.is_zero() && genmask.is_zero();
+
         switch (request) {
-        case SIOCADDRT:
-            if (!Process::current()->is_superuser())
-                return EPERM;
-            if (route.rt_gateway.sa_family != AF_INET)
+        case SIOCADDRT: {
+            if (has_gateway && route.rt_gateway.sa_family != AF_INET)
                 return EAFNOSUPPORT;
-            if ((route.rt_flags & (RTF_UP | RTF_GATEWAY)) != (RTF_UP | RTF_GATEWAY))
+            if (!(route.rt_flags & RTF_UP))
                 return EINVAL; // FIXME: Find the correct value to return
-            adapter->set_ipv4_gateway(IPv4Address(((sockaddr_in&)route.rt_gateway).sin_addr.s_addr));
-            return KSuccess;
+            if (is_default_route) {
+                if (!has_gateway)
+                    return EINVAL;
+                adapter->set_ipv4_gateway(gateway);
+                return KSuccess;
+            }
+            auto prefix_length = prefix_length_of_netmask(genmask);
+            if (!prefix_length.has_value())
+                return EINVAL;
+            return RoutingTable::the().add_route({ destination, prefix_length.value(), has_gateway ? gateway : IPv4Address(), *adapter, Route::Origin::Static, false });
+        }
 
-        case SIOCDELRT:
-            // FIXME: Support gateway deletion
-            return KSuccess;
+        case SIOCDELRT: {
+            if (is_default_route) {
+                if (adapter->ipv4_gateway().is_zero() || (has_gateway && adapter->ipv4_gateway() != gateway))
+                    return ESRCH;
+                adapter->set_ipv4_gateway({});
+                return KSuccess;
+            }
+            auto prefix_length = prefix_length_of_netmask(genmask);
+            if (!prefix_length.has_value())
+                return EINVAL;
+            return RoutingTable::the().remove_route(destination, prefix_length.value(), *adapter);
+        }
         }
 
         return EINVAL;
@@ -760,6 +811,30 @@ KResult IPv4Socket::ioctl(FileDescription&, unsigned request, Userspace<void*> a
     return EINVAL;
 }
 
+RoutingDecision IPv4Socket::route_to_peer()
+{
+    auto through = bound_interface();
+    auto generation = RoutingTable::the().generation();
+    {
+        ScopedSpinLock lock(m_cached_routing_decision_lock);
+        if (m_cached_routing_decision.has_value()) {
+            auto& cached = m_cached_routing_decision.value();
+            if (cached.generation == generation && cached.through == through.ptr() && cached.local_address == m_local_address && cached.peer_address == m_peer_address)
+                return cached.decision;
+        }
+    }
+
+    // Routing may have to block on an ARP reply, so we can't hold the lock while we do it.
+    auto decision = route_to(m_peer_address, m_local_address, through);
+    // There's nothing to remember about failing, the next attempt may well succeed.
+    if (decision.is_zero())
+        return decision;
+
+    ScopedSpinLock lock(m_cached_routing_decision_lock);
+    m_cached_routing_decision = CachedRoutingDecision { decision, m_local_address, m_peer_address, through.ptr(), generation };
+    return decision;
+}
+
 KResult IPv4Socket::close()
 {
     [[maybe_unused]] auto rc = shutdown(SHUT_RDWR);
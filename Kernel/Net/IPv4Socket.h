@@ -8,16 +8,16 @@
 
 #include <AK/HashMap.h>
 #include <AK/SinglyLinkedListWithCount.h>
-#include <Kernel/DoubleBuffer.h>
 #include <Kernel/KBuffer.h>
 #include <Kernel/Mutex.h>
 #include <Kernel/Net/IPv4.h>
 #include <Kernel/Net/IPv4SocketTuple.h>
+#include <Kernel/Net/NetworkAdapter.h>
+#include <Kernel/Net/Routing.h>
 #include <Kernel/Net/Socket.h>
 
 namespace Kernel {
 
-class NetworkAdapter;
 class TCPPacket;
 class TCPSocket;
 
@@ -48,7 +48,8 @@ public:
 
     virtual KResult ioctl(FileDescription&, unsigned request, Userspace<void*> arg) override;
 
-    bool did_receive(const IPv4Address& peer_address, u16 peer_port, ReadonlyBytes, const Time&);
+    // Takes the raw IPv4 packet. The socket keeps a reference to it instead of copying it.
+    bool did_receive(const IPv4Address& peer_address, u16 peer_port, const PacketBufferView&);
 
     const IPv4Address& local_address() const { return m_local_address; }
     u16 local_port() const { return m_local_port; }
@@ -82,6 +83,8 @@ protected:
     virtual KResult protocol_bind() { return KSuccess; }
     virtual KResult protocol_listen([[maybe_unused]] bool did_allocate_port) { return KSuccess; }
     virtual KResultOr<size_t> protocol_receive(ReadonlyBytes /* raw_ipv4_packet */, UserOrKernelBuffer&, size_t, int) { return ENOTIMPL; }
+    // Byte buffered sockets only keep this part of every packet they receive.
+    virtual ReadonlyBytes protocol_payload(ReadonlyBytes raw_ipv4_packet) const { return raw_ipv4_packet; }
     virtual KResultOr<size_t> protocol_send(const UserOrKernelBuffer&, size_t) { return ENOTIMPL; }
     virtual KResult protocol_connect(FileDescription&, ShouldBlock) { return KSuccess; }
     virtual KResultOr<u16> protocol_allocate_local_port() { return ENOPROTOOPT; }
@@ -92,12 +95,20 @@ protected:
     void set_local_address(IPv4Address address) { m_local_address = address; }
     void set_peer_address(IPv4Address address) { m_peer_address = address; }
 
+    static constexpr size_t receive_buffer_capacity() { return receive_buffer_size; }
+    size_t receive_buffer_space() const { return receive_buffer_size - m_receive_segments_size; }
+
+    // Same as route_to() for the peer, but remembers the decision until the routing table or the addresses change.
+    RoutingDecision route_to_peer();
+
 private:
     virtual bool is_ipv4() const override { return true; }
 
     KResultOr<size_t> receive_byte_buffered(FileDescription&, UserOrKernelBuffer& buffer, size_t buffer_length, int flags, Userspace<sockaddr*>, Userspace<socklen_t*>);
     KResultOr<size_t> receive_packet_buffered(FileDescription&, UserOrKernelBuffer& buffer, size_t buffer_length, int flags, Userspace<sockaddr*>, Userspace<socklen_t*>, Time&);
 
+    KResultOr<size_t> read_from_receive_segments(UserOrKernelBuffer&, size_t buffer_length, bool peek);
+
     void set_can_read(bool);
 
     IPv4Address m_local_address;
@@ -110,12 +121,18 @@ private:
         IPv4Address peer_address;
         u16 peer_port;
         Time timestamp;
-        Optional<KBuffer> data;
+        Optional<PacketBufferView> data;
     };
 
+    static constexpr size_t maximum_queued_packets = 2000;
+    static constexpr size_t receive_buffer_size = 256 * KiB;
+
     SinglyLinkedListWithCount<ReceivedPacket> m_receive_queue;
 
-    DoubleBuffer m_receive_buffer { 256 * KiB };
+    // The payloads that byte buffered sockets have received, in order. Only the first one may have been read partially.
+    SinglyLinkedListWithCount<PacketBufferView> m_receive_segments;
+    size_t m_receive_segments_size { 0 };
+    size_t m_first_receive_segment_offset { 0 };
 
     u16 m_local_port { 0 };
     u16 m_peer_port { 0 };
@@ -128,7 +145,15 @@ private:
 
     BufferMode m_buffer_mode { BufferMode::Packets };
 
-    Optional<KBuffer> m_scratch_buffer;
+    struct CachedRoutingDecision {
+        RoutingDecision decision;
+        IPv4Address local_address;
+        IPv4Address peer_address;
+        NetworkAdapter* through { nullptr };
+        u32 generation { 0 };
+    };
+    SpinLock<u8> m_cached_routing_decision_lock;
+    Optional<CachedRoutingDecision> m_cached_routing_decision;
 };
 
 }
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Endian.h>
+#include <AK/IPv6Address.h>
+#include <AK/MACAddress.h>
+#include <AK/Types.h>
+
+namespace Kernel {
+
+enum class IPv6NextHeader : u8 {
+    TCP = 6,
+    UDP = 17,
+    ICMPv6 = 58,
+};
+
+class [[gnu::packed]] IPv6Packet {
+public:
+    u8 version() const { return (m_version_class_and_flow >> 28) & 0xf; }
+    void set_version_class_and_flow(u8 version, u8 traffic_class, u32 flow_label) { m_version_class_and_flow = (u32(version) << 28) | (u32(traffic_class) << 20) | (flow_label & 0xfffff); }
+
+    u16 payload_length() const { return m_payload_length; }
+    void set_payload_length(u16 length) { m_payload_length = length; }
+
+    u8 next_header() const { return m_next_header; }
+    void set_next_header(u8 next_header) { m_next_header = next_header; }
+
+    u8 hop_limit() const { return m_hop_limit; }
+    void set_hop_limit(u8 hop_limit) { m_hop_limit = hop_limit; }
+
+    const IPv6Address& source() const { return m_source; }
+    void set_source(const IPv6Address& address) { m_source = address; }
+
+    const IPv6Address& destination() const { return m_destination; }
+    void set_destination(const IPv6Address& address) { m_destination = address; }
+
+    void* payload() { return this + 1; }
+    const void* payload() const { return this + 1; }
+
+private:
+    NetworkOrdered<u32> m_version_class_and_flow;
+    NetworkOrdered<u16> m_payload_length;
+    u8 m_next_header { 0 };
+    u8 m_hop_limit { 0 };
+    IPv6Address m_source;
+    IPv6Address m_destination;
+};
+
+static_assert(sizeof(IPv6Packet) == 40);
+
+// The link-local address every adapter has, fe80::/64 with the interface identifier derived from the MAC address (RFC 4291).
+inline IPv6Address ipv6_link_local_address(const MACAddress& mac)
+{
+    u8 data[16] { 0xfe, 0x80, 0, 0, 0, 0, 0, 0, (u8)(mac[0] ^ 0x02), mac[1], mac[2], 0xff, 0xfe, mac[3], mac[4], mac[5] };
+    return IPv6Address(data);
+}
+
+// ff02::1, which every node on the link listens to.
+inline IPv6Address ipv6_all_nodes_address()
+{
+    u8 data[16] { 0xff, 0x02, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01 };
+    return IPv6Address(data);
+}
+
+// Multicast packets go to 33:33 followed by the last four bytes of the group (RFC 2464).
+inline MACAddress ipv6_multicast_ethernet_address(const IPv6Address& address)
+{
+    return MACAddress { 0x33, 0x33, address[12], address[13], address[14], address[15] };
+}
+
+// The checksum of ICMPv6, TCP and UDP covers a pseudo-header with both addresses, the length and the protocol.
+inline NetworkOrdered<u16> ipv6_upper_layer_checksum(const IPv6Address& source, const IPv6Address& destination, IPv6NextHeader next_header, const void* payload, size_t payload_size)
+{
+    u32 checksum = 0;
+    auto add = [&checksum](u16 word) {
+        checksum += word;
+        if (checksum > 0xffff)
+            checksum = (checksum >> 16) + (checksum & 0xffff);
+    };
+    for (size_t i = 0; i < 8; ++i) {
+        add(source.group(i));
+        add(destination.group(i));
+    }
+    add(payload_size >> 16);
+    add(payload_size & 0xffff);
+    add((u16)next_header);
+
+    auto* bytes = (const u8*)payload;
+    for (size_t i = 0; i + 1 < payload_size; i += 2)
+        add((u16(bytes[i]) << 8) | bytes[i + 1]);
+    if (payload_size & 1)
+        add(u16(bytes[payload_size - 1]) << 8);
+    return ~(checksum & 0xffff);
+}
+
+}
@@ -215,7 +215,7 @@ KResult LocalSocket::connect(FileDescription& description, Userspace<const socka
 KResult LocalSocket::listen(size_t backlog)
 {
     MutexLocker locker(lock());
-    if (type() != SOCK_STREAM)
+    if (type() != SOCK_STREAM && type() != SOCK_SEQPACKET)
         return EOPNOTSUPP;
     set_backlog(backlog);
     auto previous_role = m_role;
@@ -278,23 +278,47 @@ bool LocalSocket::has_attached_peer(const FileDescription& description) const
 
 bool LocalSocket::can_write(const FileDescription& description, size_t) const
 {
+    // A message always needs room for its header as well.
+    size_t minimum_space = type() == SOCK_SEQPACKET ? sizeof(MessageHeader) + 1 : 1;
     auto role = this->role(description);
     if (role == Role::Accepted)
-        return !has_attached_peer(description) || m_for_client.space_for_writing();
+        return !has_attached_peer(description) || m_for_client.space_for_writing() >= minimum_space;
     if (role == Role::Connected)
-        return !has_attached_peer(description) || m_for_server.space_for_writing();
+        return !has_attached_peer(description) || m_for_server.space_for_writing() >= minimum_space;
     return false;
 }
 
 KResultOr<size_t> LocalSocket::sendto(FileDescription& description, const UserOrKernelBuffer& data, size_t data_size, int, Userspace<const sockaddr*>, socklen_t)
+{
+    return sendto_with_descriptions(description, data, data_size, {});
+}
+
+KResultOr<size_t> LocalSocket::sendto_with_descriptions(FileDescription& description, const UserOrKernelBuffer& data, size_t data_size, NonnullRefPtrVector<FileDescription>&& passing_descriptions)
 {
     if (!has_attached_peer(description))
         return EPIPE;
+    if (type() == SOCK_SEQPACKET)
+        return send_message(description, data, data_size, move(passing_descriptions));
     auto* socket_buffer = send_buffer_for(description);
     if (!socket_buffer)
         return EINVAL;
+    // The descriptions become available together with the data, so a reader never sees one without the other.
+    MutexLocker locker(lock());
+    auto& passed_descriptions = sendfd_queue_for(description);
+    if (auto result = make_room_for_passed_descriptions(passed_descriptions, passing_descriptions.size()); result.is_error())
+        return result;
     auto nwritten_or_error = socket_buffer->write(data, data_size);
-    if (!nwritten_or_error.is_error() && nwritten_or_error.value() > 0)
+    if (nwritten_or_error.is_error())
+        return nwritten_or_error;
+    if (!passing_descriptions.is_empty()) {
+        // Nothing went out, so the caller has to try again later, with the same descriptions.
+        if (nwritten_or_error.value() == 0 && data_size > 0)
+            return EAGAIN;
+        for (auto& passing_description : passing_descriptions)
+            passed_descriptions.queue.unchecked_append(passing_description);
+        passed_descriptions.available_count += passing_descriptions.size();
+    }
+    if (nwritten_or_error.value() > 0)
         Thread::current()->did_unix_socket_write(nwritten_or_error.value());
     return nwritten_or_error;
 }
@@ -319,8 +343,84 @@ DoubleBuffer* LocalSocket::send_buffer_for(FileDescription& description)
     return nullptr;
 }
 
-KResultOr<size_t> LocalSocket::recvfrom(FileDescription& description, UserOrKernelBuffer& buffer, size_t buffer_size, int, Userspace<sockaddr*>, Userspace<socklen_t*>, Time&)
+KResultOr<size_t> LocalSocket::send_message(FileDescription& description, const UserOrKernelBuffer& data, size_t data_size, NonnullRefPtrVector<FileDescription>&& passing_descriptions)
+{
+    if (data_size > maximum_buffer_capacity - sizeof(MessageHeader))
+        return EMSGSIZE;
+    for (;;) {
+        {
+            MutexLocker locker(lock());
+            if (!has_attached_peer(description))
+                return EPIPE;
+            auto* socket_buffer = send_buffer_for(description);
+            if (!socket_buffer)
+                return EINVAL;
+            auto& passed_descriptions = sendfd_queue_for(description);
+            // The room is made up front, so that nothing can go wrong with passing the descriptions once the message is out.
+            if (auto result = make_room_for_passed_descriptions(passed_descriptions, passing_descriptions.size()); result.is_error())
+                return result;
+            MessageHeader header { static_cast<u32>(data_size), static_cast<u32>(passed_descriptions.unattached_count + passing_descriptions.size()) };
+            auto result = socket_buffer->write_record({ &header, sizeof(header) }, data, data_size);
+            if (!result.is_error()) {
+                for (auto& passing_description : passing_descriptions)
+                    passed_descriptions.queue.unchecked_append(passing_description);
+                passed_descriptions.unattached_count = 0;
+                Thread::current()->did_unix_socket_write(data_size);
+                return data_size;
+            }
+            if (result.error() != EAGAIN)
+                return result;
+        }
+        if (!description.is_blocking())
+            return EAGAIN;
+        // The reader makes room bit by bit, so we may have to wait a couple of times before the whole message fits.
+        auto unblock_flags = Thread::FileBlocker::BlockFlags::None;
+        if (Thread::current()->block<Thread::WriteBlocker>({}, description, unblock_flags).was_interrupted())
+            return EINTR;
+    }
+}
+
+KResultOr<size_t> LocalSocket::receive_message(FileDescription& description, UserOrKernelBuffer& buffer, size_t buffer_size, int flags)
+{
+    for (;;) {
+        {
+            MutexLocker locker(lock());
+            auto* socket_buffer = receive_buffer_for(description);
+            if (!socket_buffer)
+                return EINVAL;
+            if (!socket_buffer->is_empty()) {
+                // Messages are written all at once, so once there's a header the rest of the message is right behind it.
+                MessageHeader header;
+                auto nread_or_error = socket_buffer->read((u8*)&header, sizeof(header));
+                VERIFY(!nread_or_error.is_error() && nread_or_error.value() == sizeof(header));
+                auto& passed_descriptions = recvfd_queue_for(description);
+                passed_descriptions.available_count += header.fd_count;
+                VERIFY(passed_descriptions.available_count <= passed_descriptions.queue.size());
+
+                size_t size_to_read = min(static_cast<size_t>(header.size), buffer_size);
+                auto result = socket_buffer->read(buffer, size_to_read);
+                // Whatever doesn't fit into the buffer is lost, just like with datagrams.
+                socket_buffer->discard(header.size - (result.is_error() ? 0 : result.value()));
+                if (result.is_error())
+                    return result.error();
+                Thread::current()->did_unix_socket_read(result.value());
+                return (flags & MSG_TRUNC) ? static_cast<size_t>(header.size) : result.value();
+            }
+            if (!has_attached_peer(description))
+                return 0;
+        }
+        if (!description.is_blocking())
+            return EAGAIN;
+        auto unblock_flags = Thread::FileDescriptionBlocker::BlockFlags::None;
+        if (Thread::current()->block<Thread::ReadBlocker>({}, description, unblock_flags).was_interrupted())
+            return EINTR;
+    }
+}
+
+KResultOr<size_t> LocalSocket::recvfrom(FileDescription& description, UserOrKernelBuffer& buffer, size_t buffer_size, int flags, Userspace<sockaddr*>, Userspace<socklen_t*>, Time&)
 {
+    if (type() == SOCK_SEQPACKET)
+        return receive_message(description, buffer, buffer_size, flags);
     auto* socket_buffer = receive_buffer_for(description);
     if (!socket_buffer)
         return EINVAL;
@@ -443,7 +543,7 @@ KResult LocalSocket::chown(FileDescription&, uid_t uid, gid_t gid)
     return KSuccess;
 }
 
-NonnullRefPtrVector<FileDescription>& LocalSocket::recvfd_queue_for(const FileDescription& description)
+LocalSocket::PassedFileDescriptions& LocalSocket::recvfd_queue_for(const FileDescription& description)
 {
     auto role = this->role(description);
     if (role == Role::Connected)
@@ -453,7 +553,7 @@ NonnullRefPtrVector<FileDescription>& LocalSocket::recvfd_queue_for(const FileDe
     VERIFY_NOT_REACHED();
 }
 
-NonnullRefPtrVector<FileDescription>& LocalSocket::sendfd_queue_for(const FileDescription& description)
+LocalSocket::PassedFileDescriptions& LocalSocket::sendfd_queue_for(const FileDescription& description)
 {
     auto role = this->role(description);
     if (role == Role::Connected)
@@ -463,33 +563,78 @@ NonnullRefPtrVector<FileDescription>& LocalSocket::sendfd_queue_for(const FileDe
     VERIFY_NOT_REACHED();
 }
 
-KResult LocalSocket::sendfd(const FileDescription& socket_description, FileDescription& passing_description)
+KResult LocalSocket::enqueue_passed_descriptions(const FileDescription& socket_description, NonnullRefPtrVector<FileDescription>&& passing_descriptions)
 {
     MutexLocker locker(lock());
     auto role = this->role(socket_description);
     if (role != Role::Connected && role != Role::Accepted)
         return EINVAL;
-    auto& queue = sendfd_queue_for(socket_description);
+    auto& passed_descriptions = sendfd_queue_for(socket_description);
+    if (auto result = make_room_for_passed_descriptions(passed_descriptions, passing_descriptions.size()); result.is_error())
+        return result;
+    for (auto& description : passing_descriptions)
+        passed_descriptions.queue.unchecked_append(description);
+    if (type() == SOCK_SEQPACKET)
+        passed_descriptions.unattached_count += passing_descriptions.size();
+    else
+        passed_descriptions.available_count += passing_descriptions.size();
+    return KSuccess;
+}
+
+KResult LocalSocket::make_room_for_passed_descriptions(PassedFileDescriptions& passed_descriptions, size_t count)
+{
+    VERIFY(lock().is_locked());
     // FIXME: Figure out how we should limit this properly.
-    if (queue.size() > 128)
+    if (passed_descriptions.queue.size() + count > 128)
         return EBUSY;
-    if (!queue.try_append(move(passing_description)))
+    if (!passed_descriptions.queue.try_ensure_capacity(passed_descriptions.queue.size() + count))
         return ENOMEM;
     return KSuccess;
 }
 
+KResult LocalSocket::sendfd(const FileDescription& socket_description, FileDescription& passing_description)
+{
+    NonnullRefPtrVector<FileDescription> passing_descriptions;
+    if (!passing_descriptions.try_append(passing_description))
+        return ENOMEM;
+    return enqueue_passed_descriptions(socket_description, move(passing_descriptions));
+}
+
+KResult LocalSocket::sendfds(const FileDescription& socket_description, NonnullRefPtrVector<FileDescription>&& passing_descriptions)
+{
+    return enqueue_passed_descriptions(socket_description, move(passing_descriptions));
+}
+
 KResultOr<NonnullRefPtr<FileDescription>> LocalSocket::recvfd(const FileDescription& socket_description)
 {
     MutexLocker locker(lock());
     auto role = this->role(socket_description);
     if (role != Role::Connected && role != Role::Accepted)
         return EINVAL;
-    auto& queue = recvfd_queue_for(socket_description);
-    if (queue.is_empty()) {
+    auto& passed_descriptions = recvfd_queue_for(socket_description);
+    if (passed_descriptions.available_count == 0) {
         // FIXME: Figure out the perfect error code for this.
         return EAGAIN;
     }
-    return queue.take_first();
+    --passed_descriptions.available_count;
+    return passed_descriptions.queue.take_first();
+}
+
+NonnullRefPtrVector<FileDescription> LocalSocket::recvfds(const FileDescription& socket_description, size_t max_count)
+{
+    MutexLocker locker(lock());
+    NonnullRefPtrVector<FileDescription> descriptions;
+    auto role = this->role(socket_description);
+    if (role != Role::Connected && role != Role::Accepted)
+        return descriptions;
+    auto& passed_descriptions = recvfd_queue_for(socket_description);
+    size_t count = min(max_count, passed_descriptions.available_count);
+    if (!descriptions.try_ensure_capacity(count))
+        return descriptions;
+    for (size_t i = 0; i < count; ++i)
+        descriptions.unchecked_append(passed_descriptions.queue.take_first());
+    passed_descriptions.available_count -= count;
+    return descriptions;
 }
 
 }
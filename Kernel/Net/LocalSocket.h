@@ -27,7 +27,12 @@ public:
     virtual ~LocalSocket() override;
 
     KResult sendfd(const FileDescription& socket_description, FileDescription& passing_description);
+    KResult sendfds(const FileDescription& socket_description, NonnullRefPtrVector<FileDescription>&& passing_descriptions);
+    // Sends the data and passes the file descriptions along with it in one go. They are only passed if the data is sent.
+    KResultOr<size_t> sendto_with_descriptions(FileDescription&, const UserOrKernelBuffer&, size_t, NonnullRefPtrVector<FileDescription>&& passing_descriptions);
     KResultOr<NonnullRefPtr<FileDescription>> recvfd(const FileDescription& socket_description);
+    // Takes up to `max_count` of the file descriptions that have been passed to us and can be handed out.
+    NonnullRefPtrVector<FileDescription> recvfds(const FileDescription& socket_description, size_t max_count);
 
     static void for_each(Function<void(const LocalSocket&)>);
 
@@ -57,8 +62,26 @@ private:
     bool has_attached_peer(const FileDescription&) const;
     DoubleBuffer* receive_buffer_for(FileDescription&);
     DoubleBuffer* send_buffer_for(FileDescription&);
-    NonnullRefPtrVector<FileDescription>& sendfd_queue_for(const FileDescription&);
-    NonnullRefPtrVector<FileDescription>& recvfd_queue_for(const FileDescription&);
+
+    struct PassedFileDescriptions {
+        NonnullRefPtrVector<FileDescription> queue;
+        // On SOCK_SEQPACKET sockets, file descriptions go along with the next message that is sent, and can't
+        // be taken before that message has been read. Everything else is available right away.
+        size_t available_count { 0 };
+        size_t unattached_count { 0 };
+    };
+    PassedFileDescriptions& sendfd_queue_for(const FileDescription&);
+    PassedFileDescriptions& recvfd_queue_for(const FileDescription&);
+    KResult enqueue_passed_descriptions(const FileDescription& socket_description, NonnullRefPtrVector<FileDescription>&&);
+    KResult make_room_for_passed_descriptions(PassedFileDescriptions&, size_t count);
+
+    // Every message on a SOCK_SEQPACKET socket is preceded by one of these in the buffer.
+    struct [[gnu::packed]] MessageHeader {
+        u32 size;
+        u32 fd_count;
+    };
+    KResultOr<size_t> send_message(FileDescription&, const UserOrKernelBuffer&, size_t, NonnullRefPtrVector<FileDescription>&& passing_descriptions);
+    KResultOr<size_t> receive_message(FileDescription&, UserOrKernelBuffer&, size_t, int flags);
 
     void set_connect_side_role(Role connect_side_role, bool force_evaluate_block_conditions = false)
     {
@@ -93,11 +116,14 @@ private:
     bool m_accept_side_fd_open { false };
     sockaddr_un m_address { 0, { 0 } };
 
-    DoubleBuffer m_for_client;
-    DoubleBuffer m_for_server;
+    // The buffers start out small, since most connections never have much in flight at a time.
+    static constexpr size_t initial_buffer_capacity = 16 * KiB;
+    static constexpr size_t maximum_buffer_capacity = 1 * MiB;
+    DoubleBuffer m_for_client { initial_buffer_capacity, maximum_buffer_capacity };
+    DoubleBuffer m_for_server { initial_buffer_capacity, maximum_buffer_capacity };
 
-    NonnullRefPtrVector<FileDescription> m_fds_for_client;
-    NonnullRefPtrVector<FileDescription> m_fds_for_server;
+    PassedFileDescriptions m_fds_for_client;
+    PassedFileDescriptions m_fds_for_server;
 
     IntrusiveListNode<LocalSocket> m_list_node;
 
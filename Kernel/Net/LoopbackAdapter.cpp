@@ -5,7 +5,9 @@
  */
 
 #include <AK/Singleton.h>
+#include <Kernel/Debug.h>
 #include <Kernel/Net/LoopbackAdapter.h>
+#include <Kernel/Net/NetworkTask.h>
 
 namespace Kernel {
 
@@ -21,7 +23,8 @@ LoopbackAdapter::LoopbackAdapter()
     VERIFY(!s_loopback_initialized);
     s_loopback_initialized = true;
     set_loopback_name();
-    set_mtu(65536);
+    // As large as an IPv4 packet can get, anything more wouldn't fit into its length field.
+    set_mtu(65535);
     set_mac_address({ 19, 85, 2, 9, 0x55, 0xaa });
 }
 
@@ -31,8 +34,24 @@ LoopbackAdapter::~LoopbackAdapter()
 
 void LoopbackAdapter::send_raw(ReadonlyBytes payload)
 {
-    dbgln("LoopbackAdapter: Sending {} byte(s) to myself.", payload.size());
+    dbgln_if(LOOPBACK_DEBUG, "LoopbackAdapter: Sending {} byte(s) to myself.", payload.size());
     did_receive(payload);
 }
 
+void LoopbackAdapter::send_raw_with_tcp_offload(ReadonlyBytes payload)
+{
+    // The receiving side never looks at the checksum, so the partial one can stay as it is.
+    send_raw(payload);
+}
+
+void LoopbackAdapter::deliver_udp_packet(NonnullRefPtr<PacketWithTimestamp> packet)
+{
+    size_t packet_size = packet->buffer.size();
+    dbgln_if(LOOPBACK_DEBUG, "LoopbackAdapter: Delivering {} byte datagram to myself.", packet_size);
+    count_sent_packet(packet_size);
+    count_received_packet(packet_size);
+    ReadonlyBytes ipv4_packet_bytes { packet->buffer.data() + layer3_payload_offset(), packet_size - layer3_payload_offset() };
+    NetworkTask::deliver_udp_packet(PacketBufferView { *this, move(packet), ipv4_packet_bytes });
+}
+
 }
@@ -21,8 +21,16 @@ public:
     virtual ~LoopbackAdapter() override;
 
     virtual void send_raw(ReadonlyBytes) override;
+    virtual void send_raw_with_tcp_offload(ReadonlyBytes) override;
     virtual StringView class_name() const override { return "LoopbackAdapter"; }
     virtual bool link_up() override { return true; }
+
+    // Nothing we send ever leaves the machine, so there's no point in computing checksums.
+    virtual bool has_tcp_checksum_offload() const override { return true; }
+
+    // Hands a UDP datagram that has been set up in one of our packet buffers straight to the socket
+    // it's for, without copying it or making a detour through the NetworkTask.
+    void deliver_udp_packet(NonnullRefPtr<PacketWithTimestamp>);
 };
 
 }
@@ -5,11 +5,11 @@
  */
 
 #include <AK/StringBuilder.h>
-#include <Kernel/Arch/x86/InterruptDisabler.h>
 #include <Kernel/Heap/kmalloc.h>
 #include <Kernel/Net/EtherType.h>
 #include <Kernel/Net/NetworkAdapter.h>
 #include <Kernel/Net/NetworkingManagement.h>
+#include <Kernel/Net/Routing.h>
 #include <Kernel/Process.h>
 #include <Kernel/StdLib.h>
 
@@ -23,10 +23,46 @@ NetworkAdapter::~NetworkAdapter()
 {
 }
 
-void NetworkAdapter::send_packet(ReadonlyBytes packet)
+void NetworkAdapter::count_sent_packet(size_t size)
 {
+    ScopedSpinLock lock(m_packets_lock);
     m_packets_out++;
-    m_bytes_out += packet.size();
+    m_bytes_out += size;
+}
+
+void NetworkAdapter::count_received_packet(size_t size)
+{
+    ScopedSpinLock lock(m_packets_lock);
+    m_packets_in++;
+    m_bytes_in += size;
+}
+
+void NetworkAdapter::count_dropped_packet()
+{
+    ScopedSpinLock lock(m_packets_lock);
+    m_packets_dropped++;
+}
+
+void NetworkAdapter::count_receive_error()
+{
+    ScopedSpinLock lock(m_packets_lock);
+    m_receive_errors++;
+}
+
+void NetworkAdapter::count_send_error()
+{
+    ScopedSpinLock lock(m_packets_lock);
+    m_send_errors++;
+}
+
+void NetworkAdapter::send_packet(ReadonlyBytes packet, TransmitOffload offload)
+{
+    count_sent_packet(packet.size());
+    if (offload == TransmitOffload::TCPChecksum) {
+        VERIFY(has_tcp_checksum_offload());
+        send_raw_with_tcp_offload(packet);
+        return;
+    }
     send_raw(packet);
 }
 
@@ -45,7 +81,7 @@ void NetworkAdapter::send(const MACAddress& destination, const ARPPacket& packet
 void NetworkAdapter::fill_in_ipv4_header(PacketWithTimestamp& packet, IPv4Address const& source_ipv4, MACAddress const& destination_mac, IPv4Address const& destination_ipv4, IPv4Protocol protocol, size_t payload_size, u8 ttl)
 {
     size_t ipv4_packet_size = sizeof(IPv4Packet) + payload_size;
-    VERIFY(ipv4_packet_size <= mtu());
+    VERIFY(ipv4_packet_size <= mtu() || (protocol == IPv4Protocol::TCP && ipv4_packet_size <= tcp_segmentation_offload_size()));
 
     size_t ethernet_frame_size = ipv4_payload_offset() + payload_size;
     VERIFY(packet.buffer.size() == ethernet_frame_size);
@@ -66,62 +102,95 @@ void NetworkAdapter::fill_in_ipv4_header(PacketWithTimestamp& packet, IPv4Addres
     ipv4.set_checksum(ipv4.compute_checksum());
 }
 
-void NetworkAdapter::did_receive(ReadonlyBytes payload)
+void NetworkAdapter::fill_in_ipv6_header(PacketWithTimestamp& packet, IPv6Address const& source_ipv6, MACAddress const& destination_mac, IPv6Address const& destination_ipv6, IPv6NextHeader next_header, size_t payload_size, u8 hop_limit)
 {
-    InterruptDisabler disabler;
-    m_packets_in++;
-    m_bytes_in += payload.size();
+    VERIFY(sizeof(IPv6Packet) + payload_size <= mtu());
 
-    if (m_packet_queue_size == max_packet_buffers) {
-        // FIXME: Keep track of the number of dropped packets
-        return;
+    size_t ethernet_frame_size = ipv6_payload_offset() + payload_size;
+    VERIFY(packet.buffer.size() == ethernet_frame_size);
+    memset(packet.buffer.data(), 0, ipv6_payload_offset());
+    auto& eth = *(EthernetFrameHeader*)packet.buffer.data();
+    eth.set_source(mac_address());
+    eth.set_destination(destination_mac);
+    eth.set_ether_type(EtherType::IPv6);
+    auto& ipv6 = *(IPv6Packet*)eth.payload();
+    ipv6.set_version_class_and_flow(6, 0, 0);
+    ipv6.set_payload_length(payload_size);
+    ipv6.set_next_header((u8)next_header);
+    ipv6.set_hop_limit(hop_limit);
+    ipv6.set_source(source_ipv6);
+    ipv6.set_destination(destination_ipv6);
+}
+
+void NetworkAdapter::did_receive(ReadonlyBytes payload)
+{
+    count_received_packet(payload.size());
+    {
+        ScopedSpinLock lock(m_packets_lock);
+        if (m_packet_queue_size == max_packet_buffers) {
+            m_receive_queue_full++;
+            return;
+        }
     }
 
     auto packet = acquire_packet_buffer(payload.size());
     if (!packet) {
         dbgln("Discarding packet because we're out of memory");
+        count_dropped_packet();
         return;
     }
 
     memcpy(packet->buffer.data(), payload.data(), payload.size());
 
-    m_packet_queue.append(*packet);
-    m_packet_queue_size++;
+    {
+        ScopedSpinLock lock(m_packets_lock);
+        m_packet_queue.append(*packet);
+        m_packet_queue_size++;
+    }
 
     if (on_receive)
         on_receive();
 }
 
-size_t NetworkAdapter::dequeue_packet(u8* buffer, size_t buffer_size, Time& packet_timestamp)
+void NetworkAdapter::schedule_receive_polling()
 {
-    InterruptDisabler disabler;
-    if (m_packet_queue.is_empty())
+    m_receive_polling_scheduled.store(true, AK::MemoryOrder::memory_order_release);
+    if (on_receive)
+        on_receive();
+}
+
+size_t NetworkAdapter::poll_receive(size_t budget)
+{
+    if (!m_receive_polling_scheduled.load(AK::MemoryOrder::memory_order_acquire))
         return 0;
-    auto packet_with_timestamp = m_packet_queue.take_first();
+    auto frame_count = receive_frames(budget);
+    if (frame_count < budget) {
+        // The ring is empty, so we're done until the next interrupt. This has to be cleared before the
+        // interrupts are back on, otherwise we could miss that they've already scheduled us again.
+        m_receive_polling_scheduled.store(false, AK::MemoryOrder::memory_order_release);
+        enable_receive_interrupts();
+    }
+    return frame_count;
+}
+
+RefPtr<PacketWithTimestamp> NetworkAdapter::dequeue_packet()
+{
+    ScopedSpinLock lock(m_packets_lock);
+    if (m_packet_queue.is_empty())
+        return nullptr;
     m_packet_queue_size--;
-    packet_timestamp = packet_with_timestamp->timestamp;
-    auto& packet_buffer = packet_with_timestamp->buffer;
-    size_t packet_size = packet_buffer.size();
-    VERIFY(packet_size <= buffer_size);
-    memcpy(buffer, packet_buffer.data(), packet_size);
-    release_packet_buffer(*packet_with_timestamp);
-    return packet_size;
+    return m_packet_queue.take_first();
 }
 
 RefPtr<PacketWithTimestamp> NetworkAdapter::acquire_packet_buffer(size_t size)
 {
-    InterruptDisabler disabler;
-    if (m_unused_packets.is_empty()) {
-        auto buffer = KBuffer::create_with_size(size, Region::Access::Read | Region::Access::Write, "Packet Buffer", AllocationStrategy::AllocateNow);
-        auto packet = adopt_ref_if_nonnull(new (nothrow) PacketWithTimestamp { move(buffer), kgettimeofday() });
-        if (!packet)
-            return nullptr;
-        packet->buffer.set_size(size);
-        return packet;
+    RefPtr<PacketWithTimestamp> packet;
+    {
+        ScopedSpinLock lock(m_packets_lock);
+        if (!m_unused_packets.is_empty())
+            packet = m_unused_packets.take_first();
     }
-
-    auto packet = m_unused_packets.take_first();
-    if (packet->buffer.capacity() >= size) {
+    if (packet && packet->buffer.capacity() >= size) {
         packet->timestamp = kgettimeofday();
         packet->buffer.set_size(size);
         return packet;
@@ -137,23 +206,26 @@ RefPtr<PacketWithTimestamp> NetworkAdapter::acquire_packet_buffer(size_t size)
 
 void NetworkAdapter::release_packet_buffer(PacketWithTimestamp& packet)
 {
-    InterruptDisabler disabler;
+    ScopedSpinLock lock(m_packets_lock);
     m_unused_packets.append(packet);
 }
 
 void NetworkAdapter::set_ipv4_address(const IPv4Address& address)
 {
     m_ipv4_address = address;
+    RoutingTable::the().update_adapter_routes(*this);
 }
 
 void NetworkAdapter::set_ipv4_netmask(const IPv4Address& netmask)
 {
     m_ipv4_netmask = netmask;
+    RoutingTable::the().update_adapter_routes(*this);
 }
 
 void NetworkAdapter::set_ipv4_gateway(const IPv4Address& gateway)
 {
     m_ipv4_gateway = gateway;
+    RoutingTable::the().update_adapter_routes(*this);
 }
 
 void NetworkAdapter::set_interface_name(const PCI::Address& pci_address)
@@ -170,4 +242,75 @@ void NetworkAdapter::set_loopback_name()
     VERIFY(!NetworkingManagement::the().lookup_by_name(name));
     m_name = move(name);
 }
+
+PacketBufferView::PacketBufferView(NetworkAdapter& adapter, NonnullRefPtr<PacketWithTimestamp> packet, ReadonlyBytes bytes)
+    : m_adapter(adapter)
+    , m_packet(move(packet))
+    , m_bytes(bytes)
+{
+    VERIFY(m_bytes.data() >= m_packet->buffer.data() && m_bytes.data() + m_bytes.size() <= m_packet->buffer.data() + m_packet->buffer.size());
+}
+
+PacketBufferView::PacketBufferView(const PacketBufferView& other)
+    : m_adapter(other.m_adapter)
+    , m_packet(other.m_packet)
+    , m_bytes(other.m_bytes)
+{
+}
+
+PacketBufferView::PacketBufferView(PacketBufferView&& other)
+    : m_adapter(move(other.m_adapter))
+    , m_packet(move(other.m_packet))
+    , m_bytes(exchange(other.m_bytes, {}))
+{
+}
+
+PacketBufferView::~PacketBufferView()
+{
+    release();
+}
+
+PacketBufferView& PacketBufferView::operator=(const PacketBufferView& other)
+{
+    if (this != &other) {
+        release();
+        m_adapter = other.m_adapter;
+        m_packet = other.m_packet;
+        m_bytes = other.m_bytes;
+    }
+    return *this;
+}
+
+PacketBufferView& PacketBufferView::operator=(PacketBufferView&& other)
+{
+    if (this != &other) {
+        release();
+        m_adapter = move(other.m_adapter);
+        m_packet = move(other.m_packet);
+        m_bytes = exchange(other.m_bytes, {});
+    }
+    return *this;
+}
+
+PacketBufferView PacketBufferView::slice(size_t offset, size_t length) const
+{
+    VERIFY(m_packet);
+    PacketBufferView view { *this };
+    view.m_bytes = m_bytes.slice(offset, length);
+    return view;
+}
+
+void PacketBufferView::release()
+{
+    if (!m_packet)
+        return;
+    // New views can only be made from existing ones, so nobody can get a hold of the packet after we've let go of the last one.
+    if (m_packet->ref_count() == 1) {
+        if (auto adapter = m_adapter.strong_ref())
+            adapter->release_packet_buffer(*m_packet);
+    }
+    m_packet = nullptr;
+    m_bytes = {};
+}
+
 }
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
 #include <AK/ByteBuffer.h>
 #include <AK/Function.h>
 #include <AK/IntrusiveList.h>
@@ -19,6 +20,8 @@
 #include <Kernel/Net/EthernetFrameHeader.h>
 #include <Kernel/Net/ICMP.h>
 #include <Kernel/Net/IPv4.h>
+#include <Kernel/Net/IPv6.h>
+#include <Kernel/SpinLock.h>
 #include <Kernel/UserOrKernelBuffer.h>
 
 namespace Kernel {
@@ -52,43 +55,80 @@ public:
     IPv4Address ipv4_netmask() const { return m_ipv4_netmask; }
     IPv4Address ipv4_broadcast() const { return IPv4Address { (m_ipv4_address.to_u32() & m_ipv4_netmask.to_u32()) | ~m_ipv4_netmask.to_u32() }; }
     IPv4Address ipv4_gateway() const { return m_ipv4_gateway; }
+    IPv6Address ipv6_link_local_address() const { return Kernel::ipv6_link_local_address(m_mac_address); }
     virtual bool link_up() { return false; }
 
+    // Adapters that can compute TCP checksums themselves are handed TCP packets with only the pseudo header
+    // summed up in the checksum field. They may also be given TCP packets of up to tcp_segmentation_offload_size()
+    // bytes, which they have to send as MTU-sized segments.
+    virtual bool has_tcp_checksum_offload() const { return false; }
+    virtual size_t tcp_segmentation_offload_size() const { return 0; }
+
     void set_ipv4_address(const IPv4Address&);
     void set_ipv4_netmask(const IPv4Address&);
     void set_ipv4_gateway(const IPv4Address&);
 
     void send(const MACAddress&, const ARPPacket&);
     void fill_in_ipv4_header(PacketWithTimestamp&, IPv4Address const&, MACAddress const&, IPv4Address const&, IPv4Protocol, size_t, u8);
+    void fill_in_ipv6_header(PacketWithTimestamp&, IPv6Address const&, MACAddress const&, IPv6Address const&, IPv6NextHeader, size_t, u8);
 
-    size_t dequeue_packet(u8* buffer, size_t buffer_size, Time& packet_timestamp);
+    RefPtr<PacketWithTimestamp> dequeue_packet();
 
     bool has_queued_packets() const { return !m_packet_queue.is_empty(); }
 
     u32 mtu() const { return m_mtu; }
     void set_mtu(u32 mtu) { m_mtu = mtu; }
 
-    u32 packets_in() const { return m_packets_in; }
-    u32 bytes_in() const { return m_bytes_in; }
-    u32 packets_out() const { return m_packets_out; }
-    u32 bytes_out() const { return m_bytes_out; }
+    u64 packets_in() const { return m_packets_in; }
+    u64 bytes_in() const { return m_bytes_in; }
+    u64 packets_out() const { return m_packets_out; }
+    u64 bytes_out() const { return m_bytes_out; }
+    // Packets that were received but never made it into the queue, either because it was full or for some other reason.
+    u64 receive_queue_full() const { return m_receive_queue_full; }
+    u64 packets_dropped() const { return m_packets_dropped; }
+    u64 receive_errors() const { return m_receive_errors; }
+    u64 send_errors() const { return m_send_errors; }
 
     RefPtr<PacketWithTimestamp> acquire_packet_buffer(size_t);
     void release_packet_buffer(PacketWithTimestamp&);
 
     constexpr size_t layer3_payload_offset() const { return sizeof(EthernetFrameHeader); }
     constexpr size_t ipv4_payload_offset() const { return layer3_payload_offset() + sizeof(IPv4Packet); }
+    constexpr size_t ipv6_payload_offset() const { return layer3_payload_offset() + sizeof(IPv6Packet); }
 
     Function<void()> on_receive;
 
-    void send_packet(ReadonlyBytes);
+    enum class TransmitOffload {
+        None,
+        TCPChecksum,
+    };
+
+    void send_packet(ReadonlyBytes, TransmitOffload = TransmitOffload::None);
+
+    // Adapters that support polling stop raising receive interrupts once a frame has arrived, and leave it
+    // to the NetworkTask to take up to `budget` frames at a time off their ring, until they've all been taken.
+    // Returns how many frames were taken, which is 0 if there was nothing to poll for.
+    size_t poll_receive(size_t budget);
 
 protected:
     NetworkAdapter();
     void set_interface_name(const PCI::Address&);
     void set_mac_address(const MACAddress& mac_address) { m_mac_address = mac_address; }
     void did_receive(ReadonlyBytes);
+    // Called by drivers that support polling from their IRQ handler, once they have disabled their receive interrupts.
+    void schedule_receive_polling();
+    // Takes up to `budget` frames off the receive ring and passes each of them to did_receive().
+    virtual size_t receive_frames(size_t) { VERIFY_NOT_REACHED(); }
+    // Turns receive interrupts back on. A frame that arrived after the last call to receive_frames() has to be
+    // noticed here, by scheduling another round of polling, because it may not raise an interrupt of its own.
+    virtual void enable_receive_interrupts() { VERIFY_NOT_REACHED(); }
+    void count_sent_packet(size_t);
+    void count_received_packet(size_t);
+    void count_dropped_packet();
+    void count_receive_error();
+    void count_send_error();
     virtual void send_raw(ReadonlyBytes) = 0;
+    virtual void send_raw_with_tcp_offload(ReadonlyBytes) { VERIFY_NOT_REACHED(); }
 
     void set_loopback_name();
 
@@ -103,15 +143,49 @@ private:
 
     using PacketList = IntrusiveList<PacketWithTimestamp, RefPtr<PacketWithTimestamp>, &PacketWithTimestamp::packet_node>;
 
+    // Every adapter has a receive thread of its own, but packets are also acquired and
+    // released by whoever sends them, and queued up by the IRQ handler.
+    SpinLock<u8> m_packets_lock;
     PacketList m_packet_queue;
     size_t m_packet_queue_size { 0 };
     PacketList m_unused_packets;
+    Atomic<bool> m_receive_polling_scheduled { false };
     String m_name;
-    u32 m_packets_in { 0 };
-    u32 m_bytes_in { 0 };
-    u32 m_packets_out { 0 };
-    u32 m_bytes_out { 0 };
+    u64 m_packets_in { 0 };
+    u64 m_bytes_in { 0 };
+    u64 m_packets_out { 0 };
+    u64 m_bytes_out { 0 };
+    u64 m_receive_queue_full { 0 };
+    u64 m_packets_dropped { 0 };
+    u64 m_receive_errors { 0 };
+    u64 m_send_errors { 0 };
     u32 m_mtu { 1500 };
 };
 
+// A part of a received packet. Sockets hold on to these instead of copying the data somewhere else,
+// and once the last view of a packet goes away, its buffer is handed back to the adapter it came from.
+class PacketBufferView {
+public:
+    PacketBufferView(NetworkAdapter&, NonnullRefPtr<PacketWithTimestamp>, ReadonlyBytes);
+    PacketBufferView(const PacketBufferView&);
+    PacketBufferView(PacketBufferView&&);
+    ~PacketBufferView();
+
+    PacketBufferView& operator=(const PacketBufferView&);
+    PacketBufferView& operator=(PacketBufferView&&);
+
+    ReadonlyBytes bytes() const { return m_bytes; }
+    size_t size() const { return m_bytes.size(); }
+    const Time& timestamp() const { return m_packet->timestamp; }
+
+    PacketBufferView slice(size_t offset, size_t length) const;
+
+private:
+    void release();
+
+    WeakPtr<NetworkAdapter> m_adapter;
+    RefPtr<PacketWithTimestamp> m_packet;
+    ReadonlyBytes m_bytes;
+};
+
 }
@@ -10,8 +10,10 @@
 #include <Kernel/Net/EtherType.h>
 #include <Kernel/Net/EthernetFrameHeader.h>
 #include <Kernel/Net/ICMP.h>
+#include <Kernel/Net/ICMPv6.h>
 #include <Kernel/Net/IPv4.h>
 #include <Kernel/Net/IPv4Socket.h>
+#include <Kernel/Net/IPv6.h>
 #include <Kernel/Net/LoopbackAdapter.h>
 #include <Kernel/Net/NetworkTask.h>
 #include <Kernel/Net/NetworkingManagement.h>
@@ -24,38 +26,43 @@
 
 namespace Kernel {
 
+// Sockets that owe their peer an ACK. Every receive thread has a set of its own.
+using DelayedACKSockets = HashTable<RefPtr<TCPSocket>>;
+
+// How many frames we take off an adapter's receive ring before handling them.
+static constexpr size_t receive_poll_budget = 64;
+
 static void handle_arp(const EthernetFrameHeader&, size_t frame_size);
-static void handle_ipv4(const EthernetFrameHeader&, size_t frame_size, const Time& packet_timestamp);
-static void handle_icmp(const EthernetFrameHeader&, const IPv4Packet&, const Time& packet_timestamp);
-static void handle_udp(const IPv4Packet&, const Time& packet_timestamp);
-static void handle_tcp(const IPv4Packet&, const Time& packet_timestamp);
-static void send_delayed_tcp_ack(RefPtr<TCPSocket> socket);
-static void flush_delayed_tcp_acks();
+static void handle_ipv4(const EthernetFrameHeader&, const PacketBufferView& frame, DelayedACKSockets&);
+static void handle_icmp(const EthernetFrameHeader&, const IPv4Packet&, const PacketBufferView& ipv4_packet_view);
+static void handle_udp(const IPv4Packet&, const PacketBufferView& ipv4_packet_view);
+static void handle_ipv6(NetworkAdapter&, const EthernetFrameHeader&, size_t frame_size);
+static void handle_icmpv6(NetworkAdapter&, const EthernetFrameHeader&, const IPv6Packet&);
+static void handle_tcp(const IPv4Packet&, const PacketBufferView& ipv4_packet_view, DelayedACKSockets&);
+static void send_delayed_tcp_ack(RefPtr<TCPSocket> socket, DelayedACKSockets&);
+static void flush_delayed_tcp_acks(DelayedACKSockets&);
 static void retransmit_tcp_packets();
 
-static Thread* network_task = nullptr;
-static HashTable<RefPtr<TCPSocket>>* delayed_ack_sockets;
+static Process* network_task = nullptr;
 
 [[noreturn]] static void NetworkTask_main(void*);
+[[noreturn]] static void NetworkTask_receive(void*);
 
 void NetworkTask::spawn()
 {
     RefPtr<Thread> thread;
-    Process::create_kernel_process(thread, "NetworkTask", NetworkTask_main, nullptr);
-    network_task = thread;
+    network_task = Process::create_kernel_process(thread, "NetworkTask", NetworkTask_main, nullptr).leak_ref();
 }
 
 bool NetworkTask::is_current()
 {
-    return Thread::current() == network_task;
+    return Process::current() == network_task;
 }
 
 void NetworkTask_main(void*)
 {
-    delayed_ack_sockets = new HashTable<RefPtr<TCPSocket>>;
-
-    WaitQueue packet_wait_queue;
-    int pending_packets = 0;
+    // Every adapter gets a receive thread of its own, so the packets of one adapter never
+    // wait behind those of another, and they can be processed on different processors.
     NetworkingManagement::the().for_each([&](auto& adapter) {
         dmesgln("NetworkTask: {} network adapter found: hw={}", adapter.class_name(), adapter.mac_address().to_string());
 
@@ -65,46 +72,50 @@ void NetworkTask_main(void*)
             adapter.set_ipv4_gateway({ 0, 0, 0, 0 });
         }
 
-        adapter.on_receive = [&]() {
-            pending_packets++;
-            packet_wait_queue.wake_all();
-        };
+        auto thread = network_task->create_kernel_thread(NetworkTask_receive, &adapter, THREAD_PRIORITY_NORMAL, String::formatted("NetworkTask: {}", adapter.name()), THREAD_AFFINITY_DEFAULT, false);
+        if (!thread)
+            dmesgln("NetworkTask: Couldn't create a receive thread for {}", adapter.name());
     });
 
-    auto dequeue_packet = [&pending_packets](u8* buffer, size_t buffer_size, Time& packet_timestamp) -> size_t {
-        if (pending_packets == 0)
-            return 0;
-        size_t packet_size = 0;
-        NetworkingManagement::the().for_each([&](auto& adapter) {
-            if (packet_size || !adapter.has_queued_packets())
-                return;
-            packet_size = adapter.dequeue_packet(buffer, buffer_size, packet_timestamp);
-            pending_packets--;
-            dbgln_if(NETWORK_TASK_DEBUG, "NetworkTask: Dequeued packet from {} ({} bytes)", adapter.name(), packet_size);
-        });
-        return packet_size;
-    };
+    // What's left for us are the retransmit timers, which work in steps of seconds anyway.
+    for (;;) {
+        retransmit_tcp_packets();
+        [[maybe_unused]] auto result = Thread::current()->sleep(Time::from_milliseconds(500));
+    }
+}
 
-    size_t buffer_size = 64 * KiB;
-    auto buffer_region = MM.allocate_kernel_region(buffer_size, "Kernel Packet Buffer", Region::Access::Read | Region::Access::Write);
-    auto buffer = (u8*)buffer_region->vaddr().get();
-    Time packet_timestamp;
+void NetworkTask_receive(void* data)
+{
+    auto& adapter = *static_cast<NetworkAdapter*>(data);
+    DelayedACKSockets delayed_ack_sockets;
+
+    WaitQueue packet_wait_queue;
+    adapter.on_receive = [&]() {
+        packet_wait_queue.wake_all();
+    };
 
     for (;;) {
-        flush_delayed_tcp_acks();
-        retransmit_tcp_packets();
-        size_t packet_size = dequeue_packet(buffer, buffer_size, packet_timestamp);
-        if (!packet_size) {
+        flush_delayed_tcp_acks(delayed_ack_sockets);
+        auto packet = adapter.has_queued_packets() ? adapter.dequeue_packet() : nullptr;
+        if (!packet) {
+            // Only once everything we've taken off the ring has been handled do we go back for more.
+            if (adapter.poll_receive(receive_poll_budget) > 0)
+                continue;
             auto timeout_time = Time::from_milliseconds(500);
             auto timeout = Thread::BlockTimeout { false, &timeout_time };
             [[maybe_unused]] auto result = packet_wait_queue.wait_on(timeout, "NetworkTask");
             continue;
         }
+        // The packet is handed to the sockets as it is, so whatever they keep of it is never copied until it's read.
+        ReadonlyBytes frame_bytes { packet->buffer.data(), packet->buffer.size() };
+        PacketBufferView frame { adapter, packet.release_nonnull(), frame_bytes };
+        size_t packet_size = frame.size();
+        dbgln_if(NETWORK_TASK_DEBUG, "NetworkTask: Dequeued packet from {} ({} bytes)", adapter.name(), packet_size);
         if (packet_size < sizeof(EthernetFrameHeader)) {
             dbgln("NetworkTask: Packet is too small to be an Ethernet packet! ({})", packet_size);
             continue;
         }
-        auto& eth = *(const EthernetFrameHeader*)buffer;
+        auto& eth = *(const EthernetFrameHeader*)frame.bytes().data();
         dbgln_if(ETHERNET_DEBUG, "NetworkTask: From {} to {}, ether_type={:#04x}, packet_size={}", eth.source().to_string(), eth.destination().to_string(), eth.ether_type(), packet_size);
 
         switch (eth.ether_type()) {
@@ -112,10 +123,10 @@ void NetworkTask_main(void*)
             handle_arp(eth, packet_size);
             break;
         case EtherType::IPv4:
-            handle_ipv4(eth, packet_size, packet_timestamp);
+            handle_ipv4(eth, frame, delayed_ack_sockets);
             break;
         case EtherType::IPv6:
-            // ignore
+            handle_ipv6(adapter, eth, packet_size);
             break;
         default:
             dbgln_if(ETHERNET_DEBUG, "NetworkTask: Unknown ethernet type {:#04x}", eth.ether_type());
@@ -171,8 +182,9 @@ void handle_arp(const EthernetFrameHeader& eth, size_t frame_size)
     }
 }
 
-void handle_ipv4(const EthernetFrameHeader& eth, size_t frame_size, const Time& packet_timestamp)
+void handle_ipv4(const EthernetFrameHeader& eth, const PacketBufferView& frame, DelayedACKSockets& delayed_ack_sockets)
 {
+    size_t frame_size = frame.size();
     constexpr size_t minimum_ipv4_frame_size = sizeof(EthernetFrameHeader) + sizeof(IPv4Packet);
     if (frame_size < minimum_ipv4_frame_size) {
         dbgln("handle_ipv4: Frame too small ({}, need {})", frame_size, minimum_ipv4_frame_size);
@@ -202,20 +214,21 @@ void handle_ipv4(const EthernetFrameHeader& eth, size_t frame_size, const Time&
         }
     });
 
+    auto ipv4_packet_view = frame.slice(sizeof(EthernetFrameHeader), sizeof(IPv4Packet) + packet.payload_size());
     switch ((IPv4Protocol)packet.protocol()) {
     case IPv4Protocol::ICMP:
-        return handle_icmp(eth, packet, packet_timestamp);
+        return handle_icmp(eth, packet, ipv4_packet_view);
     case IPv4Protocol::UDP:
-        return handle_udp(packet, packet_timestamp);
+        return handle_udp(packet, ipv4_packet_view);
     case IPv4Protocol::TCP:
-        return handle_tcp(packet, packet_timestamp);
+        return handle_tcp(packet, ipv4_packet_view, delayed_ack_sockets);
     default:
         dbgln_if(IPV4_DEBUG, "handle_ipv4: Unhandled protocol {:#02x}", packet.protocol());
         break;
     }
 }
 
-void handle_icmp(const EthernetFrameHeader& eth, const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
+void handle_icmp(const EthernetFrameHeader& eth, const IPv4Packet& ipv4_packet, const PacketBufferView& ipv4_packet_view)
 {
     auto& icmp_header = *static_cast<const ICMPHeader*>(ipv4_packet.payload());
     dbgln_if(ICMP_DEBUG, "handle_icmp: source={}, destination={}, type={:#02x}, code={:#02x}", ipv4_packet.source().to_string(), ipv4_packet.destination().to_string(), icmp_header.type(), icmp_header.code());
@@ -231,7 +244,7 @@ void handle_icmp(const EthernetFrameHeader& eth, const IPv4Packet& ipv4_packet,
             }
         }
         for (auto& socket : icmp_sockets)
-            socket.did_receive(ipv4_packet.source(), 0, { &ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size() }, packet_timestamp);
+            socket.did_receive(ipv4_packet.source(), 0, ipv4_packet_view);
     }
 
     auto adapter = NetworkingManagement::the().from_ipv4_address(ipv4_packet.destination());
@@ -268,7 +281,156 @@ void handle_icmp(const EthernetFrameHeader& eth, const IPv4Packet& ipv4_packet,
     }
 }
 
-void handle_udp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
+void handle_ipv6(NetworkAdapter& adapter, const EthernetFrameHeader& eth, size_t frame_size)
+{
+    constexpr size_t minimum_ipv6_frame_size = sizeof(EthernetFrameHeader) + sizeof(IPv6Packet);
+    if (frame_size < minimum_ipv6_frame_size) {
+        dbgln("handle_ipv6: Frame too small ({}, need {})", frame_size, minimum_ipv6_frame_size);
+        return;
+    }
+    auto& packet = *static_cast<const IPv6Packet*>(eth.payload());
+    if (packet.version() != 6)
+        return;
+
+    size_t actual_payload_length = frame_size - minimum_ipv6_frame_size;
+    if (packet.payload_length() > actual_payload_length) {
+        dbgln("handle_ipv6: IPv6 packet claims to be longer than it is ({}, actually {})", packet.payload_length(), actual_payload_length);
+        return;
+    }
+
+    dbgln_if(IPV6_DEBUG, "handle_ipv6: source={}, destination={}, next_header={}", packet.source(), packet.destination(), packet.next_header());
+
+    // We only have a link-local address, so that and the multicast groups that go with it are all we listen to.
+    auto our_address = adapter.ipv6_link_local_address();
+    auto& destination = packet.destination();
+    if (destination != our_address && destination != our_address.solicited_node_multicast_address() && destination != ipv6_all_nodes_address())
+        return;
+
+    switch ((IPv6NextHeader)packet.next_header()) {
+    case IPv6NextHeader::ICMPv6:
+        return handle_icmpv6(adapter, eth, packet);
+    default:
+        dbgln_if(IPV6_DEBUG, "handle_ipv6: Unhandled next header {}", packet.next_header());
+        break;
+    }
+}
+
+static void send_neighbor_advertisement(NetworkAdapter& adapter, const MACAddress& destination_mac, const IPv6Address& destination, bool solicited)
+{
+    constexpr size_t icmp_packet_size = sizeof(NeighborDiscoveryPacket) + sizeof(LinkLayerAddressOption);
+    auto ipv6_payload_offset = adapter.ipv6_payload_offset();
+    auto packet = adapter.acquire_packet_buffer(ipv6_payload_offset + icmp_packet_size);
+    if (!packet) {
+        dbgln("Could not allocate packet buffer while sending neighbor advertisement");
+        return;
+    }
+    auto our_address = adapter.ipv6_link_local_address();
+    // Neighbor discovery packets have to be sent with the maximum hop limit, so that nobody can forge them from afar.
+    adapter.fill_in_ipv6_header(*packet, our_address, destination_mac, destination, IPv6NextHeader::ICMPv6, icmp_packet_size, 255);
+    auto* icmp_data = packet->buffer.data() + ipv6_payload_offset;
+    memset(icmp_data, 0, icmp_packet_size);
+    auto& advertisement = *(NeighborDiscoveryPacket*)icmp_data;
+    advertisement.header.set_type(ICMPv6Type::NeighborAdvertisement);
+    advertisement.flags = (u32)NeighborDiscoveryPacket::Override | (solicited ? (u32)NeighborDiscoveryPacket::Solicited : 0u);
+    advertisement.target = our_address;
+    auto& option = *(LinkLayerAddressOption*)(icmp_data + sizeof(NeighborDiscoveryPacket));
+    option.type = NeighborDiscoveryOption::TargetLinkLayerAddress;
+    option.length_in_units_of_8_bytes = 1;
+    option.address = adapter.mac_address();
+    advertisement.header.set_checksum(ipv6_upper_layer_checksum(our_address, destination, IPv6NextHeader::ICMPv6, icmp_data, icmp_packet_size));
+    adapter.send_packet({ packet->buffer.data(), packet->buffer.size() });
+    adapter.release_packet_buffer(*packet);
+}
+
+static Optional<MACAddress> link_layer_address_option(const NeighborDiscoveryPacket& packet, size_t packet_size, u8 option_type)
+{
+    size_t offset = sizeof(NeighborDiscoveryPacket);
+    while (offset + 2 <= packet_size) {
+        auto* option = (const u8*)&packet + offset;
+        size_t option_size = option[1] * 8;
+        if (option_size == 0 || offset + option_size > packet_size)
+            return {};
+        if (option[0] == option_type && option_size >= sizeof(LinkLayerAddressOption))
+            return reinterpret_cast<const LinkLayerAddressOption*>(option)->address;
+        offset += option_size;
+    }
+    return {};
+}
+
+void handle_icmpv6(NetworkAdapter& adapter, const EthernetFrameHeader& eth, const IPv6Packet& ipv6_packet)
+{
+    size_t icmp_packet_size = ipv6_packet.payload_length();
+    if (icmp_packet_size < sizeof(ICMPv6Header))
+        return;
+    if (ipv6_upper_layer_checksum(ipv6_packet.source(), ipv6_packet.destination(), IPv6NextHeader::ICMPv6, ipv6_packet.payload(), icmp_packet_size) != 0) {
+        dbgln_if(IPV6_DEBUG, "handle_icmpv6: Bad checksum from {}", ipv6_packet.source());
+        return;
+    }
+    auto& icmp_header = *static_cast<const ICMPv6Header*>(ipv6_packet.payload());
+    dbgln_if(IPV6_DEBUG, "handle_icmpv6: source={}, destination={}, type={}, code={}", ipv6_packet.source(), ipv6_packet.destination(), icmp_header.type(), icmp_header.code());
+
+    switch (icmp_header.type()) {
+    case ICMPv6Type::EchoRequest: {
+        if (icmp_packet_size < sizeof(ICMPv6EchoPacket) || ipv6_packet.destination().is_multicast())
+            return;
+        auto& request = reinterpret_cast<const ICMPv6EchoPacket&>(icmp_header);
+        auto ipv6_payload_offset = adapter.ipv6_payload_offset();
+        auto packet = adapter.acquire_packet_buffer(ipv6_payload_offset + icmp_packet_size);
+        if (!packet) {
+            dbgln("Could not allocate packet buffer while sending ICMPv6 packet");
+            return;
+        }
+        auto our_address = adapter.ipv6_link_local_address();
+        adapter.fill_in_ipv6_header(*packet, our_address, eth.source(), ipv6_packet.source(), IPv6NextHeader::ICMPv6, icmp_packet_size, 64);
+        auto* icmp_data = packet->buffer.data() + ipv6_payload_offset;
+        memcpy(icmp_data, &request, icmp_packet_size);
+        auto& response = *(ICMPv6EchoPacket*)icmp_data;
+        response.header.set_type(ICMPv6Type::EchoReply);
+        response.header.set_code(0);
+        response.header.set_checksum(0);
+        response.header.set_checksum(ipv6_upper_layer_checksum(our_address, ipv6_packet.source(), IPv6NextHeader::ICMPv6, icmp_data, icmp_packet_size));
+        adapter.send_packet({ packet->buffer.data(), packet->buffer.size() });
+        adapter.release_packet_buffer(*packet);
+        return;
+    }
+    case ICMPv6Type::NeighborSolicitation: {
+        if (icmp_packet_size < sizeof(NeighborDiscoveryPacket) || ipv6_packet.hop_limit() != 255)
+            return;
+        auto& solicitation = reinterpret_cast<const NeighborDiscoveryPacket&>(icmp_header);
+        if (solicitation.target != adapter.ipv6_link_local_address())
+            return;
+        // Duplicate address detection comes from the unspecified address, and is answered to all nodes.
+        if (ipv6_packet.source().is_zero()) {
+            auto all_nodes = ipv6_all_nodes_address();
+            send_neighbor_advertisement(adapter, ipv6_multicast_ethernet_address(all_nodes), all_nodes, false);
+            return;
+        }
+        auto source_mac = link_layer_address_option(solicitation, icmp_packet_size, NeighborDiscoveryOption::SourceLinkLayerAddress).value_or(eth.source());
+        update_neighbor_table(ipv6_packet.source(), source_mac, UpdateArp::Set);
+        send_neighbor_advertisement(adapter, source_mac, ipv6_packet.source(), true);
+        return;
+    }
+    case ICMPv6Type::NeighborAdvertisement: {
+        if (icmp_packet_size < sizeof(NeighborDiscoveryPacket) || ipv6_packet.hop_limit() != 255)
+            return;
+        auto& advertisement = reinterpret_cast<const NeighborDiscoveryPacket&>(icmp_header);
+        auto target_mac = link_layer_address_option(advertisement, icmp_packet_size, NeighborDiscoveryOption::TargetLinkLayerAddress).value_or(eth.source());
+        update_neighbor_table(advertisement.target, target_mac, UpdateArp::Set);
+        return;
+    }
+    default:
+        return;
+    }
+}
+
+void NetworkTask::deliver_udp_packet(const PacketBufferView& ipv4_packet_view)
+{
+    auto& ipv4_packet = *reinterpret_cast<const IPv4Packet*>(ipv4_packet_view.bytes().data());
+    VERIFY(ipv4_packet.protocol() == (u8)IPv4Protocol::UDP);
+    handle_udp(ipv4_packet, ipv4_packet_view);
+}
+
+void handle_udp(const IPv4Packet& ipv4_packet, const PacketBufferView& ipv4_packet_view)
 {
     if (ipv4_packet.payload_size() < sizeof(UDPPacket)) {
         dbgln("handle_udp: Packet too small ({}, need {})", ipv4_packet.payload_size(), sizeof(UDPPacket));
@@ -293,10 +455,10 @@ void handle_udp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
     auto& destination = ipv4_packet.destination();
 
     if (destination == IPv4Address(255, 255, 255, 255) || NetworkingManagement::the().from_ipv4_address(destination) || socket->multicast_memberships().contains_slow(destination))
-        socket->did_receive(ipv4_packet.source(), udp_packet.source_port(), { &ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size() }, packet_timestamp);
+        socket->did_receive(ipv4_packet.source(), udp_packet.source_port(), ipv4_packet_view);
 }
 
-void send_delayed_tcp_ack(RefPtr<TCPSocket> socket)
+void send_delayed_tcp_ack(RefPtr<TCPSocket> socket, DelayedACKSockets& delayed_ack_sockets)
 {
     VERIFY(socket->lock().is_locked());
     if (!socket->should_delay_next_ack()) {
@@ -304,13 +466,13 @@ void send_delayed_tcp_ack(RefPtr<TCPSocket> socket)
         return;
     }
 
-    delayed_ack_sockets->set(move(socket));
+    delayed_ack_sockets.set(move(socket));
 }
 
-void flush_delayed_tcp_acks()
+void flush_delayed_tcp_acks(DelayedACKSockets& delayed_ack_sockets)
 {
     Vector<RefPtr<TCPSocket>, 32> remaining_sockets;
-    for (auto& socket : *delayed_ack_sockets) {
+    for (auto& socket : delayed_ack_sockets) {
         MutexLocker locker(socket->lock());
         if (socket->should_delay_next_ack()) {
             remaining_sockets.append(socket);
@@ -319,16 +481,16 @@ void flush_delayed_tcp_acks()
         [[maybe_unused]] auto result = socket->send_ack();
     }
 
-    if (remaining_sockets.size() != delayed_ack_sockets->size()) {
-        delayed_ack_sockets->clear();
+    if (remaining_sockets.size() != delayed_ack_sockets.size()) {
+        delayed_ack_sockets.clear();
         if (remaining_sockets.size() > 0)
             dbgln("flush_delayed_tcp_acks: {} sockets remaining", remaining_sockets.size());
         for (auto&& socket : remaining_sockets)
-            delayed_ack_sockets->set(move(socket));
+            delayed_ack_sockets.set(move(socket));
     }
 }
 
-void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
+void handle_tcp(const IPv4Packet& ipv4_packet, const PacketBufferView& ipv4_packet_view, DelayedACKSockets& delayed_ack_sockets)
 {
     if (ipv4_packet.payload_size() < sizeof(TCPPacket)) {
         dbgln("handle_tcp: IPv4 payload is too small to be a TCP packet ({}, need {})", ipv4_packet.payload_size(), sizeof(TCPPacket));
@@ -401,7 +563,9 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
 
     dbgln_if(TCP_DEBUG, "handle_tcp: got socket {}; state={}", socket->tuple().to_string(), TCPSocket::to_string(socket->state()));
 
-    socket->receive_tcp_packet(tcp_packet, ipv4_packet.payload_size());
+    // Listening sockets never send anything that could be acked, their connections get sockets of their own for that.
+    if (socket->state() != TCPSocket::State::Listen)
+        socket->receive_tcp_packet(tcp_packet, ipv4_packet.payload_size());
 
     [[maybe_unused]] int unused_rc {};
     switch (socket->state()) {
@@ -416,37 +580,44 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
         return;
     case TCPSocket::State::Listen:
         switch (tcp_packet.flags()) {
-        case TCPFlags::SYN: {
+        case TCPFlags::SYN:
             dbgln_if(TCP_DEBUG, "handle_tcp: incoming connection");
-            auto& local_address = ipv4_packet.destination();
-            auto& peer_address = ipv4_packet.source();
-            auto client = socket->create_client(local_address, tcp_packet.destination_port(), peer_address, tcp_packet.source_port());
+            socket->receive_syn(ipv4_packet.destination(), ipv4_packet.source(), tcp_packet);
+            return;
+        default: {
+            if (!tcp_packet.has_ack() || tcp_packet.has_syn() || tcp_packet.has_rst()) {
+                dbgln("handle_tcp: unexpected flags in Listen state ({:x})", tcp_packet.flags());
+                // socket->send_tcp_packet(TCPFlags::RST);
+                return;
+            }
+            auto client = socket->receive_handshake_ack(ipv4_packet.destination(), ipv4_packet.source(), tcp_packet);
             if (!client) {
-                dmesgln("handle_tcp: couldn't create client socket");
+                dbgln_if(TCP_DEBUG, "handle_tcp: ACK in Listen state doesn't complete any connection");
                 return;
             }
-            MutexLocker locker(client->lock());
             dbgln_if(TCP_DEBUG, "handle_tcp: created new client socket with tuple {}", client->tuple().to_string());
-            client->set_sequence_number(1000);
-            client->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
-            [[maybe_unused]] auto rc2 = client->send_tcp_packet(TCPFlags::SYN | TCPFlags::ACK);
-            client->set_state(TCPSocket::State::SynReceived);
+            // The peer may not have waited for our ACK before sending its first data.
+            if (payload_size) {
+                MutexLocker client_locker(client->lock());
+                if (client->did_receive(ipv4_packet.source(), tcp_packet.source_port(), ipv4_packet_view)) {
+                    client->set_ack_number(tcp_packet.sequence_number() + payload_size);
+                    send_delayed_tcp_ack(client, delayed_ack_sockets);
+                }
+            }
             return;
         }
-        default:
-            dbgln("handle_tcp: unexpected flags in Listen state ({:x})", tcp_packet.flags());
-            // socket->send_tcp_packet(TCPFlags::RST);
-            return;
         }
     case TCPSocket::State::SynSent:
         switch (tcp_packet.flags()) {
         case TCPFlags::SYN:
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
+            socket->process_syn_options(tcp_packet);
             unused_rc = socket->send_ack(true);
             socket->set_state(TCPSocket::State::SynReceived);
             return;
         case TCPFlags::ACK | TCPFlags::SYN:
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
+            socket->process_syn_options(tcp_packet);
             unused_rc = socket->send_ack(true);
             socket->set_state(TCPSocket::State::Established);
             socket->set_setup_state(Socket::SetupState::Completed);
@@ -454,14 +625,14 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
             return;
         case TCPFlags::ACK | TCPFlags::FIN:
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
-            send_delayed_tcp_ack(socket);
+            send_delayed_tcp_ack(socket, delayed_ack_sockets);
             socket->set_state(TCPSocket::State::Closed);
             socket->set_error(TCPSocket::Error::FINDuringConnect);
             socket->set_setup_state(Socket::SetupState::Completed);
             return;
         case TCPFlags::ACK | TCPFlags::RST:
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size);
-            send_delayed_tcp_ack(socket);
+            send_delayed_tcp_ack(socket, delayed_ack_sockets);
             socket->set_state(TCPSocket::State::Closed);
             socket->set_error(TCPSocket::Error::RSTDuringConnect);
             socket->set_setup_state(Socket::SetupState::Completed);
@@ -584,7 +755,8 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
         }
 
         if (tcp_packet.sequence_number() != socket->ack_number()) {
-            dbgln_if(TCP_DEBUG, "Discarding out of order packet: seq {} vs. ack {}", tcp_packet.sequence_number(), socket->ack_number());
+            dbgln_if(TCP_DEBUG, "Got out of order packet: seq {} vs. ack {}", tcp_packet.sequence_number(), socket->ack_number());
+            socket->queue_out_of_order_segment(tcp_packet, payload_size, ipv4_packet_view);
             if (socket->duplicate_acks() < TCPSocket::maximum_duplicate_acks) {
                 dbgln_if(TCP_DEBUG, "Sending ACK with same ack number to trigger fast retransmission");
                 socket->set_duplicate_acks(socket->duplicate_acks() + 1);
@@ -597,21 +769,26 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
 
         if (tcp_packet.has_fin()) {
             if (payload_size != 0)
-                socket->did_receive(ipv4_packet.source(), tcp_packet.source_port(), { &ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size() }, packet_timestamp);
+                socket->did_receive(ipv4_packet.source(), tcp_packet.source_port(), ipv4_packet_view);
 
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
-            send_delayed_tcp_ack(socket);
+            send_delayed_tcp_ack(socket, delayed_ack_sockets);
             socket->set_state(TCPSocket::State::CloseWait);
             socket->set_connected(false);
             return;
         }
 
         if (payload_size) {
-            if (socket->did_receive(ipv4_packet.source(), tcp_packet.source_port(), { &ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size() }, packet_timestamp)) {
+            if (socket->did_receive(ipv4_packet.source(), tcp_packet.source_port(), ipv4_packet_view)) {
                 socket->set_ack_number(tcp_packet.sequence_number() + payload_size);
+                // RFC 5681 4.2: Filling a hole should be acked right away.
+                bool filled_hole = socket->receive_queued_segments();
                 dbgln_if(TCP_DEBUG, "Got packet with ack_no={}, seq_no={}, payload_size={}, acking it with new ack_no={}, seq_no={}",
                     tcp_packet.ack_number(), tcp_packet.sequence_number(), payload_size, socket->ack_number(), socket->sequence_number());
-                send_delayed_tcp_ack(socket);
+                if (filled_hole)
+                    unused_rc = socket->send_ack();
+                else
+                    send_delayed_tcp_ack(socket, delayed_ack_sockets);
             }
         }
     }
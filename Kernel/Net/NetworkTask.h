@@ -6,10 +6,17 @@
 
 #pragma once
 
+#include <Kernel/Forward.h>
+
 namespace Kernel {
+class PacketBufferView;
+
 class NetworkTask {
 public:
     static void spawn();
     static bool is_current();
+
+    // Lets datagrams that never went through an adapter's receive queue be handled like any other.
+    static void deliver_udp_packet(const PacketBufferView& ipv4_packet_view);
 };
 }
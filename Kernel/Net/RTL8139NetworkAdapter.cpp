@@ -177,6 +177,7 @@ bool RTL8139NetworkAdapter::handle_irq(const RegisterState&)
         }
         if (status & INT_RXERR) {
             dmesgln("RTL8139: RX error - resetting device");
+            count_receive_error();
             reset();
         }
         if (status & INT_TXOK) {
@@ -184,10 +185,12 @@ bool RTL8139NetworkAdapter::handle_irq(const RegisterState&)
         }
         if (status & INT_TXERR) {
             dmesgln("RTL8139: TX error - resetting device");
+            count_send_error();
             reset();
         }
         if (status & INT_RX_BUFFER_OVERFLOW) {
             dmesgln("RTL8139: RX buffer overflow");
+            count_dropped_packet();
         }
         if (status & INT_LINK_CHANGE) {
             m_link_up = (in8(REG_MSR) & MSR_LINKB) == 0;
@@ -195,6 +198,7 @@ bool RTL8139NetworkAdapter::handle_irq(const RegisterState&)
         }
         if (status & INT_RX_FIFO_OVERFLOW) {
             dmesgln("RTL8139: RX FIFO overflow");
+            count_dropped_packet();
         }
         if (status & INT_LENGTH_CHANGE) {
             dmesgln("RTL8139: Cable length change");
@@ -320,6 +324,7 @@ void RTL8139NetworkAdapter::receive()
 
     if (!(status & RX_OK) || (status & (RX_INVALID_SYMBOL_ERROR | RX_CRC_ERROR | RX_FRAME_ALIGNMENT_ERROR)) || (length >= PACKET_SIZE_MAX) || (length < PACKET_SIZE_MIN)) {
         dmesgln("RTL8139: receive got bad packet, status={:#04x}, length={}", status, length);
+        count_receive_error();
         reset();
         return;
     }
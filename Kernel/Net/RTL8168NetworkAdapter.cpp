@@ -341,6 +341,8 @@ void RTL8168NetworkAdapter::startup()
         enabled_interrupts |= INT_RX_FIFO_OVERFLOW;
         enabled_interrupts &= ~INT_RX_OVERFLOW;
     }
+    m_enabled_interrupts = enabled_interrupts;
+    m_receive_interrupts = enabled_interrupts & (INT_RXOK | INT_RX_OVERFLOW | INT_RX_FIFO_OVERFLOW);
     out16(REG_IMR, enabled_interrupts);
 
     // update link status
@@ -1088,12 +1090,17 @@ bool RTL8168NetworkAdapter::handle_irq(const RegisterState&)
             break;
 
         was_handled = true;
+        if (status & (INT_RXOK | INT_RX_OVERFLOW | INT_RX_FIFO_OVERFLOW)) {
+            // The NetworkTask takes it from here, and turns these back on once it has emptied the ring.
+            out16(REG_IMR, m_enabled_interrupts & ~m_receive_interrupts);
+            schedule_receive_polling();
+        }
         if (status & INT_RXOK) {
             dbgln_if(RTL8168_DEBUG, "RTL8168: RX ready");
-            receive();
         }
         if (status & INT_RXERR) {
             dbgln_if(RTL8168_DEBUG, "RTL8168: RX error - invalid packet");
+            count_receive_error();
         }
         if (status & INT_TXOK) {
             dbgln_if(RTL8168_DEBUG, "RTL8168: TX complete");
@@ -1101,10 +1108,11 @@ bool RTL8168NetworkAdapter::handle_irq(const RegisterState&)
         }
         if (status & INT_TXERR) {
             dbgln_if(RTL8168_DEBUG, "RTL8168: TX error - invalid packet");
+            count_send_error();
         }
         if (status & INT_RX_OVERFLOW) {
             dmesgln("RTL8168: RX descriptor unavailable (packet lost)");
-            receive();
+            count_dropped_packet();
         }
         if (status & INT_LINK_CHANGE) {
             m_link_up = (in8(REG_PHYSTATUS) & PHY_LINK_STATUS) != 0;
@@ -1112,7 +1120,7 @@ bool RTL8168NetworkAdapter::handle_irq(const RegisterState&)
         }
         if (status & INT_RX_FIFO_OVERFLOW) {
             dmesgln("RTL8168: RX FIFO overflow");
-            receive();
+            count_dropped_packet();
         }
         if (status & INT_SYS_ERR) {
             dmesgln("RTL8168: Fatal system error");
@@ -1167,17 +1175,33 @@ void RTL8168NetworkAdapter::send_raw(ReadonlyBytes payload)
     out8(REG_TXSTART, TXSTART_START); // FIXME: this shouldnt be done so often, we should look into doing this using the watchdog timer
 }
 
-void RTL8168NetworkAdapter::receive()
+bool RTL8168NetworkAdapter::has_received_frame() const
+{
+    auto* rx_descriptors = (RXDescriptor*)m_rx_descriptors_region->vaddr().as_ptr();
+    return (rx_descriptors[m_rx_free_index].flags & RXDescriptor::Ownership) == 0;
+}
+
+void RTL8168NetworkAdapter::enable_receive_interrupts()
+{
+    // Whatever the hardware has noted down while we were polling has been taken care of already.
+    out16(REG_ISR, m_receive_interrupts);
+    out16(REG_IMR, m_enabled_interrupts);
+    if (has_received_frame()) {
+        out16(REG_IMR, m_enabled_interrupts & ~m_receive_interrupts);
+        schedule_receive_polling();
+    }
+}
+
+size_t RTL8168NetworkAdapter::receive_frames(size_t budget)
 {
     auto* rx_descriptors = (RXDescriptor*)m_rx_descriptors_region->vaddr().as_ptr();
-    for (u16 i = 0; i < number_of_rx_descriptors; ++i) {
-        auto descriptor_index = (m_rx_free_index + i) % number_of_rx_descriptors;
+    size_t frame_count = 0;
+    for (; frame_count < budget; ++frame_count) {
+        auto descriptor_index = m_rx_free_index;
         auto& descriptor = rx_descriptors[descriptor_index];
 
-        if ((descriptor.flags & RXDescriptor::Ownership) != 0) {
-            m_rx_free_index = descriptor_index;
+        if ((descriptor.flags & RXDescriptor::Ownership) != 0)
             break;
-        }
 
         u16 flags = descriptor.flags;
         u16 length = descriptor.buffer_size & 0x3FFF;
@@ -1199,7 +1223,9 @@ void RTL8168NetworkAdapter::receive()
         if (descriptor_index == number_of_rx_descriptors - 1)
             flags |= RXDescriptor::EndOfRing;
         descriptor.flags = flags; // let the NIC know it can use this descriptor again
+        m_rx_free_index = (descriptor_index + 1) % number_of_rx_descriptors;
     }
+    return frame_count;
 }
 
 void RTL8168NetworkAdapter::out8(u16 address, u8 data)
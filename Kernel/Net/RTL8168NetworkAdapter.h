@@ -30,8 +30,9 @@ public:
     virtual StringView purpose() const override { return class_name(); }
 
 private:
+    // The ring has to hold everything that arrives until the NetworkTask gets around to polling it.
     // FIXME: should this be increased? (maximum allowed here is 1024) - memory usage vs packet loss chance tradeoff
-    static const size_t number_of_rx_descriptors = 64;
+    static const size_t number_of_rx_descriptors = 256;
     static const size_t number_of_tx_descriptors = 16;
 
     RTL8168NetworkAdapter(PCI::Address, u8 irq);
@@ -143,7 +144,9 @@ private:
     void initialize_rx_descriptors();
     void initialize_tx_descriptors();
 
-    void receive();
+    virtual size_t receive_frames(size_t budget) override;
+    virtual void enable_receive_interrupts() override;
+    bool has_received_frame() const;
 
     void out8(u16 address, u8 data);
     void out16(u16 address, u16 data);
@@ -202,6 +205,9 @@ private:
     NonnullOwnPtrVector<Region> m_tx_buffers_regions;
     u16 m_tx_free_index { 0 };
     bool m_link_up { false };
+    u16 m_enabled_interrupts { 0 };
+    // These are turned off while the NetworkTask is polling the receive ring.
+    u16 m_receive_interrupts { 0 };
     EntropySource m_entropy_source;
     WaitQueue m_wait_queue;
 };
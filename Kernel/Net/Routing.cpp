@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Array.h>
 #include <AK/HashMap.h>
 #include <AK/Singleton.h>
 #include <Kernel/Debug.h>
@@ -16,6 +17,8 @@
 namespace Kernel {
 
 static AK::Singleton<Lockable<HashMap<IPv4Address, MACAddress>>> s_arp_table;
+static AK::Singleton<Lockable<HashMap<IPv6Address, MACAddress>>> s_neighbor_table;
+static AK::Singleton<RoutingTable> s_routing_table;
 
 class ARPTableBlocker : public Thread::Blocker {
 public:
@@ -112,6 +115,8 @@ void update_arp_table(const IPv4Address& ip_addr, const MACAddress& addr, Update
     if (update == UpdateArp::Delete)
         arp_table().resource().remove(ip_addr);
     s_arp_table_block_condition->unblock(ip_addr, addr);
+    // Whoever holds on to a routing decision may have the old hardware address in it.
+    RoutingTable::the().invalidate_routing_decisions();
 
     if constexpr (ROUTING_DEBUG) {
         dmesgln("ARP table ({} entries):", arp_table().resource().size());
@@ -121,11 +126,188 @@ void update_arp_table(const IPv4Address& ip_addr, const MACAddress& addr, Update
     }
 }
 
+Lockable<HashMap<IPv6Address, MACAddress>>& neighbor_table()
+{
+    return *s_neighbor_table;
+}
+
+void update_neighbor_table(const IPv6Address& address, const MACAddress& mac, UpdateArp update)
+{
+    MutexLocker locker(neighbor_table().lock());
+    if (update == UpdateArp::Set)
+        neighbor_table().resource().set(address, mac);
+    if (update == UpdateArp::Delete)
+        neighbor_table().resource().remove(address);
+    dbgln_if(ROUTING_DEBUG, "Neighbor table: {} {} {}", update == UpdateArp::Set ? "set" : "deleted", address, mac.to_string());
+}
+
 bool RoutingDecision::is_zero() const
 {
     return adapter.is_null() || next_hop.is_zero();
 }
 
+Optional<u8> prefix_length_of_netmask(const IPv4Address& netmask)
+{
+    u32 mask = (u32)netmask[0] << 24 | (u32)netmask[1] << 16 | (u32)netmask[2] << 8 | netmask[3];
+    u8 prefix_length = 0;
+    while (prefix_length < 32 && (mask & (0x80000000u >> prefix_length)))
+        ++prefix_length;
+    u32 expected_mask = prefix_length == 0 ? 0 : 0xffffffff << (32 - prefix_length);
+    if (mask != expected_mask)
+        return {};
+    return prefix_length;
+}
+
+static IPv4Address masked_address(const IPv4Address& address, u8 prefix_length)
+{
+    u8 bytes[4];
+    for (size_t i = 0; i < 4; ++i) {
+        int bits_in_byte = clamp((int)prefix_length - (int)i * 8, 0, 8);
+        bytes[i] = address[i] & (u8)(0xff00 >> bits_in_byte);
+    }
+    return IPv4Address(bytes);
+}
+
+RoutingTable& RoutingTable::the()
+{
+    return *s_routing_table;
+}
+
+bool RoutingTable::bit_at(const IPv4Address& address, size_t index)
+{
+    return (address[index / 8] >> (7 - index % 8)) & 1;
+}
+
+KResult RoutingTable::add_route(const Route& route)
+{
+    MutexLocker locker(m_lock);
+    auto result = add_route_locked(route);
+    if (!result.is_error())
+        invalidate_routing_decisions();
+    return result;
+}
+
+KResult RoutingTable::add_route_locked(const Route& route)
+{
+    VERIFY(m_lock.is_locked());
+    VERIFY(route.prefix_length <= 32);
+    auto destination = masked_address(route.destination, route.prefix_length);
+    auto* node = &m_root;
+    for (size_t depth = 0; depth < route.prefix_length; ++depth) {
+        auto& child = node->children[bit_at(destination, depth)];
+        if (!child) {
+            child = adopt_own_if_nonnull(new (nothrow) Node);
+            if (!child)
+                return ENOMEM;
+        }
+        node = child.ptr();
+    }
+    for (auto& existing_route : node->routes) {
+        if (existing_route.adapter.ptr() == route.adapter.ptr() && existing_route.gateway == route.gateway && existing_route.is_local == route.is_local)
+            return EEXIST;
+    }
+    auto new_route = route;
+    new_route.destination = destination;
+    if (!node->routes.try_append(move(new_route)))
+        return ENOMEM;
+    dbgln_if(ROUTING_DEBUG, "Routing: Added route to {}/{} via {} on {}", destination, route.prefix_length, route.gateway, route.adapter->name());
+    return KSuccess;
+}
+
+template<typename Filter>
+bool RoutingTable::remove_routes(Node& node, Filter& filter)
+{
+    node.routes.remove_all_matching([&](auto& route) { return filter(route); });
+    for (auto& child : node.children) {
+        if (child && remove_routes(*child, filter))
+            child = nullptr;
+    }
+    return node.routes.is_empty() && !node.children[0] && !node.children[1];
+}
+
+KResult RoutingTable::remove_route(const IPv4Address& destination, u8 prefix_length, const NetworkAdapter& adapter)
+{
+    MutexLocker locker(m_lock);
+    auto masked_destination = masked_address(destination, prefix_length);
+    bool did_remove = false;
+    auto filter = [&](const Route& route) {
+        if (route.origin != Route::Origin::Static || route.adapter.ptr() != &adapter)
+            return false;
+        if (route.prefix_length != prefix_length || route.destination != masked_destination)
+            return false;
+        did_remove = true;
+        return true;
+    };
+    remove_routes(m_root, filter);
+    if (!did_remove)
+        return ESRCH;
+    invalidate_routing_decisions();
+    return KSuccess;
+}
+
+void RoutingTable::update_adapter_routes(NetworkAdapter& adapter)
+{
+    auto address = adapter.ipv4_address();
+    auto netmask = adapter.ipv4_netmask();
+    auto gateway = adapter.ipv4_gateway();
+
+    MutexLocker locker(m_lock);
+    auto filter = [&](const Route& route) {
+        return route.origin == Route::Origin::Adapter && route.adapter.ptr() == &adapter;
+    };
+    remove_routes(m_root, filter);
+
+    auto add = [&](const Route& route) {
+        if (auto result = add_route_locked(route); result.is_error())
+            dbgln("Routing: Failed to add route to {}/{} on {}: {}", route.destination, route.prefix_length, adapter.name(), result.error());
+    };
+    if (!address.is_zero()) {
+        add({ address, 32, {}, adapter, Route::Origin::Adapter, true });
+        if (auto prefix_length = prefix_length_of_netmask(netmask); prefix_length.has_value())
+            add({ address, prefix_length.value(), {}, adapter, Route::Origin::Adapter, false });
+        else
+            dbgln("Routing: Netmask {} of {} isn't contiguous, so there is no route to its network", netmask, adapter.name());
+    }
+    if (!gateway.is_zero())
+        add({ {}, 0, gateway, adapter, Route::Origin::Adapter, false });
+    invalidate_routing_decisions();
+}
+
+Optional<Route> RoutingTable::find_route(const IPv4Address& target, Function<bool(const Route&)> filter) const
+{
+    MutexLocker locker(m_lock, Mutex::Mode::Shared);
+    Array<const Node*, 33> path;
+    size_t path_length = 0;
+    const Node* node = &m_root;
+    for (size_t depth = 0; node; ++depth) {
+        path[path_length++] = node;
+        node = depth < 32 ? node->children[bit_at(target, depth)].ptr() : nullptr;
+    }
+    for (size_t i = path_length; i > 0; --i) {
+        for (auto& route : path[i - 1]->routes) {
+            if (filter(route))
+                return route;
+        }
+    }
+    return {};
+}
+
+void RoutingTable::for_each_route(const Node& node, Function<void(const Route&)>& callback)
+{
+    for (auto& route : node.routes)
+        callback(route);
+    for (auto& child : node.children) {
+        if (child)
+            for_each_route(*child, callback);
+    }
+}
+
+void RoutingTable::for_each_route(Function<void(const Route&)> callback) const
+{
+    MutexLocker locker(m_lock, Mutex::Mode::Shared);
+    for_each_route(m_root, callback);
+}
+
 static MACAddress multicast_ethernet_address(IPv4Address const& address)
 {
     return MACAddress { 0x01, 0x00, 0x5e, (u8)(address[1] & 0x7f), address[2], address[3] };
@@ -153,62 +335,50 @@ RoutingDecision route_to(const IPv4Address& target, const IPv4Address& source, c
     auto target_addr = target.to_u32();
     auto source_addr = source.to_u32();
 
-    RefPtr<NetworkAdapter> local_adapter = nullptr;
-    RefPtr<NetworkAdapter> gateway_adapter = nullptr;
-
-    NetworkingManagement::the().for_each([source_addr, &target_addr, &local_adapter, &gateway_adapter, &matches, &through](NetworkAdapter& adapter) {
-        auto adapter_addr = adapter.ipv4_address().to_u32();
-        auto adapter_mask = adapter.ipv4_netmask().to_u32();
-
-        if (target_addr == adapter_addr) {
-            local_adapter = NetworkingManagement::the().loopback_adapter();
-            return;
-        }
-
-        if (!adapter.link_up() || (adapter_addr == 0 && !through))
-            return;
-
-        if (source_addr != 0 && source_addr != adapter_addr)
-            return;
-
-        if ((target_addr & adapter_mask) == (adapter_addr & adapter_mask) && matches(adapter))
-            local_adapter = adapter;
-
-        if (adapter.ipv4_gateway().to_u32() != 0 && matches(adapter))
-            gateway_adapter = adapter;
+    auto route = RoutingTable::the().find_route(target, [&](const Route& route) {
+        if (route.is_local)
+            return true;
+        // The table only hands out const routes, but asking an adapter about its link may have to poke the hardware.
+        auto& adapter = const_cast<NetworkAdapter&>(*route.adapter);
+        if (!matches(adapter))
+            return false;
+        if (!adapter.link_up() || (adapter.ipv4_address().is_zero() && !through))
+            return false;
+        return source_addr == 0 || source_addr == adapter.ipv4_address().to_u32();
     });
 
-    if (local_adapter && target == local_adapter->ipv4_address())
-        return { local_adapter, local_adapter->mac_address() };
-
-    if (!local_adapter && !gateway_adapter) {
-        dbgln_if(ROUTING_DEBUG, "Routing: Couldn't find a suitable adapter for route to {}", target);
-        return { nullptr, {} };
-    }
-
     RefPtr<NetworkAdapter> adapter = nullptr;
     IPv4Address next_hop_ip;
 
-    if (local_adapter) {
+    if (!route.has_value()) {
+        // An adapter that hasn't been configured yet has no routes, but it can still be used explicitly,
+        // e.g. to broadcast a DHCP request. Everything is directly connected to it as far as we know.
+        adapter = through;
+        if (!adapter || !adapter->ipv4_address().is_zero() || !adapter->link_up()) {
+            dbgln_if(ROUTING_DEBUG, "Routing: Couldn't find a suitable adapter for route to {}", target);
+            return { nullptr, {} };
+        }
+        next_hop_ip = target;
+    } else if (route->is_local) {
+        adapter = NetworkingManagement::the().loopback_adapter();
+        next_hop_ip = target;
+    } else if (route->gateway.is_zero()) {
         dbgln_if(ROUTING_DEBUG, "Routing: Got adapter for route (direct): {} ({}/{}) for {}",
-            local_adapter->name(),
-            local_adapter->ipv4_address(),
-            local_adapter->ipv4_netmask(),
+            route->adapter->name(),
+            route->destination,
+            route->prefix_length,
             target);
-
-        adapter = local_adapter;
+        adapter = route->adapter;
         next_hop_ip = target;
-    } else if (gateway_adapter) {
+    } else {
         dbgln_if(ROUTING_DEBUG, "Routing: Got adapter for route (using gateway {}): {} ({}/{}) for {}",
-            gateway_adapter->ipv4_gateway(),
-            gateway_adapter->name(),
-            gateway_adapter->ipv4_address(),
-            gateway_adapter->ipv4_netmask(),
+            route->gateway,
+            route->adapter->name(),
+            route->destination,
+            route->prefix_length,
             target);
-        adapter = gateway_adapter;
-        next_hop_ip = gateway_adapter->ipv4_gateway();
-    } else {
-        return { nullptr, {} };
+        adapter = route->adapter;
+        next_hop_ip = route->gateway;
     }
 
     // If it's a broadcast, we already know everything we need to know.
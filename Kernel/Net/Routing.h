@@ -6,6 +6,11 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
+#include <AK/Function.h>
+#include <AK/OwnPtr.h>
+#include <Kernel/KResult.h>
+#include <Kernel/Mutex.h>
 #include <Kernel/Net/NetworkAdapter.h>
 #include <Kernel/Thread.h>
 
@@ -18,6 +23,63 @@ struct RoutingDecision {
     bool is_zero() const;
 };
 
+struct Route {
+    enum class Origin {
+        // Follows from the address, netmask and gateway of an adapter, and changes along with them.
+        Adapter,
+        // Has been added with SIOCADDRT.
+        Static,
+    };
+
+    IPv4Address destination;
+    u8 prefix_length { 0 };
+    // Zero for destinations that are directly connected to the adapter.
+    IPv4Address gateway;
+    NonnullRefPtr<NetworkAdapter> adapter;
+    Origin origin { Origin::Static };
+    // The destination is the address of the adapter itself, so it gets there over the loopback adapter.
+    bool is_local { false };
+};
+
+// The routes are kept in a binary trie of the destination prefixes, so looking one up only ever has to
+// look at the (at most 32) prefixes of the target address, however many routes and adapters there are.
+class RoutingTable {
+public:
+    static RoutingTable& the();
+
+    KResult add_route(const Route&);
+    KResult remove_route(const IPv4Address& destination, u8 prefix_length, const NetworkAdapter&);
+    void update_adapter_routes(NetworkAdapter&);
+
+    // Returns the route with the longest prefix of the target that the filter accepts.
+    Optional<Route> find_route(const IPv4Address& target, Function<bool(const Route&)> filter) const;
+    void for_each_route(Function<void(const Route&)>) const;
+
+    // Changes whenever a routing decision that has already been made might not be right anymore.
+    u32 generation() const { return m_generation.load(AK::MemoryOrder::memory_order_acquire); }
+    void invalidate_routing_decisions() { m_generation.fetch_add(1, AK::MemoryOrder::memory_order_acq_rel); }
+
+private:
+    struct Node {
+        OwnPtr<Node> children[2];
+        Vector<Route, 1> routes;
+    };
+
+    KResult add_route_locked(const Route&);
+    static bool bit_at(const IPv4Address&, size_t index);
+    // Returns whether the node and everything below it is empty now, so it can go away.
+    template<typename Filter>
+    static bool remove_routes(Node&, Filter&);
+    static void for_each_route(const Node&, Function<void(const Route&)>&);
+
+    mutable Mutex m_lock { "RoutingTable" };
+    Node m_root;
+    Atomic<u32> m_generation { 0 };
+};
+
+// Returns how many leading bits a netmask has set, or nothing if it has a hole in it.
+Optional<u8> prefix_length_of_netmask(const IPv4Address&);
+
 enum class UpdateArp {
     Set,
     Delete,
@@ -28,4 +90,8 @@ RoutingDecision route_to(const IPv4Address& target, const IPv4Address& source, c
 
 Lockable<HashMap<IPv4Address, MACAddress>>& arp_table();
 
+// The IPv6 counterpart of the ARP table, filled in by neighbor discovery.
+void update_neighbor_table(const IPv6Address&, const MACAddress&, UpdateArp update);
+Lockable<HashMap<IPv6Address, MACAddress>>& neighbor_table();
+
 }
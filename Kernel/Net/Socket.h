@@ -74,6 +74,7 @@ public:
     void set_connected(bool);
 
     bool can_accept() const { return !m_pending.is_empty(); }
+    bool is_accept_queue_full() const { return m_pending.size() >= m_backlog; }
     RefPtr<Socket> accept();
 
     KResult shutdown(int how);
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/CommandLine.h>
+#include <Kernel/Net/TCPCongestionControl.h>
+#include <Kernel/Panic.h>
+
+namespace Kernel {
+
+// Nobody should need more than this, and it keeps the CUBIC maths within 64 bits.
+static constexpr size_t max_congestion_window = 16 * MiB;
+
+OwnPtr<TCPCongestionControl> TCPCongestionControl::create(StringView name)
+{
+    if (name == "newreno"sv)
+        return make<NewRenoCongestionControl>();
+    if (name == "cubic"sv)
+        return make<CUBICCongestionControl>();
+    return {};
+}
+
+NonnullOwnPtr<TCPCongestionControl> TCPCongestionControl::create_default()
+{
+    auto name = kernel_command_line().tcp_congestion_control();
+    auto congestion_control = create(name);
+    if (!congestion_control)
+        PANIC("Unknown TCP congestion control: {}", name);
+    return congestion_control.release_nonnull();
+}
+
+void TCPCongestionControl::set_mss(size_t mss)
+{
+    m_mss = mss;
+    if (!m_has_mss) {
+        // RFC 6928 initial window.
+        m_has_mss = true;
+        m_congestion_window = min(10 * mss, max(2 * mss, static_cast<size_t>(14600)));
+    }
+    set_congestion_window(m_congestion_window);
+}
+
+void TCPCongestionControl::set_congestion_window(size_t congestion_window)
+{
+    m_congestion_window = clamp(congestion_window, m_mss, max_congestion_window);
+}
+
+void TCPCongestionControl::on_ack(size_t acked_bytes, Time now)
+{
+    if (is_in_slow_start())
+        set_congestion_window(m_congestion_window + min(acked_bytes, m_mss));
+    else
+        increase_in_congestion_avoidance(acked_bytes, now);
+}
+
+void TCPCongestionControl::on_fast_retransmit(size_t bytes_in_flight, Time now, bool inflate_window)
+{
+    m_slow_start_threshold = slow_start_threshold_after_loss(bytes_in_flight, now);
+    // The three duplicate acks mean that three segments have left the network.
+    set_congestion_window(m_slow_start_threshold + (inflate_window ? 3 * m_mss : 0));
+}
+
+void TCPCongestionControl::on_duplicate_ack_in_recovery()
+{
+    set_congestion_window(m_congestion_window + m_mss);
+}
+
+void TCPCongestionControl::on_partial_ack(size_t acked_bytes)
+{
+    // RFC 6582 3.2: Deflate by what was acked, but keep room for the retransmission.
+    auto congestion_window = m_congestion_window - min(acked_bytes, m_congestion_window);
+    if (acked_bytes >= m_mss)
+        congestion_window += m_mss;
+    set_congestion_window(congestion_window);
+}
+
+void TCPCongestionControl::on_recovery_finished()
+{
+    set_congestion_window(m_slow_start_threshold);
+}
+
+void TCPCongestionControl::on_retransmit_timeout(size_t bytes_in_flight, Time now, bool is_first_timeout)
+{
+    // RFC 5681 3.1: The threshold must not be lowered again when the retransmission times out as well.
+    if (is_first_timeout)
+        m_slow_start_threshold = slow_start_threshold_after_loss(bytes_in_flight, now);
+    set_congestion_window(m_mss);
+}
+
+void NewRenoCongestionControl::increase_in_congestion_avoidance(size_t acked_bytes, Time)
+{
+    m_bytes_acked += acked_bytes;
+    if (m_bytes_acked < m_congestion_window)
+        return;
+    m_bytes_acked -= m_congestion_window;
+    set_congestion_window(m_congestion_window + m_mss);
+}
+
+size_t NewRenoCongestionControl::slow_start_threshold_after_loss(size_t bytes_in_flight, Time)
+{
+    m_bytes_acked = 0;
+    return max(bytes_in_flight / 2, 2 * m_mss);
+}
+
+static u64 integer_cube_root(u64 value)
+{
+    u64 low = 0;
+    u64 high = 1 << 21;
+    while (low < high) {
+        auto middle = (low + high + 1) / 2;
+        if (middle * middle * middle <= value)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+    return low;
+}
+
+// C = 0.4 segments per second cubed, and the window is multiplied by beta = 0.7 after a loss.
+void CUBICCongestionControl::increase_in_congestion_avoidance(size_t acked_bytes, Time now)
+{
+    u64 congestion_window = m_congestion_window;
+    u64 mss = m_mss;
+
+    if (!m_epoch_start.has_value()) {
+        m_epoch_start = now;
+        m_tcp_friendly_window = m_congestion_window;
+        if (m_congestion_window < m_window_max) {
+            // K = cbrt((W_max - cwnd) / C), in segments and seconds.
+            m_time_to_window_max_ms = integer_cube_root((m_window_max - congestion_window) * 2'500'000'000 / mss);
+        } else {
+            m_time_to_window_max_ms = 0;
+            m_window_max = m_congestion_window;
+        }
+    }
+
+    // W(t) = C * (t - K)^3 + W_max, and the cubic part stays within 64 bits for the first 100 seconds.
+    constexpr i64 max_offset_ms = 100'000;
+    auto offset_ms = clamp((now - m_epoch_start.value()).to_milliseconds() - m_time_to_window_max_ms, -max_offset_ms, max_offset_ms);
+    auto cubic_offset = offset_ms * offset_ms * offset_ms / 1000 * 4 * static_cast<i64>(mss) / 10'000'000;
+    auto target = max(static_cast<i64>(m_window_max) + cubic_offset, static_cast<i64>(mss));
+
+    // alpha = 3 * (1 - beta) / (1 + beta) = 9 / 17 segments per window.
+    m_tcp_friendly_window += 9 * acked_bytes * mss / (17 * congestion_window);
+    auto window_target = max(static_cast<u64>(target), static_cast<u64>(m_tcp_friendly_window));
+    // RFC 8312 4.1: Never more than half again as much within one round trip.
+    window_target = min(window_target, congestion_window * 3 / 2);
+
+    u64 increase;
+    if (window_target > congestion_window)
+        increase = (window_target - congestion_window) * acked_bytes / congestion_window;
+    else
+        increase = mss * acked_bytes / (100 * congestion_window);
+    set_congestion_window(congestion_window + increase);
+}
+
+size_t CUBICCongestionControl::slow_start_threshold_after_loss(size_t, Time)
+{
+    m_epoch_start.clear();
+    // Fast convergence: Make room for newer connections if we didn't even get back to where we were the last time.
+    if (m_congestion_window < m_window_max)
+        m_window_max = m_congestion_window * 17 / 20;
+    else
+        m_window_max = m_congestion_window;
+    return max(m_congestion_window * 7 / 10, 2 * m_mss);
+}
+
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullOwnPtr.h>
+#include <AK/OwnPtr.h>
+#include <AK/Optional.h>
+#include <AK/StringView.h>
+#include <AK/Time.h>
+#include <AK/Types.h>
+
+namespace Kernel {
+
+// Decides how many bytes a TCP socket may have in flight. Slow start and fast recovery work the
+// same for all of them (RFC 5681, RFC 6582), they differ in how the window grows in congestion
+// avoidance and how far it's cut back after a loss.
+class TCPCongestionControl {
+public:
+    static OwnPtr<TCPCongestionControl> create(StringView name);
+    static NonnullOwnPtr<TCPCongestionControl> create_default();
+    virtual ~TCPCongestionControl() = default;
+
+    virtual StringView name() const = 0;
+
+    size_t congestion_window() const { return m_congestion_window; }
+    size_t slow_start_threshold() const { return m_slow_start_threshold; }
+    bool is_in_slow_start() const { return m_congestion_window < m_slow_start_threshold; }
+
+    size_t mss() const { return m_mss; }
+    void set_mss(size_t);
+
+    // New data has been acknowledged while not in fast recovery.
+    void on_ack(size_t acked_bytes, Time now);
+
+    // The third duplicate ack, which lets us retransmit and continue in fast recovery. Without SACK the
+    // window is inflated by the segments that have left the network (RFC 6582), with SACK those are
+    // taken out of the bytes in flight instead (RFC 6675).
+    void on_fast_retransmit(size_t bytes_in_flight, Time now, bool inflate_window);
+    void on_duplicate_ack_in_recovery();
+    void on_partial_ack(size_t acked_bytes);
+    void on_recovery_finished();
+
+    // Nothing is left in flight after this, so we go back to slow start.
+    void on_retransmit_timeout(size_t bytes_in_flight, Time now, bool is_first_timeout);
+
+protected:
+    TCPCongestionControl() = default;
+
+    virtual void increase_in_congestion_avoidance(size_t acked_bytes, Time now) = 0;
+    virtual size_t slow_start_threshold_after_loss(size_t bytes_in_flight, Time now) = 0;
+
+    void set_congestion_window(size_t);
+
+    size_t m_mss { 536 };
+    size_t m_congestion_window { 0 };
+    size_t m_slow_start_threshold { NumericLimits<size_t>::max() };
+
+private:
+    bool m_has_mss { false };
+};
+
+class NewRenoCongestionControl final : public TCPCongestionControl {
+public:
+    virtual StringView name() const override { return "newreno"sv; }
+
+private:
+    virtual void increase_in_congestion_avoidance(size_t acked_bytes, Time now) override;
+    virtual size_t slow_start_threshold_after_loss(size_t bytes_in_flight, Time now) override;
+
+    // Appropriate byte counting (RFC 3465): one segment more for every window's worth of acked bytes.
+    size_t m_bytes_acked { 0 };
+};
+
+// RFC 8312, without the multiplications by real numbers.
+class CUBICCongestionControl final : public TCPCongestionControl {
+public:
+    virtual StringView name() const override { return "cubic"sv; }
+
+private:
+    virtual void increase_in_congestion_avoidance(size_t acked_bytes, Time now) override;
+    virtual size_t slow_start_threshold_after_loss(size_t bytes_in_flight, Time now) override;
+
+    // The window right before the last loss, which the cubic function levels off at.
+    size_t m_window_max { 0 };
+    // What a NewReno connection would have by now, we never grow slower than that.
+    size_t m_tcp_friendly_window { 0 };
+    Optional<Time> m_epoch_start;
+    i64 m_time_to_window_max_ms { 0 };
+};
+
+}
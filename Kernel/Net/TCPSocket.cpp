@@ -4,6 +4,9 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Array.h>
+#include <AK/FlatHashMap.h>
+#include <AK/NonnullRefPtrVector.h>
 #include <AK/Singleton.h>
 #include <AK/Time.h>
 #include <Kernel/Debug.h>
@@ -18,14 +21,109 @@
 #include <Kernel/Net/TCPSocket.h>
 #include <Kernel/Process.h>
 #include <Kernel/Random.h>
+#include <Kernel/Time/TimeManagement.h>
+#include <LibCrypto/Hash/SHA2.h>
 
 namespace Kernel {
 
+DEFINE_SLAB_CACHE(TCPSocket);
+
+// RFC 6298 bounds, and the clock granularity is how often NetworkTask looks at the retransmission timers.
+static constexpr i64 min_retransmit_timeout_us = 1'000'000;
+static constexpr i64 max_retransmit_timeout_us = 60'000'000;
+static constexpr i64 retransmit_timer_granularity_us = 500'000;
+
+static constexpr u32 duplicate_acks_for_fast_retransmit = 3;
+
+static constexpr size_t maximum_tcp_options_size = 40;
+// Two NOPs in front of the option keep everything after it aligned.
+static constexpr size_t timestamp_options_size = 2 + sizeof(TCPOptionTimestamp);
+// Anything smaller means more headers than data, so we don't believe peers asking for it.
+static constexpr u16 minimum_peer_mss = 88;
+// RFC 7323 2.3
+static constexpr u8 maximum_window_scale = 14;
+static constexpr size_t maximum_out_of_order_segments = 128;
+
+// Beyond this many, listening sockets only remember connections in the SYN cookies they send (RFC 4987 3.6).
+static constexpr size_t maximum_half_open_connections = 128;
+static constexpr u32 maximum_syn_ack_retransmits = 5;
+// A SYN cookie carries a counter that goes up every 64 seconds, and is good until the one after.
+static constexpr i64 syn_cookie_period_ms = 64'000;
+// SYN cookies only have room for the index of the MSS, so the peer gets the largest of these that fits.
+static constexpr u16 syn_cookie_mss_values[] = { 216, 536, 1024, 1200, 1360, 1400, 1440, 1460 };
+
+static bool is_sequence_number_before(u32 a, u32 b)
+{
+    return static_cast<i32>(a - b) < 0;
+}
+
+// Sockets are spread over a number of shards by their tuple, so that looking one up only ever
+// has to wait for those who are changing the same shard, and never for the rest of the table.
+static constexpr size_t socket_table_shard_count = 64;
+
+struct SocketTableShard {
+    SpinLock<u8> lock;
+    FlatHashMap<IPv4SocketTuple, TCPSocket*> sockets;
+};
+
+static AK::Singleton<Array<SocketTableShard, socket_table_shard_count>> s_socket_table;
+
+static SocketTableShard& socket_table_shard_for(const IPv4SocketTuple& tuple)
+{
+    // The shards' hash maps use the same hash, so we mix it up again to not have it pick both the shard and the slot.
+    return (*s_socket_table)[int_hash(Traits<IPv4SocketTuple>::hash(tuple)) % socket_table_shard_count];
+}
+
+// Sockets remove themselves from the table in their destructor, so whatever we find there may be going away.
+static RefPtr<TCPSocket> try_ref_socket(TCPSocket& socket)
+{
+    if (!socket.try_ref())
+        return {};
+    return adopt_ref(socket);
+}
+
+static bool try_add_to_socket_table(const IPv4SocketTuple& tuple, TCPSocket& socket)
+{
+    auto& shard = socket_table_shard_for(tuple);
+    ScopedSpinLock lock(shard.lock);
+    if (shard.sockets.contains(tuple))
+        return false;
+    shard.sockets.set(tuple, &socket);
+    return true;
+}
+
+static void remove_from_socket_table(const IPv4SocketTuple& tuple, const TCPSocket& socket)
+{
+    auto& shard = socket_table_shard_for(tuple);
+    ScopedSpinLock lock(shard.lock);
+    auto it = shard.sockets.find(tuple);
+    if (it != shard.sockets.end() && it->value == &socket)
+        shard.sockets.remove(it);
+}
+
+static RefPtr<TCPSocket> find_in_socket_table(const IPv4SocketTuple& tuple)
+{
+    auto& shard = socket_table_shard_for(tuple);
+    ScopedSpinLock lock(shard.lock);
+    auto it = shard.sockets.find(tuple);
+    if (it == shard.sockets.end())
+        return {};
+    return try_ref_socket(*it->value);
+}
+
 void TCPSocket::for_each(Function<void(const TCPSocket&)> callback)
 {
-    MutexLocker locker(sockets_by_tuple().lock(), Mutex::Mode::Shared);
-    for (auto& it : sockets_by_tuple().resource())
-        callback(*it.value);
+    // The callback may block, so it isn't called with any of the shards locked.
+    NonnullRefPtrVector<TCPSocket> sockets;
+    for (auto& shard : *s_socket_table) {
+        ScopedSpinLock lock(shard.lock);
+        for (auto& it : shard.sockets) {
+            if (auto socket = try_ref_socket(*it.value))
+                sockets.append(socket.release_nonnull());
+        }
+    }
+    for (auto& socket : sockets)
+        callback(socket);
 }
 
 void TCPSocket::set_state(State new_state)
@@ -59,42 +157,25 @@ Lockable<HashMap<IPv4SocketTuple, RefPtr<TCPSocket>>>& TCPSocket::closing_socket
     return *s_socket_closing;
 }
 
-static AK::Singleton<Lockable<HashMap<IPv4SocketTuple, TCPSocket*>>> s_socket_tuples;
-
-Lockable<HashMap<IPv4SocketTuple, TCPSocket*>>& TCPSocket::sockets_by_tuple()
-{
-    return *s_socket_tuples;
-}
-
 RefPtr<TCPSocket> TCPSocket::from_tuple(const IPv4SocketTuple& tuple)
 {
-    MutexLocker locker(sockets_by_tuple().lock(), Mutex::Mode::Shared);
-
-    auto exact_match = sockets_by_tuple().resource().get(tuple);
-    if (exact_match.has_value())
-        return { *exact_match.value() };
+    if (auto exact_match = find_in_socket_table(tuple))
+        return exact_match;
 
     auto address_tuple = IPv4SocketTuple(tuple.local_address(), tuple.local_port(), IPv4Address(), 0);
-    auto address_match = sockets_by_tuple().resource().get(address_tuple);
-    if (address_match.has_value())
-        return { *address_match.value() };
+    if (auto address_match = find_in_socket_table(address_tuple))
+        return address_match;
 
     auto wildcard_tuple = IPv4SocketTuple(IPv4Address(), tuple.local_port(), IPv4Address(), 0);
-    auto wildcard_match = sockets_by_tuple().resource().get(wildcard_tuple);
-    if (wildcard_match.has_value())
-        return { *wildcard_match.value() };
-
-    return {};
+    return find_in_socket_table(wildcard_tuple);
 }
+
 RefPtr<TCPSocket> TCPSocket::create_client(const IPv4Address& new_local_address, u16 new_local_port, const IPv4Address& new_peer_address, u16 new_peer_port)
 {
     auto tuple = IPv4SocketTuple(new_local_address, new_local_port, new_peer_address, new_peer_port);
 
-    {
-        MutexLocker locker(sockets_by_tuple().lock(), Mutex::Mode::Shared);
-        if (sockets_by_tuple().resource().contains(tuple))
-            return {};
-    }
+    if (find_in_socket_table(tuple))
+        return {};
 
     auto result = TCPSocket::create(protocol());
     if (result.is_error())
@@ -109,9 +190,10 @@ RefPtr<TCPSocket> TCPSocket::create_client(const IPv4Address& new_local_address,
     client->set_direction(Direction::Incoming);
     client->set_originator(*this);
 
-    MutexLocker locker(sockets_by_tuple().lock());
+    // Someone else may have gotten there first since we've looked.
+    if (!try_add_to_socket_table(tuple, *client))
+        return {};
     m_pending_release_for_accept.set(tuple, client);
-    sockets_by_tuple().resource().set(tuple, client);
 
     return client;
 }
@@ -133,14 +215,16 @@ void TCPSocket::release_for_accept(RefPtr<TCPSocket> socket)
 
 TCPSocket::TCPSocket(int protocol)
     : IPv4Socket(SOCK_STREAM, protocol)
+    , m_congestion_control(TCPCongestionControl::create_default())
 {
-    m_last_retransmit_time = kgettimeofday();
+    // Just enough to be able to offer the whole receive buffer.
+    while (m_receive_window_scale < maximum_window_scale && (receive_buffer_capacity() >> m_receive_window_scale) > NumericLimits<u16>::max())
+        ++m_receive_window_scale;
 }
 
 TCPSocket::~TCPSocket()
 {
-    MutexLocker locker(sockets_by_tuple().lock());
-    sockets_by_tuple().resource().remove(tuple());
+    remove_from_socket_table(tuple(), *this);
 
     dequeue_for_retransmit();
 
@@ -155,29 +239,86 @@ KResultOr<NonnullRefPtr<TCPSocket>> TCPSocket::create(int protocol)
     return ENOMEM;
 }
 
-KResultOr<size_t> TCPSocket::protocol_receive(ReadonlyBytes raw_ipv4_packet, UserOrKernelBuffer& buffer, size_t buffer_size, [[maybe_unused]] int flags)
+ReadonlyBytes TCPSocket::protocol_payload(ReadonlyBytes raw_ipv4_packet) const
 {
     auto& ipv4_packet = *reinterpret_cast<const IPv4Packet*>(raw_ipv4_packet.data());
     auto& tcp_packet = *static_cast<const TCPPacket*>(ipv4_packet.payload());
     size_t payload_size = raw_ipv4_packet.size() - sizeof(IPv4Packet) - tcp_packet.header_size();
-    dbgln_if(TCP_SOCKET_DEBUG, "payload_size {}, will it fit in {}?", payload_size, buffer_size);
-    VERIFY(buffer_size >= payload_size);
-    if (!buffer.write(tcp_packet.payload(), payload_size))
-        return EFAULT;
-    return payload_size;
+    return { tcp_packet.payload(), payload_size };
 }
 
 KResultOr<size_t> TCPSocket::protocol_send(const UserOrKernelBuffer& data, size_t data_length)
 {
-    RoutingDecision routing_decision = route_to(peer_address(), local_address(), bound_interface());
+    RoutingDecision routing_decision = route_to_peer();
     if (routing_decision.is_zero())
         return EHOSTUNREACH;
-    size_t mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
-    data_length = min(data_length, mss);
-    int err = send_tcp_packet(TCPFlags::PUSH | TCPFlags::ACK, &data, data_length, &routing_decision);
-    if (err < 0)
-        return KResult((ErrnoCode)-err);
-    return data_length;
+    size_t mss = send_mss(*routing_decision.adapter);
+    size_t max_payload_size = mss;
+    // With segmentation offload, the adapter cuts what we send into segments that fill up its MTU,
+    // which only works if the peer doesn't want them any smaller than that.
+    size_t headers_size = routing_decision.adapter->mtu() - mss;
+    bool is_mss_limited_by_peer = headers_size != sizeof(IPv4Packet) + sizeof(TCPPacket) + (m_timestamps_enabled ? timestamp_options_size : 0);
+    if (auto offload_size = routing_decision.adapter->tcp_segmentation_offload_size(); offload_size > routing_decision.adapter->mtu() && !is_mss_limited_by_peer)
+        max_payload_size = (offload_size - headers_size) / mss * mss;
+    data_length = min(data_length, max_payload_size);
+    {
+        // Never less than a segment though, so that non-blocking writers still get somewhere.
+        MutexLocker locker(m_not_acked_lock, Mutex::Mode::Shared);
+        auto window = send_window();
+        data_length = min(data_length, max(window - min(window, m_not_acked_size), mss));
+    }
+
+    if (m_unsent_size == 0 && (data_length >= mss || may_send_small_segment())) {
+        int err = send_tcp_packet(TCPFlags::PUSH | TCPFlags::ACK, &data, data_length, &routing_decision);
+        if (err < 0)
+            return KResult((ErrnoCode)-err);
+        return data_length;
+    }
+
+    // RFC 896: Anything smaller than a segment waits for the data in flight to be acknowledged,
+    // so that a series of small writes goes out as one segment instead of one for each.
+    if (!m_unsent_data) {
+        m_unsent_data = KBuffer::try_create_with_size(routing_decision.adapter->mtu(), Region::Access::Read | Region::Access::Write, "TCPSocket unsent data");
+        if (!m_unsent_data)
+            return ENOMEM;
+    }
+    size_t segment_size = min(mss, m_unsent_data->capacity());
+    size_t nbuffered = min(data_length, segment_size - m_unsent_size);
+    if (!data.read(m_unsent_data->data() + m_unsent_size, nbuffered))
+        return EFAULT;
+    if (m_unsent_size == 0)
+        m_unsent_data_time = kgettimeofday();
+    m_unsent_size += nbuffered;
+
+    if (m_unsent_size == segment_size || may_send_small_segment()) {
+        // The data is ours now, if it can't be sent right away it's sent later on.
+        [[maybe_unused]] auto result = send_unsent_data();
+    } else {
+        // Makes sure a cork times out even when nothing is in flight.
+        enqueue_for_retransmit();
+    }
+    return nbuffered;
+}
+
+bool TCPSocket::may_send_small_segment() const
+{
+    if (m_corked)
+        return false;
+    if (m_no_delay)
+        return true;
+    MutexLocker locker(m_not_acked_lock, Mutex::Mode::Shared);
+    return m_not_acked.is_empty();
+}
+
+KResult TCPSocket::send_unsent_data()
+{
+    if (m_unsent_size == 0)
+        return KSuccess;
+    auto buffer = UserOrKernelBuffer::for_kernel_buffer(m_unsent_data->data());
+    if (auto result = send_tcp_packet(TCPFlags::PUSH | TCPFlags::ACK, &buffer, m_unsent_size); result.is_error())
+        return result;
+    m_unsent_size = 0;
+    return KSuccess;
 }
 
 KResult TCPSocket::send_ack(bool allow_duplicate)
@@ -189,14 +330,15 @@ KResult TCPSocket::send_ack(bool allow_duplicate)
 
 KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload, size_t payload_size, RoutingDecision* user_routing_decision)
 {
-    RoutingDecision routing_decision = user_routing_decision ? *user_routing_decision : route_to(peer_address(), local_address(), bound_interface());
+    RoutingDecision routing_decision = user_routing_decision ? *user_routing_decision : route_to_peer();
     if (routing_decision.is_zero())
         return EHOSTUNREACH;
 
     auto ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
+    m_congestion_control->set_mss(send_mss(*routing_decision.adapter));
 
-    const bool has_mss_option = flags == TCPFlags::SYN;
-    const size_t options_size = has_mss_option ? sizeof(TCPOptionMSS) : 0;
+    u8 options[maximum_tcp_options_size];
+    const size_t options_size = build_options(flags, payload_size, *routing_decision.adapter, options);
     const size_t tcp_header_size = sizeof(TCPPacket) + options_size;
     const size_t buffer_size = ipv4_payload_offset + tcp_header_size + payload_size;
     auto packet = routing_decision.adapter->acquire_packet_buffer(buffer_size);
@@ -210,7 +352,7 @@ KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload,
     VERIFY(local_port());
     tcp_packet.set_source_port(local_port());
     tcp_packet.set_destination_port(peer_port());
-    tcp_packet.set_window_size(NumericLimits<u16>::max());
+    tcp_packet.set_window_size(advertised_window_size(flags));
     tcp_packet.set_sequence_number(m_sequence_number);
     tcp_packet.set_data_offset(tcp_header_size / sizeof(u32));
     tcp_packet.set_flags(flags);
@@ -227,27 +369,29 @@ KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload,
     }
 
     if (flags & TCPFlags::SYN) {
+        m_last_ack_received = m_sequence_number;
+        m_recovery_point = m_sequence_number;
         ++m_sequence_number;
     } else {
         m_sequence_number += payload_size;
     }
 
-    if (has_mss_option) {
-        u16 mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
-        TCPOptionMSS mss_option { mss };
-        VERIFY(packet->buffer.size() >= ipv4_payload_offset + sizeof(TCPPacket) + sizeof(mss_option));
-        memcpy(packet->buffer.data() + ipv4_payload_offset + sizeof(TCPPacket), &mss_option, sizeof(mss_option));
+    if (options_size > 0) {
+        VERIFY(packet->buffer.size() >= ipv4_payload_offset + sizeof(TCPPacket) + options_size);
+        memcpy(packet->buffer.data() + ipv4_payload_offset + sizeof(TCPPacket), options, options_size);
     }
 
-    tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
-
-    routing_decision.adapter->send_packet({ packet->buffer.data(), packet->buffer.size() });
+    auto offload = fill_in_tcp_checksum(*routing_decision.adapter, local_address(), peer_address(), tcp_packet, payload_size);
+    routing_decision.adapter->send_packet({ packet->buffer.data(), packet->buffer.size() }, offload);
 
     m_packets_out++;
     m_bytes_out += buffer_size;
     if (tcp_packet.has_syn() || payload_size > 0) {
         MutexLocker locker(m_not_acked_lock);
-        m_not_acked.append({ m_sequence_number, move(packet), ipv4_payload_offset, *routing_decision.adapter });
+        auto now = kgettimeofday();
+        if (m_not_acked.is_empty())
+            m_retransmit_timer_start = now;
+        m_not_acked.append({ m_sequence_number, move(packet), ipv4_payload_offset, *routing_decision.adapter, 0, now, payload_size });
         m_not_acked_size += payload_size;
         enqueue_for_retransmit();
     } else {
@@ -259,45 +403,645 @@ KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload,
 
 void TCPSocket::receive_tcp_packet(const TCPPacket& packet, u16 size)
 {
+    Optional<u32> timestamp_value;
+    u32 timestamp_echo_reply = 0;
+    SACKBlocks sack_blocks;
+    packet.for_each_option([&](auto kind, ReadonlyBytes data) {
+        if (kind == TCPOptionKind::Timestamp && data.size() == 2 * sizeof(u32)) {
+            timestamp_value = static_cast<u32>(*reinterpret_cast<const NetworkOrdered<u32>*>(data.data()));
+            timestamp_echo_reply = *reinterpret_cast<const NetworkOrdered<u32>*>(data.offset(sizeof(u32)));
+        } else if (kind == TCPOptionKind::SACK && data.size() % sizeof(TCPSACKBlock) == 0) {
+            for (size_t offset = 0; offset < data.size(); offset += sizeof(TCPSACKBlock)) {
+                auto& block = *reinterpret_cast<const TCPSACKBlock*>(data.offset(offset));
+                sack_blocks.append({ block.left_edge, block.right_edge });
+            }
+        }
+    });
+
+    // RFC 7323 4.3: Only what starts at or before our last ack may change the timestamp we echo back.
+    if (m_timestamps_enabled && timestamp_value.has_value()
+        && !is_sequence_number_before(timestamp_value.value(), m_recent_timestamp)
+        && !is_sequence_number_before(m_last_ack_number_sent, packet.sequence_number()))
+        m_recent_timestamp = timestamp_value.value();
+
     if (packet.has_ack()) {
         u32 ack_number = packet.ack_number();
 
         dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet: {}", ack_number);
 
-        int removed = 0;
-        MutexLocker locker(m_not_acked_lock);
-        while (!m_not_acked.is_empty()) {
-            auto& packet = m_not_acked.first();
-
-            dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: iterate: {}", packet.ack_number);
-
-            if (packet.ack_number <= ack_number) {
-                auto old_adapter = packet.adapter.strong_ref();
-                if (old_adapter)
-                    old_adapter->release_packet_buffer(*packet.buffer);
-                TCPPacket& tcp_packet = *(TCPPacket*)(packet.buffer->buffer.data() + packet.ipv4_payload_offset);
-                auto payload_size = packet.buffer->buffer.data() + packet.buffer->buffer.size() - (u8*)tcp_packet.payload();
-                m_not_acked_size -= payload_size;
+        // RFC 7323 2.2: The window of a SYN is never scaled, and old acks don't get to change it.
+        bool window_changed = false;
+        if (!is_sequence_number_before(ack_number, m_last_ack_received)) {
+            u32 window_size = packet.window_size();
+            if (!packet.has_syn())
+                window_size <<= m_send_window_scale;
+            window_changed = window_size != m_send_window_size;
+            bool window_grew = window_size > m_send_window_size;
+            m_send_window_size = window_size;
+            // The peer is there, it just doesn't have any room for us right now.
+            if (window_size == 0)
+                m_retransmit_attempts = 0;
+            if (window_grew)
                 evaluate_block_conditions();
-                m_not_acked.take_first();
-                removed++;
-            } else {
-                break;
-            }
         }
 
-        if (m_not_acked.is_empty()) {
-            m_retransmit_attempts = 0;
-            dequeue_for_retransmit();
+        auto now = kgettimeofday();
+        int removed = 0;
+        size_t acked_bytes = 0;
+        Optional<Time> rtt_sample;
+        bool has_unacked_packets;
+        {
+            MutexLocker locker(m_not_acked_lock);
+            while (!m_not_acked.is_empty()) {
+                auto& packet = m_not_acked.first();
+
+                dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: iterate: {}", packet.ack_number);
+
+                if (packet.ack_number <= ack_number) {
+                    auto old_adapter = packet.adapter.strong_ref();
+                    if (old_adapter)
+                        old_adapter->release_packet_buffer(*packet.buffer);
+                    m_not_acked_size -= packet.payload_size;
+                    acked_bytes += packet.payload_size;
+                    // Karn's algorithm: There's no telling which transmission the ack of a retransmitted packet is for,
+                    // unless the peer echoes our timestamps.
+                    if (packet.tx_counter == 0)
+                        rtt_sample = now - packet.sent_time;
+                    evaluate_block_conditions();
+                    m_not_acked.take_first();
+                    removed++;
+                } else {
+                    break;
+                }
+            }
+
+            has_unacked_packets = !m_not_acked.is_empty();
+            if (!has_unacked_packets) {
+                m_retransmit_attempts = 0;
+                dequeue_for_retransmit();
+            }
         }
 
         dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet acknowledged {} packets", removed);
+
+        if (m_timestamps_enabled && timestamp_echo_reply != 0 && removed > 0)
+            rtt_sample = Time::from_milliseconds(static_cast<u32>(current_timestamp() - timestamp_echo_reply));
+        if (m_sack_enabled && has_unacked_packets && !sack_blocks.is_empty())
+            update_sack_scoreboard(sack_blocks);
+
+        // RFC 5681 2: Acks that open or close the window are not duplicates, and neither are those for zero window probes.
+        if (removed > 0) {
+            handle_new_ack(ack_number, acked_bytes, rtt_sample, now);
+        } else if (has_unacked_packets && ack_number == m_last_ack_received && size == packet.header_size() && !packet.has_syn() && !packet.has_fin() && !window_changed && m_send_window_size != 0) {
+            handle_duplicate_ack(now);
+        }
+
+        if (m_unsent_size > 0) {
+            if (removed > 0 && may_send_small_segment()) {
+                [[maybe_unused]] auto result = send_unsent_data();
+            }
+            if (m_unsent_size > 0)
+                enqueue_for_retransmit();
+        }
     }
 
     m_packets_in++;
     m_bytes_in += packet.header_size() + size;
 }
 
+void TCPSocket::handle_new_ack(u32 ack_number, size_t acked_bytes, Optional<Time> rtt_sample, Time now)
+{
+    m_last_ack_received = ack_number;
+    m_bytes_acked += acked_bytes;
+    m_duplicate_acks_received = 0;
+    m_retransmit_attempts = 0;
+    if (rtt_sample.has_value())
+        update_retransmit_timeout(rtt_sample.value());
+    // RFC 6298 5.3: Whatever is still outstanding gets a full timeout from now on.
+    m_retransmit_timer_start = now;
+
+    if (m_in_fast_recovery) {
+        if (is_sequence_number_before(ack_number, m_recovery_point)) {
+            // A partial ack means that the segment after the one we retransmitted got lost as well.
+            if (!m_sack_enabled)
+                m_congestion_control->on_partial_ack(acked_bytes);
+            retransmit_first_unacked_packet();
+            if (m_sack_enabled)
+                mark_sack_holes_lost();
+        } else {
+            m_in_fast_recovery = false;
+            m_congestion_control->on_recovery_finished();
+        }
+    } else {
+        m_congestion_control->on_ack(acked_bytes, now);
+    }
+
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) acked {} bytes, cwnd={}, ssthresh={}, rto={}us", this, acked_bytes,
+        m_congestion_control->congestion_window(), m_congestion_control->slow_start_threshold(), m_retransmit_timeout_us);
+
+    retransmit_lost_packets();
+}
+
+void TCPSocket::handle_duplicate_ack(Time now)
+{
+    ++m_duplicate_acks_received;
+    if (m_in_fast_recovery) {
+        // Every duplicate ack means another segment has left the network. With SACK, we know which.
+        if (m_sack_enabled) {
+            mark_sack_holes_lost();
+            retransmit_lost_packets();
+        } else {
+            m_congestion_control->on_duplicate_ack_in_recovery();
+        }
+        return;
+    }
+    if (m_duplicate_acks_received != duplicate_acks_for_fast_retransmit)
+        return;
+    // RFC 6582 3.2: Don't start over for losses in what we have already been recovering from.
+    if (!is_sequence_number_before(m_recovery_point, m_last_ack_received))
+        return;
+
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) fast retransmit of {}", this, m_last_ack_received);
+    m_in_fast_recovery = true;
+    ++m_fast_retransmits;
+    m_recovery_point = m_sequence_number;
+    m_congestion_control->on_fast_retransmit(bytes_outstanding(), now, !m_sack_enabled);
+    retransmit_first_unacked_packet();
+    if (m_sack_enabled) {
+        mark_sack_holes_lost();
+        retransmit_lost_packets();
+    }
+}
+
+void TCPSocket::update_retransmit_timeout(Time rtt_sample)
+{
+    auto rtt_us = max(rtt_sample.to_microseconds(), static_cast<i64>(0));
+    if (!m_has_rtt_sample) {
+        m_has_rtt_sample = true;
+        m_smoothed_rtt_us = rtt_us;
+        m_rtt_variance_us = rtt_us / 2;
+    } else {
+        auto difference_us = m_smoothed_rtt_us - rtt_us;
+        if (difference_us < 0)
+            difference_us = -difference_us;
+        m_rtt_variance_us = (3 * m_rtt_variance_us + difference_us) / 4;
+        m_smoothed_rtt_us = (7 * m_smoothed_rtt_us + rtt_us) / 8;
+    }
+    m_retransmit_timeout_us = clamp(m_smoothed_rtt_us + max(retransmit_timer_granularity_us, 4 * m_rtt_variance_us), min_retransmit_timeout_us, max_retransmit_timeout_us);
+}
+
+size_t TCPSocket::bytes_in_flight() const
+{
+    MutexLocker locker(m_not_acked_lock, Mutex::Mode::Shared);
+    size_t bytes_in_flight = 0;
+    for (auto& packet : m_not_acked) {
+        if (!packet.is_lost && !packet.is_sacked)
+            bytes_in_flight += packet.payload_size;
+    }
+    return bytes_in_flight;
+}
+
+size_t TCPSocket::bytes_outstanding() const
+{
+    MutexLocker locker(m_not_acked_lock, Mutex::Mode::Shared);
+    return m_not_acked_size;
+}
+
+size_t TCPSocket::send_window() const
+{
+    // We don't have a persist timer, so a closed window still lets a segment through as a probe.
+    // The peer either takes it or drops it, and either way it acks with its current window.
+    return max(min(m_congestion_control->congestion_window(), static_cast<size_t>(m_send_window_size)), m_congestion_control->mss());
+}
+
+size_t TCPSocket::send_mss(const NetworkAdapter& adapter) const
+{
+    size_t mss = adapter.mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
+    if (m_peer_mss.has_value())
+        mss = min(mss, static_cast<size_t>(m_peer_mss.value()));
+    // RFC 6691: The options we put into every segment take away from its payload.
+    if (m_timestamps_enabled)
+        mss -= timestamp_options_size;
+    return mss;
+}
+
+u32 TCPSocket::current_timestamp() const
+{
+    return static_cast<u32>(TimeManagement::the().monotonic_time().to_milliseconds());
+}
+
+u16 TCPSocket::advertised_window_size(u16 flags) const
+{
+    // The headers count against the receive buffer as well.
+    auto space = receive_buffer_space();
+    space -= min(space, sizeof(IPv4Packet) + sizeof(TCPPacket) + maximum_tcp_options_size);
+    // RFC 7323 2.2: The window of a SYN is never scaled.
+    if (!(flags & TCPFlags::SYN))
+        space >>= m_receive_window_scale;
+    return min(space, static_cast<size_t>(NumericLimits<u16>::max()));
+}
+
+template<typename Option>
+static void append_option(u8* options, size_t& size, const Option& option)
+{
+    memcpy(options + size, &option, sizeof(option));
+    size += sizeof(option);
+}
+
+static void append_padding(u8* options, size_t& size, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        options[size++] = to_underlying(TCPOptionKind::NoOperation);
+}
+
+static void append_syn_options(u8* options, size_t& size, const NetworkAdapter& adapter, Optional<u8> window_scale, bool sack_permitted)
+{
+    append_option(options, size, TCPOptionMSS { static_cast<u16>(adapter.mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket)) });
+    if (window_scale.has_value()) {
+        append_padding(options, size, 1);
+        append_option(options, size, TCPOptionWindowScale { window_scale.value() });
+    }
+    if (sack_permitted) {
+        append_padding(options, size, 2);
+        append_option(options, size, TCPOptionSACKPermitted {});
+    }
+}
+
+static void append_timestamp_option(u8* options, size_t& size, u32 value, u32 echo_reply)
+{
+    append_padding(options, size, 2);
+    append_option(options, size, TCPOptionTimestamp { value, echo_reply });
+}
+
+size_t TCPSocket::build_options(u16 flags, size_t payload_size, const NetworkAdapter& adapter, u8* options)
+{
+    if (flags & TCPFlags::RST)
+        return 0;
+
+    size_t size = 0;
+    if (flags & TCPFlags::SYN)
+        append_syn_options(options, size, adapter, m_window_scale_enabled ? m_receive_window_scale : Optional<u8> {}, m_sack_enabled);
+
+    if (m_timestamps_enabled)
+        append_timestamp_option(options, size, current_timestamp(), (flags & TCPFlags::ACK) ? m_recent_timestamp : 0);
+
+    // Only acks without data carry SACK blocks, so that the mss stays the same for every segment.
+    if (!(flags & TCPFlags::SYN) && payload_size == 0 && m_sack_enabled && !m_out_of_order_segments.is_empty()) {
+        SACKBlocks blocks;
+        for (auto& segment : m_out_of_order_segments) {
+            u32 right_edge = segment.sequence_number + segment.payload_size;
+            if (!blocks.is_empty() && !is_sequence_number_before(blocks.last().right_edge, segment.sequence_number)) {
+                if (is_sequence_number_before(blocks.last().right_edge, right_edge))
+                    blocks.last().right_edge = right_edge;
+                continue;
+            }
+            blocks.append({ segment.sequence_number, right_edge });
+        }
+        // RFC 2018 4: The first block has to be the one with the segment we received last.
+        for (size_t i = 1; i < blocks.size(); ++i) {
+            auto& block = blocks[i];
+            if (!is_sequence_number_before(m_last_out_of_order_sequence_number, block.left_edge) && is_sequence_number_before(m_last_out_of_order_sequence_number, block.right_edge)) {
+                swap(blocks[0], block);
+                break;
+            }
+        }
+        size_t block_count = min(blocks.size(), (maximum_tcp_options_size - size - 4) / sizeof(TCPSACKBlock));
+        append_padding(options, size, 2);
+        options[size++] = to_underlying(TCPOptionKind::SACK);
+        options[size++] = 2 + block_count * sizeof(TCPSACKBlock);
+        for (size_t i = 0; i < block_count; ++i)
+            append_option(options, size, TCPSACKBlock { blocks[i].left_edge, blocks[i].right_edge });
+    }
+
+    VERIFY(size <= maximum_tcp_options_size && size % sizeof(u32) == 0);
+    return size;
+}
+
+void TCPSocket::process_syn_options(const TCPPacket& packet)
+{
+    apply_syn_options(parse_syn_options(packet));
+}
+
+TCPSocket::SYNOptions TCPSocket::parse_syn_options(const TCPPacket& packet)
+{
+    VERIFY(packet.has_syn());
+    SYNOptions options;
+    packet.for_each_option([&](auto kind, ReadonlyBytes data) {
+        switch (kind) {
+        case TCPOptionKind::MSS:
+            if (data.size() == sizeof(u16))
+                options.mss = max(static_cast<u16>(*reinterpret_cast<const NetworkOrdered<u16>*>(data.data())), minimum_peer_mss);
+            break;
+        case TCPOptionKind::WindowScale:
+            if (data.size() == sizeof(u8))
+                options.window_scale = min(data[0], maximum_window_scale);
+            break;
+        case TCPOptionKind::SACKPermitted:
+            options.sack_permitted = data.is_empty();
+            break;
+        case TCPOptionKind::Timestamp:
+            if (data.size() == 2 * sizeof(u32))
+                options.timestamp = static_cast<u32>(*reinterpret_cast<const NetworkOrdered<u32>*>(data.data()));
+            break;
+        default:
+            break;
+        }
+    });
+    options.window_size = packet.window_size();
+    return options;
+}
+
+void TCPSocket::apply_syn_options(const SYNOptions& options)
+{
+    if (options.mss.has_value())
+        m_peer_mss = options.mss;
+
+    // Everything is only used if both of us want it. Window scaling has to be turned off in both
+    // directions, since the peer won't scale the windows it advertises either.
+    m_window_scale_enabled = m_window_scale_enabled && options.window_scale.has_value();
+    m_send_window_scale = m_window_scale_enabled ? options.window_scale.value() : 0;
+    if (!m_window_scale_enabled)
+        m_receive_window_scale = 0;
+    m_sack_enabled = m_sack_enabled && options.sack_permitted;
+    m_timestamps_enabled = m_timestamps_enabled && options.timestamp.has_value();
+    if (m_timestamps_enabled)
+        m_recent_timestamp = options.timestamp.value();
+    m_send_window_size = options.window_size;
+
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) SYN options: mss={}, window scale={}/{}, sack={}, timestamps={}", this,
+        m_peer_mss.value_or(0), m_send_window_scale, m_receive_window_scale, m_sack_enabled, m_timestamps_enabled);
+}
+
+static u32 syn_cookie_counter()
+{
+    return static_cast<u32>(TimeManagement::the().monotonic_time().to_milliseconds() / syn_cookie_period_ms);
+}
+
+void TCPSocket::receive_syn(const IPv4Address& local_address, const IPv4Address& peer_address, const TCPPacket& packet)
+{
+    VERIFY(m_state == State::Listen);
+    IPv4SocketTuple tuple(local_address, packet.destination_port(), peer_address, packet.source_port());
+
+    HalfOpenConnection connection;
+    connection.ack_number = packet.sequence_number() + 1;
+    connection.options = parse_syn_options(packet);
+
+    if (auto it = m_half_open_connections.find(tuple); it != m_half_open_connections.end()) {
+        // The peer hasn't gotten our SYN|ACK, so it sent its SYN again.
+        if (it->value.ack_number == connection.ack_number) {
+            [[maybe_unused]] auto result = send_syn_ack(tuple, it->value);
+            return;
+        }
+        m_half_open_connections.remove(it);
+    }
+
+    if (m_half_open_connections.size() < maximum_half_open_connections) {
+        connection.sequence_number = get_fast_random<u32>();
+        connection.syn_ack_sent_time = kgettimeofday();
+        m_half_open_connections.set(tuple, connection);
+        enqueue_for_retransmit();
+    } else {
+        // There's nowhere to keep the other options, so the peer doesn't get to use them.
+        u8 mss_index = 0;
+        auto mss = connection.options.mss.value_or(536);
+        for (u8 index = 0; index < array_size(syn_cookie_mss_values); ++index) {
+            if (syn_cookie_mss_values[index] <= mss)
+                mss_index = index;
+        }
+        connection.options = { syn_cookie_mss_values[mss_index], {}, false, {}, connection.options.window_size };
+        connection.sequence_number = syn_cookie(tuple, packet.sequence_number(), syn_cookie_counter(), mss_index);
+        dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) sending SYN cookie to {}:{}", this, peer_address, packet.source_port());
+    }
+    [[maybe_unused]] auto result = send_syn_ack(tuple, connection);
+}
+
+RefPtr<TCPSocket> TCPSocket::receive_handshake_ack(const IPv4Address& local_address, const IPv4Address& peer_address, const TCPPacket& packet)
+{
+    VERIFY(m_state == State::Listen);
+    IPv4SocketTuple tuple(local_address, packet.destination_port(), peer_address, packet.source_port());
+
+    // Until there's room again, we act as if we never got the ACK. The peer sends it again when our SYN|ACK is retransmitted.
+    if (is_accept_queue_full())
+        return {};
+
+    Optional<HalfOpenConnection> connection;
+    if (auto it = m_half_open_connections.find(tuple); it != m_half_open_connections.end()) {
+        if (packet.ack_number() != it->value.sequence_number + 1)
+            return {};
+        connection = it->value;
+        m_half_open_connections.remove(it);
+    } else {
+        connection = check_syn_cookie(tuple, packet);
+        if (!connection.has_value())
+            return {};
+    }
+
+    auto client = create_client(local_address, tuple.local_port(), peer_address, tuple.peer_port());
+    if (!client)
+        return {};
+    MutexLocker locker(client->lock());
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) accepting connection from {}:{}", this, peer_address, tuple.peer_port());
+    client->m_sequence_number = connection->sequence_number + 1;
+    client->m_last_ack_received = client->m_sequence_number;
+    client->m_recovery_point = client->m_sequence_number;
+    client->m_ack_number = connection->ack_number;
+    client->apply_syn_options(connection->options);
+    client->m_send_window_size = static_cast<u32>(packet.window_size()) << client->m_send_window_scale;
+    client->set_state(State::Established);
+    client->set_setup_state(SetupState::Completed);
+    client->release_to_originator();
+    return client;
+}
+
+KResult TCPSocket::send_syn_ack(const IPv4SocketTuple& tuple, const HalfOpenConnection& connection)
+{
+    auto routing_decision = route_to(tuple.peer_address(), tuple.local_address(), bound_interface());
+    if (routing_decision.is_zero())
+        return EHOSTUNREACH;
+    auto& adapter = *routing_decision.adapter;
+
+    // We only answer with what the peer has asked for.
+    u8 options[maximum_tcp_options_size];
+    size_t options_size = 0;
+    append_syn_options(options, options_size, adapter, connection.options.window_scale.has_value() ? m_receive_window_scale : Optional<u8> {}, connection.options.sack_permitted);
+    if (connection.options.timestamp.has_value())
+        append_timestamp_option(options, options_size, current_timestamp(), connection.options.timestamp.value());
+
+    auto ipv4_payload_offset = adapter.ipv4_payload_offset();
+    const size_t tcp_header_size = sizeof(TCPPacket) + options_size;
+    auto packet = adapter.acquire_packet_buffer(ipv4_payload_offset + tcp_header_size);
+    if (!packet)
+        return ENOMEM;
+    adapter.fill_in_ipv4_header(*packet, tuple.local_address(), routing_decision.next_hop, tuple.peer_address(), IPv4Protocol::TCP, tcp_header_size, ttl());
+    memset(packet->buffer.data() + ipv4_payload_offset, 0, sizeof(TCPPacket));
+    auto& tcp_packet = *(TCPPacket*)(packet->buffer.data() + ipv4_payload_offset);
+    tcp_packet.set_source_port(tuple.local_port());
+    tcp_packet.set_destination_port(tuple.peer_port());
+    tcp_packet.set_window_size(advertised_window_size(TCPFlags::SYN));
+    tcp_packet.set_sequence_number(connection.sequence_number);
+    tcp_packet.set_ack_number(connection.ack_number);
+    tcp_packet.set_data_offset(tcp_header_size / sizeof(u32));
+    tcp_packet.set_flags(TCPFlags::SYN | TCPFlags::ACK);
+    memcpy(packet->buffer.data() + ipv4_payload_offset + sizeof(TCPPacket), options, options_size);
+
+    auto offload = fill_in_tcp_checksum(adapter, tuple.local_address(), tuple.peer_address(), tcp_packet, 0);
+    adapter.send_packet({ packet->buffer.data(), packet->buffer.size() }, offload);
+    adapter.release_packet_buffer(*packet);
+
+    m_packets_out++;
+    m_bytes_out += ipv4_payload_offset + tcp_header_size;
+    return KSuccess;
+}
+
+void TCPSocket::retransmit_syn_acks()
+{
+    auto now = kgettimeofday();
+    Vector<IPv4SocketTuple> expired_connections;
+    for (auto& it : m_half_open_connections) {
+        auto& connection = it.value;
+        if (now < connection.syn_ack_sent_time + Time::from_microseconds(min_retransmit_timeout_us << connection.retransmit_attempts))
+            continue;
+        if (connection.retransmit_attempts >= maximum_syn_ack_retransmits) {
+            expired_connections.append(it.key);
+            continue;
+        }
+        ++connection.retransmit_attempts;
+        connection.syn_ack_sent_time = now;
+        [[maybe_unused]] auto result = send_syn_ack(it.key, connection);
+    }
+    for (auto& tuple : expired_connections) {
+        dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) giving up on half open connection {}", this, tuple.to_string());
+        m_half_open_connections.remove(tuple);
+    }
+    if (m_half_open_connections.is_empty())
+        dequeue_for_retransmit();
+}
+
+u32 TCPSocket::syn_cookie(const IPv4SocketTuple& tuple, u32 peer_sequence_number, u32 counter, u8 mss_index) const
+{
+    struct [[gnu::packed]] {
+        u8 secret[sizeof(m_syn_cookie_secret)];
+        u32 local_address;
+        u16 local_port;
+        u32 peer_address;
+        u16 peer_port;
+        u32 peer_sequence_number;
+        u32 counter;
+        u8 mss_index;
+    } input;
+    memcpy(input.secret, m_syn_cookie_secret, sizeof(m_syn_cookie_secret));
+    input.local_address = tuple.local_address().to_u32();
+    input.local_port = tuple.local_port();
+    input.peer_address = tuple.peer_address().to_u32();
+    input.peer_port = tuple.peer_port();
+    input.peer_sequence_number = peer_sequence_number;
+    input.counter = counter;
+    input.mss_index = mss_index;
+    auto digest = Crypto::Hash::SHA256::hash(reinterpret_cast<const u8*>(&input), sizeof(input));
+    u32 hash = (digest.data[0] << 16) | (digest.data[1] << 8) | digest.data[2];
+    // 5 bits of the counter, 3 bits for the MSS and 24 bits that nobody can guess without the secret.
+    return ((counter & 0x1f) << 27) | ((mss_index & 0x7) << 24) | hash;
+}
+
+Optional<TCPSocket::HalfOpenConnection> TCPSocket::check_syn_cookie(const IPv4SocketTuple& tuple, const TCPPacket& packet) const
+{
+    u32 cookie = packet.ack_number() - 1;
+    u32 peer_sequence_number = packet.sequence_number() - 1;
+    u8 mss_index = (cookie >> 24) & 0x7;
+    auto counter = syn_cookie_counter();
+    for (u32 age = 0; age < 2; ++age) {
+        if (syn_cookie(tuple, peer_sequence_number, counter - age, mss_index) != cookie)
+            continue;
+        HalfOpenConnection connection;
+        connection.sequence_number = cookie;
+        connection.ack_number = packet.sequence_number();
+        connection.options.mss = syn_cookie_mss_values[mss_index];
+        return connection;
+    }
+    return {};
+}
+
+void TCPSocket::update_sack_scoreboard(const SACKBlocks& blocks)
+{
+    MutexLocker locker(m_not_acked_lock);
+    for (auto& packet : m_not_acked) {
+        if (packet.is_sacked || packet.payload_size == 0)
+            continue;
+        u32 left_edge = packet.ack_number - packet.payload_size;
+        for (auto& block : blocks) {
+            if (!is_sequence_number_before(left_edge, block.left_edge) && !is_sequence_number_before(block.right_edge, packet.ack_number)) {
+                packet.is_sacked = true;
+                packet.is_lost = false;
+                break;
+            }
+        }
+    }
+}
+
+void TCPSocket::mark_sack_holes_lost()
+{
+    // RFC 6675 4: A segment is lost once enough segments after it have made it. This only looks at
+    // segments that haven't been retransmitted yet, the retransmission timer takes care of the others.
+    MutexLocker locker(m_not_acked_lock);
+    size_t sacked_after = 0;
+    for (auto& packet : m_not_acked) {
+        if (packet.is_sacked)
+            ++sacked_after;
+    }
+    for (auto& packet : m_not_acked) {
+        if (packet.is_sacked) {
+            --sacked_after;
+            continue;
+        }
+        if (sacked_after < duplicate_acks_for_fast_retransmit)
+            break;
+        if (packet.tx_counter == 0)
+            packet.is_lost = true;
+    }
+}
+
+void TCPSocket::queue_out_of_order_segment(const TCPPacket& tcp_packet, size_t payload_size, const PacketBufferView& ipv4_packet)
+{
+    auto sequence_number = tcp_packet.sequence_number();
+    // Only what's ahead of us and fits into the receive buffer is worth holding on to.
+    if (payload_size == 0 || tcp_packet.has_fin() || !is_sequence_number_before(m_ack_number, sequence_number))
+        return;
+    if (m_out_of_order_segments.size() >= maximum_out_of_order_segments || m_out_of_order_bytes + payload_size > receive_buffer_capacity())
+        return;
+
+    size_t index = 0;
+    while (index < m_out_of_order_segments.size() && is_sequence_number_before(m_out_of_order_segments[index].sequence_number, sequence_number))
+        ++index;
+    if (index < m_out_of_order_segments.size() && m_out_of_order_segments[index].sequence_number == sequence_number)
+        return;
+
+    m_out_of_order_segments.insert(index, { sequence_number, payload_size, ipv4_packet });
+    m_out_of_order_bytes += payload_size;
+    m_last_out_of_order_sequence_number = sequence_number;
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) queued out of order segment {}, waiting for {}", this, sequence_number, m_ack_number);
+}
+
+bool TCPSocket::receive_queued_segments()
+{
+    bool received_any = false;
+    while (!m_out_of_order_segments.is_empty()) {
+        auto& segment = m_out_of_order_segments.first();
+        if (is_sequence_number_before(m_ack_number, segment.sequence_number))
+            break;
+        if (segment.sequence_number == m_ack_number) {
+            // Once the buffer has filled up, the rest has to wait for the peer to send it again.
+            if (!did_receive(peer_address(), peer_port(), segment.packet))
+                break;
+            set_ack_number(segment.sequence_number + segment.payload_size);
+            received_any = true;
+        }
+        // Anything else overlaps with what we have received already.
+        m_out_of_order_bytes -= segment.payload_size;
+        m_out_of_order_segments.take_first();
+    }
+    return received_any;
+}
+
 bool TCPSocket::should_delay_next_ack() const
 {
     // FIXME: We don't know the MSS here so make a reasonable guess.
@@ -314,7 +1058,7 @@ bool TCPSocket::should_delay_next_ack() const
     return true;
 }
 
-NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, const IPv4Address& destination, const TCPPacket& packet, u16 payload_size)
+u16 TCPSocket::sum_tcp_pseudo_header(const IPv4Address& source, const IPv4Address& destination, u16 tcp_length)
 {
     struct [[gnu::packed]] PseudoHeader {
         IPv4Address source;
@@ -324,7 +1068,7 @@ NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, c
         NetworkOrdered<u16> payload_size;
     };
 
-    PseudoHeader pseudo_header { source, destination, 0, (u8)IPv4Protocol::TCP, packet.header_size() + payload_size };
+    PseudoHeader pseudo_header { source, destination, 0, (u8)IPv4Protocol::TCP, tcp_length };
 
     u32 checksum = 0;
     auto* w = (const NetworkOrdered<u16>*)&pseudo_header;
@@ -333,7 +1077,13 @@ NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, c
         if (checksum > 0xffff)
             checksum = (checksum >> 16) + (checksum & 0xffff);
     }
-    w = (const NetworkOrdered<u16>*)&packet;
+    return checksum;
+}
+
+NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, const IPv4Address& destination, const TCPPacket& packet, u16 payload_size)
+{
+    u32 checksum = sum_tcp_pseudo_header(source, destination, packet.header_size() + payload_size);
+    auto* w = (const NetworkOrdered<u16>*)&packet;
     for (size_t i = 0; i < packet.header_size() / sizeof(u16); ++i) {
         checksum += w[i];
         if (checksum > 0xffff)
@@ -355,6 +1105,17 @@ NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, c
     return ~(checksum & 0xffff);
 }
 
+NetworkAdapter::TransmitOffload TCPSocket::fill_in_tcp_checksum(const NetworkAdapter& adapter, const IPv4Address& source, const IPv4Address& destination, TCPPacket& packet, u16 payload_size)
+{
+    packet.set_checksum(0);
+    if (adapter.has_tcp_checksum_offload()) {
+        packet.set_checksum(sum_tcp_pseudo_header(source, destination, packet.header_size() + payload_size));
+        return NetworkAdapter::TransmitOffload::TCPChecksum;
+    }
+    packet.set_checksum(compute_tcp_checksum(source, destination, packet, payload_size));
+    return NetworkAdapter::TransmitOffload::None;
+}
+
 KResult TCPSocket::protocol_bind()
 {
     if (has_specific_local_address() && !m_adapter) {
@@ -369,12 +1130,11 @@ KResult TCPSocket::protocol_bind()
 KResult TCPSocket::protocol_listen(bool did_allocate_port)
 {
     if (!did_allocate_port) {
-        MutexLocker socket_locker(sockets_by_tuple().lock());
-        if (sockets_by_tuple().resource().contains(tuple()))
+        if (!try_add_to_socket_table(tuple(), *this))
             return EADDRINUSE;
-        sockets_by_tuple().resource().set(tuple(), this);
     }
 
+    get_good_random_bytes(m_syn_cookie_secret, sizeof(m_syn_cookie_secret));
     set_direction(Direction::Passive);
     set_state(State::Listen);
     set_setup_state(SetupState::Completed);
@@ -434,14 +1194,11 @@ KResultOr<u16> TCPSocket::protocol_allocate_local_port()
     constexpr u16 ephemeral_port_range_size = last_ephemeral_port - first_ephemeral_port;
     u16 first_scan_port = first_ephemeral_port + get_good_random<u16>() % ephemeral_port_range_size;
 
-    MutexLocker locker(sockets_by_tuple().lock());
     for (u16 port = first_scan_port;;) {
         IPv4SocketTuple proposed_tuple(local_address(), port, peer_address(), peer_port());
 
-        auto it = sockets_by_tuple().resource().find(proposed_tuple);
-        if (it == sockets_by_tuple().resource().end()) {
+        if (try_add_to_socket_table(proposed_tuple, *this)) {
             set_local_port(port);
-            sockets_by_tuple().resource().set(proposed_tuple, this);
             return port;
         }
         ++port;
@@ -472,6 +1229,8 @@ bool TCPSocket::protocol_is_disconnected() const
 void TCPSocket::shut_down_for_writing()
 {
     if (state() == State::Established) {
+        // Whatever we're still holding on to has to go out before the FIN.
+        [[maybe_unused]] auto result = send_unsent_data();
         dbgln_if(TCP_SOCKET_DEBUG, " Sending FIN/ACK from Established and moving into FinWait1");
         [[maybe_unused]] auto rc = send_tcp_packet(TCPFlags::FIN | TCPFlags::ACK);
         set_state(State::FinWait1);
@@ -485,6 +1244,7 @@ KResult TCPSocket::close()
     MutexLocker socket_locker(lock());
     auto result = IPv4Socket::close();
     if (state() == State::CloseWait) {
+        [[maybe_unused]] auto unsent_result = send_unsent_data();
         dbgln_if(TCP_SOCKET_DEBUG, " Sending FIN from CloseWait and moving into LastAck");
         [[maybe_unused]] auto rc = send_tcp_packet(TCPFlags::FIN | TCPFlags::ACK);
         set_state(State::LastAck);
@@ -518,21 +1278,29 @@ void TCPSocket::dequeue_for_retransmit()
 
 void TCPSocket::retransmit_packets()
 {
+    if (m_state == State::Listen) {
+        retransmit_syn_acks();
+        return;
+    }
+
     auto now = kgettimeofday();
 
-    // RFC6298 says we should have at least one second between retransmits. According to
-    // RFC1122 we must do exponential backoff - even for SYN packets.
-    i64 retransmit_interval = 1;
-    for (decltype(m_retransmit_attempts) i = 0; i < m_retransmit_attempts; i++)
-        retransmit_interval *= 2;
+    if (m_unsent_size > 0 && m_corked && now >= m_unsent_data_time + Time::from_milliseconds(cork_timeout_ms)) {
+        [[maybe_unused]] auto result = send_unsent_data();
+    }
 
-    if (m_last_retransmit_time > now - Time::from_seconds(retransmit_interval))
+    {
+        MutexLocker locker(m_not_acked_lock, Mutex::Mode::Shared);
+        if (m_not_acked.is_empty())
+            return;
+    }
+    if (now < m_retransmit_timer_start + retransmit_timeout())
         return;
 
     dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) handling retransmit", this);
 
-    m_last_retransmit_time = now;
     ++m_retransmit_attempts;
+    ++m_retransmit_timeouts;
 
     if (m_retransmit_attempts > maximum_retransmits) {
         set_state(TCPSocket::State::Closed);
@@ -541,42 +1309,118 @@ void TCPSocket::retransmit_packets()
         return;
     }
 
-    auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
+    // RFC 6298 5.5: According to RFC1122 we must do exponential backoff - even for SYN packets.
+    m_retransmit_timeout_us = min(m_retransmit_timeout_us * 2, max_retransmit_timeout_us);
+    m_retransmit_timer_start = now;
+
+    m_congestion_control->on_retransmit_timeout(bytes_in_flight(), now, m_retransmit_attempts == 1);
+    m_in_fast_recovery = false;
+    m_duplicate_acks_received = 0;
+    m_recovery_point = m_sequence_number;
+
+    // Everything is sent again, but only as fast as the congestion window opens up again with the acks for it.
+    {
+        MutexLocker locker(m_not_acked_lock);
+        // RFC 2018 8: The peer may have dropped what it told us about with SACK.
+        for (auto& packet : m_not_acked) {
+            packet.is_lost = true;
+            packet.is_sacked = false;
+        }
+    }
+    retransmit_first_unacked_packet();
+}
+
+void TCPSocket::retransmit_first_unacked_packet()
+{
+    auto routing_decision = route_to_peer();
+    if (routing_decision.is_zero())
+        return;
+
+    MutexLocker locker(m_not_acked_lock);
+    if (!m_not_acked.is_empty())
+        retransmit_packet(m_not_acked.first(), routing_decision);
+}
+
+void TCPSocket::retransmit_lost_packets()
+{
+    MutexLocker locker(m_not_acked_lock);
+    size_t bytes_in_flight = 0;
+    bool has_lost_packets = false;
+    for (auto& packet : m_not_acked) {
+        if (packet.is_lost)
+            has_lost_packets = true;
+        else if (!packet.is_sacked)
+            bytes_in_flight += packet.payload_size;
+    }
+    if (!has_lost_packets)
+        return;
+
+    auto routing_decision = route_to_peer();
     if (routing_decision.is_zero())
         return;
 
-    MutexLocker locker(m_not_acked_lock, Mutex::Mode::Shared);
+    auto congestion_window = m_congestion_control->congestion_window();
     for (auto& packet : m_not_acked) {
-        packet.tx_counter++;
-
-        if constexpr (TCP_SOCKET_DEBUG) {
-            auto& tcp_packet = *(const TCPPacket*)(packet.buffer->buffer.data() + packet.ipv4_payload_offset);
-            dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
-                local_address(), local_port(),
-                peer_address(), peer_port(),
-                (tcp_packet.has_syn() ? "SYN " : ""),
-                (tcp_packet.has_ack() ? "ACK " : ""),
-                (tcp_packet.has_fin() ? "FIN " : ""),
-                (tcp_packet.has_rst() ? "RST " : ""),
-                tcp_packet.sequence_number(),
-                tcp_packet.ack_number(),
-                packet.tx_counter);
-        }
+        if (bytes_in_flight >= congestion_window)
+            break;
+        if (!packet.is_lost)
+            continue;
+        retransmit_packet(packet, routing_decision);
+        bytes_in_flight += packet.payload_size;
+    }
+}
 
-        size_t ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
-        if (ipv4_payload_offset != packet.ipv4_payload_offset) {
-            // FIXME: Add support for this. This can happen if after a route change
-            // we ended up on another adapter which doesn't have the same layer 2 type
-            // like the previous adapter.
-            VERIFY_NOT_REACHED();
-        }
-        routing_decision.adapter->fill_in_ipv4_header(*packet.buffer,
-            local_address(), routing_decision.next_hop, peer_address(),
-            IPv4Protocol::TCP, packet.buffer->buffer.size() - ipv4_payload_offset, ttl());
-        routing_decision.adapter->send_packet({ packet.buffer->buffer.data(), packet.buffer->buffer.size() });
-        m_packets_out++;
-        m_bytes_out += packet.buffer->buffer.size();
+void TCPSocket::retransmit_packet(OutgoingPacket& packet, RoutingDecision& routing_decision)
+{
+    VERIFY(m_not_acked_lock.is_locked());
+    packet.tx_counter++;
+    ++m_retransmitted_segments;
+    packet.is_lost = false;
+
+    if constexpr (TCP_SOCKET_DEBUG) {
+        auto& tcp_packet = *(const TCPPacket*)(packet.buffer->buffer.data() + packet.ipv4_payload_offset);
+        dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
+            local_address(), local_port(),
+            peer_address(), peer_port(),
+            (tcp_packet.has_syn() ? "SYN " : ""),
+            (tcp_packet.has_ack() ? "ACK " : ""),
+            (tcp_packet.has_fin() ? "FIN " : ""),
+            (tcp_packet.has_rst() ? "RST " : ""),
+            tcp_packet.sequence_number(),
+            tcp_packet.ack_number(),
+            packet.tx_counter);
+    }
+
+    size_t ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
+    if (ipv4_payload_offset != packet.ipv4_payload_offset) {
+        // FIXME: Add support for this. This can happen if after a route change
+        // we ended up on another adapter which doesn't have the same layer 2 type
+        // like the previous adapter.
+        VERIFY_NOT_REACHED();
     }
+    size_t ipv4_packet_size = packet.buffer->buffer.size() - ipv4_payload_offset + sizeof(IPv4Packet);
+    if (ipv4_packet_size > routing_decision.adapter->mtu() && ipv4_packet_size > routing_decision.adapter->tcp_segmentation_offload_size()) {
+        // FIXME: Split up packets built for segmentation offload if we ended up on an adapter that can't do it.
+        dbgln("TCPSocket: Can't retransmit {} byte packet on {}", ipv4_packet_size, routing_decision.adapter->name());
+        return;
+    }
+    routing_decision.adapter->fill_in_ipv4_header(*packet.buffer,
+        local_address(), routing_decision.next_hop, peer_address(),
+        IPv4Protocol::TCP, packet.buffer->buffer.size() - ipv4_payload_offset, ttl());
+    auto& tcp_packet = *(TCPPacket*)(packet.buffer->buffer.data() + packet.ipv4_payload_offset);
+    if (m_timestamps_enabled) {
+        // The peer echoes this back, so it has to say when we sent it this time.
+        tcp_packet.for_each_option([&](auto kind, ReadonlyBytes data) {
+            if (kind != TCPOptionKind::Timestamp || data.size() != 2 * sizeof(u32))
+                return;
+            auto& option = *reinterpret_cast<TCPOptionTimestamp*>(const_cast<u8*>(data.data()) - 2);
+            option = TCPOptionTimestamp { current_timestamp(), tcp_packet.has_ack() ? m_recent_timestamp : 0 };
+        });
+    }
+    auto offload = fill_in_tcp_checksum(*routing_decision.adapter, local_address(), peer_address(), tcp_packet, packet.payload_size);
+    routing_decision.adapter->send_packet({ packet.buffer->buffer.data(), packet.buffer->buffer.size() }, offload);
+    m_packets_out++;
+    m_bytes_out += packet.buffer->buffer.size();
 }
 
 bool TCPSocket::can_write(const FileDescription& file_description, size_t size) const
@@ -591,7 +1435,53 @@ bool TCPSocket::can_write(const FileDescription& file_description, size_t size)
         return true;
 
     MutexLocker lock(m_not_acked_lock);
-    return m_not_acked_size + size <= m_send_window_size;
+    return m_not_acked_size + size < send_window();
+}
+
+KResult TCPSocket::setsockopt(int level, int option, Userspace<const void*> user_value, socklen_t user_value_size)
+{
+    if (level != IPPROTO_TCP)
+        return IPv4Socket::setsockopt(level, option, user_value, user_value_size);
+
+    if (option != TCP_NODELAY && option != TCP_CORK)
+        return ENOPROTOOPT;
+    if (user_value_size < sizeof(int))
+        return EINVAL;
+    int value;
+    if (!copy_from_user(&value, static_ptr_cast<const int*>(user_value)))
+        return EFAULT;
+
+    MutexLocker locker(lock());
+    if (option == TCP_NODELAY)
+        m_no_delay = value != 0;
+    else
+        m_corked = value != 0;
+    // Turning either of them off may let go of what we've been holding back.
+    if (m_unsent_size > 0 && may_send_small_segment()) {
+        [[maybe_unused]] auto result = send_unsent_data();
+    }
+    return KSuccess;
+}
+
+KResult TCPSocket::getsockopt(FileDescription& description, int level, int option, Userspace<void*> value, Userspace<socklen_t*> value_size)
+{
+    if (level != IPPROTO_TCP)
+        return IPv4Socket::getsockopt(description, level, option, value, value_size);
+
+    if (option != TCP_NODELAY && option != TCP_CORK)
+        return ENOPROTOOPT;
+    socklen_t size;
+    if (!copy_from_user(&size, value_size.unsafe_userspace_ptr()))
+        return EFAULT;
+    if (size < sizeof(int))
+        return EINVAL;
+    int enabled = option == TCP_NODELAY ? m_no_delay : m_corked;
+    if (!copy_to_user(static_ptr_cast<int*>(value), &enabled))
+        return EFAULT;
+    size = sizeof(int);
+    if (!copy_to_user(value_size, &size))
+        return EFAULT;
+    return KSuccess;
 }
 
 }
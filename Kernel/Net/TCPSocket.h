@@ -9,13 +9,18 @@
 #include <AK/Function.h>
 #include <AK/HashMap.h>
 #include <AK/SinglyLinkedList.h>
+#include <AK/Vector.h>
 #include <AK/WeakPtr.h>
+#include <Kernel/Heap/SlabCache.h>
+#include <Kernel/KBuffer.h>
 #include <Kernel/KResult.h>
 #include <Kernel/Net/IPv4Socket.h>
+#include <Kernel/Net/TCPCongestionControl.h>
 
 namespace Kernel {
 
 class TCPSocket final : public IPv4Socket {
+    MAKE_SLAB_CACHED(TCPSocket)
 public:
     static void for_each(Function<void(const TCPSocket&)>);
     static KResultOr<NonnullRefPtr<TCPSocket>> create(int protocol);
@@ -125,10 +130,21 @@ public:
     void set_sequence_number(u32 n) { m_sequence_number = n; }
     u32 ack_number() const { return m_ack_number; }
     u32 sequence_number() const { return m_sequence_number; }
-    u32 packets_in() const { return m_packets_in; }
-    u32 bytes_in() const { return m_bytes_in; }
-    u32 packets_out() const { return m_packets_out; }
-    u32 bytes_out() const { return m_bytes_out; }
+    u64 packets_in() const { return m_packets_in; }
+    u64 bytes_in() const { return m_bytes_in; }
+    u64 packets_out() const { return m_packets_out; }
+    u64 bytes_out() const { return m_bytes_out; }
+    u64 bytes_acked() const { return m_bytes_acked; }
+    u64 retransmitted_segments() const { return m_retransmitted_segments; }
+    u64 retransmit_timeouts() const { return m_retransmit_timeouts; }
+    u64 fast_retransmits() const { return m_fast_retransmits; }
+    size_t unacked_bytes() const { return m_not_acked_size; }
+    size_t peer_window_size() const { return m_send_window_size; }
+    const TCPCongestionControl& congestion_control() const { return *m_congestion_control; }
+    Time retransmit_timeout() const { return Time::from_microseconds(m_retransmit_timeout_us); }
+    // Empty until we've measured the round trip time at least once.
+    Optional<Time> smoothed_rtt() const { return m_has_rtt_sample ? Time::from_microseconds(m_smoothed_rtt_us) : Optional<Time> {}; }
+    Optional<Time> rtt_variance() const { return m_has_rtt_sample ? Time::from_microseconds(m_rtt_variance_us) : Optional<Time> {}; }
 
     // FIXME: Make this configurable?
     static constexpr u32 maximum_duplicate_acks = 5;
@@ -138,10 +154,23 @@ public:
     KResult send_ack(bool allow_duplicate = false);
     KResult send_tcp_packet(u16 flags, const UserOrKernelBuffer* = nullptr, size_t = 0, RoutingDecision* = nullptr);
     void receive_tcp_packet(const TCPPacket&, u16 size);
+    // Sets up window scaling, SACK and timestamps from the options of the peer's SYN.
+    void process_syn_options(const TCPPacket&);
+
+    // Listening sockets only remember a little about the connections they're asked for, until the
+    // peer acks our SYN|ACK. Only then is a socket created for the connection, and queued for accept().
+    void receive_syn(const IPv4Address& local_address, const IPv4Address& peer_address, const TCPPacket&);
+    // Returns the new socket if the packet completed a connection.
+    RefPtr<TCPSocket> receive_handshake_ack(const IPv4Address& local_address, const IPv4Address& peer_address, const TCPPacket&);
+
+    // Out of order segments are held on to, so that we can tell the peer about them with SACK
+    // and don't have to wait for them to be sent again.
+    void queue_out_of_order_segment(const TCPPacket&, size_t payload_size, const PacketBufferView& ipv4_packet);
+    // Returns whether any queued segments could be received.
+    bool receive_queued_segments();
 
     bool should_delay_next_ack() const;
 
-    static Lockable<HashMap<IPv4SocketTuple, TCPSocket*>>& sockets_by_tuple();
     static RefPtr<TCPSocket> from_tuple(const IPv4SocketTuple& tuple);
 
     static Lockable<HashMap<IPv4SocketTuple, RefPtr<TCPSocket>>>& closing_sockets();
@@ -159,6 +188,9 @@ public:
 
     virtual bool can_write(const FileDescription&, size_t) const override;
 
+    virtual KResult setsockopt(int level, int option, Userspace<const void*>, socklen_t) override;
+    virtual KResult getsockopt(FileDescription&, int level, int option, Userspace<void*>, Userspace<socklen_t*>) override;
+
 protected:
     void set_direction(Direction direction) { m_direction = direction; }
 
@@ -166,11 +198,17 @@ private:
     explicit TCPSocket(int protocol);
     virtual StringView class_name() const override { return "TCPSocket"; }
 
+    static u16 sum_tcp_pseudo_header(const IPv4Address& source, const IPv4Address& destination, u16 tcp_length);
     static NetworkOrdered<u16> compute_tcp_checksum(const IPv4Address& source, const IPv4Address& destination, const TCPPacket&, u16 payload_size);
+    size_t build_options(u16 flags, size_t payload_size, const NetworkAdapter&, u8* options);
+    u16 advertised_window_size(u16 flags) const;
+    u32 current_timestamp() const;
+    // Leaves the checksum to the adapter if it can compute it itself.
+    static NetworkAdapter::TransmitOffload fill_in_tcp_checksum(const NetworkAdapter&, const IPv4Address& source, const IPv4Address& destination, TCPPacket&, u16 payload_size);
 
     virtual void shut_down_for_writing() override;
 
-    virtual KResultOr<size_t> protocol_receive(ReadonlyBytes raw_ipv4_packet, UserOrKernelBuffer& buffer, size_t buffer_size, int flags) override;
+    virtual ReadonlyBytes protocol_payload(ReadonlyBytes raw_ipv4_packet) const override;
     virtual KResultOr<size_t> protocol_send(const UserOrKernelBuffer&, size_t) override;
     virtual KResult protocol_connect(FileDescription&, ShouldBlock) override;
     virtual KResultOr<u16> protocol_allocate_local_port() override;
@@ -181,18 +219,71 @@ private:
     void enqueue_for_retransmit();
     void dequeue_for_retransmit();
 
+    struct SYNOptions {
+        Optional<u16> mss;
+        Optional<u8> window_scale;
+        bool sack_permitted { false };
+        Optional<u32> timestamp;
+        u16 window_size { 0 };
+    };
+    static SYNOptions parse_syn_options(const TCPPacket&);
+    void apply_syn_options(const SYNOptions&);
+
+    // A connection the peer has sent us a SYN for, and that we've answered with a SYN|ACK.
+    struct HalfOpenConnection {
+        u32 sequence_number { 0 };
+        u32 ack_number { 0 };
+        SYNOptions options;
+        Time syn_ack_sent_time;
+        u32 retransmit_attempts { 0 };
+    };
+    KResult send_syn_ack(const IPv4SocketTuple&, const HalfOpenConnection&);
+    void retransmit_syn_acks();
+    u32 syn_cookie(const IPv4SocketTuple&, u32 peer_sequence_number, u32 counter, u8 mss_index) const;
+    Optional<HalfOpenConnection> check_syn_cookie(const IPv4SocketTuple&, const TCPPacket&) const;
+
+    struct OutgoingPacket;
+    struct SACKBlock {
+        u32 left_edge { 0 };
+        u32 right_edge { 0 };
+    };
+    using SACKBlocks = Vector<SACKBlock, 4>;
+    void update_sack_scoreboard(const SACKBlocks&);
+    void mark_sack_holes_lost();
+
+    void handle_new_ack(u32 ack_number, size_t acked_bytes, Optional<Time> rtt_sample, Time now);
+    void handle_duplicate_ack(Time now);
+    void update_retransmit_timeout(Time rtt_sample);
+    void retransmit_packet(OutgoingPacket&, RoutingDecision&);
+    void retransmit_first_unacked_packet();
+    void retransmit_lost_packets();
+    size_t bytes_in_flight() const;
+    size_t bytes_outstanding() const;
+    size_t send_window() const;
+    size_t send_mss(const NetworkAdapter&) const;
+
+    // Whether a segment that is smaller than the MSS can go out right now, see protocol_send().
+    bool may_send_small_segment() const;
+    KResult send_unsent_data();
+
     WeakPtr<TCPSocket> m_originator;
     HashMap<IPv4SocketTuple, NonnullRefPtr<TCPSocket>> m_pending_release_for_accept;
+    HashMap<IPv4SocketTuple, HalfOpenConnection> m_half_open_connections;
+    u8 m_syn_cookie_secret[16] {};
     Direction m_direction { Direction::Unspecified };
     Error m_error { Error::None };
     RefPtr<NetworkAdapter> m_adapter;
     u32 m_sequence_number { 0 };
     u32 m_ack_number { 0 };
     State m_state { State::Closed };
-    u32 m_packets_in { 0 };
-    u32 m_bytes_in { 0 };
-    u32 m_packets_out { 0 };
-    u32 m_bytes_out { 0 };
+    u64 m_packets_in { 0 };
+    u64 m_bytes_in { 0 };
+    u64 m_packets_out { 0 };
+    u64 m_bytes_out { 0 };
+    u64 m_bytes_acked { 0 };
+    u64 m_retransmitted_segments { 0 };
+    u64 m_retransmit_timeouts { 0 };
+    u64 m_fast_retransmits { 0 };
 
     struct OutgoingPacket {
         u32 ack_number { 0 };
@@ -200,6 +291,12 @@ private:
         size_t ipv4_payload_offset;
         WeakPtr<NetworkAdapter> adapter;
         int tx_counter { 0 };
+        Time sent_time;
+        size_t payload_size { 0 };
+        // Set for everything that was in flight when the retransmission timer went off, and for the
+        // holes SACK tells us about in fast recovery. These are sent again as the congestion window allows.
+        bool is_lost { false };
+        bool is_sacked { false };
     };
 
     mutable Mutex m_not_acked_lock { "TCPSocket unacked packets" };
@@ -211,13 +308,55 @@ private:
     u32 m_last_ack_number_sent { 0 };
     Time m_last_ack_sent_time;
 
+    // Small writes are collected here until they fill up a segment, or until they may be sent anyway.
+    OwnPtr<KBuffer> m_unsent_data;
+    size_t m_unsent_size { 0 };
+    Time m_unsent_data_time;
+    bool m_no_delay { false };
+    bool m_corked { false };
+    // Like on Linux, a cork never holds back data for longer than this.
+    static constexpr i64 cork_timeout_ms = 200;
+
+    NonnullOwnPtr<TCPCongestionControl> m_congestion_control;
+    u32 m_last_ack_received { 0 };
+    u32 m_duplicate_acks_received { 0 };
+    // RFC 6582: Fast recovery ends once everything up to here has been acknowledged.
+    bool m_in_fast_recovery { false };
+    u32 m_recovery_point { 0 };
+
+    // RFC 6298, in microseconds.
+    bool m_has_rtt_sample { false };
+    i64 m_smoothed_rtt_us { 0 };
+    i64 m_rtt_variance_us { 0 };
+    i64 m_retransmit_timeout_us { 1'000'000 };
+
     // FIXME: Make this configurable (sysctl)
     static constexpr u32 maximum_retransmits = 5;
-    Time m_last_retransmit_time;
+    Time m_retransmit_timer_start;
     u32 m_retransmit_attempts { 0 };
 
-    // FIXME: Parse window size TCP option from the peer
+    // What the peer advertised, until then we assume it's got room for this much.
     u32 m_send_window_size { 64 * KiB };
+    Optional<u16> m_peer_mss;
+
+    // Negotiated on SYN, until we have seen the peer's SYN these are what we offer.
+    bool m_window_scale_enabled { true };
+    u8 m_send_window_scale { 0 };
+    u8 m_receive_window_scale { 0 };
+    bool m_sack_enabled { true };
+    bool m_timestamps_enabled { true };
+    // The peer's timestamp to echo back (RFC 7323 4.3).
+    u32 m_recent_timestamp { 0 };
+
+    struct OutOfOrderSegment {
+        u32 sequence_number { 0 };
+        size_t payload_size { 0 };
+        PacketBufferView packet;
+    };
+    // Sorted by sequence number.
+    Vector<OutOfOrderSegment> m_out_of_order_segments;
+    size_t m_out_of_order_bytes { 0 };
+    u32 m_last_out_of_order_sequence_number { 0 };
 };
 
 }
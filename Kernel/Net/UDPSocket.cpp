@@ -6,7 +6,9 @@
 
 #include <AK/Singleton.h>
 #include <Kernel/Devices/RandomDevice.h>
+#include <Kernel/Net/LoopbackAdapter.h>
 #include <Kernel/Net/NetworkAdapter.h>
+#include <Kernel/Net/NetworkingManagement.h>
 #include <Kernel/Net/Routing.h>
 #include <Kernel/Net/UDP.h>
 #include <Kernel/Net/UDPSocket.h>
@@ -75,7 +77,7 @@ KResultOr<size_t> UDPSocket::protocol_receive(ReadonlyBytes raw_ipv4_packet, Use
 
 KResultOr<size_t> UDPSocket::protocol_send(const UserOrKernelBuffer& data, size_t data_length)
 {
-    auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
+    auto routing_decision = route_to_peer();
     if (routing_decision.is_zero())
         return EHOSTUNREACH;
     auto ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
@@ -94,6 +96,10 @@ KResultOr<size_t> UDPSocket::protocol_send(const UserOrKernelBuffer& data, size_
 
     routing_decision.adapter->fill_in_ipv4_header(*packet, local_address(), routing_decision.next_hop,
         peer_address(), IPv4Protocol::UDP, udp_buffer_size, ttl());
+    if (routing_decision.adapter == NetworkingManagement::the().loopback_adapter()) {
+        static_cast<LoopbackAdapter&>(*routing_decision.adapter).deliver_udp_packet(packet.release_nonnull());
+        return data_length;
+    }
     routing_decision.adapter->send_packet({ packet->buffer.data(), packet->buffer.size() });
     return data_length;
 }
@@ -0,0 +1,414 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/MACAddress.h>
+#include <Kernel/Bus/PCI/IDs.h>
+#include <Kernel/Debug.h>
+#include <Kernel/Net/EtherType.h>
+#include <Kernel/Net/TCP.h>
+#include <Kernel/Net/VirtIONetworkAdapter.h>
+#include <Kernel/Random.h>
+#include <Kernel/Sections.h>
+
+namespace Kernel {
+
+#define VIRTIO_NET_S_LINK_UP (1 << 0)
+
+#define VIRTIO_NET_OK 0
+#define VIRTIO_NET_CTRL_MQ 4
+#define VIRTIO_NET_CTRL_MQ_VQ_PAIRS_SET 0
+
+// The command goes at the start of the control buffer, the device writes its answer here.
+static constexpr size_t control_ack_offset = 64;
+
+UNMAP_AFTER_INIT RefPtr<VirtIONetworkAdapter> VirtIONetworkAdapter::try_to_initialize(PCI::Address address)
+{
+    auto id = PCI::get_id(address);
+    if (id.vendor_id != PCI::VendorID::VirtIO)
+        return {};
+    if (id.device_id != PCI::DeviceID::VirtIONetwork && id.device_id != PCI::DeviceID::VirtIONetworkNonTransitional)
+        return {};
+    auto adapter = adopt_ref_if_nonnull(new (nothrow) VirtIONetworkAdapter(address));
+    if (!adapter)
+        return {};
+    if (adapter->initialize())
+        return adapter;
+    adapter->set_status_bit(DEVICE_STATUS_FAILED);
+    return {};
+}
+
+UNMAP_AFTER_INIT VirtIONetworkAdapter::VirtIONetworkAdapter(PCI::Address address)
+    : VirtIODevice(address, "VirtIONetworkAdapter")
+{
+    set_interface_name(address);
+}
+
+VirtIONetworkAdapter::~VirtIONetworkAdapter()
+{
+}
+
+UNMAP_AFTER_INIT bool VirtIONetworkAdapter::initialize()
+{
+    auto* cfg = get_config(ConfigurationType::Device);
+    if (!cfg) {
+        dbgln("VirtIONetworkAdapter: Legacy devices are not supported");
+        return false;
+    }
+
+    bool success = negotiate_features([&](u64 supported_features) {
+        u64 negotiated = 0;
+        auto negotiate_if_supported = [&](u64 feature) {
+            if (is_feature_set(supported_features, feature))
+                negotiated |= feature;
+        };
+        negotiate_if_supported(VIRTIO_NET_F_MAC);
+        negotiate_if_supported(VIRTIO_NET_F_STATUS);
+        negotiate_if_supported(VIRTIO_NET_F_MRG_RXBUF);
+        negotiate_if_supported(VIRTIO_NET_F_CSUM);
+        if (is_feature_set(negotiated, VIRTIO_NET_F_CSUM))
+            negotiate_if_supported(VIRTIO_NET_F_HOST_TSO4);
+        // We never check the checksums of received packets anyway, so partially checksummed ones are fine too.
+        negotiate_if_supported(VIRTIO_NET_F_GUEST_CSUM);
+        if (is_feature_set(negotiated, VIRTIO_NET_F_GUEST_CSUM | VIRTIO_NET_F_MRG_RXBUF))
+            negotiate_if_supported(VIRTIO_NET_F_GUEST_TSO4);
+        negotiate_if_supported(VIRTIO_NET_F_CTRL_VQ);
+        if (is_feature_set(negotiated, VIRTIO_NET_F_CTRL_VQ))
+            negotiate_if_supported(VIRTIO_NET_F_MQ);
+        return negotiated;
+    });
+    if (!success)
+        return false;
+
+    MACAddress mac_address;
+    u16 status = VIRTIO_NET_S_LINK_UP;
+    u16 max_queue_pair_count_of_device = 1;
+    read_config_atomic([&]() {
+        if (is_feature_accepted(VIRTIO_NET_F_MAC)) {
+            for (size_t i = 0; i < 6; i++)
+                mac_address[i] = config_read8(*cfg, i);
+        }
+        if (is_feature_accepted(VIRTIO_NET_F_STATUS))
+            status = config_read16(*cfg, 0x6);
+        if (is_feature_accepted(VIRTIO_NET_F_MQ))
+            max_queue_pair_count_of_device = config_read16(*cfg, 0x8);
+    });
+    if (!is_feature_accepted(VIRTIO_NET_F_MAC)) {
+        // Make up a locally administered unicast address.
+        for (size_t i = 0; i < 6; i++)
+            mac_address[i] = get_fast_random<u8>();
+        mac_address[0] = (mac_address[0] & ~1) | 2;
+    }
+    set_mac_address(mac_address);
+    m_link_up = status & VIRTIO_NET_S_LINK_UP;
+    m_has_tcp_checksum_offload = is_feature_accepted(VIRTIO_NET_F_CSUM);
+    m_has_tcp_segmentation_offload = is_feature_accepted(VIRTIO_NET_F_HOST_TSO4);
+    if (max_queue_pair_count_of_device == 0)
+        return false;
+
+    // The receive and transmit queues of all pairs come first, the control queue is always the one after them.
+    u16 queue_count = max_queue_pair_count_of_device * 2;
+    if (is_feature_accepted(VIRTIO_NET_F_CTRL_VQ))
+        m_control_queue_index = queue_count++;
+    if (!setup_queues(queue_count))
+        return false;
+    finish_init();
+
+    // Every processor gets to transmit on a queue pair of its own, if there are enough of them.
+    m_queue_pair_count = min(min(static_cast<size_t>(max(Processor::count(), 1u)), static_cast<size_t>(max_queue_pair_count_of_device)), max_queue_pair_count);
+
+    if (m_control_queue_index.has_value()) {
+        m_control_buffer = MM.allocate_contiguous_kernel_region(PAGE_SIZE, "VirtIONetworkAdapter Control", Region::Access::Read | Region::Access::Write);
+        if (!m_control_buffer)
+            return false;
+    }
+
+    if (m_has_tcp_segmentation_offload)
+        m_transmit_buffer_size = page_round_up(sizeof(PacketHeader) + sizeof(EthernetFrameHeader) + max_tcp_segmentation_offload_size);
+    for (size_t pair = 0; pair < m_queue_pair_count; pair++) {
+        ReceiveQueue receive_queue;
+        receive_queue.buffer_count = min(max_receive_buffer_count, static_cast<size_t>(get_queue(receive_queue_index(pair)).size()));
+        receive_queue.buffers = MM.allocate_contiguous_kernel_region(page_round_up(receive_queue.buffer_count * receive_buffer_size), "VirtIONetworkAdapter RX", Region::Access::Read | Region::Access::Write);
+        if (!receive_queue.buffers)
+            return false;
+        if (is_feature_accepted(VIRTIO_NET_F_GUEST_TSO4)) {
+            receive_queue.merge_buffer = MM.allocate_kernel_region(page_round_up(max_merged_frame_size), "VirtIONetworkAdapter RX Merge", Region::Access::Read | Region::Access::Write, AllocationStrategy::AllocateNow);
+            if (!receive_queue.merge_buffer)
+                return false;
+        }
+        m_receive_queues.append(move(receive_queue));
+
+        TransmitQueue transmit_queue;
+        transmit_queue.buffers = MM.allocate_contiguous_kernel_region(transmit_buffer_count * m_transmit_buffer_size, "VirtIONetworkAdapter TX", Region::Access::Read | Region::Access::Write);
+        if (!transmit_queue.buffers)
+            return false;
+        m_transmit_queues.append(move(transmit_queue));
+    }
+
+    for (size_t pair = 0; pair < m_queue_pair_count; pair++) {
+        for (size_t buffer_index = 0; buffer_index < m_receive_queues[pair].buffer_count; buffer_index++)
+            supply_receive_buffer(pair, buffer_index);
+    }
+
+    // Until told otherwise, the device only uses the first queue pair.
+    if (m_queue_pair_count > 1 && !set_queue_pair_count(m_queue_pair_count)) {
+        dbgln("VirtIONetworkAdapter: Failed to enable {} queue pairs", m_queue_pair_count);
+        m_queue_pair_count = 1;
+    }
+
+    dmesgln("VirtIONetworkAdapter: {} @ {}, {} queue pairs{}{}{}", mac_address.to_string(), pci_address(), m_queue_pair_count,
+        m_has_tcp_checksum_offload ? ", checksum offload" : "",
+        m_has_tcp_segmentation_offload ? ", segmentation offload" : "",
+        is_feature_accepted(VIRTIO_NET_F_MRG_RXBUF) ? ", mergeable receive buffers" : "");
+    return true;
+}
+
+UNMAP_AFTER_INIT bool VirtIONetworkAdapter::set_queue_pair_count(u16 queue_pair_count)
+{
+    VERIFY(is_feature_accepted(VIRTIO_NET_F_MQ));
+    return send_control_command(VIRTIO_NET_CTRL_MQ, VIRTIO_NET_CTRL_MQ_VQ_PAIRS_SET, { &queue_pair_count, sizeof(queue_pair_count) });
+}
+
+UNMAP_AFTER_INIT bool VirtIONetworkAdapter::send_control_command(u8 command_class, u8 command, ReadonlyBytes data)
+{
+    VERIFY(m_control_queue_index.has_value());
+    VERIFY(2 + data.size() <= control_ack_offset);
+    auto* control = m_control_buffer->vaddr().as_ptr();
+    control[0] = command_class;
+    control[1] = command;
+    memcpy(control + 2, data.data(), data.size());
+    control[control_ack_offset] = 0xff;
+    m_control_command_completed = false;
+
+    auto control_address = m_control_buffer->physical_page(0)->paddr();
+    auto& queue = get_queue(m_control_queue_index.value());
+    {
+        ScopedSpinLock lock(queue.lock());
+        VirtIOQueueChain chain(queue);
+        bool did_add_buffers = chain.add_buffer_to_chain(control_address, 2 + data.size(), BufferType::DeviceReadable)
+            && chain.add_buffer_to_chain(control_address.offset(control_ack_offset), 1, BufferType::DeviceWritable);
+        VERIFY(did_add_buffers);
+        supply_chain_and_notify(m_control_queue_index.value(), chain);
+    }
+
+    // Commands are only sent while initializing, so it's fine to spin until the device is done with it.
+    while (!m_control_command_completed) {
+        reclaim_control_buffers();
+        Processor::wait_check();
+    }
+    return control[control_ack_offset] == VIRTIO_NET_OK;
+}
+
+void VirtIONetworkAdapter::reclaim_control_buffers()
+{
+    auto& queue = get_queue(m_control_queue_index.value());
+    ScopedSpinLock lock(queue.lock());
+    size_t used;
+    for (auto chain = queue.pop_used_buffer_chain(used); !chain.is_empty(); chain = queue.pop_used_buffer_chain(used)) {
+        chain.release_buffer_slots_to_queue();
+        m_control_command_completed = true;
+    }
+}
+
+bool VirtIONetworkAdapter::handle_device_config_change()
+{
+    if (!is_feature_accepted(VIRTIO_NET_F_STATUS))
+        return true;
+    auto* cfg = get_config(ConfigurationType::Device);
+    u16 status = 0;
+    read_config_atomic([&]() {
+        status = config_read16(*cfg, 0x6);
+    });
+    m_link_up = status & VIRTIO_NET_S_LINK_UP;
+    dbgln_if(VIRTIO_DEBUG, "VirtIONetworkAdapter: Link is {}", m_link_up ? "up" : "down");
+    return true;
+}
+
+void VirtIONetworkAdapter::handle_queue_update(u16 queue_index)
+{
+    if (m_control_queue_index.has_value() && queue_index == m_control_queue_index.value()) {
+        reclaim_control_buffers();
+        return;
+    }
+    size_t pair = queue_index / 2;
+    if (pair >= m_queue_pair_count)
+        return;
+    if (queue_index == receive_queue_index(pair)) {
+        receive(pair);
+        return;
+    }
+    reclaim_transmit_buffers(pair);
+    m_transmit_wait_queue.wake_all();
+}
+
+void VirtIONetworkAdapter::supply_receive_buffer(size_t pair, size_t buffer_index)
+{
+    auto& receive_queue = m_receive_queues[pair];
+    auto buffer_address = receive_queue.buffers->physical_page(0)->paddr().offset(buffer_index * receive_buffer_size);
+    auto& queue = get_queue(receive_queue_index(pair));
+    ScopedSpinLock lock(queue.lock());
+    VirtIOQueueChain chain(queue);
+    bool did_add_buffer = chain.add_buffer_to_chain(buffer_address, receive_buffer_size, BufferType::DeviceWritable);
+    VERIFY(did_add_buffer);
+    supply_chain_and_notify(receive_queue_index(pair), chain);
+}
+
+void VirtIONetworkAdapter::receive(size_t pair)
+{
+    auto& receive_queue = m_receive_queues[pair];
+    auto& queue = get_queue(receive_queue_index(pair));
+    auto buffers_start = receive_queue.buffers->physical_page(0)->paddr();
+    for (;;) {
+        size_t used;
+        PhysicalAddress buffer_address;
+        {
+            ScopedSpinLock lock(queue.lock());
+            auto chain = queue.pop_used_buffer_chain(used);
+            if (chain.is_empty())
+                break;
+            VERIFY(chain.length() == 1);
+            chain.for_each([&](PhysicalAddress address, size_t) {
+                buffer_address = address;
+            });
+            chain.release_buffer_slots_to_queue();
+        }
+        size_t buffer_index = (buffer_address.get() - buffers_start.get()) / receive_buffer_size;
+        VERIFY(buffer_index < receive_queue.buffer_count);
+        auto* buffer = receive_queue.buffers->vaddr().offset(buffer_index * receive_buffer_size).as_ptr();
+        receive_buffer(receive_queue, buffer, min(used, receive_buffer_size));
+        supply_receive_buffer(pair, buffer_index);
+    }
+}
+
+void VirtIONetworkAdapter::receive_buffer(ReceiveQueue& receive_queue, const u8* buffer, size_t size)
+{
+    if (receive_queue.buffers_left_to_merge == 0) {
+        if (size < sizeof(PacketHeader)) {
+            dbgln_if(VIRTIO_DEBUG, "VirtIONetworkAdapter: Dropping runt buffer of {} bytes", size);
+            return;
+        }
+        auto& header = *reinterpret_cast<const PacketHeader*>(buffer);
+        ReadonlyBytes frame { buffer + sizeof(PacketHeader), size - sizeof(PacketHeader) };
+        u16 buffer_count = is_feature_accepted(VIRTIO_NET_F_MRG_RXBUF) ? header.buffer_count : 1;
+        if (buffer_count <= 1) {
+            did_receive(frame);
+            return;
+        }
+        receive_queue.buffers_left_to_merge = buffer_count - 1;
+        receive_queue.merged_size = 0;
+        receive_queue.merge_failed = !receive_queue.merge_buffer;
+        buffer = frame.data();
+        size = frame.size();
+    } else {
+        receive_queue.buffers_left_to_merge--;
+    }
+
+    if (!receive_queue.merge_failed && receive_queue.merged_size + size <= receive_queue.merge_buffer->size()) {
+        memcpy(receive_queue.merge_buffer->vaddr().offset(receive_queue.merged_size).as_ptr(), buffer, size);
+        receive_queue.merged_size += size;
+    } else {
+        receive_queue.merge_failed = true;
+    }
+
+    if (receive_queue.buffers_left_to_merge != 0)
+        return;
+    if (receive_queue.merge_failed) {
+        dbgln("VirtIONetworkAdapter: Dropping frame that doesn't fit into the merge buffer");
+        return;
+    }
+    did_receive({ receive_queue.merge_buffer->vaddr().as_ptr(), receive_queue.merged_size });
+}
+
+void VirtIONetworkAdapter::reclaim_transmit_buffers(size_t pair)
+{
+    auto& transmit_queue = m_transmit_queues[pair];
+    auto& queue = get_queue(transmit_queue_index(pair));
+    auto buffers_start = transmit_queue.buffers->physical_page(0)->paddr();
+    ScopedSpinLock lock(queue.lock());
+    size_t used;
+    for (auto chain = queue.pop_used_buffer_chain(used); !chain.is_empty(); chain = queue.pop_used_buffer_chain(used)) {
+        chain.for_each([&](PhysicalAddress address, size_t) {
+            size_t buffer_index = (address.get() - buffers_start.get()) / m_transmit_buffer_size;
+            VERIFY(buffer_index < transmit_buffer_count);
+            transmit_queue.busy_buffers &= ~(1u << buffer_index);
+        });
+        chain.release_buffer_slots_to_queue();
+    }
+}
+
+void VirtIONetworkAdapter::send_raw(ReadonlyBytes payload)
+{
+    PacketHeader header {};
+    header.segmentation_type = segmentation_type_none;
+    send(payload, header);
+}
+
+void VirtIONetworkAdapter::send_raw_with_tcp_offload(ReadonlyBytes payload)
+{
+    // These come straight from TCPSocket, so they are TCP in IPv4 without any IP options.
+    VERIFY(payload.size() >= sizeof(EthernetFrameHeader) + sizeof(IPv4Packet) + sizeof(TCPPacket));
+    auto& eth = *reinterpret_cast<const EthernetFrameHeader*>(payload.data());
+    VERIFY(eth.ether_type() == EtherType::IPv4);
+    auto& ipv4 = *static_cast<const IPv4Packet*>(eth.payload());
+    VERIFY(ipv4.protocol() == static_cast<u8>(IPv4Protocol::TCP));
+    auto& tcp = *static_cast<const TCPPacket*>(ipv4.payload());
+
+    PacketHeader header {};
+    header.flags = packet_flag_needs_checksum;
+    header.checksum_start = sizeof(EthernetFrameHeader) + sizeof(IPv4Packet);
+    header.checksum_offset = 16;
+    header.segmentation_type = segmentation_type_none;
+    if (ipv4.length() > mtu()) {
+        VERIFY(m_has_tcp_segmentation_offload);
+        header.segmentation_type = segmentation_type_tcpv4;
+        header.header_length = header.checksum_start + tcp.header_size();
+        header.segment_size = mtu() - sizeof(IPv4Packet) - tcp.header_size();
+    }
+    send(payload, header);
+}
+
+void VirtIONetworkAdapter::send(ReadonlyBytes payload, const PacketHeader& header)
+{
+    if (sizeof(PacketHeader) + payload.size() > m_transmit_buffer_size) {
+        dbgln("VirtIONetworkAdapter: Dropping {} byte packet that doesn't fit into a transmit buffer", payload.size());
+        return;
+    }
+    // Spreading the processors over the queue pairs lets them transmit without contending for a queue.
+    size_t pair = Processor::id() % m_queue_pair_count;
+    auto& transmit_queue = m_transmit_queues[pair];
+    auto& queue = get_queue(transmit_queue_index(pair));
+
+    Optional<size_t> buffer_index;
+    for (;;) {
+        reclaim_transmit_buffers(pair);
+        {
+            ScopedSpinLock lock(queue.lock());
+            for (size_t index = 0; index < transmit_buffer_count; index++) {
+                if (transmit_queue.busy_buffers & (1u << index))
+                    continue;
+                transmit_queue.busy_buffers |= 1u << index;
+                buffer_index = index;
+                break;
+            }
+        }
+        if (buffer_index.has_value())
+            break;
+        m_transmit_wait_queue.wait_forever("VirtIONetworkAdapter");
+    }
+
+    dbgln_if(VIRTIO_DEBUG, "VirtIONetworkAdapter: Sending {} byte packet on queue pair {}", payload.size(), pair);
+    auto* buffer = transmit_queue.buffers->vaddr().offset(buffer_index.value() * m_transmit_buffer_size).as_ptr();
+    memcpy(buffer, &header, sizeof(PacketHeader));
+    memcpy(buffer + sizeof(PacketHeader), payload.data(), payload.size());
+
+    auto buffer_address = transmit_queue.buffers->physical_page(0)->paddr().offset(buffer_index.value() * m_transmit_buffer_size);
+    ScopedSpinLock lock(queue.lock());
+    VirtIOQueueChain chain(queue);
+    bool did_add_buffer = chain.add_buffer_to_chain(buffer_address, sizeof(PacketHeader) + payload.size(), BufferType::DeviceReadable);
+    VERIFY(did_add_buffer);
+    supply_chain_and_notify(transmit_queue_index(pair), chain);
+}
+
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/OwnPtr.h>
+#include <AK/Vector.h>
+#include <Kernel/Net/NetworkAdapter.h>
+#include <Kernel/VirtIO/VirtIO.h>
+#include <Kernel/WaitQueue.h>
+
+namespace Kernel {
+
+#define VIRTIO_NET_F_CSUM (1 << 0)
+#define VIRTIO_NET_F_GUEST_CSUM (1 << 1)
+#define VIRTIO_NET_F_MAC (1 << 5)
+#define VIRTIO_NET_F_GUEST_TSO4 (1 << 7)
+#define VIRTIO_NET_F_HOST_TSO4 (1 << 11)
+#define VIRTIO_NET_F_MRG_RXBUF (1 << 15)
+#define VIRTIO_NET_F_STATUS (1 << 16)
+#define VIRTIO_NET_F_CTRL_VQ (1 << 17)
+#define VIRTIO_NET_F_MQ (1 << 22)
+
+class VirtIONetworkAdapter final : public NetworkAdapter
+    , public VirtIODevice {
+public:
+    static RefPtr<VirtIONetworkAdapter> try_to_initialize(PCI::Address);
+
+    virtual ~VirtIONetworkAdapter() override;
+
+    virtual bool link_up() override { return m_link_up; }
+    virtual bool has_tcp_checksum_offload() const override { return m_has_tcp_checksum_offload; }
+    virtual size_t tcp_segmentation_offload_size() const override { return m_has_tcp_segmentation_offload ? max_tcp_segmentation_offload_size : 0; }
+
+    virtual StringView purpose() const override { return class_name(); }
+
+private:
+    explicit VirtIONetworkAdapter(PCI::Address);
+    virtual StringView class_name() const override { return "VirtIONetworkAdapter"sv; }
+
+    // ^NetworkAdapter
+    virtual void send_raw(ReadonlyBytes) override;
+    virtual void send_raw_with_tcp_offload(ReadonlyBytes) override;
+
+    // ^VirtIODevice
+    virtual bool handle_device_config_change() override;
+    virtual void handle_queue_update(u16 queue_index) override;
+
+    bool initialize();
+
+    // Precedes every packet that goes through the receive and transmit queues.
+    struct [[gnu::packed]] PacketHeader {
+        u8 flags;
+        u8 segmentation_type;
+        u16 header_length;
+        u16 segment_size;
+        u16 checksum_start;
+        u16 checksum_offset;
+        u16 buffer_count;
+    };
+
+    static constexpr u8 packet_flag_needs_checksum = 1;
+    static constexpr u8 segmentation_type_none = 0;
+    static constexpr u8 segmentation_type_tcpv4 = 1;
+
+    struct ReceiveQueue {
+        OwnPtr<Region> buffers;
+        size_t buffer_count { 0 };
+        // With VIRTIO_NET_F_GUEST_TSO4, frames can span several buffers and are put back together here.
+        OwnPtr<Region> merge_buffer;
+        size_t merged_size { 0 };
+        u16 buffers_left_to_merge { 0 };
+        bool merge_failed { false };
+    };
+
+    struct TransmitQueue {
+        OwnPtr<Region> buffers;
+        // Guarded by the queue's lock.
+        u32 busy_buffers { 0 };
+    };
+
+    static constexpr size_t max_queue_pair_count = 16;
+    static constexpr size_t receive_buffer_size = 2 * KiB;
+    static constexpr size_t max_receive_buffer_count = 128;
+    static constexpr size_t transmit_buffer_count = 16;
+    static constexpr size_t max_tcp_segmentation_offload_size = 32 * KiB;
+    static constexpr size_t max_merged_frame_size = sizeof(EthernetFrameHeader) + 64 * KiB;
+
+    u16 receive_queue_index(size_t pair) const { return pair * 2; }
+    u16 transmit_queue_index(size_t pair) const { return pair * 2 + 1; }
+
+    bool set_queue_pair_count(u16);
+    bool send_control_command(u8 command_class, u8 command, ReadonlyBytes data);
+    void reclaim_control_buffers();
+
+    void supply_receive_buffer(size_t pair, size_t buffer_index);
+    void receive(size_t pair);
+    void receive_buffer(ReceiveQueue&, const u8* buffer, size_t size);
+
+    void send(ReadonlyBytes, const PacketHeader&);
+    void reclaim_transmit_buffers(size_t pair);
+
+    Vector<ReceiveQueue> m_receive_queues;
+    Vector<TransmitQueue> m_transmit_queues;
+    WaitQueue m_transmit_wait_queue;
+    size_t m_transmit_buffer_size { PAGE_SIZE };
+    size_t m_queue_pair_count { 1 };
+
+    Optional<u16> m_control_queue_index;
+    OwnPtr<Region> m_control_buffer;
+    Atomic<bool> m_control_command_completed { false };
+
+    bool m_link_up { true };
+    bool m_has_tcp_checksum_offload { false };
+    bool m_has_tcp_segmentation_offload { false };
+};
+
+}
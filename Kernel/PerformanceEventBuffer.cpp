@@ -4,9 +4,9 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include <AK/JsonArraySerializer.h>
-#include <AK/JsonObjectSerializer.h>
+#include <AK/HashMap.h>
 #include <AK/ScopeGuard.h>
+#include <Kernel/API/Perfcore.h>
 #include <Kernel/Arch/x86/SmapDisabler.h>
 #include <Kernel/FileSystem/Custody.h>
 #include <Kernel/KBufferBuilder.h>
@@ -135,6 +135,9 @@ KResult PerformanceEventBuffer::append_with_ip_and_bp(ProcessID pid, ThreadID ti
         break;
     case PERF_EVENT_PAGE_FAULT:
         break;
+    case PERF_EVENT_PMC_SAMPLE:
+        event.data.pmc_sample.counter = arg1;
+        break;
     default:
         return EINVAL;
     }
@@ -157,100 +160,173 @@ PerformanceEvent& PerformanceEventBuffer::at(size_t index)
     return events[index];
 }
 
-template<typename Serializer>
-bool PerformanceEventBuffer::to_json_impl(Serializer& object) const
+namespace {
+
+// Stacks and strings are interned by what's in the events themselves, which don't move while we serialize them.
+struct InternedStack {
+    const FlatPtr* frames { nullptr };
+    size_t size { 0 };
+
+    bool operator==(const InternedStack& other) const
+    {
+        return size == other.size && !memcmp(frames, other.frames, size * sizeof(FlatPtr));
+    }
+};
+
+// Collects a record, so that it goes into the KBufferBuilder in one piece.
+class PerfcoreRecord {
+public:
+    explicit PerfcoreRecord(PerfcoreRecordType type) { m_data[m_size++] = (u8)type; }
+
+    void append(u64 value)
+    {
+        VERIFY(m_size + max_varint_size <= sizeof(m_data));
+        do {
+            u8 byte = value & 0x7f;
+            value >>= 7;
+            if (value)
+                byte |= 0x80;
+            m_data[m_size++] = byte;
+        } while (value);
+    }
+
+    void append_zigzag(i64 value) { append(((u64)value << 1) ^ (u64)(value >> 63)); }
+
+    void write_to(KBufferBuilder& builder) const { builder.append_bytes({ m_data, m_size }); }
+
+private:
+    static constexpr size_t max_varint_size = 10;
+
+    // Big enough for a stack with all of its frames.
+    u8 m_data[1 + max_varint_size * (1 + PerformanceEvent::max_stack_frame_count)];
+    size_t m_size { 0 };
+};
+
+}
+
+}
+
+template<>
+struct AK::Traits<Kernel::InternedStack> : public GenericTraits<Kernel::InternedStack> {
+    static unsigned hash(const Kernel::InternedStack& stack)
+    {
+        unsigned hash = 0;
+        for (size_t i = 0; i < stack.size; ++i)
+            hash = pair_int_hash(hash, ptr_hash(stack.frames[i]));
+        return hash;
+    }
+};
+
+namespace Kernel {
+
+bool PerformanceEventBuffer::to_perfcore(KBufferBuilder& builder) const
 {
-    auto array = object.add_array("events");
+    builder.append_bytes({ perfcore_magic, sizeof(perfcore_magic) });
+    builder.append((char)perfcore_version);
+
+    HashMap<InternedStack, u32> stack_ids;
+    HashMap<StringView, u32> string_ids;
+
+    auto intern_string = [&](const char* characters, size_t max_length) {
+        StringView string { characters, strnlen(characters, max_length) };
+        if (auto it = string_ids.find(string); it != string_ids.end())
+            return it->value;
+        u32 id = string_ids.size();
+        string_ids.set(string, id);
+        PerfcoreRecord record(PerfcoreRecordType::String);
+        record.append(string.length());
+        record.write_to(builder);
+        builder.append(string);
+        return id;
+    };
+
     bool seen_first_sample = false;
+    u64 last_timestamp = 0;
     for (size_t i = 0; i < m_count; ++i) {
         auto& event = at(i);
-        auto event_object = array.add_object();
+
+        InternedStack stack { event.stack, event.stack_size };
+        u32 stack_id;
+        if (auto it = stack_ids.find(stack); it != stack_ids.end()) {
+            stack_id = it->value;
+        } else {
+            stack_id = stack_ids.size();
+            stack_ids.set(stack, stack_id);
+            PerfcoreRecord record(PerfcoreRecordType::Stack);
+            record.append(event.stack_size);
+            for (size_t j = 0; j < event.stack_size; ++j)
+                record.append(event.stack[j]);
+            record.write_to(builder);
+        }
+
+        // The strings have to be there before the event that refers to them.
+        u32 string_id = 0;
+        if (event.type == PERF_EVENT_MMAP)
+            string_id = intern_string(event.data.mmap.name, sizeof(event.data.mmap.name));
+        else if (event.type == PERF_EVENT_PROCESS_CREATE)
+            string_id = intern_string(event.data.process_create.executable, sizeof(event.data.process_create.executable));
+        else if (event.type == PERF_EVENT_PROCESS_EXEC)
+            string_id = intern_string(event.data.process_exec.executable, sizeof(event.data.process_exec.executable));
+
+        PerfcoreRecord record(PerfcoreRecordType::Event);
+        record.append(event.type);
+        record.append(event.pid);
+        record.append(event.tid);
+        record.append_zigzag((i64)(event.timestamp - last_timestamp));
+        last_timestamp = event.timestamp;
+        record.append(seen_first_sample ? event.lost_samples : 0);
+        if (event.type == PERF_EVENT_SAMPLE)
+            seen_first_sample = true;
+        record.append(stack_id);
+
         switch (event.type) {
-        case PERF_EVENT_SAMPLE:
-            event_object.add("type", "sample");
-            break;
         case PERF_EVENT_MALLOC:
-            event_object.add("type", "malloc");
-            event_object.add("ptr", static_cast<u64>(event.data.malloc.ptr));
-            event_object.add("size", static_cast<u64>(event.data.malloc.size));
+            record.append(event.data.malloc.ptr);
+            record.append(event.data.malloc.size);
             break;
         case PERF_EVENT_FREE:
-            event_object.add("type", "free");
-            event_object.add("ptr", static_cast<u64>(event.data.free.ptr));
+            record.append(event.data.free.ptr);
             break;
         case PERF_EVENT_MMAP:
-            event_object.add("type", "mmap");
-            event_object.add("ptr", static_cast<u64>(event.data.mmap.ptr));
-            event_object.add("size", static_cast<u64>(event.data.mmap.size));
-            event_object.add("name", event.data.mmap.name);
+            record.append(event.data.mmap.ptr);
+            record.append(event.data.mmap.size);
+            record.append(string_id);
             break;
         case PERF_EVENT_MUNMAP:
-            event_object.add("type", "munmap");
-            event_object.add("ptr", static_cast<u64>(event.data.munmap.ptr));
-            event_object.add("size", static_cast<u64>(event.data.munmap.size));
+            record.append(event.data.munmap.ptr);
+            record.append(event.data.munmap.size);
             break;
         case PERF_EVENT_PROCESS_CREATE:
-            event_object.add("type", "process_create");
-            event_object.add("parent_pid", static_cast<u64>(event.data.process_create.parent_pid));
-            event_object.add("executable", event.data.process_create.executable);
+            record.append(event.data.process_create.parent_pid);
+            record.append(string_id);
             break;
         case PERF_EVENT_PROCESS_EXEC:
-            event_object.add("type", "process_exec");
-            event_object.add("executable", event.data.process_exec.executable);
-            break;
-        case PERF_EVENT_PROCESS_EXIT:
-            event_object.add("type", "process_exit");
+            record.append(string_id);
             break;
         case PERF_EVENT_THREAD_CREATE:
-            event_object.add("type", "thread_create");
-            event_object.add("parent_tid", static_cast<u64>(event.data.thread_create.parent_tid));
-            break;
-        case PERF_EVENT_THREAD_EXIT:
-            event_object.add("type", "thread_exit");
+            record.append(event.data.thread_create.parent_tid);
             break;
         case PERF_EVENT_CONTEXT_SWITCH:
-            event_object.add("type", "context_switch");
-            event_object.add("next_pid", static_cast<u64>(event.data.context_switch.next_pid));
-            event_object.add("next_tid", static_cast<u64>(event.data.context_switch.next_tid));
+            record.append(event.data.context_switch.next_pid);
+            record.append(event.data.context_switch.next_tid);
             break;
         case PERF_EVENT_KMALLOC:
-            event_object.add("type", "kmalloc");
-            event_object.add("ptr", static_cast<u64>(event.data.kmalloc.ptr));
-            event_object.add("size", static_cast<u64>(event.data.kmalloc.size));
+            record.append(event.data.kmalloc.ptr);
+            record.append(event.data.kmalloc.size);
             break;
         case PERF_EVENT_KFREE:
-            event_object.add("type", "kfree");
-            event_object.add("ptr", static_cast<u64>(event.data.kfree.ptr));
-            event_object.add("size", static_cast<u64>(event.data.kfree.size));
+            record.append(event.data.kfree.ptr);
+            record.append(event.data.kfree.size);
             break;
-        case PERF_EVENT_PAGE_FAULT:
-            event_object.add("type", "page_fault");
+        case PERF_EVENT_PMC_SAMPLE:
+            record.append(event.data.pmc_sample.counter);
             break;
         }
-        event_object.add("pid", event.pid);
-        event_object.add("tid", event.tid);
-        event_object.add("timestamp", event.timestamp);
-        event_object.add("lost_samples", seen_first_sample ? event.lost_samples : 0);
-        if (event.type == PERF_EVENT_SAMPLE)
-            seen_first_sample = true;
-        auto stack_array = event_object.add_array("stack");
-        for (size_t j = 0; j < event.stack_size; ++j) {
-            stack_array.add(event.stack[j]);
-        }
-        stack_array.finish();
-        event_object.finish();
+        record.write_to(builder);
     }
-    array.finish();
-    object.finish();
     return true;
 }
 
-bool PerformanceEventBuffer::to_json(KBufferBuilder& builder) const
-{
-    JsonObjectSerializer object(builder);
-    return to_json_impl(object);
-}
-
 OwnPtr<PerformanceEventBuffer> PerformanceEventBuffer::try_create_with_size(size_t buffer_size)
 {
     auto buffer = KBuffer::try_create_with_size(buffer_size, Region::Access::Read | Region::Access::Write, "Performance events", AllocationStrategy::AllocateNow);
@@ -62,6 +62,10 @@ struct [[gnu::packed]] KFreePerformanceEvent {
     FlatPtr ptr;
 };
 
+struct [[gnu::packed]] PMCSamplePerformanceEvent {
+    u32 counter;
+};
+
 struct [[gnu::packed]] PerformanceEvent {
     u16 type { 0 };
     u8 stack_size { 0 };
@@ -80,6 +84,7 @@ struct [[gnu::packed]] PerformanceEvent {
         ContextSwitchPerformanceEvent context_switch;
         KMallocPerformanceEvent kmalloc;
         KFreePerformanceEvent kfree;
+        PMCSamplePerformanceEvent pmc_sample;
     } data;
     static constexpr size_t max_stack_frame_count = 64;
     FlatPtr stack[max_stack_frame_count];
@@ -110,16 +115,14 @@ public:
         return const_cast<PerformanceEventBuffer&>(*this).at(index);
     }
 
-    bool to_json(KBufferBuilder&) const;
+    // Writes the events in the binary perfcore format, see Kernel/API/Perfcore.h.
+    bool to_perfcore(KBufferBuilder&) const;
 
     void add_process(const Process&, ProcessEventType event_type);
 
 private:
     explicit PerformanceEventBuffer(NonnullOwnPtr<KBuffer>);
 
-    template<typename Serializer>
-    bool to_json_impl(Serializer&) const;
-
     PerformanceEvent& at(size_t index);
 
     size_t m_count { 0 };
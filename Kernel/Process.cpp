@@ -560,18 +560,18 @@ bool Process::dump_perfcore()
 
     auto& description = *description_or_error.value();
     KBufferBuilder builder;
-    if (!m_perf_event_buffer->to_json(builder)) {
-        dbgln("Failed to generate perfcore for pid {}: Could not serialize performance events to JSON.", pid().value());
+    if (!m_perf_event_buffer->to_perfcore(builder)) {
+        dbgln("Failed to generate perfcore for pid {}: Could not serialize performance events.", pid().value());
         return false;
     }
 
-    auto json = builder.build();
-    if (!json) {
+    auto perfcore = builder.build();
+    if (!perfcore) {
         dbgln("Failed to generate perfcore for pid {}: Could not allocate buffer.", pid().value());
         return false;
     }
-    auto json_buffer = UserOrKernelBuffer::for_kernel_buffer(json->data());
-    if (description.write(json_buffer, json->size()).is_error()) {
+    auto perfcore_buffer = UserOrKernelBuffer::for_kernel_buffer(perfcore->data());
+    if (description.write(perfcore_buffer, perfcore->size()).is_error()) {
         return false;
         dbgln("Failed to generate perfcore for pid {}: Cound not write to perfcore file.", pid().value());
     }
@@ -874,6 +874,12 @@ void Process::set_dumpable(bool dumpable)
     m_dumpable = dumpable;
 }
 
+void Process::set_io_priority(IOPriority io_priority)
+{
+    ProtectedDataMutationScope scope { *this };
+    m_io_priority = io_priority;
+}
+
 void Process::set_coredump_metadata(const String& key, String value)
 {
     m_coredump_metadata.set(key, move(value));
@@ -35,6 +35,7 @@
 #include <Kernel/VM/Space.h>
 #include <LibC/elf.h>
 #include <LibC/signal_numbers.h>
+#include <LibC/sys/prctl_numbers.h>
 
 namespace Kernel {
 
@@ -74,6 +75,12 @@ enum class Pledge : u32 {
 #undef __ENUMERATE_PLEDGE_PROMISE
 };
 
+enum class IOPriority : u8 {
+    High = IO_PRIORITY_HIGH,
+    Normal = IO_PRIORITY_NORMAL,
+    Idle = IO_PRIORITY_IDLE,
+};
+
 enum class VeilState {
     None,
     Dropped,
@@ -102,6 +109,7 @@ protected:
     bool m_has_execpromises { false };
     u32 m_execpromises { 0 };
     mode_t m_umask { 022 };
+    IOPriority m_io_priority { IOPriority::Normal };
     VirtualAddress m_signal_trampoline;
     Atomic<u32> m_thread_count { 0 };
     IntrusiveList<Thread, RawPtr<Thread>, &Thread::m_process_thread_list_node> m_thread_list;
@@ -239,6 +247,9 @@ public:
 
     mode_t umask() const { return m_umask; }
 
+    IOPriority io_priority() const { return m_io_priority; }
+    void set_io_priority(IOPriority);
+
     bool in_group(gid_t) const;
 
     // Breakable iteration functions
@@ -328,12 +339,14 @@ public:
     KResultOr<FlatPtr> sys$select(Userspace<const Syscall::SC_select_params*>);
     KResultOr<FlatPtr> sys$poll(Userspace<const Syscall::SC_poll_params*>);
     KResultOr<FlatPtr> sys$get_dir_entries(int fd, Userspace<void*>, size_t);
+    KResultOr<FlatPtr> sys$get_dir_entries_with_stat(int fd, Userspace<void*>, size_t);
     KResultOr<FlatPtr> sys$getcwd(Userspace<char*>, size_t);
     KResultOr<FlatPtr> sys$chdir(Userspace<const char*>, size_t);
     KResultOr<FlatPtr> sys$fchdir(int fd);
     KResultOr<FlatPtr> sys$adjtime(Userspace<const timeval*>, Userspace<timeval*>);
     KResultOr<FlatPtr> sys$gettimeofday(Userspace<timeval*>);
     KResultOr<FlatPtr> sys$clock_gettime(clockid_t, Userspace<timespec*>);
+    KResultOr<FlatPtr> sys$map_time_page();
     KResultOr<FlatPtr> sys$clock_settime(clockid_t, Userspace<const timespec*>);
     KResultOr<FlatPtr> sys$clock_nanosleep(Userspace<const Syscall::SC_clock_nanosleep_params*>);
     KResultOr<FlatPtr> sys$gethostname(Userspace<char*>, size_t);
@@ -380,10 +393,13 @@ public:
     KResultOr<FlatPtr> sys$bind(int sockfd, Userspace<const sockaddr*> addr, socklen_t);
     KResultOr<FlatPtr> sys$listen(int sockfd, int backlog);
     KResultOr<FlatPtr> sys$accept4(Userspace<const Syscall::SC_accept4_params*>);
+    KResultOr<FlatPtr> sys$accept4_batch(Userspace<const Syscall::SC_accept4_batch_params*>);
     KResultOr<FlatPtr> sys$connect(int sockfd, Userspace<const sockaddr*>, socklen_t);
     KResultOr<FlatPtr> sys$shutdown(int sockfd, int how);
     KResultOr<FlatPtr> sys$sendmsg(int sockfd, Userspace<const struct msghdr*>, int flags);
     KResultOr<FlatPtr> sys$recvmsg(int sockfd, Userspace<struct msghdr*>, int flags);
+    KResultOr<FlatPtr> sys$sendmmsg(Userspace<const Syscall::SC_mmsg_params*>);
+    KResultOr<FlatPtr> sys$recvmmsg(Userspace<const Syscall::SC_mmsg_params*>);
     KResultOr<FlatPtr> sys$getsockopt(Userspace<const Syscall::SC_getsockopt_params*>);
     KResultOr<FlatPtr> sys$setsockopt(Userspace<const Syscall::SC_setsockopt_params*>);
     KResultOr<FlatPtr> sys$getsockname(Userspace<const Syscall::SC_getsockname_params*>);
@@ -391,6 +407,15 @@ public:
     KResultOr<FlatPtr> sys$socketpair(Userspace<const Syscall::SC_socketpair_params*>);
     KResultOr<FlatPtr> sys$sched_setparam(pid_t pid, Userspace<const struct sched_param*>);
     KResultOr<FlatPtr> sys$sched_getparam(pid_t pid, Userspace<struct sched_param*>);
+    KResultOr<FlatPtr> sys$sched_setattr(pid_t pid, Userspace<const struct sched_attr*>);
+    KResultOr<FlatPtr> sys$sched_getattr(pid_t pid, Userspace<struct sched_attr*>);
+    KResultOr<FlatPtr> sys$posix_spawn(Userspace<const Syscall::SC_posix_spawn_params*>);
+    KResultOr<FlatPtr> sys$posix_fadvise(Userspace<const Syscall::SC_posix_fadvise_params*>);
+    KResultOr<FlatPtr> sys$sendfile(Userspace<const Syscall::SC_sendfile_params*>);
+    KResultOr<FlatPtr> sys$splice(Userspace<const Syscall::SC_splice_params*>);
+    KResultOr<FlatPtr> sys$epoll_create(int flags);
+    KResultOr<FlatPtr> sys$epoll_ctl(Userspace<const Syscall::SC_epoll_ctl_params*>);
+    KResultOr<FlatPtr> sys$epoll_wait(Userspace<const Syscall::SC_epoll_wait_params*>);
     KResultOr<FlatPtr> sys$create_thread(void* (*)(void*), Userspace<const Syscall::SC_create_thread_params*>);
     [[noreturn]] void sys$exit_thread(Userspace<void*>, Userspace<void*>, size_t);
     KResultOr<FlatPtr> sys$join_thread(pid_t tid, Userspace<void**> exit_value);
@@ -529,6 +554,7 @@ private:
     Process(const String& name, uid_t uid, gid_t gid, ProcessID ppid, bool is_kernel_process, RefPtr<Custody> cwd, RefPtr<Custody> executable, TTY* tty);
     static RefPtr<Process> create(RefPtr<Thread>& first_thread, const String& name, uid_t, gid_t, ProcessID ppid, bool is_kernel_process, RefPtr<Custody> cwd = nullptr, RefPtr<Custody> executable = nullptr, TTY* = nullptr, Process* fork_parent = nullptr);
     KResult attach_resources(RefPtr<Thread>& first_thread, Process* fork_parent);
+    void inherit_state_from(Process& parent);
     static ProcessID allocate_pid();
 
     void kill_threads_except_self();
@@ -538,6 +564,9 @@ private:
     bool create_perf_events_buffer_if_needed();
     void delete_perf_events_buffer();
 
+    static bool copy_user_strings(Syscall::StringListArgument const&, Vector<String>& output);
+    KResult apply_posix_spawn_file_action(Syscall::SC_posix_spawn_file_action const&);
+    KResult apply_posix_spawn_attributes(Process& parent, Thread& first_thread, Syscall::SC_posix_spawn_params const&);
     KResult do_exec(NonnullRefPtr<FileDescription> main_program_description, Vector<String> arguments, Vector<String> environment, RefPtr<FileDescription> interpreter_description, Thread*& new_main_thread, u32& prev_flags, const ElfW(Ehdr) & main_program_header);
     KResultOr<FlatPtr> do_write(FileDescription&, const UserOrKernelBuffer&, size_t);
 
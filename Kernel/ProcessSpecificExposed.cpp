@@ -313,6 +313,42 @@ private:
     }
 };
 
+class ProcFSProcessSchedulingLatency final : public ProcFSProcessInformation {
+public:
+    static NonnullRefPtr<ProcFSProcessSchedulingLatency> create(const ProcFSProcessDirectory& parent_directory)
+    {
+        return adopt_ref(*new (nothrow) ProcFSProcessSchedulingLatency(parent_directory));
+    }
+
+private:
+    explicit ProcFSProcessSchedulingLatency(const ProcFSProcessDirectory& parent_directory)
+        : ProcFSProcessInformation("scheduling_latency"sv, parent_directory)
+    {
+    }
+    virtual bool output(KBufferBuilder& builder) override
+    {
+        auto parent_directory = m_parent_directory.strong_ref();
+        if (parent_directory.is_null())
+            return false;
+        auto process = parent_directory->associated_process();
+        if (process.is_null())
+            return false;
+        JsonArraySerializer array { builder };
+        process->for_each_thread([&](Thread& thread) {
+            auto thread_object = array.add_object();
+            thread_object.add("tid", thread.tid().value());
+            thread_object.add("name", thread.name());
+            thread_object.add("preemptions", thread.preemption_count());
+            auto histogram_array = thread_object.add_array("latency_histogram");
+            for (auto& bucket : thread.scheduling_latency_histogram().buckets)
+                histogram_array.add(bucket.load());
+            histogram_array.finish();
+        });
+        array.finish();
+        return true;
+    }
+};
+
 class ProcFSProcessPerformanceEvents final : public ProcFSProcessInformation {
 public:
     static NonnullRefPtr<ProcFSProcessPerformanceEvents> create(const ProcFSProcessDirectory& parent_directory)
@@ -338,7 +374,7 @@ private:
             dbgln("ProcFS: No perf events for {}", process->pid());
             return false;
         }
-        return process->perf_events()->to_json(builder);
+        return process->perf_events()->to_perfcore(builder);
     }
 };
 
@@ -563,6 +599,7 @@ void ProcFSProcessDirectory::on_attach()
     m_components.append(ProcFSProcessPledge::create(*this));
     m_components.append(ProcFSProcessUnveil::create(*this));
     m_components.append(ProcFSProcessPerformanceEvents::create(*this));
+    m_components.append(ProcFSProcessSchedulingLatency::create(*this));
     m_components.append(ProcFSProcessFileDescriptions::create(*this));
     m_components.append(ProcFSProcessOverallFileDescriptions::create(*this));
     m_components.append(ProcFSProcessRoot::create(*this));
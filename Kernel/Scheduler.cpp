@@ -8,19 +8,34 @@
 #include <AK/Time.h>
 #include <Kernel/Arch/x86/InterruptDisabler.h>
 #include <Kernel/Debug.h>
+#include <Kernel/FileSystem/SysFS.h>
+#include <Kernel/Interrupts/APIC.h>
 #include <Kernel/Panic.h>
 #include <Kernel/PerformanceManager.h>
 #include <Kernel/Process.h>
 #include <Kernel/RTC.h>
 #include <Kernel/Scheduler.h>
 #include <Kernel/Sections.h>
+#include <Kernel/Time/APICTimer.h>
 #include <Kernel/Time/TimeManagement.h>
+#include <Kernel/TimerQueue.h>
+#include <Kernel/Tracepoints.h>
 
 // Remove this once SMP is stable and can be enabled by default
 #define SCHEDULE_ON_ALL_PROCESSORS 0
 
 namespace Kernel {
 
+struct ThreadReadyQueue {
+    IntrusiveList<Thread, RawPtr<Thread>, &Thread::m_ready_queue_node> thread_list;
+};
+
+static constexpr u32 g_ready_queue_buckets = sizeof(u32) * 8;
+
+// Threads of the deadline scheduling class don't go into a priority bucket,
+// Thread::m_runnable_priority is set to this while they're queued.
+static constexpr int g_deadline_ready_queue = g_ready_queue_buckets;
+
 class SchedulerData {
     AK_MAKE_NONCOPYABLE(SchedulerData);
     AK_MAKE_NONMOVABLE(SchedulerData);
@@ -31,6 +46,17 @@ public:
     SchedulerData() = default;
 
     bool m_in_scheduler { true };
+
+    // Every processor has its own set of priority-bucketed ready queues, so
+    // queueing and pulling threads doesn't serialize all processors on one lock.
+    SpinLock<u8> m_ready_queues_lock;
+    u32 m_ready_queues_mask { 0 };
+    Atomic<u32, AK::MemoryOrder::memory_order_relaxed> m_ready_thread_count { 0 };
+    Array<ThreadReadyQueue, g_ready_queue_buckets> m_ready_queues;
+    ThreadReadyQueue m_deadline_ready_queue;
+
+    // Set while this processor's periodic timer tick is stopped, see stop_tick().
+    Atomic<bool> m_tick_stopped { false };
 };
 
 RecursiveSpinLock g_scheduler_lock;
@@ -48,13 +74,29 @@ READONLY_AFTER_INIT WaitQueue* g_finalizer_wait_queue;
 Atomic<bool> g_finalizer_has_work { false };
 READONLY_AFTER_INIT static Process* s_colonel_process;
 
-struct ThreadReadyQueue {
-    IntrusiveList<Thread, RawPtr<Thread>, &Thread::m_ready_queue_node> thread_list;
-};
-static SpinLock<u8> g_ready_queues_lock;
-static u32 g_ready_queues_mask;
-static constexpr u32 g_ready_queue_buckets = sizeof(g_ready_queues_mask) * 8;
-READONLY_AFTER_INIT static ThreadReadyQueue* g_ready_queues; // g_ready_queue_buckets entries
+// How many more threads may be waiting on the processor a thread last ran on,
+// compared to the processor waking it up, before we give up on its warm caches
+// and queue it elsewhere. Tunable via /sys/scheduler/migration_cost.
+static Atomic<u32, AK::MemoryOrder::memory_order_relaxed> s_migration_cost { 2 };
+
+// Allow processors to stop their periodic timer tick while they are idle, or
+// while they are running a single thread. Tunable via /sys/scheduler/tickless.
+static Atomic<u32, AK::MemoryOrder::memory_order_relaxed> s_tickless_enabled { 1 };
+
+// Upper bound for how long a processor may go without a timer tick. This keeps
+// us well clear of the HPET main counter wrapping around between two ticks.
+static constexpr Time s_max_tickless_duration = Time::from_seconds(1);
+
+// Sum of the CPU bandwidth reserved by all deadline threads, in parts per million.
+// We only admit new deadline threads as long as this stays below the limit,
+// so that every one of them can meet its deadlines and other threads still
+// get some time to run. This is a single processor's worth of bandwidth, as
+// we don't partition deadline threads across processors.
+static constexpr u64 s_deadline_bandwidth_limit = 950'000;
+static u64 s_deadline_bandwidth_reserved { 0 };
+static SpinLock<u8> s_deadline_bandwidth_lock;
+
+static SchedulingLatencyHistogram s_scheduling_latency_histogram;
 
 static TotalTimeScheduled g_total_time_scheduled;
 static SpinLock<u8> g_total_time_scheduled_lock;
@@ -68,7 +110,7 @@ static void dump_thread_list(bool = false);
 static inline u32 thread_priority_to_priority_index(u32 thread_priority)
 {
     // Converts the priority in the range of THREAD_PRIORITY_MIN...THREAD_PRIORITY_MAX
-    // to a index into g_ready_queues where 0 is the highest priority bucket
+    // to a index into SchedulerData::m_ready_queues where 0 is the highest priority bucket
     VERIFY(thread_priority >= THREAD_PRIORITY_MIN && thread_priority <= THREAD_PRIORITY_MAX);
     constexpr u32 thread_priority_count = THREAD_PRIORITY_MAX - THREAD_PRIORITY_MIN + 1;
     static_assert(thread_priority_count > 0);
@@ -77,16 +119,174 @@ static inline u32 thread_priority_to_priority_index(u32 thread_priority)
     return priority_bucket;
 }
 
-Thread& Scheduler::pull_next_runnable_thread()
+static SchedulerData* scheduler_data_for_processor(u32 cpu)
 {
-    auto affinity_mask = 1u << Processor::id();
+    SchedulerData* scheduler_data = nullptr;
+    Processor::for_each(
+        [&](Processor& processor) {
+            if (processor.get_id() == cpu)
+                scheduler_data = processor.get_specific<SchedulerData>();
+        });
+    return scheduler_data;
+}
+
+static u64 deadline_bandwidth_for(u64 runtime_ns, u64 relative_deadline_ns)
+{
+    if (relative_deadline_ns == 0)
+        return 0;
+    return runtime_ns * 1'000'000 / relative_deadline_ns;
+}
 
-    ScopedSpinLock lock(g_ready_queues_lock);
-    auto priority_mask = g_ready_queues_mask;
+static void start_deadline_period(Thread& thread, Time const& now)
+{
+    auto& state = thread.deadline_state();
+    state.remaining_runtime_ns = (i64)state.runtime_ns;
+    state.absolute_deadline = now + Time::from_nanoseconds((i64)state.relative_deadline_ns);
+    state.next_replenishment = now + Time::from_nanoseconds((i64)state.period_ns);
+}
+
+static bool has_deadline_budget(Thread& thread, Time const& now)
+{
+    auto& state = thread.deadline_state();
+    if (state.remaining_runtime_ns > 0)
+        return true;
+    // The thread used up its runtime, it has to wait for its next period
+    if (now < state.next_replenishment)
+        return false;
+    start_deadline_period(thread, now);
+    return true;
+}
+
+static void charge_deadline_runtime(Thread& thread, Time const& now)
+{
+    auto& state = thread.deadline_state();
+    if (now > state.last_charged)
+        state.remaining_runtime_ns -= (now - state.last_charged).to_nanoseconds();
+    state.last_charged = now;
+}
+
+static Thread* earliest_deadline_thread(SchedulerData& scheduler_data, u32 affinity_mask, Time const& now)
+{
+    VERIFY(scheduler_data.m_ready_queues_lock.is_locked());
+    Thread* earliest = nullptr;
+    for (auto& thread : scheduler_data.m_deadline_ready_queue.thread_list) {
+        if (thread.is_active())
+            continue;
+        if (!(thread.affinity() & affinity_mask))
+            continue;
+        if (!has_deadline_budget(thread, now))
+            continue;
+        if (!earliest || thread.deadline_state().absolute_deadline < earliest->deadline_state().absolute_deadline)
+            earliest = &thread;
+    }
+    return earliest;
+}
+
+static Optional<Time> time_until_next_deadline_replenishment(SchedulerData& scheduler_data)
+{
+    auto now = TimeManagement::the().monotonic_time();
+    Optional<Time> next_replenishment;
+    ScopedSpinLock lock(scheduler_data.m_ready_queues_lock);
+    for (auto& thread : scheduler_data.m_deadline_ready_queue.thread_list) {
+        auto& state = thread.deadline_state();
+        if (state.remaining_runtime_ns > 0 || state.next_replenishment <= now)
+            return Time::zero();
+        if (!next_replenishment.has_value() || state.next_replenishment < next_replenishment.value())
+            next_replenishment = state.next_replenishment;
+    }
+    if (!next_replenishment.has_value())
+        return {};
+    return next_replenishment.value() - now;
+}
+
+static APICTimer* tickless_timer()
+{
+    if (!s_tickless_enabled.load() || !APIC::initialized())
+        return nullptr;
+    // We can only stop the tick if it's driven by the processor-local APIC timer
+    auto* apic_timer = APIC::the().get_timer();
+    if (!apic_timer || !TimeManagement::the().is_system_timer(*apic_timer))
+        return nullptr;
+    return apic_timer;
+}
+
+static bool stop_tick(SchedulerData& scheduler_data)
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    auto* apic_timer = tickless_timer();
+    if (!apic_timer || scheduler_data.m_tick_stopped)
+        return false;
+
+    // Instead of ticking periodically, only interrupt us once the next timer is due
+    auto duration = TimerQueue::the().time_until_next_timer_due().value_or(s_max_tickless_duration);
+    if (duration > s_max_tickless_duration)
+        duration = s_max_tickless_duration;
+    // Throttled deadline threads need a tick to notice their budget is replenished
+    if (auto replenishment = time_until_next_deadline_replenishment(scheduler_data); replenishment.has_value() && replenishment.value() < duration)
+        duration = replenishment.value();
+    auto tick_duration = Time::from_nanoseconds(1'000'000'000 / (i64)apic_timer->ticks_per_second());
+    if (duration <= tick_duration)
+        return false;
+
+    scheduler_data.m_tick_stopped = true;
+    if (Processor::is_bootstrap_processor()) {
+        // The bootstrap processor keeps the time, other processors rely on its
+        // tick to advance the coarse clocks. So only stop it if every other
+        // processor is idle, they wake us up again when they leave idle.
+        u32 all_processors_mask = (1u << Processor::count()) - 1;
+        if ((Processor::idle_cpu_mask() | 1u) != all_processors_mask) {
+            scheduler_data.m_tick_stopped = false;
+            return false;
+        }
+    }
+    apic_timer->enable_local_timer_once(duration);
+    return true;
+}
+
+static void restart_tick(SchedulerData& scheduler_data)
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    if (!scheduler_data.m_tick_stopped.exchange(false))
+        return;
+    APIC::the().get_timer()->enable_local_timer();
+}
+
+static void restart_tick_on_processor(u32 cpu, SchedulerData& scheduler_data)
+{
+    if (!scheduler_data.m_tick_stopped)
+        return;
+    if (cpu == Processor::id()) {
+        restart_tick(scheduler_data);
+        return;
+    }
+    Processor::smp_unicast(
+        cpu, [] {
+            restart_tick(ProcessorSpecific<SchedulerData>::get());
+        },
+        true);
+}
+
+Thread* Scheduler::pull_runnable_thread_from(SchedulerData& scheduler_data, u32 affinity_mask)
+{
+    ScopedSpinLock lock(scheduler_data.m_ready_queues_lock);
+
+    // Deadline threads with budget left always go first, earliest deadline first
+    if (!scheduler_data.m_deadline_ready_queue.thread_list.is_empty()) {
+        if (auto* thread = earliest_deadline_thread(scheduler_data, affinity_mask, TimeManagement::the().monotonic_time())) {
+            VERIFY(thread->m_runnable_priority == g_deadline_ready_queue);
+            thread->m_runnable_priority = -1;
+            scheduler_data.m_deadline_ready_queue.thread_list.remove(*thread);
+            scheduler_data.m_ready_thread_count--;
+            thread->set_active(true);
+            return thread;
+        }
+    }
+
+    auto priority_mask = scheduler_data.m_ready_queues_mask;
     while (priority_mask != 0) {
         auto priority = __builtin_ffsl(priority_mask);
         VERIFY(priority > 0);
-        auto& ready_queue = g_ready_queues[--priority];
+        auto& ready_queue = scheduler_data.m_ready_queues[--priority];
         for (auto& thread : ready_queue.thread_list) {
             VERIFY(thread.m_runnable_priority == (int)priority);
             if (thread.is_active())
@@ -96,7 +296,8 @@ Thread& Scheduler::pull_next_runnable_thread()
             thread.m_runnable_priority = -1;
             ready_queue.thread_list.remove(thread);
             if (ready_queue.thread_list.is_empty())
-                g_ready_queues_mask &= ~(1u << priority);
+                scheduler_data.m_ready_queues_mask &= ~(1u << priority);
+            scheduler_data.m_ready_thread_count--;
             // Mark it as active because we are using this thread. This is similar
             // to comparing it with Processor::current_thread, but when there are
             // multiple processors there's no easy way to check whether the thread
@@ -108,10 +309,50 @@ Thread& Scheduler::pull_next_runnable_thread()
             // switching to it.
             // FIXME: Figure out a better way maybe?
             thread.set_active(true);
-            return thread;
+            return &thread;
         }
         priority_mask &= ~(1u << priority);
     }
+    return nullptr;
+}
+
+Thread* Scheduler::steal_runnable_thread(u32 affinity_mask)
+{
+    // Our own ready queues are empty, so take a thread from whichever
+    // processor currently has the most threads waiting to run.
+    auto current_cpu = Processor::id();
+    SchedulerData* busiest_scheduler_data = nullptr;
+    u32 busiest_ready_thread_count = 0;
+    Processor::for_each(
+        [&](Processor& processor) {
+            if (processor.get_id() == current_cpu)
+                return;
+            auto* scheduler_data = processor.get_specific<SchedulerData>();
+            if (!scheduler_data)
+                return;
+            auto ready_thread_count = scheduler_data->m_ready_thread_count.load();
+            if (ready_thread_count > busiest_ready_thread_count) {
+                busiest_scheduler_data = scheduler_data;
+                busiest_ready_thread_count = ready_thread_count;
+            }
+        });
+    if (!busiest_scheduler_data)
+        return nullptr;
+
+    auto* thread = pull_runnable_thread_from(*busiest_scheduler_data, affinity_mask);
+    if (thread)
+        dbgln_if(SCHEDULER_DEBUG, "Scheduler[{}]: Stole {} from a busier processor", current_cpu, *thread);
+    return thread;
+}
+
+Thread& Scheduler::pull_next_runnable_thread()
+{
+    auto affinity_mask = 1u << Processor::id();
+
+    if (auto* thread = pull_runnable_thread_from(ProcessorSpecific<SchedulerData>::get(), affinity_mask))
+        return *thread;
+    if (auto* thread = steal_runnable_thread(affinity_mask))
+        return *thread;
     return *Processor::idle_thread();
 }
 
@@ -119,12 +360,18 @@ Thread* Scheduler::peek_next_runnable_thread()
 {
     auto affinity_mask = 1u << Processor::id();
 
-    ScopedSpinLock lock(g_ready_queues_lock);
-    auto priority_mask = g_ready_queues_mask;
+    auto& scheduler_data = ProcessorSpecific<SchedulerData>::get();
+    ScopedSpinLock lock(scheduler_data.m_ready_queues_lock);
+    if (!scheduler_data.m_deadline_ready_queue.thread_list.is_empty()) {
+        if (auto* thread = earliest_deadline_thread(scheduler_data, affinity_mask, TimeManagement::the().monotonic_time()))
+            return thread;
+    }
+
+    auto priority_mask = scheduler_data.m_ready_queues_mask;
     while (priority_mask != 0) {
         auto priority = __builtin_ffsl(priority_mask);
         VERIFY(priority > 0);
-        auto& ready_queue = g_ready_queues[--priority];
+        auto& ready_queue = scheduler_data.m_ready_queues[--priority];
         for (auto& thread : ready_queue.thread_list) {
             VERIFY(thread.m_runnable_priority == (int)priority);
             if (thread.is_active())
@@ -144,9 +391,17 @@ Thread* Scheduler::peek_next_runnable_thread()
 
 bool Scheduler::dequeue_runnable_thread(Thread& thread, bool check_affinity)
 {
+    VERIFY(g_scheduler_lock.own_lock());
     if (thread.is_idle_thread())
         return true;
-    ScopedSpinLock lock(g_ready_queues_lock);
+    if (thread.m_runnable_priority < 0) {
+        VERIFY(!thread.m_ready_queue_node.is_in_list());
+        return false;
+    }
+
+    auto* scheduler_data = scheduler_data_for_processor(thread.m_runnable_cpu);
+    VERIFY(scheduler_data);
+    ScopedSpinLock lock(scheduler_data->m_ready_queues_lock);
     auto priority = thread.m_runnable_priority;
     if (priority < 0) {
         VERIFY(!thread.m_ready_queue_node.is_in_list());
@@ -156,31 +411,107 @@ bool Scheduler::dequeue_runnable_thread(Thread& thread, bool check_affinity)
     if (check_affinity && !(thread.affinity() & (1 << Processor::id())))
         return false;
 
-    VERIFY(g_ready_queues_mask & (1u << priority));
-    auto& ready_queue = g_ready_queues[priority];
+    if (priority == g_deadline_ready_queue) {
+        thread.m_runnable_priority = -1;
+        scheduler_data->m_deadline_ready_queue.thread_list.remove(thread);
+        scheduler_data->m_ready_thread_count--;
+        return true;
+    }
+
+    VERIFY(scheduler_data->m_ready_queues_mask & (1u << priority));
+    auto& ready_queue = scheduler_data->m_ready_queues[priority];
     thread.m_runnable_priority = -1;
     ready_queue.thread_list.remove(thread);
     if (ready_queue.thread_list.is_empty())
-        g_ready_queues_mask &= ~(1u << priority);
+        scheduler_data->m_ready_queues_mask &= ~(1u << priority);
+    scheduler_data->m_ready_thread_count--;
     return true;
 }
 
+static u32 processor_for_runnable_thread(Thread const& thread)
+{
+#if SCHEDULE_ON_ALL_PROCESSORS
+    auto current_cpu = Processor::id();
+    auto affinity = thread.affinity();
+
+    // Prefer the processor the thread last ran on, its caches are most
+    // likely still warm. Only move it somewhere else if that processor
+    // has more than s_migration_cost extra threads waiting compared to us.
+    auto last_cpu = thread.cpu();
+    if (last_cpu != current_cpu && (affinity & (1u << last_cpu))) {
+        if (auto* last_scheduler_data = scheduler_data_for_processor(last_cpu)) {
+            auto last_load = last_scheduler_data->m_ready_thread_count.load();
+            auto current_load = ProcessorSpecific<SchedulerData>::get().m_ready_thread_count.load();
+            if (!(affinity & (1u << current_cpu)) || last_load <= current_load + s_migration_cost.load())
+                return last_cpu;
+            dbgln_if(SCHEDULER_DEBUG, "Scheduler[{}]: Migrating {} away from overloaded processor {}", current_cpu, thread, last_cpu);
+        }
+    }
+
+    if (affinity & (1u << current_cpu))
+        return current_cpu;
+    while (affinity != 0) {
+        auto cpu = (u32)__builtin_ffsl(affinity) - 1;
+        if (scheduler_data_for_processor(cpu))
+            return cpu;
+        affinity &= ~(1u << cpu);
+    }
+    // None of the processors this thread may run on have started yet. Keep it
+    // on our queues, it will be stolen once its processor enters the scheduler.
+    return current_cpu;
+#else
+    // Only the bootstrap processor schedules threads.
+    (void)thread;
+    return 0;
+#endif
+}
+
 void Scheduler::queue_runnable_thread(Thread& thread)
 {
-    VERIFY(g_scheduler_lock.own_lock());
+    // Threads woken up from Blocked are queued holding only their own lock,
+    // see Thread::wake_from_blocked(). The ready queues have their own locks.
+    VERIFY(g_scheduler_lock.own_lock() || thread.get_lock().own_lock());
     if (thread.is_idle_thread())
         return;
-    auto priority = thread_priority_to_priority_index(thread.priority());
+    auto cpu = processor_for_runnable_thread(thread);
+    auto* scheduler_data = scheduler_data_for_processor(cpu);
+    VERIFY(scheduler_data);
+    thread.m_runnable_since = current_time();
+
+    if (thread.is_deadline_thread()) {
+        // A thread that missed its deadline (e.g. because it was blocked for
+        // a while) starts over with a new budget and a later deadline, so it
+        // can't starve everyone else by claiming an ancient deadline.
+        auto now = TimeManagement::the().monotonic_time();
+        auto& state = thread.deadline_state();
+        if (now >= state.absolute_deadline && (state.remaining_runtime_ns > 0 || now >= state.next_replenishment))
+            start_deadline_period(thread, now);
+
+        ScopedSpinLock lock(scheduler_data->m_ready_queues_lock);
+        VERIFY(thread.m_runnable_priority < 0);
+        thread.m_runnable_priority = g_deadline_ready_queue;
+        thread.m_runnable_cpu = cpu;
+        VERIFY(!thread.m_ready_queue_node.is_in_list());
+        scheduler_data->m_deadline_ready_queue.thread_list.append(thread);
+        scheduler_data->m_ready_thread_count++;
+    } else {
+        auto priority = thread_priority_to_priority_index(thread.priority());
+        ScopedSpinLock lock(scheduler_data->m_ready_queues_lock);
+        VERIFY(thread.m_runnable_priority < 0);
+        thread.m_runnable_priority = (int)priority;
+        thread.m_runnable_cpu = cpu;
+        VERIFY(!thread.m_ready_queue_node.is_in_list());
+        auto& ready_queue = scheduler_data->m_ready_queues[priority];
+        bool was_empty = ready_queue.thread_list.is_empty();
+        ready_queue.thread_list.append(thread);
+        if (was_empty)
+            scheduler_data->m_ready_queues_mask |= (1u << priority);
+        scheduler_data->m_ready_thread_count++;
+    }
 
-    ScopedSpinLock lock(g_ready_queues_lock);
-    VERIFY(thread.m_runnable_priority < 0);
-    thread.m_runnable_priority = (int)priority;
-    VERIFY(!thread.m_ready_queue_node.is_in_list());
-    auto& ready_queue = g_ready_queues[priority];
-    bool was_empty = ready_queue.thread_list.is_empty();
-    ready_queue.thread_list.append(thread);
-    if (was_empty)
-        g_ready_queues_mask |= (1u << priority);
+    // The processor may have stopped its tick because it had nothing else
+    // to run, make sure it gets a chance to preempt its current thread.
+    restart_tick_on_processor(cpu, *scheduler_data);
 }
 
 UNMAP_AFTER_INIT void Scheduler::start()
@@ -192,7 +523,6 @@ UNMAP_AFTER_INIT void Scheduler::start()
     g_scheduler_lock.lock();
 
     auto& processor = Processor::current();
-    ProcessorSpecific<SchedulerData>::initialize();
     VERIFY(processor.is_initialized());
     auto& idle_thread = *Processor::idle_thread();
     VERIFY(processor.current_thread() == &idle_thread);
@@ -282,11 +612,27 @@ bool Scheduler::context_switch(Thread* thread)
     if (from_thread == thread)
         return false;
 
+    if (from_thread && from_thread->is_deadline_thread())
+        charge_deadline_runtime(*from_thread, TimeManagement::the().monotonic_time());
+    if (thread->is_deadline_thread())
+        thread->deadline_state().last_charged = TimeManagement::the().monotonic_time();
+
+    // Account for how long the thread had to wait for us
+    if (!thread->is_idle_thread() && thread->m_runnable_since != 0) {
+        auto now = current_time();
+        auto latency = now >= thread->m_runnable_since ? now - thread->m_runnable_since : 0;
+        thread->m_scheduling_latency_histogram.record(latency);
+        s_scheduling_latency_histogram.record(latency);
+        thread->m_runnable_since = 0;
+    }
+
     if (from_thread) {
         // If the last process hasn't blocked (still marked as running),
         // mark it as runnable for the next round.
-        if (from_thread->state() == Thread::Running)
+        if (from_thread->state() == Thread::Running) {
+            from_thread->m_preemption_count++;
             from_thread->set_state(Thread::Runnable);
+        }
 
 #ifdef LOG_EVERY_CONTEXT_SWITCH
         const auto msg = "Scheduler[{}]: {} -> {} [prio={}] {:#04x}:{:p}";
@@ -305,6 +651,8 @@ bool Scheduler::context_switch(Thread* thread)
     thread->set_state(Thread::Running);
 
     PerformanceManager::add_context_switch_perf_event(*from_thread, *thread);
+    PerformanceCounters::switch_threads(*from_thread, *thread);
+    TRACEPOINT(ContextSwitch, thread->tid().value(), thread->pid().value());
 
     proc.switch_context(from_thread, thread);
 
@@ -415,9 +763,12 @@ UNMAP_AFTER_INIT void Scheduler::initialize()
         current_time = current_time_monotonic;
     }
 
+    // The bootstrap processor's ready queues need to exist before we
+    // create the first threads below
+    ProcessorSpecific<SchedulerData>::initialize();
+
     RefPtr<Thread> idle_thread;
     g_finalizer_wait_queue = new WaitQueue;
-    g_ready_queues = new ThreadReadyQueue[g_ready_queue_buckets];
 
     g_finalizer_has_work.store(false, AK::MemoryOrder::memory_order_release);
     s_colonel_process = Process::create_kernel_process(idle_thread, "colonel", idle_loop, nullptr, 1, Process::RegisterProcess::No).leak_ref();
@@ -431,6 +782,8 @@ UNMAP_AFTER_INIT void Scheduler::initialize()
 
 UNMAP_AFTER_INIT void Scheduler::set_idle_thread(Thread* idle_thread)
 {
+    if (!Processor::current().get_specific<SchedulerData>())
+        ProcessorSpecific<SchedulerData>::initialize();
     idle_thread->set_idle_thread();
     Processor::current().set_idle_thread(*idle_thread);
     Processor::set_current_thread(*idle_thread);
@@ -456,6 +809,60 @@ void Scheduler::add_time_scheduled(u64 time_to_add, bool is_kernel)
         g_total_time_scheduled.total_kernel += time_to_add;
 }
 
+KResult Scheduler::set_deadline_parameters(Thread& thread, u64 runtime_ns, u64 relative_deadline_ns, u64 period_ns)
+{
+    VERIFY(g_scheduler_lock.own_lock());
+    if (thread.is_idle_thread())
+        return EINVAL;
+    if (runtime_ns == 0 || runtime_ns > relative_deadline_ns || relative_deadline_ns > period_ns)
+        return EINVAL;
+    // Keep the arithmetic below from overflowing
+    if (period_ns > (u64)Time::from_seconds(60).to_nanoseconds())
+        return EINVAL;
+
+    auto& state = thread.deadline_state();
+    auto old_bandwidth = deadline_bandwidth_for(state.runtime_ns, state.relative_deadline_ns);
+    auto new_bandwidth = deadline_bandwidth_for(runtime_ns, relative_deadline_ns);
+    {
+        ScopedSpinLock lock(s_deadline_bandwidth_lock);
+        auto reserved = s_deadline_bandwidth_reserved - old_bandwidth + new_bandwidth;
+        if (reserved > s_deadline_bandwidth_limit)
+            return EBUSY;
+        s_deadline_bandwidth_reserved = reserved;
+    }
+
+    // Move the thread into the deadline queue if it's currently waiting to run.
+    // Hold its lock so that it can't be woken up and queued concurrently.
+    ScopedSpinLock thread_lock(thread.get_lock());
+    bool was_queued = dequeue_runnable_thread(thread);
+    state.runtime_ns = runtime_ns;
+    state.relative_deadline_ns = relative_deadline_ns;
+    state.period_ns = period_ns;
+    start_deadline_period(thread, TimeManagement::the().monotonic_time());
+    if (was_queued)
+        queue_runnable_thread(thread);
+    return KSuccess;
+}
+
+void Scheduler::clear_deadline_parameters(Thread& thread)
+{
+    VERIFY(g_scheduler_lock.own_lock());
+    if (!thread.is_deadline_thread())
+        return;
+
+    auto& state = thread.deadline_state();
+    {
+        ScopedSpinLock lock(s_deadline_bandwidth_lock);
+        s_deadline_bandwidth_reserved -= deadline_bandwidth_for(state.runtime_ns, state.relative_deadline_ns);
+    }
+
+    ScopedSpinLock thread_lock(thread.get_lock());
+    bool was_queued = dequeue_runnable_thread(thread);
+    state = {};
+    if (was_queued)
+        queue_runnable_thread(thread);
+}
+
 void Scheduler::timer_tick(const RegisterState& regs)
 {
     VERIFY_INTERRUPTS_DISABLED();
@@ -469,6 +876,11 @@ void Scheduler::timer_tick(const RegisterState& regs)
     VERIFY(current_thread->current_trap());
     VERIFY(current_thread->current_trap()->regs == &regs);
 
+    // If we stopped the periodic tick, this is the one-shot interrupt we asked
+    // for. Go back to ticking, we'll stop it again below if we're still alone.
+    auto& scheduler_data = ProcessorSpecific<SchedulerData>::get();
+    restart_tick(scheduler_data);
+
 #if !SCHEDULE_ON_ALL_PROCESSORS
     if (!Processor::is_bootstrap_processor())
         return; // TODO: This prevents scheduling on other CPUs!
@@ -489,6 +901,29 @@ void Scheduler::timer_tick(const RegisterState& regs)
         return;
     }
 
+    if (current_thread->is_deadline_thread()) {
+        charge_deadline_runtime(*current_thread, TimeManagement::the().monotonic_time());
+        if (current_thread->deadline_state().remaining_runtime_ns <= 0) {
+            // Out of budget, it's throttled until its next period starts
+            dbgln_if(SCHEDULER_DEBUG, "Scheduler[{}]: Deadline thread {} used up its runtime", Processor::id(), *current_thread);
+            Processor::current().invoke_scheduler_async();
+            return;
+        }
+    }
+
+    if (auto* next_thread = peek_next_runnable_thread(); next_thread && next_thread->is_deadline_thread()) {
+        // Deadline threads don't wait for the current time slice to run out
+        if (!current_thread->is_deadline_thread() || next_thread->deadline_state().absolute_deadline < current_thread->deadline_state().absolute_deadline) {
+            Processor::current().invoke_scheduler_async();
+            return;
+        }
+    }
+
+    // Deadline threads run until they block, use up their runtime or get
+    // preempted by a thread with an earlier deadline, there are no time slices.
+    if (current_thread->is_deadline_thread())
+        return;
+
     if (current_thread->tick())
         return;
 
@@ -499,6 +934,11 @@ void Scheduler::timer_tick(const RegisterState& regs)
         current_thread->set_ticks_left(time_slice_for(*current_thread));
         current_thread->did_schedule();
         dbgln_if(SCHEDULER_DEBUG, "Scheduler[{}]: No other threads ready, give {} another timeslice", Processor::id(), *current_thread);
+        // There's no point in ticking until another thread becomes runnable here,
+        // or until the next timer is due. The bootstrap processor keeps ticking
+        // while it's busy, as it keeps the time for everyone else.
+        if (!Processor::is_bootstrap_processor())
+            stop_tick(scheduler_data);
         return;
     }
 
@@ -534,10 +974,26 @@ void Scheduler::idle_loop(void*)
 
     for (;;) {
         proc.idle_begin();
-        asm("hlt");
+        auto& scheduler_data = ProcessorSpecific<SchedulerData>::get();
+        cli();
+        stop_tick(scheduler_data);
+        // NOTE: sti only takes effect after the next instruction, so there is
+        //       no window for an interrupt to sneak in before we halt.
+        asm volatile("sti\n"
+                     "hlt");
 
         proc.idle_end();
         VERIFY_INTERRUPTS_ENABLED();
+        cli();
+        restart_tick(scheduler_data);
+        sti();
+        if (!Processor::is_bootstrap_processor()) {
+            // The bootstrap processor may have stopped its tick because
+            // everyone else was idle, wake it up so that it keeps the time.
+            AK::atomic_thread_fence(AK::MemoryOrder::memory_order_seq_cst);
+            if (auto* bsp_scheduler_data = scheduler_data_for_processor(0))
+                restart_tick_on_processor(0, *bsp_scheduler_data);
+        }
 #if SCHEDULE_ON_ALL_PROCESSORS
         yield();
 #else
@@ -558,12 +1014,106 @@ bool Scheduler::is_initialized()
     return Processor::idle_thread() != nullptr;
 }
 
+u32 Scheduler::schedulable_processors_mask()
+{
+#if SCHEDULE_ON_ALL_PROCESSORS
+    return (1u << Processor::count()) - 1;
+#else
+    return 1;
+#endif
+}
+
+SchedulingLatencyHistogram const& Scheduler::scheduling_latency_histogram()
+{
+    return s_scheduling_latency_histogram;
+}
+
 TotalTimeScheduled Scheduler::get_total_time_scheduled()
 {
     ScopedSpinLock lock(g_total_time_scheduled_lock);
     return g_total_time_scheduled;
 }
 
+class SchedulerTunableSysFSComponent final : public SysFSComponent {
+public:
+    using Value = Atomic<u32, AK::MemoryOrder::memory_order_relaxed>;
+    static NonnullRefPtr<SchedulerTunableSysFSComponent> must_create(StringView name, Value&, u32 max_value);
+
+    virtual KResultOr<size_t> read_bytes(off_t, size_t, UserOrKernelBuffer&, FileDescription*) const override;
+    virtual KResultOr<size_t> write_bytes(off_t, size_t, UserOrKernelBuffer const&, FileDescription*) override;
+    virtual mode_t permissions() const override { return S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH; }
+
+private:
+    SchedulerTunableSysFSComponent(StringView name, Value&, u32 max_value);
+
+    Value& m_value;
+    u32 m_max_value { 0 };
+};
+
+class SchedulerSysFSDirectory final : public SysFSDirectory {
+public:
+    static NonnullRefPtr<SchedulerSysFSDirectory> must_create();
+
+private:
+    SchedulerSysFSDirectory();
+};
+
+UNMAP_AFTER_INIT NonnullRefPtr<SchedulerTunableSysFSComponent> SchedulerTunableSysFSComponent::must_create(StringView name, Value& value, u32 max_value)
+{
+    return adopt_ref(*new (nothrow) SchedulerTunableSysFSComponent(name, value, max_value));
+}
+
+UNMAP_AFTER_INIT SchedulerTunableSysFSComponent::SchedulerTunableSysFSComponent(StringView name, Value& value, u32 max_value)
+    : SysFSComponent(name)
+    , m_value(value)
+    , m_max_value(max_value)
+{
+}
+
+KResultOr<size_t> SchedulerTunableSysFSComponent::read_bytes(off_t offset, size_t count, UserOrKernelBuffer& buffer, FileDescription*) const
+{
+    auto value = String::formatted("{}\n", m_value.load());
+    if ((size_t)offset >= value.length())
+        return 0;
+
+    ssize_t nread = min(static_cast<off_t>(value.length() - offset), static_cast<off_t>(count));
+    if (!buffer.write(value.characters() + offset, nread))
+        return EFAULT;
+    return nread;
+}
+
+KResultOr<size_t> SchedulerTunableSysFSComponent::write_bytes(off_t offset, size_t count, UserOrKernelBuffer const& buffer, FileDescription*)
+{
+    char value_buffer[16];
+    if (offset != 0 || count >= sizeof(value_buffer))
+        return EINVAL;
+    if (!buffer.read(value_buffer, count))
+        return EFAULT;
+
+    auto new_value = StringView(value_buffer, count).trim_whitespace().to_uint();
+    if (!new_value.has_value() || new_value.value() > m_max_value)
+        return EINVAL;
+    m_value.store(new_value.value());
+    return count;
+}
+
+UNMAP_AFTER_INIT NonnullRefPtr<SchedulerSysFSDirectory> SchedulerSysFSDirectory::must_create()
+{
+    return adopt_ref(*new (nothrow) SchedulerSysFSDirectory);
+}
+
+UNMAP_AFTER_INIT SchedulerSysFSDirectory::SchedulerSysFSDirectory()
+    : SysFSDirectory("scheduler", SysFSComponentRegistry::the().root_directory())
+{
+    m_components.append(SchedulerTunableSysFSComponent::must_create("migration_cost"sv, s_migration_cost, NumericLimits<u32>::max()));
+    m_components.append(SchedulerTunableSysFSComponent::must_create("tickless"sv, s_tickless_enabled, 1));
+}
+
+UNMAP_AFTER_INIT void Scheduler::initialize_sysfs_directory()
+{
+    SysFSComponentRegistry::the().register_new_component(SchedulerSysFSDirectory::must_create());
+}
+
 void dump_thread_list(bool with_stack_traces)
 {
     dbgln("Scheduler thread list for processor {}:", Processor::id());
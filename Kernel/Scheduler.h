@@ -6,11 +6,14 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/Assertions.h>
+#include <AK/Atomic.h>
 #include <AK/Function.h>
 #include <AK/IntrusiveList.h>
 #include <AK/Types.h>
 #include <Kernel/Forward.h>
+#include <Kernel/KResult.h>
 #include <Kernel/SpinLock.h>
 #include <Kernel/Time/TimeManagement.h>
 #include <Kernel/UnixTypes.h>
@@ -18,6 +21,7 @@
 namespace Kernel {
 
 struct RegisterState;
+class SchedulerData;
 
 extern Thread* g_finalizer;
 extern WaitQueue* g_finalizer_wait_queue;
@@ -29,9 +33,25 @@ struct TotalTimeScheduled {
     u64 total_kernel { 0 };
 };
 
+// How long threads spent waiting in a ready queue until they got to run,
+// in Scheduler::current_time() units. Bucket N counts waits shorter than
+// 2^N units, the last bucket also counts everything longer than that.
+struct SchedulingLatencyHistogram {
+    static constexpr size_t bucket_count = 32;
+
+    void record(u64 latency)
+    {
+        size_t bucket = latency == 0 ? 0 : 64 - __builtin_clzll(latency);
+        buckets[min(bucket, bucket_count - 1)]++;
+    }
+
+    Array<Atomic<u32, AK::MemoryOrder::memory_order_relaxed>, bucket_count> buckets;
+};
+
 class Scheduler {
 public:
     static void initialize();
+    static void initialize_sysfs_directory();
     static Thread* create_ap_idle_thread(u32 cpu);
     static void set_idle_thread(Thread* idle_thread);
     static void timer_tick(const RegisterState&);
@@ -53,9 +73,17 @@ public:
     static void queue_runnable_thread(Thread&);
     static void dump_scheduler_state(bool = false);
     static bool is_initialized();
+    static u32 schedulable_processors_mask();
     static TotalTimeScheduled get_total_time_scheduled();
+    static SchedulingLatencyHistogram const& scheduling_latency_histogram();
     static void add_time_scheduled(u64, bool);
+    static KResult set_deadline_parameters(Thread&, u64 runtime_ns, u64 relative_deadline_ns, u64 period_ns);
+    static void clear_deadline_parameters(Thread&);
     static u64 (*current_time)();
+
+private:
+    static Thread* pull_runnable_thread_from(SchedulerData&, u32 affinity_mask);
+    static Thread* steal_runnable_thread(u32 affinity_mask);
 };
 
 }
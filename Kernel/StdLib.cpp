@@ -276,6 +276,14 @@ int memcmp(const void* v1, const void* v2, size_t n)
 {
     auto* s1 = (const u8*)v1;
     auto* s2 = (const u8*)v2;
+    for (; n >= sizeof(FlatPtr); n -= sizeof(FlatPtr), s1 += sizeof(FlatPtr), s2 += sizeof(FlatPtr)) {
+        FlatPtr word1;
+        FlatPtr word2;
+        __builtin_memcpy(&word1, s1, sizeof(FlatPtr));
+        __builtin_memcpy(&word2, s2, sizeof(FlatPtr));
+        if (word1 != word2)
+            break;
+    }
     while (n-- > 0) {
         if (*s1++ != *s2++)
             return s1[-1] < s2[-1] ? -1 : 1;
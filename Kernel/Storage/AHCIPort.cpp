@@ -44,16 +44,47 @@ AHCIPort::AHCIPort(const AHCIPortHandler& handler, volatile AHCI::PortRegisters&
     dbgln_if(AHCI_DEBUG, "AHCI Port {}: Command list page at {}", representative_port_index(), m_command_list_page->paddr());
     dbgln_if(AHCI_DEBUG, "AHCI Port {}: FIS receive page at {}", representative_port_index(), m_command_list_page->paddr());
 
-    for (size_t index = 0; index < 1; index++) {
-        m_dma_buffers.append(MM.allocate_supervisor_physical_page().release_nonnull());
-    }
-    for (size_t index = 0; index < 1; index++) {
-        m_command_table_pages.append(MM.allocate_supervisor_physical_page().release_nonnull());
-    }
+    VERIFY(try_to_add_command_slot());
     m_command_list_region = MM.allocate_kernel_region(m_command_list_page->paddr(), PAGE_SIZE, "AHCI Port Command List", Region::Access::Read | Region::Access::Write, Region::Cacheable::No);
     dbgln_if(AHCI_DEBUG, "AHCI Port {}: Command list region at {}", representative_port_index(), m_command_list_region->vaddr());
 }
 
+bool AHCIPort::is_addressable(PhysicalAddress address) const
+{
+    return (address.get() >> 32) == 0 || m_parent_handler->hba_capabilities().addressing_64_bit_supported;
+}
+
+bool AHCIPort::try_to_add_command_slot()
+{
+    // The first slot comes out of the small supervisor pool, like it always has. The ones that
+    // are only needed for native command queuing are taken from user memory instead.
+    bool is_first_slot = m_command_slots.is_empty();
+    auto allocate_page = [&]() -> RefPtr<PhysicalPage> {
+        if (is_first_slot)
+            return MM.allocate_supervisor_physical_page();
+        auto page = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::No);
+        if (!page || !is_addressable(page->paddr()))
+            return {};
+        return page;
+    };
+
+    CommandSlot slot;
+    slot.command_table_page = allocate_page();
+    if (!slot.command_table_page)
+        return false;
+    for (size_t index = 0; index < dma_buffer_count; index++) {
+        auto page = allocate_page();
+        if (!page)
+            return false;
+        slot.dma_buffers.append(page.release_nonnull());
+    }
+    slot.command_table_region = MM.allocate_kernel_region(slot.command_table_page->paddr(), PAGE_SIZE, "AHCI Command Table", Region::Access::Read | Region::Access::Write, Region::Cacheable::No);
+    if (!slot.command_table_region)
+        return false;
+    m_command_slots.append(move(slot));
+    return true;
+}
+
 void AHCIPort::clear_sata_error_register() const
 {
     dbgln_if(AHCI_DEBUG, "AHCI Port {}: Clearing SATA error register.", representative_port_index());
@@ -84,36 +115,53 @@ void AHCIPort::handle_interrupt()
         });
         return;
     }
-    if (m_interrupt_status.is_set(AHCI::PortInterruptFlag::DHR) || m_interrupt_status.is_set(AHCI::PortInterruptFlag::PS)) {
+    if (m_interrupt_status.is_set(AHCI::PortInterruptFlag::DHR) || m_interrupt_status.is_set(AHCI::PortInterruptFlag::PS))
         m_wait_for_completion = false;
 
-        // Now schedule reading/writing the buffer as soon as we leave the irq handler.
-        // This is important so that we can safely access the buffers, which could
-        // trigger page faults
-        if (!m_current_request) {
-            dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request handled, probably identify request", representative_port_index());
-        } else {
-            g_io_work->queue([this]() {
-                dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request handled", representative_port_index());
-                MutexLocker locker(m_lock);
-                VERIFY(m_current_request);
-                VERIFY(m_current_scatter_list);
-                if (m_current_request->request_type() == AsyncBlockDeviceRequest::Read) {
-                    if (!m_current_request->write_to_buffer(m_current_request->buffer(), m_current_scatter_list->dma_region().as_ptr(), m_connected_device->block_size() * m_current_request->block_count())) {
-                        dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request failure, memory fault occurred when reading in data.", representative_port_index());
-                        m_current_scatter_list = nullptr;
-                        complete_current_request(AsyncDeviceRequest::MemoryFault);
-                        return;
-                    }
-                }
-                m_current_scatter_list = nullptr;
-                dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request success", representative_port_index());
-                complete_current_request(AsyncDeviceRequest::Success);
-            });
-        }
+    m_interrupt_status.clear();
+
+    // A command is done once neither the HBA (PxCI) nor, for queued commands, the device (PxSACT) holds on to its slot.
+    // Looking at the registers rather than at the interrupt status also picks up anything that completed while we were here.
+    u32 finished_slots;
+    {
+        ScopedSpinLock lock(m_hard_lock);
+        finished_slots = m_issued_command_slots & ~(m_port_registers.ci | m_port_registers.sact);
+        m_issued_command_slots &= ~finished_slots;
+    }
+    if (finished_slots == 0) {
+        dbgln_if(AHCI_DEBUG, "AHCI Port {}: No request handled, probably identify request", representative_port_index());
+        return;
     }
 
-    m_interrupt_status.clear();
+    // Now schedule reading/writing the buffer as soon as we leave the irq handler.
+    // This is important so that we can safely access the buffers, which could
+    // trigger page faults
+    g_io_work->queue([this, finished_slots]() {
+        complete_finished_command_slots(finished_slots);
+    });
+}
+
+void AHCIPort::complete_finished_command_slots(u32 finished_slots)
+{
+    MutexLocker locker(m_lock);
+    for (size_t slot_index = 0; slot_index < m_command_slots.size(); slot_index++) {
+        if (!(finished_slots & (1u << slot_index)))
+            continue;
+        dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request in slot {} handled", representative_port_index(), slot_index);
+        auto& slot = m_command_slots[slot_index];
+        VERIFY(slot.request);
+        VERIFY(slot.scatter_list || slot.is_direct);
+        auto& request = *slot.request;
+        if (request.request_type() == AsyncBlockDeviceRequest::Read && !slot.is_direct) {
+            if (!request.write_to_buffer(request.buffer(), slot.scatter_list->dma_region().as_ptr(), m_connected_device->block_size() * request.block_count())) {
+                dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request failure, memory fault occurred when reading in data.", representative_port_index());
+                complete_command_slot(slot_index, AsyncDeviceRequest::MemoryFault);
+                continue;
+            }
+        }
+        dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request success", representative_port_index());
+        complete_command_slot(slot_index, AsyncDeviceRequest::Success);
+    }
 }
 
 bool AHCIPort::is_interrupts_enabled() const
@@ -148,7 +196,7 @@ void AHCIPort::eject()
     auto unused_command_header = try_to_find_unused_command_header();
     VERIFY(unused_command_header.has_value());
     auto* command_list_entries = (volatile AHCI::CommandHeader*)m_command_list_region->vaddr().as_ptr();
-    command_list_entries[unused_command_header.value()].ctba = m_command_table_pages[unused_command_header.value()].paddr().get();
+    command_list_entries[unused_command_header.value()].ctba = m_command_slots[unused_command_header.value()].command_table_page->paddr().get();
     command_list_entries[unused_command_header.value()].ctbau = 0;
     command_list_entries[unused_command_header.value()].prdbc = 0;
     command_list_entries[unused_command_header.value()].prdtl = 0;
@@ -159,8 +207,7 @@ void AHCIPort::eject()
     // handshake error bit in PxSERR register if CFL is incorrect.
     command_list_entries[unused_command_header.value()].attributes = (size_t)FIS::DwordCount::RegisterHostToDevice | AHCI::CommandHeaderAttributes::P | AHCI::CommandHeaderAttributes::C | AHCI::CommandHeaderAttributes::A;
 
-    auto command_table_region = MM.allocate_kernel_region(m_command_table_pages[unused_command_header.value()].paddr().page_base(), page_round_up(sizeof(AHCI::CommandTable)), "AHCI Command Table", Region::Access::Read | Region::Access::Write, Region::Cacheable::No);
-    auto& command_table = *(volatile AHCI::CommandTable*)command_table_region->vaddr().as_ptr();
+    auto& command_table = *(volatile AHCI::CommandTable*)m_command_slots[unused_command_header.value()].command_table_region->vaddr().as_ptr();
     memset(const_cast<u8*>(command_table.command_fis), 0, 64);
     auto& fis = *(volatile FIS::HostToDevice::Register*)command_table.command_fis;
     fis.header.fis_type = (u8)FIS::Type::RegisterHostToDevice;
@@ -289,6 +336,17 @@ bool AHCIPort::initialize(ScopedSpinLock<SpinLock<u8>>& main_lock)
             m_port_registers.cmd = m_port_registers.cmd | (1 << 24);
         }
 
+        m_native_command_queuing_enabled = false;
+        // Native command queuing needs support from both the HBA and the device (word 76, bit 8).
+        // Word 75 holds the maximum queue depth of the device, minus one.
+        if (!is_atapi_attached() && m_parent_handler->hba_capabilities().native_command_queuing_supported && (identify_block->serial_ata_capabilities & (1 << 8))) {
+            size_t queue_depth = min(static_cast<size_t>(identify_block->queue_depth & 0x1f) + 1, m_parent_handler->hba_capabilities().max_command_list_entries_count);
+            while (m_command_slots.size() < queue_depth && try_to_add_command_slot())
+                ;
+            m_native_command_queuing_enabled = m_command_slots.size() > 1;
+            dmesgln("AHCI Port {}: Native command queuing {}, queue depth {}", representative_port_index(), m_native_command_queuing_enabled ? "enabled" : "disabled", m_command_slots.size());
+        }
+
         dmesgln("AHCI Port {}: Device found, Capacity={}, Bytes per logical sector={}, Bytes per physical sector={}", representative_port_index(), max_addressable_sector * logical_sector_size, logical_sector_size, physical_sector_size);
 
         // FIXME: We don't support ATAPI devices yet, so for now we don't "create" them
@@ -419,67 +477,122 @@ void AHCIPort::set_sleep_state() const
     m_port_registers.cmd = (m_port_registers.cmd & 0x0ffffff) | (0b1000 << 28);
 }
 
+size_t AHCIPort::max_request_block_count() const
+{
+    VERIFY(m_connected_device);
+    // access_device() only passes 8 bits worth of block count to the device.
+    return min(dma_buffer_count * PAGE_SIZE / m_connected_device->block_size(), static_cast<size_t>(NumericLimits<u8>::max()));
+}
+
 size_t AHCIPort::calculate_descriptors_count(size_t block_count) const
 {
     VERIFY(m_connected_device);
     size_t needed_dma_regions_count = page_round_up((block_count * m_connected_device->block_size())) / PAGE_SIZE;
-    VERIFY(needed_dma_regions_count <= m_dma_buffers.size());
+    VERIFY(needed_dma_regions_count <= dma_buffer_count);
     return needed_dma_regions_count;
 }
 
-Optional<AsyncDeviceRequest::RequestResult> AHCIPort::prepare_and_set_scatter_list(AsyncBlockDeviceRequest& request)
+Optional<AsyncDeviceRequest::RequestResult> AHCIPort::prepare_and_set_scatter_list(CommandSlot& slot)
 {
     VERIFY(m_lock.is_locked());
+    VERIFY(slot.request);
+    auto& request = *slot.request;
     VERIFY(request.block_count() > 0);
 
+    slot.is_direct = can_transfer_directly(request);
+    if (slot.is_direct)
+        return {};
+
     NonnullRefPtrVector<PhysicalPage> allocated_dma_regions;
     for (size_t index = 0; index < calculate_descriptors_count(request.block_count()); index++) {
-        allocated_dma_regions.append(m_dma_buffers.at(index));
+        allocated_dma_regions.append(slot.dma_buffers.at(index));
     }
 
-    m_current_scatter_list = ScatterGatherList::try_create(request, allocated_dma_regions.span(), m_connected_device->block_size());
-    if (!m_current_scatter_list)
+    slot.scatter_list = ScatterGatherList::try_create(request, allocated_dma_regions.span(), m_connected_device->block_size());
+    if (!slot.scatter_list)
         return AsyncDeviceRequest::Failure;
     if (request.request_type() == AsyncBlockDeviceRequest::Write) {
-        if (!request.read_from_buffer(request.buffer(), m_current_scatter_list->dma_region().as_ptr(), m_connected_device->block_size() * request.block_count())) {
+        if (!request.read_from_buffer(request.buffer(), slot.scatter_list->dma_region().as_ptr(), m_connected_device->block_size() * request.block_count())) {
             return AsyncDeviceRequest::MemoryFault;
         }
     }
     return {};
 }
 
+bool AHCIPort::can_transfer_directly(const AsyncBlockDeviceRequest& request) const
+{
+    auto& scatter_list = request.direct_scatter_list();
+    if (!scatter_list || request.request_type() != AsyncBlockDeviceRequest::Read || is_atapi_attached())
+        return false;
+    auto& entries = scatter_list->entries();
+    if (entries.is_empty() || entries.size() > dma_buffer_count + 1)
+        return false;
+    size_t total_size = 0;
+    for (auto& entry : entries) {
+        // Data base addresses and byte counts of PRDT entries have to be word aligned.
+        if (entry.address.get() % 2 != 0 || entry.size % 2 != 0 || !is_addressable(entry.address) || !is_addressable(entry.address.offset(entry.size - 1)))
+            return false;
+        total_size += entry.size;
+    }
+    return total_size == request.block_count() * m_connected_device->block_size();
+}
+
+Optional<u8> AHCIPort::try_to_allocate_command_slot()
+{
+    ScopedSpinLock lock(m_hard_lock);
+    for (size_t slot_index = 0; slot_index < m_command_slots.size(); slot_index++) {
+        if (m_allocated_command_slots & (1u << slot_index))
+            continue;
+        m_allocated_command_slots |= 1u << slot_index;
+        return slot_index;
+    }
+    return {};
+}
+
 void AHCIPort::start_request(AsyncBlockDeviceRequest& request)
 {
     MutexLocker locker(m_lock);
-    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request start", representative_port_index());
-    VERIFY(!m_current_request);
-    VERIFY(!m_current_scatter_list);
+    // The device never hands us more than max_requests_in_flight() requests at a time.
+    auto slot_index = try_to_allocate_command_slot();
+    VERIFY(slot_index.has_value());
+    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request start in slot {}", representative_port_index(), slot_index.value());
 
-    m_current_request = request;
+    auto& slot = m_command_slots[slot_index.value()];
+    VERIFY(!slot.request);
+    VERIFY(!slot.scatter_list && !slot.is_direct);
+    slot.request = request;
 
-    auto result = prepare_and_set_scatter_list(request);
+    auto result = prepare_and_set_scatter_list(slot);
     if (result.has_value()) {
         dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request failure.", representative_port_index());
         locker.unlock();
-        complete_current_request(result.value());
+        complete_command_slot(slot_index.value(), result.value());
         return;
     }
 
-    auto success = access_device(request.request_type(), request.block_index(), request.block_count());
+    auto success = access_device(slot_index.value(), request.request_type(), request.block_index(), request.block_count());
     if (!success) {
         dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request failure.", representative_port_index());
         locker.unlock();
-        complete_current_request(AsyncDeviceRequest::Failure);
+        complete_command_slot(slot_index.value(), AsyncDeviceRequest::Failure);
         return;
     }
 }
 
-void AHCIPort::complete_current_request(AsyncDeviceRequest::RequestResult result)
+void AHCIPort::complete_command_slot(u8 slot_index, AsyncDeviceRequest::RequestResult result)
 {
-    VERIFY(m_current_request);
-    auto current_request = m_current_request;
-    m_current_request.clear();
-    current_request->complete(result);
+    auto& slot = m_command_slots[slot_index];
+    VERIFY(slot.request);
+    auto request = move(slot.request);
+    slot.scatter_list = nullptr;
+    slot.is_direct = false;
+    {
+        ScopedSpinLock lock(m_hard_lock);
+        VERIFY(!(m_issued_command_slots & (1u << slot_index)));
+        m_allocated_command_slots &= ~(1u << slot_index);
+    }
+    // This may start the next request right away, possibly in the slot we just gave up.
+    request->complete(result);
 }
 
 bool AHCIPort::spin_until_ready() const
@@ -498,57 +611,59 @@ bool AHCIPort::spin_until_ready() const
     return true;
 }
 
-bool AHCIPort::access_device(AsyncBlockDeviceRequest::RequestType direction, u64 lba, u8 block_count)
+bool AHCIPort::access_device(u8 slot_index, AsyncBlockDeviceRequest::RequestType direction, u64 lba, u8 block_count)
 {
     VERIFY(m_connected_device);
     VERIFY(is_operable());
     VERIFY(m_lock.is_locked());
-    VERIFY(m_current_scatter_list);
+    auto& slot = m_command_slots[slot_index];
+    VERIFY(slot.scatter_list || slot.is_direct);
     ScopedSpinLock lock(m_hard_lock);
 
-    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Do a {}, lba {}, block count {}", representative_port_index(), direction == AsyncBlockDeviceRequest::RequestType::Write ? "write" : "read", lba, block_count);
+    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Do a {}, lba {}, block count {}, slot {}", representative_port_index(), direction == AsyncBlockDeviceRequest::RequestType::Write ? "write" : "read", lba, block_count, slot_index);
     if (!spin_until_ready())
         return false;
 
-    auto unused_command_header = try_to_find_unused_command_header();
-    VERIFY(unused_command_header.has_value());
+    auto command_table_address = slot.command_table_page->paddr().get();
     auto* command_list_entries = (volatile AHCI::CommandHeader*)m_command_list_region->vaddr().as_ptr();
-    command_list_entries[unused_command_header.value()].ctba = m_command_table_pages[unused_command_header.value()].paddr().get();
-    command_list_entries[unused_command_header.value()].ctbau = 0;
-    command_list_entries[unused_command_header.value()].prdbc = 0;
-    command_list_entries[unused_command_header.value()].prdtl = m_current_scatter_list->scatters_count();
+    command_list_entries[slot_index].ctba = command_table_address & 0xffffffff;
+    command_list_entries[slot_index].ctbau = command_table_address >> 32;
+    command_list_entries[slot_index].prdbc = 0;
+    command_list_entries[slot_index].prdtl = slot.is_direct ? slot.request->direct_scatter_list()->entries().size() : slot.scatter_list->scatters_count();
 
     // Note: we must set the correct Dword count in this register. Real hardware
     // AHCI controllers do care about this field! QEMU doesn't care if we don't
     // set the correct CFL field in this register, real hardware will set an
     // handshake error bit in PxSERR register if CFL is incorrect.
-    command_list_entries[unused_command_header.value()].attributes = (size_t)FIS::DwordCount::RegisterHostToDevice | AHCI::CommandHeaderAttributes::P | (is_atapi_attached() ? AHCI::CommandHeaderAttributes::A : 0) | (direction == AsyncBlockDeviceRequest::RequestType::Write ? AHCI::CommandHeaderAttributes::W : 0);
-
-    dbgln_if(AHCI_DEBUG, "AHCI Port {}: CLE: ctba={:#08x}, ctbau={:#08x}, prdbc={:#08x}, prdtl={:#04x}, attributes={:#04x}", representative_port_index(), (u32)command_list_entries[unused_command_header.value()].ctba, (u32)command_list_entries[unused_command_header.value()].ctbau, (u32)command_list_entries[unused_command_header.value()].prdbc, (u16)command_list_entries[unused_command_header.value()].prdtl, (u16)command_list_entries[unused_command_header.value()].attributes);
+    // Queued commands must not be marked as prefetchable.
+    command_list_entries[slot_index].attributes = (size_t)FIS::DwordCount::RegisterHostToDevice | (m_native_command_queuing_enabled ? 0 : AHCI::CommandHeaderAttributes::P) | (is_atapi_attached() ? AHCI::CommandHeaderAttributes::A : 0) | (direction == AsyncBlockDeviceRequest::RequestType::Write ? AHCI::CommandHeaderAttributes::W : 0);
 
-    auto command_table_region = MM.allocate_kernel_region(m_command_table_pages[unused_command_header.value()].paddr().page_base(), page_round_up(sizeof(AHCI::CommandTable)), "AHCI Command Table", Region::Access::Read | Region::Access::Write, Region::Cacheable::No);
-    auto& command_table = *(volatile AHCI::CommandTable*)command_table_region->vaddr().as_ptr();
+    dbgln_if(AHCI_DEBUG, "AHCI Port {}: CLE: ctba={:#08x}, ctbau={:#08x}, prdbc={:#08x}, prdtl={:#04x}, attributes={:#04x}", representative_port_index(), (u32)command_list_entries[slot_index].ctba, (u32)command_list_entries[slot_index].ctbau, (u32)command_list_entries[slot_index].prdbc, (u16)command_list_entries[slot_index].prdtl, (u16)command_list_entries[slot_index].attributes);
 
-    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Allocated command table at {}", representative_port_index(), command_table_region->vaddr());
+    auto& command_table = *(volatile AHCI::CommandTable*)slot.command_table_region->vaddr().as_ptr();
 
     memset(const_cast<u8*>(command_table.command_fis), 0, 64);
 
     size_t scatter_entry_index = 0;
-    size_t data_transfer_count = (block_count * m_connected_device->block_size());
-    for (auto scatter_page : m_current_scatter_list->vmobject().physical_pages()) {
-        VERIFY(data_transfer_count != 0);
-        VERIFY(scatter_page);
-        dbgln_if(AHCI_DEBUG, "AHCI Port {}: Add a transfer scatter entry @ {}", representative_port_index(), scatter_page->paddr());
-        command_table.descriptors[scatter_entry_index].base_high = 0;
-        command_table.descriptors[scatter_entry_index].base_low = scatter_page->paddr().get();
-        if (data_transfer_count <= PAGE_SIZE) {
-            command_table.descriptors[scatter_entry_index].byte_count = data_transfer_count - 1;
-            data_transfer_count = 0;
-        } else {
-            command_table.descriptors[scatter_entry_index].byte_count = PAGE_SIZE - 1;
-            data_transfer_count -= PAGE_SIZE;
-        }
+    auto add_scatter_entry = [&](PhysicalAddress address, size_t byte_count) {
+        dbgln_if(AHCI_DEBUG, "AHCI Port {}: Add a transfer scatter entry @ {}, {} bytes", representative_port_index(), address, byte_count);
+        command_table.descriptors[scatter_entry_index].base_high = address.get() >> 32;
+        command_table.descriptors[scatter_entry_index].base_low = address.get() & 0xffffffff;
+        command_table.descriptors[scatter_entry_index].byte_count = byte_count - 1;
         scatter_entry_index++;
+    };
+    if (slot.is_direct) {
+        for (auto& entry : slot.request->direct_scatter_list()->entries())
+            add_scatter_entry(entry.address, entry.size);
+    } else {
+        size_t data_transfer_count = (block_count * m_connected_device->block_size());
+        for (auto scatter_page : slot.scatter_list->vmobject().physical_pages()) {
+            VERIFY(data_transfer_count != 0);
+            VERIFY(scatter_page);
+            auto byte_count = min(data_transfer_count, PAGE_SIZE);
+            add_scatter_entry(scatter_page->paddr(), byte_count);
+            data_transfer_count -= byte_count;
+        }
     }
     command_table.descriptors[scatter_entry_index].byte_count = (PAGE_SIZE - 1) | (1 << 31);
 
@@ -559,6 +674,11 @@ bool AHCIPort::access_device(AsyncBlockDeviceRequest::RequestType direction, u64
     if (is_atapi_attached()) {
         fis.command = ATA_CMD_PACKET;
         TODO();
+    } else if (m_native_command_queuing_enabled) {
+        if (direction == AsyncBlockDeviceRequest::RequestType::Write)
+            fis.command = ATA_CMD_WRITE_FPDMA_QUEUED;
+        else
+            fis.command = ATA_CMD_READ_FPDMA_QUEUED;
     } else {
         if (direction == AsyncBlockDeviceRequest::RequestType::Write)
             fis.command = ATA_CMD_WRITE_DMA_EXT;
@@ -577,17 +697,29 @@ bool AHCIPort::access_device(AsyncBlockDeviceRequest::RequestType direction, u64
     fis.lba_low[0] = lba & 0xff;
     fis.lba_low[1] = (lba >> 8) & 0xff;
     fis.lba_low[2] = (lba >> 16) & 0xff;
-    fis.count = (block_count);
+    if (m_native_command_queuing_enabled) {
+        // Queued commands take the block count in the features register, and the tag in bits 7:3 of the count register.
+        fis.features_low = block_count;
+        fis.features_high = 0;
+        fis.count = slot_index << 3;
+    } else {
+        fis.count = (block_count);
+    }
 
     // The below loop waits until the port is no longer busy before issuing a new command
     if (!spin_until_ready())
         return false;
 
     full_memory_barrier();
-    mark_command_header_ready_to_process(unused_command_header.value());
+    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Issuing command in slot {}", representative_port_index(), slot_index);
+    m_issued_command_slots |= 1u << slot_index;
+    // Queued commands have to be marked as outstanding in PxSACT before they are issued.
+    if (m_native_command_queuing_enabled)
+        m_port_registers.sact = 1u << slot_index;
+    m_port_registers.ci = 1u << slot_index;
     full_memory_barrier();
 
-    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Do a {}, lba {}, block count {} @ {}, ended", representative_port_index(), direction == AsyncBlockDeviceRequest::RequestType::Write ? "write" : "read", lba, block_count, m_dma_buffers[0].paddr());
+    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Do a {}, lba {}, block count {} @ {}, ended", representative_port_index(), direction == AsyncBlockDeviceRequest::RequestType::Write ? "write" : "read", lba, block_count, slot.dma_buffers[0].paddr());
     return true;
 }
 
@@ -601,7 +733,7 @@ bool AHCIPort::identify_device(ScopedSpinLock<SpinLock<u8>>& main_lock)
     auto unused_command_header = try_to_find_unused_command_header();
     VERIFY(unused_command_header.has_value());
     auto* command_list_entries = (volatile AHCI::CommandHeader*)m_command_list_region->vaddr().as_ptr();
-    command_list_entries[unused_command_header.value()].ctba = m_command_table_pages[unused_command_header.value()].paddr().get();
+    command_list_entries[unused_command_header.value()].ctba = m_command_slots[unused_command_header.value()].command_table_page->paddr().get();
     command_list_entries[unused_command_header.value()].ctbau = 0;
     command_list_entries[unused_command_header.value()].prdbc = 512;
     command_list_entries[unused_command_header.value()].prdtl = 1;
@@ -610,8 +742,7 @@ bool AHCIPort::identify_device(ScopedSpinLock<SpinLock<u8>>& main_lock)
     // QEMU doesn't care if we don't set the correct CFL field in this register, real hardware will set an handshake error bit in PxSERR register.
     command_list_entries[unused_command_header.value()].attributes = (size_t)FIS::DwordCount::RegisterHostToDevice | AHCI::CommandHeaderAttributes::P;
 
-    auto command_table_region = MM.allocate_kernel_region(m_command_table_pages[unused_command_header.value()].paddr().page_base(), page_round_up(sizeof(AHCI::CommandTable)), "AHCI Command Table", Region::Access::Read | Region::Access::Write);
-    auto& command_table = *(volatile AHCI::CommandTable*)command_table_region->vaddr().as_ptr();
+    auto& command_table = *(volatile AHCI::CommandTable*)m_command_slots[unused_command_header.value()].command_table_region->vaddr().as_ptr();
     memset(const_cast<u8*>(command_table.command_fis), 0, 64);
     command_table.descriptors[0].base_high = 0;
     command_table.descriptors[0].base_low = m_parent_handler->get_identify_metadata_physical_region(m_port_index).get();
@@ -664,7 +795,7 @@ Optional<u8> AHCIPort::try_to_find_unused_command_header()
 {
     VERIFY(m_lock.is_locked());
     u32 commands_issued = m_port_registers.ci;
-    for (size_t index = 0; index < 32; index++) {
+    for (size_t index = 0; index < m_command_slots.size(); index++) {
         if (!(commands_issued & 1)) {
             dbgln_if(AHCI_DEBUG, "AHCI Port {}: unused command header at index {}", representative_port_index(), index);
             return index;
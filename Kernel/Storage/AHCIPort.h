@@ -49,6 +49,9 @@ public:
     UNMAP_AFTER_INIT bool initialize_without_reset();
     void handle_interrupt();
 
+    size_t max_request_block_count() const;
+    size_t max_requests_in_flight() const { return m_native_command_queuing_enabled ? m_command_slots.size() : 1; }
+
 private:
     bool is_phy_enabled() const { return (m_port_registers.ssts & 0xf) == 3; }
     bool initialize(ScopedSpinLock<SpinLock<u8>>&);
@@ -69,11 +72,28 @@ private:
     ALWAYS_INLINE void spin_up() const;
     ALWAYS_INLINE void power_on() const;
 
+    struct CommandSlot {
+        RefPtr<PhysicalPage> command_table_page;
+        OwnPtr<Region> command_table_region;
+        // Requests are scattered over these pages, one PRDT entry each.
+        NonnullRefPtrVector<PhysicalPage> dma_buffers;
+        RefPtr<AsyncBlockDeviceRequest> request;
+        RefPtr<ScatterGatherList> scatter_list;
+        // The device transfers straight into the pages of the request's direct scatter list, scatter_list is unused.
+        bool is_direct { false };
+    };
+
+    bool try_to_add_command_slot();
+    bool is_addressable(PhysicalAddress) const;
+
     void start_request(AsyncBlockDeviceRequest&);
-    void complete_current_request(AsyncDeviceRequest::RequestResult);
-    bool access_device(AsyncBlockDeviceRequest::RequestType, u64 lba, u8 block_count);
+    Optional<u8> try_to_allocate_command_slot();
+    void complete_command_slot(u8 slot_index, AsyncDeviceRequest::RequestResult);
+    void complete_finished_command_slots(u32 finished_slots);
+    bool access_device(u8 slot_index, AsyncBlockDeviceRequest::RequestType, u64 lba, u8 block_count);
     size_t calculate_descriptors_count(size_t block_count) const;
-    [[nodiscard]] Optional<AsyncDeviceRequest::RequestResult> prepare_and_set_scatter_list(AsyncBlockDeviceRequest& request);
+    [[nodiscard]] Optional<AsyncDeviceRequest::RequestResult> prepare_and_set_scatter_list(CommandSlot&);
+    bool can_transfer_directly(const AsyncBlockDeviceRequest&) const;
 
     ALWAYS_INLINE bool is_interrupts_enabled() const;
 
@@ -100,15 +120,20 @@ private:
     // Data members
 
     EntropySource m_entropy_source;
-    RefPtr<AsyncBlockDeviceRequest> m_current_request;
     SpinLock<u8> m_hard_lock;
     Mutex m_lock { "AHCIPort" };
 
     mutable bool m_wait_for_completion { false };
     bool m_wait_connect_for_completion { false };
 
-    NonnullRefPtrVector<PhysicalPage> m_dma_buffers;
-    NonnullRefPtrVector<PhysicalPage> m_command_table_pages;
+    static constexpr size_t dma_buffer_count = 16;
+    // Slot 0 always exists, the others are only added when native command queuing is used.
+    Vector<CommandSlot> m_command_slots;
+    // Both are guarded by m_hard_lock. A slot is allocated from start_request() until its request
+    // has been completed, and issued while the HBA and the device own it.
+    u32 m_allocated_command_slots { 0 };
+    u32 m_issued_command_slots { 0 };
+    bool m_native_command_queuing_enabled { false };
     RefPtr<PhysicalPage> m_command_list_page;
     OwnPtr<Region> m_command_list_region;
     RefPtr<PhysicalPage> m_fis_receive_page;
@@ -120,7 +145,6 @@ private:
     AHCI::PortInterruptStatusBitField m_interrupt_status;
     AHCI::PortInterruptEnableBitField m_interrupt_enable;
 
-    RefPtr<ScatterGatherList> m_current_scatter_list;
     bool m_disabled_by_firmware { false };
 };
 }
@@ -27,6 +27,10 @@ AHCIPortHandler::AHCIPortHandler(AHCIController& controller, u8 irq, AHCI::Maske
 
     dbgln_if(AHCI_DEBUG, "AHCI Port Handler: IRQ {}", irq);
 
+    // With MSI, the HBA doesn't share its interrupt with anyone and doesn't have to interrupt the BSP.
+    if (try_to_enable_message_signalled_interrupts(controller.pci_address()))
+        dbgln_if(AHCI_DEBUG, "AHCI Port Handler: Using message signalled interrupts");
+
     // Clear pending interrupts, if there are any!
     m_pending_ports_interrupts.set_all();
     enable_irq();
@@ -0,0 +1,370 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteReader.h>
+#include <Kernel/Arch/x86/Processor.h>
+#include <Kernel/Debug.h>
+#include <Kernel/IO.h>
+#include <Kernel/Interrupts/APIC.h>
+#include <Kernel/Interrupts/IRQHandler.h>
+#include <Kernel/Interrupts/InterruptManagement.h>
+#include <Kernel/Interrupts/MSIHandler.h>
+#include <Kernel/Storage/NVMeController.h>
+#include <Kernel/VM/MemoryManager.h>
+
+namespace Kernel {
+
+// Handles the completions of all I/O queues if there's nothing better than the controller's INTx line.
+class NVMeInterruptHandler final : public IRQHandler {
+public:
+    NVMeInterruptHandler(NVMeController& controller, u8 irq)
+        : IRQHandler(irq)
+        , m_controller(controller)
+    {
+    }
+
+    virtual StringView purpose() const override { return "NVMe"; }
+
+private:
+    virtual bool handle_irq(const RegisterState&) override { return m_controller.handle_completions_on_all_queues(); }
+
+    NVMeController& m_controller;
+};
+
+// Handles the completions of a single I/O queue, on the processor that queue belongs to.
+class NVMeQueueInterruptHandler final : public MSIHandler {
+public:
+    NVMeQueueInterruptHandler(NVMeQueue& queue, u8 interrupt_number)
+        : MSIHandler(interrupt_number)
+        , m_queue(queue)
+    {
+    }
+
+    virtual bool handle_interrupt(const RegisterState&) override { return m_queue.handle_completions(); }
+    virtual StringView purpose() const override { return "NVMe I/O Queue"; }
+
+private:
+    NVMeQueue& m_queue;
+};
+
+static u32 s_next_controller_index { 0 };
+
+UNMAP_AFTER_INIT NonnullRefPtr<NVMeController> NVMeController::initialize(PCI::Address address)
+{
+    auto controller = adopt_ref(*new NVMeController(address));
+    // A controller that failed to come up just doesn't have any namespaces.
+    if (!controller->initialize_controller())
+        dmesgln("NVMe @ {}: Failed to initialize controller", address);
+    return controller;
+}
+
+UNMAP_AFTER_INIT NVMeController::NVMeController(PCI::Address address)
+    : StorageController()
+    , PCI::DeviceController(address)
+    , m_index(s_next_controller_index++)
+{
+}
+
+NVMeController::~NVMeController()
+{
+}
+
+volatile NVMe::ControllerRegisters& NVMeController::registers() const
+{
+    return *reinterpret_cast<volatile NVMe::ControllerRegisters*>(m_registers_region->vaddr().as_ptr());
+}
+
+volatile u32* NVMeController::doorbell(u16 queue_id, bool completion_queue) const
+{
+    size_t offset = NVMe::doorbells_offset + (2 * queue_id + (completion_queue ? 1 : 0)) * m_doorbell_stride;
+    VERIFY(offset + sizeof(u32) <= m_registers_region->size());
+    return reinterpret_cast<volatile u32*>(m_registers_region->vaddr().offset(offset).as_ptr());
+}
+
+UNMAP_AFTER_INIT bool NVMeController::wait_for_ready(bool ready)
+{
+    for (size_t elapsed_ms = 0; elapsed_ms < m_timeout_ms; elapsed_ms++) {
+        u32 status = registers().controller_status;
+        if (ready && (status & NVMe::csts_fatal))
+            return false;
+        if (!!(status & NVMe::csts_ready) == ready)
+            return true;
+        IO::delay(1000);
+    }
+    return false;
+}
+
+UNMAP_AFTER_INIT bool NVMeController::initialize_controller()
+{
+    PCI::enable_memory_space(pci_address());
+    PCI::enable_bus_mastering(pci_address());
+
+    // BAR0 and BAR1 together form the 64-bit address of the registers.
+    u64 registers_address = (PCI::get_BAR0(pci_address()) & ~0xfu) | ((u64)PCI::get_BAR1(pci_address()) << 32);
+    size_t registers_size = PCI::get_BAR_space_size(pci_address(), 0);
+    if (registers_size < NVMe::doorbells_offset + PAGE_SIZE)
+        return false;
+    m_registers_region = MM.allocate_kernel_region(PhysicalAddress(registers_address).page_base(), page_round_up(registers_size), "NVMe Registers", Region::Access::Read | Region::Access::Write, Region::Cacheable::No);
+    if (!m_registers_region)
+        return false;
+
+    u64 capabilities = registers().capabilities;
+    u32 version = registers().version;
+    if (!(capabilities & NVMe::cap_css_nvm)) {
+        dbgln("NVMe @ {}: Controller doesn't support the NVM command set", pci_address());
+        return false;
+    }
+    // Our queues and PRPs are made of 4 KiB pages.
+    if (((capabilities >> NVMe::cap_mpsmin_shift) & NVMe::cap_mpsmin_mask) != 0) {
+        dbgln("NVMe @ {}: Controller doesn't support 4 KiB pages", pci_address());
+        return false;
+    }
+    m_doorbell_stride = 4u << ((capabilities >> NVMe::cap_dstrd_shift) & NVMe::cap_dstrd_mask);
+    m_timeout_ms = max<size_t>(((capabilities >> NVMe::cap_to_shift) & NVMe::cap_to_mask) * 500, 500);
+    m_max_queue_entry_count = min<size_t>((capabilities & NVMe::cap_mqes_mask) + 1, max_queue_entry_count);
+    if (m_max_queue_entry_count < 2)
+        return false;
+
+    // The controller has to be disabled while we set up the admin queue.
+    registers().controller_configuration = registers().controller_configuration & ~NVMe::cc_enable;
+    if (!wait_for_ready(false))
+        return false;
+
+    m_admin_queue = NVMeQueue::try_create(0, m_max_queue_entry_count, doorbell(0, false), doorbell(0, true));
+    m_identify_region = MM.allocate_contiguous_kernel_region(PAGE_SIZE, "NVMe Identify", Region::Access::Read | Region::Access::Write);
+    if (!m_admin_queue || !m_identify_region)
+        return false;
+    registers().admin_queue_attributes = ((m_max_queue_entry_count - 1) << 16) | (m_max_queue_entry_count - 1);
+    registers().admin_submission_queue = m_admin_queue->submission_queue_address().get();
+    registers().admin_completion_queue = m_admin_queue->completion_queue_address().get();
+
+    registers().controller_configuration = NVMe::cc_enable | NVMe::cc_iosqes | NVMe::cc_iocqes;
+    if (!wait_for_ready(true)) {
+        dbgln("NVMe @ {}: Controller didn't become ready", pci_address());
+        return false;
+    }
+
+    NVMe::Command identify_controller {};
+    identify_controller.opcode = static_cast<u8>(NVMe::AdminOpcode::Identify);
+    identify_controller.data_pointer[0] = m_identify_region->physical_page(0)->paddr().get();
+    identify_controller.cdw10 = NVMe::identify_cns_controller;
+    auto identify_result = submit_admin_command(identify_controller);
+    if (!identify_result.has_value())
+        return false;
+    auto* identify_data = m_identify_region->vaddr().as_ptr();
+    // MDTS is a power of two in units of the minimum page size, with 0 meaning there's no limit.
+    u8 max_data_transfer_size = identify_data[NVMe::identify_controller_mdts];
+    if (max_data_transfer_size != 0 && max_data_transfer_size < 4)
+        m_data_pages_per_request = min(m_data_pages_per_request, static_cast<size_t>(1u << max_data_transfer_size));
+    u32 namespace_count = ByteReader::load32(identify_data + NVMe::identify_controller_nn);
+
+    if (!create_io_queues())
+        return false;
+    identify_namespaces(namespace_count);
+
+    dmesgln("NVMe @ {}: Version {}.{}, {} I/O queues with {} interrupts, {} namespaces", pci_address(), version >> 16, (version >> 8) & 0xff, m_io_queues.size(), m_msix_table ? "MSI-X" : "pin-based", m_namespaces.size());
+    return true;
+}
+
+Optional<NVMe::Completion> NVMeController::submit_admin_command(NVMe::Command& command)
+{
+    auto completion = m_admin_queue->submit_and_wait(command, m_timeout_ms);
+    if (!completion.has_value())
+        return {};
+    if (u16 status = completion.value().status >> 1; status != 0) {
+        dbgln("NVMe @ {}: Admin command {:#02x} failed with status {:#04x}", pci_address(), command.opcode, status);
+        return {};
+    }
+    return completion;
+}
+
+UNMAP_AFTER_INIT bool NVMeController::create_io_queues()
+{
+    size_t queue_count = min(static_cast<size_t>(Processor::count()), max_io_queue_count);
+    if (APIC::initialized() && is_msix_capable()) {
+        m_msix_table = PCI::MSIXTable::try_create(pci_address());
+        if (m_msix_table)
+            queue_count = min(queue_count, m_msix_table->entry_count());
+    }
+
+    // Both counts are zero-based, and so is the number of queues the controller is willing to give us.
+    NVMe::Command set_queue_count {};
+    set_queue_count.opcode = static_cast<u8>(NVMe::AdminOpcode::SetFeatures);
+    set_queue_count.cdw10 = NVMe::feature_number_of_queues;
+    set_queue_count.cdw11 = ((queue_count - 1) << 16) | (queue_count - 1);
+    auto result = submit_admin_command(set_queue_count);
+    if (!result.has_value())
+        return false;
+    queue_count = min(queue_count, static_cast<size_t>((result.value().dw0 & 0xffff) + 1));
+    queue_count = min(queue_count, static_cast<size_t>((result.value().dw0 >> 16) + 1));
+
+    // I/O queue i interrupts through MSI-X vector i - 1, the admin queue shares the first one but is only ever polled.
+    for (u16 queue_id = 1; queue_id <= queue_count; queue_id++) {
+        if (!create_io_queue(queue_id, m_msix_table ? queue_id - 1 : 0)) {
+            if (m_io_queues.is_empty())
+                return false;
+            break;
+        }
+    }
+    return set_up_interrupts();
+}
+
+UNMAP_AFTER_INIT bool NVMeController::create_io_queue(u16 queue_id, u16 interrupt_vector)
+{
+    size_t slot_count = min(request_slots_per_queue, m_max_queue_entry_count - 1);
+    auto queue = NVMeQueue::try_create(queue_id, m_max_queue_entry_count, doorbell(queue_id, false), doorbell(queue_id, true), slot_count, m_data_pages_per_request);
+    if (!queue)
+        return false;
+
+    NVMe::Command create_completion_queue {};
+    create_completion_queue.opcode = static_cast<u8>(NVMe::AdminOpcode::CreateIOCompletionQueue);
+    create_completion_queue.data_pointer[0] = queue->completion_queue_address().get();
+    create_completion_queue.cdw10 = ((queue->entry_count() - 1) << 16) | queue_id;
+    create_completion_queue.cdw11 = ((u32)interrupt_vector << 16) | NVMe::completion_queue_interrupts_enabled | NVMe::queue_physically_contiguous;
+    if (!submit_admin_command(create_completion_queue).has_value())
+        return false;
+
+    NVMe::Command create_submission_queue {};
+    create_submission_queue.opcode = static_cast<u8>(NVMe::AdminOpcode::CreateIOSubmissionQueue);
+    create_submission_queue.data_pointer[0] = queue->submission_queue_address().get();
+    create_submission_queue.cdw10 = ((queue->entry_count() - 1) << 16) | queue_id;
+    create_submission_queue.cdw11 = ((u32)queue_id << 16) | NVMe::queue_physically_contiguous;
+    if (!submit_admin_command(create_submission_queue).has_value())
+        return false;
+
+    m_io_queues.append(queue.release_nonnull());
+    return true;
+}
+
+UNMAP_AFTER_INIT bool NVMeController::set_up_interrupts()
+{
+    if (!m_msix_table) {
+        auto handler = make<NVMeInterruptHandler>(*this, PCI::get_interrupt_line(pci_address()));
+        handler->enable_irq();
+        enable_pin_based_interrupts();
+        m_interrupt_handlers.append(move(handler));
+        return true;
+    }
+
+    for (size_t queue_index = 0; queue_index < m_io_queues.size(); queue_index++) {
+        auto interrupt_number = InterruptManagement::allocate_message_signalled_interrupt_number();
+        if (!interrupt_number.has_value()) {
+            dbgln("NVMe @ {}: Ran out of interrupt vectors", pci_address());
+            return false;
+        }
+        auto handler = make<NVMeQueueInterruptHandler>(m_io_queues[queue_index], interrupt_number.value());
+        handler->register_interrupt_handler();
+        m_msix_table->set_entry(queue_index, interrupt_number.value(), queue_index % Processor::count());
+        m_interrupt_handlers.append(move(handler));
+    }
+    enable_extended_message_signalled_interrupts();
+    return true;
+}
+
+UNMAP_AFTER_INIT void NVMeController::identify_namespaces(u32 namespace_count)
+{
+    // Every namespace should be able to have at least one request in flight.
+    size_t total_slot_count = 0;
+    for (auto& queue : m_io_queues)
+        total_slot_count += queue.request_slot_count();
+
+    for (u32 nsid = 1; nsid <= min(namespace_count, max_namespace_count) && m_namespaces.size() < total_slot_count; nsid++) {
+        NVMe::Command identify_namespace {};
+        identify_namespace.opcode = static_cast<u8>(NVMe::AdminOpcode::Identify);
+        identify_namespace.nsid = nsid;
+        identify_namespace.data_pointer[0] = m_identify_region->physical_page(0)->paddr().get();
+        identify_namespace.cdw10 = NVMe::identify_cns_namespace;
+        if (!submit_admin_command(identify_namespace).has_value())
+            continue;
+
+        auto* identify_data = m_identify_region->vaddr().as_ptr();
+        u64 block_count = ByteReader::load64(identify_data + NVMe::identify_namespace_nsze);
+        // Inactive namespace ids identify as all zeroes.
+        if (block_count == 0)
+            continue;
+        u8 format_index = identify_data[NVMe::identify_namespace_flbas] & 0xf;
+        u32 format = ByteReader::load32(identify_data + NVMe::identify_namespace_lbaf + format_index * sizeof(u32));
+        u16 metadata_size = format & 0xffff;
+        size_t block_size = 1u << ((format >> 16) & 0xff);
+        if (metadata_size != 0 || block_size < 512 || block_size > PAGE_SIZE) {
+            dbgln("NVMe @ {}: Namespace {} has an unsupported format ({} byte blocks, {} bytes of metadata)", pci_address(), nsid, block_size, metadata_size);
+            continue;
+        }
+        dbgln_if(NVME_DEBUG, "NVMe @ {}: Namespace {} has {} blocks of {} bytes", pci_address(), nsid, block_count, block_size);
+        m_namespaces.append(NVMeNamespaceDevice::create(*this, nsid, block_size, block_count));
+    }
+}
+
+size_t NVMeController::max_requests_in_flight_per_namespace() const
+{
+    size_t total_slot_count = 0;
+    for (auto& queue : m_io_queues)
+        total_slot_count += queue.request_slot_count();
+    return max<size_t>(total_slot_count / max<size_t>(m_namespaces.size(), 1), 1);
+}
+
+bool NVMeController::handle_completions_on_all_queues()
+{
+    bool handled = false;
+    for (auto& queue : m_io_queues) {
+        if (queue.handle_completions())
+            handled = true;
+    }
+    return handled;
+}
+
+RefPtr<StorageDevice> NVMeController::device(u32 index) const
+{
+    if (index >= m_namespaces.size())
+        return {};
+    return m_namespaces[index];
+}
+
+size_t NVMeController::devices_count() const
+{
+    return m_namespaces.size();
+}
+
+bool NVMeController::reset()
+{
+    TODO();
+}
+
+bool NVMeController::shutdown()
+{
+    if (!m_registers_region)
+        return true;
+    registers().controller_configuration = (registers().controller_configuration & ~NVMe::cc_shn_mask) | NVMe::cc_shn_normal;
+    for (size_t elapsed_ms = 0; elapsed_ms < m_timeout_ms; elapsed_ms++) {
+        if ((registers().controller_status & NVMe::csts_shst_mask) == NVMe::csts_shst_complete)
+            return true;
+        IO::delay(1000);
+    }
+    return false;
+}
+
+void NVMeController::start_request(const StorageDevice& device, AsyncBlockDeviceRequest& request)
+{
+    auto& namespace_device = static_cast<const NVMeNamespaceDevice&>(device);
+    VERIFY(request.block_count() > 0 && request.block_count() <= namespace_device.max_request_block_count());
+
+    // Stay on the current processor's queue if we can, so its completion interrupt comes back to us.
+    size_t first_queue_index = Processor::id() % m_io_queues.size();
+    for (size_t offset = 0; offset < m_io_queues.size(); offset++) {
+        auto& queue = m_io_queues[(first_queue_index + offset) % m_io_queues.size()];
+        if (queue.try_start_request(namespace_device.nsid(), namespace_device.block_size(), request))
+            return;
+    }
+    // No namespace has more requests in flight than there are slots to go around.
+    VERIFY_NOT_REACHED();
+}
+
+void NVMeController::complete_current_request(AsyncDeviceRequest::RequestResult)
+{
+    VERIFY_NOT_REACHED();
+}
+
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/OwnPtr.h>
+#include <AK/RefPtr.h>
+#include <AK/Types.h>
+#include <Kernel/Bus/PCI/DeviceController.h>
+#include <Kernel/Bus/PCI/MSIXTable.h>
+#include <Kernel/Interrupts/GenericInterruptHandler.h>
+#include <Kernel/Storage/NVMeDefinitions.h>
+#include <Kernel/Storage/NVMeNamespaceDevice.h>
+#include <Kernel/Storage/NVMeQueue.h>
+#include <Kernel/Storage/StorageController.h>
+#include <Kernel/VM/Region.h>
+
+namespace Kernel {
+
+class AsyncBlockDeviceRequest;
+
+// An NVMe controller with one I/O queue pair per processor (as far as the controller and its
+// MSI-X table allow), each of them interrupting the processor it belongs to.
+// Every namespace of the controller shows up as a storage device of its own.
+class NVMeController final : public StorageController
+    , public PCI::DeviceController {
+    AK_MAKE_ETERNAL
+public:
+    UNMAP_AFTER_INIT static NonnullRefPtr<NVMeController> initialize(PCI::Address address);
+    virtual ~NVMeController() override;
+
+    virtual RefPtr<StorageDevice> device(u32 index) const override;
+    virtual bool reset() override;
+    virtual bool shutdown() override;
+    virtual size_t devices_count() const override;
+    virtual void start_request(const StorageDevice&, AsyncBlockDeviceRequest&) override;
+    virtual void complete_current_request(AsyncDeviceRequest::RequestResult) override;
+
+    u32 index() const { return m_index; }
+    size_t max_transfer_size() const { return m_data_pages_per_request * PAGE_SIZE; }
+    // Namespaces share the request slots of all queues, so each of them is guaranteed to always find a free one.
+    size_t max_requests_in_flight_per_namespace() const;
+
+    // Called from the pin-based interrupt handler.
+    bool handle_completions_on_all_queues();
+
+private:
+    UNMAP_AFTER_INIT explicit NVMeController(PCI::Address address);
+    UNMAP_AFTER_INIT bool initialize_controller();
+    UNMAP_AFTER_INIT bool wait_for_ready(bool ready);
+    UNMAP_AFTER_INIT bool create_io_queues();
+    UNMAP_AFTER_INIT bool create_io_queue(u16 queue_id, u16 interrupt_vector);
+    UNMAP_AFTER_INIT void identify_namespaces(u32 namespace_count);
+    UNMAP_AFTER_INIT bool set_up_interrupts();
+
+    Optional<NVMe::Completion> submit_admin_command(NVMe::Command&);
+
+    volatile NVMe::ControllerRegisters& registers() const;
+    volatile u32* doorbell(u16 queue_id, bool completion_queue) const;
+
+    // We only ever use this many I/O queues, and give each of them this many request slots.
+    static constexpr size_t max_io_queue_count = 8;
+    static constexpr size_t request_slots_per_queue = 8;
+    static constexpr size_t max_data_pages_per_request = 8;
+    static constexpr size_t max_queue_entry_count = 64;
+    // Namespace ids start at 1, more than this many namespaces are ignored.
+    static constexpr u32 max_namespace_count = 256;
+
+    u32 m_index { 0 };
+    OwnPtr<Region> m_registers_region;
+    OwnPtr<Region> m_identify_region;
+    OwnPtr<PCI::MSIXTable> m_msix_table;
+    OwnPtr<NVMeQueue> m_admin_queue;
+    NonnullOwnPtrVector<NVMeQueue> m_io_queues;
+    NonnullOwnPtrVector<GenericInterruptHandler> m_interrupt_handlers;
+    NonnullRefPtrVector<NVMeNamespaceDevice> m_namespaces;
+    size_t m_doorbell_stride { 4 };
+    size_t m_timeout_ms { 500 };
+    size_t m_max_queue_entry_count { 2 };
+    size_t m_data_pages_per_request { max_data_pages_per_request };
+};
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+namespace Kernel::NVMe {
+
+struct [[gnu::packed]] ControllerRegisters {
+    u64 capabilities;
+    u32 version;
+    u32 interrupt_mask_set;
+    u32 interrupt_mask_clear;
+    u32 controller_configuration;
+    u32 reserved;
+    u32 controller_status;
+    u32 subsystem_reset;
+    u32 admin_queue_attributes;
+    u64 admin_submission_queue;
+    u64 admin_completion_queue;
+};
+
+static constexpr size_t doorbells_offset = 0x1000;
+
+// Controller capabilities
+static constexpr u64 cap_mqes_mask = 0xffff;
+static constexpr u64 cap_to_shift = 24;
+static constexpr u64 cap_to_mask = 0xff;
+static constexpr u64 cap_dstrd_shift = 32;
+static constexpr u64 cap_dstrd_mask = 0xf;
+static constexpr u64 cap_css_nvm = 1ull << 37;
+static constexpr u64 cap_mpsmin_shift = 48;
+static constexpr u64 cap_mpsmin_mask = 0xf;
+
+// Controller configuration
+static constexpr u32 cc_enable = 1 << 0;
+static constexpr u32 cc_shn_mask = 0x3 << 14;
+static constexpr u32 cc_shn_normal = 0x1 << 14;
+// 64 byte submission queue entries, 16 byte completion queue entries.
+static constexpr u32 cc_iosqes = 6 << 16;
+static constexpr u32 cc_iocqes = 4 << 20;
+
+// Controller status
+static constexpr u32 csts_ready = 1 << 0;
+static constexpr u32 csts_fatal = 1 << 1;
+static constexpr u32 csts_shst_mask = 0x3 << 2;
+static constexpr u32 csts_shst_complete = 0x2 << 2;
+
+enum class AdminOpcode : u8 {
+    CreateIOSubmissionQueue = 0x01,
+    CreateIOCompletionQueue = 0x05,
+    Identify = 0x06,
+    SetFeatures = 0x09,
+};
+
+enum class IOOpcode : u8 {
+    Write = 0x01,
+    Read = 0x02,
+};
+
+static constexpr u32 identify_cns_namespace = 0x0;
+static constexpr u32 identify_cns_controller = 0x1;
+static constexpr u32 feature_number_of_queues = 0x07;
+
+// Offsets into the identify data structures.
+static constexpr size_t identify_controller_mdts = 77;
+static constexpr size_t identify_controller_nn = 516;
+static constexpr size_t identify_namespace_nsze = 0;
+static constexpr size_t identify_namespace_flbas = 26;
+static constexpr size_t identify_namespace_lbaf = 128;
+
+// Create I/O queue flags, in cdw11.
+static constexpr u32 queue_physically_contiguous = 1 << 0;
+static constexpr u32 completion_queue_interrupts_enabled = 1 << 1;
+
+struct [[gnu::packed]] Command {
+    u8 opcode;
+    u8 flags;
+    u16 command_id;
+    u32 nsid;
+    u64 reserved;
+    u64 metadata;
+    u64 data_pointer[2];
+    u32 cdw10;
+    u32 cdw11;
+    u32 cdw12;
+    u32 cdw13;
+    u32 cdw14;
+    u32 cdw15;
+};
+static_assert(sizeof(Command) == 64);
+
+struct [[gnu::packed]] Completion {
+    u32 dw0;
+    u32 dw1;
+    u16 sq_head;
+    u16 sq_id;
+    u16 command_id;
+    // Bit 0 is the phase tag, the rest the status field.
+    u16 status;
+};
+static_assert(sizeof(Completion) == 16);
+
+}
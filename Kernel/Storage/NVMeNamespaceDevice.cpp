@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/StringView.h>
+#include <Kernel/Storage/NVMeController.h>
+#include <Kernel/Storage/NVMeNamespaceDevice.h>
+
+namespace Kernel {
+
+NonnullRefPtr<NVMeNamespaceDevice> NVMeNamespaceDevice::create(const NVMeController& controller, u32 nsid, size_t block_size, u64 block_count)
+{
+    return adopt_ref(*new NVMeNamespaceDevice(controller, nsid, block_size, block_count));
+}
+
+NVMeNamespaceDevice::NVMeNamespaceDevice(const NVMeController& controller, u32 nsid, size_t block_size, u64 block_count)
+    : StorageDevice(controller, block_size, block_count)
+    , m_controller(controller)
+    , m_nsid(nsid)
+{
+}
+
+NVMeNamespaceDevice::~NVMeNamespaceDevice()
+{
+}
+
+StringView NVMeNamespaceDevice::class_name() const
+{
+    return "NVMeNamespaceDevice";
+}
+
+size_t NVMeNamespaceDevice::max_request_block_count() const
+{
+    return m_controller->max_transfer_size() / block_size();
+}
+
+size_t NVMeNamespaceDevice::max_requests_in_flight() const
+{
+    return m_controller->max_requests_in_flight_per_namespace();
+}
+
+void NVMeNamespaceDevice::start_request(AsyncBlockDeviceRequest& request)
+{
+    m_controller->start_request(*this, request);
+}
+
+String NVMeNamespaceDevice::device_name() const
+{
+    return String::formatted("nvme{}n{}", m_controller->index(), m_nsid);
+}
+
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <Kernel/Storage/StorageDevice.h>
+
+namespace Kernel {
+
+class NVMeController;
+class NVMeNamespaceDevice final : public StorageDevice {
+    friend class NVMeController;
+
+public:
+    static NonnullRefPtr<NVMeNamespaceDevice> create(const NVMeController&, u32 nsid, size_t block_size, u64 block_count);
+    virtual ~NVMeNamespaceDevice() override;
+
+    u32 nsid() const { return m_nsid; }
+
+    // ^StorageDevice
+    virtual size_t max_request_block_count() const override;
+
+    // ^BlockDevice
+    virtual void start_request(AsyncBlockDeviceRequest&) override;
+    virtual String device_name() const override;
+
+    // ^Device
+    virtual size_t max_requests_in_flight() const override;
+
+private:
+    NVMeNamespaceDevice(const NVMeController&, u32 nsid, size_t block_size, u64 block_count);
+
+    // ^DiskDevice
+    virtual StringView class_name() const override;
+
+    NonnullRefPtr<NVMeController> m_controller;
+    u32 m_nsid { 0 };
+};
+
+}
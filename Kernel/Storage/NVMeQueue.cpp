@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Debug.h>
+#include <Kernel/IO.h>
+#include <Kernel/Sections.h>
+#include <Kernel/Storage/NVMeQueue.h>
+#include <Kernel/VM/MemoryManager.h>
+#include <Kernel/WorkQueue.h>
+
+namespace Kernel {
+
+UNMAP_AFTER_INIT OwnPtr<NVMeQueue> NVMeQueue::try_create(u16 queue_id, size_t entry_count, volatile u32* submission_doorbell, volatile u32* completion_doorbell, size_t request_slot_count, size_t data_pages_per_request)
+{
+    // A full submission queue is one that has a single free entry, so there have to be more entries than slots.
+    VERIFY(request_slot_count < entry_count && request_slot_count <= 32);
+    VERIFY(data_pages_per_request <= prp_list_size_per_slot / sizeof(u64) + 1);
+
+    auto queue = adopt_own_if_nonnull(new (nothrow) NVMeQueue(queue_id, entry_count, submission_doorbell, completion_doorbell));
+    if (!queue)
+        return {};
+    queue->m_submission_queue_region = MM.allocate_contiguous_kernel_region(page_round_up(entry_count * sizeof(NVMe::Command)), "NVMe Submission Queue", Region::Access::Read | Region::Access::Write);
+    queue->m_completion_queue_region = MM.allocate_contiguous_kernel_region(page_round_up(entry_count * sizeof(NVMe::Completion)), "NVMe Completion Queue", Region::Access::Read | Region::Access::Write);
+    if (!queue->m_submission_queue_region || !queue->m_completion_queue_region)
+        return {};
+    memset(queue->m_submission_queue_region->vaddr().as_ptr(), 0, queue->m_submission_queue_region->size());
+    memset(queue->m_completion_queue_region->vaddr().as_ptr(), 0, queue->m_completion_queue_region->size());
+
+    if (request_slot_count == 0)
+        return queue;
+    queue->m_prp_list_region = MM.allocate_contiguous_kernel_region(page_round_up(request_slot_count * prp_list_size_per_slot), "NVMe PRP Lists", Region::Access::Read | Region::Access::Write);
+    if (!queue->m_prp_list_region)
+        return {};
+    for (size_t slot_index = 0; slot_index < request_slot_count; slot_index++) {
+        RequestSlot slot;
+        slot.data_region = MM.allocate_kernel_region(data_pages_per_request * PAGE_SIZE, "NVMe DMA", Region::Access::Read | Region::Access::Write, AllocationStrategy::AllocateNow);
+        if (!slot.data_region)
+            return {};
+        queue->m_request_slots.append(move(slot));
+    }
+    return queue;
+}
+
+UNMAP_AFTER_INIT NVMeQueue::NVMeQueue(u16 queue_id, size_t entry_count, volatile u32* submission_doorbell, volatile u32* completion_doorbell)
+    : m_id(queue_id)
+    , m_entry_count(entry_count)
+    , m_submission_doorbell(submission_doorbell)
+    , m_completion_doorbell(completion_doorbell)
+{
+}
+
+NVMeQueue::~NVMeQueue()
+{
+}
+
+void NVMeQueue::submit(const NVMe::Command& command)
+{
+    VERIFY(m_lock.is_locked());
+    auto* entries = reinterpret_cast<NVMe::Command*>(m_submission_queue_region->vaddr().as_ptr());
+    entries[m_submission_tail] = command;
+    if (++m_submission_tail == m_entry_count)
+        m_submission_tail = 0;
+    full_memory_barrier();
+    *m_submission_doorbell = m_submission_tail;
+}
+
+template<typename Callback>
+void NVMeQueue::reap_completions(Callback callback)
+{
+    VERIFY(m_lock.is_locked());
+    auto* entries = reinterpret_cast<volatile NVMe::Completion*>(m_completion_queue_region->vaddr().as_ptr());
+    bool reaped_any = false;
+    for (;;) {
+        auto& entry = entries[m_completion_head];
+        u16 status = entry.status;
+        // The controller flips the phase tag every time it wraps around, so stale entries still have the old one.
+        if ((status & 1) != m_completion_phase)
+            break;
+        full_memory_barrier();
+        NVMe::Completion completion {};
+        completion.dw0 = entry.dw0;
+        completion.sq_head = entry.sq_head;
+        completion.sq_id = entry.sq_id;
+        completion.command_id = entry.command_id;
+        completion.status = status;
+        if (++m_completion_head == m_entry_count) {
+            m_completion_head = 0;
+            m_completion_phase ^= 1;
+        }
+        reaped_any = true;
+        callback(completion);
+    }
+    if (reaped_any)
+        *m_completion_doorbell = m_completion_head;
+}
+
+UNMAP_AFTER_INIT Optional<NVMe::Completion> NVMeQueue::submit_and_wait(NVMe::Command& command, size_t timeout_ms)
+{
+    ScopedSpinLock lock(m_lock);
+    command.command_id = m_next_command_id++;
+    submit(command);
+
+    Optional<NVMe::Completion> result;
+    for (size_t elapsed_us = 0; elapsed_us < timeout_ms * 1000; elapsed_us += 10) {
+        reap_completions([&](const NVMe::Completion& completion) {
+            if (completion.command_id == command.command_id)
+                result = completion;
+        });
+        if (result.has_value())
+            return result;
+        IO::delay(10);
+    }
+    dbgln("NVMeQueue {}: Timed out waiting for command {:#02x}", m_id, command.opcode);
+    return {};
+}
+
+bool NVMeQueue::try_start_request(u32 nsid, size_t block_size, AsyncBlockDeviceRequest& request)
+{
+    Optional<u8> slot_index;
+    {
+        ScopedSpinLock lock(m_lock);
+        for (size_t index = 0; index < m_request_slots.size(); index++) {
+            if (m_allocated_request_slots & (1u << index))
+                continue;
+            m_allocated_request_slots |= 1u << index;
+            slot_index = index;
+            break;
+        }
+    }
+    if (!slot_index.has_value())
+        return false;
+    dbgln_if(NVME_DEBUG, "NVMeQueue {}: Request start in slot {}, namespace {}, block {}, count {}", m_id, slot_index.value(), nsid, request.block_index(), request.block_count());
+
+    auto& slot = m_request_slots[slot_index.value()];
+    VERIFY(!slot.request);
+    slot.request = request;
+    slot.transfer_size = request.block_count() * block_size;
+    VERIFY(slot.transfer_size <= slot.data_region->size());
+    slot.is_direct = can_transfer_directly(request, slot.transfer_size);
+
+    if (request.request_type() == AsyncBlockDeviceRequest::Write) {
+        if (!request.read_from_buffer(request.buffer(), slot.data_region->vaddr().as_ptr(), slot.transfer_size)) {
+            complete_request(slot_index.value(), AsyncDeviceRequest::MemoryFault);
+            return true;
+        }
+    }
+
+    NVMe::Command command {};
+    command.opcode = static_cast<u8>(request.request_type() == AsyncBlockDeviceRequest::Write ? NVMe::IOOpcode::Write : NVMe::IOOpcode::Read);
+    command.command_id = slot_index.value();
+    command.nsid = nsid;
+    command.cdw10 = request.block_index() & 0xffffffff;
+    command.cdw11 = request.block_index() >> 32;
+    command.cdw12 = request.block_count() - 1;
+
+    // The first page goes into PRP1, which may point into the middle of it. The second one goes
+    // into PRP2 as well, anything longer needs a list of all the pages after the first one.
+    auto page_address = [&](size_t page_index) {
+        if (slot.is_direct)
+            return request.direct_scatter_list()->entries()[page_index].address.get();
+        return slot.data_region->physical_page(page_index)->paddr().get();
+    };
+    size_t page_count = slot.is_direct ? request.direct_scatter_list()->entries().size() : page_round_up(slot.transfer_size) / PAGE_SIZE;
+    command.data_pointer[0] = page_address(0);
+    if (page_count == 2) {
+        command.data_pointer[1] = page_address(1);
+    } else if (page_count > 2) {
+        size_t prp_list_offset = slot_index.value() * prp_list_size_per_slot;
+        auto* prp_list = reinterpret_cast<u64*>(m_prp_list_region->vaddr().offset(prp_list_offset).as_ptr());
+        for (size_t page_index = 1; page_index < page_count; page_index++)
+            prp_list[page_index - 1] = page_address(page_index);
+        command.data_pointer[1] = m_prp_list_region->physical_page(prp_list_offset / PAGE_SIZE)->paddr().offset(prp_list_offset % PAGE_SIZE).get();
+    }
+
+    ScopedSpinLock lock(m_lock);
+    submit(command);
+    return true;
+}
+
+bool NVMeQueue::can_transfer_directly(const AsyncBlockDeviceRequest& request, size_t transfer_size) const
+{
+    auto& scatter_list = request.direct_scatter_list();
+    if (!scatter_list || request.request_type() != AsyncBlockDeviceRequest::Read)
+        return false;
+    auto& entries = scatter_list->entries();
+    // Only PRP1 may have an offset into its page, and it has to be dword aligned.
+    if (entries.is_empty() || entries.size() > prp_list_size_per_slot / sizeof(u64) + 1 || entries[0].address.get() % 4 != 0)
+        return false;
+    size_t total_size = 0;
+    for (auto& entry : entries)
+        total_size += entry.size;
+    return total_size == transfer_size;
+}
+
+bool NVMeQueue::handle_completions()
+{
+    u32 finished_slots = 0;
+    {
+        ScopedSpinLock lock(m_lock);
+        reap_completions([&](const NVMe::Completion& completion) {
+            auto slot_index = completion.command_id;
+            if (slot_index >= m_request_slots.size() || !(m_allocated_request_slots & (1u << slot_index))) {
+                dbgln("NVMeQueue {}: Completion for unknown command {}", m_id, slot_index);
+                return;
+            }
+            m_request_slots[slot_index].status = completion.status >> 1;
+            finished_slots |= 1u << slot_index;
+        });
+    }
+    if (finished_slots == 0)
+        return false;
+
+    // Copying the data into the request's buffer could page fault, so that has to wait until we leave the IRQ handler.
+    g_io_work->queue([this, finished_slots]() {
+        complete_finished_requests(finished_slots);
+    });
+    return true;
+}
+
+void NVMeQueue::complete_finished_requests(u32 finished_slots)
+{
+    for (size_t slot_index = 0; slot_index < m_request_slots.size(); slot_index++) {
+        if (!(finished_slots & (1u << slot_index)))
+            continue;
+        auto& slot = m_request_slots[slot_index];
+        VERIFY(slot.request);
+        if (slot.status != 0) {
+            dbgln_if(NVME_DEBUG, "NVMeQueue {}: Request in slot {} failed with status {:#04x}", m_id, slot_index, slot.status);
+            complete_request(slot_index, AsyncDeviceRequest::Failure);
+            continue;
+        }
+        auto& request = *slot.request;
+        if (request.request_type() == AsyncBlockDeviceRequest::Read && !slot.is_direct) {
+            if (!request.write_to_buffer(request.buffer(), slot.data_region->vaddr().as_ptr(), slot.transfer_size)) {
+                complete_request(slot_index, AsyncDeviceRequest::MemoryFault);
+                continue;
+            }
+        }
+        complete_request(slot_index, AsyncDeviceRequest::Success);
+    }
+}
+
+void NVMeQueue::complete_request(u8 slot_index, AsyncDeviceRequest::RequestResult result)
+{
+    auto& slot = m_request_slots[slot_index];
+    VERIFY(slot.request);
+    auto request = move(slot.request);
+    {
+        ScopedSpinLock lock(m_lock);
+        m_allocated_request_slots &= ~(1u << slot_index);
+    }
+    // This may start the next request right away, possibly in the slot we just gave up.
+    request->complete(result);
+}
+
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/OwnPtr.h>
+#include <AK/RefPtr.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+#include <Kernel/Devices/BlockDevice.h>
+#include <Kernel/SpinLock.h>
+#include <Kernel/Storage/NVMeDefinitions.h>
+#include <Kernel/VM/ScatterGatherList.h>
+#include <Kernel/VM/Region.h>
+
+namespace Kernel {
+
+// A submission queue together with the completion queue its commands complete on.
+// The admin queue has no request slots, its commands are submitted one at a time and polled for.
+// I/O queues bounce the data of every request through the buffer of one of their request slots,
+// unless it can be read straight into the pages of the user buffer, and use the slot index as the command id.
+class NVMeQueue {
+    AK_MAKE_NONCOPYABLE(NVMeQueue);
+    AK_MAKE_NONMOVABLE(NVMeQueue);
+
+public:
+    static OwnPtr<NVMeQueue> try_create(u16 queue_id, size_t entry_count, volatile u32* submission_doorbell, volatile u32* completion_doorbell, size_t request_slot_count = 0, size_t data_pages_per_request = 0);
+    ~NVMeQueue();
+
+    u16 id() const { return m_id; }
+    size_t entry_count() const { return m_entry_count; }
+    size_t request_slot_count() const { return m_request_slots.size(); }
+    PhysicalAddress submission_queue_address() const { return m_submission_queue_region->physical_page(0)->paddr(); }
+    PhysicalAddress completion_queue_address() const { return m_completion_queue_region->physical_page(0)->paddr(); }
+
+    // Returns the completion entry, or nothing if the controller didn't answer in time.
+    Optional<NVMe::Completion> submit_and_wait(NVMe::Command&, size_t timeout_ms);
+
+    // Returns false if all request slots are taken. Otherwise the request is completed once the controller is done with it.
+    bool try_start_request(u32 nsid, size_t block_size, AsyncBlockDeviceRequest&);
+
+    // Called from the IRQ handler, returns whether any of our commands completed.
+    bool handle_completions();
+
+private:
+    struct RequestSlot {
+        OwnPtr<Region> data_region;
+        RefPtr<AsyncBlockDeviceRequest> request;
+        size_t transfer_size { 0 };
+        // The controller transfers straight into the pages of the request's direct scatter list.
+        bool is_direct { false };
+        u16 status { 0 };
+    };
+
+    // Every slot gets this much room for its PRP list in the queue's PRP list page.
+    static constexpr size_t prp_list_size_per_slot = 64;
+
+    NVMeQueue(u16 queue_id, size_t entry_count, volatile u32* submission_doorbell, volatile u32* completion_doorbell);
+
+    void submit(const NVMe::Command&);
+    bool can_transfer_directly(const AsyncBlockDeviceRequest&, size_t transfer_size) const;
+    template<typename Callback>
+    void reap_completions(Callback);
+
+    void complete_finished_requests(u32 finished_slots);
+    void complete_request(u8 slot_index, AsyncDeviceRequest::RequestResult);
+
+    u16 m_id { 0 };
+    size_t m_entry_count { 0 };
+    volatile u32* m_submission_doorbell { nullptr };
+    volatile u32* m_completion_doorbell { nullptr };
+    OwnPtr<Region> m_submission_queue_region;
+    OwnPtr<Region> m_completion_queue_region;
+    OwnPtr<Region> m_prp_list_region;
+    Vector<RequestSlot> m_request_slots;
+
+    SpinLock<u8> m_lock;
+    // Everything below is guarded by m_lock.
+    u32 m_allocated_request_slots { 0 };
+    u16 m_submission_tail { 0 };
+    u16 m_completion_head { 0 };
+    u16 m_completion_phase { 1 };
+    u16 m_next_command_id { 0 };
+};
+
+}
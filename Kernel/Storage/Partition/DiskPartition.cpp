@@ -7,6 +7,7 @@
 #include <Kernel/Debug.h>
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/Storage/Partition/DiskPartition.h>
+#include <Kernel/VM/ScatterGatherList.h>
 
 namespace Kernel {
 
@@ -34,7 +35,7 @@ const DiskPartitionMetadata& DiskPartition::metadata() const
 void DiskPartition::start_request(AsyncBlockDeviceRequest& request)
 {
     request.add_sub_request(m_device->make_request<AsyncBlockDeviceRequest>(request.request_type(),
-        request.block_index() + m_metadata.start_block(), request.block_count(), request.buffer(), request.buffer_size()));
+        request.block_index() + m_metadata.start_block(), request.block_count(), request.buffer(), request.buffer_size(), request.direct_scatter_list()));
 }
 
 KResultOr<size_t> DiskPartition::read(FileDescription& fd, u64 offset, UserOrKernelBuffer& outbuf, size_t len)
@@ -18,6 +18,8 @@ public:
     virtual ~DiskPartition();
 
     virtual void start_request(AsyncBlockDeviceRequest&) override;
+    // Requests are passed on right away, so they only queue up (and get scheduled) on the device itself.
+    virtual size_t max_requests_in_flight() const override { return NumericLimits<size_t>::max(); }
 
     // ^BlockDevice
     virtual KResultOr<size_t> read(FileDescription&, u64, UserOrKernelBuffer&, size_t) override;
@@ -32,6 +32,16 @@ StringView SATADiskDevice::class_name() const
     return "SATADiskDevice";
 }
 
+size_t SATADiskDevice::max_request_block_count() const
+{
+    return m_port->max_request_block_count();
+}
+
+size_t SATADiskDevice::max_requests_in_flight() const
+{
+    return m_port->max_requests_in_flight();
+}
+
 void SATADiskDevice::start_request(AsyncBlockDeviceRequest& request)
 {
     m_port->start_request(request);
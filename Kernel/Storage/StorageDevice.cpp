@@ -10,6 +10,7 @@
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/Storage/StorageDevice.h>
 #include <Kernel/Storage/StorageManagement.h>
+#include <Kernel/VM/ScatterGatherList.h>
 
 namespace Kernel {
 
@@ -39,23 +40,25 @@ NonnullRefPtr<StorageController> StorageDevice::controller() const
 
 KResultOr<size_t> StorageDevice::read(FileDescription&, u64 offset, UserOrKernelBuffer& outbuf, size_t len)
 {
-    unsigned index = offset / block_size();
-    u16 whole_blocks = len / block_size();
+    u64 index = offset / block_size();
+    size_t whole_blocks = len / block_size();
     size_t remaining = len % block_size();
 
-    unsigned blocks_per_page = PAGE_SIZE / block_size();
-
-    // PATAChannel will chuck a wobbly if we try to read more than PAGE_SIZE
-    // at a time, because it uses a single page for its DMA buffer.
-    if (whole_blocks >= blocks_per_page) {
-        whole_blocks = blocks_per_page;
+    // Controllers can only transfer so much at once (PATA uses a single page for its DMA buffer),
+    // so larger requests end up as short reads and writes.
+    if (whole_blocks >= max_request_block_count()) {
+        whole_blocks = max_request_block_count();
         remaining = 0;
     }
 
     dbgln_if(STORAGE_DEVICE_DEBUG, "StorageDevice::read() index={}, whole_blocks={}, remaining={}", index, whole_blocks, remaining);
 
     if (whole_blocks > 0) {
-        auto read_request = make_request<AsyncBlockDeviceRequest>(AsyncBlockDeviceRequest::Read, index, whole_blocks, outbuf, whole_blocks * block_size());
+        // User buffers only get here for O_DIRECT and raw device reads, the controller may be able to DMA right into them.
+        RefPtr<UserScatterGatherList> direct_scatter_list;
+        if (!outbuf.is_kernel_buffer())
+            direct_scatter_list = UserScatterGatherList::try_create_for_device_read(outbuf, whole_blocks * block_size());
+        auto read_request = make_request<AsyncBlockDeviceRequest>(AsyncBlockDeviceRequest::Read, index, whole_blocks, outbuf, whole_blocks * block_size(), move(direct_scatter_list));
         auto result = read_request->wait();
         if (result.wait_result().was_interrupted())
             return EINTR;
@@ -104,16 +107,14 @@ bool StorageDevice::can_read(const FileDescription&, size_t offset) const
 
 KResultOr<size_t> StorageDevice::write(FileDescription&, u64 offset, const UserOrKernelBuffer& inbuf, size_t len)
 {
-    unsigned index = offset / block_size();
-    u16 whole_blocks = len / block_size();
+    u64 index = offset / block_size();
+    size_t whole_blocks = len / block_size();
     size_t remaining = len % block_size();
 
-    unsigned blocks_per_page = PAGE_SIZE / block_size();
-
-    // PATAChannel will chuck a wobbly if we try to write more than PAGE_SIZE
-    // at a time, because it uses a single page for its DMA buffer.
-    if (whole_blocks >= blocks_per_page) {
-        whole_blocks = blocks_per_page;
+    // Controllers can only transfer so much at once (PATA uses a single page for its DMA buffer),
+    // so larger requests end up as short reads and writes.
+    if (whole_blocks >= max_request_block_count()) {
+        whole_blocks = max_request_block_count();
         remaining = 0;
     }
 
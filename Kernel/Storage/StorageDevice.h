@@ -23,6 +23,9 @@ public:
 
     NonnullRefPtr<StorageController> controller() const;
 
+    // The most blocks a single AsyncBlockDeviceRequest to this device may ask for.
+    virtual size_t max_request_block_count() const { return PAGE_SIZE / block_size(); }
+
     // ^BlockDevice
     virtual KResultOr<size_t> read(FileDescription&, u64, UserOrKernelBuffer&, size_t) override;
     virtual bool can_read(const FileDescription&, size_t) const override;
@@ -12,10 +12,12 @@
 #include <Kernel/Panic.h>
 #include <Kernel/Storage/AHCIController.h>
 #include <Kernel/Storage/IDEController.h>
+#include <Kernel/Storage/NVMeController.h>
 #include <Kernel/Storage/Partition/EBRPartitionTable.h>
 #include <Kernel/Storage/Partition/GUIDPartitionTable.h>
 #include <Kernel/Storage/Partition/MBRPartitionTable.h>
 #include <Kernel/Storage/RamdiskController.h>
+#include <Kernel/Storage/VirtIOBlockController.h>
 #include <Kernel/Storage/StorageManagement.h>
 
 namespace Kernel {
@@ -57,7 +59,12 @@ UNMAP_AFTER_INIT NonnullRefPtrVector<StorageController> StorageManagement::enume
             if (PCI::get_class(address) == 0x1 && PCI::get_subclass(address) == 0x6 && PCI::get_programming_interface(address) == 0x1) {
                 controllers.append(AHCIController::initialize(address));
             }
+            if (PCI::get_class(address) == 0x1 && PCI::get_subclass(address) == 0x8 && PCI::get_programming_interface(address) == 0x2) {
+                controllers.append(NVMeController::initialize(address));
+            }
         });
+        if (!kernel_command_line().disable_virtio())
+            controllers.append(VirtIOBlockController::initialize());
     }
     controllers.append(RamdiskController::initialize());
     return controllers;
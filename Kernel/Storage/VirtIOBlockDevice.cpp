@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Debug.h>
+#include <Kernel/Sections.h>
+#include <Kernel/Storage/VirtIOBlockController.h>
+#include <Kernel/Storage/VirtIOBlockDevice.h>
+#include <Kernel/WorkQueue.h>
+
+namespace Kernel {
+
+#define REQUESTQ 0
+
+UNMAP_AFTER_INIT RefPtr<VirtIOBlockDevice> VirtIOBlockDevice::try_create(const VirtIOBlockController& controller, PCI::Address address)
+{
+    auto device = adopt_ref(*new VirtIOBlockDevice(controller, address));
+    if (!device->is_operational()) {
+        // The device has already registered itself (and its IRQ handler), so we can't get rid of it anymore.
+        dmesgln("VirtIOBlockDevice: Failed to initialize device @ {}", address);
+        [[maybe_unused]] auto& unused = device.leak_ref();
+        return {};
+    }
+    return device;
+}
+
+UNMAP_AFTER_INIT VirtIOBlockDevice::VirtIOBlockDevice(const VirtIOBlockController& controller, PCI::Address address)
+    : StorageDevice(controller, sector_size, 0)
+    , VirtIODevice(address, "VirtIOBlockDevice")
+{
+    m_is_operational = initialize();
+}
+
+VirtIOBlockDevice::~VirtIOBlockDevice()
+{
+}
+
+UNMAP_AFTER_INIT bool VirtIOBlockDevice::initialize()
+{
+    auto* cfg = get_config(ConfigurationType::Device);
+    if (!cfg) {
+        dbgln("VirtIOBlockDevice: Legacy devices are not supported");
+        return false;
+    }
+
+    bool success = negotiate_features([&](u64 supported_features) {
+        u64 negotiated = 0;
+        if (is_feature_set(supported_features, VIRTIO_F_INDIRECT_DESC))
+            negotiated |= VIRTIO_F_INDIRECT_DESC;
+        if (is_feature_set(supported_features, VIRTIO_BLK_F_SIZE_MAX))
+            negotiated |= VIRTIO_BLK_F_SIZE_MAX;
+        if (is_feature_set(supported_features, VIRTIO_BLK_F_SEG_MAX))
+            negotiated |= VIRTIO_BLK_F_SEG_MAX;
+        if (is_feature_set(supported_features, VIRTIO_BLK_F_RO))
+            negotiated |= VIRTIO_BLK_F_RO;
+        return negotiated;
+    });
+    if (!success)
+        return false;
+
+    u32 size_max = 0;
+    u32 seg_max = 0;
+    read_config_atomic([&]() {
+        m_capacity = config_read32(*cfg, 0x0) | ((u64)config_read32(*cfg, 0x4) << 32);
+        if (is_feature_accepted(VIRTIO_BLK_F_SIZE_MAX))
+            size_max = config_read32(*cfg, 0x8);
+        if (is_feature_accepted(VIRTIO_BLK_F_SEG_MAX))
+            seg_max = config_read32(*cfg, 0xc);
+    });
+    // Every data page gets a descriptor of its own.
+    if (size_max != 0 && size_max < PAGE_SIZE) {
+        dbgln("VirtIOBlockDevice: Maximum segment size of {} bytes is not supported", size_max);
+        return false;
+    }
+    if (seg_max != 0)
+        m_data_pages_per_request = min(m_data_pages_per_request, static_cast<size_t>(seg_max));
+    m_is_read_only = is_feature_accepted(VIRTIO_BLK_F_RO);
+    m_uses_indirect_descriptors = is_feature_accepted(VIRTIO_F_INDIRECT_DESC);
+
+    if (!setup_queues(1))
+        return false;
+    finish_init();
+
+    // A request takes a descriptor for its header, one for its status and one per data page.
+    // With indirect descriptors those live in the request's own table, and only a single
+    // descriptor of the queue is used up per request.
+    auto queue_size = static_cast<size_t>(get_queue(REQUESTQ).size());
+    if (queue_size < 3)
+        return false;
+    m_data_pages_per_request = min(m_data_pages_per_request, queue_size - 2);
+    size_t slot_count = max_request_slot_count;
+    if (m_uses_indirect_descriptors)
+        slot_count = min(slot_count, queue_size);
+    else
+        slot_count = min(slot_count, queue_size / (m_data_pages_per_request + 2));
+    while (m_request_slots.size() < slot_count && try_to_add_request_slot())
+        ;
+    if (m_request_slots.is_empty())
+        return false;
+
+    dmesgln("VirtIOBlockDevice: {} sectors{}, {} requests in flight of up to {} KiB, {}indirect descriptors", m_capacity, m_is_read_only ? " (read-only)" : "", m_request_slots.size(), m_data_pages_per_request * PAGE_SIZE / KiB, m_uses_indirect_descriptors ? "" : "no ");
+    return true;
+}
+
+UNMAP_AFTER_INIT bool VirtIOBlockDevice::try_to_add_request_slot()
+{
+    RequestSlot slot;
+    slot.control_region = MM.allocate_kernel_region(PAGE_SIZE, "VirtIOBlockDevice Request", Region::Access::Read | Region::Access::Write, AllocationStrategy::AllocateNow);
+    slot.data_region = MM.allocate_kernel_region(m_data_pages_per_request * PAGE_SIZE, "VirtIOBlockDevice DMA", Region::Access::Read | Region::Access::Write, AllocationStrategy::AllocateNow);
+    if (!slot.control_region || !slot.data_region)
+        return false;
+    slot.control_address = slot.control_region->physical_page(0)->paddr();
+    m_request_slots.append(move(slot));
+    return true;
+}
+
+size_t VirtIOBlockDevice::max_request_block_count() const
+{
+    return m_data_pages_per_request * PAGE_SIZE / block_size();
+}
+
+String VirtIOBlockDevice::device_name() const
+{
+    return String::formatted("vd{:c}", 'a' + minor());
+}
+
+bool VirtIOBlockDevice::handle_device_config_change()
+{
+    // FIXME: Handle the disk being resized.
+    dbgln("VirtIOBlockDevice: Handle device config change");
+    return true;
+}
+
+void VirtIOBlockDevice::start_request(AsyncBlockDeviceRequest& request)
+{
+    if (!m_is_operational || (m_is_read_only && request.request_type() == AsyncBlockDeviceRequest::Write)) {
+        request.complete(AsyncDeviceRequest::Failure);
+        return;
+    }
+    VERIFY(request.block_count() > 0 && request.block_count() <= max_request_block_count());
+
+    // The device never hands us more than max_requests_in_flight() requests at a time.
+    Optional<u8> slot_index;
+    {
+        ScopedSpinLock lock(get_queue(REQUESTQ).lock());
+        for (size_t index = 0; index < m_request_slots.size(); index++) {
+            if (m_allocated_request_slots & (1u << index))
+                continue;
+            m_allocated_request_slots |= 1u << index;
+            slot_index = index;
+            break;
+        }
+    }
+    VERIFY(slot_index.has_value());
+    dbgln_if(VIRTIO_DEBUG, "VirtIOBlockDevice: Request start in slot {}, block {}, count {}", slot_index.value(), request.block_index(), request.block_count());
+
+    auto& slot = m_request_slots[slot_index.value()];
+    VERIFY(!slot.request);
+    slot.request = request;
+
+    if (request.request_type() == AsyncBlockDeviceRequest::Write) {
+        if (!request.read_from_buffer(request.buffer(), slot.data_region->vaddr().as_ptr(), request.block_count() * block_size())) {
+            complete_request(slot_index.value(), AsyncDeviceRequest::MemoryFault);
+            return;
+        }
+    }
+    submit_request(slot_index.value());
+}
+
+void VirtIOBlockDevice::submit_request(u8 slot_index)
+{
+    auto& slot = m_request_slots[slot_index];
+    auto& request = *slot.request;
+    auto* control = slot.control_region->vaddr().as_ptr();
+
+    auto& header = *reinterpret_cast<RequestHeader*>(control + request_header_offset);
+    header.type = static_cast<u32>(request.request_type() == AsyncBlockDeviceRequest::Write ? RequestType::Out : RequestType::In);
+    header.reserved = 0;
+    header.sector = request.block_index();
+    control[request_status_offset] = 0xff;
+
+    auto data_buffer_type = request.request_type() == AsyncBlockDeviceRequest::Write ? BufferType::DeviceReadable : BufferType::DeviceWritable;
+    size_t data_size = request.block_count() * block_size();
+
+    auto& queue = get_queue(REQUESTQ);
+    ScopedSpinLock lock(queue.lock());
+    VirtIOQueueChain chain(queue);
+    bool success = true;
+    if (m_uses_indirect_descriptors) {
+        auto* table = reinterpret_cast<VirtIOQueue::VirtIOQueueDescriptor*>(control + descriptor_table_offset);
+        size_t descriptor_count = 0;
+        auto add_descriptor = [&](PhysicalAddress address, size_t length, BufferType buffer_type) {
+            table[descriptor_count].address = address.get();
+            table[descriptor_count].length = length;
+            table[descriptor_count].flags = static_cast<u16>(buffer_type) | VIRTQ_DESC_F_NEXT;
+            table[descriptor_count].next = descriptor_count + 1;
+            ++descriptor_count;
+        };
+        add_descriptor(slot.control_address.offset(request_header_offset), sizeof(RequestHeader), BufferType::DeviceReadable);
+        for (size_t offset = 0; offset < data_size; offset += PAGE_SIZE)
+            add_descriptor(slot.data_region->physical_page(offset / PAGE_SIZE)->paddr(), min(data_size - offset, PAGE_SIZE), data_buffer_type);
+        add_descriptor(slot.control_address.offset(request_status_offset), 1, BufferType::DeviceWritable);
+        table[descriptor_count - 1].flags &= ~VIRTQ_DESC_F_NEXT;
+        success = chain.add_indirect_descriptor_table_to_chain(slot.control_address.offset(descriptor_table_offset), descriptor_count);
+    } else {
+        success = chain.add_buffer_to_chain(slot.control_address.offset(request_header_offset), sizeof(RequestHeader), BufferType::DeviceReadable);
+        for (size_t offset = 0; success && offset < data_size; offset += PAGE_SIZE)
+            success = chain.add_buffer_to_chain(slot.data_region->physical_page(offset / PAGE_SIZE)->paddr(), min(data_size - offset, PAGE_SIZE), data_buffer_type);
+        if (success)
+            success = chain.add_buffer_to_chain(slot.control_address.offset(request_status_offset), 1, BufferType::DeviceWritable);
+    }
+    // The number of request slots was chosen so that the queue can't run out of descriptors.
+    VERIFY(success);
+    supply_chain_and_notify(REQUESTQ, chain);
+}
+
+Optional<u8> VirtIOBlockDevice::find_slot_by_control_page(PhysicalAddress address) const
+{
+    for (size_t index = 0; index < m_request_slots.size(); index++) {
+        if (m_request_slots[index].control_address == address.page_base())
+            return index;
+    }
+    return {};
+}
+
+void VirtIOBlockDevice::handle_queue_update(u16 queue_index)
+{
+    VERIFY(queue_index == REQUESTQ);
+    auto& queue = get_queue(REQUESTQ);
+    u32 finished_slots = 0;
+    {
+        ScopedSpinLock lock(queue.lock());
+        size_t used;
+        for (auto chain = queue.pop_used_buffer_chain(used); !chain.is_empty(); chain = queue.pop_used_buffer_chain(used)) {
+            // Both the request header and the indirect descriptor table live in the request's control page.
+            Optional<PhysicalAddress> first_address;
+            chain.for_each([&](PhysicalAddress address, size_t) {
+                if (!first_address.has_value())
+                    first_address = address;
+            });
+            VERIFY(first_address.has_value());
+            auto slot_index = find_slot_by_control_page(first_address.value());
+            VERIFY(slot_index.has_value());
+            finished_slots |= 1u << slot_index.value();
+            chain.release_buffer_slots_to_queue();
+        }
+    }
+    if (finished_slots == 0)
+        return;
+
+    // Copying the data into the request's buffer could page fault, so that has to wait until we leave the IRQ handler.
+    g_io_work->queue([this, finished_slots]() {
+        complete_finished_requests(finished_slots);
+    });
+}
+
+void VirtIOBlockDevice::complete_finished_requests(u32 finished_slots)
+{
+    for (size_t slot_index = 0; slot_index < m_request_slots.size(); slot_index++) {
+        if (!(finished_slots & (1u << slot_index)))
+            continue;
+        auto& slot = m_request_slots[slot_index];
+        VERIFY(slot.request);
+        auto& request = *slot.request;
+        auto status = static_cast<RequestStatus>(slot.control_region->vaddr().as_ptr()[request_status_offset]);
+        if (status != RequestStatus::Ok) {
+            dbgln_if(VIRTIO_DEBUG, "VirtIOBlockDevice: Request in slot {} failed with status {}", slot_index, static_cast<u8>(status));
+            complete_request(slot_index, AsyncDeviceRequest::Failure);
+            continue;
+        }
+        if (request.request_type() == AsyncBlockDeviceRequest::Read) {
+            if (!request.write_to_buffer(request.buffer(), slot.data_region->vaddr().as_ptr(), request.block_count() * block_size())) {
+                complete_request(slot_index, AsyncDeviceRequest::MemoryFault);
+                continue;
+            }
+        }
+        complete_request(slot_index, AsyncDeviceRequest::Success);
+    }
+}
+
+void VirtIOBlockDevice::complete_request(u8 slot_index, AsyncDeviceRequest::RequestResult result)
+{
+    auto& slot = m_request_slots[slot_index];
+    VERIFY(slot.request);
+    auto request = move(slot.request);
+    {
+        ScopedSpinLock lock(get_queue(REQUESTQ).lock());
+        m_allocated_request_slots &= ~(1u << slot_index);
+    }
+    // This may start the next request right away, possibly in the slot we just gave up.
+    request->complete(result);
+}
+
+}
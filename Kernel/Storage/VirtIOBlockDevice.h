@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <Kernel/Storage/StorageDevice.h>
+#include <Kernel/VirtIO/VirtIO.h>
+
+namespace Kernel {
+
+#define VIRTIO_BLK_F_SIZE_MAX (1 << 1)
+#define VIRTIO_BLK_F_SEG_MAX (1 << 2)
+#define VIRTIO_BLK_F_RO (1 << 5)
+
+class VirtIOBlockController;
+
+class VirtIOBlockDevice final : public StorageDevice
+    , public VirtIODevice {
+public:
+    static RefPtr<VirtIOBlockDevice> try_create(const VirtIOBlockController&, PCI::Address);
+    virtual ~VirtIOBlockDevice() override;
+
+    bool is_operational() const { return m_is_operational; }
+
+    // ^StorageDevice
+    virtual u64 max_addressable_block() const override { return m_capacity; }
+    virtual size_t max_request_block_count() const override;
+
+    // ^BlockDevice
+    virtual void start_request(AsyncBlockDeviceRequest&) override;
+
+    // ^Device
+    virtual String device_name() const override;
+    virtual size_t max_requests_in_flight() const override { return m_request_slots.size(); }
+
+    // ^IRQHandler
+    virtual StringView purpose() const override { return "VirtIOBlockDevice"; }
+
+private:
+    VirtIOBlockDevice(const VirtIOBlockController&, PCI::Address);
+
+    // ^StorageDevice
+    virtual StringView class_name() const override { return "VirtIOBlockDevice"; }
+
+    // ^VirtIODevice
+    virtual bool handle_device_config_change() override;
+    virtual void handle_queue_update(u16 queue_index) override;
+
+    bool initialize();
+    bool try_to_add_request_slot();
+
+    enum class RequestType : u32 {
+        In = 0,
+        Out = 1,
+    };
+
+    enum class RequestStatus : u8 {
+        Ok = 0,
+        IOError = 1,
+        Unsupported = 2,
+    };
+
+    struct [[gnu::packed]] RequestHeader {
+        u32 type;
+        u32 reserved;
+        u64 sector;
+    };
+
+    // Every request gets a page for its descriptor table, header and status byte, plus its own data buffer.
+    struct RequestSlot {
+        OwnPtr<Region> control_region;
+        PhysicalAddress control_address;
+        OwnPtr<Region> data_region;
+        RefPtr<AsyncBlockDeviceRequest> request;
+    };
+
+    static constexpr size_t max_request_slot_count = 16;
+    static constexpr size_t max_data_pages_per_request = 16;
+    static constexpr size_t descriptor_table_offset = 0;
+    static constexpr size_t request_header_offset = 512;
+    static constexpr size_t request_status_offset = request_header_offset + sizeof(RequestHeader);
+
+    void submit_request(u8 slot_index);
+    void complete_request(u8 slot_index, AsyncDeviceRequest::RequestResult);
+    void complete_finished_requests(u32 finished_slots);
+    Optional<u8> find_slot_by_control_page(PhysicalAddress) const;
+
+    // VirtIO always addresses the disk in 512 byte sectors, so that's what our blocks are too.
+    static constexpr size_t sector_size = 512;
+
+    Vector<RequestSlot> m_request_slots;
+    // Guarded by the request queue's lock.
+    u32 m_allocated_request_slots { 0 };
+    u64 m_capacity { 0 };
+    size_t m_data_pages_per_request { max_data_pages_per_request };
+    bool m_uses_indirect_descriptors { false };
+    bool m_is_read_only { false };
+    bool m_is_operational { false };
+};
+
+}
@@ -11,6 +11,7 @@
 #include <Kernel/Process.h>
 #include <Kernel/Sections.h>
 #include <Kernel/ThreadTracer.h>
+#include <Kernel/Tracepoints.h>
 #include <Kernel/VM/MemoryManager.h>
 
 namespace Kernel {
@@ -210,6 +211,7 @@ NEVER_INLINE void syscall_handler(TrapFrame* trap)
     FlatPtr arg4;
     regs.capture_syscall_params(function, arg1, arg2, arg3, arg4);
 
+    TRACEPOINT(SyscallEnter, function, arg1);
     auto result = Syscall::handle(regs, function, arg1, arg2, arg3, arg4);
 
     if (result.is_error()) {
@@ -217,6 +219,7 @@ NEVER_INLINE void syscall_handler(TrapFrame* trap)
     } else {
         regs.set_return_reg(result.value());
     }
+    TRACEPOINT(SyscallExit, function, result.is_error() ? result.error().error() : result.value());
 
     if (auto tracer = process.tracer(); tracer && tracer->is_tracing_syscalls()) {
         tracer->set_trace_syscalls(false);
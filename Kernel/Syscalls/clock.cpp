@@ -25,6 +25,21 @@ KResultOr<FlatPtr> Process::sys$clock_gettime(clockid_t clock_id, Userspace<time
     return 0;
 }
 
+KResultOr<FlatPtr> Process::sys$map_time_page()
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
+    REQUIRE_PROMISE(stdio);
+
+    auto range = space().page_directory().range_allocator().allocate_randomized(PAGE_SIZE, PAGE_SIZE);
+    if (!range.has_value())
+        return ENOMEM;
+
+    auto region_or_error = space().allocate_region_with_vmobject(range.value(), TimeManagement::the().time_page_vmobject(), 0, "Kernel time page", PROT_READ, true);
+    if (region_or_error.is_error())
+        return region_or_error.error().error();
+    return region_or_error.value()->vaddr().get();
+}
+
 KResultOr<FlatPtr> Process::sys$clock_settime(clockid_t clock_id, Userspace<const timespec*> user_ts)
 {
     VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ScopeGuard.h>
+#include <AK/Time.h>
+#include <Kernel/FileSystem/EPoll.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+// We never hand out more events than this in one go, the rest is left for the next call.
+static constexpr size_t max_events_per_wait = 256;
+
+KResultOr<FlatPtr> Process::sys$epoll_create(int flags)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    REQUIRE_PROMISE(stdio);
+
+    if (flags & ~EPOLL_CLOEXEC)
+        return EINVAL;
+
+    auto fd_or_error = m_fds.allocate();
+    if (fd_or_error.is_error())
+        return fd_or_error.error();
+    auto epoll_fd = fd_or_error.release_value();
+
+    auto epoll_or_error = EPoll::create();
+    if (epoll_or_error.is_error())
+        return epoll_or_error.error();
+
+    auto description_or_error = FileDescription::create(*epoll_or_error.value());
+    if (description_or_error.is_error())
+        return description_or_error.error();
+
+    m_fds[epoll_fd.fd].set(description_or_error.release_value(), (flags & EPOLL_CLOEXEC) ? FD_CLOEXEC : 0);
+    m_fds[epoll_fd.fd].description()->set_readable(true);
+    return epoll_fd.fd;
+}
+
+KResultOr<FlatPtr> Process::sys$epoll_ctl(Userspace<const Syscall::SC_epoll_ctl_params*> user_params)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    REQUIRE_PROMISE(stdio);
+
+    Syscall::SC_epoll_ctl_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+
+    auto epoll_description = fds().file_description(params.epfd);
+    if (!epoll_description)
+        return EBADF;
+    auto* epoll = epoll_description->epoll();
+    if (!epoll)
+        return EINVAL;
+    auto description = fds().file_description(params.fd);
+    if (!description)
+        return EBADF;
+
+    epoll_event event {};
+    if (params.op != EPOLL_CTL_DEL && !copy_from_user(&event, params.event))
+        return EFAULT;
+
+    switch (params.op) {
+    case EPOLL_CTL_ADD:
+        return epoll->add_interest(params.fd, *description, event);
+    case EPOLL_CTL_MOD:
+        return epoll->modify_interest(params.fd, *description, event);
+    case EPOLL_CTL_DEL:
+        return epoll->remove_interest(params.fd, *description);
+    default:
+        return EINVAL;
+    }
+}
+
+KResultOr<FlatPtr> Process::sys$epoll_wait(Userspace<const Syscall::SC_epoll_wait_params*> user_params)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    REQUIRE_PROMISE(stdio);
+
+    Syscall::SC_epoll_wait_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+
+    if (params.maxevents <= 0)
+        return EINVAL;
+
+    auto description = fds().file_description(params.epfd);
+    if (!description)
+        return EBADF;
+    auto* epoll = description->epoll();
+    if (!epoll)
+        return EINVAL;
+
+    Thread::BlockTimeout timeout;
+    if (params.timeout) {
+        auto timeout_time = copy_time_from_user(params.timeout);
+        if (!timeout_time.has_value())
+            return EFAULT;
+        timeout = Thread::BlockTimeout(false, &timeout_time.value());
+    }
+
+    sigset_t sigmask = {};
+    if (params.sigmask && !copy_from_user(&sigmask, params.sigmask))
+        return EFAULT;
+
+    Vector<epoll_event> events;
+    if (!events.try_resize(min(static_cast<size_t>(params.maxevents), max_events_per_wait)))
+        return ENOMEM;
+
+    auto current_thread = Thread::current();
+
+    u32 previous_signal_mask = 0;
+    if (params.sigmask)
+        previous_signal_mask = current_thread->update_signal_mask(sigmask);
+    ScopeGuard rollback_signal_mask([&]() {
+        if (params.sigmask)
+            current_thread->update_signal_mask(previous_signal_mask);
+    });
+
+    size_t event_count = 0;
+    for (;;) {
+        event_count = epoll->collect_ready_events(events.span());
+        if (event_count > 0 || !timeout.should_block())
+            break;
+        // Being woken up only means that something may have become ready, so we have to look again.
+        // The timeout is absolute once it has been set up, so it doesn't get longer by doing that.
+        Thread::FileBlocker::BlockFlags unblocked_flags;
+        auto result = current_thread->block<Thread::ReadBlocker>(timeout, *description, unblocked_flags);
+        if (result.was_interrupted())
+            return EINTR;
+        if (result.timed_out())
+            break;
+    }
+
+    if (event_count > 0 && !copy_to_user(params.events, events.data(), event_count * sizeof(epoll_event)))
+        return EFAULT;
+    return event_count;
+}
+
+}
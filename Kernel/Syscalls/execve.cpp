@@ -580,7 +580,6 @@ KResult Process::do_exec(NonnullRefPtr<FileDescription> main_program_description
     m_coredump_metadata.clear();
 
     auto current_thread = Thread::current();
-    current_thread->clear_signals();
 
     clear_futex_queues_on_exec();
 
@@ -610,6 +609,8 @@ KResult Process::do_exec(NonnullRefPtr<FileDescription> main_program_description
         });
     }
     VERIFY(new_main_thread);
+    // NOTE: This isn't necessarily the current thread, posix_spawn() execs on behalf of a new process.
+    new_main_thread->clear_signals();
 
     auto auxv = generate_auxiliary_vector(load_result.load_base, load_result.entry_eip, uid(), euid(), gid(), egid(), path, main_program_fd);
 
@@ -930,6 +931,29 @@ KResult Process::exec(String path, Vector<String> arguments, Vector<String> envi
     return KSuccess;
 }
 
+bool Process::copy_user_strings(Syscall::StringListArgument const& list, Vector<String>& output)
+{
+    if (!list.length)
+        return true;
+    Checked<size_t> size = sizeof(*list.strings);
+    size *= list.length;
+    if (size.has_overflow())
+        return false;
+    Vector<Syscall::StringArgument, 32> strings;
+    if (!strings.try_resize(list.length))
+        return false;
+    if (!copy_from_user(strings.data(), list.strings, size.value()))
+        return false;
+    for (size_t i = 0; i < list.length; ++i) {
+        auto string = copy_string_from_user(strings[i]);
+        if (string.is_null())
+            return false;
+        if (!output.try_append(move(string)))
+            return false;
+    }
+    return true;
+}
+
 KResultOr<FlatPtr> Process::sys$execve(Userspace<const Syscall::SC_execve_params*> user_params)
 {
     VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
@@ -952,28 +976,6 @@ KResultOr<FlatPtr> Process::sys$execve(Userspace<const Syscall::SC_execve_params
         path = path_arg.value()->view();
     }
 
-    auto copy_user_strings = [](const auto& list, auto& output) {
-        if (!list.length)
-            return true;
-        Checked<size_t> size = sizeof(*list.strings);
-        size *= list.length;
-        if (size.has_overflow())
-            return false;
-        Vector<Syscall::StringArgument, 32> strings;
-        if (!strings.try_resize(list.length))
-            return false;
-        if (!copy_from_user(strings.data(), list.strings, size.value()))
-            return false;
-        for (size_t i = 0; i < list.length; ++i) {
-            auto string = copy_string_from_user(strings[i]);
-            if (string.is_null())
-                return false;
-            if (!output.try_append(move(string)))
-                return false;
-        }
-        return true;
-    };
-
     Vector<String> arguments;
     if (!copy_user_strings(params.arguments, arguments))
         return EFAULT;
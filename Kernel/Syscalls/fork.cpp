@@ -14,6 +14,28 @@
 
 namespace Kernel {
 
+void Process::inherit_state_from(Process& parent)
+{
+    m_root_directory = parent.m_root_directory;
+    m_root_directory_relative_to_global_root = parent.m_root_directory_relative_to_global_root;
+    m_veil_state = parent.m_veil_state;
+    m_unveiled_paths = parent.m_unveiled_paths.deep_copy();
+    m_fds = parent.m_fds;
+    m_pg = parent.m_pg;
+
+    ProtectedDataMutationScope scope { *this };
+    m_promises = parent.m_promises;
+    m_execpromises = parent.m_execpromises;
+    m_has_promises = parent.m_has_promises;
+    m_has_execpromises = parent.m_has_execpromises;
+    m_sid = parent.m_sid;
+    m_extra_gids = parent.m_extra_gids;
+    m_umask = parent.m_umask;
+    m_signal_trampoline = parent.m_signal_trampoline;
+    m_dumpable = parent.m_dumpable;
+    m_io_priority = parent.m_io_priority;
+}
+
 KResultOr<FlatPtr> Process::sys$fork(RegisterState& regs)
 {
     VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
@@ -22,25 +44,7 @@ KResultOr<FlatPtr> Process::sys$fork(RegisterState& regs)
     auto child = Process::create(child_first_thread, m_name, uid(), gid(), pid(), m_is_kernel_process, m_cwd, m_executable, m_tty, this);
     if (!child || !child_first_thread)
         return ENOMEM;
-    child->m_root_directory = m_root_directory;
-    child->m_root_directory_relative_to_global_root = m_root_directory_relative_to_global_root;
-    child->m_veil_state = m_veil_state;
-    child->m_unveiled_paths = m_unveiled_paths.deep_copy();
-    child->m_fds = m_fds;
-    child->m_pg = m_pg;
-
-    {
-        ProtectedDataMutationScope scope { *child };
-        child->m_promises = m_promises;
-        child->m_execpromises = m_execpromises;
-        child->m_has_promises = m_has_promises;
-        child->m_has_execpromises = m_has_execpromises;
-        child->m_sid = m_sid;
-        child->m_extra_gids = m_extra_gids;
-        child->m_umask = m_umask;
-        child->m_signal_trampoline = m_signal_trampoline;
-        child->m_dumpable = m_dumpable;
-    }
+    child->inherit_state_from(*this);
 
     dbgln_if(FORK_DEBUG, "fork: child={}", child);
     child->space().set_enforces_syscall_regions(space().enforces_syscall_regions());
@@ -109,7 +113,9 @@ KResultOr<FlatPtr> Process::sys$fork(RegisterState& regs)
                 // TODO: tear down new process?
                 return ENOMEM;
             }
-            child_region->map(child->space().page_directory(), ShouldFlushTLB::No);
+            // Don't copy the page tables. The child will fault its pages in as it touches them,
+            // which for the common fork() and exec() is hardly any of them.
+            child_region->map_lazily(child->space().page_directory());
 
             if (region == m_master_tls_region.unsafe_ptr())
                 child->m_master_tls_region = child_region;
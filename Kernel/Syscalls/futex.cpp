@@ -4,6 +4,8 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Array.h>
+#include <AK/HashFunctions.h>
 #include <AK/Singleton.h>
 #include <Kernel/Debug.h>
 #include <Kernel/Process.h>
@@ -11,8 +13,22 @@
 
 namespace Kernel {
 
-static SpinLock<u8> g_global_futex_lock;
-static AK::Singleton<HashMap<VMObject*, FutexQueues>> g_global_futex_queues;
+// Shared futexes are spread across a fixed number of hash buckets with a lock
+// each, so that processes using unrelated futexes don't contend on one lock.
+static constexpr size_t g_global_futex_bucket_count = 64;
+
+struct GlobalFutexBucket {
+    SpinLock<u8> lock;
+    HashMap<VMObject*, FutexQueues> queues;
+};
+
+static AK::Singleton<Array<GlobalFutexBucket, g_global_futex_bucket_count>> g_global_futex_buckets;
+
+static GlobalFutexBucket& global_futex_bucket_for(VMObject const& vmobject, FlatPtr offset)
+{
+    auto hash = pair_int_hash(ptr_hash(&vmobject), ptr_hash(offset));
+    return (*g_global_futex_buckets)[hash % g_global_futex_bucket_count];
+}
 
 FutexQueue::FutexQueue(FlatPtr user_address_or_offset, VMObject* vmobject)
     : m_user_address_or_offset(user_address_or_offset)
@@ -56,8 +72,13 @@ void FutexQueue::vmobject_deleted(VMObject& vmobject)
     m_vmobject = nullptr; // Just to be safe...
 
     {
-        ScopedSpinLock lock(g_global_futex_lock);
-        g_global_futex_queues->remove(&vmobject);
+        auto& bucket = global_futex_bucket_for(vmobject, m_user_address_or_offset);
+        ScopedSpinLock lock(bucket.lock);
+        if (auto it = bucket.queues.find(&vmobject); it != bucket.queues.end()) {
+            it->value.remove(m_user_address_or_offset);
+            if (it->value.is_empty())
+                bucket.queues.remove(it);
+        }
     }
 
     bool did_wake_all;
@@ -121,7 +142,6 @@ KResultOr<FlatPtr> Process::sys$futex(Userspace<const Syscall::SC_futex_params*>
     }
 
     bool is_private = (params.futex_op & FUTEX_PRIVATE_FLAG) != 0;
-    auto& queue_lock = is_private ? m_futex_lock : g_global_futex_lock;
     auto user_address_or_offset = FlatPtr(params.userspace_address);
     auto user_address_or_offset2 = FlatPtr(params.userspace_address2);
 
@@ -143,14 +163,20 @@ KResultOr<FlatPtr> Process::sys$futex(Userspace<const Syscall::SC_futex_params*>
             if (!region2)
                 return EFAULT;
             vmobject2 = region2->vmobject();
-            user_address_or_offset2 = region->offset_in_vmobject_from_vaddr(VirtualAddress(user_address_or_offset2));
+            user_address_or_offset2 = region2->offset_in_vmobject_from_vaddr(VirtualAddress(user_address_or_offset2));
             break;
         }
         }
     }
 
-    auto find_global_futex_queues = [&](VMObject& vmobject, bool create_if_not_found) -> FutexQueues* {
-        auto& global_queues = *g_global_futex_queues;
+    auto futex_lock_for = [&](VMObject* vmobject, FlatPtr user_address_or_offset) -> SpinLock<u8>& {
+        if (is_private)
+            return m_futex_lock;
+        return global_futex_bucket_for(*vmobject, user_address_or_offset).lock;
+    };
+
+    auto find_global_futex_queues = [&](VMObject& vmobject, FlatPtr offset, bool create_if_not_found) -> FutexQueues* {
+        auto& global_queues = global_futex_bucket_for(vmobject, offset).queues;
         auto it = global_queues.find(&vmobject);
         if (it != global_queues.end())
             return &it->value;
@@ -168,7 +194,7 @@ KResultOr<FlatPtr> Process::sys$futex(Userspace<const Syscall::SC_futex_params*>
     auto find_futex_queue = [&](VMObject* vmobject, FlatPtr user_address_or_offset, bool create_if_not_found, bool* did_create = nullptr) -> RefPtr<FutexQueue> {
         VERIFY(is_private || vmobject);
         VERIFY(!create_if_not_found || did_create != nullptr);
-        auto* queues = is_private ? &m_futex_queues : find_global_futex_queues(*vmobject, create_if_not_found);
+        auto* queues = is_private ? &m_futex_queues : find_global_futex_queues(*vmobject, user_address_or_offset, create_if_not_found);
         if (!queues)
             return {};
         auto it = queues->find(user_address_or_offset);
@@ -185,7 +211,7 @@ KResultOr<FlatPtr> Process::sys$futex(Userspace<const Syscall::SC_futex_params*>
     };
 
     auto remove_futex_queue = [&](VMObject* vmobject, FlatPtr user_address_or_offset) {
-        auto* queues = is_private ? &m_futex_queues : find_global_futex_queues(*vmobject, false);
+        auto* queues = is_private ? &m_futex_queues : find_global_futex_queues(*vmobject, user_address_or_offset, false);
         if (queues) {
             if (auto it = queues->find(user_address_or_offset); it != queues->end()) {
                 if (it->value->try_remove()) {
@@ -194,14 +220,14 @@ KResultOr<FlatPtr> Process::sys$futex(Userspace<const Syscall::SC_futex_params*>
                 }
             }
             if (!is_private && queues->is_empty())
-                g_global_futex_queues->remove(vmobject);
+                global_futex_bucket_for(*vmobject, user_address_or_offset).queues.remove(vmobject);
         }
     };
 
     auto do_wake = [&](VMObject* vmobject, FlatPtr user_address_or_offset, u32 count, Optional<u32> bitmask) -> int {
         if (count == 0)
             return 0;
-        ScopedSpinLock lock(queue_lock);
+        ScopedSpinLock lock(futex_lock_for(vmobject, user_address_or_offset));
         auto futex_queue = find_futex_queue(vmobject, user_address_or_offset, false);
         if (!futex_queue)
             return 0;
@@ -227,7 +253,7 @@ KResultOr<FlatPtr> Process::sys$futex(Userspace<const Syscall::SC_futex_params*>
             }
             atomic_thread_fence(AK::MemoryOrder::memory_order_acquire);
 
-            ScopedSpinLock lock(queue_lock);
+            ScopedSpinLock lock(futex_lock_for(vmobject.ptr(), user_address_or_offset));
             did_create = false;
             futex_queue = find_futex_queue(vmobject.ptr(), user_address_or_offset, true, &did_create);
             VERIFY(futex_queue);
@@ -240,7 +266,7 @@ KResultOr<FlatPtr> Process::sys$futex(Userspace<const Syscall::SC_futex_params*>
 
         Thread::BlockResult block_result = futex_queue->wait_on(timeout, bitset);
 
-        ScopedSpinLock lock(queue_lock);
+        ScopedSpinLock lock(futex_lock_for(vmobject.ptr(), user_address_or_offset));
         if (futex_queue->is_empty_and_no_imminent_waits()) {
             // If there are no more waiters, we want to get rid of the futex!
             remove_futex_queue(vmobject, user_address_or_offset);
@@ -260,7 +286,16 @@ KResultOr<FlatPtr> Process::sys$futex(Userspace<const Syscall::SC_futex_params*>
         atomic_thread_fence(AK::MemoryOrder::memory_order_acquire);
 
         int woken_or_requeued = 0;
-        ScopedSpinLock lock(queue_lock);
+        // The source and target futex may live in different buckets. Always take
+        // their locks in the same order so that concurrent requeues can't deadlock.
+        auto* source_lock = &futex_lock_for(vmobject.ptr(), user_address_or_offset);
+        auto* target_lock = &futex_lock_for(vmobject2.ptr(), user_address_or_offset2);
+        if (target_lock < source_lock)
+            swap(source_lock, target_lock);
+        ScopedSpinLock lock(*source_lock);
+        Optional<ScopedSpinLock<SpinLock<u8>>> target_queue_lock;
+        if (target_lock != source_lock)
+            target_queue_lock.emplace(*target_lock);
         if (auto futex_queue = find_futex_queue(vmobject.ptr(), user_address_or_offset, false)) {
             RefPtr<FutexQueue> target_futex_queue;
             bool is_empty, is_target_empty;
@@ -9,23 +9,35 @@
 
 namespace Kernel {
 
-KResultOr<FlatPtr> Process::sys$get_dir_entries(int fd, Userspace<void*> user_buffer, size_t user_size)
+static KResultOr<FlatPtr> get_dir_entries(Process& process, int fd, Userspace<void*> user_buffer, size_t user_size, FileDescription::IncludeStat include_stat)
 {
-    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
-    REQUIRE_PROMISE(stdio);
     if (user_size > NumericLimits<ssize_t>::max())
         return EINVAL;
-    auto description = fds().file_description(fd);
+    auto description = process.fds().file_description(fd);
     if (!description)
         return EBADF;
     auto buffer = UserOrKernelBuffer::for_user_buffer(user_buffer, static_cast<size_t>(user_size));
     if (!buffer.has_value())
         return EFAULT;
-    auto result = description->get_dir_entries(buffer.value(), user_size);
+    auto result = description->get_dir_entries(buffer.value(), user_size, include_stat);
     if (result.is_error())
         return result.error();
     else
         return result.release_value();
 }
 
+KResultOr<FlatPtr> Process::sys$get_dir_entries(int fd, Userspace<void*> user_buffer, size_t user_size)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
+    REQUIRE_PROMISE(stdio);
+    return get_dir_entries(*this, fd, user_buffer, user_size, FileDescription::IncludeStat::No);
+}
+
+KResultOr<FlatPtr> Process::sys$get_dir_entries_with_stat(int fd, Userspace<void*> user_buffer, size_t user_size)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
+    REQUIRE_PROMISE(rpath);
+    return get_dir_entries(*this, fd, user_buffer, user_size, FileDescription::IncludeStat::Yes);
+}
+
 }
@@ -198,6 +198,10 @@ KResultOr<FlatPtr> Process::sys$mmap(Userspace<const Syscall::SC_mmap_params*> u
     if (map_stack && (!map_private || !map_anonymous))
         return EINVAL;
 
+    // Place big anonymous mappings on huge page boundaries so they can be backed by huge pages.
+    if (map_anonymous && !addr && size >= huge_page_size && alignment < huge_page_size)
+        alignment = huge_page_size;
+
     Region* region = nullptr;
     Optional<Range> range;
 
@@ -466,6 +470,17 @@ KResultOr<FlatPtr> Process::sys$madvise(Userspace<void*> address, size_t size, i
         return EINVAL;
     if (!region->is_mmap())
         return EPERM;
+    switch (advice) {
+    case MADV_NORMAL:
+        region->set_readahead_advice(ReadaheadAdvice::Normal);
+        return 0;
+    case MADV_SEQUENTIAL:
+        region->set_readahead_advice(ReadaheadAdvice::Sequential);
+        return 0;
+    case MADV_RANDOM:
+        region->set_readahead_advice(ReadaheadAdvice::Random);
+        return 0;
+    }
     bool set_volatile = advice & MADV_SET_VOLATILE;
     bool set_nonvolatile = advice & MADV_SET_NONVOLATILE;
     if (set_volatile && set_nonvolatile)
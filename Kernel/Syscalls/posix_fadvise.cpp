@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+KResultOr<FlatPtr> Process::sys$posix_fadvise(Userspace<const Syscall::SC_posix_fadvise_params*> user_params)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
+    REQUIRE_PROMISE(stdio);
+
+    Syscall::SC_posix_fadvise_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+
+    if (params.offset < 0 || params.len < 0)
+        return EINVAL;
+
+    auto description = fds().file_description(params.fd);
+    if (!description)
+        return EBADF;
+    if (description->is_fifo())
+        return ESPIPE;
+
+    if (auto result = description->advise(params.offset, params.len, params.advice); result.is_error())
+        return result;
+    return 0;
+}
+
+}
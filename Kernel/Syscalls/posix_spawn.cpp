@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Checked.h>
+#include <AK/ScopeGuard.h>
+#include <Kernel/Debug.h>
+#include <Kernel/FileSystem/Custody.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/FileSystem/VirtualFileSystem.h>
+#include <Kernel/PerformanceManager.h>
+#include <Kernel/Process.h>
+#include <Kernel/TTY/TTY.h>
+#include <Kernel/VM/MemoryManager.h>
+#include <LibC/limits.h>
+
+namespace Kernel {
+
+KResult Process::apply_posix_spawn_file_action(Syscall::SC_posix_spawn_file_action const& action)
+{
+    auto validate_fd = [&](int fd) -> KResult {
+        if (fd < 0 || static_cast<size_t>(fd) >= m_fds.max_open())
+            return EBADF;
+        return KSuccess;
+    };
+
+    auto install_description = [&](int fd, NonnullRefPtr<FileDescription> description, u32 fd_flags) {
+        if (!m_fds.m_fds_metadatas[fd].is_allocated())
+            m_fds.m_fds_metadatas[fd].allocate();
+        m_fds[fd].set(move(description), fd_flags);
+    };
+
+    switch (action.type) {
+    case Syscall::PosixSpawnFileActionType::Open: {
+        if (auto result = validate_fd(action.fd); result.is_error())
+            return result;
+        auto path = Process::current()->get_syscall_path_argument(action.path);
+        if (path.is_error())
+            return path.error();
+        auto description_or_error = VirtualFileSystem::the().open(path.value()->view(), action.options, (action.mode & 0777) & ~umask(), current_directory());
+        if (description_or_error.is_error())
+            return description_or_error.error();
+        auto description = description_or_error.release_value();
+        if (description->inode() && description->inode()->socket())
+            return ENXIO;
+        install_description(action.fd, move(description), (action.options & O_CLOEXEC) ? FD_CLOEXEC : 0);
+        return KSuccess;
+    }
+    case Syscall::PosixSpawnFileActionType::Close:
+        if (auto result = validate_fd(action.fd); result.is_error())
+            return result;
+        if (!m_fds.file_description(action.fd))
+            return EBADF;
+        // NOTE: The description is still shared with the parent, so it must not be closed, only dropped from the child's table.
+        m_fds[action.fd] = {};
+        return KSuccess;
+    case Syscall::PosixSpawnFileActionType::Dup2: {
+        auto description = m_fds.file_description(action.fd);
+        if (!description)
+            return EBADF;
+        if (auto result = validate_fd(action.new_fd); result.is_error())
+            return result;
+        // Unlike dup2(), a file action with old_fd == new_fd clears FD_CLOEXEC.
+        install_description(action.new_fd, description.release_nonnull(), 0);
+        return KSuccess;
+    }
+    case Syscall::PosixSpawnFileActionType::Chdir: {
+        auto path = Process::current()->get_syscall_path_argument(action.path);
+        if (path.is_error())
+            return path.error();
+        auto directory_or_error = VirtualFileSystem::the().open_directory(path.value()->view(), current_directory());
+        if (directory_or_error.is_error())
+            return directory_or_error.error();
+        m_cwd = *directory_or_error.value();
+        return KSuccess;
+    }
+    case Syscall::PosixSpawnFileActionType::Fchdir: {
+        auto description = m_fds.file_description(action.fd);
+        if (!description)
+            return EBADF;
+        if (!description->is_directory())
+            return ENOTDIR;
+        if (!description->metadata().may_execute(*this))
+            return EACCES;
+        m_cwd = description->custody();
+        return KSuccess;
+    }
+    }
+    return EINVAL;
+}
+
+KResult Process::apply_posix_spawn_attributes(Process& parent, Thread& thread, Syscall::SC_posix_spawn_params const& params)
+{
+    if (params.flags & ~(POSIX_SPAWN_RESETIDS | POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSCHEDPARAM | POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSID))
+        return EINVAL;
+
+    if (params.flags & POSIX_SPAWN_RESETIDS) {
+        ProtectedDataMutationScope scope { *this };
+        m_euid = m_uid;
+        m_egid = m_gid;
+    }
+
+    if (params.flags & POSIX_SPAWN_SETPGROUP) {
+        if (params.pgroup < 0)
+            return EINVAL;
+        ProcessGroupID new_pgid = params.pgroup ? ProcessGroupID(params.pgroup) : ProcessGroupID(pid().value());
+        if (new_pgid != pid().value()) {
+            // Like setpgid(), the child may only join an existing process group in its own session.
+            SessionID new_sid = parent.get_sid_from_pgid(new_pgid);
+            if (new_sid == -1 || new_sid != sid())
+                return EPERM;
+        }
+        m_pg = ProcessGroup::find_or_create(new_pgid);
+        if (!m_pg)
+            return ENOMEM;
+    }
+
+    if (params.flags & POSIX_SPAWN_SETSID) {
+        // The child is brand new, so the only group that can be named after it is one POSIX_SPAWN_SETPGROUP just made.
+        m_pg = ProcessGroup::find_or_create(ProcessGroupID(pid().value()));
+        if (!m_pg)
+            return ENOMEM;
+        m_tty = nullptr;
+        ProtectedDataMutationScope scope { *this };
+        m_sid = pid().value();
+    }
+
+    if (params.flags & POSIX_SPAWN_SETSIGDEF) {
+        for (size_t signal = 1; signal < NSIG; ++signal) {
+            if (params.sigdefault & (1 << (signal - 1)))
+                thread.m_signal_action_data[signal] = {};
+        }
+    }
+
+    if (params.flags & POSIX_SPAWN_SETSIGMASK)
+        thread.update_signal_mask(params.sigmask);
+
+    if (params.flags & POSIX_SPAWN_SETSCHEDPARAM) {
+        if (params.sched_priority < THREAD_PRIORITY_MIN || params.sched_priority > THREAD_PRIORITY_MAX)
+            return EINVAL;
+        thread.set_priority(params.sched_priority);
+    }
+
+    return KSuccess;
+}
+
+KResultOr<FlatPtr> Process::sys$posix_spawn(Userspace<const Syscall::SC_posix_spawn_params*> user_params)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
+    REQUIRE_PROMISE(proc);
+    REQUIRE_PROMISE(exec);
+
+    Syscall::SC_posix_spawn_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+
+    if (params.arguments.length > ARG_MAX || params.environment.length > ARG_MAX)
+        return E2BIG;
+
+    String path;
+    {
+        auto path_arg = get_syscall_path_argument(params.path);
+        if (path_arg.is_error())
+            return path_arg.error();
+        path = path_arg.value()->view();
+    }
+
+    Vector<String> arguments;
+    if (!copy_user_strings(params.arguments, arguments))
+        return EFAULT;
+
+    Vector<String> environment;
+    if (!copy_user_strings(params.environment, environment))
+        return EFAULT;
+
+    Vector<Syscall::SC_posix_spawn_file_action> file_actions;
+    if (params.file_action_count) {
+        Checked<size_t> size = sizeof(*params.file_actions);
+        size *= params.file_action_count;
+        if (size.has_overflow())
+            return EOVERFLOW;
+        if (!file_actions.try_resize(params.file_action_count))
+            return ENOMEM;
+        if (!copy_from_user(file_actions.data(), params.file_actions, size.value()))
+            return EFAULT;
+    }
+
+    // Build the child straight from our own state, without ever cloning our address space.
+    RefPtr<Thread> child_first_thread;
+    auto child = Process::create(child_first_thread, m_name, uid(), gid(), pid(), false, m_cwd, m_executable, m_tty, this);
+    if (!child || !child_first_thread)
+        return ENOMEM;
+    child->inherit_state_from(*this);
+
+    dbgln_if(FORK_DEBUG, "posix_spawn: child={} path={}", child, path);
+
+    if (auto result = child->apply_posix_spawn_attributes(*this, *child_first_thread, params); result.is_error())
+        return result;
+
+    for (auto& action : file_actions) {
+        if (auto result = child->apply_posix_spawn_file_action(action); result.is_error())
+            return result;
+    }
+
+    {
+        // exec() switches to the child's address space, make sure we come back to ours.
+        ScopeGuard paging_scope_guard = [&] {
+            MemoryManager::enter_process_paging_scope(*this);
+        };
+        if (auto result = child->exec(move(path), move(arguments), move(environment)); result.is_error())
+            return result;
+    }
+
+    Process::register_new(*child);
+
+    PerformanceManager::add_process_created_event(*child);
+
+    {
+        ScopedSpinLock lock(g_scheduler_lock);
+        child_first_thread->set_affinity(Thread::current()->affinity());
+    }
+
+    auto child_pid = child->pid().value();
+
+    // NOTE: All user processes have a leaked ref on them. It's balanced by Thread::WaitBlockCondition::finalize().
+    (void)child.leak_ref();
+
+    return child_pid;
+}
+
+}
@@ -18,6 +18,16 @@ KResultOr<FlatPtr> Process::sys$prctl(int option, FlatPtr arg1, [[maybe_unused]]
     case PR_SET_DUMPABLE:
         set_dumpable(arg1);
         return 0;
+    case PR_GET_IO_PRIORITY:
+        return to_underlying(io_priority());
+    case PR_SET_IO_PRIORITY:
+        if (arg1 > IO_PRIORITY_IDLE)
+            return EINVAL;
+        // Anyone may go easier on the disks, but only the superuser may cut in line.
+        if (arg1 < to_underlying(io_priority()) && !is_superuser())
+            return EPERM;
+        set_io_priority(static_cast<IOPriority>(arg1));
+        return 0;
     default:
         return EINVAL;
     }
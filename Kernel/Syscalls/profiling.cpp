@@ -17,6 +17,16 @@ bool g_profiling_all_threads;
 PerformanceEventBuffer* g_global_perf_events;
 u64 g_profiling_event_mask;
 
+// Starts the hardware performance counters asked for, and leaves out those that can't be counted.
+static u64 enable_performance_counters(u64 event_mask)
+{
+    auto counter_events = PerformanceCounters::enable(event_mask);
+    event_mask = (event_mask & ~(PERF_EVENT_PMC_MASK | PERF_EVENT_PMC_SAMPLE)) | counter_events;
+    if (counter_events)
+        event_mask |= PERF_EVENT_PMC_SAMPLE;
+    return event_mask;
+}
+
 KResultOr<FlatPtr> Process::sys$profiling_enable(pid_t pid, u64 event_mask)
 {
     VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
@@ -41,7 +51,7 @@ KResultOr<FlatPtr> Process::sys$profiling_enable(pid_t pid, u64 event_mask)
             PerformanceManager::add_process_created_event(process);
             return IterationDecision::Continue;
         });
-        g_profiling_event_mask = event_mask;
+        g_profiling_event_mask = enable_performance_counters(event_mask);
         return 0;
     }
 
@@ -64,6 +74,7 @@ KResultOr<FlatPtr> Process::sys$profiling_enable(pid_t pid, u64 event_mask)
         process->set_profiling(false);
         return ENOTSUP;
     }
+    g_profiling_event_mask = enable_performance_counters(event_mask);
     return 0;
 }
 
@@ -78,6 +89,7 @@ KResultOr<FlatPtr> Process::sys$profiling_disable(pid_t pid)
         ScopedCritical critical;
         if (!TimeManagement::the().disable_profile_timer())
             return ENOTSUP;
+        PerformanceCounters::disable();
         g_profiling_all_threads = false;
         return 0;
     }
@@ -93,6 +105,7 @@ KResultOr<FlatPtr> Process::sys$profiling_disable(pid_t pid)
     // FIXME: If we enabled the profile timer and it's not supported, how do we disable it now?
     if (!TimeManagement::the().disable_profile_timer())
         return ENOTSUP;
+    PerformanceCounters::disable();
     process->set_profiling(false);
     return 0;
 }
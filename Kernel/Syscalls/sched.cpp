@@ -73,4 +73,95 @@ KResultOr<FlatPtr> Process::sys$sched_getparam(pid_t pid, Userspace<struct sched
     return 0;
 }
 
+KResultOr<FlatPtr> Process::sys$sched_setattr(pid_t pid, Userspace<const struct sched_attr*> user_attr)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    REQUIRE_PROMISE(proc);
+    struct sched_attr attr;
+    if (!copy_from_user(&attr, user_attr))
+        return EFAULT;
+
+    if (attr.size != sizeof(attr))
+        return EINVAL;
+
+    switch (attr.sched_policy) {
+    case SCHED_OTHER:
+    case SCHED_FIFO:
+    case SCHED_RR:
+    case SCHED_BATCH:
+        if (attr.sched_priority < THREAD_PRIORITY_MIN || attr.sched_priority > THREAD_PRIORITY_MAX)
+            return EINVAL;
+        break;
+    case SCHED_DEADLINE:
+        break;
+    default:
+        return EINVAL;
+    }
+
+    auto* peer = Thread::current();
+    ScopedSpinLock lock(g_scheduler_lock);
+    if (pid != 0)
+        peer = Thread::from_tid(pid);
+
+    if (!peer)
+        return ESRCH;
+
+    if (!is_superuser() && euid() != peer->process().uid() && uid() != peer->process().uid())
+        return EPERM;
+
+    if (attr.sched_policy == SCHED_DEADLINE) {
+        // Like on other systems, the period defaults to the relative deadline
+        auto period = attr.sched_period != 0 ? attr.sched_period : attr.sched_deadline;
+        // A reservation takes CPU time away from everyone else, so only the superuser may make or grow one.
+        // Others can only give some of an existing reservation back.
+        if (!is_superuser()) {
+            if (!peer->is_deadline_thread())
+                return EPERM;
+            auto& state = peer->deadline_state();
+            if (attr.sched_runtime > state.runtime_ns || period < state.period_ns)
+                return EPERM;
+        }
+        return Scheduler::set_deadline_parameters(*peer, attr.sched_runtime, attr.sched_deadline, period);
+    }
+
+    Scheduler::clear_deadline_parameters(*peer);
+    peer->set_priority(attr.sched_priority);
+    return 0;
+}
+
+KResultOr<FlatPtr> Process::sys$sched_getattr(pid_t pid, Userspace<struct sched_attr*> user_attr)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    REQUIRE_PROMISE(proc);
+    struct sched_attr attr {};
+    {
+        auto* peer = Thread::current();
+        ScopedSpinLock lock(g_scheduler_lock);
+        if (pid != 0)
+            peer = Thread::from_tid(pid);
+
+        if (!peer)
+            return ESRCH;
+
+        if (!is_superuser() && euid() != peer->process().uid() && uid() != peer->process().uid())
+            return EPERM;
+
+        attr.size = sizeof(attr);
+        attr.sched_priority = peer->priority();
+        if (peer->is_deadline_thread()) {
+            auto& state = peer->deadline_state();
+            attr.sched_policy = SCHED_DEADLINE;
+            attr.sched_runtime = state.runtime_ns;
+            attr.sched_deadline = state.relative_deadline_ns;
+            attr.sched_period = state.period_ns;
+        } else {
+            attr.sched_policy = SCHED_OTHER;
+        }
+    }
+
+    if (!copy_to_user(user_attr, &attr))
+        return EFAULT;
+    return 0;
+}
+
 }
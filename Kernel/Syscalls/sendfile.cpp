@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/NumericLimits.h>
+#include <Kernel/Debug.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/KBuffer.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+// Large enough to keep the per-chunk overhead low, small enough to not hog kernel memory.
+static constexpr size_t max_transfer_chunk_size = 64 * KiB;
+
+static KResult wait_until_readable(FileDescription& description, bool nonblocking)
+{
+    if (description.can_read())
+        return KSuccess;
+    if (nonblocking || !description.is_blocking())
+        return EAGAIN;
+    auto unblock_flags = BlockFlags::None;
+    if (Thread::current()->block<Thread::ReadBlocker>({}, description, unblock_flags).was_interrupted())
+        return EINTR;
+    if (!has_flag(unblock_flags, BlockFlags::Read))
+        return EAGAIN;
+    return KSuccess;
+}
+
+static KResult wait_until_writable(FileDescription& description, bool nonblocking)
+{
+    while (!description.can_write()) {
+        if (nonblocking || !description.is_blocking())
+            return EAGAIN;
+        auto unblock_flags = BlockFlags::None;
+        if (Thread::current()->block<Thread::WriteBlocker>({}, description, unblock_flags).was_interrupted())
+            return EINTR;
+    }
+    return KSuccess;
+}
+
+// Moves up to count bytes from in to out without them ever being copied to userspace.
+// Descriptions with an offset are accessed at that offset (which is advanced), the others at their current position.
+// Once something has been transferred, errors and would-block conditions just end the transfer early.
+static KResultOr<size_t> transfer(FileDescription& in, Optional<u64>& in_offset, FileDescription& out, Optional<u64>& out_offset, size_t count, bool nonblocking)
+{
+    auto buffer = KBuffer::try_create_with_size(page_round_up(min(count, max_transfer_chunk_size)), Region::Access::Read | Region::Access::Write, "Transfer buffer");
+    if (!buffer)
+        return ENOMEM;
+
+    if (!out_offset.has_value() && out.should_append() && out.file().is_seekable()) {
+        auto seek_result = out.seek(0, SEEK_END);
+        if (seek_result.is_error())
+            return seek_result.error();
+    }
+
+    // Data read from a pipe or a socket can't be put back if it can't be written out.
+    bool input_is_rewindable = in_offset.has_value() || in.file().is_seekable();
+
+    size_t total_transferred = 0;
+    while (total_transferred < count) {
+        if (auto result = wait_until_readable(in, nonblocking || total_transferred > 0); result.is_error())
+            return total_transferred > 0 ? KResultOr<size_t>(total_transferred) : result;
+        if (!input_is_rewindable) {
+            if (auto result = wait_until_writable(out, nonblocking || total_transferred > 0); result.is_error())
+                return total_transferred > 0 ? KResultOr<size_t>(total_transferred) : result;
+        }
+
+        auto chunk_size = min(count - total_transferred, buffer->size());
+        auto kernel_buffer = UserOrKernelBuffer::for_kernel_buffer(buffer->data());
+        auto nread_or_error = in_offset.has_value() ? in.read(kernel_buffer, in_offset.value(), chunk_size) : in.read(kernel_buffer, chunk_size);
+        if (nread_or_error.is_error())
+            return total_transferred > 0 ? KResultOr<size_t>(total_transferred) : nread_or_error.error();
+        auto nread = nread_or_error.value();
+        if (nread == 0)
+            break;
+
+        size_t nwritten = 0;
+        KResult write_result = KSuccess;
+        while (nwritten < nread) {
+            // Once the bytes have left the input, a blocking output has to take them all.
+            write_result = wait_until_writable(out, input_is_rewindable && (nonblocking || total_transferred + nwritten > 0));
+            if (write_result.is_error())
+                break;
+            auto data = kernel_buffer.offset(nwritten);
+            auto result = out_offset.has_value() ? out.write(out_offset.value() + nwritten, data, nread - nwritten) : out.write(data, nread - nwritten);
+            if (result.is_error()) {
+                write_result = result.error();
+                break;
+            }
+            VERIFY(result.value() > 0);
+            nwritten += result.value();
+        }
+
+        if (in_offset.has_value())
+            in_offset.value() += nwritten;
+        else if (nwritten < nread && in.file().is_seekable())
+            (void)in.seek(-static_cast<off_t>(nread - nwritten), SEEK_CUR);
+        if (out_offset.has_value())
+            out_offset.value() += nwritten;
+
+        total_transferred += nwritten;
+        if (write_result.is_error())
+            return total_transferred > 0 ? KResultOr<size_t>(total_transferred) : write_result;
+    }
+    return total_transferred;
+}
+
+static KResultOr<Optional<u64>> copy_offset_from_user(i64* user_offset)
+{
+    if (!user_offset)
+        return Optional<u64> {};
+    i64 offset;
+    if (!copy_from_user(&offset, user_offset))
+        return EFAULT;
+    if (offset < 0)
+        return EINVAL;
+    return Optional<u64> { static_cast<u64>(offset) };
+}
+
+static KResult copy_offset_to_user(i64* user_offset, Optional<u64> const& offset)
+{
+    if (!user_offset)
+        return KSuccess;
+    i64 value = offset.value();
+    if (!copy_to_user(user_offset, &value))
+        return EFAULT;
+    return KSuccess;
+}
+
+KResultOr<FlatPtr> Process::sys$sendfile(Userspace<const Syscall::SC_sendfile_params*> user_params)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_sendfile_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+    if (params.count > NumericLimits<ssize_t>::max())
+        return EINVAL;
+
+    auto in_description = fds().file_description(params.in_fd);
+    auto out_description = fds().file_description(params.out_fd);
+    if (!in_description || !out_description)
+        return EBADF;
+    if (!in_description->is_readable() || !out_description->is_writable())
+        return EBADF;
+    // Like on Linux, the input has to be something that can be read at an offset.
+    if (!in_description->file().is_seekable() || in_description->is_directory())
+        return EINVAL;
+
+    auto in_offset_or_error = copy_offset_from_user(params.offset);
+    if (in_offset_or_error.is_error())
+        return in_offset_or_error.error();
+    auto in_offset = in_offset_or_error.release_value();
+    Optional<u64> out_offset;
+
+    dbgln_if(IO_DEBUG, "sys$sendfile({}, {}, {})", params.out_fd, params.in_fd, params.count);
+    if (params.count == 0)
+        return 0;
+
+    auto result = transfer(*in_description, in_offset, *out_description, out_offset, params.count, false);
+    if (result.is_error())
+        return result.error();
+    if (auto copy_result = copy_offset_to_user(params.offset, in_offset); copy_result.is_error())
+        return copy_result;
+    return result.value();
+}
+
+KResultOr<FlatPtr> Process::sys$splice(Userspace<const Syscall::SC_splice_params*> user_params)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_splice_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+    if (params.len > NumericLimits<ssize_t>::max())
+        return EINVAL;
+    if (params.flags & ~(SPLICE_F_MOVE | SPLICE_F_NONBLOCK | SPLICE_F_MORE))
+        return EINVAL;
+
+    auto in_description = fds().file_description(params.fd_in);
+    auto out_description = fds().file_description(params.fd_out);
+    if (!in_description || !out_description)
+        return EBADF;
+    if (!in_description->is_readable() || !out_description->is_writable())
+        return EBADF;
+    if (in_description->is_directory() || out_description->is_directory())
+        return EINVAL;
+    if (!in_description->is_fifo() && !out_description->is_fifo())
+        return EINVAL;
+    if (params.off_in && (in_description->is_fifo() || !in_description->file().is_seekable()))
+        return ESPIPE;
+    if (params.off_out && (out_description->is_fifo() || !out_description->file().is_seekable()))
+        return ESPIPE;
+
+    auto in_offset_or_error = copy_offset_from_user(params.off_in);
+    if (in_offset_or_error.is_error())
+        return in_offset_or_error.error();
+    auto in_offset = in_offset_or_error.release_value();
+    auto out_offset_or_error = copy_offset_from_user(params.off_out);
+    if (out_offset_or_error.is_error())
+        return out_offset_or_error.error();
+    auto out_offset = out_offset_or_error.release_value();
+
+    dbgln_if(IO_DEBUG, "sys$splice({}, {}, {}, {:#x})", params.fd_in, params.fd_out, params.len, params.flags);
+    if (params.len == 0)
+        return 0;
+
+    auto result = transfer(*in_description, in_offset, *out_description, out_offset, params.len, params.flags & SPLICE_F_NONBLOCK);
+    if (result.is_error())
+        return result.error();
+    if (auto copy_result = copy_offset_to_user(params.off_in, in_offset); copy_result.is_error())
+        return copy_result;
+    if (auto copy_result = copy_offset_to_user(params.off_out, out_offset); copy_result.is_error())
+        return copy_result;
+    return result.value();
+}
+
+}
@@ -83,6 +83,28 @@ KResultOr<FlatPtr> Process::sys$listen(int sockfd, int backlog)
     return socket.listen(backlog);
 }
 
+// Gives a connection we've just accepted a description of its own, and puts it into the fd.
+static KResult install_accepted_socket(Process& process, int fd, Socket& accepted_socket, int flags)
+{
+    auto description_or_error = FileDescription::create(accepted_socket);
+    if (description_or_error.is_error())
+        return description_or_error.error();
+    auto description = description_or_error.release_value();
+
+    description->set_readable(true);
+    description->set_writable(true);
+    if (flags & SOCK_NONBLOCK)
+        description->set_blocking(false);
+    int fd_flags = 0;
+    if (flags & SOCK_CLOEXEC)
+        fd_flags |= FD_CLOEXEC;
+    process.fds()[fd].set(move(description), fd_flags);
+
+    // NOTE: Moving this state to Completed is what causes connect() to unblock on the client side.
+    accepted_socket.set_setup_state(Socket::SetupState::Completed);
+    return KSuccess;
+}
+
 KResultOr<FlatPtr> Process::sys$accept4(Userspace<const Syscall::SC_accept4_params*> user_params)
 {
     VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
@@ -134,22 +156,62 @@ KResultOr<FlatPtr> Process::sys$accept4(Userspace<const Syscall::SC_accept4_para
             return EFAULT;
     }
 
-    auto accepted_socket_description_result = FileDescription::create(*accepted_socket);
-    if (accepted_socket_description_result.is_error())
-        return accepted_socket_description_result.error();
+    if (auto result = install_accepted_socket(*this, accepted_socket_fd.fd, *accepted_socket, flags); result.is_error())
+        return result;
+    return accepted_socket_fd.fd;
+}
 
-    accepted_socket_description_result.value()->set_readable(true);
-    accepted_socket_description_result.value()->set_writable(true);
-    if (flags & SOCK_NONBLOCK)
-        accepted_socket_description_result.value()->set_blocking(false);
-    int fd_flags = 0;
-    if (flags & SOCK_CLOEXEC)
-        fd_flags |= FD_CLOEXEC;
-    m_fds[accepted_socket_fd.fd].set(accepted_socket_description_result.release_value(), fd_flags);
+KResultOr<FlatPtr> Process::sys$accept4_batch(Userspace<const Syscall::SC_accept4_batch_params*> user_params)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    REQUIRE_PROMISE(accept);
 
-    // NOTE: Moving this state to Completed is what causes connect() to unblock on the client side.
-    accepted_socket->set_setup_state(Socket::SetupState::Completed);
-    return accepted_socket_fd.fd;
+    Syscall::SC_accept4_batch_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+    if (params.count == 0)
+        return EINVAL;
+
+    auto accepting_socket_description = fds().file_description(params.sockfd);
+    if (!accepting_socket_description)
+        return EBADF;
+    if (!accepting_socket_description->is_socket())
+        return ENOTSOCK;
+    auto& socket = *accepting_socket_description->socket();
+
+    if (!socket.can_accept()) {
+        if (accepting_socket_description->is_blocking()) {
+            auto unblock_flags = Thread::FileBlocker::BlockFlags::None;
+            if (Thread::current()->block<Thread::AcceptBlocker>({}, *accepting_socket_description, unblock_flags).was_interrupted())
+                return EINTR;
+        } else {
+            return EAGAIN;
+        }
+    }
+
+    // We only wait for the first one, after that we take whatever has been queued up already.
+    size_t accepted_count = 0;
+    while (accepted_count < params.count && socket.can_accept()) {
+        auto accepted_socket_fd_or_error = m_fds.allocate();
+        if (accepted_socket_fd_or_error.is_error()) {
+            if (accepted_count == 0)
+                return accepted_socket_fd_or_error.error();
+            break;
+        }
+        auto accepted_socket_fd = accepted_socket_fd_or_error.release_value();
+        auto accepted_socket = socket.accept();
+        if (!accepted_socket)
+            break;
+        if (auto result = install_accepted_socket(*this, accepted_socket_fd.fd, *accepted_socket, params.flags); result.is_error()) {
+            if (accepted_count == 0)
+                return result;
+            break;
+        }
+        if (!copy_to_user(params.fds + accepted_count, &accepted_socket_fd.fd))
+            return EFAULT;
+        ++accepted_count;
+    }
+    return accepted_count;
 }
 
 KResultOr<FlatPtr> Process::sys$connect(int sockfd, Userspace<const sockaddr*> user_address, socklen_t user_address_size)
@@ -184,14 +246,47 @@ KResultOr<FlatPtr> Process::sys$shutdown(int sockfd, int how)
     return socket.shutdown(how);
 }
 
-KResultOr<FlatPtr> Process::sys$sendmsg(int sockfd, Userspace<const struct msghdr*> user_msg, int flags)
+// The batched syscalls never take more messages than this in one go.
+static constexpr unsigned max_messages_per_call = 1024;
+
+static constexpr size_t cmsg_align(size_t size) { return (size + sizeof(void*) - 1) & ~(sizeof(void*) - 1); }
+
+// The most file descriptors we take in one SCM_RIGHTS message, which is as many as a LocalSocket queues up at most.
+static constexpr size_t max_passed_fds_per_message = 128;
+
+// Collects the file descriptions from the SCM_RIGHTS control messages, so they can go along with the data.
+static KResult collect_rights(const struct msghdr& msg, NonnullRefPtrVector<FileDescription>& passing_descriptions)
 {
-    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
-    REQUIRE_PROMISE(stdio);
-    struct msghdr msg;
-    if (!copy_from_user(&msg, user_msg))
+    REQUIRE_PROMISE(sendfd);
+    if (msg.msg_controllen > cmsg_align(sizeof(cmsghdr)) + max_passed_fds_per_message * sizeof(int))
+        return EINVAL;
+    u8 control[cmsg_align(sizeof(cmsghdr)) + max_passed_fds_per_message * sizeof(int)];
+    if (!copy_from_user(control, msg.msg_control, msg.msg_controllen))
         return EFAULT;
 
+    auto& fds = Process::current()->fds();
+    for (size_t offset = 0; offset + sizeof(cmsghdr) <= msg.msg_controllen;) {
+        auto& cmsg = *reinterpret_cast<cmsghdr*>(control + offset);
+        if (cmsg.cmsg_len < cmsg_align(sizeof(cmsghdr)) || offset + cmsg.cmsg_len > msg.msg_controllen)
+            return EINVAL;
+        if (cmsg.cmsg_level != SOL_SOCKET || cmsg.cmsg_type != SCM_RIGHTS)
+            return EINVAL;
+        size_t fd_count = (cmsg.cmsg_len - cmsg_align(sizeof(cmsghdr))) / sizeof(int);
+        auto* passed_fds = reinterpret_cast<int*>(control + offset + cmsg_align(sizeof(cmsghdr)));
+        for (size_t i = 0; i < fd_count; ++i) {
+            auto passing_description = fds.file_description(passed_fds[i]);
+            if (!passing_description)
+                return EBADF;
+            if (!passing_descriptions.try_append(passing_description.release_nonnull()))
+                return ENOMEM;
+        }
+        offset += cmsg_align(cmsg.cmsg_len);
+    }
+    return KSuccess;
+}
+
+static KResultOr<size_t> send_message(FileDescription& description, Socket& socket, const struct msghdr& msg, int flags)
+{
     if (msg.msg_iovlen != 1)
         return ENOTSUP; // FIXME: Support this :)
     Vector<iovec, 1> iovs;
@@ -205,33 +300,26 @@ KResultOr<FlatPtr> Process::sys$sendmsg(int sockfd, Userspace<const struct msghd
     Userspace<const sockaddr*> user_addr((FlatPtr)msg.msg_name);
     socklen_t addr_length = msg.msg_namelen;
 
-    auto description = fds().file_description(sockfd);
-    if (!description)
-        return EBADF;
-    if (!description->is_socket())
-        return ENOTSOCK;
-    auto& socket = *description->socket();
     if (socket.is_shut_down_for_writing())
         return EPIPE;
     auto data_buffer = UserOrKernelBuffer::for_user_buffer((u8*)iovs[0].iov_base, iovs[0].iov_len);
     if (!data_buffer.has_value())
         return EFAULT;
-    auto result = socket.sendto(*description, data_buffer.value(), iovs[0].iov_len, flags, user_addr, addr_length);
-    if (result.is_error())
-        return result.error();
-    else
-        return result.release_value();
+    if (msg.msg_control && msg.msg_controllen > 0) {
+        if (!socket.is_local())
+            return EOPNOTSUPP;
+        NonnullRefPtrVector<FileDescription> passing_descriptions;
+        if (auto result = collect_rights(msg, passing_descriptions); result.is_error())
+            return result;
+        // The descriptions are only passed if the data makes it into the socket, and only ever once.
+        return static_cast<LocalSocket&>(socket).sendto_with_descriptions(description, data_buffer.value(), iovs[0].iov_len, move(passing_descriptions));
+    }
+    return socket.sendto(description, data_buffer.value(), iovs[0].iov_len, flags, user_addr, addr_length);
 }
 
-KResultOr<FlatPtr> Process::sys$recvmsg(int sockfd, Userspace<struct msghdr*> user_msg, int flags)
+// Receives into the buffers of msg, and updates the lengths and flags of user_msg, which msg has been copied from.
+static KResultOr<size_t> receive_message(FileDescription& description, Socket& socket, const struct msghdr& msg, Userspace<struct msghdr*> user_msg, int flags)
 {
-    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
-    REQUIRE_PROMISE(stdio);
-
-    struct msghdr msg;
-    if (!copy_from_user(&msg, user_msg))
-        return EFAULT;
-
     if (msg.msg_iovlen != 1)
         return ENOTSUP; // FIXME: Support this :)
     Vector<iovec, 1> iovs;
@@ -243,27 +331,20 @@ KResultOr<FlatPtr> Process::sys$recvmsg(int sockfd, Userspace<struct msghdr*> us
     Userspace<sockaddr*> user_addr((FlatPtr)msg.msg_name);
     Userspace<socklen_t*> user_addr_length(msg.msg_name ? (FlatPtr)&user_msg.unsafe_userspace_ptr()->msg_namelen : 0);
 
-    auto description = fds().file_description(sockfd);
-    if (!description)
-        return EBADF;
-    if (!description->is_socket())
-        return ENOTSOCK;
-    auto& socket = *description->socket();
-
     if (socket.is_shut_down_for_reading())
         return 0;
 
-    bool original_blocking = description->is_blocking();
+    bool original_blocking = description.is_blocking();
     if (flags & MSG_DONTWAIT)
-        description->set_blocking(false);
+        description.set_blocking(false);
 
     auto data_buffer = UserOrKernelBuffer::for_user_buffer((u8*)iovs[0].iov_base, iovs[0].iov_len);
     if (!data_buffer.has_value())
         return EFAULT;
     Time timestamp {};
-    auto result = socket.recvfrom(*description, data_buffer.value(), iovs[0].iov_len, flags, user_addr, user_addr_length, timestamp);
+    auto result = socket.recvfrom(description, data_buffer.value(), iovs[0].iov_len, flags, user_addr, user_addr_length, timestamp);
     if (flags & MSG_DONTWAIT)
-        description->set_blocking(original_blocking);
+        description.set_blocking(original_blocking);
 
     if (result.is_error())
         return result.error();
@@ -275,7 +356,41 @@ KResultOr<FlatPtr> Process::sys$recvmsg(int sockfd, Userspace<struct msghdr*> us
         msg_flags |= MSG_TRUNC;
     }
 
-    if (socket.wants_timestamp()) {
+    if (socket.is_local() && msg.msg_control && msg.msg_controllen >= cmsg_align(sizeof(cmsghdr)) + sizeof(int)) {
+        REQUIRE_PROMISE(recvfd);
+        auto& local_socket = static_cast<LocalSocket&>(socket);
+        size_t max_fd_count = min((msg.msg_controllen - cmsg_align(sizeof(cmsghdr))) / sizeof(int), max_passed_fds_per_message);
+        auto passed_descriptions = local_socket.recvfds(description, max_fd_count);
+        socklen_t control_length = 0;
+        if (!passed_descriptions.is_empty()) {
+            u8 control[cmsg_align(sizeof(cmsghdr)) + max_passed_fds_per_message * sizeof(int)];
+            auto* received_fds = reinterpret_cast<int*>(control + cmsg_align(sizeof(cmsghdr)));
+            size_t fd_count = 0;
+            auto& process = *Process::current();
+            for (auto& passed_description : passed_descriptions) {
+                auto fd_or_error = process.fds().allocate();
+                if (fd_or_error.is_error()) {
+                    // FIXME: The remaining file descriptions are lost, maybe we should put them back?
+                    msg_flags |= MSG_CTRUNC;
+                    break;
+                }
+                auto fd = fd_or_error.release_value();
+                process.fds()[fd.fd].set(passed_description, 0);
+                received_fds[fd_count++] = fd.fd;
+            }
+            control_length = cmsg_align(sizeof(cmsghdr)) + fd_count * sizeof(int);
+            auto& cmsg = *reinterpret_cast<cmsghdr*>(control);
+            cmsg = { control_length, SOL_SOCKET, SCM_RIGHTS };
+            if (!copy_to_user(msg.msg_control, control, control_length)) {
+                // The receiver never learns about these, so they mustn't stay open behind its back.
+                for (size_t i = 0; i < fd_count; ++i)
+                    process.fds()[received_fds[i]].clear();
+                return EFAULT;
+            }
+        }
+        if (!copy_to_user(&user_msg.unsafe_userspace_ptr()->msg_controllen, &control_length))
+            return EFAULT;
+    } else if (socket.wants_timestamp()) {
         struct {
             cmsghdr cmsg;
             timeval timestamp;
@@ -298,6 +413,127 @@ KResultOr<FlatPtr> Process::sys$recvmsg(int sockfd, Userspace<struct msghdr*> us
     return result.value();
 }
 
+KResultOr<FlatPtr> Process::sys$sendmsg(int sockfd, Userspace<const struct msghdr*> user_msg, int flags)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    REQUIRE_PROMISE(stdio);
+    struct msghdr msg;
+    if (!copy_from_user(&msg, user_msg))
+        return EFAULT;
+
+    auto description = fds().file_description(sockfd);
+    if (!description)
+        return EBADF;
+    if (!description->is_socket())
+        return ENOTSOCK;
+    auto result = send_message(*description, *description->socket(), msg, flags);
+    if (result.is_error())
+        return result.error();
+    return result.release_value();
+}
+
+KResultOr<FlatPtr> Process::sys$recvmsg(int sockfd, Userspace<struct msghdr*> user_msg, int flags)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    REQUIRE_PROMISE(stdio);
+
+    struct msghdr msg;
+    if (!copy_from_user(&msg, user_msg))
+        return EFAULT;
+
+    auto description = fds().file_description(sockfd);
+    if (!description)
+        return EBADF;
+    if (!description->is_socket())
+        return ENOTSOCK;
+    auto result = receive_message(*description, *description->socket(), msg, user_msg, flags);
+    if (result.is_error())
+        return result.error();
+    return result.release_value();
+}
+
+KResultOr<FlatPtr> Process::sys$sendmmsg(Userspace<const Syscall::SC_mmsg_params*> user_params)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    REQUIRE_PROMISE(stdio);
+
+    Syscall::SC_mmsg_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+    Userspace<struct mmsghdr*> user_msgs((FlatPtr)params.msgs);
+    auto flags = params.flags;
+
+    auto description = fds().file_description(params.sockfd);
+    if (!description)
+        return EBADF;
+    if (!description->is_socket())
+        return ENOTSOCK;
+    auto& socket = *description->socket();
+
+    auto message_count = min(params.message_count, max_messages_per_call);
+    unsigned sent_count = 0;
+    for (; sent_count < message_count; ++sent_count) {
+        auto* user_message = user_msgs.unsafe_userspace_ptr() + sent_count;
+        struct msghdr msg;
+        if (!copy_from_user(&msg, &user_message->msg_hdr))
+            return EFAULT;
+        auto result = send_message(*description, socket, msg, flags);
+        // Like everywhere else, an error is only reported if nothing was sent at all.
+        if (result.is_error()) {
+            if (sent_count == 0)
+                return result.error();
+            break;
+        }
+        unsigned length = result.value();
+        if (!copy_to_user(&user_message->msg_len, &length))
+            return EFAULT;
+    }
+    return sent_count;
+}
+
+KResultOr<FlatPtr> Process::sys$recvmmsg(Userspace<const Syscall::SC_mmsg_params*> user_params)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    REQUIRE_PROMISE(stdio);
+
+    Syscall::SC_mmsg_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+    Userspace<struct mmsghdr*> user_msgs((FlatPtr)params.msgs);
+    auto flags = params.flags;
+
+    auto description = fds().file_description(params.sockfd);
+    if (!description)
+        return EBADF;
+    if (!description->is_socket())
+        return ENOTSOCK;
+    auto& socket = *description->socket();
+
+    auto message_count = min(params.message_count, max_messages_per_call);
+    unsigned received_count = 0;
+    for (; received_count < message_count; ++received_count) {
+        auto* user_message = user_msgs.unsafe_userspace_ptr() + received_count;
+        struct msghdr msg;
+        if (!copy_from_user(&msg, &user_message->msg_hdr))
+            return EFAULT;
+        // We only wait for the first message, after that we take whatever has been queued up already.
+        auto message_flags = received_count > 0 ? flags | MSG_DONTWAIT : flags;
+        auto result = receive_message(*description, socket, msg, Userspace<struct msghdr*>((FlatPtr)&user_message->msg_hdr), message_flags);
+        if (result.is_error()) {
+            if (received_count == 0)
+                return result.error();
+            break;
+        }
+        unsigned length = result.value();
+        if (!copy_to_user(&user_message->msg_len, &length))
+            return EFAULT;
+        // A stream socket that has been shut down will keep returning 0, so there's no point in going on.
+        if (length == 0 && socket.type() == SOCK_STREAM)
+            break;
+    }
+    return received_count;
+}
+
 template<bool sockname, typename Params>
 int Process::get_sock_or_peer_name(const Params& params)
 {
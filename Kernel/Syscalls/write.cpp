@@ -87,7 +87,8 @@ KResultOr<FlatPtr> Process::do_write(FileDescription& description, const UserOrK
         if (nwritten_or_error.is_error()) {
             if (total_nwritten > 0)
                 return total_nwritten;
-            if (nwritten_or_error.error() == EAGAIN)
+            // Being able to write doesn't mean that everything fits, e.g. a whole message on a SOCK_SEQPACKET socket.
+            if (nwritten_or_error.error() == EAGAIN && description.is_blocking())
                 continue;
             return nwritten_or_error.error();
         }
@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Interrupts/APIC.h>
+#include <Kernel/Interrupts/InterruptManagement.h>
+#include <Kernel/Process.h>
+#include <Kernel/Sections.h>
+#include <Kernel/Tasks/IRQBalanceTask.h>
+
+namespace Kernel {
+
+UNMAP_AFTER_INIT void IRQBalanceTask::spawn()
+{
+    if (!APIC::initialized() || Processor::count() < 2)
+        return;
+    RefPtr<Thread> balancer_thread;
+    Process::create_kernel_process(balancer_thread, "IRQBalanceTask", [] {
+        for (;;) {
+            if (InterruptManagement::the().is_irq_balancing_enabled())
+                InterruptManagement::the().balance_irqs();
+            (void)Thread::current()->sleep(Time::from_seconds(1));
+        }
+    });
+}
+
+}
@@ -0,0 +1,17 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+namespace Kernel {
+
+// IRQBalanceTask spreads the busy IRQs over all processors once a second, as long as
+// that's enabled through /sys/interrupts/balance. It only exists on SMP systems.
+class IRQBalanceTask {
+public:
+    static void spawn();
+};
+}
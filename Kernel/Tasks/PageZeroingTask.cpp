@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Process.h>
+#include <Kernel/Sections.h>
+#include <Kernel/Tasks/PageZeroingTask.h>
+#include <Kernel/VM/MemoryManager.h>
+#include <Kernel/WaitQueue.h>
+
+namespace Kernel {
+
+static WaitQueue* s_wait_queue;
+static Atomic<bool> s_wake_pending;
+
+// Zero this many pages at a time, then give everyone else a chance to run.
+static constexpr size_t pages_per_batch = 16;
+
+UNMAP_AFTER_INIT void PageZeroingTask::spawn()
+{
+    s_wait_queue = new WaitQueue;
+    RefPtr<Thread> page_zeroing_thread;
+    Process::create_kernel_process(page_zeroing_thread, "PageZeroingTask", [] {
+        Thread::current()->set_priority(THREAD_PRIORITY_MIN);
+        for (;;) {
+            s_wake_pending = false;
+            if (MM.zero_free_user_physical_pages(pages_per_batch) == pages_per_batch) {
+                Scheduler::yield();
+                continue;
+            }
+            // The pools are full (or memory is tight), so wait until someone takes pages out of them.
+            auto timeout = Time::from_seconds(1);
+            (void)s_wait_queue->wait_on(Thread::BlockTimeout(false, &timeout), "PageZeroingTask");
+        }
+    });
+}
+
+void PageZeroingTask::notify_zeroed_pages_wanted()
+{
+    if (!s_wait_queue || s_wake_pending.exchange(true))
+        return;
+    // We may be called with the MM lock held, so wait until we've left the critical section.
+    Processor::deferred_call_queue([] {
+        s_wait_queue->wake_all();
+    });
+}
+
+}
@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+namespace Kernel {
+
+// PageZeroingTask runs at the lowest priority and zeroes free physical pages ahead of time,
+// keeping the zeroed page pools of the user PhysicalRegions topped up.
+class PageZeroingTask {
+public:
+    static void spawn();
+    static void notify_zeroed_pages_wanted();
+};
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/NonnullRefPtrVector.h>
+#include <Kernel/Debug.h>
+#include <Kernel/Devices/MemoryPressureDevice.h>
+#include <Kernel/FileSystem/DiskCache.h>
+#include <Kernel/Process.h>
+#include <Kernel/Sections.h>
+#include <Kernel/Tasks/ReclaimTask.h>
+#include <Kernel/VM/AnonymousVMObject.h>
+#include <Kernel/VM/InodeVMObject.h>
+#include <Kernel/VM/MemoryManager.h>
+#include <Kernel/VM/PageCache.h>
+#include <Kernel/WaitQueue.h>
+
+namespace Kernel {
+
+static WaitQueue* s_wait_queue;
+static Atomic<bool> s_wake_pending;
+
+static bool reached_high_watermark()
+{
+    return MM.get_system_memory_info().user_physical_pages_uncommitted >= MM.high_watermark();
+}
+
+template<typename VMObjectType, typename Filter>
+static NonnullRefPtrVector<VMObjectType> collect_vmobjects(Filter filter)
+{
+    NonnullRefPtrVector<VMObjectType> vmobjects;
+    MM.for_each_vmobject([&](auto& vmobject) {
+        if (!filter(vmobject))
+            return IterationDecision::Continue;
+        // If we can't remember any more, make do with the ones we already have.
+        if (!vmobjects.try_append(static_cast<VMObjectType&>(vmobject)))
+            return IterationDecision::Break;
+        return IterationDecision::Continue;
+    });
+    return vmobjects;
+}
+
+static size_t reclaim()
+{
+    size_t reclaimed_page_count = 0;
+
+    // Volatile memory is the cheapest to give up, its owner has already said it can live without it.
+    auto volatile_vmobjects = collect_vmobjects<AnonymousVMObject>([](VMObject& vmobject) {
+        if (!vmobject.is_anonymous())
+            return false;
+        auto& anonymous_vmobject = static_cast<AnonymousVMObject&>(vmobject);
+        return anonymous_vmobject.is_purgeable() && anonymous_vmobject.is_volatile();
+    });
+    for (auto& vmobject : volatile_vmobjects) {
+        if (reached_high_watermark())
+            return reclaimed_page_count;
+        reclaimed_page_count += vmobject.purge();
+    }
+
+    // Next, files nobody has looked at in a while. Those can always be read back in.
+    reclaimed_page_count += PageCache::the().trim();
+    if (reached_high_watermark())
+        return reclaimed_page_count;
+
+    // Then whatever the block caches have grown into while memory was plentiful.
+    reclaimed_page_count += DiskCache::shrink_all();
+    if (reached_high_watermark())
+        return reclaimed_page_count;
+
+    // Finally, clean pages of files that are still mapped somewhere.
+    auto inode_vmobjects = collect_vmobjects<InodeVMObject>([](VMObject& vmobject) {
+        return vmobject.is_inode();
+    });
+    for (auto& vmobject : inode_vmobjects) {
+        if (reached_high_watermark())
+            break;
+        reclaimed_page_count += vmobject.release_all_clean_pages();
+    }
+    return reclaimed_page_count;
+}
+
+UNMAP_AFTER_INIT void ReclaimTask::spawn()
+{
+    s_wait_queue = new WaitQueue;
+    RefPtr<Thread> reclaim_thread;
+    Process::create_kernel_process(reclaim_thread, "ReclaimTask", [] {
+        dbgln("ReclaimTask is running");
+        for (;;) {
+            // Even without being woken up, look around every now and then so userspace
+            // hears about the pressure going away again.
+            auto timeout = Time::from_seconds(1);
+            (void)s_wait_queue->wait_on(Thread::BlockTimeout(false, &timeout), "ReclaimTask");
+            s_wake_pending = false;
+
+            auto level = MM.memory_pressure_level();
+            if (MemoryPressureDevice::is_initialized())
+                MemoryPressureDevice::the().set_level(level);
+            if (level == MemoryPressureLevel::None)
+                continue;
+
+            auto reclaimed_page_count = reclaim();
+            dbgln_if(RECLAIM_DEBUG, "ReclaimTask: Reclaimed {} pages, memory pressure is now {}", reclaimed_page_count, to_underlying(MM.memory_pressure_level()));
+            if (MemoryPressureDevice::is_initialized())
+                MemoryPressureDevice::the().set_level(MM.memory_pressure_level());
+        }
+    });
+}
+
+void ReclaimTask::notify_low_memory()
+{
+    if (!s_wait_queue || s_wake_pending.exchange(true))
+        return;
+    // This is called with the MM lock held, so wait until we've left the critical section.
+    Processor::deferred_call_queue([] {
+        s_wait_queue->wake_all();
+    });
+}
+
+}
@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+namespace Kernel {
+
+// ReclaimTask watches the amount of free user memory. Once it drops below MemoryManager's
+// low watermark, it purges volatile memory and drops clean file pages until it's back above
+// the high watermark, and tells userspace about the pressure through /dev/mempressure.
+class ReclaimTask {
+public:
+    static void spawn();
+    static void notify_low_memory();
+};
+}
@@ -4,24 +4,38 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include <Kernel/FileSystem/VirtualFileSystem.h>
+#include <Kernel/FileSystem/FileSystem.h>
 #include <Kernel/Process.h>
 #include <Kernel/Sections.h>
 #include <Kernel/Tasks/SyncTask.h>
 #include <Kernel/Time/TimeManagement.h>
+#include <Kernel/WaitQueue.h>
 
 namespace Kernel {
 
+static WaitQueue* s_wait_queue;
+static Atomic<bool> s_wake_pending;
+
 UNMAP_AFTER_INIT void SyncTask::spawn()
 {
+    s_wait_queue = new WaitQueue;
     RefPtr<Thread> syncd_thread;
     Process::create_kernel_process(syncd_thread, "SyncTask", [] {
         dbgln("SyncTask is running");
         for (;;) {
-            VirtualFileSystem::sync();
-            (void)Thread::current()->sleep(Time::from_seconds(1));
+            s_wake_pending = false;
+            FileSystem::writeback();
+            auto timeout = Time::from_seconds(1);
+            (void)s_wait_queue->wait_on(Thread::BlockTimeout(false, &timeout), "SyncTask");
         }
     });
 }
 
+void SyncTask::wake()
+{
+    if (!s_wait_queue || s_wake_pending.exchange(true))
+        return;
+    s_wait_queue->wake_all();
+}
+
 }
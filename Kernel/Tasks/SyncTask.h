@@ -7,8 +7,11 @@
 #pragma once
 
 namespace Kernel {
+// SyncTask writes back dirty file system data in the background: once a second, and
+// whenever a block cache fills up with too many dirty blocks.
 class SyncTask {
 public:
     static void spawn();
+    static void wake();
 };
 }
@@ -29,6 +29,8 @@
 
 namespace Kernel {
 
+DEFINE_SLAB_CACHE(Thread);
+
 SpinLock<u8> Thread::g_tid_map_lock;
 READONLY_AFTER_INIT HashMap<ThreadID, Thread*>* Thread::g_tid_map;
 
@@ -165,6 +167,9 @@ Thread::~Thread()
 
         // We shouldn't be queued
         VERIFY(m_runnable_priority < 0);
+
+        // Give back any CPU bandwidth reserved for us
+        Scheduler::clear_deadline_parameters(*this);
     }
     {
         ScopedSpinLock lock(g_tid_map_lock);
@@ -250,21 +255,14 @@ u32 Thread::unblock_from_lock(Kernel::Mutex& lock)
     block_lock.unlock();
 
     auto do_unblock = [&]() {
-        ScopedSpinLock scheduler_lock(g_scheduler_lock);
         ScopedSpinLock block_lock(m_block_lock);
         VERIFY(m_blocking_lock == &lock);
         VERIFY(!Processor::current().in_irq());
-        VERIFY(g_scheduler_lock.own_lock());
         VERIFY(m_block_lock.own_lock());
         VERIFY(m_blocking_lock == &lock);
         dbgln_if(THREAD_DEBUG, "Thread {} unblocked from Mutex {}", *this, &lock);
         m_blocking_lock = nullptr;
-        if (Thread::current() == this) {
-            set_state(Thread::Running);
-            return;
-        }
-        VERIFY(m_state != Thread::Runnable && m_state != Thread::Running);
-        set_state(Thread::Runnable);
+        wake_from_blocked();
     };
     if (Processor::current().in_irq()) {
         Processor::current().deferred_call_queue([do_unblock = move(do_unblock), self = make_weak_ptr()]() {
@@ -280,7 +278,6 @@ u32 Thread::unblock_from_lock(Kernel::Mutex& lock)
 void Thread::unblock_from_blocker(Blocker& blocker)
 {
     auto do_unblock = [&]() {
-        ScopedSpinLock scheduler_lock(g_scheduler_lock);
         ScopedSpinLock block_lock(m_block_lock);
         if (m_blocker != &blocker)
             return;
@@ -300,7 +297,6 @@ void Thread::unblock_from_blocker(Blocker& blocker)
 void Thread::unblock(u8 signal)
 {
     VERIFY(!Processor::current().in_irq());
-    VERIFY(g_scheduler_lock.own_lock());
     VERIFY(m_block_lock.own_lock());
     if (m_state != Thread::Blocked)
         return;
@@ -319,12 +315,29 @@ void Thread::unblock(u8 signal)
         m_blocker->set_interrupted_by_signal(signal);
     }
     m_blocker = nullptr;
+    wake_from_blocked();
+}
+
+void Thread::wake_from_blocked()
+{
+    // Waking up a blocked thread is by far the most common state change, so
+    // it only takes this thread's own locks rather than g_scheduler_lock.
+    // This is safe because every other transition out of Blocked also
+    // updates m_state under m_lock, and we queue the thread before letting
+    // go of it, so nobody can observe it Runnable but not yet queued.
+    VERIFY(m_block_lock.own_lock());
+    ScopedSpinLock lock(m_lock);
+    if (m_state != Thread::Blocked)
+        return;
     if (Thread::current() == this) {
-        set_state(Thread::Running);
+        m_state = Thread::Running;
+        dbgln_if(THREAD_DEBUG, "Set thread {} state to {}", *this, state_string());
         return;
     }
-    VERIFY(m_state != Thread::Runnable && m_state != Thread::Running);
-    set_state(Thread::Runnable);
+    m_state = Thread::Runnable;
+    dbgln_if(THREAD_DEBUG, "Set thread {} state to {}", *this, state_string());
+    Scheduler::queue_runnable_thread(*this);
+    Processor::smp_wake_n_idle_processors(1);
 }
 
 void Thread::set_should_die()
@@ -1266,6 +1279,8 @@ RefPtr<Thread> Thread::from_tid(ThreadID tid)
 void Thread::reset_fpu_state()
 {
     memcpy(m_fpu_state, &Processor::current().clean_fpu_state(), sizeof(FPUState));
+    // Whatever state is loaded into an FPU for us is stale now
+    m_fpu_state_cpu = NumericLimits<u32>::max();
 }
 
 bool Thread::should_be_stopped() const
@@ -19,11 +19,13 @@
 #include <AK/Vector.h>
 #include <AK/WeakPtr.h>
 #include <AK/Weakable.h>
+#include <Kernel/Arch/x86/PerformanceCounters.h>
 #include <Kernel/Arch/x86/RegisterState.h>
 #include <Kernel/Arch/x86/SafeMem.h>
 #include <Kernel/Debug.h>
 #include <Kernel/FileSystem/InodeIdentifier.h>
 #include <Kernel/Forward.h>
+#include <Kernel/Heap/SlabCache.h>
 #include <Kernel/KResult.h>
 #include <Kernel/LockMode.h>
 #include <Kernel/Scheduler.h>
@@ -133,6 +135,7 @@ class Thread
     , public Weakable<Thread> {
     AK_MAKE_NONCOPYABLE(Thread);
     AK_MAKE_NONMOVABLE(Thread);
+    MAKE_SLAB_CACHED(Thread)
 
     friend class Mutex;
     friend class Process;
@@ -163,6 +166,22 @@ public:
     void set_priority(u32 p) { m_priority = p; }
     u32 priority() const { return m_priority; }
 
+    // State of the deadline scheduling class, managed by the Scheduler.
+    // A thread with a non-zero runtime is scheduled earliest deadline first,
+    // ahead of all priority scheduled threads, as long as it has budget left.
+    struct DeadlineState {
+        u64 runtime_ns { 0 };
+        u64 relative_deadline_ns { 0 };
+        u64 period_ns { 0 };
+        i64 remaining_runtime_ns { 0 };
+        Time absolute_deadline {};
+        Time next_replenishment {};
+        Time last_charged {};
+    };
+    bool is_deadline_thread() const { return m_deadline_state.runtime_ns != 0; }
+    DeadlineState& deadline_state() { return m_deadline_state; }
+    DeadlineState const& deadline_state() const { return m_deadline_state; }
+
     void detach()
     {
         ScopedSpinLock lock(m_lock);
@@ -893,7 +912,6 @@ public:
                     VERIFY(!g_scheduler_lock.own_lock());
                     VERIFY(!m_block_lock.own_lock());
                     // NOTE: this may execute on the same or any other processor!
-                    ScopedSpinLock scheduler_lock(g_scheduler_lock);
                     ScopedSpinLock block_lock(m_block_lock);
                     if (m_blocker && timeout_unblocked.exchange(true) == false)
                         unblock();
@@ -1043,6 +1061,10 @@ public:
 
     FPUState& fpu_state() { return *m_fpu_state; }
 
+    // The processor whose FPU holds this thread's live FPU state, if any.
+    u32 fpu_state_cpu() const { return m_fpu_state_cpu; }
+    void set_fpu_state_cpu(u32 cpu) { m_fpu_state_cpu = cpu; }
+
     KResult make_thread_specific_region(Badge<Process>);
 
     unsigned syscall_count() const { return m_syscall_count; }
@@ -1134,6 +1156,9 @@ public:
     u64 time_in_user() const { return m_total_time_scheduled_user; }
     u64 time_in_kernel() const { return m_total_time_scheduled_kernel; }
 
+    SchedulingLatencyHistogram const& scheduling_latency_histogram() const { return m_scheduling_latency_histogram; }
+    u32 preemption_count() const { return m_preemption_count; }
+
     enum class PreviousMode : u8 {
         KernelMode = 0,
         UserMode
@@ -1213,6 +1238,8 @@ public:
     bool is_profiling_suppressed() const { return m_is_profiling_suppressed; }
     void set_profiling_suppressed() { m_is_profiling_suppressed = true; }
 
+    PerformanceCounterState& performance_counter_state() { return m_performance_counter_state; }
+
     InodeIndex global_procfs_inode_index() const { return m_global_procfs_inode_index; }
 
     String backtrace();
@@ -1222,6 +1249,7 @@ private:
 
     IntrusiveListNode<Thread> m_process_thread_list_node;
     int m_runnable_priority { -1 };
+    u32 m_runnable_cpu { 0 };
 
     friend class WaitQueue;
 
@@ -1284,6 +1312,7 @@ private:
     LockMode unlock_process_if_locked(u32&);
     void relock_process(LockMode, u32);
     void reset_fpu_state();
+    void wake_from_blocked();
 
     mutable RecursiveSpinLock m_lock;
     mutable RecursiveSpinLock m_block_lock;
@@ -1299,6 +1328,9 @@ private:
     Optional<u64> m_last_time_scheduled;
     u64 m_total_time_scheduled_user { 0 };
     u64 m_total_time_scheduled_kernel { 0 };
+    u64 m_runnable_since { 0 };
+    SchedulingLatencyHistogram m_scheduling_latency_histogram;
+    Atomic<u32, AK::MemoryOrder::memory_order_relaxed> m_preemption_count { 0 };
     u32 m_ticks_left { 0 };
     u32 m_times_scheduled { 0 };
     u32 m_ticks_in_user { 0 };
@@ -1348,9 +1380,11 @@ private:
     unsigned m_ipv4_socket_write_bytes { 0 };
 
     OwnPtr<FPUState> m_fpu_state;
+    u32 m_fpu_state_cpu { NumericLimits<u32>::max() };
     State m_state { Invalid };
     String m_name;
     u32 m_priority { THREAD_PRIORITY_NORMAL };
+    DeadlineState m_deadline_state;
 
     State m_stop_state { Invalid };
 
@@ -1369,6 +1403,7 @@ private:
     InodeIndex m_global_procfs_inode_index;
 
     bool m_is_profiling_suppressed { false };
+    PerformanceCounterState m_performance_counter_state;
 
     void yield_and_release_relock_big_lock();
     void yield_assuming_not_holding_big_lock();
@@ -132,6 +132,15 @@ void APICTimer::enable_local_timer()
     APIC::the().setup_local_timer(m_timer_period, m_timer_mode, true);
 }
 
+void APICTimer::enable_local_timer_once(Time const& duration)
+{
+    // Fire a single interrupt after (at least one tick, and at most) the given
+    // duration. Calling enable_local_timer() switches back to periodic mode.
+    u64 ticks = max<u64>(1, ((u64)duration.to_nanoseconds() * m_frequency) / 1'000'000'000);
+    u64 count = min<u64>(ticks * m_timer_period, NumericLimits<u32>::max());
+    APIC::the().setup_local_timer((u32)count, APIC::TimerMode::OneShot, true);
+}
+
 void APICTimer::disable_local_timer()
 {
     APIC::the().setup_local_timer(0, APIC::TimerMode::OneShot, false);
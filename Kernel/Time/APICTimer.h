@@ -33,6 +33,7 @@ public:
     void will_be_destroyed() override { HardwareTimer<GenericInterruptHandler>::will_be_destroyed(); }
     void enable_local_timer();
     void disable_local_timer();
+    void enable_local_timer_once(Time const& duration);
 
 private:
     explicit APICTimer(u8, Function<void(const RegisterState&)>);
@@ -67,6 +67,8 @@ public:
         IRQHandler::will_be_destroyed();
     }
 
+    virtual bool has_fixed_affinity() const override { return true; }
+
     virtual StringView purpose() const override
     {
         if (TimeManagement::the().is_system_timer(*this))
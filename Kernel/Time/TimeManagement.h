@@ -10,9 +10,11 @@
 #include <AK/RefPtr.h>
 #include <AK/Time.h>
 #include <AK/Types.h>
+#include <Kernel/API/TimePage.h>
 #include <Kernel/Arch/x86/RegisterState.h>
 #include <Kernel/KResult.h>
 #include <Kernel/UnixTypes.h>
+#include <Kernel/VM/Region.h>
 
 namespace Kernel {
 
@@ -71,7 +73,12 @@ public:
 
     bool can_query_precise_time() const { return m_can_query_precise_time; }
 
+    VMObject& time_page_vmobject() { return m_time_page_region->vmobject(); }
+
 private:
+    TimePage& time_page() { return *static_cast<TimePage*>((void*)m_time_page_region->vaddr().as_ptr()); }
+    void update_time_page();
+
     bool probe_and_set_legacy_hardware_timers();
     bool probe_and_set_non_legacy_hardware_timers();
     Vector<HardwareTimerBase*> scan_and_initialize_periodic_timers();
@@ -100,6 +107,8 @@ private:
 
     Atomic<u32> m_profile_enable_count { 0 };
     RefPtr<HardwareTimerBase> m_profile_timer;
+
+    OwnPtr<Region> m_time_page_region;
 };
 
 }
@@ -282,6 +282,23 @@ void TimerQueue::fire()
         fire_timers(m_timer_queue_realtime);
 }
 
+Optional<Time> TimerQueue::time_until_next_timer_due()
+{
+    ScopedSpinLock lock(g_timerqueue_lock);
+
+    Optional<Time> time_until_next_due;
+    auto check_queue = [&](Queue& queue, clockid_t clock_id) {
+        if (queue.list.is_empty())
+            return;
+        auto time_until_due = queue.next_timer_due - TimeManagement::the().current_time(clock_id);
+        if (!time_until_next_due.has_value() || time_until_due < time_until_next_due.value())
+            time_until_next_due = time_until_due;
+    };
+    check_queue(m_timer_queue_monotonic, CLOCK_MONOTONIC);
+    check_queue(m_timer_queue_realtime, CLOCK_REALTIME);
+    return time_until_next_due;
+}
+
 void TimerQueue::update_next_timer_due(Queue& queue)
 {
     VERIFY(g_timerqueue_lock.is_locked());
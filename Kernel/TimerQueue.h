@@ -9,6 +9,7 @@
 #include <AK/Function.h>
 #include <AK/IntrusiveList.h>
 #include <AK/NonnullRefPtr.h>
+#include <AK/Optional.h>
 #include <AK/OwnPtr.h>
 #include <AK/RefCounted.h>
 #include <AK/Time.h>
@@ -89,6 +90,7 @@ public:
         return cancel_timer(*move(timer));
     }
     void fire();
+    Optional<Time> time_until_next_timer_due();
 
 private:
     struct Queue {
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/JsonArraySerializer.h>
+#include <AK/JsonObjectSerializer.h>
+#include <Kernel/Arch/x86/InterruptDisabler.h>
+#include <Kernel/KBufferBuilder.h>
+#include <Kernel/Scheduler.h>
+#include <Kernel/Thread.h>
+#include <Kernel/Tracepoints.h>
+
+namespace Kernel {
+
+bool g_tracepoints_enabled;
+
+static constexpr size_t trace_buffer_capacity = 2048;
+
+struct TraceEvent {
+    u64 timestamp;
+    FlatPtr arg1;
+    FlatPtr arg2;
+    u32 tid;
+    TracepointType type;
+};
+
+struct TraceBuffer {
+    static ProcessorSpecificDataID processor_specific_data_id() { return ProcessorSpecificDataID::Tracepoints; }
+
+    // Only ever goes up, the oldest events are overwritten once the buffer is full.
+    size_t head { 0 };
+    TraceEvent events[trace_buffer_capacity];
+};
+
+static StringView to_string(TracepointType type)
+{
+    switch (type) {
+    case TracepointType::ContextSwitch:
+        return "context_switch"sv;
+    case TracepointType::PageFault:
+        return "page_fault"sv;
+    case TracepointType::DeviceRequestStart:
+        return "device_request_start"sv;
+    case TracepointType::DeviceRequestComplete:
+        return "device_request_complete"sv;
+    case TracepointType::SyscallEnter:
+        return "syscall_enter"sv;
+    case TracepointType::SyscallExit:
+        return "syscall_exit"sv;
+    }
+    VERIFY_NOT_REACHED();
+}
+
+void Tracepoints::initialize_processor_buffer()
+{
+    ProcessorSpecific<TraceBuffer>::initialize();
+}
+
+void Tracepoints::record(TracepointType type, FlatPtr arg1, FlatPtr arg2)
+{
+    if (!Processor::is_initialized())
+        return;
+    // Keeps interrupt handlers from recording into the same slot, and us on this processor.
+    InterruptDisabler disabler;
+    auto* buffer = Processor::current().get_specific<TraceBuffer>();
+    if (!buffer)
+        return;
+    auto* current_thread = Thread::current();
+    auto& event = buffer->events[buffer->head++ % trace_buffer_capacity];
+    event.timestamp = Scheduler::current_time();
+    event.arg1 = arg1;
+    event.arg2 = arg2;
+    event.tid = current_thread ? current_thread->tid().value() : 0;
+    event.type = type;
+}
+
+bool Tracepoints::to_json(KBufferBuilder& builder)
+{
+    JsonArraySerializer array { builder };
+    // NOTE: The other processors keep on recording while we read their buffers, so the oldest few events may be torn.
+    Processor::for_each([&](Processor& processor) {
+        auto* buffer = processor.get_specific<TraceBuffer>();
+        if (!buffer)
+            return;
+        auto head = AK::atomic_load(&buffer->head, AK::MemoryOrder::memory_order_relaxed);
+        auto count = min(head, trace_buffer_capacity);
+        for (size_t i = head - count; i < head; ++i) {
+            auto& event = buffer->events[i % trace_buffer_capacity];
+            auto object = array.add_object();
+            object.add("cpu", processor.get_id());
+            object.add("timestamp", event.timestamp);
+            object.add("tid", event.tid);
+            object.add("type", to_string(event.type));
+            object.add("arg1", static_cast<u64>(event.arg1));
+            object.add("arg2", static_cast<u64>(event.arg2));
+        }
+    });
+    array.finish();
+    return true;
+}
+
+}
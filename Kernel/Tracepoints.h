@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+namespace Kernel {
+
+class KBufferBuilder;
+
+enum class TracepointType : u8 {
+    ContextSwitch,
+    PageFault,
+    DeviceRequestStart,
+    DeviceRequestComplete,
+    SyscallEnter,
+    SyscallExit,
+};
+
+// Set through /proc/sys/tracepoints.
+extern bool g_tracepoints_enabled;
+
+// Every processor keeps the most recent events in a ring buffer of its own, so recording one
+// never has to take a lock or wait for another processor. They are read through /proc/tracepoints.
+class Tracepoints {
+public:
+    static void initialize_processor_buffer();
+
+    static void record(TracepointType, FlatPtr arg1, FlatPtr arg2);
+    static bool to_json(KBufferBuilder&);
+};
+
+}
+
+// The arguments are only evaluated if tracing is enabled, until then this is just a load and a branch.
+#define TRACEPOINT(type, arg1, arg2)                                                                     \
+    do {                                                                                                 \
+        if (Kernel::g_tracepoints_enabled) [[unlikely]]                                                  \
+            Kernel::Tracepoints::record(Kernel::TracepointType::type, (FlatPtr)(arg1), (FlatPtr)(arg2)); \
+    } while (0)
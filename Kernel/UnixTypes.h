@@ -29,6 +29,14 @@
 #define O_NOFOLLOW_NOERROR (1 << 29)
 #define O_UNLINK_INTERNAL (1 << 30)
 
+#define POSIX_SPAWN_RESETIDS (1 << 0)
+#define POSIX_SPAWN_SETPGROUP (1 << 1)
+#define POSIX_SPAWN_SETSCHEDPARAM (1 << 2)
+#define POSIX_SPAWN_SETSCHEDULER (1 << 3)
+#define POSIX_SPAWN_SETSIGDEF (1 << 4)
+#define POSIX_SPAWN_SETSIGMASK (1 << 5)
+#define POSIX_SPAWN_SETSID (1 << 6)
+
 #define MS_NODEV (1 << 0)
 #define MS_NOEXEC (1 << 1)
 #define MS_NOSUID (1 << 2)
@@ -62,8 +70,16 @@ enum {
     PERF_EVENT_KMALLOC = 2048,
     PERF_EVENT_KFREE = 4096,
     PERF_EVENT_PAGE_FAULT = 8192,
+    PERF_EVENT_PMC_SAMPLE = 16384,
 };
 
+// Which hardware performance counters to take PERF_EVENT_PMC_SAMPLE samples of.
+#define PERF_EVENT_PMC_CYCLES (1ull << 32)
+#define PERF_EVENT_PMC_CACHE_MISSES (1ull << 33)
+#define PERF_EVENT_PMC_BRANCH_MISSES (1ull << 34)
+#define PERF_EVENT_PMC_LLC_LOADS (1ull << 35)
+#define PERF_EVENT_PMC_MASK (PERF_EVENT_PMC_CYCLES | PERF_EVENT_PMC_CACHE_MISSES | PERF_EVENT_PMC_BRANCH_MISSES | PERF_EVENT_PMC_LLC_LOADS)
+
 #define WNOHANG 1
 #define WUNTRACED 2
 #define WSTOPPED WUNTRACED
@@ -99,6 +115,9 @@ enum {
 #define PROT_EXEC 0x4
 #define PROT_NONE 0x0
 
+#define MADV_NORMAL 0x0
+#define MADV_RANDOM 0x1
+#define MADV_SEQUENTIAL 0x2
 #define MADV_SET_VOLATILE 0x100
 #define MADV_SET_NONVOLATILE 0x200
 
@@ -114,6 +133,17 @@ enum {
 
 #define FD_CLOEXEC 1
 
+#define POSIX_FADV_NORMAL 0
+#define POSIX_FADV_RANDOM 1
+#define POSIX_FADV_SEQUENTIAL 2
+#define POSIX_FADV_WILLNEED 3
+#define POSIX_FADV_DONTNEED 4
+#define POSIX_FADV_NOREUSE 5
+
+#define SPLICE_F_MOVE 1
+#define SPLICE_F_NONBLOCK 2
+#define SPLICE_F_MORE 4
+
 #define _FUTEX_OP_SHIFT_OP 28
 #define _FUTEX_OP_MASK_OP 0xf
 #define _FUTEX_OP_SHIFT_CMP 24
@@ -483,6 +513,33 @@ struct pollfd {
     short revents;
 };
 
+#define EPOLL_CLOEXEC (1 << 0)
+
+#define EPOLL_CTL_ADD 1
+#define EPOLL_CTL_DEL 2
+#define EPOLL_CTL_MOD 3
+
+#define EPOLLIN POLLIN
+#define EPOLLPRI POLLPRI
+#define EPOLLOUT POLLOUT
+#define EPOLLERR POLLERR
+#define EPOLLHUP POLLHUP
+#define EPOLLRDHUP POLLRDHUP
+#define EPOLLONESHOT (1u << 30)
+#define EPOLLET (1u << 31)
+
+typedef union epoll_data {
+    void* ptr;
+    int fd;
+    uint32_t u32;
+    uint64_t u64;
+} epoll_data_t;
+
+struct epoll_event {
+    uint32_t events;
+    epoll_data_t data;
+};
+
 #define AF_MASK 0xff
 #define AF_UNSPEC 0
 #define AF_LOCAL 1
@@ -495,6 +552,7 @@ struct pollfd {
 #define SOCK_STREAM 1
 #define SOCK_RAW 3
 #define SOCK_DGRAM 2
+#define SOCK_SEQPACKET 5
 #define SOCK_NONBLOCK 04000
 #define SOCK_CLOEXEC 02000000
 
@@ -528,6 +586,7 @@ enum {
 
 enum {
     SCM_TIMESTAMP,
+    SCM_RIGHTS,
 };
 
 #define IPPROTO_IP 0
@@ -540,6 +599,9 @@ enum {
 #define IP_ADD_MEMBERSHIP 4
 #define IP_DROP_MEMBERSHIP 5
 
+#define TCP_NODELAY 10
+#define TCP_CORK 11
+
 struct ucred {
     pid_t pid;
     uid_t uid;
@@ -607,6 +669,7 @@ typedef int clockid_t;
 #define CLOCK_MONOTONIC_RAW 4
 #define CLOCK_REALTIME_COARSE 5
 #define CLOCK_MONOTONIC_COARSE 6
+#define CLOCK_ID_COUNT 7
 #define TIMER_ABSTIME 99
 
 #define UTSNAME_ENTRY_LEN 65
@@ -640,10 +703,33 @@ struct msghdr {
     int msg_flags;
 };
 
+struct mmsghdr {
+    struct msghdr msg_hdr;
+    unsigned int msg_len;
+};
+
 struct sched_param {
     int sched_priority;
 };
 
+#define SCHED_FIFO 0
+#define SCHED_RR 1
+#define SCHED_OTHER 2
+#define SCHED_BATCH 3
+#define SCHED_DEADLINE 6
+
+struct sched_attr {
+    u32 size;
+    u32 sched_policy;
+    u64 sched_flags;
+    i32 sched_nice;
+    u32 sched_priority;
+    // The following are only used with SCHED_DEADLINE. All values are in nanoseconds.
+    u64 sched_runtime;
+    u64 sched_deadline;
+    u64 sched_period;
+};
+
 struct ifreq {
 #define IFNAMSIZ 16
     char ifr_name[IFNAMSIZ];
@@ -680,6 +766,7 @@ struct ifreq {
 };
 
 struct rtentry {
+    struct sockaddr rt_dst;     /* the target address */
     struct sockaddr rt_gateway; /* the gateway address */
     struct sockaddr rt_genmask; /* the target network mask */
     unsigned short int rt_flags;
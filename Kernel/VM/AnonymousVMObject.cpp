@@ -111,9 +111,20 @@ AnonymousVMObject::AnonymousVMObject(size_t size, AllocationStrategy strategy)
     , m_unused_committed_pages(strategy == AllocationStrategy::Reserve ? page_count() : 0)
 {
     if (strategy == AllocationStrategy::AllocateNow) {
-        // Allocate all pages right now. We know we can get all because we committed the amount needed
-        for (size_t i = 0; i < page_count(); ++i)
-            physical_pages()[i] = MM.allocate_committed_user_physical_page(MemoryManager::ShouldZeroFill::Yes);
+        // Allocate all pages right now. We know we can get all because we committed the amount needed.
+        // Where physical memory allows it, take them in huge page sized chunks so they can be mapped as such.
+        for (size_t i = 0; i < page_count();) {
+            if (!(i % pages_per_huge_page) && page_count() - i >= pages_per_huge_page) {
+                auto huge_page = MM.allocate_committed_user_physical_huge_page(MemoryManager::ShouldZeroFill::Yes);
+                if (!huge_page.is_empty()) {
+                    for (size_t j = 0; j < pages_per_huge_page; ++j)
+                        physical_pages()[i + j] = huge_page[j];
+                    i += pages_per_huge_page;
+                    continue;
+                }
+            }
+            physical_pages()[i++] = MM.allocate_committed_user_physical_page(MemoryManager::ShouldZeroFill::Yes);
+        }
     } else {
         auto& initial_page = (strategy == AllocationStrategy::Reserve) ? MM.lazy_committed_page() : MM.shared_zero_page();
         for (size_t i = 0; i < page_count(); ++i)
@@ -270,6 +281,25 @@ NonnullRefPtr<PhysicalPage> AnonymousVMObject::allocate_committed_page(Badge<Reg
     return MM.allocate_committed_user_physical_page(MemoryManager::ShouldZeroFill::Yes);
 }
 
+bool AnonymousVMObject::try_allocate_committed_huge_page(Badge<Region>, size_t first_page_index)
+{
+    ScopedSpinLock lock(m_lock);
+    VERIFY(first_page_index + pages_per_huge_page <= page_count());
+    if (m_unused_committed_pages < pages_per_huge_page)
+        return false;
+    for (size_t i = 0; i < pages_per_huge_page; ++i) {
+        if (!physical_pages()[first_page_index + i]->is_lazy_committed_page())
+            return false;
+    }
+    auto huge_page = MM.allocate_committed_user_physical_huge_page(MemoryManager::ShouldZeroFill::Yes);
+    if (huge_page.is_empty())
+        return false;
+    m_unused_committed_pages -= pages_per_huge_page;
+    for (size_t i = 0; i < pages_per_huge_page; ++i)
+        physical_pages()[first_page_index + i] = huge_page[i];
+    return true;
+}
+
 Bitmap& AnonymousVMObject::ensure_cow_map()
 {
     if (m_cow_map.is_null())
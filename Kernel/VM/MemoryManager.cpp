@@ -7,6 +7,9 @@
 #include <AK/Assertions.h>
 #include <AK/Memory.h>
 #include <AK/StringView.h>
+#include <Kernel/ACPI/Parser.h>
+#include <Kernel/Arch/x86/CPUID.h>
+#include <Kernel/Arch/x86/InterruptDisabler.h>
 #include <Kernel/BootInfo.h>
 #include <Kernel/CMOS.h>
 #include <Kernel/FileSystem/Inode.h>
@@ -16,11 +19,15 @@
 #include <Kernel/Process.h>
 #include <Kernel/Sections.h>
 #include <Kernel/StdLib.h>
+#include <Kernel/Tasks/PageZeroingTask.h>
+#include <Kernel/Tasks/ReclaimTask.h>
+#include <Kernel/Tracepoints.h>
 #include <Kernel/VM/AnonymousVMObject.h>
 #include <Kernel/VM/MemoryManager.h>
 #include <Kernel/VM/PageDirectory.h>
 #include <Kernel/VM/PhysicalRegion.h>
 #include <Kernel/VM/SharedInodeVMObject.h>
+#include <Kernel/VM/TypedMapping.h>
 
 extern u8 start_of_kernel_image[];
 extern u8 end_of_kernel_image[];
@@ -512,7 +519,8 @@ PageTableEntry* MemoryManager::pte(PageDirectory& page_directory, VirtualAddress
 
     auto* pd = quickmap_pd(const_cast<PageDirectory&>(page_directory), page_directory_table_index);
     PageDirectoryEntry const& pde = pd[page_directory_index];
-    if (!pde.is_present())
+    // NOTE: Huge pages don't have a page table, use ensure_pte() if one is needed.
+    if (!pde.is_present() || pde.is_huge())
         return nullptr;
 
     return &quickmap_pt(PhysicalAddress((FlatPtr)pde.page_table_base()))[page_table_index];
@@ -529,6 +537,12 @@ PageTableEntry* MemoryManager::ensure_pte(PageDirectory& page_directory, Virtual
 
     auto* pd = quickmap_pd(page_directory, page_directory_table_index);
     PageDirectoryEntry& pde = pd[page_directory_index];
+    if (pde.is_present() && pde.is_huge()) {
+        if (!split_huge_page(page_directory, vaddr))
+            return nullptr;
+        pd = quickmap_pd(page_directory, page_directory_table_index);
+        VERIFY(&pde == &pd[page_directory_index]); // Sanity check
+    }
     if (!pde.is_present()) {
         bool did_purge = false;
         auto page_table = allocate_user_physical_page(ShouldZeroFill::Yes, &did_purge);
@@ -571,6 +585,8 @@ void MemoryManager::release_pte(PageDirectory& page_directory, VirtualAddress va
 
     auto* pd = quickmap_pd(page_directory, page_directory_table_index);
     PageDirectoryEntry& pde = pd[page_directory_index];
+    // Huge pages are only ever mapped for regions covering all of them, and are released with release_huge_pde().
+    VERIFY(!pde.is_huge());
     if (pde.is_present()) {
         auto* page_table = quickmap_pt(PhysicalAddress((FlatPtr)pde.page_table_base()));
         auto& pte = page_table[page_table_index];
@@ -596,6 +612,89 @@ void MemoryManager::release_pte(PageDirectory& page_directory, VirtualAddress va
     }
 }
 
+PageDirectoryEntry* MemoryManager::ensure_huge_pde(PageDirectory& page_directory, VirtualAddress vaddr)
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    VERIFY(s_mm_lock.own_lock());
+    VERIFY(page_directory.get_lock().own_lock());
+    VERIFY(!(vaddr.get() % huge_page_size));
+    u32 page_directory_table_index = (vaddr.get() >> 30) & 0x1ff;
+    u32 page_directory_index = (vaddr.get() >> 21) & 0x1ff;
+
+    auto* pd = quickmap_pd(page_directory, page_directory_table_index);
+    PageDirectoryEntry& pde = pd[page_directory_index];
+    if (pde.is_present() && !pde.is_huge()) {
+        // The caller is about to map the entire 2 MiB with this entry, so the page table can go.
+        pde.clear();
+        auto result = page_directory.m_page_tables.remove(vaddr.get());
+        VERIFY(result);
+    }
+    return &pde;
+}
+
+bool MemoryManager::release_huge_pde(PageDirectory& page_directory, VirtualAddress vaddr)
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    VERIFY(s_mm_lock.own_lock());
+    VERIFY(page_directory.get_lock().own_lock());
+    VERIFY(!(vaddr.get() % huge_page_size));
+    u32 page_directory_table_index = (vaddr.get() >> 30) & 0x1ff;
+    u32 page_directory_index = (vaddr.get() >> 21) & 0x1ff;
+
+    auto* pd = quickmap_pd(page_directory, page_directory_table_index);
+    PageDirectoryEntry& pde = pd[page_directory_index];
+    if (!pde.is_present() || !pde.is_huge())
+        return false;
+    pde.clear();
+    return true;
+}
+
+bool MemoryManager::split_huge_page(PageDirectory& page_directory, VirtualAddress vaddr)
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    VERIFY(s_mm_lock.own_lock());
+    VERIFY(page_directory.get_lock().own_lock());
+    u32 page_directory_table_index = (vaddr.get() >> 30) & 0x1ff;
+    u32 page_directory_index = (vaddr.get() >> 21) & 0x1ff;
+
+    // Every entry gets written below, so there's no need to zero-fill the new page table.
+    auto page_table = allocate_user_physical_page(ShouldZeroFill::No);
+    if (!page_table) {
+        dbgln("MM: Unable to allocate page table to split huge page at {}", vaddr);
+        return false;
+    }
+
+    // Allocating may have purged memory and remapped the quickmapped page directory, so look it up again.
+    auto* pd = quickmap_pd(page_directory, page_directory_table_index);
+    PageDirectoryEntry& pde = pd[page_directory_index];
+    VERIFY(pde.is_present() && pde.is_huge());
+
+    auto* page_table_entries = quickmap_pt(page_table->paddr());
+    for (size_t i = 0; i < pages_per_huge_page; ++i) {
+        auto& pte = page_table_entries[i];
+        pte.clear();
+        pte.set_physical_page_base(pde.page_table_base() + i * PAGE_SIZE);
+        pte.set_present(true);
+        pte.set_writable(pde.is_writable());
+        pte.set_user_allowed(pde.is_user_allowed());
+        pte.set_write_through(pde.is_write_through());
+        pte.set_cache_disabled(pde.is_cache_disabled());
+        pte.set_global(pde.is_global());
+        pte.set_execute_disabled(pde.is_execute_disabled());
+    }
+
+    // The translation for every address stays the same, so the TLB doesn't need flushing here.
+    pde.clear();
+    pde.set_page_table_base(page_table->paddr().get());
+    pde.set_user_allowed(true);
+    pde.set_present(true);
+    pde.set_writable(true);
+    pde.set_global(&page_directory == m_kernel_page_directory.ptr());
+    auto result = page_directory.m_page_tables.set(vaddr.get() & ~(FlatPtr)0x1fffff, move(page_table));
+    VERIFY(result == AK::HashSetResult::InsertedNewEntry);
+    return true;
+}
+
 UNMAP_AFTER_INIT void MemoryManager::initialize(u32 cpu)
 {
     ProcessorSpecific<MemoryManagerData>::initialize();
@@ -603,7 +702,123 @@ UNMAP_AFTER_INIT void MemoryManager::initialize(u32 cpu)
     if (cpu == 0) {
         new MemoryManager;
         kmalloc_enable_expand();
+    } else {
+        MM.set_current_processor_numa_node();
+    }
+}
+
+UNMAP_AFTER_INIT u8 MemoryManager::numa_node_for_proximity_domain(u32 proximity_domain)
+{
+    for (size_t i = 0; i < m_numa_proximity_domains.size(); ++i) {
+        if (m_numa_proximity_domains[i] == proximity_domain)
+            return i;
+    }
+    if (m_numa_proximity_domains.size() == max_numa_node_count) {
+        dmesgln("MM: Too many NUMA nodes, folding proximity domain {} into node {}", proximity_domain, max_numa_node_count - 1);
+        return max_numa_node_count - 1;
+    }
+    m_numa_proximity_domains.append(proximity_domain);
+    return m_numa_proximity_domains.size() - 1;
+}
+
+u8 MemoryManager::numa_node_for_physical_address(PhysicalAddress paddr) const
+{
+    for (auto& range : m_numa_memory_ranges) {
+        if (paddr >= range.base && paddr.get() - range.base.get() < range.length)
+            return range.node;
     }
+    return 0;
+}
+
+UNMAP_AFTER_INIT void MemoryManager::set_current_processor_numa_node()
+{
+    if (m_numa_node_for_apic_id.is_empty())
+        return;
+    u32 apic_id = CPUID(1).ebx() >> 24;
+    auto numa_node = m_numa_node_for_apic_id.get(apic_id);
+    get_data().m_numa_node = numa_node.value_or(0);
+    dmesgln("MM: CPU[{}] (APIC ID {}) is in NUMA node {}", Processor::id(), apic_id, get_data().m_numa_node);
+}
+
+UNMAP_AFTER_INIT void MemoryManager::initialize_numa_nodes()
+{
+    if (!ACPI::is_enabled())
+        return;
+    auto srat_address = ACPI::Parser::the()->find_table("SRAT");
+    if (srat_address.is_null())
+        return;
+
+    auto srat = map_typed<ACPI::Structures::SRAT>(srat_address);
+    size_t entries_length = srat->h.length - sizeof(ACPI::Structures::SRAT);
+    auto const* entry = srat->entries;
+    while (entries_length >= sizeof(ACPI::Structures::SRATEntryHeader)) {
+        size_t entry_length = entry->length;
+        if (entry_length < sizeof(ACPI::Structures::SRATEntryHeader) || entry_length > entries_length)
+            break;
+        switch (entry->type) {
+        case (u8)ACPI::Structures::SRATEntryType::ProcessorLocalAPICAffinity: {
+            auto* affinity = (ACPI::Structures::SRATEntries::ProcessorLocalAPICAffinity const*)entry;
+            if (!(affinity->flags & ACPI::Structures::SRATEntries::AFFINITY_ENABLED_FLAG))
+                break;
+            u32 proximity_domain = affinity->proximity_domain_low
+                | (affinity->proximity_domain_high[0] << 8)
+                | (affinity->proximity_domain_high[1] << 16)
+                | (affinity->proximity_domain_high[2] << 24);
+            m_numa_node_for_apic_id.set(affinity->apic_id, numa_node_for_proximity_domain(proximity_domain));
+            break;
+        }
+        case (u8)ACPI::Structures::SRATEntryType::ProcessorLocalx2APICAffinity: {
+            auto* affinity = (ACPI::Structures::SRATEntries::ProcessorLocalx2APICAffinity const*)entry;
+            if (!(affinity->flags & ACPI::Structures::SRATEntries::AFFINITY_ENABLED_FLAG))
+                break;
+            m_numa_node_for_apic_id.set(affinity->x2apic_id, numa_node_for_proximity_domain(affinity->proximity_domain));
+            break;
+        }
+        case (u8)ACPI::Structures::SRATEntryType::MemoryAffinity: {
+            auto* affinity = (ACPI::Structures::SRATEntries::MemoryAffinity const*)entry;
+            if (!(affinity->flags & ACPI::Structures::SRATEntries::AFFINITY_ENABLED_FLAG))
+                break;
+            NumaMemoryRange range;
+            range.base = PhysicalAddress(((PhysicalPtr)affinity->base_address_high << 32) | affinity->base_address_low);
+            range.length = ((PhysicalSize)affinity->length_high << 32) | affinity->length_low;
+            range.node = numa_node_for_proximity_domain(affinity->proximity_domain);
+            dmesgln("MM: NUMA node {} (proximity domain {}) memory @ {} (size {:#x})", range.node, affinity->proximity_domain, range.base, range.length);
+            m_numa_memory_ranges.append(range);
+            break;
+        }
+        default:
+            break;
+        }
+        entries_length -= entry_length;
+        entry = (ACPI::Structures::SRATEntryHeader const*)((FlatPtr)entry + entry_length);
+    }
+
+    if (m_numa_proximity_domains.size() <= 1)
+        return;
+
+    ScopedSpinLock lock(s_mm_lock);
+    for (auto& region : m_user_physical_regions)
+        region.assign_numa_nodes([this](PhysicalAddress paddr) { return numa_node_for_physical_address(paddr); });
+
+    set_current_processor_numa_node();
+}
+
+Vector<MemoryManager::NumaNodeInfo> MemoryManager::numa_node_info()
+{
+    Vector<NumaNodeInfo> nodes;
+    ScopedSpinLock lock(s_mm_lock);
+    for (size_t i = 0; i < numa_node_count(); ++i) {
+        NumaNodeInfo node;
+        node.node = i;
+        node.proximity_domain = i < m_numa_proximity_domains.size() ? m_numa_proximity_domains[i] : 0;
+        // NOTE: Pages parked in the per-CPU magazines and zeroed page pools are not counted as free here.
+        for (auto& region : m_user_physical_regions) {
+            node.user_physical_pages += region.page_count_in_numa_node(i);
+            node.user_physical_pages_free += region.free_page_count_in_numa_node(i);
+        }
+        nodes.append(node);
+    }
+    return nodes;
 }
 
 Region* MemoryManager::kernel_region_from_vaddr(VirtualAddress vaddr)
@@ -689,6 +904,7 @@ PageFaultResponse MemoryManager::handle_page_fault(PageFault const& fault)
         return PageFaultResponse::ShouldCrash;
     }
     dbgln_if(PAGE_FAULT_DEBUG, "MM: CPU[{}] handle_page_fault({:#04x}) at {}", Processor::id(), fault.code(), fault.vaddr());
+    TRACEPOINT(PageFault, fault.vaddr().get(), fault.code());
     auto* region = find_region_from_vaddr(fault.vaddr());
     if (!region) {
         return PageFaultResponse::ShouldCrash;
@@ -718,7 +934,9 @@ OwnPtr<Region> MemoryManager::allocate_kernel_region(size_t size, StringView nam
     if (!vm_object)
         return {};
     ScopedSpinLock lock(s_mm_lock);
-    auto range = kernel_page_directory().range_allocator().allocate_anywhere(size);
+    // Align big regions to huge page boundaries so that they can be mapped with huge pages.
+    auto alignment = size >= huge_page_size ? huge_page_size : PAGE_SIZE;
+    auto range = kernel_page_directory().range_allocator().allocate_anywhere(size, alignment);
     if (!range.has_value())
         return {};
     return allocate_kernel_region_with_vmobject(range.value(), vm_object.release_nonnull(), name, access, cacheable);
@@ -772,44 +990,197 @@ OwnPtr<Region> MemoryManager::allocate_kernel_region_with_vmobject(VMObject& vmo
 bool MemoryManager::commit_user_physical_pages(size_t page_count)
 {
     VERIFY(page_count > 0);
-    ScopedSpinLock lock(s_mm_lock);
-    if (m_system_memory_info.user_physical_pages_uncommitted < page_count)
+    if (!try_take_uncommitted_user_physical_pages(page_count))
         return false;
-
-    m_system_memory_info.user_physical_pages_uncommitted -= page_count;
-    m_system_memory_info.user_physical_pages_committed += page_count;
+    AK::atomic_fetch_add(&m_system_memory_info.user_physical_pages_committed, static_cast<PhysicalSize>(page_count));
     return true;
 }
 
 void MemoryManager::uncommit_user_physical_pages(size_t page_count)
 {
     VERIFY(page_count > 0);
-    ScopedSpinLock lock(s_mm_lock);
-    VERIFY(m_system_memory_info.user_physical_pages_committed >= page_count);
+    auto committed_page_count = AK::atomic_fetch_sub(&m_system_memory_info.user_physical_pages_committed, static_cast<PhysicalSize>(page_count));
+    VERIFY(committed_page_count >= page_count);
+    AK::atomic_fetch_add(&m_system_memory_info.user_physical_pages_uncommitted, static_cast<PhysicalSize>(page_count));
+}
 
-    m_system_memory_info.user_physical_pages_uncommitted += page_count;
-    m_system_memory_info.user_physical_pages_committed -= page_count;
+bool MemoryManager::try_take_uncommitted_user_physical_pages(size_t page_count)
+{
+    // This is called both with and without s_mm_lock held, so the counter has to be updated atomically.
+    auto& uncommitted = m_system_memory_info.user_physical_pages_uncommitted;
+    auto uncommitted_page_count = AK::atomic_load(&uncommitted, AK::memory_order_relaxed);
+    do {
+        if (uncommitted_page_count < page_count)
+            return false;
+    } while (!AK::atomic_compare_exchange_strong(&uncommitted, uncommitted_page_count, uncommitted_page_count - page_count, AK::memory_order_relaxed));
+    did_consume_uncommitted_pages();
+    return true;
 }
 
-void MemoryManager::deallocate_physical_page(PhysicalAddress paddr)
+PhysicalRegion* MemoryManager::user_physical_region_containing(PhysicalAddress paddr)
 {
-    ScopedSpinLock lock(s_mm_lock);
+    // The set of user physical regions doesn't change after boot, so this needs no locking.
+    for (auto& region : m_user_physical_regions) {
+        if (region.contains(paddr))
+            return &region;
+    }
+    return nullptr;
+}
 
-    // Are we returning a user page?
+bool MemoryManager::try_account_for_free_user_physical_page(bool committed)
+{
+    if (committed) {
+        auto committed_page_count = AK::atomic_fetch_sub(&m_system_memory_info.user_physical_pages_committed, static_cast<PhysicalSize>(1));
+        VERIFY(committed_page_count > 0);
+    } else if (!try_take_uncommitted_user_physical_pages(1)) {
+        return false;
+    }
+    AK::atomic_fetch_add(&m_system_memory_info.user_physical_pages_used, static_cast<PhysicalSize>(1));
+    return true;
+}
+
+RefPtr<PhysicalPage> MemoryManager::take_user_physical_page_from_magazine(bool committed)
+{
+    auto& magazine = get_data().m_physical_page_magazine;
+    ScopedSpinLock lock(magazine.lock);
+    if (magazine.count == 0)
+        return {};
+    if (!try_account_for_free_user_physical_page(committed))
+        return {};
+    return PhysicalPage::create(magazine.pages[--magazine.count]);
+}
+
+RefPtr<PhysicalPage> MemoryManager::take_zeroed_user_physical_page(bool committed)
+{
     for (auto& region : m_user_physical_regions) {
-        if (!region.contains(paddr))
+        auto paddr = region.take_zeroed_page();
+        if (!paddr.has_value())
             continue;
+        if (region.zeroed_page_count() < region.zeroed_page_target() / 2)
+            PageZeroingTask::notify_zeroed_pages_wanted();
+        if (!try_account_for_free_user_physical_page(committed)) {
+            if (!region.add_zeroed_page(paddr.value())) {
+                ScopedSpinLock lock(s_mm_lock);
+                region.return_page(paddr.value());
+            }
+            return {};
+        }
+        return PhysicalPage::create(paddr.value());
+    }
+    return {};
+}
 
-        region.return_page(paddr);
-        --m_system_memory_info.user_physical_pages_used;
+size_t MemoryManager::zero_free_user_physical_pages(size_t max_page_count)
+{
+    size_t zeroed_page_count = 0;
+    for (auto& region : m_user_physical_regions) {
+        while (zeroed_page_count < max_page_count && region.zeroed_page_count() < region.zeroed_page_target()) {
+            // Don't tie up free pages while we're trying to reclaim memory.
+            if (memory_pressure_level() != MemoryPressureLevel::None)
+                return zeroed_page_count;
+            PhysicalAddress paddr;
+            {
+                ScopedSpinLock lock(s_mm_lock);
+                if (!region.take_free_pages({ &paddr, 1 }))
+                    break;
+            }
+            {
+                InterruptDisabler disabler;
+                auto* ptr = quickmap_page(paddr);
+                memset(ptr, 0, PAGE_SIZE);
+                unquickmap_page();
+            }
+            if (!region.add_zeroed_page(paddr)) {
+                ScopedSpinLock lock(s_mm_lock);
+                region.return_page(paddr);
+                break;
+            }
+            ++zeroed_page_count;
+        }
+    }
+    return zeroed_page_count;
+}
+
+bool MemoryManager::return_user_physical_page_to_magazine(PhysicalAddress paddr)
+{
+    if (!user_physical_region_containing(paddr))
+        return false;
+
+    PhysicalAddress overflow_pages[PhysicalPageMagazine::batch_size];
+    size_t overflow_page_count = 0;
+    {
+        auto& magazine = get_data().m_physical_page_magazine;
+        ScopedSpinLock lock(magazine.lock);
+        if (magazine.count == PhysicalPageMagazine::capacity) {
+            // Make room by handing the most recently freed batch back to the regions.
+            overflow_page_count = PhysicalPageMagazine::batch_size;
+            magazine.count -= overflow_page_count;
+            for (size_t i = 0; i < overflow_page_count; ++i)
+                overflow_pages[i] = magazine.pages[magazine.count + i];
+        }
+        magazine.pages[magazine.count++] = paddr;
 
         // Always return pages to the uncommitted pool. Pages that were
         // committed and allocated are only freed upon request. Once
         // returned there is no guarantee being able to get them back.
-        ++m_system_memory_info.user_physical_pages_uncommitted;
-        return;
+        AK::atomic_fetch_sub(&m_system_memory_info.user_physical_pages_used, static_cast<PhysicalSize>(1));
+        AK::atomic_fetch_add(&m_system_memory_info.user_physical_pages_uncommitted, static_cast<PhysicalSize>(1));
     }
 
+    // The magazine lock nests inside s_mm_lock, so only take s_mm_lock once we've let go of it.
+    if (overflow_page_count) {
+        ScopedSpinLock lock(s_mm_lock);
+        return_user_physical_pages_to_regions({ overflow_pages, overflow_page_count });
+    }
+    return true;
+}
+
+void MemoryManager::return_user_physical_pages_to_regions(Span<PhysicalAddress const> pages)
+{
+    VERIFY(s_mm_lock.is_locked());
+    for (auto& paddr : pages) {
+        auto* region = user_physical_region_containing(paddr);
+        VERIFY(region);
+        region->return_page(paddr);
+    }
+}
+
+void MemoryManager::refill_user_physical_page_magazine()
+{
+    VERIFY(s_mm_lock.is_locked());
+    auto& magazine = get_data().m_physical_page_magazine;
+    ScopedSpinLock lock(magazine.lock);
+    for (auto& region : m_user_physical_regions) {
+        if (magazine.count >= PhysicalPageMagazine::batch_size)
+            break;
+        magazine.count += region.take_free_pages({ magazine.pages + magazine.count, PhysicalPageMagazine::batch_size - magazine.count }, get_data().m_numa_node);
+    }
+}
+
+void MemoryManager::drain_user_physical_page_magazines()
+{
+    VERIFY(s_mm_lock.is_locked());
+    Processor::for_each([&](Processor& processor) {
+        auto* mm_data = processor.get_specific<MemoryManagerData>();
+        if (!mm_data)
+            return;
+        auto& magazine = mm_data->m_physical_page_magazine;
+        ScopedSpinLock lock(magazine.lock);
+        if (magazine.count == 0)
+            return;
+        return_user_physical_pages_to_regions({ magazine.pages, magazine.count });
+        magazine.count = 0;
+    });
+}
+
+void MemoryManager::deallocate_physical_page(PhysicalAddress paddr)
+{
+    // Are we returning a user page?
+    if (return_user_physical_page_to_magazine(paddr))
+        return;
+
+    ScopedSpinLock lock(s_mm_lock);
+
     // If it's not a user page, it should be a supervisor page.
     for (auto& region : m_super_physical_regions) {
         if (!region.contains(paddr)) {
@@ -828,33 +1199,58 @@ void MemoryManager::deallocate_physical_page(PhysicalAddress paddr)
 RefPtr<PhysicalPage> MemoryManager::find_free_user_physical_page(bool committed)
 {
     VERIFY(s_mm_lock.is_locked());
+    if (auto page = take_user_physical_page_from_magazine(committed))
+        return page;
+
     RefPtr<PhysicalPage> page;
     if (committed) {
         // Draw from the committed pages pool. We should always have these pages available
-        VERIFY(m_system_memory_info.user_physical_pages_committed > 0);
-        m_system_memory_info.user_physical_pages_committed--;
+        auto committed_page_count = AK::atomic_fetch_sub(&m_system_memory_info.user_physical_pages_committed, static_cast<PhysicalSize>(1));
+        VERIFY(committed_page_count > 0);
     } else {
         // We need to make sure we don't touch pages that we have committed to
-        if (m_system_memory_info.user_physical_pages_uncommitted == 0)
+        if (!try_take_uncommitted_user_physical_pages(1))
             return {};
-        m_system_memory_info.user_physical_pages_uncommitted--;
     }
+    auto numa_node = get_data().m_numa_node;
     for (auto& region : m_user_physical_regions) {
-        page = region.take_free_page();
-        if (!page.is_null()) {
-            ++m_system_memory_info.user_physical_pages_used;
+        page = region.take_free_page(numa_node);
+        if (!page.is_null())
             break;
+    }
+    if (page.is_null()) {
+        // The free pages we're accounting for are sitting in the magazines or the zeroed page pools.
+        drain_user_physical_page_magazines();
+        for (auto& region : m_user_physical_regions)
+            region.return_zeroed_pages();
+        for (auto& region : m_user_physical_regions) {
+            page = region.take_free_page(numa_node);
+            if (!page.is_null())
+                break;
         }
     }
     VERIFY(!committed || !page.is_null());
+    if (!page.is_null()) {
+        AK::atomic_fetch_add(&m_system_memory_info.user_physical_pages_used, static_cast<PhysicalSize>(1));
+        refill_user_physical_page_magazine();
+    }
     return page;
 }
 
 NonnullRefPtr<PhysicalPage> MemoryManager::allocate_committed_user_physical_page(ShouldZeroFill should_zero_fill)
 {
-    ScopedSpinLock lock(s_mm_lock);
-    auto page = find_free_user_physical_page(true);
     if (should_zero_fill == ShouldZeroFill::Yes) {
+        if (auto page = take_zeroed_user_physical_page(true))
+            return page.release_nonnull();
+    }
+
+    auto page = take_user_physical_page_from_magazine(true);
+    if (!page) {
+        ScopedSpinLock lock(s_mm_lock);
+        page = find_free_user_physical_page(true);
+    }
+    if (should_zero_fill == ShouldZeroFill::Yes) {
+        InterruptDisabler disabler;
         auto* ptr = quickmap_page(*page);
         memset(ptr, 0, PAGE_SIZE);
         unquickmap_page();
@@ -864,6 +1260,26 @@ NonnullRefPtr<PhysicalPage> MemoryManager::allocate_committed_user_physical_page
 
 RefPtr<PhysicalPage> MemoryManager::allocate_user_physical_page(ShouldZeroFill should_zero_fill, bool* did_purge)
 {
+    if (should_zero_fill == ShouldZeroFill::Yes) {
+        if (auto page = take_zeroed_user_physical_page(false)) {
+            if (did_purge)
+                *did_purge = false;
+            return page;
+        }
+    }
+
+    if (auto page = take_user_physical_page_from_magazine(false)) {
+        if (should_zero_fill == ShouldZeroFill::Yes) {
+            InterruptDisabler disabler;
+            auto* ptr = quickmap_page(*page);
+            memset(ptr, 0, PAGE_SIZE);
+            unquickmap_page();
+        }
+        if (did_purge)
+            *did_purge = false;
+        return page;
+    }
+
     ScopedSpinLock lock(s_mm_lock);
     auto page = find_free_user_physical_page(false);
     bool purged_pages = false;
@@ -886,6 +1302,21 @@ RefPtr<PhysicalPage> MemoryManager::allocate_user_physical_page(ShouldZeroFill s
             }
             return IterationDecision::Continue;
         });
+        if (!page) {
+            // Next, drop clean file pages from the page cache. They can always be read back in.
+            for_each_vmobject([&](auto& vmobject) {
+                if (!vmobject.is_shared_inode())
+                    return IterationDecision::Continue;
+                if (static_cast<InodeVMObject&>(vmobject).release_all_clean_pages()) {
+                    page = find_free_user_physical_page(false);
+                    if (page) {
+                        purged_pages = true;
+                        return IterationDecision::Break;
+                    }
+                }
+                return IterationDecision::Continue;
+            });
+        }
         if (!page) {
             dmesgln("MM: no user physical pages available");
             return {};
@@ -903,6 +1334,71 @@ RefPtr<PhysicalPage> MemoryManager::allocate_user_physical_page(ShouldZeroFill s
     return page;
 }
 
+NonnullRefPtrVector<PhysicalPage> MemoryManager::find_free_user_physical_huge_page(bool committed)
+{
+    VERIFY(s_mm_lock.is_locked());
+    if (committed) {
+        VERIFY(m_system_memory_info.user_physical_pages_committed >= pages_per_huge_page);
+    } else {
+        if (!try_take_uncommitted_user_physical_pages(pages_per_huge_page))
+            return {};
+    }
+
+    NonnullRefPtrVector<PhysicalPage> physical_pages;
+    for (auto& region : m_user_physical_regions) {
+        physical_pages = region.take_contiguous_free_pages(pages_per_huge_page, huge_page_size, get_data().m_numa_node);
+        if (!physical_pages.is_empty())
+            break;
+    }
+
+    // Physical memory may simply be too fragmented, callers fall back to individual pages.
+    if (physical_pages.is_empty()) {
+        if (!committed)
+            AK::atomic_fetch_add(&m_system_memory_info.user_physical_pages_uncommitted, static_cast<PhysicalSize>(pages_per_huge_page));
+        return {};
+    }
+
+    if (committed)
+        AK::atomic_fetch_sub(&m_system_memory_info.user_physical_pages_committed, static_cast<PhysicalSize>(pages_per_huge_page));
+    AK::atomic_fetch_add(&m_system_memory_info.user_physical_pages_used, static_cast<PhysicalSize>(pages_per_huge_page));
+    return physical_pages;
+}
+
+void MemoryManager::did_consume_uncommitted_pages()
+{
+    if (AK::atomic_load(&m_system_memory_info.user_physical_pages_uncommitted, AK::memory_order_relaxed) < low_watermark())
+        ReclaimTask::notify_low_memory();
+}
+
+MemoryPressureLevel MemoryManager::memory_pressure_level()
+{
+    ScopedSpinLock lock(s_mm_lock);
+    auto uncommitted = m_system_memory_info.user_physical_pages_uncommitted;
+    if (uncommitted < critical_watermark())
+        return MemoryPressureLevel::Critical;
+    if (uncommitted < low_watermark())
+        return MemoryPressureLevel::Low;
+    return MemoryPressureLevel::None;
+}
+
+void MemoryManager::zero_fill_physical_pages(NonnullRefPtrVector<PhysicalPage>& physical_pages)
+{
+    for (auto& page : physical_pages) {
+        auto* ptr = quickmap_page(page);
+        memset(ptr, 0, PAGE_SIZE);
+        unquickmap_page();
+    }
+}
+
+NonnullRefPtrVector<PhysicalPage> MemoryManager::allocate_committed_user_physical_huge_page(ShouldZeroFill should_zero_fill)
+{
+    ScopedSpinLock lock(s_mm_lock);
+    auto physical_pages = find_free_user_physical_huge_page(true);
+    if (should_zero_fill == ShouldZeroFill::Yes)
+        zero_fill_physical_pages(physical_pages);
+    return physical_pages;
+}
+
 NonnullRefPtrVector<PhysicalPage> MemoryManager::allocate_contiguous_supervisor_physical_pages(size_t size)
 {
     VERIFY(!(size % PAGE_SIZE));
@@ -913,7 +1409,14 @@ NonnullRefPtrVector<PhysicalPage> MemoryManager::allocate_contiguous_supervisor_
     for (auto& region : m_super_physical_regions) {
         physical_pages = region.take_contiguous_free_pages(count);
         if (!physical_pages.is_empty())
-            continue;
+            break;
+    }
+
+    if (!physical_pages.is_empty()) {
+        m_system_memory_info.super_physical_pages_used += count;
+    } else {
+        // The super physical pages are few and get fragmented quickly, so fall back to user physical memory.
+        physical_pages = allocate_contiguous_user_physical_pages(count);
     }
 
     if (physical_pages.is_empty()) {
@@ -928,10 +1431,247 @@ NonnullRefPtrVector<PhysicalPage> MemoryManager::allocate_contiguous_supervisor_
 
     auto cleanup_region = MM.allocate_kernel_region(physical_pages[0].paddr(), PAGE_SIZE * count, "MemoryManager Allocation Sanitization", Region::Access::Read | Region::Access::Write);
     fast_u32_fill((u32*)cleanup_region->vaddr().as_ptr(), 0, (PAGE_SIZE * count) / sizeof(u32));
-    m_system_memory_info.super_physical_pages_used += count;
     return physical_pages;
 }
 
+// Contiguous allocations are mostly DMA buffers, and plenty of devices can only address the first 4 GiB.
+static constexpr PhysicalPtr contiguous_user_physical_pages_limit = 4 * GiB;
+
+NonnullRefPtrVector<PhysicalPage> MemoryManager::allocate_contiguous_user_physical_pages(size_t count)
+{
+    VERIFY(s_mm_lock.is_locked());
+    if (!try_take_uncommitted_user_physical_pages(count))
+        return {};
+
+    auto take_contiguous_free_pages = [&]() -> NonnullRefPtrVector<PhysicalPage> {
+        for (auto& region : m_user_physical_regions) {
+            if (region.upper().get() > contiguous_user_physical_pages_limit)
+                continue;
+            auto physical_pages = region.take_contiguous_free_pages(count);
+            if (!physical_pages.is_empty())
+                return physical_pages;
+        }
+        return {};
+    };
+
+    auto physical_pages = take_contiguous_free_pages();
+    if (physical_pages.is_empty() && compact_user_physical_memory(count))
+        physical_pages = take_contiguous_free_pages();
+
+    if (physical_pages.is_empty()) {
+        AK::atomic_fetch_add(&m_system_memory_info.user_physical_pages_uncommitted, static_cast<PhysicalSize>(count));
+        return {};
+    }
+    AK::atomic_fetch_add(&m_system_memory_info.user_physical_pages_used, static_cast<PhysicalSize>(count));
+    return physical_pages;
+}
+
+// Pages that might be mapped as part of a huge page are left alone, the mapping has no page table to update.
+static bool could_be_mapped_as_huge_page(VMObject const& vmobject, size_t page_index)
+{
+    auto physical_pages = vmobject.physical_pages();
+    auto first_paddr = physical_pages[page_index]->paddr().get() & ~(PhysicalPtr)(huge_page_size - 1);
+    size_t offset_in_huge_page = (physical_pages[page_index]->paddr().get() - first_paddr) / PAGE_SIZE;
+    if (page_index < offset_in_huge_page || page_index - offset_in_huge_page + pages_per_huge_page > physical_pages.size())
+        return false;
+    auto first_page_index = page_index - offset_in_huge_page;
+    for (size_t i = 0; i < pages_per_huge_page; ++i) {
+        auto& page = physical_pages[first_page_index + i];
+        if (!page || page->paddr().get() != first_paddr + i * PAGE_SIZE)
+            return false;
+    }
+    return true;
+}
+
+static bool is_movable_user_physical_page(VMObject const& vmobject, size_t page_index)
+{
+    auto& page = vmobject.physical_pages()[page_index];
+    if (!page || page->is_shared_zero_page() || page->is_lazy_committed_page())
+        return false;
+    // Anyone else holding a reference (a COW clone, a DMA transfer, ...) may depend on the page staying put.
+    if (page->ref_count() != 1)
+        return false;
+    return !could_be_mapped_as_huge_page(vmobject, page_index);
+}
+
+static constexpr size_t max_compaction_blocks_per_zone = 4096 / 2;
+static u16 s_compaction_free_page_counts[max_compaction_blocks_per_zone];
+
+bool MemoryManager::compact_user_physical_memory(size_t page_count)
+{
+    VERIFY(s_mm_lock.is_locked());
+    size_t block_page_count = 1;
+    while (block_page_count < page_count)
+        block_page_count <<= 1;
+    // A single free page can be found without moving anything around.
+    if (block_page_count == 1)
+        return false;
+    auto block_size = block_page_count * PAGE_SIZE;
+
+    // Free pages are only coalesced while they sit in their zone.
+    drain_user_physical_page_magazines();
+    for (auto& region : m_user_physical_regions)
+        region.return_zeroed_pages();
+
+    // First pick the few blocks that are closest to being free already.
+    struct Candidate {
+        PhysicalAddress base;
+        size_t free_page_count { 0 };
+        size_t movable_page_count { 0 };
+    };
+    static constexpr size_t max_candidate_count = 4;
+    Array<Candidate, max_candidate_count> candidates;
+    size_t candidate_count = 0;
+
+    for (auto& region : m_user_physical_regions) {
+        if (region.upper().get() > contiguous_user_physical_pages_limit)
+            continue;
+        for (auto& zone : region.zones()) {
+            if (zone.page_count() < block_page_count || (zone.base().get() % block_size))
+                continue;
+            size_t block_count = zone.page_count() / block_page_count;
+            VERIFY(block_count <= max_compaction_blocks_per_zone);
+            __builtin_memset(s_compaction_free_page_counts, 0, block_count * sizeof(u16));
+            zone.for_each_free_block([&](PhysicalAddress paddr, size_t free_page_count) {
+                s_compaction_free_page_counts[(paddr.get() - zone.base().get()) / block_size] += free_page_count;
+            });
+            for (size_t i = 0; i < block_count; ++i) {
+                size_t free_page_count = s_compaction_free_page_counts[i];
+                if (!free_page_count)
+                    continue;
+                size_t insert_index = candidate_count;
+                while (insert_index > 0 && candidates[insert_index - 1].free_page_count < free_page_count)
+                    --insert_index;
+                if (insert_index == max_candidate_count)
+                    continue;
+                for (size_t j = min(candidate_count, max_candidate_count - 1); j > insert_index; --j)
+                    candidates[j] = candidates[j - 1];
+                candidates[insert_index] = { zone.base().offset(i * block_size), free_page_count, 0 };
+                candidate_count = min(candidate_count + 1, max_candidate_count);
+            }
+        }
+    }
+
+    // Only anonymous memory that is exclusively mapped into userspace can be moved behind its owner's back.
+    auto has_movable_user_physical_pages = [](VMObject& vmobject) {
+        if (!vmobject.is_anonymous())
+            return false;
+        bool has_regions = false;
+        bool only_user_regions = true;
+        vmobject.for_each_region([&](auto& region) {
+            has_regions = true;
+            if (!region.is_user())
+                only_user_regions = false;
+        });
+        return has_regions && only_user_regions;
+    };
+
+    auto candidate_containing = [&](PhysicalAddress paddr) -> Candidate* {
+        for (size_t i = 0; i < candidate_count; ++i) {
+            if (paddr >= candidates[i].base && paddr < candidates[i].base.offset(block_size))
+                return &candidates[i];
+        }
+        return nullptr;
+    };
+
+    for (auto& vmobject : m_vmobjects) {
+        if (!has_movable_user_physical_pages(vmobject))
+            continue;
+        for (size_t i = 0; i < vmobject.page_count(); ++i) {
+            auto& page = vmobject.physical_pages()[i];
+            if (!page)
+                continue;
+            auto* candidate = candidate_containing(page->paddr());
+            if (candidate && is_movable_user_physical_page(vmobject, i))
+                ++candidate->movable_page_count;
+        }
+    }
+
+    // A block can only be freed up if every page in it is either free or movable.
+    Candidate* target = nullptr;
+    for (size_t i = 0; i < candidate_count; ++i) {
+        if (candidates[i].free_page_count + candidates[i].movable_page_count == block_page_count) {
+            target = &candidates[i];
+            break;
+        }
+    }
+    if (!target) {
+        dbgln_if(COMPACTION_DEBUG, "MM: Unable to compact user physical memory for {} contiguous pages", page_count);
+        return false;
+    }
+
+    dbgln_if(COMPACTION_DEBUG, "MM: Compacting {} pages out of {} - {}", target->movable_page_count, target->base, target->base.offset(block_size - 1));
+
+    auto block_region = allocate_kernel_region(target->base, block_size, "MemoryManager Compaction", Region::Access::Read);
+    if (!block_region)
+        return false;
+    auto is_in_target = [&](PhysicalAddress paddr) {
+        return paddr >= target->base && paddr < target->base.offset(block_size);
+    };
+
+    // Free pages handed out from inside the target block are held on to until we're done, so we never move a page back into it.
+    NonnullRefPtrVector<PhysicalPage> pages_in_target;
+    bool out_of_memory = false;
+    for (auto& vmobject : m_vmobjects) {
+        if (out_of_memory)
+            break;
+        if (!has_movable_user_physical_pages(vmobject))
+            continue;
+        for (size_t i = 0; i < vmobject.page_count(); ++i) {
+            auto& page = vmobject.physical_pages()[i];
+            if (!page || !is_in_target(page->paddr()) || !is_movable_user_physical_page(vmobject, i))
+                continue;
+            RefPtr<PhysicalPage> new_page;
+            while ((new_page = find_free_user_physical_page(false)) && is_in_target(new_page->paddr()))
+                pages_in_target.append(new_page.release_nonnull());
+            if (!new_page) {
+                out_of_memory = true;
+                break;
+            }
+            auto* old_page_contents = block_region->vaddr().offset(page->paddr().get() - target->base.get()).as_ptr();
+            migrate_user_physical_page(vmobject, i, new_page.release_nonnull(), old_page_contents);
+        }
+    }
+
+    pages_in_target.clear();
+    drain_user_physical_page_magazines();
+    for (auto& region : m_user_physical_regions)
+        region.return_zeroed_pages();
+    return !out_of_memory;
+}
+
+void MemoryManager::migrate_user_physical_page(VMObject& vmobject, size_t page_index, NonnullRefPtr<PhysicalPage> new_page, u8 const* old_page_contents)
+{
+    VERIFY(s_mm_lock.is_locked());
+    ScopedSpinLock lock(vmobject.m_lock);
+
+    // Unmap the old page everywhere first, so nobody can write to it while we copy.
+    vmobject.for_each_region([&](auto& region) {
+        size_t page_index_in_region = page_index;
+        if (!region.m_page_directory || !region.translate_vmobject_page(page_index_in_region))
+            return;
+        ScopedSpinLock page_lock(region.m_page_directory->get_lock());
+        auto vaddr = region.vaddr_from_page_index(page_index_in_region);
+        auto* pte = this->pte(*region.m_page_directory, vaddr);
+        if (!pte || !pte->is_present())
+            return;
+        pte->clear();
+        flush_tlb(region.m_page_directory.ptr(), vaddr);
+    });
+
+    {
+        InterruptDisabler disabler;
+        auto* new_page_contents = quickmap_page(*new_page);
+        memcpy(new_page_contents, old_page_contents, PAGE_SIZE);
+        unquickmap_page();
+    }
+
+    vmobject.physical_pages()[page_index] = move(new_page);
+    vmobject.for_each_region([&](auto& region) {
+        region.do_remap_vmobject_page(page_index);
+    });
+}
+
 RefPtr<PhysicalPage> MemoryManager::allocate_supervisor_physical_page()
 {
     ScopedSpinLock lock(s_mm_lock);
@@ -970,7 +1710,7 @@ void MemoryManager::enter_space(Space& space)
     ScopedSpinLock lock(s_mm_lock);
 
     current_thread->regs().cr3 = space.page_directory().cr3();
-    write_cr3(space.page_directory().cr3());
+    Processor::load_cr3(space.page_directory().cr3());
 }
 
 void MemoryManager::flush_tlb_local(VirtualAddress vaddr, size_t page_count)
@@ -1038,8 +1778,8 @@ u8* MemoryManager::quickmap_page(PhysicalAddress const& physical_address)
 {
     VERIFY_INTERRUPTS_DISABLED();
     auto& mm_data = get_data();
+    // The quickmap slot belongs to this processor, so m_quickmap_in_use is all the locking it needs.
     mm_data.m_quickmap_prev_flags = mm_data.m_quickmap_in_use.lock();
-    ScopedSpinLock lock(s_mm_lock);
 
     VirtualAddress vaddr(KERNEL_QUICKMAP_PER_CPU_BASE + Processor::id() * PAGE_SIZE);
     u32 pte_idx = (vaddr.get() - KERNEL_PT1024_BASE) / PAGE_SIZE;
@@ -1058,7 +1798,6 @@ u8* MemoryManager::quickmap_page(PhysicalAddress const& physical_address)
 void MemoryManager::unquickmap_page()
 {
     VERIFY_INTERRUPTS_DISABLED();
-    ScopedSpinLock lock(s_mm_lock);
     auto& mm_data = get_data();
     VERIFY(mm_data.m_quickmap_in_use.is_locked());
     VirtualAddress vaddr(KERNEL_QUICKMAP_PER_CPU_BASE + Processor::id() * PAGE_SIZE);
@@ -7,10 +7,12 @@
 #pragma once
 
 #include <AK/Concepts.h>
+#include <AK/HashMap.h>
 #include <AK/HashTable.h>
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/String.h>
+#include <Kernel/API/MemoryPressure.h>
 #include <Kernel/Arch/x86/PageFault.h>
 #include <Kernel/Arch/x86/TrapFrame.h>
 #include <Kernel/Forward.h>
@@ -23,6 +25,10 @@
 
 namespace Kernel {
 
+// A huge page is mapped by a single page directory entry instead of a page table.
+constexpr size_t huge_page_size = 2 * MiB;
+constexpr size_t pages_per_huge_page = huge_page_size / PAGE_SIZE;
+
 constexpr bool page_round_up_would_wrap(FlatPtr x)
 {
     return x > (explode_byte(0xFF) & ~0xFFF);
@@ -90,6 +96,18 @@ struct PhysicalMemoryRange {
 
 #define MM Kernel::MemoryManager::the()
 
+// A per-processor stash of free user physical pages. Pages move between a magazine and the
+// PhysicalRegions in batches, so most allocations and deallocations don't need s_mm_lock.
+// Pages in a magazine are still accounted for as free.
+struct PhysicalPageMagazine {
+    static constexpr size_t capacity = 64;
+    static constexpr size_t batch_size = capacity / 2;
+
+    SpinLock<u8> lock;
+    size_t count { 0 };
+    PhysicalAddress pages[capacity];
+};
+
 struct MemoryManagerData {
     static ProcessorSpecificDataID processor_specific_data_id() { return ProcessorSpecificDataID::MemoryManager; }
 
@@ -98,6 +116,11 @@ struct MemoryManagerData {
 
     PhysicalAddress m_last_quickmap_pd;
     PhysicalAddress m_last_quickmap_pt;
+
+    PhysicalPageMagazine m_physical_page_magazine;
+
+    // The NUMA node this processor belongs to, physical pages are preferably allocated from it.
+    u8 m_numa_node { 0 };
 };
 
 extern RecursiveSpinLock s_mm_lock;
@@ -107,6 +130,9 @@ class MemoryManager {
     friend class PageDirectory;
     friend class AnonymousVMObject;
     friend class Region;
+    friend class SharedInodeVMObject;
+    friend class Space;
+    friend class TmpFSInode;
     friend class VMObject;
 
 public:
@@ -115,6 +141,10 @@ public:
 
     static void initialize(u32 cpu);
 
+    // Reads the ACPI SRAT (if any) to split physical memory and processors into NUMA nodes.
+    // Without one, everything lives in node 0.
+    void initialize_numa_nodes();
+
     static inline MemoryManagerData& get_data()
     {
         return ProcessorSpecific<MemoryManagerData>::get();
@@ -143,6 +173,7 @@ public:
     void uncommit_user_physical_pages(size_t);
     NonnullRefPtr<PhysicalPage> allocate_committed_user_physical_page(ShouldZeroFill = ShouldZeroFill::Yes);
     RefPtr<PhysicalPage> allocate_user_physical_page(ShouldZeroFill = ShouldZeroFill::Yes, bool* did_purge = nullptr);
+    NonnullRefPtrVector<PhysicalPage> allocate_committed_user_physical_huge_page(ShouldZeroFill = ShouldZeroFill::Yes);
     RefPtr<PhysicalPage> allocate_supervisor_physical_page();
     NonnullRefPtrVector<PhysicalPage> allocate_contiguous_supervisor_physical_pages(size_t size);
     void deallocate_physical_page(PhysicalAddress);
@@ -169,6 +200,27 @@ public:
         return m_system_memory_info;
     }
 
+    // Free memory watermarks, in uncommitted user physical pages. Dropping below the low watermark
+    // wakes up the ReclaimTask, which then keeps reclaiming until we're back above the high watermark.
+    size_t critical_watermark() const { return m_system_memory_info.user_physical_pages / 32; }
+    size_t low_watermark() const { return m_system_memory_info.user_physical_pages / 16; }
+    size_t high_watermark() const { return m_system_memory_info.user_physical_pages / 8; }
+    MemoryPressureLevel memory_pressure_level();
+
+    struct NumaNodeInfo {
+        u8 node { 0 };
+        u32 proximity_domain { 0 };
+        PhysicalSize user_physical_pages { 0 };
+        PhysicalSize user_physical_pages_free { 0 };
+    };
+
+    size_t numa_node_count() const { return max(m_numa_proximity_domains.size(), (size_t)1); }
+    Vector<NumaNodeInfo> numa_node_info();
+
+    // Called by the PageZeroingTask to fill up the zeroed page pools, so that allocations
+    // with ShouldZeroFill::Yes don't have to zero pages themselves. Returns the number of pages zeroed.
+    size_t zero_free_user_physical_pages(size_t max_page_count);
+
     template<IteratorFunction<VMObject&> Callback>
     static void for_each_vmobject(Callback callback)
     {
@@ -217,6 +269,9 @@ private:
 
     void protect_kernel_image();
     void parse_memory_map();
+    u8 numa_node_for_proximity_domain(u32);
+    u8 numa_node_for_physical_address(PhysicalAddress) const;
+    void set_current_processor_numa_node();
     static void flush_tlb_local(VirtualAddress, size_t page_count = 1);
     static void flush_tlb(PageDirectory const*, VirtualAddress, size_t page_count = 1);
 
@@ -225,6 +280,21 @@ private:
     static Region* find_region_from_vaddr(VirtualAddress);
 
     RefPtr<PhysicalPage> find_free_user_physical_page(bool);
+    bool try_take_uncommitted_user_physical_pages(size_t);
+    void did_consume_uncommitted_pages();
+    PhysicalRegion* user_physical_region_containing(PhysicalAddress);
+    bool try_account_for_free_user_physical_page(bool committed);
+    RefPtr<PhysicalPage> take_user_physical_page_from_magazine(bool committed);
+    RefPtr<PhysicalPage> take_zeroed_user_physical_page(bool committed);
+    bool return_user_physical_page_to_magazine(PhysicalAddress);
+    void return_user_physical_pages_to_regions(Span<PhysicalAddress const>);
+    void refill_user_physical_page_magazine();
+    void drain_user_physical_page_magazines();
+    NonnullRefPtrVector<PhysicalPage> find_free_user_physical_huge_page(bool);
+    NonnullRefPtrVector<PhysicalPage> allocate_contiguous_user_physical_pages(size_t count);
+    bool compact_user_physical_memory(size_t page_count);
+    void migrate_user_physical_page(VMObject&, size_t page_index, NonnullRefPtr<PhysicalPage>, u8 const* old_page_contents);
+    void zero_fill_physical_pages(NonnullRefPtrVector<PhysicalPage>&);
 
     ALWAYS_INLINE u8* quickmap_page(PhysicalPage& page)
     {
@@ -239,6 +309,9 @@ private:
     PageTableEntry* pte(PageDirectory&, VirtualAddress);
     PageTableEntry* ensure_pte(PageDirectory&, VirtualAddress);
     void release_pte(PageDirectory&, VirtualAddress, bool);
+    PageDirectoryEntry* ensure_huge_pde(PageDirectory&, VirtualAddress);
+    bool release_huge_pde(PageDirectory&, VirtualAddress);
+    bool split_huge_page(PageDirectory&, VirtualAddress);
 
     RefPtr<PageDirectory> m_kernel_page_directory;
 
@@ -259,6 +332,15 @@ private:
     Vector<PhysicalMemoryRange> m_physical_memory_ranges;
     Vector<ContiguousReservedMemoryRange> m_reserved_memory_ranges;
 
+    struct NumaMemoryRange {
+        PhysicalAddress base;
+        PhysicalSize length { 0 };
+        u8 node { 0 };
+    };
+    Vector<u32, max_numa_node_count> m_numa_proximity_domains;
+    Vector<NumaMemoryRange> m_numa_memory_ranges;
+    HashMap<u32, u8> m_numa_node_for_apic_id;
+
     VMObject::List m_vmobjects;
 };
 
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Singleton.h>
+#include <Kernel/FileSystem/Inode.h>
+#include <Kernel/VM/MemoryManager.h>
+#include <Kernel/VM/PageCache.h>
+#include <Kernel/WorkQueue.h>
+
+namespace Kernel {
+
+// Sequential readers start with a small readahead window, which doubles every time they catch up with it.
+static constexpr size_t readahead_initial_page_count = 4;
+static constexpr size_t readahead_max_page_count = 64;
+
+static AK::Singleton<PageCache> s_the;
+
+PageCache& PageCache::the()
+{
+    return *s_the;
+}
+
+static bool is_under_memory_pressure()
+{
+    return MM.get_system_memory_info().user_physical_pages_uncommitted < MM.high_watermark();
+}
+
+RefPtr<SharedInodeVMObject> PageCache::ensure_vmobject(Inode& inode)
+{
+    auto vmobject = inode.shared_vmobject();
+    if (vmobject && vmobject->size() < inode.size() && !vmobject->is_mapped()) {
+        // The file has grown since we started caching it. Nobody has it mapped, so start over with a bigger one.
+        evict(inode);
+        vmobject = nullptr;
+    }
+    if (!vmobject)
+        vmobject = SharedInodeVMObject::try_create_with_inode(inode);
+    if (!vmobject)
+        return {};
+
+    ScopedSpinLock locker(m_lock);
+    m_lru_list.prepend(*vmobject);
+    return vmobject;
+}
+
+KResultOr<size_t> PageCache::read_bytes(Inode& inode, u64 offset, size_t count, UserOrKernelBuffer& buffer)
+{
+    auto size = inode.size();
+    if (offset >= size)
+        return 0;
+    count = min(count, static_cast<size_t>(size - offset));
+
+    auto vmobject = ensure_vmobject(inode);
+    if (!vmobject)
+        return inode.read_bytes(offset, count, buffer, nullptr);
+
+    auto result = vmobject->read_bytes(offset, count, buffer);
+    if (result.is_error())
+        return result.error();
+    auto nread = result.value();
+
+    if (nread < count) {
+        // The file has grown past the end of the VMObject, read the rest directly.
+        auto remaining_buffer = buffer.offset(nread);
+        auto remaining_result = inode.read_bytes(offset + nread, count - nread, remaining_buffer, nullptr);
+        if (remaining_result.is_error())
+            return remaining_result.error();
+        nread += remaining_result.value();
+    }
+
+    trim();
+    return nread;
+}
+
+void PageCache::invalidate(Inode& inode, u64 offset, u64 count)
+{
+    auto vmobject = inode.shared_vmobject();
+    if (!vmobject)
+        return;
+    auto first_page_index = offset / PAGE_SIZE;
+    if (first_page_index >= vmobject->page_count())
+        return;
+    auto end_offset = offset + min(count, static_cast<u64>(vmobject->size()) - offset);
+    auto end_page_index = ceil_div(end_offset, static_cast<u64>(PAGE_SIZE));
+    vmobject->invalidate_pages(first_page_index, end_page_index - first_page_index);
+}
+
+void PageCache::discard(Inode& inode, u64 offset, u64 count)
+{
+    auto vmobject = inode.shared_vmobject();
+    if (!vmobject || vmobject->is_mapped())
+        return;
+    invalidate(inode, offset, count);
+}
+
+void PageCache::did_read(Inode& inode, ReadaheadState& state, u64 offset, size_t count)
+{
+    auto end_offset = offset + count;
+    bool is_sequential = offset == state.next_offset;
+    state.next_offset = end_offset;
+
+    if (state.advice == ReadaheadAdvice::Random)
+        return;
+    if (!is_sequential && state.advice != ReadaheadAdvice::Sequential) {
+        // Looks like random access, don't read ahead until the reader settles down again.
+        state.window_page_count = 0;
+        state.end_offset = 0;
+        return;
+    }
+
+    // Only ask for the next window once the reader is halfway through the current one,
+    // so that there is always something on its way without reading too far ahead.
+    if (state.end_offset > end_offset && state.end_offset - end_offset > state.window_page_count * PAGE_SIZE / 2)
+        return;
+
+    if (!state.window_page_count)
+        state.window_page_count = state.advice == ReadaheadAdvice::Sequential ? readahead_max_page_count : readahead_initial_page_count;
+    else
+        state.window_page_count = min(state.window_page_count * 2, readahead_max_page_count);
+
+    auto start_offset = max(end_offset, state.end_offset);
+    auto size = inode.size();
+    if (start_offset >= size)
+        return;
+    auto readahead_count = min(static_cast<u64>(state.window_page_count * PAGE_SIZE), size - start_offset);
+    state.end_offset = start_offset + readahead_count;
+    read_ahead(inode, start_offset, readahead_count);
+}
+
+void PageCache::read_ahead(Inode& inode, u64 offset, u64 count)
+{
+    if (MM.memory_pressure_level() != MemoryPressureLevel::None)
+        return;
+    auto vmobject = ensure_vmobject(inode);
+    if (!vmobject)
+        return;
+    auto first_page_index = offset / PAGE_SIZE;
+    if (first_page_index >= vmobject->page_count())
+        return;
+    auto end_offset = offset + min(count, static_cast<u64>(vmobject->size()) - offset);
+    auto end_page_index = min(static_cast<size_t>(ceil_div(end_offset, static_cast<u64>(PAGE_SIZE))), vmobject->page_count());
+
+    g_readahead_work->queue([vmobject = vmobject.release_nonnull(), first_page_index, end_page_index]() mutable {
+        vmobject->prefetch_pages(first_page_index, end_page_index - first_page_index);
+    });
+}
+
+void PageCache::evict(Inode& inode)
+{
+    auto vmobject = inode.shared_vmobject();
+    if (!vmobject)
+        return;
+    ScopedSpinLock locker(m_lock);
+    m_lru_list.remove(*vmobject);
+}
+
+size_t PageCache::trim()
+{
+    size_t released_page_count = 0;
+    while (is_under_memory_pressure()) {
+        RefPtr<SharedInodeVMObject> vmobject;
+        {
+            ScopedSpinLock locker(m_lock);
+            vmobject = m_lru_list.take_last();
+        }
+        if (!vmobject)
+            break;
+        released_page_count += vmobject->release_all_clean_pages();
+    }
+    return released_page_count;
+}
+
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <Kernel/FileSystem/ReadaheadState.h>
+#include <Kernel/KResult.h>
+#include <Kernel/SpinLock.h>
+#include <Kernel/UserOrKernelBuffer.h>
+#include <Kernel/VM/SharedInodeVMObject.h>
+
+namespace Kernel {
+
+// The page cache keeps the contents of recently read files in their SharedInodeVMObject,
+// so that read() and mmap() of the same file share one set of physical pages.
+// It keeps those VMObjects alive in LRU order, and lets go of them when free memory runs low.
+class PageCache {
+public:
+    static PageCache& the();
+
+    KResultOr<size_t> read_bytes(Inode&, u64 offset, size_t count, UserOrKernelBuffer&);
+    void invalidate(Inode&, u64 offset, u64 count);
+    // Drops the cached pages of a range, unless the file is mapped somewhere.
+    void discard(Inode&, u64 offset, u64 count);
+
+    // Called after every read through the page cache, reads ahead of sequential readers.
+    void did_read(Inode&, ReadaheadState&, u64 offset, size_t count);
+    // Starts bringing a range of the file into the page cache in the background.
+    void read_ahead(Inode&, u64 offset, u64 count);
+    void evict(Inode&);
+
+    // Drops clean pages of the least recently used files until MM is above its high watermark.
+    size_t trim();
+
+private:
+    RefPtr<SharedInodeVMObject> ensure_vmobject(Inode&);
+
+    SpinLock<u8> m_lock;
+    SharedInodeVMObject::PageCacheList m_lru_list;
+};
+
+}
@@ -48,7 +48,7 @@ void PhysicalRegion::initialize_zones()
         while (remaining_pages >= pages_per_zone) {
             m_zones.append(make<PhysicalZone>(base_address, pages_per_zone));
             base_address = base_address.offset(pages_per_zone * PAGE_SIZE);
-            m_usable_zones.append(m_zones.last());
+            m_usable_zones[0].append(m_zones.last());
             remaining_pages -= pages_per_zone;
             ++zone_count;
         }
@@ -56,6 +56,18 @@ void PhysicalRegion::initialize_zones()
             dmesgln(" * {}x PhysicalZone ({} MiB) @ {:016x}-{:016x}", zone_count, pages_per_zone / 256, first_address.get(), base_address.get() - pages_per_zone * PAGE_SIZE - 1);
     };
 
+    // Carve the pages below the first 2 MiB boundary into small naturally aligned zones,
+    // so that the big zones (and every 2 MiB block allocated from them) are huge page aligned.
+    while (remaining_pages > 0 && (base_address.get() % huge_page_size)) {
+        size_t pages_per_zone = 1u << __builtin_ctzll(base_address.get() / PAGE_SIZE);
+        while (pages_per_zone > remaining_pages)
+            pages_per_zone >>= 1;
+        m_zones.append(make<PhysicalZone>(base_address, pages_per_zone));
+        m_usable_zones[0].append(m_zones.last());
+        base_address = base_address.offset(pages_per_zone * PAGE_SIZE);
+        remaining_pages -= pages_per_zone;
+    }
+
     // First make 16 MiB zones (with 4096 pages each)
     make_zones(4096);
 
@@ -75,22 +87,45 @@ OwnPtr<PhysicalRegion> PhysicalRegion::try_take_pages_from_beginning(unsigned pa
     return try_create(taken_lower, taken_upper);
 }
 
-NonnullRefPtrVector<PhysicalPage> PhysicalRegion::take_contiguous_free_pages(size_t count)
+template<typename Callback>
+IterationDecision PhysicalRegion::for_each_usable_zone_list(u8 preferred_numa_node, Callback callback)
+{
+    VERIFY(preferred_numa_node < max_numa_node_count);
+    if (callback(m_usable_zones[preferred_numa_node]) == IterationDecision::Break)
+        return IterationDecision::Break;
+    for (size_t numa_node = 0; numa_node < max_numa_node_count; ++numa_node) {
+        if (numa_node == preferred_numa_node || m_usable_zones[numa_node].is_empty())
+            continue;
+        if (callback(m_usable_zones[numa_node]) == IterationDecision::Break)
+            return IterationDecision::Break;
+    }
+    return IterationDecision::Continue;
+}
+
+NonnullRefPtrVector<PhysicalPage> PhysicalRegion::take_contiguous_free_pages(size_t count, size_t physical_alignment, u8 preferred_numa_node)
 {
     auto rounded_page_count = next_power_of_two(count);
     auto order = __builtin_ctz(rounded_page_count);
 
+    // Blocks are aligned to their size relative to the zone base, so only zones with an aligned base will do.
+    VERIFY(physical_alignment <= rounded_page_count * PAGE_SIZE);
+
     Optional<PhysicalAddress> page_base;
-    for (auto& zone : m_usable_zones) {
-        page_base = zone.allocate_block(order);
-        if (page_base.has_value()) {
-            if (zone.is_empty()) {
-                // We've exhausted this zone, move it to the full zones list.
-                m_full_zones.append(zone);
+    for_each_usable_zone_list(preferred_numa_node, [&](auto& zones) {
+        for (auto& zone : zones) {
+            if (zone.base().get() % physical_alignment)
+                continue;
+            page_base = zone.allocate_block(order);
+            if (page_base.has_value()) {
+                if (zone.is_empty()) {
+                    // We've exhausted this zone, move it to the full zones list.
+                    m_full_zones.append(zone);
+                }
+                return IterationDecision::Break;
             }
-            break;
         }
-    }
+        return IterationDecision::Continue;
+    });
 
     if (!page_base.has_value())
         return {};
@@ -103,21 +138,32 @@ NonnullRefPtrVector<PhysicalPage> PhysicalRegion::take_contiguous_free_pages(siz
     return physical_pages;
 }
 
-RefPtr<PhysicalPage> PhysicalRegion::take_free_page()
+RefPtr<PhysicalPage> PhysicalRegion::take_free_page(u8 preferred_numa_node)
 {
-    if (m_usable_zones.is_empty())
+    PhysicalAddress paddr;
+    if (!take_free_pages({ &paddr, 1 }, preferred_numa_node))
         return nullptr;
+    return PhysicalPage::create(paddr);
+}
 
-    auto& zone = *m_usable_zones.first();
-    auto page = zone.allocate_block(0);
-    VERIFY(page.has_value());
-
-    if (zone.is_empty()) {
-        // We've exhausted this zone, move it to the full zones list.
-        m_full_zones.append(zone);
-    }
+size_t PhysicalRegion::take_free_pages(Span<PhysicalAddress> pages, u8 preferred_numa_node)
+{
+    size_t taken_count = 0;
+    for_each_usable_zone_list(preferred_numa_node, [&](auto& zones) {
+        while (taken_count < pages.size() && !zones.is_empty()) {
+            auto& zone = *zones.first();
+            auto page = zone.allocate_block(0);
+            VERIFY(page.has_value());
+            pages[taken_count++] = page.value();
 
-    return PhysicalPage::create(page.value());
+            if (zone.is_empty()) {
+                // We've exhausted this zone, move it to the full zones list.
+                m_full_zones.append(zone);
+            }
+        }
+        return taken_count < pages.size() ? IterationDecision::Continue : IterationDecision::Break;
+    });
+    return taken_count;
 }
 
 void PhysicalRegion::return_page(PhysicalAddress paddr)
@@ -130,7 +176,7 @@ void PhysicalRegion::return_page(PhysicalAddress paddr)
         if (zone.contains(paddr)) {
             zone.deallocate_block(paddr, 0);
             if (m_full_zones.contains(zone))
-                m_usable_zones.append(zone);
+                m_usable_zones[zone.numa_node()].append(zone);
             return;
         }
     }
@@ -138,4 +184,61 @@ void PhysicalRegion::return_page(PhysicalAddress paddr)
     VERIFY_NOT_REACHED();
 }
 
+void PhysicalRegion::assign_numa_nodes(Function<u8(PhysicalAddress)> const& numa_node_for_address)
+{
+    for (auto& zone : m_zones) {
+        // NOTE: A zone that straddles a node boundary is assigned to the node its first page lives in.
+        auto numa_node = numa_node_for_address(zone.base());
+        VERIFY(numa_node < max_numa_node_count);
+        zone.set_numa_node(numa_node);
+        if (!m_full_zones.contains(zone))
+            m_usable_zones[numa_node].append(zone);
+    }
+}
+
+size_t PhysicalRegion::page_count_in_numa_node(u8 numa_node) const
+{
+    size_t page_count = 0;
+    for (auto& zone : m_zones) {
+        if (zone.numa_node() == numa_node)
+            page_count += zone.page_count();
+    }
+    return page_count;
+}
+
+size_t PhysicalRegion::free_page_count_in_numa_node(u8 numa_node) const
+{
+    size_t page_count = 0;
+    for (auto& zone : m_zones) {
+        if (zone.numa_node() == numa_node)
+            page_count += zone.available();
+    }
+    return page_count;
+}
+
+Optional<PhysicalAddress> PhysicalRegion::take_zeroed_page()
+{
+    ScopedSpinLock lock(m_zeroed_pages_lock);
+    if (m_zeroed_page_count == 0)
+        return {};
+    return m_zeroed_pages[--m_zeroed_page_count];
+}
+
+bool PhysicalRegion::add_zeroed_page(PhysicalAddress paddr)
+{
+    ScopedSpinLock lock(m_zeroed_pages_lock);
+    if (m_zeroed_page_count >= zeroed_page_target())
+        return false;
+    m_zeroed_pages[m_zeroed_page_count++] = paddr;
+    return true;
+}
+
+void PhysicalRegion::return_zeroed_pages()
+{
+    ScopedSpinLock lock(m_zeroed_pages_lock);
+    for (size_t i = 0; i < m_zeroed_page_count; ++i)
+        return_page(m_zeroed_pages[i]);
+    m_zeroed_page_count = 0;
+}
+
 }
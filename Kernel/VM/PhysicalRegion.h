@@ -6,7 +6,12 @@
 
 #pragma once
 
+#include <AK/Array.h>
+#include <AK/Function.h>
+#include <AK/Optional.h>
 #include <AK/OwnPtr.h>
+#include <AK/Span.h>
+#include <Kernel/SpinLock.h>
 #include <Kernel/VM/PhysicalPage.h>
 #include <Kernel/VM/PhysicalZone.h>
 
@@ -34,21 +39,45 @@ public:
 
     OwnPtr<PhysicalRegion> try_take_pages_from_beginning(unsigned);
 
-    RefPtr<PhysicalPage> take_free_page();
-    NonnullRefPtrVector<PhysicalPage> take_contiguous_free_pages(size_t count);
+    NonnullOwnPtrVector<PhysicalZone> const& zones() const { return m_zones; }
+
+    // Allocations are served from zones in the preferred NUMA node first, and only fall back to other nodes when it runs dry.
+    RefPtr<PhysicalPage> take_free_page(u8 preferred_numa_node = 0);
+    size_t take_free_pages(Span<PhysicalAddress>, u8 preferred_numa_node = 0);
+    NonnullRefPtrVector<PhysicalPage> take_contiguous_free_pages(size_t count, size_t physical_alignment = PAGE_SIZE, u8 preferred_numa_node = 0);
     void return_page(PhysicalAddress);
 
+    void assign_numa_nodes(Function<u8(PhysicalAddress)> const& numa_node_for_address);
+    size_t page_count_in_numa_node(u8 numa_node) const;
+    size_t free_page_count_in_numa_node(u8 numa_node) const;
+
+    // Free pages that the PageZeroingTask has already filled with zeroes.
+    // They have been taken out of the zones, but are still accounted for as free.
+    Optional<PhysicalAddress> take_zeroed_page();
+    bool add_zeroed_page(PhysicalAddress);
+    void return_zeroed_pages();
+    size_t zeroed_page_count() const { return m_zeroed_page_count; }
+    size_t zeroed_page_target() const { return min(zeroed_page_pool_capacity, m_pages / 16); }
+
 private:
     PhysicalRegion(PhysicalAddress lower, PhysicalAddress upper);
 
+    template<typename Callback>
+    IterationDecision for_each_usable_zone_list(u8 preferred_numa_node, Callback);
+
     NonnullOwnPtrVector<PhysicalZone> m_zones;
 
-    PhysicalZone::List m_usable_zones;
+    Array<PhysicalZone::List, max_numa_node_count> m_usable_zones;
     PhysicalZone::List m_full_zones;
 
     PhysicalAddress m_lower;
     PhysicalAddress m_upper;
     unsigned m_pages { 0 };
+
+    static constexpr size_t zeroed_page_pool_capacity = 256;
+    SpinLock<u8> m_zeroed_pages_lock;
+    size_t m_zeroed_page_count { 0 };
+    PhysicalAddress m_zeroed_pages[zeroed_page_pool_capacity];
 };
 
 }
@@ -195,4 +195,12 @@ void PhysicalZone::dump() const
     }
 }
 
+void PhysicalZone::for_each_free_block(Function<void(PhysicalAddress, size_t page_count)> const& callback) const
+{
+    for (size_t order = 0; order <= max_order; ++order) {
+        for (auto index = m_buckets[order].freelist; index != -1; index = get_freelist_entry(index).freelist.next_index)
+            callback(m_base_address.offset(index * ZONE_CHUNK_SIZE), 1u << order);
+    }
+}
+
 }
@@ -7,10 +7,14 @@
 #pragma once
 
 #include <AK/Bitmap.h>
+#include <AK/Function.h>
 #include <AK/IntrusiveList.h>
 
 namespace Kernel {
 
+// NUMA nodes beyond this are folded into the last one.
+static constexpr size_t max_numa_node_count = 8;
+
 // A PhysicalZone is an allocator that manages a sub-area of a PhysicalRegion.
 // Its total size is always a power of two.
 // You allocate chunks at a time. One chunk is PAGE_SIZE/2, and the minimum allocation size is 2 chunks.
@@ -31,11 +35,16 @@ public:
     void deallocate_block(PhysicalAddress, size_t order);
 
     void dump() const;
+    void for_each_free_block(Function<void(PhysicalAddress, size_t page_count)> const&) const;
     size_t available() const { return m_page_count - (m_used_chunks / 2); }
 
     bool is_empty() const { return !available(); }
 
     PhysicalAddress base() const { return m_base_address; }
+    size_t page_count() const { return m_page_count; }
+
+    u8 numa_node() const { return m_numa_node; }
+    void set_numa_node(u8 numa_node) { m_numa_node = numa_node; }
     bool contains(PhysicalAddress paddr) const
     {
         return paddr >= m_base_address && paddr < m_base_address.offset(m_page_count * PAGE_SIZE);
@@ -85,6 +94,7 @@ private:
     PhysicalAddress m_base_address { 0 };
     size_t m_page_count { 0 };
     size_t m_used_chunks { 0 };
+    u8 m_numa_node { 0 };
 
     IntrusiveListNode<PhysicalZone> m_list_node;
 
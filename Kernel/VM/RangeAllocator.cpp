@@ -42,13 +42,15 @@ void RangeAllocator::dump() const
     }
 }
 
-void RangeAllocator::carve_at_iterator(auto& it, Range const& range)
+void RangeAllocator::carve_from_available_range(Range available_range, Range const& range)
 {
     VERIFY(m_lock.is_locked());
-    auto remaining_parts = (*it).carve(range);
+    m_available_ranges.remove(available_range.base().get());
+    if (available_range == range)
+        return;
+    auto remaining_parts = available_range.carve(range);
     VERIFY(remaining_parts.size() >= 1);
     VERIFY(m_total_range.contains(remaining_parts[0]));
-    m_available_ranges.remove(it.key());
     m_available_ranges.insert(remaining_parts[0].base().get(), remaining_parts[0]);
     if (remaining_parts.size() == 2) {
         VERIFY(m_total_range.contains(remaining_parts[1]));
@@ -105,28 +107,25 @@ Optional<Range> RangeAllocator::allocate_anywhere(size_t size, size_t alignment)
 
     ScopedSpinLock lock(m_lock);
 
-    for (auto it = m_available_ranges.begin(); !it.is_end(); ++it) {
-        auto& available_range = *it;
-        // FIXME: This check is probably excluding some valid candidates when using a large alignment.
-        if (available_range.size() < (effective_size + alignment))
-            continue;
+    // Take the lowest available range that fits, like a linear first-fit scan would, but without visiting all of them.
+    // FIXME: This check is probably excluding some valid candidates when using a large alignment.
+    auto* available_range = m_available_ranges.find_smallest_matching_augmentation([&](size_t largest_range_size) {
+        return largest_range_size >= effective_size + alignment;
+    });
+    if (!available_range) {
+        dmesgln("RangeAllocator: Failed to allocate anywhere: size={}, alignment={}", size, alignment);
+        return {};
+    }
 
-        FlatPtr initial_base = available_range.base().offset(offset_from_effective_base).get();
-        FlatPtr aligned_base = round_up_to_power_of_two(initial_base, alignment);
+    FlatPtr initial_base = available_range->base().offset(offset_from_effective_base).get();
+    FlatPtr aligned_base = round_up_to_power_of_two(initial_base, alignment);
 
-        Range const allocated_range(VirtualAddress(aligned_base), size);
+    Range const allocated_range(VirtualAddress(aligned_base), size);
 
-        VERIFY(m_total_range.contains(allocated_range));
+    VERIFY(m_total_range.contains(allocated_range));
 
-        if (available_range == allocated_range) {
-            m_available_ranges.remove(it.key());
-            return allocated_range;
-        }
-        carve_at_iterator(it, allocated_range);
-        return allocated_range;
-    }
-    dmesgln("RangeAllocator: Failed to allocate anywhere: size={}, alignment={}", size, alignment);
-    return {};
+    carve_from_available_range(*available_range, allocated_range);
+    return allocated_range;
 }
 
 Optional<Range> RangeAllocator::allocate_specific(VirtualAddress base, size_t size)
@@ -143,18 +142,12 @@ Optional<Range> RangeAllocator::allocate_specific(VirtualAddress base, size_t si
     }
 
     ScopedSpinLock lock(m_lock);
-    for (auto it = m_available_ranges.begin(); !it.is_end(); ++it) {
-        auto& available_range = *it;
-        if (!available_range.contains(base, size))
-            continue;
-        if (available_range == allocated_range) {
-            m_available_ranges.remove(it.key());
-            return allocated_range;
-        }
-        carve_at_iterator(it, allocated_range);
-        return allocated_range;
-    }
-    return {};
+    // Available ranges never overlap, so only the one starting closest below the base can contain the allocation.
+    auto* available_range = m_available_ranges.find_largest_not_above(base.get());
+    if (!available_range || !available_range->contains(base, size))
+        return {};
+    carve_from_available_range(*available_range, allocated_range);
+    return allocated_range;
 }
 
 void RangeAllocator::deallocate(Range const& range)
@@ -173,6 +166,7 @@ void RangeAllocator::deallocate(Range const& range)
         auto* preceding_range = m_available_ranges.find_largest_not_above(range.base().get());
         if (preceding_range && preceding_range->end() == range.base()) {
             preceding_range->m_size += range.size();
+            m_available_ranges.update_augmentation(preceding_range->base().get());
             merged_range = *preceding_range;
         } else {
             m_available_ranges.insert(range.base().get(), range);
@@ -186,6 +180,7 @@ void RangeAllocator::deallocate(Range const& range)
             auto* existing_range = m_available_ranges.find_largest_not_above(range.base().get());
             VERIFY(existing_range->base() == merged_range.base());
             existing_range->m_size += following_range->size();
+            m_available_ranges.update_augmentation(existing_range->base().get());
             m_available_ranges.remove(following_range->base().get());
         }
     }
@@ -31,9 +31,16 @@ public:
     bool contains(Range const& range) const { return m_total_range.contains(range); }
 
 private:
-    void carve_at_iterator(auto&, Range const&);
+    void carve_from_available_range(Range available_range, Range const&);
 
-    RedBlackTree<FlatPtr, Range> m_available_ranges;
+    // Every subtree knows the size of the largest available range in it, so a fitting range can be found in O(log n).
+    struct LargestRangeAugmentation {
+        using Type = size_t;
+        static size_t value(Range const& range) { return range.size(); }
+        static size_t combine(size_t a, size_t b) { return max(a, b); }
+    };
+
+    RedBlackTree<FlatPtr, Range, LargestRangeAugmentation> m_available_ranges;
     Range m_total_range;
     mutable SpinLock<u8> m_lock;
 };
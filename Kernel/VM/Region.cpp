@@ -19,6 +19,13 @@
 
 namespace Kernel {
 
+// Sequential inode faults read ahead this many pages, doubling with every sequential fault up to the maximum.
+static constexpr size_t inode_readahead_initial_page_count = 4;
+static constexpr size_t inode_readahead_max_page_count = 32;
+
+// On an inode fault, pages of the surrounding aligned block that are already in memory get mapped too.
+static constexpr size_t inode_fault_around_page_count = 16;
+
 Region::Region(Range const& range, NonnullRefPtr<VMObject> vmobject, size_t offset_in_vmobject, OwnPtr<KString> name, Region::Access access, Cacheable cacheable, bool shared)
     : m_range(range)
     , m_offset_in_vmobject(offset_in_vmobject)
@@ -208,6 +215,69 @@ bool Region::map_individual_page_impl(size_t page_index)
     return true;
 }
 
+bool Region::can_map_huge_page(size_t page_index, size_t end_page_index) const
+{
+    if (!vmobject().is_anonymous())
+        return false;
+    if (end_page_index - page_index < pages_per_huge_page)
+        return false;
+    if (vaddr_from_page_index(page_index).get() % huge_page_size)
+        return false;
+    if (!is_readable() && !is_writable())
+        return false;
+    auto* first_page = physical_page(page_index);
+    if (!first_page || (first_page->paddr().get() % huge_page_size))
+        return false;
+    // The shared zero page and the lazy committed page fail this too, since they back every slot with the same page.
+    for (size_t i = 0; i < pages_per_huge_page; ++i) {
+        auto* page = physical_page(page_index + i);
+        if (!page || page->paddr() != first_page->paddr().offset(i * PAGE_SIZE))
+            return false;
+        if (should_cow(page_index + i))
+            return false;
+    }
+    return true;
+}
+
+void Region::map_huge_page_impl(size_t page_index)
+{
+    VERIFY(m_page_directory->get_lock().own_lock());
+    auto page_vaddr = vaddr_from_page_index(page_index);
+
+    bool user_allowed = page_vaddr.get() >= 0x00800000 && is_user_address(page_vaddr);
+    if (is_mmap() && !user_allowed) {
+        PANIC("About to map mmap'ed page at a kernel address");
+    }
+
+    ScopedSpinLock mm_locker(s_mm_lock);
+
+    auto* pde = MM.ensure_huge_pde(*m_page_directory, page_vaddr);
+    pde->clear();
+    pde->set_huge(true);
+    pde->set_cache_disabled(!m_cacheable);
+    pde->set_page_table_base(physical_page(page_index)->paddr().get());
+    pde->set_present(true);
+    pde->set_writable(is_writable());
+    if (Processor::current().has_feature(CPUFeature::NX))
+        pde->set_execute_disabled(!is_executable());
+    pde->set_user_allowed(user_allowed);
+}
+
+size_t Region::map_page_range_impl(size_t page_index, size_t end_page_index)
+{
+    while (page_index < end_page_index) {
+        if (can_map_huge_page(page_index, end_page_index)) {
+            map_huge_page_impl(page_index);
+            page_index += pages_per_huge_page;
+            continue;
+        }
+        if (!map_individual_page_impl(page_index))
+            break;
+        ++page_index;
+    }
+    return page_index;
+}
+
 bool Region::do_remap_vmobject_page(size_t page_index, bool with_flush)
 {
     ScopedSpinLock lock(vmobject().m_lock);
@@ -234,18 +304,50 @@ bool Region::remap_vmobject_page(size_t page_index, bool with_flush)
     return success;
 }
 
-void Region::unmap(ShouldDeallocateVirtualMemoryRange deallocate_range)
+bool Region::do_remap_vmobject_huge_page(size_t first_page_index_in_vmobject)
+{
+    ScopedSpinLock lock(vmobject().m_lock);
+    if (!m_page_directory)
+        return true; // not an error, region may have not yet mapped it
+    auto first_page_index_in_region = max(first_page_index_in_vmobject, first_page_index()) - first_page_index();
+    auto end_page_index_in_region = min(first_page_index_in_vmobject + pages_per_huge_page, first_page_index() + page_count()) - first_page_index();
+    if (first_page_index_in_region >= end_page_index_in_region)
+        return true; // not an error, region doesn't map these pages
+    ScopedSpinLock page_lock(m_page_directory->get_lock());
+    bool success = map_page_range_impl(first_page_index_in_region, end_page_index_in_region) == end_page_index_in_region;
+    MM.flush_tlb(m_page_directory, vaddr_from_page_index(first_page_index_in_region), end_page_index_in_region - first_page_index_in_region);
+    return success;
+}
+
+bool Region::remap_vmobject_huge_page(size_t first_page_index_in_vmobject)
+{
+    auto& vmobject = this->vmobject();
+    bool success = true;
+    vmobject.for_each_region([&](auto& region) {
+        if (!region.do_remap_vmobject_huge_page(first_page_index_in_vmobject))
+            success = false;
+    });
+    return success;
+}
+
+void Region::unmap(ShouldDeallocateVirtualMemoryRange deallocate_range, ShouldFlushTLB should_flush_tlb)
 {
     ScopedSpinLock lock(s_mm_lock);
     if (!m_page_directory)
         return;
     ScopedSpinLock page_lock(m_page_directory->get_lock());
     size_t count = page_count();
-    for (size_t i = 0; i < count; ++i) {
+    for (size_t i = 0; i < count;) {
         auto vaddr = vaddr_from_page_index(i);
+        if (!(vaddr.get() % huge_page_size) && count - i >= pages_per_huge_page && MM.release_huge_pde(*m_page_directory, vaddr)) {
+            i += pages_per_huge_page;
+            continue;
+        }
         MM.release_pte(*m_page_directory, vaddr, i == count - 1);
+        ++i;
     }
-    MM.flush_tlb(m_page_directory, vaddr(), page_count());
+    if (should_flush_tlb == ShouldFlushTLB::Yes)
+        MM.flush_tlb(m_page_directory, vaddr(), page_count());
     if (deallocate_range == ShouldDeallocateVirtualMemoryRange::Yes) {
         if (m_page_directory->range_allocator().contains(range()))
             m_page_directory->range_allocator().deallocate(range());
@@ -273,12 +375,7 @@ bool Region::map(PageDirectory& page_directory, ShouldFlushTLB should_flush_tlb)
     }
 
     set_page_directory(page_directory);
-    size_t page_index = 0;
-    while (page_index < page_count()) {
-        if (!map_individual_page_impl(page_index))
-            break;
-        ++page_index;
-    }
+    size_t page_index = map_page_range_impl(0, page_count());
     if (page_index > 0) {
         if (should_flush_tlb == ShouldFlushTLB::Yes)
             MM.flush_tlb(m_page_directory, vaddr(), page_index);
@@ -311,6 +408,10 @@ PageFaultResponse Region::handle_fault(PageFault const& fault)
         }
 
         auto& page_slot = physical_page_slot(page_index_in_region);
+        if (!page_slot) {
+            dbgln("BUG! Unexpected NP fault at {}", fault.vaddr());
+            return PageFaultResponse::ShouldCrash;
+        }
         if (page_slot->is_lazy_committed_page()) {
             auto page_index_in_vmobject = translate_to_vmobject_page(page_index_in_region);
             VERIFY(m_vmobject->is_anonymous());
@@ -318,23 +419,41 @@ PageFaultResponse Region::handle_fault(PageFault const& fault)
             remap_vmobject_page(page_index_in_vmobject);
             return PageFaultResponse::Continue;
         }
-        dbgln("BUG! Unexpected NP fault at {}", fault.vaddr());
-        return PageFaultResponse::ShouldCrash;
+
+        // The page is there, it just isn't mapped in this page directory yet. This happens
+        // for regions that fork() handed to the child without copying their page tables.
+        dbgln_if(PAGE_FAULT_DEBUG, "NP(lazy) fault in Region({})[{}] at {}", this, page_index_in_region, fault.vaddr());
+        if (!do_remap_vmobject_page(translate_to_vmobject_page(page_index_in_region), false))
+            return PageFaultResponse::OutOfMemory;
+        if (fault.is_write() && should_cow(page_index_in_region))
+            return handle_cow_write_fault(page_index_in_region);
+        return PageFaultResponse::Continue;
     }
     VERIFY(fault.type() == PageFault::Type::ProtectionViolation);
     if (fault.access() == PageFault::Access::Write && is_writable() && should_cow(page_index_in_region)) {
         dbgln_if(PAGE_FAULT_DEBUG, "PV(cow) fault in Region({})[{}] at {}", this, page_index_in_region, fault.vaddr());
-        auto* phys_page = physical_page(page_index_in_region);
-        if (phys_page->is_shared_zero_page() || phys_page->is_lazy_committed_page()) {
-            dbgln_if(PAGE_FAULT_DEBUG, "NP(zero) fault in Region({})[{}] at {}", this, page_index_in_region, fault.vaddr());
-            return handle_zero_fault(page_index_in_region);
-        }
-        return handle_cow_fault(page_index_in_region);
+        return handle_cow_write_fault(page_index_in_region);
     }
     dbgln("PV(error) fault in Region({})[{}] at {}", this, page_index_in_region, fault.vaddr());
     return PageFaultResponse::ShouldCrash;
 }
 
+PageFaultResponse Region::handle_cow_write_fault(size_t page_index_in_region)
+{
+    auto* phys_page = physical_page(page_index_in_region);
+    if (phys_page->is_shared_zero_page() || phys_page->is_lazy_committed_page()) {
+        dbgln_if(PAGE_FAULT_DEBUG, "NP(zero) fault in Region({})[{}]", this, page_index_in_region);
+        return handle_zero_fault(page_index_in_region);
+    }
+    return handle_cow_fault(page_index_in_region);
+}
+
+void Region::map_lazily(PageDirectory& page_directory)
+{
+    ScopedSpinLock lock(s_mm_lock);
+    set_page_directory(page_directory);
+}
+
 PageFaultResponse Region::handle_zero_fault(size_t page_index_in_region)
 {
     VERIFY_INTERRUPTS_DISABLED();
@@ -358,7 +477,24 @@ PageFaultResponse Region::handle_zero_fault(size_t page_index_in_region)
 
     if (page_slot->is_lazy_committed_page()) {
         VERIFY(m_vmobject->is_anonymous());
-        page_slot = static_cast<AnonymousVMObject&>(*m_vmobject).allocate_committed_page({});
+        auto& anonymous_vmobject = static_cast<AnonymousVMObject&>(*m_vmobject);
+
+        // If this region covers the whole huge page around the fault and none of it has been touched yet,
+        // populate all of it at once so it can be mapped as a huge page.
+        auto huge_page_vaddr = VirtualAddress(vaddr_from_page_index(page_index_in_region).get() & ~(FlatPtr)(huge_page_size - 1));
+        if (range().contains(huge_page_vaddr, huge_page_size)) {
+            auto first_page_index_in_vmobject = translate_to_vmobject_page(page_index_from_address(huge_page_vaddr));
+            if (anonymous_vmobject.try_allocate_committed_huge_page({}, first_page_index_in_vmobject)) {
+                dbgln_if(PAGE_FAULT_DEBUG, "      >> ALLOCATED COMMITTED HUGE PAGE {}", page_slot->paddr());
+                if (!remap_vmobject_huge_page(first_page_index_in_vmobject)) {
+                    dmesgln("MM: handle_zero_fault was unable to allocate a page table to map {}", page_slot);
+                    return PageFaultResponse::OutOfMemory;
+                }
+                return PageFaultResponse::Continue;
+            }
+        }
+
+        page_slot = anonymous_vmobject.allocate_committed_page({});
         dbgln_if(PAGE_FAULT_DEBUG, "      >> ALLOCATED COMMITTED {}", page_slot->paddr());
     } else {
         page_slot = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::Yes);
@@ -393,6 +529,48 @@ PageFaultResponse Region::handle_cow_fault(size_t page_index_in_region)
     return response;
 }
 
+size_t Region::inode_fault_page_count(size_t page_index_in_region)
+{
+    VERIFY(vmobject().m_lock.own_lock());
+
+    // Grow the readahead window while faults keep landing right behind what we read last time,
+    // and stop reading ahead as soon as the access pattern looks random.
+    if (m_readahead_advice == ReadaheadAdvice::Random)
+        m_inode_readahead_page_count = 0;
+    else if (m_readahead_advice == ReadaheadAdvice::Sequential)
+        m_inode_readahead_page_count = inode_readahead_max_page_count;
+    else if (page_index_in_region == m_next_sequential_inode_fault_page_index)
+        m_inode_readahead_page_count = m_inode_readahead_page_count ? min(m_inode_readahead_page_count * 2, inode_readahead_max_page_count) : inode_readahead_initial_page_count;
+    else
+        m_inode_readahead_page_count = 0;
+
+    size_t page_count = 1;
+    if (m_inode_readahead_page_count && MM.memory_pressure_level() == MemoryPressureLevel::None) {
+        auto end_page_index = min(page_index_in_region + 1 + m_inode_readahead_page_count, this->page_count());
+        for (auto page_index = page_index_in_region + 1; page_index < end_page_index && !physical_page(page_index); ++page_index)
+            ++page_count;
+    }
+    m_next_sequential_inode_fault_page_index = page_index_in_region + page_count;
+    return page_count;
+}
+
+void Region::map_cached_inode_pages_around(size_t page_index_in_region)
+{
+    ScopedSpinLock locker(vmobject().m_lock);
+    if (!m_page_directory)
+        return;
+    auto first_page_index = page_index_in_region - (page_index_in_region % inode_fault_around_page_count);
+    auto end_page_index = min(first_page_index + inode_fault_around_page_count, page_count());
+    ScopedSpinLock page_lock(m_page_directory->get_lock());
+    for (auto page_index = first_page_index; page_index < end_page_index; ++page_index) {
+        if (page_index == page_index_in_region || !physical_page(page_index))
+            continue;
+        // These pages weren't mapped in this region before, so there's nothing to flush.
+        if (!map_individual_page_impl(page_index))
+            break;
+    }
+}
+
 PageFaultResponse Region::handle_inode_fault(size_t page_index_in_region)
 {
     VERIFY_INTERRUPTS_DISABLED();
@@ -403,55 +581,94 @@ PageFaultResponse Region::handle_inode_fault(size_t page_index_in_region)
     auto& inode_vmobject = static_cast<InodeVMObject&>(vmobject());
 
     auto page_index_in_vmobject = translate_to_vmobject_page(page_index_in_region);
-    auto& vmobject_physical_page_entry = inode_vmobject.physical_pages()[page_index_in_vmobject];
-    VERIFY(vmobject_physical_page_entry.is_null());
 
-    dbgln_if(PAGE_FAULT_DEBUG, "Inode fault in {} page index: {}", name(), page_index_in_region);
+    size_t page_count_to_read = 0;
+    {
+        ScopedSpinLock locker(inode_vmobject.m_lock);
+        if (!inode_vmobject.physical_pages()[page_index_in_vmobject].is_null()) {
+            // The page cache brought this page in through read() since we last mapped it.
+            if (!remap_vmobject_page(page_index_in_vmobject))
+                return PageFaultResponse::OutOfMemory;
+            map_cached_inode_pages_around(page_index_in_region);
+            return PageFaultResponse::Continue;
+        }
+        page_count_to_read = inode_fault_page_count(page_index_in_region);
+    }
+
+    dbgln_if(PAGE_FAULT_DEBUG, "Inode fault in {} page index: {}, reading {} pages", name(), page_index_in_region, page_count_to_read);
 
     auto current_thread = Thread::current();
     if (current_thread)
         current_thread->did_inode_fault();
 
-    u8 page_buffer[PAGE_SIZE];
     auto& inode = inode_vmobject.inode();
 
-    auto buffer = UserOrKernelBuffer::for_kernel_buffer(page_buffer);
-    auto result = inode.read_bytes(page_index_in_vmobject * PAGE_SIZE, PAGE_SIZE, buffer, nullptr);
-
-    if (result.is_error()) {
-        dmesgln("handle_inode_fault: Error ({}) while reading from inode", result.error());
-        return PageFaultResponse::ShouldCrash;
+    if (inode_vmobject.is_shared_inode()) {
+        if (auto page = inode.physical_page_for_shared_mapping(page_index_in_vmobject)) {
+            ScopedSpinLock locker(inode_vmobject.m_lock);
+            auto& vmobject_physical_page_entry = inode_vmobject.physical_pages()[page_index_in_vmobject];
+            if (vmobject_physical_page_entry.is_null())
+                vmobject_physical_page_entry = move(page);
+            if (!remap_vmobject_page(page_index_in_vmobject))
+                return PageFaultResponse::OutOfMemory;
+            return PageFaultResponse::Continue;
+        }
     }
 
-    auto nread = result.value();
-    if (nread < PAGE_SIZE) {
-        // If we read less than a page, zero out the rest to avoid leaking uninitialized data.
-        memset(page_buffer + nread, 0, PAGE_SIZE - nread);
-    }
+    u8 page_buffer[PAGE_SIZE];
+
+    // The first page is the one we faulted on, any others are readahead. Failing to read
+    // ahead isn't fatal, we'll simply fault on those pages later.
+    for (size_t i = 0; i < page_count_to_read; ++i) {
+        auto page_index = page_index_in_vmobject + i;
+        auto buffer = UserOrKernelBuffer::for_kernel_buffer(page_buffer);
+        auto result = inode.read_bytes_for_page_cache(page_index * PAGE_SIZE, PAGE_SIZE, buffer);
+
+        if (result.is_error()) {
+            if (i != 0)
+                break;
+            dmesgln("handle_inode_fault: Error ({}) while reading from inode", result.error());
+            return PageFaultResponse::ShouldCrash;
+        }
 
-    ScopedSpinLock locker(inode_vmobject.m_lock);
+        auto nread = result.value();
+        if (nread < PAGE_SIZE) {
+            // If we read less than a page, zero out the rest to avoid leaking uninitialized data.
+            memset(page_buffer + nread, 0, PAGE_SIZE - nread);
+        }
 
-    if (!vmobject_physical_page_entry.is_null()) {
-        // Someone else faulted in this page while we were reading from the inode.
-        // No harm done (other than some duplicate work), remap the page here and return.
-        dbgln_if(PAGE_FAULT_DEBUG, "handle_inode_fault: Page faulted in by someone else, remapping.");
-        if (!remap_vmobject_page(page_index_in_vmobject))
+        ScopedSpinLock locker(inode_vmobject.m_lock);
+
+        auto& vmobject_physical_page_entry = inode_vmobject.physical_pages()[page_index];
+        if (!vmobject_physical_page_entry.is_null()) {
+            // Someone else faulted in this page while we were reading from the inode.
+            // No harm done (other than some duplicate work), remap the page here and move on.
+            dbgln_if(PAGE_FAULT_DEBUG, "handle_inode_fault: Page faulted in by someone else, remapping.");
+            if (!remap_vmobject_page(page_index) && i == 0)
+                return PageFaultResponse::OutOfMemory;
+            continue;
+        }
+
+        vmobject_physical_page_entry = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::No);
+
+        if (vmobject_physical_page_entry.is_null()) {
+            if (i != 0)
+                break;
+            dmesgln("MM: handle_inode_fault was unable to allocate a physical page");
             return PageFaultResponse::OutOfMemory;
-        return PageFaultResponse::Continue;
-    }
+        }
 
-    vmobject_physical_page_entry = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::No);
+        u8* dest_ptr = MM.quickmap_page(*vmobject_physical_page_entry);
+        memcpy(dest_ptr, page_buffer, PAGE_SIZE);
+        MM.unquickmap_page();
 
-    if (vmobject_physical_page_entry.is_null()) {
-        dmesgln("MM: handle_inode_fault was unable to allocate a physical page");
-        return PageFaultResponse::OutOfMemory;
+        if (i == 0)
+            remap_vmobject_page(page_index);
+        else if (!do_remap_vmobject_page(page_index, false))
+            break;
     }
 
-    u8* dest_ptr = MM.quickmap_page(*vmobject_physical_page_entry);
-    memcpy(dest_ptr, page_buffer, PAGE_SIZE);
-    MM.unquickmap_page();
-
-    remap_vmobject_page(page_index_in_vmobject);
+    map_cached_inode_pages_around(page_index_in_region);
     return PageFaultResponse::Continue;
 }
 
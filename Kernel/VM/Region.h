@@ -10,6 +10,7 @@
 #include <AK/IntrusiveList.h>
 #include <AK/Weakable.h>
 #include <Kernel/Arch/x86/PageFault.h>
+#include <Kernel/FileSystem/ReadaheadState.h>
 #include <Kernel/Forward.h>
 #include <Kernel/Heap/SlabAllocator.h>
 #include <Kernel/KString.h>
@@ -82,6 +83,8 @@ public:
     bool is_mmap() const { return m_mmap; }
     void set_mmap(bool mmap) { m_mmap = mmap; }
 
+    void set_readahead_advice(ReadaheadAdvice advice) { m_readahead_advice = advice; }
+
     bool is_user() const { return !is_kernel(); }
     bool is_kernel() const { return vaddr().get() < 0x00800000 || vaddr().get() >= kernel_mapping_base; }
 
@@ -168,11 +171,14 @@ public:
 
     void set_page_directory(PageDirectory&);
     bool map(PageDirectory&, ShouldFlushTLB = ShouldFlushTLB::Yes);
+    // Attaches the region to a page directory without creating any page table entries.
+    // Its pages get mapped one at a time as they are faulted in.
+    void map_lazily(PageDirectory&);
     enum class ShouldDeallocateVirtualMemoryRange {
         No,
         Yes,
     };
-    void unmap(ShouldDeallocateVirtualMemoryRange = ShouldDeallocateVirtualMemoryRange::Yes);
+    void unmap(ShouldDeallocateVirtualMemoryRange = ShouldDeallocateVirtualMemoryRange::Yes, ShouldFlushTLB = ShouldFlushTLB::Yes);
 
     void remap();
 
@@ -184,6 +190,8 @@ private:
 
     bool remap_vmobject_page(size_t page_index, bool with_flush = true);
     bool do_remap_vmobject_page(size_t page_index, bool with_flush = true);
+    bool remap_vmobject_huge_page(size_t first_page_index_in_vmobject);
+    bool do_remap_vmobject_huge_page(size_t first_page_index_in_vmobject);
 
     void set_access_bit(Access access, bool b)
     {
@@ -194,10 +202,17 @@ private:
     }
 
     PageFaultResponse handle_cow_fault(size_t page_index);
+    PageFaultResponse handle_cow_write_fault(size_t page_index);
     PageFaultResponse handle_inode_fault(size_t page_index);
     PageFaultResponse handle_zero_fault(size_t page_index);
 
+    size_t inode_fault_page_count(size_t page_index);
+    void map_cached_inode_pages_around(size_t page_index);
+
     bool map_individual_page_impl(size_t page_index);
+    bool can_map_huge_page(size_t page_index, size_t end_page_index) const;
+    void map_huge_page_impl(size_t page_index);
+    size_t map_page_range_impl(size_t page_index, size_t end_page_index);
 
     RefPtr<PageDirectory> m_page_directory;
     Range m_range;
@@ -210,6 +225,9 @@ private:
     bool m_stack : 1 { false };
     bool m_mmap : 1 { false };
     bool m_syscall_region : 1 { false };
+    size_t m_next_sequential_inode_fault_page_index { 0 };
+    size_t m_inode_readahead_page_count { 0 };
+    ReadaheadAdvice m_readahead_advice { ReadaheadAdvice::Normal };
     IntrusiveListNode<Region> m_memory_manager_list_node;
     IntrusiveListNode<Region> m_vmobject_list_node;
 
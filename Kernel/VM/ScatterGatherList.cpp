@@ -22,4 +22,49 @@ ScatterGatherList::ScatterGatherList(NonnullRefPtr<AnonymousVMObject> vm_object,
     m_dma_region = MM.allocate_kernel_region_with_vmobject(m_vm_object, page_round_up((request.block_count() * device_block_size)), "AHCI Scattered DMA", Region::Access::Read | Region::Access::Write, Region::Cacheable::Yes);
 }
 
+RefPtr<UserScatterGatherList> UserScatterGatherList::try_create_for_device_read(UserOrKernelBuffer& buffer, size_t size)
+{
+    if (buffer.is_kernel_buffer() || size == 0)
+        return {};
+    VirtualAddress base { buffer.user_or_kernel_ptr() };
+    auto first_page = base.page_base();
+    size_t page_count = page_round_up(base.get() + size - first_page.get()) / PAGE_SIZE;
+
+    // Touch every page first, so they are all present, writable and not shared copy-on-write anymore.
+    // The device overwrites the whole buffer anyway.
+    for (size_t page_index = 0; page_index < page_count; page_index++) {
+        auto offset = page_index == 0 ? 0 : first_page.offset(page_index * PAGE_SIZE).get() - base.get();
+        u8 byte;
+        if (!buffer.read(&byte, offset, 1) || !buffer.write(&byte, offset, 1))
+            return {};
+    }
+
+    auto list = adopt_ref_if_nonnull(new (nothrow) UserScatterGatherList);
+    if (!list)
+        return {};
+    list->m_pages.ensure_capacity(page_count);
+    list->m_entries.ensure_capacity(page_count);
+
+    auto& space = Process::current()->space();
+    ScopedSpinLock lock(space.get_lock());
+    auto vaddr = base;
+    size_t remaining = size;
+    while (remaining > 0) {
+        auto* region = space.find_region_containing(Range { vaddr, 1 });
+        if (!region || !region->is_writable() || !region->vmobject().is_anonymous())
+            return {};
+        auto page_index = region->page_index_from_address(vaddr);
+        RefPtr<PhysicalPage> page = region->physical_page_slot(page_index);
+        if (!page || page->is_shared_zero_page() || page->is_lazy_committed_page() || region->should_cow(page_index))
+            return {};
+        auto offset_in_page = vaddr.get() - vaddr.page_base().get();
+        auto entry_size = min(remaining, PAGE_SIZE - offset_in_page);
+        list->m_entries.unchecked_append({ page->paddr().offset(offset_in_page), entry_size });
+        list->m_pages.unchecked_append(page.release_nonnull());
+        vaddr = vaddr.offset(entry_size);
+        remaining -= entry_size;
+    }
+    return list;
+}
+
 }
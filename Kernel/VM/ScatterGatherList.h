@@ -29,4 +29,27 @@ private:
     OwnPtr<Region> m_dma_region;
 };
 
+// The physical pages behind a user buffer, for controllers to DMA straight into instead of going
+// through a buffer of their own. Holding on to the pages keeps them from being freed while the
+// request is in flight, even if the process unmaps them in the meantime.
+class UserScatterGatherList : public RefCounted<UserScatterGatherList> {
+public:
+    struct Entry {
+        PhysicalAddress address;
+        size_t size { 0 };
+    };
+
+    // Returns nullptr if the buffer can't be used for DMA, for example because it isn't backed by anonymous memory.
+    static RefPtr<UserScatterGatherList> try_create_for_device_read(UserOrKernelBuffer&, size_t size);
+
+    const Vector<Entry>& entries() const { return m_entries; }
+
+private:
+    UserScatterGatherList() = default;
+
+    NonnullRefPtrVector<PhysicalPage> m_pages;
+    // Split at page boundaries, so only the first entry may start and only the last one may end in the middle of a page.
+    Vector<Entry> m_entries;
+};
+
 }
@@ -5,10 +5,13 @@
  */
 
 #include <Kernel/FileSystem/Inode.h>
+#include <Kernel/VM/MemoryManager.h>
 #include <Kernel/VM/SharedInodeVMObject.h>
 
 namespace Kernel {
 
+static constexpr size_t max_prefetch_run_page_count = 16;
+
 RefPtr<SharedInodeVMObject> SharedInodeVMObject::try_create_with_inode(Inode& inode)
 {
     size_t size = inode.size();
@@ -36,4 +39,125 @@ SharedInodeVMObject::SharedInodeVMObject(SharedInodeVMObject const& other)
 {
 }
 
+KResult SharedInodeVMObject::read_page(size_t page_index, u8* page_buffer)
+{
+    VERIFY(page_index < page_count());
+    {
+        ScopedSpinLock locker(m_lock);
+        if (auto& page = m_physical_pages[page_index]) {
+            memcpy(page_buffer, MM.quickmap_page(*page), PAGE_SIZE);
+            MM.unquickmap_page();
+            return KSuccess;
+        }
+    }
+
+    auto buffer = UserOrKernelBuffer::for_kernel_buffer(page_buffer);
+    auto result = inode().read_bytes_for_page_cache(page_index * PAGE_SIZE, PAGE_SIZE, buffer);
+    if (result.is_error())
+        return result.error();
+    auto nread = result.value();
+    if (nread < PAGE_SIZE) {
+        // If we read less than a page, zero out the rest to avoid leaking uninitialized data.
+        memset(page_buffer + nread, 0, PAGE_SIZE - nread);
+    }
+
+    // Caching is best effort, the caller already has the data if we can't get a page for it.
+    cache_page(page_index, page_buffer);
+    return KSuccess;
+}
+
+bool SharedInodeVMObject::cache_page(size_t page_index, u8 const* page_data)
+{
+    auto new_page = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::No);
+    if (!new_page)
+        return false;
+
+    ScopedSpinLock locker(m_lock);
+    auto& page_slot = m_physical_pages[page_index];
+    if (page_slot) {
+        // Someone else brought this page in while we were reading from the inode.
+        return true;
+    }
+    memcpy(MM.quickmap_page(*new_page), page_data, PAGE_SIZE);
+    MM.unquickmap_page();
+    page_slot = move(new_page);
+    return true;
+}
+
+void SharedInodeVMObject::prefetch_pages(size_t first_page_index, size_t count)
+{
+    VERIFY(first_page_index + count <= page_count());
+    auto is_cached = [&](size_t page_index) {
+        ScopedSpinLock locker(m_lock);
+        return !m_physical_pages[page_index].is_null();
+    };
+
+    auto end_page_index = first_page_index + count;
+    for (auto page_index = first_page_index; page_index < end_page_index;) {
+        if (is_cached(page_index)) {
+            ++page_index;
+            continue;
+        }
+        size_t run_length = 1;
+        while (page_index + run_length < end_page_index && run_length < max_prefetch_run_page_count && !is_cached(page_index + run_length))
+            ++run_length;
+
+        auto run_buffer = ByteBuffer::create_uninitialized(run_length * PAGE_SIZE);
+        auto buffer = UserOrKernelBuffer::for_kernel_buffer(run_buffer.data());
+        auto result = inode().read_bytes_for_page_cache(page_index * PAGE_SIZE, run_length * PAGE_SIZE, buffer);
+        if (result.is_error())
+            return;
+        if (result.value() < run_length * PAGE_SIZE)
+            memset(run_buffer.data() + result.value(), 0, run_length * PAGE_SIZE - result.value());
+
+        for (size_t i = 0; i < run_length; ++i) {
+            if (!cache_page(page_index + i, run_buffer.data() + i * PAGE_SIZE))
+                return;
+        }
+        page_index += run_length;
+
+        // Readahead is speculative, don't keep going once memory gets tight.
+        if (MM.memory_pressure_level() != MemoryPressureLevel::None)
+            return;
+    }
+}
+
+KResultOr<size_t> SharedInodeVMObject::read_bytes(u64 offset, size_t count, UserOrKernelBuffer& buffer)
+{
+    u8 page_buffer[PAGE_SIZE];
+    size_t nread = 0;
+    while (nread < count) {
+        auto position = offset + nread;
+        size_t page_index = position / PAGE_SIZE;
+        if (page_index >= page_count())
+            break;
+        size_t offset_in_page = position % PAGE_SIZE;
+        size_t chunk_size = min(PAGE_SIZE - offset_in_page, count - nread);
+        if (auto result = read_page(page_index, page_buffer); result.is_error())
+            return result;
+        if (!buffer.write(page_buffer + offset_in_page, nread, chunk_size))
+            return EFAULT;
+        nread += chunk_size;
+    }
+    return nread;
+}
+
+void SharedInodeVMObject::invalidate_pages(size_t first_page_index, size_t count)
+{
+    ScopedSpinLock locker(m_lock);
+    VERIFY(first_page_index + count <= page_count());
+    bool did_invalidate = false;
+    for (size_t i = first_page_index; i < first_page_index + count; ++i) {
+        if (m_physical_pages[i]) {
+            m_physical_pages[i] = nullptr;
+            did_invalidate = true;
+        }
+    }
+    if (did_invalidate) {
+        for_each_region([](auto& region) {
+            region.remap();
+        });
+    }
+}
+
 }
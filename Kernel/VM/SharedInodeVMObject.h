@@ -7,7 +7,10 @@
 #pragma once
 
 #include <AK/Bitmap.h>
+#include <AK/IntrusiveList.h>
+#include <Kernel/KResult.h>
 #include <Kernel/UnixTypes.h>
+#include <Kernel/UserOrKernelBuffer.h>
 #include <Kernel/VM/InodeVMObject.h>
 
 namespace Kernel {
@@ -19,15 +22,28 @@ public:
     static RefPtr<SharedInodeVMObject> try_create_with_inode(Inode&);
     virtual RefPtr<VMObject> try_clone() override;
 
+    KResultOr<size_t> read_bytes(u64 offset, size_t count, UserOrKernelBuffer&);
+    void invalidate_pages(size_t first_page_index, size_t page_count);
+    // Brings the given pages into memory (unless they are already there), reading runs of missing pages at once.
+    void prefetch_pages(size_t first_page_index, size_t page_count);
+
 private:
     virtual bool is_shared_inode() const override { return true; }
 
+    KResult read_page(size_t page_index, u8* page_buffer);
+    bool cache_page(size_t page_index, u8 const* page_data);
+
     explicit SharedInodeVMObject(Inode&, size_t);
     explicit SharedInodeVMObject(SharedInodeVMObject const&);
 
     virtual StringView class_name() const override { return "SharedInodeVMObject"sv; }
 
     SharedInodeVMObject& operator=(SharedInodeVMObject const&) = delete;
+
+    IntrusiveListNode<SharedInodeVMObject, RefPtr<SharedInodeVMObject>> m_page_cache_list_node;
+
+public:
+    using PageCacheList = IntrusiveList<SharedInodeVMObject, RefPtr<SharedInodeVMObject>, &SharedInodeVMObject::m_page_cache_list_node>;
 };
 
 }
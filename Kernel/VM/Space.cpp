@@ -5,6 +5,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ScopeGuard.h>
 #include <Kernel/PerformanceManager.h>
 #include <Kernel/Process.h>
 #include <Kernel/SpinLock.h>
@@ -102,27 +103,35 @@ KResult Space::unmap_mmap_range(VirtualAddress addr, size_t size)
 
     Vector<Region*, 2> new_regions;
 
-    for (auto* old_region : regions) {
-        // If it's a full match we can remove the entire old region.
-        if (old_region->range().intersect(range_to_unmap).size() == old_region->size()) {
-            deallocate_region(*old_region);
-            continue;
+    {
+        // The regions are unmapped without flushing the TLB, so flush the whole range in one go once we're done,
+        // including when we bail out halfway through.
+        ScopeGuard flush_tlb_guard = [&] {
+            MM.flush_tlb(&page_directory(), range_to_unmap.base(), range_to_unmap.size() / PAGE_SIZE);
+        };
+
+        for (auto* old_region : regions) {
+            // If it's a full match we can remove the entire old region.
+            if (old_region->range().intersect(range_to_unmap).size() == old_region->size()) {
+                deallocate_region(*old_region);
+                continue;
+            }
+
+            // Remove the old region from our regions tree, since were going to add another region
+            // with the exact same start address, but don't deallocate it yet.
+            auto region = take_region(*old_region);
+
+            // We manually unmap the old region here, specifying that we *don't* want the VM deallocated.
+            region->unmap(Region::ShouldDeallocateVirtualMemoryRange::No, ShouldFlushTLB::No);
+
+            // Otherwise, split the regions and collect them for future mapping.
+            auto split_regions_or_error = try_split_region_around_range(*region, range_to_unmap);
+            if (split_regions_or_error.is_error())
+                return split_regions_or_error.error();
+
+            if (!new_regions.try_extend(split_regions_or_error.value()))
+                return ENOMEM;
         }
-
-        // Remove the old region from our regions tree, since were going to add another region
-        // with the exact same start address, but don't deallocate it yet.
-        auto region = take_region(*old_region);
-
-        // We manually unmap the old region here, specifying that we *don't* want the VM deallocated.
-        region->unmap(Region::ShouldDeallocateVirtualMemoryRange::No);
-
-        // Otherwise, split the regions and collect them for future mapping.
-        auto split_regions_or_error = try_split_region_around_range(*region, range_to_unmap);
-        if (split_regions_or_error.is_error())
-            return split_regions_or_error.error();
-
-        if (new_regions.try_extend(split_regions_or_error.value()))
-            return ENOMEM;
     }
 
     // Give back any unwanted VM to the range allocator.
@@ -61,6 +61,12 @@ public:
         m_regions.remove(region);
     }
 
+    bool is_mapped() const
+    {
+        ScopedSpinLock locker(m_lock);
+        return !m_regions.is_empty();
+    }
+
     void register_on_deleted_handler(VMObjectDeletedHandler& handler)
     {
         ScopedSpinLock locker(m_on_deleted_lock);
@@ -36,6 +36,16 @@ UNMAP_AFTER_INIT void VirtIO::detect()
             // This should have been initialized by the graphics subsystem
             break;
         }
+        case PCI::DeviceID::VirtIOBlock:
+        case PCI::DeviceID::VirtIOBlockNonTransitional: {
+            // This is initialized by the storage subsystem
+            break;
+        }
+        case PCI::DeviceID::VirtIONetwork:
+        case PCI::DeviceID::VirtIONetworkNonTransitional: {
+            // This is initialized by the networking subsystem
+            break;
+        }
         default:
             dbgln_if(VIRTIO_DEBUG, "VirtIO: Unknown VirtIO device with ID: {}", id.device_id);
             break;
@@ -210,14 +220,10 @@ bool VirtIODevice::accept_device_features(u64 device_features, u64 accepted_feat
         accepted_features &= ~(VIRTIO_F_RING_PACKED);
     }
 
-    // TODO: implement indirect descriptors to allow queue_size buffers instead of buffers totalling (PAGE_SIZE * queue_size) bytes
-    if (is_feature_set(device_features, VIRTIO_F_INDIRECT_DESC)) {
-        // accepted_features |= VIRTIO_F_INDIRECT_DESC;
-    }
-
-    if (is_feature_set(device_features, VIRTIO_F_IN_ORDER)) {
-        accepted_features |= VIRTIO_F_IN_ORDER;
-    }
+    // Indirect descriptors are left to the drivers that know how to build the tables (see VirtIOQueueChain).
+    // VIRTIO_F_IN_ORDER allows the device to return a whole batch of chains with a single used ring entry,
+    // which pop_used_buffer_chain() doesn't handle, so that one is never accepted.
+    accepted_features &= ~(VIRTIO_F_IN_ORDER);
 
     dbgln_if(VIRTIO_DEBUG, "{}: Device features: {}", m_class_name, device_features);
     dbgln_if(VIRTIO_DEBUG, "{}: Accepted features: {}", m_class_name, accepted_features);
@@ -364,13 +370,16 @@ bool VirtIODevice::handle_irq(const RegisterState&)
     }
     if (isr_type & QUEUE_INTERRUPT) {
         dbgln_if(VIRTIO_DEBUG, "{}: VirtIO Queue interrupt!", m_class_name);
+        // Reading the ISR status acknowledged the interrupt for all queues, so all of them have to be looked at.
+        bool did_handle_queue = false;
         for (size_t i = 0; i < m_queues.size(); i++) {
             if (get_queue(i).new_data_available()) {
                 handle_queue_update(i);
-                return true;
+                did_handle_queue = true;
             }
         }
-        dbgln_if(VIRTIO_DEBUG, "{}: Got queue interrupt but all queues are up to date!", m_class_name);
+        if (!did_handle_queue)
+            dbgln_if(VIRTIO_DEBUG, "{}: Got queue interrupt but all queues are up to date!", m_class_name);
     }
     return true;
 }
@@ -166,6 +166,26 @@ bool VirtIOQueueChain::add_buffer_to_chain(PhysicalAddress buffer_start, size_t
     return true;
 }
 
+bool VirtIOQueueChain::add_indirect_descriptor_table_to_chain(PhysicalAddress table_start, size_t descriptor_count)
+{
+    VERIFY(m_queue.lock().is_locked());
+    VERIFY(is_empty());
+    VERIFY(descriptor_count > 0 && descriptor_count <= m_queue.m_queue_size);
+
+    auto descriptor_index = m_queue.take_free_slot();
+    if (!descriptor_index.has_value())
+        return false;
+
+    m_start_of_chain_index = m_end_of_chain_index = descriptor_index.value();
+    m_chain_length = 1;
+
+    m_queue.m_descriptors[descriptor_index.value()].address = static_cast<u64>(table_start.get());
+    m_queue.m_descriptors[descriptor_index.value()].flags = VIRTQ_DESC_F_INDIRECT;
+    m_queue.m_descriptors[descriptor_index.value()].length = static_cast<u32>(descriptor_count * sizeof(VirtIOQueue::VirtIOQueueDescriptor));
+
+    return true;
+}
+
 void VirtIOQueueChain::submit_to_queue()
 {
     VERIFY(m_queue.lock().is_locked());
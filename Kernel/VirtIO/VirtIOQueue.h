@@ -28,11 +28,20 @@ class VirtIOQueueChain;
 
 class VirtIOQueue {
 public:
+    // Also the layout of the entries of an indirect descriptor table.
+    struct [[gnu::packed]] VirtIOQueueDescriptor {
+        u64 address;
+        u32 length;
+        u16 flags;
+        u16 next;
+    };
+
     VirtIOQueue(u16 queue_size, u16 notify_offset);
     ~VirtIOQueue();
 
     bool is_null() const { return !m_queue_region; }
     u16 notify_offset() const { return m_notify_offset; }
+    u16 size() const { return m_queue_size; }
 
     void enable_interrupts();
     void disable_interrupts();
@@ -59,12 +68,6 @@ private:
         auto offset = FlatPtr(ptr) - m_queue_region->vaddr().get();
         return m_queue_region->physical_page(0)->paddr().offset(offset);
     }
-    struct [[gnu::packed]] VirtIOQueueDescriptor {
-        u64 address;
-        u32 length;
-        u16 flags;
-        u16 next;
-    };
 
     struct [[gnu::packed]] VirtIOQueueDriver {
         u16 flags;
@@ -151,6 +154,9 @@ public:
     [[nodiscard]] bool is_empty() const { return m_chain_length == 0; }
     [[nodiscard]] size_t length() const { return m_chain_length; }
     bool add_buffer_to_chain(PhysicalAddress buffer_start, size_t buffer_length, BufferType buffer_type);
+    // Makes the chain consist of just a single descriptor, which refers to a table of descriptor_count
+    // descriptors that the caller filled in. Only allowed if VIRTIO_F_INDIRECT_DESC was negotiated.
+    bool add_indirect_descriptor_table_to_chain(PhysicalAddress table_start, size_t descriptor_count);
     void submit_to_queue();
     void release_buffer_slots_to_queue();
 
@@ -5,6 +5,7 @@
  */
 
 #include <Kernel/Process.h>
+#include <Kernel/Scheduler.h>
 #include <Kernel/Sections.h>
 #include <Kernel/SpinLock.h>
 #include <Kernel/WaitQueue.h>
@@ -13,45 +14,78 @@
 namespace Kernel {
 
 WorkQueue* g_io_work;
+WorkQueue* g_readahead_work;
 
 UNMAP_AFTER_INIT void WorkQueue::initialize()
 {
     g_io_work = new WorkQueue("IO WorkQueue");
+    g_readahead_work = new WorkQueue("Readahead WorkQueue");
 }
 
 UNMAP_AFTER_INIT WorkQueue::WorkQueue(const char* name)
 {
-    RefPtr<Thread> thread;
-    Process::create_kernel_process(thread, name, [this] {
-        for (;;) {
-            WorkItem* item;
-            bool have_more;
-            {
-                ScopedSpinLock lock(m_lock);
-                item = m_items.take_first();
-                have_more = !m_items.is_empty();
-            }
-            if (item) {
-                item->function();
-                delete item;
-
-                if (have_more)
-                    continue;
-            }
-            [[maybe_unused]] auto result = m_wait_queue.wait_on({});
+    RefPtr<Process> process;
+    auto processors_mask = Scheduler::schedulable_processors_mask();
+    for (u32 cpu = 0; cpu < Processor::count(); cpu++) {
+        if (!(processors_mask & (1u << cpu)))
+            break;
+        m_workers.append(make<Worker>());
+        auto& worker = m_workers.last();
+
+        RefPtr<Thread> thread;
+        if (!process)
+            process = Process::create_kernel_process(thread, name, run_worker, &worker, 1u << cpu);
+        else
+            thread = process->create_kernel_thread(run_worker, &worker, THREAD_PRIORITY_NORMAL, String::formatted("{} #{}", name, cpu), 1u << cpu, false);
+        // If we can't create the thread we're in trouble...
+        worker.thread = thread.release_nonnull();
+    }
+    VERIFY(!m_workers.is_empty());
+}
+
+void WorkQueue::run_worker(void* data)
+{
+    auto& worker = *static_cast<Worker*>(data);
+    for (;;) {
+        WorkItem* item;
+        bool have_more;
+        {
+            ScopedSpinLock lock(worker.lock);
+            item = worker.items.take_first();
+            have_more = !worker.items.is_empty();
+        }
+        if (item) {
+            item->function();
+            delete item;
+            worker.pending_count--;
+
+            if (have_more)
+                continue;
         }
-    });
-    // If we can't create the thread we're in trouble...
-    m_thread = thread.release_nonnull();
+        [[maybe_unused]] auto result = worker.wait_queue.wait_on({});
+    }
 }
 
-void WorkQueue::do_queue(WorkItem* item)
+void WorkQueue::do_queue(WorkItem* item, Locality locality)
 {
+    // Processors that don't run threads hand their work to the first worker
+    auto cpu = Processor::id();
+    auto* worker = &m_workers[cpu < m_workers.size() ? cpu : 0];
+
+    if (locality == Locality::AnyProcessor && worker->pending_count.load() != 0) {
+        // Our own worker is busy, give the work to whichever one has the least to do
+        for (auto& other_worker : m_workers) {
+            if (other_worker.pending_count.load() < worker->pending_count.load())
+                worker = &other_worker;
+        }
+    }
+
+    worker->pending_count++;
     {
-        ScopedSpinLock lock(m_lock);
-        m_items.append(*item);
+        ScopedSpinLock lock(worker->lock);
+        worker->items.append(*item);
     }
-    m_wait_queue.wake_one();
+    worker->wait_queue.wake_one();
 }
 
 }
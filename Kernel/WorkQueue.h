@@ -7,11 +7,16 @@
 #pragma once
 
 #include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtrVector.h>
 #include <Kernel/Forward.h>
+#include <Kernel/SpinLock.h>
+#include <Kernel/WaitQueue.h>
 
 namespace Kernel {
 
 extern WorkQueue* g_io_work;
+// Readahead waits for I/O, which completes on g_io_work, so it needs workers of its own.
+extern WorkQueue* g_readahead_work;
 
 class WorkQueue {
     AK_MAKE_NONCOPYABLE(WorkQueue);
@@ -22,7 +27,15 @@ public:
 
     WorkQueue(const char*);
 
-    void queue(void (*function)(void*), void* data = nullptr, void (*free_data)(void*) = nullptr)
+    enum class Locality {
+        // Run on whichever worker is least busy, preferring the submitting processor
+        AnyProcessor,
+        // Always run on the worker of the submitting processor, e.g. to keep
+        // the data the work touches in a warm cache
+        SameProcessor,
+    };
+
+    void queue(void (*function)(void*), void* data = nullptr, void (*free_data)(void*) = nullptr, Locality locality = Locality::AnyProcessor)
     {
         auto* item = new WorkItem; // TODO: use a pool
         item->function = [function, data, free_data] {
@@ -30,15 +43,15 @@ public:
             if (free_data)
                 free_data(data);
         };
-        do_queue(item);
+        do_queue(item, locality);
     }
 
     template<typename Function>
-    void queue(Function function)
+    void queue(Function function, Locality locality = Locality::AnyProcessor)
     {
         auto* item = new WorkItem; // TODO: use a pool
         item->function = Function(function);
-        do_queue(item);
+        do_queue(item, locality);
     }
 
 private:
@@ -47,12 +60,19 @@ private:
         Function<void()> function;
     };
 
-    void do_queue(WorkItem*);
+    // Every processor that runs threads gets its own worker thread, pinned to it.
+    struct Worker {
+        RefPtr<Thread> thread;
+        WaitQueue wait_queue;
+        IntrusiveList<WorkItem, RawPtr<WorkItem>, &WorkItem::m_node> items;
+        Atomic<u32, AK::MemoryOrder::memory_order_relaxed> pending_count { 0 };
+        SpinLock<u8> lock;
+    };
+
+    void do_queue(WorkItem*, Locality);
+    static void run_worker(void*);
 
-    RefPtr<Thread> m_thread;
-    WaitQueue m_wait_queue;
-    IntrusiveList<WorkItem, RawPtr<WorkItem>, &WorkItem::m_node> m_items;
-    SpinLock<u8> m_lock;
+    NonnullOwnPtrVector<Worker> m_workers;
 };
 
 }
@@ -17,9 +17,11 @@
 #include <Kernel/CMOS.h>
 #include <Kernel/CommandLine.h>
 #include <Kernel/Devices/FullDevice.h>
+#include <Kernel/Devices/IOScheduler.h>
 #include <Kernel/Devices/HID/HIDManagement.h>
 #include <Kernel/Devices/KCOVDevice.h>
 #include <Kernel/Devices/MemoryDevice.h>
+#include <Kernel/Devices/MemoryPressureDevice.h>
 #include <Kernel/Devices/NullDevice.h>
 #include <Kernel/Devices/PCISerialDevice.h>
 #include <Kernel/Devices/RandomDevice.h>
@@ -27,12 +29,15 @@
 #include <Kernel/Devices/SerialDevice.h>
 #include <Kernel/Devices/VMWareBackdoor.h>
 #include <Kernel/Devices/ZeroDevice.h>
+#include <Kernel/FileSystem/DiskCache.h>
 #include <Kernel/FileSystem/Ext2FileSystem.h>
 #include <Kernel/FileSystem/SysFS.h>
 #include <Kernel/FileSystem/VirtualFileSystem.h>
 #include <Kernel/Graphics/GraphicsManagement.h>
 #include <Kernel/Heap/SlabAllocator.h>
+#include <Kernel/Heap/SlabCache.h>
 #include <Kernel/Heap/kmalloc.h>
+#include <Kernel/IOStatistics.h>
 #include <Kernel/Interrupts/APIC.h>
 #include <Kernel/Interrupts/InterruptManagement.h>
 #include <Kernel/Interrupts/PIC.h>
@@ -53,8 +58,12 @@
 #include <Kernel/TTY/PTYMultiplexer.h>
 #include <Kernel/TTY/VirtualConsole.h>
 #include <Kernel/Tasks/FinalizerTask.h>
+#include <Kernel/Tasks/IRQBalanceTask.h>
+#include <Kernel/Tasks/PageZeroingTask.h>
+#include <Kernel/Tasks/ReclaimTask.h>
 #include <Kernel/Tasks/SyncTask.h>
 #include <Kernel/Time/TimeManagement.h>
+#include <Kernel/Tracepoints.h>
 #include <Kernel/VM/MemoryManager.h>
 #include <Kernel/VirtIO/VirtIO.h>
 #include <Kernel/WorkQueue.h>
@@ -184,6 +193,9 @@ extern "C" [[noreturn]] UNMAP_AFTER_INIT void init(BootInfo const& boot_info)
 
     ConsoleDevice::initialize();
     s_bsp_processor.initialize(0);
+    kmalloc_enable_processor_cache();
+    SlabCache::enable_processor_magazines();
+    Tracepoints::initialize_processor_buffer();
 
     CommandLine::initialize();
     MemoryManager::initialize(0);
@@ -200,6 +212,7 @@ extern "C" [[noreturn]] UNMAP_AFTER_INIT void init(BootInfo const& boot_info)
     APIC::initialize();
     InterruptManagement::initialize();
     ACPI::initialize();
+    MM.initialize_numa_nodes();
 
     // Initialize TimeManagement before using randomness!
     TimeManagement::initialize(0);
@@ -236,6 +249,9 @@ extern "C" [[noreturn]] UNMAP_AFTER_INIT void init_ap(FlatPtr cpu, Processor* pr
     processor_info->early_initialize(cpu);
 
     processor_info->initialize(cpu);
+    kmalloc_enable_processor_cache();
+    SlabCache::enable_processor_magazines();
+    Tracepoints::initialize_processor_buffer();
     MemoryManager::initialize(cpu);
 
     Scheduler::set_idle_thread(APIC::the().get_idle_thread(cpu));
@@ -265,8 +281,6 @@ void init_stage2(void*)
     // The colonel process gets away without having to do this because it never exits.
     Process::register_new(*Process::current());
 
-    WorkQueue::initialize();
-
     if (APIC::initialized() && APIC::the().enabled_processor_count() > 1) {
         // We can't start the APs until we have a scheduler up and running.
         // We need to be able to process ICI messages, otherwise another
@@ -275,6 +289,9 @@ void init_stage2(void*)
         APIC::the().boot_aps();
     }
 
+    // The work queues have a worker per processor, so wait for the APs first
+    WorkQueue::initialize();
+
     // Initialize the PCI Bus as early as possible, for early boot (PCI based) serial logging
     SysFSComponentRegistry::initialize();
     PCI::initialize();
@@ -296,7 +313,10 @@ void init_stage2(void*)
     ConsoleManagement::the().initialize();
 
     SyncTask::spawn();
+    ReclaimTask::spawn();
+    PageZeroingTask::spawn();
     FinalizerTask::spawn();
+    IRQBalanceTask::spawn();
 
     auto boot_profiling = kernel_command_line().is_boot_profiling_enabled();
 
@@ -304,6 +324,11 @@ void init_stage2(void*)
 
     BIOSSysFSDirectory::initialize();
     ACPI::ACPISysFSDirectory::initialize();
+    Scheduler::initialize_sysfs_directory();
+    InterruptManagement::initialize_sysfs_directory();
+    DiskCache::initialize_sysfs_component();
+    IOStatistics::initialize_sysfs_directory();
+    IOScheduler::initialize_sysfs_component();
 
     VirtIO::detect();
 
@@ -317,6 +342,7 @@ void init_stage2(void*)
     (void)ZeroDevice::must_create().leak_ref();
     (void)FullDevice::must_create().leak_ref();
     (void)RandomDevice::must_create().leak_ref();
+    MemoryPressureDevice::initialize();
     PTYMultiplexer::initialize();
     SB16::detect();
 
@@ -13,7 +13,9 @@ set(CALLBACK_MACHINE_DEBUG ON)
 set(CHTTPJOB_DEBUG ON)
 set(CNETWORKJOB_DEBUG ON)
 set(COMMIT_DEBUG ON)
+set(COMPACTION_DEBUG ON)
 set(COMPOSE_DEBUG ON)
+set(CONNECTION_CACHE_DEBUG ON)
 set(CONTEXT_SWITCH_DEBUG ON)
 set(CONTIGUOUS_VMOBJECT_DEBUG ON)
 set(COPY_DEBUG ON)
@@ -23,6 +25,7 @@ set(CRYPTO_DEBUG ON)
 set(CSOCKET_DEBUG ON)
 set(CSS_LOADER_DEBUG ON)
 set(CURSOR_TOOL_DEBUG ON)
+set(CUSTODY_CACHE_DEBUG ON)
 set(DDS_DEBUG ON)
 set(DEBUG_AUTOCOMPLETE ON)
 set(DEBUG_CPP_LANGUAGE_SERVER ON)
@@ -39,6 +42,7 @@ set(E1000E_DEBUG ON)
 set(EDITOR_DEBUG ON)
 set(ELF_IMAGE_DEBUG ON)
 set(EMOJI_DEBUG ON)
+set(EPOLL_DEBUG ON)
 set(ESCAPE_SEQUENCE_DEBUG ON)
 set(ETHERNET_DEBUG ON)
 set(ETHERNET_VERY_DEBUG ON)
@@ -72,6 +76,8 @@ set(HIGHLIGHT_FOCUSED_FRAME_DEBUG ON)
 set(HPET_COMPARATOR_DEBUG ON)
 set(HPET_DEBUG ON)
 set(HTML_SCRIPT_DEBUG ON)
+set(HTTP2_DEBUG ON)
+set(HTTP_CACHE_DEBUG ON)
 set(HTTPSJOB_DEBUG ON)
 set(HUNKS_DEBUG ON)
 set(ICMP_DEBUG ON)
@@ -84,6 +90,7 @@ set(IOAPIC_DEBUG ON)
 set(IO_DEBUG ON)
 set(IPV4_DEBUG ON)
 set(IPV4_SOCKET_DEBUG ON)
+set(IPV6_DEBUG ON)
 set(IRC_DEBUG ON)
 set(IRQ_DEBUG ON)
 set(ITEM_RECTS_DEBUG ON)
@@ -101,6 +108,7 @@ set(LOCK_DEBUG ON)
 set(LOCK_RESTORE_DEBUG ON)
 set(LOCK_TRACE_DEBUG ON)
 set(LOOKUPSERVER_DEBUG ON)
+set(LOOPBACK_DEBUG ON)
 set(MALLOC_DEBUG ON)
 set(MARKDOWN_DEBUG ON)
 set(MATROSKA_DEBUG ON)
@@ -117,6 +125,7 @@ set(MULTIPROCESSOR_DEBUG ON)
 set(NE2000_DEBUG ON)
 set(NETWORK_TASK_DEBUG ON)
 set(NT_DEBUG ON)
+set(NVME_DEBUG ON)
 set(OCCLUSIONS_DEBUG ON)
 set(OFFD_DEBUG ON)
 set(PAGE_FAULT_DEBUG ON)
@@ -135,6 +144,7 @@ set(PS2MOUSE_DEBUG ON)
 set(PTHREAD_DEBUG ON)
 set(PTMX_DEBUG ON)
 set(REACHABLE_DEBUG ON)
+set(RECLAIM_DEBUG ON)
 set(REGEX_DEBUG ON)
 set(RESIZE_DEBUG ON)
 set(RESOURCE_DEBUG ON)
@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+
+import argparse
+import os
+import sys
+from collections import defaultdict
+
+SIZE_BUCKET_COUNT = 17
+
+
+def bucket_upper_bound(bucket):
+    """Final sizes are counted in buckets of 0, 1, 2-3, 4-7, ..., with the last one taking everything larger."""
+    return 0 if bucket == 0 else (1 << bucket) - 1
+
+
+def read_reports(directory):
+    """Sum up the counts of all processes that wrote a report, by the place in the source their Vectors were declared."""
+    sites = defaultdict(lambda: {"constructed": 0, "destroyed": 0, "allocations": 0, "spilled": 0, "max_size": 0,
+                                 "final_sizes": [0] * SIZE_BUCKET_COUNT})
+    for name in os.listdir(directory):
+        with open(os.path.join(directory, name)) as report:
+            for line in report:
+                if line.startswith("#"):
+                    continue
+                fields = line.rstrip("\n").split("\t")
+                path, line_number, inline_capacity, element_size = fields[0], int(fields[1]), int(fields[2]), int(fields[3])
+                constructed, destroyed, allocations, spilled, max_size = map(int, fields[4:9])
+                site = sites[(os.path.normpath(path), line_number, inline_capacity, element_size)]
+                site["constructed"] += constructed
+                site["destroyed"] += destroyed
+                site["allocations"] += allocations
+                site["spilled"] += spilled
+                site["max_size"] = max(site["max_size"], max_size)
+                for bucket, count in enumerate(map(int, fields[9:9 + SIZE_BUCKET_COUNT])):
+                    site["final_sizes"][bucket] += count
+    return sites
+
+
+def suggested_inline_capacity(final_sizes, coverage):
+    """The smallest inline capacity that the given share of Vectors would have fit into when they were destroyed.
+    There's no suggestion if that's more than the buckets tell apart, as those Vectors are too large to be inline anyway."""
+    total = sum(final_sizes)
+    if total == 0:
+        return None
+    seen = 0
+    for bucket, count in enumerate(final_sizes):
+        seen += count
+        if seen >= coverage * total:
+            return bucket_upper_bound(bucket) if bucket < SIZE_BUCKET_COUNT - 1 else None
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Show which Vectors allocate the most, from a system built with ENABLE_VECTOR_GROWTH_INSTRUMENTATION.")
+    parser.add_argument("directory", nargs="?", default="/tmp/vector-growth",
+                        help="where the processes wrote their reports (default: %(default)s)")
+    parser.add_argument("--coverage", type=float, default=0.9,
+                        help="share of Vectors that should fit into the suggested inline capacity (default: %(default)s)")
+    parser.add_argument("--limit", type=int, default=50, help="number of places to show (default: %(default)s)")
+    args = parser.parse_args()
+
+    if not os.path.isdir(args.directory):
+        print(f"{args.directory} doesn't exist, did you run anything that was built with the instrumentation?",
+              file=sys.stderr)
+        return 1
+
+    sites = read_reports(args.directory)
+    ranked = sorted(sites.items(), key=lambda item: item[1]["allocations"], reverse=True)[:args.limit]
+
+    print(f"{'allocations':>12} {'vectors':>10} {'spilled':>8} {'max size':>9} {'inline':>7} {'suggested':>10}  location")
+    for (path, line_number, inline_capacity, element_size), site in ranked:
+        spilled = 100 * site["spilled"] / site["constructed"] if site["constructed"] else 0
+        suggestion = suggested_inline_capacity(site["final_sizes"], args.coverage)
+        suggestion = "-" if suggestion is None else str(suggestion)
+        print(f"{site['allocations']:>12} {site['constructed']:>10} {spilled:>7.1f}% {site['max_size']:>9} "
+              f"{inline_capacity:>7} {suggestion:>10}  {path}:{line_number} ({element_size}-byte elements)")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Arena.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/RefCounted.h>
+#include <AK/Vector.h>
+#include <string.h>
+
+static size_t s_live_nodes = 0;
+
+class Node : public RefCounted<Node> {
+    AK_MAKE_ARENA_ALLOCATED
+
+public:
+    explicit Node(int value)
+        : m_value(value)
+    {
+        ++s_live_nodes;
+    }
+    ~Node() { --s_live_nodes; }
+
+    int value() const { return m_value; }
+
+private:
+    int m_value { 0 };
+};
+
+TEST_CASE(allocations_are_aligned_and_distinct)
+{
+    Arena arena(256);
+    Vector<u8*> allocations;
+    for (size_t i = 1; i < 100; ++i) {
+        auto* ptr = static_cast<u8*>(arena.allocate(i));
+        EXPECT_EQ((FlatPtr)ptr % Arena::default_alignment, 0u);
+        memset(ptr, (int)i, i);
+        allocations.append(ptr);
+    }
+    for (size_t i = 1; i < 100; ++i) {
+        for (size_t j = 0; j < i; ++j)
+            EXPECT_EQ(allocations[i - 1][j], (u8)i);
+    }
+    EXPECT(arena.bytes_reserved() >= arena.bytes_allocated());
+}
+
+TEST_CASE(large_alignment)
+{
+    Arena arena;
+    arena.allocate(1);
+    auto* ptr = arena.allocate(64, 128);
+    EXPECT_EQ((FlatPtr)ptr % 128, 0u);
+}
+
+TEST_CASE(allocation_larger_than_chunk)
+{
+    Arena arena(128);
+    auto* ptr = static_cast<u8*>(arena.allocate(4096));
+    memset(ptr, 0xaa, 4096);
+    EXPECT(arena.bytes_reserved() >= 4096u);
+}
+
+TEST_CASE(ref_counted_objects)
+{
+    Arena arena;
+    {
+        auto a = adopt_ref(*new (arena) Node(1));
+        auto b = adopt_ref(*new (arena) Node(2));
+        EXPECT_EQ(s_live_nodes, 2u);
+        EXPECT_EQ(a->value(), 1);
+        EXPECT_EQ(b->value(), 2);
+    }
+    EXPECT_EQ(s_live_nodes, 0u);
+}
+
+TEST_CASE(objects_outliving_arena)
+{
+    RefPtr<Node> survivor;
+    {
+        Arena arena;
+        for (int i = 0; i < 1000; ++i) {
+            auto node = adopt_ref(*new (arena) Node(i));
+            if (i == 500)
+                survivor = node;
+        }
+        EXPECT_EQ(s_live_nodes, 1u);
+    }
+    EXPECT_EQ(survivor->value(), 500);
+    survivor = nullptr;
+    EXPECT_EQ(s_live_nodes, 0u);
+}
+
+TEST_CASE(objects_outside_of_arena)
+{
+    auto node = adopt_ref(*new Node(42));
+    EXPECT_EQ((FlatPtr)node.ptr() % Arena::default_alignment, 0u);
+    EXPECT_EQ(node->value(), 42);
+}
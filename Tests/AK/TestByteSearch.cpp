@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/ByteSearch.h>
+#include <AK/MemMem.h>
+#include <AK/StringView.h>
+#include <AK/Utf8View.h>
+#include <AK/Vector.h>
+
+TEST_CASE(find_byte_at_every_position)
+{
+    // Go over every position in and around the 16-byte blocks, and every length of the tail after them.
+    for (size_t length = 0; length < 70; ++length) {
+        Vector<u8> haystack;
+        haystack.resize(length);
+        for (size_t position = 0; position < length; ++position) {
+            haystack.span().fill(0);
+            haystack[position] = 0xaa;
+            if (position + 1 < length)
+                haystack[length - 1] = 0xaa;
+            EXPECT_EQ(find_byte(haystack.span(), 0xaa), position);
+        }
+        haystack.span().fill(1);
+        EXPECT(!find_byte(haystack.span(), 0xaa).has_value());
+    }
+}
+
+TEST_CASE(find_byte_in_string_view)
+{
+    StringView string = "hello friends, this is a long string with a comma at thirteen";
+    EXPECT_EQ(string.find(','), 13u);
+    EXPECT_EQ(string.find('t'), 15u);
+    EXPECT_EQ(string.find('t', 16), 31u);
+    EXPECT(!string.find('&').has_value());
+}
+
+TEST_CASE(count_leading_ascii_bytes)
+{
+    for (size_t length = 0; length < 70; ++length) {
+        Vector<u8> bytes;
+        bytes.resize(length);
+        bytes.span().fill('a');
+        EXPECT_EQ(count_leading_ascii_bytes(bytes.span()), length);
+        for (size_t position = 0; position < length; ++position) {
+            bytes.span().fill('a');
+            bytes[position] = 0xc3;
+            EXPECT_EQ(count_leading_ascii_bytes(bytes.span()), position);
+        }
+    }
+}
+
+TEST_CASE(memmem_at_every_position)
+{
+    u8 const needle[] = { 'n', 'e', 'e', 'd', 'l', 'e' };
+    for (size_t length = sizeof(needle); length < 80; ++length) {
+        Vector<u8> haystack;
+        haystack.resize(length);
+        for (size_t position = 0; position + sizeof(needle) <= length; ++position) {
+            // Plenty of partial matches of the first and the last byte to get past.
+            for (size_t i = 0; i < length; ++i)
+                haystack[i] = i % 2 ? 'n' : 'e';
+            __builtin_memcpy(haystack.data() + position, needle, sizeof(needle));
+            EXPECT_EQ(AK::memmem_optional(haystack.data(), length, needle, sizeof(needle)), position);
+        }
+    }
+}
+
+TEST_CASE(utf8_validation)
+{
+    EXPECT(Utf8View("plain ASCII text that is longer than a vector"sv).validate());
+    EXPECT(Utf8View("ASCII followed by a multi-byte character: \xc3\xa9, and more ASCII after it."sv).validate());
+    EXPECT(!Utf8View("ASCII followed by a broken character \xc3"sv).validate());
+    EXPECT(!Utf8View("a stray continuation byte \x80 in the middle of the text"sv).validate());
+
+    size_t valid_bytes = 0;
+    EXPECT(!Utf8View("0123456789abcdefghij\xff"sv).validate(valid_bytes));
+    EXPECT_EQ(valid_bytes, 20u);
+}
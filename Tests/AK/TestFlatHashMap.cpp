@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/FlatHashMap.h>
+#include <AK/FlyString.h>
+#include <AK/HashMap.h>
+#include <AK/OwnPtr.h>
+#include <AK/String.h>
+
+TEST_CASE(construct)
+{
+    using IntIntMap = FlatHashMap<int, int>;
+    EXPECT(IntIntMap().is_empty());
+    EXPECT_EQ(IntIntMap().size(), 0u);
+    EXPECT(IntIntMap().begin() == IntIntMap().end());
+}
+
+TEST_CASE(populate)
+{
+    FlatHashMap<int, String> number_to_string;
+    EXPECT_EQ(number_to_string.set(1, "One"), AK::HashSetResult::InsertedNewEntry);
+    EXPECT_EQ(number_to_string.set(2, "Two"), AK::HashSetResult::InsertedNewEntry);
+    EXPECT_EQ(number_to_string.set(3, "Three"), AK::HashSetResult::InsertedNewEntry);
+    EXPECT_EQ(number_to_string.set(2, "Deux"), AK::HashSetResult::ReplacedExistingEntry);
+
+    EXPECT_EQ(number_to_string.size(), 3u);
+    EXPECT_EQ(number_to_string.get(1).value(), "One");
+    EXPECT_EQ(number_to_string.get(2).value(), "Deux");
+    EXPECT(!number_to_string.get(4).has_value());
+}
+
+TEST_CASE(range_loop)
+{
+    FlatHashMap<int, int> squares;
+    for (int i = 0; i < 100; ++i)
+        squares.set(i, i * i);
+
+    int loop_counter = 0;
+    for (auto& it : squares) {
+        EXPECT_EQ(it.value, it.key * it.key);
+        ++loop_counter;
+    }
+    EXPECT_EQ(loop_counter, 100);
+}
+
+TEST_CASE(map_remove)
+{
+    FlatHashMap<int, String> number_to_string;
+    number_to_string.set(1, "One");
+    number_to_string.set(2, "Two");
+    number_to_string.set(3, "Three");
+
+    EXPECT_EQ(number_to_string.remove(1), true);
+    EXPECT_EQ(number_to_string.size(), 2u);
+    EXPECT(!number_to_string.contains(1));
+    EXPECT_EQ(number_to_string.remove(1), false);
+
+    auto it = number_to_string.find(3);
+    EXPECT(it != number_to_string.end());
+    number_to_string.remove(it);
+    EXPECT_EQ(number_to_string.size(), 1u);
+    EXPECT(number_to_string.contains(2));
+}
+
+TEST_CASE(ensure)
+{
+    FlatHashMap<String, int> counts;
+    ++counts.ensure("a");
+    ++counts.ensure("a");
+    ++counts.ensure("b");
+    EXPECT_EQ(counts.size(), 2u);
+    EXPECT_EQ(counts.get("a").value(), 2);
+    EXPECT_EQ(counts.get("b").value(), 1);
+}
+
+TEST_CASE(copy_and_move)
+{
+    FlatHashMap<int, OwnPtr<int>> owning;
+    for (int i = 0; i < 20; ++i)
+        owning.set(i, make<int>(i));
+
+    auto moved = move(owning);
+    EXPECT(owning.is_empty());
+    EXPECT_EQ(moved.size(), 20u);
+    EXPECT_EQ(*moved.get(7).value(), 7);
+
+    FlatHashMap<int, String> strings;
+    strings.set(1, "One");
+    auto copy = strings;
+    strings.set(1, "Uno");
+    EXPECT_EQ(copy.get(1).value(), "One");
+    EXPECT_EQ(strings.get(1).value(), "Uno");
+}
+
+TEST_CASE(many_insertions_and_removals)
+{
+    // Keep the table churning so that it fills up with tombstones, and check it against a HashMap.
+    FlatHashMap<u32, u32> flat_map;
+    HashMap<u32, u32> map;
+    u32 state = 1;
+    for (size_t i = 0; i < 100'000; ++i) {
+        state = state * 1103515245 + 12345;
+        auto key = (state >> 8) % 2000;
+        if (state & 1) {
+            EXPECT_EQ(flat_map.set(key, i), map.set(key, i));
+        } else {
+            EXPECT_EQ(flat_map.remove(key), map.remove(key));
+        }
+    }
+    EXPECT_EQ(flat_map.size(), map.size());
+    for (auto& it : map)
+        EXPECT_EQ(flat_map.get(it.key).value(), it.value);
+    size_t count = 0;
+    for (auto& it : flat_map) {
+        EXPECT_EQ(map.get(it.key).value(), it.value);
+        ++count;
+    }
+    EXPECT_EQ(count, map.size());
+    EXPECT(flat_map.capacity() <= 4096u);
+}
+
+TEST_CASE(clear)
+{
+    FlatHashMap<int, int> map;
+    for (int i = 0; i < 50; ++i)
+        map.set(i, i);
+    map.clear();
+    EXPECT(map.is_empty());
+    EXPECT(!map.contains(1));
+    map.set(1, 2);
+    EXPECT_EQ(map.get(1).value(), 2);
+}
+
+// Shaped like the kernel's TCP socket tables: a few hundred connections keyed by their address tuple.
+struct SocketTuple {
+    u32 local_address;
+    u16 local_port;
+    u32 peer_address;
+    u16 peer_port;
+
+    bool operator==(SocketTuple const& other) const
+    {
+        return local_address == other.local_address && local_port == other.local_port && peer_address == other.peer_address && peer_port == other.peer_port;
+    }
+};
+
+template<>
+struct AK::Traits<SocketTuple> : public GenericTraits<SocketTuple> {
+    static unsigned hash(SocketTuple const& tuple)
+    {
+        return pair_int_hash(pair_int_hash(tuple.local_address, tuple.local_port), pair_int_hash(tuple.peer_address, tuple.peer_port));
+    }
+};
+
+template<typename Map>
+static void socket_table_lookups()
+{
+    Map sockets;
+    for (u16 i = 0; i < 500; ++i)
+        sockets.set({ 0x0a000001, 80, 0x0a000100u + i, (u16)(40000 + i) }, i);
+    size_t found = 0;
+    for (size_t round = 0; round < 2000; ++round) {
+        for (u16 i = 0; i < 1000; ++i) {
+            if (sockets.contains({ 0x0a000001, 80, 0x0a000100u + i, (u16)(40000 + i) }))
+                ++found;
+        }
+    }
+    EXPECT_EQ(found, 2000u * 500u);
+}
+
+BENCHMARK_CASE(socket_table_lookups_hash_map)
+{
+    socket_table_lookups<HashMap<SocketTuple, u16>>();
+}
+
+BENCHMARK_CASE(socket_table_lookups_flat_hash_map)
+{
+    socket_table_lookups<FlatHashMap<SocketTuple, u16>>();
+}
+
+// Shaped like the property tables of LibJS shapes: lots of small tables, keyed by interned names.
+struct PropertyMetadata {
+    size_t offset { 0 };
+    u8 attributes { 0 };
+};
+
+template<typename Map>
+static void property_table_lookups()
+{
+    Vector<FlyString> names;
+    for (size_t i = 0; i < 32; ++i)
+        names.append(String::formatted("property{}", i));
+
+    size_t found = 0;
+    for (size_t round = 0; round < 20'000; ++round) {
+        Map table;
+        auto property_count = 4 + round % 28;
+        for (size_t i = 0; i < property_count; ++i)
+            table.set(names[i], { i, 0 });
+        for (size_t i = 0; i < 4; ++i) {
+            for (auto& name : names) {
+                if (table.contains(name))
+                    ++found;
+            }
+        }
+    }
+    EXPECT(found > 0u);
+}
+
+BENCHMARK_CASE(property_table_lookups_hash_map)
+{
+    property_table_lookups<HashMap<FlyString, PropertyMetadata>>();
+}
+
+BENCHMARK_CASE(property_table_lookups_flat_hash_map)
+{
+    property_table_lookups<FlatHashMap<FlyString, PropertyMetadata>>();
+}
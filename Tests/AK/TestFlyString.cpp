@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/FlyString.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <pthread.h>
+
+TEST_CASE(interns_equal_strings)
+{
+    FlyString from_view("foo"sv);
+    FlyString from_string(String("foo"));
+    FlyString other("bar"sv);
+    EXPECT_EQ(from_view.impl(), from_string.impl());
+    EXPECT_EQ(from_view, "foo");
+    EXPECT_NE(from_view.impl(), other.impl());
+    EXPECT(from_view.impl()->is_fly());
+}
+
+TEST_CASE(string_is_interned_in_place)
+{
+    String string = String::formatted("in-place-{}", 1);
+    FlyString fly(string);
+    EXPECT_EQ(fly.impl(), string.impl());
+    EXPECT(string.impl()->is_fly());
+    EXPECT_EQ(FlyString("in-place-1"sv).impl(), string.impl());
+}
+
+TEST_CASE(reinterns_after_last_reference_is_gone)
+{
+    {
+        FlyString fly(String::formatted("short-lived-{}", 1));
+        EXPECT_EQ(fly, "short-lived-1");
+    }
+    FlyString again("short-lived-1"sv);
+    EXPECT_EQ(again, "short-lived-1");
+    EXPECT_EQ(FlyString(String("short-lived-1")).impl(), again.impl());
+}
+
+TEST_CASE(null_and_empty)
+{
+    EXPECT(FlyString(String()).is_null());
+    EXPECT(FlyString(StringView()).is_null());
+    EXPECT(FlyString(""sv).is_empty());
+    EXPECT_EQ(FlyString(""sv).impl(), FlyString(String::empty()).impl());
+}
+
+static constexpr size_t stress_test_thread_count = 8;
+static constexpr size_t stress_test_string_count = 512;
+static constexpr size_t stress_test_iteration_count = 50'000;
+
+TEST_CASE(stress_interning_from_many_threads)
+{
+    // Every thread keeps creating and dropping FlyStrings for the same small set of strings, so they keep on
+    // racing each other to intern them, and to intern them again while the last reference is going away.
+    static Vector<String> s_strings;
+    for (size_t i = 0; i < stress_test_string_count; ++i)
+        s_strings.append(String::formatted("string-{}", i));
+    static Atomic<size_t> s_failures;
+
+    pthread_t threads[stress_test_thread_count];
+    for (size_t i = 0; i < stress_test_thread_count; ++i) {
+        pthread_create(
+            &threads[i], nullptr, [](void* argument) -> void* {
+                auto seed = (size_t)argument;
+                for (size_t i = 0; i < stress_test_iteration_count; ++i) {
+                    auto& string = s_strings[(i * 7 + seed * 13) % stress_test_string_count];
+                    FlyString fly(string.view());
+                    if (fly != string.view() || FlyString(string.view()).impl() != fly.impl())
+                        ++s_failures;
+                }
+                return nullptr;
+            },
+            (void*)i);
+    }
+    for (auto& thread : threads)
+        pthread_join(thread, nullptr);
+
+    EXPECT_EQ(s_failures.load(), 0u);
+}
@@ -323,3 +323,40 @@ TEST_CASE(vector_format)
         EXPECT_EQ(String::formatted("{}", v), "[ [ 1, 2 ], [ 3, 4 ] ]");
     }
 }
+
+TEST_CASE(precompiled_format_strings_match_runtime_parsing)
+{
+    auto format_at_runtime = [](StringView fmtstr, auto const&... parameters) {
+        StringBuilder builder;
+        AK::vformat(builder, fmtstr, AK::VariadicFormatParams { parameters... });
+        return builder.to_string();
+    };
+
+    EXPECT_EQ(String::formatted("{{}}{}{{", 1), "{}1{");
+    EXPECT_EQ(String::formatted("{{}}{}{{", 1), format_at_runtime("{{}}{}{{", 1));
+    EXPECT_EQ(String::formatted("{} {} {} {} {}", 'a', true, (u8)200, (i8)-5, "x"), "a true 200 -5 x");
+    EXPECT_EQ(String::formatted("{} {}", NumericLimits<i64>::min(), NumericLimits<u64>::max()), "-9223372036854775808 18446744073709551615");
+    EXPECT_EQ(String::formatted("{1}{0}", 1, 2), "21");
+    EXPECT_EQ(String::formatted("{0}{0}", 7), "77");
+    EXPECT_EQ(String::formatted("{:{}}|{}", 1, 3, 4), "  1|4");
+    EXPECT_EQ(String::formatted("{:x}-{:>3}-{}", 255, "a", 0), "ff-  a-0");
+    EXPECT_EQ(String::formatted("no fields"), "no fields");
+    EXPECT_EQ(String::formatted(""), "");
+}
+
+BENCHMARK_CASE(format_integers_with_precompiled_format_string)
+{
+    for (size_t i = 0; i < 1'000'000; ++i) {
+        auto string = String::formatted("pid={} tid={} name={}", i, i + 1, "Process"sv);
+        EXPECT(!string.is_empty());
+    }
+}
+
+BENCHMARK_CASE(format_integers_with_runtime_format_string)
+{
+    StringView fmtstr = "pid={} tid={} name={}";
+    for (size_t i = 0; i < 1'000'000; ++i) {
+        auto string = String::formatted(fmtstr, i, i + 1, "Process"sv);
+        EXPECT(!string.is_empty());
+    }
+}
@@ -173,3 +173,36 @@ TEST_CASE(basic_contains)
     EXPECT_EQ(map.remove(1), true);
     EXPECT_EQ(map.contains(1), false);
 }
+
+BENCHMARK_CASE(hash_map_int_keys)
+{
+    HashMap<u32, u32> map;
+    size_t found = 0;
+    for (u32 round = 0; round < 10; ++round) {
+        for (u32 i = 0; i < 100'000; ++i)
+            map.set(i * 2654435761u, i);
+        for (u32 i = 0; i < 200'000; ++i)
+            found += map.contains(i * 2654435761u);
+        for (u32 i = 0; i < 100'000; i += 2)
+            map.remove(i * 2654435761u);
+    }
+    EXPECT_EQ(found, 10 * 100'000u);
+    EXPECT_EQ(map.size(), 50'000u);
+}
+
+BENCHMARK_CASE(hash_map_string_keys)
+{
+    Vector<String> keys;
+    for (size_t i = 0; i < 20'000; ++i)
+        keys.append(String::formatted("key-{}", i));
+
+    size_t found = 0;
+    for (size_t round = 0; round < 10; ++round) {
+        HashMap<String, size_t> map;
+        for (size_t i = 0; i < keys.size(); ++i)
+            map.set(keys[i], i);
+        for (auto& key : keys)
+            found += map.get(key).has_value();
+    }
+    EXPECT_EQ(found, 10 * keys.size());
+}
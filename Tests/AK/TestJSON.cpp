@@ -114,3 +114,17 @@ TEST_CASE(json_u64_roundtrip)
     EXPECT_EQ_FORCE(value.has_value(), true);
     EXPECT_EQ(value->as_u64(), big_value);
 }
+
+TEST_CASE(json_repeated_and_escaped_keys)
+{
+    auto value = JsonValue::from_string("[{\"name\":\"a\",\"n\\u0061me\":\"b\"},{\"name\":\"c\",\"nope\":\"d\\\"\"},{\"name\":\"e\",\"\":1}]");
+    EXPECT_EQ_FORCE(value.has_value(), true);
+    auto& array = value->as_array();
+    EXPECT_EQ(array.size(), 3u);
+    EXPECT_EQ(array.at(0).as_object().size(), 1u);
+    EXPECT_EQ(array.at(0).as_object().get("name").as_string(), "b");
+    EXPECT_EQ(array.at(1).as_object().get("name").as_string(), "c");
+    EXPECT_EQ(array.at(1).as_object().get("nope").as_string(), "d\"");
+    EXPECT_EQ(array.at(2).as_object().get("name").as_string(), "e");
+    EXPECT_EQ(array.at(2).as_object().get("").to_i32(), 1);
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/JsonPullParser.h>
+#include <AK/JsonValue.h>
+#include <AK/StringBuilder.h>
+
+using TokenType = JsonPullParser::TokenType;
+
+static Vector<TokenType> token_types(StringView const& input)
+{
+    JsonPullParser parser(input);
+    Vector<TokenType> types;
+    for (;;) {
+        auto token = parser.next();
+        types.append(token.type());
+        if (token.is(TokenType::End) || token.is_error())
+            return types;
+    }
+}
+
+TEST_CASE(tokens)
+{
+    auto types = token_types(R"({ "a": [1, -2.5, "three", true, false, null], "b": {}, "c": [] })");
+    Vector<TokenType> expected {
+        TokenType::ObjectStart,
+        TokenType::Key, TokenType::ArrayStart, TokenType::Number, TokenType::Number, TokenType::String, TokenType::True, TokenType::False, TokenType::Null, TokenType::ArrayEnd,
+        TokenType::Key, TokenType::ObjectStart, TokenType::ObjectEnd,
+        TokenType::Key, TokenType::ArrayStart, TokenType::ArrayEnd,
+        TokenType::ObjectEnd,
+        TokenType::End
+    };
+    EXPECT_EQ(types, expected);
+
+    EXPECT_EQ(token_types("42"), (Vector<TokenType> { TokenType::Number, TokenType::End }));
+    EXPECT_EQ(token_types(" \"x\" "), (Vector<TokenType> { TokenType::String, TokenType::End }));
+}
+
+TEST_CASE(strings_and_numbers_are_views_into_the_input)
+{
+    StringView input = R"({"name": "WindowServer", "pid": 12, "size": 18446744073709551615, "offset": -3})";
+    JsonPullParser parser(input);
+    EXPECT(parser.next().is(TokenType::ObjectStart));
+
+    auto key = parser.next();
+    EXPECT(key.is(TokenType::Key));
+    EXPECT(key.string_equals("name"));
+    auto name = parser.next();
+    EXPECT_EQ(name.raw_string(), "WindowServer");
+    EXPECT_EQ(name.raw_string().characters_without_null_termination(), input.characters_without_null_termination() + 10);
+    EXPECT(!name.has_escapes());
+
+    EXPECT(parser.next().string_equals("pid"));
+    EXPECT_EQ(parser.next().to_number<u32>(), 12u);
+    EXPECT(parser.next().string_equals("size"));
+    EXPECT_EQ(parser.next().to_number<u64>(), NumericLimits<u64>::max());
+    EXPECT(parser.next().string_equals("offset"));
+    auto offset = parser.next();
+    EXPECT_EQ(offset.to_number<i32>(), -3);
+    EXPECT(!offset.to_number<u32>().has_value());
+    EXPECT(parser.next().is(TokenType::ObjectEnd));
+    EXPECT(parser.next().is(TokenType::End));
+    EXPECT(parser.next().is(TokenType::End));
+}
+
+TEST_CASE(escapes)
+{
+    JsonPullParser parser(R"(["a\"b\\cé", "tab\there"])");
+    EXPECT(parser.next().is(TokenType::ArrayStart));
+    auto first = parser.next();
+    EXPECT(first.has_escapes());
+    EXPECT_EQ(first.raw_string(), R"(a\"b\\cé)");
+    EXPECT_EQ(first.to_string(), "a\"b\\c\xc3\xa9");
+    EXPECT(first.string_equals("a\"b\\c\xc3\xa9"));
+    EXPECT_EQ(parser.next().to_string(), "tab\there");
+    EXPECT(parser.next().is(TokenType::ArrayEnd));
+}
+
+TEST_CASE(skip_value)
+{
+    JsonPullParser parser(R"({"skipped": {"a": [1, {"b": []}], "c": "}"}, "kept": true})");
+    EXPECT(parser.next().is(TokenType::ObjectStart));
+    EXPECT(parser.next().string_equals("skipped"));
+    EXPECT(parser.skip_next_value());
+    EXPECT_EQ(parser.depth(), 1u);
+    EXPECT(parser.next().string_equals("kept"));
+    EXPECT(parser.next().to_bool());
+    EXPECT(parser.next().is(TokenType::ObjectEnd));
+    EXPECT(parser.next().is(TokenType::End));
+}
+
+TEST_CASE(errors)
+{
+    auto fails = [](StringView const& input) {
+        auto types = token_types(input);
+        return types.last() == TokenType::Error;
+    };
+    EXPECT(fails(""));
+    EXPECT(fails("{"));
+    EXPECT(fails("[1,]"));
+    EXPECT(fails("[1 2]"));
+    EXPECT(fails("{\"a\" 1}"));
+    EXPECT(fails("{\"a\": 1,}"));
+    EXPECT(fails("{1: 2}"));
+    EXPECT(fails("[1}"));
+    EXPECT(fails("\"unterminated"));
+    EXPECT(fails("\"control\ncharacter\""));
+    EXPECT(fails("tru"));
+    EXPECT(fails("[] []"));
+    EXPECT(fails("-"));
+    EXPECT(!fails("[[[[]]]]"));
+}
+
+static String build_process_list(size_t process_count)
+{
+    StringBuilder builder;
+    builder.append("{\"processes\":[");
+    for (size_t i = 0; i < process_count; ++i) {
+        if (i)
+            builder.append(',');
+        builder.appendff("{{\"pid\":{},\"pgid\":0,\"uid\":100,\"name\":\"Process {}\",\"executable\":\"/bin/Process\",\"tty\":\"notty\",\"amount_virtual\":1234567,\"kernel\":false,\"threads\":[", i, i);
+        for (size_t j = 0; j < 4; ++j) {
+            if (j)
+                builder.append(',');
+            builder.appendff("{{\"tid\":{},\"name\":\"Thread\",\"state\":\"Running\",\"time_user\":123456789,\"time_kernel\":98765,\"cpu\":0}}", i * 4 + j);
+        }
+        builder.append("]}");
+    }
+    builder.append("],\"total_time\":1234567890,\"total_time_kernel\":123456}");
+    return builder.to_string();
+}
+
+BENCHMARK_CASE(pull_parser)
+{
+    auto input = build_process_list(500);
+    for (size_t i = 0; i < 100; ++i) {
+        size_t thread_count = 0;
+        JsonPullParser parser(input);
+        for (;;) {
+            auto token = parser.next();
+            if (token.is(TokenType::Key) && token.string_equals("tid"))
+                ++thread_count;
+            if (token.is(TokenType::End) || token.is_error())
+                break;
+        }
+        EXPECT_EQ(thread_count, 2000u);
+    }
+}
+
+BENCHMARK_CASE(json_value)
+{
+    auto input = build_process_list(500);
+    for (size_t i = 0; i < 100; ++i) {
+        auto json = JsonValue::from_string(input);
+        EXPECT(json.has_value());
+    }
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Atomic.h>
+#include <AK/MPMCQueue.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <pthread.h>
+#include <sched.h>
+
+TEST_CASE(basic)
+{
+    MPMCQueue<int, 4> ints;
+    EXPECT(ints.is_empty());
+    EXPECT_EQ(ints.capacity(), 4u);
+    for (int i = 1; i <= 4; ++i)
+        EXPECT(ints.try_enqueue(i));
+    EXPECT_EQ(ints.size(), 4u);
+    EXPECT(!ints.try_enqueue(5));
+    EXPECT_EQ(ints.try_dequeue().value(), 1);
+    EXPECT(ints.try_enqueue(5));
+    for (int i = 2; i <= 5; ++i)
+        EXPECT_EQ(ints.try_dequeue().value(), i);
+    EXPECT(!ints.try_dequeue().has_value());
+    EXPECT(ints.is_empty());
+}
+
+TEST_CASE(complex_type)
+{
+    MPMCQueue<String, 2> strings;
+    EXPECT(strings.try_enqueue("foo"));
+    EXPECT(strings.try_enqueue(String("bar")));
+    EXPECT(!strings.try_enqueue("baz"));
+    EXPECT_EQ(strings.try_dequeue().value(), "foo");
+    EXPECT_EQ(strings.try_dequeue().value(), "bar");
+    EXPECT(!strings.try_dequeue().has_value());
+}
+
+TEST_CASE(wraps_around_many_times)
+{
+    MPMCQueue<size_t, 2> queue;
+    for (size_t i = 0; i < 1000; ++i) {
+        EXPECT(queue.try_enqueue(i));
+        EXPECT_EQ(queue.try_dequeue().value(), i);
+    }
+    EXPECT(queue.is_empty());
+}
+
+static constexpr size_t thread_count = 4;
+static constexpr size_t elements_per_producer = 250'000;
+
+static MPMCQueue<size_t, 128> s_queue;
+static Atomic<size_t> s_consumed_count;
+static Atomic<size_t> s_consumed_sum;
+// Which element every consumer saw last from every producer, to check that each producer's elements stay in order.
+static size_t s_last_seen[thread_count][thread_count];
+static bool s_out_of_order;
+
+static void* produce(void* argument)
+{
+    auto producer = (size_t)argument;
+    for (size_t i = 0; i < elements_per_producer; ++i) {
+        while (!s_queue.try_enqueue(producer * elements_per_producer + i))
+            sched_yield();
+    }
+    return nullptr;
+}
+
+static void* consume(void* argument)
+{
+    auto consumer = (size_t)argument;
+    for (size_t i = 0; i < thread_count; ++i)
+        s_last_seen[consumer][i] = NumericLimits<size_t>::max();
+    while (s_consumed_count.load() < thread_count * elements_per_producer) {
+        auto value = s_queue.try_dequeue();
+        if (!value.has_value()) {
+            sched_yield();
+            continue;
+        }
+        auto producer = value.value() / elements_per_producer;
+        auto& last_seen = s_last_seen[consumer][producer];
+        if (last_seen != NumericLimits<size_t>::max() && last_seen >= value.value())
+            s_out_of_order = true;
+        last_seen = value.value();
+        s_consumed_sum.fetch_add(value.value());
+        s_consumed_count.fetch_add(1);
+    }
+    return nullptr;
+}
+
+TEST_CASE(stress_many_producers_and_consumers)
+{
+    Vector<pthread_t> threads;
+    for (size_t i = 0; i < thread_count; ++i) {
+        pthread_t producer;
+        pthread_t consumer;
+        pthread_create(&producer, nullptr, produce, (void*)i);
+        pthread_create(&consumer, nullptr, consume, (void*)i);
+        threads.append(producer);
+        threads.append(consumer);
+    }
+    for (auto thread : threads)
+        pthread_join(thread, nullptr);
+
+    // Every element has to arrive exactly once.
+    size_t element_count = thread_count * elements_per_producer;
+    EXPECT_EQ(s_consumed_count.load(), element_count);
+    EXPECT_EQ(s_consumed_sum.load(), element_count * (element_count - 1) / 2);
+    EXPECT(!s_out_of_order);
+    EXPECT(s_queue.is_empty());
+}
@@ -86,3 +86,54 @@ TEST_CASE(clear)
     test.clear();
     EXPECT_EQ(test.size(), 0u);
 }
+
+struct MaxAugmentation {
+    using Type = int;
+    static int value(int const& value) { return value; }
+    static int combine(int a, int b) { return max(a, b); }
+};
+
+TEST_CASE(find_smallest_matching_augmentation)
+{
+    constexpr auto amount = 1000;
+    constexpr auto max_value = 1000;
+    RedBlackTree<int, int, MaxAugmentation> test;
+    Array<int, amount> keys {};
+
+    for (int i = 0; i < amount; i++) {
+        keys[i] = i;
+    }
+    for (size_t i = 0; i < amount; i++) {
+        swap(keys[i], keys[get_random<size_t>() % amount]);
+    }
+
+    for (size_t i = 0; i < amount; i++) {
+        test.insert(keys[i], get_random<u32>() % max_value);
+    }
+
+    // the result must match what a linear first-fit scan finds
+    auto verify_against_linear_scan = [&] {
+        for (int threshold = 0; threshold <= max_value; threshold += 10) {
+            int* expected = nullptr;
+            for (auto& value : test) {
+                if (value >= threshold) {
+                    expected = &value;
+                    break;
+                }
+            }
+            auto* found = test.find_smallest_matching_augmentation([&](int largest_value) { return largest_value >= threshold; });
+            EXPECT_EQ(found, expected);
+        }
+    };
+    verify_against_linear_scan();
+
+    // removals, and values that change in place, must keep the augmentation up to date
+    for (size_t i = 0; i < amount / 2; i++) {
+        EXPECT(test.remove(keys[i]));
+    }
+    for (size_t i = amount / 2; i < amount; i += 7) {
+        *test.find(keys[i]) = get_random<u32>() % max_value;
+        test.update_augmentation(keys[i]);
+    }
+    verify_against_linear_scan();
+}
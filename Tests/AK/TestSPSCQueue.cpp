@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/NonnullOwnPtr.h>
+#include <AK/SPSCQueue.h>
+#include <AK/String.h>
+#include <pthread.h>
+
+TEST_CASE(basic)
+{
+    SPSCQueue<int, 4> ints;
+    EXPECT(ints.is_empty());
+    EXPECT_EQ(ints.capacity(), 4u);
+    EXPECT(ints.try_enqueue(1));
+    EXPECT(ints.try_enqueue(2));
+    EXPECT(ints.try_enqueue(3));
+    EXPECT(ints.try_enqueue(4));
+    EXPECT_EQ(ints.size(), 4u);
+    EXPECT(!ints.try_enqueue(5));
+    EXPECT_EQ(ints.try_dequeue().value(), 1);
+    EXPECT(ints.try_enqueue(5));
+    EXPECT_EQ(ints.try_dequeue().value(), 2);
+    EXPECT_EQ(ints.try_dequeue().value(), 3);
+    EXPECT_EQ(ints.try_dequeue().value(), 4);
+    EXPECT_EQ(ints.try_dequeue().value(), 5);
+    EXPECT(!ints.try_dequeue().has_value());
+    EXPECT(ints.is_empty());
+}
+
+TEST_CASE(complex_type)
+{
+    SPSCQueue<String, 2> strings;
+    EXPECT(strings.try_enqueue("foo"));
+    EXPECT(strings.try_enqueue(String("bar")));
+    EXPECT(!strings.try_enqueue("baz"));
+    EXPECT_EQ(strings.try_dequeue().value(), "foo");
+    EXPECT_EQ(strings.try_dequeue().value(), "bar");
+}
+
+TEST_CASE(destroys_remaining_elements)
+{
+    static size_t s_destroyed;
+    struct Tracked {
+        ~Tracked() { ++s_destroyed; }
+    };
+    {
+        SPSCQueue<NonnullOwnPtr<Tracked>, 8> queue;
+        for (size_t i = 0; i < 5; ++i)
+            EXPECT(queue.try_enqueue(make<Tracked>()));
+        EXPECT(queue.try_dequeue().has_value());
+        EXPECT_EQ(s_destroyed, 1u);
+    }
+    EXPECT_EQ(s_destroyed, 5u);
+}
+
+static constexpr size_t stress_test_element_count = 1'000'000;
+
+TEST_CASE(stress_one_producer_and_one_consumer)
+{
+    static SPSCQueue<size_t, 64> s_queue;
+    pthread_t producer;
+    pthread_create(
+        &producer, nullptr, [](void*) -> void* {
+            for (size_t i = 0; i < stress_test_element_count; ++i) {
+                while (!s_queue.try_enqueue(i))
+                    sched_yield();
+            }
+            return nullptr;
+        },
+        nullptr);
+
+    // Every element has to arrive exactly once, and in order.
+    for (size_t expected = 0; expected < stress_test_element_count;) {
+        auto value = s_queue.try_dequeue();
+        if (!value.has_value()) {
+            sched_yield();
+            continue;
+        }
+        EXPECT_EQ(value.value(), expected);
+        if (value.value() != expected)
+            break;
+        ++expected;
+    }
+
+    pthread_join(producer, nullptr);
+    EXPECT(s_queue.is_empty());
+}
@@ -303,3 +303,32 @@ TEST_CASE(roman_numerals)
     auto four_thousand = String::roman_number_from(4000);
     EXPECT_EQ(four_thousand, "4000");
 }
+
+TEST_CASE(single_character_strings_are_shared)
+{
+    String a = "x";
+    String b = String::formatted("{}", 'x');
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a.impl(), b.impl());
+    EXPECT_EQ(String("y").length(), 1u);
+    EXPECT_EQ(String("\0", 1).length(), 1u);
+}
+
+BENCHMARK_CASE(string_build_split_and_compare)
+{
+    size_t matches = 0;
+    for (size_t round = 0; round < 20; ++round) {
+        StringBuilder builder;
+        for (size_t i = 0; i < 10'000; ++i)
+            builder.appendff("{}:{},", i, i * 3);
+        auto string = builder.to_string();
+
+        auto parts = string.split(',');
+        for (size_t i = 0; i < parts.size(); ++i) {
+            if (parts[i] == String::formatted("{}:{}", i, i * 3))
+                matches++;
+        }
+        matches += string.contains("9999:29997"sv);
+    }
+    EXPECT_EQ(matches, 20 * 10'001u);
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Array.h>
+#include <LibAudio/Loader.h>
+
+// A 16-bit stereo stream at 44.1 kHz with four frames of 16 samples each, which uses every kind of subframe:
+// - frame 0: verbatim left, constant right
+// - frame 1: fixed order 2 left, fixed order 1 right with 3 wasted bits
+// - frame 2: LPC order 2 left, verbatim right with 4 wasted bits
+// - frame 3: fixed order 0 left with 1 wasted bit, LPC order 1 right with 3 wasted bits
+// Several warm-up samples, constants and verbatim samples are negative.
+static constexpr Array<u8, 257> flac_stream {
+        0x66, 0x4c, 0x61, 0x43, 0x80, 0x00, 0x00, 0x22, 0x00, 0x10, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x0a, 0xc4, 0x42, 0xf0, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xf8, 0x69, 0x18, 0x00, 0x0f,
+        0x92, 0x02, 0xec, 0x78, 0xf3, 0xb2, 0xfa, 0xec, 0x02, 0x26, 0x09, 0x60, 0x10, 0x9a, 0xf0, 0xc4,
+        0xf7, 0xfe, 0xff, 0x38, 0x06, 0x72, 0x0d, 0xac, 0xed, 0xd6, 0xf5, 0x10, 0xfc, 0x4a, 0x03, 0x84,
+        0x0a, 0xbe, 0x00, 0xfb, 0x2e, 0x89, 0x78, 0xff, 0xf8, 0x69, 0x18, 0x01, 0x0f, 0x87, 0x14, 0x11,
+        0xf8, 0xf2, 0x22, 0x03, 0x03, 0xc4, 0x10, 0x00, 0x80, 0x04, 0x00, 0x03, 0xc3, 0xe1, 0xe2, 0x08,
+        0x00, 0x40, 0x02, 0x00, 0x10, 0x00, 0x0f, 0x0f, 0x87, 0x88, 0x20, 0x01, 0x00, 0x01, 0x33, 0xff,
+        0x80, 0x00, 0x92, 0x49, 0x24, 0x92, 0x49, 0x20, 0x78, 0xe0, 0xff, 0xf8, 0x69, 0x18, 0x02, 0x0f,
+        0xb8, 0x42, 0x10, 0x68, 0xf0, 0x92, 0x30, 0x9f, 0x81, 0x87, 0x92, 0xae, 0x75, 0x73, 0xab, 0x9d,
+        0x05, 0xb9, 0x4f, 0x25, 0x5c, 0xea, 0xe7, 0x57, 0x3a, 0xb9, 0xd0, 0x5b, 0x94, 0xf2, 0x55, 0xce,
+        0xae, 0x74, 0x06, 0x3f, 0xf1, 0xff, 0x3f, 0xf5, 0xff, 0x7f, 0xf9, 0xff, 0xbf, 0xfd, 0xff, 0xe0,
+        0x00, 0x00, 0x20, 0x04, 0x00, 0x60, 0x08, 0x00, 0xa0, 0x0c, 0x00, 0xe0, 0xdb, 0xc3, 0xff, 0xf8,
+        0x69, 0x18, 0x03, 0x0f, 0xad, 0x11, 0x81, 0x6e, 0xd8, 0x23, 0xf5, 0x38, 0x75, 0x13, 0x96, 0x0b,
+        0xea, 0x2c, 0x91, 0x96, 0x3a, 0xef, 0x38, 0x48, 0xfc, 0x20, 0xd9, 0xf3, 0xe8, 0x65, 0x92, 0xbe,
+        0x0e, 0x41, 0x3f, 0xe8, 0x10, 0x20, 0x13, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x00, 0x55,
+        0xb4,
+};
+
+static constexpr int sample_count = 64;
+
+static i32 expected_left(int index) { return (index * 37 % 200 - 100) * 50; }
+static i32 expected_right(int index) { return index < 16 ? -1234 : (index % 16 - 8) * 8 * (index / 16); }
+
+// The loader reads straight from the buffer, so it has to outlive the loader.
+static ByteBuffer const& flac_buffer()
+{
+    static auto buffer = ByteBuffer::copy(flac_stream.span());
+    return buffer;
+}
+
+static NonnullRefPtr<Audio::Loader> create_loader()
+{
+    auto loader = Audio::Loader::create(flac_buffer());
+    VERIFY(!loader->has_error());
+    return loader;
+}
+
+// Checks that the next samples the loader hands out are the ones starting at first_index.
+static void expect_samples_from(Audio::Loader& loader, int first_index, int count)
+{
+    auto buffer = loader.get_more_samples(count);
+    EXPECT(buffer);
+    if (!buffer)
+        return;
+    EXPECT_EQ(buffer->sample_count(), count);
+    for (int i = 0; i < buffer->sample_count(); ++i) {
+        EXPECT_EQ(static_cast<i32>(buffer->samples()[i].left * 65536), expected_left(first_index + i));
+        EXPECT_EQ(static_cast<i32>(buffer->samples()[i].right * 65536), expected_right(first_index + i));
+    }
+}
+
+TEST_CASE(decode_every_subframe_type)
+{
+    auto loader = create_loader();
+    EXPECT_EQ(loader->total_samples(), sample_count);
+    EXPECT_EQ(loader->num_channels(), 2);
+
+    // 24 samples at a time, so that reads start and end in the middle of frames.
+    expect_samples_from(loader, 0, 24);
+    expect_samples_from(loader, 24, 24);
+    expect_samples_from(loader, 48, 16);
+    EXPECT_EQ(loader->loaded_samples(), sample_count);
+    EXPECT(!loader->get_more_samples(24));
+}
+
+TEST_CASE(seek_by_sample_index)
+{
+    auto loader = create_loader();
+
+    // Forward into a frame that hasn't been decoded yet.
+    loader->seek(40);
+    EXPECT_EQ(loader->loaded_samples(), 40);
+    expect_samples_from(loader, 40, 10);
+
+    // Back into a frame that has been decoded before, and across the frame boundary from there.
+    loader->seek(5);
+    EXPECT_EQ(loader->loaded_samples(), 5);
+    expect_samples_from(loader, 5, 20);
+
+    // Forward within the current frame.
+    loader->seek(30);
+    expect_samples_from(loader, 30, 2);
+
+    loader->seek(sample_count - 1);
+    expect_samples_from(loader, sample_count - 1, 1);
+}
+
+TEST_CASE(reset_rewinds_to_the_start)
+{
+    auto loader = create_loader();
+    expect_samples_from(loader, 0, 40);
+    loader->reset();
+    EXPECT_EQ(loader->loaded_samples(), 0);
+    expect_samples_from(loader, 0, 24);
+}
@@ -16,3 +16,173 @@ TEST_CASE(strerror_r_basic)
     EXPECT_EQ(strerror_r(EFAULT, buf, sizeof(buf)), 0);
     EXPECT_EQ(strcmp(buf, "Bad address"), 0);
 }
+
+static constexpr size_t test_buffer_size = 2048 + 64;
+
+static void fill_with_pattern(u8* buffer, size_t size, u8 seed)
+{
+    for (size_t i = 0; i < size; ++i)
+        buffer[i] = (u8)(i * 7 + seed);
+}
+
+TEST_CASE(memcpy_and_memset_at_every_size_and_alignment)
+{
+    static u8 source[test_buffer_size];
+    static u8 destination[test_buffer_size];
+    fill_with_pattern(source, test_buffer_size, 1);
+    for (size_t size = 0; size <= 2048; size = size < 300 ? size + 1 : size * 2 + 1) {
+        for (size_t dest_offset = 0; dest_offset < 16; dest_offset += 3) {
+            for (size_t src_offset = 0; src_offset < 16; src_offset += 5) {
+                memset(destination, 0xaa, test_buffer_size);
+                EXPECT_EQ(memcpy(destination + dest_offset, source + src_offset, size), destination + dest_offset);
+                for (size_t i = 0; i < test_buffer_size; ++i) {
+                    bool is_copied = i >= dest_offset && i < dest_offset + size;
+                    EXPECT_EQ(destination[i], is_copied ? source[i - dest_offset + src_offset] : 0xaa);
+                }
+            }
+            memset(destination, 0xaa, test_buffer_size);
+            EXPECT_EQ(memset(destination + dest_offset, 0x55, size), destination + dest_offset);
+            for (size_t i = 0; i < test_buffer_size; ++i) {
+                bool is_set = i >= dest_offset && i < dest_offset + size;
+                EXPECT_EQ(destination[i], is_set ? 0x55 : 0xaa);
+            }
+        }
+    }
+}
+
+TEST_CASE(memmove_overlapping)
+{
+    static u8 buffer[test_buffer_size + 64];
+    static u8 expected[test_buffer_size + 64];
+    for (size_t size = 0; size <= 2048; size = size < 300 ? size + 1 : size * 2 + 1) {
+        for (int distance : { -33, -16, -9, -1, 0, 1, 7, 8, 17, 32 }) {
+            size_t src_offset = 40;
+            size_t dest_offset = src_offset + distance;
+            fill_with_pattern(buffer, sizeof(buffer), (u8)size);
+            fill_with_pattern(expected, sizeof(expected), (u8)size);
+            for (size_t i = 0; i < size; ++i)
+                expected[dest_offset + i] = (u8)((src_offset + i) * 7 + (u8)size);
+            EXPECT_EQ(memmove(buffer + dest_offset, buffer + src_offset, size), buffer + dest_offset);
+            EXPECT_EQ(__builtin_memcmp(buffer, expected, sizeof(buffer)), 0);
+        }
+    }
+}
+
+static int sign(int value)
+{
+    return (value > 0) - (value < 0);
+}
+
+TEST_CASE(memcmp_finds_first_difference)
+{
+    static u8 a[test_buffer_size];
+    static u8 b[test_buffer_size];
+    fill_with_pattern(a, test_buffer_size, 3);
+    fill_with_pattern(b, test_buffer_size, 3);
+    EXPECT_EQ(memcmp(a, b, test_buffer_size), 0);
+    for (size_t i = 0; i < 300; ++i) {
+        b[i] = a[i] + 1;
+        EXPECT_EQ(memcmp(a, b, i), 0);
+        int expected = a[i] < b[i] ? -1 : 1;
+        EXPECT_EQ(sign(memcmp(a, b, test_buffer_size)), expected);
+        EXPECT_EQ(sign(memcmp(b, a, test_buffer_size)), -expected);
+        // Only the first difference counts.
+        b[i + 1] = a[i + 1] + (expected < 0 ? -1 : 1);
+        EXPECT_EQ(sign(memcmp(a, b, test_buffer_size)), expected);
+        b[i] = a[i];
+        b[i + 1] = a[i + 1];
+    }
+}
+
+TEST_CASE(strlen_and_strchr_at_every_alignment)
+{
+    static char string[300];
+    for (size_t start = 0; start < 16; ++start) {
+        for (size_t length = 0; length + start < sizeof(string) - 1; ++length) {
+            for (size_t i = 0; i < length; ++i)
+                string[start + i] = 'a' + i % 26;
+            string[start + length] = '\0';
+            auto* s = string + start;
+            EXPECT_EQ(strlen(s), length);
+            EXPECT_EQ(strchr(s, '\0'), s + length);
+            EXPECT_EQ(strchr(s, '#'), nullptr);
+            EXPECT_EQ(strchrnul(s, '#'), s + length);
+            if (length)
+                EXPECT_EQ(strchr(s, s[length - 1]), s + (length - 1) % 26);
+        }
+    }
+    char high_bytes[] = "abc\xe9"
+                        "def";
+    EXPECT_EQ(strchr(high_bytes, 0xe9), high_bytes + 3);
+    EXPECT_EQ(strchr(high_bytes, (char)0xe9), high_bytes + 3);
+}
+
+static constexpr size_t benchmark_bytes = 1 * GiB;
+static u8 benchmark_source[64 * KiB + 1];
+static u8 benchmark_destination[64 * KiB + 1];
+
+template<typename Callback>
+static void run_benchmark(Callback callback)
+{
+    size_t sizes[] = { 8, 64, 512, 4096, 64 * KiB };
+    for (auto size : sizes) {
+        for (size_t i = 0; i < benchmark_bytes / size; ++i)
+            callback(size);
+    }
+}
+
+BENCHMARK_CASE(memcpy)
+{
+    run_benchmark([](size_t size) {
+        memcpy(benchmark_destination + 1, benchmark_source, size);
+        asm volatile("" ::: "memory");
+    });
+}
+
+BENCHMARK_CASE(memmove)
+{
+    run_benchmark([](size_t size) {
+        memmove(benchmark_destination + 1, benchmark_destination, size);
+        asm volatile("" ::: "memory");
+    });
+}
+
+BENCHMARK_CASE(memset)
+{
+    run_benchmark([](size_t size) {
+        memset(benchmark_destination + 1, 0x55, size);
+        asm volatile("" ::: "memory");
+    });
+}
+
+BENCHMARK_CASE(memcmp)
+{
+    memset(benchmark_source, 'x', sizeof(benchmark_source));
+    memset(benchmark_destination, 'x', sizeof(benchmark_destination));
+    run_benchmark([](size_t size) {
+        auto result = memcmp(benchmark_destination, benchmark_source, size);
+        asm volatile("" ::"r"(result) : "memory");
+    });
+}
+
+BENCHMARK_CASE(strlen)
+{
+    memset(benchmark_source, 'x', sizeof(benchmark_source));
+    run_benchmark([](size_t size) {
+        benchmark_source[size - 1] = '\0';
+        auto result = strlen((const char*)benchmark_source);
+        asm volatile("" ::"r"(result) : "memory");
+        benchmark_source[size - 1] = 'x';
+    });
+}
+
+BENCHMARK_CASE(strchr)
+{
+    memset(benchmark_source, 'x', sizeof(benchmark_source));
+    run_benchmark([](size_t size) {
+        benchmark_source[size - 1] = '\0';
+        auto* result = strchr((const char*)benchmark_source, 'y');
+        asm volatile("" ::"r"(result) : "memory");
+        benchmark_source[size - 1] = 'x';
+    });
+}
@@ -8,6 +8,7 @@
 
 #include <AK/Array.h>
 #include <AK/MemoryStream.h>
+#include <AK/OwnPtr.h>
 #include <AK/Random.h>
 #include <LibCompress/Deflate.h>
 #include <cstring>
@@ -154,3 +155,130 @@ TEST_CASE(deflate_compress_literals)
     auto compressed = Compress::DeflateCompressor::compress_all(test, Compress::DeflateCompressor::CompressionLevel::GOOD);
     EXPECT(compressed.has_value());
 }
+
+// Text-like data with lots of short and overlapping back references, which is what deflate usually has to deal with.
+static ByteBuffer make_compressible_data(size_t size)
+{
+    auto data = ByteBuffer::create_uninitialized(size);
+    for (size_t i = 0; i < size; ++i) {
+        auto random = get_random<u32>();
+        if (i >= 64 && random % 4 != 0)
+            data[i] = data[i - 1 - (random >> 8) % 64];
+        else
+            data[i] = 'a' + random % 26;
+    }
+    return data;
+}
+
+static Optional<ByteBuffer> decompress_as_stream(ReadonlyBytes compressed)
+{
+    InputMemoryStream memory_stream { compressed };
+    Compress::DeflateDecompressor deflate_stream { memory_stream };
+    DuplexMemoryStream output_stream;
+
+    u8 buffer[4096];
+    while (!deflate_stream.has_any_error() && !deflate_stream.unreliable_eof()) {
+        auto nread = deflate_stream.read({ buffer, sizeof(buffer) });
+        output_stream.write_or_error({ buffer, nread });
+    }
+    if (deflate_stream.handle_any_error())
+        return {};
+    return output_stream.copy_into_contiguous_buffer();
+}
+
+TEST_CASE(deflate_decompress_all_matches_stream)
+{
+    auto original = make_compressible_data(256 * KiB);
+    auto compressed = Compress::DeflateCompressor::compress_all(original, Compress::DeflateCompressor::CompressionLevel::GOOD);
+    EXPECT(compressed.has_value());
+
+    auto uncompressed = Compress::DeflateDecompressor::decompress_all(compressed.value());
+    EXPECT(uncompressed.has_value());
+    EXPECT(uncompressed.value() == original);
+
+    auto streamed = decompress_as_stream(compressed.value());
+    EXPECT(streamed.has_value());
+    EXPECT(streamed.value() == original);
+}
+
+TEST_CASE(deflate_decompress_all_consecutive_uncompressed_blocks)
+{
+    auto original = ByteBuffer::create_uninitialized(3000);
+    for (size_t i = 0; i < original.size(); ++i)
+        original[i] = i * 7 % 251;
+
+    ByteBuffer compressed;
+    for (size_t offset = 0; offset < original.size(); offset += 1000) {
+        u8 header[5] = { offset + 1000 == original.size(), 0xe8, 0x03, 0x17, 0xfc };
+        compressed.append(header, sizeof(header));
+        compressed.append(original.bytes().slice(offset, 1000));
+    }
+
+    auto decompressed = Compress::DeflateDecompressor::decompress_all(compressed);
+    EXPECT(decompressed.has_value());
+    EXPECT(decompressed.value() == original);
+}
+
+TEST_CASE(deflate_decompress_all_truncated)
+{
+    auto original = make_compressible_data(16 * KiB);
+    auto compressed = Compress::DeflateCompressor::compress_all(original, Compress::DeflateCompressor::CompressionLevel::FAST);
+    EXPECT(compressed.has_value());
+
+    for (size_t size : { 0ul, 1ul, compressed->size() / 2, compressed->size() - 1 })
+        EXPECT(!Compress::DeflateDecompressor::decompress_all(compressed->bytes().trim(size)).has_value());
+}
+
+TEST_CASE(deflate_decompress_all_distance_too_far_back)
+{
+    // A fixed Huffman block whose first symbol is a back reference, with nothing to refer back to.
+    const Array<u8, 3> compressed { 0x03, 0x02, 0x00 };
+    EXPECT(!Compress::DeflateDecompressor::decompress_all(compressed).has_value());
+}
+
+BENCHMARK_CASE(deflate_decompress_all_large)
+{
+    auto original = make_compressible_data(4 * MiB);
+    auto compressed = Compress::DeflateCompressor::compress_all(original, Compress::DeflateCompressor::CompressionLevel::FAST);
+    EXPECT(compressed.has_value());
+
+    for (size_t i = 0; i < 10; ++i) {
+        auto uncompressed = Compress::DeflateDecompressor::decompress_all(compressed.value());
+        EXPECT(uncompressed.has_value());
+        EXPECT_EQ(uncompressed->size(), original.size());
+    }
+}
+
+TEST_CASE(deflate_sync_flush)
+{
+    // Two compressors' outputs joined by a sync flush decompress to the two inputs back to back.
+    auto first = make_compressible_data(10 * KiB);
+    auto second = make_compressible_data(20 * KiB);
+
+    DuplexMemoryStream output_stream;
+    {
+        auto compressor = make<Compress::DeflateCompressor>(output_stream);
+        EXPECT(compressor->write_or_error(first));
+        compressor->sync_flush();
+    }
+    {
+        auto compressor = make<Compress::DeflateCompressor>(output_stream);
+        EXPECT(compressor->write_or_error(second));
+        compressor->final_flush();
+    }
+
+    auto uncompressed = Compress::DeflateDecompressor::decompress_all(output_stream.copy_into_contiguous_buffer());
+    EXPECT(uncompressed.has_value());
+    EXPECT_EQ(uncompressed->size(), first.size() + second.size());
+    EXPECT(uncompressed->bytes().slice(0, first.size()) == first.bytes());
+    EXPECT(uncompressed->bytes().slice(first.size()) == second.bytes());
+}
+
+BENCHMARK_CASE(deflate_compress_large)
+{
+    auto original = make_compressible_data(4 * MiB);
+    for (auto level : { Compress::DeflateCompressor::CompressionLevel::FAST, Compress::DeflateCompressor::CompressionLevel::GOOD }) {
+        auto compressed = Compress::DeflateCompressor::compress_all(original, level);
+        EXPECT(compressed.has_value());
+    }
+}
@@ -95,3 +95,18 @@ TEST_CASE(gzip_round_trip)
     EXPECT(uncompressed.has_value());
     EXPECT(uncompressed.value() == original);
 }
+
+TEST_CASE(gzip_round_trip_chunks)
+{
+    // Large enough to be compressed as several chunks, the last of which is only partially filled.
+    auto size = Compress::GzipCompressor::parallel_chunk_size * 3 + 1000;
+    auto original = ByteBuffer::create_uninitialized(size);
+    for (size_t i = 0; i < size; ++i)
+        original[i] = i % 251 < 200 ? 'a' + i % 7 : get_random<u8>();
+    auto compressed = Compress::GzipCompressor::compress_all(original);
+    EXPECT(compressed.has_value());
+    EXPECT(compressed->size() < size / 2);
+    auto uncompressed = Compress::GzipDecompressor::decompress_all(compressed.value());
+    EXPECT(uncompressed.has_value());
+    EXPECT(uncompressed.value() == original);
+}
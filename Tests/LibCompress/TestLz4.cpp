@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Array.h>
+#include <AK/Random.h>
+#include <AK/StringView.h>
+#include <LibCompress/Lz4.h>
+
+// A frame made by the reference implementation, with linked blocks, block checksums and the content size.
+static constexpr Array<u8, 49> reference_frame {
+    0x04, 0x22, 0x4d, 0x18, 0x7c, 0x40, 0x28, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x4d, 0x12, 0x00, 0x00, 0x00, 0x3f, 0x61, 0x62, 0x63, 0x03,
+    0x00, 0x08, 0xa0, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39,
+    0x30, 0x69, 0x57, 0x65, 0xb4, 0x00, 0x00, 0x00, 0x00, 0x51, 0x61, 0xcf,
+    0x0a
+};
+
+static ByteBuffer make_compressible_data(size_t size)
+{
+    auto data = ByteBuffer::create_uninitialized(size);
+    for (size_t i = 0; i < size; ++i) {
+        auto random = get_random<u32>();
+        if (i >= 64 && random % 4 != 0)
+            data[i] = data[i - 1 - (random >> 8) % 64];
+        else
+            data[i] = 'a' + random % 26;
+    }
+    return data;
+}
+
+TEST_CASE(lz4_decompress_reference_frame)
+{
+    auto decompressed = Compress::Lz4Decompressor::decompress_all(reference_frame);
+    EXPECT(decompressed.has_value());
+    EXPECT_EQ(StringView { decompressed->bytes() }, "abcabcabcabcabcabcabcabcabcabc1234567890");
+}
+
+TEST_CASE(lz4_decompress_corrupt_frame)
+{
+    // The last byte is part of the content checksum, and the one before the end mark part of the block's checksum.
+    for (size_t index : { reference_frame.size() - 1, reference_frame.size() - 9, 20ul }) {
+        auto corrupt = reference_frame;
+        corrupt[index] ^= 1;
+        EXPECT(!Compress::Lz4Decompressor::decompress_all(corrupt).has_value());
+    }
+    EXPECT(!Compress::Lz4Decompressor::decompress_all(ReadonlyBytes { reference_frame }.trim(30)).has_value());
+}
+
+TEST_CASE(lz4_round_trip)
+{
+    for (size_t size : { 0ul, 1ul, 12ul, 13ul, 1000ul, 3 * Compress::Lz4Compressor::block_size + 17 }) {
+        auto original = make_compressible_data(size);
+        auto compressed = Compress::Lz4Compressor::compress_all(original);
+        EXPECT(compressed.has_value());
+        EXPECT(Compress::Lz4Decompressor::is_likely_compressed(compressed.value()));
+        auto decompressed = Compress::Lz4Decompressor::decompress_all(compressed.value());
+        EXPECT(decompressed.has_value());
+        EXPECT(decompressed.value() == original);
+    }
+}
+
+TEST_CASE(lz4_round_trip_incompressible)
+{
+    auto original = ByteBuffer::create_uninitialized(100000);
+    fill_with_random(original.data(), original.size());
+    auto compressed = Compress::Lz4Compressor::compress_all(original);
+    EXPECT(compressed.has_value());
+    auto decompressed = Compress::Lz4Decompressor::decompress_all(compressed.value());
+    EXPECT(decompressed.has_value());
+    EXPECT(decompressed.value() == original);
+}
+
+TEST_CASE(lz4_block_distance_too_far_back)
+{
+    // One literal, then a match 2 bytes back.
+    const Array<u8, 5> block { 0x10, 'a', 0x02, 0x00, 0x00 };
+    Array<u8, 64> output;
+    EXPECT(!Compress::Lz4::decompress_block(block, output).has_value());
+    EXPECT_EQ(Compress::Lz4::decompress_block(block, output, 1).value(), 5u);
+}
+
+BENCHMARK_CASE(lz4_round_trip_large)
+{
+    auto original = make_compressible_data(4 * MiB);
+    auto compressed = Compress::Lz4Compressor::compress_all(original);
+    EXPECT(compressed.has_value());
+    auto decompressed = Compress::Lz4Decompressor::decompress_all(compressed.value());
+    EXPECT(decompressed.has_value());
+    EXPECT(decompressed.value() == original);
+}
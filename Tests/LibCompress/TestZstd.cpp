@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Array.h>
+#include <AK/Random.h>
+#include <AK/StringView.h>
+#include <LibCompress/Zstd.h>
+
+// A frame made by the reference implementation, with Huffman coded literals (whose weights are FSE compressed), FSE coded
+// sequences, the content size and a checksum.
+static constexpr Array<u8, 160> reference_frame {
+    0x28, 0xb5, 0x2f, 0xfd, 0x64, 0x63, 0x00, 0x95, 0x04, 0x00, 0xd2, 0x8a,
+    0x1e, 0x17, 0x70, 0x6d, 0x1b, 0x44, 0x6d, 0x4f, 0x8d, 0xbe, 0x71, 0xd3,
+    0xa1, 0x8e, 0x36, 0x20, 0x43, 0x1c, 0x2a, 0xf2, 0x0c, 0x02, 0xa0, 0xea,
+    0xbc, 0x82, 0xb4, 0xb8, 0x4a, 0xdb, 0x09, 0xa4, 0x18, 0x96, 0x05, 0x32,
+    0x96, 0x46, 0x6f, 0x9f, 0x03, 0xc9, 0xb0, 0xf9, 0xd2, 0xf3, 0xb6, 0x5d,
+    0x4a, 0x9b, 0xd1, 0xf1, 0x92, 0xfa, 0xca, 0x46, 0x41, 0x75, 0xd6, 0xf7,
+    0x71, 0x81, 0x9f, 0x36, 0xee, 0x66, 0x77, 0xaa, 0x2f, 0x87, 0x6f, 0x19,
+    0x65, 0x0b, 0x94, 0xb6, 0xe9, 0x8d, 0xe7, 0xa7, 0x8b, 0x2e, 0x15, 0x4e,
+    0x47, 0x3b, 0x68, 0x98, 0x7b, 0xe6, 0xb4, 0x93, 0x2d, 0xf6, 0x01, 0x87,
+    0x69, 0xdd, 0xc7, 0x1a, 0xde, 0x3d, 0x65, 0xce, 0x7d, 0x9c, 0xa7, 0x9c,
+    0x39, 0x1b, 0xf3, 0x6b, 0x6f, 0xc6, 0xe5, 0x78, 0xd6, 0xaf, 0xc5, 0xe5,
+    0xb0, 0x39, 0x09, 0x06, 0x00, 0x5f, 0x10, 0xba, 0xd2, 0xc1, 0x58, 0x6c,
+    0x68, 0x08, 0x87, 0xa1, 0xb8, 0xa4, 0x3a, 0xfe, 0x70, 0x87, 0x32, 0x03,
+    0xd9, 0x95, 0xfa, 0x0f
+};
+
+static constexpr StringView reference_text = "Zstandard is a fast lossless compression algorithm, targeting real-time compression scenarios at zlib-level and better compression ratios. "
+                                             "Zstandard is a fast lossless compression algorithm, targeting real-time compression scenarios at zlib-level and better compression ratios. "
+                                             "It is backed by a very fast entropy stage, provided by Huff0 and FSE library.";
+
+static ByteBuffer make_compressible_data(size_t size)
+{
+    auto data = ByteBuffer::create_uninitialized(size);
+    for (size_t i = 0; i < size; ++i) {
+        auto random = get_random<u32>();
+        if (i >= 64 && random % 4 != 0)
+            data[i] = data[i - 1 - (random >> 8) % 64];
+        else
+            data[i] = 'a' + random % 26;
+    }
+    return data;
+}
+
+
+TEST_CASE(zstd_decompress_reference_frame)
+{
+    auto decompressed = Compress::ZstdDecompressor::decompress_all(reference_frame);
+    EXPECT(decompressed.has_value());
+    EXPECT_EQ(StringView { decompressed->bytes() }, reference_text);
+}
+
+TEST_CASE(zstd_decompress_concatenated_frames)
+{
+    Array<u8, 2 * reference_frame.size()> frames;
+    for (size_t i = 0; i < reference_frame.size(); ++i)
+        frames[i] = frames[reference_frame.size() + i] = reference_frame[i];
+    auto decompressed = Compress::ZstdDecompressor::decompress_all(frames);
+    EXPECT(decompressed.has_value());
+    EXPECT_EQ(decompressed->size(), 2 * reference_text.length());
+    EXPECT_EQ(StringView { decompressed->bytes().slice(reference_text.length()) }, reference_text);
+}
+
+TEST_CASE(zstd_decompress_corrupt_frame)
+{
+    // The last byte is part of the checksum, the others are in the literals and the sequences.
+    for (size_t index : { reference_frame.size() - 1, 20ul, reference_frame.size() - 10 }) {
+        auto corrupt = reference_frame;
+        corrupt[index] ^= 1;
+        EXPECT(!Compress::ZstdDecompressor::decompress_all(corrupt).has_value());
+    }
+    EXPECT(!Compress::ZstdDecompressor::decompress_all(ReadonlyBytes { reference_frame }.trim(100)).has_value());
+}
+
+TEST_CASE(zstd_round_trip)
+{
+    for (size_t size : { 0ul, 1ul, 16ul, 17ul, 1000ul, Compress::ZstdCompressor::block_size, 3 * Compress::ZstdCompressor::window_size + 17 }) {
+        auto original = make_compressible_data(size);
+        auto compressed = Compress::ZstdCompressor::compress_all(original);
+        EXPECT(compressed.has_value());
+        EXPECT(Compress::ZstdDecompressor::is_likely_compressed(compressed.value()));
+        auto decompressed = Compress::ZstdDecompressor::decompress_all(compressed.value());
+        EXPECT(decompressed.has_value());
+        EXPECT(decompressed.value() == original);
+    }
+}
+
+TEST_CASE(zstd_round_trip_incompressible)
+{
+    auto original = ByteBuffer::create_uninitialized(300000);
+    fill_with_random(original.data(), original.size());
+    auto compressed = Compress::ZstdCompressor::compress_all(original);
+    EXPECT(compressed.has_value());
+    auto decompressed = Compress::ZstdDecompressor::decompress_all(compressed.value());
+    EXPECT(decompressed.has_value());
+    EXPECT(decompressed.value() == original);
+}
+
+BENCHMARK_CASE(zstd_round_trip_large)
+{
+    auto original = make_compressible_data(4 * MiB);
+    auto compressed = Compress::ZstdCompressor::compress_all(original);
+    EXPECT(compressed.has_value());
+    auto decompressed = Compress::ZstdDecompressor::decompress_all(compressed.value());
+    EXPECT(decompressed.has_value());
+    EXPECT(decompressed.value() == original);
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/EventLoop.h>
+#include <LibCore/Timer.h>
+#include <LibTest/TestCase.h>
+
+TEST_CASE(timers_fire_in_order)
+{
+    Core::EventLoop event_loop;
+    Vector<int> fired;
+    NonnullRefPtrVector<Core::Timer> timers;
+    for (int interval : { 40, 10, 30, 20 }) {
+        timers.append(Core::Timer::create_single_shot(interval, [&fired, interval] {
+            fired.append(interval);
+        }));
+        timers.last().start();
+    }
+    auto quit_timer = Core::Timer::create_single_shot(100, [&] { event_loop.quit(0); });
+    quit_timer->start();
+    event_loop.exec();
+
+    EXPECT_EQ(fired.size(), 4u);
+    for (size_t i = 0; i < fired.size(); ++i)
+        EXPECT_EQ(fired[i], static_cast<int>(i + 1) * 10);
+}
+
+TEST_CASE(stopped_timers_do_not_fire)
+{
+    Core::EventLoop event_loop;
+    size_t fire_count = 0;
+    NonnullRefPtrVector<Core::Timer> timers;
+    for (int i = 0; i < 1000; ++i) {
+        timers.append(Core::Timer::create_single_shot(i % 50, [&] { ++fire_count; }));
+        timers.last().start();
+    }
+    for (size_t i = 0; i < timers.size(); i += 2)
+        timers[i].stop();
+    auto quit_timer = Core::Timer::create_single_shot(100, [&] { event_loop.quit(0); });
+    quit_timer->start();
+    event_loop.exec();
+
+    EXPECT_EQ(fire_count, 500u);
+}
+
+TEST_CASE(repeating_timer)
+{
+    Core::EventLoop event_loop;
+    int fire_count = 0;
+    auto timer = Core::Timer::create_repeating(5, [&] {
+        if (++fire_count == 10)
+            event_loop.quit(0);
+    });
+    timer->start();
+    event_loop.exec();
+
+    EXPECT_EQ(fire_count, 10);
+}
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Random.h>
 #include <LibCrypto/BigInt/UnsignedBigInteger.h>
 #include <LibCrypto/Checksum/Adler32.h>
 #include <LibCrypto/Cipher/AES.h>
@@ -454,3 +455,83 @@ TEST_CASE(test_AES_GCM_128bit_decrypt_multiple_blocks_with_aad)
     EXPECT(memcmp(result_pt, out.data(), out.size()) == 0);
     EXPECT_EQ(consistency, Crypto::VerificationConsistency::Consistent);
 }
+
+TEST_CASE(test_AES_CTR_many_blocks_match_single_blocks)
+{
+    // 19 and a bit blocks, to go through the batched path, one block at a time and the partial block at the end.
+    u8 key[32];
+    u8 ivec[16];
+    u8 in[19 * 16 + 5];
+    fill_with_random(key, sizeof(key));
+    fill_with_random(ivec, sizeof(ivec));
+    fill_with_random(in, sizeof(in));
+    ivec[15] = 0xf0; // make the counter carry in the middle
+
+    Crypto::Cipher::AESCipher::CTRMode cipher(ReadonlyBytes { key, sizeof(key) }, 256, Crypto::Cipher::Intent::Encryption);
+    auto out = ByteBuffer::create_uninitialized(sizeof(in));
+    auto out_span = out.bytes();
+    cipher.encrypt({ in, sizeof(in) }, out_span, { ivec, sizeof(ivec) });
+
+    Crypto::Cipher::AESCipher block_cipher({ key, sizeof(key) }, 256);
+    Bytes counter { ivec, sizeof(ivec) };
+    for (size_t offset = 0; offset < sizeof(in); offset += 16) {
+        Crypto::Cipher::AESCipherBlock block(counter.data(), counter.size());
+        block_cipher.encrypt_block(block, block);
+        for (size_t i = offset; i < min(offset + 16, sizeof(in)); ++i)
+            EXPECT_EQ(out[i], in[i] ^ block.bytes()[i - offset]);
+        Crypto::Cipher::IncrementInplace {}(counter);
+    }
+}
+
+TEST_CASE(test_GHash_matches_bitwise_multiply)
+{
+    u8 key[16];
+    u8 aad[37];
+    u8 cipher_text[150];
+    fill_with_random(key, sizeof(key));
+    fill_with_random(aad, sizeof(aad));
+    fill_with_random(cipher_text, sizeof(cipher_text));
+
+    u32 h[4];
+    for (size_t i = 0; i < 4; ++i)
+        h[i] = (u32)key[4 * i] << 24 | key[4 * i + 1] << 16 | key[4 * i + 2] << 8 | key[4 * i + 3];
+    u32 expected[4] {};
+    auto add_block = [&](const u8* data, size_t size) {
+        u8 block[16] {};
+        memcpy(block, data, size);
+        for (size_t i = 0; i < 4; ++i)
+            expected[i] ^= (u32)block[4 * i] << 24 | block[4 * i + 1] << 16 | block[4 * i + 2] << 8 | block[4 * i + 3];
+        Crypto::Authentication::galois_multiply(expected, h, expected);
+    };
+    for (size_t i = 0; i < sizeof(aad); i += 16)
+        add_block(aad + i, min<size_t>(16, sizeof(aad) - i));
+    for (size_t i = 0; i < sizeof(cipher_text); i += 16)
+        add_block(cipher_text + i, min<size_t>(16, sizeof(cipher_text) - i));
+    u8 lengths[16] {};
+    lengths[6] = (8 * sizeof(aad)) >> 8;
+    lengths[7] = (u8)(8 * sizeof(aad));
+    lengths[14] = (8 * sizeof(cipher_text)) >> 8;
+    lengths[15] = (u8)(8 * sizeof(cipher_text));
+    add_block(lengths, 16);
+
+    Crypto::Authentication::GHash ghash({ key, sizeof(key) });
+    auto tag = ghash.process({ aad, sizeof(aad) }, { cipher_text, sizeof(cipher_text) });
+    for (size_t i = 0; i < 16; ++i)
+        EXPECT_EQ(tag.data[i], (u8)(expected[i / 4] >> (24 - 8 * (i % 4))));
+}
+
+BENCHMARK_CASE(test_AES_GCM_encrypt_decrypt_large)
+{
+    auto key = ByteBuffer::create_zeroed(16);
+    auto in = ByteBuffer::create_uninitialized(4 * MiB + 3);
+    fill_with_random(in.data(), in.size());
+    auto iv = ByteBuffer::create_zeroed(16);
+    u8 tag[16];
+
+    Crypto::Cipher::AESCipher::GCMMode cipher(key, 128, Crypto::Cipher::Intent::Encryption);
+    auto encrypted = ByteBuffer::create_uninitialized(in.size());
+    cipher.encrypt(in, encrypted, iv, {}, { tag, sizeof(tag) });
+    auto decrypted = ByteBuffer::create_uninitialized(in.size());
+    EXPECT_EQ(cipher.decrypt(encrypted, decrypted, iv, {}, { tag, sizeof(tag) }), Crypto::VerificationConsistency::Consistent);
+    EXPECT(decrypted == in);
+}
@@ -35,6 +35,16 @@ static Crypto::SignedBigInteger bigint_signed_fibonacci(size_t n)
     return num1;
 }
 
+static Crypto::UnsignedBigInteger random_bigint(size_t length_in_words)
+{
+    Vector<u32, Crypto::STARTING_WORD_SIZE> words;
+    words.resize(length_in_words);
+    fill_with_random(words.data(), length_in_words * sizeof(u32));
+    // Set the top bit, so that the number is exactly as long as asked for and so are products of these.
+    words.last() |= 1u << 31;
+    return Crypto::UnsignedBigInteger(move(words));
+}
+
 TEST_CASE(test_bigint_fib500)
 {
     Vector<u32> result {
@@ -201,6 +211,35 @@ TEST_CASE(test_unsigned_bigint_multiplication_with_big_numbers2)
     EXPECT_EQ(result.words(), expected_result);
 }
 
+TEST_CASE(test_unsigned_bigint_multiplication_with_karatsuba)
+{
+    // Both balanced and lopsided operands, above and around the size where Karatsuba takes over.
+    struct {
+        size_t left_length;
+        size_t right_length;
+    } sizes[] = { { 32, 32 }, { 33, 65 }, { 100, 70 }, { 300, 40 }, { 97, 250 } };
+
+    for (auto size : sizes) {
+        auto left = random_bigint(size.left_length);
+        auto right = random_bigint(size.right_length);
+        auto product = left.multiplied_by(right);
+        EXPECT_EQ(product.trimmed_length(), size.left_length + size.right_length);
+        auto division = product.divided_by(right);
+        EXPECT_EQ(division.quotient, left);
+        EXPECT_EQ(division.remainder, 0);
+    }
+}
+
+TEST_CASE(test_unsigned_bigint_multiplication_with_karatsuba_carries)
+{
+    // (2^n - 1)^2 = 2^2n - 2^(n + 1) + 1, where every word of the operands is all ones.
+    size_t bits = 200 * Crypto::UnsignedBigInteger::BITS_IN_WORD;
+    Crypto::UnsignedBigInteger one { 1 };
+    auto all_ones = one.shift_left(bits).minus(one);
+    auto expected = one.shift_left(2 * bits).minus(one.shift_left(bits + 1)).plus(one);
+    EXPECT_EQ(all_ones.multiplied_by(all_ones), expected);
+}
+
 TEST_CASE(test_unsigned_bigint_simple_division)
 {
     Crypto::UnsignedBigInteger num1(27194);
@@ -330,6 +369,29 @@ TEST_CASE(test_bigint_modular_power_extra_tests)
     }
 }
 
+BENCHMARK_CASE(test_bigint_modular_power_2048_bits)
+{
+    // The size of an RSA-2048 private key operation, without the Chinese remainder theorem.
+    auto modulo = random_bigint(64);
+    modulo.set_bit_inplace(0);
+    auto base = random_bigint(63);
+    auto exponent = random_bigint(64);
+    for (size_t i = 0; i < 10; ++i) {
+        auto result = Crypto::NumberTheory::ModularPower(base, exponent, modulo);
+        EXPECT(result < modulo);
+    }
+}
+
+BENCHMARK_CASE(test_bigint_multiplication_large)
+{
+    auto left = random_bigint(2000);
+    auto right = random_bigint(2000);
+    for (size_t i = 0; i < 10; ++i) {
+        auto product = left.multiplied_by(right);
+        EXPECT_EQ(product.trimmed_length(), 4000u);
+    }
+}
+
 TEST_CASE(test_bigint_primality_test)
 {
     struct {
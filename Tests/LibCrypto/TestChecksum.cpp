@@ -4,8 +4,10 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ByteBuffer.h>
 #include <LibCrypto/Checksum/Adler32.h>
 #include <LibCrypto/Checksum/CRC32.h>
+#include <LibCrypto/Checksum/XXHash.h>
 #include <LibTest/TestCase.h>
 
 TEST_CASE(test_adler32)
@@ -33,3 +35,101 @@ TEST_CASE(test_crc32)
     do_test(String("The quick brown fox jumps over the lazy dog").bytes(), 0x414FA339);
     do_test(String("various CRC algorithms input data").bytes(), 0x9BD366AE);
 }
+
+// Large enough to go through the unrolled and folded paths, with a pattern that doesn't repeat every few bytes.
+static ByteBuffer make_large_input(size_t size, Optional<u8> fill = {})
+{
+    auto buffer = ByteBuffer::create_uninitialized(size);
+    for (size_t i = 0; i < size; ++i)
+        buffer[i] = fill.has_value() ? fill.value() : (u8)(i * 7 + i / 3);
+    return buffer;
+}
+
+TEST_CASE(test_adler32_large_input)
+{
+    EXPECT_EQ(Crypto::Checksum::Adler32(make_large_input(100000)).digest(), 0xaff8518au);
+    EXPECT_EQ(Crypto::Checksum::Adler32(make_large_input(100000, 0xff)).digest(), 0x149a302cu);
+}
+
+TEST_CASE(test_crc32_large_input)
+{
+    EXPECT_EQ(Crypto::Checksum::CRC32(make_large_input(100000)).digest(), 0x57e50f15u);
+    EXPECT_EQ(Crypto::Checksum::CRC32(make_large_input(100000, 0xff)).digest(), 0x68c6cec4u);
+}
+
+TEST_CASE(test_checksums_split_updates)
+{
+    auto input = make_large_input(100000);
+    auto expected_adler32 = Crypto::Checksum::Adler32(input).digest();
+    auto expected_crc32 = Crypto::Checksum::CRC32(input).digest();
+
+    // Every split point below the folding threshold and a few odd-sized ones above it.
+    for (size_t split : { 0, 1, 3, 15, 16, 17, 63, 64, 65, 5551, 5552, 5553, 99999 }) {
+        Crypto::Checksum::Adler32 adler32;
+        adler32.update(input.bytes().trim(split));
+        adler32.update(input.bytes().slice(split));
+        EXPECT_EQ(adler32.digest(), expected_adler32);
+
+        Crypto::Checksum::CRC32 crc32;
+        crc32.update(input.bytes().trim(split));
+        crc32.update(input.bytes().slice(split));
+        EXPECT_EQ(crc32.digest(), expected_crc32);
+    }
+}
+
+TEST_CASE(test_crc32_unaligned_input)
+{
+    auto input = make_large_input(1000);
+    for (size_t offset = 0; offset < 16; ++offset) {
+        // Single bytes are too short to take anything but the bytewise path.
+        Crypto::Checksum::CRC32 expected;
+        for (u8 byte : input.bytes().slice(offset))
+            expected.update({ &byte, 1 });
+        EXPECT_EQ(Crypto::Checksum::CRC32(input.bytes().slice(offset)).digest(), expected.digest());
+    }
+}
+
+TEST_CASE(test_xxhash32)
+{
+    auto do_test = [](ReadonlyBytes input, u32 expected_result) {
+        auto digest = Crypto::Checksum::XXHash32(input).digest();
+        EXPECT_EQ(digest, expected_result);
+    };
+
+    do_test(String("").bytes(), 0x02cc5d05);
+    do_test(String("abc").bytes(), 0x32d153ff);
+    do_test(String("The quick brown fox jumps over the lazy dogThe quick brown fox jumps over the lazy dogThe quick brown fox jumps over the lazy dog").bytes(), 0x903b2d5e);
+    do_test(make_large_input(100000), 0x20ba3ecd);
+}
+
+TEST_CASE(test_xxhash64)
+{
+    auto do_test = [](ReadonlyBytes input, u64 expected_result) {
+        auto digest = Crypto::Checksum::XXHash64(input).digest();
+        EXPECT_EQ(digest, expected_result);
+    };
+
+    do_test(String("").bytes(), 0xef46db3751d8e999);
+    do_test(String("abc").bytes(), 0x44bc2cf5ad770999);
+    do_test(String("The quick brown fox jumps over the lazy dogThe quick brown fox jumps over the lazy dogThe quick brown fox jumps over the lazy dog").bytes(), 0xc652b4dbfcd6b853);
+    do_test(make_large_input(100000), 0x7f81beec5e417462);
+}
+
+TEST_CASE(test_xxhash_split_updates)
+{
+    auto input = make_large_input(1000);
+    auto expected_xxhash32 = Crypto::Checksum::XXHash32(input).digest();
+    auto expected_xxhash64 = Crypto::Checksum::XXHash64(input).digest();
+
+    for (size_t split : { 0, 1, 15, 16, 17, 31, 32, 33, 999 }) {
+        Crypto::Checksum::XXHash32 xxhash32;
+        xxhash32.update(input.bytes().trim(split));
+        xxhash32.update(input.bytes().slice(split));
+        EXPECT_EQ(xxhash32.digest(), expected_xxhash32);
+
+        Crypto::Checksum::XXHash64 xxhash64;
+        xxhash64.update(input.bytes().trim(split));
+        xxhash64.update(input.bytes().slice(split));
+        EXPECT_EQ(xxhash64.digest(), expected_xxhash64);
+    }
+}
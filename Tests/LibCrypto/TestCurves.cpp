@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <LibCrypto/Curves/X25519.h>
+#include <LibTest/TestCase.h>
+
+using Key = Array<u8, Crypto::Curves::X25519::key_size>;
+
+// The test vectors from RFC 7748 section 5.2.
+TEST_CASE(test_x25519_compute_coordinate)
+{
+    Key scalar {
+        0xa5, 0x46, 0xe3, 0x6b, 0xf0, 0x52, 0x7c, 0x9d, 0x3b, 0x16, 0x15, 0x4b, 0x82, 0x46, 0x5e, 0xdd,
+        0x62, 0x14, 0x4c, 0x0a, 0xc1, 0xfc, 0x5a, 0x18, 0x50, 0x6a, 0x22, 0x44, 0xba, 0x44, 0x9a, 0xc4
+    };
+    Key point {
+        0xe6, 0xdb, 0x68, 0x67, 0x58, 0x30, 0x30, 0xdb, 0x35, 0x94, 0xc1, 0xa4, 0x24, 0xb1, 0x5f, 0x7c,
+        0x72, 0x66, 0x24, 0xec, 0x26, 0xb3, 0x35, 0x3b, 0x10, 0xa9, 0x03, 0xa6, 0xd0, 0xab, 0x1c, 0x4c
+    };
+    Key expected {
+        0xc3, 0xda, 0x55, 0x37, 0x9d, 0xe9, 0xc6, 0x90, 0x8e, 0x94, 0xea, 0x4d, 0xf2, 0x8d, 0x08, 0x4f,
+        0x32, 0xec, 0xcf, 0x03, 0x49, 0x1c, 0x71, 0xf7, 0x54, 0xb4, 0x07, 0x55, 0x77, 0xa2, 0x85, 0x52
+    };
+    Key result;
+    Crypto::Curves::X25519::compute_coordinate(scalar, point, result);
+    EXPECT(result == expected);
+}
+
+TEST_CASE(test_x25519_iterated)
+{
+    // Starting from k = u = 9, one iteration sets u to the old k and k to X25519(k, u).
+    Key scalar { 9 };
+    Key point { 9 };
+    for (size_t i = 0; i < 1000; ++i) {
+        Key result;
+        Crypto::Curves::X25519::compute_coordinate(scalar, point, result);
+        point = scalar;
+        scalar = result;
+    }
+    Key expected {
+        0x68, 0x4c, 0xf5, 0x9b, 0xa8, 0x33, 0x09, 0x55, 0x28, 0x00, 0xef, 0x56, 0x6f, 0x2f, 0x4d, 0x3c,
+        0x1c, 0x38, 0x87, 0xc4, 0x93, 0x60, 0xe3, 0x87, 0x5f, 0x2e, 0xb9, 0x4d, 0x99, 0x53, 0x2c, 0x51
+    };
+    EXPECT(scalar == expected);
+}
+
+// The Diffie-Hellman example from RFC 7748 section 6.1.
+TEST_CASE(test_x25519_key_exchange)
+{
+    Key alice_private_key {
+        0x77, 0x07, 0x6d, 0x0a, 0x73, 0x18, 0xa5, 0x7d, 0x3c, 0x16, 0xc1, 0x72, 0x51, 0xb2, 0x66, 0x45,
+        0xdf, 0x4c, 0x2f, 0x87, 0xeb, 0xc0, 0x99, 0x2a, 0xb1, 0x77, 0xfb, 0xa5, 0x1d, 0xb9, 0x2c, 0x2a
+    };
+    Key alice_expected_public_key {
+        0x85, 0x20, 0xf0, 0x09, 0x89, 0x30, 0xa7, 0x54, 0x74, 0x8b, 0x7d, 0xdc, 0xb4, 0x3e, 0xf7, 0x5a,
+        0x0d, 0xbf, 0x3a, 0x0d, 0x26, 0x38, 0x1a, 0xf4, 0xeb, 0xa4, 0xa9, 0x8e, 0xaa, 0x9b, 0x4e, 0x6a
+    };
+    Key bob_private_key {
+        0x5d, 0xab, 0x08, 0x7e, 0x62, 0x4a, 0x8a, 0x4b, 0x79, 0xe1, 0x7f, 0x8b, 0x83, 0x80, 0x0e, 0xe6,
+        0x6f, 0x3b, 0xb1, 0x29, 0x26, 0x18, 0xb6, 0xfd, 0x1c, 0x2f, 0x8b, 0x27, 0xff, 0x88, 0xe0, 0xeb
+    };
+    Key bob_expected_public_key {
+        0xde, 0x9e, 0xdb, 0x7d, 0x7b, 0x7d, 0xc1, 0xb4, 0xd3, 0x5b, 0x61, 0xc2, 0xec, 0xe4, 0x35, 0x37,
+        0x3f, 0x83, 0x43, 0xc8, 0x5b, 0x78, 0x67, 0x4d, 0xad, 0xfc, 0x7e, 0x14, 0x6f, 0x88, 0x2b, 0x4f
+    };
+    Key expected_shared_secret {
+        0x4a, 0x5d, 0x9d, 0x5b, 0xa4, 0xce, 0x2d, 0xe1, 0x72, 0x8e, 0x3b, 0xf4, 0x80, 0x35, 0x0f, 0x25,
+        0xe0, 0x7e, 0x21, 0xc9, 0x47, 0xd1, 0x9e, 0x33, 0x76, 0xf0, 0x9b, 0x3c, 0x1e, 0x16, 0x17, 0x42
+    };
+
+    Key alice_public_key;
+    Key bob_public_key;
+    Crypto::Curves::X25519::generate_public_key(alice_private_key, alice_public_key);
+    Crypto::Curves::X25519::generate_public_key(bob_private_key, bob_public_key);
+    EXPECT(alice_public_key == alice_expected_public_key);
+    EXPECT(bob_public_key == bob_expected_public_key);
+
+    Key alice_shared_secret;
+    Key bob_shared_secret;
+    EXPECT(Crypto::Curves::X25519::compute_shared_secret(alice_private_key, bob_public_key, alice_shared_secret));
+    EXPECT(Crypto::Curves::X25519::compute_shared_secret(bob_private_key, alice_public_key, bob_shared_secret));
+    EXPECT(alice_shared_secret == expected_shared_secret);
+    EXPECT(bob_shared_secret == expected_shared_secret);
+}
+
+TEST_CASE(test_x25519_rejects_small_order_point)
+{
+    Key private_key;
+    Crypto::Curves::X25519::generate_private_key(private_key);
+    Key zero_point {};
+    Key shared_secret;
+    EXPECT(!Crypto::Curves::X25519::compute_shared_secret(private_key, zero_point, shared_secret));
+}
@@ -4,6 +4,8 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ByteBuffer.h>
+#include <AK/Random.h>
 #include <LibCrypto/Authentication/GHash.h>
 #include <LibCrypto/Authentication/HMAC.h>
 #include <LibCrypto/Hash/MD5.h>
@@ -12,6 +14,23 @@
 #include <LibTest/TestCase.h>
 #include <cstring>
 
+// Hashes a million 'a's, starting at an unaligned address, in pieces that don't line up with the blocks.
+template<typename Hash>
+static typename Hash::DigestType hash_million_characters_in_pieces()
+{
+    auto string = String::repeated('a', 1000001);
+    auto data = string.bytes().slice(1);
+
+    Hash hasher;
+    size_t offset = 0;
+    for (size_t piece_size = 1; offset < data.size(); piece_size = piece_size * 3 + 1) {
+        auto size = min(piece_size, data.size() - offset);
+        hasher.update(data.slice(offset, size));
+        offset += size;
+    }
+    return hasher.digest();
+}
+
 TEST_CASE(test_MD5_name)
 {
     Crypto::Hash::MD5 md5;
@@ -142,6 +161,23 @@ TEST_CASE(test_SHA1_hash_successive_updates)
     EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA1::digest_size()) == 0);
 }
 
+TEST_CASE(test_SHA1_hash_million_characters)
+{
+    u8 result[] {
+        0x34, 0xaa, 0x97, 0x3c, 0xd4, 0xc4, 0xda, 0xa4, 0xf6, 0x1e, 0xeb, 0x2b, 0xdb, 0xad, 0x27, 0x31, 0x65, 0x34, 0x01, 0x6f
+    };
+    auto digest = hash_million_characters_in_pieces<Crypto::Hash::SHA1>();
+    EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA1::digest_size()) == 0);
+}
+
+BENCHMARK_CASE(test_SHA1_hash_large)
+{
+    auto buffer = ByteBuffer::create_uninitialized(64 * MiB);
+    fill_with_random(buffer.data(), buffer.size());
+    auto digest = Crypto::Hash::SHA1::hash(buffer);
+    EXPECT(digest.data_length() == Crypto::Hash::SHA1::digest_size());
+}
+
 TEST_CASE(test_SHA256_name)
 {
     Crypto::Hash::SHA256 sha;
@@ -166,6 +202,23 @@ TEST_CASE(test_SHA256_hash_empty_string)
     EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA256::digest_size()) == 0);
 }
 
+TEST_CASE(test_SHA256_hash_million_characters)
+{
+    u8 result[] {
+        0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92, 0x81, 0xa1, 0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67, 0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e, 0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0
+    };
+    auto digest = hash_million_characters_in_pieces<Crypto::Hash::SHA256>();
+    EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA256::digest_size()) == 0);
+}
+
+BENCHMARK_CASE(test_SHA256_hash_large)
+{
+    auto buffer = ByteBuffer::create_uninitialized(64 * MiB);
+    fill_with_random(buffer.data(), buffer.size());
+    auto digest = Crypto::Hash::SHA256::hash(buffer);
+    EXPECT(digest.data_length() == Crypto::Hash::SHA256::digest_size());
+}
+
 TEST_CASE(test_SHA384_name)
 {
     Crypto::Hash::SHA384 sha;
@@ -61,3 +61,98 @@ BENCHMARK_CASE(fill_with_gradient)
         painter.fill_rect_with_gradient(bitmap->rect(), Color::Blue, Color::Red);
     }
 }
+
+BENCHMARK_CASE(fill_with_alpha)
+{
+    const int run_count = 100;
+    const int bitmap_size = 2000;
+
+    auto bitmap = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size });
+    Gfx::Painter painter(*bitmap);
+    painter.clear_rect(bitmap->rect(), Color::White);
+
+    for (int run = 0; run < run_count; run++) {
+        painter.fill_rect(bitmap->rect(), Color(Color::Blue).with_alpha(0x80));
+    }
+}
+
+BENCHMARK_CASE(blit)
+{
+    const int run_count = 100;
+    const int bitmap_size = 2000;
+
+    auto bitmap = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size });
+    auto source = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size });
+    Gfx::Painter painter(*bitmap);
+    Gfx::Painter(*source).fill_rect_with_gradient(source->rect(), Color::Blue, Color::Red);
+
+    for (int run = 0; run < run_count; run++) {
+        painter.blit({ 0, 0 }, *source, source->rect());
+    }
+}
+
+BENCHMARK_CASE(blit_with_opacity)
+{
+    const int run_count = 100;
+    const int bitmap_size = 2000;
+
+    auto bitmap = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size });
+    auto source = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size });
+    Gfx::Painter painter(*bitmap);
+    Gfx::Painter(*source).fill_rect_with_gradient(source->rect(), Color::Blue, Color::Red);
+
+    for (int run = 0; run < run_count; run++) {
+        painter.blit({ 0, 0 }, *source, source->rect(), 0.5f);
+    }
+}
+
+BENCHMARK_CASE(blit_with_alpha)
+{
+    const int run_count = 100;
+    const int bitmap_size = 2000;
+
+    auto bitmap = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, { bitmap_size, bitmap_size });
+    auto source = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, { bitmap_size, bitmap_size });
+    Gfx::Painter painter(*bitmap);
+    painter.clear_rect(bitmap->rect(), Color::White);
+    Gfx::Painter(*source).fill_rect_with_gradient(source->rect(), Color(Color::Blue).with_alpha(0x40), Color(Color::Red).with_alpha(0xc0));
+
+    for (int run = 0; run < run_count; run++) {
+        painter.blit({ 0, 0 }, *source, source->rect());
+    }
+}
+
+BENCHMARK_CASE(blit_premultiplied)
+{
+    const int run_count = 100;
+    const int bitmap_size = 2000;
+
+    auto bitmap = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, { bitmap_size, bitmap_size });
+    auto source = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888Premultiplied, { bitmap_size, bitmap_size });
+    Gfx::Painter painter(*bitmap);
+    painter.clear_rect(bitmap->rect(), Color::White);
+    for (int y = 0; y < bitmap_size; ++y) {
+        for (int x = 0; x < bitmap_size; ++x)
+            source->set_pixel(x, y, Color(x, y, 0x80, 0x40 + x % 0x80));
+    }
+
+    for (int run = 0; run < run_count; run++) {
+        painter.blit({ 0, 0 }, *source, source->rect());
+    }
+}
+
+BENCHMARK_CASE(draw_scaled_bitmap_with_alpha)
+{
+    const int run_count = 50;
+    const int bitmap_size = 2000;
+
+    auto bitmap = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, { bitmap_size, bitmap_size });
+    auto source = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, { 700, 700 });
+    Gfx::Painter painter(*bitmap);
+    painter.clear_rect(bitmap->rect(), Color::White);
+    Gfx::Painter(*source).fill_rect_with_gradient(source->rect(), Color(Color::Blue).with_alpha(0x40), Color(Color::Red).with_alpha(0xc0));
+
+    for (int run = 0; run < run_count; run++) {
+        painter.draw_scaled_bitmap(bitmap->rect(), *source, source->rect());
+    }
+}
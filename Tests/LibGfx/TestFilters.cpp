@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Filters/FastBoxBlurFilter.h>
+#include <LibGfx/Filters/SharpenFilter.h>
+#include <LibGfx/Filters/SpatialGaussianBlurFilter.h>
+#include <LibTest/TestCase.h>
+
+static RefPtr<Gfx::Bitmap> create_test_bitmap(int width, int height)
+{
+    auto bitmap = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, { width, height });
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x)
+            bitmap->set_pixel(x, y, Color((x * 37) % 256, (y * 59) % 256, (x * y) % 256, 255));
+    }
+    return bitmap;
+}
+
+TEST_CASE(fast_box_blur_keeps_uniform_color)
+{
+    auto bitmap = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, { 300, 200 });
+    bitmap->fill(Color(10, 20, 30, 200));
+    Gfx::FastBoxBlurFilter(*bitmap).apply_three_passes(12);
+    for (int y = 0; y < bitmap->height(); ++y) {
+        for (int x = 0; x < bitmap->width(); ++x)
+            EXPECT_EQ(bitmap->get_pixel(x, y), Color(10, 20, 30, 200));
+    }
+}
+
+TEST_CASE(fast_box_blur_averages_window)
+{
+    auto bitmap = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, { 9, 9 });
+    bitmap->fill(Color::Black);
+    bitmap->set_pixel(4, 4, Color(90, 180, 255));
+    Gfx::FastBoxBlurFilter(*bitmap).apply_single_pass(1);
+    for (int y = 0; y < 9; ++y) {
+        for (int x = 0; x < 9; ++x) {
+            bool in_window = abs(x - 4) <= 1 && abs(y - 4) <= 1;
+            EXPECT_EQ(bitmap->get_pixel(x, y), in_window ? Color(10, 20, 28) : Color::Black);
+        }
+    }
+}
+
+template<size_t N>
+static void expect_matches_direct_convolution(Gfx::Bitmap const& original, Gfx::Bitmap const& filtered, Gfx::Matrix<N, float> const& kernel)
+{
+    constexpr int offset = N / 2;
+    for (int y = 0; y < original.height(); ++y) {
+        for (int x = 0; x < original.width(); ++x) {
+            float red = 0;
+            float green = 0;
+            float blue = 0;
+            for (int k = 0; k < (int)N; ++k) {
+                for (int l = 0; l < (int)N; ++l) {
+                    int sample_x = x + k - offset;
+                    int sample_y = y + l - offset;
+                    if (!original.rect().contains(sample_x, sample_y))
+                        continue;
+                    auto pixel = original.get_pixel(sample_x, sample_y);
+                    red += pixel.red() * kernel.elements()[k][l];
+                    green += pixel.green() * kernel.elements()[k][l];
+                    blue += pixel.blue() * kernel.elements()[k][l];
+                }
+            }
+            auto pixel = filtered.get_pixel(x, y);
+            EXPECT(fabsf(clamp(red, 0.0f, 255.0f) - pixel.red()) <= 1.0f);
+            EXPECT(fabsf(clamp(green, 0.0f, 255.0f) - pixel.green()) <= 1.0f);
+            EXPECT(fabsf(clamp(blue, 0.0f, 255.0f) - pixel.blue()) <= 1.0f);
+        }
+    }
+}
+
+TEST_CASE(separable_convolution)
+{
+    Gfx::Matrix<5, float> kernel;
+    float weights[5] = { 1, 4, 6, 4, 1 };
+    for (size_t k = 0; k < 5; ++k) {
+        for (size_t l = 0; l < 5; ++l)
+            kernel.elements()[k][l] = weights[k] * weights[l] / 256;
+    }
+
+    auto original = create_test_bitmap(37, 23);
+    auto filtered = original->clone();
+    Gfx::SpatialGaussianBlurFilter<5> filter;
+    filter.apply(*filtered, filtered->rect(), *filtered, filtered->rect(), Gfx::SpatialGaussianBlurFilter<5>::Parameters(kernel));
+    expect_matches_direct_convolution(*original, *filtered, kernel);
+}
+
+TEST_CASE(non_separable_convolution)
+{
+    Gfx::Matrix<3, float> kernel(0, -1, 0, -1, 5, -1, 0, -1, 0);
+
+    auto original = create_test_bitmap(37, 23);
+    auto filtered = original->clone();
+    Gfx::SharpenFilter filter;
+    filter.apply(*filtered, filtered->rect(), *filtered, filtered->rect(), Gfx::SharpenFilter::Parameters(kernel));
+    expect_matches_direct_convolution(*original, *filtered, kernel);
+}
@@ -5,8 +5,11 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Utf8View.h>
 #include <LibGfx/BitmapFont.h>
 #include <LibGfx/FontDatabase.h>
+#include <LibGfx/GlyphAtlas.h>
+#include <LibGfx/TrueTypeFont/Font.h>
 #include <LibTest/TestCase.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -147,3 +150,58 @@ TEST_CASE(test_write_to_file)
     EXPECT(font->write_to_file(path));
     unlink(path);
 }
+
+TEST_CASE(test_glyph_atlas_packing)
+{
+    auto atlas = Gfx::GlyphAtlas::create();
+    Vector<Gfx::GlyphAtlas::Entry> entries;
+    for (int i = 0; i < 100; ++i) {
+        auto bitmap = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, { 10 + i % 7, 12 + i % 5 });
+        bitmap->fill(Color(i, 0, 0, 255));
+        auto entry = atlas->add(*bitmap);
+        EXPECT(entry.has_value());
+        EXPECT_EQ(entry->rect.size(), bitmap->size());
+        EXPECT_EQ(entry->bitmap->get_pixel(entry->rect.location()), Color(i, 0, 0, 255));
+        EXPECT_EQ(entry->bitmap->get_pixel(entry->rect.bottom_right()), Color(i, 0, 0, 255));
+        for (auto& other : entries)
+            EXPECT(other.bitmap.ptr() != entry->bitmap.ptr() || !other.rect.intersects(entry->rect));
+        entries.append(entry.release_value());
+    }
+    EXPECT_EQ(atlas->page_count(), 1u);
+
+    auto large_bitmap = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, { 300, 20 });
+    auto large_entry = atlas->add(*large_bitmap);
+    EXPECT(large_entry.has_value());
+    EXPECT_EQ(large_entry->rect, Gfx::IntRect(0, 0, 300, 20));
+    EXPECT_EQ(atlas->page_count(), 2u);
+}
+
+TEST_CASE(test_truetype_glyphs_share_atlas)
+{
+    auto font_or_error = TTF::Font::try_load_from_file("/res/fonts/LiberationSerif-Regular.ttf");
+    EXPECT(!font_or_error.is_error());
+    auto scaled_font = adopt_ref(*new TTF::ScaledFont(font_or_error.release_value(), 12, 12));
+    auto a = scaled_font->glyph('a');
+    auto b = scaled_font->glyph('b');
+    EXPECT(!a.is_glyph_bitmap());
+    EXPECT_EQ(a.bitmap().ptr(), b.bitmap().ptr());
+    EXPECT(!a.bitmap_rect().intersects(b.bitmap_rect()));
+    EXPECT_EQ(scaled_font->glyph('a').bitmap_rect(), a.bitmap_rect());
+}
+
+TEST_CASE(test_truetype_width_cache)
+{
+    auto font_or_error = TTF::Font::try_load_from_file("/res/fonts/LiberationSerif-Regular.ttf");
+    EXPECT(!font_or_error.is_error());
+    auto scaled_font = adopt_ref(*new TTF::ScaledFont(font_or_error.release_value(), 12, 12));
+    auto hello_width = scaled_font->width("Hello friends!");
+    EXPECT(hello_width > 0);
+    EXPECT_EQ(scaled_font->width(Utf8View("Hello friends!")), hello_width);
+
+    // Measuring enough other runs to evict everything else shouldn't change the result.
+    for (size_t i = 0; i < 2000; ++i)
+        EXPECT(scaled_font->width(String::number(i)) > 0);
+    EXPECT_EQ(scaled_font->width("Hello friends!"), hello_width);
+    EXPECT_EQ(scaled_font->width("1"), scaled_font->width("7"));
+    EXPECT(scaled_font->width("ll") < scaled_font->width("mm"));
+}
@@ -5,6 +5,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/MappedFile.h>
 #include <AK/String.h>
 #include <LibGfx/BMPLoader.h>
 #include <LibGfx/GIFLoader.h>
@@ -79,6 +80,30 @@ TEST_CASE(test_jpg)
     EXPECT(frame.duration == 0);
 }
 
+TEST_CASE(test_jpg_ideal_size)
+{
+    auto file_or_error = MappedFile::map("/res/html/misc/jpgsuite_files/oh-lena.jpg");
+    EXPECT(!file_or_error.is_error());
+    auto& file = file_or_error.value();
+
+    auto full_decoder = Gfx::ImageDecoder::try_create(file->bytes());
+    EXPECT(full_decoder);
+    auto full_bitmap = full_decoder->frame(0).image;
+    EXPECT_EQ(full_bitmap->size(), Gfx::IntSize(1200, 822));
+
+    // An eighth of the size is decoded from the DC coefficients alone.
+    auto small_decoder = Gfx::ImageDecoder::try_create(file->bytes());
+    small_decoder->set_ideal_size({ 100, 100 });
+    auto small_bitmap = small_decoder->frame(0).image;
+    EXPECT_EQ(small_bitmap->size(), Gfx::IntSize(150, 103));
+    EXPECT_EQ(small_decoder->size(), Gfx::IntSize(1200, 822));
+
+    // Anything bigger than that needs all of the image.
+    auto big_decoder = Gfx::ImageDecoder::try_create(file->bytes());
+    big_decoder->set_ideal_size({ 300, 300 });
+    EXPECT_EQ(big_decoder->frame(0).image->size(), Gfx::IntSize(1200, 822));
+}
+
 TEST_CASE(test_pbm)
 {
     auto image = Gfx::load_pbm("/res/html/misc/pbmsuite_files/buggie-raw.pbm");
@@ -134,3 +159,34 @@ TEST_CASE(test_ppm)
     auto frame = ppm.frame(1);
     EXPECT(frame.duration == 0);
 }
+
+static void decode_corpus(Vector<StringView> const& paths)
+{
+    for (auto& path : paths) {
+        auto file_or_error = MappedFile::map(path);
+        EXPECT(!file_or_error.is_error());
+        auto decoder = Gfx::ImageDecoder::try_create(file_or_error.value()->bytes());
+        EXPECT(decoder);
+        EXPECT(decoder->frame(0).image);
+    }
+}
+
+BENCHMARK_CASE(decode_png_corpus)
+{
+    Vector<StringView> paths { "/res/wallpapers/grid.png", "/res/wallpapers/sunset-retro.png", "/res/graphics/buggie.png" };
+    for (int run = 0; run < 5; ++run)
+        decode_corpus(paths);
+}
+
+BENCHMARK_CASE(decode_jpg_corpus)
+{
+    Vector<StringView> paths {
+        "/res/html/misc/jpgsuite_files/oh-lena.jpg",
+        "/res/html/misc/jpgsuite_files/non-subsampled-lena.jpg",
+        "/res/html/misc/jpgsuite_files/horizontally-halved-lena.jpg",
+        "/res/html/misc/jpgsuite_files/vertically-halved-lena.jpg",
+        "/res/html/misc/jpgsuite_files/chroma-quartered-lena.jpg",
+    };
+    for (int run = 0; run < 5; ++run)
+        decode_corpus(paths);
+}
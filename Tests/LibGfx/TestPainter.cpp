@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/FontDatabase.h>
+#include <LibGfx/Painter.h>
+#include <LibTest/TestCase.h>
+
+static struct FontDatabaseSpoofer {
+    FontDatabaseSpoofer()
+    {
+        Gfx::FontDatabase::the().set_default_font_query("Katica 10 400"sv);
+    }
+} g_spoof;
+
+TEST_CASE(premultiplied_pixels)
+{
+    auto bitmap = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888Premultiplied, { 2, 1 });
+    EXPECT(bitmap->has_alpha_channel());
+
+    bitmap->set_pixel(0, 0, Color(201, 102, 51, 85));
+    EXPECT_EQ(bitmap->scanline(0)[0], Color(67, 34, 17, 85).value());
+    EXPECT_EQ(bitmap->get_pixel(0, 0), Color(201, 102, 51, 85));
+
+    bitmap->set_pixel(1, 0, Color(200, 100, 50, 0));
+    EXPECT_EQ(bitmap->scanline(0)[1], 0u);
+    EXPECT_EQ(bitmap->get_pixel(1, 0), Color(0, 0, 0, 0));
+}
+
+TEST_CASE(blit_premultiplied_matches_straight_alpha)
+{
+    auto straight = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, { 256, 4 });
+    auto premultiplied = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888Premultiplied, { 256, 4 });
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 256; ++x) {
+            Color color(x, 255 - x, y * 80, x);
+            straight->set_pixel(x, y, color);
+            premultiplied->set_pixel(x, y, color);
+        }
+    }
+
+    for (auto opacity : { 1.0f, 0.5f }) {
+        auto expected = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRx8888, { 256, 4 });
+        auto actual = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRx8888, { 256, 4 });
+        expected->fill(Color(10, 120, 230));
+        actual->fill(Color(10, 120, 230));
+        Gfx::Painter(*expected).blit({ 0, 0 }, *straight, straight->rect(), opacity);
+        Gfx::Painter(*actual).blit({ 0, 0 }, *premultiplied, premultiplied->rect(), opacity);
+
+        // Premultiplying and scaling by the opacity both round, so the results may be off by a little.
+        for (int y = 0; y < 4; ++y) {
+            for (int x = 0; x < 256; ++x) {
+                auto a = expected->get_pixel(x, y);
+                auto b = actual->get_pixel(x, y);
+                EXPECT(abs(a.red() - b.red()) <= 2);
+                EXPECT(abs(a.green() - b.green()) <= 2);
+                EXPECT(abs(a.blue() - b.blue()) <= 2);
+            }
+        }
+    }
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Hex.h>
+#include <LibHTTP/HPack.h>
+
+static ByteBuffer bytes_from_hex(StringView hex)
+{
+    return decode_hex(hex).release_value();
+}
+
+static void expect_headers(Optional<Vector<HTTP::HPack::Header>> const& headers, Vector<HTTP::HPack::Header> const& expected)
+{
+    EXPECT(headers.has_value());
+    if (!headers.has_value())
+        return;
+    EXPECT_EQ(headers->size(), expected.size());
+    for (size_t i = 0; i < min(headers->size(), expected.size()); ++i) {
+        EXPECT_EQ(headers->at(i).name, expected[i].name);
+        EXPECT_EQ(headers->at(i).value, expected[i].value);
+    }
+}
+
+TEST_CASE(huffman_round_trip)
+{
+    // RFC 7541, C.4.1
+    auto encoded = HTTP::HPack::encode_huffman("www.example.com"sv.bytes());
+    EXPECT(encoded.bytes() == bytes_from_hex("f1e3c2e5f23a6ba0ab90f4ff").bytes());
+    auto decoded = HTTP::HPack::decode_huffman(encoded);
+    EXPECT(decoded.has_value());
+    EXPECT_EQ(StringView { decoded->bytes() }, "www.example.com"sv);
+
+    u8 all_bytes[256];
+    for (size_t i = 0; i < sizeof(all_bytes); ++i)
+        all_bytes[i] = i;
+    auto round_tripped = HTTP::HPack::decode_huffman(HTTP::HPack::encode_huffman({ all_bytes, sizeof(all_bytes) }));
+    EXPECT(round_tripped.has_value());
+    EXPECT(round_tripped->bytes() == ReadonlyBytes(all_bytes, sizeof(all_bytes)));
+}
+
+TEST_CASE(huffman_invalid_padding)
+{
+    // Padding that isn't all ones, and padding longer than 7 bits.
+    EXPECT(!HTTP::HPack::decode_huffman(bytes_from_hex("f1e3c2e5f23a6ba0ab90f4fe")).has_value());
+    EXPECT(!HTTP::HPack::decode_huffman(bytes_from_hex("f1e3c2e5f23a6ba0ab90f4ffff")).has_value());
+}
+
+TEST_CASE(decode_requests_without_huffman)
+{
+    // RFC 7541, C.3
+    HTTP::HPack::Decoder decoder;
+    expect_headers(decoder.decode(bytes_from_hex("828684410f7777772e6578616d706c652e636f6d")),
+        { { ":method", "GET" }, { ":scheme", "http" }, { ":path", "/" }, { ":authority", "www.example.com" } });
+    EXPECT_EQ(decoder.table_size(), 57u);
+
+    expect_headers(decoder.decode(bytes_from_hex("828684be58086e6f2d6361636865")),
+        { { ":method", "GET" }, { ":scheme", "http" }, { ":path", "/" }, { ":authority", "www.example.com" }, { "cache-control", "no-cache" } });
+    EXPECT_EQ(decoder.table_size(), 110u);
+
+    expect_headers(decoder.decode(bytes_from_hex("828785bf400a637573746f6d2d6b65790c637573746f6d2d76616c7565")),
+        { { ":method", "GET" }, { ":scheme", "https" }, { ":path", "/index.html" }, { ":authority", "www.example.com" }, { "custom-key", "custom-value" } });
+    EXPECT_EQ(decoder.table_size(), 164u);
+}
+
+TEST_CASE(decode_requests_with_huffman)
+{
+    // RFC 7541, C.4
+    HTTP::HPack::Decoder decoder;
+    expect_headers(decoder.decode(bytes_from_hex("828684418cf1e3c2e5f23a6ba0ab90f4ff")),
+        { { ":method", "GET" }, { ":scheme", "http" }, { ":path", "/" }, { ":authority", "www.example.com" } });
+    expect_headers(decoder.decode(bytes_from_hex("828684be5886a8eb10649cbf")),
+        { { ":method", "GET" }, { ":scheme", "http" }, { ":path", "/" }, { ":authority", "www.example.com" }, { "cache-control", "no-cache" } });
+    expect_headers(decoder.decode(bytes_from_hex("828785bf408825a849e95ba97d7f8925a849e95bb8e8b4bf")),
+        { { ":method", "GET" }, { ":scheme", "https" }, { ":path", "/index.html" }, { ":authority", "www.example.com" }, { "custom-key", "custom-value" } });
+    EXPECT_EQ(decoder.table_size(), 164u);
+}
+
+TEST_CASE(decode_responses_with_eviction)
+{
+    // RFC 7541, C.6
+    HTTP::HPack::Decoder decoder { 256 };
+    expect_headers(decoder.decode(bytes_from_hex("488264025885aec3771a4b6196d07abe941054d444a8200595040b8166e082a62d1bff6e919d29ad171863c78f0b97c8e9ae82ae43d3")),
+        { { ":status", "302" }, { "cache-control", "private" }, { "date", "Mon, 21 Oct 2013 20:13:21 GMT" }, { "location", "https://www.example.com" } });
+    EXPECT_EQ(decoder.table_size(), 222u);
+
+    expect_headers(decoder.decode(bytes_from_hex("4883640effc1c0bf")),
+        { { ":status", "307" }, { "cache-control", "private" }, { "date", "Mon, 21 Oct 2013 20:13:21 GMT" }, { "location", "https://www.example.com" } });
+    EXPECT_EQ(decoder.table_size(), 222u);
+}
+
+TEST_CASE(decode_malformed_blocks)
+{
+    HTTP::HPack::Decoder decoder;
+    // Index 0, an index past the end of both tables, and a literal that is cut short.
+    EXPECT(!decoder.decode(bytes_from_hex("80")).has_value());
+    EXPECT(!decoder.decode(bytes_from_hex("be")).has_value());
+    EXPECT(!decoder.decode(bytes_from_hex("410f7777772e")).has_value());
+    // A table size update past the limit, and one that isn't at the start of the block.
+    EXPECT(!decoder.decode(bytes_from_hex("3fe21f")).has_value());
+    EXPECT(!decoder.decode(bytes_from_hex("8220")).has_value());
+}
+
+TEST_CASE(decode_past_max_header_list_size)
+{
+    HTTP::HPack::Decoder decoder;
+    // ":method: GET" counts as 42 bytes, so two of them fit and three don't, even though the block is just 3 bytes.
+    decoder.set_max_header_list_size(100);
+    expect_headers(decoder.decode(bytes_from_hex("8282")), { { ":method", "GET" }, { ":method", "GET" } });
+    EXPECT(!decoder.exceeded_max_header_list_size());
+    EXPECT(!decoder.decode(bytes_from_hex("828282")).has_value());
+    EXPECT(decoder.exceeded_max_header_list_size());
+
+    // Literals count too, "a: bc" being 35 bytes.
+    HTTP::HPack::Decoder literal_decoder;
+    literal_decoder.set_max_header_list_size(34);
+    EXPECT(!literal_decoder.decode(bytes_from_hex("000161026263")).has_value());
+    EXPECT(literal_decoder.exceeded_max_header_list_size());
+}
+
+TEST_CASE(encode_round_trip)
+{
+    Vector<HTTP::HPack::Header> headers {
+        { ":method", "GET" },
+        { ":scheme", "https" },
+        { ":authority", "www.example.com" },
+        { ":path", "/some/resource?query=1" },
+        { "accept-encoding", "gzip, deflate" },
+        { "user-agent", "Mozilla/4.0 (SerenityOS; x86) LibWeb+LibJS (Not KHTML, nor Gecko) LibWeb" },
+        { "x-custom-header", String::repeated('x', 300) },
+    };
+    HTTP::HPack::Encoder encoder;
+    HTTP::HPack::Decoder decoder;
+    auto encoded = encoder.encode(headers);
+    expect_headers(decoder.decode(encoded), headers);
+    // Nothing the encoder sends may end up in the peer's dynamic table.
+    EXPECT_EQ(decoder.table_size(), 0u);
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <RequestServer/HttpCache.h>
+
+using RequestServer::CachedResponse;
+using RequestServer::HttpCache;
+
+using ResponseHeaders = HashMap<String, String, CaseInsensitiveStringTraits>;
+
+// The responses below arrive one second after they were requested, at this time.
+static constexpr time_t response_time = 1'000'000'000;
+
+struct Header {
+    String name;
+    String value;
+};
+
+static ResponseHeaders response_headers(std::initializer_list<Header> headers)
+{
+    ResponseHeaders result;
+    for (auto& header : headers)
+        result.set(header.name, header.value);
+    return result;
+}
+
+static HashMap<String, String> request_headers(std::initializer_list<Header> headers)
+{
+    HashMap<String, String> result;
+    for (auto& header : headers)
+        result.set(header.name, header.value);
+    return result;
+}
+
+static NonnullRefPtr<CachedResponse> create_response(ResponseHeaders headers, u32 status_code = 200)
+{
+    return CachedResponse::create(URL("http://example.com/"), status_code, move(headers), {}, ByteBuffer::copy("hello", 5), response_time - 1, response_time);
+}
+
+TEST_CASE(is_storable)
+{
+    auto max_age = response_headers({ { "Cache-Control", "max-age=60" } });
+    EXPECT(HttpCache::is_storable("GET", {}, 200, max_age));
+    EXPECT(!HttpCache::is_storable("POST", {}, 200, max_age));
+    EXPECT(!HttpCache::is_storable("GET", {}, 206, max_age));
+    EXPECT(!HttpCache::is_storable("GET", {}, 304, max_age));
+    EXPECT(!HttpCache::is_storable("GET", request_headers({ { "Cache-Control", "no-store" } }), 200, max_age));
+
+    EXPECT(!HttpCache::is_storable("GET", {}, 200, response_headers({ { "Cache-Control", "no-store, max-age=60" } })));
+    EXPECT(!HttpCache::is_storable("GET", {}, 200, response_headers({ { "Cache-Control", "private, max-age=60" } })));
+    EXPECT(!HttpCache::is_storable("GET", {}, 200, response_headers({ { "Cache-Control", "max-age=60" }, { "Vary", " * " } })));
+
+    // Responses to authenticated requests are only shared when the origin server allows it.
+    auto authorization = request_headers({ { "Authorization", "Basic Zm9vOmJhcg==" } });
+    EXPECT(!HttpCache::is_storable("GET", authorization, 200, max_age));
+    EXPECT(HttpCache::is_storable("GET", authorization, 200, response_headers({ { "Cache-Control", "public, max-age=60" } })));
+    EXPECT(HttpCache::is_storable("GET", authorization, 200, response_headers({ { "Cache-Control", "s-maxage=60" } })));
+
+    // Without explicit freshness information, only some status codes can be stored.
+    EXPECT(HttpCache::is_storable("GET", {}, 404, {}));
+    EXPECT(!HttpCache::is_storable("GET", {}, 302, {}));
+    EXPECT(HttpCache::is_storable("GET", {}, 302, max_age));
+}
+
+TEST_CASE(freshness_lifetime)
+{
+    EXPECT_EQ(create_response(response_headers({ { "Cache-Control", "max-age=60" } }))->freshness_lifetime(), 60);
+    // This is a shared cache, so s-maxage wins over max-age, and both win over Expires.
+    EXPECT_EQ(create_response(response_headers({ { "Cache-Control", "max-age=60, s-maxage=\"120\"" }, { "Expires", "Thu, 01 Jan 2015 00:00:00 GMT" } }))->freshness_lifetime(), 120);
+
+    EXPECT_EQ(create_response(response_headers({ { "Date", "Thu, 01 Jan 2015 00:00:00 GMT" }, { "Expires", "Thu, 01 Jan 2015 01:00:00 GMT" } }))->freshness_lifetime(), 3600);
+    EXPECT_EQ(create_response(response_headers({ { "Date", "Thu, 01 Jan 2015 01:00:00 GMT" }, { "Expires", "Thu, 01 Jan 2015 00:00:00 GMT" } }))->freshness_lifetime(), 0);
+    EXPECT_EQ(create_response(response_headers({ { "Expires", "0" } }))->freshness_lifetime(), 0);
+
+    // The heuristic is a tenth of the time since the last modification, for status codes that allow it.
+    auto last_modified = response_headers({ { "Date", "Thu, 11 Jan 2015 00:00:00 GMT" }, { "Last-Modified", "Thu, 01 Jan 2015 00:00:00 GMT" } });
+    EXPECT_EQ(create_response(last_modified)->freshness_lifetime(), 86400);
+    EXPECT_EQ(create_response(last_modified, 302)->freshness_lifetime(), 0);
+    EXPECT_EQ(create_response({})->freshness_lifetime(), 0);
+}
+
+TEST_CASE(is_fresh_for)
+{
+    auto response = create_response(response_headers({ { "Cache-Control", "max-age=60" } }));
+    // The response was already one second old when it arrived.
+    EXPECT(response->is_fresh_for({}, response_time));
+    EXPECT(response->is_fresh_for({}, response_time + 58));
+    EXPECT(!response->is_fresh_for({}, response_time + 59));
+
+    auto aged_response = create_response(response_headers({ { "Cache-Control", "max-age=60" }, { "Age", "30" } }));
+    EXPECT(aged_response->is_fresh_for({}, response_time + 28));
+    EXPECT(!aged_response->is_fresh_for({}, response_time + 29));
+
+    EXPECT(!response->is_fresh_for(request_headers({ { "Cache-Control", "no-cache" } }), response_time));
+    EXPECT(!response->is_fresh_for(request_headers({ { "Pragma", "no-cache" } }), response_time));
+    // Pragma is ignored when there is a Cache-Control header.
+    EXPECT(response->is_fresh_for(request_headers({ { "Cache-Control", "max-age=10" }, { "Pragma", "no-cache" } }), response_time));
+    EXPECT(!response->is_fresh_for(request_headers({ { "Cache-Control", "max-age=10" } }), response_time + 10));
+    EXPECT(response->is_fresh_for(request_headers({ { "Cache-Control", "min-fresh=20" } }), response_time + 39));
+    EXPECT(!response->is_fresh_for(request_headers({ { "Cache-Control", "min-fresh=20" } }), response_time + 40));
+
+    EXPECT(!create_response(response_headers({ { "Cache-Control", "no-cache, max-age=60" } }))->is_fresh_for({}, response_time));
+}
+
+TEST_CASE(revalidation)
+{
+    auto response = create_response(response_headers({ { "Cache-Control", "max-age=60" }, { "ETag", "\"v1\"" }, { "Last-Modified", "Thu, 01 Jan 2015 00:00:00 GMT" }, { "Content-Length", "5" } }));
+    auto now = response_time + 100;
+    EXPECT(!response->is_fresh_for({}, now));
+    EXPECT(response->has_validators());
+    EXPECT(!create_response(response_headers({ { "Cache-Control", "max-age=60" } }))->has_validators());
+
+    HashMap<String, String> headers;
+    response->add_validators_to(headers);
+    EXPECT_EQ(headers.get("If-None-Match"), "\"v1\"");
+    EXPECT_EQ(headers.get("If-Modified-Since"), "Thu, 01 Jan 2015 00:00:00 GMT");
+
+    // The 304 freshens the stored response, but its own framing headers don't replace the stored ones.
+    response->update_from_not_modified_response(response_headers({ { "Cache-Control", "max-age=300" }, { "Content-Length", "0" } }), now, now + 1);
+    EXPECT(response->is_fresh_for({}, now + 200));
+    EXPECT(!response->is_fresh_for({}, now + 300));
+    EXPECT_EQ(response->response_headers().get("Content-Length"), "5");
+    EXPECT_EQ(response->response_headers().get("ETag"), "\"v1\"");
+    EXPECT_EQ(response->body().size(), 5u);
+}
+
+TEST_CASE(store_and_lookup)
+{
+    auto& cache = HttpCache::the();
+    URL url("http://example.com/store_and_lookup");
+    cache.store("GET", url, {}, 200, response_headers({ { "Cache-Control", "max-age=60" } }), ByteBuffer::copy("hello", 5), response_time - 1, response_time);
+
+    auto response = cache.lookup("GET", url, {});
+    EXPECT(response);
+    EXPECT_EQ(response->status_code(), 200u);
+    EXPECT_EQ(StringView(response->body().bytes()), "hello");
+
+    // Conditional and range requests always go to the origin server, as does anything but GET.
+    EXPECT(!cache.lookup("GET", url, request_headers({ { "If-None-Match", "\"v1\"" } })));
+    EXPECT(!cache.lookup("GET", url, request_headers({ { "Range", "bytes=0-1" } })));
+    EXPECT(!cache.lookup("HEAD", url, {}));
+    EXPECT(!cache.lookup("GET", URL("http://example.com/somewhere_else"), {}));
+
+    cache.invalidate(url);
+    EXPECT(!cache.lookup("GET", url, {}));
+}
+
+TEST_CASE(responses_that_would_never_be_used_are_not_stored)
+{
+    auto& cache = HttpCache::the();
+    URL url("http://example.com/never_used");
+    cache.store("GET", url, {}, 200, {}, ByteBuffer::copy("hello", 5), response_time - 1, response_time);
+    EXPECT(!cache.lookup("GET", url, {}));
+
+    // Once it can be revalidated, it is worth keeping.
+    cache.store("GET", url, {}, 200, response_headers({ { "ETag", "\"v1\"" } }), ByteBuffer::copy("hello", 5), response_time - 1, response_time);
+    EXPECT(cache.lookup("GET", url, {}));
+}
+
+TEST_CASE(vary)
+{
+    auto& cache = HttpCache::the();
+    URL url("http://example.com/vary");
+    cache.store("GET", url, request_headers({ { "accept-language", "de" } }), 200, response_headers({ { "Cache-Control", "max-age=60" }, { "Vary", "Accept-Language, Accept-Encoding" } }), ByteBuffer::copy("hallo", 5), response_time - 1, response_time);
+
+    EXPECT(cache.lookup("GET", url, request_headers({ { "Accept-Language", "de" } })));
+    EXPECT(!cache.lookup("GET", url, request_headers({ { "Accept-Language", "en" } })));
+    EXPECT(!cache.lookup("GET", url, request_headers({ { "Accept-Language", "de" }, { "Accept-Encoding", "gzip" } })));
+    EXPECT(!cache.lookup("GET", url, {}));
+}
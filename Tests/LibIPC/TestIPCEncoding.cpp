@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/ByteBuffer.h>
+#include <AK/HashMap.h>
+#include <AK/MemoryStream.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibIPC/Decoder.h>
+#include <LibIPC/Encoder.h>
+
+template<typename T>
+static T round_trip(T const& value)
+{
+    IPC::MessageBuffer buffer;
+    IPC::Encoder encoder(buffer);
+    encoder << value;
+
+    InputMemoryStream stream { buffer.data };
+    IPC::Decoder decoder { stream, -1 };
+    T decoded {};
+    EXPECT(decoder.decode(decoded));
+    EXPECT_EQ(stream.remaining(), 0u);
+    return decoded;
+}
+
+TEST_CASE(strings)
+{
+    EXPECT(round_trip(String {}).is_null());
+    EXPECT_EQ(round_trip(String::empty()), String::empty());
+    EXPECT_EQ(round_trip(String("Well hello friends!")), "Well hello friends!");
+}
+
+TEST_CASE(byte_vectors)
+{
+    Vector<u8> bytes;
+    for (size_t i = 0; i < 1000; ++i)
+        bytes.append(i * 7);
+    EXPECT_EQ(round_trip(bytes), bytes);
+    EXPECT(round_trip(Vector<u8> {}).is_empty());
+}
+
+TEST_CASE(nested_vectors)
+{
+    Vector<Vector<String>> rows;
+    for (size_t i = 0; i < 10; ++i) {
+        Vector<String> row;
+        for (size_t j = 0; j < i; ++j)
+            row.append(String::number(i * j));
+        rows.append(move(row));
+    }
+    auto decoded = round_trip(rows);
+    EXPECT_EQ(decoded.size(), rows.size());
+    for (size_t i = 0; i < rows.size(); ++i)
+        EXPECT_EQ(decoded[i], rows[i]);
+}
+
+TEST_CASE(truncated_input)
+{
+    IPC::MessageBuffer buffer;
+    IPC::Encoder encoder(buffer);
+    encoder << Vector<u8> { 1, 2, 3, 4 };
+    buffer.data.resize(buffer.data.size() - 1);
+
+    InputMemoryStream stream { buffer.data };
+    IPC::Decoder decoder { stream, -1 };
+    Vector<u8> decoded;
+    EXPECT(!decoder.decode(decoded));
+}
+
+TEST_CASE(bogus_vector_size)
+{
+    IPC::MessageBuffer buffer;
+    IPC::Encoder encoder(buffer);
+    encoder << (u64)NumericLimits<i32>::max() << (u32)1;
+
+    InputMemoryStream stream { buffer.data };
+    IPC::Decoder decoder { stream, -1 };
+    Vector<u32> decoded;
+    EXPECT(!decoder.decode(decoded));
+}
+
+BENCHMARK_CASE(encode_and_decode_small_messages)
+{
+    IPC::MessageBuffer buffer;
+    for (size_t i = 0; i < 1'000'000; ++i) {
+        buffer.data.clear_with_capacity();
+        IPC::Encoder encoder(buffer);
+        encoder << (i32)i << (u32)4 << String("about:blank") << true;
+
+        InputMemoryStream stream { buffer.data };
+        IPC::Decoder decoder { stream, -1 };
+        i32 id;
+        u32 kind;
+        String url;
+        bool flag;
+        EXPECT(decoder.decode(id) && decoder.decode(kind) && decoder.decode(url) && decoder.decode(flag));
+    }
+}
+
+BENCHMARK_CASE(encode_and_decode_byte_vectors)
+{
+    Vector<u8> bytes;
+    bytes.resize(64 * KiB);
+    IPC::MessageBuffer buffer;
+    for (size_t i = 0; i < 10'000; ++i) {
+        buffer.data.clear_with_capacity();
+        IPC::Encoder encoder(buffer);
+        encoder << bytes;
+
+        InputMemoryStream stream { buffer.data };
+        IPC::Decoder decoder { stream, -1 };
+        Vector<u8> decoded;
+        EXPECT(decoder.decode(decoded));
+    }
+}
+
+BENCHMARK_CASE(encode_and_decode_string_vectors)
+{
+    Vector<String> strings;
+    for (size_t i = 0; i < 1000; ++i)
+        strings.append(String::formatted("Entry number {}", i));
+    IPC::MessageBuffer buffer;
+    for (size_t i = 0; i < 1000; ++i) {
+        buffer.data.clear_with_capacity();
+        IPC::Encoder encoder(buffer);
+        encoder << strings;
+
+        InputMemoryStream stream { buffer.data };
+        IPC::Decoder decoder { stream, -1 };
+        Vector<String> decoded;
+        EXPECT(decoder.decode(decoded));
+    }
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <LibJS/Interpreter.h>
+#include <LibJS/Lexer.h>
+#include <LibJS/Parser.h>
+#include <LibJS/Runtime/GlobalObject.h>
+#include <LibJS/Runtime/VM.h>
+
+static void run_script(StringView source)
+{
+    auto vm = JS::VM::create();
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
+    JS::VM::InterpreterExecutionScope scope(*interpreter);
+
+    auto parser = JS::Parser(JS::Lexer(source));
+    auto program = parser.parse_program();
+    EXPECT(!parser.has_errors());
+    if (parser.has_errors())
+        return;
+
+    interpreter->run(interpreter->global_object(), *program);
+    EXPECT(!vm->exception());
+    if (vm->exception())
+        vm->clear_exception();
+}
+
+BENCHMARK_CASE(arithmetic_loop)
+{
+    run_script(R"(
+        let sum = 0;
+        for (let i = 0; i < 200000; ++i)
+            sum = (sum + i * 3) % 1000003;
+        if (sum !== 520003) throw new Error("wrong sum " + sum);
+    )"sv);
+}
+
+BENCHMARK_CASE(function_calls_and_closures)
+{
+    run_script(R"(
+        function fib(n) { return n < 2 ? n : fib(n - 1) + fib(n - 2); }
+        const add = x => y => x + y;
+        let total = 0;
+        for (let i = 0; i < 10000; ++i)
+            total = add(total)(1);
+        if (fib(20) !== 6765 || total !== 10000) throw new Error("wrong result");
+    )"sv);
+}
+
+BENCHMARK_CASE(objects_arrays_and_strings)
+{
+    run_script(R"(
+        const objects = [];
+        for (let i = 0; i < 10000; ++i)
+            objects.push({ id: i, name: "item" + i });
+        const names = objects.filter(o => o.id % 2 === 0).map(o => o.name).join(",");
+        if (names.split(",").length !== 5000) throw new Error("wrong count");
+    )"sv);
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <LibCore/File.h>
+#include <LibJS/Bytecode/ExecutableCache.h>
+#include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Interpreter.h>
+#include <LibJS/Lexer.h>
+#include <LibJS/Parser.h>
+#include <LibJS/Runtime/GlobalObject.h>
+#include <LibJS/Runtime/VM.h>
+#include <stdlib.h>
+
+static constexpr auto source = R"(
+    function outer() {
+        function inner(x) { return x * 2; }
+        var twenty = function () { return 20; };
+        return inner(twenty());
+    }
+    var result = outer() + (function () { return 2; })();
+)"sv;
+
+// Runs the source through the bytecode interpreter with the given cache, and returns whether the executable came out of it.
+static bool run_with_cache(String const& cache_directory, bool parse_lazily)
+{
+    auto vm = JS::VM::create();
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
+    JS::VM::InterpreterExecutionScope scope(*interpreter);
+
+    auto parser = JS::Parser(JS::Lexer(source));
+    parser.set_parse_function_bodies_lazily(parse_lazily);
+    auto program = parser.parse_program();
+    EXPECT(!parser.has_errors());
+    if (parser.has_errors())
+        return false;
+
+    JS::Bytecode::ExecutableCache cache(cache_directory);
+    auto cached_executable = cache.load(source, *program, false);
+    bool is_cached = cached_executable.has_value();
+    auto executable = is_cached ? cached_executable.release_value() : JS::Bytecode::Generator::generate(*program);
+    if (!is_cached)
+        cache.store(source, *program, executable, false);
+
+    JS::Bytecode::Interpreter bytecode_interpreter(interpreter->global_object());
+    bytecode_interpreter.run(executable);
+    EXPECT(!vm->exception());
+    if (vm->exception()) {
+        vm->clear_exception();
+        return is_cached;
+    }
+    EXPECT_EQ(interpreter->global_object().get("result").as_i32(), 42);
+    return is_cached;
+}
+
+TEST_CASE(eager_and_lazy_parses_keep_separate_entries)
+{
+    char directory_template[] = "/tmp/js-bytecode-cache.XXXXXX";
+    auto* cache_directory = mkdtemp(directory_template);
+    VERIFY(cache_directory);
+
+    // Nested functions aren't numbered when their enclosing body is parsed lazily, so neither run may
+    // pick up the executable of the other, nor replace it.
+    EXPECT(!run_with_cache(cache_directory, false));
+    EXPECT(!run_with_cache(cache_directory, true));
+    EXPECT(run_with_cache(cache_directory, false));
+    EXPECT(run_with_cache(cache_directory, true));
+
+    auto result = Core::File::remove(cache_directory, Core::File::RecursionMode::Allowed, true);
+    EXPECT(!result.is_error());
+}
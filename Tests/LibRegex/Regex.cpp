@@ -678,3 +678,72 @@ TEST_CASE(case_insensitive_match)
         EXPECT_EQ(result.matches.at(0).column, 4ul);
     }
 }
+
+TEST_CASE(literal_prefix_search)
+{
+    Regex<PosixExtended> re("needle[0-9]");
+    EXPECT(re.optimization_data.literal_prefix.size() == 6);
+    RegexResult result;
+    EXPECT_EQ(re.search("hay needle hay needle4 hay needle7", result, PosixFlags::Global), true);
+    EXPECT_EQ(result.count, 2u);
+    if (result.count == 2u) {
+        EXPECT_EQ(result.matches.at(0).view, "needle4");
+        EXPECT_EQ(result.matches.at(1).view, "needle7");
+    }
+    EXPECT_EQ(re.search("hay needle hay", result, PosixFlags::Global), false);
+}
+
+TEST_CASE(anchored_search)
+{
+    Regex<PosixExtended> re("^ab");
+    EXPECT(re.optimization_data.anchored_at_start);
+    RegexResult result;
+    EXPECT_EQ(re.search("cab", result), false);
+    EXPECT_EQ(re.search("abab", result), true);
+    EXPECT_EQ(result.count, 1u);
+    EXPECT_EQ(re.search("cd\nab", result, PosixFlags::Multiline), true);
+}
+
+TEST_CASE(single_character_alternation)
+{
+    Regex<ECMA262> re("x(a|b|[0-9])y");
+    EXPECT_EQ(re.parser_result.error, Error::NoError);
+    EXPECT_EQ(re.match("xay").success, true);
+    EXPECT_EQ(re.match("x7y").success, true);
+    EXPECT_EQ(re.match("xcy").success, false);
+    auto result = re.match("xby");
+    EXPECT_EQ(result.success, true);
+    if (result.success)
+        EXPECT_EQ(result.capture_group_matches.at(0).at(0).view, "b");
+}
+
+TEST_CASE(match_without_backtracking)
+{
+    // Backtracking tries every way of splitting the a's between the alternatives before it gives up.
+    Regex<ECMA262> re("(a|aa)*b");
+    EXPECT(re.optimization_data.can_match_without_backtracking);
+    String haystack = String::repeated('a', 100);
+    EXPECT_EQ(re.match(haystack).success, false);
+    auto result = re.match(String::formatted("{}b", haystack));
+    EXPECT_EQ(result.success, true);
+    if (result.success) {
+        EXPECT_EQ(result.matches.at(0).view.length(), 101u);
+        EXPECT_EQ(result.capture_group_matches.at(0).at(0).view, "a");
+    }
+
+    Regex<ECMA262> empty_loop("(a*)*b");
+    EXPECT_EQ(empty_loop.match("aaaab").success, true);
+
+    Regex<ECMA262> named("(?<year>\\d{4})-(?<month>\\d{2})");
+    result = named.match("1999-01");
+    EXPECT_EQ(result.success, true);
+    if (result.success) {
+        EXPECT_EQ(result.named_capture_group_matches.at(0).ensure("year").view, "1999");
+        EXPECT_EQ(result.named_capture_group_matches.at(0).ensure("month").view, "01");
+    }
+
+    Regex<ECMA262> backreference("(a)\\1");
+    EXPECT(!backreference.optimization_data.can_match_without_backtracking);
+    Regex<ECMA262> lookahead("a(?=b)");
+    EXPECT(!lookahead.optimization_data.can_match_without_backtracking);
+}
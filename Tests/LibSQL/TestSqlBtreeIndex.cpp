@@ -123,6 +123,8 @@ constexpr static u32 pointers[] = {
 NonnullRefPtr<SQL::BTree> setup_btree(SQL::Heap& heap);
 void insert_and_get_to_and_from_btree(int num_keys);
 void insert_into_and_scan_btree(int num_keys);
+void verify_btree_contents(SQL::BTree&, int num_keys, int step);
+void bulk_load_and_verify_btree(int num_keys);
 
 NonnullRefPtr<SQL::BTree> setup_btree(SQL::Heap& heap)
 {
@@ -309,3 +311,134 @@ TEST_CASE(btree_scan_50_keys)
 {
     insert_into_and_scan_btree(50);
 }
+
+// Verifies that the tree holds the keys 0, step, 2 * step, ... each pointing to the block with its value plus one.
+void verify_btree_contents(SQL::BTree& btree, int num_keys, int step)
+{
+    int count = 0;
+    for (auto iter = btree.begin(); !iter.is_end(); iter++, count++) {
+        auto key = (*iter);
+        EXPECT_EQ((int)key[0], count * step);
+        EXPECT_EQ(key.pointer(), (u32)(count * step + 1));
+    }
+    EXPECT_EQ(count, num_keys);
+
+    for (auto ix = 0; ix < num_keys; ix += 7) {
+        SQL::Key k(btree.descriptor());
+        k[0] = ix * step;
+        auto pointer_opt = btree.get(k);
+        EXPECT(pointer_opt.has_value());
+        EXPECT_EQ(pointer_opt.value(), (u32)(ix * step + 1));
+    }
+}
+
+void bulk_load_and_verify_btree(int num_keys)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        auto btree = setup_btree(heap);
+        Vector<SQL::Key> sorted_keys;
+        for (auto ix = 0; ix < num_keys; ix++) {
+            SQL::Key k(btree->descriptor());
+            k[0] = 2 * ix;
+            k.set_pointer(2 * ix + 1);
+            sorted_keys.append(k);
+        }
+        EXPECT(btree->bulk_load(sorted_keys));
+        verify_btree_contents(btree, num_keys, 2);
+    }
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        auto btree = setup_btree(heap);
+        verify_btree_contents(btree, num_keys, 2);
+
+        // Fill in the odd keys between the bulk loaded ones, which splits the packed nodes.
+        for (auto ix = 0; ix < num_keys; ix++) {
+            SQL::Key k(btree->descriptor());
+            k[0] = 2 * ix + 1;
+            k.set_pointer(2 * ix + 2);
+            EXPECT(btree->insert(k));
+        }
+        verify_btree_contents(btree, 2 * num_keys, 1);
+    }
+}
+
+TEST_CASE(btree_bulk_load_one_key)
+{
+    bulk_load_and_verify_btree(1);
+}
+
+TEST_CASE(btree_bulk_load_1000_keys)
+{
+    bulk_load_and_verify_btree(1000);
+}
+
+TEST_CASE(btree_bulk_load_10000_keys)
+{
+    bulk_load_and_verify_btree(10000);
+}
+
+TEST_CASE(btree_bulk_load_rejects_unsorted_keys)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    auto heap = SQL::Heap::construct("/tmp/test.db");
+    auto btree = setup_btree(heap);
+    Vector<SQL::Key> unsorted_keys;
+    for (auto value : { 1, 3, 2 }) {
+        SQL::Key k(btree->descriptor());
+        k[0] = value;
+        unsorted_keys.append(k);
+    }
+    EXPECT(!btree->bulk_load(unsorted_keys));
+}
+
+TEST_CASE(btree_insert_many_keys)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    constexpr int num_keys = 5000;
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        auto btree = setup_btree(heap);
+
+        // Visit the keys in a scattered order; 2039 is a prime that doesn't divide num_keys.
+        for (auto ix = 0; ix < num_keys; ix++) {
+            auto value = (ix * 2039) % num_keys;
+            SQL::Key k(btree->descriptor());
+            k[0] = value;
+            k.set_pointer(value + 1);
+            EXPECT(btree->insert(k));
+        }
+    }
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        auto btree = setup_btree(heap);
+        verify_btree_contents(btree, num_keys, 1);
+    }
+}
+
+TEST_CASE(btree_prefix_compressed_text_keys)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    constexpr int num_keys = 1000;
+    auto heap = SQL::Heap::construct("/tmp/test.db");
+    SQL::TupleDescriptor tuple_descriptor;
+    tuple_descriptor.append({ "key_value", SQL::SQLType::Text, SQL::Order::Ascending });
+    auto root_pointer = heap->new_record_pointer();
+    auto btree = SQL::BTree::construct(heap, tuple_descriptor, true, root_pointer);
+
+    for (auto ix = 0; ix < num_keys; ix++) {
+        SQL::Key k(btree->descriptor());
+        k[0] = String::formatted("common_prefix_{:05}", ix);
+        k.set_pointer(ix + 1);
+        EXPECT(btree->insert(k));
+    }
+
+    // Stored in full, a node would only hold 13 of these keys, and the tree would need over 100 blocks.
+    EXPECT(heap->new_record_pointer() - root_pointer < 40u);
+
+    int count = 0;
+    for (auto iter = btree->begin(); !iter.is_end(); iter++, count++)
+        EXPECT_EQ((*iter)[0].to_string().value(), String::formatted("common_prefix_{:05}", count));
+    EXPECT_EQ(count, num_keys);
+}
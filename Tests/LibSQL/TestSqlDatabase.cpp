@@ -7,6 +7,8 @@
 #include <unistd.h>
 
 #include <AK/ScopeGuard.h>
+#include <LibCore/EventLoop.h>
+#include <LibCore/File.h>
 #include <LibSQL/BTree.h>
 #include <LibSQL/Database.h>
 #include <LibSQL/Heap.h>
@@ -20,6 +22,9 @@ NonnullRefPtr<SQL::SchemaDef> setup_table(SQL::Database&);
 void insert_into_table(SQL::Database&, int);
 void verify_table_contents(SQL::Database&, int);
 void insert_and_verify(int);
+void copy_file(String const&, String const&);
+void write_numbered_blocks(SQL::Heap&, u32);
+void verify_numbered_blocks(SQL::Heap&, u32);
 
 NonnullRefPtr<SQL::SchemaDef> setup_schema(SQL::Database& db)
 {
@@ -93,6 +98,37 @@ void insert_and_verify(int count)
     }
 }
 
+void copy_file(String const& from, String const& to)
+{
+    auto from_file = Core::File::open(from, Core::OpenMode::ReadOnly);
+    EXPECT(!from_file.is_error());
+    auto to_file = Core::File::open(to, Core::OpenMode::WriteOnly | Core::OpenMode::Truncate);
+    EXPECT(!to_file.is_error());
+    auto contents = from_file.value()->read_all();
+    EXPECT(to_file.value()->write(contents.data(), contents.size()));
+}
+
+void write_numbered_blocks(SQL::Heap& heap, u32 count)
+{
+    for (u32 ix = 0; ix < count; ix++) {
+        auto block = heap.new_record_pointer();
+        auto buffer = ByteBuffer::create_zeroed(sizeof(u32));
+        buffer.overwrite(0, &block, sizeof(u32));
+        EXPECT(heap.write_block(block, buffer));
+    }
+}
+
+void verify_numbered_blocks(SQL::Heap& heap, u32 count)
+{
+    for (u32 block = 1; block <= count; block++) {
+        auto buffer_or_error = heap.read_block(block);
+        EXPECT(!buffer_or_error.is_error());
+        u32 value = 0;
+        memcpy(&value, buffer_or_error.value().data(), sizeof(u32));
+        EXPECT_EQ(value, block);
+    }
+}
+
 TEST_CASE(create_heap)
 {
     ScopeGuard guard([]() { unlink("/tmp/test.db"); });
@@ -174,3 +210,118 @@ TEST_CASE(insert_100_into_table)
 {
     insert_and_verify(100);
 }
+
+TEST_CASE(insert_1000_into_table)
+{
+    insert_and_verify(1000);
+}
+
+TEST_CASE(evict_dirty_pages_from_heap)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    constexpr u32 block_count = 100;
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        heap->set_cache_capacity(8);
+        write_numbered_blocks(heap, block_count);
+        EXPECT(heap->cached_page_count() <= 8u);
+
+        // Blocks that were evicted before the heap was flushed are read back from the log.
+        verify_numbered_blocks(heap, block_count);
+        EXPECT(heap->cached_page_count() <= 8u);
+        heap->flush();
+    }
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        EXPECT_EQ(heap->size(), block_count + 1);
+        verify_numbered_blocks(heap, block_count);
+    }
+}
+
+TEST_CASE(recover_committed_blocks_from_write_ahead_log)
+{
+    ScopeGuard guard([]() {
+        unlink("/tmp/test.db");
+        unlink("/tmp/crash.db");
+        unlink("/tmp/crash.db-wal");
+    });
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        write_numbered_blocks(heap, 10);
+        heap->flush();
+        EXPECT(!heap->write_ahead_log().is_empty());
+
+        // These are evicted into the log, but never committed.
+        heap->set_cache_capacity(2);
+        write_numbered_blocks(heap, 10);
+        EXPECT(heap->write_ahead_log().has_uncommitted_frames());
+
+        // Take a copy of the files as they would be found if the system went down now.
+        copy_file("/tmp/test.db", "/tmp/crash.db");
+        copy_file("/tmp/test.db-wal", "/tmp/crash.db-wal");
+    }
+
+    // A frame that was only partially written.
+    auto wal_file = Core::File::open("/tmp/crash.db-wal", Core::OpenMode::WriteOnly | Core::OpenMode::Append);
+    EXPECT(!wal_file.is_error());
+    EXPECT(wal_file.value()->write("SWAL"));
+    wal_file.value()->close();
+
+    {
+        auto heap = SQL::Heap::construct("/tmp/crash.db");
+        verify_numbered_blocks(heap, 10);
+        EXPECT(!heap->write_ahead_log().has_uncommitted_frames());
+        EXPECT_EQ(heap->new_record_pointer(), 11u);
+    }
+    {
+        // The log was checkpointed into the heap file when it was closed.
+        EXPECT_NE(access("/tmp/crash.db-wal", F_OK), 0);
+        auto heap = SQL::Heap::construct("/tmp/crash.db");
+        EXPECT_EQ(heap->size(), 11u);
+        verify_numbered_blocks(heap, 10);
+    }
+}
+
+TEST_CASE(checkpoint_write_ahead_log)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    auto heap = SQL::Heap::construct("/tmp/test.db");
+    write_numbered_blocks(heap, 10);
+    heap->flush();
+    EXPECT(heap->checkpoint());
+    EXPECT(heap->write_ahead_log().is_empty());
+    EXPECT_EQ(heap->size(), 11u);
+    verify_numbered_blocks(heap, 10);
+
+    // Once the log has enough frames in it, committing checkpoints it.
+    write_numbered_blocks(heap, SQL::Heap::checkpoint_threshold);
+    heap->flush();
+    EXPECT(heap->write_ahead_log().is_empty());
+    verify_numbered_blocks(heap, SQL::Heap::checkpoint_threshold + 10);
+}
+
+TEST_CASE(group_commit)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    Core::EventLoop loop;
+    auto heap = SQL::Heap::construct("/tmp/test.db");
+
+    int durable_commits = 0;
+    write_numbered_blocks(heap, 1);
+    heap->commit([&](bool success) {
+        EXPECT(success);
+        durable_commits++;
+    });
+    write_numbered_blocks(heap, 1);
+    heap->commit([&](bool success) {
+        EXPECT(success);
+        durable_commits++;
+    });
+
+    // Both transactions are in the log, but neither is reported as durable before the log has been synced.
+    EXPECT(!heap->write_ahead_log().has_uncommitted_frames());
+    EXPECT_EQ(durable_commits, 0);
+    loop.pump(Core::EventLoop::WaitMode::PollForEvents);
+    EXPECT_EQ(durable_commits, 2);
+    verify_numbered_blocks(heap, 2);
+}
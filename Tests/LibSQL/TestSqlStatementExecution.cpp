@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <unistd.h>
+
+#include <AK/ScopeGuard.h>
+#include <LibSQL/AST/Lexer.h>
+#include <LibSQL/AST/Parser.h>
+#include <LibSQL/Database.h>
+#include <LibSQL/Meta.h>
+#include <LibSQL/Row.h>
+#include <LibSQL/SQLResult.h>
+#include <LibTest/TestCase.h>
+
+namespace {
+
+constexpr const char* db_name = "/tmp/test.db";
+
+RefPtr<SQL::SQLResult> execute(NonnullRefPtr<SQL::Database> database, String const& sql)
+{
+    auto parser = SQL::AST::Parser(SQL::AST::Lexer(sql));
+    auto statement = parser.next_statement();
+    EXPECT(!parser.has_errors());
+    if (parser.has_errors())
+        warnln("{}", parser.errors()[0].to_string());
+    auto result = statement->execute(move(database));
+    if (result->error().code != SQL::SQLErrorCode::NoError)
+        warnln("{}", result->error().to_string());
+    return result;
+}
+
+void create_schema(NonnullRefPtr<SQL::Database> database)
+{
+    auto result = execute(database, "CREATE SCHEMA TestSchema;");
+    EXPECT(result->error().code == SQL::SQLErrorCode::NoError);
+}
+
+void create_table(NonnullRefPtr<SQL::Database> database)
+{
+    create_schema(database);
+    auto result = execute(database, "CREATE TABLE TestSchema.TestTable ( TextColumn text, IntColumn integer );");
+    EXPECT(result->error().code == SQL::SQLErrorCode::NoError);
+}
+
+void insert_rows(NonnullRefPtr<SQL::Database> database, int count)
+{
+    for (int ix = 0; ix < count; ++ix) {
+        auto result = execute(database, String::formatted("INSERT INTO TestSchema.TestTable VALUES ( 'Test{}', {} );", ix, ix));
+        EXPECT(result->error().code == SQL::SQLErrorCode::NoError);
+        EXPECT(result->inserted() == 1);
+    }
+}
+
+}
+
+TEST_CASE(insert_into_table)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    create_table(database);
+    auto result = execute(database, "INSERT INTO TestSchema.TestTable ( TextColumn, IntColumn ) VALUES ( 'Test', 42 ), ( 'Test2', 43 );");
+    EXPECT(result->error().code == SQL::SQLErrorCode::NoError);
+    EXPECT(result->inserted() == 2);
+
+    auto table = database->get_table("TESTSCHEMA", "TESTTABLE");
+    EXPECT(table);
+    auto rows = database->select_all(*table);
+    EXPECT_EQ(rows.size(), 2u);
+}
+
+TEST_CASE(insert_wrong_number_of_values)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    create_table(database);
+    auto result = execute(database, "INSERT INTO TestSchema.TestTable VALUES ( 42 );");
+    EXPECT(result->error().code == SQL::SQLErrorCode::InvalidNumberOfValues);
+    EXPECT(result->inserted() == 0);
+}
+
+TEST_CASE(insert_wrong_data_type)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    create_table(database);
+    auto result = execute(database, "INSERT INTO TestSchema.TestTable VALUES ( 'Test', 'Not a number' );");
+    EXPECT(result->error().code == SQL::SQLErrorCode::InvalidType);
+
+    auto table = database->get_table("TESTSCHEMA", "TESTTABLE");
+    EXPECT(database->select_all(*table).is_empty());
+}
+
+TEST_CASE(insert_into_nonexistent_table)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    create_schema(database);
+    auto result = execute(database, "INSERT INTO TestSchema.NoTable VALUES ( 'Test', 42 );");
+    EXPECT(result->error().code == SQL::SQLErrorCode::TableDoesNotExist);
+}
+
+TEST_CASE(select_from_table)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    create_table(database);
+    insert_rows(database, 5);
+    auto result = execute(database, "SELECT * FROM TestSchema.TestTable;");
+    EXPECT(result->error().code == SQL::SQLErrorCode::NoError);
+    EXPECT(result->has_results());
+    EXPECT_EQ(result->results().size(), 5u);
+    for (auto& row : result->results()) {
+        EXPECT_EQ(row.length(), 2u);
+        EXPECT_EQ(row["TEXTCOLUMN"].to_string().value(), String::formatted("Test{}", row["INTCOLUMN"].to_int().value()));
+    }
+}
+
+TEST_CASE(select_with_where_clause)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    create_table(database);
+    insert_rows(database, 10);
+    auto result = execute(database, "SELECT TextColumn FROM TestSchema.TestTable WHERE ( IntColumn > 3 ) AND ( ( IntColumn % 2 ) = 0 );");
+    EXPECT(result->error().code == SQL::SQLErrorCode::NoError);
+    EXPECT_EQ(result->results().size(), 3u);
+    for (auto& row : result->results()) {
+        EXPECT_EQ(row.length(), 1u);
+        auto text = row[0].to_string().value();
+        EXPECT(text == "Test4" || text == "Test6" || text == "Test8");
+    }
+}
+
+TEST_CASE(select_expressions)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    create_table(database);
+    insert_rows(database, 3);
+    auto result = execute(database, "SELECT ( IntColumn * 2 ) + 1, ( TextColumn || '!' ), ( IntColumn / 2.5 ) FROM TestSchema.TestTable WHERE IntColumn = 2;");
+    EXPECT(result->error().code == SQL::SQLErrorCode::NoError);
+    EXPECT_EQ(result->results().size(), 1u);
+    auto& row = result->results()[0];
+    EXPECT_EQ(row[0].type(), SQL::SQLType::Integer);
+    EXPECT_EQ(row[0].to_int().value(), 5);
+    EXPECT_EQ(row[1].to_string().value(), "Test2!");
+    EXPECT_EQ(row[2].type(), SQL::SQLType::Float);
+    EXPECT_EQ(row[2].to_double().value(), 0.8);
+}
+
+TEST_CASE(select_without_from)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    auto result = execute(database, "SELECT 6 * 7, 1 / 0, 'a' < 'b', NULL ISNULL;");
+    EXPECT(result->error().code == SQL::SQLErrorCode::NoError);
+    EXPECT_EQ(result->results().size(), 1u);
+    auto& row = result->results()[0];
+    EXPECT_EQ(row[0].to_int().value(), 42);
+    EXPECT(row[1].is_null());
+    EXPECT_EQ(row[2].to_int().value(), 1);
+    EXPECT_EQ(row[3].to_int().value(), 1);
+}
+
+TEST_CASE(select_with_limit_and_offset)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    create_table(database);
+    insert_rows(database, 3000);
+    auto result = execute(database, "SELECT IntColumn FROM TestSchema.TestTable WHERE IntColumn >= 1000 LIMIT 1500 OFFSET 100;");
+    EXPECT(result->error().code == SQL::SQLErrorCode::NoError);
+    EXPECT_EQ(result->results().size(), 1500u);
+    for (auto& row : result->results())
+        EXPECT(row[0].to_int().value() >= 1000);
+
+    result = execute(database, "SELECT * FROM TestSchema.TestTable WHERE IntColumn < 10 LIMIT 100;");
+    EXPECT_EQ(result->results().size(), 10u);
+}
+
+TEST_CASE(select_nonexistent_column)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    create_table(database);
+    insert_rows(database, 1);
+    auto result = execute(database, "SELECT NoColumn FROM TestSchema.TestTable;");
+    EXPECT(result->error().code == SQL::SQLErrorCode::ColumnDoesNotExist);
+    result = execute(database, "SELECT * FROM TestSchema.TestTable WHERE NoColumn = 1;");
+    EXPECT(result->error().code == SQL::SQLErrorCode::ColumnDoesNotExist);
+}
+
+TEST_CASE(select_unsupported_clauses)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    create_table(database);
+    auto result = execute(database, "SELECT * FROM TestSchema.TestTable ORDER BY IntColumn;");
+    EXPECT(result->error().code == SQL::SQLErrorCode::NotYetImplemented);
+    result = execute(database, "SELECT * FROM TestSchema.TestTable, TestSchema.TestTable;");
+    EXPECT(result->error().code == SQL::SQLErrorCode::NotYetImplemented);
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/MemoryStream.h>
+#include <LibTest/TestCase.h>
+#include <LibThreading/ReadAheadStream.h>
+
+static ByteBuffer make_test_data(size_t size)
+{
+    auto data = ByteBuffer::create_uninitialized(size);
+    for (size_t i = 0; i < size; ++i)
+        data[i] = i * 7 % 251;
+    return data;
+}
+
+TEST_CASE(read_ahead_stream_reads_everything_in_order)
+{
+    auto data = make_test_data(100'000);
+    InputMemoryStream memory_stream { data };
+    Threading::ReadAheadStream stream { memory_stream, 4096, 3 };
+
+    ByteBuffer result;
+    u8 buffer[1000];
+    size_t nread;
+    while ((nread = stream.read({ buffer, sizeof(buffer) })) > 0)
+        result.append(buffer, nread);
+    EXPECT(stream.unreliable_eof());
+    EXPECT(!stream.has_any_error());
+    EXPECT(result == data);
+}
+
+TEST_CASE(read_ahead_stream_discards)
+{
+    auto data = make_test_data(10'000);
+    InputMemoryStream memory_stream { data };
+    Threading::ReadAheadStream stream { memory_stream, 1024, 2 };
+
+    u8 byte;
+    EXPECT(stream.discard_or_error(5000));
+    EXPECT(stream.read_or_error({ &byte, 1 }));
+    EXPECT_EQ(byte, data[5000]);
+    EXPECT(stream.discard_or_error(4999));
+    EXPECT(!stream.read_or_error({ &byte, 1 }));
+    EXPECT(stream.handle_any_error());
+}
+
+TEST_CASE(read_ahead_stream_can_be_destroyed_before_the_end)
+{
+    auto data = make_test_data(1'000'000);
+    InputMemoryStream memory_stream { data };
+    Threading::ReadAheadStream stream { memory_stream, 1024, 2 };
+    u8 byte;
+    EXPECT(stream.read_or_error({ &byte, 1 }));
+}
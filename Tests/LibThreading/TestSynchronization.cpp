@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <AK/NonnullRefPtrVector.h>
+#include <LibTest/TestCase.h>
+#include <LibThreading/ConditionVariable.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/RWLock.h>
+#include <LibThreading/Thread.h>
+#include <unistd.h>
+
+TEST_CASE(rwlock_lets_readers_in_together)
+{
+    Threading::RWLock lock;
+    Atomic<int> readers_inside { 0 };
+    Atomic<int> most_readers_inside { 0 };
+
+    NonnullRefPtrVector<Threading::Thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.append(Threading::Thread::construct([&] {
+            Threading::RWLockReadLocker locker(lock);
+            auto inside = readers_inside.fetch_add(1) + 1;
+            auto most = most_readers_inside.load();
+            while (inside > most && !most_readers_inside.compare_exchange_strong(most, inside))
+                ;
+            usleep(50 * 1000);
+            readers_inside.fetch_sub(1);
+            return 0;
+        }));
+    }
+    for (auto& thread : threads)
+        thread.start();
+    for (auto& thread : threads)
+        (void)thread.join();
+
+    EXPECT(most_readers_inside.load() > 1);
+}
+
+TEST_CASE(rwlock_keeps_writers_exclusive)
+{
+    Threading::RWLock lock;
+    int first = 0;
+    int second = 0;
+    Atomic<bool> saw_torn_write { false };
+
+    NonnullRefPtrVector<Threading::Thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.append(Threading::Thread::construct([&, i] {
+            for (int j = 0; j < 10000; ++j) {
+                if (i % 2) {
+                    Threading::RWLockWriteLocker locker(lock);
+                    ++first;
+                    ++second;
+                } else {
+                    Threading::RWLockReadLocker locker(lock);
+                    if (first != second)
+                        saw_torn_write = true;
+                }
+            }
+            return 0;
+        }));
+    }
+    for (auto& thread : threads)
+        thread.start();
+    for (auto& thread : threads)
+        (void)thread.join();
+
+    EXPECT(!saw_torn_write.load());
+    EXPECT_EQ(first, 20000);
+}
+
+TEST_CASE(condition_variable_wakes_waiter)
+{
+    Threading::Mutex mutex;
+    Threading::ConditionVariable condition;
+    bool ready = false;
+
+    auto thread = Threading::Thread::construct([&] {
+        usleep(10 * 1000);
+        Threading::MutexLocker locker(mutex);
+        ready = true;
+        condition.signal();
+        return 0;
+    });
+    thread->start();
+
+    {
+        Threading::MutexLocker locker(mutex);
+        condition.wait_while(mutex, [&] { return !ready; });
+        EXPECT(ready);
+    }
+    (void)thread->join();
+}
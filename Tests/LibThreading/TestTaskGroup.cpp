@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/Atomic.h>
+#include <AK/Vector.h>
+#include <LibTest/TestCase.h>
+#include <LibThreading/Future.h>
+#include <LibThreading/TaskGroup.h>
+
+TEST_CASE(task_group_runs_every_task)
+{
+    Atomic<size_t> counter { 0 };
+    Threading::TaskGroup group;
+    for (size_t i = 0; i < 1000; ++i)
+        group.spawn([&counter] { counter.fetch_add(1); });
+    group.wait();
+    EXPECT_EQ(counter.load(), 1000u);
+}
+
+TEST_CASE(task_group_can_be_waited_for_from_a_task)
+{
+    Atomic<size_t> counter { 0 };
+    Threading::TaskGroup outer;
+    for (size_t i = 0; i < 16; ++i) {
+        outer.spawn([&counter] {
+            Threading::TaskGroup inner;
+            for (size_t j = 0; j < 16; ++j)
+                inner.spawn([&counter] { counter.fetch_add(1); });
+        });
+    }
+    outer.wait();
+    EXPECT_EQ(counter.load(), 256u);
+}
+
+TEST_CASE(parallel_for_visits_every_index_once)
+{
+    Array<Atomic<u32>, 10007> visits {};
+    Threading::parallel_for(0, visits.size(), [&](size_t i) { visits[i].fetch_add(1); });
+    for (auto& visit : visits)
+        EXPECT_EQ(visit.load(), 1u);
+
+    Threading::parallel_for(5, 5, [](size_t) { FAIL("called for an empty range"); });
+}
+
+TEST_CASE(future_computes_its_value)
+{
+    Threading::Future<int> future { [] { return 42; } };
+    EXPECT_EQ(future.await(), 42);
+    EXPECT_EQ(future.await(), 42);
+}
+
+static u64 sum_of_squares_up_to(size_t limit)
+{
+    u64 sum = 0;
+    for (size_t i = 0; i < limit; ++i)
+        sum += i * i % 7;
+    return sum;
+}
+
+static constexpr size_t benchmark_rows = 512;
+static constexpr size_t benchmark_row_length = 100000;
+
+BENCHMARK_CASE(rows_serially)
+{
+    Vector<u64> results;
+    results.resize(benchmark_rows);
+    for (size_t row = 0; row < benchmark_rows; ++row)
+        results[row] = sum_of_squares_up_to(benchmark_row_length + row);
+    EXPECT_EQ(results[0], sum_of_squares_up_to(benchmark_row_length));
+}
+
+BENCHMARK_CASE(rows_with_parallel_for)
+{
+    Vector<u64> results;
+    results.resize(benchmark_rows);
+    Threading::parallel_for(0, benchmark_rows, [&](size_t row) {
+        results[row] = sum_of_squares_up_to(benchmark_row_length + row);
+    });
+    EXPECT_EQ(results[0], sum_of_squares_up_to(benchmark_row_length));
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Array.h>
+#include <LibVideo/VP9/BitStream.h>
+
+TEST_CASE(read_fixed_width_values_at_a_byte_boundary)
+{
+    Array<u8, 7> const data { 0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde };
+    Video::VP9::BitStream stream(data.data(), data.size());
+
+    EXPECT_EQ(stream.read_f8(), 0x12);
+    EXPECT_EQ(stream.read_f16(), 0x3456);
+    EXPECT_EQ(stream.read_f32(), 0x789abcdeu);
+    EXPECT_EQ(stream.bytes_remaining(), 0u);
+}
+
+TEST_CASE(read_fixed_width_values_between_bytes)
+{
+    // A single bit, followed by 0x81, 0x0203 and 0x04050607, all shifted one bit to the right.
+    Array<u8, 8> const data { 0xc0, 0x81, 0x01, 0x82, 0x02, 0x83, 0x03, 0x80 };
+    Video::VP9::BitStream stream(data.data(), data.size());
+
+    EXPECT(stream.read_bit());
+    EXPECT_EQ(stream.read_f8(), 0x81);
+    EXPECT_EQ(stream.read_f16(), 0x0203);
+    EXPECT_EQ(stream.read_f32(), 0x04050607u);
+    EXPECT_EQ(stream.read_f(7), 0);
+}
+
+TEST_CASE(read_f_keeps_bits_in_order)
+{
+    Array<u8, 2> const data { 0b10110011, 0b01000000 };
+    Video::VP9::BitStream stream(data.data(), data.size());
+
+    EXPECT_EQ(stream.read_f(3), 0b101);
+    EXPECT_EQ(stream.read_f(6), 0b100110);
+    EXPECT_EQ(stream.read_f(2), 0b10);
+}
+
+TEST_CASE(split_off)
+{
+    Array<u8, 4> const data { 0x11, 0x22, 0x33, 0x44 };
+    Video::VP9::BitStream stream(data.data(), data.size());
+
+    EXPECT_EQ(stream.read_f8(), 0x11);
+    auto tile = stream.split_off(2);
+    EXPECT(tile.has_value());
+    EXPECT_EQ(tile->bytes_remaining(), 2u);
+    EXPECT_EQ(tile->read_f16(), 0x2233);
+
+    // The split off bytes are skipped in the original stream.
+    EXPECT_EQ(stream.bytes_remaining(), 1u);
+    EXPECT_EQ(stream.read_f8(), 0x44);
+
+    // Sizes that point past the end of the stream fail instead of asserting.
+    EXPECT(!stream.split_off(1).has_value());
+}
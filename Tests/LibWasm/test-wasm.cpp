@@ -66,6 +66,7 @@ public:
 private:
     JS_DECLARE_NATIVE_FUNCTION(get_export);
     JS_DECLARE_NATIVE_FUNCTION(wasm_invoke);
+    JS_DECLARE_NATIVE_FUNCTION(wasm_invoke_interpreted);
 
     static HashMap<Wasm::Linker::Name, Wasm::ExternValue> const& spec_test_namespace()
     {
@@ -160,6 +161,7 @@ void WebAssemblyModule::initialize(JS::GlobalObject& global_object)
     Base::initialize(global_object);
     define_native_function("getExport", get_export, 1, JS::default_attributes);
     define_native_function("invoke", wasm_invoke, 1, JS::default_attributes);
+    define_native_function("invokeInterpreted", wasm_invoke_interpreted, 1, JS::default_attributes);
 }
 
 JS_DEFINE_NATIVE_FUNCTION(WebAssemblyModule::get_export)
@@ -198,7 +200,28 @@ JS_DEFINE_NATIVE_FUNCTION(WebAssemblyModule::get_export)
     return {};
 }
 
+// Runs functions one instruction at a time, even those that have been compiled, so tests can check that both ways
+// of running a function agree.
+struct InstructionByInstructionInterpreter final : public Wasm::BytecodeInterpreter {
+private:
+    virtual bool can_run_compiled_code() const override { return false; }
+};
+
+static JS::Value invoke_with(JS::VM&, JS::GlobalObject&, Wasm::Interpreter&);
+
 JS_DEFINE_NATIVE_FUNCTION(WebAssemblyModule::wasm_invoke)
+{
+    Wasm::BytecodeInterpreter interpreter;
+    return invoke_with(vm, global_object, interpreter);
+}
+
+JS_DEFINE_NATIVE_FUNCTION(WebAssemblyModule::wasm_invoke_interpreted)
+{
+    InstructionByInstructionInterpreter interpreter;
+    return invoke_with(vm, global_object, interpreter);
+}
+
+static JS::Value invoke_with(JS::VM& vm, JS::GlobalObject& global_object, Wasm::Interpreter& interpreter)
 {
     auto address = static_cast<unsigned long>(vm.argument(0).to_double(global_object));
     if (vm.exception())
@@ -253,7 +276,7 @@ JS_DEFINE_NATIVE_FUNCTION(WebAssemblyModule::wasm_invoke)
         }
     }
 
-    auto result = WebAssemblyModule::machine().invoke(function_address, arguments);
+    auto result = WebAssemblyModule::machine().invoke(interpreter, function_address, arguments);
     if (result.is_trap()) {
         vm.throw_exception<JS::TypeError>(global_object, String::formatted("Execution trapped: {}", result.trap().reason));
         return {};
@@ -76,6 +76,27 @@ static Vector<Token> run_tokenizer(StringView const& input)
     return tokens;
 }
 
+static Vector<Token> run_tokenizer_in_pieces(StringView const& input, size_t piece_size)
+{
+    Vector<Token> tokens;
+    Tokenizer tokenizer { ""sv, "UTF-8"sv };
+    auto take_tokens = [&] {
+        while (true) {
+            auto maybe_token = tokenizer.next_token();
+            if (!maybe_token.has_value())
+                break;
+            tokens.append(maybe_token.release_value());
+        }
+    };
+    for (size_t offset = 0; offset < input.length(); offset += piece_size) {
+        tokenizer.append_input(input.substring_view(offset, min(piece_size, input.length() - offset)));
+        take_tokens();
+    }
+    tokenizer.insert_eof();
+    take_tokens();
+    return tokens;
+}
+
 // FIXME: It's not very nice to rely on the format of HTMLToken::to_string() to stay the same.
 static u32 hash_tokens(Vector<Token> const& tokens)
 {
@@ -197,6 +218,17 @@ TEST_CASE(doctype)
     EXPECT_END_TAG_TOKEN(html);
 }
 
+TEST_CASE(input_in_pieces)
+{
+    // Every piece size splits something: tags, attributes, comments, character references and multi-byte code points.
+    auto input = "<!DOCTYPE html><p class=\"a b\" id='x'>caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80 &amp; &amp &notit; &CounterClockwiseContourIntegral; &#x41;</p><!-- comment --><script>if (a < b) {}</script><br/>"sv;
+    auto expected_tokens = run_tokenizer(input);
+    for (size_t piece_size = 1; piece_size <= 8; ++piece_size) {
+        auto tokens = run_tokenizer_in_pieces(input, piece_size);
+        EXPECT_EQ(hash_tokens(tokens), hash_tokens(expected_tokens));
+    }
+}
+
 // NOTE: This relies on the format of HTMLToken::to_string() staying the same.
 //       If that changes, or something is added to the test HTML, the hash needs to be adjusted.
 TEST_CASE(regression)
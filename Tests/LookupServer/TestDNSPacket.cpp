@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Vector.h>
+#include <LookupServer/DNSPacket.h>
+
+using LookupServer::DNSAnswer;
+using LookupServer::DNSPacket;
+using LookupServer::DNSRecordClass;
+using LookupServer::DNSRecordType;
+
+// Builds the responses to an A query for "nowhere.example" that an upstream nameserver might send.
+class ResponseBuilder {
+public:
+    ResponseBuilder& set_code(DNSPacket::Code code)
+    {
+        m_code = code;
+        return *this;
+    }
+
+    ResponseBuilder& add_a_record(u32 ttl)
+    {
+        append_name(m_answers, "nowhere.example");
+        append_u16(m_answers, (u16)DNSRecordType::A);
+        append_u16(m_answers, (u16)DNSRecordClass::IN);
+        append_u32(m_answers, ttl);
+        append_u16(m_answers, 4);
+        m_answers.append(Array<u8, 4> { 192, 0, 2, 1 }.data(), 4);
+        ++m_answer_count;
+        return *this;
+    }
+
+    ResponseBuilder& add_soa_record(u32 ttl, u32 minimum)
+    {
+        Vector<u8> data;
+        append_name(data, "ns.example");
+        append_name(data, "hostmaster.example");
+        for (u32 value : { 2021u, 7200u, 3600u, 1209600u, minimum })
+            append_u32(data, value);
+
+        append_name(m_authorities, "example");
+        append_u16(m_authorities, (u16)DNSRecordType::SOA);
+        append_u16(m_authorities, (u16)DNSRecordClass::IN);
+        append_u32(m_authorities, ttl);
+        append_u16(m_authorities, data.size());
+        m_authorities.extend(data);
+        ++m_authority_count;
+        return *this;
+    }
+
+    Vector<u8> build() const
+    {
+        Vector<u8> packet;
+        append_u16(packet, 0x1234);
+        // A response to a query that desired recursion, and got it.
+        append_u16(packet, 0x8180 | (u8)m_code);
+        append_u16(packet, 1);
+        append_u16(packet, m_answer_count);
+        append_u16(packet, m_authority_count);
+        append_u16(packet, 0);
+        append_name(packet, "nowhere.example");
+        append_u16(packet, (u16)DNSRecordType::A);
+        append_u16(packet, (u16)DNSRecordClass::IN);
+        packet.extend(m_answers);
+        packet.extend(m_authorities);
+        return packet;
+    }
+
+private:
+    static void append_u16(Vector<u8>& bytes, u16 value)
+    {
+        bytes.append(value >> 8);
+        bytes.append(value);
+    }
+
+    static void append_u32(Vector<u8>& bytes, u32 value)
+    {
+        append_u16(bytes, value >> 16);
+        append_u16(bytes, value);
+    }
+
+    static void append_name(Vector<u8>& bytes, StringView name)
+    {
+        for (auto label : name.split_view('.')) {
+            bytes.append(label.length());
+            bytes.append((u8 const*)label.characters_without_null_termination(), label.length());
+        }
+        bytes.append(0);
+    }
+
+    DNSPacket::Code m_code { DNSPacket::Code::NOERROR };
+    Vector<u8> m_answers;
+    u16 m_answer_count { 0 };
+    Vector<u8> m_authorities;
+    u16 m_authority_count { 0 };
+};
+
+static Optional<DNSPacket> parse(Vector<u8> const& bytes)
+{
+    return DNSPacket::from_raw_packet(bytes.data(), bytes.size());
+}
+
+TEST_CASE(nxdomain_with_soa)
+{
+    auto packet = parse(ResponseBuilder().set_code(DNSPacket::Code::NXDOMAIN).add_soa_record(900, 300).build());
+    EXPECT(packet.has_value());
+    EXPECT(packet->code() == DNSPacket::Code::NXDOMAIN);
+    EXPECT_EQ(packet->question_count(), 1);
+    EXPECT(packet->questions()[0].record_type() == DNSRecordType::A);
+    EXPECT_EQ(packet->answer_count(), 0);
+    // RFC 2308, 5: The smaller of the SOA's own TTL and its MINIMUM field.
+    EXPECT_EQ(packet->negative_ttl(), 300u);
+
+    packet = parse(ResponseBuilder().set_code(DNSPacket::Code::NXDOMAIN).add_soa_record(60, 300).build());
+    EXPECT(packet.has_value());
+    EXPECT_EQ(packet->negative_ttl(), 60u);
+}
+
+TEST_CASE(nodata_with_soa)
+{
+    auto packet = parse(ResponseBuilder().add_soa_record(900, 300).build());
+    EXPECT(packet.has_value());
+    EXPECT(packet->code() == DNSPacket::Code::NOERROR);
+    EXPECT_EQ(packet->answer_count(), 0);
+    EXPECT_EQ(packet->negative_ttl(), 300u);
+}
+
+TEST_CASE(answers_before_the_authority_section)
+{
+    auto packet = parse(ResponseBuilder().add_a_record(120).add_soa_record(900, 300).build());
+    EXPECT(packet.has_value());
+    EXPECT_EQ(packet->answer_count(), 1);
+    EXPECT(packet->answers()[0].type() == DNSRecordType::A);
+    EXPECT_EQ(packet->answers()[0].ttl(), 120u);
+    EXPECT_EQ(packet->negative_ttl(), 300u);
+}
+
+TEST_CASE(no_negative_ttl_without_soa)
+{
+    // RFC 2308, 5: Negative responses without an SOA mustn't be cached.
+    auto packet = parse(ResponseBuilder().set_code(DNSPacket::Code::NXDOMAIN).build());
+    EXPECT(packet.has_value());
+    EXPECT(packet->code() == DNSPacket::Code::NXDOMAIN);
+    EXPECT(!packet->negative_ttl().has_value());
+
+    packet = parse(ResponseBuilder().build());
+    EXPECT(packet.has_value());
+    EXPECT(!packet->negative_ttl().has_value());
+}
+
+TEST_CASE(no_negative_ttl_for_server_failures)
+{
+    auto packet = parse(ResponseBuilder().set_code(DNSPacket::Code::SERVFAIL).add_soa_record(900, 300).build());
+    EXPECT(packet.has_value());
+    EXPECT(packet->code() == DNSPacket::Code::SERVFAIL);
+    EXPECT(!packet->negative_ttl().has_value());
+}
+
+TEST_CASE(truncated_soa)
+{
+    auto bytes = ResponseBuilder().set_code(DNSPacket::Code::NXDOMAIN).add_soa_record(900, 300).build();
+    // Cut off the middle of the MINIMUM field.
+    bytes.resize(bytes.size() - 2);
+    auto packet = parse(bytes);
+    EXPECT(packet.has_value());
+    EXPECT(!packet->negative_ttl().has_value());
+}
+
+TEST_CASE(remaining_ttl)
+{
+    DNSAnswer answer({ "nowhere.example" }, DNSRecordType::A, DNSRecordClass::IN, 60, "", false);
+    EXPECT(answer.remaining_ttl() <= 60u);
+    EXPECT(answer.remaining_ttl() >= 59u);
+
+    DNSAnswer expired_answer({ "nowhere.example" }, DNSRecordType::A, DNSRecordClass::IN, 0, "", false);
+    EXPECT_EQ(expired_answer.remaining_ttl(), 0u);
+    EXPECT(expired_answer.has_expired());
+}
@@ -26,6 +26,10 @@ void PDFViewer::set_document(RefPtr<PDF::Document> document)
     m_current_page_index = document->get_first_page_index();
     m_zoom_level = initial_zoom_level;
     m_rendered_page_list.clear();
+    if (m_page_render_action) {
+        m_page_render_action->cancel();
+        m_page_render_action = nullptr;
+    }
 
     m_rendered_page_list.ensure_capacity(document->get_page_count());
     for (u32 i = 0; i < document->get_page_count(); i++)
@@ -41,9 +45,32 @@ RefPtr<Gfx::Bitmap> PDFViewer::get_rendered_page(u32 index)
     if (existing_rendered_page.has_value())
         return existing_rendered_page.value();
 
-    auto rendered_page = render_page(m_document->get_page(index));
-    rendered_page_map.set(m_zoom_level, rendered_page);
-    return rendered_page;
+    render_page_in_background(index);
+    return {};
+}
+
+void PDFViewer::render_page_in_background(u32 index)
+{
+    // A Document can only be used by one thread at a time, so pages are rendered one after the other. Once
+    // this one is done, the next paint asks for whichever page is wanted then.
+    if (m_page_render_action)
+        return;
+
+    auto zoom_level = m_zoom_level;
+    auto zoom_scale_factor = static_cast<float>(zoom_levels[zoom_level]) / 100.0f;
+    auto height = static_cast<float>(this->height() - 2 * frame_thickness() - PAGE_PADDING * 2) * zoom_scale_factor;
+
+    m_page_render_action = Threading::BackgroundAction<RefPtr<Gfx::Bitmap>>::create(
+        [document = m_document, index, height](auto&) mutable {
+            return render_page(*document, document->get_page(index), height);
+        },
+        [this, weak_this = make_weak_ptr(), document = m_document, index, zoom_level](auto rendered_page) {
+            if (!weak_this || m_document != document)
+                return;
+            m_page_render_action = nullptr;
+            m_rendered_page_list[index].set(zoom_level, move(rendered_page));
+            update();
+        });
 }
 
 void PDFViewer::paint_event(GUI::PaintEvent& event)
@@ -59,6 +86,8 @@ void PDFViewer::paint_event(GUI::PaintEvent& event)
         return;
 
     auto page = get_rendered_page(m_current_page_index);
+    if (!page)
+        return;
     set_content_size(page->size());
 
     painter.translate(frame_thickness(), frame_thickness());
@@ -135,19 +164,18 @@ void PDFViewer::zoom_out()
         m_zoom_level--;
 }
 
-RefPtr<Gfx::Bitmap> PDFViewer::render_page(const PDF::Page& page)
+RefPtr<Gfx::Bitmap> PDFViewer::render_page(PDF::Document& document, const PDF::Page& page, float height)
 {
-    auto zoom_scale_factor = static_cast<float>(zoom_levels[m_zoom_level]) / 100.0f;
-
     auto page_width = page.media_box.upper_right_x - page.media_box.lower_left_x;
     auto page_height = page.media_box.upper_right_y - page.media_box.lower_left_y;
     auto page_scale_factor = page_height / page_width;
 
-    auto height = static_cast<float>(this->height() - 2 * frame_thickness() - PAGE_PADDING * 2) * zoom_scale_factor;
     auto width = height / page_scale_factor;
     auto bitmap = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, { width, height });
+    if (!bitmap)
+        return {};
 
-    PDF::Renderer::render(*m_document, page, bitmap);
+    PDF::Renderer::render(document, page, bitmap);
 
     if (page.rotate != 0) {
         int rotation_count = (page.rotate / 90) % 4;
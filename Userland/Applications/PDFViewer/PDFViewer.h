@@ -10,6 +10,7 @@
 #include <LibGUI/AbstractScrollableWidget.h>
 #include <LibGfx/Bitmap.h>
 #include <LibPDF/Document.h>
+#include <LibThreading/BackgroundAction.h>
 
 static constexpr u16 zoom_levels[] = {
     17,
@@ -58,7 +59,8 @@ protected:
 
 private:
     RefPtr<Gfx::Bitmap> get_rendered_page(u32 index);
-    RefPtr<Gfx::Bitmap> render_page(const PDF::Page&);
+    void render_page_in_background(u32 index);
+    static RefPtr<Gfx::Bitmap> render_page(PDF::Document&, const PDF::Page&, float height);
 
     void zoom_in();
     void zoom_out();
@@ -66,6 +68,7 @@ private:
     RefPtr<PDF::Document> m_document;
     u32 m_current_page_index { 0 };
     Vector<HashMap<u32, RefPtr<Gfx::Bitmap>>> m_rendered_page_list;
+    RefPtr<Threading::BackgroundAction<RefPtr<Gfx::Bitmap>>> m_page_render_action;
 
     u8 m_zoom_level { initial_zoom_level };
 };
@@ -522,9 +522,15 @@ public:
         for (auto& message : endpoint.messages) {
             auto message_generator = endpoint_generator.fork();
 
-            auto do_implement_proxy = [&](String const& name, Vector<Parameter> const& parameters, bool is_synchronous, bool is_try) {
+            auto do_implement_proxy = [&](String const& name, Vector<Parameter> const& parameters, bool is_synchronous, bool is_try, bool is_promise = false) {
                 String return_type = "void";
-                if (is_synchronous) {
+                if (is_promise) {
+                    StringBuilder builder;
+                    builder.append("NonnullRefPtr<Core::Promise<NonnullOwnPtr<");
+                    builder.append(message_name(endpoint.name, message.name, true));
+                    builder.append(">>>");
+                    return_type = builder.to_string();
+                } else if (is_synchronous) {
                     if (message.outputs.size() == 1)
                         return_type = message.outputs[0].type;
                     else if (!message.outputs.is_empty())
@@ -541,12 +547,13 @@ public:
                 message_generator.set("message.name", message.name);
                 message_generator.set("message.pascal_name", pascal_case(message.name));
                 message_generator.set("message.complex_return_type", return_type);
-                message_generator.set("async_prefix_maybe", is_synchronous ? "" : "async_");
+                message_generator.set("async_prefix_maybe", is_synchronous || is_promise ? "" : "async_");
                 message_generator.set("try_prefix_maybe", is_try ? "try_" : "");
+                message_generator.set("promise_prefix_maybe", is_promise ? "promise_" : "");
 
                 message_generator.set("handler_name", name);
                 message_generator.append(R"~~~(
-    @message.complex_return_type@ @try_prefix_maybe@@async_prefix_maybe@@handler_name@()~~~");
+    @message.complex_return_type@ @try_prefix_maybe@@promise_prefix_maybe@@async_prefix_maybe@@handler_name@()~~~");
 
                 for (size_t i = 0; i < parameters.size(); ++i) {
                     auto& parameter = parameters[i];
@@ -560,7 +567,10 @@ public:
 
                 message_generator.append(") {");
 
-                if (is_synchronous && !is_try) {
+                if (is_promise) {
+                    message_generator.append(R"~~~(
+        return m_connection.template send_with_promise<Messages::@endpoint.name@::@message.pascal_name@>()~~~");
+                } else if (is_synchronous && !is_try) {
                     if (return_type != "void") {
                         message_generator.append(R"~~~(
         return )~~~");
@@ -575,6 +585,10 @@ public:
                 } else if (is_try) {
                     message_generator.append(R"~~~(
         auto result = m_connection.template send_sync_but_allow_failure<Messages::@endpoint.name@::@message.pascal_name@>()~~~");
+                } else if (message.is_synchronous) {
+                    // The response to this will arrive anyway, and must not be mistaken for that of a later request.
+                    message_generator.append(R"~~~(
+        m_connection.post_message_and_ignore_response(Messages::@endpoint.name@::@message.pascal_name@ { )~~~");
                 } else {
                     message_generator.append(R"~~~(
         m_connection.post_message(Messages::@endpoint.name@::@message.pascal_name@ { )~~~");
@@ -592,7 +606,9 @@ public:
                         argument_generator.append(", ");
                 }
 
-                if (is_synchronous && !is_try) {
+                if (is_promise) {
+                    message_generator.append(");");
+                } else if (is_synchronous && !is_try) {
                     if (return_type != "void") {
                         message_generator.append(")");
                     }
@@ -633,6 +649,7 @@ public:
             if (message.is_synchronous) {
                 do_implement_proxy(message.name, message.inputs, false, false);
                 do_implement_proxy(message.name, message.inputs, true, true);
+                do_implement_proxy(message.name, message.inputs, false, false, true);
             }
         }
 
@@ -16,6 +16,7 @@
 #include <AK/RefPtr.h>
 #include <LibCore/File.h>
 #include <LibELF/Image.h>
+#include <LibPerfcore/Reader.h>
 #include <LibSymbolication/Symbolication.h>
 #include <sys/stat.h>
 
@@ -31,9 +32,10 @@ static void sort_profile_nodes(Vector<NonnullRefPtr<ProfileNode>>& nodes)
         child->sort_children();
 }
 
-Profile::Profile(Vector<Process> processes, Vector<Event> events)
+Profile::Profile(Vector<Process> processes, Vector<Event> events, Vector<Vector<Frame>> stacks)
     : m_processes(move(processes))
     , m_events(move(events))
+    , m_stacks(move(stacks))
 {
     m_first_timestamp = m_events.first().timestamp;
     m_last_timestamp = m_events.last().timestamp;
@@ -83,6 +85,7 @@ void Profile::rebuild_tree()
     });
 
     m_filtered_event_indices.clear();
+    m_total_off_cpu_time = 0;
 
     for (size_t event_index = 0; event_index < m_events.size(); ++event_index) {
         auto& event = m_events.at(event_index);
@@ -104,15 +107,24 @@ void Profile::rebuild_tree()
         if (event.type == "free"sv)
             continue;
 
+        u32 weight = 1;
+        if (m_show_off_cpu_time) {
+            if (event.type != "context_switch"sv || !event.off_cpu_time)
+                continue;
+            weight = event.off_cpu_time;
+            m_total_off_cpu_time += weight;
+        }
+
+        auto& frames = m_stacks[event.stack_id];
         auto for_each_frame = [&]<typename Callback>(Callback callback) {
             if (!m_inverted) {
-                for (size_t i = 0; i < event.frames.size(); ++i) {
-                    if (callback(event.frames.at(i), i == event.frames.size() - 1) == IterationDecision::Break)
+                for (size_t i = 0; i < frames.size(); ++i) {
+                    if (callback(frames.at(i), i == frames.size() - 1) == IterationDecision::Break)
                         break;
                 }
             } else {
-                for (ssize_t i = event.frames.size() - 1; i >= 0; --i) {
-                    if (callback(event.frames.at(i), static_cast<size_t>(i) == event.frames.size() - 1) == IterationDecision::Break)
+                for (ssize_t i = frames.size() - 1; i >= 0; --i) {
+                    if (callback(frames.at(i), static_cast<size_t>(i) == frames.size() - 1) == IterationDecision::Break)
                         break;
                 }
             }
@@ -121,7 +133,7 @@ void Profile::rebuild_tree()
         if (!m_show_top_functions) {
             ProfileNode* node = nullptr;
             auto& process_node = find_or_create_process_node(event.pid, event.serial);
-            process_node.increment_event_count();
+            process_node.increment_event_count(weight);
             for_each_frame([&](const Frame& frame, bool is_innermost_frame) {
                 auto& object_name = frame.object_name;
                 auto& symbol = frame.symbol;
@@ -136,21 +148,21 @@ void Profile::rebuild_tree()
                     node = &process_node;
                 node = &node->find_or_create_child(object_name, symbol, address, offset, event.timestamp, event.pid);
 
-                node->increment_event_count();
+                node->increment_event_count(weight);
                 if (is_innermost_frame) {
-                    node->add_event_address(address);
-                    node->increment_self_count();
+                    node->add_event_address(address, weight);
+                    node->increment_self_count(weight);
                 }
                 return IterationDecision::Continue;
             });
         } else {
             auto& process_node = find_or_create_process_node(event.pid, event.serial);
-            process_node.increment_event_count();
-            for (size_t i = 0; i < event.frames.size(); ++i) {
+            process_node.increment_event_count(weight);
+            for (size_t i = 0; i < frames.size(); ++i) {
                 ProfileNode* node = nullptr;
                 ProfileNode* root = nullptr;
-                for (size_t j = i; j < event.frames.size(); ++j) {
-                    auto& frame = event.frames.at(j);
+                for (size_t j = i; j < frames.size(); ++j) {
+                    auto& frame = frames.at(j);
                     auto& object_name = frame.object_name;
                     auto& symbol = frame.symbol;
                     auto& address = frame.address;
@@ -170,14 +182,14 @@ void Profile::rebuild_tree()
 
                     if (!root->has_seen_event(event_index)) {
                         root->did_see_event(event_index);
-                        root->increment_event_count();
+                        root->increment_event_count(weight);
                     } else if (node != root) {
-                        node->increment_event_count();
+                        node->increment_event_count(weight);
                     }
 
-                    if (j == event.frames.size() - 1) {
-                        node->add_event_address(address);
-                        node->increment_self_count();
+                    if (j == frames.size() - 1) {
+                        node->add_event_address(address, weight);
+                        node->increment_self_count(weight);
                     }
                 }
             }
@@ -190,83 +202,134 @@ void Profile::rebuild_tree()
     m_model->update();
 }
 
-Result<NonnullOwnPtr<Profile>, String> Profile::load_from_perfcore_file(const StringView& path)
-{
-    auto file = Core::File::construct(path);
-    if (!file->open(Core::OpenMode::ReadOnly))
-        return String::formatted("Unable to open {}, error: {}", path, file->error_string());
+namespace {
+
+// A stack as it was captured, before symbolication. The same addresses can mean different things in different processes.
+struct RawStack {
+    Process const* process { nullptr };
+    Vector<FlatPtr> addresses;
+
+    bool operator==(RawStack const& other) const
+    {
+        return process == other.process && addresses == other.addresses;
+    }
+};
+
+}
+
+}
 
-    auto json = JsonValue::from_string(file->read_all());
-    if (!json.has_value() || !json.value().is_object())
-        return String { "Invalid perfcore format (not a JSON object)" };
+template<>
+struct AK::Traits<Profiler::RawStack> : public GenericTraits<Profiler::RawStack> {
+    static unsigned hash(Profiler::RawStack const& stack)
+    {
+        unsigned hash = ptr_hash(stack.process);
+        for (auto address : stack.addresses)
+            hash = pair_int_hash(hash, ptr_hash(address));
+        return hash;
+    }
+};
 
-    auto& object = json.value().as_object();
+namespace Profiler {
+
+Result<NonnullOwnPtr<Profile>, String> Profile::load_from_perfcore_file(const StringView& path)
+{
+    // Regular files are mapped, but /proc/<pid>/perf_events can only be read.
+    ByteBuffer contents;
+    ReadonlyBytes bytes;
+    auto mapped_file_or_error = MappedFile::map(path);
+    if (!mapped_file_or_error.is_error()) {
+        bytes = mapped_file_or_error.value()->bytes();
+    } else {
+        auto file = Core::File::construct(path);
+        if (!file->open(Core::OpenMode::ReadOnly))
+            return String::formatted("Unable to open {}, error: {}", path, file->error_string());
+        contents = file->read_all();
+        bytes = contents.bytes();
+    }
 
     auto file_or_error = MappedFile::map("/boot/Kernel.debug");
     OwnPtr<ELF::Image> kernel_elf;
     if (!file_or_error.is_error())
         kernel_elf = make<ELF::Image>(file_or_error.value()->bytes());
 
-    auto events_value = object.get_ptr("events");
-    if (!events_value || !events_value->is_array())
-        return String { "Malformed profile (events is not an array)" };
-
-    auto& perf_events = events_value->as_array();
-
     NonnullOwnPtrVector<Process> all_processes;
     HashMap<pid_t, Process*> current_processes;
     Vector<Event> events;
+    Vector<Vector<Frame>> stacks;
+    HashMap<RawStack, u32> stack_ids;
     EventSerialNumber next_serial;
 
-    for (auto& perf_event_value : perf_events.values()) {
-        auto& perf_event = perf_event_value.as_object();
+    auto maybe_kernel_base = Symbolication::kernel_base();
+
+    auto symbolicate = [&](Process* process, Vector<FlatPtr> const& addresses) {
+        Vector<Frame> frames;
+        frames.ensure_capacity(addresses.size());
+        for (ssize_t i = addresses.size() - 1; i >= 0; --i) {
+            auto ptr = addresses[i];
+            u32 offset = 0;
+            FlyString object_name;
+            String symbol;
+
+            if (maybe_kernel_base.has_value() && ptr >= maybe_kernel_base.value()) {
+                if (kernel_elf) {
+                    symbol = kernel_elf->symbolicate(ptr - maybe_kernel_base.value(), &offset);
+                } else {
+                    symbol = String::formatted("?? <{:p}>", ptr);
+                }
+            } else {
+                // FIXME: This logic is kinda gnarly, find a way to clean it up.
+                LibraryMetadata* library_metadata = process ? &process->library_metadata : nullptr;
+                if (auto* library = library_metadata ? library_metadata->library_containing(ptr) : nullptr) {
+                    object_name = library->name;
+                    symbol = library->symbolicate(ptr, &offset);
+                } else {
+                    symbol = String::formatted("?? <{:p}>", ptr);
+                }
+            }
+
+            frames.append({ object_name, symbol, ptr, offset });
+        }
+        return frames;
+    };
 
+    Perfcore::Reader reader(bytes);
+    auto result = reader.for_each_event([&](Perfcore::Event const& perf_event) {
         Event event;
 
         event.serial = next_serial;
         next_serial.increment();
-        event.timestamp = perf_event.get("timestamp").to_number<u64>();
-        event.lost_samples = perf_event.get("lost_samples").to_number<u32>();
-        event.type = perf_event.get("type").to_string();
-        event.pid = perf_event.get("pid").to_i32();
-        event.tid = perf_event.get("tid").to_i32();
+        event.timestamp = perf_event.timestamp;
+        event.lost_samples = perf_event.lost_samples;
+        event.type = perf_event.type;
+        event.pid = perf_event.pid;
+        event.tid = perf_event.tid;
 
         if (event.type == "malloc"sv) {
-            event.ptr = perf_event.get("ptr").to_number<FlatPtr>();
-            event.size = perf_event.get("size").to_number<size_t>();
+            event.ptr = perf_event.ptr;
+            event.size = perf_event.size;
         } else if (event.type == "free"sv) {
-            event.ptr = perf_event.get("ptr").to_number<FlatPtr>();
+            event.ptr = perf_event.ptr;
         } else if (event.type == "mmap"sv) {
-            event.ptr = perf_event.get("ptr").to_number<FlatPtr>();
-            event.size = perf_event.get("size").to_number<size_t>();
-            event.name = perf_event.get("name").to_string();
-
             auto it = current_processes.find(event.pid);
             if (it != current_processes.end())
-                it->value->library_metadata.handle_mmap(event.ptr, event.size, event.name);
-            continue;
+                it->value->library_metadata.handle_mmap(perf_event.ptr, perf_event.size, perf_event.name);
+            return;
         } else if (event.type == "munmap"sv) {
-            event.ptr = perf_event.get("ptr").to_number<FlatPtr>();
-            event.size = perf_event.get("size").to_number<size_t>();
-            continue;
+            return;
         } else if (event.type == "process_create"sv) {
-            event.parent_pid = perf_event.get("parent_pid").to_number<FlatPtr>();
-            event.executable = perf_event.get("executable").to_string();
-
             auto sampled_process = adopt_own(*new Process {
                 .pid = event.pid,
-                .executable = event.executable,
-                .basename = LexicalPath::basename(event.executable),
+                .executable = perf_event.executable,
+                .basename = LexicalPath::basename(perf_event.executable),
                 .start_valid = event.serial,
                 .end_valid = {},
             });
 
             current_processes.set(sampled_process->pid, sampled_process);
             all_processes.append(move(sampled_process));
-            continue;
+            return;
         } else if (event.type == "process_exec"sv) {
-            event.executable = perf_event.get("executable").to_string();
-
             auto old_process = current_processes.get(event.pid).value();
             old_process->end_valid = event.serial;
 
@@ -274,81 +337,84 @@ Result<NonnullOwnPtr<Profile>, String> Profile::load_from_perfcore_file(const St
 
             auto sampled_process = adopt_own(*new Process {
                 .pid = event.pid,
-                .executable = event.executable,
-                .basename = LexicalPath::basename(event.executable),
+                .executable = perf_event.executable,
+                .basename = LexicalPath::basename(perf_event.executable),
                 .start_valid = event.serial,
                 .end_valid = {},
             });
 
             current_processes.set(sampled_process->pid, sampled_process);
             all_processes.append(move(sampled_process));
-            continue;
+            return;
         } else if (event.type == "process_exit"sv) {
             auto old_process = current_processes.get(event.pid).value();
             old_process->end_valid = event.serial;
 
             current_processes.remove(event.pid);
-            continue;
+            return;
         } else if (event.type == "thread_create"sv) {
-            event.parent_tid = perf_event.get("parent_tid").to_i32();
             auto it = current_processes.find(event.pid);
             if (it != current_processes.end())
                 it->value->handle_thread_create(event.tid, event.serial);
-            continue;
+            return;
+        } else if (event.type == "context_switch"sv) {
+            event.next_pid = perf_event.next_pid;
+            event.next_tid = perf_event.next_tid;
         } else if (event.type == "thread_exit"sv) {
             auto it = current_processes.find(event.pid);
             if (it != current_processes.end())
                 it->value->handle_thread_exit(event.tid, event.serial);
-            continue;
+            return;
         }
 
-        auto maybe_kernel_base = Symbolication::kernel_base();
+        if (perf_event.stack.size() < 2)
+            return;
 
-        auto* stack = perf_event.get_ptr("stack");
-        VERIFY(stack);
-        auto& stack_array = stack->as_array();
-        for (ssize_t i = stack_array.values().size() - 1; i >= 0; --i) {
-            auto& frame = stack_array.at(i);
-            auto ptr = frame.to_number<u64>();
-            u32 offset = 0;
-            FlyString object_name;
-            String symbol;
+        auto process_it = current_processes.find(event.pid);
+        auto* process = process_it != current_processes.end() ? process_it->value : nullptr;
 
-            if (maybe_kernel_base.has_value() && ptr >= maybe_kernel_base.value()) {
-                if (kernel_elf) {
-                    symbol = kernel_elf->symbolicate(ptr - maybe_kernel_base.value(), &offset);
-                } else {
-                    symbol = String::formatted("?? <{:p}>", ptr);
-                }
-            } else {
-                auto it = current_processes.find(event.pid);
-                // FIXME: This logic is kinda gnarly, find a way to clean it up.
-                LibraryMetadata* library_metadata {};
-                if (it != current_processes.end())
-                    library_metadata = &it->value->library_metadata;
-                if (auto* library = library_metadata ? library_metadata->library_containing(ptr) : nullptr) {
-                    object_name = library->name;
-                    symbol = library->symbolicate(ptr, &offset);
-                } else {
-                    symbol = String::formatted("?? <{:p}>", ptr);
-                }
-            }
-
-            event.frames.append({ object_name, symbol, (FlatPtr)ptr, offset });
+        RawStack raw_stack { process, {} };
+        raw_stack.addresses.append(perf_event.stack.data(), perf_event.stack.size());
+        auto stack_it = stack_ids.find(raw_stack);
+        if (stack_it != stack_ids.end()) {
+            event.stack_id = stack_it->value;
+        } else {
+            event.stack_id = stacks.size();
+            stacks.append(symbolicate(process, raw_stack.addresses));
+            stack_ids.set(move(raw_stack), event.stack_id);
         }
 
-        if (event.frames.size() < 2)
-            continue;
-
-        FlatPtr innermost_frame_address = event.frames.at(1).address;
+        FlatPtr innermost_frame_address = stacks[event.stack_id].at(1).address;
         event.in_kernel = maybe_kernel_base.has_value() && innermost_frame_address >= maybe_kernel_base.value();
 
         events.append(move(event));
-    }
+    });
+    if (result.is_error())
+        return result.release_error();
 
     if (events.is_empty())
         return String { "No events captured (targeted process was never on CPU)" };
 
+    // A thread that was switched out is off the CPU until it gets switched back in. We only see that happen if the
+    // thread that was running before is profiled as well, otherwise the next event of the thread itself has to do.
+    HashMap<int, size_t> switched_out_threads;
+    for (size_t i = 0; i < events.size(); ++i) {
+        auto& event = events[i];
+        auto switched_back_in = [&](int tid) {
+            auto it = switched_out_threads.find(tid);
+            if (it == switched_out_threads.end())
+                return;
+            auto& switch_out_event = events[it->value];
+            switch_out_event.off_cpu_time = event.timestamp - switch_out_event.timestamp;
+            switched_out_threads.remove(it);
+        };
+        switched_back_in(event.tid);
+        if (event.type == "context_switch"sv) {
+            switched_back_in(event.next_tid);
+            switched_out_threads.set(event.tid, i);
+        }
+    }
+
     quick_sort(all_processes, [](auto& a, auto& b) {
         if (a.pid == b.pid)
             return a.start_valid < b.start_valid;
@@ -360,7 +426,7 @@ Result<NonnullOwnPtr<Profile>, String> Profile::load_from_perfcore_file(const St
     for (auto& it : all_processes)
         processes.append(move(it));
 
-    return adopt_own(*new Profile(move(processes), move(events)));
+    return adopt_own(*new Profile(move(processes), move(events), move(stacks)));
 }
 
 void ProfileNode::sort_children()
@@ -464,6 +530,14 @@ void Profile::set_show_percentages(bool show_percentages)
     m_show_percentages = show_percentages;
 }
 
+void Profile::set_show_off_cpu_time(bool show_off_cpu_time)
+{
+    if (m_show_off_cpu_time == show_off_cpu_time)
+        return;
+    m_show_off_cpu_time = show_off_cpu_time;
+    rebuild_tree();
+}
+
 void Profile::set_disassembly_index(const GUI::ModelIndex& index)
 {
     if (m_disassembly_index == index)
@@ -13,9 +13,6 @@
 #include "SamplesModel.h"
 #include <AK/Bitmap.h>
 #include <AK/FlyString.h>
-#include <AK/JsonArray.h>
-#include <AK/JsonObject.h>
-#include <AK/JsonValue.h>
 #include <AK/MappedFile.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/OwnPtr.h>
@@ -84,19 +81,20 @@ public:
     ProfileNode* parent() { return m_parent; }
     const ProfileNode* parent() const { return m_parent; }
 
-    void increment_event_count() { ++m_event_count; }
-    void increment_self_count() { ++m_self_count; }
+    // Every event counts once, unless we're looking at how long threads were off the CPU, where it's milliseconds.
+    void increment_event_count(u32 weight = 1) { m_event_count += weight; }
+    void increment_self_count(u32 weight = 1) { m_self_count += weight; }
 
     void sort_children();
 
     const HashMap<FlatPtr, size_t>& events_per_address() const { return m_events_per_address; }
-    void add_event_address(FlatPtr address)
+    void add_event_address(FlatPtr address, u32 weight = 1)
     {
         auto it = m_events_per_address.find(address);
         if (it == m_events_per_address.end())
-            m_events_per_address.set(address, 1);
+            m_events_per_address.set(address, weight);
         else
-            m_events_per_address.set(address, it->value + 1);
+            m_events_per_address.set(address, it->value + weight);
     }
 
     pid_t pid() const { return m_pid; }
@@ -165,21 +163,23 @@ public:
     struct Event {
         EventSerialNumber serial;
         u64 timestamp { 0 };
-        String type;
+        FlyString type;
         FlatPtr ptr { 0 };
         size_t size { 0 };
-        String name;
-        int parent_pid { 0 };
-        int parent_tid { 0 };
-        String executable;
         int pid { 0 };
         int tid { 0 };
+        int next_pid { 0 };
+        int next_tid { 0 };
+        // For context switches: how many milliseconds it took until the thread got back onto the CPU.
+        u64 off_cpu_time { 0 };
         u32 lost_samples { 0 };
+        // Events with the same stack share its frames, see frames().
+        u32 stack_id { 0 };
         bool in_kernel { false };
-        Vector<Frame> frames;
     };
 
     const Vector<Event>& events() const { return m_events; }
+    const Vector<Frame>& frames(const Event& event) const { return m_stacks[event.stack_id]; }
     const Vector<size_t>& filtered_event_indices() const { return m_filtered_event_indices; }
 
     u64 length_in_ms() const { return m_last_timestamp - m_first_timestamp; }
@@ -204,6 +204,13 @@ public:
     bool show_percentages() const { return m_show_percentages; }
     void set_show_percentages(bool);
 
+    // Attributes the time threads spent blocked or waiting to run to the stacks they were switched out with.
+    bool show_off_cpu_time() const { return m_show_off_cpu_time; }
+    void set_show_off_cpu_time(bool);
+
+    // What percentages in the tree are relative to.
+    u64 total_event_weight() const { return m_show_off_cpu_time ? m_total_off_cpu_time : m_filtered_event_indices.size(); }
+
     const Vector<Process>& processes() const { return m_processes; }
 
     template<typename Callback>
@@ -220,7 +227,7 @@ public:
     }
 
 private:
-    Profile(Vector<Process>, Vector<Event>);
+    Profile(Vector<Process>, Vector<Event>, Vector<Vector<Frame>> stacks);
 
     void rebuild_tree();
 
@@ -237,6 +244,7 @@ private:
 
     Vector<Process> m_processes;
     Vector<Event> m_events;
+    Vector<Vector<Frame>> m_stacks;
 
     bool m_has_timestamp_filter_range { false };
     u64 m_timestamp_filter_range_start { 0 };
@@ -247,6 +255,8 @@ private:
     bool m_inverted { false };
     bool m_show_top_functions { false };
     bool m_show_percentages { false };
+    bool m_show_off_cpu_time { false };
+    u64 m_total_off_cpu_time { 0 };
 };
 
 }
@@ -88,7 +88,7 @@ GUI::Variant SamplesModel::data(const GUI::ModelIndex& index, GUI::ModelRole rol
         }
 
         if (index.column() == Column::InnermostStackFrame) {
-            return event.frames.last().symbol;
+            return m_profile.frames(event).last().symbol;
         }
         return {};
     }
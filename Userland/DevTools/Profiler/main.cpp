@@ -224,6 +224,13 @@ int main(int argc, char** argv)
     percent_action->set_checked(false);
     view_menu.add_action(percent_action);
 
+    auto off_cpu_action = GUI::Action::create_checkable("&Off-CPU Time", { Mod_Ctrl, Key_O }, [&](auto& action) {
+        profile->set_show_off_cpu_time(action.is_checked());
+        tree_view.update();
+    });
+    off_cpu_action->set_checked(false);
+    view_menu.add_action(off_cpu_action);
+
     view_menu.add_action(disassembly_action);
 
     auto& help_menu = window->add_menu("&Help");
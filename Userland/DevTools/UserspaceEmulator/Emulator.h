@@ -167,9 +167,12 @@ private:
     int virt$select(FlatPtr);
     int virt$get_stack_bounds(FlatPtr, FlatPtr);
     int virt$accept4(FlatPtr);
+    int virt$accept4_batch(FlatPtr);
     int virt$bind(int sockfd, FlatPtr address, socklen_t address_length);
     int virt$recvmsg(int sockfd, FlatPtr msg_addr, int flags);
     int virt$sendmsg(int sockfd, FlatPtr msg_addr, int flags);
+    int virt$recvmmsg(FlatPtr params_addr);
+    int virt$sendmmsg(FlatPtr params_addr);
     int virt$connect(int sockfd, FlatPtr address, socklen_t address_size);
     int virt$shutdown(int sockfd, int how);
     void virt$sync();
@@ -186,11 +189,16 @@ private:
     int virt$getsid(pid_t);
     int virt$sched_setparam(int, FlatPtr);
     int virt$sched_getparam(pid_t, FlatPtr);
+    int virt$sched_setattr(pid_t, FlatPtr);
+    int virt$sched_getattr(pid_t, FlatPtr);
     int virt$set_thread_name(pid_t, FlatPtr, size_t);
     pid_t virt$setsid();
     int virt$create_inode_watcher(unsigned);
     int virt$inode_watcher_add_watch(FlatPtr);
     int virt$inode_watcher_remove_watch(int, int);
+    int virt$epoll_create(int);
+    int virt$epoll_ctl(FlatPtr);
+    int virt$epoll_wait(FlatPtr);
     int virt$readlink(FlatPtr);
     u32 virt$allocate_tls(FlatPtr, size_t);
     int virt$ptsname(int fd, FlatPtr buffer, size_t buffer_size);
@@ -13,6 +13,7 @@
 #include <sched.h>
 #include <serenity.h>
 #include <strings.h>
+#include <sys/epoll.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <sys/select.h>
@@ -170,6 +171,8 @@ u32 Emulator::virt_syscall(u32 function, u32 arg1, u32 arg2, u32 arg3)
         return virt$fchown(arg1, arg2, arg3);
     case SC_accept4:
         return virt$accept4(arg1);
+    case SC_accept4_batch:
+        return virt$accept4_batch(arg1);
     case SC_setsockopt:
         return virt$setsockopt(arg1);
     case SC_getsockname:
@@ -190,6 +193,10 @@ u32 Emulator::virt_syscall(u32 function, u32 arg1, u32 arg2, u32 arg3)
         return virt$recvmsg(arg1, arg2, arg3);
     case SC_sendmsg:
         return virt$sendmsg(arg1, arg2, arg3);
+    case SC_recvmmsg:
+        return virt$recvmmsg(arg1);
+    case SC_sendmmsg:
+        return virt$sendmmsg(arg1);
     case SC_kill:
         return virt$kill(arg1, arg2);
     case SC_killpg:
@@ -218,6 +225,10 @@ u32 Emulator::virt_syscall(u32 function, u32 arg1, u32 arg2, u32 arg3)
         return virt$sched_getparam(arg1, arg2);
     case SC_sched_setparam:
         return virt$sched_setparam(arg1, arg2);
+    case SC_sched_getattr:
+        return virt$sched_getattr(arg1, arg2);
+    case SC_sched_setattr:
+        return virt$sched_setattr(arg1, arg2);
     case SC_set_thread_name:
         return virt$set_thread_name(arg1, arg2, arg3);
     case SC_setsid:
@@ -228,6 +239,12 @@ u32 Emulator::virt_syscall(u32 function, u32 arg1, u32 arg2, u32 arg3)
         return virt$inode_watcher_add_watch(arg1);
     case SC_inode_watcher_remove_watch:
         return virt$inode_watcher_remove_watch(arg1, arg2);
+    case SC_epoll_create:
+        return virt$epoll_create(arg1);
+    case SC_epoll_ctl:
+        return virt$epoll_ctl(arg1);
+    case SC_epoll_wait:
+        return virt$epoll_wait(arg1);
     case SC_clock_nanosleep:
         return virt$clock_nanosleep(arg1);
     case SC_readlink:
@@ -468,6 +485,19 @@ int Emulator::virt$accept4(FlatPtr params_addr)
     return rc < 0 ? -errno : rc;
 }
 
+int Emulator::virt$accept4_batch(FlatPtr params_addr)
+{
+    Syscall::SC_accept4_batch_params params;
+    mmu().copy_from_vm(&params, params_addr, sizeof(params));
+
+    Vector<int> fds;
+    fds.resize(params.count);
+    int rc = accept4_batch(params.sockfd, fds.data(), fds.size(), params.flags);
+    if (rc > 0)
+        mmu().copy_to_vm((FlatPtr)params.fds, fds.data(), rc * sizeof(int));
+    return rc < 0 ? -errno : rc;
+}
+
 int Emulator::virt$bind(int sockfd, FlatPtr address, socklen_t address_length)
 {
     auto buffer = mmu().copy_buffer_from_vm(address, address_length);
@@ -635,7 +665,7 @@ int Emulator::virt$sendmsg(int sockfd, FlatPtr msg_addr, int flags)
 
     ByteBuffer control_buffer;
     if (mmu_msg.msg_control)
-        control_buffer = ByteBuffer::create_uninitialized(mmu_msg.msg_controllen);
+        control_buffer = mmu().copy_buffer_from_vm((FlatPtr)mmu_msg.msg_control, mmu_msg.msg_controllen);
 
     sockaddr_storage address;
     socklen_t address_length = 0;
@@ -648,6 +678,53 @@ int Emulator::virt$sendmsg(int sockfd, FlatPtr msg_addr, int flags)
     return sendmsg(sockfd, &msg, flags);
 }
 
+// These go through the host one message at a time, which is good enough for the emulator.
+int Emulator::virt$recvmmsg(FlatPtr params_addr)
+{
+    Syscall::SC_mmsg_params params;
+    mmu().copy_from_vm(&params, params_addr, sizeof(params));
+    auto sockfd = params.sockfd;
+    auto msgs_addr = (FlatPtr)params.msgs;
+    auto flags = params.flags;
+
+    unsigned received_count = 0;
+    for (; received_count < params.message_count; ++received_count) {
+        FlatPtr msg_addr = msgs_addr + received_count * sizeof(mmsghdr);
+        int rc = virt$recvmsg(sockfd, msg_addr + offsetof(mmsghdr, msg_hdr), received_count > 0 ? flags | MSG_DONTWAIT : flags);
+        if (rc < 0) {
+            if (received_count == 0)
+                return rc;
+            break;
+        }
+        unsigned length = rc;
+        mmu().copy_to_vm(msg_addr + offsetof(mmsghdr, msg_len), &length, sizeof(length));
+    }
+    return received_count;
+}
+
+int Emulator::virt$sendmmsg(FlatPtr params_addr)
+{
+    Syscall::SC_mmsg_params params;
+    mmu().copy_from_vm(&params, params_addr, sizeof(params));
+    auto sockfd = params.sockfd;
+    auto msgs_addr = (FlatPtr)params.msgs;
+    auto flags = params.flags;
+
+    unsigned sent_count = 0;
+    for (; sent_count < params.message_count; ++sent_count) {
+        FlatPtr msg_addr = msgs_addr + sent_count * sizeof(mmsghdr);
+        int rc = virt$sendmsg(sockfd, msg_addr + offsetof(mmsghdr, msg_hdr), flags);
+        if (rc < 0) {
+            if (sent_count == 0)
+                return -errno;
+            break;
+        }
+        unsigned length = rc;
+        mmu().copy_to_vm(msg_addr + offsetof(mmsghdr, msg_len), &length, sizeof(length));
+    }
+    return sent_count;
+}
+
 int Emulator::virt$select(FlatPtr params_addr)
 {
     Syscall::SC_select_params params;
@@ -1392,6 +1469,22 @@ int Emulator::virt$sched_setparam(int pid, FlatPtr user_addr)
     return syscall(SC_sched_setparam, pid, &user_param);
 }
 
+int Emulator::virt$sched_getattr(pid_t pid, FlatPtr user_addr)
+{
+    sched_attr user_attr;
+    mmu().copy_from_vm(&user_attr, user_addr, sizeof(user_attr));
+    auto rc = syscall(SC_sched_getattr, pid, &user_attr);
+    mmu().copy_to_vm(user_addr, &user_attr, sizeof(user_attr));
+    return rc;
+}
+
+int Emulator::virt$sched_setattr(pid_t pid, FlatPtr user_addr)
+{
+    sched_attr user_attr;
+    mmu().copy_from_vm(&user_attr, user_addr, sizeof(user_attr));
+    return syscall(SC_sched_setattr, pid, &user_attr);
+}
+
 int Emulator::virt$set_thread_name(pid_t pid, FlatPtr name_addr, size_t name_length)
 {
     auto user_name = mmu().copy_buffer_from_vm(name_addr, name_length);
@@ -1421,6 +1514,53 @@ int Emulator::virt$inode_watcher_remove_watch(int fd, int wd)
     return syscall(SC_inode_watcher_add_watch, fd, wd);
 }
 
+int Emulator::virt$epoll_create(int flags)
+{
+    return syscall(SC_epoll_create, flags);
+}
+
+int Emulator::virt$epoll_ctl(FlatPtr params_addr)
+{
+    Syscall::SC_epoll_ctl_params params;
+    mmu().copy_from_vm(&params, params_addr, sizeof(params));
+
+    epoll_event event {};
+    if (params.event) {
+        mmu().copy_from_vm(&event, (FlatPtr)params.event, sizeof(event));
+        params.event = &event;
+    }
+    return syscall(SC_epoll_ctl, &params);
+}
+
+int Emulator::virt$epoll_wait(FlatPtr params_addr)
+{
+    Syscall::SC_epoll_wait_params params;
+    mmu().copy_from_vm(&params, params_addr, sizeof(params));
+    if (params.maxevents <= 0)
+        return -EINVAL;
+
+    timespec timeout;
+    u32 sigmask;
+    if (params.timeout) {
+        mmu().copy_from_vm(&timeout, (FlatPtr)params.timeout, sizeof(timeout));
+        params.timeout = &timeout;
+    }
+    if (params.sigmask) {
+        mmu().copy_from_vm(&sigmask, (FlatPtr)params.sigmask, sizeof(sigmask));
+        params.sigmask = &sigmask;
+    }
+
+    Vector<epoll_event> events;
+    events.resize(params.maxevents);
+    auto guest_events = (FlatPtr)params.events;
+    params.events = events.data();
+
+    int rc = syscall(SC_epoll_wait, &params);
+    if (rc > 0)
+        mmu().copy_to_vm(guest_events, events.data(), rc * sizeof(epoll_event));
+    return rc;
+}
+
 int Emulator::virt$clock_nanosleep(FlatPtr params_addr)
 {
     Syscall::SC_clock_nanosleep_params params;
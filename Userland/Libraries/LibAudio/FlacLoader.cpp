@@ -6,19 +6,94 @@
 
 #include "FlacLoader.h"
 #include "Buffer.h"
+#include <AK/Array.h>
 #include <AK/BitStream.h>
 #include <AK/Debug.h>
 #include <AK/FlyString.h>
 #include <AK/Format.h>
 #include <AK/Math.h>
+#include <AK/MemoryStream.h>
+#include <AK/NumericLimits.h>
 #include <AK/Stream.h>
 #include <AK/String.h>
 #include <AK/StringBuilder.h>
 #include <LibCore/File.h>
-#include <LibCore/FileStream.h>
 
 namespace Audio {
 
+FlacInputStream::FlacInputStream(NonnullRefPtr<Core::File> file)
+    : m_file(move(file))
+{
+}
+
+FlacInputStream::FlacInputStream(ReadonlyBytes data)
+    : m_buffer(data)
+{
+}
+
+bool FlacInputStream::fill_buffer()
+{
+    if (!m_file)
+        return false;
+    m_buffer_offset += m_buffer.size();
+    m_file_buffer = m_file->read(64 * KiB);
+    m_buffer = m_file_buffer.bytes();
+    m_position_in_buffer = 0;
+    return !m_buffer.is_empty();
+}
+
+size_t FlacInputStream::read(Bytes bytes)
+{
+    size_t nread = 0;
+    while (nread < bytes.size()) {
+        if (m_position_in_buffer == m_buffer.size() && !fill_buffer())
+            break;
+        auto count = m_buffer.slice(m_position_in_buffer).copy_trimmed_to(bytes.slice(nread));
+        m_position_in_buffer += count;
+        nread += count;
+    }
+    return nread;
+}
+
+bool FlacInputStream::unreliable_eof() const
+{
+    return m_position_in_buffer == m_buffer.size() && (!m_file || m_file->eof());
+}
+
+bool FlacInputStream::read_or_error(Bytes bytes)
+{
+    if (read(bytes) < bytes.size()) {
+        set_fatal_error();
+        return false;
+    }
+    return true;
+}
+
+bool FlacInputStream::discard_or_error(size_t count)
+{
+    if (!seek(offset() + count)) {
+        set_fatal_error();
+        return false;
+    }
+    return true;
+}
+
+bool FlacInputStream::seek(u64 offset)
+{
+    handle_any_error();
+    if (offset >= m_buffer_offset && offset <= m_buffer_offset + m_buffer.size()) {
+        m_position_in_buffer = offset - m_buffer_offset;
+        return true;
+    }
+    if (!m_file || !m_file->seek(offset))
+        return false;
+    m_file_buffer.clear();
+    m_buffer = {};
+    m_buffer_offset = offset;
+    m_position_in_buffer = 0;
+    return true;
+}
+
 FlacLoaderPlugin::FlacLoaderPlugin(const StringView& path)
     : m_file(Core::File::construct(path))
 {
@@ -27,11 +102,10 @@ FlacLoaderPlugin::FlacLoaderPlugin(const StringView& path)
         return;
     }
 
+    m_stream = make<FlacInputStream>(*m_file);
     m_valid = parse_header();
     if (!m_valid)
         return;
-
-    m_stream = make<FlacInputStream>(Core::InputFileStream(*m_file));
     reset();
 
     m_resampler = make<ResampleHelper<double>>(m_sample_rate, 44100);
@@ -39,11 +113,7 @@ FlacLoaderPlugin::FlacLoaderPlugin(const StringView& path)
 
 FlacLoaderPlugin::FlacLoaderPlugin(const ByteBuffer& buffer)
 {
-    m_stream = make<FlacInputStream>(InputMemoryStream(buffer));
-    if (!m_stream) {
-        m_error_string = String::formatted("Can't open memory stream");
-        return;
-    }
+    m_stream = make<FlacInputStream>(buffer.bytes());
 
     m_valid = parse_header();
     if (!m_valid)
@@ -60,16 +130,9 @@ bool FlacLoaderPlugin::sniff()
 
 bool FlacLoaderPlugin::parse_header()
 {
-    Optional<Core::InputFileStream> fis;
     bool ok = true;
 
-    InputBitStream bit_input = [&]() -> InputBitStream {
-        if (m_file) {
-            fis = Core::InputFileStream(*m_file);
-            return InputBitStream(*fis);
-        }
-        return InputBitStream(m_stream->get<InputMemoryStream>());
-    }();
+    InputBitStream bit_input(*m_stream);
 
 #define CHECK_OK(msg)                                                      \
     do {                                                                   \
@@ -131,8 +194,7 @@ bool FlacLoaderPlugin::parse_header()
     md5_checksum.bytes().copy_to({ m_md5_checksum, sizeof(m_md5_checksum) });
 
     // Parse other blocks
-    // TODO: For a simple first implementation, all other blocks are skipped as allowed by the FLAC specification.
-    // Especially the SEEKTABLE block may become useful in a more sophisticated version.
+    // TODO: Except for the SEEKTABLE, all other blocks are skipped as allowed by the FLAC specification.
     [[maybe_unused]] u16 meta_blocks_parsed = 1;
     [[maybe_unused]] u16 total_meta_blocks = meta_blocks_parsed;
     FlacRawMetadataBlock block = streaminfo;
@@ -141,8 +203,16 @@ bool FlacLoaderPlugin::parse_header()
         ++total_meta_blocks;
         ok = ok && m_error_string.is_empty();
         CHECK_OK(m_error_string);
+        if (block.type == FlacMetadataBlockType::SEEKTABLE) {
+            parse_seektable(block.data);
+            ++meta_blocks_parsed;
+        }
     }
 
+    // Seek points are relative to the first frame, which we only know the location of now.
+    for (auto& seek_point : m_seek_points)
+        seek_point.byte_offset += m_data_start_location;
+
     if constexpr (AFLACLOADER_DEBUG) {
         // HACK: u128 should be able to format itself
         StringBuilder checksum_string;
@@ -195,44 +265,103 @@ FlacRawMetadataBlock FlacLoaderPlugin::next_meta_block(InputBitStream& bit_input
 #undef CHECK_IO_ERROR
 }
 
+void FlacLoaderPlugin::parse_seektable(ReadonlyBytes data)
+{
+    InputMemoryStream stream(data);
+    // Each seek point is the first sample of a frame, the frame's offset and its sample count.
+    while (stream.remaining() >= 18) {
+        BigEndian<u64> sample_index;
+        BigEndian<u64> byte_offset;
+        BigEndian<u16> sample_count;
+        stream >> sample_index >> byte_offset >> sample_count;
+        // Placeholder points have all bits of the sample index set.
+        if (sample_index == NumericLimits<u64>::max())
+            continue;
+        if (!m_seek_points.is_empty() && sample_index <= m_seek_points.last().sample_index)
+            continue;
+        m_seek_points.append({ sample_index, byte_offset });
+    }
+    dbgln_if(AFLACLOADER_DEBUG, "SEEKTABLE with {} seek points", m_seek_points.size());
+}
+
+FlacSeekPoint FlacLoaderPlugin::nearest_seek_point(u64 sample_index) const
+{
+    FlacSeekPoint nearest { 0, m_data_start_location };
+    size_t low = 0;
+    size_t high = m_seek_points.size();
+    while (low < high) {
+        auto middle = low + (high - low) / 2;
+        if (m_seek_points[middle].sample_index <= sample_index) {
+            nearest = m_seek_points[middle];
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return nearest;
+}
+
 void FlacLoaderPlugin::reset()
 {
-    seek(m_data_start_location);
+    m_stream->seek(m_data_start_location);
     m_current_frame.clear();
+    m_current_frame_data.clear_with_capacity();
+    m_current_frame_position = 0;
+    m_next_frame_first_sample = 0;
+    m_loaded_samples = 0;
 }
 
-void FlacLoaderPlugin::seek(const int position)
+void FlacLoaderPlugin::seek(const int sample_index)
 {
-    m_stream->seek(position);
+    if (sample_index < 0 || static_cast<u64>(sample_index) >= m_total_samples)
+        return;
+    u64 target = sample_index;
+
+    // Frames can only be decoded from their start, so continue from the closest frame we know of, unless the target is
+    // in or after the frame we're in and that is at least as close.
+    auto seek_point = nearest_seek_point(target);
+    bool can_continue = m_current_frame.has_value() && target >= m_current_frame_first_sample && seek_point.sample_index <= m_current_frame_first_sample;
+    if (!can_continue) {
+        if (!m_stream->seek(seek_point.byte_offset)) {
+            m_error_string = "Seek failed";
+            return;
+        }
+        m_current_frame.clear();
+        m_next_frame_first_sample = seek_point.sample_index;
+    }
+
+    while (!m_current_frame.has_value() || target >= m_current_frame_first_sample + m_current_frame_data.size()) {
+        next_frame();
+        if (!m_error_string.is_empty()) {
+            dbgln("Frame parsing error while seeking: {}", m_error_string);
+            return;
+        }
+    }
+    m_current_frame_position = target - m_current_frame_first_sample;
+    m_loaded_samples = target;
 }
 
-// TODO implement these
-RefPtr<Buffer> FlacLoaderPlugin::get_more_samples([[maybe_unused]] size_t max_bytes_to_read_from_input)
+RefPtr<Buffer> FlacLoaderPlugin::get_more_samples(size_t max_bytes_to_read_from_input)
 {
-    Vector<Frame> samples;
     ssize_t remaining_samples = m_total_samples - m_loaded_samples;
     if (remaining_samples <= 0) {
         return nullptr;
     }
 
     size_t samples_to_read = min(max_bytes_to_read_from_input, remaining_samples);
-    while (samples_to_read > 0) {
-        if (!m_current_frame.has_value()) {
+    Vector<Frame> samples;
+    samples.ensure_capacity(samples_to_read);
+    while (samples.size() < samples_to_read) {
+        if (!m_current_frame.has_value() || m_current_frame_position == m_current_frame_data.size()) {
             next_frame();
             if (!m_error_string.is_empty()) {
                 dbgln("Frame parsing error: {}", m_error_string);
                 return nullptr;
             }
-            // HACK: Test the start of the next subframe
-            // auto input = m_stream->bit_stream();
-            // u64 next = input.read_bits_big_endian(64);
-            // dbgln("After frame end: {}", next);
         }
-        samples.append(m_current_frame_data.take_first());
-        if (m_current_frame_data.size() == 0) {
-            m_current_frame.clear();
-        }
-        --samples_to_read;
+        auto count = min(samples_to_read - samples.size(), m_current_frame_data.size() - m_current_frame_position);
+        samples.append(m_current_frame_data.data() + m_current_frame_position, count);
+        m_current_frame_position += count;
     }
 
     m_loaded_samples += samples.size();
@@ -242,7 +371,8 @@ RefPtr<Buffer> FlacLoaderPlugin::get_more_samples([[maybe_unused]] size_t max_by
 void FlacLoaderPlugin::next_frame()
 {
     bool ok = true;
-    InputBitStream bit_stream = m_stream->bit_stream();
+    auto frame_offset = m_stream->offset();
+    InputBitStream bit_stream(*m_stream);
 #define CHECK_OK(msg)                                                                                                      \
     do {                                                                                                                   \
         if (!ok) {                                                                                                         \
@@ -323,16 +453,16 @@ void FlacLoaderPlugin::next_frame()
     };
 
     u8 subframe_count = frame_channel_type_to_channel_count(channel_type);
-    Vector<Vector<i32>> current_subframes;
-    current_subframes.ensure_capacity(subframe_count);
+    if (m_subframe_samples.size() < subframe_count)
+        m_subframe_samples.resize(subframe_count);
 
     for (u8 i = 0; i < subframe_count; ++i) {
         FlacSubframeHeader new_subframe = next_subframe_header(bit_stream, i);
         CHECK_ERROR_STRING;
-        Vector<i32> subframe_samples = parse_subframe(new_subframe, bit_stream);
-        // HACK: Test the start of the next subframe
+        parse_subframe(new_subframe, bit_stream, m_subframe_samples[i]);
         CHECK_ERROR_STRING;
-        current_subframes.append(move(subframe_samples));
+        ok = ok && (m_subframe_samples[i].size() == m_subframe_samples[0].size());
+        CHECK_OK("Subframe sample count");
     }
 
     bit_stream.align_to_byte_boundary();
@@ -340,11 +470,23 @@ void FlacLoaderPlugin::next_frame()
     // TODO: check checksum, see above
     [[maybe_unused]] u16 footer_checksum = bit_stream.read_bits_big_endian(16);
 
-    Vector<i32> left, right;
+    // TODO: find the correct rescale offset
+    double sample_rescale = static_cast<double>(1 << pcm_bits_per_sample(m_current_frame->bit_depth));
+    dbgln_if(AFLACLOADER_DEBUG, "Sample rescaled from {} bits: factor {:.1f}", pcm_bits_per_sample(m_current_frame->bit_depth), sample_rescale);
+
+    auto& first_channel = m_subframe_samples[0];
+    auto& second_channel = subframe_count > 1 ? m_subframe_samples[1] : first_channel;
+    m_current_frame_data.clear_with_capacity();
+    m_current_frame_data.ensure_capacity(first_channel.size());
+    // zip together channels
+    auto append_frames = [&](auto left_at, auto right_at) {
+        for (size_t i = 0; i < first_channel.size(); ++i)
+            m_current_frame_data.unchecked_append({ left_at(i) / sample_rescale, right_at(i) / sample_rescale });
+    };
 
     switch (channel_type) {
     case FlacFrameChannelType::Mono:
-        left = right = current_subframes[0];
+        append_frames([&](size_t i) { return first_channel[i]; }, [&](size_t i) { return first_channel[i]; });
         break;
     case FlacFrameChannelType::Stereo:
     // TODO mix together surround channels on each side?
@@ -354,55 +496,40 @@ void FlacLoaderPlugin::next_frame()
     case FlacFrameChannelType::Surround5p1:
     case FlacFrameChannelType::Surround6p1:
     case FlacFrameChannelType::Surround7p1:
-        left = current_subframes[0];
-        right = current_subframes[1];
+        append_frames([&](size_t i) { return first_channel[i]; }, [&](size_t i) { return second_channel[i]; });
         break;
     case FlacFrameChannelType::LeftSideStereo:
         // channels are left (0) and side (1)
-        left = current_subframes[0];
-        right.ensure_capacity(left.size());
-        for (size_t i = 0; i < left.size(); ++i) {
-            // right = left - side
-            right.unchecked_append(left[i] - current_subframes[1][i]);
-        }
+        // right = left - side
+        append_frames([&](size_t i) { return first_channel[i]; }, [&](size_t i) { return first_channel[i] - second_channel[i]; });
         break;
     case FlacFrameChannelType::RightSideStereo:
         // channels are side (0) and right (1)
-        right = current_subframes[1];
-        left.ensure_capacity(right.size());
-        for (size_t i = 0; i < right.size(); ++i) {
-            // left = right + side
-            left.unchecked_append(right[i] + current_subframes[0][i]);
-        }
+        // left = right + side
+        append_frames([&](size_t i) { return second_channel[i] + first_channel[i]; }, [&](size_t i) { return second_channel[i]; });
         break;
     case FlacFrameChannelType::MidSideStereo:
         // channels are mid (0) and side (1)
-        left.ensure_capacity(current_subframes[0].size());
-        right.ensure_capacity(current_subframes[0].size());
-        for (size_t i = 0; i < current_subframes[0].size(); ++i) {
-            i64 mid = current_subframes[0][i];
-            i64 side = current_subframes[1][i];
-            mid *= 2;
-            // prevent integer division errors
-            left.unchecked_append(static_cast<i32>((mid + side) / 2));
-            right.unchecked_append(static_cast<i32>((mid - side) / 2));
-        }
+        append_frames(
+            [&](size_t i) {
+                i64 mid = first_channel[i];
+                i64 side = second_channel[i];
+                // prevent integer division errors
+                return static_cast<i32>((mid * 2 + side) / 2);
+            },
+            [&](size_t i) {
+                i64 mid = first_channel[i];
+                i64 side = second_channel[i];
+                return static_cast<i32>((mid * 2 - side) / 2);
+            });
         break;
     }
 
-    VERIFY(left.size() == right.size());
-
-    // TODO: find the correct rescale offset
-    double sample_rescale = static_cast<double>(1 << pcm_bits_per_sample(m_current_frame->bit_depth));
-    dbgln_if(AFLACLOADER_DEBUG, "Sample rescaled from {} bits: factor {:.1f}", pcm_bits_per_sample(m_current_frame->bit_depth), sample_rescale);
-
-    m_current_frame_data.clear_with_capacity();
-    m_current_frame_data.ensure_capacity(left.size());
-    // zip together channels
-    for (size_t i = 0; i < left.size(); ++i) {
-        Frame frame = { left[i] / sample_rescale, right[i] / sample_rescale };
-        m_current_frame_data.unchecked_append(frame);
-    }
+    m_current_frame_position = 0;
+    m_current_frame_first_sample = m_next_frame_first_sample;
+    m_next_frame_first_sample += m_current_frame_data.size();
+    if (m_seek_points.is_empty() || m_current_frame_first_sample > m_seek_points.last().sample_index)
+        m_seek_points.append({ m_current_frame_first_sample, frame_offset });
 
 #undef CHECK_OK
 #undef CHECK_ERROR_STRING
@@ -549,7 +676,6 @@ FlacSubframeHeader FlacLoaderPlugin::next_subframe_header(InputBitStream& bit_st
     u8 k = 0;
     if (has_wasted_bits) {
         bool current_k_bit = 0;
-        u8 k = 0;
         do {
             current_k_bit = bit_stream.read_bit_big_endian();
             ++k;
@@ -564,16 +690,16 @@ FlacSubframeHeader FlacLoaderPlugin::next_subframe_header(InputBitStream& bit_st
     };
 }
 
-Vector<i32> FlacLoaderPlugin::parse_subframe(FlacSubframeHeader& subframe_header, InputBitStream& bit_input)
+void FlacLoaderPlugin::parse_subframe(FlacSubframeHeader& subframe_header, InputBitStream& bit_input, Vector<i32>& samples)
 {
-    Vector<i32> samples;
+    samples.clear_with_capacity();
+    samples.ensure_capacity(m_current_frame->sample_count);
 
     switch (subframe_header.type) {
     case FlacSubframeType::Constant: {
-        u64 constant_value = bit_input.read_bits_big_endian(subframe_header.bits_per_sample - subframe_header.wasted_bits_per_sample);
+        i32 constant_value = sign_extend(bit_input.read_bits_big_endian(subframe_header.bits_per_sample - subframe_header.wasted_bits_per_sample), subframe_header.bits_per_sample - subframe_header.wasted_bits_per_sample);
         dbgln_if(AFLACLOADER_DEBUG, "Constant subframe: {}", constant_value);
 
-        samples.ensure_capacity(m_current_frame->sample_count);
         for (u32 i = 0; i < m_current_frame->sample_count; ++i) {
             samples.unchecked_append(constant_value);
         }
@@ -581,142 +707,158 @@ Vector<i32> FlacLoaderPlugin::parse_subframe(FlacSubframeHeader& subframe_header
     }
     case FlacSubframeType::Fixed: {
         dbgln_if(AFLACLOADER_DEBUG, "Fixed LPC subframe order {}", subframe_header.order);
-        samples = decode_fixed_lpc(subframe_header, bit_input);
+        decode_fixed_lpc(subframe_header, bit_input, samples);
         break;
     }
     case FlacSubframeType::Verbatim: {
         dbgln_if(AFLACLOADER_DEBUG, "Verbatim subframe");
-        samples = decode_verbatim(subframe_header, bit_input);
+        decode_verbatim(subframe_header, bit_input, samples);
         break;
     }
     case FlacSubframeType::LPC: {
         dbgln_if(AFLACLOADER_DEBUG, "Custom LPC subframe order {}", subframe_header.order);
-        samples = decode_custom_lpc(subframe_header, bit_input);
+        decode_custom_lpc(subframe_header, bit_input, samples);
         break;
     }
     default:
         m_error_string = "Unhandled FLAC subframe type";
-        return {};
+        return;
     }
     if (!m_error_string.is_empty()) {
-        return {};
+        return;
     }
 
-    for (size_t i = 0; i < samples.size(); ++i) {
-        samples[i] <<= subframe_header.wasted_bits_per_sample;
+    if (subframe_header.wasted_bits_per_sample > 0) {
+        for (size_t i = 0; i < samples.size(); ++i)
+            samples[i] <<= subframe_header.wasted_bits_per_sample;
     }
 
-    ResampleHelper<i32> resampler(m_current_frame->sample_rate, m_sample_rate);
-    return resampler.resample(samples);
+    if (m_current_frame->sample_rate != m_sample_rate) {
+        ResampleHelper<i32> resampler(m_current_frame->sample_rate, m_sample_rate);
+        samples = resampler.resample(move(samples));
+    }
 }
 
 // Decode a subframe that isn't actually encoded
-Vector<i32> FlacLoaderPlugin::decode_verbatim([[maybe_unused]] FlacSubframeHeader& subframe, [[maybe_unused]] InputBitStream& bit_input)
+void FlacLoaderPlugin::decode_verbatim(FlacSubframeHeader& subframe, InputBitStream& bit_input, Vector<i32>& decoded)
 {
-    TODO();
+    u8 bits_per_sample = subframe.bits_per_sample - subframe.wasted_bits_per_sample;
+    for (u32 i = 0; i < m_current_frame->sample_count; ++i)
+        decoded.unchecked_append(sign_extend(bit_input.read_bits_big_endian(bits_per_sample), bits_per_sample));
 }
 
-// Decode a subframe encoded with a custom linear predictor coding, i.e. the subframe provides the polynomial order and coefficients
-Vector<i32> FlacLoaderPlugin::decode_custom_lpc(FlacSubframeHeader& subframe, InputBitStream& bit_input)
+// FLAC predicts every sample from the ones right before it, so the samples have to be restored one after the other.
+// The prediction itself can be computed in parallel though: with the coefficients reversed, it is the dot product of
+// two contiguous arrays, which the compiler unrolls and vectorizes as long as it knows the order up front.
+template<size_t Order>
+static void restore_lpc(i32* samples, size_t sample_count, i32 const* reversed_coefficients, u8 shift)
+{
+    for (size_t i = Order; i < sample_count; ++i) {
+        i64 prediction = 0;
+        for (size_t t = 0; t < Order; ++t)
+            prediction += static_cast<i64>(reversed_coefficients[t]) * samples[i - Order + t];
+        samples[i] += static_cast<i32>(prediction >> shift);
+    }
+}
+
+using LPCRestorer = void (*)(i32*, size_t, i32 const*, u8);
+
+template<unsigned... Orders>
+static constexpr Array<LPCRestorer, sizeof...(Orders)> make_lpc_restorers(IntegerSequence<unsigned, Orders...>)
 {
-    Vector<i32> decoded;
-    decoded.ensure_capacity(m_current_frame->sample_count);
+    return { &restore_lpc<Orders + 1>... };
+}
+
+// LPC subframes have an order of 1 up to 32.
+static constexpr auto s_lpc_restorers = make_lpc_restorers(MakeIndexSequence<32>());
 
+// Decode a subframe encoded with a custom linear predictor coding, i.e. the subframe provides the polynomial order and coefficients
+void FlacLoaderPlugin::decode_custom_lpc(FlacSubframeHeader& subframe, InputBitStream& bit_input, Vector<i32>& decoded)
+{
     // warm-up samples
     for (auto i = 0; i < subframe.order; ++i) {
-        decoded.unchecked_append(sign_extend(bit_input.read_bits_big_endian(subframe.bits_per_sample - subframe.wasted_bits_per_sample), subframe.bits_per_sample));
-        decoded[i] <<= subframe.wasted_bits_per_sample;
+        decoded.unchecked_append(sign_extend(bit_input.read_bits_big_endian(subframe.bits_per_sample - subframe.wasted_bits_per_sample), subframe.bits_per_sample - subframe.wasted_bits_per_sample));
     }
 
     // precision of the coefficients
     u8 lpc_precision = bit_input.read_bits_big_endian(4);
     if (lpc_precision == 0b1111) {
         m_error_string = "Invalid linear predictor coefficient precision";
-        return {};
+        return;
     }
     lpc_precision += 1;
 
     // shift needed on the data (signed!)
     i8 lpc_shift = sign_extend(bit_input.read_bits_big_endian(5), 5);
+    if (lpc_shift < 0) {
+        m_error_string = "Negative linear predictor shift";
+        return;
+    }
 
-    Vector<i32> coefficients;
-    coefficients.ensure_capacity(subframe.order);
+    Array<i32, 32> reversed_coefficients;
     // read coefficients
     for (auto i = 0; i < subframe.order; ++i) {
         u32 raw_coefficient = bit_input.read_bits_big_endian(lpc_precision);
-        i32 coefficient = sign_extend(raw_coefficient, lpc_precision);
-        coefficients.unchecked_append(coefficient);
+        reversed_coefficients[subframe.order - i - 1] = sign_extend(raw_coefficient, lpc_precision);
     }
 
-    dbgln_if(AFLACLOADER_DEBUG, "{}-bit {} shift coefficients: {}", lpc_precision, lpc_shift, coefficients);
+    dbgln_if(AFLACLOADER_DEBUG, "{}-bit {} shift coefficients: {}", lpc_precision, lpc_shift, reversed_coefficients.span().trim(subframe.order));
 
     // decode residual
-    // FIXME: This order may be incorrect, the LPC is applied to the residual, probably leading to incorrect results.
-    decoded = decode_residual(decoded, subframe, bit_input);
+    decode_residual(decoded, subframe, bit_input);
+    if (!m_error_string.is_empty())
+        return;
 
     // approximate the waveform with the predictor
-    for (size_t i = subframe.order; i < m_current_frame->sample_count; ++i) {
-        i32 sample = 0;
-        for (size_t t = 0; t < subframe.order; ++t) {
-            sample += coefficients[t] * decoded[i - t - 1];
-        }
-        decoded[i] += sample >> lpc_shift;
-    }
-
-    return decoded;
+    s_lpc_restorers[subframe.order - 1](decoded.data(), decoded.size(), reversed_coefficients.data(), lpc_shift);
 }
 
 // Decode a subframe encoded with one of the fixed linear predictor codings
-Vector<i32> FlacLoaderPlugin::decode_fixed_lpc(FlacSubframeHeader& subframe, InputBitStream& bit_input)
+void FlacLoaderPlugin::decode_fixed_lpc(FlacSubframeHeader& subframe, InputBitStream& bit_input, Vector<i32>& decoded)
 {
-    Vector<i32> decoded;
-    decoded.ensure_capacity(m_current_frame->sample_count);
-
     // warm-up samples
     for (auto i = 0; i < subframe.order; ++i) {
-        decoded.unchecked_append(bit_input.read_bits_big_endian(subframe.bits_per_sample - subframe.wasted_bits_per_sample));
+        decoded.unchecked_append(sign_extend(bit_input.read_bits_big_endian(subframe.bits_per_sample - subframe.wasted_bits_per_sample), subframe.bits_per_sample - subframe.wasted_bits_per_sample));
     }
 
     decode_residual(decoded, subframe, bit_input);
     if (!m_error_string.is_empty())
-        return {};
+        return;
     dbgln_if(AFLACLOADER_DEBUG, "decoded length {}, {} order predictor", decoded.size(), subframe.order);
 
+    auto* samples = decoded.data();
     switch (subframe.order) {
     case 0:
         // s_0(t) = 0
-        for (u32 i = subframe.order; i < m_current_frame->sample_count; ++i)
-            decoded[i] += 0;
         break;
     case 1:
         // s_1(t) = s(t-1)
-        for (u32 i = subframe.order; i < m_current_frame->sample_count; ++i)
-            decoded[i] += decoded[i - 1];
+        for (size_t i = subframe.order; i < decoded.size(); ++i)
+            samples[i] += samples[i - 1];
         break;
     case 2:
         // s_2(t) = 2s(t-1) - s(t-2)
-        for (u32 i = subframe.order; i < m_current_frame->sample_count; ++i)
-            decoded[i] += 2 * decoded[i - 1] - decoded[i - 2];
+        for (size_t i = subframe.order; i < decoded.size(); ++i)
+            samples[i] += 2 * samples[i - 1] - samples[i - 2];
         break;
     case 3:
         // s_3(t) = 3s(t-1) - 3s(t-2) + s(t-3)
-        for (u32 i = subframe.order; i < m_current_frame->sample_count; ++i)
-            decoded[i] += 3 * decoded[i - 1] - 3 * decoded[i - 2] + decoded[i - 3];
+        for (size_t i = subframe.order; i < decoded.size(); ++i)
+            samples[i] += 3 * samples[i - 1] - 3 * samples[i - 2] + samples[i - 3];
         break;
     case 4:
         // s_4(t) = 4s(t-1) - 6s(t-2) + 4s(t-3) - s(t-4)
-        for (u32 i = subframe.order; i < m_current_frame->sample_count; ++i)
-            decoded[i] += 4 * decoded[i - 1] - 6 * decoded[i - 2] + 4 * decoded[i - 3] - decoded[i - 4];
+        for (size_t i = subframe.order; i < decoded.size(); ++i)
+            samples[i] += 4 * samples[i - 1] - 6 * samples[i - 2] + 4 * samples[i - 3] - samples[i - 4];
         break;
     default:
         m_error_string = String::formatted("Unrecognized predictor order {}", subframe.order);
         break;
     }
-    return decoded;
 }
 
-// Decode the residual, the "error" between the function approximation and the actual audio data
-Vector<i32> FlacLoaderPlugin::decode_residual(Vector<i32>& decoded, FlacSubframeHeader& subframe, InputBitStream& bit_input)
+// Decode the residual, the "error" between the function approximation and the actual audio data, appending it to the warm-up samples
+void FlacLoaderPlugin::decode_residual(Vector<i32>& decoded, FlacSubframeHeader& subframe, InputBitStream& bit_input)
 {
     u8 residual_mode = bit_input.read_bits_big_endian(2);
     u8 partition_order = bit_input.read_bits_big_endian(4);
@@ -724,26 +866,23 @@ Vector<i32> FlacLoaderPlugin::decode_residual(Vector<i32>& decoded, FlacSubframe
 
     if (residual_mode == FlacResidualMode::Rice4Bit) {
         // decode a single Rice partition with four bits for the order k
-        for (u32 i = 0; i < partitions; ++i) {
-            auto rice_partition = decode_rice_partition(4, partitions, i, subframe, bit_input);
-            decoded.extend(move(rice_partition));
-        }
+        for (u32 i = 0; i < partitions; ++i)
+            decode_rice_partition(4, partitions, i, subframe, bit_input, decoded);
     } else if (residual_mode == FlacResidualMode::Rice5Bit) {
         // five bits equivalent
-        for (u32 i = 0; i < partitions; ++i) {
-            auto rice_partition = decode_rice_partition(5, partitions, i, subframe, bit_input);
-            decoded.extend(move(rice_partition));
-        }
+        for (u32 i = 0; i < partitions; ++i)
+            decode_rice_partition(5, partitions, i, subframe, bit_input, decoded);
     } else {
         m_error_string = "Reserved residual coding method";
-        return {};
+        return;
     }
 
-    return decoded;
+    if (decoded.size() != m_current_frame->sample_count)
+        m_error_string = "Residual sample count";
 }
 
 // Decode a single Rice partition as part of the residual, every partition can have its own Rice parameter k
-ALWAYS_INLINE Vector<i32> FlacLoaderPlugin::decode_rice_partition(u8 partition_type, u32 partitions, u32 partition_index, FlacSubframeHeader& subframe, InputBitStream& bit_input)
+ALWAYS_INLINE void FlacLoaderPlugin::decode_rice_partition(u8 partition_type, u32 partitions, u32 partition_index, FlacSubframeHeader& subframe, InputBitStream& bit_input, Vector<i32>& decoded)
 {
     // Rice parameter / Exp-Golomb order
     u8 k = bit_input.read_bits_big_endian(partition_type);
@@ -754,24 +893,21 @@ ALWAYS_INLINE Vector<i32> FlacLoaderPlugin::decode_rice_partition(u8 partition_t
     else
         residual_sample_count = m_current_frame->sample_count / partitions;
     if (partition_index == 0)
-        residual_sample_count -= subframe.order;
+        residual_sample_count -= min(residual_sample_count, (u32)subframe.order);
 
-    Vector<i32> rice_partition;
-    rice_partition.resize(residual_sample_count);
+    decoded.ensure_capacity(decoded.size() + residual_sample_count);
 
     // escape code for unencoded binary partition
     if (k == (1 << partition_type) - 1) {
         u8 unencoded_bps = bit_input.read_bits_big_endian(5);
         for (u32 r = 0; r < residual_sample_count; ++r) {
-            rice_partition[r] = bit_input.read_bits_big_endian(unencoded_bps);
+            decoded.unchecked_append(bit_input.read_bits_big_endian(unencoded_bps));
         }
     } else {
         for (u32 r = 0; r < residual_sample_count; ++r) {
-            rice_partition[r] = decode_unsigned_exp_golomb(k, bit_input);
+            decoded.unchecked_append(decode_unsigned_exp_golomb(k, bit_input));
         }
     }
-
-    return rice_partition;
 }
 
 // Decode a single number encoded with Rice/Exponential-Golomb encoding (the unsigned variant)
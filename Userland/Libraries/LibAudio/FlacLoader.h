@@ -12,31 +12,36 @@
 #include <AK/BitStream.h>
 #include <AK/Stream.h>
 #include <AK/Types.h>
-#include <AK/Variant.h>
-#include <LibCore/FileStream.h>
+#include <LibCore/File.h>
 
 namespace Audio {
 
-class FlacInputStream : public Variant<Core::InputFileStream, InputMemoryStream> {
-
+// Reads FLAC data from a file in large chunks, or straight from memory, and keeps track of the offset into the stream so
+// that frames can be found again when seeking.
+class FlacInputStream final : public InputStream {
 public:
-    using Variant<Core::InputFileStream, InputMemoryStream>::Variant;
-
-    void seek(size_t pos)
-    {
-        this->visit(
-            [&](auto& stream) {
-                stream.seek(pos);
-            });
-    }
-
-    InputBitStream bit_stream()
-    {
-        return this->visit(
-            [&](auto& stream) {
-                return InputBitStream(stream);
-            });
-    }
+    explicit FlacInputStream(NonnullRefPtr<Core::File>);
+    explicit FlacInputStream(ReadonlyBytes);
+    // A stream cut short leaves a read error behind, which is reported through the loader's error string instead.
+    virtual ~FlacInputStream() override { handle_any_error(); }
+
+    virtual size_t read(Bytes) override;
+    virtual bool unreliable_eof() const override;
+    virtual bool read_or_error(Bytes) override;
+    virtual bool discard_or_error(size_t count) override;
+
+    u64 offset() const { return m_buffer_offset + m_position_in_buffer; }
+    bool seek(u64 offset);
+
+private:
+    bool fill_buffer();
+
+    RefPtr<Core::File> m_file;
+    ByteBuffer m_file_buffer;
+    // The part of the stream we currently have, and where it starts in the stream.
+    ReadonlyBytes m_buffer;
+    u64 m_buffer_offset { 0 };
+    size_t m_position_in_buffer { 0 };
 };
 
 ALWAYS_INLINE u8 frame_channel_type_to_channel_count(FlacFrameChannelType channel_type);
@@ -86,15 +91,19 @@ private:
     void next_frame();
     // Helper of next_frame that fetches a sub frame's header
     FlacSubframeHeader next_subframe_header(InputBitStream& bit_input, u8 channel_index);
-    // Helper of next_frame that decompresses a subframe
-    Vector<i32> parse_subframe(FlacSubframeHeader& subframe_header, InputBitStream& bit_input);
+    // Helper of next_frame that decompresses a subframe into the given samples
+    void parse_subframe(FlacSubframeHeader& subframe_header, InputBitStream& bit_input, Vector<i32>& samples);
     // Subframe-internal data decoders (heavy lifting)
-    Vector<i32> decode_fixed_lpc(FlacSubframeHeader& subframe, InputBitStream& bit_input);
-    Vector<i32> decode_verbatim(FlacSubframeHeader& subframe, InputBitStream& bit_input);
-    Vector<i32> decode_custom_lpc(FlacSubframeHeader& subframe, InputBitStream& bit_input);
-    Vector<i32> decode_residual(Vector<i32>& decoded, FlacSubframeHeader& subframe, InputBitStream& bit_input);
+    void decode_fixed_lpc(FlacSubframeHeader& subframe, InputBitStream& bit_input, Vector<i32>& decoded);
+    void decode_verbatim(FlacSubframeHeader& subframe, InputBitStream& bit_input, Vector<i32>& decoded);
+    void decode_custom_lpc(FlacSubframeHeader& subframe, InputBitStream& bit_input, Vector<i32>& decoded);
+    void decode_residual(Vector<i32>& decoded, FlacSubframeHeader& subframe, InputBitStream& bit_input);
     // decode a single rice partition that has its own rice parameter
-    ALWAYS_INLINE Vector<i32> decode_rice_partition(u8 partition_type, u32 partitions, u32 partition_index, FlacSubframeHeader& subframe, InputBitStream& bit_input);
+    ALWAYS_INLINE void decode_rice_partition(u8 partition_type, u32 partitions, u32 partition_index, FlacSubframeHeader& subframe, InputBitStream& bit_input, Vector<i32>& decoded);
+
+    void parse_seektable(ReadonlyBytes);
+    // The last frame we know of that starts at or before the given sample.
+    FlacSeekPoint nearest_seek_point(u64 sample_index) const;
 
     // Converters for special coding used in frame headers
     ALWAYS_INLINE u32 convert_sample_count_code(u8 sample_count_code);
@@ -125,7 +134,17 @@ private:
     OwnPtr<FlacInputStream> m_stream;
     Optional<FlacFrameHeader> m_current_frame;
     Vector<Frame> m_current_frame_data;
+    // How many of the current frame's samples were handed out already.
+    size_t m_current_frame_position { 0 };
+    u64 m_current_frame_first_sample { 0 };
+    u64 m_next_frame_first_sample { 0 };
     u64 m_current_sample_or_frame { 0 };
+    // The samples of each channel of the current frame; kept around so that decoding doesn't allocate for every frame.
+    Vector<Vector<i32>> m_subframe_samples;
+
+    // Where frames start, sorted by their first sample. Filled from the SEEKTABLE if there is one, and with every frame
+    // we decode, so that seeking back to anything that was played once only needs to decode a single frame.
+    Vector<FlacSeekPoint> m_seek_points;
 };
 
 }
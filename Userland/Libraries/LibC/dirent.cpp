@@ -30,6 +30,7 @@ DIR* opendir(const char* name)
     dirp->buffer = nullptr;
     dirp->buffer_size = 0;
     dirp->nextptr = nullptr;
+    dirp->buffer_has_stat = 0;
     return dirp;
 }
 
@@ -51,6 +52,7 @@ void rewinddir(DIR* dirp)
     dirp->buffer = nullptr;
     dirp->buffer_size = 0;
     dirp->nextptr = nullptr;
+    dirp->buffer_has_stat = 0;
     lseek(dirp->fd, 0, SEEK_SET);
 }
 
@@ -65,6 +67,12 @@ struct [[gnu::packed]] sys_dirent {
     }
 };
 
+// In buffers from get_dir_entries_with_stat(), each entry is followed by its struct stat.
+static size_t sys_dirent_stride(DIR* dirp, sys_dirent* sys_ent)
+{
+    return sys_ent->total_size() + (dirp->buffer_has_stat ? sizeof(struct stat) : 0);
+}
+
 static void create_struct_dirent(sys_dirent* sys_ent, struct dirent* str_ent)
 {
     str_ent->d_ino = sys_ent->ino;
@@ -81,7 +89,7 @@ static void create_struct_dirent(sys_dirent* sys_ent, struct dirent* str_ent)
     str_ent->d_name[sys_ent->namelen] = '\0';
 }
 
-static int allocate_dirp_buffer(DIR* dirp)
+static int allocate_dirp_buffer(DIR* dirp, bool with_stat = false)
 {
     if (dirp->buffer) {
         return 0;
@@ -101,7 +109,7 @@ static int allocate_dirp_buffer(DIR* dirp)
     if (!dirp->buffer)
         return ENOMEM;
     for (;;) {
-        ssize_t nread = syscall(SC_get_dir_entries, dirp->fd, dirp->buffer, size_to_allocate);
+        ssize_t nread = syscall(with_stat ? SC_get_dir_entries_with_stat : SC_get_dir_entries, dirp->fd, dirp->buffer, size_to_allocate);
         if (nread < 0) {
             if (nread == -EINVAL) {
                 size_to_allocate *= 2;
@@ -120,6 +128,7 @@ static int allocate_dirp_buffer(DIR* dirp)
         }
         dirp->buffer_size = nread;
         dirp->nextptr = dirp->buffer;
+        dirp->buffer_has_stat = with_stat;
         break;
     }
     return 0;
@@ -144,7 +153,39 @@ dirent* readdir(DIR* dirp)
     auto* sys_ent = (sys_dirent*)dirp->nextptr;
     create_struct_dirent(sys_ent, &dirp->cur_ent);
 
-    dirp->nextptr += sys_ent->total_size();
+    dirp->nextptr += sys_dirent_stride(dirp, sys_ent);
+    return &dirp->cur_ent;
+}
+
+dirent* readdir_with_stat(DIR* dirp, struct stat* statbuf)
+{
+    if (!dirp)
+        return nullptr;
+    if (dirp->fd == -1)
+        return nullptr;
+
+    if (int new_errno = allocate_dirp_buffer(dirp, true)) {
+        errno = new_errno;
+        return nullptr;
+    }
+
+    if (dirp->nextptr >= (dirp->buffer + dirp->buffer_size))
+        return nullptr;
+
+    auto* sys_ent = (sys_dirent*)dirp->nextptr;
+    create_struct_dirent(sys_ent, &dirp->cur_ent);
+
+    if (dirp->buffer_has_stat)
+        memcpy(statbuf, sys_ent->name + sys_ent->namelen, sizeof(struct stat));
+    // The buffer came from plain readdir() calls, or the entry went away before the kernel got to stat it.
+    if (!dirp->buffer_has_stat || statbuf->st_mode == 0) {
+        int old_errno = errno;
+        if (fstatat(dirp->fd, dirp->cur_ent.d_name, statbuf, AT_SYMLINK_NOFOLLOW) < 0)
+            memset(statbuf, 0, sizeof(struct stat));
+        errno = old_errno;
+    }
+
+    dirp->nextptr += sys_dirent_stride(dirp, sys_ent);
     return &dirp->cur_ent;
 }
 
@@ -180,7 +221,7 @@ int readdir_r(DIR* dirp, struct dirent* entry, struct dirent** result)
         found = compare_sys_struct_dirent(sys_ent, entry);
 
         // Make sure if we found one, it's the one after (end of buffer or not)
-        buffer += sys_ent->total_size();
+        buffer += sys_dirent_stride(dirp, sys_ent);
         sys_ent = (sys_dirent*)buffer;
     }
 
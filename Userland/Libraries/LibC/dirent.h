@@ -45,6 +45,7 @@ struct __DIR {
     char* buffer;
     size_t buffer_size;
     char* nextptr;
+    int buffer_has_stat;
 };
 typedef struct __DIR DIR;
 
@@ -53,6 +54,10 @@ int closedir(DIR*);
 void rewinddir(DIR*);
 struct dirent* readdir(DIR*);
 int readdir_r(DIR*, struct dirent*, struct dirent**);
+// SerenityOS extension: like readdir(), but also fills in *statbuf as if by lstat() on the entry.
+// The kernel hands out all entries of the directory along with their metadata at once.
+struct stat;
+struct dirent* readdir_with_stat(DIR*, struct stat* statbuf);
 int dirfd(DIR*);
 
 int scandir(const char* dirp, struct dirent*** namelist,
@@ -86,4 +86,19 @@ int openat(int dirfd, const char* path, int options, ...)
     int rc = syscall(SC_open, &params);
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
+
+int posix_fadvise(int fd, off_t offset, off_t len, int advice)
+{
+    // Unlike most functions, posix_fadvise() returns the error instead of setting errno.
+    Syscall::SC_posix_fadvise_params params { fd, offset, len, advice };
+    int rc = syscall(SC_posix_fadvise, &params);
+    return rc < 0 ? -rc : 0;
+}
+
+ssize_t splice(int fd_in, off_t* off_in, int fd_out, off_t* off_out, size_t len, unsigned flags)
+{
+    Syscall::SC_splice_params params { fd_in, off_in, fd_out, off_out, len, flags };
+    int rc = syscall(SC_splice, &params);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
 }
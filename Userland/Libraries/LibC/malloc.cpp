@@ -37,16 +37,28 @@ private:
 
 #define RECYCLE_BIG_ALLOCATIONS
 
+// Every thread allocates from a block per size class that it owns, which it can do without taking the lock.
+// The dynamic loader doesn't have thread-local storage, so it always goes through the global allocators.
+#ifndef NO_TLS
+#    define THREAD_LOCAL_BLOCK_CACHES
+#endif
+
 static pthread_mutex_t s_malloc_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 constexpr size_t number_of_hot_chunked_blocks_to_keep_around = 16;
-constexpr size_t number_of_cold_chunked_blocks_to_keep_around = 16;
-constexpr size_t number_of_big_blocks_to_keep_around_per_size_class = 8;
+// Cold blocks and kept big blocks are volatile, so the kernel can take their memory back whenever it needs it.
+// Keeping plenty of them around is cheap, and saves us from unmapping and mapping them again in bursts.
+constexpr size_t number_of_cold_chunked_blocks_to_keep_around = 64;
+// Big allocations up to this many chunked blocks in size are recycled, with one size class per block.
+constexpr size_t number_of_big_block_size_classes = 8;
+constexpr size_t big_block_bytes_to_keep_around_per_size_class = 512 * KiB;
+constexpr size_t number_of_big_blocks_to_keep_around_per_size_class = big_block_bytes_to_keep_around_per_size_class / ChunkedBlock::block_size;
 
 static bool s_log_malloc = false;
 static bool s_scrub_malloc = true;
 static bool s_scrub_free = true;
 static bool s_profiling = false;
+static bool s_track_size_classes = false;
 static bool s_in_userspace_emulator = false;
 
 ALWAYS_INLINE static void ue_notify_malloc(const void* ptr, size_t size)
@@ -85,8 +97,10 @@ struct MallocStats {
     size_t number_of_cold_empty_block_purge_hits;
     size_t number_of_block_allocs;
     size_t number_of_blocks_full;
+    size_t number_of_thread_cache_refills;
 
     size_t number_of_free_calls;
+    size_t number_of_remote_frees;
 
     size_t number_of_big_allocator_keeps;
     size_t number_of_big_allocator_frees;
@@ -108,6 +122,10 @@ struct Allocator {
     size_t block_count { 0 };
     ChunkedBlock::List usable_blocks;
     ChunkedBlock::List full_blocks;
+
+    // Only kept track of when LIBC_DUMP_MALLOC_INFO is set, to see how much the size classes round up.
+    Atomic<size_t, AK::memory_order_relaxed> number_of_allocations { 0 };
+    Atomic<size_t, AK::memory_order_relaxed> bytes_requested { 0 };
 };
 
 struct BigAllocator {
@@ -121,21 +139,33 @@ struct BigAllocator {
 // them. We could have used AK::NeverDestoyed to prevent the latter,
 // but it would have not helped with the former.
 alignas(Allocator) static u8 g_allocators_storage[sizeof(Allocator) * num_size_classes];
-alignas(BigAllocator) static u8 g_big_allocators_storage[sizeof(BigAllocator)];
+alignas(BigAllocator) static u8 g_big_allocators_storage[sizeof(BigAllocator) * number_of_big_block_size_classes];
 
 static inline Allocator (&allocators())[num_size_classes]
 {
     return reinterpret_cast<Allocator(&)[num_size_classes]>(g_allocators_storage);
 }
 
-static inline BigAllocator (&big_allocators())[1]
+#ifdef THREAD_LOCAL_BLOCK_CACHES
+struct ThreadCache {
+    ChunkedBlock* blocks[num_size_classes];
+};
+static __thread ThreadCache t_thread_cache;
+#endif
+
+static inline BigAllocator (&big_allocators())[number_of_big_block_size_classes]
 {
-    return reinterpret_cast<BigAllocator(&)[1]>(g_big_allocators_storage);
+    return reinterpret_cast<BigAllocator(&)[number_of_big_block_size_classes]>(g_big_allocators_storage);
 }
 
 static Allocator* allocator_for_size(size_t size, size_t& good_size)
 {
-    for (size_t i = 0; size_classes[i]; ++i) {
+    if (size <= largest_small_size_class) {
+        size_t index = size ? (size - 1) / small_size_class_granularity : 0;
+        good_size = size_classes[index];
+        return &allocators()[index];
+    }
+    for (size_t i = largest_small_size_class / small_size_class_granularity; size_classes[i]; ++i) {
         if (size <= size_classes[i]) {
             good_size = size_classes[i];
             return &allocators()[i];
@@ -148,9 +178,12 @@ static Allocator* allocator_for_size(size_t size, size_t& good_size)
 #ifdef RECYCLE_BIG_ALLOCATIONS
 static BigAllocator* big_allocator_for_size(size_t size)
 {
-    if (size == 65536)
-        return &big_allocators()[0];
-    return nullptr;
+    if (size % ChunkedBlock::block_size)
+        return nullptr;
+    size_t number_of_blocks = size / ChunkedBlock::block_size;
+    if (number_of_blocks > number_of_big_block_size_classes)
+        return nullptr;
+    return &big_allocators()[number_of_blocks - 1];
 }
 #endif
 
@@ -178,67 +211,55 @@ enum class CallerWillInitializeMemory {
     Yes,
 };
 
-static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_initialize_memory)
+static void* malloc_big(size_t size)
 {
-    if (s_log_malloc)
-        dbgln("LibC: malloc({})", size);
-
-    if (!size) {
-        // Legally we could just return a null pointer here, but this is more
-        // compatible with existing software.
-        size = 1;
-    }
-
-    g_malloc_stats.number_of_malloc_calls++;
-
-    size_t good_size;
-    auto* allocator = allocator_for_size(size, good_size);
+    size_t real_size = round_up_to_power_of_two(sizeof(BigAllocationBlock) + size, ChunkedBlock::block_size);
 
     PthreadMutexLocker locker(s_malloc_mutex);
 
-    if (!allocator) {
-        size_t real_size = round_up_to_power_of_two(sizeof(BigAllocationBlock) + size, ChunkedBlock::block_size);
 #ifdef RECYCLE_BIG_ALLOCATIONS
-        if (auto* allocator = big_allocator_for_size(real_size)) {
-            if (!allocator->blocks.is_empty()) {
-                g_malloc_stats.number_of_big_allocator_hits++;
-                auto* block = allocator->blocks.take_last();
-                int rc = madvise(block, real_size, MADV_SET_NONVOLATILE);
-                bool this_block_was_purged = rc == 1;
-                if (rc < 0) {
-                    perror("madvise");
-                    VERIFY_NOT_REACHED();
-                }
-                if (mprotect(block, real_size, PROT_READ | PROT_WRITE) < 0) {
-                    perror("mprotect");
-                    VERIFY_NOT_REACHED();
-                }
-                if (this_block_was_purged) {
-                    g_malloc_stats.number_of_big_allocator_purge_hits++;
-                    new (block) BigAllocationBlock(real_size);
-                }
-
-                ue_notify_malloc(&block->m_slot[0], size);
-                return &block->m_slot[0];
+    if (auto* allocator = big_allocator_for_size(real_size)) {
+        if (!allocator->blocks.is_empty()) {
+            g_malloc_stats.number_of_big_allocator_hits++;
+            auto* block = allocator->blocks.take_last();
+            int rc = madvise(block, real_size, MADV_SET_NONVOLATILE);
+            bool this_block_was_purged = rc == 1;
+            if (rc < 0) {
+                perror("madvise");
+                VERIFY_NOT_REACHED();
+            }
+            if (mprotect(block, real_size, PROT_READ | PROT_WRITE) < 0) {
+                perror("mprotect");
+                VERIFY_NOT_REACHED();
+            }
+            if (this_block_was_purged) {
+                g_malloc_stats.number_of_big_allocator_purge_hits++;
+                new (block) BigAllocationBlock(real_size);
             }
+
+            ue_notify_malloc(&block->m_slot[0], size);
+            return &block->m_slot[0];
         }
-#endif
-        g_malloc_stats.number_of_big_allocs++;
-        auto* block = (BigAllocationBlock*)os_alloc(real_size, "malloc: BigAllocationBlock");
-        new (block) BigAllocationBlock(real_size);
-        ue_notify_malloc(&block->m_slot[0], size);
-        return &block->m_slot[0];
     }
+#endif
+    g_malloc_stats.number_of_big_allocs++;
+    auto* block = (BigAllocationBlock*)os_alloc(real_size, "malloc: BigAllocationBlock");
+    new (block) BigAllocationBlock(real_size);
+    ue_notify_malloc(&block->m_slot[0], size);
+    return &block->m_slot[0];
+}
 
-    ChunkedBlock* block = nullptr;
-    for (auto& current : allocator->usable_blocks) {
-        if (current.free_chunks()) {
-            block = &current;
-            break;
-        }
+// Finds a block with free chunks in the allocator's usable blocks, taking an empty one or making a new one if there is none.
+// Must be called with the malloc mutex held.
+static ChunkedBlock* find_or_create_usable_block(Allocator& allocator, size_t good_size)
+{
+    for (auto& current : allocator.usable_blocks) {
+        if (current.free_chunks())
+            return &current;
     }
 
-    if (!block && s_hot_empty_block_count) {
+    ChunkedBlock* block = nullptr;
+    if (s_hot_empty_block_count) {
         g_malloc_stats.number_of_hot_empty_block_hits++;
         block = s_hot_empty_blocks[--s_hot_empty_block_count];
         if (block->m_size != good_size) {
@@ -248,10 +269,11 @@ static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_ini
             snprintf(buffer, sizeof(buffer), "malloc: ChunkedBlock(%zu)", good_size);
             set_mmap_name(block, ChunkedBlock::block_size, buffer);
         }
-        allocator->usable_blocks.append(*block);
+        allocator.usable_blocks.append(*block);
+        return block;
     }
 
-    if (!block && s_cold_empty_block_count) {
+    if (s_cold_empty_block_count) {
         g_malloc_stats.number_of_cold_empty_block_hits++;
         block = s_cold_empty_blocks[--s_cold_empty_block_count];
         int rc = madvise(block, ChunkedBlock::block_size, MADV_SET_NONVOLATILE);
@@ -271,43 +293,210 @@ static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_ini
             new (block) ChunkedBlock(good_size);
             ue_notify_chunk_size_changed(block, good_size);
         }
-        allocator->usable_blocks.append(*block);
+        allocator.usable_blocks.append(*block);
+        return block;
     }
 
-    if (!block) {
-        g_malloc_stats.number_of_block_allocs++;
-        char buffer[64];
-        snprintf(buffer, sizeof(buffer), "malloc: ChunkedBlock(%zu)", good_size);
-        block = (ChunkedBlock*)os_alloc(ChunkedBlock::block_size, buffer);
-        new (block) ChunkedBlock(good_size);
-        allocator->usable_blocks.append(*block);
-        ++allocator->block_count;
-    }
+    g_malloc_stats.number_of_block_allocs++;
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "malloc: ChunkedBlock(%zu)", good_size);
+    block = (ChunkedBlock*)os_alloc(ChunkedBlock::block_size, buffer);
+    new (block) ChunkedBlock(good_size);
+    allocator.usable_blocks.append(*block);
+    ++allocator.block_count;
+    return block;
+}
 
-    --block->m_free_chunks;
-    void* ptr = block->m_freelist;
+static void* take_chunk(ChunkedBlock& block)
+{
+    --block.m_free_chunks;
+    void* ptr = block.m_freelist;
     if (ptr) {
-        block->m_freelist = block->m_freelist->next;
+        block.m_freelist = block.m_freelist->next;
     } else {
-        ptr = block->m_slot + block->m_next_lazy_freelist_index * block->m_size;
-        block->m_next_lazy_freelist_index++;
+        ptr = block.m_slot + block.m_next_lazy_freelist_index * block.m_size;
+        block.m_next_lazy_freelist_index++;
     }
     VERIFY(ptr);
-    if (block->is_full()) {
+    return ptr;
+}
+
+// Keeps an empty block around for later, or gives it back to the system if we already have enough of those.
+// Must be called with the malloc mutex held, and with the block not being on any of the allocator's lists.
+static void retire_empty_block(Allocator& allocator, ChunkedBlock* block)
+{
+    if (s_hot_empty_block_count < number_of_hot_chunked_blocks_to_keep_around) {
+        dbgln_if(MALLOC_DEBUG, "Keeping hot block {:p} around", block);
+        g_malloc_stats.number_of_hot_keeps++;
+        s_hot_empty_blocks[s_hot_empty_block_count++] = block;
+        return;
+    }
+    if (s_cold_empty_block_count < number_of_cold_chunked_blocks_to_keep_around) {
+        dbgln_if(MALLOC_DEBUG, "Keeping cold block {:p} around", block);
+        g_malloc_stats.number_of_cold_keeps++;
+        s_cold_empty_blocks[s_cold_empty_block_count++] = block;
+        mprotect(block, ChunkedBlock::block_size, PROT_NONE);
+        madvise(block, ChunkedBlock::block_size, MADV_SET_VOLATILE);
+        return;
+    }
+    dbgln_if(MALLOC_DEBUG, "Releasing block {:p} for size class {}", block, block->m_size);
+    g_malloc_stats.number_of_frees++;
+    --allocator.block_count;
+    os_free(block, ChunkedBlock::block_size);
+}
+
+#ifdef THREAD_LOCAL_BLOCK_CACHES
+// Moves the chunks other threads have freed into the block over to its freelist, and returns how many there were.
+// The remote freelist is replaced with an empty one if we keep owning the block, or closed if we're giving it up.
+static size_t reclaim_remote_frees(ChunkedBlock& block, FreelistEntry* new_remote_freelist)
+{
+    auto* entry = block.m_remote_freelist.exchange(new_remote_freelist, AK::memory_order_acq_rel);
+    VERIFY(entry != ChunkedBlock::remote_freelist_closed());
+    size_t count = 0;
+    while (entry) {
+        auto* next = entry->next;
+        entry->next = block.m_freelist;
+        block.m_freelist = entry;
+        entry = next;
+        ++count;
+    }
+    block.m_free_chunks += count;
+    return count;
+}
+
+// Hands a block from a thread cache back to its allocator. Must be called with the malloc mutex held.
+static void release_cached_block(Allocator& allocator, ChunkedBlock* block)
+{
+    block->m_owner.store(0);
+    reclaim_remote_frees(*block, ChunkedBlock::remote_freelist_closed());
+    if (!block->used_chunks()) {
+        retire_empty_block(allocator, block);
+    } else if (block->is_full()) {
         g_malloc_stats.number_of_blocks_full++;
-        dbgln_if(MALLOC_DEBUG, "Block {:p} is now full in size class {}", block, good_size);
-        allocator->usable_blocks.remove(*block);
-        allocator->full_blocks.append(*block);
+        dbgln_if(MALLOC_DEBUG, "Block {:p} is now full in size class {}", block, block->m_size);
+        allocator.full_blocks.append(*block);
+    } else {
+        allocator.usable_blocks.append(*block);
+    }
+}
+
+static void* malloc_from_thread_cache(Allocator& allocator, size_t good_size)
+{
+    auto& cached_block = t_thread_cache.blocks[&allocator - allocators()];
+    if (cached_block && (!cached_block->is_full() || reclaim_remote_frees(*cached_block, nullptr)))
+        return take_chunk(*cached_block);
+
+    PthreadMutexLocker locker(s_malloc_mutex);
+    g_malloc_stats.number_of_thread_cache_refills++;
+    if (cached_block)
+        release_cached_block(allocator, cached_block);
+    cached_block = find_or_create_usable_block(allocator, good_size);
+    allocator.usable_blocks.remove(*cached_block);
+    cached_block->m_owner.store((FlatPtr)&t_thread_cache);
+    cached_block->m_remote_freelist.store(nullptr, AK::memory_order_release);
+    dbgln_if(MALLOC_DEBUG, "Block {:p} is now owned by the thread cache {:p}", cached_block, &t_thread_cache);
+    return take_chunk(*cached_block);
+}
+#endif
+
+static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_initialize_memory)
+{
+    if (s_log_malloc)
+        dbgln("LibC: malloc({})", size);
+
+    if (!size) {
+        // Legally we could just return a null pointer here, but this is more
+        // compatible with existing software.
+        size = 1;
+    }
+
+    g_malloc_stats.number_of_malloc_calls++;
+
+    size_t good_size;
+    auto* allocator = allocator_for_size(size, good_size);
+    if (!allocator)
+        return malloc_big(size);
+
+    if (s_track_size_classes) {
+        allocator->number_of_allocations++;
+        allocator->bytes_requested += size;
     }
-    dbgln_if(MALLOC_DEBUG, "LibC: allocated {:p} (chunk in block {:p}, size {})", ptr, block, block->bytes_per_chunk());
+
+#ifdef THREAD_LOCAL_BLOCK_CACHES
+    void* ptr = malloc_from_thread_cache(*allocator, good_size);
+#else
+    void* ptr = nullptr;
+    {
+        PthreadMutexLocker locker(s_malloc_mutex);
+        auto* block = find_or_create_usable_block(*allocator, good_size);
+        ptr = take_chunk(*block);
+        if (block->is_full()) {
+            g_malloc_stats.number_of_blocks_full++;
+            dbgln_if(MALLOC_DEBUG, "Block {:p} is now full in size class {}", block, good_size);
+            allocator->usable_blocks.remove(*block);
+            allocator->full_blocks.append(*block);
+        }
+    }
+#endif
+    dbgln_if(MALLOC_DEBUG, "LibC: allocated {:p} (chunk in block {:p}, size {})", ptr, (void*)((FlatPtr)ptr & ChunkedBlock::block_mask), good_size);
 
     if (s_scrub_malloc && caller_will_initialize_memory == CallerWillInitializeMemory::No)
-        memset(ptr, MALLOC_SCRUB_BYTE, block->m_size);
+        memset(ptr, MALLOC_SCRUB_BYTE, good_size);
 
     ue_notify_malloc(ptr, size);
     return ptr;
 }
 
+static void free_big(BigAllocationBlock* block)
+{
+    PthreadMutexLocker locker(s_malloc_mutex);
+
+#ifdef RECYCLE_BIG_ALLOCATIONS
+    if (auto* allocator = big_allocator_for_size(block->m_size)) {
+        if (allocator->blocks.size() < big_block_bytes_to_keep_around_per_size_class / block->m_size) {
+            g_malloc_stats.number_of_big_allocator_keeps++;
+            allocator->blocks.append(block);
+            size_t this_block_size = block->m_size;
+            if (mprotect(block, this_block_size, PROT_NONE) < 0) {
+                perror("mprotect");
+                VERIFY_NOT_REACHED();
+            }
+            if (madvise(block, this_block_size, MADV_SET_VOLATILE) != 0) {
+                perror("madvise");
+                VERIFY_NOT_REACHED();
+            }
+            return;
+        }
+    }
+#endif
+    g_malloc_stats.number_of_big_allocator_frees++;
+    os_free(block, block->m_size);
+}
+
+// Puts a chunk back into a block that no thread cache owns. Must be called with the malloc mutex held.
+static void free_to_block(ChunkedBlock* block, FreelistEntry* entry)
+{
+    entry->next = block->m_freelist;
+    block->m_freelist = entry;
+
+    size_t good_size;
+    auto* allocator = allocator_for_size(block->m_size, good_size);
+
+    if (block->is_full()) {
+        dbgln_if(MALLOC_DEBUG, "Block {:p} no longer full in size class {}", block, good_size);
+        g_malloc_stats.number_of_freed_full_blocks++;
+        allocator->full_blocks.remove(*block);
+        allocator->usable_blocks.prepend(*block);
+    }
+
+    ++block->m_free_chunks;
+
+    if (!block->used_chunks()) {
+        allocator->usable_blocks.remove(*block);
+        retire_empty_block(*allocator, block);
+    }
+}
+
 static void free_impl(void* ptr)
 {
     ScopedValueRollback rollback(errno);
@@ -320,30 +509,8 @@ static void free_impl(void* ptr)
     void* block_base = (void*)((FlatPtr)ptr & ChunkedBlock::ChunkedBlock::block_mask);
     size_t magic = *(size_t*)block_base;
 
-    PthreadMutexLocker locker(s_malloc_mutex);
-
     if (magic == MAGIC_BIGALLOC_HEADER) {
-        auto* block = (BigAllocationBlock*)block_base;
-#ifdef RECYCLE_BIG_ALLOCATIONS
-        if (auto* allocator = big_allocator_for_size(block->m_size)) {
-            if (allocator->blocks.size() < number_of_big_blocks_to_keep_around_per_size_class) {
-                g_malloc_stats.number_of_big_allocator_keeps++;
-                allocator->blocks.append(block);
-                size_t this_block_size = block->m_size;
-                if (mprotect(block, this_block_size, PROT_NONE) < 0) {
-                    perror("mprotect");
-                    VERIFY_NOT_REACHED();
-                }
-                if (madvise(block, this_block_size, MADV_SET_VOLATILE) != 0) {
-                    perror("madvise");
-                    VERIFY_NOT_REACHED();
-                }
-                return;
-            }
-        }
-#endif
-        g_malloc_stats.number_of_big_allocator_frees++;
-        os_free(block, block->m_size);
+        free_big((BigAllocationBlock*)block_base);
         return;
     }
 
@@ -356,45 +523,36 @@ static void free_impl(void* ptr)
         memset(ptr, FREE_SCRUB_BYTE, block->bytes_per_chunk());
 
     auto* entry = (FreelistEntry*)ptr;
-    entry->next = block->m_freelist;
-    block->m_freelist = entry;
 
-    if (block->is_full()) {
-        size_t good_size;
-        auto* allocator = allocator_for_size(block->m_size, good_size);
-        dbgln_if(MALLOC_DEBUG, "Block {:p} no longer full in size class {}", block, good_size);
-        g_malloc_stats.number_of_freed_full_blocks++;
-        allocator->full_blocks.remove(*block);
-        allocator->usable_blocks.prepend(*block);
+#ifdef THREAD_LOCAL_BLOCK_CACHES
+    if (block->m_owner.load() == (FlatPtr)&t_thread_cache) {
+        entry->next = block->m_freelist;
+        block->m_freelist = entry;
+        ++block->m_free_chunks;
+        return;
     }
 
-    ++block->m_free_chunks;
-
-    if (!block->used_chunks()) {
-        size_t good_size;
-        auto* allocator = allocator_for_size(block->m_size, good_size);
-        if (s_hot_empty_block_count < number_of_hot_chunked_blocks_to_keep_around) {
-            dbgln_if(MALLOC_DEBUG, "Keeping hot block {:p} around", block);
-            g_malloc_stats.number_of_hot_keeps++;
-            allocator->usable_blocks.remove(*block);
-            s_hot_empty_blocks[s_hot_empty_block_count++] = block;
-            return;
-        }
-        if (s_cold_empty_block_count < number_of_cold_chunked_blocks_to_keep_around) {
-            dbgln_if(MALLOC_DEBUG, "Keeping cold block {:p} around", block);
-            g_malloc_stats.number_of_cold_keeps++;
-            allocator->usable_blocks.remove(*block);
-            s_cold_empty_blocks[s_cold_empty_block_count++] = block;
-            mprotect(block, ChunkedBlock::block_size, PROT_NONE);
-            madvise(block, ChunkedBlock::block_size, MADV_SET_VOLATILE);
-            return;
+    for (;;) {
+        auto* head = block->m_remote_freelist.load(AK::memory_order_relaxed);
+        while (head != ChunkedBlock::remote_freelist_closed()) {
+            entry->next = head;
+            if (block->m_remote_freelist.compare_exchange_strong(head, entry, AK::memory_order_release)) {
+                g_malloc_stats.number_of_remote_frees++;
+                return;
+            }
         }
-        dbgln_if(MALLOC_DEBUG, "Releasing block {:p} for size class {}", block, good_size);
-        g_malloc_stats.number_of_frees++;
-        allocator->usable_blocks.remove(*block);
-        --allocator->block_count;
-        os_free(block, ChunkedBlock::block_size);
+
+        PthreadMutexLocker locker(s_malloc_mutex);
+        // Blocks are only handed to thread caches with the lock held, but one may have taken this block while we were waiting for it.
+        if (block->m_remote_freelist.load(AK::memory_order_relaxed) != ChunkedBlock::remote_freelist_closed())
+            continue;
+        free_to_block(block, entry);
+        return;
     }
+#else
+    PthreadMutexLocker locker(s_malloc_mutex);
+    free_to_block(block, entry);
+#endif
 }
 
 [[gnu::flatten]] void* malloc(size_t size)
@@ -488,13 +646,65 @@ void __malloc_init()
         s_log_malloc = true;
     if (secure_getenv("LIBC_PROFILE_MALLOC"))
         s_profiling = true;
+    if (secure_getenv("LIBC_DUMP_MALLOC_INFO"))
+        s_track_size_classes = true;
 
     for (size_t i = 0; i < num_size_classes; ++i) {
         new (&allocators()[i]) Allocator();
         allocators()[i].size = size_classes[i];
     }
 
-    new (&big_allocators()[0])(BigAllocator);
+    for (size_t i = 0; i < number_of_big_block_size_classes; ++i)
+        new (&big_allocators()[i])(BigAllocator);
+}
+
+void __malloc_release_caches_for_current_thread()
+{
+#ifdef THREAD_LOCAL_BLOCK_CACHES
+    PthreadMutexLocker locker(s_malloc_mutex);
+    for (size_t i = 0; i < num_size_classes; ++i) {
+        if (auto* block = exchange(t_thread_cache.blocks[i], nullptr))
+            release_cached_block(allocators()[i], block);
+    }
+#endif
+}
+
+// Shows how the memory of every size class is used. The chunks of blocks that are owned by a thread cache aren't
+// counted as in use, since only their owner can look at them. Allocations are only counted with LIBC_DUMP_MALLOC_INFO.
+void serenity_dump_malloc_info()
+{
+    PthreadMutexLocker locker(s_malloc_mutex);
+    dbgln("size class | blocks | cached | chunks in use | capacity | allocations | avg. requested | rounded up");
+    for (auto& allocator : allocators()) {
+        size_t number_of_allocations = allocator.number_of_allocations.load();
+        if (!allocator.block_count && !number_of_allocations)
+            continue;
+        size_t listed_blocks = 0;
+        size_t chunks_in_use = 0;
+        size_t chunk_capacity = 0;
+        auto count_block = [&](ChunkedBlock& block) {
+            ++listed_blocks;
+            chunks_in_use += block.used_chunks();
+            chunk_capacity += block.chunk_capacity();
+        };
+        for (auto& block : allocator.usable_blocks)
+            count_block(block);
+        for (auto& block : allocator.full_blocks)
+            count_block(block);
+
+        size_t bytes_requested = allocator.bytes_requested.load();
+        size_t bytes_handed_out = number_of_allocations * allocator.size;
+        size_t average_request = number_of_allocations ? bytes_requested / number_of_allocations : 0;
+        size_t rounded_up_percent = bytes_handed_out ? (bytes_handed_out - bytes_requested) * 100 / bytes_handed_out : 0;
+        dbgln("{:>10} | {:>6} | {:>6} | {:>13} | {:>8} | {:>11} | {:>14} | {:>9}%",
+            allocator.size, allocator.block_count, allocator.block_count - listed_blocks, chunks_in_use, chunk_capacity,
+            number_of_allocations, average_request, rounded_up_percent);
+    }
+    dbgln("empty blocks kept around: {} hot, {} cold", s_hot_empty_block_count, s_cold_empty_block_count);
+    size_t big_blocks_kept_around = 0;
+    for (auto& allocator : big_allocators())
+        big_blocks_kept_around += allocator.blocks.size();
+    dbgln("big blocks kept around: {}", big_blocks_kept_around);
 }
 
 void serenity_dump_malloc_stats()
@@ -510,8 +720,10 @@ void serenity_dump_malloc_stats()
     dbgln("empty cold block hits that were purged: {}", g_malloc_stats.number_of_cold_empty_block_purge_hits);
     dbgln("block allocs: {}", g_malloc_stats.number_of_block_allocs);
     dbgln("filled blocks: {}", g_malloc_stats.number_of_blocks_full);
+    dbgln("thread cache refills: {}", g_malloc_stats.number_of_thread_cache_refills);
     dbgln();
     dbgln("# free() calls: {}", g_malloc_stats.number_of_free_calls);
+    dbgln("remote frees: {}", g_malloc_stats.number_of_remote_frees);
     dbgln();
     dbgln("big alloc keeps: {}", g_malloc_stats.number_of_big_allocator_keeps);
     dbgln("big alloc frees: {}", g_malloc_stats.number_of_big_allocator_frees);
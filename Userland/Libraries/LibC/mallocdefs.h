@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
 #include <AK/IntrusiveList.h>
 #include <AK/Types.h>
 
@@ -16,8 +17,14 @@
 
 #define PAGE_ROUND_UP(x) ((((size_t)(x)) + PAGE_SIZE - 1) & (~(PAGE_SIZE - 1)))
 
-static constexpr unsigned short size_classes[] = { 16, 32, 64, 128, 256, 496, 1008, 2032, 4080, 8176, 16368, 32752, 0 };
+// Small allocations get a size class every 16 bytes, after that every class is about twice as large as the one before.
+static constexpr unsigned short size_classes[] = {
+    16, 32, 48, 64, 80, 96, 112, 128, 144, 160, 176, 192, 208, 224, 240, 256,
+    496, 1008, 2032, 4080, 8176, 16368, 32752, 0
+};
 static constexpr size_t num_size_classes = (sizeof(size_classes) / sizeof(unsigned short)) - 1;
+static constexpr size_t small_size_class_granularity = 16;
+static constexpr size_t largest_small_size_class = 256;
 
 consteval bool check_size_classes_alignment()
 {
@@ -29,6 +36,16 @@ consteval bool check_size_classes_alignment()
 }
 static_assert(check_size_classes_alignment());
 
+consteval bool check_small_size_classes()
+{
+    for (size_t i = 0; i < largest_small_size_class / small_size_class_granularity; i++) {
+        if (size_classes[i] != (i + 1) * small_size_class_granularity)
+            return false;
+    }
+    return true;
+}
+static_assert(check_small_size_classes());
+
 struct CommonHeader {
     size_t m_magic;
     size_t m_size;
@@ -63,8 +80,15 @@ struct ChunkedBlock : public CommonHeader {
     size_t m_next_lazy_freelist_index { 0 };
     FreelistEntry* m_freelist { nullptr };
     size_t m_free_chunks { 0 };
+    // The thread cache this block has been handed out to, if any. While a thread owns a block, only it
+    // touches the freelist, and every other thread pushes the chunks it frees onto the remote freelist.
+    Atomic<FlatPtr, AK::memory_order_relaxed> m_owner { 0 };
+    Atomic<FreelistEntry*> m_remote_freelist { remote_freelist_closed() };
     [[gnu::aligned(16)]] unsigned char m_slot[0];
 
+    // Marks the remote freelist of a block nobody owns, frees into it have to take the global lock.
+    static FreelistEntry* remote_freelist_closed() { return reinterpret_cast<FreelistEntry*>(1); }
+
     void* chunk(size_t index)
     {
         return &m_slot[index * m_size];
@@ -131,6 +131,37 @@ int __pthread_mutex_trylock(pthread_mutex_t* mutex)
 
 int pthread_mutex_trylock(pthread_mutex_t* mutex) __attribute__((weak, alias("__pthread_mutex_trylock")));
 
+// Most critical sections are short, so when the mutex is held by a thread running on another CPU, it's usually
+// cheaper to watch it for a little while than to go to sleep and have to be woken up again.
+static constexpr size_t mutex_spin_count = 100;
+
+static bool should_spin_on_mutexes()
+{
+    static int s_processor_count = 0;
+    if (s_processor_count == 0)
+        s_processor_count = max(sysconf(_SC_NPROCESSORS_ONLN), 1l);
+    return s_processor_count > 1;
+}
+
+// Returns whether the mutex could be claimed. If it couldn't, value is what the mutex was last seen as.
+static bool spin_on_mutex(pthread_mutex_t* mutex, u32& value)
+{
+    if (!should_spin_on_mutexes())
+        return false;
+    for (size_t i = 0; i < mutex_spin_count; ++i) {
+        // Don't try to get in line ahead of the threads that are already sleeping on it.
+        if (value == MUTEX_LOCKED_NEED_TO_WAKE)
+            return false;
+        if (value == MUTEX_UNLOCKED && AK::atomic_compare_exchange_strong(&mutex->lock, value, MUTEX_LOCKED_NO_NEED_TO_WAKE, AK::memory_order_acquire))
+            return true;
+#if ARCH(I386) || ARCH(X86_64)
+        __builtin_ia32_pause();
+#endif
+        value = AK::atomic_load(&mutex->lock, AK::memory_order_relaxed);
+    }
+    return false;
+}
+
 int __pthread_mutex_lock(pthread_mutex_t* mutex)
 {
     // Fast path: attempt to claim the mutex without waiting.
@@ -150,6 +181,13 @@ int __pthread_mutex_lock(pthread_mutex_t* mutex)
         }
     }
 
+    if (spin_on_mutex(mutex, value)) {
+        if (mutex->type == __PTHREAD_MUTEX_RECURSIVE)
+            AK::atomic_store(&mutex->owner, __pthread_self(), AK::memory_order_relaxed);
+        mutex->level = 0;
+        return 0;
+    }
+
     // Slow path: wait, record the fact that we're going to wait, and always
     // remember to wake the next thread up once we release the mutex.
     if (value != MUTEX_LOCKED_NEED_TO_WAKE)
@@ -37,4 +37,16 @@ int sched_getparam(pid_t pid, struct sched_param* param)
     int rc = syscall(SC_sched_getparam, pid, param);
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
+
+int sched_setattr(pid_t pid, const struct sched_attr* attr)
+{
+    int rc = syscall(SC_sched_setattr, pid, attr);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
+int sched_getattr(pid_t pid, struct sched_attr* attr)
+{
+    int rc = syscall(SC_sched_getattr, pid, attr);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
 }
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <stdint.h>
 #include <sys/cdefs.h>
 #include <sys/types.h>
 
@@ -21,10 +22,25 @@ struct sched_param {
 #define SCHED_RR 1
 #define SCHED_OTHER 2
 #define SCHED_BATCH 3
+#define SCHED_DEADLINE 6
+
+struct sched_attr {
+    uint32_t size;
+    uint32_t sched_policy;
+    uint64_t sched_flags;
+    int32_t sched_nice;
+    uint32_t sched_priority;
+    // The following are only used with SCHED_DEADLINE. All values are in nanoseconds.
+    uint64_t sched_runtime;
+    uint64_t sched_deadline;
+    uint64_t sched_period;
+};
 
 int sched_get_priority_min(int policy);
 int sched_get_priority_max(int policy);
 int sched_setparam(pid_t pid, const struct sched_param* param);
 int sched_getparam(pid_t pid, struct sched_param* param);
+int sched_setattr(pid_t pid, const struct sched_attr* attr);
+int sched_getattr(pid_t pid, struct sched_attr* attr);
 
 __END_DECLS
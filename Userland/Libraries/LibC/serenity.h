@@ -112,8 +112,16 @@ enum {
     PERF_EVENT_KMALLOC = 2048,
     PERF_EVENT_KFREE = 4096,
     PERF_EVENT_PAGE_FAULT = 8192,
+    PERF_EVENT_PMC_SAMPLE = 16384,
 };
 
+// Which hardware performance counters to take PERF_EVENT_PMC_SAMPLE samples of.
+#define PERF_EVENT_PMC_CYCLES (1ull << 32)
+#define PERF_EVENT_PMC_CACHE_MISSES (1ull << 33)
+#define PERF_EVENT_PMC_BRANCH_MISSES (1ull << 34)
+#define PERF_EVENT_PMC_LLC_LOADS (1ull << 35)
+#define PERF_EVENT_PMC_MASK (PERF_EVENT_PMC_CYCLES | PERF_EVENT_PMC_CACHE_MISSES | PERF_EVENT_PMC_BRANCH_MISSES | PERF_EVENT_PMC_LLC_LOADS)
+
 #define PERF_EVENT_MASK_ALL (~0ull)
 
 int perf_event(int type, uintptr_t arg1, uintptr_t arg2);
@@ -201,6 +201,8 @@ void exit(int status)
 
     if (secure_getenv("LIBC_DUMP_MALLOC_STATS"))
         serenity_dump_malloc_stats();
+    if (secure_getenv("LIBC_DUMP_MALLOC_INFO"))
+        serenity_dump_malloc_info();
 
     extern void _fini();
     _fini();
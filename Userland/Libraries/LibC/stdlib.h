@@ -23,6 +23,7 @@ __attribute__((malloc)) __attribute__((alloc_size(1, 2))) void* calloc(size_t nm
 size_t malloc_size(void*);
 size_t malloc_good_size(size_t);
 void serenity_dump_malloc_stats(void);
+void serenity_dump_malloc_info(void);
 void free(void*);
 __attribute__((alloc_size(2))) void* realloc(void* ptr, size_t);
 char* getenv(const char* name);
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ByteSearch.h>
 #include <AK/Format.h>
 #include <AK/MemMem.h>
 #include <AK/Platform.h>
@@ -17,6 +18,229 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if ARCH(I386) || ARCH(X86_64)
+#    include <cpuid.h>
+#endif
+#if ARCH(X86_64)
+#    include <AK/SIMD.h>
+#endif
+
+// How memcpy(), memmove() and memset() work depends on the size:
+// - Up to 16 bytes are moved with two loads and stores of the largest size that fits, which overlap in the middle.
+// - Up to rep_threshold bytes are moved a chunk at a time, with one more (overlapping) chunk for the remainder.
+// - Anything larger is left to "rep movs" and "rep stos", which are the fastest way to do it on CPUs with ERMS
+//   (Enhanced REP MOVSB/STOSB) and still fast on everything else as long as the destination is aligned.
+// AVX isn't used, as the kernel only saves the SSE registers when switching threads.
+#if ARCH(X86_64)
+// SSE2 is always available on x86_64.
+using Chunk = AK::SIMD::u8x16;
+using ComparableChunk = AK::SIMD::c8x16;
+static constexpr size_t rep_threshold = 1024;
+#else
+using Chunk = FlatPtr;
+static constexpr size_t rep_threshold = 256;
+#endif
+
+template<typename T>
+static ALWAYS_INLINE T load(const u8* src)
+{
+    T value;
+    __builtin_memcpy(&value, src, sizeof(T));
+    return value;
+}
+
+template<typename T>
+static ALWAYS_INLINE void store(u8* dest, T value)
+{
+    __builtin_memcpy(dest, &value, sizeof(T));
+}
+
+template<typename T>
+static ALWAYS_INLINE bool copy_head_and_tail(u8* dest, const u8* src, size_t n)
+{
+    if (n < sizeof(T))
+        return false;
+    auto head = load<T>(src);
+    auto tail = load<T>(src + n - sizeof(T));
+    store(dest, head);
+    store(dest + n - sizeof(T), tail);
+    return true;
+}
+
+// Everything is loaded before anything is stored, so this works for overlapping buffers too.
+static ALWAYS_INLINE void copy_small(u8* dest, const u8* src, size_t n)
+{
+    if (copy_head_and_tail<u64>(dest, src, n) || copy_head_and_tail<u32>(dest, src, n) || copy_head_and_tail<u16>(dest, src, n))
+        return;
+    if (n)
+        *dest = *src;
+}
+
+// Copies front to back, so dest may overlap with src as long as it's below it.
+static void copy_forward(u8* dest, const u8* src, size_t n)
+{
+    auto tail = load<Chunk>(src + n - sizeof(Chunk));
+    size_t i = 0;
+    for (; i + 4 * sizeof(Chunk) < n; i += 4 * sizeof(Chunk)) {
+        auto chunk0 = load<Chunk>(src + i);
+        auto chunk1 = load<Chunk>(src + i + sizeof(Chunk));
+        auto chunk2 = load<Chunk>(src + i + 2 * sizeof(Chunk));
+        auto chunk3 = load<Chunk>(src + i + 3 * sizeof(Chunk));
+        store(dest + i, chunk0);
+        store(dest + i + sizeof(Chunk), chunk1);
+        store(dest + i + 2 * sizeof(Chunk), chunk2);
+        store(dest + i + 3 * sizeof(Chunk), chunk3);
+    }
+    for (; i < n - sizeof(Chunk); i += sizeof(Chunk))
+        store(dest + i, load<Chunk>(src + i));
+    store(dest + n - sizeof(Chunk), tail);
+}
+
+// Copies back to front, so dest may overlap with src as long as it's above it.
+static void copy_backward(u8* dest, const u8* src, size_t n)
+{
+    auto head = load<Chunk>(src);
+    for (size_t i = n; i > sizeof(Chunk); i -= sizeof(Chunk))
+        store(dest + i - sizeof(Chunk), load<Chunk>(src + i - sizeof(Chunk)));
+    store(dest, head);
+}
+
+static bool has_erms()
+{
+#if ARCH(I386) || ARCH(X86_64)
+    static int s_has_erms = -1;
+    if (s_has_erms < 0) {
+        unsigned eax, ebx, ecx, edx;
+        // CPUID.(EAX=07H, ECX=0):EBX[bit 9]
+        s_has_erms = __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & (1 << 9));
+    }
+    return s_has_erms;
+#else
+    return false;
+#endif
+}
+
+static void copy_large(u8* dest, const u8* src, size_t n)
+{
+    if (has_erms()) {
+        asm volatile("rep movsb"
+                     : "+D"(dest), "+S"(src), "+c"(n)::"memory");
+        return;
+    }
+    // The head and tail are stored last, as storing them first could overwrite bytes of src that haven't been copied yet.
+    auto head = load<FlatPtr>(src);
+    auto tail = load<FlatPtr>(src + n - sizeof(FlatPtr));
+    auto* original_dest = dest;
+    size_t offset = sizeof(FlatPtr) - ((FlatPtr)dest % sizeof(FlatPtr));
+    size_t count = (n - offset) / sizeof(FlatPtr);
+    dest += offset;
+    src += offset;
+#if ARCH(I386)
+    asm volatile("rep movsl"
+                 : "+D"(dest), "+S"(src), "+c"(count)::"memory");
+#else
+    asm volatile("rep movsq"
+                 : "+D"(dest), "+S"(src), "+c"(count)::"memory");
+#endif
+    store(original_dest, head);
+    store(original_dest + n - sizeof(FlatPtr), tail);
+}
+
+static ALWAYS_INLINE Chunk splat(u8 c)
+{
+#if ARCH(X86_64)
+    return (Chunk)(AK::SIMD::u64x2 { explode_byte(c), explode_byte(c) });
+#else
+    return explode_byte(c);
+#endif
+}
+
+template<typename T>
+static ALWAYS_INLINE bool fill_head_and_tail(u8* dest, u8 c, size_t n)
+{
+    if (n < sizeof(T))
+        return false;
+    auto value = (T)(0x0101010101010101ull * c);
+    store(dest, value);
+    store(dest + n - sizeof(T), value);
+    return true;
+}
+
+static ALWAYS_INLINE void fill_small(u8* dest, u8 c, size_t n)
+{
+    if (fill_head_and_tail<u64>(dest, c, n) || fill_head_and_tail<u32>(dest, c, n) || fill_head_and_tail<u16>(dest, c, n))
+        return;
+    if (n)
+        *dest = c;
+}
+
+static void fill_large(u8* dest, u8 c, size_t n)
+{
+    if (has_erms()) {
+        asm volatile("rep stosb"
+                     : "+D"(dest), "+c"(n)
+                     : "a"(c)
+                     : "memory");
+        return;
+    }
+    auto value = explode_byte(c);
+    store(dest, value);
+    store(dest + n - sizeof(FlatPtr), value);
+    size_t offset = sizeof(FlatPtr) - ((FlatPtr)dest % sizeof(FlatPtr));
+    size_t count = (n - offset) / sizeof(FlatPtr);
+    dest += offset;
+#if ARCH(I386)
+    asm volatile("rep stosl"
+                 : "+D"(dest), "+c"(count)
+                 : "a"(value)
+                 : "memory");
+#else
+    asm volatile("rep stosq"
+                 : "+D"(dest), "+c"(count)
+                 : "a"(value)
+                 : "memory");
+#endif
+}
+
+// Returns the first byte of str that's either zero or c. Whole aligned chunks are read at a time, which may go
+// past the end of the string, but never into the next page.
+static const char* find_null_or(const char* str, char c)
+{
+#if ARCH(X86_64)
+    using AlignedChunk [[gnu::may_alias]] = ComparableChunk;
+    auto matches = [&](AlignedChunk chunk) -> u32 {
+        ComparableChunk needle = (ComparableChunk)splat(c);
+        return __builtin_ia32_pmovmskb128((chunk == ComparableChunk {}) | (chunk == needle));
+    };
+    size_t offset = (FlatPtr)str % sizeof(Chunk);
+    auto* chunk = (const AlignedChunk*)(str - offset);
+    if (u32 mask = matches(*chunk) >> offset)
+        return str + count_trailing_zeroes_32(mask);
+    for (;;) {
+        if (u32 mask = matches(*++chunk))
+            return (const char*)chunk + count_trailing_zeroes_32(mask);
+    }
+#else
+    for (; (FlatPtr)str % sizeof(FlatPtr); ++str) {
+        if (!*str || *str == c)
+            return str;
+    }
+    auto has_zero_byte = [](FlatPtr word) {
+        return (word - explode_byte(0x01)) & ~word & explode_byte(0x80);
+    };
+    using AlignedWord [[gnu::may_alias]] = FlatPtr;
+    auto needle = explode_byte(c);
+    for (;; str += sizeof(FlatPtr)) {
+        auto word = *(const AlignedWord*)str;
+        if (has_zero_byte(word) || has_zero_byte(word ^ needle))
+            break;
+    }
+    while (*str && *str != c)
+        ++str;
+    return str;
+#endif
+}
+
 extern "C" {
 
 size_t strspn(const char* s, const char* accept)
@@ -47,10 +271,7 @@ size_t strcspn(const char* s, const char* reject)
 
 size_t strlen(const char* str)
 {
-    size_t len = 0;
-    while (*(str++))
-        ++len;
-    return len;
+    return find_null_or(str, 0) - str;
 }
 
 size_t strnlen(const char* str, size_t maxlen)
@@ -102,8 +323,22 @@ int strncmp(const char* s1, const char* s2, size_t n)
 
 int memcmp(const void* v1, const void* v2, size_t n)
 {
-    auto* s1 = (const uint8_t*)v1;
-    auto* s2 = (const uint8_t*)v2;
+    auto* s1 = (const u8*)v1;
+    auto* s2 = (const u8*)v2;
+#if ARCH(X86_64)
+    for (; n >= sizeof(Chunk); n -= sizeof(Chunk), s1 += sizeof(Chunk), s2 += sizeof(Chunk)) {
+        u32 equal = __builtin_ia32_pmovmskb128(load<ComparableChunk>(s1) == load<ComparableChunk>(s2));
+        if (equal != 0xffff) {
+            auto index = count_trailing_zeroes_32(~equal);
+            return s1[index] < s2[index] ? -1 : 1;
+        }
+    }
+#else
+    for (; n >= sizeof(FlatPtr) && load<FlatPtr>(s1) == load<FlatPtr>(s2); n -= sizeof(FlatPtr)) {
+        s1 += sizeof(FlatPtr);
+        s2 += sizeof(FlatPtr);
+    }
+#endif
     while (n-- > 0) {
         if (*s1++ != *s2++)
             return s1[-1] < s2[-1] ? -1 : 1;
@@ -113,55 +348,45 @@ int memcmp(const void* v1, const void* v2, size_t n)
 
 void* memcpy(void* dest_ptr, const void* src_ptr, size_t n)
 {
-    void* original_dest = dest_ptr;
-    asm volatile(
-        "rep movsb"
-        : "+D"(dest_ptr), "+S"(src_ptr), "+c"(n)::"memory");
-    return original_dest;
+    auto* dest = (u8*)dest_ptr;
+    auto* src = (const u8*)src_ptr;
+    if (n <= sizeof(Chunk))
+        copy_small(dest, src, n);
+    else if (n <= rep_threshold)
+        copy_forward(dest, src, n);
+    else
+        copy_large(dest, src, n);
+    return dest_ptr;
 }
 
 void* memset(void* dest_ptr, int c, size_t n)
 {
-    size_t dest = (size_t)dest_ptr;
-    // FIXME: Support starting at an unaligned address.
-    if (!(dest & 0x3) && n >= 12) {
-        size_t size_ts = n / sizeof(size_t);
-        size_t expanded_c = explode_byte((u8)c);
-#if ARCH(I386)
-        asm volatile(
-            "rep stosl\n"
-            : "=D"(dest)
-            : "D"(dest), "c"(size_ts), "a"(expanded_c)
-            : "memory");
-#else
-        asm volatile(
-            "rep stosq\n"
-            : "=D"(dest)
-            : "D"(dest), "c"(size_ts), "a"(expanded_c)
-            : "memory");
-#endif
-        n -= size_ts * sizeof(size_t);
-        if (n == 0)
-            return dest_ptr;
+    auto* dest = (u8*)dest_ptr;
+    if (n <= sizeof(Chunk)) {
+        fill_small(dest, (u8)c, n);
+    } else if (n <= rep_threshold) {
+        auto value = splat((u8)c);
+        for (size_t i = 0; i < n - sizeof(Chunk); i += sizeof(Chunk))
+            store(dest + i, value);
+        store(dest + n - sizeof(Chunk), value);
+    } else {
+        fill_large(dest, (u8)c, n);
     }
-    asm volatile(
-        "rep stosb\n"
-        : "=D"(dest), "=c"(n)
-        : "0"(dest), "1"(n), "a"(c)
-        : "memory");
     return dest_ptr;
 }
 
-void* memmove(void* dest, const void* src, size_t n)
+void* memmove(void* dest_ptr, const void* src_ptr, size_t n)
 {
-    if (dest < src)
-        return memcpy(dest, src, n);
-
-    u8* pd = (u8*)dest;
-    const u8* ps = (const u8*)src;
-    for (pd += n, ps += n; n--;)
-        *--pd = *--ps;
-    return dest;
+    auto* dest = (u8*)dest_ptr;
+    auto* src = (const u8*)src_ptr;
+    // Both copy front to back, which is fine unless dest starts within src.
+    if ((FlatPtr)dest - (FlatPtr)src >= n)
+        return memcpy(dest_ptr, src_ptr, n);
+    if (n <= sizeof(Chunk))
+        copy_small(dest, src, n);
+    else
+        copy_backward(dest, src, n);
+    return dest_ptr;
 }
 
 const void* memmem(const void* haystack, size_t haystack_length, const void* needle, size_t needle_length)
@@ -202,33 +427,21 @@ size_t strlcpy(char* dest, const char* src, size_t n)
 
 char* strchr(const char* str, int c)
 {
-    char ch = c;
-    for (;; ++str) {
-        if (*str == ch)
-            return const_cast<char*>(str);
-        if (!*str)
-            return nullptr;
-    }
+    auto* result = find_null_or(str, (char)c);
+    return *result == (char)c ? const_cast<char*>(result) : nullptr;
 }
 
 char* strchrnul(const char* str, int c)
 {
-    char ch = c;
-    for (;; ++str) {
-        if (*str == ch || !*str)
-            return const_cast<char*>(str);
-    }
+    return const_cast<char*>(find_null_or(str, (char)c));
 }
 
 void* memchr(const void* ptr, int c, size_t size)
 {
-    char ch = c;
-    auto* cptr = (const char*)ptr;
-    for (size_t i = 0; i < size; ++i) {
-        if (cptr[i] == ch)
-            return const_cast<char*>(cptr + i);
-    }
-    return nullptr;
+    auto index = AK::find_byte({ ptr, size }, (u8)c);
+    if (!index.has_value())
+        return nullptr;
+    return const_cast<u8*>((const u8*)ptr + index.value());
 }
 
 char* strrchr(const char* str, int ch)
@@ -8,3 +8,9 @@
 
 #define PR_SET_DUMPABLE 1
 #define PR_GET_DUMPABLE 2
+#define PR_SET_IO_PRIORITY 3
+#define PR_GET_IO_PRIORITY 4
+
+#define IO_PRIORITY_HIGH 0
+#define IO_PRIORITY_NORMAL 1
+#define IO_PRIORITY_IDLE 2
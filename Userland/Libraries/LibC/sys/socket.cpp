@@ -44,6 +44,13 @@ int accept4(int sockfd, sockaddr* addr, socklen_t* addrlen, int flags)
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
 
+int accept4_batch(int sockfd, int* fds, size_t count, int flags)
+{
+    Syscall::SC_accept4_batch_params params { sockfd, fds, count, flags };
+    int rc = syscall(SC_accept4_batch, &params);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
 int connect(int sockfd, const sockaddr* addr, socklen_t addrlen)
 {
     int rc = syscall(SC_connect, sockfd, addr, addrlen);
@@ -103,6 +110,25 @@ ssize_t recv(int sockfd, void* buffer, size_t buffer_length, int flags)
     return recvfrom(sockfd, buffer, buffer_length, flags, nullptr, nullptr);
 }
 
+int sendmmsg(int sockfd, struct mmsghdr* msgs, unsigned int vlen, int flags)
+{
+    Syscall::SC_mmsg_params params { sockfd, msgs, vlen, flags };
+    int rc = syscall(SC_sendmmsg, &params);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
+int recvmmsg(int sockfd, struct mmsghdr* msgs, unsigned int vlen, int flags, struct timespec* timeout)
+{
+    // FIXME: Support the timeout.
+    if (timeout) {
+        errno = ENOTSUP;
+        return -1;
+    }
+    Syscall::SC_mmsg_params params { sockfd, msgs, vlen, flags };
+    int rc = syscall(SC_recvmmsg, &params);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
 int getsockopt(int sockfd, int level, int option, void* value, socklen_t* value_size)
 {
     Syscall::SC_getsockopt_params params { sockfd, level, option, value, value_size };
@@ -7,10 +7,12 @@
 #include <AK/String.h>
 #include <AK/StringBuilder.h>
 #include <AK/Time.h>
+#include <Kernel/API/TimePage.h>
 #include <assert.h>
 #include <errno.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/time.h>
 #include <sys/times.h>
 #include <syscall.h>
@@ -353,8 +355,43 @@ clock_t clock()
     return tms.tms_utime + tms.tms_stime;
 }
 
+static Kernel::TimePage* get_kernel_time_page()
+{
+    static Kernel::TimePage* s_kernel_time_page;
+    if (auto* time_page = AK::atomic_load(&s_kernel_time_page, AK::memory_order_acquire))
+        return time_page;
+
+    auto rc = syscall(SC_map_time_page);
+    if ((int)rc < 0 && (int)rc > -EMAXERRNO)
+        return nullptr;
+
+    Kernel::TimePage* expected = nullptr;
+    auto* time_page = (Kernel::TimePage*)rc;
+    if (!AK::atomic_compare_exchange_strong(&s_kernel_time_page, expected, time_page, AK::memory_order_acq_rel)) {
+        // Another thread beat us to it.
+        munmap(time_page, PAGE_SIZE);
+        return expected;
+    }
+    return time_page;
+}
+
 int clock_gettime(clockid_t clock_id, struct timespec* ts)
 {
+    if (Kernel::time_page_supports(clock_id)) {
+        if (!ts) {
+            errno = EFAULT;
+            return -1;
+        }
+        if (auto* time_page = get_kernel_time_page()) {
+            u32 update_iteration;
+            do {
+                update_iteration = AK::atomic_load(&time_page->update1, AK::memory_order_acquire);
+                *ts = time_page->clocks[clock_id];
+            } while (update_iteration != AK::atomic_load(&time_page->update2, AK::memory_order_acquire));
+            return 0;
+        }
+    }
+
     int rc = syscall(SC_clock_gettime, clock_id, ts);
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
@@ -57,6 +57,7 @@ typedef int clockid_t;
 #define CLOCK_MONOTONIC_RAW 4
 #define CLOCK_REALTIME_COARSE 5
 #define CLOCK_MONOTONIC_COARSE 6
+#define CLOCK_ID_COUNT 7
 #define TIMER_ABSTIME 99
 
 int clock_gettime(clockid_t, struct timespec*);
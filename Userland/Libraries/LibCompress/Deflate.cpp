@@ -8,7 +8,6 @@
 #include <AK/Array.h>
 #include <AK/Assertions.h>
 #include <AK/BinaryHeap.h>
-#include <AK/BinarySearch.h>
 #include <AK/MemoryStream.h>
 #include <string.h>
 
@@ -18,29 +17,14 @@ namespace Compress {
 
 const CanonicalCode& CanonicalCode::fixed_literal_codes()
 {
-    static CanonicalCode code;
-    static bool initialized = false;
-
-    if (initialized)
-        return code;
-
-    code = CanonicalCode::from_bytes(fixed_literal_bit_lengths).value();
-    initialized = true;
-
+    // Initialized on first use, which is safe if several threads get here at once.
+    static CanonicalCode const code = CanonicalCode::from_bytes(fixed_literal_bit_lengths).value();
     return code;
 }
 
 const CanonicalCode& CanonicalCode::fixed_distance_codes()
 {
-    static CanonicalCode code;
-    static bool initialized = false;
-
-    if (initialized)
-        return code;
-
-    code = CanonicalCode::from_bytes(fixed_distance_bit_lengths).value();
-    initialized = true;
-
+    static CanonicalCode const code = CanonicalCode::from_bytes(fixed_distance_bit_lengths).value();
     return code;
 }
 
@@ -59,10 +43,11 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
         }
     }
     if (non_zero_symbols == 1) { // special case - only 1 symbol
-        code.m_symbol_codes.append(0b10);
         code.m_symbol_values.append(last_non_zero);
+        code.m_code_length_counts[1] = 1;
         code.m_bit_codes[last_non_zero] = 0;
         code.m_bit_code_lengths[last_non_zero] = 1;
+        code.fill_fast_symbols();
         return code;
     }
 
@@ -78,8 +63,8 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
             if (next_code > start_bit)
                 return {};
 
-            code.m_symbol_codes.append(start_bit | next_code);
             code.m_symbol_values.append(symbol);
+            code.m_code_length_counts[code_length]++;
             code.m_bit_codes[symbol] = fast_reverse16(start_bit | next_code, code_length); // DEFLATE writes huffman encoded symbols as lsb-first
             code.m_bit_code_lengths[symbol] = code_length;
 
@@ -91,24 +76,59 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
         return {};
     }
 
+    code.fill_fast_symbols();
     return code;
 }
 
+void CanonicalCode::fill_fast_symbols()
+{
+    for (size_t symbol = 0; symbol < m_bit_code_lengths.size(); ++symbol) {
+        auto code_length = m_bit_code_lengths[symbol];
+        if (code_length == 0 || code_length > fast_bits)
+            continue;
+        // Every run of fast_bits bits that starts with this code decodes to it.
+        for (size_t bits = m_bit_codes[symbol]; bits < m_fast_symbols.size(); bits += 1 << code_length)
+            m_fast_symbols[bits] = symbol << 4 | code_length;
+    }
+}
+
+template<typename NextBit>
+u32 CanonicalCode::decode_symbol_bit_by_bit(NextBit next_bit) const
+{
+    // The codes of each length are consecutive numbers, starting at twice the number following the last code of the
+    // length before (https://www.hanshq.net/zip.html#huffdec), so finding out whether a code is complete only takes
+    // a subtraction.
+    u32 code = 0;
+    u32 first_code = 0;
+    u32 first_index = 0;
+    for (size_t code_length = 1; code_length <= max_code_length; ++code_length) {
+        code |= next_bit();
+        u32 count = m_code_length_counts[code_length];
+        if (code - first_code < count)
+            return m_symbol_values[first_index + code - first_code];
+        first_index += count;
+        first_code = (first_code + count) << 1;
+        code <<= 1;
+    }
+
+    return UINT32_MAX; // the maximum symbol in deflate is 288, so we use UINT32_MAX (an impossible value) to indicate an error
+}
+
 u32 CanonicalCode::read_symbol(InputBitStream& stream) const
 {
-    u32 code_bits = 1;
+    // The stream can't be peeked at, so we can't look up more bits than the code turns out to have.
+    return decode_symbol_bit_by_bit([&] { return static_cast<u32>(stream.read_bits(1)); });
+}
 
-    for (;;) {
-        code_bits = code_bits << 1 | stream.read_bits(1);
-        if (code_bits >= (1 << 16))
-            return UINT32_MAX; // the maximum symbol in deflate is 288, so we use UINT32_MAX (an impossible value) to indicate an error
-
-        // FIXME: This is very inefficient and could greatly be improved by implementing this
-        //        algorithm: https://www.hanshq.net/zip.html#huffdec
-        size_t index;
-        if (binary_search(m_symbol_codes.span(), code_bits, &index))
-            return m_symbol_values[index];
+u32 CanonicalCode::decode_symbol(u32 bits, u32& code_length) const
+{
+    if (auto entry = m_fast_symbols[bits & (m_fast_symbols.size() - 1)]) {
+        code_length = entry & 0xf;
+        return entry >> 4;
     }
+
+    code_length = 0;
+    return decode_symbol_bit_by_bit([&] { return (bits >> code_length++) & 1; });
 }
 
 void CanonicalCode::write_symbol(OutputBitStream& stream, u32 symbol) const
@@ -116,6 +136,235 @@ void CanonicalCode::write_symbol(OutputBitStream& stream, u32 symbol) const
     stream.write_bits(m_bit_codes[symbol], m_bit_code_lengths[symbol]);
 }
 
+// Reads bits lsb-first from a buffer, refilling a 64-bit register with a whole word at a time instead of going back
+// to the buffer for every bit. Past the end of the buffer it reads zeros, and has_overrun() tells whether any of those
+// were actually consumed.
+class BitBuffer {
+public:
+    explicit BitBuffer(ReadonlyBytes bytes)
+        : m_bytes(bytes)
+    {
+    }
+
+    // Afterwards at least 56 bits can be consumed before refilling again.
+    ALWAYS_INLINE void refill()
+    {
+        if (m_bit_count >= 56)
+            return;
+
+        if (m_offset + sizeof(u64) <= m_bytes.size()) {
+            u64 word;
+            __builtin_memcpy(&word, m_bytes.offset(m_offset), sizeof(word));
+            m_bits |= AK::convert_between_host_and_little_endian(word) << m_bit_count;
+            m_offset += (63 - m_bit_count) / 8;
+            m_bit_count |= 56;
+            return;
+        }
+
+        while (m_bit_count <= 56) {
+            u64 byte = m_offset < m_bytes.size() ? m_bytes[m_offset] : 0;
+            m_bits |= byte << m_bit_count;
+            ++m_offset;
+            m_bit_count += 8;
+        }
+    }
+
+    ALWAYS_INLINE u32 peek_bits() const { return static_cast<u32>(m_bits); }
+
+    ALWAYS_INLINE void consume_bits(size_t count)
+    {
+        m_bits >>= count;
+        m_bit_count -= count;
+    }
+
+    ALWAYS_INLINE u32 read_bits(size_t count)
+    {
+        refill();
+        u32 bits = m_bits & ((1ull << count) - 1);
+        consume_bits(count);
+        return bits;
+    }
+
+    void align_to_byte_boundary() { consume_bits(m_bit_count % 8); }
+
+    bool read_bytes(Bytes bytes)
+    {
+        size_t nread = 0;
+        while (nread < bytes.size() && m_bit_count >= 8) {
+            bytes[nread++] = static_cast<u8>(m_bits);
+            consume_bits(8);
+        }
+
+        auto remaining = bytes.size() - nread;
+        if (remaining == 0)
+            return true;
+        // The rest is copied straight from the input, so the bits refill() already ORed in from beyond m_offset
+        // won't match what's there once m_offset has moved past it.
+        m_bits = 0;
+        if (m_offset > m_bytes.size() || m_bytes.size() - m_offset < remaining)
+            return false;
+        __builtin_memcpy(bytes.offset(nread), m_bytes.offset(m_offset), remaining);
+        m_offset += remaining;
+        return true;
+    }
+
+    bool has_overrun() const { return m_offset * 8 - m_bit_count > m_bytes.size() * 8; }
+
+private:
+    ReadonlyBytes m_bytes;
+    size_t m_offset { 0 };
+    u64 m_bits { 0 };
+    size_t m_bit_count { 0 };
+};
+
+static u32 read_symbol(CanonicalCode const& code, InputBitStream& input)
+{
+    return code.read_symbol(input);
+}
+
+static u32 read_symbol(CanonicalCode const& code, BitBuffer& input)
+{
+    input.refill();
+    u32 code_length;
+    auto symbol = code.decode_symbol(input.peek_bits(), code_length);
+    input.consume_bits(code_length);
+    return symbol;
+}
+
+template<typename BitReader>
+static u32 decode_length(u32 symbol, BitReader& input)
+{
+    // FIXME: I can't quite follow the algorithm here, but it seems to work.
+
+    if (symbol <= 264)
+        return symbol - 254;
+
+    if (symbol <= 284) {
+        auto extra_bits = (symbol - 261) / 4;
+        return (((symbol - 265) % 4 + 4) << extra_bits) + 3 + input.read_bits(extra_bits);
+    }
+
+    if (symbol == 285)
+        return 258;
+
+    VERIFY_NOT_REACHED();
+}
+
+template<typename BitReader>
+static u32 decode_distance(u32 symbol, BitReader& input)
+{
+    // FIXME: I can't quite follow the algorithm here, but it seems to work.
+
+    if (symbol <= 3)
+        return symbol + 1;
+
+    if (symbol <= 29) {
+        auto extra_bits = (symbol / 2) - 1;
+        return ((symbol % 2 + 2) << extra_bits) + 1 + input.read_bits(extra_bits);
+    }
+
+    VERIFY_NOT_REACHED();
+}
+
+// Returns false if the code lengths are malformed.
+template<typename BitReader>
+static bool decode_codes(BitReader& input, CanonicalCode& literal_code, Optional<CanonicalCode>& distance_code)
+{
+    auto literal_code_count = input.read_bits(5) + 257;
+    auto distance_code_count = input.read_bits(5) + 1;
+    auto code_length_count = input.read_bits(4) + 4;
+
+    // First we have to extract the code lengths of the code that was used to encode the code lengths of
+    // the code that was used to encode the block.
+
+    u8 code_lengths_code_lengths[19] = { 0 };
+    for (size_t i = 0; i < code_length_count; ++i) {
+        code_lengths_code_lengths[code_lengths_code_lengths_order[i]] = input.read_bits(3);
+    }
+
+    // Now we can extract the code that was used to encode the code lengths of the code that was used to
+    // encode the block.
+
+    auto code_length_code_result = CanonicalCode::from_bytes({ code_lengths_code_lengths, sizeof(code_lengths_code_lengths) });
+    if (!code_length_code_result.has_value()) {
+        return false;
+    }
+    const auto code_length_code = code_length_code_result.value();
+
+    // Next we extract the code lengths of the code that was used to encode the block.
+
+    Vector<u8> code_lengths;
+    while (code_lengths.size() < literal_code_count + distance_code_count) {
+        auto symbol = read_symbol(code_length_code, input);
+
+        if (symbol == UINT32_MAX) {
+            return false;
+        }
+
+        if (symbol < DeflateSpecialCodeLengths::COPY) {
+            code_lengths.append(static_cast<u8>(symbol));
+            continue;
+        } else if (symbol == DeflateSpecialCodeLengths::ZEROS) {
+            auto nrepeat = 3 + input.read_bits(3);
+            for (size_t j = 0; j < nrepeat; ++j)
+                code_lengths.append(0);
+            continue;
+        } else if (symbol == DeflateSpecialCodeLengths::LONG_ZEROS) {
+            auto nrepeat = 11 + input.read_bits(7);
+            for (size_t j = 0; j < nrepeat; ++j)
+                code_lengths.append(0);
+            continue;
+        } else {
+            VERIFY(symbol == DeflateSpecialCodeLengths::COPY);
+
+            if (code_lengths.is_empty()) {
+                return false;
+            }
+
+            auto nrepeat = 3 + input.read_bits(2);
+            for (size_t j = 0; j < nrepeat; ++j)
+                code_lengths.append(code_lengths.last());
+        }
+    }
+
+    if (code_lengths.size() != literal_code_count + distance_code_count) {
+        return false;
+    }
+
+    // Now we extract the code that was used to encode literals and lengths in the block.
+
+    auto literal_code_result = CanonicalCode::from_bytes(code_lengths.span().trim(literal_code_count));
+    if (!literal_code_result.has_value()) {
+        return false;
+    }
+    literal_code = literal_code_result.value();
+
+    // Now we extract the code that was used to encode distances in the block.
+
+    if (distance_code_count == 1) {
+        auto length = code_lengths[literal_code_count];
+
+        if (length == 0) {
+            return true;
+        } else if (length != 1) {
+            return false;
+        }
+    }
+
+    auto distance_code_result = CanonicalCode::from_bytes(code_lengths.span().slice(literal_code_count));
+    if (!distance_code_result.has_value()) {
+        return false;
+    }
+    distance_code = distance_code_result.value();
+    return true;
+}
+
+void DeflateDecompressor::decode_codes(CanonicalCode& literal_code, Optional<CanonicalCode>& distance_code)
+{
+    if (!Compress::decode_codes(m_input_stream, literal_code, distance_code))
+        set_fatal_error();
+}
+
 DeflateDecompressor::CompressedBlock::CompressedBlock(DeflateDecompressor& decompressor, CanonicalCode literal_codes, Optional<CanonicalCode> distance_codes)
     : m_decompressor(decompressor)
     , m_literal_codes(literal_codes)
@@ -147,22 +396,25 @@ bool DeflateDecompressor::CompressedBlock::try_read_more()
             return false;
         }
 
-        const auto length = m_decompressor.decode_length(symbol);
+        const auto length = decode_length(symbol, m_decompressor.m_input_stream);
         const auto distance_symbol = m_distance_codes.value().read_symbol(m_decompressor.m_input_stream);
         if (distance_symbol >= 30) { // invalid deflate distance symbol
             m_decompressor.set_fatal_error();
             return false;
         }
-        const auto distance = m_decompressor.decode_distance(distance_symbol);
+        const auto distance = decode_distance(distance_symbol, m_decompressor.m_input_stream);
 
-        for (size_t idx = 0; idx < length; ++idx) {
-            u8 byte = 0;
-            m_decompressor.m_output_stream.read({ &byte, sizeof(byte) }, distance);
+        // A back reference may overlap the bytes it produces, so it's copied in pieces of at most `distance` bytes,
+        // each of which has been written completely by the time it's read.
+        u8 buffer[258];
+        for (size_t copied = 0; copied < length;) {
+            auto nread = m_decompressor.m_output_stream.read({ buffer, length - copied }, distance);
             if (m_decompressor.m_output_stream.handle_any_error()) {
                 m_decompressor.set_fatal_error();
                 return false; // a back reference was requested that was too far back (outside our current sliding window)
             }
-            m_decompressor.m_output_stream << byte;
+            m_decompressor.m_output_stream.write({ buffer, nread });
+            copied += nread;
         }
 
         return true;
@@ -355,152 +607,100 @@ bool DeflateDecompressor::handle_any_error()
     return Stream::handle_any_error() || handled_errors;
 }
 
-Optional<ByteBuffer> DeflateDecompressor::decompress_all(ReadonlyBytes bytes)
-{
-    InputMemoryStream memory_stream { bytes };
-    DeflateDecompressor deflate_stream { memory_stream };
-    DuplexMemoryStream output_stream;
-
-    u8 buffer[4096];
-    while (!deflate_stream.has_any_error() && !deflate_stream.unreliable_eof()) {
-        const auto nread = deflate_stream.read({ buffer, sizeof(buffer) });
-        output_stream.write_or_error({ buffer, nread });
-    }
-
-    if (deflate_stream.handle_any_error())
-        return {};
-
-    return output_stream.copy_into_contiguous_buffer();
-}
-
-u32 DeflateDecompressor::decode_length(u32 symbol)
+// Inflates a compressed block straight into the output buffer, which already holds everything decompressed before it,
+// so back references can be resolved with a copy within the buffer instead of going through a sliding window.
+static bool inflate_compressed_block(BitBuffer& input, ByteBuffer& output, size_t& output_size, CanonicalCode const& literal_codes, Optional<CanonicalCode> const& distance_codes)
 {
-    // FIXME: I can't quite follow the algorithm here, but it seems to work.
-
-    if (symbol <= 264)
-        return symbol - 254;
-
-    if (symbol <= 284) {
-        auto extra_bits = (symbol - 261) / 4;
-        return (((symbol - 265) % 4 + 4) << extra_bits) + 3 + m_input_stream.read_bits(extra_bits);
-    }
-
-    if (symbol == 285)
-        return 258;
+    for (;;) {
+        // Every symbol can produce at most 258 bytes.
+        if (output.size() - output_size < 258)
+            output.resize(max<size_t>(output.size() * 2, 64 * KiB));
 
-    VERIFY_NOT_REACHED();
-}
+        auto symbol = read_symbol(literal_codes, input);
+        if (input.has_overrun())
+            return false;
 
-u32 DeflateDecompressor::decode_distance(u32 symbol)
-{
-    // FIXME: I can't quite follow the algorithm here, but it seems to work.
+        if (symbol < 256) {
+            output[output_size++] = static_cast<u8>(symbol);
+            continue;
+        }
+        if (symbol == 256)
+            return true;
+        if (!distance_codes.has_value() || symbol >= 286)
+            return false;
 
-    if (symbol <= 3)
-        return symbol + 1;
+        auto length = decode_length(symbol, input);
+        auto distance_symbol = read_symbol(distance_codes.value(), input);
+        if (distance_symbol >= 30)
+            return false;
+        auto distance = decode_distance(distance_symbol, input);
+        if (input.has_overrun() || distance > output_size)
+            return false;
 
-    if (symbol <= 29) {
-        auto extra_bits = (symbol / 2) - 1;
-        return ((symbol % 2 + 2) << extra_bits) + 1 + m_input_stream.read_bits(extra_bits);
+        auto* destination = output.data() + output_size;
+        auto const* source = destination - distance;
+        if (distance >= length) {
+            __builtin_memcpy(destination, source, length);
+        } else if (distance == 1) {
+            __builtin_memset(destination, *source, length);
+        } else {
+            // The reference overlaps the bytes it produces.
+            for (size_t i = 0; i < length; ++i)
+                destination[i] = source[i];
+        }
+        output_size += length;
     }
-
-    VERIFY_NOT_REACHED();
 }
 
-void DeflateDecompressor::decode_codes(CanonicalCode& literal_code, Optional<CanonicalCode>& distance_code)
+Optional<ByteBuffer> DeflateDecompressor::decompress_all(ReadonlyBytes bytes)
 {
-    auto literal_code_count = m_input_stream.read_bits(5) + 257;
-    auto distance_code_count = m_input_stream.read_bits(5) + 1;
-    auto code_length_count = m_input_stream.read_bits(4) + 4;
-
-    // First we have to extract the code lengths of the code that was used to encode the code lengths of
-    // the code that was used to encode the block.
+    // Unlike the stream, which mustn't read past the end of the deflate data (a gzip member's footer follows it in the
+    // same stream), this sees all of the input at once, so it reads it a word at a time.
+    BitBuffer input { bytes };
+    ByteBuffer output;
+    size_t output_size = 0;
 
-    u8 code_lengths_code_lengths[19] = { 0 };
-    for (size_t i = 0; i < code_length_count; ++i) {
-        code_lengths_code_lengths[code_lengths_code_lengths_order[i]] = m_input_stream.read_bits(3);
-    }
+    for (bool is_final_block = false; !is_final_block;) {
+        is_final_block = input.read_bits(1);
+        auto block_type = input.read_bits(2);
 
-    // Now we can extract the code that was used to encode the code lengths of the code that was used to
-    // encode the block.
-
-    auto code_length_code_result = CanonicalCode::from_bytes({ code_lengths_code_lengths, sizeof(code_lengths_code_lengths) });
-    if (!code_length_code_result.has_value()) {
-        set_fatal_error();
-        return;
-    }
-    const auto code_length_code = code_length_code_result.value();
-
-    // Next we extract the code lengths of the code that was used to encode the block.
+        if (block_type == 0b00) {
+            input.align_to_byte_boundary();
 
-    Vector<u8> code_lengths;
-    while (code_lengths.size() < literal_code_count + distance_code_count) {
-        auto symbol = code_length_code.read_symbol(m_input_stream);
-
-        if (symbol == UINT32_MAX) {
-            set_fatal_error();
-            return;
-        }
+            u8 header[4];
+            if (!input.read_bytes({ header, sizeof(header) }))
+                return {};
+            u16 length = header[0] | header[1] << 8;
+            u16 negated_length = header[2] | header[3] << 8;
+            if ((length ^ 0xffff) != negated_length)
+                return {};
 
-        if (symbol < DeflateSpecialCodeLengths::COPY) {
-            code_lengths.append(static_cast<u8>(symbol));
-            continue;
-        } else if (symbol == DeflateSpecialCodeLengths::ZEROS) {
-            auto nrepeat = 3 + m_input_stream.read_bits(3);
-            for (size_t j = 0; j < nrepeat; ++j)
-                code_lengths.append(0);
-            continue;
-        } else if (symbol == DeflateSpecialCodeLengths::LONG_ZEROS) {
-            auto nrepeat = 11 + m_input_stream.read_bits(7);
-            for (size_t j = 0; j < nrepeat; ++j)
-                code_lengths.append(0);
+            if (output.size() < output_size + length)
+                output.resize(output_size + length);
+            if (!input.read_bytes(output.bytes().slice(output_size, length)))
+                return {};
+            output_size += length;
             continue;
-        } else {
-            VERIFY(symbol == DeflateSpecialCodeLengths::COPY);
-
-            if (code_lengths.is_empty()) {
-                set_fatal_error();
-                return;
-            }
-
-            auto nrepeat = 3 + m_input_stream.read_bits(2);
-            for (size_t j = 0; j < nrepeat; ++j)
-                code_lengths.append(code_lengths.last());
         }
-    }
 
-    if (code_lengths.size() != literal_code_count + distance_code_count) {
-        set_fatal_error();
-        return;
-    }
-
-    // Now we extract the code that was used to encode literals and lengths in the block.
-
-    auto literal_code_result = CanonicalCode::from_bytes(code_lengths.span().trim(literal_code_count));
-    if (!literal_code_result.has_value()) {
-        set_fatal_error();
-        return;
-    }
-    literal_code = literal_code_result.value();
-
-    // Now we extract the code that was used to encode distances in the block.
-
-    if (distance_code_count == 1) {
-        auto length = code_lengths[literal_code_count];
-
-        if (length == 0) {
-            return;
-        } else if (length != 1) {
-            set_fatal_error();
-            return;
+        bool succeeded;
+        if (block_type == 0b01) {
+            succeeded = inflate_compressed_block(input, output, output_size, CanonicalCode::fixed_literal_codes(), CanonicalCode::fixed_distance_codes());
+        } else if (block_type == 0b10) {
+            CanonicalCode literal_codes;
+            Optional<CanonicalCode> distance_codes;
+            succeeded = Compress::decode_codes(input, literal_codes, distance_codes)
+                && !input.has_overrun()
+                && inflate_compressed_block(input, output, output_size, literal_codes, distance_codes);
+        } else {
+            succeeded = false;
         }
+        if (!succeeded || input.has_overrun())
+            return {};
     }
 
-    auto distance_code_result = CanonicalCode::from_bytes(code_lengths.span().slice(literal_code_count));
-    if (!distance_code_result.has_value()) {
-        set_fatal_error();
-        return;
-    }
-    distance_code = distance_code_result.value();
+    output.resize(output_size);
+    return output;
 }
 
 DeflateCompressor::DeflateCompressor(OutputStream& stream, CompressionLevel compression_level)
@@ -554,21 +754,31 @@ size_t DeflateCompressor::compare_match_candidate(size_t start, size_t candidate
 {
     VERIFY(previous_match_length < maximum_match_length);
 
-    // We firstly check that the match is at least (prev_match_length + 1) long, we check backwards as there's a higher chance the end mismatches
-    for (ssize_t i = previous_match_length; i >= 0; i--) {
-        if (m_rolling_window[start + i] != m_rolling_window[candidate + i])
-            return 0;
+    // The candidate is only interesting if it's longer than the previous match, and most of them already differ at its end
+    if (m_rolling_window[start + previous_match_length] != m_rolling_window[candidate + previous_match_length])
+        return 0;
+
+    // Find the actual length, comparing 8 bytes at a time: the first mismatching byte is the lowest non-zero byte of the
+    // (little endian) difference
+    size_t match_length = 0;
+    while (match_length + sizeof(u64) <= maximum_match_length) {
+        u64 start_bytes;
+        u64 candidate_bytes;
+        __builtin_memcpy(&start_bytes, &m_rolling_window[start + match_length], sizeof(u64));
+        __builtin_memcpy(&candidate_bytes, &m_rolling_window[candidate + match_length], sizeof(u64));
+        auto difference = AK::convert_between_host_and_little_endian(start_bytes ^ candidate_bytes);
+        if (difference != 0) {
+            match_length += __builtin_ctzll(difference) / 8;
+            return match_length > previous_match_length ? match_length : 0;
+        }
+        match_length += sizeof(u64);
     }
-
-    // Find the actual length
-    auto match_length = previous_match_length + 1;
     while (match_length < maximum_match_length && m_rolling_window[start + match_length] == m_rolling_window[candidate + match_length]) {
         match_length++;
     }
 
-    VERIFY(match_length > previous_match_length);
     VERIFY(match_length <= maximum_match_length);
-    return match_length;
+    return match_length > previous_match_length ? match_length : 0;
 }
 
 size_t DeflateCompressor::find_back_match(size_t start, u16 hash, size_t previous_match_length, size_t maximum_match_length, size_t& match_position)
@@ -733,6 +943,19 @@ void DeflateCompressor::lz77_compress_block()
 
         insert_hash(current_position, hash);
 
+        // the fastest level takes every match right away instead of checking whether the next byte starts a longer one,
+        // and (like zlib's) only adds the bytes inside a match to the hash table when the match is short
+        if (m_compression_level == CompressionLevel::FAST && match_length != 0) {
+            emit_back_reference(current_position - match_position, match_length);
+            if (match_length <= m_compression_constants.max_lazy_length) {
+                for (size_t j = current_position + 1; j < min(current_position + match_length, block_end - min_match_length + 1); j++) {
+                    insert_hash(j, hash_sequence(&m_rolling_window[j]));
+                }
+            }
+            current_position += match_length - 1;
+            continue;
+        }
+
         // if the previous match is as good as the new match, just use it
         if (previous_match_length != 0 && previous_match_length >= match_length) {
             emit_back_reference((current_position - 1) - previous_match_position, previous_match_length);
@@ -1052,6 +1275,21 @@ void DeflateCompressor::final_flush()
     flush();
 }
 
+void DeflateCompressor::sync_flush()
+{
+    VERIFY(!m_finished);
+    if (m_pending_block_size != 0)
+        flush();
+
+    // an empty non-final uncompressed block ends the output on a byte boundary
+    m_output_stream.write_bits(0b000, 3);
+    m_output_stream.align_to_byte_boundary();
+    LittleEndian<u16> len = 0;
+    LittleEndian<u16> nlen = 0xffff;
+    m_output_stream << len << nlen;
+    m_finished = true;
+}
+
 Optional<ByteBuffer> DeflateCompressor::compress_all(const ReadonlyBytes& bytes, CompressionLevel compression_level)
 {
     DuplexMemoryStream output_stream;
@@ -18,19 +18,35 @@ namespace Compress {
 
 class CanonicalCode {
 public:
+    static constexpr size_t max_code_length = 15;
+
     CanonicalCode() = default;
     u32 read_symbol(InputBitStream&) const;
     void write_symbol(OutputBitStream&, u32) const;
 
+    // Decodes the symbol whose code is at the start of `bits`, which has to hold at least the next max_code_length bits
+    // of the input (lsb first), and sets `code_length` to the number of bits it took. Like read_symbol(), this
+    // returns UINT32_MAX if the bits aren't the start of any code.
+    u32 decode_symbol(u32 bits, u32& code_length) const;
+
     static const CanonicalCode& fixed_literal_codes();
     static const CanonicalCode& fixed_distance_codes();
 
     static Optional<CanonicalCode> from_bytes(ReadonlyBytes);
 
 private:
-    // Decompression - indexed by code
-    Vector<u16> m_symbol_codes;
+    // Codes of up to this many bits are decoded with a single lookup in m_fast_symbols, longer ones one bit at a time.
+    static constexpr size_t fast_bits = 9;
+
+    void fill_fast_symbols();
+    template<typename NextBit>
+    u32 decode_symbol_bit_by_bit(NextBit) const;
+
+    // Decompression - the symbols sorted by code, and how many codes there are of each length
     Vector<u16> m_symbol_values;
+    Array<u16, max_code_length + 1> m_code_length_counts {};
+    // Indexed by the next fast_bits bits of input, holds symbol << 4 | code length, or 0 for longer codes
+    Array<u16, 1 << fast_bits> m_fast_symbols {};
 
     // Compression - indexed by symbol
     Array<u16, 288> m_bit_codes {}; // deflate uses a maximum of 288 symbols (maximum of 32 for distances)
@@ -87,8 +103,6 @@ public:
     static Optional<ByteBuffer> decompress_all(ReadonlyBytes);
 
 private:
-    u32 decode_length(u32);
-    u32 decode_distance(u32);
     void decode_codes(CanonicalCode& literal_code, Optional<CanonicalCode>& distance_code);
 
     bool m_read_final_bock { false };
@@ -150,6 +164,9 @@ public:
     size_t write(ReadonlyBytes) override;
     bool write_or_error(ReadonlyBytes) override;
     void final_flush();
+    // Ends the output on a byte boundary without marking it as the end of the deflate data, so that the output of another
+    // compressor can follow it. Like final_flush(), nothing can be written afterwards.
+    void sync_flush();
 
     static Optional<ByteBuffer> compress_all(const ReadonlyBytes& bytes, CompressionLevel = CompressionLevel::GOOD);
 
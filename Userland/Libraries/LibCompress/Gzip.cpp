@@ -8,8 +8,10 @@
 #include <LibCompress/Gzip.h>
 
 #include <AK/MemoryStream.h>
+#include <AK/NonnullOwnPtr.h>
 #include <AK/String.h>
 #include <LibCore/DateTime.h>
+#include <LibThreading/TaskGroup.h>
 
 namespace Compress {
 
@@ -240,11 +242,36 @@ size_t GzipCompressor::write(ReadonlyBytes bytes)
     header.extra_flags = 3;      // DEFLATE sets 2 for maximum compression and 4 for minimum compression
     header.operating_system = 3; // unix
     m_output_stream << Bytes { &header, sizeof(header) };
-    DeflateCompressor compressed_stream { m_output_stream };
-    VERIFY(compressed_stream.write_or_error(bytes));
-    compressed_stream.final_flush();
+
+    // Like pigz, the input is split into chunks that are compressed on the ThreadPool, and their outputs are concatenated.
+    // Our deflate blocks never refer back into the ones before them anyway, so this only costs the few bytes that end
+    // each chunk on a byte boundary.
+    auto chunk_count = max<size_t>(ceil_div(bytes.size(), parallel_chunk_size), 1);
+    Vector<ByteBuffer> compressed_chunks;
+    compressed_chunks.resize(chunk_count);
     Crypto::Checksum::CRC32 crc32;
-    crc32.update(bytes);
+    {
+        Threading::TaskGroup group;
+        for (size_t i = 0; i < chunk_count; ++i) {
+            group.spawn([&, i] {
+                DuplexMemoryStream chunk_stream;
+                // The compressor is too big for the stack of a pool thread.
+                auto compressor = make<DeflateCompressor>(chunk_stream);
+                VERIFY(compressor->write_or_error(bytes.slice(i * parallel_chunk_size, min(parallel_chunk_size, bytes.size() - i * parallel_chunk_size))));
+                if (i == chunk_count - 1)
+                    compressor->final_flush();
+                else
+                    compressor->sync_flush();
+                compressed_chunks[i] = chunk_stream.copy_into_contiguous_buffer();
+            });
+        }
+        // The checksum is calculated while the pool threads compress.
+        crc32.update(bytes);
+        group.wait();
+    }
+    for (auto& chunk : compressed_chunks)
+        m_output_stream << chunk.bytes();
+
     LittleEndian<u32> digest = crc32.digest();
     LittleEndian<u32> size = bytes.size();
     m_output_stream << digest << size;
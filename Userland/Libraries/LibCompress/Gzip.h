@@ -81,6 +81,8 @@ private:
 
 class GzipCompressor final : public OutputStream {
 public:
+    static constexpr size_t parallel_chunk_size = 4 * DeflateCompressor::block_size;
+
     GzipCompressor(OutputStream&);
     ~GzipCompressor();
 
@@ -0,0 +1,525 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Endian.h>
+#include <AK/MemoryStream.h>
+#include <LibCompress/Lz4.h>
+
+namespace Compress {
+
+static constexpr size_t min_match_length = 4;
+// The format requires the last 5 bytes of a block to be literals, and the last match to start at least 12 bytes before
+// the end of the block.
+static constexpr size_t last_literals = 5;
+static constexpr size_t match_start_limit = 12;
+
+static constexpr size_t hash_bits = 14;
+
+static ALWAYS_INLINE u32 read_u32(u8 const* bytes)
+{
+    u32 value;
+    __builtin_memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+// Counts how many bytes at `a` and `b` are the same, up to `limit`, 8 bytes at a time where it can: the first mismatching
+// byte is the lowest non-zero byte of the (little endian) difference.
+static ALWAYS_INLINE size_t count_matching_bytes(u8 const* a, u8 const* b, size_t limit)
+{
+    size_t count = 0;
+    for (; count + sizeof(u64) <= limit; count += sizeof(u64)) {
+        u64 a_bytes;
+        u64 b_bytes;
+        __builtin_memcpy(&a_bytes, a + count, sizeof(u64));
+        __builtin_memcpy(&b_bytes, b + count, sizeof(u64));
+        auto difference = AK::convert_between_host_and_little_endian(a_bytes ^ b_bytes);
+        if (difference != 0)
+            return count + __builtin_ctzll(difference) / 8;
+    }
+    while (count < limit && a[count] == b[count])
+        ++count;
+    return count;
+}
+
+static ALWAYS_INLINE u32 hash_sequence(u32 sequence)
+{
+    constexpr u32 knuth_constant = 2654435761; // shares no common factors with 2^32
+    return (sequence * knuth_constant) >> (32 - hash_bits);
+}
+
+Optional<size_t> Lz4::decompress_block(ReadonlyBytes input, Bytes output, size_t history_size)
+{
+    auto const* in = input.data();
+    auto const* in_end = in + input.size();
+    auto* out = output.data() + history_size;
+    auto* out_end = output.data() + output.size();
+
+    // Lengths of 15 and more continue in bytes of their own, for as long as they're 255.
+    auto read_length = [&](size_t length) -> Optional<size_t> {
+        if (length != 15)
+            return length;
+        for (;;) {
+            if (in == in_end)
+                return {};
+            auto byte = *in++;
+            length += byte;
+            if (byte != 255)
+                return length;
+        }
+    };
+
+    for (;;) {
+        if (in == in_end)
+            return {};
+        auto token = *in++;
+
+        auto literal_length = read_length(token >> 4);
+        if (!literal_length.has_value())
+            return {};
+        if (static_cast<size_t>(in_end - in) < *literal_length || static_cast<size_t>(out_end - out) < *literal_length)
+            return {};
+        __builtin_memcpy(out, in, *literal_length);
+        in += *literal_length;
+        out += *literal_length;
+
+        // The last sequence of a block only has literals.
+        if (in == in_end)
+            break;
+
+        if (in_end - in < 2)
+            return {};
+        size_t distance = in[0] | in[1] << 8;
+        in += 2;
+        if (distance == 0 || distance > static_cast<size_t>(out - output.data()))
+            return {};
+
+        auto match_length = read_length(token & 0xf);
+        if (!match_length.has_value())
+            return {};
+        *match_length += min_match_length;
+        if (static_cast<size_t>(out_end - out) < *match_length)
+            return {};
+
+        auto const* match = out - distance;
+        if (distance >= *match_length) {
+            __builtin_memcpy(out, match, *match_length);
+        } else {
+            // The match overlaps the bytes it produces.
+            for (size_t i = 0; i < *match_length; ++i)
+                out[i] = match[i];
+        }
+        out += *match_length;
+    }
+
+    return out - output.data() - history_size;
+}
+
+ByteBuffer Lz4::compress_block(ReadonlyBytes input)
+{
+    auto output = ByteBuffer::create_uninitialized(max_compressed_block_size(input.size()));
+    auto* out = output.data();
+
+    auto write_length = [&](size_t length) {
+        for (; length >= 255; length -= 255)
+            *out++ = 255;
+        *out++ = length;
+    };
+
+    auto const* in = input.data();
+    size_t anchor = 0;
+    auto emit_sequence = [&](size_t literal_end, size_t distance, size_t match_length) {
+        auto literal_length = literal_end - anchor;
+        auto* token = out++;
+        *token = min<size_t>(literal_length, 15) << 4;
+        if (literal_length >= 15)
+            write_length(literal_length - 15);
+        __builtin_memcpy(out, in + anchor, literal_length);
+        out += literal_length;
+        if (match_length == 0)
+            return;
+
+        *out++ = distance & 0xff;
+        *out++ = distance >> 8;
+        match_length -= min_match_length;
+        *token |= min<size_t>(match_length, 15);
+        if (match_length >= 15)
+            write_length(match_length - 15);
+    };
+
+    if (input.size() > match_start_limit) {
+        // Positions are stored relative to the block, plus one so that zero means there's nothing there yet.
+        Vector<u32> hash_table;
+        hash_table.resize(1 << hash_bits);
+
+        auto match_limit = input.size() - match_start_limit;
+        auto match_end_limit = input.size() - last_literals;
+        size_t position = 0;
+        while (position < match_limit) {
+            auto sequence = read_u32(in + position);
+            auto& slot = hash_table[hash_sequence(sequence)];
+            size_t candidate = slot;
+            slot = position + 1;
+
+            if (candidate == 0 || position + 1 - candidate > max_distance || read_u32(in + candidate - 1) != sequence) {
+                // The longer we go without finding anything, the more positions we skip, so that incompressible input
+                // doesn't take long.
+                position += 1 + ((position - anchor) >> 6);
+                continue;
+            }
+            --candidate;
+
+            // The hash only found the start of the match, which might reach further back.
+            while (position > anchor && candidate > 0 && in[position - 1] == in[candidate - 1]) {
+                --position;
+                --candidate;
+            }
+
+            auto match_length = min_match_length + count_matching_bytes(in + position + min_match_length, in + candidate + min_match_length, match_end_limit - position - min_match_length);
+
+            emit_sequence(position, position - candidate, match_length);
+            position += match_length;
+            anchor = position;
+
+            // Matches often follow each other, so index the end of this one too.
+            if (position < match_limit)
+                hash_table[hash_sequence(read_u32(in + position - 2))] = position - 1;
+        }
+    }
+
+    emit_sequence(input.size(), 0, 0);
+    output.resize(out - output.data());
+    return output;
+}
+
+bool Lz4Decompressor::is_likely_compressed(ReadonlyBytes bytes)
+{
+    return bytes.size() >= 4 && (bytes[0] | bytes[1] << 8 | bytes[2] << 16 | static_cast<u32>(bytes[3]) << 24) == Lz4::frame_magic;
+}
+
+Lz4Decompressor::Lz4Decompressor(InputStream& stream)
+    : m_input_stream(stream)
+{
+}
+
+Lz4Decompressor::~Lz4Decompressor()
+{
+}
+
+bool Lz4Decompressor::read_frame_header()
+{
+    LittleEndian<u32> magic;
+    m_input_stream >> magic;
+    if (m_input_stream.handle_any_error())
+        return false;
+
+    // Skippable frames carry data that isn't ours to decompress.
+    if ((magic & 0xfffffff0) == 0x184D2A50) {
+        LittleEndian<u32> size;
+        m_input_stream >> size;
+        return m_input_stream.discard_or_error(size);
+    }
+    if (magic != Lz4::frame_magic)
+        return false;
+
+    u8 descriptor[14];
+    if (!m_input_stream.read_or_error({ descriptor, 2 }))
+        return false;
+    auto flags = descriptor[0];
+    auto block_descriptor = descriptor[1];
+    if ((flags >> 6) != 0b01 || (flags & 0b10) || (block_descriptor & 0b10001111))
+        return false;
+    m_blocks_are_independent = flags & 0b00100000;
+    m_has_block_checksums = flags & 0b00010000;
+    m_has_content_checksum = flags & 0b00000100;
+    bool has_content_size = flags & 0b00001000;
+    bool has_dictionary_id = flags & 0b00000001;
+
+    auto block_size_id = block_descriptor >> 4;
+    if (block_size_id < 4)
+        return false;
+    m_block_max_size = 1 << (2 * block_size_id + 8);
+
+    size_t descriptor_size = 2;
+    if (has_content_size) {
+        if (!m_input_stream.read_or_error({ descriptor + descriptor_size, 8 }))
+            return false;
+        u64 content_size = 0;
+        for (size_t i = 0; i < 8; ++i)
+            content_size |= static_cast<u64>(descriptor[descriptor_size + i]) << (8 * i);
+        m_content_size = content_size;
+        descriptor_size += 8;
+    } else {
+        m_content_size.clear();
+    }
+    if (has_dictionary_id) {
+        // We don't have any dictionaries.
+        return false;
+    }
+
+    u8 header_checksum;
+    m_input_stream >> header_checksum;
+    if (m_input_stream.handle_any_error())
+        return false;
+    if (header_checksum != ((Crypto::Checksum::XXHash32({ descriptor, descriptor_size }).digest() >> 8) & 0xff))
+        return false;
+
+    m_buffer.resize(Lz4::max_distance + m_block_max_size);
+    m_output_offset = 0;
+    m_output_end = 0;
+    m_frame_output_size = 0;
+    m_content_checksum = Crypto::Checksum::XXHash32();
+    m_in_frame = true;
+    return true;
+}
+
+bool Lz4Decompressor::read_block()
+{
+    LittleEndian<u32> block_header;
+    m_input_stream >> block_header;
+    if (m_input_stream.handle_any_error())
+        return false;
+
+    if (block_header == 0) {
+        // The end mark
+        if (m_has_content_checksum) {
+            LittleEndian<u32> checksum;
+            m_input_stream >> checksum;
+            if (m_input_stream.handle_any_error() || checksum != m_content_checksum.digest())
+                return false;
+        }
+        if (m_content_size.has_value() && m_content_size.value() != m_frame_output_size)
+            return false;
+        m_in_frame = false;
+        return true;
+    }
+
+    bool is_uncompressed = block_header & 0x80000000;
+    size_t block_size = block_header & 0x7fffffff;
+    if (block_size > m_block_max_size)
+        return false;
+    m_compressed_block.resize(block_size);
+    if (!m_input_stream.read_or_error(m_compressed_block))
+        return false;
+    if (m_has_block_checksums) {
+        LittleEndian<u32> checksum;
+        m_input_stream >> checksum;
+        if (m_input_stream.handle_any_error() || checksum != Crypto::Checksum::XXHash32(m_compressed_block).digest())
+            return false;
+    }
+
+    // Linked blocks can refer back into the ones before them, so we keep the last max_distance bytes around.
+    size_t history_size = 0;
+    if (!m_blocks_are_independent) {
+        history_size = min(m_output_end, Lz4::max_distance);
+        __builtin_memmove(m_buffer.data(), m_buffer.data() + m_output_end - history_size, history_size);
+    }
+
+    size_t output_size;
+    if (is_uncompressed) {
+        __builtin_memcpy(m_buffer.data() + history_size, m_compressed_block.data(), block_size);
+        output_size = block_size;
+    } else {
+        auto result = Lz4::decompress_block(m_compressed_block, m_buffer.bytes().trim(history_size + m_block_max_size), history_size);
+        if (!result.has_value())
+            return false;
+        output_size = result.value();
+    }
+
+    m_output_offset = history_size;
+    m_output_end = history_size + output_size;
+    m_frame_output_size += output_size;
+    if (m_has_content_checksum)
+        m_content_checksum.update(m_buffer.bytes().slice(m_output_offset, output_size));
+    return true;
+}
+
+size_t Lz4Decompressor::read(Bytes bytes)
+{
+    size_t total_read = 0;
+    while (total_read < bytes.size()) {
+        if (has_any_error() || m_eof)
+            break;
+
+        if (m_output_offset < m_output_end) {
+            auto nread = m_buffer.bytes().slice(m_output_offset, m_output_end - m_output_offset).copy_trimmed_to(bytes.slice(total_read));
+            m_output_offset += nread;
+            total_read += nread;
+            continue;
+        }
+
+        if (!m_in_frame) {
+            if (m_input_stream.unreliable_eof()) {
+                m_eof = true;
+                break;
+            }
+            if (!read_frame_header()) {
+                set_fatal_error();
+                break;
+            }
+            continue;
+        }
+
+        if (!read_block()) {
+            set_fatal_error();
+            break;
+        }
+    }
+    return total_read;
+}
+
+bool Lz4Decompressor::read_or_error(Bytes bytes)
+{
+    if (read(bytes) < bytes.size()) {
+        set_fatal_error();
+        return false;
+    }
+
+    return true;
+}
+
+bool Lz4Decompressor::discard_or_error(size_t count)
+{
+    u8 buffer[4096];
+
+    size_t ndiscarded = 0;
+    while (ndiscarded < count) {
+        if (unreliable_eof()) {
+            set_fatal_error();
+            return false;
+        }
+
+        ndiscarded += read({ buffer, min<size_t>(count - ndiscarded, sizeof(buffer)) });
+    }
+
+    return true;
+}
+
+bool Lz4Decompressor::unreliable_eof() const
+{
+    return m_eof;
+}
+
+bool Lz4Decompressor::handle_any_error()
+{
+    bool handled_errors = m_input_stream.handle_any_error();
+    return Stream::handle_any_error() || handled_errors;
+}
+
+Optional<ByteBuffer> Lz4Decompressor::decompress_all(ReadonlyBytes bytes)
+{
+    InputMemoryStream memory_stream { bytes };
+    Lz4Decompressor lz4_stream { memory_stream };
+    DuplexMemoryStream output_stream;
+
+    u8 buffer[4096];
+    while (!lz4_stream.has_any_error() && !lz4_stream.unreliable_eof()) {
+        auto nread = lz4_stream.read({ buffer, sizeof(buffer) });
+        output_stream.write_or_error({ buffer, nread });
+    }
+
+    if (lz4_stream.handle_any_error())
+        return {};
+
+    return output_stream.copy_into_contiguous_buffer();
+}
+
+Lz4Compressor::Lz4Compressor(OutputStream& stream)
+    : m_output_stream(stream)
+{
+}
+
+Lz4Compressor::~Lz4Compressor()
+{
+    VERIFY(m_finished);
+}
+
+void Lz4Compressor::write_frame_header()
+{
+    // Version 1, independent blocks with a content checksum, at most 64 KiB each
+    u8 descriptor[2] = { 0b01100100, 4 << 4 };
+    LittleEndian<u32> magic = Lz4::frame_magic;
+    m_output_stream << magic;
+    m_output_stream << ReadonlyBytes { descriptor, sizeof(descriptor) };
+    m_output_stream << static_cast<u8>(Crypto::Checksum::XXHash32({ descriptor, sizeof(descriptor) }).digest() >> 8);
+    m_wrote_frame_header = true;
+}
+
+size_t Lz4Compressor::write(ReadonlyBytes bytes)
+{
+    VERIFY(!m_finished);
+
+    size_t total_written = 0;
+    while (total_written < bytes.size()) {
+        auto n_written = bytes.slice(total_written).copy_trimmed_to({ m_pending_block + m_pending_block_size, block_size - m_pending_block_size });
+        m_pending_block_size += n_written;
+        total_written += n_written;
+
+        if (m_pending_block_size == block_size)
+            flush();
+    }
+    return total_written;
+}
+
+bool Lz4Compressor::write_or_error(ReadonlyBytes bytes)
+{
+    if (write(bytes) < bytes.size()) {
+        set_fatal_error();
+        return false;
+    }
+
+    return true;
+}
+
+void Lz4Compressor::flush()
+{
+    if (!m_wrote_frame_header)
+        write_frame_header();
+    if (m_pending_block_size == 0)
+        return;
+
+    ReadonlyBytes block { m_pending_block, m_pending_block_size };
+    m_content_checksum.update(block);
+
+    auto compressed = Lz4::compress_block(block);
+    if (compressed.size() < block.size()) {
+        LittleEndian<u32> block_header = compressed.size();
+        m_output_stream << block_header << compressed.bytes();
+    } else {
+        // Incompressible blocks are stored as they are.
+        LittleEndian<u32> block_header = block.size() | 0x80000000;
+        m_output_stream << block_header << block;
+    }
+    m_pending_block_size = 0;
+
+    if (m_output_stream.handle_any_error())
+        set_fatal_error();
+}
+
+void Lz4Compressor::final_flush()
+{
+    VERIFY(!m_finished);
+    flush();
+    LittleEndian<u32> end_mark = 0;
+    LittleEndian<u32> checksum = m_content_checksum.digest();
+    m_output_stream << end_mark << checksum;
+    m_finished = true;
+}
+
+Optional<ByteBuffer> Lz4Compressor::compress_all(ReadonlyBytes bytes)
+{
+    DuplexMemoryStream output_stream;
+    Lz4Compressor lz4_stream { output_stream };
+
+    lz4_stream.write_or_error(bytes);
+    lz4_stream.final_flush();
+
+    if (lz4_stream.handle_any_error())
+        return {};
+
+    return output_stream.copy_into_contiguous_buffer();
+}
+
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Optional.h>
+#include <AK/Stream.h>
+#include <LibCrypto/Checksum/XXHash.h>
+
+namespace Compress {
+
+// LZ4 (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md), which trades some compression ratio for being
+// several times faster than deflate in both directions.
+class Lz4 {
+public:
+    static constexpr u32 frame_magic = 0x184D2204;
+    // Matches can reach at most this far back.
+    static constexpr size_t max_distance = 65535;
+
+    // Decompresses a single block into `output`, after the `history_size` bytes already at its start (which matches can
+    // refer back to). Returns the number of bytes it decompressed, or an empty Optional if the block is corrupt or doesn't
+    // fit.
+    static Optional<size_t> decompress_block(ReadonlyBytes, Bytes output, size_t history_size = 0);
+
+    // Compresses `input` into a single block that doesn't refer to anything before it.
+    static ByteBuffer compress_block(ReadonlyBytes input);
+    static constexpr size_t max_compressed_block_size(size_t input_size) { return input_size + input_size / 255 + 16; }
+};
+
+// Reads LZ4 frames (https://github.com/lz4/lz4/blob/dev/doc/lz4_Frame_format.md), including ones that follow each other.
+class Lz4Decompressor final : public InputStream {
+public:
+    Lz4Decompressor(InputStream&);
+    ~Lz4Decompressor();
+
+    size_t read(Bytes) override;
+    bool read_or_error(Bytes) override;
+    bool discard_or_error(size_t) override;
+
+    bool unreliable_eof() const override;
+    bool handle_any_error() override;
+
+    static Optional<ByteBuffer> decompress_all(ReadonlyBytes);
+    static bool is_likely_compressed(ReadonlyBytes);
+
+private:
+    bool read_frame_header();
+    bool read_block();
+
+    InputStream& m_input_stream;
+
+    bool m_in_frame { false };
+    bool m_eof { false };
+    bool m_blocks_are_independent { true };
+    bool m_has_block_checksums { false };
+    bool m_has_content_checksum { false };
+    Optional<u64> m_content_size;
+    u64 m_frame_output_size { 0 };
+    Crypto::Checksum::XXHash32 m_content_checksum;
+
+    // Decompressed blocks go after the last max_distance bytes of the ones before them, which linked blocks can refer to.
+    ByteBuffer m_buffer;
+    ByteBuffer m_compressed_block;
+    size_t m_block_max_size { 0 };
+    size_t m_output_offset { 0 };
+    size_t m_output_end { 0 };
+};
+
+// Writes a single LZ4 frame of independent blocks, with a checksum of its contents.
+class Lz4Compressor final : public OutputStream {
+public:
+    static constexpr size_t block_size = 64 * KiB;
+
+    Lz4Compressor(OutputStream&);
+    ~Lz4Compressor();
+
+    size_t write(ReadonlyBytes) override;
+    bool write_or_error(ReadonlyBytes) override;
+    void final_flush();
+
+    static Optional<ByteBuffer> compress_all(ReadonlyBytes);
+
+private:
+    void write_frame_header();
+    void flush();
+
+    OutputStream& m_output_stream;
+    bool m_wrote_frame_header { false };
+    bool m_finished { false };
+    Crypto::Checksum::XXHash32 m_content_checksum;
+    u8 m_pending_block[block_size];
+    size_t m_pending_block_size { 0 };
+};
+
+}
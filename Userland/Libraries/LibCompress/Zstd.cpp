@@ -0,0 +1,1496 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/Endian.h>
+#include <AK/MemoryStream.h>
+#include <AK/QuickSort.h>
+#include <LibCompress/Zstd.h>
+
+namespace Compress {
+
+// RFC 8878, 3.1.1.3.2.1.1: Literals_Length_Code and Match_Length_Code, as baselines and numbers of extra bits
+struct LengthCode {
+    u32 baseline;
+    u8 extra_bits;
+};
+
+static constexpr Array<LengthCode, 36> literal_length_codes { {
+    { 0, 0 }, { 1, 0 }, { 2, 0 }, { 3, 0 }, { 4, 0 }, { 5, 0 }, { 6, 0 }, { 7, 0 },
+    { 8, 0 }, { 9, 0 }, { 10, 0 }, { 11, 0 }, { 12, 0 }, { 13, 0 }, { 14, 0 }, { 15, 0 },
+    { 16, 1 }, { 18, 1 }, { 20, 1 }, { 22, 1 }, { 24, 2 }, { 28, 2 }, { 32, 3 }, { 40, 3 },
+    { 48, 4 }, { 64, 6 }, { 128, 7 }, { 256, 8 }, { 512, 9 }, { 1024, 10 }, { 2048, 11 }, { 4096, 12 },
+    { 8192, 13 }, { 16384, 14 }, { 32768, 15 }, { 65536, 16 },
+} };
+
+static constexpr Array<LengthCode, 53> match_length_codes { {
+    { 3, 0 }, { 4, 0 }, { 5, 0 }, { 6, 0 }, { 7, 0 }, { 8, 0 }, { 9, 0 }, { 10, 0 },
+    { 11, 0 }, { 12, 0 }, { 13, 0 }, { 14, 0 }, { 15, 0 }, { 16, 0 }, { 17, 0 }, { 18, 0 },
+    { 19, 0 }, { 20, 0 }, { 21, 0 }, { 22, 0 }, { 23, 0 }, { 24, 0 }, { 25, 0 }, { 26, 0 },
+    { 27, 0 }, { 28, 0 }, { 29, 0 }, { 30, 0 }, { 31, 0 }, { 32, 0 }, { 33, 0 }, { 34, 0 },
+    { 35, 1 }, { 37, 1 }, { 39, 1 }, { 41, 1 }, { 43, 2 }, { 47, 2 }, { 51, 3 }, { 59, 3 },
+    { 67, 4 }, { 83, 4 }, { 99, 5 }, { 131, 7 }, { 259, 8 }, { 515, 9 }, { 1027, 10 }, { 2051, 11 },
+    { 4099, 12 }, { 8195, 13 }, { 16387, 14 }, { 32771, 15 }, { 65539, 16 },
+} };
+
+// RFC 8878, 3.1.1.3.2.2: Default Distributions. A count of -1 stands for a "less than 1" probability.
+static constexpr Array<i16, 36> default_literal_length_counts {
+    4, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 2, 1, 1, 1, 1, 1, -1, -1, -1, -1
+};
+static constexpr Array<i16, 53> default_match_length_counts {
+    1, 4, 3, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1, -1, -1, -1, -1
+};
+static constexpr Array<i16, 29> default_offset_counts {
+    1, 1, 1, 1, 1, 1, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1, -1, -1
+};
+static constexpr size_t default_literal_length_accuracy_log = 6;
+static constexpr size_t default_match_length_accuracy_log = 6;
+static constexpr size_t default_offset_accuracy_log = 5;
+
+static constexpr size_t max_literal_length_accuracy_log = 9;
+static constexpr size_t max_match_length_accuracy_log = 9;
+static constexpr size_t max_offset_accuracy_log = 8;
+static constexpr size_t max_offset_code = 31;
+
+static constexpr size_t max_huffman_bits = 11;
+
+static ALWAYS_INLINE size_t highest_bit(u32 value)
+{
+    VERIFY(value != 0);
+    return 31 - __builtin_clz(value);
+}
+
+static ALWAYS_INLINE u64 low_bits_mask(size_t count)
+{
+    return count >= 64 ? ~0ull : (1ull << count) - 1;
+}
+
+// Loads the (up to) 64 bits starting at bit `bit_index` of `bytes`, with zeros past the end.
+static ALWAYS_INLINE u64 load_bits(ReadonlyBytes bytes, size_t bit_index)
+{
+    auto byte_index = bit_index / 8;
+    u64 value = 0;
+    if (byte_index + sizeof(u64) <= bytes.size()) {
+        __builtin_memcpy(&value, bytes.offset_pointer(byte_index), sizeof(u64));
+        value = AK::convert_between_host_and_little_endian(value);
+    } else {
+        for (size_t i = 0; byte_index + i < bytes.size(); ++i)
+            value |= static_cast<u64>(bytes[byte_index + i]) << (8 * i);
+    }
+    return value >> (bit_index % 8);
+}
+
+// Reads bits from the start of a buffer, lsb first (which is how FSE table descriptions are stored).
+class ForwardBitReader {
+public:
+    explicit ForwardBitReader(ReadonlyBytes bytes)
+        : m_bytes(bytes)
+    {
+    }
+
+    u32 peek_bits(size_t count) const { return load_bits(m_bytes, m_position) & low_bits_mask(count); }
+    void consume_bits(size_t count) { m_position += count; }
+    u32 read_bits(size_t count)
+    {
+        auto bits = peek_bits(count);
+        consume_bits(count);
+        return bits;
+    }
+
+    bool has_overrun() const { return m_position > m_bytes.size() * 8; }
+    size_t consumed_bytes() const { return (m_position + 7) / 8; }
+
+private:
+    ReadonlyBytes m_bytes;
+    size_t m_position { 0 };
+};
+
+// Reads bits from the end of a buffer towards its start (RFC 8878, 4.1), which is how the encoder can write everything
+// in reverse and have the decoder read it in order. Reading past the start gives zeros, and has_overrun() tells.
+class BackwardBitReader {
+public:
+    static Optional<BackwardBitReader> create(ReadonlyBytes bytes)
+    {
+        // The highest set bit of the last byte marks where the stream ends.
+        if (bytes.is_empty() || bytes[bytes.size() - 1] == 0)
+            return {};
+        return BackwardBitReader(bytes, (bytes.size() - 1) * 8 + highest_bit(bytes[bytes.size() - 1]));
+    }
+
+    ALWAYS_INLINE u64 peek_bits(size_t count) const
+    {
+        if (count == 0)
+            return 0;
+        auto start = m_position - static_cast<ssize_t>(count);
+        if (start >= 0)
+            return load_bits(m_bytes, start) & low_bits_mask(count);
+        if (m_position <= 0)
+            return 0;
+        return (load_bits(m_bytes, 0) & low_bits_mask(m_position)) << -start;
+    }
+
+    ALWAYS_INLINE void consume_bits(size_t count) { m_position -= count; }
+
+    ALWAYS_INLINE u64 read_bits(size_t count)
+    {
+        auto bits = peek_bits(count);
+        consume_bits(count);
+        return bits;
+    }
+
+    bool has_overrun() const { return m_position < 0; }
+    bool is_finished() const { return m_position == 0; }
+
+private:
+    BackwardBitReader(ReadonlyBytes bytes, ssize_t position)
+        : m_bytes(bytes)
+        , m_position(position)
+    {
+    }
+
+    ReadonlyBytes m_bytes;
+    ssize_t m_position { 0 };
+};
+
+// Writes bits lsb first, for the encoder's side of BackwardBitReader.
+class BitWriter {
+public:
+    explicit BitWriter(ByteBuffer& output)
+        : m_output(output)
+    {
+    }
+
+    ALWAYS_INLINE void write_bits(u64 bits, size_t count)
+    {
+        VERIFY(count <= 32);
+        m_bits |= bits << m_bit_count;
+        m_bit_count += count;
+        if (m_bit_count >= 32) {
+            auto word = AK::convert_between_host_and_little_endian(static_cast<u32>(m_bits));
+            m_output.append(&word, sizeof(word));
+            m_bits >>= 32;
+            m_bit_count -= 32;
+        }
+    }
+
+    // Ends the stream with the marker bit that BackwardBitReader looks for.
+    void finish()
+    {
+        write_bits(1, 1);
+        while (m_bit_count > 0) {
+            u8 byte = m_bits;
+            m_output.append(&byte, 1);
+            m_bits >>= 8;
+            m_bit_count -= min<size_t>(m_bit_count, 8);
+        }
+    }
+
+private:
+    ByteBuffer& m_output;
+    u64 m_bits { 0 };
+    size_t m_bit_count { 0 };
+};
+
+// RFC 8878, 4.1: FSE. Decoding a symbol takes its state's entry, and the next state is its baseline plus bit_count bits.
+struct FseEntry {
+    u16 baseline;
+    u8 symbol;
+    u8 bit_count;
+};
+
+class FseTable {
+public:
+    FseTable() = default;
+
+    static Optional<FseTable> from_counts(Span<i16 const> counts, size_t accuracy_log)
+    {
+        size_t table_size = 1 << accuracy_log;
+        size_t total = 0;
+        for (auto count : counts)
+            total += count < 0 ? 1 : count;
+        if (total != table_size)
+            return {};
+
+        FseTable table;
+        table.m_accuracy_log = accuracy_log;
+        table.m_entries.resize(table_size);
+
+        // Symbols with a "less than 1" probability get the states at the end, the others are spread out over the rest.
+        Vector<u16, 256> next_states;
+        next_states.resize(counts.size());
+        size_t high_threshold = table_size - 1;
+        for (size_t symbol = 0; symbol < counts.size(); ++symbol) {
+            if (counts[symbol] == -1) {
+                table.m_entries[high_threshold--].symbol = symbol;
+                next_states[symbol] = 1;
+            } else {
+                next_states[symbol] = counts[symbol];
+            }
+        }
+
+        size_t step = (table_size >> 1) + (table_size >> 3) + 3;
+        size_t position = 0;
+        for (size_t symbol = 0; symbol < counts.size(); ++symbol) {
+            for (i16 i = 0; i < counts[symbol]; ++i) {
+                table.m_entries[position].symbol = symbol;
+                do {
+                    position = (position + step) & (table_size - 1);
+                } while (position > high_threshold);
+            }
+        }
+        if (position != 0)
+            return {};
+
+        for (auto& entry : table.m_entries) {
+            auto next_state = next_states[entry.symbol]++;
+            entry.bit_count = accuracy_log - highest_bit(next_state);
+            entry.baseline = (next_state << entry.bit_count) - table_size;
+        }
+        return table;
+    }
+
+    // RFC 8878, 4.1.1: FSE Table Description. Takes the description off the front of `input`.
+    static Optional<FseTable> read(ReadonlyBytes& input, size_t max_symbol, size_t max_accuracy_log)
+    {
+        ForwardBitReader reader { input };
+        size_t accuracy_log = reader.read_bits(4) + 5;
+        if (accuracy_log > max_accuracy_log)
+            return {};
+
+        Vector<i16, 256> counts;
+        i32 remaining = (1 << accuracy_log) + 1;
+        u32 threshold = 1 << accuracy_log;
+        size_t bit_count = accuracy_log + 1;
+        while (remaining > 1) {
+            if (counts.size() > max_symbol)
+                return {};
+
+            u32 max_small_value = 2 * threshold - 1 - remaining;
+            u32 bits = reader.peek_bits(bit_count);
+            i32 value;
+            if ((bits & (threshold - 1)) < max_small_value) {
+                value = bits & (threshold - 1);
+                reader.consume_bits(bit_count - 1);
+            } else {
+                value = bits & (2 * threshold - 1);
+                if (value >= static_cast<i32>(threshold))
+                    value -= max_small_value;
+                reader.consume_bits(bit_count);
+            }
+
+            i16 count = value - 1;
+            remaining -= count < 0 ? -count : count;
+            counts.append(count);
+
+            // A zero count is followed by 2-bit numbers of further zero counts, for as long as they're 3.
+            if (count == 0) {
+                for (;;) {
+                    auto repeat = reader.read_bits(2);
+                    for (size_t i = 0; i < repeat; ++i)
+                        counts.append(0);
+                    if (repeat != 3)
+                        break;
+                }
+            }
+
+            while (remaining > 0 && static_cast<u32>(remaining) < threshold) {
+                --bit_count;
+                threshold >>= 1;
+            }
+        }
+        if (remaining != 1 || counts.size() > max_symbol + 1 || reader.has_overrun())
+            return {};
+
+        input = input.slice(reader.consumed_bytes());
+        return from_counts(counts, accuracy_log);
+    }
+
+    // A table that only ever decodes `symbol`, without reading any bits.
+    static FseTable rle(u8 symbol)
+    {
+        FseTable table;
+        table.m_entries.append({ 0, symbol, 0 });
+        return table;
+    }
+
+    size_t accuracy_log() const { return m_accuracy_log; }
+    size_t size() const { return m_entries.size(); }
+    FseEntry const& operator[](size_t state) const { return m_entries[state]; }
+
+private:
+    size_t m_accuracy_log { 0 };
+    Vector<FseEntry> m_entries;
+};
+
+class FseState {
+public:
+    FseState(FseTable const& table, BackwardBitReader& reader)
+        : m_table(table)
+        , m_state(reader.read_bits(table.accuracy_log()))
+    {
+    }
+
+    ALWAYS_INLINE u8 symbol() const { return m_table[m_state].symbol; }
+
+    ALWAYS_INLINE void update(BackwardBitReader& reader)
+    {
+        auto& entry = m_table[m_state];
+        m_state = entry.baseline + reader.read_bits(entry.bit_count);
+    }
+
+private:
+    FseTable const& m_table;
+    size_t m_state { 0 };
+};
+
+// The other way around: for every symbol and every state the decoder goes to next, the state it has to be in before, so
+// that it decodes the symbol and then reads the bits that take it there.
+class FseEncoder {
+public:
+    explicit FseEncoder(FseTable const& table, size_t symbol_count)
+        : m_table(table)
+    {
+        m_previous_states.resize(symbol_count * table.size());
+        m_first_states.resize(symbol_count);
+        for (size_t state = table.size(); state-- > 0;) {
+            auto& entry = table[state];
+            for (size_t next_state = entry.baseline; next_state < entry.baseline + (1u << entry.bit_count); ++next_state)
+                m_previous_states[entry.symbol * table.size() + next_state] = state;
+            m_first_states[entry.symbol] = state;
+        }
+    }
+
+    size_t accuracy_log() const { return m_table.accuracy_log(); }
+    u16 first_state(u8 symbol) const { return m_first_states[symbol]; }
+
+    // Moves back from `state` to the one before it that decodes `symbol`, and writes the bits that lead from there.
+    ALWAYS_INLINE void encode(u16& state, u8 symbol, BitWriter& writer) const
+    {
+        auto previous_state = m_previous_states[symbol * m_table.size() + state];
+        auto& entry = m_table[previous_state];
+        writer.write_bits(state - entry.baseline, entry.bit_count);
+        state = previous_state;
+    }
+
+private:
+    FseTable const& m_table;
+    Vector<u16> m_previous_states;
+    Vector<u16> m_first_states;
+};
+
+struct DefaultTables {
+    DefaultTables()
+        : literal_lengths(FseTable::from_counts(default_literal_length_counts, default_literal_length_accuracy_log).release_value())
+        , match_lengths(FseTable::from_counts(default_match_length_counts, default_match_length_accuracy_log).release_value())
+        , offsets(FseTable::from_counts(default_offset_counts, default_offset_accuracy_log).release_value())
+        , literal_length_encoder(literal_lengths, default_literal_length_counts.size())
+        , match_length_encoder(match_lengths, default_match_length_counts.size())
+        , offset_encoder(offsets, default_offset_counts.size())
+    {
+    }
+
+    FseTable literal_lengths;
+    FseTable match_lengths;
+    FseTable offsets;
+    FseEncoder literal_length_encoder;
+    FseEncoder match_length_encoder;
+    FseEncoder offset_encoder;
+};
+
+static DefaultTables const& default_tables()
+{
+    static DefaultTables tables;
+    return tables;
+}
+
+// RFC 8878, 4.2: Huffman Coding. Looking up the next max_bits bits gives the symbol, and how many of them its code took.
+struct HuffmanEntry {
+    u8 symbol;
+    u8 bit_count;
+};
+
+class HuffmanTable {
+public:
+    // RFC 8878, 4.2.1: Huffman Tree Description. Takes the description off the front of `input`.
+    static Optional<HuffmanTable> read(ReadonlyBytes& input)
+    {
+        if (input.is_empty())
+            return {};
+        auto header = input[0];
+        input = input.slice(1);
+
+        Vector<u8, 256> weights;
+        if (header >= 128) {
+            // The weights are stored directly, as 4-bit numbers.
+            size_t weight_count = header - 127;
+            size_t byte_count = (weight_count + 1) / 2;
+            if (input.size() < byte_count)
+                return {};
+            for (size_t i = 0; i < weight_count; ++i)
+                weights.append(i % 2 == 0 ? input[i / 2] >> 4 : input[i / 2] & 0xf);
+            input = input.slice(byte_count);
+        } else {
+            // The weights are FSE compressed, with two states taking turns.
+            if (input.size() < header)
+                return {};
+            auto description = input.trim(header);
+            input = input.slice(header);
+
+            auto table = FseTable::read(description, 255, 6);
+            if (!table.has_value())
+                return {};
+            auto reader = BackwardBitReader::create(description);
+            if (!reader.has_value())
+                return {};
+            FseState states[2] { { table.value(), reader.value() }, { table.value(), reader.value() } };
+            for (size_t i = 0;; i ^= 1) {
+                if (weights.size() >= 255)
+                    return {};
+                weights.append(states[i].symbol());
+                states[i].update(reader.value());
+                if (reader->has_overrun()) {
+                    weights.append(states[i ^ 1].symbol());
+                    break;
+                }
+            }
+        }
+
+        // The last symbol's weight is implied by the others, since together they have to add up to a power of two.
+        u32 weight_sum = 0;
+        for (auto weight : weights) {
+            if (weight > max_huffman_bits)
+                return {};
+            if (weight > 0)
+                weight_sum += 1 << (weight - 1);
+        }
+        if (weight_sum == 0)
+            return {};
+        size_t max_bits = highest_bit(weight_sum) + 1;
+        if (max_bits > max_huffman_bits)
+            return {};
+        u32 remainder = (1 << max_bits) - weight_sum;
+        if ((remainder & (remainder - 1)) != 0)
+            return {};
+        weights.append(highest_bit(remainder) + 1);
+
+        // The codes are handed out in order of increasing weight, then symbol.
+        HuffmanTable table;
+        table.m_max_bits = max_bits;
+        table.m_entries.resize(1 << max_bits);
+        size_t position = 0;
+        for (size_t weight = 1; weight <= max_bits; ++weight) {
+            for (size_t symbol = 0; symbol < weights.size(); ++symbol) {
+                if (weights[symbol] != weight)
+                    continue;
+                size_t entry_count = 1 << (weight - 1);
+                for (size_t i = 0; i < entry_count; ++i)
+                    table.m_entries[position + i] = { static_cast<u8>(symbol), static_cast<u8>(max_bits + 1 - weight) };
+                position += entry_count;
+            }
+        }
+        VERIFY(position == table.m_entries.size());
+        return table;
+    }
+
+    bool decode_stream(ReadonlyBytes stream, Bytes output) const
+    {
+        auto reader = BackwardBitReader::create(stream);
+        if (!reader.has_value())
+            return false;
+        for (auto& byte : output) {
+            auto& entry = m_entries[reader->peek_bits(m_max_bits)];
+            reader->consume_bits(entry.bit_count);
+            byte = entry.symbol;
+        }
+        return reader->is_finished();
+    }
+
+private:
+    size_t m_max_bits { 0 };
+    Vector<HuffmanEntry> m_entries;
+};
+
+class ZstdBlockDecoder {
+public:
+    // Decodes a compressed block to the end of `output`, whose bytes from `frame_start` on can be referred back to.
+    bool decode_block(ReadonlyBytes block, ByteBuffer& output, size_t& output_size, size_t frame_start);
+
+private:
+    bool decode_literals(ReadonlyBytes& block);
+    bool read_sequence_table(ReadonlyBytes& block, u8 mode, Optional<FseTable>& table, FseTable const& default_table, size_t max_symbol, size_t max_accuracy_log);
+
+    Optional<HuffmanTable> m_huffman_table;
+    Optional<FseTable> m_literal_length_table;
+    Optional<FseTable> m_offset_table;
+    Optional<FseTable> m_match_length_table;
+    u32 m_repeated_offsets[3] { 1, 4, 8 };
+
+    ByteBuffer m_literal_buffer;
+    ReadonlyBytes m_literals;
+};
+
+// RFC 8878, 3.1.1.3.1: Literals Section
+bool ZstdBlockDecoder::decode_literals(ReadonlyBytes& block)
+{
+    if (block.is_empty())
+        return false;
+    auto type = block[0] & 0b11;
+    auto size_format = (block[0] >> 2) & 0b11;
+
+    if (type == 0 || type == 1) {
+        // Raw and RLE literals
+        size_t header_size = 0;
+        size_t size = 0;
+        if (size_format == 0 || size_format == 2) {
+            header_size = 1;
+            size = block[0] >> 3;
+        } else if (size_format == 1) {
+            header_size = 2;
+            if (block.size() < header_size)
+                return false;
+            size = (block[0] >> 4) | block[1] << 4;
+        } else {
+            header_size = 3;
+            if (block.size() < header_size)
+                return false;
+            size = (block[0] >> 4) | block[1] << 4 | block[2] << 12;
+        }
+        if (size > Zstd::max_block_size)
+            return false;
+        block = block.slice(header_size);
+
+        if (type == 0) {
+            if (block.size() < size)
+                return false;
+            m_literals = block.trim(size);
+            block = block.slice(size);
+        } else {
+            if (block.is_empty())
+                return false;
+            m_literal_buffer.resize(size);
+            m_literal_buffer.bytes().fill(block[0]);
+            m_literals = m_literal_buffer;
+            block = block.slice(1);
+        }
+        return true;
+    }
+
+    // Huffman compressed literals, with a new tree or the one from before
+    size_t header_size = size_format < 2 ? 3 : size_format + 2;
+    size_t size_bits = size_format < 2 ? 10 : 4 * size_format + 6;
+    if (block.size() < header_size)
+        return false;
+    u64 header = 0;
+    for (size_t i = 0; i < header_size; ++i)
+        header |= static_cast<u64>(block[i]) << (8 * i);
+    size_t regenerated_size = (header >> 4) & low_bits_mask(size_bits);
+    size_t compressed_size = (header >> (4 + size_bits)) & low_bits_mask(size_bits);
+    bool has_four_streams = size_format != 0;
+    if (regenerated_size > Zstd::max_block_size)
+        return false;
+    block = block.slice(header_size);
+    if (block.size() < compressed_size)
+        return false;
+    auto compressed = block.trim(compressed_size);
+    block = block.slice(compressed_size);
+
+    if (type == 2) {
+        m_huffman_table = HuffmanTable::read(compressed);
+        if (!m_huffman_table.has_value())
+            return false;
+    } else if (!m_huffman_table.has_value()) {
+        return false;
+    }
+
+    m_literal_buffer.resize(regenerated_size);
+    m_literals = m_literal_buffer;
+    if (!has_four_streams)
+        return m_huffman_table->decode_stream(compressed, m_literal_buffer);
+
+    // Four streams, each of which decodes a quarter of the literals, and the jump table that says where they start
+    if (compressed.size() < 6)
+        return false;
+    size_t stream_sizes[4];
+    stream_sizes[0] = compressed[0] | compressed[1] << 8;
+    stream_sizes[1] = compressed[2] | compressed[3] << 8;
+    stream_sizes[2] = compressed[4] | compressed[5] << 8;
+    compressed = compressed.slice(6);
+    if (stream_sizes[0] + stream_sizes[1] + stream_sizes[2] > compressed.size())
+        return false;
+    stream_sizes[3] = compressed.size() - stream_sizes[0] - stream_sizes[1] - stream_sizes[2];
+
+    size_t segment_size = (regenerated_size + 3) / 4;
+    if (segment_size * 3 > regenerated_size)
+        return false;
+    size_t output_offset = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        auto output_size = i < 3 ? segment_size : regenerated_size - 3 * segment_size;
+        if (!m_huffman_table->decode_stream(compressed.trim(stream_sizes[i]), m_literal_buffer.bytes().slice(output_offset, output_size)))
+            return false;
+        compressed = compressed.slice(stream_sizes[i]);
+        output_offset += output_size;
+    }
+    return true;
+}
+
+bool ZstdBlockDecoder::read_sequence_table(ReadonlyBytes& block, u8 mode, Optional<FseTable>& table, FseTable const& default_table, size_t max_symbol, size_t max_accuracy_log)
+{
+    switch (mode) {
+    case 0:
+        table = default_table;
+        return true;
+    case 1:
+        if (block.is_empty() || block[0] > max_symbol)
+            return false;
+        table = FseTable::rle(block[0]);
+        block = block.slice(1);
+        return true;
+    case 2:
+        table = FseTable::read(block, max_symbol, max_accuracy_log);
+        return table.has_value();
+    default:
+        // Repeat the table of the block before
+        return table.has_value();
+    }
+}
+
+bool ZstdBlockDecoder::decode_block(ReadonlyBytes block, ByteBuffer& output, size_t& output_size, size_t frame_start)
+{
+    if (!decode_literals(block))
+        return false;
+
+    // RFC 8878, 3.1.1.3.2: Sequences Section
+    if (block.is_empty())
+        return false;
+    size_t sequence_count = block[0];
+    if (sequence_count < 128) {
+        block = block.slice(1);
+    } else if (sequence_count < 255) {
+        if (block.size() < 2)
+            return false;
+        sequence_count = ((sequence_count - 128) << 8) + block[1];
+        block = block.slice(2);
+    } else {
+        if (block.size() < 3)
+            return false;
+        sequence_count = block[1] + (block[2] << 8) + 0x7f00;
+        block = block.slice(3);
+    }
+
+    if (output.size() < output_size + Zstd::max_block_size)
+        output.resize(max(output.size() * 2, output_size + Zstd::max_block_size));
+    auto* out = output.data() + output_size;
+    auto* out_end = out + Zstd::max_block_size;
+    auto const* literals = m_literals.data();
+    auto const* literals_end = literals + m_literals.size();
+
+    if (sequence_count > 0) {
+        if (block.is_empty())
+            return false;
+        auto modes = block[0];
+        block = block.slice(1);
+        if (modes & 0b11)
+            return false;
+        auto& defaults = default_tables();
+        if (!read_sequence_table(block, modes >> 6, m_literal_length_table, defaults.literal_lengths, literal_length_codes.size() - 1, max_literal_length_accuracy_log))
+            return false;
+        if (!read_sequence_table(block, (modes >> 4) & 0b11, m_offset_table, defaults.offsets, max_offset_code, max_offset_accuracy_log))
+            return false;
+        if (!read_sequence_table(block, (modes >> 2) & 0b11, m_match_length_table, defaults.match_lengths, match_length_codes.size() - 1, max_match_length_accuracy_log))
+            return false;
+
+        auto reader = BackwardBitReader::create(block);
+        if (!reader.has_value())
+            return false;
+        FseState literal_length_state { m_literal_length_table.value(), reader.value() };
+        FseState offset_state { m_offset_table.value(), reader.value() };
+        FseState match_length_state { m_match_length_table.value(), reader.value() };
+
+        for (size_t i = 0; i < sequence_count; ++i) {
+            auto offset_code = offset_state.symbol();
+            auto& match_length_code = match_length_codes[match_length_state.symbol()];
+            auto& literal_length_code = literal_length_codes[literal_length_state.symbol()];
+
+            u32 offset_value = (1u << offset_code) + reader->read_bits(offset_code);
+            size_t match_length = match_length_code.baseline + reader->read_bits(match_length_code.extra_bits);
+            size_t literal_length = literal_length_code.baseline + reader->read_bits(literal_length_code.extra_bits);
+
+            // RFC 8878, 3.1.1.5: Offset values of 1 to 3 pick one of the three offsets used last (shifted by one if there
+            // are no literals), anything else is a new offset.
+            u32 offset;
+            if (offset_value > 3) {
+                offset = offset_value - 3;
+                m_repeated_offsets[2] = m_repeated_offsets[1];
+                m_repeated_offsets[1] = m_repeated_offsets[0];
+                m_repeated_offsets[0] = offset;
+            } else {
+                auto index = offset_value - 1 + (literal_length == 0);
+                if (index == 0) {
+                    offset = m_repeated_offsets[0];
+                } else {
+                    offset = index == 3 ? m_repeated_offsets[0] - 1 : m_repeated_offsets[index];
+                    if (offset == 0)
+                        return false;
+                    if (index != 1)
+                        m_repeated_offsets[2] = m_repeated_offsets[1];
+                    m_repeated_offsets[1] = m_repeated_offsets[0];
+                    m_repeated_offsets[0] = offset;
+                }
+            }
+
+            if (i + 1 < sequence_count) {
+                literal_length_state.update(reader.value());
+                match_length_state.update(reader.value());
+                offset_state.update(reader.value());
+            }
+
+            if (static_cast<size_t>(literals_end - literals) < literal_length || static_cast<size_t>(out_end - out) < literal_length + match_length)
+                return false;
+            __builtin_memcpy(out, literals, literal_length);
+            literals += literal_length;
+            out += literal_length;
+
+            if (offset > static_cast<size_t>(out - output.data()) - frame_start)
+                return false;
+            auto const* match = out - offset;
+            if (offset >= match_length) {
+                __builtin_memcpy(out, match, match_length);
+            } else if (offset == 1) {
+                __builtin_memset(out, *match, match_length);
+            } else {
+                // The match overlaps the bytes it produces.
+                for (size_t j = 0; j < match_length; ++j)
+                    out[j] = match[j];
+            }
+            out += match_length;
+        }
+
+        if (!reader->is_finished())
+            return false;
+    } else if (!block.is_empty()) {
+        return false;
+    }
+
+    // The literals that no sequence took come last.
+    size_t remaining_literals = literals_end - literals;
+    if (static_cast<size_t>(out_end - out) < remaining_literals)
+        return false;
+    __builtin_memcpy(out, literals, remaining_literals);
+    out += remaining_literals;
+
+    output_size = out - output.data();
+    return true;
+}
+
+bool ZstdDecompressor::is_likely_compressed(ReadonlyBytes bytes)
+{
+    return bytes.size() >= 4 && (bytes[0] | bytes[1] << 8 | bytes[2] << 16 | static_cast<u32>(bytes[3]) << 24) == Zstd::frame_magic;
+}
+
+ZstdDecompressor::ZstdDecompressor(InputStream& stream)
+    : m_input_stream(stream)
+{
+}
+
+ZstdDecompressor::~ZstdDecompressor()
+{
+}
+
+// RFC 8878, 3.1.1.1: Frame Header
+bool ZstdDecompressor::read_frame_header()
+{
+    LittleEndian<u32> magic;
+    m_input_stream >> magic;
+    if (m_input_stream.handle_any_error())
+        return false;
+
+    // Skippable frames carry data that isn't ours to decompress.
+    if ((magic & 0xfffffff0) == 0x184D2A50) {
+        LittleEndian<u32> size;
+        m_input_stream >> size;
+        return m_input_stream.discard_or_error(size);
+    }
+    if (magic != Zstd::frame_magic)
+        return false;
+
+    u8 descriptor;
+    m_input_stream >> descriptor;
+    if (m_input_stream.handle_any_error())
+        return false;
+    auto content_size_flag = descriptor >> 6;
+    bool is_single_segment = descriptor & 0b00100000;
+    bool is_reserved_bit_set = descriptor & 0b00001000;
+    m_has_checksum = descriptor & 0b00000100;
+    auto dictionary_id_flag = descriptor & 0b11;
+    if (is_reserved_bit_set)
+        return false;
+
+    u64 window_size = 0;
+    if (!is_single_segment) {
+        u8 window_descriptor;
+        m_input_stream >> window_descriptor;
+        if (m_input_stream.handle_any_error())
+            return false;
+        u64 window_base = 1ull << (10 + (window_descriptor >> 3));
+        window_size = window_base + (window_base / 8) * (window_descriptor & 0b111);
+    }
+
+    constexpr size_t dictionary_id_sizes[] = { 0, 1, 2, 4 };
+    u8 field[8] {};
+    if (!m_input_stream.read_or_error({ field, dictionary_id_sizes[dictionary_id_flag] }))
+        return false;
+    for (size_t i = 0; i < dictionary_id_sizes[dictionary_id_flag]; ++i) {
+        // We don't have any dictionaries.
+        if (field[i] != 0)
+            return false;
+    }
+
+    constexpr size_t content_size_sizes[] = { 0, 2, 4, 8 };
+    size_t content_size_size = content_size_flag == 0 && is_single_segment ? 1 : content_size_sizes[content_size_flag];
+    if (content_size_size != 0) {
+        if (!m_input_stream.read_or_error({ field, content_size_size }))
+            return false;
+        u64 content_size = 0;
+        for (size_t i = 0; i < content_size_size; ++i)
+            content_size |= static_cast<u64>(field[i]) << (8 * i);
+        if (content_size_size == 2)
+            content_size += 256;
+        m_content_size = content_size;
+    } else {
+        m_content_size.clear();
+    }
+
+    if (is_single_segment)
+        window_size = m_content_size.value();
+    if (window_size > max_window_size)
+        return false;
+    m_window_size = max<size_t>(window_size, 1);
+
+    m_block_decoder = make<ZstdBlockDecoder>();
+    m_checksum = Crypto::Checksum::XXHash64();
+    m_frame_output_size = 0;
+    // Everything that was decompressed before has been read by now.
+    VERIFY(m_output_offset == m_buffer_size);
+    m_buffer_size = 0;
+    m_output_offset = 0;
+    m_in_frame = true;
+    return true;
+}
+
+// RFC 8878, 3.1.1.2: Blocks
+bool ZstdDecompressor::read_block()
+{
+    u8 header_bytes[3];
+    if (!m_input_stream.read_or_error({ header_bytes, sizeof(header_bytes) }))
+        return false;
+    u32 header = header_bytes[0] | header_bytes[1] << 8 | header_bytes[2] << 16;
+    bool is_last_block = header & 1;
+    auto type = (header >> 1) & 0b11;
+    size_t size = header >> 3;
+    if (size > min(m_window_size, Zstd::max_block_size))
+        return false;
+
+    // Only the window is kept of what has been read already, once it's taking up enough space to be worth moving.
+    VERIFY(m_output_offset == m_buffer_size);
+    if (m_buffer_size > 2 * m_window_size) {
+        __builtin_memmove(m_buffer.data(), m_buffer.data() + m_buffer_size - m_window_size, m_window_size);
+        m_buffer_size = m_window_size;
+        m_output_offset = m_buffer_size;
+    }
+    if (m_buffer.size() < m_buffer_size + Zstd::max_block_size)
+        m_buffer.resize(max(m_buffer.size() * 2, m_buffer_size + Zstd::max_block_size));
+
+    switch (type) {
+    case 0:
+        if (!m_input_stream.read_or_error(m_buffer.bytes().slice(m_buffer_size, size)))
+            return false;
+        m_buffer_size += size;
+        break;
+    case 1: {
+        u8 byte;
+        m_input_stream >> byte;
+        if (m_input_stream.handle_any_error())
+            return false;
+        m_buffer.bytes().slice(m_buffer_size, size).fill(byte);
+        m_buffer_size += size;
+        break;
+    }
+    case 2:
+        m_compressed_block.resize(size);
+        if (!m_input_stream.read_or_error(m_compressed_block))
+            return false;
+        if (!m_block_decoder->decode_block(m_compressed_block, m_buffer, m_buffer_size, 0))
+            return false;
+        break;
+    default:
+        return false;
+    }
+
+    auto output = m_buffer.bytes().slice(m_output_offset, m_buffer_size - m_output_offset);
+    m_frame_output_size += output.size();
+    if (m_has_checksum)
+        m_checksum.update(output);
+
+    if (is_last_block) {
+        if (m_has_checksum) {
+            LittleEndian<u32> checksum;
+            m_input_stream >> checksum;
+            if (m_input_stream.handle_any_error() || checksum != static_cast<u32>(m_checksum.digest()))
+                return false;
+        }
+        if (m_content_size.has_value() && m_content_size.value() != m_frame_output_size)
+            return false;
+        m_in_frame = false;
+    }
+    return true;
+}
+
+size_t ZstdDecompressor::read(Bytes bytes)
+{
+    size_t total_read = 0;
+    while (total_read < bytes.size()) {
+        if (has_any_error() || m_eof)
+            break;
+
+        if (m_output_offset < m_buffer_size) {
+            auto nread = m_buffer.bytes().slice(m_output_offset, m_buffer_size - m_output_offset).copy_trimmed_to(bytes.slice(total_read));
+            m_output_offset += nread;
+            total_read += nread;
+            continue;
+        }
+
+        if (!m_in_frame) {
+            if (m_input_stream.unreliable_eof()) {
+                m_eof = true;
+                break;
+            }
+            if (!read_frame_header()) {
+                set_fatal_error();
+                break;
+            }
+            continue;
+        }
+
+        if (!read_block()) {
+            set_fatal_error();
+            break;
+        }
+    }
+    return total_read;
+}
+
+bool ZstdDecompressor::read_or_error(Bytes bytes)
+{
+    if (read(bytes) < bytes.size()) {
+        set_fatal_error();
+        return false;
+    }
+
+    return true;
+}
+
+bool ZstdDecompressor::discard_or_error(size_t count)
+{
+    u8 buffer[4096];
+
+    size_t ndiscarded = 0;
+    while (ndiscarded < count) {
+        if (unreliable_eof()) {
+            set_fatal_error();
+            return false;
+        }
+
+        ndiscarded += read({ buffer, min<size_t>(count - ndiscarded, sizeof(buffer)) });
+    }
+
+    return true;
+}
+
+bool ZstdDecompressor::unreliable_eof() const
+{
+    return m_eof;
+}
+
+bool ZstdDecompressor::handle_any_error()
+{
+    bool handled_errors = m_input_stream.handle_any_error();
+    return Stream::handle_any_error() || handled_errors;
+}
+
+Optional<ByteBuffer> ZstdDecompressor::decompress_all(ReadonlyBytes bytes)
+{
+    InputMemoryStream memory_stream { bytes };
+    ZstdDecompressor zstd_stream { memory_stream };
+    DuplexMemoryStream output_stream;
+
+    u8 buffer[4096];
+    while (!zstd_stream.has_any_error() && !zstd_stream.unreliable_eof()) {
+        auto nread = zstd_stream.read({ buffer, sizeof(buffer) });
+        output_stream.write_or_error({ buffer, nread });
+    }
+
+    if (zstd_stream.handle_any_error())
+        return {};
+
+    return output_stream.copy_into_contiguous_buffer();
+}
+
+static constexpr size_t min_match_length = 4;
+static constexpr size_t hash_bits = 16;
+
+static ALWAYS_INLINE u32 read_u32(u8 const* bytes)
+{
+    u32 value;
+    __builtin_memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+// Hashes the 6 bytes at `bytes`, which finds fewer short and far away matches than hashing the 4 of min_match_length.
+static ALWAYS_INLINE u32 hash_sequence(u8 const* bytes)
+{
+    constexpr u64 prime = 0xCF1BBCDCB7A56463;
+    u64 sequence;
+    __builtin_memcpy(&sequence, bytes, sizeof(sequence));
+    return ((AK::convert_between_host_and_little_endian(sequence) << 16) * prime) >> (64 - hash_bits);
+}
+
+// Counts how many bytes at `a` and `b` are the same, up to `limit`, 8 bytes at a time where it can: the first mismatching
+// byte is the lowest non-zero byte of the (little endian) difference.
+static ALWAYS_INLINE size_t count_matching_bytes(u8 const* a, u8 const* b, size_t limit)
+{
+    size_t count = 0;
+    for (; count + sizeof(u64) <= limit; count += sizeof(u64)) {
+        u64 a_bytes;
+        u64 b_bytes;
+        __builtin_memcpy(&a_bytes, a + count, sizeof(u64));
+        __builtin_memcpy(&b_bytes, b + count, sizeof(u64));
+        auto difference = AK::convert_between_host_and_little_endian(a_bytes ^ b_bytes);
+        if (difference != 0)
+            return count + __builtin_ctzll(difference) / 8;
+    }
+    while (count < limit && a[count] == b[count])
+        ++count;
+    return count;
+}
+
+struct Sequence {
+    u32 literal_length;
+    u32 match_length;
+    u32 offset;
+};
+
+static u8 literal_length_code(u32 literal_length)
+{
+    if (literal_length < 16)
+        return literal_length;
+    if (literal_length >= 64)
+        return highest_bit(literal_length) + 19;
+    size_t code = 16;
+    while (code + 1 < literal_length_codes.size() && literal_length_codes[code + 1].baseline <= literal_length)
+        ++code;
+    return code;
+}
+
+static u8 match_length_code(u32 match_length)
+{
+    if (match_length < 35)
+        return match_length - 3;
+    if (match_length >= 131)
+        return highest_bit(match_length - 3) + 36;
+    size_t code = 32;
+    while (code + 1 < match_length_codes.size() && match_length_codes[code + 1].baseline <= match_length)
+        ++code;
+    return code;
+}
+
+// Builds code lengths of at most max_huffman_bits for the symbols that occur. Returns the longest one.
+static size_t build_huffman_code_lengths(Array<u32, 256> const& frequencies, Array<u8, 256>& code_lengths)
+{
+    struct Node {
+        u32 frequency;
+        i16 parent;
+    };
+    Array<u32, 256> scaled_frequencies = frequencies;
+    for (;;) {
+        // Leaves first, then the inner nodes in the order they're made, which is also the order of their frequencies.
+        Vector<Node, 512> nodes;
+        Vector<u16, 256> leaves;
+        for (size_t symbol = 0; symbol < 256; ++symbol) {
+            if (scaled_frequencies[symbol] != 0)
+                leaves.append(symbol);
+        }
+        quick_sort(leaves, [&](auto a, auto b) { return scaled_frequencies[a] < scaled_frequencies[b]; });
+        for (auto symbol : leaves)
+            nodes.append({ scaled_frequencies[symbol], -1 });
+
+        size_t next_leaf = 0;
+        size_t next_inner = leaves.size();
+        auto take_smallest = [&] {
+            if (next_leaf < leaves.size() && (next_inner == nodes.size() || nodes[next_leaf].frequency <= nodes[next_inner].frequency))
+                return next_leaf++;
+            return next_inner++;
+        };
+        for (size_t i = 1; i < leaves.size(); ++i) {
+            auto a = take_smallest();
+            auto b = take_smallest();
+            nodes[a].parent = nodes.size();
+            nodes[b].parent = nodes.size();
+            nodes.append({ nodes[a].frequency + nodes[b].frequency, -1 });
+        }
+
+        // Depths, from the root (the last node) down.
+        Vector<u8, 512> depths;
+        depths.resize(nodes.size());
+        size_t max_length = 0;
+        for (size_t i = nodes.size() - 1; i-- > 0;) {
+            depths[i] = depths[nodes[i].parent] + 1;
+            max_length = max<size_t>(max_length, depths[i]);
+        }
+
+        if (max_length <= max_huffman_bits) {
+            code_lengths.fill(0);
+            for (size_t i = 0; i < leaves.size(); ++i)
+                code_lengths[leaves[i]] = depths[i];
+            return max_length;
+        }
+
+        // Flatten the distribution until the tree is shallow enough.
+        for (auto& frequency : scaled_frequencies) {
+            if (frequency != 0)
+                frequency = (frequency + 1) / 2;
+        }
+    }
+}
+
+// Writes the literals section of a block (RFC 8878, 3.1.1.3.1), Huffman coded if that's smaller.
+static void write_literals(ReadonlyBytes literals, ByteBuffer& output)
+{
+    auto write_raw_or_rle = [&](u8 type, ReadonlyBytes data) {
+        size_t size = literals.size();
+        if (size < 32) {
+            u8 header = type | size << 3;
+            output.append(&header, 1);
+        } else if (size < 4096) {
+            u8 header[2] = { static_cast<u8>(type | 1 << 2 | (size & 0xf) << 4), static_cast<u8>(size >> 4) };
+            output.append(header, sizeof(header));
+        } else {
+            u8 header[3] = { static_cast<u8>(type | 3 << 2 | (size & 0xf) << 4), static_cast<u8>(size >> 4), static_cast<u8>(size >> 12) };
+            output.append(header, sizeof(header));
+        }
+        output.append(data.data(), data.size());
+    };
+
+    Array<u32, 256> frequencies {};
+    for (auto byte : literals)
+        ++frequencies[byte];
+    size_t symbol_count = 0;
+    size_t last_symbol = 0;
+    for (size_t symbol = 0; symbol < 256; ++symbol) {
+        if (frequencies[symbol] != 0) {
+            ++symbol_count;
+            last_symbol = symbol;
+        }
+    }
+
+    if (symbol_count == 1 && literals.size() > 1)
+        return write_raw_or_rle(1, literals.trim(1));
+    // The weights are stored directly, which only works for up to 128 of them. Short runs aren't worth a tree either.
+    if (symbol_count < 2 || last_symbol > 128 || literals.size() < 64)
+        return write_raw_or_rle(0, literals);
+
+    Array<u8, 256> code_lengths;
+    auto max_bits = build_huffman_code_lengths(frequencies, code_lengths);
+
+    // The codes are handed out in order of increasing weight (decreasing length), then symbol.
+    Array<u16, 256> codes {};
+    size_t position = 0;
+    for (size_t length = max_bits; length > 0; --length) {
+        for (size_t symbol = 0; symbol <= last_symbol; ++symbol) {
+            if (code_lengths[symbol] != length)
+                continue;
+            codes[symbol] = position >> (max_bits - length);
+            position += 1 << (max_bits - length);
+        }
+    }
+    VERIFY(position == 1u << max_bits);
+
+    ByteBuffer compressed;
+    compressed.ensure_capacity(literals.size() + 128);
+    u8 tree_header = 127 + last_symbol;
+    compressed.append(&tree_header, 1);
+    for (size_t symbol = 0; symbol < last_symbol; symbol += 2) {
+        auto weight = [&](size_t symbol) -> u8 { return symbol < last_symbol && code_lengths[symbol] != 0 ? max_bits + 1 - code_lengths[symbol] : 0; };
+        u8 byte = weight(symbol) << 4 | weight(symbol + 1);
+        compressed.append(&byte, 1);
+    }
+
+    // The decoder reads each stream from the end, so the literals are written back to front.
+    auto write_stream = [&](ReadonlyBytes stream_literals) {
+        BitWriter writer { compressed };
+        for (size_t i = stream_literals.size(); i-- > 0;)
+            writer.write_bits(codes[stream_literals[i]], code_lengths[stream_literals[i]]);
+        writer.finish();
+    };
+
+    bool has_four_streams = literals.size() > 1023;
+    if (!has_four_streams) {
+        write_stream(literals);
+    } else {
+        auto jump_table_offset = compressed.size();
+        u8 jump_table[6] {};
+        compressed.append(jump_table, sizeof(jump_table));
+        size_t segment_size = (literals.size() + 3) / 4;
+        for (size_t i = 0; i < 4; ++i) {
+            auto stream_start = compressed.size();
+            write_stream(literals.slice(i * segment_size, i < 3 ? segment_size : literals.size() - 3 * segment_size));
+            auto stream_size = compressed.size() - stream_start;
+            if (stream_size > 0xffff)
+                return write_raw_or_rle(0, literals);
+            if (i < 3) {
+                compressed[jump_table_offset + 2 * i] = stream_size & 0xff;
+                compressed[jump_table_offset + 2 * i + 1] = stream_size >> 8;
+            }
+        }
+    }
+
+    size_t size_bits;
+    u8 size_format;
+    if (!has_four_streams) {
+        size_bits = 10;
+        size_format = 0;
+    } else if (max(literals.size(), compressed.size()) < 1024) {
+        size_bits = 10;
+        size_format = 1;
+    } else if (max(literals.size(), compressed.size()) < 16384) {
+        size_bits = 14;
+        size_format = 2;
+    } else {
+        size_bits = 18;
+        size_format = 3;
+    }
+    size_t header_size = size_format < 2 ? 3 : size_format + 2;
+    if (compressed.size() >= (1u << size_bits) || header_size + compressed.size() >= literals.size() + 3)
+        return write_raw_or_rle(0, literals);
+
+    u64 header = 2 | size_format << 2 | static_cast<u64>(literals.size()) << 4 | static_cast<u64>(compressed.size()) << (4 + size_bits);
+    for (size_t i = 0; i < header_size; ++i) {
+        u8 byte = header >> (8 * i);
+        output.append(&byte, 1);
+    }
+    output.append(compressed.data(), compressed.size());
+}
+
+// Writes the sequences section of a block (RFC 8878, 3.1.1.3.2), using the predefined FSE tables.
+static void write_sequences(Span<Sequence const> sequences, ByteBuffer& output)
+{
+    auto count = sequences.size();
+    if (count < 128) {
+        u8 byte = count;
+        output.append(&byte, 1);
+    } else if (count < 0x7f00) {
+        u8 bytes[2] = { static_cast<u8>((count >> 8) + 128), static_cast<u8>(count) };
+        output.append(bytes, sizeof(bytes));
+    } else {
+        u8 bytes[3] = { 255, static_cast<u8>(count - 0x7f00), static_cast<u8>((count - 0x7f00) >> 8) };
+        output.append(bytes, sizeof(bytes));
+    }
+    if (count == 0)
+        return;
+
+    u8 modes = 0; // All predefined
+    output.append(&modes, 1);
+
+    // Everything is written in the reverse of the order the decoder reads it in, starting with the last sequence.
+    auto& tables = default_tables();
+    BitWriter writer { output };
+    u16 literal_length_state = 0;
+    u16 match_length_state = 0;
+    u16 offset_state = 0;
+    for (size_t i = count; i-- > 0;) {
+        auto& sequence = sequences[i];
+        auto literal_length_symbol = literal_length_code(sequence.literal_length);
+        auto match_length_symbol = match_length_code(sequence.match_length);
+        u32 offset_value = sequence.offset + 3;
+        u8 offset_symbol = highest_bit(offset_value);
+
+        if (i == count - 1) {
+            literal_length_state = tables.literal_length_encoder.first_state(literal_length_symbol);
+            match_length_state = tables.match_length_encoder.first_state(match_length_symbol);
+            offset_state = tables.offset_encoder.first_state(offset_symbol);
+        } else {
+            tables.offset_encoder.encode(offset_state, offset_symbol, writer);
+            tables.match_length_encoder.encode(match_length_state, match_length_symbol, writer);
+            tables.literal_length_encoder.encode(literal_length_state, literal_length_symbol, writer);
+        }
+
+        auto& literal_length = literal_length_codes[literal_length_symbol];
+        auto& match_length = match_length_codes[match_length_symbol];
+        writer.write_bits(sequence.literal_length - literal_length.baseline, literal_length.extra_bits);
+        writer.write_bits(sequence.match_length - match_length.baseline, match_length.extra_bits);
+        writer.write_bits(offset_value - (1u << offset_symbol), offset_symbol);
+    }
+    writer.write_bits(match_length_state, tables.match_length_encoder.accuracy_log());
+    writer.write_bits(offset_state, tables.offset_encoder.accuracy_log());
+    writer.write_bits(literal_length_state, tables.literal_length_encoder.accuracy_log());
+    writer.finish();
+}
+
+ZstdCompressor::ZstdCompressor(OutputStream& stream)
+    : m_output_stream(stream)
+{
+    m_buffer.resize(2 * window_size + block_size);
+    m_hash_table.resize(1 << hash_bits);
+}
+
+ZstdCompressor::~ZstdCompressor()
+{
+    VERIFY(m_finished);
+}
+
+void ZstdCompressor::write_frame_header()
+{
+    LittleEndian<u32> magic = Zstd::frame_magic;
+    m_output_stream << magic;
+    // A content checksum, and the window size (as the exponent of a power of two, starting at 1 KiB)
+    u8 descriptor[2] = { 0b00000100, static_cast<u8>((__builtin_ctz(window_size) - 10) << 3) };
+    m_output_stream << ReadonlyBytes { descriptor, sizeof(descriptor) };
+    m_wrote_frame_header = true;
+}
+
+size_t ZstdCompressor::write(ReadonlyBytes bytes)
+{
+    VERIFY(!m_finished);
+
+    size_t total_written = 0;
+    while (total_written < bytes.size()) {
+        auto n_written = bytes.slice(total_written).copy_trimmed_to(m_buffer.bytes().slice(m_buffer_size, block_size - (m_buffer_size - m_block_start)));
+        m_buffer_size += n_written;
+        total_written += n_written;
+
+        if (m_buffer_size - m_block_start == block_size)
+            flush(false);
+    }
+    return total_written;
+}
+
+bool ZstdCompressor::write_or_error(ReadonlyBytes bytes)
+{
+    if (write(bytes) < bytes.size()) {
+        set_fatal_error();
+        return false;
+    }
+
+    return true;
+}
+
+void ZstdCompressor::flush(bool is_last_block)
+{
+    if (!m_wrote_frame_header)
+        write_frame_header();
+
+    auto block = m_buffer.bytes().slice(m_block_start, m_buffer_size - m_block_start);
+    m_checksum.update(block);
+
+    // Find the matches, with a hash table of the last position each 6 bytes were seen at (plus one, so that zero means
+    // there's nothing there yet), which also covers the window before this block.
+    // ByteBuffer only grows by as much as it has to, so everything is given its worst case size up front.
+    Vector<Sequence> sequences;
+    sequences.ensure_capacity(block.size() / min_match_length + 1);
+    ByteBuffer literals;
+    literals.ensure_capacity(block.size());
+    auto const* in = m_buffer.data();
+    size_t anchor = m_block_start;
+    if (block.size() > 2 * sizeof(u64)) {
+        auto match_limit = m_buffer_size - sizeof(u64);
+        size_t position = m_block_start;
+        while (position < match_limit) {
+            auto sequence = read_u32(in + position);
+            auto& slot = m_hash_table[hash_sequence(in + position)];
+            size_t candidate = slot;
+            slot = position + 1;
+
+            if (candidate == 0 || position + 1 - candidate > window_size || read_u32(in + candidate - 1) != sequence) {
+                // The longer we go without finding anything, the more positions we skip, so that incompressible input
+                // doesn't take long.
+                position += 1 + ((position - anchor) >> 6);
+                continue;
+            }
+            --candidate;
+
+            // The hash only found the start of the match, which might reach further back.
+            while (position > anchor && candidate > 0 && in[position - 1] == in[candidate - 1]) {
+                --position;
+                --candidate;
+            }
+            auto match_length = min_match_length + count_matching_bytes(in + position + min_match_length, in + candidate + min_match_length, m_buffer_size - position - min_match_length);
+
+            sequences.append({ static_cast<u32>(position - anchor), static_cast<u32>(match_length), static_cast<u32>(position - candidate) });
+            literals.append(in + anchor, position - anchor);
+            position += match_length;
+            anchor = position;
+
+            // Matches often follow each other, so index the end of this one too.
+            if (position < match_limit)
+                m_hash_table[hash_sequence(in + position - 2)] = position - 1;
+        }
+    }
+    literals.append(in + anchor, m_buffer_size - anchor);
+
+    ByteBuffer compressed;
+    compressed.ensure_capacity(2 * block.size() + 64);
+    write_literals(literals, compressed);
+    write_sequences(sequences, compressed);
+
+    // RFC 8878, 3.1.1.2: Block_Header, which is followed by the block as it is if compressing it didn't help
+    u8 type = 2;
+    ReadonlyBytes content = compressed;
+    if (compressed.size() >= block.size()) {
+        type = 0;
+        content = block;
+    }
+    u32 header = is_last_block | type << 1 | content.size() << 3;
+    u8 header_bytes[3] = { static_cast<u8>(header), static_cast<u8>(header >> 8), static_cast<u8>(header >> 16) };
+    m_output_stream << ReadonlyBytes { header_bytes, sizeof(header_bytes) } << content;
+
+    // Once there's no room for another block, only the window is kept.
+    m_block_start = m_buffer_size;
+    if (m_buffer_size + block_size > m_buffer.size()) {
+        auto shift = m_buffer_size - window_size;
+        __builtin_memmove(m_buffer.data(), m_buffer.data() + shift, window_size);
+        for (auto& slot : m_hash_table)
+            slot = slot > shift ? slot - shift : 0;
+        m_block_start = m_buffer_size = window_size;
+    }
+
+    if (m_output_stream.handle_any_error())
+        set_fatal_error();
+}
+
+void ZstdCompressor::final_flush()
+{
+    VERIFY(!m_finished);
+    flush(true);
+    LittleEndian<u32> checksum = static_cast<u32>(m_checksum.digest());
+    m_output_stream << checksum;
+    m_finished = true;
+}
+
+Optional<ByteBuffer> ZstdCompressor::compress_all(ReadonlyBytes bytes)
+{
+    DuplexMemoryStream output_stream;
+    ZstdCompressor zstd_stream { output_stream };
+
+    zstd_stream.write_or_error(bytes);
+    zstd_stream.final_flush();
+
+    if (zstd_stream.handle_any_error())
+        return {};
+
+    return output_stream.copy_into_contiguous_buffer();
+}
+
+}
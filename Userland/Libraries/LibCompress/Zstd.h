@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Optional.h>
+#include <AK/OwnPtr.h>
+#include <AK/Stream.h>
+#include <LibCrypto/Checksum/XXHash.h>
+
+namespace Compress {
+
+// Zstandard (RFC 8878), which compresses about as well as deflate while being much faster to decompress.
+class Zstd {
+public:
+    static constexpr u32 frame_magic = 0xFD2FB528;
+    static constexpr size_t max_block_size = 128 * KiB;
+};
+
+// The entropy tables and repeated offsets that compressed blocks can take over from the ones before them in a frame.
+class ZstdBlockDecoder;
+
+// Reads Zstandard frames, including ones that follow each other. Dictionaries aren't supported.
+class ZstdDecompressor final : public InputStream {
+public:
+    // Frames that need to look back further than this are rejected rather than taking up too much memory. RFC 8878
+    // recommends supporting at least 8 MiB.
+    static constexpr size_t max_window_size = 64 * MiB;
+
+    ZstdDecompressor(InputStream&);
+    ~ZstdDecompressor();
+
+    size_t read(Bytes) override;
+    bool read_or_error(Bytes) override;
+    bool discard_or_error(size_t) override;
+
+    bool unreliable_eof() const override;
+    bool handle_any_error() override;
+
+    static Optional<ByteBuffer> decompress_all(ReadonlyBytes);
+    static bool is_likely_compressed(ReadonlyBytes);
+
+private:
+    bool read_frame_header();
+    bool read_block();
+
+    InputStream& m_input_stream;
+
+    bool m_in_frame { false };
+    bool m_eof { false };
+    bool m_has_checksum { false };
+    Optional<u64> m_content_size;
+    u64 m_frame_output_size { 0 };
+    size_t m_window_size { 0 };
+    Crypto::Checksum::XXHash64 m_checksum;
+    OwnPtr<ZstdBlockDecoder> m_block_decoder;
+
+    // The output of the frame so far, of which only the last m_window_size bytes are kept once they have been read.
+    ByteBuffer m_buffer;
+    size_t m_buffer_size { 0 };
+    size_t m_output_offset { 0 };
+    ByteBuffer m_compressed_block;
+};
+
+// Writes a single Zstandard frame with a checksum of its contents. Literals are Huffman coded and sequences use the
+// predefined FSE tables.
+class ZstdCompressor final : public OutputStream {
+public:
+    static constexpr size_t block_size = Zstd::max_block_size;
+    static constexpr size_t window_size = 1 * MiB;
+
+    ZstdCompressor(OutputStream&);
+    ~ZstdCompressor();
+
+    size_t write(ReadonlyBytes) override;
+    bool write_or_error(ReadonlyBytes) override;
+    void final_flush();
+
+    static Optional<ByteBuffer> compress_all(ReadonlyBytes);
+
+private:
+    void write_frame_header();
+    void flush(bool is_last_block);
+
+    OutputStream& m_output_stream;
+    bool m_wrote_frame_header { false };
+    bool m_finished { false };
+    Crypto::Checksum::XXHash64 m_checksum;
+
+    // Up to window_size bytes of history, followed by the block that's being filled.
+    ByteBuffer m_buffer;
+    size_t m_block_start { 0 };
+    size_t m_buffer_size { 0 };
+    Vector<u32> m_hash_table;
+};
+
+}
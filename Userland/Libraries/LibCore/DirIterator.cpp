@@ -7,6 +7,7 @@
 #include <AK/Vector.h>
 #include <LibCore/DirIterator.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <unistd.h>
 
 namespace Core {
@@ -36,7 +37,20 @@ bool DirIterator::advance_next()
 
     while (true) {
         errno = 0;
-        auto* de = readdir(m_dir);
+        dirent* de;
+        if (m_flags & Flags::WithStat) {
+#ifdef __serenity__
+            de = readdir_with_stat(m_dir, &m_next_stat);
+#else
+            de = readdir(m_dir);
+            if (de && fstatat(dirfd(m_dir), de->d_name, &m_next_stat, AT_SYMLINK_NOFOLLOW) < 0) {
+                memset(&m_next_stat, 0, sizeof(m_next_stat));
+                errno = 0;
+            }
+#endif
+        } else {
+            de = readdir(m_dir);
+        }
         if (!de) {
             m_error = errno;
             m_next = String();
@@ -72,6 +86,7 @@ String DirIterator::next_path()
 
     auto tmp = m_next;
     m_next = String();
+    m_current_stat = m_next_stat;
     return tmp;
 }
 
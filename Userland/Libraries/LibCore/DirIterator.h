@@ -9,6 +9,7 @@
 #include <AK/String.h>
 #include <dirent.h>
 #include <string.h>
+#include <sys/stat.h>
 
 namespace Core {
 
@@ -18,6 +19,8 @@ public:
         NoFlags = 0x0,
         SkipDots = 0x1,
         SkipParentAndBaseDir = 0x2,
+        // Fetch every entry's metadata along with the entries themselves, see current_stat().
+        WithStat = 0x4,
     };
 
     explicit DirIterator(String path, Flags = Flags::NoFlags);
@@ -29,12 +32,17 @@ public:
     bool has_next();
     String next_path();
     String next_full_path();
+    // With Flags::WithStat, the metadata of the entry last returned by next_path(), as if by lstat().
+    // st_mode is 0 if the entry couldn't be stat'ed.
+    struct stat const& current_stat() const { return m_current_stat; }
     int fd() const;
 
 private:
     DIR* m_dir = nullptr;
     int m_error = 0;
     String m_next;
+    struct stat m_next_stat {};
+    struct stat m_current_stat {};
     String m_path;
     int m_flags;
 
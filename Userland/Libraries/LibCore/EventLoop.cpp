@@ -29,6 +29,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/select.h>
+#ifdef __serenity__
+#    include <sys/epoll.h>
+#endif
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/time.h>
@@ -40,6 +43,9 @@ namespace Core {
 class InspectorServerConnection;
 
 [[maybe_unused]] static bool connect_to_inspector_server();
+#ifdef __serenity__
+static void update_epoll_interest(int fd);
+#endif
 
 struct EventLoopTimer {
     int timer_id { 0 };
@@ -48,11 +54,18 @@ struct EventLoopTimer {
     bool should_reload { false };
     TimerShouldFireWhenNotVisible fire_when_not_visible { TimerShouldFireWhenNotVisible::No };
     WeakPtr<Object> owner;
+    size_t heap_index { 0 };
+    bool is_hidden { false };
 
     void reload(const timeval& now);
     bool has_expired(const timeval& now) const;
+    bool should_wait_for_owner() const;
 };
 
+static void insert_timer_into_heap(EventLoopTimer&);
+static void remove_timer_from_heap(EventLoopTimer&);
+static void unhide_timers();
+
 struct EventLoop::Private {
     Threading::Mutex lock;
 };
@@ -61,7 +74,18 @@ static EventLoop* s_main_event_loop;
 static Vector<EventLoop&>* s_event_loop_stack;
 static NeverDestroyed<IDAllocator> s_id_allocator;
 static HashMap<int, NonnullOwnPtr<EventLoopTimer>>* s_timers;
+// The timers that can fire, in a binary min-heap ordered by their fire time. Every timer knows its index in the heap,
+// so that it can be removed without searching for it.
+static Vector<EventLoopTimer*>* s_timer_heap;
+// Expired timers whose owner isn't visible. They go back into the heap once it is, and fire right away.
+static HashTable<EventLoopTimer*>* s_hidden_timers;
 static HashTable<Notifier*>* s_notifiers;
+#ifdef __serenity__
+// Every fd has a single interest in the epoll, which covers the events of all of its notifiers.
+static int s_epoll_fd = -1;
+static HashMap<int, Vector<Notifier*, 1>>* s_notifiers_by_fd;
+static constexpr int max_events_per_wait = 64;
+#endif
 int EventLoop::s_wake_pipe_fds[2];
 static RefPtr<InspectorServerConnection> s_inspector_server_connection;
 
@@ -259,7 +283,12 @@ EventLoop::EventLoop([[maybe_unused]] MakeInspectable make_inspectable)
     if (!s_event_loop_stack) {
         s_event_loop_stack = new Vector<EventLoop&>;
         s_timers = new HashMap<int, NonnullOwnPtr<EventLoopTimer>>;
+        s_timer_heap = new Vector<EventLoopTimer*>;
+        s_hidden_timers = new HashTable<EventLoopTimer*>;
         s_notifiers = new HashTable<Notifier*>;
+#ifdef __serenity__
+        s_notifiers_by_fd = new HashMap<int, Vector<Notifier*, 1>>;
+#endif
     }
 
     if (!s_main_event_loop) {
@@ -276,6 +305,19 @@ EventLoop::EventLoop([[maybe_unused]] MakeInspectable make_inspectable)
         VERIFY(rc == 0);
         s_event_loop_stack->append(*this);
 
+#ifdef __serenity__
+        s_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        VERIFY(s_epoll_fd >= 0);
+        epoll_event wake_event {};
+        wake_event.events = EPOLLIN;
+        wake_event.data.fd = s_wake_pipe_fds[0];
+        rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, s_wake_pipe_fds[0], &wake_event);
+        VERIFY(rc == 0);
+        // Notifiers may have been registered since we forked.
+        for (auto& it : *s_notifiers_by_fd)
+            update_epoll_interest(it.key);
+#endif
+
 #ifdef __serenity__
         if (getuid() != 0
             && make_inspectable == MakeInspectable::Yes
@@ -554,7 +596,15 @@ void EventLoop::notify_forked(ForkEvent event)
         s_main_event_loop = nullptr;
         s_event_loop_stack->clear();
         s_timers->clear();
+        s_timer_heap->clear();
+        s_hidden_timers->clear();
         s_notifiers->clear();
+#ifdef __serenity__
+        // The epoll is shared with our parent, so we must not touch its interests.
+        close(s_epoll_fd);
+        s_epoll_fd = -1;
+        s_notifiers_by_fd->clear();
+#endif
         if (auto* info = signals_info<false>()) {
             info->signal_handlers.clear();
             info->next_signal_id = 0;
@@ -571,9 +621,12 @@ void EventLoop::notify_forked(ForkEvent event)
 
 void EventLoop::wait_for_event(WaitMode mode)
 {
+#ifndef __serenity__
     fd_set rfds;
     fd_set wfds;
+#endif
 retry:
+#ifndef __serenity__
     FD_ZERO(&rfds);
     FD_ZERO(&wfds);
 
@@ -595,6 +648,7 @@ retry:
         if (notifier->event_mask() & Notifier::Exceptional)
             VERIFY_NOT_REACHED();
     }
+#endif
 
     bool queued_events_is_empty;
     {
@@ -622,8 +676,16 @@ retry:
         }
     }
 
+#ifdef __serenity__
+    epoll_event events[max_events_per_wait];
+    // Round up, so we don't wake up just before the timer expires and then spin until it does.
+    int timeout_ms = should_wait_forever ? -1 : timeout.tv_sec * 1000 + (timeout.tv_usec + 999) / 1000;
+try_select_again:
+    int marked_fd_count = epoll_wait(s_epoll_fd, events, max_events_per_wait, timeout_ms);
+#else
 try_select_again:
     int marked_fd_count = select(max_fd + 1, &rfds, &wfds, nullptr, should_wait_forever ? nullptr : &timeout);
+#endif
     if (marked_fd_count < 0) {
         int saved_errno = errno;
         if (saved_errno == EINTR) {
@@ -634,7 +696,16 @@ try_select_again:
         dbgln_if(EVENTLOOP_DEBUG, "Core::EventLoop::wait_for_event: {} ({}: {})", marked_fd_count, saved_errno, strerror(saved_errno));
         VERIFY_NOT_REACHED();
     }
-    if (FD_ISSET(s_wake_pipe_fds[0], &rfds)) {
+#ifdef __serenity__
+    bool wake_pipe_is_readable = false;
+    for (int i = 0; i < marked_fd_count; ++i) {
+        if (events[i].data.fd == s_wake_pipe_fds[0])
+            wake_pipe_is_readable = true;
+    }
+#else
+    bool wake_pipe_is_readable = FD_ISSET(s_wake_pipe_fds[0], &rfds);
+#endif
+    if (wake_pipe_is_readable) {
         int wake_events[8];
         auto nread = read(s_wake_pipe_fds[0], wake_events, sizeof(wake_events));
         if (nread < 0) {
@@ -662,22 +733,32 @@ try_select_again:
         now.tv_usec = now_spec.tv_nsec / 1000;
     }
 
-    for (auto& it : *s_timers) {
-        auto& timer = *it.value;
-        if (!timer.has_expired(now))
-            continue;
-        auto owner = timer.owner.strong_ref();
-        if (timer.fire_when_not_visible == TimerShouldFireWhenNotVisible::No
-            && owner && !owner->is_visible_for_timer_purposes()) {
+    unhide_timers();
+
+    // Take all expired timers off the heap before reloading any of them, so that a timer with an interval of 0 only
+    // fires once per iteration.
+    Vector<EventLoopTimer*, 16> expired_timers;
+    while (!s_timer_heap->is_empty() && s_timer_heap->first()->has_expired(now)) {
+        auto& timer = *s_timer_heap->first();
+        remove_timer_from_heap(timer);
+        expired_timers.append(&timer);
+    }
+
+    for (auto* timer : expired_timers) {
+        if (timer->should_wait_for_owner()) {
+            timer->is_hidden = true;
+            s_hidden_timers->set(timer);
             continue;
         }
 
-        dbgln_if(EVENTLOOP_DEBUG, "Core::EventLoop: Timer {} has expired, sending Core::TimerEvent to {}", timer.timer_id, *owner);
+        auto owner = timer->owner.strong_ref();
+        dbgln_if(EVENTLOOP_DEBUG, "Core::EventLoop: Timer {} has expired, sending Core::TimerEvent to {}", timer->timer_id, *owner);
 
         if (owner)
-            post_event(*owner, make<TimerEvent>(timer.timer_id));
-        if (timer.should_reload) {
-            timer.reload(now);
+            post_event(*owner, make<TimerEvent>(timer->timer_id));
+        if (timer->should_reload) {
+            timer->reload(now);
+            insert_timer_into_heap(*timer);
         } else {
             // FIXME: Support removing expired timers that don't want to reload.
             VERIFY_NOT_REACHED();
@@ -687,6 +768,22 @@ try_select_again:
     if (!marked_fd_count)
         return;
 
+#ifdef __serenity__
+    for (int i = 0; i < marked_fd_count; ++i) {
+        auto it = s_notifiers_by_fd->find(events[i].data.fd);
+        if (it == s_notifiers_by_fd->end())
+            continue;
+        // Errors and hangups are what a read would find out about, just like select() says the fd is readable then.
+        bool is_readable = events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP | EPOLLRDHUP);
+        bool is_writable = events[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP);
+        for (auto* notifier : it->value) {
+            if (is_readable && (notifier->event_mask() & Notifier::Event::Read))
+                post_event(*notifier, make<NotifierReadEvent>(notifier->fd()));
+            if (is_writable && (notifier->event_mask() & Notifier::Event::Write))
+                post_event(*notifier, make<NotifierWriteEvent>(notifier->fd()));
+        }
+    }
+#else
     for (auto& notifier : *s_notifiers) {
         if (FD_ISSET(notifier->fd(), &rfds)) {
             if (notifier->event_mask() & Notifier::Event::Read)
@@ -697,6 +794,7 @@ try_select_again:
                 post_event(*notifier, make<NotifierWriteEvent>(notifier->fd()));
         }
     }
+#endif
 }
 
 bool EventLoopTimer::has_expired(const timeval& now) const
@@ -704,27 +802,123 @@ bool EventLoopTimer::has_expired(const timeval& now) const
     return now.tv_sec > fire_time.tv_sec || (now.tv_sec == fire_time.tv_sec && now.tv_usec >= fire_time.tv_usec);
 }
 
+// How late a timer may fire: the largest power of two milliseconds up to a sixteenth of its interval.
+static int timer_slack_ms(int interval)
+{
+    static constexpr int max_timer_slack_ms = 32;
+    int slack = 1;
+    while (slack * 2 <= interval / 16 && slack * 2 <= max_timer_slack_ms)
+        slack *= 2;
+    return slack;
+}
+
 void EventLoopTimer::reload(const timeval& now)
 {
-    fire_time = now;
-    fire_time.tv_sec += interval / 1000;
-    fire_time.tv_usec += (interval % 1000) * 1000;
+    // Rounding the fire time up to a multiple of the slack makes timers that are due around the same time fire
+    // together, so the event loop wakes up once for all of them instead of once for each.
+    u64 fire_time_us = now.tv_sec * 1000000ull + now.tv_usec + interval * 1000ull;
+    u64 slack_us = timer_slack_ms(interval) * 1000ull;
+    // Note: Timers only allowed to be a millisecond late keep their exact fire time.
+    if (slack_us > 1000)
+        fire_time_us = ceil_div(fire_time_us, slack_us) * slack_us;
+    fire_time.tv_sec = fire_time_us / 1000000;
+    fire_time.tv_usec = fire_time_us % 1000000;
 }
 
-Optional<struct timeval> EventLoop::get_next_timer_expiration()
+bool EventLoopTimer::should_wait_for_owner() const
 {
-    Optional<struct timeval> soonest {};
-    for (auto& it : *s_timers) {
-        auto& fire_time = it.value->fire_time;
-        auto owner = it.value->owner.strong_ref();
-        if (it.value->fire_when_not_visible == TimerShouldFireWhenNotVisible::No
-            && owner && !owner->is_visible_for_timer_purposes()) {
-            continue;
+    if (fire_when_not_visible == TimerShouldFireWhenNotVisible::Yes)
+        return false;
+    auto strong_owner = owner.strong_ref();
+    return strong_owner && !strong_owner->is_visible_for_timer_purposes();
+}
+
+static bool fires_before(EventLoopTimer const& a, EventLoopTimer const& b)
+{
+    return a.fire_time.tv_sec < b.fire_time.tv_sec || (a.fire_time.tv_sec == b.fire_time.tv_sec && a.fire_time.tv_usec < b.fire_time.tv_usec);
+}
+
+static void swap_timers_in_heap(size_t a, size_t b)
+{
+    auto& heap = *s_timer_heap;
+    swap(heap[a], heap[b]);
+    heap[a]->heap_index = a;
+    heap[b]->heap_index = b;
+}
+
+static void sift_timer_up(size_t index)
+{
+    auto& heap = *s_timer_heap;
+    while (index != 0) {
+        auto parent = (index - 1) / 2;
+        if (!fires_before(*heap[index], *heap[parent]))
+            break;
+        swap_timers_in_heap(index, parent);
+        index = parent;
+    }
+}
+
+static void sift_timer_down(size_t index)
+{
+    auto& heap = *s_timer_heap;
+    for (;;) {
+        auto soonest = index;
+        for (auto child : { index * 2 + 1, index * 2 + 2 }) {
+            if (child < heap.size() && fires_before(*heap[child], *heap[soonest]))
+                soonest = child;
         }
-        if (!soonest.has_value() || fire_time.tv_sec < soonest.value().tv_sec || (fire_time.tv_sec == soonest.value().tv_sec && fire_time.tv_usec < soonest.value().tv_usec))
-            soonest = fire_time;
+        if (soonest == index)
+            break;
+        swap_timers_in_heap(index, soonest);
+        index = soonest;
+    }
+}
+
+static void insert_timer_into_heap(EventLoopTimer& timer)
+{
+    timer.heap_index = s_timer_heap->size();
+    s_timer_heap->append(&timer);
+    sift_timer_up(timer.heap_index);
+}
+
+static void remove_timer_from_heap(EventLoopTimer& timer)
+{
+    auto index = timer.heap_index;
+    auto last = s_timer_heap->size() - 1;
+    if (index != last)
+        swap_timers_in_heap(index, last);
+    s_timer_heap->take_last();
+    if (index != last) {
+        auto& moved_timer = *(*s_timer_heap)[index];
+        sift_timer_up(index);
+        sift_timer_down(moved_timer.heap_index);
     }
-    return soonest;
+}
+
+static void unhide_timers()
+{
+    if (s_hidden_timers->is_empty())
+        return;
+    Vector<EventLoopTimer*> timers_to_unhide;
+    for (auto* timer : *s_hidden_timers) {
+        if (!timer->should_wait_for_owner())
+            timers_to_unhide.append(timer);
+    }
+    for (auto* timer : timers_to_unhide) {
+        s_hidden_timers->remove(timer);
+        timer->is_hidden = false;
+        insert_timer_into_heap(*timer);
+    }
+}
+
+Optional<struct timeval> EventLoop::get_next_timer_expiration()
+{
+    unhide_timers();
+    if (s_timer_heap->is_empty())
+        return {};
+    // Note: The soonest timer may belong to an owner that isn't visible. Waking up for it only to find that out is
+    //       cheaper than looking for the soonest timer that can actually fire.
+    return s_timer_heap->first()->fire_time;
 }
 
 int EventLoop::register_timer(Object& object, int milliseconds, bool should_reload, TimerShouldFireWhenNotVisible fire_when_not_visible)
@@ -743,6 +937,7 @@ int EventLoop::register_timer(Object& object, int milliseconds, bool should_relo
     timer->fire_when_not_visible = fire_when_not_visible;
     int timer_id = s_id_allocator->allocate();
     timer->timer_id = timer_id;
+    insert_timer_into_heap(*timer);
     s_timers->set(timer_id, move(timer));
     return timer_id;
 }
@@ -753,18 +948,76 @@ bool EventLoop::unregister_timer(int timer_id)
     auto it = s_timers->find(timer_id);
     if (it == s_timers->end())
         return false;
+    auto& timer = *it->value;
+    if (timer.is_hidden)
+        s_hidden_timers->remove(&timer);
+    else
+        remove_timer_from_heap(timer);
     s_timers->remove(it);
     return true;
 }
 
+#ifdef __serenity__
+static void update_epoll_interest(int fd)
+{
+    if (s_epoll_fd < 0)
+        return;
+
+    epoll_event event {};
+    event.data.fd = fd;
+    if (auto it = s_notifiers_by_fd->find(fd); it != s_notifiers_by_fd->end()) {
+        for (auto* notifier : it->value) {
+            if (notifier->event_mask() & Notifier::Read)
+                event.events |= EPOLLIN;
+            if (notifier->event_mask() & Notifier::Write)
+                event.events |= EPOLLOUT;
+            if (notifier->event_mask() & Notifier::Exceptional)
+                VERIFY_NOT_REACHED();
+        }
+    }
+
+    if (!event.events) {
+        // The fd may well have been closed already, in which case the kernel has forgotten about it anyway.
+        (void)epoll_ctl(s_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        return;
+    }
+    if (epoll_ctl(s_epoll_fd, EPOLL_CTL_MOD, fd, &event) == 0)
+        return;
+    if (errno != ENOENT || epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0)
+        dbgln("Core::EventLoop: Failed to watch fd {}: {}", fd, strerror(errno));
+}
+#endif
+
 void EventLoop::register_notifier(Badge<Notifier>, Notifier& notifier)
 {
-    s_notifiers->set(&notifier);
+    if (s_notifiers->set(&notifier) != AK::HashSetResult::InsertedNewEntry)
+        return;
+#ifdef __serenity__
+    s_notifiers_by_fd->ensure(notifier.fd()).append(&notifier);
+    update_epoll_interest(notifier.fd());
+#endif
 }
 
 void EventLoop::unregister_notifier(Badge<Notifier>, Notifier& notifier)
 {
-    s_notifiers->remove(&notifier);
+    if (!s_notifiers->remove(&notifier))
+        return;
+#ifdef __serenity__
+    auto it = s_notifiers_by_fd->find(notifier.fd());
+    VERIFY(it != s_notifiers_by_fd->end());
+    it->value.remove_first_matching([&](auto* entry) { return entry == &notifier; });
+    if (it->value.is_empty())
+        s_notifiers_by_fd->remove(it);
+    update_epoll_interest(notifier.fd());
+#endif
+}
+
+void EventLoop::notifier_event_mask_changed(Badge<Notifier>, [[maybe_unused]] Notifier& notifier)
+{
+#ifdef __serenity__
+    if (s_notifiers->contains(&notifier))
+        update_epoll_interest(notifier.fd());
+#endif
 }
 
 void EventLoop::wake()
@@ -7,10 +7,13 @@
 #include <LibCore/LocalSocket.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #ifndef SOCK_NONBLOCK
 #    include <sys/ioctl.h>
@@ -141,4 +144,53 @@ RefPtr<LocalSocket> LocalSocket::take_over_accepted_socket_from_system_server(St
     return socket;
 }
 
+void LocalSocket::fork_for_each_connection_from_system_server(String const& socket_path)
+{
+    if (!s_overtaken_sockets_parsed)
+        parse_sockets_from_system_server();
+
+    auto it = socket_path.is_null() ? s_overtaken_sockets.begin() : s_overtaken_sockets.find(socket_path);
+    VERIFY(it != s_overtaken_sockets.end());
+    auto path = it->key;
+    int listening_fd = it->value;
+
+    // SystemServer hands out its own (non-blocking) listening socket, but we've got nothing else to do than wait.
+    int flags = fcntl(listening_fd, F_GETFL);
+    if (flags < 0 || fcntl(listening_fd, F_SETFL, flags & ~O_NONBLOCK) < 0) {
+        perror("fcntl");
+        VERIFY_NOT_REACHED();
+    }
+
+    struct sigaction act;
+    memset(&act, 0, sizeof(act));
+    act.sa_flags = SA_NOCLDWAIT;
+    act.sa_handler = SIG_IGN;
+    if (sigaction(SIGCHLD, &act, nullptr) < 0) {
+        perror("sigaction");
+        VERIFY_NOT_REACHED();
+    }
+
+    for (;;) {
+        int accepted_fd = accept(listening_fd, nullptr, nullptr);
+        if (accepted_fd < 0) {
+            perror("accept");
+            continue;
+        }
+
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+        } else if (pid == 0) {
+            // We are the child, and only serve the connection we were forked for.
+            ::close(listening_fd);
+            act.sa_flags = 0;
+            act.sa_handler = SIG_DFL;
+            sigaction(SIGCHLD, &act, nullptr);
+            s_overtaken_sockets.set(path, accepted_fd);
+            return;
+        }
+        ::close(accepted_fd);
+    }
+}
+
 }
@@ -16,6 +16,13 @@ public:
     virtual ~LocalSocket() override;
 
     static RefPtr<LocalSocket> take_over_accepted_socket_from_system_server(String const& socket_path = String());
+
+    // Makes the calling process a fork server for the listening socket that SystemServer passed to it: the process
+    // keeps accepting connections forever, forking off a child for each of them. Only the children return from this,
+    // and they can then take over their connection with take_over_accepted_socket_from_system_server() as usual.
+    // Everything that was initialized before (dynamic linking, fonts, ...) is shared with all of the children.
+    // This needs the "accept", "proc" and "sigaction" promises.
+    static void fork_for_each_connection_from_system_server(String const& socket_path = String());
     pid_t peer_pid() const;
 
 private:
@@ -5,9 +5,7 @@
  */
 
 #include <AK/ByteBuffer.h>
-#include <AK/JsonArray.h>
-#include <AK/JsonObject.h>
-#include <AK/JsonValue.h>
+#include <AK/JsonPullParser.h>
 #include <LibCore/File.h>
 #include <LibCore/ProcessStatisticsReader.h>
 #include <pwd.h>
@@ -16,6 +14,163 @@ namespace Core {
 
 HashMap<uid_t, String> ProcessStatisticsReader::s_usernames;
 
+using TokenType = JsonPullParser::TokenType;
+
+// /proc/all is parsed a token at a time rather than into a JsonValue, as it's re-read every time the process list
+// is refreshed, and building a tree of objects just to copy their members out of it again is most of the work.
+
+// Calls the callback with every key of the object that has just started, along with the first token of its value.
+// If that's the start of an object or array, the callback has to consume the rest of it.
+template<typename Callback>
+static bool for_each_member(JsonPullParser& parser, Callback callback)
+{
+    for (;;) {
+        auto key = parser.next();
+        if (key.is(TokenType::ObjectEnd))
+            return true;
+        if (!key.is(TokenType::Key))
+            return false;
+        auto value = parser.next();
+        if (value.is_error() || !callback(key.raw_string(), value))
+            return false;
+    }
+}
+
+// Calls the callback with the first token of every element of the array that has just started.
+template<typename Callback>
+static bool for_each_element(JsonPullParser& parser, Callback callback)
+{
+    for (;;) {
+        auto element = parser.next();
+        if (element.is(TokenType::ArrayEnd))
+            return true;
+        if (element.is_error() || !callback(element))
+            return false;
+    }
+}
+
+template<typename T>
+static T to_number(JsonPullParser::Token const& token)
+{
+    return token.to_number<T>().value_or(0);
+}
+
+static String to_string(JsonPullParser::Token const& token)
+{
+    if (token.is(TokenType::String))
+        return token.to_string();
+    return token.literal();
+}
+
+static bool parse_thread(JsonPullParser& parser, Core::ThreadStatistics& thread)
+{
+    return for_each_member(parser, [&](auto const& key, auto const& value) {
+        if (key == "tid")
+            thread.tid = to_number<u32>(value);
+        else if (key == "times_scheduled")
+            thread.times_scheduled = to_number<u32>(value);
+        else if (key == "name")
+            thread.name = to_string(value);
+        else if (key == "state")
+            thread.state = to_string(value);
+        else if (key == "time_user")
+            thread.time_user = to_number<u64>(value);
+        else if (key == "time_kernel")
+            thread.time_kernel = to_number<u64>(value);
+        else if (key == "cpu")
+            thread.cpu = to_number<u32>(value);
+        else if (key == "priority")
+            thread.priority = to_number<u32>(value);
+        else if (key == "syscall_count")
+            thread.syscall_count = to_number<u32>(value);
+        else if (key == "inode_faults")
+            thread.inode_faults = to_number<u32>(value);
+        else if (key == "zero_faults")
+            thread.zero_faults = to_number<u32>(value);
+        else if (key == "cow_faults")
+            thread.cow_faults = to_number<u32>(value);
+        else if (key == "unix_socket_read_bytes")
+            thread.unix_socket_read_bytes = to_number<u32>(value);
+        else if (key == "unix_socket_write_bytes")
+            thread.unix_socket_write_bytes = to_number<u32>(value);
+        else if (key == "ipv4_socket_read_bytes")
+            thread.ipv4_socket_read_bytes = to_number<u32>(value);
+        else if (key == "ipv4_socket_write_bytes")
+            thread.ipv4_socket_write_bytes = to_number<u32>(value);
+        else if (key == "file_read_bytes")
+            thread.file_read_bytes = to_number<u32>(value);
+        else if (key == "file_write_bytes")
+            thread.file_write_bytes = to_number<u32>(value);
+        else
+            return parser.skip_value(value);
+        return true;
+    });
+}
+
+static bool parse_process(JsonPullParser& parser, Core::ProcessStatistics& process)
+{
+    return for_each_member(parser, [&](auto const& key, auto const& value) {
+        if (key == "threads") {
+            if (!value.is(TokenType::ArrayStart))
+                return false;
+            return for_each_element(parser, [&](auto const& element) {
+                if (!element.is(TokenType::ObjectStart))
+                    return false;
+                Core::ThreadStatistics thread {};
+                if (!parse_thread(parser, thread))
+                    return false;
+                process.threads.append(move(thread));
+                return true;
+            });
+        }
+        if (key == "pid")
+            process.pid = to_number<u32>(value);
+        else if (key == "pgid")
+            process.pgid = to_number<u32>(value);
+        else if (key == "pgp")
+            process.pgp = to_number<u32>(value);
+        else if (key == "sid")
+            process.sid = to_number<u32>(value);
+        else if (key == "uid")
+            process.uid = to_number<u32>(value);
+        else if (key == "gid")
+            process.gid = to_number<u32>(value);
+        else if (key == "ppid")
+            process.ppid = to_number<u32>(value);
+        else if (key == "nfds")
+            process.nfds = to_number<u32>(value);
+        else if (key == "kernel")
+            process.kernel = value.to_bool();
+        else if (key == "name")
+            process.name = to_string(value);
+        else if (key == "executable")
+            process.executable = to_string(value);
+        else if (key == "tty")
+            process.tty = to_string(value);
+        else if (key == "pledge")
+            process.pledge = to_string(value);
+        else if (key == "veil")
+            process.veil = to_string(value);
+        else if (key == "amount_virtual")
+            process.amount_virtual = to_number<u64>(value);
+        else if (key == "amount_resident")
+            process.amount_resident = to_number<u64>(value);
+        else if (key == "amount_shared")
+            process.amount_shared = to_number<u64>(value);
+        else if (key == "amount_dirty_private")
+            process.amount_dirty_private = to_number<u64>(value);
+        else if (key == "amount_clean_inode")
+            process.amount_clean_inode = to_number<u64>(value);
+        else if (key == "amount_purgeable_volatile")
+            process.amount_purgeable_volatile = to_number<u64>(value);
+        else if (key == "amount_purgeable_nonvolatile")
+            process.amount_purgeable_nonvolatile = to_number<u64>(value);
+        else
+            return parser.skip_value(value);
+        return true;
+    });
+}
+
 Optional<AllProcessesStatistics> ProcessStatisticsReader::get_all(RefPtr<Core::File>& proc_all_file)
 {
     if (proc_all_file) {
@@ -31,74 +186,38 @@ Optional<AllProcessesStatistics> ProcessStatisticsReader::get_all(RefPtr<Core::F
         }
     }
 
-    AllProcessesStatistics all_processes_statistics;
-
     auto file_contents = proc_all_file->read_all();
-    auto json = JsonValue::from_string(file_contents);
-    if (!json.has_value())
+    JsonPullParser parser(file_contents);
+    if (!parser.next().is(TokenType::ObjectStart))
         return {};
 
-    auto& json_obj = json.value().as_object();
-    json_obj.get("processes").as_array().for_each([&](auto& value) {
-        const JsonObject& process_object = value.as_object();
-        Core::ProcessStatistics process;
-
-        // kernel data first
-        process.pid = process_object.get("pid").to_u32();
-        process.pgid = process_object.get("pgid").to_u32();
-        process.pgp = process_object.get("pgp").to_u32();
-        process.sid = process_object.get("sid").to_u32();
-        process.uid = process_object.get("uid").to_u32();
-        process.gid = process_object.get("gid").to_u32();
-        process.ppid = process_object.get("ppid").to_u32();
-        process.nfds = process_object.get("nfds").to_u32();
-        process.kernel = process_object.get("kernel").to_bool();
-        process.name = process_object.get("name").to_string();
-        process.executable = process_object.get("executable").to_string();
-        process.tty = process_object.get("tty").to_string();
-        process.pledge = process_object.get("pledge").to_string();
-        process.veil = process_object.get("veil").to_string();
-        process.amount_virtual = process_object.get("amount_virtual").to_u32();
-        process.amount_resident = process_object.get("amount_resident").to_u32();
-        process.amount_shared = process_object.get("amount_shared").to_u32();
-        process.amount_dirty_private = process_object.get("amount_dirty_private").to_u32();
-        process.amount_clean_inode = process_object.get("amount_clean_inode").to_u32();
-        process.amount_purgeable_volatile = process_object.get("amount_purgeable_volatile").to_u32();
-        process.amount_purgeable_nonvolatile = process_object.get("amount_purgeable_nonvolatile").to_u32();
-
-        auto& thread_array = process_object.get_ptr("threads")->as_array();
-        process.threads.ensure_capacity(thread_array.size());
-        thread_array.for_each([&](auto& value) {
-            auto& thread_object = value.as_object();
-            Core::ThreadStatistics thread;
-            thread.tid = thread_object.get("tid").to_u32();
-            thread.times_scheduled = thread_object.get("times_scheduled").to_u32();
-            thread.name = thread_object.get("name").to_string();
-            thread.state = thread_object.get("state").to_string();
-            thread.time_user = thread_object.get("time_user").to_u64();
-            thread.time_kernel = thread_object.get("time_kernel").to_u64();
-            thread.cpu = thread_object.get("cpu").to_u32();
-            thread.priority = thread_object.get("priority").to_u32();
-            thread.syscall_count = thread_object.get("syscall_count").to_u32();
-            thread.inode_faults = thread_object.get("inode_faults").to_u32();
-            thread.zero_faults = thread_object.get("zero_faults").to_u32();
-            thread.cow_faults = thread_object.get("cow_faults").to_u32();
-            thread.unix_socket_read_bytes = thread_object.get("unix_socket_read_bytes").to_u32();
-            thread.unix_socket_write_bytes = thread_object.get("unix_socket_write_bytes").to_u32();
-            thread.ipv4_socket_read_bytes = thread_object.get("ipv4_socket_read_bytes").to_u32();
-            thread.ipv4_socket_write_bytes = thread_object.get("ipv4_socket_write_bytes").to_u32();
-            thread.file_read_bytes = thread_object.get("file_read_bytes").to_u32();
-            thread.file_write_bytes = thread_object.get("file_write_bytes").to_u32();
-            process.threads.append(move(thread));
-        });
-
-        // and synthetic data last
-        process.username = username_from_uid(process.uid);
-        all_processes_statistics.processes.append(move(process));
+    AllProcessesStatistics all_processes_statistics {};
+    auto parsed = for_each_member(parser, [&](auto const& key, auto const& value) {
+        if (key == "processes") {
+            if (!value.is(TokenType::ArrayStart))
+                return false;
+            return for_each_element(parser, [&](auto const& element) {
+                if (!element.is(TokenType::ObjectStart))
+                    return false;
+                Core::ProcessStatistics process {};
+                if (!parse_process(parser, process))
+                    return false;
+                // synthetic data last
+                process.username = username_from_uid(process.uid);
+                all_processes_statistics.processes.append(move(process));
+                return true;
+            });
+        }
+        if (key == "total_time")
+            all_processes_statistics.total_time_scheduled = to_number<u64>(value);
+        else if (key == "total_time_kernel")
+            all_processes_statistics.total_time_scheduled_kernel = to_number<u64>(value);
+        else
+            return parser.skip_value(value);
+        return true;
     });
-
-    all_processes_statistics.total_time_scheduled = json_obj.get("total_time").to_u64();
-    all_processes_statistics.total_time_scheduled_kernel = json_obj.get("total_time_kernel").to_u64();
+    if (!parsed || !parser.next().is(TokenType::End))
+        return {};
     return all_processes_statistics;
 }
 
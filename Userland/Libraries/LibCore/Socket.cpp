@@ -173,6 +173,13 @@ bool Socket::send(ReadonlyBytes data)
     return true;
 }
 
+void Socket::set_reading_paused(bool paused)
+{
+    m_is_reading_paused = paused;
+    if (m_read_notifier)
+        m_read_notifier->set_enabled(!paused);
+}
+
 void Socket::did_update_fd(int fd)
 {
     if (fd < 0) {
@@ -204,6 +211,8 @@ void Socket::ensure_read_notifier()
         if (on_ready_to_read)
             on_ready_to_read();
     };
+    if (m_is_reading_paused)
+        m_read_notifier->set_enabled(false);
 }
 
 }
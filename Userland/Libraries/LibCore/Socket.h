@@ -42,6 +42,11 @@ public:
     SocketAddress destination_address() const { return m_destination_address; }
     int destination_port() const { return m_destination_port; }
 
+    // While reading is paused, on_ready_to_read isn't called even if there is something to read, so whoever reads
+    // from the socket can stop taking data in faster than it can get rid of it.
+    virtual void set_reading_paused(bool);
+    bool is_reading_paused() const { return m_is_reading_paused; }
+
     Function<void()> on_connected;
     Function<void()> on_ready_to_read;
 
@@ -53,6 +58,7 @@ protected:
     int m_source_port { -1 };
     int m_destination_port { -1 };
     bool m_connected { false };
+    bool m_is_reading_paused { false };
 
     virtual void did_update_fd(int) override;
     virtual bool common_connect(const struct sockaddr*, socklen_t);
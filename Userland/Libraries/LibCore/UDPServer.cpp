@@ -11,6 +11,7 @@
 #include <LibCore/UDPSocket.h>
 #include <errno.h>
 #include <stdio.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #ifndef SOCK_NONBLOCK
@@ -76,6 +77,91 @@ ByteBuffer UDPServer::receive(size_t size, sockaddr_in& in)
     return buf;
 }
 
+// Not every host we build on has recvmmsg() and sendmmsg(), so there's a fallback that goes one by one.
+#if defined(__serenity__) || defined(__linux__)
+#    define HAVE_MMSG
+#endif
+
+Vector<UDPServer::Datagram> UDPServer::receive_batch(size_t datagram_size, size_t max_count)
+{
+    Vector<Datagram> datagrams;
+    datagrams.resize(max_count);
+    for (auto& datagram : datagrams)
+        datagram.data = ByteBuffer::create_uninitialized(datagram_size);
+
+#ifdef HAVE_MMSG
+    Vector<iovec> iovs;
+    Vector<mmsghdr> messages;
+    iovs.resize(max_count);
+    messages.resize(max_count);
+    for (size_t i = 0; i < max_count; ++i) {
+        iovs[i] = { datagrams[i].data.data(), datagram_size };
+        messages[i] = {};
+        messages[i].msg_hdr.msg_name = &datagrams[i].address;
+        messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        messages[i].msg_hdr.msg_iov = &iovs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+    int count = ::recvmmsg(m_fd, messages.data(), max_count, 0, nullptr);
+    if (count < 0) {
+        if (errno != EAGAIN)
+            dbgln("recvmmsg: {}", strerror(errno));
+        return {};
+    }
+    for (int i = 0; i < count; ++i)
+        datagrams[i].data.resize(min(static_cast<size_t>(messages[i].msg_len), datagram_size));
+#else
+    size_t count = 0;
+    for (; count < max_count; ++count) {
+        socklen_t address_length = sizeof(sockaddr_in);
+        ssize_t rlen = ::recvfrom(m_fd, datagrams[count].data.data(), datagram_size, 0, (sockaddr*)&datagrams[count].address, &address_length);
+        if (rlen < 0) {
+            if (errno != EAGAIN)
+                dbgln("recvfrom: {}", strerror(errno));
+            break;
+        }
+        datagrams[count].data.resize(rlen);
+    }
+#endif
+    datagrams.shrink(count);
+    return datagrams;
+}
+
+int UDPServer::send_batch(const Vector<Datagram>& datagrams)
+{
+    if (datagrams.is_empty())
+        return 0;
+
+#ifdef HAVE_MMSG
+    Vector<iovec> iovs;
+    Vector<mmsghdr> messages;
+    iovs.resize(datagrams.size());
+    messages.resize(datagrams.size());
+    for (size_t i = 0; i < datagrams.size(); ++i) {
+        iovs[i] = { const_cast<u8*>(datagrams[i].data.data()), datagrams[i].data.size() };
+        messages[i] = {};
+        messages[i].msg_hdr.msg_name = const_cast<sockaddr_in*>(&datagrams[i].address);
+        messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        messages[i].msg_hdr.msg_iov = &iovs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+    int count = ::sendmmsg(m_fd, messages.data(), messages.size(), 0);
+    if (count < 0)
+        dbgln("sendmmsg: {}", strerror(errno));
+    return count;
+#else
+    int count = 0;
+    for (auto& datagram : datagrams) {
+        if (::sendto(m_fd, datagram.data.data(), datagram.data.size(), 0, (const sockaddr*)&datagram.address, sizeof(datagram.address)) < 0) {
+            dbgln("sendto: {}", strerror(errno));
+            break;
+        }
+        ++count;
+    }
+    return count > 0 ? count : -1;
+#endif
+}
+
 Optional<IPv4Address> UDPServer::local_address() const
 {
     if (m_fd == -1)
@@ -9,6 +9,7 @@
 #include <AK/ByteBuffer.h>
 #include <AK/Forward.h>
 #include <AK/Function.h>
+#include <AK/Vector.h>
 #include <LibCore/Forward.h>
 #include <LibCore/Object.h>
 #include <LibCore/SocketAddress.h>
@@ -30,6 +31,15 @@ public:
         return receive(size, saddr);
     };
 
+    struct Datagram {
+        ByteBuffer data;
+        sockaddr_in address;
+    };
+    // Takes up to max_count datagrams that are queued up already, using as few syscalls as possible.
+    Vector<Datagram> receive_batch(size_t datagram_size, size_t max_count);
+    // Sends each datagram to its address and returns how many were sent, or -1 if none were.
+    int send_batch(const Vector<Datagram>&);
+
     Optional<IPv4Address> local_address() const;
     Optional<u16> local_port() const;
 
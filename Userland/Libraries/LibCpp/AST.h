@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Arena.h>
 #include <AK/FlyString.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/Optional.h>
@@ -27,6 +28,8 @@ class Statement;
 class Name;
 
 class ASTNode : public RefCounted<ASTNode> {
+    AK_MAKE_ARENA_ALLOCATED
+
 public:
     virtual ~ASTNode() = default;
     virtual const char* class_name() const = 0;
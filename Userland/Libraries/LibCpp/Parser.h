@@ -155,7 +155,7 @@ private:
     NonnullRefPtr<T>
     create_ast_node(ASTNode& parent, const Position& start, Optional<Position> end, Args&&... args)
     {
-        auto node = adopt_ref(*new T(&parent, start, end, m_filename, forward<Args>(args)...));
+        auto node = adopt_ref(*new (m_arena) T(&parent, start, end, m_filename, forward<Args>(args)...));
 
         if (m_saved_states.is_empty()) {
             m_nodes.append(node);
@@ -169,7 +169,7 @@ private:
     NonnullRefPtr<TranslationUnit>
     create_root_ast_node(const Position& start, Position end)
     {
-        auto node = adopt_ref(*new TranslationUnit(nullptr, start, end, m_filename));
+        auto node = adopt_ref(*new (m_arena) TranslationUnit(nullptr, start, end, m_filename));
         m_nodes.append(node);
         m_root_node = node;
         return node;
@@ -199,6 +199,8 @@ private:
     Preprocessor::Definitions m_preprocessor_definitions;
     String m_filename;
     Vector<Token> m_tokens;
+    // All nodes are allocated from here. Nodes that are still referenced keep their memory alive after we're gone.
+    Arena m_arena;
     State m_state;
     Vector<State> m_saved_states;
     RefPtr<TranslationUnit> m_root_node;
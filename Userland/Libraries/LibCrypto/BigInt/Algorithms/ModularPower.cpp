@@ -70,53 +70,16 @@ ALWAYS_INLINE static u32 inverse_wrapped(u32 value)
     return static_cast<u32>(-k0);
 }
 
-/**
- * Computes z = x * y + c. z_carry contains the top bits, z contains the bottom bits.
- */
-ALWAYS_INLINE static void linear_multiplication_with_carry(u32 x, u32 y, u32 c, u32& z_carry, u32& z)
-{
-    u64 result = static_cast<u64>(x) * static_cast<u64>(y) + static_cast<u64>(c);
-    z_carry = static_cast<u32>(result >> 32);
-    z = static_cast<u32>(result);
-}
-
-/**
- * Computes z = a + b. z_carry contains the top bit (1 or 0), z contains the bottom bits.
- */
-ALWAYS_INLINE static void addition_with_carry(u32 a, u32 b, u32& z_carry, u32& z)
-{
-    u64 result = static_cast<u64>(a) + static_cast<u64>(b);
-    z_carry = static_cast<u32>(result >> 32);
-    z = static_cast<u32>(result);
-}
-
-/**
- * Computes a montgomery "fragment" for y_i. This computes "z[i] += x[i] * y_i" for all words while rippling the carry, and returns the carry.
- * Algorithm from: Gueron, "Efficient Software Implementations of Modular Exponentiation". (https://eprint.iacr.org/2011/239.pdf)
- */
-UnsignedBigInteger::Word UnsignedBigIntegerAlgorithms::montgomery_fragment(UnsignedBigInteger& z, size_t offset_in_z, UnsignedBigInteger const& x, UnsignedBigInteger::Word y_digit, size_t num_words)
-{
-    UnsignedBigInteger::Word carry { 0 };
-    for (size_t i = 0; i < num_words; ++i) {
-        UnsignedBigInteger::Word a_carry;
-        UnsignedBigInteger::Word a;
-        linear_multiplication_with_carry(x.m_words[i], y_digit, z.m_words[offset_in_z + i], a_carry, a);
-        UnsignedBigInteger::Word b_carry;
-        UnsignedBigInteger::Word b;
-        addition_with_carry(a, carry, b_carry, b);
-        z.m_words[offset_in_z + i] = b;
-        carry = a_carry + b_carry;
-    }
-    return carry;
-}
-
 /**
  * Computes the "almost montgomery" product : x * y * 2 ^ (-num_words * BITS_IN_WORD) % modulo
  * [Note : that means that the result z satisfies z * 2^(num_words * BITS_IN_WORD) % modulo = x * y % modulo]
  * assuming :
  *  - x, y and modulo are all already padded to num_words
  *  - k = inverse_wrapped(modulo) (optimization to not recompute K each time)
- * Algorithm from: Gueron, "Efficient Software Implementations of Modular Exponentiation". (https://eprint.iacr.org/2011/239.pdf)
+ * z is scratch space for the 2 * num_words + 1 words of the running sum, which is kept between calls to avoid allocating.
+ * Each step adds x * y_i and the multiple of the modulo that clears the lowest word in the same pass, which is
+ * the "coarsely integrated operand scanning" method from Koç, Acar and Kaliski, "Analyzing and Comparing
+ * Montgomery Multiplication Algorithms".
  */
 void UnsignedBigIntegerAlgorithms::almost_montgomery_multiplication_without_allocation(
     UnsignedBigInteger const& x,
@@ -131,51 +94,57 @@ void UnsignedBigIntegerAlgorithms::almost_montgomery_multiplication_without_allo
     VERIFY(y.length() >= num_words);
     VERIFY(modulo.length() >= num_words);
 
-    z.set_to(0);
-    z.resize_with_leading_zeros(num_words * 2);
+    z.set_to_0();
+    z.m_words.resize_and_keep_capacity(num_words + 2);
+    auto* t = z.m_words.data();
+    __builtin_memset(t, 0, (num_words + 2) * sizeof(UnsignedBigInteger::Word));
+
+    auto const* x_words = x.m_words.data();
+    auto const* y_words = y.m_words.data();
+    auto const* modulo_words = modulo.m_words.data();
 
-    UnsignedBigInteger::Word previous_double_carry { 0 };
     for (size_t i = 0; i < num_words; ++i) {
-        // z[i->num_words+i] += x * y_i
-        UnsignedBigInteger::Word carry_1 = montgomery_fragment(z, i, x, y.m_words[i], num_words);
-        // z[i->num_words+i] += modulo * (z_i * k)
-        UnsignedBigInteger::Word t = z.m_words[i] * k;
-        UnsignedBigInteger::Word carry_2 = montgomery_fragment(z, i, modulo, t, num_words);
-
-        // Compute the carry by combining all of the carrys of the previous computations
-        // Put it "right after" the range that we computed above
-        UnsignedBigInteger::Word temp_carry = previous_double_carry + carry_1;
-        UnsignedBigInteger::Word overall_carry = temp_carry + carry_2;
-        z.m_words[num_words + i] = overall_carry;
-
-        // Detect if there was a "double carry" for this word by checking if our carry results are smaller than their components
-        previous_double_carry = (temp_carry < carry_1 || overall_carry < carry_2) ? 1 : 0;
+        // t += x * y_i
+        u64 carry = 0;
+        for (size_t j = 0; j < num_words; ++j) {
+            carry += static_cast<u64>(x_words[j]) * y_words[i] + t[j];
+            t[j] = static_cast<UnsignedBigInteger::Word>(carry);
+            carry >>= UnsignedBigInteger::BITS_IN_WORD;
+        }
+        carry += t[num_words];
+        t[num_words] = static_cast<UnsignedBigInteger::Word>(carry);
+        t[num_words + 1] = static_cast<UnsignedBigInteger::Word>(carry >> UnsignedBigInteger::BITS_IN_WORD);
+
+        // t = (t + modulo * (t_0 * k)) / 2^BITS_IN_WORD, where the division is exact as the lowest word becomes zero
+        UnsignedBigInteger::Word m = t[0] * k;
+        carry = (static_cast<u64>(modulo_words[0]) * m + t[0]) >> UnsignedBigInteger::BITS_IN_WORD;
+        for (size_t j = 1; j < num_words; ++j) {
+            carry += static_cast<u64>(modulo_words[j]) * m + t[j];
+            t[j - 1] = static_cast<UnsignedBigInteger::Word>(carry);
+            carry >>= UnsignedBigInteger::BITS_IN_WORD;
+        }
+        carry += t[num_words];
+        t[num_words - 1] = static_cast<UnsignedBigInteger::Word>(carry);
+        t[num_words] = t[num_words + 1] + static_cast<UnsignedBigInteger::Word>(carry >> UnsignedBigInteger::BITS_IN_WORD);
     }
 
-    if (previous_double_carry == 0) {
-        // Return the top num_words bytes of Z, which contains our result.
-        shift_right_by_n_words(z, num_words, result);
-        result.resize_with_leading_zeros(num_words);
+    result.set_to_0();
+    result.m_words.resize_and_keep_capacity(num_words);
+    auto* result_words = result.m_words.data();
+
+    if (t[num_words] == 0) {
+        __builtin_memcpy(result_words, t, num_words * sizeof(UnsignedBigInteger::Word));
         return;
     }
 
     // We have a carry, so we're "one bigger" than we need to be.
-    // Subtract the modulo from the result (the top half of z), and write it to the bottom half of Z since we have space.
-    // (With carry, of course.)
-    UnsignedBigInteger::Word c { 0 };
+    // Subtract the modulo from the result, which brings it back under 2^(num_words * BITS_IN_WORD).
+    u64 borrow = 0;
     for (size_t i = 0; i < num_words; ++i) {
-        UnsignedBigInteger::Word z_digit = z.m_words[num_words + i];
-        UnsignedBigInteger::Word modulo_digit = modulo.m_words[i];
-        UnsignedBigInteger::Word new_z_digit = z_digit - modulo_digit - c;
-        z.m_words[i] = new_z_digit;
-        // Detect if the subtraction underflowed - from "Hacker's Delight"
-        c = ((modulo_digit & ~z_digit) | ((modulo_digit | ~z_digit) & new_z_digit)) >> (UnsignedBigInteger::BITS_IN_WORD - 1);
+        u64 difference = static_cast<u64>(t[i]) - modulo_words[i] - borrow;
+        result_words[i] = static_cast<UnsignedBigInteger::Word>(difference);
+        borrow = difference >> 63;
     }
-
-    // Return the bottom num_words bytes of Z (with the carry bit handled)
-    z.m_words.resize(num_words);
-    result.set_to(z);
-    result.resize_with_leading_zeros(num_words);
 }
 
 /**
@@ -9,38 +9,160 @@
 
 namespace Crypto {
 
+using Word = UnsignedBigInteger::Word;
+
+// Below this many words (in the shorter operand), the schoolbook method beats splitting the operands up.
+static constexpr size_t karatsuba_threshold = 32;
+
+/**
+ * Computes output[0, left_length + right_length) = left * right, one row of word products at a time.
+ * Complexity: O(N*M)
+ */
+static void schoolbook_multiply(Word const* left, size_t left_length, Word const* right, size_t right_length, Word* output)
+{
+    __builtin_memset(output, 0, (left_length + right_length) * sizeof(Word));
+    for (size_t i = 0; i < left_length; ++i) {
+        u64 carry = 0;
+        for (size_t j = 0; j < right_length; ++j) {
+            carry += static_cast<u64>(left[i]) * right[j] + output[i + j];
+            output[i + j] = static_cast<Word>(carry);
+            carry >>= UnsignedBigInteger::BITS_IN_WORD;
+        }
+        output[i + right_length] = static_cast<Word>(carry);
+    }
+}
+
+// Computes output[0, left_length + 1) = left + right, with left_length >= right_length.
+static void add_words(Word const* left, size_t left_length, Word const* right, size_t right_length, Word* output)
+{
+    u64 carry = 0;
+    for (size_t i = 0; i < left_length; ++i) {
+        carry += static_cast<u64>(left[i]) + (i < right_length ? right[i] : 0);
+        output[i] = static_cast<Word>(carry);
+        carry >>= UnsignedBigInteger::BITS_IN_WORD;
+    }
+    output[left_length] = static_cast<Word>(carry);
+}
+
+// Computes accumulator[0, accumulator_length) += value, dropping the final carry.
+static void add_into_words(Word* accumulator, size_t accumulator_length, Word const* value, size_t value_length)
+{
+    u64 carry = 0;
+    for (size_t i = 0; i < accumulator_length && (i < value_length || carry); ++i) {
+        carry += static_cast<u64>(accumulator[i]) + (i < value_length ? value[i] : 0);
+        accumulator[i] = static_cast<Word>(carry);
+        carry >>= UnsignedBigInteger::BITS_IN_WORD;
+    }
+}
+
+// Computes accumulator[0, accumulator_length) -= value, which must not underflow.
+static void subtract_from_words(Word* accumulator, size_t accumulator_length, Word const* value, size_t value_length)
+{
+    u64 borrow = 0;
+    for (size_t i = 0; i < accumulator_length && (i < value_length || borrow); ++i) {
+        u64 difference = static_cast<u64>(accumulator[i]) - (i < value_length ? value[i] : 0) - borrow;
+        accumulator[i] = static_cast<Word>(difference);
+        borrow = difference >> 63;
+    }
+}
+
+// An upper bound on the scratch words that karatsuba_multiply() needs for an operand of the given length.
+static size_t karatsuba_scratch_length(size_t length)
+{
+    size_t scratch_length = 0;
+    while (length >= karatsuba_threshold) {
+        auto half_length = (length + 1) / 2 + 1;
+        scratch_length += 4 * half_length;
+        length = half_length;
+    }
+    return scratch_length + 2 * length;
+}
+
 /**
- * Complexity: O(N^2) where N is the number of words in the larger number
- * Multiplication method:
- * An integer is equal to the sum of the powers of two
- * according to the indices of its 'on' bits.
- * So to multiple x*y, we go over each '1' bit in x (say the i'th bit),
- * and add y<<i to the result.
+ * Computes output[0, left_length + right_length) = left * right by splitting both operands at `half` words:
+ *   left * right = high * 2^(2 * half) + (middle - high - low) * 2^half + low
+ * where low = left_low * right_low, high = left_high * right_high and middle = (left_low + left_high) * (right_low + right_high).
+ * Complexity: O(N^1.58)
+ */
+static void karatsuba_multiply(Word const* left, size_t left_length, Word const* right, size_t right_length, Word* output, Word* scratch)
+{
+    if (left_length < right_length) {
+        swap(left, right);
+        swap(left_length, right_length);
+    }
+
+    if (right_length < karatsuba_threshold) {
+        schoolbook_multiply(left, left_length, right, right_length, output);
+        return;
+    }
+
+    if (right_length <= left_length / 2) {
+        // The right operand is too short to split at the same point, so multiply it by slices of the left one instead.
+        __builtin_memset(output, 0, (left_length + right_length) * sizeof(Word));
+        auto* product = scratch;
+        for (size_t offset = 0; offset < left_length; offset += right_length) {
+            auto slice_length = min(right_length, left_length - offset);
+            karatsuba_multiply(left + offset, slice_length, right, right_length, product, scratch + 2 * right_length);
+            add_into_words(output + offset, left_length + right_length - offset, product, slice_length + right_length);
+        }
+        return;
+    }
+
+    auto half = left_length / 2;
+    auto left_high_length = left_length - half;
+    auto right_high_length = right_length - half;
+
+    // The low and high products go straight into their places in the output, and don't overlap.
+    karatsuba_multiply(left, half, right, half, output, scratch);
+    karatsuba_multiply(left + half, left_high_length, right + half, right_high_length, output + 2 * half, scratch);
+
+    auto left_sum_length = left_high_length + 1;
+    auto right_sum_length = max(half, right_high_length) + 1;
+    auto* left_sum = scratch;
+    auto* right_sum = left_sum + left_sum_length;
+    auto* middle = right_sum + right_sum_length;
+    add_words(left + half, left_high_length, left, half, left_sum);
+    if (right_high_length >= half)
+        add_words(right + half, right_high_length, right, half, right_sum);
+    else
+        add_words(right, half, right + half, right_high_length, right_sum);
+
+    auto middle_length = left_sum_length + right_sum_length;
+    karatsuba_multiply(left_sum, left_sum_length, right_sum, right_sum_length, middle, middle + middle_length);
+    subtract_from_words(middle, middle_length, output, 2 * half);
+    subtract_from_words(middle, middle_length, output + 2 * half, left_high_length + right_high_length);
+    add_into_words(output + half, left_length + right_length - half, middle, middle_length);
+}
+
+/**
+ * Complexity: O(N*M) for short operands, O(N^1.58) with Karatsuba once both have at least karatsuba_threshold words.
+ * temp_shift_result holds the scratch words for Karatsuba, so that repeated multiplications with the same temporaries
+ * don't allocate.
  */
 FLATTEN void UnsignedBigIntegerAlgorithms::multiply_without_allocation(
     UnsignedBigInteger const& left,
     UnsignedBigInteger const& right,
     UnsignedBigInteger& temp_shift_result,
-    UnsignedBigInteger& temp_shift_plus,
-    UnsignedBigInteger& temp_shift,
+    UnsignedBigInteger&,
+    UnsignedBigInteger&,
     UnsignedBigInteger& output)
 {
     output.set_to_0();
 
-    // iterate all bits
-    for (size_t word_index = 0; word_index < left.length(); ++word_index) {
-        for (size_t bit_index = 0; bit_index < UnsignedBigInteger::BITS_IN_WORD; ++bit_index) {
-            // If the bit is off - skip over it
-            if (!(left.m_words[word_index] & (1 << bit_index)))
-                continue;
+    auto left_length = left.trimmed_length();
+    auto right_length = right.trimmed_length();
+    if (left_length == 0 || right_length == 0)
+        return;
 
-            size_t shift_amount = word_index * UnsignedBigInteger::BITS_IN_WORD + bit_index;
-
-            // output += (right << shift_amount);
-            shift_left_without_allocation(right, shift_amount, temp_shift_result, temp_shift_plus, temp_shift);
-            add_into_accumulator_without_allocation(output, temp_shift);
-        }
+    output.m_words.resize_and_keep_capacity(left_length + right_length);
+    if (min(left_length, right_length) < karatsuba_threshold) {
+        schoolbook_multiply(left.m_words.data(), left_length, right.m_words.data(), right_length, output.m_words.data());
+    } else {
+        temp_shift_result.set_to_0();
+        temp_shift_result.m_words.resize_and_keep_capacity(karatsuba_scratch_length(max(left_length, right_length)));
+        karatsuba_multiply(left.m_words.data(), left_length, right.m_words.data(), right_length, output.m_words.data(), temp_shift_result.m_words.data());
     }
+    output.clamp_to_trimmed_length();
 }
 
 }
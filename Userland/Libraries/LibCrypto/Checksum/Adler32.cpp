@@ -10,12 +10,48 @@
 
 namespace Crypto::Checksum {
 
+static constexpr u32 adler_modulus = 65521;
+
+// The largest number of bytes that can be summed up before m_state_b could overflow a u32, so the expensive
+// modulo only has to be taken once per run instead of twice per byte.
+static constexpr size_t max_bytes_per_reduction = 5552;
+
 void Adler32::update(ReadonlyBytes data)
 {
-    for (size_t i = 0; i < data.size(); i++) {
-        m_state_a = (m_state_a + data.at(i)) % 65521;
-        m_state_b = (m_state_b + m_state_a) % 65521;
+    auto* bytes = data.data();
+    size_t remaining = data.size();
+    u32 a = m_state_a;
+    u32 b = m_state_b;
+    while (remaining > 0) {
+        size_t run = min(remaining, max_bytes_per_reduction);
+        remaining -= run;
+        for (; run >= 8; run -= 8, bytes += 8) {
+            a += bytes[0];
+            b += a;
+            a += bytes[1];
+            b += a;
+            a += bytes[2];
+            b += a;
+            a += bytes[3];
+            b += a;
+            a += bytes[4];
+            b += a;
+            a += bytes[5];
+            b += a;
+            a += bytes[6];
+            b += a;
+            a += bytes[7];
+            b += a;
+        }
+        for (; run > 0; --run, ++bytes) {
+            a += *bytes;
+            b += a;
+        }
+        a %= adler_modulus;
+        b %= adler_modulus;
     }
+    m_state_a = a;
+    m_state_b = b;
 };
 
 u32 Adler32::digest()
@@ -4,17 +4,149 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Platform.h>
 #include <AK/Span.h>
 #include <AK/Types.h>
 #include <LibCrypto/Checksum/CRC32.h>
 
+#if ARCH(I386) || ARCH(X86_64)
+#    define CRC32_HAVE_PCLMUL
+#    include <cpuid.h>
+#endif
+
 namespace Crypto::Checksum {
 
+// slicing_tables[k][i] is the CRC of byte i followed by k zero bytes, which lets us process eight bytes at a time.
+struct SlicingTables {
+    u32 data[8][256];
+
+    constexpr SlicingTables()
+        : data()
+    {
+        for (auto i = 0; i < 256; i++)
+            data[0][i] = table[i];
+        for (auto k = 1; k < 8; k++) {
+            for (auto i = 0; i < 256; i++)
+                data[k][i] = (data[k - 1][i] >> 8) ^ table[data[k - 1][i] & 0xFF];
+        }
+    }
+};
+
+constexpr static auto slicing_tables = SlicingTables();
+
+static ALWAYS_INLINE u32 load_le32(const u8* data)
+{
+    return data[0] | (data[1] << 8) | (data[2] << 16) | ((u32)data[3] << 24);
+}
+
+static u32 update_sliced(u32 state, const u8* data, size_t size)
+{
+    auto& t = slicing_tables.data;
+    for (; size >= 8; data += 8, size -= 8) {
+        u32 low = load_le32(data) ^ state;
+        u32 high = load_le32(data + 4);
+        state = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24]
+            ^ t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+    }
+    for (; size; ++data, --size)
+        state = table[(state ^ *data) & 0xFF] ^ (state >> 8);
+    return state;
+}
+
+#ifdef CRC32_HAVE_PCLMUL
+
+static bool has_pclmul()
+{
+    static int s_has_pclmul = -1;
+    if (s_has_pclmul < 0) {
+        unsigned eax, ebx, ecx, edx;
+        s_has_pclmul = __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_PCLMUL) && (edx & bit_SSE2);
+    }
+    return s_has_pclmul;
+}
+
+// The PCLMUL path wants at least four blocks to fold in parallel.
+static constexpr size_t pclmul_block_size = 16;
+static constexpr size_t pclmul_minimum_size = 4 * pclmul_block_size;
+
+// This is the vector type that the PCLMUL builtins take.
+using Block = long long __attribute__((vector_size(16)));
+
+[[gnu::target("pclmul,sse2")]] static ALWAYS_INLINE Block load_block(const u8* data)
+{
+    Block block;
+    __builtin_memcpy(&block, data, sizeof(block));
+    return block;
+}
+
+template<int selector>
+[[gnu::target("pclmul,sse2")]] static ALWAYS_INLINE Block clmul(Block a, Block b)
+{
+    return __builtin_ia32_pclmulqdq128(a, b, selector);
+}
+
+// Multiplies both halves of the value by the constants in k and adds (xors) them up with the next block, which
+// "moves" the value that many bits further along the message without changing its remainder.
+[[gnu::target("pclmul,sse2")]] static ALWAYS_INLINE Block fold(Block value, Block k, Block next)
+{
+    return clmul<0x00>(value, k) ^ clmul<0x11>(value, k) ^ next;
+}
+
+// This is the folding algorithm from Intel's "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ
+// Instruction", with the constants for the bit-reflected CRC-32 polynomial.
+// Note that the SSE4.2 crc32 instruction can't be used instead, as it computes the CRC-32C (Castagnoli) checksum.
+[[gnu::target("pclmul,sse2")]] static u32 update_pclmul(u32 state, const u8* data, size_t size)
+{
+    constexpr Block k1k2 = { 0x154442bd4, 0x1c6e41596 };
+    constexpr Block k3k4 = { 0x1751997d0, 0x0ccaa009e };
+    constexpr Block k5k0 = { 0x163cd6124, 0 };
+    constexpr Block poly = { 0x1db710641, 0x1f7011641 };
+    constexpr Block mask32 = { 0xffffffff, 0xffffffff };
+
+    auto x1 = load_block(data) ^ Block { state, 0 };
+    auto x2 = load_block(data + 0x10);
+    auto x3 = load_block(data + 0x20);
+    auto x4 = load_block(data + 0x30);
+    data += pclmul_minimum_size;
+    size -= pclmul_minimum_size;
+
+    for (; size >= pclmul_minimum_size; data += pclmul_minimum_size, size -= pclmul_minimum_size) {
+        x1 = fold(x1, k1k2, load_block(data));
+        x2 = fold(x2, k1k2, load_block(data + 0x10));
+        x3 = fold(x3, k1k2, load_block(data + 0x20));
+        x4 = fold(x4, k1k2, load_block(data + 0x30));
+    }
+
+    x1 = fold(x1, k3k4, x2);
+    x1 = fold(x1, k3k4, x3);
+    x1 = fold(x1, k3k4, x4);
+    for (; size >= pclmul_block_size; data += pclmul_block_size, size -= pclmul_block_size)
+        x1 = fold(x1, k3k4, load_block(data));
+
+    // Fold the remaining 128 bits down to 64...
+    x1 = clmul<0x10>(x1, k3k4) ^ Block { x1[1], 0 };
+    x1 = clmul<0x00>(x1 & mask32, k5k0) ^ __builtin_ia32_psrldqi128(x1, 32);
+
+    // ...and do a Barrett reduction to get to the remainder.
+    auto reduction = clmul<0x10>(x1 & mask32, poly);
+    reduction = clmul<0x00>(reduction & mask32, poly);
+    x1 ^= reduction;
+
+    state = x1[0] >> 32;
+    return update_sliced(state, data, size);
+}
+
+#endif
+
 void CRC32::update(ReadonlyBytes data)
 {
-    for (size_t i = 0; i < data.size(); i++) {
-        m_state = table[(m_state ^ data.at(i)) & 0xFF] ^ (m_state >> 8);
+#ifdef CRC32_HAVE_PCLMUL
+    if (data.size() >= pclmul_minimum_size && has_pclmul()) {
+        m_state = update_pclmul(m_state, data.data(), data.size());
+        return;
     }
+#endif
+    m_state = update_sliced(m_state, data.data(), data.size());
 };
 
 u32 CRC32::digest()
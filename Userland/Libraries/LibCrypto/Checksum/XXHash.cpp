@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Endian.h>
+#include <AK/Span.h>
+#include <AK/Types.h>
+#include <LibCrypto/Checksum/XXHash.h>
+
+namespace Crypto::Checksum {
+
+static constexpr u32 prime32_1 = 0x9E3779B1U;
+static constexpr u32 prime32_2 = 0x85EBCA77U;
+static constexpr u32 prime32_3 = 0xC2B2AE3DU;
+static constexpr u32 prime32_4 = 0x27D4EB2FU;
+static constexpr u32 prime32_5 = 0x165667B1U;
+
+static constexpr u64 prime64_1 = 0x9E3779B185EBCA87ULL;
+static constexpr u64 prime64_2 = 0xC2B2AE3D27D4EB4FULL;
+static constexpr u64 prime64_3 = 0x165667B19E3779F9ULL;
+static constexpr u64 prime64_4 = 0x85EBCA77C2B2AE63ULL;
+static constexpr u64 prime64_5 = 0x27D4EB2F165667C5ULL;
+
+template<typename T>
+static ALWAYS_INLINE T rotate_left(T value, int bits)
+{
+    return (value << bits) | (value >> (sizeof(T) * 8 - bits));
+}
+
+template<typename T>
+static ALWAYS_INLINE T read_le(u8 const* bytes)
+{
+    T value;
+    __builtin_memcpy(&value, bytes, sizeof(T));
+    return AK::convert_between_host_and_little_endian(value);
+}
+
+static ALWAYS_INLINE u32 round32(u32 accumulator, u32 lane)
+{
+    accumulator += lane * prime32_2;
+    return rotate_left(accumulator, 13) * prime32_1;
+}
+
+static ALWAYS_INLINE u64 round64(u64 accumulator, u64 lane)
+{
+    accumulator += lane * prime64_2;
+    return rotate_left(accumulator, 31) * prime64_1;
+}
+
+static ALWAYS_INLINE u64 merge64(u64 accumulator, u64 lane_accumulator)
+{
+    accumulator ^= round64(0, lane_accumulator);
+    return accumulator * prime64_1 + prime64_4;
+}
+
+XXHash32::XXHash32(u32 seed)
+    : m_seed(seed)
+    , m_accumulators { seed + prime32_1 + prime32_2, seed + prime32_2, seed, seed - prime32_1 }
+{
+}
+
+void XXHash32::update(ReadonlyBytes data)
+{
+    m_total_size += data.size();
+    auto* bytes = data.data();
+    auto* end = bytes + data.size();
+
+    if (m_buffer_size + data.size() < sizeof(m_buffer)) {
+        __builtin_memcpy(m_buffer + m_buffer_size, bytes, data.size());
+        m_buffer_size += data.size();
+        return;
+    }
+
+    if (m_buffer_size != 0) {
+        auto fill = sizeof(m_buffer) - m_buffer_size;
+        __builtin_memcpy(m_buffer + m_buffer_size, bytes, fill);
+        bytes += fill;
+        for (size_t i = 0; i < 4; ++i)
+            m_accumulators[i] = round32(m_accumulators[i], read_le<u32>(m_buffer + i * 4));
+        m_buffer_size = 0;
+    }
+
+    u32 a0 = m_accumulators[0], a1 = m_accumulators[1], a2 = m_accumulators[2], a3 = m_accumulators[3];
+    for (; end - bytes >= 16; bytes += 16) {
+        a0 = round32(a0, read_le<u32>(bytes));
+        a1 = round32(a1, read_le<u32>(bytes + 4));
+        a2 = round32(a2, read_le<u32>(bytes + 8));
+        a3 = round32(a3, read_le<u32>(bytes + 12));
+    }
+    m_accumulators[0] = a0, m_accumulators[1] = a1, m_accumulators[2] = a2, m_accumulators[3] = a3;
+
+    m_buffer_size = end - bytes;
+    __builtin_memcpy(m_buffer, bytes, m_buffer_size);
+}
+
+u32 XXHash32::digest()
+{
+    u32 hash;
+    if (m_total_size >= 16)
+        hash = rotate_left(m_accumulators[0], 1) + rotate_left(m_accumulators[1], 7) + rotate_left(m_accumulators[2], 12) + rotate_left(m_accumulators[3], 18);
+    else
+        hash = m_seed + prime32_5;
+    hash += static_cast<u32>(m_total_size);
+
+    auto* bytes = m_buffer;
+    auto* end = m_buffer + m_buffer_size;
+    for (; end - bytes >= 4; bytes += 4)
+        hash = rotate_left(hash + read_le<u32>(bytes) * prime32_3, 17) * prime32_4;
+    for (; bytes < end; ++bytes)
+        hash = rotate_left(hash + *bytes * prime32_5, 11) * prime32_1;
+
+    hash ^= hash >> 15;
+    hash *= prime32_2;
+    hash ^= hash >> 13;
+    hash *= prime32_3;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+XXHash64::XXHash64(u64 seed)
+    : m_seed(seed)
+    , m_accumulators { seed + prime64_1 + prime64_2, seed + prime64_2, seed, seed - prime64_1 }
+{
+}
+
+void XXHash64::update(ReadonlyBytes data)
+{
+    m_total_size += data.size();
+    auto* bytes = data.data();
+    auto* end = bytes + data.size();
+
+    if (m_buffer_size + data.size() < sizeof(m_buffer)) {
+        __builtin_memcpy(m_buffer + m_buffer_size, bytes, data.size());
+        m_buffer_size += data.size();
+        return;
+    }
+
+    if (m_buffer_size != 0) {
+        auto fill = sizeof(m_buffer) - m_buffer_size;
+        __builtin_memcpy(m_buffer + m_buffer_size, bytes, fill);
+        bytes += fill;
+        for (size_t i = 0; i < 4; ++i)
+            m_accumulators[i] = round64(m_accumulators[i], read_le<u64>(m_buffer + i * 8));
+        m_buffer_size = 0;
+    }
+
+    u64 a0 = m_accumulators[0], a1 = m_accumulators[1], a2 = m_accumulators[2], a3 = m_accumulators[3];
+    for (; end - bytes >= 32; bytes += 32) {
+        a0 = round64(a0, read_le<u64>(bytes));
+        a1 = round64(a1, read_le<u64>(bytes + 8));
+        a2 = round64(a2, read_le<u64>(bytes + 16));
+        a3 = round64(a3, read_le<u64>(bytes + 24));
+    }
+    m_accumulators[0] = a0, m_accumulators[1] = a1, m_accumulators[2] = a2, m_accumulators[3] = a3;
+
+    m_buffer_size = end - bytes;
+    __builtin_memcpy(m_buffer, bytes, m_buffer_size);
+}
+
+u64 XXHash64::digest()
+{
+    u64 hash;
+    if (m_total_size >= 32) {
+        hash = rotate_left(m_accumulators[0], 1) + rotate_left(m_accumulators[1], 7) + rotate_left(m_accumulators[2], 12) + rotate_left(m_accumulators[3], 18);
+        for (auto accumulator : m_accumulators)
+            hash = merge64(hash, accumulator);
+    } else {
+        hash = m_seed + prime64_5;
+    }
+    hash += m_total_size;
+
+    auto* bytes = m_buffer;
+    auto* end = m_buffer + m_buffer_size;
+    for (; end - bytes >= 8; bytes += 8)
+        hash = rotate_left(hash ^ round64(0, read_le<u64>(bytes)), 27) * prime64_1 + prime64_4;
+    if (end - bytes >= 4) {
+        hash = rotate_left(hash ^ (read_le<u32>(bytes) * prime64_1), 23) * prime64_2 + prime64_3;
+        bytes += 4;
+    }
+    for (; bytes < end; ++bytes)
+        hash = rotate_left(hash ^ (*bytes * prime64_5), 11) * prime64_1;
+
+    hash ^= hash >> 33;
+    hash *= prime64_2;
+    hash ^= hash >> 29;
+    hash *= prime64_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+}
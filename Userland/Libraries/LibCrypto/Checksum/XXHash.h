@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Span.h>
+#include <AK/Types.h>
+#include <LibCrypto/Checksum/ChecksumFunction.h>
+
+namespace Crypto::Checksum {
+
+// xxHash (https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md), which LZ4 and Zstandard frames use as
+// their checksums.
+class XXHash32 : public ChecksumFunction<u32> {
+public:
+    explicit XXHash32(u32 seed = 0);
+    XXHash32(ReadonlyBytes data)
+        : XXHash32()
+    {
+        update(data);
+    }
+
+    void update(ReadonlyBytes data);
+    u32 digest();
+
+private:
+    u32 m_seed { 0 };
+    u32 m_accumulators[4];
+    u8 m_buffer[16];
+    size_t m_buffer_size { 0 };
+    u64 m_total_size { 0 };
+};
+
+class XXHash64 : public ChecksumFunction<u64> {
+public:
+    explicit XXHash64(u64 seed = 0);
+    XXHash64(ReadonlyBytes data)
+        : XXHash64()
+    {
+        update(data);
+    }
+
+    void update(ReadonlyBytes data);
+    u64 digest();
+
+private:
+    u64 m_seed { 0 };
+    u64 m_accumulators[4];
+    u8 m_buffer[32];
+    size_t m_buffer_size { 0 };
+    u64 m_total_size { 0 };
+};
+
+}
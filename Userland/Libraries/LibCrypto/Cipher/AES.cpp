@@ -4,9 +4,16 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Platform.h>
 #include <AK/StringBuilder.h>
 #include <LibCrypto/Cipher/AES.h>
 
+// The kernel doesn't save the SSE registers on entry, so it has to stick to the table based rounds.
+#if (ARCH(I386) || ARCH(X86_64)) && !defined(KERNEL)
+#    define AES_HAVE_AESNI
+#    include <cpuid.h>
+#endif
+
 namespace Crypto {
 namespace Cipher {
 
@@ -23,6 +30,78 @@ constexpr void swap_keys(u32* keys, size_t i, size_t j)
     keys[j] = temp;
 }
 
+#ifdef AES_HAVE_AESNI
+
+static bool has_aesni()
+{
+    static int s_has_aesni = -1;
+    if (s_has_aesni < 0) {
+        unsigned eax, ebx, ecx, edx;
+        s_has_aesni = __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_AES) && (edx & bit_SSE2);
+    }
+    return s_has_aesni;
+}
+
+// This is the vector type that the AES-NI builtins take.
+using Block = long long __attribute__((vector_size(16)));
+
+[[gnu::target("aes,sse2")]] static ALWAYS_INLINE Block load_block(const u8* data)
+{
+    Block block;
+    __builtin_memcpy(&block, data, sizeof(block));
+    return block;
+}
+
+[[gnu::target("aes,sse2")]] static ALWAYS_INLINE void store_block(u8* data, Block block)
+{
+    __builtin_memcpy(data, &block, sizeof(block));
+}
+
+// Each instruction does a whole round. Decryption takes the same (reversed and inverse mix-columned) key schedule
+// that the table based decrypt_block() does.
+[[gnu::target("aes,sse2")]] static void encrypt_block_aesni(const u8* round_keys, size_t rounds, const u8* in, u8* out)
+{
+    auto state = load_block(in) ^ load_block(round_keys);
+    for (size_t i = 1; i < rounds; ++i)
+        state = __builtin_ia32_aesenc128(state, load_block(round_keys + 16 * i));
+    store_block(out, __builtin_ia32_aesenclast128(state, load_block(round_keys + 16 * rounds)));
+}
+
+[[gnu::target("aes,sse2")]] static void decrypt_block_aesni(const u8* round_keys, size_t rounds, const u8* in, u8* out)
+{
+    auto state = load_block(in) ^ load_block(round_keys);
+    for (size_t i = 1; i < rounds; ++i)
+        state = __builtin_ia32_aesdec128(state, load_block(round_keys + 16 * i));
+    store_block(out, __builtin_ia32_aesdeclast128(state, load_block(round_keys + 16 * rounds)));
+}
+
+// An aesenc has a latency of several cycles but can start every cycle, so eight independent blocks keep it busy.
+static constexpr size_t aesni_parallel_blocks = 8;
+
+[[gnu::target("aes,sse2")]] static void encrypt_blocks_aesni(const u8* round_keys, size_t rounds, const u8* in, u8* out, size_t count)
+{
+    for (; count >= aesni_parallel_blocks; count -= aesni_parallel_blocks) {
+        Block states[aesni_parallel_blocks];
+        auto key = load_block(round_keys);
+        for (size_t j = 0; j < aesni_parallel_blocks; ++j)
+            states[j] = load_block(in + 16 * j) ^ key;
+        for (size_t i = 1; i < rounds; ++i) {
+            key = load_block(round_keys + 16 * i);
+            for (size_t j = 0; j < aesni_parallel_blocks; ++j)
+                states[j] = __builtin_ia32_aesenc128(states[j], key);
+        }
+        key = load_block(round_keys + 16 * rounds);
+        for (size_t j = 0; j < aesni_parallel_blocks; ++j)
+            store_block(out + 16 * j, __builtin_ia32_aesenclast128(states[j], key));
+        in += 16 * aesni_parallel_blocks;
+        out += 16 * aesni_parallel_blocks;
+    }
+    for (; count > 0; --count, in += 16, out += 16)
+        encrypt_block_aesni(round_keys, rounds, in, out);
+}
+
+#endif
+
 String AESCipherBlock::to_string() const
 {
     StringBuilder builder;
@@ -150,6 +229,16 @@ void AESCipherKey::expand_encrypt_key(ReadonlyBytes user_key, size_t bits)
     }
 }
 
+void AESCipherKey::update_round_key_bytes()
+{
+    for (size_t i = 0; i < (rounds() + 1) * 4; ++i) {
+        m_rd_key_bytes[4 * i] = m_rd_keys[i] >> 24;
+        m_rd_key_bytes[4 * i + 1] = m_rd_keys[i] >> 16;
+        m_rd_key_bytes[4 * i + 2] = m_rd_keys[i] >> 8;
+        m_rd_key_bytes[4 * i + 3] = m_rd_keys[i];
+    }
+}
+
 void AESCipherKey::expand_decrypt_key(ReadonlyBytes user_key, size_t bits)
 {
     u32* round_key;
@@ -196,6 +285,13 @@ void AESCipherKey::expand_decrypt_key(ReadonlyBytes user_key, size_t bits)
 
 void AESCipher::encrypt_block(const AESCipherBlock& in, AESCipherBlock& out)
 {
+#ifdef AES_HAVE_AESNI
+    if (has_aesni()) {
+        encrypt_block_aesni(m_key.round_key_bytes(), m_key.rounds(), in.bytes().data(), out.bytes().data());
+        return;
+    }
+#endif
+
     u32 s0, s1, s2, s3, t0, t1, t2, t3;
     size_t r { 0 };
 
@@ -288,6 +384,13 @@ void AESCipher::encrypt_block(const AESCipherBlock& in, AESCipherBlock& out)
 
 void AESCipher::decrypt_block(const AESCipherBlock& in, AESCipherBlock& out)
 {
+#ifdef AES_HAVE_AESNI
+    if (has_aesni()) {
+        decrypt_block_aesni(m_key.round_key_bytes(), m_key.rounds(), in.bytes().data(), out.bytes().data());
+        return;
+    }
+#endif
+
     u32 s0, s1, s2, s3, t0, t1, t2, t3;
     size_t r { 0 };
 
@@ -375,6 +478,26 @@ void AESCipher::decrypt_block(const AESCipherBlock& in, AESCipherBlock& out)
     // clang-format on
 }
 
+void AESCipher::encrypt_blocks(ReadonlyBytes in, Bytes out)
+{
+    VERIFY(in.size() % block_size() == 0);
+    VERIFY(out.size() >= in.size());
+
+#ifdef AES_HAVE_AESNI
+    if (has_aesni()) {
+        encrypt_blocks_aesni(m_key.round_key_bytes(), m_key.rounds(), in.data(), out.data(), in.size() / block_size());
+        return;
+    }
+#endif
+
+    AESCipherBlock block;
+    for (size_t offset = 0; offset < in.size(); offset += block_size()) {
+        block.overwrite(in.slice(offset, block_size()));
+        encrypt_block(block, block);
+        block.bytes().copy_to(out.slice(offset));
+    }
+}
+
 void AESCipherBlock::overwrite(ReadonlyBytes bytes)
 {
     auto data = bytes.data();
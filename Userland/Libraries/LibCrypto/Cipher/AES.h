@@ -61,6 +61,8 @@ struct AESCipherKey : public CipherKey {
     {
         return (const u32*)m_rd_keys;
     }
+    // The round keys as bytes in memory order, which is how the AES-NI instructions take them.
+    const u8* round_key_bytes() const { return m_rd_key_bytes; }
 
     AESCipherKey(ReadonlyBytes user_key, size_t key_bits, Intent intent)
         : m_bits(key_bits)
@@ -69,6 +71,7 @@ struct AESCipherKey : public CipherKey {
             expand_encrypt_key(user_key, key_bits);
         else
             expand_decrypt_key(user_key, key_bits);
+        update_round_key_bytes();
     }
 
     virtual ~AESCipherKey() override { }
@@ -83,8 +86,11 @@ protected:
     }
 
 private:
+    void update_round_key_bytes();
+
     static constexpr size_t MAX_ROUND_COUNT = 14;
     u32 m_rd_keys[(MAX_ROUND_COUNT + 1) * 4] { 0 };
+    alignas(16) u8 m_rd_key_bytes[(MAX_ROUND_COUNT + 1) * 16] { 0 };
     size_t m_rounds;
     size_t m_bits;
 };
@@ -109,6 +115,9 @@ public:
     virtual void encrypt_block(const BlockType& in, BlockType& out) override;
     virtual void decrypt_block(const BlockType& in, BlockType& out) override;
 
+    // Encrypts a run of independent blocks, several at a time where the CPU can overlap them (as in CTR mode).
+    void encrypt_blocks(ReadonlyBytes in, Bytes out);
+
     virtual String class_name() const override { return "AES"; }
 
 protected:
@@ -86,9 +86,9 @@ public:
         auto& cipher = this->cipher();
 
         VERIFY(!ivec.is_empty());
-        ReadonlyBytes iv = ivec;
 
         auto block_size = cipher.block_size();
+        VERIFY(block_size <= IV_length());
 
         // if the data is not aligned, it's not correct encrypted data
         // FIXME (ponder): Should we simply decrypt as much as we can?
@@ -97,15 +97,21 @@ public:
         m_cipher_block.set_padding_mode(cipher.padding_mode());
         size_t offset { 0 };
 
+        // Each block is chained to the ciphertext of the one before it, which we keep a copy of so that `out` may be
+        // the same buffer as `in`.
+        u8 iv[IVSizeInBits / 8];
+        u8 next_iv[IVSizeInBits / 8];
+        __builtin_memcpy(iv, ivec.data(), min(ivec.size(), sizeof(iv)));
+
         while (length > 0) {
-            auto slice = in.slice(offset);
-            m_cipher_block.overwrite(slice.data(), block_size);
+            __builtin_memcpy(next_iv, in.offset(offset), block_size);
+            m_cipher_block.overwrite(next_iv, block_size);
             cipher.decrypt_block(m_cipher_block, m_cipher_block);
-            m_cipher_block.apply_initialization_vector(iv);
+            m_cipher_block.apply_initialization_vector({ iv, block_size });
             auto decrypted = m_cipher_block.bytes();
             VERIFY(offset + decrypted.size() <= out.size());
             __builtin_memcpy(out.offset(offset), decrypted.data(), decrypted.size());
-            iv = slice;
+            __builtin_memcpy(iv, next_iv, block_size);
             length -= block_size;
             offset += block_size;
         }
@@ -163,6 +163,30 @@ protected:
         size_t offset { 0 };
         auto block_size = cipher.block_size();
 
+        // Ciphers that can encrypt several blocks at once get whole batches of counters, which (unlike in CBC mode)
+        // don't depend on each other.
+        if constexpr (requires { cipher.encrypt_blocks(ReadonlyBytes {}, Bytes {}); }) {
+            constexpr size_t batch_size = 8;
+            u8 counters[batch_size * T::block_size()];
+            u8 key_stream[batch_size * T::block_size()];
+            while (length >= block_size) {
+                auto block_count = min(batch_size, length / block_size);
+                for (size_t i = 0; i < block_count; ++i) {
+                    __builtin_memcpy(counters + i * block_size, iv.data(), block_size);
+                    increment(iv);
+                }
+                auto batch_length = block_count * block_size;
+                cipher.encrypt_blocks({ counters, batch_length }, { key_stream, batch_length });
+                if (in) {
+                    for (size_t i = 0; i < batch_length; ++i)
+                        key_stream[i] ^= (*in)[offset + i];
+                }
+                __builtin_memcpy(out.offset(offset), key_stream, batch_length);
+                length -= batch_length;
+                offset += batch_length;
+            }
+        }
+
         while (length > 0) {
             m_cipher_block.overwrite(iv.slice(0, block_size));
 
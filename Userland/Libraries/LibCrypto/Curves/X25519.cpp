@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/Random.h>
+#include <LibCrypto/Curves/X25519.h>
+#include <string.h>
+
+namespace Crypto::Curves {
+
+// An element of GF(2^255 - 19) as sixteen 16-bit limbs, which leaves enough headroom in each i64 for sums and
+// products to only be carried once per operation. This is the representation from TweetNaCl.
+using FieldElement = Array<i64, 16>;
+
+static void carry(FieldElement& element)
+{
+    for (size_t i = 0; i < 16; ++i) {
+        auto carry = element[i] >> 16;
+        element[i] &= 0xffff;
+        // 2^256 = 38 (mod 2^255 - 19), so the carry out of the top limb wraps around to the bottom one.
+        if (i < 15)
+            element[i + 1] += carry;
+        else
+            element[0] += 38 * carry;
+    }
+}
+
+// Swaps the two elements if bit is 1, without branching on it.
+static void conditional_swap(FieldElement& a, FieldElement& b, i64 bit)
+{
+    i64 mask = -bit;
+    for (size_t i = 0; i < 16; ++i) {
+        auto difference = mask & (a[i] ^ b[i]);
+        a[i] ^= difference;
+        b[i] ^= difference;
+    }
+}
+
+static FieldElement add(FieldElement const& a, FieldElement const& b)
+{
+    FieldElement result;
+    for (size_t i = 0; i < 16; ++i)
+        result[i] = a[i] + b[i];
+    return result;
+}
+
+static FieldElement subtract(FieldElement const& a, FieldElement const& b)
+{
+    FieldElement result;
+    for (size_t i = 0; i < 16; ++i)
+        result[i] = a[i] - b[i];
+    return result;
+}
+
+static FieldElement multiply(FieldElement const& a, FieldElement const& b)
+{
+    i64 product[31] {};
+    for (size_t i = 0; i < 16; ++i) {
+        for (size_t j = 0; j < 16; ++j)
+            product[i + j] += a[i] * b[j];
+    }
+    for (size_t i = 0; i < 15; ++i)
+        product[i] += 38 * product[i + 16];
+
+    FieldElement result;
+    for (size_t i = 0; i < 16; ++i)
+        result[i] = product[i];
+    carry(result);
+    carry(result);
+    return result;
+}
+
+static FieldElement square(FieldElement const& a)
+{
+    return multiply(a, a);
+}
+
+// a^(p - 2), which is the inverse of a by Fermat's little theorem.
+static FieldElement invert(FieldElement const& a)
+{
+    auto result = a;
+    for (int bit = 253; bit >= 0; --bit) {
+        result = square(result);
+        if (bit != 2 && bit != 4)
+            result = multiply(result, a);
+    }
+    return result;
+}
+
+static FieldElement unpack(ReadonlyBytes bytes)
+{
+    FieldElement result;
+    for (size_t i = 0; i < 16; ++i)
+        result[i] = bytes[2 * i] + (static_cast<i64>(bytes[2 * i + 1]) << 8);
+    // The top bit of a u-coordinate is ignored.
+    result[15] &= 0x7fff;
+    return result;
+}
+
+// Writes out the fully reduced element, subtracting p (at most twice) without branching on the value.
+static void pack(FieldElement element, Bytes output)
+{
+    carry(element);
+    carry(element);
+    carry(element);
+    for (size_t round = 0; round < 2; ++round) {
+        FieldElement reduced;
+        reduced[0] = element[0] - 0xffed;
+        for (size_t i = 1; i < 15; ++i) {
+            reduced[i] = element[i] - 0xffff - ((reduced[i - 1] >> 16) & 1);
+            reduced[i - 1] &= 0xffff;
+        }
+        reduced[15] = element[15] - 0x7fff - ((reduced[14] >> 16) & 1);
+        auto borrow = (reduced[15] >> 16) & 1;
+        reduced[14] &= 0xffff;
+        conditional_swap(element, reduced, 1 - borrow);
+    }
+    for (size_t i = 0; i < 16; ++i) {
+        output[2 * i] = element[i] & 0xff;
+        output[2 * i + 1] = element[i] >> 8;
+    }
+}
+
+void X25519::compute_coordinate(ReadonlyBytes scalar_bytes, ReadonlyBytes point, Bytes output)
+{
+    VERIFY(scalar_bytes.size() == key_size);
+    VERIFY(point.size() == key_size);
+    VERIFY(output.size() == key_size);
+
+    u8 scalar[key_size];
+    __builtin_memcpy(scalar, scalar_bytes.data(), key_size);
+    scalar[0] &= 248;
+    scalar[31] = (scalar[31] & 127) | 64;
+
+    // The Montgomery ladder from RFC 7748 section 5, which does the same operations whatever the scalar's bits are.
+    static constexpr FieldElement a24 { 0xdb41, 1 }; // 121665
+    auto x_1 = unpack(point);
+    FieldElement x_2 { 1 };
+    FieldElement z_2 {};
+    auto x_3 = x_1;
+    FieldElement z_3 { 1 };
+
+    for (int bit_index = 254; bit_index >= 0; --bit_index) {
+        i64 bit = (scalar[bit_index / 8] >> (bit_index % 8)) & 1;
+        conditional_swap(x_2, x_3, bit);
+        conditional_swap(z_2, z_3, bit);
+
+        auto a = add(x_2, z_2);
+        auto b = subtract(x_2, z_2);
+        auto c = add(x_3, z_3);
+        auto d = subtract(x_3, z_3);
+        auto aa = square(a);
+        auto bb = square(b);
+        auto e = subtract(aa, bb);
+        auto da = multiply(d, a);
+        auto cb = multiply(c, b);
+        x_3 = square(add(da, cb));
+        z_3 = multiply(x_1, square(subtract(da, cb)));
+        x_2 = multiply(aa, bb);
+        z_2 = multiply(e, add(aa, multiply(a24, e)));
+
+        conditional_swap(x_2, x_3, bit);
+        conditional_swap(z_2, z_3, bit);
+    }
+
+    pack(multiply(x_2, invert(z_2)), output);
+    explicit_bzero(scalar, sizeof(scalar));
+}
+
+void X25519::generate_private_key(Bytes output)
+{
+    VERIFY(output.size() == key_size);
+    fill_with_random(output.data(), output.size());
+}
+
+void X25519::generate_public_key(ReadonlyBytes private_key, Bytes output)
+{
+    u8 base_point[key_size] { 9 };
+    compute_coordinate(private_key, { base_point, key_size }, output);
+}
+
+bool X25519::compute_shared_secret(ReadonlyBytes private_key, ReadonlyBytes peer_public_key, Bytes output)
+{
+    compute_coordinate(private_key, peer_public_key, output);
+    u8 all_bits = 0;
+    for (auto byte : output)
+        all_bits |= byte;
+    return all_bits != 0;
+}
+
+}
@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Span.h>
+#include <AK/Types.h>
+
+namespace Crypto::Curves {
+
+// Diffie-Hellman over Curve25519 (RFC 7748). Keys and shared secrets are little endian u-coordinates.
+class X25519 {
+public:
+    static constexpr size_t key_size = 32;
+
+    // Computes scalar * point. The scalar is clamped as RFC 7748 section 5 describes, so any 32 random bytes will do.
+    static void compute_coordinate(ReadonlyBytes scalar, ReadonlyBytes point, Bytes output);
+
+    static void generate_private_key(Bytes output);
+    static void generate_public_key(ReadonlyBytes private_key, Bytes output);
+
+    // Returns false if the peer's public key is one of the small order points that would make the shared secret all
+    // zeros, as RFC 7748 section 6.1 asks to check for.
+    static bool compute_shared_secret(ReadonlyBytes private_key, ReadonlyBytes peer_public_key, Bytes output);
+};
+
+}
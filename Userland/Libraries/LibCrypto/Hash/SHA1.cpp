@@ -4,10 +4,18 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ByteReader.h>
 #include <AK/Endian.h>
+#include <AK/Platform.h>
+#include <AK/StdLibExtras.h>
 #include <AK/Types.h>
 #include <LibCrypto/Hash/SHA1.h>
 
+#if (ARCH(I386) || ARCH(X86_64)) && !defined(KERNEL)
+#    define SHA1_HAVE_SHA_NI
+#    include <cpuid.h>
+#endif
+
 namespace Crypto {
 namespace Hash {
 
@@ -16,11 +24,90 @@ static constexpr auto ROTATE_LEFT(u32 value, size_t bits)
     return (value << bits) | (value >> (32 - bits));
 }
 
+#ifdef SHA1_HAVE_SHA_NI
+
+static bool has_sha_ni()
+{
+    static int s_has_sha_ni = -1;
+    if (s_has_sha_ni < 0) {
+        unsigned eax, ebx, ecx, edx;
+        s_has_sha_ni = __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSE4_1)
+            && __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_SHA);
+    }
+    return s_has_sha_ni;
+}
+
+// These are the vector types that the SHA builtins take, and the one the byte shuffle works on.
+using Words = u32 __attribute__((vector_size(16)));
+using NativeWords = int __attribute__((vector_size(16)));
+using ByteVector = char __attribute__((vector_size(16)));
+
+// The instructions keep the words of a block in reverse order, with the first one in the top lane.
+[[gnu::target("sha,sse4.1")]] static ALWAYS_INLINE Words load_message_words(const u8* data)
+{
+    ByteVector bytes;
+    __builtin_memcpy(&bytes, data, sizeof(bytes));
+    return (Words)__builtin_shuffle(bytes, ByteVector { 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 });
+}
+
+// Each group does four of the 80 rounds with sha1rnds4, which takes the round function as an immediate, while
+// sha1msg1, sha1msg2 and a xor expand the message schedule for the groups three ahead.
+template<size_t Group = 0>
+[[gnu::target("sha,sse4.1")]] static ALWAYS_INLINE void rounds_sha_ni(Words& abcd, Words (&e)[2], Words (&w)[4])
+{
+    auto& message = w[Group % 4];
+    auto& this_e = e[Group % 2];
+    if constexpr (Group == 0)
+        this_e += message;
+    else
+        this_e = (Words)__builtin_ia32_sha1nexte((NativeWords)this_e, (NativeWords)message);
+    e[(Group + 1) % 2] = abcd;
+    abcd = (Words)__builtin_ia32_sha1rnds4((NativeWords)abcd, (NativeWords)this_e, Group / 5);
+
+    if constexpr (Group >= 3 && Group < 19)
+        w[(Group + 1) % 4] = (Words)__builtin_ia32_sha1msg2((NativeWords)w[(Group + 1) % 4], (NativeWords)message);
+    if constexpr (Group >= 1 && Group < 17)
+        w[(Group + 3) % 4] = (Words)__builtin_ia32_sha1msg1((NativeWords)w[(Group + 3) % 4], (NativeWords)message);
+    if constexpr (Group >= 2 && Group < 18)
+        w[(Group + 2) % 4] ^= message;
+
+    if constexpr (Group + 1 < 20)
+        rounds_sha_ni<Group + 1>(abcd, e, w);
+}
+
+[[gnu::target("sha,sse4.1")]] static void transform_blocks_sha_ni(u32* state, const u8* data, size_t count)
+{
+    Words abcd { state[3], state[2], state[1], state[0] };
+    Words e { 0, 0, 0, state[4] };
+
+    for (size_t i = 0; i < count; ++i, data += 64) {
+        Words message[4] {
+            load_message_words(data),
+            load_message_words(data + 16),
+            load_message_words(data + 32),
+            load_message_words(data + 48),
+        };
+        Words round_e[2] { e, {} };
+        auto saved_abcd = abcd;
+        rounds_sha_ni(abcd, round_e, message);
+        abcd += saved_abcd;
+        e = (Words)__builtin_ia32_sha1nexte((NativeWords)round_e[0], (NativeWords)e);
+    }
+
+    state[0] = abcd[3];
+    state[1] = abcd[2];
+    state[2] = abcd[1];
+    state[3] = abcd[0];
+    state[4] = e[3];
+}
+
+#endif
+
 inline void SHA1::transform(const u8* data)
 {
     u32 blocks[80];
     for (size_t i = 0; i < 16; ++i)
-        blocks[i] = AK::convert_between_host_and_network_endian(((const u32*)data)[i]);
+        blocks[i] = AK::convert_between_host_and_network_endian(ByteReader::load32(data + i * 4));
 
     // w[i] = (w[i-3] xor w[i-8] xor w[i-14] xor w[i-16]) leftrotate 1
     for (size_t i = 16; i < Rounds; ++i)
@@ -66,16 +153,40 @@ inline void SHA1::transform(const u8* data)
     __builtin_memset(blocks, 0, 16 * sizeof(u32));
 }
 
+void SHA1::transform_blocks(const u8* data, size_t count)
+{
+#ifdef SHA1_HAVE_SHA_NI
+    if (has_sha_ni()) {
+        transform_blocks_sha_ni(m_state, data, count);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < count; ++i)
+        transform(data + i * BlockSize);
+}
+
 void SHA1::update(const u8* message, size_t length)
 {
-    for (size_t i = 0; i < length; ++i) {
-        if (m_data_length == BlockSize) {
-            transform(m_data_buffer);
-            m_bit_length += 512;
-            m_data_length = 0;
-        }
-        m_data_buffer[m_data_length++] = message[i];
+    if (m_data_length > 0) {
+        auto length_to_copy = min(length, BlockSize - m_data_length);
+        __builtin_memcpy(m_data_buffer + m_data_length, message, length_to_copy);
+        m_data_length += length_to_copy;
+        message += length_to_copy;
+        length -= length_to_copy;
+        if (m_data_length < BlockSize)
+            return;
+        transform_blocks(m_data_buffer, 1);
+        m_bit_length += BlockSize * 8;
+        m_data_length = 0;
     }
+
+    // Whole blocks are hashed straight from the message, so that the vectorized transform can run over all of them.
+    auto block_count = length / BlockSize;
+    transform_blocks(message, block_count);
+    m_bit_length += block_count * BlockSize * 8;
+
+    m_data_length = length % BlockSize;
+    __builtin_memcpy(m_data_buffer, message + block_count * BlockSize, m_data_length);
 }
 
 SHA1::DigestType SHA1::digest()
@@ -97,7 +208,7 @@ SHA1::DigestType SHA1::peek()
     __builtin_memcpy(state, m_state, 20);
 
     if (BlockSize == m_data_length) {
-        transform(m_data_buffer);
+        transform_blocks(m_data_buffer, 1);
         m_bit_length += BlockSize * 8;
         m_data_length = 0;
         i = 0;
@@ -113,7 +224,7 @@ SHA1::DigestType SHA1::peek()
         m_data_buffer[i++] = 0x80;
         while (i < BlockSize)
             m_data_buffer[i++] = 0x00;
-        transform(m_data_buffer);
+        transform_blocks(m_data_buffer, 1);
 
         // Then start another block with BlockSize - 8 bytes of zeros
         __builtin_memset(m_data_buffer, 0, FinalBlockDataSize);
@@ -130,7 +241,7 @@ SHA1::DigestType SHA1::peek()
     m_data_buffer[BlockSize - 7] = m_bit_length >> 48;
     m_data_buffer[BlockSize - 8] = m_bit_length >> 56;
 
-    transform(m_data_buffer);
+    transform_blocks(m_data_buffer, 1);
 
     for (size_t i = 0; i < 4; ++i) {
         digest.data[i + 0] = (m_state[0] >> (24 - i * 8)) & 0x000000ff;
@@ -72,6 +72,7 @@ public:
 
 private:
     inline void transform(const u8*);
+    void transform_blocks(const u8*, size_t count);
 
     u8 m_data_buffer[BlockSize] {};
     size_t m_data_length { 0 };
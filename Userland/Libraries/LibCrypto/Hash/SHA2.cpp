@@ -4,9 +4,17 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Platform.h>
+#include <AK/StdLibExtras.h>
 #include <AK/Types.h>
 #include <LibCrypto/Hash/SHA2.h>
 
+// The kernel doesn't save the SSE registers on entry, so it has to stick to the plain transform.
+#if (ARCH(I386) || ARCH(X86_64)) && !defined(KERNEL)
+#    define SHA256_HAVE_SHA_NI
+#    include <cpuid.h>
+#endif
+
 namespace Crypto {
 namespace Hash {
 constexpr static auto ROTRIGHT(u32 a, size_t b) { return (a >> b) | (a << (32 - b)); }
@@ -25,6 +33,86 @@ constexpr static auto EP1(u64 x) { return ROTRIGHT(x, 14) ^ ROTRIGHT(x, 18) ^ RO
 constexpr static auto SIGN0(u64 x) { return ROTRIGHT(x, 1) ^ ROTRIGHT(x, 8) ^ (x >> 7); }
 constexpr static auto SIGN1(u64 x) { return ROTRIGHT(x, 19) ^ ROTRIGHT(x, 61) ^ (x >> 6); }
 
+#ifdef SHA256_HAVE_SHA_NI
+
+static bool has_sha_ni()
+{
+    static int s_has_sha_ni = -1;
+    if (s_has_sha_ni < 0) {
+        unsigned eax, ebx, ecx, edx;
+        s_has_sha_ni = __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSE4_1)
+            && __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_SHA);
+    }
+    return s_has_sha_ni;
+}
+
+// These are the vector types that the SHA builtins take, and the one the byte shuffle works on.
+using Words = u32 __attribute__((vector_size(16)));
+using NativeWords = int __attribute__((vector_size(16)));
+using ByteVector = char __attribute__((vector_size(16)));
+
+[[gnu::target("sha,sse4.1")]] static ALWAYS_INLINE Words load_message_words(const u8* data)
+{
+    ByteVector bytes;
+    __builtin_memcpy(&bytes, data, sizeof(bytes));
+    return (Words)__builtin_shuffle(bytes, ByteVector { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 });
+}
+
+// Each group does four of the 64 rounds as two sha256rnds2, which keep the state split into (A, B, E, F) and
+// (C, D, G, H). sha256msg1, sha256msg2 and the shuffle in between expand the message schedule for the groups ahead.
+template<size_t Group = 0>
+[[gnu::target("sha,sse4.1")]] static ALWAYS_INLINE void rounds_sha_ni(Words& abef, Words& cdgh, Words (&w)[4])
+{
+    auto& message = w[Group % 4];
+    Words constants;
+    __builtin_memcpy(&constants, SHA256Constants::RoundConstants + Group * 4, sizeof(constants));
+    auto scheduled = message + constants;
+
+    cdgh = (Words)__builtin_ia32_sha256rnds2((NativeWords)cdgh, (NativeWords)abef, (NativeWords)scheduled);
+    if constexpr (Group >= 3 && Group < 15) {
+        auto& next = w[(Group + 1) % 4];
+        next += __builtin_shuffle(w[(Group + 3) % 4], message, Words { 1, 2, 3, 4 });
+        next = (Words)__builtin_ia32_sha256msg2((NativeWords)next, (NativeWords)message);
+    }
+    abef = (Words)__builtin_ia32_sha256rnds2((NativeWords)abef, (NativeWords)cdgh, (NativeWords)__builtin_shuffle(scheduled, Words { 2, 3, 0, 0 }));
+    if constexpr (Group >= 1 && Group < 13)
+        w[(Group + 3) % 4] = (Words)__builtin_ia32_sha256msg1((NativeWords)w[(Group + 3) % 4], (NativeWords)message);
+
+    if constexpr (Group + 1 < 16)
+        rounds_sha_ni<Group + 1>(abef, cdgh, w);
+}
+
+[[gnu::target("sha,sse4.1")]] static void transform_blocks_sha_ni(u32* state, const u8* data, size_t count)
+{
+    Words abef { state[5], state[4], state[1], state[0] };
+    Words cdgh { state[7], state[6], state[3], state[2] };
+
+    for (size_t i = 0; i < count; ++i, data += 64) {
+        Words message[4] {
+            load_message_words(data),
+            load_message_words(data + 16),
+            load_message_words(data + 32),
+            load_message_words(data + 48),
+        };
+        auto saved_abef = abef;
+        auto saved_cdgh = cdgh;
+        rounds_sha_ni(abef, cdgh, message);
+        abef += saved_abef;
+        cdgh += saved_cdgh;
+    }
+
+    state[0] = abef[3];
+    state[1] = abef[2];
+    state[2] = cdgh[3];
+    state[3] = cdgh[2];
+    state[4] = abef[1];
+    state[5] = abef[0];
+    state[6] = cdgh[1];
+    state[7] = cdgh[0];
+}
+
+#endif
+
 inline void SHA256::transform(const u8* data)
 {
     u32 m[64];
@@ -66,16 +154,40 @@ inline void SHA256::transform(const u8* data)
     m_state[7] += h;
 }
 
+void SHA256::transform_blocks(const u8* data, size_t count)
+{
+#ifdef SHA256_HAVE_SHA_NI
+    if (has_sha_ni()) {
+        transform_blocks_sha_ni(m_state, data, count);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < count; ++i)
+        transform(data + i * BlockSize);
+}
+
 void SHA256::update(const u8* message, size_t length)
 {
-    for (size_t i = 0; i < length; ++i) {
-        if (m_data_length == BlockSize) {
-            transform(m_data_buffer);
-            m_bit_length += 512;
-            m_data_length = 0;
-        }
-        m_data_buffer[m_data_length++] = message[i];
+    if (m_data_length > 0) {
+        auto length_to_copy = min(length, BlockSize - m_data_length);
+        __builtin_memcpy(m_data_buffer + m_data_length, message, length_to_copy);
+        m_data_length += length_to_copy;
+        message += length_to_copy;
+        length -= length_to_copy;
+        if (m_data_length < BlockSize)
+            return;
+        transform_blocks(m_data_buffer, 1);
+        m_bit_length += BlockSize * 8;
+        m_data_length = 0;
     }
+
+    // Whole blocks are hashed straight from the message, so that the vectorized transform can run over all of them.
+    auto block_count = length / BlockSize;
+    transform_blocks(message, block_count);
+    m_bit_length += block_count * BlockSize * 8;
+
+    m_data_length = length % BlockSize;
+    __builtin_memcpy(m_data_buffer, message + block_count * BlockSize, m_data_length);
 }
 
 SHA256::DigestType SHA256::digest()
@@ -91,7 +203,7 @@ SHA256::DigestType SHA256::peek()
     size_t i = m_data_length;
 
     if (BlockSize == m_data_length) {
-        transform(m_data_buffer);
+        transform_blocks(m_data_buffer, 1);
         m_bit_length += BlockSize * 8;
         m_data_length = 0;
         i = 0;
@@ -107,7 +219,7 @@ SHA256::DigestType SHA256::peek()
         m_data_buffer[i++] = 0x80;
         while (i < BlockSize)
             m_data_buffer[i++] = 0x00;
-        transform(m_data_buffer);
+        transform_blocks(m_data_buffer, 1);
 
         // Then start another block with BlockSize - 8 bytes of zeros
         __builtin_memset(m_data_buffer, 0, FinalBlockDataSize);
@@ -124,7 +236,7 @@ SHA256::DigestType SHA256::peek()
     m_data_buffer[BlockSize - 7] = m_bit_length >> 48;
     m_data_buffer[BlockSize - 8] = m_bit_length >> 56;
 
-    transform(m_data_buffer);
+    transform_blocks(m_data_buffer, 1);
 
     // SHA uses big-endian and we assume little-endian
     // FIXME: looks like a thing for AK::NetworkOrdered,
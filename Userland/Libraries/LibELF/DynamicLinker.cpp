@@ -50,15 +50,23 @@ static char** s_envp = nullptr;
 static LibCExitFunction s_libc_exit = nullptr;
 static __pthread_mutex_t s_loader_lock = __PTHREAD_MUTEX_INITIALIZER;
 
+// Every library looks up the same symbols (malloc, free, the AK string functions, ...) in all of the global objects,
+// so the results are remembered while the program and its dependencies are being linked. That happens before any
+// other thread could be resolving a lazily bound PLT entry, and once all of the global objects have been mapped, so
+// none of the results can change.
+static HashMap<StringView, Optional<DynamicObject::SymbolLookupResult>> s_global_symbol_cache;
+static bool s_should_cache_global_symbols { false };
+
 static bool s_allowed_to_check_environment_variables { false };
 static bool s_do_breakpoint_trap_before_entry { false };
+static bool s_should_bind_now { false };
 
 static Result<void, DlErrorMessage> __dlclose(void* handle);
 static Result<void*, DlErrorMessage> __dlopen(const char* filename, int flags);
 static Result<void*, DlErrorMessage> __dlsym(void* handle, const char* symbol_name);
 static Result<void, DlErrorMessage> __dladdr(void* addr, Dl_info* info);
 
-Optional<DynamicObject::SymbolLookupResult> DynamicLinker::lookup_global_symbol(const StringView& name)
+static Optional<DynamicObject::SymbolLookupResult> lookup_global_symbol_uncached(const StringView& name)
 {
     Optional<DynamicObject::SymbolLookupResult> weak_result;
 
@@ -77,6 +85,28 @@ Optional<DynamicObject::SymbolLookupResult> DynamicLinker::lookup_global_symbol(
     return weak_result;
 }
 
+static void stop_caching_global_symbols()
+{
+    if (!s_should_cache_global_symbols)
+        return;
+    dbgln_if(DYNAMIC_LOAD_DEBUG, "Global symbol cache held {} symbols", s_global_symbol_cache.size());
+    s_should_cache_global_symbols = false;
+    s_global_symbol_cache.clear();
+}
+
+Optional<DynamicObject::SymbolLookupResult> DynamicLinker::lookup_global_symbol(const StringView& name)
+{
+    if (!s_should_cache_global_symbols)
+        return lookup_global_symbol_uncached(name);
+
+    // The names point into the string tables of the objects that refer to them, which stay mapped.
+    if (auto cached = s_global_symbol_cache.find(name); cached != s_global_symbol_cache.end())
+        return cached->value;
+    auto result = lookup_global_symbol_uncached(name);
+    s_global_symbol_cache.set(name, result);
+    return result;
+}
+
 static String get_library_name(String path)
 {
     return LexicalPath::basename(move(path));
@@ -278,6 +308,8 @@ static NonnullRefPtrVector<DynamicLoader> collect_loaders_for_library(const Stri
 
 static Result<NonnullRefPtr<DynamicLoader>, DlErrorMessage> load_main_library(const String& name, int flags)
 {
+    bool is_loading_main_program = s_global_objects.is_empty();
+
     auto main_library_loader = *s_loaders.get(name);
     auto main_library_object = main_library_loader->map();
     s_global_objects.set(name, *main_library_object);
@@ -290,6 +322,9 @@ static Result<NonnullRefPtr<DynamicLoader>, DlErrorMessage> load_main_library(co
             s_global_objects.set(dynamic_object->filename(), *dynamic_object);
     }
 
+    s_should_cache_global_symbols = is_loading_main_program;
+    ScopeGuard stop_caching_guard = [] { stop_caching_global_symbols(); };
+
     for (auto& loader : loaders) {
         bool success = loader.link(flags);
         if (!success) {
@@ -316,6 +351,9 @@ static Result<NonnullRefPtr<DynamicLoader>, DlErrorMessage> load_main_library(co
         }
     }
 
+    // The initializers are free to start threads.
+    stop_caching_global_symbols();
+
     for (auto& loader : loaders) {
         loader.load_stage_4();
     }
@@ -369,9 +407,13 @@ static Optional<DlErrorMessage> verify_tls_for_dlopen(const DynamicLoader& loade
 
 static Result<void*, DlErrorMessage> __dlopen(const char* filename, int flags)
 {
-    // FIXME: RTLD_NOW and RTLD_LOCAL are not supported
-    flags &= ~RTLD_NOW;
-    flags |= RTLD_LAZY;
+    // FIXME: RTLD_LOCAL is not supported
+    if (s_should_bind_now)
+        flags |= RTLD_NOW;
+    if (flags & RTLD_NOW)
+        flags &= ~RTLD_LAZY;
+    else
+        flags |= RTLD_LAZY;
     flags &= ~RTLD_LOCAL;
     flags |= RTLD_GLOBAL;
 
@@ -488,6 +530,12 @@ static void read_environment_variables()
         if (StringView { *env } == "_LOADER_BREAKPOINT=1"sv) {
             s_do_breakpoint_trap_before_entry = true;
         }
+
+        // Like other loaders, any non-empty value counts.
+        StringView bind_now_prefix = "LD_BIND_NOW="sv;
+        StringView env_string { *env };
+        if (env_string.starts_with(bind_now_prefix) && env_string.length() > bind_now_prefix.length())
+            s_should_bind_now = true;
     }
 }
 
@@ -529,7 +577,7 @@ void ELF::DynamicLinker::linker_main(String&& main_program_name, int main_progra
 
     auto entry_point_function = [&main_program_name] {
         auto library_name = get_library_name(main_program_name);
-        auto result = load_main_library(library_name, RTLD_GLOBAL | RTLD_LAZY);
+        auto result = load_main_library(library_name, RTLD_GLOBAL | (s_should_bind_now ? RTLD_NOW : RTLD_LAZY));
         if (result.is_error()) {
             warnln("{}", result.error().text);
             _exit(1);
@@ -149,6 +149,8 @@ private:
     VirtualAddress m_relro_segment_address;
     size_t m_relro_segment_size { 0 };
 
+    bool m_should_bind_now { false };
+
     VirtualAddress m_dynamic_section_address;
 
     ssize_t m_tls_offset { 0 };
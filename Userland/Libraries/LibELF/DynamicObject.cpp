@@ -161,6 +161,8 @@ void DynamicObject::parse()
         case DT_DEBUG:
             break;
         case DT_FLAGS_1:
+            if (entry.val() & DF_1_NOW)
+                m_dt_flags |= DF_BIND_NOW;
             break;
         case DT_NEEDED:
             // We handle these in for_each_needed_library
@@ -5,18 +5,27 @@
  */
 
 #include "DepthBuffer.h"
+#include <AK/NumericLimits.h>
 
 namespace GL {
 
 DepthBuffer::DepthBuffer(Gfx::IntSize const& size)
     : m_size(size)
     , m_data(new float[size.width() * size.height()])
+    , m_blocks_per_row(ceil_div(size.width(), block_size))
+    , m_block_max_depths(new float[m_blocks_per_row * ceil_div(size.height(), block_size)])
 {
+    // Nothing can be skipped until the depths have been cleared.
+    int num_blocks = m_blocks_per_row * ceil_div(size.height(), block_size);
+    for (int i = 0; i < num_blocks; ++i) {
+        m_block_max_depths[i] = NumericLimits<float>::max();
+    }
 }
 
 DepthBuffer::~DepthBuffer()
 {
     delete[] m_data;
+    delete[] m_block_max_depths;
 }
 
 float* DepthBuffer::scanline(int y)
@@ -25,12 +34,33 @@ float* DepthBuffer::scanline(int y)
     return &m_data[y * m_size.width()];
 }
 
+void DepthBuffer::update_block_max_depth(int block_x, int block_y)
+{
+    int x0 = block_x * block_size;
+    int y0 = block_y * block_size;
+    int x1 = min(x0 + block_size, m_size.width());
+    int y1 = min(y0 + block_size, m_size.height());
+
+    float max_depth = scanline(y0)[x0];
+    for (int y = y0; y < y1; ++y) {
+        auto* depth = scanline(y);
+        for (int x = x0; x < x1; ++x)
+            max_depth = max(max_depth, depth[x]);
+    }
+    m_block_max_depths[block_y * m_blocks_per_row + block_x] = max_depth;
+}
+
 void DepthBuffer::clear(float depth)
 {
     int num_entries = m_size.width() * m_size.height();
     for (int i = 0; i < num_entries; ++i) {
         m_data[i] = depth;
     }
+
+    int num_blocks = m_blocks_per_row * ceil_div(m_size.height(), block_size);
+    for (int i = 0; i < num_blocks; ++i) {
+        m_block_max_depths[i] = depth;
+    }
 }
 
 }
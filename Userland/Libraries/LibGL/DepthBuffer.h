@@ -15,13 +15,23 @@ public:
     DepthBuffer(Gfx::IntSize const&);
     ~DepthBuffer();
 
+    // The largest depth in each block of block_size by block_size pixels is kept track of, so the rasterizer can skip
+    // the blocks of a triangle that is behind everything that's been drawn there already.
+    static constexpr int block_size = 16;
+
     float* scanline(int y);
 
+    float block_max_depth(int block_x, int block_y) const { return m_block_max_depths[block_y * m_blocks_per_row + block_x]; }
+    // Has to be called after writing to the depths in a block.
+    void update_block_max_depth(int block_x, int block_y);
+
     void clear(float depth);
 
 private:
     Gfx::IntSize m_size;
     float* m_data { nullptr };
+    int m_blocks_per_row { 0 };
+    float* m_block_max_depths { nullptr };
 };
 
 }
@@ -314,6 +314,9 @@ void SoftwareGLContext::gl_end()
         m_rasterizer.submit_triangle(triangle, m_texture_units);
     }
 
+    // The queued triangles are drawn with the textures that are bound right now.
+    m_rasterizer.wait_for_all_threads();
+
     triangle_list.clear();
     processed_triangles.clear();
     vertex_list.clear();
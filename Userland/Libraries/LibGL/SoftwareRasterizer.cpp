@@ -6,28 +6,31 @@
 
 #include "SoftwareRasterizer.h"
 #include <AK/Function.h>
+#include <AK/SIMD.h>
 #include <LibGfx/Painter.h>
 #include <LibGfx/Vector2.h>
 #include <LibGfx/Vector3.h>
+#include <LibThreading/TaskGroup.h>
 
 namespace GL {
 
+using AK::SIMD::f32x4;
+using AK::SIMD::i32x4;
 using IntVector2 = Gfx::Vector2<int>;
 using IntVector3 = Gfx::Vector3<int>;
 
 static constexpr int RASTERIZER_BLOCK_SIZE = 16;
+static_assert(RASTERIZER_BLOCK_SIZE == DepthBuffer::block_size);
+static_assert(RASTERIZER_BLOCK_SIZE % 4 == 0, "Coverage is tested 4 pixels at a time");
+
+// Triangles are sorted into square tiles of this many pixels, and the tiles are drawn in parallel.
+static constexpr int RASTERIZER_TILE_SIZE = 4 * RASTERIZER_BLOCK_SIZE;
 
 constexpr static int edge_function(const IntVector2& a, const IntVector2& b, const IntVector2& c)
 {
     return ((c.x() - a.x()) * (b.y() - a.y()) - (c.y() - a.y()) * (b.x() - a.x()));
 }
 
-template<typename T>
-constexpr static T interpolate(const T& v0, const T& v1, const T& v2, const FloatVector3& barycentric_coords)
-{
-    return v0 * barycentric_coords.x() + v1 * barycentric_coords.y() + v2 * barycentric_coords.z();
-}
-
 static Gfx::RGBA32 to_rgba32(const FloatVector4& v)
 {
     auto clamped = v.clamped(0, 1);
@@ -98,8 +101,26 @@ static constexpr void setup_blend_factors(GLenum mode, FloatVector4& constant, f
     }
 }
 
+// Evaluates an edge function (or any other value that changes linearly across the screen) for the 4 pixels of a 2x2 quad.
+static f32x4 quad_values(int value, int step_x, int step_y)
+{
+    return f32x4 { (float)value, (float)(value + step_x), (float)(value + step_y), (float)(value + step_x + step_y) };
+}
+
+static f32x4 expand4(float value)
+{
+    return f32x4 { value, value, value, value };
+}
+
+// Returns the coverage of the quad whose top left pixel is at (x, y) in the block: bit 0 and 1 for the top pixels, bit 2 and 3 for the bottom ones.
+static int quad_mask(const int* pixel_mask, int x, int y)
+{
+    return ((pixel_mask[y] >> x) & 3) | (((pixel_mask[y + 1] >> x) & 3) << 2);
+}
+
+// Draws the part of the triangle that is inside tile_rect, which has to be aligned to RASTERIZER_BLOCK_SIZE.
 template<typename PS>
-static void rasterize_triangle(const RasterizerOptions& options, Gfx::Bitmap& render_target, DepthBuffer& depth_buffer, const GLTriangle& triangle, PS pixel_shader)
+static void rasterize_triangle(const RasterizerOptions& options, Gfx::Bitmap& render_target, DepthBuffer& depth_buffer, const GLTriangle& triangle, const Gfx::IntRect& tile_rect, PS pixel_shader)
 {
     // Since the algorithm is based on blocks of uniform size, we need
     // to ensure that our render_target size is actually a multiple of the block size
@@ -117,6 +138,10 @@ static void rasterize_triangle(const RasterizerOptions& options, Gfx::Bitmap& re
 
     float one_over_area = 1.0f / area;
 
+    auto const& vertex0 = triangle.vertices[0];
+    auto const& vertex1 = triangle.vertices[1];
+    auto const& vertex2 = triangle.vertices[2];
+
     FloatVector4 src_constant {};
     float src_factor_src_alpha = 0;
     float src_factor_dst_alpha = 0;
@@ -178,12 +203,15 @@ static void rasterize_triangle(const RasterizerOptions& options, Gfx::Bitmap& re
 
     // Calculate block-based bounds
     // clang-format off
-    const int bx0 = max(0,                      min(min(v0.x(), v1.x()), v2.x())                            ) / RASTERIZER_BLOCK_SIZE;
-    const int bx1 = min(render_target.width(),  max(max(v0.x(), v1.x()), v2.x()) + RASTERIZER_BLOCK_SIZE - 1) / RASTERIZER_BLOCK_SIZE;
-    const int by0 = max(0,                      min(min(v0.y(), v1.y()), v2.y())                            ) / RASTERIZER_BLOCK_SIZE;
-    const int by1 = min(render_target.height(), max(max(v0.y(), v1.y()), v2.y()) + RASTERIZER_BLOCK_SIZE - 1) / RASTERIZER_BLOCK_SIZE;
+    const int bx0 = max(tile_rect.left(),       min(min(v0.x(), v1.x()), v2.x())                            ) / RASTERIZER_BLOCK_SIZE;
+    const int bx1 = min(tile_rect.right() + 1,  max(max(v0.x(), v1.x()), v2.x()) + RASTERIZER_BLOCK_SIZE - 1) / RASTERIZER_BLOCK_SIZE;
+    const int by0 = max(tile_rect.top(),        min(min(v0.y(), v1.y()), v2.y())                            ) / RASTERIZER_BLOCK_SIZE;
+    const int by1 = min(tile_rect.bottom() + 1, max(max(v0.y(), v1.y()), v2.y()) + RASTERIZER_BLOCK_SIZE - 1) / RASTERIZER_BLOCK_SIZE;
     // clang-format on
 
+    // No pixel of the triangle is closer than its closest vertex.
+    const float min_z = min(min(vertex0.z, vertex1.z), vertex2.z);
+
     static_assert(RASTERIZER_BLOCK_SIZE < sizeof(int) * 8, "RASTERIZER_BLOCK_SIZE must be smaller than the pixel_mask's width in bits");
     int pixel_mask[RASTERIZER_BLOCK_SIZE];
 
@@ -192,6 +220,9 @@ static void rasterize_triangle(const RasterizerOptions& options, Gfx::Bitmap& re
     // Iterate over all blocks within the bounds of the triangle
     for (int by = by0; by < by1; by++) {
         for (int bx = bx0; bx < bx1; bx++) {
+            // Early z: skip the block if everything in it is in front of the triangle already
+            if (options.enable_depth_test && min_z >= depth_buffer.block_max_depth(bx, by))
+                continue;
 
             // Edge values of the 4 block corners
             // clang-format off
@@ -216,8 +247,6 @@ static void rasterize_triangle(const RasterizerOptions& options, Gfx::Bitmap& re
             // edge value derivatives
             auto dbdx = (b1 - b0) / RASTERIZER_BLOCK_SIZE;
             auto dbdy = (b2 - b0) / RASTERIZER_BLOCK_SIZE;
-            // step edge value after each horizontal span: 1 down, BLOCK_SIZE left
-            auto step_y = dbdy - dbdx * RASTERIZER_BLOCK_SIZE;
 
             int x0 = bx * RASTERIZER_BLOCK_SIZE;
             int y0 = by * RASTERIZER_BLOCK_SIZE;
@@ -230,14 +259,24 @@ static void rasterize_triangle(const RasterizerOptions& options, Gfx::Bitmap& re
                 }
             } else {
                 // The block overlaps at least one triangle edge.
-                // We need to test coverage of every pixel within the block.
+                // We need to test coverage of every pixel within the block, which we do 4 pixels at a time.
+                constexpr i32x4 lane_offsets { 0, 1, 2, 3 };
+                constexpr i32x4 lane_bits { 1, 2, 4, 8 };
+                i32x4 lane_steps_x = lane_offsets * dbdx.x();
+                i32x4 lane_steps_y = lane_offsets * dbdx.y();
+                i32x4 lane_steps_z = lane_offsets * dbdx.z();
+
                 auto coords = b0;
-                for (int y = 0; y < RASTERIZER_BLOCK_SIZE; y++, coords += step_y) {
+                for (int y = 0; y < RASTERIZER_BLOCK_SIZE; y++, coords += dbdy) {
                     pixel_mask[y] = 0;
 
-                    for (int x = 0; x < RASTERIZER_BLOCK_SIZE; x++, coords += dbdx) {
-                        if (test_point(coords))
-                            pixel_mask[y] |= 1 << x;
+                    auto span_coords = coords;
+                    for (int x = 0; x < RASTERIZER_BLOCK_SIZE; x += 4, span_coords += dbdx * 4) {
+                        i32x4 inside = (span_coords.x() + lane_steps_x >= zero.x())
+                            & (span_coords.y() + lane_steps_y >= zero.y())
+                            & (span_coords.z() + lane_steps_z >= zero.z());
+                        i32x4 bits = inside & lane_bits;
+                        pixel_mask[y] |= (bits[0] | bits[1] | bits[2] | bits[3]) << x;
                     }
                 }
             }
@@ -245,74 +284,90 @@ static void rasterize_triangle(const RasterizerOptions& options, Gfx::Bitmap& re
             // AND the depth mask onto the coverage mask
             if (options.enable_depth_test) {
                 int z_pass_count = 0;
-                auto coords = b0;
+                // The largest depth in the block can only have changed if we overwrote it.
+                float block_max_depth = depth_buffer.block_max_depth(bx, by);
+                bool overwrote_block_max_depth = false;
+
+                for (int y = 0; y < RASTERIZER_BLOCK_SIZE; y += 2) {
+                    float* depth_rows[2] = { &depth_buffer.scanline(y0 + y)[x0], &depth_buffer.scanline(y0 + y + 1)[x0] };
+                    for (int x = 0; x < RASTERIZER_BLOCK_SIZE; x += 2) {
+                        int mask = quad_mask(pixel_mask, x, y);
+                        if (mask == 0)
+                            continue;
 
-                for (int y = 0; y < RASTERIZER_BLOCK_SIZE; y++, coords += step_y) {
-                    if (pixel_mask[y] == 0) {
-                        coords += dbdx * RASTERIZER_BLOCK_SIZE;
-                        continue;
-                    }
+                        auto coords = b0 + dbdx * x + dbdy * y;
+                        f32x4 z = quad_values(coords.x(), dbdx.x(), dbdy.x()) * one_over_area * vertex0.z
+                            + quad_values(coords.y(), dbdx.y(), dbdy.y()) * one_over_area * vertex1.z
+                            + quad_values(coords.z(), dbdx.z(), dbdy.z()) * one_over_area * vertex2.z;
 
-                    auto* depth = &depth_buffer.scanline(y0 + y)[x0];
-                    for (int x = 0; x < RASTERIZER_BLOCK_SIZE; x++, coords += dbdx, depth++) {
-                        if (~pixel_mask[y] & (1 << x))
-                            continue;
+                        for (int i = 0; i < 4; i++) {
+                            if (~mask & (1 << i))
+                                continue;
 
-                        auto barycentric = FloatVector3(coords.x(), coords.y(), coords.z()) * one_over_area;
-                        float z = interpolate(triangle.vertices[0].z, triangle.vertices[1].z, triangle.vertices[2].z, barycentric);
-                        if (z >= *depth) {
-                            pixel_mask[y] ^= 1 << x;
-                            continue;
-                        }
+                            auto& depth = depth_rows[i / 2][x + i % 2];
+                            if (z[i] >= depth) {
+                                pixel_mask[y + i / 2] ^= 1 << (x + i % 2);
+                                continue;
+                            }
 
-                        *depth = z;
-                        z_pass_count++;
+                            overwrote_block_max_depth |= depth >= block_max_depth;
+                            depth = z[i];
+                            z_pass_count++;
+                        }
                     }
                 }
 
                 // Nice, no pixels passed the depth test -> block rejected by early z
                 if (z_pass_count == 0)
                     continue;
-            }
 
-            // Draw the pixels according to the previously generated mask
-            auto coords = b0;
-            for (int y = 0; y < RASTERIZER_BLOCK_SIZE; y++, coords += step_y) {
-                if (pixel_mask[y] == 0) {
-                    coords += dbdx * RASTERIZER_BLOCK_SIZE;
-                    continue;
-                }
+                if (overwrote_block_max_depth)
+                    depth_buffer.update_block_max_depth(bx, by);
+            }
 
-                auto* pixel = pixel_buffer[y];
-                for (int x = 0; x < RASTERIZER_BLOCK_SIZE; x++, coords += dbdx, pixel++) {
-                    if (~pixel_mask[y] & (1 << x))
+            // Draw the pixels according to the previously generated mask, a 2x2 quad at a time
+            for (int y = 0; y < RASTERIZER_BLOCK_SIZE; y += 2) {
+                for (int x = 0; x < RASTERIZER_BLOCK_SIZE; x += 2) {
+                    int mask = quad_mask(pixel_mask, x, y);
+                    if (mask == 0)
                         continue;
 
+                    auto coords = b0 + dbdx * x + dbdy * y;
+                    f32x4 barycentric_x = quad_values(coords.x(), dbdx.x(), dbdy.x()) * one_over_area;
+                    f32x4 barycentric_y = quad_values(coords.y(), dbdx.y(), dbdy.y()) * one_over_area;
+                    f32x4 barycentric_z = quad_values(coords.z(), dbdx.z(), dbdy.z()) * one_over_area;
+
                     // Perspective correct barycentric coordinates
-                    auto barycentric = FloatVector3(coords.x(), coords.y(), coords.z()) * one_over_area;
-                    float interpolated_reciprocal_w = interpolate(triangle.vertices[0].w, triangle.vertices[1].w, triangle.vertices[2].w, barycentric);
-                    float interpolated_w = 1 / interpolated_reciprocal_w;
-                    barycentric = barycentric * FloatVector3(triangle.vertices[0].w, triangle.vertices[1].w, triangle.vertices[2].w) * interpolated_w;
+                    f32x4 interpolated_reciprocal_w = barycentric_x * vertex0.w + barycentric_y * vertex1.w + barycentric_z * vertex2.w;
+                    f32x4 interpolated_w = 1.0f / interpolated_reciprocal_w;
+                    barycentric_x = barycentric_x * vertex0.w * interpolated_w;
+                    barycentric_y = barycentric_y * vertex1.w * interpolated_w;
+                    barycentric_z = barycentric_z * vertex2.w * interpolated_w;
+
+                    auto quad_interpolate = [&](float value0, float value1, float value2) {
+                        return barycentric_x * value0 + barycentric_y * value1 + barycentric_z * value2;
+                    };
 
                     // FIXME: make this more generic. We want to interpolate more than just color and uv
-                    FloatVector4 vertex_color;
+                    f32x4 r, g, b, a;
                     if (options.shade_smooth) {
-                        vertex_color = interpolate(
-                            FloatVector4(triangle.vertices[0].r, triangle.vertices[0].g, triangle.vertices[0].b, triangle.vertices[0].a),
-                            FloatVector4(triangle.vertices[1].r, triangle.vertices[1].g, triangle.vertices[1].b, triangle.vertices[1].a),
-                            FloatVector4(triangle.vertices[2].r, triangle.vertices[2].g, triangle.vertices[2].b, triangle.vertices[2].a),
-                            barycentric);
+                        r = quad_interpolate(vertex0.r, vertex1.r, vertex2.r);
+                        g = quad_interpolate(vertex0.g, vertex1.g, vertex2.g);
+                        b = quad_interpolate(vertex0.b, vertex1.b, vertex2.b);
+                        a = quad_interpolate(vertex0.a, vertex1.a, vertex2.a);
                     } else {
-                        vertex_color = { triangle.vertices[0].r, triangle.vertices[0].g, triangle.vertices[0].b, triangle.vertices[0].a };
+                        r = expand4(vertex0.r);
+                        g = expand4(vertex0.g);
+                        b = expand4(vertex0.b);
+                        a = expand4(vertex0.a);
                     }
+                    f32x4 u = quad_interpolate(vertex0.u, vertex1.u, vertex2.u);
+                    f32x4 v = quad_interpolate(vertex0.v, vertex1.v, vertex2.v);
 
-                    auto uv = interpolate(
-                        FloatVector2(triangle.vertices[0].u, triangle.vertices[0].v),
-                        FloatVector2(triangle.vertices[1].u, triangle.vertices[1].v),
-                        FloatVector2(triangle.vertices[2].u, triangle.vertices[2].v),
-                        barycentric);
-
-                    *pixel = pixel_shader(uv, vertex_color);
+                    for (int i = 0; i < 4; i++) {
+                        if (mask & (1 << i))
+                            pixel_buffer[y + i / 2][x + i % 2] = pixel_shader(FloatVector2(u[i], v[i]), FloatVector4(r[i], g[i], b[i], a[i]));
+                    }
                 }
             }
 
@@ -416,30 +471,93 @@ SoftwareRasterizer::SoftwareRasterizer(const Gfx::IntSize& min_size)
 
 void SoftwareRasterizer::submit_triangle(const GLTriangle& triangle)
 {
-    rasterize_triangle(m_options, *m_render_target, *m_depth_buffer, triangle, [](const FloatVector2&, const FloatVector4& color) -> FloatVector4 {
-        return color;
-    });
+    if (m_queued_texture_units)
+        draw_queued_triangles();
+    m_queued_triangles.append(triangle);
 }
 
 void SoftwareRasterizer::submit_triangle(const GLTriangle& triangle, const Array<TextureUnit, 32>& texture_units)
 {
-    rasterize_triangle(m_options, *m_render_target, *m_depth_buffer, triangle, [&texture_units](const FloatVector2& uv, const FloatVector4& color) -> FloatVector4 {
-        // TODO: We'd do some kind of multitexturing/blending here
-        // Construct a vector for the texel we want to sample
-        FloatVector4 texel = color;
+    if (m_queued_texture_units != &texture_units)
+        draw_queued_triangles();
+    m_queued_texture_units = &texture_units;
+    m_queued_triangles.append(triangle);
+}
+
+void SoftwareRasterizer::draw_queued_triangles()
+{
+    if (m_queued_triangles.is_empty()) {
+        m_queued_texture_units = nullptr;
+        return;
+    }
 
-        for (const auto& texture_unit : texture_units) {
+    // Sort the triangles into the tiles that their bounding boxes overlap. Each tile keeps them in the order they
+    // were submitted in, so blending and depth testing work out the same as when drawing them one by one.
+    int tile_columns = ceil_div(m_render_target->width(), RASTERIZER_TILE_SIZE);
+    int tile_rows = ceil_div(m_render_target->height(), RASTERIZER_TILE_SIZE);
+    m_tile_bins.resize(tile_columns * tile_rows);
+
+    for (size_t i = 0; i < m_queued_triangles.size(); ++i) {
+        auto& vertices = m_queued_triangles[i].vertices;
+        int min_x = min(min((int)vertices[0].x, (int)vertices[1].x), (int)vertices[2].x);
+        int max_x = max(max((int)vertices[0].x, (int)vertices[1].x), (int)vertices[2].x);
+        int min_y = min(min((int)vertices[0].y, (int)vertices[1].y), (int)vertices[2].y);
+        int max_y = max(max((int)vertices[0].y, (int)vertices[1].y), (int)vertices[2].y);
+
+        int first_column = max(min_x, 0) / RASTERIZER_TILE_SIZE;
+        int last_column = min(max_x / RASTERIZER_TILE_SIZE, tile_columns - 1);
+        int first_row = max(min_y, 0) / RASTERIZER_TILE_SIZE;
+        int last_row = min(max_y / RASTERIZER_TILE_SIZE, tile_rows - 1);
+        for (int row = first_row; row <= last_row; ++row) {
+            for (int column = first_column; column <= last_column; ++column)
+                m_tile_bins[row * tile_columns + column].append(i);
+        }
+    }
 
-            // No texture is bound to this texture unit
-            if (!texture_unit.is_bound())
-                continue;
+    auto draw_tile = [&](size_t tile, auto pixel_shader) {
+        auto& bin = m_tile_bins[tile];
+        Gfx::IntRect tile_rect {
+            (int)(tile % tile_columns) * RASTERIZER_TILE_SIZE,
+            (int)(tile / tile_columns) * RASTERIZER_TILE_SIZE,
+            RASTERIZER_TILE_SIZE,
+            RASTERIZER_TILE_SIZE
+        };
+        tile_rect.intersect(m_render_target->rect());
+        for (auto index : bin)
+            rasterize_triangle(m_options, *m_render_target, *m_depth_buffer, m_queued_triangles[index], tile_rect, pixel_shader);
+        bin.clear_with_capacity();
+    };
 
-            // FIXME: Don't assume Texture2D, _and_ work out how we blend/do multitexturing properly.....
-            texel = texel * static_ptr_cast<Texture2D>(texture_unit.bound_texture())->sample_texel(uv);
+    Threading::parallel_for(0, m_tile_bins.size(), [&](size_t tile) {
+        if (!m_queued_texture_units) {
+            draw_tile(tile, [](const FloatVector2&, const FloatVector4& color) -> FloatVector4 {
+                return color;
+            });
+            return;
         }
 
-        return texel;
+        draw_tile(tile, [&texture_units = *m_queued_texture_units](const FloatVector2& uv, const FloatVector4& color) -> FloatVector4 {
+            // TODO: We'd do some kind of multitexturing/blending here
+            // Construct a vector for the texel we want to sample
+            FloatVector4 texel = color;
+
+            for (const auto& texture_unit : texture_units) {
+
+                // No texture is bound to this texture unit
+                if (!texture_unit.is_bound())
+                    continue;
+
+                // FIXME: Don't assume Texture2D, _and_ work out how we blend/do multitexturing properly.....
+                // Going through a reference rather than a RefPtr keeps the tiles from fighting over the reference count.
+                texel = texel * static_cast<const Texture2D&>(*texture_unit.bound_texture()).sample_texel(uv);
+            }
+
+            return texel;
+        });
     });
+
+    m_queued_triangles.clear_with_capacity();
+    m_queued_texture_units = nullptr;
 }
 
 void SoftwareRasterizer::resize(const Gfx::IntSize& min_size)
@@ -477,9 +595,9 @@ void SoftwareRasterizer::blit_to(Gfx::Bitmap& target)
     painter.blit({ 0, 0 }, *m_render_target, m_render_target->rect(), 1.0f, false);
 }
 
-void SoftwareRasterizer::wait_for_all_threads() const
+void SoftwareRasterizer::wait_for_all_threads()
 {
-    // FIXME: Wait for all render threads to finish when multithreading is being implemented
+    draw_queued_triangles();
 }
 
 void SoftwareRasterizer::set_options(const RasterizerOptions& options)
@@ -487,12 +605,12 @@ void SoftwareRasterizer::set_options(const RasterizerOptions& options)
     wait_for_all_threads();
 
     m_options = options;
-
-    // FIXME: Recreate or reinitialize render threads here when multithreading is being implemented
 }
 
 Gfx::RGBA32 SoftwareRasterizer::get_backbuffer_pixel(int x, int y)
 {
+    wait_for_all_threads();
+
     // FIXME: Reading individual pixels is very slow, rewrite this to transfer whole blocks
     if (x < 0 || y < 0 || x >= m_render_target->width() || y >= m_render_target->height())
         return 0;
@@ -502,6 +620,8 @@ Gfx::RGBA32 SoftwareRasterizer::get_backbuffer_pixel(int x, int y)
 
 float SoftwareRasterizer::get_depthbuffer_value(int x, int y)
 {
+    wait_for_all_threads();
+
     // FIXME: Reading individual pixels is very slow, rewrite this to transfer whole blocks
     if (x < 0 || y < 0 || x >= m_render_target->width() || y >= m_render_target->height())
         return 1.0f;
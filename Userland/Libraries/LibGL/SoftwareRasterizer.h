@@ -13,6 +13,7 @@
 #include "Tex/TextureUnit.h"
 #include <AK/Array.h>
 #include <AK/OwnPtr.h>
+#include <AK/Vector.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/Vector4.h>
 
@@ -29,6 +30,8 @@ struct RasterizerOptions {
     GLenum blend_destination_factor { GL_ONE };
 };
 
+// Triangles are queued up and drawn in tiles, spread across the ThreadPool, once something needs to see the result:
+// a change of options, a clear, reading back pixels, or the end of the draw call that submitted them.
 class SoftwareRasterizer final {
 public:
     SoftwareRasterizer(const Gfx::IntSize& min_size);
@@ -39,16 +42,23 @@ public:
     void clear_color(const FloatVector4&);
     void clear_depth(float);
     void blit_to(Gfx::Bitmap&);
-    void wait_for_all_threads() const;
+    void wait_for_all_threads();
     void set_options(const RasterizerOptions&);
     RasterizerOptions options() const { return m_options; }
     Gfx::RGBA32 get_backbuffer_pixel(int x, int y);
     float get_depthbuffer_value(int x, int y);
 
 private:
+    void draw_queued_triangles();
+
     RefPtr<Gfx::Bitmap> m_render_target;
     OwnPtr<DepthBuffer> m_depth_buffer;
     RasterizerOptions m_options;
+
+    Vector<GLTriangle> m_queued_triangles;
+    // The texture units that the queued triangles are sampled from, if any.
+    const Array<TextureUnit, 32>* m_queued_texture_units { nullptr };
+    Vector<Vector<u32>> m_tile_bins;
 };
 
 }
@@ -37,6 +37,10 @@ enum class BitmapFormat {
     BGRx8888,
     BGRA8888,
     RGBA8888,
+    // Like BGRA8888, but with every color channel already multiplied by alpha. Blending such a bitmap is a single
+    // multiply-add per channel, so it suits bitmaps that are drawn much more often than they change. Painter can only
+    // draw these, not draw onto them.
+    BGRA8888Premultiplied,
 };
 
 inline bool is_valid_bitmap_format(unsigned format)
@@ -50,6 +54,7 @@ inline bool is_valid_bitmap_format(unsigned format)
     case (unsigned)BitmapFormat::BGRx8888:
     case (unsigned)BitmapFormat::BGRA8888:
     case (unsigned)BitmapFormat::RGBA8888:
+    case (unsigned)BitmapFormat::BGRA8888Premultiplied:
         return true;
     }
     return false;
@@ -60,6 +65,7 @@ enum class StorageFormat {
     BGRx8888,
     BGRA8888,
     RGBA8888,
+    BGRA8888Premultiplied,
 };
 
 static StorageFormat determine_storage_format(BitmapFormat format)
@@ -71,6 +77,8 @@ static StorageFormat determine_storage_format(BitmapFormat format)
         return StorageFormat::BGRA8888;
     case BitmapFormat::RGBA8888:
         return StorageFormat::RGBA8888;
+    case BitmapFormat::BGRA8888Premultiplied:
+        return StorageFormat::BGRA8888Premultiplied;
     case BitmapFormat::Indexed1:
     case BitmapFormat::Indexed2:
     case BitmapFormat::Indexed4:
@@ -181,6 +189,7 @@ public:
             return 8;
         case BitmapFormat::BGRx8888:
         case BitmapFormat::BGRA8888:
+        case BitmapFormat::BGRA8888Premultiplied:
             return 32;
         default:
             VERIFY_NOT_REACHED();
@@ -198,7 +207,7 @@ public:
 
     void fill(Color);
 
-    [[nodiscard]] bool has_alpha_channel() const { return m_format == BitmapFormat::BGRA8888; }
+    [[nodiscard]] bool has_alpha_channel() const { return m_format == BitmapFormat::BGRA8888 || m_format == BitmapFormat::BGRA8888Premultiplied; }
     [[nodiscard]] BitmapFormat format() const { return m_format; }
 
     void set_mmap_name(String const&);
@@ -291,6 +300,13 @@ inline Color Bitmap::get_pixel<StorageFormat::BGRA8888>(int x, int y) const
     return Color::from_rgba(scanline(y)[x]);
 }
 
+template<>
+inline Color Bitmap::get_pixel<StorageFormat::BGRA8888Premultiplied>(int x, int y) const
+{
+    VERIFY(x >= 0 && x < physical_width());
+    return Color::from_premultiplied(scanline(y)[x]);
+}
+
 template<>
 inline Color Bitmap::get_pixel<StorageFormat::Indexed8>(int x, int y) const
 {
@@ -305,6 +321,8 @@ inline Color Bitmap::get_pixel(int x, int y) const
         return get_pixel<StorageFormat::BGRx8888>(x, y);
     case StorageFormat::BGRA8888:
         return get_pixel<StorageFormat::BGRA8888>(x, y);
+    case StorageFormat::BGRA8888Premultiplied:
+        return get_pixel<StorageFormat::BGRA8888Premultiplied>(x, y);
     case StorageFormat::Indexed8:
         return get_pixel<StorageFormat::Indexed8>(x, y);
     default:
@@ -324,6 +342,12 @@ inline void Bitmap::set_pixel<StorageFormat::BGRA8888>(int x, int y, Color color
     VERIFY(x >= 0 && x < physical_width());
     scanline(y)[x] = color.value(); // drop alpha
 }
+template<>
+inline void Bitmap::set_pixel<StorageFormat::BGRA8888Premultiplied>(int x, int y, Color color)
+{
+    VERIFY(x >= 0 && x < physical_width());
+    scanline(y)[x] = color.premultiplied_value();
+}
 inline void Bitmap::set_pixel(int x, int y, Color color)
 {
     switch (determine_storage_format(m_format)) {
@@ -333,6 +357,9 @@ inline void Bitmap::set_pixel(int x, int y, Color color)
     case StorageFormat::BGRA8888:
         set_pixel<StorageFormat::BGRA8888>(x, y, color);
         break;
+    case StorageFormat::BGRA8888Premultiplied:
+        set_pixel<StorageFormat::BGRA8888Premultiplied>(x, y, color);
+        break;
     case StorageFormat::Indexed8:
         VERIFY_NOT_REACHED();
     default:
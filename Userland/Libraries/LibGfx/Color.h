@@ -71,6 +71,16 @@ public:
     static constexpr Color from_rgb(unsigned rgb) { return Color(rgb | 0xff000000); }
     static constexpr Color from_rgba(unsigned rgba) { return Color(rgba); }
 
+    // In a premultiplied pixel, each color channel has already been multiplied by alpha.
+    static constexpr Color from_premultiplied(RGBA32 premultiplied)
+    {
+        u8 alpha = premultiplied >> 24;
+        if (!alpha)
+            return Color(0, 0, 0, 0);
+        auto unpremultiply = [&](u8 channel) { return (u8)min(255, (channel * 255 + alpha / 2) / alpha); };
+        return Color(unpremultiply((premultiplied >> 16) & 0xff), unpremultiply((premultiplied >> 8) & 0xff), unpremultiply(premultiplied & 0xff), alpha);
+    }
+
     static constexpr Color from_cmyk(float c, float m, float y, float k)
     {
         auto r = static_cast<u8>(255.0f * (1.0f - c) * (1.0f - k));
@@ -249,6 +259,12 @@ public:
 
     constexpr RGBA32 value() const { return m_value; }
 
+    constexpr RGBA32 premultiplied_value() const
+    {
+        auto premultiply = [&](u8 channel) { return (u32)(channel * alpha() + 127) / 255; };
+        return ((u32)alpha() << 24) | (premultiply(red()) << 16) | (premultiply(green()) << 8) | premultiply(blue());
+    }
+
     constexpr bool operator==(const Color& other) const
     {
         return m_value == other.m_value;
@@ -6,8 +6,10 @@
 
 #pragma once
 
-#include <LibCore/ElapsedTimer.h>
+#include <AK/SIMD.h>
+#include <AK/Vector.h>
 #include <LibGfx/Bitmap.h>
+#include <LibThreading/TaskGroup.h>
 
 namespace Gfx {
 
@@ -19,92 +21,70 @@ public:
     }
 
     // Based on the super fast blur algorithm by Quasimondo, explored here: https://stackoverflow.com/questions/21418892/understanding-super-fast-blur-algorithm
+    // The rows and then the columns are spread across the ThreadPool, and all four channels of a pixel are summed at once.
     void apply_single_pass(int radius)
     {
         VERIFY(radius >= 0);
         VERIFY(m_bitmap.format() == BitmapFormat::BGRA8888);
 
-        int height = m_bitmap.height();
-        int width = m_bitmap.width();
-
-        int div = 2 * radius + 1;
-
-        size_t sum_red, sum_green, sum_blue, sum_alpha;
-
-        u8 intermediate_red[width * height];
-        u8 intermediate_green[width * height];
-        u8 intermediate_blue[width * height];
-        u8 intermediate_alpha[width * height];
-
-        // First pass: vertical
-        for (int y = 0; y < height; y++) {
-            sum_red = sum_green = sum_blue = sum_alpha = 0;
-            // Setup sliding window
-            for (int i = -radius; i <= radius; i++) {
-                auto color_at_px = m_bitmap.get_pixel(clamp(i, 0, width - 1), y);
-                sum_red += red_value(color_at_px);
-                sum_green += green_value(color_at_px);
-                sum_blue += blue_value(color_at_px);
-                sum_alpha += color_at_px.alpha();
-            }
-            // Slide horizontally
-            for (int x = 0; x < width; x++) {
-                intermediate_red[y * width + x] = (sum_red / div);
-                intermediate_green[y * width + x] = (sum_green / div);
-                intermediate_blue[y * width + x] = (sum_blue / div);
-                intermediate_alpha[y * width + x] = (sum_alpha / div);
-
-                auto leftmost_x_coord = max(x - radius, 0);
-                auto rightmost_x_coord = min(x + radius + 1, width - 1);
-
-                auto leftmost_x_color = m_bitmap.get_pixel(leftmost_x_coord, y);
-                auto rightmost_x_color = m_bitmap.get_pixel(rightmost_x_coord, y);
-
-                sum_red -= red_value(leftmost_x_color);
-                sum_red += red_value(rightmost_x_color);
-                sum_green -= green_value(leftmost_x_color);
-                sum_green += green_value(rightmost_x_color);
-                sum_blue -= blue_value(leftmost_x_color);
-                sum_blue += blue_value(rightmost_x_color);
-                sum_alpha -= leftmost_x_color.alpha();
-                sum_alpha += rightmost_x_color.alpha();
-            }
-        }
+        int height = m_bitmap.physical_height();
+        int width = m_bitmap.physical_width();
+        if (width == 0 || height == 0)
+            return;
 
-        // Second pass: horizontal
-        for (int x = 0; x < width; x++) {
-            sum_red = sum_green = sum_blue = sum_alpha = 0;
-            // Setup sliding window
-            for (int i = -radius; i <= radius; i++) {
-                int offset = clamp(i, 0, height - 1) * width + x;
-                sum_red += intermediate_red[offset];
-                sum_green += intermediate_green[offset];
-                sum_blue += intermediate_blue[offset];
-                sum_alpha += intermediate_alpha[offset];
-            }
-
-            for (int y = 0; y < height; y++) {
-                auto color = Color(
-                    sum_red / div,
-                    sum_green / div,
-                    sum_blue / div,
-                    sum_alpha / div);
-
-                m_bitmap.set_pixel(x, y, color);
-
-                auto topmost_y_coord = max(y - radius, 0);
-                auto bottommost_y_coord = min(y + radius + 1, height - 1);
-
-                sum_red += intermediate_red[x + bottommost_y_coord * width];
-                sum_red -= intermediate_red[x + topmost_y_coord * width];
-                sum_green += intermediate_green[x + bottommost_y_coord * width];
-                sum_green -= intermediate_green[x + topmost_y_coord * width];
-                sum_blue += intermediate_blue[x + bottommost_y_coord * width];
-                sum_blue -= intermediate_blue[x + topmost_y_coord * width];
-                sum_alpha += intermediate_alpha[x + bottommost_y_coord * width];
-                sum_alpha -= intermediate_alpha[x + topmost_y_coord * width];
-            }
-        }
+        Divider divide(2 * radius + 1);
+        Vector<RGBA32> intermediate;
+        intermediate.resize(width * height);
+
+        // First pass: horizontal
+        Threading::parallel_for(
+            0, height, [&](size_t y) {
+                auto const* source = m_bitmap.scanline(y);
+                auto* destination = &intermediate[y * width];
+
+                // Setup sliding window
+                u32x4 sum {};
+                for (int i = -radius; i <= radius; i++)
+                    sum += source_channels_of(source[clamp(i, 0, width - 1)]);
+
+                // Slide horizontally
+                for (int x = 0; x < width; x++) {
+                    destination[x] = pixel_from(divide(sum));
+                    sum += source_channels_of(source[min(x + radius + 1, width - 1)]);
+                    sum -= source_channels_of(source[max(x - radius, 0)]);
+                }
+            },
+            max(pixels_per_task / width, 1));
+
+        // Second pass: vertical, on a band of columns at a time so the rows are still read front to back.
+        int band_count = ceil_div(width, columns_per_band);
+        Threading::parallel_for(
+            0, band_count, [&](size_t band) {
+                int band_start = band * columns_per_band;
+                int band_width = min(columns_per_band, width - band_start);
+                auto row = [&](int y) { return &intermediate[y * width + band_start]; };
+
+                // Setup sliding windows
+                u32x4 sums[columns_per_band] {};
+                for (int i = -radius; i <= radius; i++) {
+                    auto const* pixels = row(clamp(i, 0, height - 1));
+                    for (int x = 0; x < band_width; x++)
+                        sums[x] += channels_of(pixels[x]);
+                }
+
+                // Slide vertically
+                for (int y = 0; y < height; y++) {
+                    auto* destination = m_bitmap.scanline(y) + band_start;
+                    auto const* bottommost = row(min(y + radius + 1, height - 1));
+                    auto const* topmost = row(max(y - radius, 0));
+                    for (int x = 0; x < band_width; x++) {
+                        destination[x] = pixel_from(divide(sums[x]));
+                        sums[x] += channels_of(bottommost[x]);
+                        sums[x] -= channels_of(topmost[x]);
+                    }
+                }
+            },
+            max(pixels_per_task / (columns_per_band * height), 1));
     }
 
     // Math from here: http://blog.ivank.net/fastest-gaussian-blur.html
@@ -131,17 +111,53 @@ public:
     }
 
 private:
-    ALWAYS_INLINE static u8 red_value(Color const& color)
+    using u32x4 = AK::SIMD::u32x4;
+    using u8x4 = AK::SIMD::u8x4;
+
+    static constexpr int pixels_per_task = 16384;
+    static constexpr int columns_per_band = 16;
+
+    // Divides all four sums by the size of the window, by multiplying with a 24-bit reciprocal instead where that gives
+    // the same result.
+    class Divider {
+    public:
+        explicit Divider(u32 divisor)
+            : m_divisor(divisor)
+            , m_reciprocal(ceil_div(1u << 24, divisor))
+        {
+        }
+
+        ALWAYS_INLINE u32x4 operator()(u32x4 sums) const
+        {
+            if (m_divisor <= 256)
+                return (sums * m_reciprocal) >> 24;
+            return sums / m_divisor;
+        }
+
+    private:
+        u32 m_divisor { 1 };
+        u32 m_reciprocal { 0 };
+    };
+
+    ALWAYS_INLINE static u32x4 channels_of(RGBA32 pixel)
     {
-        return (color.alpha() == 0) ? 0xFF : color.red();
+        u8x4 bytes;
+        __builtin_memcpy(&bytes, &pixel, sizeof(pixel));
+        return __builtin_convertvector(bytes, u32x4);
     }
-    ALWAYS_INLINE static u8 green_value(Color const& color)
+
+    // Fully transparent pixels of the original image count as white.
+    ALWAYS_INLINE static u32x4 source_channels_of(RGBA32 pixel)
     {
-        return (color.alpha() == 0) ? 0xFF : color.green();
+        return channels_of(pixel >> 24 ? pixel : 0x00ffffff);
     }
-    ALWAYS_INLINE static u8 blue_value(Color const& color)
+
+    ALWAYS_INLINE static RGBA32 pixel_from(u32x4 channels)
     {
-        return (color.alpha() == 0) ? 0xFF : color.blue();
+        auto bytes = __builtin_convertvector(channels, u8x4);
+        RGBA32 pixel;
+        __builtin_memcpy(&pixel, &bytes, sizeof(pixel));
+        return pixel;
     }
 
     Bitmap& m_bitmap;
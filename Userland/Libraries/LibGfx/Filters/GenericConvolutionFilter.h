@@ -7,8 +7,13 @@
 #pragma once
 
 #include "Filter.h"
+#include <AK/Array.h>
+#include <AK/Optional.h>
+#include <AK/Vector.h>
 #include <LibGfx/Matrix.h>
 #include <LibGfx/Matrix4x4.h>
+#include <LibThreading/TaskGroup.h>
+#include <math.h>
 
 namespace Gfx {
 
@@ -100,53 +105,155 @@ public:
 
         Bitmap* render_target_bitmap = (&target != &source) ? &target : apply_cache.m_target.ptr();
 
-        // FIXME: Help! I am naive!
-        constexpr static ssize_t offset = N / 2;
-        for (auto i_ = 0; i_ < target_rect.width(); ++i_) {
-            ssize_t i = i_ + target_rect.x();
-            for (auto j_ = 0; j_ < target_rect.height(); ++j_) {
-                ssize_t j = j_ + target_rect.y();
-                FloatVector3 value(0, 0, 0);
-                for (auto k = 0l; k < (ssize_t)N; ++k) {
-                    auto ki = i + k - offset;
-                    if (ki < source_rect.x() || ki > source_rect.right()) {
-                        if (parameters.should_wrap())
-                            ki = (ki + source.size().width()) % source.size().width(); // TODO: fix up using source_rect
-                        else
+        Optional<SeparatedKernel> separated_kernel;
+        if (!parameters.should_wrap())
+            separated_kernel = separate(parameters.kernel());
+        if (separated_kernel.has_value())
+            apply_separated(*render_target_bitmap, target_rect, source, source_rect, source_delta_x, source_delta_y, *separated_kernel);
+        else
+            apply_naive(*render_target_bitmap, target_rect, source, source_rect, source_delta_x, source_delta_y, parameters);
+
+        if (render_target_bitmap != &target) {
+            // FIXME: Substitute for some sort of faster "blit" method.
+            for (auto i_ = 0; i_ < target_rect.width(); ++i_) {
+                auto i = i_ + target_rect.x();
+                for (auto j_ = 0; j_ < target_rect.height(); ++j_) {
+                    auto j = j_ + target_rect.y();
+                    target.set_pixel(i, j, render_target_bitmap->get_pixel(i_, j_));
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr ssize_t offset = N / 2;
+    static constexpr int pixels_per_task = 4096;
+
+    // A kernel that is the outer product of a horizontal and a vertical one, like a Gaussian or a box blur, can be
+    // applied as a horizontal pass followed by a vertical one, which takes 2N instead of N*N samples per pixel.
+    struct SeparatedKernel {
+        Array<float, N> horizontal;
+        Array<float, N> vertical;
+    };
+
+    static Optional<SeparatedKernel> separate(const Gfx::Matrix<N, float>& kernel)
+    {
+        auto elements = kernel.elements();
+        size_t pivot_k = 0;
+        size_t pivot_l = 0;
+        for (size_t k = 0; k < N; ++k) {
+            for (size_t l = 0; l < N; ++l) {
+                if (fabsf(elements[k][l]) > fabsf(elements[pivot_k][pivot_l])) {
+                    pivot_k = k;
+                    pivot_l = l;
+                }
+            }
+        }
+        auto pivot = elements[pivot_k][pivot_l];
+        if (pivot == 0)
+            return {};
+
+        SeparatedKernel separated;
+        for (size_t i = 0; i < N; ++i) {
+            separated.horizontal[i] = elements[i][pivot_l];
+            separated.vertical[i] = elements[pivot_k][i] / pivot;
+        }
+        for (size_t k = 0; k < N; ++k) {
+            for (size_t l = 0; l < N; ++l) {
+                if (fabsf(elements[k][l] - separated.horizontal[k] * separated.vertical[l]) > fabsf(pivot) * 1e-5f)
+                    return {};
+            }
+        }
+        return separated;
+    }
+
+    static void apply_separated(Bitmap& render_target_bitmap, const IntRect& target_rect, const Bitmap& source, const IntRect& source_rect, int source_delta_x, int source_delta_y, const SeparatedKernel& kernel)
+    {
+        // The horizontal pass covers every row that the vertical pass reads from.
+        int first_row = max(target_rect.y() - (int)offset, source_rect.y());
+        int row_count = min(target_rect.bottom() + (int)offset, source_rect.bottom()) - first_row + 1;
+        int width = target_rect.width();
+        int grain_size = max(pixels_per_task / max(width, 1), 1);
+
+        Vector<FloatVector3> rows;
+        rows.resize(row_count * width);
+        Threading::parallel_for(
+            0, row_count, [&](size_t row) {
+                int j = first_row + row;
+                for (auto i_ = 0; i_ < width; ++i_) {
+                    ssize_t i = i_ + target_rect.x();
+                    FloatVector3 value(0, 0, 0);
+                    for (auto k = 0l; k < (ssize_t)N; ++k) {
+                        auto ki = i + k - offset;
+                        if (ki < source_rect.x() || ki > source_rect.right())
                             continue;
+                        auto pixel = source.get_pixel(ki, j);
+                        value = value + FloatVector3(pixel.red(), pixel.green(), pixel.blue()) * kernel.horizontal[k];
                     }
+                    rows[row * width + i_] = value;
+                }
+            },
+            grain_size);
 
+        Threading::parallel_for(
+            0, target_rect.height(), [&](size_t j_) {
+                ssize_t j = j_ + target_rect.y();
+                for (auto i_ = 0; i_ < width; ++i_) {
+                    ssize_t i = i_ + target_rect.x();
+                    FloatVector3 value(0, 0, 0);
                     for (auto l = 0l; l < (ssize_t)N; ++l) {
                         auto lj = j + l - offset;
-                        if (lj < source_rect.y() || lj > source_rect.bottom()) {
+                        if (lj < source_rect.y() || lj > source_rect.bottom())
+                            continue;
+                        value = value + rows[(lj - first_row) * width + i_] * kernel.vertical[l];
+                    }
+
+                    value.clamp(0, 255);
+                    render_target_bitmap.set_pixel(i, j, Color(value.x(), value.y(), value.z(), source.get_pixel(i + source_delta_x, j + source_delta_y).alpha()));
+                }
+            },
+            grain_size);
+    }
+
+    static void apply_naive(Bitmap& render_target_bitmap, const IntRect& target_rect, const Bitmap& source, const IntRect& source_rect, int source_delta_x, int source_delta_y, const GenericConvolutionFilter::Parameters& parameters)
+    {
+        // FIXME: Help! I am naive!
+        Threading::parallel_for(
+            0, target_rect.width(), [&](size_t i_) {
+                ssize_t i = i_ + target_rect.x();
+                for (auto j_ = 0; j_ < target_rect.height(); ++j_) {
+                    ssize_t j = j_ + target_rect.y();
+                    FloatVector3 value(0, 0, 0);
+                    for (auto k = 0l; k < (ssize_t)N; ++k) {
+                        auto ki = i + k - offset;
+                        if (ki < source_rect.x() || ki > source_rect.right()) {
                             if (parameters.should_wrap())
-                                lj = (lj + source.size().height()) % source.size().height(); // TODO: fix up using source_rect
+                                ki = (ki + source.size().width()) % source.size().width(); // TODO: fix up using source_rect
                             else
                                 continue;
                         }
 
-                        auto pixel = source.get_pixel(ki, lj);
-                        FloatVector3 pixel_value(pixel.red(), pixel.green(), pixel.blue());
+                        for (auto l = 0l; l < (ssize_t)N; ++l) {
+                            auto lj = j + l - offset;
+                            if (lj < source_rect.y() || lj > source_rect.bottom()) {
+                                if (parameters.should_wrap())
+                                    lj = (lj + source.size().height()) % source.size().height(); // TODO: fix up using source_rect
+                                else
+                                    continue;
+                            }
 
-                        value = value + pixel_value * parameters.kernel().elements()[k][l];
-                    }
-                }
+                            auto pixel = source.get_pixel(ki, lj);
+                            FloatVector3 pixel_value(pixel.red(), pixel.green(), pixel.blue());
 
-                value.clamp(0, 255);
-                render_target_bitmap->set_pixel(i, j, Color(value.x(), value.y(), value.z(), source.get_pixel(i + source_delta_x, j + source_delta_y).alpha()));
-            }
-        }
+                            value = value + pixel_value * parameters.kernel().elements()[k][l];
+                        }
+                    }
 
-        if (render_target_bitmap != &target) {
-            // FIXME: Substitute for some sort of faster "blit" method.
-            for (auto i_ = 0; i_ < target_rect.width(); ++i_) {
-                auto i = i_ + target_rect.x();
-                for (auto j_ = 0; j_ < target_rect.height(); ++j_) {
-                    auto j = j_ + target_rect.y();
-                    target.set_pixel(i, j, render_target_bitmap->get_pixel(i_, j_));
+                    value.clamp(0, 255);
+                    render_target_bitmap.set_pixel(i, j, Color(value.x(), value.y(), value.z(), source.get_pixel(i + source_delta_x, j + source_delta_y).alpha()));
                 }
-            }
-        }
+            },
+            max(pixels_per_task / max(target_rect.height(), 1), 1));
     }
 };
 
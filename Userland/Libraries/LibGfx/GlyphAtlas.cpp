@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Memory.h>
+#include <LibGfx/GlyphAtlas.h>
+
+namespace Gfx {
+
+Optional<IntRect> GlyphAtlas::allocate(Page& page, IntSize const& size)
+{
+    auto page_width = page.bitmap->width();
+    auto page_height = page.bitmap->height();
+    if (page.shelf_x + size.width() > page_width) {
+        page.shelf_x = 0;
+        page.shelf_y += page.shelf_height;
+        page.shelf_height = 0;
+    }
+    if (size.width() > page_width || page.shelf_y + size.height() > page_height)
+        return {};
+
+    IntRect rect { page.shelf_x, page.shelf_y, size.width(), size.height() };
+    page.shelf_x += size.width();
+    page.shelf_height = max(page.shelf_height, size.height());
+    return rect;
+}
+
+Optional<GlyphAtlas::Entry> GlyphAtlas::add(Bitmap const& bitmap)
+{
+    VERIFY(bitmap.scale() == 1);
+    VERIFY(bitmap.format() == BitmapFormat::BGRA8888);
+
+    Optional<IntRect> rect;
+    // Only the last page has room left on its current shelf; the earlier ones were full for something already.
+    if (!m_pages.is_empty())
+        rect = allocate(m_pages.last(), bitmap.size());
+    if (!rect.has_value()) {
+        IntSize page_size { max(bitmap.width(), GlyphAtlas::page_size), max(bitmap.height(), GlyphAtlas::page_size) };
+        auto page_bitmap = Bitmap::try_create(BitmapFormat::BGRA8888, page_size);
+        if (!page_bitmap)
+            return {};
+        m_pages.append({ page_bitmap.release_nonnull() });
+        rect = allocate(m_pages.last(), bitmap.size());
+        VERIFY(rect.has_value());
+    }
+
+    auto& page_bitmap = *m_pages.last().bitmap;
+    for (int y = 0; y < rect->height(); ++y)
+        fast_u32_copy(page_bitmap.scanline(rect->y() + y) + rect->x(), bitmap.scanline(y), rect->width());
+    return Entry { page_bitmap, *rect };
+}
+
+}
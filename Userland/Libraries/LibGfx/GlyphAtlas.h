@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullRefPtr.h>
+#include <AK/Optional.h>
+#include <AK/RefCounted.h>
+#include <AK/Vector.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Rect.h>
+
+namespace Gfx {
+
+// Packs many small bitmaps, like the rasterized glyphs of a font, into a few large ones, so they don't each need an
+// allocation of their own and the glyphs of a line of text sit close together in memory. Bitmaps are placed on shelves:
+// a shelf is as high as the tallest bitmap on it, and a new one is started below once a bitmap doesn't fit anymore.
+class GlyphAtlas : public RefCounted<GlyphAtlas> {
+public:
+    static constexpr int page_size = 256;
+
+    static NonnullRefPtr<GlyphAtlas> create() { return adopt_ref(*new GlyphAtlas); }
+
+    struct Entry {
+        NonnullRefPtr<Bitmap> bitmap;
+        IntRect rect;
+    };
+
+    // Copies the bitmap into the atlas. Bitmaps that are larger than a page get a page of their own.
+    Optional<Entry> add(Bitmap const&);
+
+    size_t page_count() const { return m_pages.size(); }
+
+private:
+    GlyphAtlas() = default;
+
+    struct Page {
+        NonnullRefPtr<Bitmap> bitmap;
+        int shelf_x { 0 };
+        int shelf_y { 0 };
+        int shelf_height { 0 };
+    };
+
+    Optional<IntRect> allocate(Page&, IntSize const&);
+
+    Vector<Page> m_pages;
+};
+
+}
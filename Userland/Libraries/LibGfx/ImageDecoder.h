@@ -41,6 +41,10 @@ public:
     virtual size_t frame_count() = 0;
     virtual ImageFrameDescriptor frame(size_t i) = 0;
 
+    // Lets the decoder skip work for an image that is only going to be shown at (about) this size, in which case the
+    // frames may be smaller than the image, but never smaller than the ideal size. Has to be set before decoding.
+    virtual void set_ideal_size(IntSize) { }
+
 protected:
     virtual RefPtr<Gfx::Bitmap> bitmap() = 0;
 
@@ -62,6 +66,7 @@ public:
     size_t loop_count() const { return m_plugin->loop_count(); }
     size_t frame_count() const { return m_plugin->frame_count(); }
     ImageFrameDescriptor frame(size_t i) const { return m_plugin->frame(i); }
+    void set_ideal_size(IntSize size) { m_plugin->set_ideal_size(size); }
 
 private:
     explicit ImageDecoder(NonnullOwnPtr<ImageDecoderPlugin>);
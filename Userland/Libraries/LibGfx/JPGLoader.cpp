@@ -12,6 +12,7 @@
 #include <AK/MappedFile.h>
 #include <AK/Math.h>
 #include <AK/MemoryStream.h>
+#include <AK/SIMD.h>
 #include <AK/String.h>
 #include <AK/Vector.h>
 #include <LibGfx/Bitmap.h>
@@ -194,6 +195,7 @@ struct JPGLoadingContext {
     HuffmanStreamState huffman_stream;
     i32 previous_dc_values[3] = { 0 };
     MacroblockMeta mblock_meta;
+    IntSize ideal_size;
 };
 
 static void generate_huffman_codes(HuffmanTableSpec& table)
@@ -879,6 +881,100 @@ static void inverse_dct(const JPGLoadingContext& context, Vector<Macroblock>& ma
     static const float s6 = AK::cos(6.0 / 16.0 * AK::Pi<double>) / 2.0;
     static const float s7 = AK::cos(7.0 / 16.0 * AK::Pi<double>) / 2.0;
 
+    // Runs the 1-D transform down a few neighbouring columns of the block at once, one column per lane.
+#ifdef __SSE2__
+    using Lanes = AK::SIMD::f32x4;
+    auto load = [](const i32* values) {
+        AK::SIMD::i32x4 lanes;
+        __builtin_memcpy(&lanes, values, sizeof(lanes));
+        return __builtin_convertvector(lanes, Lanes);
+    };
+    auto store = [](i32* values, Lanes lanes) {
+        auto truncated = __builtin_convertvector(lanes, AK::SIMD::i32x4);
+        __builtin_memcpy(values, &truncated, sizeof(truncated));
+    };
+#else
+    using Lanes = float;
+    auto load = [](const i32* values) { return (Lanes)*values; };
+    auto store = [](i32* values, Lanes lanes) { *values = lanes; };
+#endif
+    constexpr u32 lane_count = sizeof(Lanes) / sizeof(float);
+
+    auto inverse_dct_columns = [&](i32* block_component, u32 k) {
+        const Lanes g0 = load(&block_component[0 * 8 + k]) * s0;
+        const Lanes g1 = load(&block_component[4 * 8 + k]) * s4;
+        const Lanes g2 = load(&block_component[2 * 8 + k]) * s2;
+        const Lanes g3 = load(&block_component[6 * 8 + k]) * s6;
+        const Lanes g4 = load(&block_component[5 * 8 + k]) * s5;
+        const Lanes g5 = load(&block_component[1 * 8 + k]) * s1;
+        const Lanes g6 = load(&block_component[7 * 8 + k]) * s7;
+        const Lanes g7 = load(&block_component[3 * 8 + k]) * s3;
+
+        const Lanes f0 = g0;
+        const Lanes f1 = g1;
+        const Lanes f2 = g2;
+        const Lanes f3 = g3;
+        const Lanes f4 = g4 - g7;
+        const Lanes f5 = g5 + g6;
+        const Lanes f6 = g5 - g6;
+        const Lanes f7 = g4 + g7;
+
+        const Lanes e0 = f0;
+        const Lanes e1 = f1;
+        const Lanes e2 = f2 - f3;
+        const Lanes e3 = f2 + f3;
+        const Lanes e4 = f4;
+        const Lanes e5 = f5 - f7;
+        const Lanes e6 = f6;
+        const Lanes e7 = f5 + f7;
+        const Lanes e8 = f4 + f6;
+
+        const Lanes d0 = e0;
+        const Lanes d1 = e1;
+        const Lanes d2 = e2 * m1;
+        const Lanes d3 = e3;
+        const Lanes d4 = e4 * m2;
+        const Lanes d5 = e5 * m3;
+        const Lanes d6 = e6 * m4;
+        const Lanes d7 = e7;
+        const Lanes d8 = e8 * m5;
+
+        const Lanes c0 = d0 + d1;
+        const Lanes c1 = d0 - d1;
+        const Lanes c2 = d2 - d3;
+        const Lanes c3 = d3;
+        const Lanes c4 = d4 + d8;
+        const Lanes c5 = d5 + d7;
+        const Lanes c6 = d6 - d8;
+        const Lanes c7 = d7;
+        const Lanes c8 = c5 - c6;
+
+        const Lanes b0 = c0 + c3;
+        const Lanes b1 = c1 + c2;
+        const Lanes b2 = c1 - c2;
+        const Lanes b3 = c0 - c3;
+        const Lanes b4 = c4 - c8;
+        const Lanes b5 = c8;
+        const Lanes b6 = c6 - c7;
+        const Lanes b7 = c7;
+
+        store(&block_component[0 * 8 + k], b0 + b7);
+        store(&block_component[1 * 8 + k], b1 + b6);
+        store(&block_component[2 * 8 + k], b2 + b5);
+        store(&block_component[3 * 8 + k], b3 + b4);
+        store(&block_component[4 * 8 + k], b3 - b4);
+        store(&block_component[5 * 8 + k], b2 - b5);
+        store(&block_component[6 * 8 + k], b1 - b6);
+        store(&block_component[7 * 8 + k], b0 - b7);
+    };
+
+    auto transpose = [](i32* block_component) {
+        for (u32 i = 0; i < 8; ++i) {
+            for (u32 j = i + 1; j < 8; ++j)
+                swap(block_component[i * 8 + j], block_component[j * 8 + i]);
+        }
+    };
+
     for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
         for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
             for (u32 component_i = 0; component_i < context.component_count; component_i++) {
@@ -888,140 +984,13 @@ static void inverse_dct(const JPGLoadingContext& context, Vector<Macroblock>& ma
                         u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
                         Macroblock& block = macroblocks[mb_index];
                         i32* block_component = get_component(block, component_i);
-                        for (u32 k = 0; k < 8; ++k) {
-                            const float g0 = block_component[0 * 8 + k] * s0;
-                            const float g1 = block_component[4 * 8 + k] * s4;
-                            const float g2 = block_component[2 * 8 + k] * s2;
-                            const float g3 = block_component[6 * 8 + k] * s6;
-                            const float g4 = block_component[5 * 8 + k] * s5;
-                            const float g5 = block_component[1 * 8 + k] * s1;
-                            const float g6 = block_component[7 * 8 + k] * s7;
-                            const float g7 = block_component[3 * 8 + k] * s3;
-
-                            const float f0 = g0;
-                            const float f1 = g1;
-                            const float f2 = g2;
-                            const float f3 = g3;
-                            const float f4 = g4 - g7;
-                            const float f5 = g5 + g6;
-                            const float f6 = g5 - g6;
-                            const float f7 = g4 + g7;
-
-                            const float e0 = f0;
-                            const float e1 = f1;
-                            const float e2 = f2 - f3;
-                            const float e3 = f2 + f3;
-                            const float e4 = f4;
-                            const float e5 = f5 - f7;
-                            const float e6 = f6;
-                            const float e7 = f5 + f7;
-                            const float e8 = f4 + f6;
-
-                            const float d0 = e0;
-                            const float d1 = e1;
-                            const float d2 = e2 * m1;
-                            const float d3 = e3;
-                            const float d4 = e4 * m2;
-                            const float d5 = e5 * m3;
-                            const float d6 = e6 * m4;
-                            const float d7 = e7;
-                            const float d8 = e8 * m5;
-
-                            const float c0 = d0 + d1;
-                            const float c1 = d0 - d1;
-                            const float c2 = d2 - d3;
-                            const float c3 = d3;
-                            const float c4 = d4 + d8;
-                            const float c5 = d5 + d7;
-                            const float c6 = d6 - d8;
-                            const float c7 = d7;
-                            const float c8 = c5 - c6;
-
-                            const float b0 = c0 + c3;
-                            const float b1 = c1 + c2;
-                            const float b2 = c1 - c2;
-                            const float b3 = c0 - c3;
-                            const float b4 = c4 - c8;
-                            const float b5 = c8;
-                            const float b6 = c6 - c7;
-                            const float b7 = c7;
-
-                            block_component[0 * 8 + k] = b0 + b7;
-                            block_component[1 * 8 + k] = b1 + b6;
-                            block_component[2 * 8 + k] = b2 + b5;
-                            block_component[3 * 8 + k] = b3 + b4;
-                            block_component[4 * 8 + k] = b3 - b4;
-                            block_component[5 * 8 + k] = b2 - b5;
-                            block_component[6 * 8 + k] = b1 - b6;
-                            block_component[7 * 8 + k] = b0 - b7;
-                        }
-                        for (u32 l = 0; l < 8; ++l) {
-                            const float g0 = block_component[l * 8 + 0] * s0;
-                            const float g1 = block_component[l * 8 + 4] * s4;
-                            const float g2 = block_component[l * 8 + 2] * s2;
-                            const float g3 = block_component[l * 8 + 6] * s6;
-                            const float g4 = block_component[l * 8 + 5] * s5;
-                            const float g5 = block_component[l * 8 + 1] * s1;
-                            const float g6 = block_component[l * 8 + 7] * s7;
-                            const float g7 = block_component[l * 8 + 3] * s3;
-
-                            const float f0 = g0;
-                            const float f1 = g1;
-                            const float f2 = g2;
-                            const float f3 = g3;
-                            const float f4 = g4 - g7;
-                            const float f5 = g5 + g6;
-                            const float f6 = g5 - g6;
-                            const float f7 = g4 + g7;
-
-                            const float e0 = f0;
-                            const float e1 = f1;
-                            const float e2 = f2 - f3;
-                            const float e3 = f2 + f3;
-                            const float e4 = f4;
-                            const float e5 = f5 - f7;
-                            const float e6 = f6;
-                            const float e7 = f5 + f7;
-                            const float e8 = f4 + f6;
-
-                            const float d0 = e0;
-                            const float d1 = e1;
-                            const float d2 = e2 * m1;
-                            const float d3 = e3;
-                            const float d4 = e4 * m2;
-                            const float d5 = e5 * m3;
-                            const float d6 = e6 * m4;
-                            const float d7 = e7;
-                            const float d8 = e8 * m5;
-
-                            const float c0 = d0 + d1;
-                            const float c1 = d0 - d1;
-                            const float c2 = d2 - d3;
-                            const float c3 = d3;
-                            const float c4 = d4 + d8;
-                            const float c5 = d5 + d7;
-                            const float c6 = d6 - d8;
-                            const float c7 = d7;
-                            const float c8 = c5 - c6;
-
-                            const float b0 = c0 + c3;
-                            const float b1 = c1 + c2;
-                            const float b2 = c1 - c2;
-                            const float b3 = c0 - c3;
-                            const float b4 = c4 - c8;
-                            const float b5 = c8;
-                            const float b6 = c6 - c7;
-                            const float b7 = c7;
-
-                            block_component[l * 8 + 0] = b0 + b7;
-                            block_component[l * 8 + 1] = b1 + b6;
-                            block_component[l * 8 + 2] = b2 + b5;
-                            block_component[l * 8 + 3] = b3 + b4;
-                            block_component[l * 8 + 4] = b3 - b4;
-                            block_component[l * 8 + 5] = b2 - b5;
-                            block_component[l * 8 + 6] = b1 - b6;
-                            block_component[l * 8 + 7] = b0 - b7;
-                        }
+                        for (u32 k = 0; k < 8; k += lane_count)
+                            inverse_dct_columns(block_component, k);
+                        // The rows go through the same transform, as the columns of the transposed block.
+                        transpose(block_component);
+                        for (u32 l = 0; l < 8; l += lane_count)
+                            inverse_dct_columns(block_component, l);
+                        transpose(block_component);
                     }
                 }
             }
@@ -1043,9 +1012,41 @@ static void ycbcr_to_rgb(const JPGLoadingContext& context, Vector<Macroblock>& m
                     i32* cb = macroblocks[mb_index].cb;
                     i32* cr = macroblocks[mb_index].cr;
                     for (u8 i = 7; i < 8; --i) {
+                        const u32 chroma_pxrow = (i / context.vsample_factor) + 4 * vfactor_i;
+#ifdef __SSE2__
+                        // Four pixels of the row at a time. All of their chroma is read before anything is written,
+                        // since the chroma block may be this very block.
+                        using AK::SIMD::f32x4;
+                        using AK::SIMD::i32x4;
+                        for (u8 j = 4; j < 8; j -= 4) {
+                            const u8 pixel = i * 8 + j;
+                            f32x4 chroma_cb;
+                            f32x4 chroma_cr;
+                            for (u8 lane = 0; lane < 4; ++lane) {
+                                const u32 chroma_pxcol = ((j + lane) / context.hsample_factor) + 4 * hfactor_i;
+                                const u32 chroma_pixel = chroma_pxrow * 8 + chroma_pxcol;
+                                chroma_cb[lane] = chroma.cb[chroma_pixel];
+                                chroma_cr[lane] = chroma.cr[chroma_pixel];
+                            }
+                            i32x4 luma_lanes;
+                            __builtin_memcpy(&luma_lanes, &y[pixel], sizeof(luma_lanes));
+                            auto luma = __builtin_convertvector(luma_lanes, f32x4);
+                            auto clamp_to_byte = [](f32x4 value) {
+                                auto truncated = __builtin_convertvector(value, i32x4);
+                                truncated &= ~(truncated < 0);
+                                auto too_big = truncated > 255;
+                                return (truncated & ~too_big) | (255 & too_big);
+                            };
+                            auto r = clamp_to_byte(luma + 1.402f * chroma_cr + 128);
+                            auto g = clamp_to_byte(luma - 0.344f * chroma_cb - 0.714f * chroma_cr + 128);
+                            auto b = clamp_to_byte(luma + 1.772f * chroma_cb + 128);
+                            __builtin_memcpy(&y[pixel], &r, sizeof(r));
+                            __builtin_memcpy(&cb[pixel], &g, sizeof(g));
+                            __builtin_memcpy(&cr[pixel], &b, sizeof(b));
+                        }
+#else
                         for (u8 j = 7; j < 8; --j) {
                             const u8 pixel = i * 8 + j;
-                            const u32 chroma_pxrow = (i / context.vsample_factor) + 4 * vfactor_i;
                             const u32 chroma_pxcol = (j / context.hsample_factor) + 4 * hfactor_i;
                             const u32 chroma_pixel = chroma_pxrow * 8 + chroma_pxcol;
                             int r = y[pixel] + 1.402f * chroma.cr[chroma_pixel] + 128;
@@ -1055,6 +1056,7 @@ static void ycbcr_to_rgb(const JPGLoadingContext& context, Vector<Macroblock>& m
                             cb[pixel] = g < 0 ? 0 : (g > 255 ? 255 : g);
                             cr[pixel] = b < 0 ? 0 : (b > 255 ? 255 : b);
                         }
+#endif
                     }
                 }
             }
@@ -1084,6 +1086,37 @@ static bool compose_bitmap(JPGLoadingContext& context, const Vector<Macroblock>&
     return true;
 }
 
+// The DC coefficient of a block is the average of its 8x8 pixels, which is all an image an eighth of the size needs.
+static bool compose_bitmap_from_dc_coefficients(JPGLoadingContext& context, const Vector<Macroblock>& macroblocks)
+{
+    context.bitmap = Bitmap::try_create(BitmapFormat::BGRx8888, { (int)context.mblock_meta.hcount, (int)context.mblock_meta.vcount });
+    if (!context.bitmap)
+        return false;
+
+    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
+        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
+            const Macroblock& chroma = macroblocks[vcursor * context.mblock_meta.hpadded_count + hcursor];
+            const float cb = chroma.cb[0] / 8.0f;
+            const float cr = chroma.cr[0] / 8.0f;
+            for (u32 vfactor_i = 0; vfactor_i < context.vsample_factor; vfactor_i++) {
+                for (u32 hfactor_i = 0; hfactor_i < context.hsample_factor; hfactor_i++) {
+                    const u32 x = hcursor + hfactor_i;
+                    const u32 y = vcursor + vfactor_i;
+                    if (x >= context.mblock_meta.hcount || y >= context.mblock_meta.vcount)
+                        continue;
+                    const float luma = macroblocks[y * context.mblock_meta.hpadded_count + x].y[0] / 8.0f;
+                    int r = luma + 1.402f * cr + 128;
+                    int g = luma - 0.344f * cb - 0.714f * cr + 128;
+                    int b = luma + 1.772f * cb + 128;
+                    context.bitmap->set_pixel(x, y, Color(clamp(r, 0, 255), clamp(g, 0, 255), clamp(b, 0, 255)));
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
 static bool parse_header(InputMemoryStream& stream, JPGLoadingContext& context)
 {
     auto marker = read_marker_at_cursor(stream);
@@ -1214,6 +1247,13 @@ static bool decode_jpg(JPGLoadingContext& context)
 
     auto macroblocks = result.release_value();
     dequantize(context, macroblocks);
+
+    // Skip the inverse DCT altogether when an eighth of the size is still big enough.
+    if (!context.ideal_size.is_empty()
+        && context.mblock_meta.hcount >= (u32)context.ideal_size.width()
+        && context.mblock_meta.vcount >= (u32)context.ideal_size.height())
+        return compose_bitmap_from_dc_coefficients(context, macroblocks);
+
     inverse_dct(context, macroblocks);
     ycbcr_to_rgb(context, macroblocks);
     if (!compose_bitmap(context, macroblocks))
@@ -1332,4 +1372,9 @@ ImageFrameDescriptor JPGImageDecoderPlugin::frame(size_t i)
     return { bitmap(), 0 };
 }
 
+void JPGImageDecoderPlugin::set_ideal_size(IntSize size)
+{
+    m_context->ideal_size = size;
+}
+
 }
@@ -8,7 +8,9 @@
 #include <AK/Endian.h>
 #include <AK/LexicalPath.h>
 #include <AK/MappedFile.h>
+#include <AK/SIMD.h>
 #include <LibCompress/Zlib.h>
+#include <LibCrypto/Checksum/CRC32.h>
 #include <LibGfx/PNGLoader.h>
 #include <fcntl.h>
 #include <stdio.h>
@@ -213,85 +215,102 @@ union [[gnu::packed]] Pixel {
 };
 static_assert(sizeof(Pixel) == 4);
 
+// The filters work on every byte of a pixel on its own, without carrying anything over into its neighbours. So a whole
+// pixel can be handled as one u32, where the bytes are kept apart by masking off the top bit of each before adding.
+ALWAYS_INLINE static u32 swap_red_and_blue(u32 pixel)
+{
+    return (pixel & 0xff00ff00) | ((pixel >> 16) & 0xff) | ((pixel & 0xff) << 16);
+}
+
+ALWAYS_INLINE static u32 add_bytes(u32 a, u32 b)
+{
+    return ((a & 0x7f7f7f7f) + (b & 0x7f7f7f7f)) ^ ((a ^ b) & 0x80808080);
+}
+
+ALWAYS_INLINE static u32 average_bytes(u32 a, u32 b)
+{
+    return (a & b) + (((a ^ b) & 0xfefefefe) >> 1);
+}
+
+ALWAYS_INLINE static u32 paeth_predictor(u32 a, u32 b, u32 c)
+{
+#ifdef __SSE2__
+    using AK::SIMD::i16x4;
+    using AK::SIMD::u8x4;
+
+    auto va = __builtin_convertvector((u8x4)a, i16x4);
+    auto vb = __builtin_convertvector((u8x4)b, i16x4);
+    auto vc = __builtin_convertvector((u8x4)c, i16x4);
+    auto abs = [](i16x4 x) {
+        auto sign = x >> 15;
+        return (x ^ sign) - sign;
+    };
+    i16x4 p = va + vb - vc;
+    i16x4 pa = abs(p - va);
+    i16x4 pb = abs(p - vb);
+    i16x4 pc = abs(p - vc);
+    i16x4 use_a = (pa <= pb) & (pa <= pc);
+    i16x4 use_b = ~use_a & (pb <= pc);
+    i16x4 predictor = (va & use_a) | (vb & use_b) | (vc & ~(use_a | use_b));
+    return (u32)__builtin_convertvector(predictor, u8x4);
+#else
+    u32 predictor = 0;
+    for (u32 shift = 0; shift < 32; shift += 8)
+        predictor |= (u32)paeth_predictor((int)((a >> shift) & 0xff), (int)((b >> shift) & 0xff), (int)((c >> shift) & 0xff)) << shift;
+    return predictor;
+#endif
+}
+
 template<bool has_alpha, u8 filter_type>
 ALWAYS_INLINE static void unfilter_impl(Gfx::Bitmap& bitmap, int y, const void* dummy_scanline_data)
 {
-    auto* dummy_scanline = (const Pixel*)dummy_scanline_data;
-    if constexpr (filter_type == 0) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        for (int i = 0; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-        }
-    }
-
-    if constexpr (filter_type == 1) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        swap(pixels[0].r, pixels[0].b);
-        for (int i = 1; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-            auto& a = (const Pixel&)pixels[i - 1];
-            x.v[0] += a.v[0];
-            x.v[1] += a.v[1];
-            x.v[2] += a.v[2];
-            if constexpr (has_alpha)
-                x.v[3] += a.v[3];
-        }
-        return;
-    }
-    if constexpr (filter_type == 2) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        auto* pixels_y_minus_1 = y == 0 ? dummy_scanline : (const Pixel*)bitmap.scanline(y - 1);
-        for (int i = 0; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-            const Pixel& b = pixels_y_minus_1[i];
-            x.v[0] += b.v[0];
-            x.v[1] += b.v[1];
-            x.v[2] += b.v[2];
-            if constexpr (has_alpha)
-                x.v[3] += b.v[3];
+    // Without an alpha channel, every pixel's alpha byte has been set to 0xff already and has to stay that way.
+    constexpr u32 filtered_bytes = has_alpha ? 0xffffffff : 0x00ffffff;
+    auto* pixels = bitmap.scanline(y);
+    auto* pixels_y_minus_1 = y == 0 ? (const RGBA32*)dummy_scanline_data : bitmap.scanline(y - 1);
+    size_t width = bitmap.width();
+
+    // None and Up don't depend on the pixel to the left, so they can go four pixels at a time.
+    if constexpr (filter_type == 0 || filter_type == 2) {
+        size_t i = 0;
+#ifdef __SSE2__
+        using AK::SIMD::u32x4;
+        using AK::SIMD::u8x16;
+        for (; i + 4 <= width; i += 4) {
+            u32x4 x;
+            __builtin_memcpy(&x, pixels + i, sizeof(x));
+            x = (x & 0xff00ff00) | ((x >> 16) & 0xff) | ((x & 0xff) << 16);
+            if constexpr (filter_type == 2) {
+                u32x4 b;
+                __builtin_memcpy(&b, pixels_y_minus_1 + i, sizeof(b));
+                x = (u32x4)((u8x16)x + (u8x16)(b & filtered_bytes));
+            }
+            __builtin_memcpy(pixels + i, &x, sizeof(x));
         }
-        return;
-    }
-    if constexpr (filter_type == 3) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        auto* pixels_y_minus_1 = y == 0 ? dummy_scanline : (const Pixel*)bitmap.scanline(y - 1);
-        for (int i = 0; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-            Pixel a;
-            if (i != 0)
-                a = pixels[i - 1];
-            const Pixel& b = pixels_y_minus_1[i];
-            x.v[0] = x.v[0] + ((a.v[0] + b.v[0]) / 2);
-            x.v[1] = x.v[1] + ((a.v[1] + b.v[1]) / 2);
-            x.v[2] = x.v[2] + ((a.v[2] + b.v[2]) / 2);
-            if constexpr (has_alpha)
-                x.v[3] = x.v[3] + ((a.v[3] + b.v[3]) / 2);
+#endif
+        for (; i < width; ++i) {
+            auto x = swap_red_and_blue(pixels[i]);
+            if constexpr (filter_type == 2)
+                x = add_bytes(x, pixels_y_minus_1[i] & filtered_bytes);
+            pixels[i] = x;
         }
         return;
     }
-    if constexpr (filter_type == 4) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        auto* pixels_y_minus_1 = y == 0 ? dummy_scanline : (Pixel*)bitmap.scanline(y - 1);
-        for (int i = 0; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-            Pixel a;
-            const Pixel& b = pixels_y_minus_1[i];
-            Pixel c;
-            if (i != 0) {
-                a = pixels[i - 1];
-                c = pixels_y_minus_1[i - 1];
-            }
-            x.v[0] += paeth_predictor(a.v[0], b.v[0], c.v[0]);
-            x.v[1] += paeth_predictor(a.v[1], b.v[1], c.v[1]);
-            x.v[2] += paeth_predictor(a.v[2], b.v[2], c.v[2]);
-            if constexpr (has_alpha)
-                x.v[3] += paeth_predictor(a.v[3], b.v[3], c.v[3]);
+
+    u32 a = 0;
+    u32 c = 0;
+    for (size_t i = 0; i < width; ++i) {
+        auto x = swap_red_and_blue(pixels[i]);
+        if constexpr (filter_type == 1)
+            x = add_bytes(x, a & filtered_bytes);
+        if constexpr (filter_type == 3)
+            x = add_bytes(x, average_bytes(a, pixels_y_minus_1[i]) & filtered_bytes);
+        if constexpr (filter_type == 4) {
+            auto b = pixels_y_minus_1[i];
+            x = add_bytes(x, paeth_predictor(a, b, c) & filtered_bytes);
+            c = b;
         }
+        pixels[i] = a = x;
     }
 }
 
@@ -926,6 +945,14 @@ static bool process_chunk(Streamer& streamer, PNGLoadingContext& context)
     }
     dbgln_if(PNG_DEBUG, "Chunk type: '{}', size: {}, crc: {:x}", chunk_type, chunk_size, chunk_crc);
 
+    // The CRC covers the chunk type and data, but not the size.
+    Crypto::Checksum::CRC32 computed_crc { ReadonlyBytes { chunk_type, 4 } };
+    computed_crc.update(chunk_data);
+    if (computed_crc.digest() != chunk_crc) {
+        dbgln_if(PNG_DEBUG, "Bail at chunk_crc, computed crc: {:x}", computed_crc.digest());
+        return false;
+    }
+
     if (!strcmp((const char*)chunk_type, "IHDR"))
         return process_IHDR(chunk_data, context);
     if (!strcmp((const char*)chunk_type, "IDAT"))
@@ -53,6 +53,144 @@ ALWAYS_INLINE Color get_pixel(const Gfx::Bitmap& bitmap, int x, int y)
     return bitmap.get_pixel(x, y);
 }
 
+#ifdef __SSE2__
+// Blends four source pixels over four opaque destination pixels at once. Red and blue are spread into the 16-bit halves
+// of one set of lanes and green into another, so every 16-bit multiply works on a channel of its own. For an opaque
+// destination, Color::blend() comes down to (dst * (255 - alpha) + src * alpha) / 255, and this rounds the same way.
+static ALWAYS_INLINE AK::SIMD::u32x4 blend_over_opaque(AK::SIMD::u32x4 dst, AK::SIMD::u32x4 src)
+{
+    using AK::SIMD::u16x8;
+    using AK::SIMD::u32x4;
+
+    u32x4 alpha = src >> 24;
+    u16x8 src_alpha = (u16x8)(alpha | (alpha << 16));
+    u16x8 dst_alpha = 255 - src_alpha;
+
+    u16x8 red_blue = (u16x8)(dst & 0x00ff00ff) * dst_alpha + (u16x8)(src & 0x00ff00ff) * src_alpha;
+    u16x8 green = (u16x8)((dst >> 8) & 0xff) * dst_alpha + (u16x8)((src >> 8) & 0xff) * src_alpha;
+
+    // x / 255 for any x up to 255 * 255.
+    red_blue = (red_blue + 1 + (red_blue >> 8)) >> 8;
+    green = (green + 1 + (green >> 8)) >> 8;
+
+    return (u32x4)red_blue | ((u32x4)green << 8) | 0xff000000;
+}
+#endif
+
+// Blends `count` pixels from source_at(index) over the span, with the same result as calling Color::blend() for each
+// of them. If the destination has an alpha channel, only runs of four opaque pixels go through the vector kernel.
+template<bool dst_has_alpha, typename SourceAt>
+ALWAYS_INLINE static void blend_span(RGBA32* dst, size_t count, SourceAt source_at)
+{
+    size_t i = 0;
+#ifdef __SSE2__
+    using AK::SIMD::u32x4;
+    for (; i + 4 <= count; i += 4) {
+        if constexpr (dst_has_alpha) {
+            if ((dst[i] & dst[i + 1] & dst[i + 2] & dst[i + 3]) < 0xff000000) {
+                for (size_t j = i; j < i + 4; ++j)
+                    dst[j] = Color::from_rgba(dst[j]).blend(Color::from_rgba(source_at(j))).value();
+                continue;
+            }
+        }
+        u32x4 dst_pixels;
+        __builtin_memcpy(&dst_pixels, dst + i, sizeof(dst_pixels));
+        u32x4 src_pixels { source_at(i), source_at(i + 1), source_at(i + 2), source_at(i + 3) };
+        dst_pixels = blend_over_opaque(dst_pixels, src_pixels);
+        __builtin_memcpy(dst + i, &dst_pixels, sizeof(dst_pixels));
+    }
+#endif
+    for (; i < count; ++i) {
+        Color dst_color = dst_has_alpha ? Color::from_rgba(dst[i]) : Color::from_rgb(dst[i]);
+        dst[i] = dst_color.blend(Color::from_rgba(source_at(i))).value();
+    }
+}
+
+#ifdef __SSE2__
+// x / 255 for each 16-bit lane, for any x up to 255 * 255.
+static ALWAYS_INLINE AK::SIMD::u16x8 divide_by_255(AK::SIMD::u16x8 x)
+{
+    return (x + 1 + (x >> 8)) >> 8;
+}
+
+// Multiplies every channel of four premultiplied pixels by an opacity out of 255, which leaves them premultiplied.
+static ALWAYS_INLINE AK::SIMD::u32x4 scale_premultiplied(AK::SIMD::u32x4 pixels, u16 opacity)
+{
+    using AK::SIMD::u16x8;
+    using AK::SIMD::u32x4;
+
+    u16x8 red_blue = divide_by_255((u16x8)(pixels & 0x00ff00ff) * opacity);
+    u16x8 alpha_green = divide_by_255((u16x8)((pixels >> 8) & 0x00ff00ff) * opacity);
+    return (u32x4)red_blue | ((u32x4)alpha_green << 8);
+}
+
+// Blends four premultiplied source pixels over four opaque destination pixels. The source color has already been
+// scaled by its alpha, so all that's left is dst * (255 - alpha) / 255 + src, rounded the same way as above.
+static ALWAYS_INLINE AK::SIMD::u32x4 blend_premultiplied_over_opaque(AK::SIMD::u32x4 dst, AK::SIMD::u32x4 src)
+{
+    using AK::SIMD::u16x8;
+    using AK::SIMD::u32x4;
+
+    u32x4 alpha = src >> 24;
+    u16x8 dst_alpha = 255 - (u16x8)(alpha | (alpha << 16));
+    u16x8 red_blue = divide_by_255((u16x8)(dst & 0x00ff00ff) * dst_alpha);
+    u16x8 green = divide_by_255((u16x8)((dst >> 8) & 0xff) * dst_alpha);
+    return (src + ((u32x4)red_blue | ((u32x4)green << 8))) | 0xff000000;
+}
+#endif
+
+ALWAYS_INLINE static RGBA32 scale_premultiplied(RGBA32 pixel, u32 opacity)
+{
+    u32 red_blue = (pixel & 0x00ff00ff) * opacity;
+    u32 alpha_green = ((pixel >> 8) & 0x00ff00ff) * opacity;
+    red_blue = ((red_blue + 0x00010001 + ((red_blue >> 8) & 0x00ff00ff)) >> 8) & 0x00ff00ff;
+    alpha_green = ((alpha_green + 0x00010001 + ((alpha_green >> 8) & 0x00ff00ff)) >> 8) & 0x00ff00ff;
+    return red_blue | (alpha_green << 8);
+}
+
+template<bool dst_has_alpha>
+ALWAYS_INLINE static RGBA32 blend_premultiplied_pixel(RGBA32 dst, RGBA32 src)
+{
+    if (dst_has_alpha && (dst >> 24) != 0xff)
+        return Color::from_rgba(dst).blend(Color::from_premultiplied(src)).value();
+
+    u32 dst_alpha = 255 - (src >> 24);
+    u32 red_blue = (dst & 0x00ff00ff) * dst_alpha;
+    u32 green = ((dst >> 8) & 0xff) * dst_alpha;
+    red_blue = ((red_blue + 0x00010001 + ((red_blue >> 8) & 0x00ff00ff)) >> 8) & 0x00ff00ff;
+    green = (green + 1 + (green >> 8)) >> 8;
+    return (src + (red_blue | (green << 8))) | 0xff000000;
+}
+
+// Like blend_span(), but for premultiplied source pixels, which are scaled by an opacity out of 255 first.
+template<bool dst_has_alpha, bool has_opacity>
+ALWAYS_INLINE static void blend_premultiplied_span(RGBA32* dst, const RGBA32* src, size_t count, u16 opacity)
+{
+    size_t i = 0;
+#ifdef __SSE2__
+    using AK::SIMD::u32x4;
+    for (; i + 4 <= count; i += 4) {
+        u32x4 src_pixels;
+        __builtin_memcpy(&src_pixels, src + i, sizeof(src_pixels));
+        if constexpr (has_opacity)
+            src_pixels = scale_premultiplied(src_pixels, opacity);
+        if constexpr (dst_has_alpha) {
+            if ((dst[i] & dst[i + 1] & dst[i + 2] & dst[i + 3]) < 0xff000000) {
+                for (size_t j = 0; j < 4; ++j)
+                    dst[i + j] = blend_premultiplied_pixel<true>(dst[i + j], src_pixels[j]);
+                continue;
+            }
+        }
+        u32x4 dst_pixels;
+        __builtin_memcpy(&dst_pixels, dst + i, sizeof(dst_pixels));
+        dst_pixels = blend_premultiplied_over_opaque(dst_pixels, src_pixels);
+        __builtin_memcpy(dst + i, &dst_pixels, sizeof(dst_pixels));
+    }
+#endif
+    for (; i < count; ++i)
+        dst[i] = blend_premultiplied_pixel<dst_has_alpha>(dst[i], has_opacity ? scale_premultiplied(src[i], opacity) : src[i]);
+}
+
 Painter::Painter(Gfx::Bitmap& bitmap)
     : m_target(bitmap)
 {
@@ -114,8 +252,7 @@ void Painter::fill_physical_rect(const IntRect& physical_rect, Color color)
     const size_t dst_skip = m_target->pitch() / sizeof(RGBA32);
 
     for (int i = physical_rect.height() - 1; i >= 0; --i) {
-        for (int j = 0; j < physical_rect.width(); ++j)
-            dst[j] = Color::from_rgba(dst[j]).blend(color).value();
+        blend_span<true>(dst, physical_rect.width(), [&](size_t) { return color.value(); });
         dst += dst_skip;
     }
 }
@@ -751,23 +888,42 @@ struct BlitState {
     float opacity;
 };
 
-template<BlitState::AlphaState has_alpha>
+template<BlitState::AlphaState has_alpha, bool src_is_premultiplied = false>
 static void do_blit_with_opacity(BlitState& state)
 {
-    for (int row = 0; row < state.row_count; ++row) {
-        for (int x = 0; x < state.column_count; ++x) {
-            Color dest_color = (has_alpha & BlitState::DstAlpha) ? Color::from_rgba(state.dst[x]) : Color::from_rgb(state.dst[x]);
-            if constexpr (has_alpha & BlitState::SrcAlpha) {
-                Color src_color_with_alpha = Color::from_rgba(state.src[x]);
-                float pixel_opacity = src_color_with_alpha.alpha() / 255.0;
-                src_color_with_alpha.set_alpha(255 * (state.opacity * pixel_opacity));
-                state.dst[x] = dest_color.blend(src_color_with_alpha).value();
-            } else {
-                Color src_color_with_alpha = Color::from_rgb(state.src[x]);
-                src_color_with_alpha.set_alpha(state.opacity * 255);
-                state.dst[x] = dest_color.blend(src_color_with_alpha).value();
-            }
+    // The opacity scales every source alpha the same way, so it's cheaper to work out each of them up front.
+    u32 scaled_alpha[256];
+    if constexpr (has_alpha & BlitState::SrcAlpha) {
+        for (u32 alpha = 0; alpha < 256; ++alpha) {
+            float pixel_opacity = alpha / 255.0;
+            scaled_alpha[alpha] = (u32)(u8)(255 * (state.opacity * pixel_opacity)) << 24;
         }
+    }
+    u32 constant_alpha = (u32)(u8)(state.opacity * 255) << 24;
+
+    for (int row = 0; row < state.row_count; ++row) {
+        auto* src = state.src;
+        blend_span<(has_alpha & BlitState::DstAlpha) != 0>(state.dst, state.column_count, [&](size_t x) {
+            auto pixel = src_is_premultiplied ? Color::from_premultiplied(src[x]).value() : src[x];
+            if constexpr (has_alpha & BlitState::SrcAlpha)
+                return (pixel & 0x00ffffff) | scaled_alpha[pixel >> 24];
+            else
+                return (pixel & 0x00ffffff) | constant_alpha;
+        });
+        state.dst += state.dst_pitch;
+        state.src += state.src_pitch;
+    }
+}
+
+template<bool dst_has_alpha>
+static void do_blit_premultiplied_with_opacity(BlitState& state)
+{
+    u16 opacity = (u8)(state.opacity * 255);
+    for (int row = 0; row < state.row_count; ++row) {
+        if (opacity == 255)
+            blend_premultiplied_span<dst_has_alpha, false>(state.dst, state.src, state.column_count, opacity);
+        else
+            blend_premultiplied_span<dst_has_alpha, true>(state.dst, state.src, state.column_count, opacity);
         state.dst += state.dst_pitch;
         state.src += state.src_pitch;
     }
@@ -809,6 +965,21 @@ void Painter::blit_with_opacity(const IntPoint& position, const Gfx::Bitmap& sou
         .opacity = opacity
     };
 
+    if (source.format() == BitmapFormat::BGRA8888Premultiplied) {
+        if (apply_alpha) {
+            if (m_target->has_alpha_channel())
+                do_blit_premultiplied_with_opacity<true>(blit_state);
+            else
+                do_blit_premultiplied_with_opacity<false>(blit_state);
+        } else {
+            if (m_target->has_alpha_channel())
+                do_blit_with_opacity<BlitState::DstAlpha, true>(blit_state);
+            else
+                do_blit_with_opacity<BlitState::NoAlpha, true>(blit_state);
+        }
+        return;
+    }
+
     if (source.has_alpha_channel() && apply_alpha) {
         if (m_target->has_alpha_channel())
             do_blit_with_opacity<BlitState::BothAlpha>(blit_state);
@@ -822,9 +993,13 @@ void Painter::blit_with_opacity(const IntPoint& position, const Gfx::Bitmap& sou
     }
 }
 
-void Painter::blit_filtered(const IntPoint& position, const Gfx::Bitmap& source, const IntRect& src_rect, Function<Color(Color)> filter)
+// Glyphs are blitted with a filter too, so the filter is a template parameter that can be inlined, rather than a
+// Function that has to be called through for every pixel.
+template<typename Filter>
+void Painter::do_blit_filtered(const IntPoint& position, const Gfx::Bitmap& source, const IntRect& src_rect, Filter filter)
 {
     VERIFY((source.scale() == 1 || source.scale() == scale()) && "blit_filtered only supports integer upsampling");
+    VERIFY(source.format() != BitmapFormat::BGRA8888Premultiplied);
 
     IntRect safe_src_rect = src_rect.intersected(source.rect());
     auto dst_rect = IntRect(position, safe_src_rect.size()).translated(translation());
@@ -887,6 +1062,11 @@ void Painter::blit_filtered(const IntPoint& position, const Gfx::Bitmap& source,
     }
 }
 
+void Painter::blit_filtered(const IntPoint& position, const Gfx::Bitmap& source, const IntRect& src_rect, Function<Color(Color)> filter)
+{
+    do_blit_filtered(position, source, src_rect, move(filter));
+}
+
 void Painter::blit_brightened(const IntPoint& position, const Gfx::Bitmap& source, const IntRect& src_rect)
 {
     return blit_filtered(position, source, src_rect, [](Color src) {
@@ -1003,6 +1183,18 @@ void Painter::blit(const IntPoint& position, const Gfx::Bitmap& source, const In
         return;
     }
 
+    if (source.format() == BitmapFormat::BGRA8888Premultiplied) {
+        const RGBA32* src = source.scanline(src_rect.top() + first_row) + src_rect.left() + first_column;
+        const size_t src_skip = source.pitch() / sizeof(RGBA32);
+        for (int row = first_row; row <= last_row; ++row) {
+            for (int i = 0; i < clipped_rect.width(); ++i)
+                dst[i] = Color::from_premultiplied(src[i]).value();
+            dst += dst_skip;
+            src += src_skip;
+        }
+        return;
+    }
+
     if (source.format() == BitmapFormat::RGBA8888) {
         const u32* src = source.scanline(src_rect.top() + first_row) + src_rect.left() + first_column;
         const size_t src_skip = source.pitch() / sizeof(u32);
@@ -1082,17 +1274,22 @@ ALWAYS_INLINE static void do_draw_scaled_bitmap(Gfx::Bitmap& target, const IntRe
     int src_top = src_rect.top() * (1 << 16);
 
     for (int y = clipped_rect.top(); y <= clipped_rect.bottom(); ++y) {
-        auto* scanline = (Color*)target.scanline(y);
-        for (int x = clipped_rect.left(); x <= clipped_rect.right(); ++x) {
+        auto scaled_y = ((y - dst_rect.y()) * vscale + src_top) >> 16;
+        auto source_at = [&](int x) {
             auto scaled_x = ((x - dst_rect.x()) * hscale + src_left) >> 16;
-            auto scaled_y = ((y - dst_rect.y()) * vscale + src_top) >> 16;
             auto src_pixel = get_pixel(source, scaled_x, scaled_y);
             if (has_opacity)
                 src_pixel.set_alpha(src_pixel.alpha() * opacity);
-            if constexpr (has_alpha_channel) {
-                scanline[x] = scanline[x].blend(src_pixel);
-            } else
-                scanline[x] = src_pixel;
+            return src_pixel;
+        };
+        if constexpr (has_alpha_channel) {
+            blend_span<true>(target.scanline(y) + clipped_rect.left(), clipped_rect.width(), [&](size_t i) {
+                return source_at(clipped_rect.left() + i).value();
+            });
+        } else {
+            auto* scanline = (Color*)target.scanline(y);
+            for (int x = clipped_rect.left(); x <= clipped_rect.right(); ++x)
+                scanline[x] = source_at(x);
         }
     }
 }
@@ -1166,7 +1363,7 @@ FLATTEN void Painter::draw_glyph(const IntPoint& point, u32 code_point, const Fo
     if (glyph.is_glyph_bitmap()) {
         draw_bitmap(top_left, glyph.glyph_bitmap(), color);
     } else {
-        blit_filtered(top_left, *glyph.bitmap(), glyph.bitmap()->rect(), [color](Color pixel) -> Color {
+        do_blit_filtered(top_left, *glyph.bitmap(), glyph.bitmap_rect(), [color](Color pixel) -> Color {
             return pixel.multiply(color);
         });
     }
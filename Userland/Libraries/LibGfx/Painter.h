@@ -155,6 +155,9 @@ protected:
     Vector<State, 4> m_state_stack;
 
 private:
+    template<typename Filter>
+    void do_blit_filtered(const IntPoint&, const Gfx::Bitmap&, const IntRect& src_rect, Filter);
+
     Vector<DirectionalRun> split_text_into_directional_runs(Utf8View const&, TextDirection initial_direction);
     bool text_contains_bidirectional_text(Utf8View const&, TextDirection);
     template<typename DrawGlyphFunction>
@@ -497,10 +497,39 @@ bool Font::is_fixed_width() const
     return glyph_metrics(glyph_id_for_code_point('.'), 1, 1).advance_width == glyph_metrics(glyph_id_for_code_point('X'), 1, 1).advance_width;
 }
 
-int ScaledFont::width(StringView const& view) const { return unicode_view_width(Utf8View(view)); }
-int ScaledFont::width(Utf8View const& view) const { return unicode_view_width(view); }
+int ScaledFont::width(StringView const& view) const { return cached_width(view); }
+int ScaledFont::width(Utf8View const& view) const { return cached_width(view.as_string()); }
 int ScaledFont::width(Utf32View const& view) const { return unicode_view_width(view); }
 
+int ScaledFont::cached_width(StringView const& view) const
+{
+    if (view.length() > max_cached_width_length)
+        return unicode_view_width(Utf8View(view));
+
+    auto it = m_cached_widths.find(view.hash(), [&](auto& entry) { return entry.key == view; });
+    if (it != m_cached_widths.end()) {
+        it->value.last_used = ++m_width_use_counter;
+        return it->value.width;
+    }
+
+    // Once full, drop everything that wasn't used during the most recent half of the lookups, which leaves at most
+    // half of the entries in place.
+    if (m_cached_widths.size() >= max_cached_widths) {
+        auto oldest_to_keep = m_width_use_counter - max_cached_widths / 2;
+        Vector<String> stale_keys;
+        for (auto& it : m_cached_widths) {
+            if (it.value.last_used <= oldest_to_keep)
+                stale_keys.append(it.key);
+        }
+        for (auto& key : stale_keys)
+            m_cached_widths.remove(key);
+    }
+
+    auto width = unicode_view_width(Utf8View(view));
+    m_cached_widths.set(view, { width, ++m_width_use_counter });
+    return width;
+}
+
 template<typename T>
 ALWAYS_INLINE int ScaledFont::unicode_view_width(T const& view) const
 {
@@ -524,21 +553,30 @@ ALWAYS_INLINE int ScaledFont::unicode_view_width(T const& view) const
 
 RefPtr<Gfx::Bitmap> ScaledFont::rasterize_glyph(u32 glyph_id) const
 {
-    auto glyph_iterator = m_cached_glyph_bitmaps.find(glyph_id);
-    if (glyph_iterator != m_cached_glyph_bitmaps.end())
+    return m_font->rasterize_glyph(glyph_id, m_x_scale, m_y_scale);
+}
+
+Optional<Gfx::GlyphAtlas::Entry> ScaledFont::cached_glyph(u32 glyph_id) const
+{
+    auto glyph_iterator = m_cached_glyphs.find(glyph_id);
+    if (glyph_iterator != m_cached_glyphs.end())
         return glyph_iterator->value;
 
-    auto glyph_bitmap = m_font->rasterize_glyph(glyph_id, m_x_scale, m_y_scale);
-    m_cached_glyph_bitmaps.set(glyph_id, glyph_bitmap);
-    return glyph_bitmap;
+    Optional<Gfx::GlyphAtlas::Entry> entry;
+    if (auto glyph_bitmap = rasterize_glyph(glyph_id))
+        entry = m_glyph_atlas->add(*glyph_bitmap);
+    m_cached_glyphs.set(glyph_id, entry);
+    return entry;
 }
 
 Gfx::Glyph ScaledFont::glyph(u32 code_point) const
 {
     auto id = glyph_id_for_code_point(code_point);
-    auto bitmap = rasterize_glyph(id);
+    auto entry = cached_glyph(id);
     auto metrics = glyph_metrics(id);
-    return Gfx::Glyph(bitmap, metrics.left_side_bearing, metrics.advance_width, metrics.ascender);
+    if (!entry.has_value())
+        return Gfx::Glyph(RefPtr<Gfx::Bitmap>(), metrics.left_side_bearing, metrics.advance_width, metrics.ascender);
+    return Gfx::Glyph(entry->bitmap, entry->rect, metrics.left_side_bearing, metrics.advance_width, metrics.ascender);
 }
 
 u8 ScaledFont::glyph_width(size_t code_point) const
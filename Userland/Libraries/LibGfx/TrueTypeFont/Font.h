@@ -9,9 +9,11 @@
 #include <AK/HashMap.h>
 #include <AK/Noncopyable.h>
 #include <AK/RefCounted.h>
+#include <AK/String.h>
 #include <AK/StringView.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/Font.h>
+#include <LibGfx/GlyphAtlas.h>
 #include <LibGfx/Size.h>
 #include <LibGfx/TrueTypeFont/Cmap.h>
 #include <LibGfx/TrueTypeFont/Glyf.h>
@@ -118,6 +120,7 @@ public:
     ScaledFontMetrics metrics() const { return m_font->metrics(m_x_scale, m_y_scale); }
     ScaledGlyphMetrics glyph_metrics(u32 glyph_id) const { return m_font->glyph_metrics(glyph_id, m_x_scale, m_y_scale); }
     RefPtr<Gfx::Bitmap> rasterize_glyph(u32 glyph_id) const;
+    Optional<Gfx::GlyphAtlas::Entry> cached_glyph(u32 glyph_id) const;
 
     // Gfx::Font implementation
     virtual NonnullRefPtr<Font> clone() const override { return *this; } // FIXME: clone() should not need to be implemented
@@ -151,7 +154,21 @@ private:
     float m_y_scale { 0.0f };
     float m_point_width { 0.0f };
     float m_point_height { 0.0f };
-    mutable HashMap<u32, RefPtr<Gfx::Bitmap>> m_cached_glyph_bitmaps;
+    // Shared with the clones of this font, which would otherwise pack their glyphs into the same places.
+    mutable NonnullRefPtr<Gfx::GlyphAtlas> m_glyph_atlas { Gfx::GlyphAtlas::create() };
+    mutable HashMap<u32, Optional<Gfx::GlyphAtlas::Entry>> m_cached_glyphs;
+
+    // Measuring a run looks up every glyph's metrics in the font tables, and the same short runs (labels, words)
+    // get measured over and over again by text layout, so their widths are kept around.
+    static constexpr size_t max_cached_width_length = 128;
+    static constexpr size_t max_cached_widths = 512;
+    struct CachedWidth {
+        int width { 0 };
+        size_t last_used { 0 };
+    };
+    int cached_width(StringView const&) const;
+    mutable HashMap<String, CachedWidth> m_cached_widths;
+    mutable size_t m_width_use_counter { 0 };
 
     template<typename T>
     int unicode_view_width(T const& view) const;
@@ -0,0 +1,410 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/StringView.h>
+#include <LibHTTP/HPack.h>
+
+namespace HTTP::HPack {
+
+struct StaticTableEntry {
+    StringView name;
+    StringView value;
+};
+
+// RFC 7541, Appendix A: Static Table Definition
+static constexpr StaticTableEntry s_static_table[] = {
+    { ":authority", "" },
+    { ":method", "GET" },
+    { ":method", "POST" },
+    { ":path", "/" },
+    { ":path", "/index.html" },
+    { ":scheme", "http" },
+    { ":scheme", "https" },
+    { ":status", "200" },
+    { ":status", "204" },
+    { ":status", "206" },
+    { ":status", "304" },
+    { ":status", "400" },
+    { ":status", "404" },
+    { ":status", "500" },
+    { "accept-charset", "" },
+    { "accept-encoding", "gzip, deflate" },
+    { "accept-language", "" },
+    { "accept-ranges", "" },
+    { "accept", "" },
+    { "access-control-allow-origin", "" },
+    { "age", "" },
+    { "allow", "" },
+    { "authorization", "" },
+    { "cache-control", "" },
+    { "content-disposition", "" },
+    { "content-encoding", "" },
+    { "content-language", "" },
+    { "content-length", "" },
+    { "content-location", "" },
+    { "content-range", "" },
+    { "content-type", "" },
+    { "cookie", "" },
+    { "date", "" },
+    { "etag", "" },
+    { "expect", "" },
+    { "expires", "" },
+    { "from", "" },
+    { "host", "" },
+    { "if-match", "" },
+    { "if-modified-since", "" },
+    { "if-none-match", "" },
+    { "if-range", "" },
+    { "if-unmodified-since", "" },
+    { "last-modified", "" },
+    { "link", "" },
+    { "location", "" },
+    { "max-forwards", "" },
+    { "proxy-authenticate", "" },
+    { "proxy-authorization", "" },
+    { "range", "" },
+    { "referer", "" },
+    { "refresh", "" },
+    { "retry-after", "" },
+    { "server", "" },
+    { "set-cookie", "" },
+    { "strict-transport-security", "" },
+    { "transfer-encoding", "" },
+    { "user-agent", "" },
+    { "vary", "" },
+    { "via", "" },
+    { "www-authenticate", "" },
+};
+static constexpr size_t s_static_table_size = sizeof(s_static_table) / sizeof(s_static_table[0]);
+
+// RFC 7541, Appendix B: Huffman Code
+// The code is canonical, so the length of each symbol's code is all it takes to rebuild the codes themselves.
+static constexpr size_t s_end_of_string_symbol = 256;
+static constexpr size_t s_max_huffman_code_length = 30;
+static constexpr u8 s_huffman_code_lengths[257] = {
+    13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+    6, 10, 10, 12, 13, 6, 8, 11, 10, 10, 8, 11, 8, 6, 6, 6, 5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 7, 8, 15, 6, 12, 10,
+    13, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 8, 7, 8, 13, 19, 13, 14, 6,
+    15, 5, 6, 5, 6, 5, 6, 6, 6, 5, 7, 7, 6, 6, 6, 5, 6, 7, 6, 5, 5, 6, 7, 7, 7, 7, 7, 15, 11, 14, 13, 28,
+    20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23, 24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24,
+    22, 21, 20, 22, 22, 23, 23, 21, 23, 22, 22, 24, 21, 22, 23, 23, 21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+    26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25, 19, 21, 26, 27, 27, 26, 27, 24, 21, 21, 26, 26, 28, 27, 27, 27,
+    20, 24, 20, 21, 22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23, 26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27, 27, 27, 27, 26,
+    30
+};
+
+struct HuffmanTables {
+    Array<u32, 257> codes;
+    // The codes of each length are consecutive, so a code of a given length is decoded by its distance from the first one.
+    Array<u32, s_max_huffman_code_length + 1> first_code;
+    Array<u16, s_max_huffman_code_length + 1> first_symbol_index;
+    Array<u16, s_max_huffman_code_length + 1> symbol_count;
+    Array<u16, 257> symbols_by_code;
+};
+
+static HuffmanTables const& huffman_tables()
+{
+    static HuffmanTables tables = [] {
+        HuffmanTables tables {};
+        for (auto length : s_huffman_code_lengths)
+            ++tables.symbol_count[length];
+
+        u32 code = 0;
+        u16 index = 0;
+        for (size_t length = 1; length <= s_max_huffman_code_length; ++length) {
+            tables.first_code[length] = code;
+            tables.first_symbol_index[length] = index;
+            for (u16 symbol = 0; symbol < 257; ++symbol) {
+                if (s_huffman_code_lengths[symbol] != length)
+                    continue;
+                tables.codes[symbol] = code++;
+                tables.symbols_by_code[index++] = symbol;
+            }
+            code <<= 1;
+        }
+        return tables;
+    }();
+    return tables;
+}
+
+Optional<ByteBuffer> decode_huffman(ReadonlyBytes bytes)
+{
+    auto& tables = huffman_tables();
+    ByteBuffer output;
+    u32 code = 0;
+    size_t length = 0;
+    for (auto byte : bytes) {
+        for (int bit = 7; bit >= 0; --bit) {
+            code = (code << 1) | ((byte >> bit) & 1);
+            ++length;
+            if (length > s_max_huffman_code_length)
+                return {};
+            if (code - tables.first_code[length] >= tables.symbol_count[length])
+                continue;
+            auto symbol = tables.symbols_by_code[tables.first_symbol_index[length] + code - tables.first_code[length]];
+            // RFC 7541, 5.2: A string containing the EOS symbol is a decoding error.
+            if (symbol == s_end_of_string_symbol)
+                return {};
+            u8 decoded = symbol;
+            output.append(&decoded, 1);
+            code = 0;
+            length = 0;
+        }
+    }
+    // RFC 7541, 5.2: Padding is at most 7 bits of the most significant bits of the EOS code, which are all ones.
+    if (length > 7 || code != (1u << length) - 1)
+        return {};
+    return output;
+}
+
+size_t huffman_encoded_length(ReadonlyBytes bytes)
+{
+    size_t bits = 0;
+    for (auto byte : bytes)
+        bits += s_huffman_code_lengths[byte];
+    return (bits + 7) / 8;
+}
+
+ByteBuffer encode_huffman(ReadonlyBytes bytes)
+{
+    auto& tables = huffman_tables();
+    auto output = ByteBuffer::create_uninitialized(huffman_encoded_length(bytes));
+    size_t output_index = 0;
+    u64 pending = 0;
+    size_t pending_bits = 0;
+    for (auto byte : bytes) {
+        pending = (pending << s_huffman_code_lengths[byte]) | tables.codes[byte];
+        pending_bits += s_huffman_code_lengths[byte];
+        while (pending_bits >= 8) {
+            pending_bits -= 8;
+            output[output_index++] = pending >> pending_bits;
+        }
+    }
+    if (pending_bits > 0)
+        output[output_index++] = (pending << (8 - pending_bits)) | ((1u << (8 - pending_bits)) - 1);
+    VERIFY(output_index == output.size());
+    return output;
+}
+
+// RFC 7541, 5.1: Integer Representation
+static Optional<u64> decode_integer(ReadonlyBytes bytes, size_t& offset, u8 prefix_bits)
+{
+    if (offset >= bytes.size())
+        return {};
+    u8 max_prefix = (1u << prefix_bits) - 1;
+    u64 value = bytes[offset++] & max_prefix;
+    if (value < max_prefix)
+        return value;
+    for (size_t shift = 0;; shift += 7) {
+        // Nothing anywhere near this large has any business being in a header block.
+        if (offset >= bytes.size() || shift > 28)
+            return {};
+        u8 byte = bytes[offset++];
+        value += (u64)(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return value;
+    }
+}
+
+static void encode_integer(ByteBuffer& buffer, u8 flags, u8 prefix_bits, u64 value)
+{
+    auto append_byte = [&](u8 byte) { buffer.append(&byte, 1); };
+    u8 max_prefix = (1u << prefix_bits) - 1;
+    if (value < max_prefix) {
+        append_byte(flags | value);
+        return;
+    }
+    append_byte(flags | max_prefix);
+    value -= max_prefix;
+    while (value >= 0x80) {
+        append_byte((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    append_byte(value);
+}
+
+// RFC 7541, 5.2: String Literal Representation
+static Optional<String> decode_string(ReadonlyBytes bytes, size_t& offset)
+{
+    if (offset >= bytes.size())
+        return {};
+    bool is_huffman_encoded = bytes[offset] & 0x80;
+    auto length = decode_integer(bytes, offset, 7);
+    if (!length.has_value() || *length > bytes.size() - offset)
+        return {};
+    auto data = bytes.slice(offset, *length);
+    offset += *length;
+    if (!is_huffman_encoded)
+        return String { data, NoChomp };
+    auto decoded = decode_huffman(data);
+    if (!decoded.has_value())
+        return {};
+    return String { decoded->bytes(), NoChomp };
+}
+
+static void encode_string(ByteBuffer& buffer, StringView string)
+{
+    auto huffman_length = huffman_encoded_length(string.bytes());
+    if (huffman_length < string.length()) {
+        encode_integer(buffer, 0x80, 7, huffman_length);
+        buffer.append(encode_huffman(string.bytes()));
+        return;
+    }
+    encode_integer(buffer, 0, 7, string.length());
+    buffer.append(string.bytes());
+}
+
+// RFC 7541, 4.1: The size of an entry is the sum of its name's length, its value's length, and 32.
+static size_t entry_size(Header const& header)
+{
+    return header.name.length() + header.value.length() + 32;
+}
+
+Optional<Header> Decoder::header_at(size_t index) const
+{
+    // RFC 7541, 2.3.3: Indices start at 1, with the dynamic table following the static one.
+    if (index == 0)
+        return {};
+    if (index <= s_static_table_size) {
+        auto& entry = s_static_table[index - 1];
+        return Header { entry.name.to_string(), entry.value.to_string() };
+    }
+    index -= s_static_table_size + 1;
+    if (index >= m_dynamic_table.size())
+        return {};
+    return m_dynamic_table[m_dynamic_table.size() - 1 - index];
+}
+
+void Decoder::evict_until_size(size_t size)
+{
+    while (m_table_size > size) {
+        m_table_size -= entry_size(m_dynamic_table.first());
+        m_dynamic_table.take_first();
+    }
+}
+
+void Decoder::add_to_table(Header header)
+{
+    // RFC 7541, 4.4: An entry larger than the whole table empties it, and is not added.
+    auto size = entry_size(header);
+    if (size > m_max_table_size) {
+        evict_until_size(0);
+        return;
+    }
+    evict_until_size(m_max_table_size - size);
+    m_table_size += size;
+    m_dynamic_table.append(move(header));
+}
+
+Optional<Vector<Header>> Decoder::decode(ReadonlyBytes bytes)
+{
+    Vector<Header> headers;
+    size_t header_list_size = 0;
+    auto fits_in_header_list = [&](Header const& header) {
+        header_list_size += entry_size(header);
+        if (header_list_size <= m_max_header_list_size)
+            return true;
+        m_exceeded_max_header_list_size = true;
+        return false;
+    };
+    size_t offset = 0;
+    // RFC 7541, 4.2: Table size updates may only come at the beginning of a block.
+    bool can_update_table_size = true;
+    while (offset < bytes.size()) {
+        u8 byte = bytes[offset];
+
+        // 6.1: Indexed Header Field Representation
+        if (byte & 0x80) {
+            auto index = decode_integer(bytes, offset, 7);
+            if (!index.has_value())
+                return {};
+            auto header = header_at(*index);
+            if (!header.has_value() || !fits_in_header_list(*header))
+                return {};
+            headers.append(header.release_value());
+            can_update_table_size = false;
+            continue;
+        }
+
+        // 6.3: Dynamic Table Size Update
+        if ((byte & 0xe0) == 0x20) {
+            auto size = decode_integer(bytes, offset, 5);
+            if (!can_update_table_size || !size.has_value() || *size > m_table_size_limit)
+                return {};
+            m_max_table_size = *size;
+            evict_until_size(m_max_table_size);
+            continue;
+        }
+
+        // 6.2: Literal Header Field Representation, with incremental indexing (01), without indexing (0000),
+        // or never indexed (0001).
+        bool should_index = (byte & 0xc0) == 0x40;
+        auto name_index = decode_integer(bytes, offset, should_index ? 6 : 4);
+        if (!name_index.has_value())
+            return {};
+        String name;
+        if (*name_index == 0) {
+            auto decoded_name = decode_string(bytes, offset);
+            if (!decoded_name.has_value())
+                return {};
+            name = decoded_name.release_value();
+        } else {
+            auto indexed_header = header_at(*name_index);
+            if (!indexed_header.has_value())
+                return {};
+            name = move(indexed_header->name);
+        }
+        auto value = decode_string(bytes, offset);
+        if (!value.has_value())
+            return {};
+
+        Header header { move(name), value.release_value() };
+        if (!fits_in_header_list(header))
+            return {};
+        if (should_index)
+            add_to_table(header);
+        headers.append(move(header));
+        can_update_table_size = false;
+    }
+    return headers;
+}
+
+ByteBuffer Encoder::encode(Vector<Header> const& headers) const
+{
+    ByteBuffer buffer;
+    for (auto& header : headers) {
+        Optional<size_t> name_index;
+        Optional<size_t> exact_index;
+        for (size_t i = 0; i < s_static_table_size; ++i) {
+            if (s_static_table[i].name != header.name)
+                continue;
+            if (!name_index.has_value())
+                name_index = i + 1;
+            if (s_static_table[i].value == header.value) {
+                exact_index = i + 1;
+                break;
+            }
+        }
+
+        if (exact_index.has_value()) {
+            encode_integer(buffer, 0x80, 7, *exact_index);
+            continue;
+        }
+
+        // Literal Header Field without Indexing.
+        if (name_index.has_value()) {
+            encode_integer(buffer, 0, 4, *name_index);
+        } else {
+            encode_integer(buffer, 0, 4, 0);
+            encode_string(buffer, header.name);
+        }
+        encode_string(buffer, header.value);
+    }
+    return buffer;
+}
+
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/NumericLimits.h>
+#include <AK/Optional.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+
+namespace HTTP {
+
+// RFC 7541: HPACK, the header compression used by HTTP/2.
+namespace HPack {
+
+struct Header {
+    String name;
+    String value;
+};
+
+// Decodes header blocks. A decoder keeps the dynamic table that all header blocks received on a connection share,
+// so it has to see every one of them, in the order they were received.
+class Decoder {
+public:
+    static constexpr size_t default_max_table_size = 4096;
+
+    explicit Decoder(size_t max_table_size = default_max_table_size)
+        : m_max_table_size(max_table_size)
+        , m_table_size_limit(max_table_size)
+    {
+    }
+
+    // Returns an empty Optional if the block is malformed, in which case the connection can't be used anymore
+    // (RFC 7540, 4.3: COMPRESSION_ERROR). The same goes for a block whose headers add up to more than the maximum
+    // header list size, which decoding stops at, since a few bytes referring to the tables can expand to a lot.
+    Optional<Vector<Header>> decode(ReadonlyBytes);
+
+    // RFC 7540, 6.5.2: A header list is as large as the table entries its headers would make up.
+    void set_max_header_list_size(size_t size) { m_max_header_list_size = size; }
+    bool exceeded_max_header_list_size() const { return m_exceeded_max_header_list_size; }
+
+    size_t table_size() const { return m_table_size; }
+
+private:
+    Optional<Header> header_at(size_t index) const;
+    void add_to_table(Header);
+    void evict_until_size(size_t);
+
+    Vector<Header> m_dynamic_table; // Newest entries first.
+    size_t m_table_size { 0 };
+    size_t m_max_table_size { 0 };
+    size_t m_table_size_limit { 0 };
+    size_t m_max_header_list_size { NumericLimits<size_t>::max() };
+    bool m_exceeded_max_header_list_size { false };
+};
+
+// Encodes header blocks. Nothing is ever added to the dynamic table, so the peer's table size doesn't matter and
+// the same encoder can be used for any number of blocks.
+class Encoder {
+public:
+    ByteBuffer encode(Vector<Header> const&) const;
+};
+
+Optional<ByteBuffer> decode_huffman(ReadonlyBytes);
+ByteBuffer encode_huffman(ReadonlyBytes);
+size_t huffman_encoded_length(ReadonlyBytes);
+
+}
+
+}
@@ -0,0 +1,694 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/Vector.h>
+#include <LibHTTP/Http2Connection.h>
+
+namespace HTTP {
+
+static constexpr size_t frame_header_size = 9;
+static constexpr u32 default_max_frame_size = 16384;
+static constexpr i64 default_window_size = 65535;
+static constexpr i64 max_window_size = 0x7fffffff;
+
+// We hand the data to the job as soon as it arrives, so the windows only need to be large enough not to hold up a
+// fast server.
+static constexpr i64 stream_receive_window = 1 * MiB;
+static constexpr i64 connection_receive_window = 16 * MiB;
+
+// The most we accept for the headers of a response, both as the header block on the wire and once it's decoded. The
+// server learns about it from our settings, so a well-behaved one never sends more.
+static constexpr u32 max_header_list_size = 256 * KiB;
+
+static constexpr u8 flag_end_stream = 0x1;
+static constexpr u8 flag_ack = 0x1;
+static constexpr u8 flag_end_headers = 0x4;
+static constexpr u8 flag_padded = 0x8;
+static constexpr u8 flag_priority = 0x20;
+
+// RFC 7540, 6.5.2: Defined SETTINGS Parameters
+enum class SettingsParameter : u16 {
+    HeaderTableSize = 0x1,
+    EnablePush = 0x2,
+    MaxConcurrentStreams = 0x3,
+    InitialWindowSize = 0x4,
+    MaxFrameSize = 0x5,
+    MaxHeaderListSize = 0x6,
+};
+
+static u16 read_u16(ReadonlyBytes bytes, size_t offset)
+{
+    return (bytes[offset] << 8) | bytes[offset + 1];
+}
+
+static u32 read_u32(ReadonlyBytes bytes, size_t offset)
+{
+    return ((u32)bytes[offset] << 24) | (bytes[offset + 1] << 16) | (bytes[offset + 2] << 8) | bytes[offset + 3];
+}
+
+static void append_u16(ByteBuffer& buffer, u16 value)
+{
+    u8 bytes[] = { (u8)(value >> 8), (u8)value };
+    buffer.append(bytes, sizeof(bytes));
+}
+
+static void append_u32(ByteBuffer& buffer, u32 value)
+{
+    u8 bytes[] = { (u8)(value >> 24), (u8)(value >> 16), (u8)(value >> 8), (u8)value };
+    buffer.append(bytes, sizeof(bytes));
+}
+
+// RFC 7540, 6.1: Padded frames start with the length of the padding, which follows the actual payload.
+static Optional<ReadonlyBytes> remove_padding(u8 flags, ReadonlyBytes payload)
+{
+    if (!(flags & flag_padded))
+        return payload;
+    if (payload.is_empty() || payload[0] >= payload.size())
+        return {};
+    return payload.slice(1, payload.size() - 1 - payload[0]);
+}
+
+Http2Connection::Http2Connection(NonnullRefPtr<TLS::TLSv12> socket)
+    : m_socket(move(socket))
+    , m_connection_receive_window(connection_receive_window)
+{
+    m_decoder.set_max_header_list_size(max_header_list_size);
+    m_socket->on_tls_connected = nullptr;
+    m_socket->on_tls_ready_to_write = nullptr;
+    m_socket->on_tls_certificate_request = nullptr;
+    m_socket->on_tls_ready_to_read = [this](auto&) {
+        read_from_socket();
+    };
+    m_socket->on_tls_finished = [this] {
+        close();
+    };
+    m_socket->on_tls_error = [this](auto) {
+        close();
+    };
+    send_connection_preface();
+
+    // The server's preface may have come in along with the end of the handshake.
+    if (m_socket->can_read()) {
+        deferred_invoke([](auto& object) {
+            static_cast<Http2Connection&>(object).read_from_socket();
+        });
+    }
+}
+
+Http2Connection::~Http2Connection()
+{
+    m_socket->on_tls_ready_to_read = nullptr;
+    m_socket->on_tls_finished = nullptr;
+    m_socket->on_tls_error = nullptr;
+}
+
+bool Http2Connection::can_open_stream() const
+{
+    return !m_is_closed && !m_received_go_away && m_streams.size() < m_max_concurrent_streams && m_next_stream_id <= max_window_size;
+}
+
+u32 Http2Connection::open_stream(HttpRequest const& request, StreamCallbacks callbacks)
+{
+    VERIFY(can_open_stream());
+    auto stream_id = m_next_stream_id;
+    m_next_stream_id += 2;
+
+    auto& url = request.url();
+    auto authority = url.host();
+    if (url.port() != URL::default_port_for_scheme(url.scheme()))
+        authority = String::formatted("{}:{}", url.host(), url.port());
+
+    // RFC 7540, 8.1.2.3: What used to be the request line is sent as pseudo-header fields, ahead of all others.
+    Vector<HPack::Header> headers;
+    headers.append({ ":method", request.method_name() });
+    headers.append({ ":scheme", url.scheme() });
+    headers.append({ ":authority", authority });
+    headers.append({ ":path", request.request_target() });
+    for (auto& header : request.headers()) {
+        // RFC 7540, 8.1.2: Header field names are lowercase, and connection-specific ones have no place in HTTP/2.
+        auto name = header.name.to_lowercase();
+        if (name.is_one_of("connection", "host", "keep-alive", "proxy-connection", "transfer-encoding", "upgrade"))
+            continue;
+        headers.append({ move(name), header.value });
+    }
+    auto& body = request.body();
+    if (!body.is_empty())
+        headers.append({ "content-length", String::number(body.size()) });
+
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Opening stream {} for {} {}", stream_id, request.method_name(), url);
+
+    // RFC 7540, 6.10: Whatever doesn't fit in the HEADERS frame goes into CONTINUATION frames right after it.
+    auto header_block = m_encoder.encode(headers);
+    size_t offset = 0;
+    do {
+        auto size = min(max_send_payload_size(), header_block.size() - offset);
+        bool is_first_frame = offset == 0;
+        u8 flags = 0;
+        if (offset + size == header_block.size())
+            flags |= flag_end_headers;
+        if (is_first_frame && body.is_empty())
+            flags |= flag_end_stream;
+        send_frame(is_first_frame ? FrameType::Headers : FrameType::Continuation, flags, stream_id, header_block.bytes().slice(offset, size));
+        offset += size;
+    } while (offset < header_block.size());
+
+    auto stream = make<Stream>();
+    stream->id = stream_id;
+    stream->callbacks = move(callbacks);
+    stream->pending_body = body;
+    stream->send_window = m_initial_send_window;
+    stream->receive_window = stream_receive_window;
+    auto& stream_reference = *stream;
+    m_streams.set(stream_id, move(stream));
+    send_pending_body(stream_reference);
+    return stream_id;
+}
+
+void Http2Connection::close_stream(u32 stream_id)
+{
+    if (!find_stream(stream_id))
+        return;
+    // RFC 7540, 8.1: This is the only way to tell the server we don't want the rest of the response.
+    send_reset_stream(stream_id, ErrorCode::Cancel);
+    take_stream(stream_id);
+}
+
+void Http2Connection::set_stream_paused(u32 stream_id, bool paused)
+{
+    auto* stream = find_stream(stream_id);
+    if (!stream || stream->is_paused == paused)
+        return;
+    stream->is_paused = paused;
+    if (!paused && !m_is_closed)
+        update_receive_window(*stream);
+}
+
+void Http2Connection::close()
+{
+    if (m_is_closed)
+        return;
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Closing with {} open streams", m_streams.size());
+    if (!m_sent_go_away)
+        send_go_away(ErrorCode::NoError);
+    m_is_closed = true;
+    m_socket->on_tls_ready_to_read = nullptr;
+    m_socket->on_tls_finished = nullptr;
+    m_socket->on_tls_error = nullptr;
+
+    auto streams = move(m_streams);
+    for (auto& it : streams) {
+        if (it.value->callbacks.on_error)
+            it.value->callbacks.on_error();
+    }
+
+    deferred_invoke([](auto& object) {
+        auto& connection = static_cast<Http2Connection&>(object);
+        if (connection.on_closed)
+            connection.on_closed();
+    });
+}
+
+void Http2Connection::send_connection_preface()
+{
+    // RFC 7540, 3.5: The client's preface is a fixed string, followed by its settings.
+    m_socket->write("PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"sv.bytes());
+
+    ByteBuffer settings;
+    append_u16(settings, (u16)SettingsParameter::EnablePush);
+    append_u32(settings, 0);
+    append_u16(settings, (u16)SettingsParameter::InitialWindowSize);
+    append_u32(settings, stream_receive_window);
+    append_u16(settings, (u16)SettingsParameter::MaxHeaderListSize);
+    append_u32(settings, max_header_list_size);
+    send_frame(FrameType::Settings, 0, 0, settings);
+
+    // The connection's window can only be changed with a WINDOW_UPDATE.
+    send_window_update(0, connection_receive_window - default_window_size);
+}
+
+size_t Http2Connection::max_send_payload_size() const
+{
+    // Frames are kept small enough for each one to fit in a single TLS record.
+    return min<size_t>(m_max_frame_size, 16 * KiB - frame_header_size);
+}
+
+void Http2Connection::send_frame(FrameType type, u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    if (m_is_closed)
+        return;
+    VERIFY(payload.size() <= m_max_frame_size);
+
+    // RFC 7540, 4.1: Frame Format
+    auto frame = ByteBuffer::create_uninitialized(frame_header_size + payload.size());
+    frame[0] = payload.size() >> 16;
+    frame[1] = payload.size() >> 8;
+    frame[2] = payload.size();
+    frame[3] = (u8)type;
+    frame[4] = flags;
+    frame[5] = (stream_id >> 24) & 0x7f;
+    frame[6] = stream_id >> 16;
+    frame[7] = stream_id >> 8;
+    frame[8] = stream_id;
+    if (!payload.is_empty())
+        memcpy(frame.data() + frame_header_size, payload.data(), payload.size());
+
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Sending frame of type {} with flags {:#x} on stream {}, {} bytes", (u8)type, flags, stream_id, payload.size());
+    m_socket->write(frame);
+}
+
+void Http2Connection::send_window_update(u32 stream_id, u32 increment)
+{
+    ByteBuffer payload;
+    append_u32(payload, increment);
+    send_frame(FrameType::WindowUpdate, 0, stream_id, payload);
+}
+
+void Http2Connection::send_reset_stream(u32 stream_id, ErrorCode error_code)
+{
+    ByteBuffer payload;
+    append_u32(payload, (u32)error_code);
+    send_frame(FrameType::ResetStream, 0, stream_id, payload);
+}
+
+void Http2Connection::send_go_away(ErrorCode error_code)
+{
+    // We never accept any streams from the server, so the last one we processed is always 0.
+    ByteBuffer payload;
+    append_u32(payload, 0);
+    append_u32(payload, (u32)error_code);
+    send_frame(FrameType::GoAway, 0, 0, payload);
+    m_sent_go_away = true;
+}
+
+void Http2Connection::send_pending_bodies()
+{
+    for (auto& it : m_streams)
+        send_pending_body(*it.value);
+}
+
+void Http2Connection::send_pending_body(Stream& stream)
+{
+    // RFC 7540, 6.9: Only as much as both the stream's and the connection's windows allow can be sent.
+    while (!stream.pending_body.is_empty()) {
+        auto window = min(stream.send_window, m_connection_send_window);
+        if (window <= 0)
+            return;
+        auto size = min(min((size_t)window, max_send_payload_size()), stream.pending_body.size());
+        bool is_last_frame = size == stream.pending_body.size();
+        send_frame(FrameType::Data, is_last_frame ? flag_end_stream : 0, stream.id, stream.pending_body.bytes().slice(0, size));
+        stream.send_window -= size;
+        m_connection_send_window -= size;
+        stream.pending_body = stream.pending_body.slice(size, stream.pending_body.size() - size);
+    }
+}
+
+void Http2Connection::read_from_socket()
+{
+    NonnullRefPtr protector { *this };
+    while (!m_is_closed && m_socket->can_read()) {
+        auto data = m_socket->read();
+        if (!data.has_value())
+            break;
+        m_receive_buffer.append(data->bytes());
+    }
+    process_frames();
+}
+
+void Http2Connection::process_frames()
+{
+    size_t offset = 0;
+    while (!m_is_closed && m_receive_buffer.size() - offset >= frame_header_size) {
+        auto header = m_receive_buffer.bytes().slice(offset, frame_header_size);
+        u32 length = (header[0] << 16) | (header[1] << 8) | header[2];
+        // We never allow the server to send anything larger than the default.
+        if (length > default_max_frame_size)
+            return fail_connection(ErrorCode::FrameSizeError);
+        if (m_receive_buffer.size() - offset - frame_header_size < length)
+            break;
+
+        auto type = (FrameType)header[3];
+        u8 flags = header[4];
+        u32 stream_id = read_u32(header, 5) & 0x7fffffff;
+        auto payload = m_receive_buffer.bytes().slice(offset + frame_header_size, length);
+        offset += frame_header_size + length;
+        handle_frame(type, flags, stream_id, payload);
+    }
+
+    if (m_is_closed) {
+        m_receive_buffer.clear();
+        return;
+    }
+    m_receive_buffer = m_receive_buffer.slice(offset, m_receive_buffer.size() - offset);
+}
+
+void Http2Connection::handle_frame(FrameType type, u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Received frame of type {} with flags {:#x} on stream {}, {} bytes", (u8)type, flags, stream_id, payload.size());
+
+    // RFC 7540, 6.10: Nothing may come between a HEADERS frame and the CONTINUATION frames that complete it.
+    if (m_header_block_stream_id != 0 && type != FrameType::Continuation)
+        return fail_connection(ErrorCode::ProtocolError);
+
+    switch (type) {
+    case FrameType::Data:
+        return handle_data_frame(flags, stream_id, payload);
+    case FrameType::Headers:
+        return handle_headers_frame(flags, stream_id, payload);
+    case FrameType::Continuation:
+        return handle_continuation_frame(flags, stream_id, payload);
+    case FrameType::ResetStream:
+        return handle_reset_stream_frame(stream_id, payload);
+    case FrameType::Settings:
+        return handle_settings_frame(flags, stream_id, payload);
+    case FrameType::Ping:
+        return handle_ping_frame(flags, stream_id, payload);
+    case FrameType::GoAway:
+        return handle_go_away_frame(stream_id, payload);
+    case FrameType::WindowUpdate:
+        return handle_window_update_frame(stream_id, payload);
+    case FrameType::PushPromise:
+        // Our settings disable server push, so the server may not send this.
+        return fail_connection(ErrorCode::ProtocolError);
+    case FrameType::Priority:
+    default:
+        // Priorities only matter to the server, and frames of unknown types are to be ignored.
+        return;
+    }
+}
+
+bool Http2Connection::is_idle_stream(u32 stream_id) const
+{
+    // RFC 7540, 5.1.1: We only ever open odd-numbered streams, and the server can't open any of its own.
+    return stream_id == 0 || stream_id % 2 == 0 || stream_id >= m_next_stream_id;
+}
+
+void Http2Connection::handle_data_frame(u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    if (is_idle_stream(stream_id))
+        return fail_connection(ErrorCode::ProtocolError);
+    auto data = remove_padding(flags, payload);
+    if (!data.has_value())
+        return fail_connection(ErrorCode::ProtocolError);
+
+    // RFC 7540, 6.9.1: The entire frame counts against the flow-control windows, padding included. That holds for
+    // streams we have reset as well, since the server may not know that yet.
+    m_connection_receive_window -= payload.size();
+    if (m_connection_receive_window < 0)
+        return fail_connection(ErrorCode::FlowControlError);
+    if (m_connection_receive_window < connection_receive_window / 2) {
+        send_window_update(0, connection_receive_window - m_connection_receive_window);
+        m_connection_receive_window = connection_receive_window;
+    }
+
+    auto* stream = find_stream(stream_id);
+    if (!stream)
+        return;
+    if (!stream->received_final_headers)
+        return fail_stream(stream_id, ErrorCode::ProtocolError);
+    stream->receive_window -= payload.size();
+    if (stream->receive_window < 0)
+        return fail_stream(stream_id, ErrorCode::FlowControlError);
+
+    if (!data->is_empty() && stream->callbacks.on_data) {
+        stream->callbacks.on_data(*data);
+        // The stream may have been closed from within the callback.
+        stream = find_stream(stream_id);
+        if (!stream)
+            return;
+    }
+
+    if (flags & flag_end_stream)
+        return finish_stream(stream_id);
+
+    update_receive_window(*stream);
+}
+
+void Http2Connection::update_receive_window(Stream& stream)
+{
+    if (stream.is_paused || stream.receive_window >= stream_receive_window / 2)
+        return;
+    send_window_update(stream.id, stream_receive_window - stream.receive_window);
+    stream.receive_window = stream_receive_window;
+}
+
+void Http2Connection::handle_headers_frame(u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    if (is_idle_stream(stream_id))
+        return fail_connection(ErrorCode::ProtocolError);
+    auto fragment = remove_padding(flags, payload);
+    if (!fragment.has_value())
+        return fail_connection(ErrorCode::ProtocolError);
+    if (flags & flag_priority) {
+        // The stream dependency and weight, which only matter to the server.
+        if (fragment->size() < 5)
+            return fail_connection(ErrorCode::ProtocolError);
+        fragment = fragment->slice(5);
+    }
+
+    // A header never takes up more of the block than the 32 bytes it adds to the header list on top of its name and
+    // value, so a block larger than the header list may be can't be decoded into one that fits.
+    if (fragment->size() > max_header_list_size)
+        return fail_connection(ErrorCode::EnhanceYourCalm);
+
+    m_header_block_stream_id = stream_id;
+    m_header_block_ends_stream = flags & flag_end_stream;
+    m_header_block = ByteBuffer::copy(*fragment);
+    if (flags & flag_end_headers)
+        did_receive_header_block();
+}
+
+void Http2Connection::handle_continuation_frame(u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    if (m_header_block_stream_id == 0 || stream_id != m_header_block_stream_id)
+        return fail_connection(ErrorCode::ProtocolError);
+    // Otherwise, a server could keep sending CONTINUATION frames for as long as it likes.
+    if (m_header_block.size() + payload.size() > max_header_list_size)
+        return fail_connection(ErrorCode::EnhanceYourCalm);
+    m_header_block.append(payload);
+    if (flags & flag_end_headers)
+        did_receive_header_block();
+}
+
+void Http2Connection::did_receive_header_block()
+{
+    auto stream_id = exchange(m_header_block_stream_id, 0);
+    bool ends_stream = m_header_block_ends_stream;
+
+    // RFC 7540, 4.3: Every header block has to go through the decoder, even those for streams we have reset, since
+    // they all share its state.
+    auto headers = m_decoder.decode(m_header_block);
+    m_header_block.clear();
+    if (!headers.has_value())
+        return fail_connection(m_decoder.exceeded_max_header_list_size() ? ErrorCode::EnhanceYourCalm : ErrorCode::CompressionError);
+
+    auto* stream = find_stream(stream_id);
+    if (!stream)
+        return;
+
+    if (!stream->received_final_headers) {
+        Optional<u32> status_code;
+        HashMap<String, String, CaseInsensitiveStringTraits> response_headers;
+        for (auto& header : *headers) {
+            if (header.name == ":status")
+                status_code = header.value.to_uint();
+            else if (!header.name.starts_with(':'))
+                response_headers.set(header.name, header.value);
+        }
+        if (!status_code.has_value())
+            return fail_stream(stream_id, ErrorCode::ProtocolError);
+
+        // RFC 7231, 6.2: An informational response is followed by the actual one.
+        if (*status_code < 200) {
+            if (ends_stream)
+                fail_stream(stream_id, ErrorCode::ProtocolError);
+            return;
+        }
+
+        stream->received_final_headers = true;
+        if (stream->callbacks.on_headers) {
+            stream->callbacks.on_headers(response_headers, *status_code);
+            if (!find_stream(stream_id))
+                return;
+        }
+    }
+
+    // Any header block after the response's own is trailers, which only matter in that they may end the stream.
+    if (ends_stream)
+        finish_stream(stream_id);
+}
+
+void Http2Connection::handle_reset_stream_frame(u32 stream_id, ReadonlyBytes payload)
+{
+    if (is_idle_stream(stream_id))
+        return fail_connection(ErrorCode::ProtocolError);
+    if (payload.size() != 4)
+        return fail_connection(ErrorCode::FrameSizeError);
+
+    auto stream = take_stream(stream_id);
+    if (!stream)
+        return;
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Stream {} was reset with error {}", stream_id, read_u32(payload, 0));
+    if (stream->callbacks.on_error)
+        stream->callbacks.on_error();
+}
+
+void Http2Connection::handle_settings_frame(u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    if (stream_id != 0)
+        return fail_connection(ErrorCode::ProtocolError);
+    if (flags & flag_ack) {
+        if (!payload.is_empty())
+            fail_connection(ErrorCode::FrameSizeError);
+        return;
+    }
+    if (payload.size() % 6 != 0)
+        return fail_connection(ErrorCode::FrameSizeError);
+
+    for (size_t offset = 0; offset < payload.size(); offset += 6) {
+        auto parameter = (SettingsParameter)read_u16(payload, offset);
+        auto value = read_u32(payload, offset + 2);
+        switch (parameter) {
+        case SettingsParameter::MaxConcurrentStreams:
+            m_max_concurrent_streams = value;
+            break;
+        case SettingsParameter::InitialWindowSize: {
+            if (value > max_window_size)
+                return fail_connection(ErrorCode::FlowControlError);
+            // RFC 7540, 6.9.2: A change to the initial window size applies to the windows of all open streams.
+            auto delta = (i64)value - (i64)m_initial_send_window;
+            for (auto& it : m_streams)
+                it.value->send_window += delta;
+            m_initial_send_window = value;
+            break;
+        }
+        case SettingsParameter::MaxFrameSize:
+            if (value < default_max_frame_size || value > 0xffffff)
+                return fail_connection(ErrorCode::ProtocolError);
+            m_max_frame_size = value;
+            break;
+        default:
+            // Our encoder never adds to the dynamic table, so the server's table size doesn't matter to us, and
+            // neither do any of the other settings.
+            break;
+        }
+    }
+
+    send_frame(FrameType::Settings, flag_ack, 0, {});
+    send_pending_bodies();
+}
+
+void Http2Connection::handle_ping_frame(u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    if (stream_id != 0)
+        return fail_connection(ErrorCode::ProtocolError);
+    if (payload.size() != 8)
+        return fail_connection(ErrorCode::FrameSizeError);
+    if (!(flags & flag_ack))
+        send_frame(FrameType::Ping, flag_ack, 0, payload);
+}
+
+void Http2Connection::handle_go_away_frame(u32 stream_id, ReadonlyBytes payload)
+{
+    if (stream_id != 0)
+        return fail_connection(ErrorCode::ProtocolError);
+    if (payload.size() < 8)
+        return fail_connection(ErrorCode::FrameSizeError);
+
+    auto last_stream_id = read_u32(payload, 0) & 0x7fffffff;
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Server is going away after stream {} with error {}", last_stream_id, read_u32(payload, 4));
+    m_received_go_away = true;
+
+    // The streams the server hasn't processed never will be, but the ones it has can still finish.
+    Vector<u32> unprocessed_stream_ids;
+    for (auto& it : m_streams) {
+        if (it.key > last_stream_id)
+            unprocessed_stream_ids.append(it.key);
+    }
+    for (auto unprocessed_stream_id : unprocessed_stream_ids) {
+        auto stream = take_stream(unprocessed_stream_id);
+        if (stream && stream->callbacks.on_error)
+            stream->callbacks.on_error();
+    }
+    if (m_streams.is_empty())
+        close();
+}
+
+void Http2Connection::handle_window_update_frame(u32 stream_id, ReadonlyBytes payload)
+{
+    if (payload.size() != 4)
+        return fail_connection(ErrorCode::FrameSizeError);
+    auto increment = read_u32(payload, 0) & 0x7fffffff;
+
+    if (stream_id == 0) {
+        if (increment == 0)
+            return fail_connection(ErrorCode::ProtocolError);
+        m_connection_send_window += increment;
+        if (m_connection_send_window > max_window_size)
+            return fail_connection(ErrorCode::FlowControlError);
+    } else {
+        auto* stream = find_stream(stream_id);
+        if (!stream)
+            return;
+        if (increment == 0)
+            return fail_stream(stream_id, ErrorCode::ProtocolError);
+        stream->send_window += increment;
+        if (stream->send_window > max_window_size)
+            return fail_stream(stream_id, ErrorCode::FlowControlError);
+    }
+    send_pending_bodies();
+}
+
+Http2Connection::Stream* Http2Connection::find_stream(u32 stream_id)
+{
+    auto it = m_streams.find(stream_id);
+    if (it == m_streams.end())
+        return nullptr;
+    return it->value.ptr();
+}
+
+OwnPtr<Http2Connection::Stream> Http2Connection::take_stream(u32 stream_id)
+{
+    auto it = m_streams.find(stream_id);
+    if (it == m_streams.end())
+        return {};
+    OwnPtr<Stream> stream = move(it->value);
+    m_streams.remove(it);
+
+    if (m_streams.is_empty()) {
+        if (m_received_go_away)
+            close();
+        else if (on_idle)
+            on_idle();
+    }
+    return stream;
+}
+
+void Http2Connection::finish_stream(u32 stream_id)
+{
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Stream {} is done", stream_id);
+    auto stream = take_stream(stream_id);
+    if (stream && stream->callbacks.on_finish)
+        stream->callbacks.on_finish();
+}
+
+void Http2Connection::fail_stream(u32 stream_id, ErrorCode error_code)
+{
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Resetting stream {} with error {}", stream_id, (u32)error_code);
+    send_reset_stream(stream_id, error_code);
+    auto stream = take_stream(stream_id);
+    if (stream && stream->callbacks.on_error)
+        stream->callbacks.on_error();
+}
+
+void Http2Connection::fail_connection(ErrorCode error_code)
+{
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Closing the connection with error {}", (u32)error_code);
+    send_go_away(error_code);
+    close();
+}
+
+}
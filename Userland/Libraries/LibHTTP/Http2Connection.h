@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Function.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Optional.h>
+#include <LibCore/Object.h>
+#include <LibHTTP/HPack.h>
+#include <LibHTTP/HttpRequest.h>
+#include <LibTLS/TLSv12.h>
+
+namespace HTTP {
+
+// An HTTP/2 connection (RFC 7540) over a TLS session that negotiated "h2". Any number of requests can be in flight
+// on it at once, each on a stream of its own, so a slow response doesn't hold up the ones behind it.
+class Http2Connection final : public Core::Object {
+    C_OBJECT(Http2Connection)
+public:
+    static constexpr StringView alpn_protocol_id = "h2";
+
+    struct StreamCallbacks {
+        Function<void(HashMap<String, String, CaseInsensitiveStringTraits> const&, u32 status_code)> on_headers;
+        Function<void(ReadonlyBytes)> on_data;
+        Function<void()> on_finish;
+        Function<void()> on_error;
+    };
+
+    virtual ~Http2Connection() override;
+
+    bool can_open_stream() const;
+    size_t stream_count() const { return m_streams.size(); }
+
+    // Sends the request on a new stream, and returns the stream's identifier.
+    u32 open_stream(HttpRequest const&, StreamCallbacks);
+
+    // Stops calling the stream's callbacks, and tells the server to stop sending if it isn't done yet.
+    void close_stream(u32 stream_id);
+
+    // A paused stream doesn't give the server any more room to send, so the server stops once it has used up the
+    // stream's flow-control window.
+    void set_stream_paused(u32 stream_id, bool);
+
+    // Tells the server we're going away, and fails whatever streams are still open.
+    void close();
+    bool is_closed() const { return m_is_closed; }
+
+    // Called whenever the last open stream is done.
+    Function<void()> on_idle;
+    // Called (deferred) once the connection can't be used anymore.
+    Function<void()> on_closed;
+
+private:
+    explicit Http2Connection(NonnullRefPtr<TLS::TLSv12>);
+
+    // RFC 7540, 6: Frame Definitions
+    enum class FrameType : u8 {
+        Data = 0x0,
+        Headers = 0x1,
+        Priority = 0x2,
+        ResetStream = 0x3,
+        Settings = 0x4,
+        PushPromise = 0x5,
+        Ping = 0x6,
+        GoAway = 0x7,
+        WindowUpdate = 0x8,
+        Continuation = 0x9,
+    };
+
+    // RFC 7540, 7: Error Codes
+    enum class ErrorCode : u32 {
+        NoError = 0x0,
+        ProtocolError = 0x1,
+        InternalError = 0x2,
+        FlowControlError = 0x3,
+        StreamClosed = 0x5,
+        FrameSizeError = 0x6,
+        Cancel = 0x8,
+        CompressionError = 0x9,
+        EnhanceYourCalm = 0xb,
+    };
+
+    struct Stream {
+        u32 id { 0 };
+        StreamCallbacks callbacks;
+        // The part of the request body that hasn't fit in the flow-control windows yet.
+        ByteBuffer pending_body;
+        i64 send_window { 0 };
+        i64 receive_window { 0 };
+        bool received_final_headers { false };
+        bool is_paused { false };
+    };
+
+    void send_connection_preface();
+    void send_frame(FrameType, u8 flags, u32 stream_id, ReadonlyBytes payload);
+    void send_window_update(u32 stream_id, u32 increment);
+    void send_reset_stream(u32 stream_id, ErrorCode);
+    void send_go_away(ErrorCode);
+    void send_pending_bodies();
+    void send_pending_body(Stream&);
+    void update_receive_window(Stream&);
+    size_t max_send_payload_size() const;
+
+    void read_from_socket();
+    void process_frames();
+    void handle_frame(FrameType, u8 flags, u32 stream_id, ReadonlyBytes payload);
+    void handle_data_frame(u8 flags, u32 stream_id, ReadonlyBytes payload);
+    void handle_headers_frame(u8 flags, u32 stream_id, ReadonlyBytes payload);
+    void handle_continuation_frame(u8 flags, u32 stream_id, ReadonlyBytes payload);
+    void handle_reset_stream_frame(u32 stream_id, ReadonlyBytes payload);
+    void handle_settings_frame(u8 flags, u32 stream_id, ReadonlyBytes payload);
+    void handle_ping_frame(u8 flags, u32 stream_id, ReadonlyBytes payload);
+    void handle_go_away_frame(u32 stream_id, ReadonlyBytes payload);
+    void handle_window_update_frame(u32 stream_id, ReadonlyBytes payload);
+    void did_receive_header_block();
+
+    bool is_idle_stream(u32 stream_id) const;
+    Stream* find_stream(u32 stream_id);
+    OwnPtr<Stream> take_stream(u32 stream_id);
+    void finish_stream(u32 stream_id);
+    void fail_stream(u32 stream_id, ErrorCode);
+    void fail_connection(ErrorCode);
+
+    NonnullRefPtr<TLS::TLSv12> m_socket;
+    ByteBuffer m_receive_buffer;
+    HPack::Decoder m_decoder;
+    HPack::Encoder m_encoder;
+
+    HashMap<u32, NonnullOwnPtr<Stream>> m_streams;
+    u32 m_next_stream_id { 1 };
+
+    // A header block may be split across a HEADERS frame and any number of CONTINUATION frames, which have to
+    // follow each other without anything in between.
+    u32 m_header_block_stream_id { 0 };
+    bool m_header_block_ends_stream { false };
+    ByteBuffer m_header_block;
+
+    // What the server's settings allow us to do.
+    u32 m_max_concurrent_streams { 100 };
+    u32 m_initial_send_window { 65535 };
+    u32 m_max_frame_size { 16384 };
+
+    i64 m_connection_send_window { 65535 };
+    i64 m_connection_receive_window { 0 };
+
+    bool m_received_go_away { false };
+    bool m_sent_go_away { false };
+    bool m_is_closed { false };
+};
+
+}
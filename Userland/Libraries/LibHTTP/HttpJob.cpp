@@ -13,9 +13,22 @@
 
 namespace HTTP {
 void HttpJob::start()
+{
+    start(Core::TCPSocket::construct(this));
+}
+
+void HttpJob::start(NonnullRefPtr<Core::Socket> socket)
 {
     VERIFY(!m_socket);
-    m_socket = Core::TCPSocket::construct(this);
+    m_socket = move(socket);
+    if (m_socket->is_connected()) {
+        dbgln_if(CHTTPJOB_DEBUG, "HttpJob: Reusing an open connection");
+        deferred_invoke([this](auto&) {
+            if (m_socket)
+                on_socket_connected();
+        });
+        return;
+    }
     m_socket->on_connected = [this] {
         dbgln_if(CHTTPJOB_DEBUG, "HttpJob: on_connected callback");
         on_socket_connected();
@@ -32,10 +45,16 @@ void HttpJob::shutdown()
 {
     if (!m_socket)
         return;
+    // Anything left to read would be taken for the start of the next response.
+    bool can_reuse_socket = can_reuse_connection() && m_socket->is_connected() && !m_socket->can_read();
+    m_socket->set_reading_paused(false);
     m_socket->on_ready_to_read = nullptr;
     m_socket->on_connected = nullptr;
-    remove_child(*m_socket);
+    if (m_socket->parent() == this)
+        remove_child(*m_socket);
     m_socket = nullptr;
+    if (on_socket_released)
+        on_socket_released(can_reuse_socket);
 }
 
 void HttpJob::register_on_ready_to_read(Function<void()> callback)
@@ -43,6 +62,12 @@ void HttpJob::register_on_ready_to_read(Function<void()> callback)
     m_socket->on_ready_to_read = move(callback);
 }
 
+void HttpJob::set_reading_paused(bool paused)
+{
+    if (m_socket)
+        m_socket->set_reading_paused(paused);
+}
+
 void HttpJob::register_on_ready_to_write(Function<void()> callback)
 {
     // There is no need to wait, the connection is already established
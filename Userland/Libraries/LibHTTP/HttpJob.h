@@ -30,10 +30,14 @@ public:
     virtual void start() override;
     virtual void shutdown() override;
 
+    // Starts the job on a socket that may already be connected to the request's origin.
+    void start(NonnullRefPtr<Core::Socket>);
+
 protected:
     virtual bool should_fail_on_empty_payload() const override { return false; }
     virtual void register_on_ready_to_read(Function<void()>) override;
     virtual void register_on_ready_to_write(Function<void()>) override;
+    virtual void set_reading_paused(bool) override;
     virtual bool can_read_line() const override;
     virtual String read_line(size_t) override;
     virtual bool can_read() const override;
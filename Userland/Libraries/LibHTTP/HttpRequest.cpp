@@ -33,11 +33,9 @@ String HttpRequest::method_name() const
     }
 }
 
-ByteBuffer HttpRequest::to_raw_request() const
+String HttpRequest::request_target() const
 {
     StringBuilder builder;
-    builder.append(method_name());
-    builder.append(' ');
     // NOTE: The percent_encode is so that e.g. spaces are properly encoded.
     auto path = m_url.path();
     VERIFY(!path.is_empty());
@@ -46,6 +44,15 @@ ByteBuffer HttpRequest::to_raw_request() const
         builder.append('?');
         builder.append(URL::percent_encode(m_url.query(), URL::PercentEncodeSet::EncodeURI));
     }
+    return builder.to_string();
+}
+
+ByteBuffer HttpRequest::to_raw_request() const
+{
+    StringBuilder builder;
+    builder.append(method_name());
+    builder.append(' ');
+    builder.append(request_target());
     builder.append(" HTTP/1.1\r\nHost: ");
     builder.append(m_url.host());
     builder.append("\r\n");
@@ -55,7 +62,6 @@ ByteBuffer HttpRequest::to_raw_request() const
         builder.append(header.value);
         builder.append("\r\n");
     }
-    builder.append("Connection: close\r\n");
     if (!m_body.is_empty()) {
         builder.appendff("Content-Length: {}\r\n\r\n", m_body.size());
         builder.append((char const*)m_body.data(), m_body.size());
@@ -88,68 +94,62 @@ Optional<HttpRequest> HttpRequest::from_raw_request(ReadonlyBytes raw_request)
         return raw_request[index++];
     };
 
-    Vector<u8, 256> buffer;
+    // The parts of the request are taken straight out of it, and only copied for the headers we keep.
+    size_t token_start = 0;
 
-    String method;
-    String resource;
-    String protocol;
+    StringView method;
+    StringView resource;
+    StringView protocol;
     Vector<Header> headers;
     Header current_header;
 
-    auto commit_and_advance_to = [&](auto& output, State new_state) {
-        output = String::copy(buffer);
-        buffer.clear();
+    auto commit_and_advance_to = [&](auto& output, size_t delimiter_length, State new_state) {
+        output = StringView { raw_request.offset_pointer(token_start), index - token_start };
+        index += delimiter_length;
+        token_start = index;
         state = new_state;
     };
 
     while (index < raw_request.size()) {
         // FIXME: Figure out what the appropriate limitations should be.
-        if (buffer.size() > 65536)
+        if (index - token_start > 65536)
             return {};
         switch (state) {
         case State::InMethod:
             if (peek() == ' ') {
-                consume();
-                commit_and_advance_to(method, State::InResource);
+                commit_and_advance_to(method, 1, State::InResource);
                 break;
             }
-            buffer.append(consume());
+            consume();
             break;
         case State::InResource:
             if (peek() == ' ') {
-                consume();
-                commit_and_advance_to(resource, State::InProtocol);
+                commit_and_advance_to(resource, 1, State::InProtocol);
                 break;
             }
-            buffer.append(consume());
+            consume();
             break;
         case State::InProtocol:
             if (peek(0) == '\r' && peek(1) == '\n') {
-                consume();
-                consume();
-                commit_and_advance_to(protocol, State::InHeaderName);
+                commit_and_advance_to(protocol, 2, State::InHeaderName);
                 break;
             }
-            buffer.append(consume());
+            consume();
             break;
         case State::InHeaderName:
             if (peek(0) == ':' && peek(1) == ' ') {
-                consume();
-                consume();
-                commit_and_advance_to(current_header.name, State::InHeaderValue);
+                commit_and_advance_to(current_header.name, 2, State::InHeaderValue);
                 break;
             }
-            buffer.append(consume());
+            consume();
             break;
         case State::InHeaderValue:
             if (peek(0) == '\r' && peek(1) == '\n') {
-                consume();
-                consume();
-                commit_and_advance_to(current_header.value, State::InHeaderName);
+                commit_and_advance_to(current_header.value, 2, State::InHeaderName);
                 headers.append(move(current_header));
                 break;
             }
-            buffer.append(consume());
+            consume();
             break;
         }
     }
@@ -37,6 +37,11 @@ public:
     HttpRequest();
     ~HttpRequest();
 
+    HttpRequest(HttpRequest const&) = default;
+    HttpRequest(HttpRequest&&) = default;
+    HttpRequest& operator=(HttpRequest const&) = default;
+    HttpRequest& operator=(HttpRequest&&) = default;
+
     String const& resource() const { return m_resource; }
     Vector<Header> const& headers() const { return m_headers; }
 
@@ -51,6 +56,8 @@ public:
     void set_body(ByteBuffer&& body) { m_body = move(body); }
 
     String method_name() const;
+    // RFC 7230, 5.3.1: The path and query of the URL, as they are sent to the server.
+    String request_target() const;
     ByteBuffer to_raw_request() const;
 
     void set_headers(HashMap<String, String> const&);
@@ -15,14 +15,14 @@
 namespace HTTP {
 
 void HttpsJob::start()
+{
+    start(TLS::TLSv12::construct(this));
+}
+
+void HttpsJob::start(NonnullRefPtr<TLS::TLSv12> socket)
 {
     VERIFY(!m_socket);
-    m_socket = TLS::TLSv12::construct(this);
-    m_socket->set_root_certificates(m_override_ca_certificates ? *m_override_ca_certificates : DefaultRootCACertificates::the().certificates());
-    m_socket->on_tls_connected = [this] {
-        dbgln_if(HTTPSJOB_DEBUG, "HttpsJob: on_connected callback");
-        on_socket_connected();
-    };
+    m_socket = move(socket);
     m_socket->on_tls_error = [&](TLS::AlertDescription error) {
         if (error == TLS::AlertDescription::HandshakeFailure) {
             deferred_invoke([this](auto&) {
@@ -46,6 +46,30 @@ void HttpsJob::start()
         if (on_certificate_requested)
             on_certificate_requested(*this);
     };
+    if (m_socket->is_established()) {
+        dbgln_if(HTTPSJOB_DEBUG, "HttpsJob: Reusing an established connection");
+        deferred_invoke([this](auto&) {
+            if (m_socket)
+                on_socket_connected();
+        });
+        return;
+    }
+    m_socket->set_root_certificates(m_override_ca_certificates ? *m_override_ca_certificates : DefaultRootCACertificates::the().certificates());
+    m_socket->add_alpn(Http2Connection::alpn_protocol_id);
+    m_socket->add_alpn("http/1.1");
+    m_socket->on_tls_connected = [this] {
+        dbgln_if(HTTPSJOB_DEBUG, "HttpsJob: on_connected callback");
+        // Which protocol the server picked is only known once the handshake is done, which is when the socket first
+        // becomes ready to write.
+        m_socket->on_tls_ready_to_write = [this](auto&) {
+            m_socket->on_tls_ready_to_write = nullptr;
+            // The socket's callbacks can't be replaced from within one of them.
+            deferred_invoke([this](auto&) {
+                if (m_socket)
+                    did_establish_session();
+            });
+        };
+    };
     bool success = ((TLS::TLSv12&)*m_socket).connect(m_request.url().host(), m_request.url().port());
     if (!success) {
         deferred_invoke([this](auto&) {
@@ -54,14 +78,83 @@ void HttpsJob::start()
     }
 }
 
+void HttpsJob::did_establish_session()
+{
+    if (m_socket->alpn() != Http2Connection::alpn_protocol_id) {
+        on_socket_connected();
+        return;
+    }
+
+    dbgln_if(HTTPSJOB_DEBUG, "HttpsJob: Server picked HTTP/2");
+    auto socket = m_socket.release_nonnull();
+    if (socket->parent() == this)
+        remove_child(*socket);
+    auto connection = Http2Connection::construct(move(socket));
+    if (on_http2_connection_established)
+        on_http2_connection_established(*connection);
+    start(*connection);
+}
+
+void HttpsJob::start(Http2Connection& connection)
+{
+    VERIFY(!m_socket && !m_http2_connection);
+    m_http2_connection = connection;
+
+    Http2Connection::StreamCallbacks callbacks;
+    callbacks.on_headers = [this](auto& headers, u32 status_code) {
+        m_code = status_code;
+        m_headers = headers;
+        if (m_headers.contains("Content-Encoding")) {
+            // Assume that any content-encoding means that we can't decode it as a stream :(
+            m_can_stream_response = false;
+        }
+        m_state = State::InBody;
+        if (on_headers_received)
+            on_headers_received(m_headers, m_code);
+    };
+    callbacks.on_data = [this](ReadonlyBytes data) {
+        m_received_buffers.append(ByteBuffer::copy(data));
+        m_buffered_size += data.size();
+        m_received_size += data.size();
+        flush_received_buffers();
+        pause_reading_if_client_is_behind();
+        deferred_invoke([this, content_length = content_length()](auto&) { did_progress(content_length, m_received_size); });
+    };
+    callbacks.on_finish = [this] {
+        m_received_complete_message = true;
+        finish_up();
+    };
+    callbacks.on_error = [this] {
+        deferred_invoke([this](auto&) {
+            did_fail(Core::NetworkJob::Error::TransmissionFailed);
+        });
+    };
+    m_http2_stream_id = connection.open_stream(m_request, move(callbacks));
+}
+
 void HttpsJob::shutdown()
 {
+    if (m_http2_connection) {
+        m_http2_connection->close_stream(m_http2_stream_id);
+        m_http2_connection = nullptr;
+        return;
+    }
     if (!m_socket)
         return;
+    // Anything left to read would be taken for the start of the next response.
+    bool can_reuse_socket = can_reuse_connection() && m_socket->is_established() && !m_socket->can_read();
+    m_socket->set_reading_paused(false);
     m_socket->on_tls_ready_to_read = nullptr;
+    m_socket->on_tls_ready_to_write = nullptr;
     m_socket->on_tls_connected = nullptr;
-    remove_child(*m_socket);
+    m_socket->on_tls_error = nullptr;
+    m_socket->on_tls_finished = nullptr;
+    m_socket->on_tls_certificate_request = nullptr;
+    if (m_socket->parent() == this)
+        remove_child(*m_socket);
     m_socket = nullptr;
+    if (on_socket_released)
+        on_socket_released(can_reuse_socket);
 }
 
 void HttpsJob::set_certificate(String certificate, String private_key)
@@ -88,8 +181,24 @@ void HttpsJob::register_on_ready_to_read(Function<void()> callback)
     };
 }
 
+void HttpsJob::set_reading_paused(bool paused)
+{
+    // Other jobs may be sharing an HTTP/2 connection, so only this job's stream is held back.
+    if (m_http2_connection) {
+        m_http2_connection->set_stream_paused(m_http2_stream_id, paused);
+        return;
+    }
+    if (m_socket)
+        m_socket->set_reading_paused(paused);
+}
+
 void HttpsJob::register_on_ready_to_write(Function<void()> callback)
 {
+    // An established session won't tell us it is ready to write again until something has been written.
+    if (m_socket->is_established()) {
+        callback();
+        return;
+    }
     m_socket->on_tls_ready_to_write = [callback = move(callback)](auto&) {
         callback();
     };
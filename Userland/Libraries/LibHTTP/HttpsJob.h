@@ -8,6 +8,7 @@
 
 #include <AK/HashMap.h>
 #include <LibCore/NetworkJob.h>
+#include <LibHTTP/Http2Connection.h>
 #include <LibHTTP/HttpRequest.h>
 #include <LibHTTP/HttpResponse.h>
 #include <LibHTTP/Job.h>
@@ -32,11 +33,21 @@ public:
     virtual void shutdown() override;
     void set_certificate(String certificate, String key);
 
+    // Starts the job on a socket that may already have established a TLS session with the request's origin.
+    void start(NonnullRefPtr<TLS::TLSv12>);
+
+    // Starts the job as a stream on an HTTP/2 connection to the request's origin.
+    void start(Http2Connection&);
+
     Function<void(HttpsJob&)> on_certificate_requested;
 
+    // Called when the server picked HTTP/2 for a new connection this job made, so that other jobs can share it.
+    Function<void(Http2Connection&)> on_http2_connection_established;
+
 protected:
     virtual void register_on_ready_to_read(Function<void()>) override;
     virtual void register_on_ready_to_write(Function<void()>) override;
+    virtual void set_reading_paused(bool) override;
     virtual bool can_read_line() const override;
     virtual String read_line(size_t) override;
     virtual bool can_read() const override;
@@ -48,7 +59,11 @@ protected:
     virtual void read_while_data_available(Function<IterationDecision()>) override;
 
 private:
+    void did_establish_session();
+
     RefPtr<TLS::TLSv12> m_socket;
+    RefPtr<Http2Connection> m_http2_connection;
+    u32 m_http2_stream_id { 0 };
     const Vector<Certificate>* m_override_ca_certificates { nullptr };
 };
 
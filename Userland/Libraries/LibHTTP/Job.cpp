@@ -7,6 +7,7 @@
 #include <AK/Debug.h>
 #include <LibCompress/Gzip.h>
 #include <LibCompress/Zlib.h>
+#include <LibCompress/Zstd.h>
 #include <LibCore/Event.h>
 #include <LibCore/TCPSocket.h>
 #include <LibHTTP/HttpResponse.h>
@@ -65,6 +66,23 @@ static ByteBuffer handle_content_encoding(const ByteBuffer& buf, const String& c
             dbgln("  Output size: {}", uncompressed.value().size());
         }
 
+        return uncompressed.value();
+    } else if (content_encoding == "zstd") {
+        dbgln_if(JOB_DEBUG, "Job::handle_content_encoding: buf is zstd compressed!");
+
+        // https://tools.ietf.org/html/rfc8878#section-7.2
+        auto uncompressed = Compress::ZstdDecompressor::decompress_all(buf);
+        if (!uncompressed.has_value()) {
+            dbgln("Job::handle_content_encoding: ZstdDecompressor::decompress_all() failed, returning original buffer.");
+            return buf;
+        }
+
+        if constexpr (JOB_DEBUG) {
+            dbgln("Job::handle_content_encoding: Zstd decompression successful.");
+            dbgln("  Input size: {}", buf.size());
+            dbgln("  Output size: {}", uncompressed.value().size());
+        }
+
         return uncompressed.value();
     }
 
@@ -101,6 +119,21 @@ void Job::flush_received_buffers()
         break;
     }
     dbgln_if(JOB_DEBUG, "Job: Flushing received buffers done: have {} bytes in {} buffers", m_buffered_size, m_received_buffers.size());
+
+    // Whatever the client couldn't take yet follows as soon as it makes room, rather than with the next bit of data.
+    if (m_buffered_size != 0 && !has_timer())
+        start_timer(50);
+}
+
+bool Job::pause_reading_if_client_is_behind()
+{
+    if (m_is_reading_paused || !m_can_stream_response || m_buffered_size < max_buffered_size)
+        return m_is_reading_paused;
+    // The client isn't keeping up, so leave the rest with the server until it has caught up.
+    dbgln_if(JOB_DEBUG, "Job: Pausing with {} bytes waiting for the client", m_buffered_size);
+    m_is_reading_paused = true;
+    set_reading_paused(true);
+    return true;
 }
 
 void Job::on_socket_connected()
@@ -121,7 +154,7 @@ void Job::on_socket_connected()
             deferred_invoke([this](auto&) { did_fail(Core::NetworkJob::Error::TransmissionFailed); });
     });
     register_on_ready_to_read([&] {
-        if (is_cancelled())
+        if (is_cancelled() || m_is_reading_paused)
             return;
 
         if (m_state == State::Finished) {
@@ -149,6 +182,9 @@ void Job::on_socket_connected()
                 warnln("Job: Expected numeric HTTP status");
                 return deferred_invoke([this](auto&) { did_fail(Core::NetworkJob::Error::ProtocolFailed); });
             }
+            // HTTP/1.0 connections are closed after every response, unless asked otherwise.
+            if (parts[0] == "HTTP/1.0")
+                m_server_closes_connection = true;
             m_code = code.value();
             m_state = State::InHeaders;
             return;
@@ -169,11 +205,17 @@ void Job::on_socket_connected()
             }
             if (line.is_empty()) {
                 if (m_state == State::Trailers) {
+                    m_received_complete_message = true;
                     return finish_up();
                 } else {
                     if (on_headers_received)
                         on_headers_received(m_headers, m_code > 0 ? m_code : Optional<u32> {});
                     m_state = State::InBody;
+                    // The connection is kept open, so there's no end of stream to tell us there is nothing more to come.
+                    if (!response_has_body()) {
+                        m_received_complete_message = true;
+                        return finish_up();
+                    }
                 }
                 return;
             }
@@ -201,6 +243,8 @@ void Job::on_socket_connected()
             }
             auto value = line.substring(name.length() + 2, line.length() - name.length() - 2);
             m_headers.set(name, value);
+            if (name.equals_ignoring_case("Connection") && value.contains("close", CaseSensitivity::CaseInsensitive))
+                m_server_closes_connection = true;
             if (name.equals_ignoring_case("Content-Encoding")) {
                 // Assume that any content-encoding means that we can't decode it as a stream :(
                 dbgln_if(JOB_DEBUG, "Content-Encoding {} detected, cannot stream output :(", value);
@@ -321,25 +365,22 @@ void Job::on_socket_connected()
                 m_current_chunk_remaining_size = size;
             }
 
-            auto content_length_header = m_headers.get("Content-Length");
-            Optional<u32> content_length {};
-
-            if (content_length_header.has_value()) {
-                auto length = content_length_header.value().to_uint();
-                if (length.has_value())
-                    content_length = length.value();
-            }
-
+            auto content_length = this->content_length();
             deferred_invoke([this, content_length](auto&) { did_progress(content_length, m_received_size); });
 
             if (content_length.has_value()) {
                 auto length = content_length.value();
                 if (m_received_size >= length) {
+                    // Anything past the announced length can't be the start of another response.
+                    m_received_complete_message = m_received_size == length;
                     m_received_size = length;
                     finish_up();
                     return IterationDecision::Break;
                 }
             }
+
+            if (pause_reading_if_client_is_behind())
+                return IterationDecision::Break;
             return IterationDecision::Continue;
         });
 
@@ -350,10 +391,44 @@ void Job::on_socket_connected()
     });
 }
 
+// RFC 7230, 3.3.3: Message Body Length
+bool Job::response_has_body() const
+{
+    if (m_request.method() == HttpRequest::Method::HEAD)
+        return false;
+    if (m_code == 204 || m_code == 304)
+        return false;
+    if (m_headers.contains("Transfer-Encoding"))
+        return true;
+    auto content_length = m_headers.get("Content-Length");
+    if (!content_length.has_value())
+        return true;
+    auto length = content_length->to_uint();
+    return !length.has_value() || *length != 0;
+}
+
+Optional<u32> Job::content_length() const
+{
+    auto content_length_header = m_headers.get("Content-Length");
+    if (!content_length_header.has_value())
+        return {};
+    return content_length_header->to_uint();
+}
+
 void Job::timer_event(Core::TimerEvent& event)
 {
     event.accept();
-    finish_up();
+    if (m_state == State::Finished) {
+        if (!m_has_scheduled_finish)
+            finish_up();
+    } else {
+        flush_received_buffers();
+        if (m_is_reading_paused && m_buffered_size <= max_buffered_size / 2) {
+            dbgln_if(JOB_DEBUG, "Job: Resuming with {} bytes waiting for the client", m_buffered_size);
+            m_is_reading_paused = false;
+            set_reading_paused(false);
+        }
+    }
     if (m_buffered_size == 0)
         stop_timer();
 }
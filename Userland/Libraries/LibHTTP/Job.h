@@ -27,12 +27,25 @@ public:
     HttpResponse* response() { return static_cast<HttpResponse*>(Core::NetworkJob::response()); }
     const HttpResponse* response() const { return static_cast<const HttpResponse*>(Core::NetworkJob::response()); }
 
+    // Called when the job is done with a socket it was started with, and whether another request can be sent over it.
+    Function<void(bool can_reuse_connection)> on_socket_released;
+
+    // How much of the response may be waiting for the client to take it before we stop reading from the server.
+    static constexpr size_t max_buffered_size = 1 * MiB;
+
 protected:
+    // Whether the whole response was received, and the server didn't ask for the connection to be closed afterwards.
+    bool can_reuse_connection() const { return m_received_complete_message && !m_server_closes_connection && !has_error(); }
+    bool response_has_body() const;
+    Optional<u32> content_length() const;
+
     void finish_up();
     void on_socket_connected();
     void flush_received_buffers();
+    bool pause_reading_if_client_is_behind();
     virtual void register_on_ready_to_read(Function<void()>) = 0;
     virtual void register_on_ready_to_write(Function<void()>) = 0;
+    virtual void set_reading_paused(bool) = 0;
     virtual bool can_read_line() const = 0;
     virtual String read_line(size_t) = 0;
     virtual bool can_read() const = 0;
@@ -65,6 +78,9 @@ protected:
     bool m_can_stream_response { true };
     bool m_should_read_chunk_ending_line { false };
     bool m_has_scheduled_finish { false };
+    bool m_is_reading_paused { false };
+    bool m_received_complete_message { false };
+    bool m_server_closes_connection { false };
 };
 
 }
@@ -8,23 +8,35 @@
 
 #include <AK/ByteBuffer.h>
 #include <AK/NonnullOwnPtrVector.h>
+#include <LibCore/AnonymousBuffer.h>
 #include <LibCore/Event.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/LocalSocket.h>
 #include <LibCore/Notifier.h>
+#include <LibCore/Promise.h>
 #include <LibCore/Timer.h>
 #include <LibIPC/Message.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/select.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 namespace IPC {
 
+// Message bodies at least this large are handed to the peer in an anonymous buffer instead of being written
+// through the socket, so they don't have to be copied into and out of the kernel or reassembled on the other side.
+static constexpr size_t shared_memory_message_threshold = 64 * KiB;
+
+// Set in the size that precedes a message whose body is in an anonymous buffer. The buffer's fd is sent along
+// with the size, ahead of any fds of the message itself.
+static constexpr u32 message_in_shared_memory_flag = 0x80000000;
+
 template<typename LocalEndpoint, typename PeerEndpoint>
 class Connection : public Core::Object {
 public:
@@ -43,6 +55,11 @@ public:
         };
     }
 
+    virtual ~Connection() override
+    {
+        flush_batched_messages();
+    }
+
     template<typename MessageType>
     OwnPtr<MessageType> wait_for_specific_message()
     {
@@ -62,24 +79,122 @@ public:
         if (!m_socket->is_open())
             return;
 
-        // Prepend the message size.
         uint32_t message_size = buffer.data.size();
+#ifdef __serenity__
+        if (buffer.data.size() >= shared_memory_message_threshold && buffer.data.size() < message_in_shared_memory_flag)
+            move_message_to_shared_memory(buffer, message_size);
+#endif
+
+        if (m_batches_messages) {
+            if (m_batched_messages.data.is_empty())
+                deferred_invoke([this](auto&) { flush_batched_messages(); });
+            m_batched_messages.data.append(reinterpret_cast<const u8*>(&message_size), sizeof(message_size));
+            m_batched_messages.data.append(buffer.data.data(), buffer.data.size());
+            m_batched_messages.fds.extend(move(buffer.fds));
+            return;
+        }
+
+        // Prepend the message size.
         buffer.data.prepend(reinterpret_cast<const u8*>(&message_size), sizeof(message_size));
+        write_message_buffer(buffer);
+    }
+
+    // When enabled, messages are held back until the end of the current event loop iteration
+    // and then all written at once, instead of taking at least one syscall each.
+    void set_batches_messages(bool batches_messages)
+    {
+        m_batches_messages = batches_messages;
+        if (!batches_messages)
+            flush_batched_messages();
+    }
+
+    void flush_batched_messages()
+    {
+        if (m_batched_messages.data.is_empty())
+            return;
+        auto buffer = move(m_batched_messages);
+        m_batched_messages = {};
+        if (m_socket->is_open())
+            write_message_buffer(buffer);
+    }
+
+    template<typename RequestType, typename... Args>
+    NonnullOwnPtr<typename RequestType::ResponseType> send_sync(Args&&... args)
+    {
+        post_message(RequestType(forward<Args>(args)...));
+        expect_response<typename RequestType::ResponseType>(nullptr);
+        auto response = wait_for_specific_endpoint_message<typename RequestType::ResponseType, PeerEndpoint>();
+        VERIFY(response);
+        return response.release_nonnull();
+    }
+
+    template<typename RequestType, typename... Args>
+    OwnPtr<typename RequestType::ResponseType> send_sync_but_allow_failure(Args&&... args)
+    {
+        post_message(RequestType(forward<Args>(args)...));
+        expect_response<typename RequestType::ResponseType>(nullptr);
+        return wait_for_specific_endpoint_message<typename RequestType::ResponseType, PeerEndpoint>();
+    }
+
+    // Sends a synchronous request without waiting for it, and resolves the returned promise once the response
+    // arrives. Several requests can be in flight at the same time this way.
+    template<typename RequestType, typename... Args>
+    NonnullRefPtr<Core::Promise<NonnullOwnPtr<typename RequestType::ResponseType>>> send_with_promise(Args&&... args)
+    {
+        using ResponseType = typename RequestType::ResponseType;
+        auto promise = Core::Promise<NonnullOwnPtr<ResponseType>>::construct();
+        post_message(RequestType(forward<Args>(args)...));
+        expect_response<ResponseType>([promise](NonnullOwnPtr<Message> response) mutable {
+            promise->resolve(response.template release_nonnull<ResponseType>());
+        });
+        return promise;
+    }
+
+    // Sends a synchronous request without caring about its response, which is dropped once it arrives.
+    template<typename RequestType>
+    void post_message_and_ignore_response(RequestType const& request)
+    {
+        post_message(request);
+        expect_response<typename RequestType::ResponseType>([](auto) {});
+    }
+
+    virtual void may_have_become_unresponsive() { }
+    virtual void did_become_responsive() { }
+
+    void shutdown()
+    {
+        m_batched_messages = {};
+        m_notifier->close();
+        m_socket->close();
+        die();
+    }
+
+    virtual void die() { }
+
+    bool is_open() const { return m_socket->is_open(); }
+
+protected:
+    Core::LocalSocket& socket() { return *m_socket; }
 
+    void write_message_buffer(MessageBuffer const& buffer)
+    {
+        size_t total_nwritten = 0;
 #ifdef __serenity__
-        for (auto& fd : buffer.fds) {
-            auto rc = sendfd(m_socket->fd(), fd->value());
-            if (rc < 0) {
-                perror("sendfd");
+        if (!buffer.fds.is_empty()) {
+            // All the file descriptors go along with the first write, so they only take a single syscall.
+            auto nwritten = send_with_fds(buffer);
+            if (nwritten < 0) {
+                perror("Connection::post_message sendmsg");
                 shutdown();
+                return;
             }
+            total_nwritten = nwritten;
         }
 #else
         if (!buffer.fds.is_empty())
             warnln("fd passing is not supported on this platform, sorry :(");
 #endif
 
-        size_t total_nwritten = 0;
         while (total_nwritten < buffer.data.size()) {
             auto nwritten = write(m_socket->fd(), buffer.data.data() + total_nwritten, buffer.data.size() - total_nwritten);
             if (nwritten < 0) {
@@ -104,42 +219,111 @@ public:
         m_responsiveness_timer->start();
     }
 
-    template<typename RequestType, typename... Args>
-    NonnullOwnPtr<typename RequestType::ResponseType> send_sync(Args&&... args)
+    // Responses arrive in the order their requests were sent, so each one belongs to the oldest request
+    // of its type that is still waiting. A null callback means that someone is waiting for it synchronously.
+    struct PendingResponse {
+        int message_id { 0 };
+        Function<void(NonnullOwnPtr<Message>)> callback;
+    };
+
+    template<typename ResponseType>
+    void expect_response(Function<void(NonnullOwnPtr<Message>)> callback)
     {
-        post_message(RequestType(forward<Args>(args)...));
-        auto response = wait_for_specific_endpoint_message<typename RequestType::ResponseType, PeerEndpoint>();
-        VERIFY(response);
-        return response.release_nonnull();
+        // Synchronous callers find their response on their own if nothing else is waiting for one like it.
+        if (!callback && !has_pending_response(ResponseType::static_message_id()))
+            return;
+        m_pending_responses.append({ ResponseType::static_message_id(), move(callback) });
     }
 
-    template<typename RequestType, typename... Args>
-    OwnPtr<typename RequestType::ResponseType> send_sync_but_allow_failure(Args&&... args)
+    bool has_pending_response(int message_id) const
     {
-        post_message(RequestType(forward<Args>(args)...));
-        return wait_for_specific_endpoint_message<typename RequestType::ResponseType, PeerEndpoint>();
+        for (auto& pending_response : m_pending_responses) {
+            if (pending_response.message_id == message_id)
+                return true;
+        }
+        return false;
     }
 
-    virtual void may_have_become_unresponsive() { }
-    virtual void did_become_responsive() { }
-
-    void shutdown()
+    void did_receive_response(NonnullOwnPtr<Message> response)
     {
-        m_notifier->close();
-        m_socket->close();
-        die();
+        for (size_t i = 0; i < m_pending_responses.size(); ++i) {
+            if (m_pending_responses[i].message_id != response->message_id())
+                continue;
+            auto pending_response = m_pending_responses.take(i);
+            if (pending_response.callback) {
+                // This is called while the received bytes are being parsed, which the callback mustn't get in the way of.
+                deferred_invoke([callback = move(pending_response.callback), response = move(response)](auto&) mutable {
+                    callback(move(response));
+                });
+                return;
+            }
+            break;
+        }
+        m_unprocessed_messages.append(move(response));
     }
 
-    virtual void die() { }
+#ifdef __serenity__
+    void move_message_to_shared_memory(MessageBuffer& buffer, uint32_t& message_size)
+    {
+        auto shared_buffer = Core::AnonymousBuffer::create_with_size(buffer.data.size());
+        if (!shared_buffer.is_valid())
+            return;
+        int fd = dup(shared_buffer.fd());
+        if (fd < 0) {
+            perror("Connection::post_message dup");
+            return;
+        }
+        memcpy(shared_buffer.data<void>(), buffer.data.data(), buffer.data.size());
+        message_size = buffer.data.size() | message_in_shared_memory_flag;
+        buffer.data.clear();
+        buffer.fds.prepend(adopt_ref(*new AutoCloseFileDescriptor(fd)));
+    }
 
-    bool is_open() const { return m_socket->is_open(); }
+    OwnPtr<Message> decode_message_from_shared_memory(u32 size)
+    {
+        int fd = recvfd(m_socket->fd(), O_CLOEXEC);
+        if (fd < 0) {
+            perror("recvfd");
+            return {};
+        }
+        auto shared_buffer = Core::AnonymousBuffer::create_from_anon_fd(fd, size);
+        if (!shared_buffer.is_valid()) {
+            close(fd);
+            return {};
+        }
+        // The message is decoded straight out of the mapping, and the buffer goes away once it has been.
+        auto bytes = ReadonlyBytes { shared_buffer.data<u8>(), size };
+        if (auto message = LocalEndpoint::decode_message(bytes, m_socket->fd()))
+            return message;
+        return PeerEndpoint::decode_message(bytes, m_socket->fd());
+    }
 
-protected:
-    Core::LocalSocket& socket() { return *m_socket; }
+    ssize_t send_with_fds(const MessageBuffer& buffer)
+    {
+        Vector<u8> control;
+        control.resize(CMSG_SPACE(buffer.fds.size() * sizeof(int)));
+        auto* cmsg = reinterpret_cast<cmsghdr*>(control.data());
+        cmsg->cmsg_len = CMSG_LEN(buffer.fds.size() * sizeof(int));
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        auto* fds = reinterpret_cast<int*>(CMSG_DATA(cmsg));
+        for (size_t i = 0; i < buffer.fds.size(); ++i)
+            fds[i] = buffer.fds[i]->value();
+
+        iovec iov { const_cast<u8*>(buffer.data.data()), buffer.data.size() };
+        msghdr msg {};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.data();
+        msg.msg_controllen = cmsg->cmsg_len;
+        return sendmsg(m_socket->fd(), &msg, 0);
+    }
+#endif
 
     template<typename MessageType, typename Endpoint>
     OwnPtr<MessageType> wait_for_specific_endpoint_message()
     {
+        flush_batched_messages();
         for (;;) {
             // Double check we don't already have the event waiting for us.
             // Otherwise we might end up blocked for a while for no reason.
@@ -177,16 +361,18 @@ protected:
 
     bool drain_messages_from_peer()
     {
-        Vector<u8> bytes;
-
-        if (!m_unprocessed_bytes.is_empty()) {
-            bytes.append(m_unprocessed_bytes.data(), m_unprocessed_bytes.size());
-            m_unprocessed_bytes.clear();
-        }
+        // Received bytes go straight into the buffer, after whatever was left over from last time. The buffer
+        // keeps its capacity, so once a connection has seen its biggest burst of messages it stops allocating here.
+        auto& bytes = m_unprocessed_bytes;
+        size_t received_byte_count = 0;
 
         while (m_socket->is_open()) {
-            u8 buffer[4096];
-            ssize_t nread = recv(m_socket->fd(), buffer, sizeof(buffer), MSG_DONTWAIT);
+            static constexpr size_t receive_chunk_size = 16 * KiB;
+            auto old_size = bytes.size();
+            bytes.grow_capacity(old_size + receive_chunk_size);
+            bytes.resize_and_keep_capacity(old_size + receive_chunk_size);
+            ssize_t nread = recv(m_socket->fd(), bytes.data() + old_size, receive_chunk_size, MSG_DONTWAIT);
+            bytes.shrink(old_size + (nread > 0 ? nread : 0), true);
             if (nread < 0) {
                 if (errno == EAGAIN)
                     break;
@@ -201,18 +387,37 @@ protected:
                 }
                 break;
             }
-            bytes.append(buffer, nread);
+            received_byte_count += nread;
         }
 
-        if (!bytes.is_empty()) {
+        if (received_byte_count != 0) {
             m_responsiveness_timer->stop();
             did_become_responsive();
         }
 
         size_t index = 0;
         u32 message_size = 0;
-        for (; index + sizeof(message_size) < bytes.size(); index += message_size) {
+        for (; index + sizeof(message_size) <= bytes.size(); index += message_size) {
             memcpy(&message_size, bytes.data() + index, sizeof(message_size));
+            if (message_size & message_in_shared_memory_flag) {
+#ifdef __serenity__
+                auto message = decode_message_from_shared_memory(message_size & ~message_in_shared_memory_flag);
+#else
+                OwnPtr<Message> message;
+#endif
+                if (!message) {
+                    dbgln("{}::drain_messages_from_peer: Failed to parse a message from shared memory", *this);
+                    shutdown();
+                    return false;
+                }
+                if (message->endpoint_magic() == LocalEndpoint::static_magic())
+                    m_unprocessed_messages.append(message.release_nonnull());
+                else
+                    did_receive_response(message.release_nonnull());
+                index += sizeof(message_size);
+                message_size = 0;
+                continue;
+            }
             if (message_size == 0 || bytes.size() - index - sizeof(uint32_t) < message_size)
                 break;
             index += sizeof(message_size);
@@ -220,25 +425,19 @@ protected:
             if (auto message = LocalEndpoint::decode_message(remaining_bytes, m_socket->fd())) {
                 m_unprocessed_messages.append(message.release_nonnull());
             } else if (auto message = PeerEndpoint::decode_message(remaining_bytes, m_socket->fd())) {
-                m_unprocessed_messages.append(message.release_nonnull());
+                did_receive_response(message.release_nonnull());
             } else {
                 dbgln("Failed to parse a message");
                 break;
             }
         }
 
-        if (index < bytes.size()) {
-            // Sometimes we might receive a partial message. That's okay, just stash away
-            // the unprocessed bytes and we'll prepend them to the next incoming message
-            // in the next run of this function.
-            auto remaining_bytes = ByteBuffer::copy(bytes.data() + index, bytes.size() - index);
-            if (!m_unprocessed_bytes.is_empty()) {
-                dbgln("{}::drain_messages_from_peer: Already have unprocessed bytes", *this);
-                shutdown();
-                return false;
-            }
-            m_unprocessed_bytes = remaining_bytes;
-        }
+        // Sometimes we might receive a partial message. That's okay, it stays in the buffer
+        // and the rest of it will be appended in the next run of this function.
+        if (index == bytes.size())
+            bytes.clear_with_capacity();
+        else
+            bytes.remove(0, index);
 
         if (!m_unprocessed_messages.is_empty()) {
             deferred_invoke([this](auto&) {
@@ -265,7 +464,11 @@ protected:
 
     RefPtr<Core::Notifier> m_notifier;
     NonnullOwnPtrVector<Message> m_unprocessed_messages;
-    ByteBuffer m_unprocessed_bytes;
+    Vector<u8> m_unprocessed_bytes;
+    Vector<PendingResponse> m_pending_responses;
+
+    bool m_batches_messages { false };
+    MessageBuffer m_batched_messages;
 };
 
 }
@@ -8,6 +8,7 @@
 
 #include <AK/Concepts.h>
 #include <AK/Forward.h>
+#include <AK/MemoryStream.h>
 #include <AK/NumericLimits.h>
 #include <AK/StdLibExtras.h>
 #include <AK/String.h>
@@ -90,6 +91,18 @@ public:
         u64 size;
         if (!decode(size) || size > NumericLimits<i32>::max())
             return false;
+        if constexpr (IsSame<T, u8>) {
+            if (size > m_stream.remaining())
+                return false;
+            if (size == 0)
+                return true;
+            auto old_size = vector.size();
+            vector.resize(old_size + size);
+            m_stream >> Bytes { vector.data() + old_size, static_cast<size_t>(size) };
+            return !m_stream.handle_any_error();
+        }
+        // Every element takes up at least one byte, so a bogus size can't make this allocate more than the message itself.
+        vector.ensure_capacity(vector.size() + min(static_cast<size_t>(size), m_stream.remaining()));
         for (size_t i = 0; i < size; ++i) {
             T value;
             if (!decode(value))
@@ -59,6 +59,10 @@ public:
     Encoder& operator<<(const Vector<T>& vector)
     {
         *this << (u64)vector.size();
+        if constexpr (IsSame<T, u8>) {
+            m_buffer.data.append(vector.data(), vector.size());
+            return *this;
+        }
         for (auto& value : vector)
             *this << value;
         return *this;
@@ -16,23 +16,49 @@ Client::Client()
 
 void Client::die()
 {
+    auto pending_decodes = move(m_pending_decodes);
+    for (auto& it : pending_decodes)
+        it.value({});
+
     if (on_death)
         on_death();
 }
 
-Optional<DecodedImage> Client::decode_image(const ByteBuffer& encoded_data)
+static Optional<Core::AnonymousBuffer> copy_to_anonymous_buffer(const ByteBuffer& encoded_data)
 {
-    if (encoded_data.is_empty())
-        return {};
-
     auto encoded_buffer = Core::AnonymousBuffer::create_with_size(encoded_data.size());
     if (!encoded_buffer.is_valid()) {
         dbgln("Could not allocate encoded buffer");
         return {};
     }
-
     memcpy(encoded_buffer.data<void>(), encoded_data.data(), encoded_data.size());
-    auto response_or_error = try_decode_image(move(encoded_buffer));
+    return encoded_buffer;
+}
+
+static DecodedImage make_decoded_image(bool is_animated, u32 loop_count, Vector<Gfx::ShareableBitmap> const& bitmaps, Vector<u32> const& durations)
+{
+    DecodedImage image;
+    image.is_animated = is_animated;
+    image.loop_count = loop_count;
+    image.frames.resize(bitmaps.size());
+    for (size_t i = 0; i < image.frames.size(); ++i) {
+        auto& frame = image.frames[i];
+        frame.bitmap = bitmaps[i].bitmap();
+        frame.duration = durations[i];
+    }
+    return image;
+}
+
+Optional<DecodedImage> Client::decode_image(const ByteBuffer& encoded_data)
+{
+    if (encoded_data.is_empty())
+        return {};
+
+    auto encoded_buffer = copy_to_anonymous_buffer(encoded_data);
+    if (!encoded_buffer.has_value())
+        return {};
+
+    auto response_or_error = try_decode_image(encoded_buffer.release_value());
 
     if (response_or_error.is_error()) {
         dbgln("ImageDecoder died heroically");
@@ -44,16 +70,60 @@ Optional<DecodedImage> Client::decode_image(const ByteBuffer& encoded_data)
     if (response.bitmaps().is_empty())
         return {};
 
-    DecodedImage image;
-    image.is_animated = response.is_animated();
-    image.loop_count = response.loop_count();
-    image.frames.resize(response.bitmaps().size());
-    for (size_t i = 0; i < image.frames.size(); ++i) {
-        auto& frame = image.frames[i];
-        frame.bitmap = response.bitmaps()[i].bitmap();
-        frame.duration = response.durations()[i];
+    return make_decoded_image(response.is_animated(), response.loop_count(), response.bitmaps(), response.durations());
+}
+
+i32 Client::start_decoding_image(const ByteBuffer& encoded_data, Function<void(Optional<DecodedImage>)> on_complete, bool is_visible, Gfx::IntSize ideal_size)
+{
+    auto image_id = m_next_image_id++;
+
+    auto encoded_buffer = encoded_data.is_empty() ? Optional<Core::AnonymousBuffer> {} : copy_to_anonymous_buffer(encoded_data);
+    if (!encoded_buffer.has_value()) {
+        deferred_invoke([on_complete = move(on_complete)](auto&) {
+            on_complete({});
+        });
+        return image_id;
     }
-    return image;
+
+    m_pending_decodes.set(image_id, move(on_complete));
+    async_start_decoding_image(image_id, encoded_buffer.release_value(), ideal_size, is_visible);
+    return image_id;
+}
+
+void Client::set_image_visible(i32 image_id, bool is_visible)
+{
+    if (m_pending_decodes.contains(image_id))
+        async_set_image_visible(image_id, is_visible);
+}
+
+void Client::cancel_decoding_image(i32 image_id)
+{
+    if (m_pending_decodes.remove(image_id))
+        async_cancel_decoding_image(image_id);
+}
+
+void Client::did_decode_image(i32 image_id, bool is_animated, u32 loop_count, Vector<Gfx::ShareableBitmap> const& bitmaps, Vector<u32> const& durations)
+{
+    auto it = m_pending_decodes.find(image_id);
+    if (it == m_pending_decodes.end())
+        return;
+    auto on_complete = move(it->value);
+    m_pending_decodes.remove(it);
+    if (bitmaps.is_empty()) {
+        on_complete({});
+        return;
+    }
+    on_complete(make_decoded_image(is_animated, loop_count, bitmaps, durations));
+}
+
+void Client::did_fail_to_decode_image(i32 image_id)
+{
+    auto it = m_pending_decodes.find(image_id);
+    if (it == m_pending_decodes.end())
+        return;
+    auto on_complete = move(it->value);
+    m_pending_decodes.remove(it);
+    on_complete({});
 }
 
 }
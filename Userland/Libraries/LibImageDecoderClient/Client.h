@@ -32,12 +32,25 @@ class Client final
 public:
     Optional<DecodedImage> decode_image(const ByteBuffer&);
 
+    // Decodes the image on one of ImageDecoder's threads, and calls on_complete with it, or with nothing if it can't
+    // be decoded. Visible images are decoded before the others. An image that is only going to be shown small can
+    // be decoded to (at least) an ideal size, which may be much less work than decoding all of it.
+    i32 start_decoding_image(const ByteBuffer&, Function<void(Optional<DecodedImage>)> on_complete, bool is_visible = false, Gfx::IntSize ideal_size = {});
+    void set_image_visible(i32 image_id, bool is_visible);
+    void cancel_decoding_image(i32 image_id);
+
     Function<void()> on_death;
 
 private:
     Client();
 
     virtual void die() override;
+
+    virtual void did_decode_image(i32 image_id, bool is_animated, u32 loop_count, Vector<Gfx::ShareableBitmap> const& bitmaps, Vector<u32> const& durations) override;
+    virtual void did_fail_to_decode_image(i32 image_id) override;
+
+    HashMap<i32, Function<void(Optional<DecodedImage>)>> m_pending_decodes;
+    i32 m_next_image_id { 1 };
 };
 
 }
@@ -14,6 +14,7 @@
 #include <LibCrypto/BigInt/SignedBigInteger.h>
 #include <LibJS/AST.h>
 #include <LibJS/Interpreter.h>
+#include <LibJS/Parser.h>
 #include <LibJS/Runtime/AbstractOperations.h>
 #include <LibJS/Runtime/Accessor.h>
 #include <LibJS/Runtime/Array.h>
@@ -93,6 +94,18 @@ Value Program::execute(Interpreter& interpreter, GlobalObject& global_object) co
     return interpreter.execute_statement(global_object, *this, ScopeType::Block);
 }
 
+BlockStatement const& LazyFunctionBody::body() const
+{
+    if (!m_body)
+        m_body = Parser::parse_lazy_function_body(*this);
+    return *m_body;
+}
+
+Value LazyFunctionBody::execute(Interpreter& interpreter, GlobalObject& global_object) const
+{
+    return body().execute(interpreter, global_object);
+}
+
 Value FunctionDeclaration::execute(Interpreter& interpreter, GlobalObject&) const
 {
     InterpreterNodeScope node_scope { interpreter, *this };
@@ -1004,6 +1017,18 @@ void ScopeNode::dump(int indent) const
     }
 }
 
+void LazyFunctionBody::dump(int indent) const
+{
+    // Dumping shouldn't be what makes us parse the body.
+    if (m_body) {
+        m_body->dump(indent);
+        return;
+    }
+    ASTNode::dump(indent);
+    print_indent(indent + 1);
+    outln("(Not parsed yet, {} bytes of source)", m_end_offset - m_start_offset);
+}
+
 void BinaryExpression::dump(int indent) const
 {
     const char* op_string = nullptr;
@@ -2074,19 +2099,19 @@ Value TemplateLiteral::execute(Interpreter& interpreter, GlobalObject& global_ob
 {
     InterpreterNodeScope node_scope { interpreter, *this };
 
-    StringBuilder string_builder;
+    PrimitiveString* result = &interpreter.vm().empty_string();
 
     for (auto& expression : m_expressions) {
         auto expr = expression.execute(interpreter, global_object);
         if (interpreter.exception())
             return {};
-        auto string = expr.to_string(global_object);
+        auto* string = expr.to_primitive_string(global_object);
         if (interpreter.exception())
             return {};
-        string_builder.append(string);
+        result = js_rope_string(interpreter.vm(), *result, *string);
     }
 
-    return js_string(interpreter.heap(), string_builder.build());
+    return result;
 }
 
 void TaggedTemplateLiteral::dump(int indent) const
@@ -60,6 +60,7 @@ public:
     virtual bool is_identifier() const { return false; }
     virtual bool is_scope_node() const { return false; }
     virtual bool is_program() const { return false; }
+    virtual bool is_lazy_function_body() const { return false; }
 
 protected:
     explicit ASTNode(SourceRange source_range)
@@ -177,10 +178,21 @@ public:
     bool is_strict_mode() const { return m_is_strict_mode; }
     void set_strict_mode() { m_is_strict_mode = true; }
 
+    // Every function and class node the parser created for this program, in the order it created them.
+    // Parsing the same source the same way always produces the same list, so cached bytecode can refer to these nodes
+    // by index. The nodes nested in a lazily parsed function body are left out, so the list depends on the parse mode.
+    NonnullRefPtrVector<ASTNode> const& function_and_class_nodes() const { return m_function_and_class_nodes; }
+    void set_function_and_class_nodes(NonnullRefPtrVector<ASTNode> nodes) { m_function_and_class_nodes = move(nodes); }
+
+    bool has_lazily_parsed_function_bodies() const { return m_has_lazily_parsed_function_bodies; }
+    void set_has_lazily_parsed_function_bodies(bool value) { m_has_lazily_parsed_function_bodies = value; }
+
 private:
     virtual bool is_program() const override { return true; }
 
     bool m_is_strict_mode { false };
+    bool m_has_lazily_parsed_function_bodies { false };
+    NonnullRefPtrVector<ASTNode> m_function_and_class_nodes;
 };
 
 class BlockStatement final : public ScopeNode {
@@ -191,6 +203,62 @@ public:
     }
 };
 
+// Stands in for the body of a function that was only checked for errors while its enclosing code was parsed.
+// The body is parsed again from its source text the first time it's needed, see Parser::parse_lazy_function_body().
+class LazyFunctionBody final : public Statement {
+public:
+    // The parser state at the start of the body, which has to be restored to parse it the same way again.
+    struct Context {
+        bool strict_mode { false };
+        bool allow_super_property_lookup { false };
+        bool allow_super_constructor_call { false };
+        bool in_generator_function_context { false };
+        bool in_arrow_function_context { false };
+        bool in_break_context { false };
+        bool in_continue_context { false };
+    };
+
+    LazyFunctionBody(SourceRange source_range, String source, String filename, size_t start_offset, size_t end_offset, Context context, bool is_strict_mode, HashMap<size_t, NonnullRefPtr<LazyFunctionBody>> inner_function_bodies)
+        : Statement(source_range)
+        , m_source(move(source))
+        , m_filename(move(filename))
+        , m_start_offset(start_offset)
+        , m_end_offset(end_offset)
+        , m_context(context)
+        , m_is_strict_mode(is_strict_mode)
+        , m_inner_function_bodies(move(inner_function_bodies))
+    {
+    }
+
+    BlockStatement const& body() const;
+
+    String const& source() const { return m_source; }
+    String const& filename() const { return m_filename; }
+    size_t start_offset() const { return m_start_offset; }
+    size_t end_offset() const { return m_end_offset; }
+    Context const& context() const { return m_context; }
+    bool is_strict_mode() const { return m_is_strict_mode; }
+
+    // Bodies of the functions inside this one, keyed by their start offset, so parsing this body can skip over them.
+    HashMap<size_t, NonnullRefPtr<LazyFunctionBody>> const& inner_function_bodies() const { return m_inner_function_bodies; }
+
+    virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual void dump(int indent) const override;
+    virtual void generate_bytecode(Bytecode::Generator&) const override;
+
+private:
+    virtual bool is_lazy_function_body() const override { return true; }
+
+    String m_source;
+    String m_filename;
+    size_t m_start_offset { 0 };
+    size_t m_end_offset { 0 };
+    Context m_context;
+    bool m_is_strict_mode { false };
+    HashMap<size_t, NonnullRefPtr<LazyFunctionBody>> m_inner_function_bodies;
+    mutable RefPtr<BlockStatement> m_body;
+};
+
 class Expression : public ASTNode {
 public:
     explicit Expression(SourceRange source_range)
@@ -1484,4 +1552,7 @@ inline bool ASTNode::fast_is<ScopeNode>() const { return is_scope_node(); }
 template<>
 inline bool ASTNode::fast_is<Program>() const { return is_program(); }
 
+template<>
+inline bool ASTNode::fast_is<LazyFunctionBody>() const { return is_lazy_function_body(); }
+
 }
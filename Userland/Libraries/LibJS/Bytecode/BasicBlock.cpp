@@ -64,6 +64,25 @@ void BasicBlock::grow(size_t additional_size)
     VERIFY(m_buffer_size <= m_buffer_capacity);
 }
 
+void BasicBlock::remove_instructions(HashTable<Instruction const*> const& instructions_to_remove)
+{
+    size_t new_size = 0;
+    Bytecode::InstructionStreamIterator it(instruction_stream());
+    while (!it.at_end()) {
+        auto& instruction = const_cast<Instruction&>(*it);
+        auto length = instruction.length();
+        ++it;
+        if (instructions_to_remove.contains(&instruction)) {
+            Instruction::destroy(instruction);
+            continue;
+        }
+        if (m_buffer + new_size != reinterpret_cast<u8*>(&instruction))
+            __builtin_memmove(m_buffer + new_size, &instruction, length);
+        new_size += length;
+    }
+    m_buffer_size = new_size;
+}
+
 void InstructionStreamIterator::operator++()
 {
     VERIFY(!at_end());
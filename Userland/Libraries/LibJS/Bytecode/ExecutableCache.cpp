@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Hex.h>
+#include <LibCore/File.h>
+#include <LibCrypto/Hash/SHA2.h>
+#include <LibJS/AST.h>
+#include <LibJS/Bytecode/ExecutableCache.h>
+#include <LibJS/Bytecode/Serialization.h>
+#include <stdio.h>
+#include <unistd.h>
+
+namespace JS::Bytecode {
+
+String ExecutableCache::path_for(StringView source, Program const& program, bool optimized) const
+{
+    auto digest = Crypto::Hash::SHA256::hash(source);
+    auto hash = encode_hex({ digest.immutable_data(), digest.data_length() });
+    // Executables refer to function and class nodes by index, and which nodes there are depends on the parse mode.
+    // Keeping the modes apart also stops eager and lazy runs from replacing each other's entries.
+    return String::formatted("{}/{}{}{}.bc", m_directory, hash, program.has_lazily_parsed_function_bodies() ? "-lazy" : "", optimized ? "-opt" : "");
+}
+
+Optional<Executable> ExecutableCache::load(StringView source, Program const& program, bool optimized) const
+{
+    auto file_or_error = Core::File::open(path_for(source, program, optimized), Core::OpenMode::ReadOnly);
+    if (file_or_error.is_error())
+        return {};
+    auto bytes = file_or_error.value()->read_all();
+    auto executable = deserialize_executable(bytes, program);
+    if (!executable.has_value())
+        dbgln("ExecutableCache: Ignoring unreadable cache entry for program with {} bytes of source", source.length());
+    return executable;
+}
+
+void ExecutableCache::store(StringView source, Program const& program, Executable const& executable, bool optimized) const
+{
+    auto bytes = serialize_executable(executable, program);
+    if (bytes.is_empty())
+        return;
+
+    auto path = path_for(source, program, optimized);
+    if (!Core::File::ensure_parent_directories(path))
+        return;
+
+    // Write to a file of our own first, so a concurrent load never sees a partially written entry.
+    auto temporary_path = String::formatted("{}.{}", path, getpid());
+    auto file_or_error = Core::File::open(temporary_path, (Core::OpenMode)(Core::OpenMode::WriteOnly | Core::OpenMode::Truncate));
+    if (file_or_error.is_error())
+        return;
+    auto& file = *file_or_error.value();
+    if (!file.write(bytes.data(), bytes.size()) || !file.close()) {
+        unlink(temporary_path.characters());
+        return;
+    }
+    if (rename(temporary_path.characters(), path.characters()) < 0)
+        unlink(temporary_path.characters());
+}
+
+}
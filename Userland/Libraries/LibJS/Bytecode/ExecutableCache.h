@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Optional.h>
+#include <AK/String.h>
+#include <LibJS/Bytecode/Generator.h>
+#include <LibJS/Forward.h>
+
+namespace JS::Bytecode {
+
+// Keeps serialized executables of top-level programs in a directory, keyed by a hash of their source code and by how
+// it was parsed.
+// The program still has to be parsed, as functions and classes are compiled from their AST nodes when they're created,
+// but a hit skips code generation and the optimization passes.
+class ExecutableCache {
+public:
+    explicit ExecutableCache(String directory)
+        : m_directory(move(directory))
+    {
+    }
+
+    Optional<Executable> load(StringView source, Program const&, bool optimized) const;
+    void store(StringView source, Program const&, Executable const&, bool optimized) const;
+
+private:
+    String path_for(StringView source, Program const&, bool optimized) const;
+
+    String m_directory;
+};
+
+}
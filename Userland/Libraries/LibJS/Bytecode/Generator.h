@@ -15,6 +15,7 @@
 #include <LibJS/Bytecode/Register.h>
 #include <LibJS/Bytecode/StringTable.h>
 #include <LibJS/Forward.h>
+#include <LibJS/JIT/NativeExecutable.h>
 
 namespace JS::Bytecode {
 
@@ -23,6 +24,10 @@ struct Executable {
     NonnullOwnPtr<StringTable> string_table;
     size_t number_of_registers { 0 };
 
+    // Compiled the first time this runs with the JIT enabled, unless the platform doesn't support it.
+    mutable OwnPtr<JIT::NativeExecutable> native_executable;
+    mutable bool did_try_to_compile { false };
+
     String const& get_string(StringTableIndex index) const { return string_table->get(index); }
 };
 
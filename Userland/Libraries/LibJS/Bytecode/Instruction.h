@@ -77,6 +77,10 @@
 
 namespace JS::Bytecode {
 
+class Decoder;
+class Encoder;
+class Register;
+
 class Instruction {
 public:
     constexpr static bool IsTerminator = false;
@@ -96,6 +100,19 @@ public:
     void replace_references(BasicBlock const&, BasicBlock const&);
     static void destroy(Instruction&);
 
+    // Writes the instruction's operands, or emits an instruction of the given type with operands read from the decoder.
+    void encode(Encoder&) const;
+    static bool decode(Type, Decoder&);
+
+    enum class RegisterAccess {
+        Read,
+        Write,
+        ReadWrite,
+    };
+
+    // Calls back with every register operand, not including the accumulator that most instructions use implicitly.
+    void for_each_register_operand(Function<void(Register&, RegisterAccess)> const&);
+
 protected:
     explicit Instruction(Type type)
         : m_type(type)
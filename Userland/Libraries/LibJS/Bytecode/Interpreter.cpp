@@ -10,18 +10,29 @@
 #include <LibJS/Bytecode/Instruction.h>
 #include <LibJS/Bytecode/Interpreter.h>
 #include <LibJS/Bytecode/Op.h>
+#include <LibJS/JIT/Compiler.h>
 #include <LibJS/Runtime/GlobalEnvironment.h>
 #include <LibJS/Runtime/GlobalObject.h>
 
 namespace JS::Bytecode {
 
 static Interpreter* s_current;
+bool Interpreter::s_jit_enabled = false;
 
 Interpreter* Interpreter::current()
 {
     return s_current;
 }
 
+template<typename OpType>
+ALWAYS_INLINE static size_t instruction_length(OpType const& instruction)
+{
+    if constexpr (requires { instruction.length_impl(); })
+        return instruction.length_impl();
+    else
+        return sizeof(OpType);
+}
+
 Interpreter::Interpreter(GlobalObject& global_object)
     : m_vm(global_object.vm())
     , m_global_object(global_object)
@@ -36,6 +47,18 @@ Interpreter::~Interpreter()
     s_current = nullptr;
 }
 
+void Interpreter::gather_roots(HashTable<Cell*>& roots)
+{
+    for (auto& window : m_register_windows) {
+        for (auto& value : window) {
+            if (value.is_cell())
+                roots.set(&value.as_cell());
+        }
+    }
+    if (m_return_value.is_cell())
+        roots.set(&m_return_value.as_cell());
+}
+
 Value Interpreter::run(Executable const& executable, BasicBlock const* entry_point)
 {
     dbgln_if(JS_BYTECODE_DEBUG, "Bytecode::Interpreter will run unit {:p}", &executable);
@@ -67,52 +90,80 @@ Value Interpreter::run(Executable const& executable, BasicBlock const* entry_poi
         registers()[Register::global_object_index] = Value(&global_object());
     }
 
+    // Every instruction handler jumps straight to the next instruction's handler through this table, instead of
+    // going back to a single switch that all instructions share (and whose one indirect branch mispredicts a lot).
+    static void* const s_dispatch_table[] = {
+#define __BYTECODE_OP(op) &&handle_##op,
+        ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+#undef __BYTECODE_OP
+    };
+
+    JIT::NativeExecutable const* native_executable = nullptr;
+    if (s_jit_enabled) {
+        if (!executable.did_try_to_compile) {
+            executable.native_executable = JIT::Compiler::compile(executable);
+            executable.did_try_to_compile = true;
+        }
+        native_executable = executable.native_executable.ptr();
+    }
+
     for (;;) {
-        Bytecode::InstructionStreamIterator pc(block->instruction_stream());
-        bool will_jump = false;
-        bool will_return = false;
-        while (!pc.at_end()) {
-            auto& instruction = *pc;
-            instruction.execute(*this);
-            if (vm().exception()) {
-                m_saved_exception = {};
-                if (m_unwind_contexts.is_empty())
-                    break;
-                auto& unwind_context = m_unwind_contexts.last();
-                if (unwind_context.handler) {
-                    block = unwind_context.handler;
-                    unwind_context.handler = nullptr;
-                    accumulator() = vm().exception()->value();
-                    vm().clear_exception();
-                    will_jump = true;
-                } else if (unwind_context.finalizer) {
-                    block = unwind_context.finalizer;
-                    m_unwind_contexts.take_last();
-                    will_jump = true;
-                    m_saved_exception = Handle<Exception>::create(vm().exception());
-                    vm().clear_exception();
-                }
-            }
-            if (m_pending_jump.has_value()) {
-                block = m_pending_jump.release_value();
-                will_jump = true;
+        u8 const* pc = block->instruction_stream().data();
+        u8 const* end = pc + block->size();
+        if (pc == end)
+            break;
+
+        if (native_executable) {
+            native_executable->run_block(*block, *this);
+            pc = end;
+            goto did_execute_instruction;
+        }
+
+        goto* s_dispatch_table[to_underlying(reinterpret_cast<Instruction const*>(pc)->type())];
+
+#define __BYTECODE_OP(op)                                                     \
+    handle_##op:                                                              \
+    {                                                                         \
+        auto& instruction = *reinterpret_cast<Op::op const*>(pc);             \
+        instruction.execute_impl(*this);                                      \
+        pc += instruction_length(instruction);                                \
+        goto did_execute_instruction;                                         \
+    }
+
+        ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+#undef __BYTECODE_OP
+
+    did_execute_instruction:
+        if (vm().exception()) [[unlikely]] {
+            m_saved_exception = {};
+            if (m_unwind_contexts.is_empty())
                 break;
+            auto& unwind_context = m_unwind_contexts.last();
+            if (unwind_context.handler) {
+                block = unwind_context.handler;
+                unwind_context.handler = nullptr;
+                accumulator() = vm().exception()->value();
+                vm().clear_exception();
+                continue;
             }
-            if (!m_return_value.is_empty()) {
-                will_return = true;
-                break;
+            if (unwind_context.finalizer) {
+                block = unwind_context.finalizer;
+                m_unwind_contexts.take_last();
+                m_saved_exception = Handle<Exception>::create(vm().exception());
+                vm().clear_exception();
+                continue;
             }
-            ++pc;
-        }
-
-        if (will_return)
             break;
-
-        if (pc.at_end() && !will_jump)
+        }
+        if (m_pending_jump.has_value()) {
+            block = m_pending_jump.release_value();
+            continue;
+        }
+        if (!m_return_value.is_empty())
             break;
-
-        if (vm().exception())
+        if (pc == end)
             break;
+        goto* s_dispatch_table[to_underlying(reinterpret_cast<Instruction const*>(pc)->type())];
     }
 
     dbgln_if(JS_BYTECODE_DEBUG, "Bytecode::Interpreter did run unit {:p}", &executable);
@@ -148,6 +199,11 @@ Value Interpreter::run(Executable const& executable, BasicBlock const* entry_poi
     return return_value;
 }
 
+bool Interpreter::has_pending_control_flow()
+{
+    return vm().exception() || m_pending_jump.has_value() || !m_return_value.is_empty();
+}
+
 void Interpreter::enter_unwind_context(Optional<Label> handler_target, Optional<Label> finalizer_target)
 {
     m_unwind_contexts.empend(handler_target.has_value() ? &handler_target->block() : nullptr, finalizer_target.has_value() ? &finalizer_target->block() : nullptr);
@@ -191,6 +247,10 @@ Bytecode::PassManager& Interpreter::optimization_pipeline(Interpreter::Optimizat
         pm->add<Passes::MergeBlocks>();
         pm->add<Passes::GenerateCFG>();
         pm->add<Passes::PlaceBlocks>();
+        pm->add<Passes::EliminateRedundantMoves>();
+        pm->add<Passes::GenerateCFG>();
+        pm->add<Passes::AllocateRegisters>();
+        pm->add<Passes::EliminateRedundantMoves>();
     } else {
         VERIFY_NOT_REACHED();
     }
@@ -8,6 +8,7 @@
 
 #include "Generator.h"
 #include "PassManager.h"
+#include <AK/HashTable.h>
 #include <LibJS/Bytecode/Label.h>
 #include <LibJS/Bytecode/Register.h>
 #include <LibJS/Forward.h>
@@ -61,6 +62,15 @@ public:
 
     Executable const& current_executable() { return *m_current_executable; }
 
+    // The register windows live outside the GC heap, so the values in them have to be reported as roots.
+    void gather_roots(HashTable<Cell*>&);
+
+    // Whether the last instruction threw, jumped or returned, so that the next one in the block mustn't run.
+    bool has_pending_control_flow();
+
+    static bool is_jit_enabled() { return s_jit_enabled; }
+    static void set_jit_enabled(bool enabled) { s_jit_enabled = enabled; }
+
     enum class OptimizationLevel {
         Default,
         __Count,
@@ -71,6 +81,7 @@ private:
     RegisterWindow& registers() { return m_register_windows.last(); }
 
     static AK::Array<OwnPtr<PassManager>, static_cast<UnderlyingType<Interpreter::OptimizationLevel>>(Interpreter::OptimizationLevel::__Count)> s_optimization_pipelines;
+    static bool s_jit_enabled;
 
     VM& m_vm;
     GlobalObject& m_global_object;
@@ -6,10 +6,12 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/CharacterTypes.h>
 #include <AK/HashTable.h>
 #include <LibJS/AST.h>
 #include <LibJS/Bytecode/Interpreter.h>
 #include <LibJS/Bytecode/Op.h>
+#include <LibJS/Bytecode/Serialization.h>
 #include <LibJS/Runtime/Array.h>
 #include <LibJS/Runtime/BigInt.h>
 #include <LibJS/Runtime/DeclarativeEnvironment.h>
@@ -37,6 +39,36 @@ String Instruction::to_string(Bytecode::Executable const& executable) const
 #undef __BYTECODE_OP
 }
 
+void Instruction::encode(Bytecode::Encoder& encoder) const
+{
+#define __BYTECODE_OP(op)       \
+    case Instruction::Type::op: \
+        return static_cast<Bytecode::Op::op const&>(*this).encode_impl(encoder);
+
+    switch (type()) {
+        ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+#undef __BYTECODE_OP
+}
+
+bool Instruction::decode(Type type, Bytecode::Decoder& decoder)
+{
+#define __BYTECODE_OP(op)       \
+    case Instruction::Type::op: \
+        return Bytecode::Op::op::decode_impl(decoder);
+
+    switch (type) {
+        ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+    default:
+        return false;
+    }
+
+#undef __BYTECODE_OP
+}
+
 }
 
 namespace JS::Bytecode::Op {
@@ -86,6 +118,15 @@ static Value typed_equals(GlobalObject&, Value src1, Value src2)
     String OpTitleCase::to_string_impl(Bytecode::Executable const&) const                 \
     {                                                                                     \
         return String::formatted(#OpTitleCase " {}", m_lhs_reg);                          \
+    }                                                                                     \
+    void OpTitleCase::encode_impl(Bytecode::Encoder& encoder) const                       \
+    {                                                                                     \
+        encoder.encode(m_lhs_reg);                                                        \
+    }                                                                                     \
+    bool OpTitleCase::decode_impl(Bytecode::Decoder& decoder)                             \
+    {                                                                                     \
+        Register lhs_reg { 0 };                                                           \
+        return decoder.decode(lhs_reg) && decoder.emit<OpTitleCase>(lhs_reg);             \
     }
 
 JS_ENUMERATE_COMMON_BINARY_OPS(JS_DEFINE_COMMON_BINARY_OP)
@@ -108,6 +149,10 @@ static Value typeof_(GlobalObject& global_object, Value value)
     String OpTitleCase::to_string_impl(Bytecode::Executable const&) const                                  \
     {                                                                                                      \
         return #OpTitleCase;                                                                               \
+    }                                                                                                      \
+    bool OpTitleCase::decode_impl(Bytecode::Decoder& decoder)                                              \
+    {                                                                                                      \
+        return decoder.emit<OpTitleCase>();                                                                \
     }
 
 JS_ENUMERATE_COMMON_UNARY_OPS(JS_DEFINE_COMMON_UNARY_OP)
@@ -225,16 +270,58 @@ void SetVariable::execute_impl(Bytecode::Interpreter& interpreter) const
     interpreter.vm().set_variable(interpreter.current_executable().get_string(m_identifier), interpreter.accumulator(), interpreter.global_object());
 }
 
+void PropertyLookupCache::add(Object const& object, String const& property_name)
+{
+    // Proxies and typed arrays can answer for properties their shape has, so they're never cached.
+    auto& shape = object.shape();
+    if (shape.is_unique() || object.is_proxy_object() || object.is_typed_array())
+        return;
+    auto metadata = shape.lookup(property_name);
+    if (!metadata.has_value() || object.get_direct(metadata->offset).is_accessor())
+        return;
+    m_entries[m_next_entry] = { const_cast<Shape&>(shape).make_weak_ptr(), metadata->offset, metadata->attributes };
+    m_next_entry = (m_next_entry + 1) % max_entries;
+}
+
 void GetById::execute_impl(Bytecode::Interpreter& interpreter) const
 {
-    if (auto* object = interpreter.accumulator().to_object(interpreter.global_object()))
-        interpreter.accumulator() = object->get(interpreter.current_executable().get_string(m_property));
+    if (interpreter.accumulator().is_object()) {
+        auto& object = interpreter.accumulator().as_object();
+        if (auto* entry = m_cache.lookup(object.shape())) {
+            // The property can still have been turned into an accessor without changing its attributes.
+            auto value = object.get_direct(entry->offset);
+            if (!value.is_accessor() && !value.is_empty()) {
+                interpreter.accumulator() = value;
+                return;
+            }
+        }
+    }
+
+    if (auto* object = interpreter.accumulator().to_object(interpreter.global_object())) {
+        auto& property_name = interpreter.current_executable().get_string(m_property);
+        interpreter.accumulator() = object->get(property_name);
+        if (!interpreter.vm().exception())
+            m_cache.add(*object, property_name);
+    }
 }
 
 void PutById::execute_impl(Bytecode::Interpreter& interpreter) const
 {
-    if (auto* object = interpreter.reg(m_base).to_object(interpreter.global_object()))
-        object->set(interpreter.current_executable().get_string(m_property), interpreter.accumulator(), Object::ShouldThrowExceptions::Yes);
+    auto base = interpreter.reg(m_base);
+    if (base.is_object()) {
+        auto& object = base.as_object();
+        if (auto* entry = m_cache.lookup(object.shape()); entry && entry->attributes.is_writable() && !object.get_direct(entry->offset).is_accessor()) {
+            object.put_direct(entry->offset, interpreter.accumulator());
+            return;
+        }
+    }
+
+    if (auto* object = base.to_object(interpreter.global_object())) {
+        auto& property_name = interpreter.current_executable().get_string(m_property);
+        object->set(property_name, interpreter.accumulator(), Object::ShouldThrowExceptions::Yes);
+        if (!interpreter.vm().exception())
+            m_cache.add(*object, property_name);
+    }
 }
 
 void Jump::execute_impl(Bytecode::Interpreter& interpreter) const
@@ -700,4 +787,397 @@ String IteratorResultValue::to_string_impl(Executable const&) const
     return "IteratorResultValue";
 }
 
+
+void Load::encode_impl(Bytecode::Encoder& encoder) const
+{
+    encoder.encode(m_src);
+}
+
+bool Load::decode_impl(Bytecode::Decoder& decoder)
+{
+    Register src { 0 };
+    return decoder.decode(src) && decoder.emit<Load>(src);
+}
+
+void LoadImmediate::encode_impl(Bytecode::Encoder& encoder) const
+{
+    encoder.encode(m_value);
+}
+
+bool LoadImmediate::decode_impl(Bytecode::Decoder& decoder)
+{
+    Value value;
+    return decoder.decode(value) && decoder.emit<LoadImmediate>(value);
+}
+
+void Store::encode_impl(Bytecode::Encoder& encoder) const
+{
+    encoder.encode(m_dst);
+}
+
+bool Store::decode_impl(Bytecode::Decoder& decoder)
+{
+    Register dst { 0 };
+    return decoder.decode(dst) && decoder.emit<Store>(dst);
+}
+
+void NewBigInt::encode_impl(Bytecode::Encoder& encoder) const
+{
+    encoder.encode(m_bigint.to_base(10).view());
+}
+
+bool NewBigInt::decode_impl(Bytecode::Decoder& decoder)
+{
+    String digits;
+    if (!decoder.decode(digits) || digits.is_empty())
+        return false;
+    for (size_t i = 0; i < digits.length(); ++i) {
+        if (!is_ascii_digit(digits[i]) && !(i == 0 && digits[i] == '-' && digits.length() > 1))
+            return false;
+    }
+    return decoder.emit<NewBigInt>(Crypto::SignedBigInteger::from_base(10, digits));
+}
+
+void NewArray::encode_impl(Bytecode::Encoder& encoder) const
+{
+    encoder.encode(static_cast<u32>(m_element_count));
+    for (size_t i = 0; i < m_element_count; ++i)
+        encoder.encode(m_elements[i]);
+}
+
+bool NewArray::decode_impl(Bytecode::Decoder& decoder)
+{
+    Vector<Register> elements;
+    return decoder.decode(elements) && decoder.emit_with_extra_register_slots<NewArray>(elements.size(), elements);
+}
+
+bool IteratorToArray::decode_impl(Bytecode::Decoder& decoder)
+{
+    return decoder.emit<IteratorToArray>();
+}
+
+void NewString::encode_impl(Bytecode::Encoder& encoder) const
+{
+    encoder.encode(m_string);
+}
+
+bool NewString::decode_impl(Bytecode::Decoder& decoder)
+{
+    StringTableIndex string;
+    return decoder.decode(string) && decoder.emit<NewString>(string);
+}
+
+bool NewObject::decode_impl(Bytecode::Decoder& decoder)
+{
+    return decoder.emit<NewObject>();
+}
+
+void NewRegExp::encode_impl(Bytecode::Encoder& encoder) const
+{
+    encoder.encode(m_source_index);
+    encoder.encode(m_flags_index);
+}
+
+bool NewRegExp::decode_impl(Bytecode::Decoder& decoder)
+{
+    StringTableIndex source_index;
+    StringTableIndex flags_index;
+    return decoder.decode(source_index) && decoder.decode(flags_index) && decoder.emit<NewRegExp>(source_index, flags_index);
+}
+
+void CopyObjectExcludingProperties::encode_impl(Bytecode::Encoder& encoder) const
+{
+    encoder.encode(m_from_object);
+    encoder.encode(static_cast<u32>(m_excluded_names_count));
+    for (size_t i = 0; i < m_excluded_names_count; ++i)
+        encoder.encode(m_excluded_names[i]);
+}
+
+bool CopyObjectExcludingProperties::decode_impl(Bytecode::Decoder& decoder)
+{
+    Register from_object { 0 };
+    Vector<Register> excluded_names;
+    if (!decoder.decode(from_object) || !decoder.decode(excluded_names))
+        return false;
+    return decoder.emit_with_extra_register_slots<CopyObjectExcludingProperties>(excluded_names.size(), from_object, excluded_names);
+}
+
+void ConcatString::encode_impl(Bytecode::Encoder& encoder) const
+{
+    encoder.encode(m_lhs);
+}
+
+bool ConcatString::decode_impl(Bytecode::Decoder& decoder)
+{
+    Register lhs { 0 };
+    return decoder.decode(lhs) && decoder.emit<ConcatString>(lhs);
+}
+
+void GetVariable::encode_impl(Bytecode::Encoder& encoder) const
+{
+    encoder.encode(m_identifier);
+}
+
+bool GetVariable::decode_impl(Bytecode::Decoder& decoder)
+{
+    StringTableIndex identifier;
+    return decoder.decode(identifier) && decoder.emit<GetVariable>(identifier);
+}
+
+void SetVariable::encode_impl(Bytecode::Encoder& encoder) const
+{
+    encoder.encode(m_identifier);
+}
+
+bool SetVariable::decode_impl(Bytecode::Decoder& decoder)
+{
+    StringTableIndex identifier;
+    return decoder.decode(identifier) && decoder.emit<SetVariable>(identifier);
+}
+
+// The lookup caches of GetById and PutById start out empty again, as the shapes they remember don't outlive the heap.
+void GetById::encode_impl(Bytecode::Encoder& encoder) const
+{
+    encoder.encode(m_property);
+}
+
+bool GetById::decode_impl(Bytecode::Decoder& decoder)
+{
+    StringTableIndex property;
+    return decoder.decode(property) && decoder.emit<GetById>(property);
+}
+
+void PutById::encode_impl(Bytecode::Encoder& encoder) const
+{
+    encoder.encode(m_base);
+    encoder.encode(m_property);
+}
+
+bool PutById::decode_impl(Bytecode::Decoder& decoder)
+{
+    Register base { 0 };
+    StringTableIndex property;
+    return decoder.decode(base) && decoder.decode(property) && decoder.emit<PutById>(base, property);
+}
+
+void Jump::encode_impl(Bytecode::Encoder& encoder) const
+{
+    encoder.encode(m_true_target);
+    encoder.encode(m_false_target);
+}
+
+template<typename JumpType>
+static bool decode_jump(Bytecode::Decoder& decoder)
+{
+    Optional<Label> true_target;
+    Optional<Label> false_target;
+    return decoder.decode(true_target) && decoder.decode(false_target) && decoder.emit<JumpType>(move(true_target), move(false_target));
+}
+
+bool Jump::decode_impl(Bytecode::Decoder& decoder)
+{
+    return decode_jump<Jump>(decoder);
+}
+
+bool JumpConditional::decode_impl(Bytecode::Decoder& decoder)
+{
+    return decode_jump<JumpConditional>(decoder);
+}
+
+bool JumpNullish::decode_impl(Bytecode::Decoder& decoder)
+{
+    return decode_jump<JumpNullish>(decoder);
+}
+
+bool JumpUndefined::decode_impl(Bytecode::Decoder& decoder)
+{
+    return decode_jump<JumpUndefined>(decoder);
+}
+
+void Call::encode_impl(Bytecode::Encoder& encoder) const
+{
+    encoder.encode(static_cast<u8>(m_type));
+    encoder.encode(m_callee);
+    encoder.encode(m_this_value);
+    encoder.encode(static_cast<u32>(m_argument_count));
+    for (size_t i = 0; i < m_argument_count; ++i)
+        encoder.encode(m_arguments[i]);
+}
+
+bool Call::decode_impl(Bytecode::Decoder& decoder)
+{
+    u8 type;
+    Register callee { 0 };
+    Register this_value { 0 };
+    Vector<Register> arguments;
+    if (!decoder.decode(type) || type > static_cast<u8>(CallType::Construct))
+        return false;
+    if (!decoder.decode(callee) || !decoder.decode(this_value) || !decoder.decode(arguments))
+        return false;
+    return decoder.emit_with_extra_register_slots<Call>(arguments.size(), static_cast<CallType>(type), callee, this_value, arguments);
+}
+
+void NewFunction::encode_impl(Bytecode::Encoder& encoder) const
+{
+    encoder.encode(m_function_node);
+}
+
+bool NewFunction::decode_impl(Bytecode::Decoder& decoder)
+{
+    auto* function_node = decoder.decode_function_node();
+    return function_node && decoder.emit<NewFunction>(*function_node);
+}
+
+bool Return::decode_impl(Bytecode::Decoder& decoder)
+{
+    return decoder.emit<Return>();
+}
+
+bool Increment::decode_impl(Bytecode::Decoder& decoder)
+{
+    return decoder.emit<Increment>();
+}
+
+bool Decrement::decode_impl(Bytecode::Decoder& decoder)
+{
+    return decoder.emit<Decrement>();
+}
+
+bool Throw::decode_impl(Bytecode::Decoder& decoder)
+{
+    return decoder.emit<Throw>();
+}
+
+void EnterUnwindContext::encode_impl(Bytecode::Encoder& encoder) const
+{
+    encoder.encode(m_entry_point);
+    encoder.encode(m_handler_target);
+    encoder.encode(m_finalizer_target);
+}
+
+bool EnterUnwindContext::decode_impl(Bytecode::Decoder& decoder)
+{
+    Optional<Label> entry_point;
+    Optional<Label> handler_target;
+    Optional<Label> finalizer_target;
+    if (!decoder.decode_label(entry_point) || !decoder.decode(handler_target) || !decoder.decode(finalizer_target))
+        return false;
+    return decoder.emit<EnterUnwindContext>(*entry_point, move(handler_target), move(finalizer_target));
+}
+
+bool LeaveUnwindContext::decode_impl(Bytecode::Decoder& decoder)
+{
+    return decoder.emit<LeaveUnwindContext>();
+}
+
+void ContinuePendingUnwind::encode_impl(Bytecode::Encoder& encoder) const
+{
+    encoder.encode(m_resume_target);
+}
+
+bool ContinuePendingUnwind::decode_impl(Bytecode::Decoder& decoder)
+{
+    Optional<Label> resume_target;
+    return decoder.decode_label(resume_target) && decoder.emit<ContinuePendingUnwind>(*resume_target);
+}
+
+void PushDeclarativeEnvironment::encode_impl(Bytecode::Encoder& encoder) const
+{
+    encoder.encode(static_cast<u32>(m_variables.size()));
+    for (auto& it : m_variables) {
+        encoder.encode(it.key);
+        encoder.encode(it.value.value);
+        encoder.encode(static_cast<u8>(it.value.declaration_kind));
+    }
+}
+
+bool PushDeclarativeEnvironment::decode_impl(Bytecode::Decoder& decoder)
+{
+    u32 count;
+    if (!decoder.decode(count))
+        return false;
+    HashMap<u32, Variable> variables;
+    for (u32 i = 0; i < count; ++i) {
+        u32 key;
+        Value value;
+        u8 declaration_kind;
+        if (!decoder.decode(key) || !decoder.decode(value) || !decoder.decode(declaration_kind))
+            return false;
+        if (declaration_kind > static_cast<u8>(DeclarationKind::Const))
+            return false;
+        variables.set(key, { value, static_cast<DeclarationKind>(declaration_kind) });
+    }
+    return decoder.emit<PushDeclarativeEnvironment>(move(variables));
+}
+
+void Yield::encode_impl(Bytecode::Encoder& encoder) const
+{
+    encoder.encode(m_continuation_label);
+}
+
+bool Yield::decode_impl(Bytecode::Decoder& decoder)
+{
+    Optional<Label> continuation_label;
+    if (!decoder.decode(continuation_label))
+        return false;
+    if (!continuation_label.has_value())
+        return decoder.emit<Yield>(nullptr);
+    return decoder.emit<Yield>(*continuation_label);
+}
+
+void GetByValue::encode_impl(Bytecode::Encoder& encoder) const
+{
+    encoder.encode(m_base);
+}
+
+bool GetByValue::decode_impl(Bytecode::Decoder& decoder)
+{
+    Register base { 0 };
+    return decoder.decode(base) && decoder.emit<GetByValue>(base);
+}
+
+void PutByValue::encode_impl(Bytecode::Encoder& encoder) const
+{
+    encoder.encode(m_base);
+    encoder.encode(m_property);
+}
+
+bool PutByValue::decode_impl(Bytecode::Decoder& decoder)
+{
+    Register base { 0 };
+    Register property { 0 };
+    return decoder.decode(base) && decoder.decode(property) && decoder.emit<PutByValue>(base, property);
+}
+
+bool GetIterator::decode_impl(Bytecode::Decoder& decoder)
+{
+    return decoder.emit<GetIterator>();
+}
+
+bool IteratorNext::decode_impl(Bytecode::Decoder& decoder)
+{
+    return decoder.emit<IteratorNext>();
+}
+
+bool IteratorResultDone::decode_impl(Bytecode::Decoder& decoder)
+{
+    return decoder.emit<IteratorResultDone>();
+}
+
+bool IteratorResultValue::decode_impl(Bytecode::Decoder& decoder)
+{
+    return decoder.emit<IteratorResultValue>();
+}
+
+void NewClass::encode_impl(Bytecode::Encoder& encoder) const
+{
+    encoder.encode(m_class_expression);
+}
+
+bool NewClass::decode_impl(Bytecode::Decoder& decoder)
+{
+    auto* class_expression = decoder.decode_class_expression();
+    return class_expression && decoder.emit<NewClass>(*class_expression);
+}
+
 }
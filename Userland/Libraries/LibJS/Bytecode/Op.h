@@ -8,6 +8,9 @@
 
 #pragma once
 
+#include <AK/Array.h>
+#include <AK/Function.h>
+#include <AK/WeakPtr.h>
 #include <LibCrypto/BigInt/SignedBigInteger.h>
 #include <LibJS/Bytecode/Instruction.h>
 #include <LibJS/Bytecode/Label.h>
@@ -15,6 +18,7 @@
 #include <LibJS/Bytecode/StringTable.h>
 #include <LibJS/Heap/Cell.h>
 #include <LibJS/Runtime/Environment.h>
+#include <LibJS/Runtime/Shape.h>
 #include <LibJS/Runtime/Value.h>
 
 namespace JS::Bytecode::Op {
@@ -29,7 +33,12 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const;
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const& callback) { callback(m_src, RegisterAccess::Read); }
+
+    Register const& src() const { return m_src; }
 
 private:
     Register m_src;
@@ -45,7 +54,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const;
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
 private:
     Value m_value;
@@ -61,7 +73,12 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const;
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const& callback) { callback(m_dst, RegisterAccess::Write); }
+
+    Register const& dst() const { return m_dst; }
 
 private:
     Register m_dst;
@@ -91,21 +108,27 @@ private:
     O(RightShift, right_shift)                \
     O(UnsignedRightShift, unsigned_right_shift)
 
-#define JS_DECLARE_COMMON_BINARY_OP(OpTitleCase, op_snake_case)                \
-    class OpTitleCase final : public Instruction {                             \
-    public:                                                                    \
-        explicit OpTitleCase(Register lhs_reg)                                 \
-            : Instruction(Type::OpTitleCase)                                   \
-            , m_lhs_reg(lhs_reg)                                               \
-        {                                                                      \
-        }                                                                      \
-                                                                               \
-        void execute_impl(Bytecode::Interpreter&) const;                       \
-        String to_string_impl(Bytecode::Executable const&) const;              \
-        void replace_references_impl(BasicBlock const&, BasicBlock const&) { } \
-                                                                               \
-    private:                                                                   \
-        Register m_lhs_reg;                                                    \
+#define JS_DECLARE_COMMON_BINARY_OP(OpTitleCase, op_snake_case)                                                \
+    class OpTitleCase final : public Instruction {                                                             \
+    public:                                                                                                    \
+        explicit OpTitleCase(Register lhs_reg)                                                                 \
+            : Instruction(Type::OpTitleCase)                                                                   \
+            , m_lhs_reg(lhs_reg)                                                                               \
+        {                                                                                                      \
+        }                                                                                                      \
+                                                                                                               \
+        void execute_impl(Bytecode::Interpreter&) const;                                                       \
+        String to_string_impl(Bytecode::Executable const&) const;                                              \
+        void encode_impl(Bytecode::Encoder&) const;                                                            \
+        static bool decode_impl(Bytecode::Decoder&);                                                           \
+        void replace_references_impl(BasicBlock const&, BasicBlock const&) { }                                 \
+        void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const& callback)         \
+        {                                                                                                      \
+            callback(m_lhs_reg, RegisterAccess::Read);                                                         \
+        }                                                                                                      \
+                                                                                                               \
+    private:                                                                                                   \
+        Register m_lhs_reg;                                                                                    \
     };
 
 JS_ENUMERATE_COMMON_BINARY_OPS(JS_DECLARE_COMMON_BINARY_OP)
@@ -118,17 +141,20 @@ JS_ENUMERATE_COMMON_BINARY_OPS(JS_DECLARE_COMMON_BINARY_OP)
     O(UnaryMinus, unary_minus)           \
     O(Typeof, typeof_)
 
-#define JS_DECLARE_COMMON_UNARY_OP(OpTitleCase, op_snake_case)                 \
-    class OpTitleCase final : public Instruction {                             \
-    public:                                                                    \
-        OpTitleCase()                                                          \
-            : Instruction(Type::OpTitleCase)                                   \
-        {                                                                      \
-        }                                                                      \
-                                                                               \
-        void execute_impl(Bytecode::Interpreter&) const;                       \
-        String to_string_impl(Bytecode::Executable const&) const;              \
-        void replace_references_impl(BasicBlock const&, BasicBlock const&) { } \
+#define JS_DECLARE_COMMON_UNARY_OP(OpTitleCase, op_snake_case)                                          \
+    class OpTitleCase final : public Instruction {                                                      \
+    public:                                                                                             \
+        OpTitleCase()                                                                                   \
+            : Instruction(Type::OpTitleCase)                                                            \
+        {                                                                                               \
+        }                                                                                               \
+                                                                                                        \
+        void execute_impl(Bytecode::Interpreter&) const;                                                \
+        String to_string_impl(Bytecode::Executable const&) const;                                       \
+        void encode_impl(Bytecode::Encoder&) const { }                                                  \
+        static bool decode_impl(Bytecode::Decoder&);                                                    \
+        void replace_references_impl(BasicBlock const&, BasicBlock const&) { }                          \
+        void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }       \
     };
 
 JS_ENUMERATE_COMMON_UNARY_OPS(JS_DECLARE_COMMON_UNARY_OP)
@@ -144,7 +170,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const;
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
 private:
     StringTableIndex m_string;
@@ -159,7 +188,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const { }
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class NewRegExp final : public Instruction {
@@ -173,7 +205,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const;
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
 private:
     StringTableIndex m_source_index;
@@ -194,7 +229,15 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const;
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const& callback)
+    {
+        callback(m_from_object, RegisterAccess::Read);
+        for (size_t i = 0; i < m_excluded_names_count; i++)
+            callback(m_excluded_names[i], RegisterAccess::Read);
+    }
 
     size_t length_impl() const { return sizeof(*this) + sizeof(Register) * m_excluded_names_count; }
 
@@ -214,7 +257,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const;
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
 private:
     Crypto::SignedBigInteger m_bigint;
@@ -239,7 +285,14 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const;
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const& callback)
+    {
+        for (size_t i = 0; i < m_element_count; ++i)
+            callback(m_elements[i], RegisterAccess::Read);
+    }
 
     size_t length_impl() const
     {
@@ -260,7 +313,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const { }
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class ConcatString final : public Instruction {
@@ -273,7 +329,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const;
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const& callback) { callback(m_lhs, RegisterAccess::ReadWrite); }
 
 private:
     Register m_lhs;
@@ -289,7 +348,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const;
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
 private:
     StringTableIndex m_identifier;
@@ -305,12 +367,45 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const;
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
 private:
     StringTableIndex m_identifier;
 };
 
+// Remembers where a property was found in the last few shapes an instruction has seen, so it can go straight to
+// the object's storage the next time it sees one of them. Only own data properties of objects with shared shapes
+// are cached, because the property can't move or change its attributes without such an object getting a new shape.
+// Unique shapes are changed in place, so objects that have one always take the slow path.
+class PropertyLookupCache {
+public:
+    struct Entry {
+        WeakPtr<Shape> shape;
+        size_t offset { 0 };
+        PropertyAttributes attributes { 0 };
+    };
+
+    Entry const* lookup(Shape const& shape) const
+    {
+        for (auto& entry : m_entries) {
+            if (entry.shape.ptr() == &shape)
+                return &entry;
+        }
+        return nullptr;
+    }
+
+    void add(Object const&, String const& property_name);
+
+private:
+    static constexpr size_t max_entries = 4;
+
+    AK::Array<Entry, max_entries> m_entries;
+    size_t m_next_entry { 0 };
+};
+
 class GetById final : public Instruction {
 public:
     explicit GetById(StringTableIndex property)
@@ -321,10 +416,14 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const;
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
 private:
     StringTableIndex m_property;
+    mutable PropertyLookupCache m_cache;
 };
 
 class PutById final : public Instruction {
@@ -338,11 +437,15 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const;
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const& callback) { callback(m_base, RegisterAccess::Read); }
 
 private:
     Register m_base;
     StringTableIndex m_property;
+    mutable PropertyLookupCache m_cache;
 };
 
 class GetByValue final : public Instruction {
@@ -355,7 +458,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const;
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const& callback) { callback(m_base, RegisterAccess::Read); }
 
 private:
     Register m_base;
@@ -372,7 +478,14 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const;
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const& callback)
+    {
+        callback(m_base, RegisterAccess::Read);
+        callback(m_property, RegisterAccess::Read);
+    }
 
 private:
     Register m_base;
@@ -405,7 +518,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const;
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&);
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
     auto& true_target() const { return m_true_target; }
     auto& false_target() const { return m_false_target; }
@@ -424,6 +540,7 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    static bool decode_impl(Bytecode::Decoder&);
 };
 
 class JumpNullish final : public Jump {
@@ -435,6 +552,7 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    static bool decode_impl(Bytecode::Decoder&);
 };
 
 class JumpUndefined final : public Jump {
@@ -446,6 +564,7 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    static bool decode_impl(Bytecode::Decoder&);
 };
 
 // NOTE: This instruction is variable-width depending on the number of arguments!
@@ -469,7 +588,16 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const;
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const& callback)
+    {
+        callback(m_callee, RegisterAccess::Read);
+        callback(m_this_value, RegisterAccess::Read);
+        for (size_t i = 0; i < m_argument_count; ++i)
+            callback(m_arguments[i], RegisterAccess::Read);
+    }
 
     size_t length_impl() const
     {
@@ -494,7 +622,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const;
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
 private:
     ClassExpression const& m_class_expression;
@@ -510,7 +641,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const;
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
 private:
     FunctionNode const& m_function_node;
@@ -527,7 +661,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const { }
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class Increment final : public Instruction {
@@ -539,7 +676,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const { }
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class Decrement final : public Instruction {
@@ -551,7 +691,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const { }
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class Throw final : public Instruction {
@@ -565,7 +708,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const { }
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class EnterUnwindContext final : public Instruction {
@@ -582,7 +728,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const;
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&);
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
     auto& entry_point() const { return m_entry_point; }
     auto& handler_target() const { return m_handler_target; }
@@ -603,7 +752,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const { }
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class ContinuePendingUnwind final : public Instruction {
@@ -618,7 +770,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const;
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&);
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
     auto& resume_target() const { return m_resume_target; }
 
@@ -643,7 +798,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const;
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&);
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
     auto& continuation() const { return m_continuation_label; }
 
@@ -661,7 +819,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const;
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 
 private:
     HashMap<u32, Variable> m_variables;
@@ -676,7 +837,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const { }
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class IteratorNext final : public Instruction {
@@ -688,7 +852,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const { }
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class IteratorResultDone final : public Instruction {
@@ -700,7 +867,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const { }
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 class IteratorResultValue final : public Instruction {
@@ -712,7 +882,10 @@ public:
 
     void execute_impl(Bytecode::Interpreter&) const;
     String to_string_impl(Bytecode::Executable const&) const;
+    void encode_impl(Bytecode::Encoder&) const { }
+    static bool decode_impl(Bytecode::Decoder&);
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
+    void for_each_register_operand_impl(Function<void(Register&, RegisterAccess)> const&) { }
 };
 
 }
@@ -749,6 +922,21 @@ ALWAYS_INLINE void Instruction::replace_references(BasicBlock const& from, Basic
 #undef __BYTECODE_OP
 }
 
+ALWAYS_INLINE void Instruction::for_each_register_operand(Function<void(Register&, RegisterAccess)> const& callback)
+{
+#define __BYTECODE_OP(op)       \
+    case Instruction::Type::op: \
+        return static_cast<Bytecode::Op::op&>(*this).for_each_register_operand_impl(callback);
+
+    switch (type()) {
+        ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+#undef __BYTECODE_OP
+}
+
 ALWAYS_INLINE size_t Instruction::length() const
 {
     if (type() == Type::Call)
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/HashTable.h>
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+class RegisterSet {
+public:
+    explicit RegisterSet(size_t size)
+    {
+        m_words.resize(ceil_div(size, static_cast<size_t>(64)));
+    }
+
+    bool contains(u32 index) const { return m_words[index / 64] & (1ull << (index % 64)); }
+    void set(u32 index) { m_words[index / 64] |= 1ull << (index % 64); }
+    void remove(u32 index) { m_words[index / 64] &= ~(1ull << (index % 64)); }
+
+    // Adds the registers in `other` that aren't in `except`, and returns whether anything was added.
+    bool merge(RegisterSet const& other, RegisterSet const* except = nullptr)
+    {
+        bool changed = false;
+        for (size_t i = 0; i < m_words.size(); ++i) {
+            auto word = other.m_words[i] & (except ? ~except->m_words[i] : ~0ull);
+            changed |= (word & ~m_words[i]) != 0;
+            m_words[i] |= word;
+        }
+        return changed;
+    }
+
+    template<typename Callback>
+    void for_each(Callback callback) const
+    {
+        for (size_t i = 0; i < m_words.size(); ++i) {
+            for (auto word = m_words[i]; word; word &= word - 1)
+                callback(static_cast<u32>(i * 64 + __builtin_ctzll(word)));
+        }
+    }
+
+private:
+    Vector<u64> m_words;
+};
+
+static constexpr u32 first_allocatable_register = Register::global_object_index + 1;
+
+static void for_each_allocatable_register(Instruction& instruction, Function<void(Register&, Instruction::RegisterAccess)> const& callback)
+{
+    instruction.for_each_register_operand([&](Register& reg, auto access) {
+        if (reg.index() >= first_allocatable_register)
+            callback(reg, access);
+    });
+}
+
+// Codegen gives every temporary a register of its own, even though most of them are only live for a couple of
+// instructions. This gives registers that are never live at the same time the same index, which makes register
+// windows a lot smaller (and cheaper to allocate and snapshot).
+void AllocateRegisters::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    VERIFY(executable.cfg.has_value());
+    auto& cfg = *executable.cfg;
+    auto& blocks = executable.executable.basic_blocks;
+    auto register_count = executable.executable.number_of_registers;
+
+    struct BlockInfo {
+        Vector<Instruction*> instructions;
+        RegisterSet used;
+        RegisterSet defined;
+        RegisterSet live_in;
+        RegisterSet live_out;
+    };
+    Vector<BlockInfo> block_infos;
+    HashMap<BasicBlock const*, size_t> block_indices;
+    HashTable<BasicBlock const*> handler_blocks;
+    RegisterSet referenced_registers(register_count);
+
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        block_indices.set(&blocks[i], i);
+        BlockInfo info { {}, RegisterSet(register_count), RegisterSet(register_count), RegisterSet(register_count), RegisterSet(register_count) };
+        InstructionStreamIterator it { blocks[i].instruction_stream() };
+        for (; !it.at_end(); ++it) {
+            auto& instruction = const_cast<Instruction&>(*it);
+            info.instructions.append(&instruction);
+            if (instruction.type() == Instruction::Type::EnterUnwindContext) {
+                auto& enter = static_cast<Op::EnterUnwindContext const&>(instruction);
+                if (enter.handler_target().has_value())
+                    handler_blocks.set(&enter.handler_target()->block());
+                if (enter.finalizer_target().has_value())
+                    handler_blocks.set(&enter.finalizer_target()->block());
+            }
+            for_each_allocatable_register(instruction, [&](Register& reg, auto access) {
+                referenced_registers.set(reg.index());
+                if (access != Instruction::RegisterAccess::Write && !info.defined.contains(reg.index()))
+                    info.used.set(reg.index());
+                if (access != Instruction::RegisterAccess::Read)
+                    info.defined.set(reg.index());
+            });
+        }
+        block_infos.append(move(info));
+    }
+
+    // Compute which registers are live on entry to and exit from each block.
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t i = blocks.size(); i-- > 0;) {
+            auto& info = block_infos[i];
+            if (auto successors = cfg.find(&blocks[i]); successors != cfg.end()) {
+                for (auto* successor : successors->value)
+                    changed |= info.live_out.merge(block_infos[*block_indices.get(successor)].live_in);
+            }
+            changed |= info.live_in.merge(info.used);
+            changed |= info.live_in.merge(info.live_out, &info.defined);
+        }
+    }
+
+    // Exception handlers can be entered from anywhere in their try block, which the CFG doesn't know about, and
+    // registers that are read before they are written shouldn't see what some other register left behind.
+    // So these get a register of their own, which nothing else can clobber.
+    RegisterSet pinned_registers(register_count);
+    pinned_registers.merge(block_infos.first().live_in);
+    for (auto* handler_block : handler_blocks) {
+        if (auto index = block_indices.get(handler_block); index.has_value())
+            pinned_registers.merge(block_infos[*index].live_in);
+    }
+
+    // Two registers interfere if one of them is written while the other one is live.
+    Vector<HashTable<u32>> interferences;
+    interferences.resize(register_count);
+    for (auto& info : block_infos) {
+        RegisterSet live(register_count);
+        live.merge(info.live_out);
+        for (size_t i = info.instructions.size(); i-- > 0;) {
+            Vector<u32, 4> reads;
+            for_each_allocatable_register(*info.instructions[i], [&](Register& reg, auto access) {
+                if (access != Instruction::RegisterAccess::Read) {
+                    live.for_each([&](u32 other) {
+                        if (other == reg.index())
+                            return;
+                        interferences[reg.index()].set(other);
+                        interferences[other].set(reg.index());
+                    });
+                    live.remove(reg.index());
+                }
+                if (access != Instruction::RegisterAccess::Write)
+                    reads.append(reg.index());
+            });
+            for (auto index : reads)
+                live.set(index);
+        }
+    }
+
+    Vector<u32> new_indices;
+    new_indices.resize(register_count);
+    for (u32 i = 0; i < first_allocatable_register; ++i)
+        new_indices[i] = i;
+    u32 next_free_index = first_allocatable_register;
+    Vector<bool> is_taken;
+    referenced_registers.for_each([&](u32 index) {
+        if (pinned_registers.contains(index))
+            return;
+        is_taken.clear_with_capacity();
+        is_taken.resize(next_free_index);
+        for (auto other : interferences[index]) {
+            if (other < index && referenced_registers.contains(other) && !pinned_registers.contains(other))
+                is_taken[new_indices[other]] = true;
+        }
+        u32 new_index = first_allocatable_register;
+        while (new_index < next_free_index && is_taken[new_index])
+            ++new_index;
+        new_indices[index] = new_index;
+        next_free_index = max(next_free_index, new_index + 1);
+    });
+    referenced_registers.for_each([&](u32 index) {
+        if (pinned_registers.contains(index))
+            new_indices[index] = next_free_index++;
+    });
+
+    for (auto& info : block_infos) {
+        for (auto* instruction : info.instructions) {
+            for_each_allocatable_register(*instruction, [&](Register& reg, auto) {
+                reg = Register { new_indices[reg.index()] };
+            });
+        }
+    }
+    executable.executable.number_of_registers = next_free_index;
+
+    finished();
+}
+
+}
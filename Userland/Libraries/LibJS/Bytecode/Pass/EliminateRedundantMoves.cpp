@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+static bool overwrites_accumulator_without_reading_it(Instruction const& instruction)
+{
+    switch (instruction.type()) {
+    case Instruction::Type::Load:
+    case Instruction::Type::LoadImmediate:
+    case Instruction::Type::NewString:
+    case Instruction::Type::NewObject:
+    case Instruction::Type::NewBigInt:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Codegen moves values between the accumulator and registers quite liberally, which leaves behind moves that
+// don't change anything (and loads that are overwritten before anything looks at them).
+void EliminateRedundantMoves::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    for (auto& block : executable.executable.basic_blocks) {
+        HashTable<Instruction const*> instructions_to_remove;
+        Instruction const* previous = nullptr;
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it) {
+            auto& instruction = *it;
+            if (previous) {
+                // Store $x; Load $x and Load $x; Store $x leave the accumulator and $x as they were after the first one.
+                if (previous->type() == Instruction::Type::Store && instruction.type() == Instruction::Type::Load
+                    && static_cast<Op::Store const&>(*previous).dst().index() == static_cast<Op::Load const&>(instruction).src().index()) {
+                    instructions_to_remove.set(&instruction);
+                    continue;
+                }
+                if (previous->type() == Instruction::Type::Load && instruction.type() == Instruction::Type::Store
+                    && static_cast<Op::Load const&>(*previous).src().index() == static_cast<Op::Store const&>(instruction).dst().index()) {
+                    instructions_to_remove.set(&instruction);
+                    continue;
+                }
+                // Loads have no side effects, so there's no point in doing one if the accumulator is overwritten right after.
+                if ((previous->type() == Instruction::Type::Load || previous->type() == Instruction::Type::LoadImmediate)
+                    && overwrites_accumulator_without_reading_it(instruction))
+                    instructions_to_remove.set(previous);
+            }
+            previous = &instruction;
+        }
+        if (!instructions_to_remove.is_empty())
+            block.remove_instructions(instructions_to_remove);
+    }
+
+    finished();
+}
+
+}
@@ -121,6 +121,24 @@ private:
     virtual void perform(PassPipelineExecutable&) override;
 };
 
+class AllocateRegisters : public Pass {
+public:
+    AllocateRegisters() = default;
+    ~AllocateRegisters() override = default;
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
+class EliminateRedundantMoves : public Pass {
+public:
+    EliminateRedundantMoves() = default;
+    ~EliminateRedundantMoves() override = default;
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
 class DumpCFG : public Pass {
 public:
     DumpCFG(FILE* file)
@@ -0,0 +1,408 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/TypeCasts.h>
+#include <LibJS/AST.h>
+#include <LibJS/Bytecode/Generator.h>
+#include <LibJS/Bytecode/Instruction.h>
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/Bytecode/Serialization.h>
+
+namespace JS::Bytecode {
+
+static constexpr u32 executable_magic = 0x43424a4c; // "LJBC"
+// Bump this whenever an instruction or the layout below changes, so stale caches are ignored rather than misread.
+static constexpr u32 executable_format_version = 2;
+static constexpr u32 no_label = NumericLimits<u32>::max();
+
+Encoder::Encoder(Executable const& executable, Program const& program)
+{
+    for (size_t i = 0; i < executable.basic_blocks.size(); ++i)
+        m_block_indices.set(&executable.basic_blocks[i], i);
+
+    auto& nodes = program.function_and_class_nodes();
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        auto& node = nodes[i];
+        if (is<FunctionDeclaration>(node))
+            m_function_node_indices.set(&static_cast<FunctionDeclaration const&>(node), i);
+        else if (is<FunctionExpression>(node))
+            m_function_node_indices.set(&static_cast<FunctionExpression const&>(node), i);
+        else if (is<ClassExpression>(node))
+            m_class_expression_indices.set(&static_cast<ClassExpression const&>(node), i);
+    }
+}
+
+void Encoder::encode(u8 value)
+{
+    append(&value, sizeof(value));
+}
+
+void Encoder::encode(u32 value)
+{
+    append(&value, sizeof(value));
+}
+
+void Encoder::encode(u64 value)
+{
+    append(&value, sizeof(value));
+}
+
+void Encoder::encode(double value)
+{
+    append(&value, sizeof(value));
+}
+
+void Encoder::encode(bool value)
+{
+    encode(static_cast<u8>(value));
+}
+
+void Encoder::encode(StringView string)
+{
+    encode(static_cast<u32>(string.length()));
+    append(string.characters_without_null_termination(), string.length());
+}
+
+void Encoder::encode(Register reg)
+{
+    encode(reg.index());
+}
+
+void Encoder::encode(StringTableIndex index)
+{
+    encode(static_cast<u64>(index.value()));
+}
+
+void Encoder::encode(Label label)
+{
+    auto index = m_block_indices.get(&label.block());
+    if (!index.has_value()) {
+        set_failed();
+        return;
+    }
+    encode(*index);
+}
+
+void Encoder::encode(Optional<Label> const& label)
+{
+    if (!label.has_value()) {
+        encode(no_label);
+        return;
+    }
+    encode(*label);
+}
+
+void Encoder::encode(Value value)
+{
+    encode(static_cast<u8>(value.type()));
+    switch (value.type()) {
+    case Value::Type::Empty:
+    case Value::Type::Undefined:
+    case Value::Type::Null:
+        return;
+    case Value::Type::Int32:
+    case Value::Type::Double:
+        encode(value.as_double());
+        return;
+    case Value::Type::Boolean:
+        encode(value.as_bool());
+        return;
+    default:
+        // Cells only live as long as the heap that allocated them.
+        set_failed();
+        return;
+    }
+}
+
+void Encoder::encode(FunctionNode const& function_node)
+{
+    auto index = m_function_node_indices.get(&function_node);
+    if (!index.has_value()) {
+        set_failed();
+        return;
+    }
+    encode(*index);
+}
+
+void Encoder::encode(ClassExpression const& class_expression)
+{
+    auto index = m_class_expression_indices.get(&class_expression);
+    if (!index.has_value()) {
+        set_failed();
+        return;
+    }
+    encode(*index);
+}
+
+Decoder::Decoder(ReadonlyBytes bytes, Program const& program)
+    : m_bytes(bytes)
+    , m_program(program)
+{
+}
+
+bool Decoder::read(void* data, size_t size)
+{
+    if (size > m_bytes.size() - m_offset)
+        return false;
+    __builtin_memcpy(data, m_bytes.data() + m_offset, size);
+    m_offset += size;
+    return true;
+}
+
+bool Decoder::decode(u8& value)
+{
+    return read(&value, sizeof(value));
+}
+
+bool Decoder::decode(u32& value)
+{
+    return read(&value, sizeof(value));
+}
+
+bool Decoder::decode(u64& value)
+{
+    return read(&value, sizeof(value));
+}
+
+bool Decoder::decode(double& value)
+{
+    return read(&value, sizeof(value));
+}
+
+bool Decoder::decode(bool& value)
+{
+    u8 byte;
+    if (!decode(byte) || byte > 1)
+        return false;
+    value = byte;
+    return true;
+}
+
+bool Decoder::decode(String& string)
+{
+    u32 length;
+    if (!decode(length) || length > m_bytes.size() - m_offset)
+        return false;
+    string = String { reinterpret_cast<char const*>(m_bytes.data() + m_offset), length };
+    m_offset += length;
+    return true;
+}
+
+bool Decoder::decode(Register& reg)
+{
+    u32 index;
+    if (!decode(index) || index >= m_number_of_registers)
+        return false;
+    reg = Register { index };
+    return true;
+}
+
+bool Decoder::decode(StringTableIndex& index)
+{
+    u64 value;
+    if (!decode(value))
+        return false;
+    index = value;
+    return true;
+}
+
+bool Decoder::decode(Optional<Label>& label)
+{
+    u32 index;
+    if (!decode(index))
+        return false;
+    if (index == no_label) {
+        label = {};
+        return true;
+    }
+    if (index >= m_blocks.size())
+        return false;
+    label = Label { *m_blocks[index] };
+    return true;
+}
+
+bool Decoder::decode(Value& value)
+{
+    u8 type;
+    if (!decode(type))
+        return false;
+    switch (static_cast<Value::Type>(type)) {
+    case Value::Type::Empty:
+        value = {};
+        return true;
+    case Value::Type::Undefined:
+        value = js_undefined();
+        return true;
+    case Value::Type::Null:
+        value = js_null();
+        return true;
+    case Value::Type::Int32:
+    case Value::Type::Double: {
+        double number;
+        if (!decode(number))
+            return false;
+        value = Value(number);
+        return true;
+    }
+    case Value::Type::Boolean: {
+        bool boolean;
+        if (!decode(boolean))
+            return false;
+        value = Value(boolean);
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+bool Decoder::decode(Vector<Register>& registers)
+{
+    u32 count;
+    if (!decode(count) || count > (m_bytes.size() - m_offset) / sizeof(u32))
+        return false;
+    registers.ensure_capacity(count);
+    for (u32 i = 0; i < count; ++i) {
+        Register reg { 0 };
+        if (!decode(reg))
+            return false;
+        registers.unchecked_append(reg);
+    }
+    return true;
+}
+
+FunctionNode const* Decoder::decode_function_node()
+{
+    u32 index;
+    auto& nodes = m_program.function_and_class_nodes();
+    if (!decode(index) || index >= nodes.size())
+        return nullptr;
+    auto& node = nodes[index];
+    if (is<FunctionDeclaration>(node))
+        return &static_cast<FunctionDeclaration const&>(node);
+    if (is<FunctionExpression>(node))
+        return &static_cast<FunctionExpression const&>(node);
+    return nullptr;
+}
+
+ClassExpression const* Decoder::decode_class_expression()
+{
+    u32 index;
+    auto& nodes = m_program.function_and_class_nodes();
+    if (!decode(index) || index >= nodes.size())
+        return nullptr;
+    auto& node = nodes[index];
+    if (is<ClassExpression>(node))
+        return &static_cast<ClassExpression const&>(node);
+    return nullptr;
+}
+
+ByteBuffer serialize_executable(Executable const& executable, Program const& program)
+{
+    Encoder encoder(executable, program);
+    encoder.encode(executable_magic);
+    encoder.encode(executable_format_version);
+    encoder.encode(program.has_lazily_parsed_function_bodies());
+    encoder.encode(static_cast<u32>(program.function_and_class_nodes().size()));
+    encoder.encode(static_cast<u64>(executable.number_of_registers));
+
+    encoder.encode(static_cast<u32>(executable.string_table->size()));
+    for (size_t i = 0; i < executable.string_table->size(); ++i)
+        encoder.encode(executable.get_string(i).view());
+
+    encoder.encode(static_cast<u32>(executable.basic_blocks.size()));
+    for (auto& block : executable.basic_blocks) {
+        encoder.encode(block.name().view());
+        encoder.encode(static_cast<u64>(block.size()));
+    }
+
+    for (auto& block : executable.basic_blocks) {
+        u32 instruction_count = 0;
+        for (InstructionStreamIterator it(block.instruction_stream()); !it.at_end(); ++it)
+            ++instruction_count;
+        encoder.encode(instruction_count);
+
+        for (InstructionStreamIterator it(block.instruction_stream()); !it.at_end(); ++it) {
+            encoder.encode(static_cast<u8>((*it).type()));
+            (*it).encode(encoder);
+        }
+    }
+
+    if (encoder.has_failed())
+        return {};
+    return move(encoder.buffer());
+}
+
+Optional<Executable> deserialize_executable(ReadonlyBytes bytes, Program const& program)
+{
+    Decoder decoder(bytes, program);
+
+    u32 magic, version, node_count;
+    if (!decoder.decode(magic) || magic != executable_magic)
+        return {};
+    if (!decoder.decode(version) || version != executable_format_version)
+        return {};
+    // The nodes are numbered differently depending on whether function bodies were parsed lazily.
+    bool has_lazily_parsed_function_bodies;
+    if (!decoder.decode(has_lazily_parsed_function_bodies) || has_lazily_parsed_function_bodies != program.has_lazily_parsed_function_bodies())
+        return {};
+    // A different number of nodes means this isn't the program the executable was generated from.
+    if (!decoder.decode(node_count) || node_count != program.function_and_class_nodes().size())
+        return {};
+
+    u64 number_of_registers;
+    if (!decoder.decode(number_of_registers))
+        return {};
+    decoder.set_number_of_registers(number_of_registers);
+
+    auto string_table = make<StringTable>();
+    u32 string_count;
+    if (!decoder.decode(string_count))
+        return {};
+    for (u32 i = 0; i < string_count; ++i) {
+        String string;
+        if (!decoder.decode(string))
+            return {};
+        // Strings in a table are unique, so they keep their indices.
+        if (string_table->insert(string).value() != i)
+            return {};
+    }
+
+    NonnullOwnPtrVector<BasicBlock> basic_blocks;
+    Vector<BasicBlock*> blocks;
+    u32 block_count;
+    if (!decoder.decode(block_count))
+        return {};
+    for (u32 i = 0; i < block_count; ++i) {
+        String name;
+        u64 size;
+        // Every instruction takes up at least a byte in the buffer, and none of them come close to a KiB in memory.
+        if (!decoder.decode(name) || !decoder.decode(size) || size > bytes.size() * KiB)
+            return {};
+        basic_blocks.append(BasicBlock::create(move(name), size));
+        blocks.append(&basic_blocks.last());
+    }
+    decoder.set_blocks(move(blocks));
+
+    for (auto& block : basic_blocks) {
+        decoder.set_current_block(block);
+        u32 instruction_count;
+        if (!decoder.decode(instruction_count))
+            return {};
+        for (u32 i = 0; i < instruction_count; ++i) {
+            u8 type;
+            if (!decoder.decode(type) || !Instruction::decode(static_cast<Instruction::Type>(type), decoder))
+                return {};
+        }
+    }
+
+    if (!decoder.at_end())
+        return {};
+
+    return Executable { move(basic_blocks), move(string_table), number_of_registers, {}, false };
+}
+
+}
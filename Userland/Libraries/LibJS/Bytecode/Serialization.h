@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/HashMap.h>
+#include <AK/Optional.h>
+#include <AK/Vector.h>
+#include <LibJS/Bytecode/BasicBlock.h>
+#include <LibJS/Bytecode/Label.h>
+#include <LibJS/Bytecode/Register.h>
+#include <LibJS/Bytecode/StringTable.h>
+#include <LibJS/Forward.h>
+#include <LibJS/Runtime/Value.h>
+
+namespace JS::Bytecode {
+
+// Writes the operands of instructions into a flat buffer. Nothing in the buffer may point into memory, so basic blocks
+// are written as their index in the executable, and the AST nodes of functions and classes as their index in the
+// program's Program::function_and_class_nodes().
+class Encoder {
+public:
+    Encoder(Executable const&, Program const&);
+
+    void encode(u8);
+    void encode(u32);
+    void encode(u64);
+    void encode(double);
+    void encode(bool);
+    void encode(StringView);
+    void encode(Register);
+    void encode(StringTableIndex);
+    void encode(Label);
+    void encode(Optional<Label> const&);
+    void encode(Value);
+    void encode(FunctionNode const&);
+    void encode(ClassExpression const&);
+
+    // Called for operands that can't be written to the buffer, such as immediate values that are heap cells.
+    void set_failed() { m_failed = true; }
+    bool has_failed() const { return m_failed; }
+
+    ByteBuffer& buffer() { return m_buffer; }
+
+private:
+    void append(void const* data, size_t size) { m_buffer.append(data, size); }
+
+    ByteBuffer m_buffer;
+    HashMap<BasicBlock const*, u32> m_block_indices;
+    HashMap<FunctionNode const*, u32> m_function_node_indices;
+    HashMap<ClassExpression const*, u32> m_class_expression_indices;
+    bool m_failed { false };
+};
+
+// Reads back what an Encoder wrote, and emits the decoded instructions into the current basic block.
+// Every decode() returns false if the buffer ends early or contains something that can't have been encoded.
+class Decoder {
+public:
+    Decoder(ReadonlyBytes, Program const&);
+
+    bool decode(u8&);
+    bool decode(u32&);
+    bool decode(u64&);
+    bool decode(double&);
+    bool decode(bool&);
+    bool decode(String&);
+    bool decode(Register&);
+    bool decode(StringTableIndex&);
+    bool decode(Optional<Label>&);
+    bool decode(Value&);
+    bool decode(Vector<Register>&);
+    FunctionNode const* decode_function_node();
+    ClassExpression const* decode_class_expression();
+
+    // Labels that have to be present, decoded into an Optional since Label has no empty state.
+    bool decode_label(Optional<Label>& label) { return decode(label) && label.has_value(); }
+
+    bool at_end() const { return m_offset >= m_bytes.size(); }
+
+    void set_number_of_registers(size_t number_of_registers) { m_number_of_registers = number_of_registers; }
+    void set_blocks(Vector<BasicBlock*> blocks) { m_blocks = move(blocks); }
+    void set_current_block(BasicBlock& block) { m_current_block = &block; }
+
+    template<typename OpType, typename... Args>
+    bool emit(Args&&... args)
+    {
+        return emit_with_extra_register_slots<OpType>(0, forward<Args>(args)...);
+    }
+
+    template<typename OpType, typename... Args>
+    bool emit_with_extra_register_slots(size_t extra_register_slots, Args&&... args)
+    {
+        // Blocks are created with the size they had when they were encoded, so they can only overflow if the buffer is bad.
+        auto size = sizeof(OpType) + extra_register_slots * sizeof(Register);
+        if (!m_current_block || !m_current_block->can_grow(size))
+            return false;
+        void* slot = m_current_block->next_slot();
+        m_current_block->grow(size);
+        new (slot) OpType(forward<Args>(args)...);
+        return true;
+    }
+
+private:
+    bool read(void* data, size_t size);
+
+    ReadonlyBytes m_bytes;
+    size_t m_offset { 0 };
+    Program const& m_program;
+    size_t m_number_of_registers { 0 };
+    Vector<BasicBlock*> m_blocks;
+    BasicBlock* m_current_block { nullptr };
+};
+
+// Returns an empty buffer if the executable contains something that can't be serialized.
+ByteBuffer serialize_executable(Executable const&, Program const&);
+Optional<Executable> deserialize_executable(ReadonlyBytes, Program const&);
+
+}
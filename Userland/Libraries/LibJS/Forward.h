@@ -152,6 +152,7 @@ class MarkedValueList;
 class NativeFunction;
 class ObjectEnvironment;
 class PrimitiveString;
+class Program;
 class PromiseReaction;
 class PromiseReactionJob;
 class PromiseResolveThenableJob;
@@ -217,4 +218,8 @@ class Interpreter;
 class Register;
 }
 
+namespace JIT {
+class NativeExecutable;
+}
+
 }
@@ -43,6 +43,12 @@ void* BlockAllocator::allocate_block([[maybe_unused]] char const* name)
         auto* block = m_blocks.take_last();
         ASAN_UNPOISON_MEMORY_REGION(block, HeapBlock::block_size);
 #ifdef __serenity__
+        // The kernel may have purged the block while it was cached, but that only means it's zero-filled now.
+        // HeapBlock sets up all of its state when it's created in the block anyway.
+        if (madvise(block, HeapBlock::block_size, MADV_SET_NONVOLATILE) < 0) {
+            perror("madvise(MADV_SET_NONVOLATILE)");
+            VERIFY_NOT_REACHED();
+        }
         if (set_mmap_name(block, HeapBlock::block_size, name) < 0) {
             perror("set_mmap_name");
             VERIFY_NOT_REACHED();
@@ -52,7 +58,7 @@ void* BlockAllocator::allocate_block([[maybe_unused]] char const* name)
     }
 
 #ifdef __serenity__
-    auto* block = (HeapBlock*)serenity_mmap(nullptr, HeapBlock::block_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_RANDOMIZED | MAP_PRIVATE, 0, 0, HeapBlock::block_size, name);
+    auto* block = (HeapBlock*)serenity_mmap(nullptr, HeapBlock::block_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_RANDOMIZED | MAP_PRIVATE | MAP_PURGEABLE, 0, 0, HeapBlock::block_size, name);
     VERIFY(block != MAP_FAILED);
 #else
     auto* block = (HeapBlock*)aligned_alloc(HeapBlock::block_size, HeapBlock::block_size);
@@ -76,6 +82,15 @@ void BlockAllocator::deallocate_block(void* block)
         return;
     }
 
+#ifdef __serenity__
+    // Cached blocks don't hold on to any memory the system needs more urgently, they're just a way to skip the mmap()
+    // when the heap grows again.
+    if (madvise(block, HeapBlock::block_size, MADV_SET_VOLATILE) < 0) {
+        perror("madvise(MADV_SET_VOLATILE)");
+        VERIFY_NOT_REACHED();
+    }
+#endif
+
     ASAN_POISON_MEMORY_REGION(block, HeapBlock::block_size);
     m_blocks.append(block);
 }
@@ -20,9 +20,10 @@ public:
     void deallocate_block(void*);
 
 private:
-    static constexpr size_t max_cached_blocks = 64;
+    // Since cached blocks are volatile, this can be a lot more than what we'd want to keep committed.
+    static constexpr size_t max_cached_blocks = 512;
 
-    Vector<void*, max_cached_blocks> m_blocks;
+    Vector<void*> m_blocks;
 };
 
 }
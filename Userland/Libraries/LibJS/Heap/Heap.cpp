@@ -10,6 +10,7 @@
 #include <AK/StackInfo.h>
 #include <AK/TemporaryChange.h>
 #include <LibCore/ElapsedTimer.h>
+#include <LibJS/Bytecode/Interpreter.h>
 #include <LibJS/Heap/CellAllocator.h>
 #include <LibJS/Heap/Handle.h>
 #include <LibJS/Heap/Heap.h>
@@ -89,6 +90,8 @@ void Heap::collect_garbage(CollectionType collection_type, bool print_report)
 void Heap::gather_roots(HashTable<Cell*>& roots)
 {
     vm().gather_roots(roots);
+    if (auto* bytecode_interpreter = Bytecode::Interpreter::current(); bytecode_interpreter && &bytecode_interpreter->vm() == &vm())
+        bytecode_interpreter->gather_roots(roots);
     gather_conservative_roots(roots);
 
     for (auto& handle : m_handles)
@@ -117,30 +120,36 @@ __attribute__((no_sanitize("address"))) void Heap::gather_conservative_roots(Has
     jmp_buf buf;
     setjmp(buf);
 
+    HashTable<HeapBlock*> all_live_heap_blocks;
+    FlatPtr lowest_block_address = NumericLimits<FlatPtr>::max();
+    FlatPtr highest_block_address = 0;
+    for_each_block([&](auto& block) {
+        all_live_heap_blocks.set(&block);
+        lowest_block_address = min(lowest_block_address, bit_cast<FlatPtr>(&block));
+        highest_block_address = max(highest_block_address, bit_cast<FlatPtr>(&block) + HeapBlock::block_size);
+        return IterationDecision::Continue;
+    });
+
+    // Most words on the stack are return addresses, small integers and pointers into other memory, so weed those out
+    // before they get anywhere near a hash table.
     HashTable<FlatPtr> possible_pointers;
+    auto add_possible_pointer = [&](FlatPtr data) {
+        if (data >= lowest_block_address && data < highest_block_address)
+            possible_pointers.set(data);
+    };
 
     auto* raw_jmp_buf = reinterpret_cast<FlatPtr const*>(buf);
 
-    for (size_t i = 0; i < ((size_t)sizeof(buf)) / sizeof(FlatPtr); i += sizeof(FlatPtr))
-        possible_pointers.set(raw_jmp_buf[i]);
+    for (size_t i = 0; i < ((size_t)sizeof(buf)) / sizeof(FlatPtr); ++i)
+        add_possible_pointer(raw_jmp_buf[i]);
 
     auto stack_reference = bit_cast<FlatPtr>(&dummy);
     auto& stack_info = m_vm.stack_info();
 
-    for (FlatPtr stack_address = stack_reference; stack_address < stack_info.top(); stack_address += sizeof(FlatPtr)) {
-        auto data = *reinterpret_cast<FlatPtr*>(stack_address);
-        possible_pointers.set(data);
-    }
-
-    HashTable<HeapBlock*> all_live_heap_blocks;
-    for_each_block([&](auto& block) {
-        all_live_heap_blocks.set(&block);
-        return IterationDecision::Continue;
-    });
+    for (FlatPtr stack_address = stack_reference; stack_address < stack_info.top(); stack_address += sizeof(FlatPtr))
+        add_possible_pointer(*reinterpret_cast<FlatPtr*>(stack_address));
 
     for (auto possible_pointer : possible_pointers) {
-        if (!possible_pointer)
-            continue;
         dbgln_if(HEAP_DEBUG, "  ? {}", (const void*)possible_pointer);
         auto* possible_heap_block = HeapBlock::from_cell(reinterpret_cast<const Cell*>(possible_pointer));
         if (all_live_heap_blocks.contains(possible_heap_block)) {
@@ -156,6 +165,9 @@ __attribute__((no_sanitize("address"))) void Heap::gather_conservative_roots(Has
     }
 }
 
+// Cells are marked as soon as they're reached, but their edges are only visited once they come off the work stack.
+// Following edges right away would recurse as deep as the longest chain of references, which long linked lists or
+// deeply nested scopes could turn into a stack overflow in the middle of a collection.
 class MarkingVisitor final : public Cell::Visitor {
 public:
     MarkingVisitor() { }
@@ -166,8 +178,17 @@ public:
             return;
         dbgln_if(HEAP_DEBUG, "  ! {}", &cell);
         cell.set_marked(true);
-        cell.visit_edges(*this);
+        m_work_stack.append(&cell);
     }
+
+    void mark_all_live_cells()
+    {
+        while (!m_work_stack.is_empty())
+            m_work_stack.take_last()->visit_edges(*this);
+    }
+
+private:
+    Vector<Cell*, 256> m_work_stack;
 };
 
 void Heap::mark_live_cells(const HashTable<Cell*>& roots)
@@ -176,6 +197,7 @@ void Heap::mark_live_cells(const HashTable<Cell*>& roots)
     MarkingVisitor visitor;
     for (auto* root : roots)
         visitor.visit(root);
+    visitor.mark_all_live_cells();
 }
 
 void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measurement_timer)
@@ -229,6 +251,8 @@ void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measure
     for (auto& weak_container : m_weak_containers)
         weak_container.remove_swept_cells({}, swept_cells);
 
+    m_max_allocations_between_gc = max(min_allocations_between_gc, live_cells);
+
     if constexpr (HEAP_DEBUG) {
         for_each_block([&](auto& block) {
             dbgln(" > Live HeapBlock @ {}: cell_size={}", &block, block.cell_size());
@@ -252,6 +276,7 @@ void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measure
         dbgln("Collected cells: {} ({} bytes)", collected_cells, collected_cell_bytes);
         dbgln("    Live blocks: {} ({} bytes)", live_block_count, live_block_count * HeapBlock::block_size);
         dbgln("   Freed blocks: {} ({} bytes)", empty_blocks.size(), empty_blocks.size() * HeapBlock::block_size);
+        dbgln("  Next GC after: {} allocations", m_max_allocations_between_gc);
         dbgln("=============================================");
     }
 }
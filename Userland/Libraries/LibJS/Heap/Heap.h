@@ -99,7 +99,11 @@ private:
         }
     }
 
-    size_t m_max_allocations_between_gc { 10000 };
+    // How far apart collections are depends on how many cells survived the last one, so the heap can grow to about twice
+    // its live size before it is collected again. That way, the time spent marking and sweeping stays proportional to
+    // the time spent allocating, rather than growing with the size of the heap.
+    static constexpr size_t min_allocations_between_gc = 10000;
+    size_t m_max_allocations_between_gc { min_allocations_between_gc };
     size_t m_allocations_since_last_gc { 0 };
 
     bool m_should_collect_on_every_allocation { false };
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Vector.h>
+
+namespace JS::JIT {
+
+// Emits the handful of x86-64 instructions the baseline compiler needs, nothing more.
+class Assembler {
+public:
+    enum class Reg : u8 {
+        RAX = 0,
+        RCX = 1,
+        RDX = 2,
+        RBX = 3,
+        RSP = 4,
+        RBP = 5,
+        RSI = 6,
+        RDI = 7,
+    };
+
+    explicit Assembler(Vector<u8>& output)
+        : m_output(output)
+    {
+    }
+
+    size_t offset() const { return m_output.size(); }
+
+    void push(Reg reg) { emit8(0x50 | encode(reg)); }
+    void pop(Reg reg) { emit8(0x58 | encode(reg)); }
+    void ret() { emit8(0xc3); }
+
+    // mov dst, src
+    void mov(Reg dst, Reg src)
+    {
+        emit8(0x48);
+        emit8(0x89);
+        emit8(0xc0 | (encode(src) << 3) | encode(dst));
+    }
+
+    // movabs dst, imm64
+    void mov(Reg dst, u64 immediate)
+    {
+        emit8(0x48);
+        emit8(0xb8 | encode(dst));
+        emit64(immediate);
+    }
+
+    // call reg
+    void call(Reg reg)
+    {
+        emit8(0xff);
+        emit8(0xd0 | encode(reg));
+    }
+
+    // test low8(a), low8(b), which only works for the registers that have a low byte register without a REX prefix.
+    void test8(Reg a, Reg b)
+    {
+        VERIFY(encode(a) < 4 && encode(b) < 4);
+        emit8(0x84);
+        emit8(0xc0 | (encode(b) << 3) | encode(a));
+    }
+
+    // jnz rel32, with the target to be filled in by link_jump() later. Returns the jump to link.
+    size_t jump_if_not_zero()
+    {
+        emit8(0x0f);
+        emit8(0x85);
+        auto jump = offset();
+        emit32(0);
+        return jump;
+    }
+
+    void link_jump(size_t jump, size_t target)
+    {
+        auto displacement = static_cast<i32>(static_cast<i64>(target) - static_cast<i64>(jump + sizeof(i32)));
+        for (size_t i = 0; i < sizeof(i32); ++i)
+            m_output[jump + i] = (static_cast<u32>(displacement) >> (i * 8)) & 0xff;
+    }
+
+private:
+    static u8 encode(Reg reg) { return to_underlying(reg); }
+
+    void emit8(u8 value) { m_output.append(value); }
+    void emit32(u32 value)
+    {
+        for (size_t i = 0; i < sizeof(value); ++i)
+            emit8((value >> (i * 8)) & 0xff);
+    }
+    void emit64(u64 value)
+    {
+        for (size_t i = 0; i < sizeof(value); ++i)
+            emit8((value >> (i * 8)) & 0xff);
+    }
+
+    Vector<u8>& m_output;
+};
+
+}
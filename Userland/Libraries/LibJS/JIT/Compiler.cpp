@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Platform.h>
+#include <LibJS/Bytecode/BasicBlock.h>
+#include <LibJS/Bytecode/Generator.h>
+#include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/JIT/Assembler.h>
+#include <LibJS/JIT/Compiler.h>
+
+namespace JS::JIT {
+
+#if ARCH(X86_64)
+using SlowPath = bool (*)(Bytecode::Interpreter&, Bytecode::Instruction const&);
+
+// Returns whether the native code has to hand control back to the interpreter loop.
+template<typename OpType>
+static bool execute_slow_path(Bytecode::Interpreter& interpreter, Bytecode::Instruction const& instruction)
+{
+    static_cast<OpType const&>(instruction).execute_impl(interpreter);
+    return interpreter.has_pending_control_flow();
+}
+
+static SlowPath slow_path_for(Bytecode::Instruction::Type type)
+{
+#    define __BYTECODE_OP(op)                     \
+    case Bytecode::Instruction::Type::op: \
+        return execute_slow_path<Bytecode::Op::op>;
+
+    switch (type) {
+        ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+#    undef __BYTECODE_OP
+}
+#endif
+
+// Every block becomes a function that takes the interpreter and calls into the slow path of each of its instructions
+// in turn, which saves the interpreter's dispatch. Whenever an instruction throws, jumps or returns, the function
+// returns and the interpreter loop takes it from there.
+OwnPtr<NativeExecutable> Compiler::compile(Bytecode::Executable const& executable)
+{
+#if ARCH(X86_64)
+    using Reg = Assembler::Reg;
+
+    Vector<u8> code;
+    HashMap<Bytecode::BasicBlock const*, size_t> block_entry_points;
+    Assembler assembler(code);
+
+    for (auto& block : executable.basic_blocks) {
+        block_entry_points.set(&block, assembler.offset());
+
+        // The interpreter comes in in rdi and is kept in the callee-saved rbx across the calls. Pushing it also leaves
+        // the stack 16-byte aligned for the calls, as the System V ABI requires.
+        assembler.push(Reg::RBX);
+        assembler.mov(Reg::RBX, Reg::RDI);
+
+        Vector<size_t> exits;
+        for (Bytecode::InstructionStreamIterator it { block.instruction_stream() }; !it.at_end();) {
+            auto& instruction = *it;
+            ++it;
+            assembler.mov(Reg::RDI, Reg::RBX);
+            assembler.mov(Reg::RSI, reinterpret_cast<FlatPtr>(&instruction));
+            assembler.mov(Reg::RAX, reinterpret_cast<FlatPtr>(slow_path_for(instruction.type())));
+            assembler.call(Reg::RAX);
+            if (!it.at_end()) {
+                assembler.test8(Reg::RAX, Reg::RAX);
+                exits.append(assembler.jump_if_not_zero());
+            }
+        }
+
+        for (auto exit : exits)
+            assembler.link_jump(exit, assembler.offset());
+        assembler.pop(Reg::RBX);
+        assembler.ret();
+    }
+
+    return NativeExecutable::create(code.span(), move(block_entry_points));
+#else
+    (void)executable;
+    return {};
+#endif
+}
+
+}
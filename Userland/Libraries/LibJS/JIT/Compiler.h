@@ -0,0 +1,21 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/OwnPtr.h>
+#include <LibJS/Forward.h>
+#include <LibJS/JIT/NativeExecutable.h>
+
+namespace JS::JIT {
+
+class Compiler {
+public:
+    // Returns null if there's no native code generation for this platform, or it can't be made executable.
+    static OwnPtr<NativeExecutable> compile(Bytecode::Executable const&);
+};
+
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/Format.h>
+#include <LibJS/JIT/NativeExecutable.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace JS::JIT {
+
+OwnPtr<NativeExecutable> NativeExecutable::create(ReadonlyBytes code, HashMap<Bytecode::BasicBlock const*, size_t> block_entry_points)
+{
+    auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    auto size = ceil_div(code.size(), page_size) * page_size;
+    auto* memory = (u8*)mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0);
+    if (memory == MAP_FAILED) {
+        dbgln_if(JS_BYTECODE_DEBUG, "NativeExecutable: mmap: {}", strerror(errno));
+        return {};
+    }
+    __builtin_memcpy(memory, code.data(), code.size());
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) < 0) {
+        // Serenity doesn't allow anonymous memory to become executable, so this is where we fall back to the interpreter there.
+        dbgln_if(JS_BYTECODE_DEBUG, "NativeExecutable: mprotect: {}", strerror(errno));
+        munmap(memory, size);
+        return {};
+    }
+    return adopt_own(*new NativeExecutable(memory, size, move(block_entry_points)));
+}
+
+NativeExecutable::NativeExecutable(u8* code, size_t size, HashMap<Bytecode::BasicBlock const*, size_t> block_entry_points)
+    : m_code(code)
+    , m_size(size)
+    , m_block_entry_points(move(block_entry_points))
+{
+}
+
+NativeExecutable::~NativeExecutable()
+{
+    munmap(m_code, m_size);
+}
+
+void NativeExecutable::run_block(Bytecode::BasicBlock const& block, Bytecode::Interpreter& interpreter) const
+{
+    auto entry_point = m_block_entry_points.get(&block);
+    VERIFY(entry_point.has_value());
+    auto* function = reinterpret_cast<void (*)(Bytecode::Interpreter&)>(m_code + *entry_point);
+    function(interpreter);
+}
+
+}
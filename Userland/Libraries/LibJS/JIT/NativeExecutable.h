@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/Noncopyable.h>
+#include <AK/OwnPtr.h>
+#include <LibJS/Forward.h>
+
+namespace JS::JIT {
+
+// Machine code for all basic blocks of an executable, in memory that is only ever writable or executable, never both.
+class NativeExecutable {
+    AK_MAKE_NONCOPYABLE(NativeExecutable);
+    AK_MAKE_NONMOVABLE(NativeExecutable);
+
+public:
+    // Returns null if the system doesn't let us make memory executable.
+    static OwnPtr<NativeExecutable> create(ReadonlyBytes code, HashMap<Bytecode::BasicBlock const*, size_t> block_entry_points);
+    ~NativeExecutable();
+
+    // Runs the block until it ends, or until one of its instructions throws, jumps or returns.
+    void run_block(Bytecode::BasicBlock const&, Bytecode::Interpreter&) const;
+
+private:
+    NativeExecutable(u8* code, size_t size, HashMap<Bytecode::BasicBlock const*, size_t> block_entry_points);
+
+    u8* m_code { nullptr };
+    size_t m_size { 0 };
+    HashMap<Bytecode::BasicBlock const*, size_t> m_block_entry_points;
+};
+
+}
@@ -323,6 +323,8 @@ NonnullRefPtr<Program> Parser::parse_program(bool starts_in_strict_mode)
         syntax_error("Unclosed lexical_environment");
     }
     program->source_range().end = position();
+    program->set_function_and_class_nodes(move(m_function_and_class_nodes));
+    program->set_has_lazily_parsed_function_bodies(m_parse_function_bodies_lazily);
     return program;
 }
 
@@ -515,9 +517,11 @@ RefPtr<FunctionExpression> Parser::try_parse_arrow_function_expression(bool expe
         }
     }
 
-    return create_ast_node<FunctionExpression>(
+    auto function = create_ast_node<FunctionExpression>(
         { m_state.current_token.filename(), rule_start.position(), position() }, "", move(body),
         move(parameters), function_length, FunctionKind::Regular, is_strict, true);
+    m_function_and_class_nodes.append(function);
+    return function;
 }
 
 RefPtr<Statement> Parser::try_parse_labelled_statement()
@@ -744,7 +748,9 @@ NonnullRefPtr<ClassExpression> Parser::parse_class_expression(bool expect_class_
         }
     }
 
-    return create_ast_node<ClassExpression>({ m_state.current_token.filename(), rule_start.position(), position() }, move(class_name), move(constructor), move(super_class), move(methods));
+    auto class_expression = create_ast_node<ClassExpression>({ m_state.current_token.filename(), rule_start.position(), position() }, move(class_name), move(constructor), move(super_class), move(methods));
+    m_function_and_class_nodes.append(class_expression);
+    return class_expression;
 }
 
 Parser::PrimaryExpressionParseResult Parser::parse_primary_expression()
@@ -1700,7 +1706,14 @@ NonnullRefPtr<FunctionNodeType> Parser::parse_function_node(u8 parse_options)
     });
 
     bool is_strict = false;
-    auto body = parse_block_statement(is_strict, has_binding);
+    RefPtr<Statement> body;
+    if (m_parse_function_bodies_lazily) {
+        body = preparse_function_body(is_strict, has_binding);
+    } else {
+        auto block = parse_block_statement(is_strict, has_binding);
+        scope.add_to_scope_node(block);
+        body = move(block);
+    }
 
     // If the function contains 'use strict' we need to check the parameters (again).
     if (is_strict) {
@@ -1734,12 +1747,99 @@ NonnullRefPtr<FunctionNodeType> Parser::parse_function_node(u8 parse_options)
 
     m_state.function_parameters.take_last();
 
-    scope.add_to_scope_node(body);
-
-    return create_ast_node<FunctionNodeType>(
+    auto function = create_ast_node<FunctionNodeType>(
         { m_state.current_token.filename(), rule_start.position(), position() },
-        name, move(body), move(parameters), function_length,
+        name, body.release_nonnull(), move(parameters), function_length,
         is_generator ? FunctionKind::Generator : FunctionKind::Regular, is_strict);
+    m_function_and_class_nodes.append(function);
+    return function;
+}
+
+NonnullRefPtr<LazyFunctionBody> Parser::preparse_function_body(bool& is_strict, bool error_on_binding)
+{
+    auto rule_start = push_start();
+    auto start_offset = source_offset_of(m_state.current_token.value());
+    LazyFunctionBody::Context context {
+        .strict_mode = m_state.strict_mode,
+        .allow_super_property_lookup = m_state.allow_super_property_lookup,
+        .allow_super_constructor_call = m_state.allow_super_constructor_call,
+        .in_generator_function_context = m_state.in_generator_function_context,
+        .in_arrow_function_context = m_state.in_arrow_function_context,
+        .in_break_context = m_state.in_break_context,
+        .in_continue_context = m_state.in_continue_context,
+    };
+
+    // When parsing the body of a function we already checked, the bodies of the functions inside it were checked too.
+    // All that's left to do for them is finding their closing brace.
+    if (auto preparsed_body = m_preparsed_function_bodies.get(start_offset); preparsed_body.has_value()) {
+        size_t depth = 0;
+        do {
+            if (match(TokenType::CurlyOpen))
+                ++depth;
+            else if (match(TokenType::CurlyClose))
+                --depth;
+            consume();
+        } while (depth > 0 && !done());
+        is_strict = preparsed_body.value()->is_strict_mode();
+        return *preparsed_body.value();
+    }
+
+    if (m_source.is_null())
+        m_source = m_state.lexer.source();
+
+    auto inner_function_bodies_start = m_lazy_function_bodies.size();
+    auto function_and_class_nodes_start = m_function_and_class_nodes.size();
+
+    // Parsing the body is how we find its errors, but the AST we get out of it is thrown away.
+    parse_block_statement(is_strict, error_on_binding);
+    // The trivia of the token after the closing brace starts right after it.
+    auto end_offset = source_offset_of(m_state.current_token.trivia());
+
+    HashMap<size_t, NonnullRefPtr<LazyFunctionBody>> inner_function_bodies;
+    for (size_t i = inner_function_bodies_start; i < m_lazy_function_bodies.size(); ++i)
+        inner_function_bodies.set(m_lazy_function_bodies[i].start_offset(), m_lazy_function_bodies.ptr_at(i));
+    m_lazy_function_bodies.shrink(inner_function_bodies_start);
+    m_function_and_class_nodes.shrink(function_and_class_nodes_start);
+
+    auto body = create_ast_node<LazyFunctionBody>(
+        { m_state.current_token.filename(), rule_start.position(), position() },
+        m_source, m_state.lexer.filename(), start_offset, end_offset, context, is_strict, move(inner_function_bodies));
+    m_lazy_function_bodies.append(body);
+    return body;
+}
+
+NonnullRefPtr<BlockStatement> Parser::parse_lazy_function_body(LazyFunctionBody const& lazy_body)
+{
+    auto& start = lazy_body.source_range().start;
+    auto source = lazy_body.source().substring_view(lazy_body.start_offset(), lazy_body.end_offset() - lazy_body.start_offset());
+    Parser parser { Lexer { source, lazy_body.filename(), start.line, start.column - 1 } };
+    parser.m_parse_function_bodies_lazily = true;
+    parser.m_source = lazy_body.source();
+    parser.m_source_offset = lazy_body.start_offset();
+    parser.m_preparsed_function_bodies = lazy_body.inner_function_bodies();
+
+    auto& context = lazy_body.context();
+    parser.m_state.strict_mode = context.strict_mode;
+    parser.m_state.allow_super_property_lookup = context.allow_super_property_lookup;
+    parser.m_state.allow_super_constructor_call = context.allow_super_constructor_call;
+    parser.m_state.in_function_context = true;
+    parser.m_state.in_generator_function_context = context.in_generator_function_context;
+    parser.m_state.in_arrow_function_context = context.in_arrow_function_context;
+    parser.m_state.in_break_context = context.in_break_context;
+    parser.m_state.in_continue_context = context.in_continue_context;
+
+    ScopePusher scope(parser, ScopePusher::Var, Parser::Scope::Function);
+    bool is_strict = false;
+    auto body = parser.parse_block_statement(is_strict);
+    scope.add_to_scope_node(body);
+    // This source already parsed without errors once, in the same state.
+    VERIFY(!parser.has_errors());
+    return body;
+}
+
+size_t Parser::source_offset_of(StringView view) const
+{
+    return view.characters_without_null_termination() - m_state.lexer.source().characters_without_null_termination() + m_source_offset;
 }
 
 Vector<FunctionNode::Parameter> Parser::parse_formal_parameters(int& function_length, u8 parse_options)
@@ -39,6 +39,11 @@ public:
 
     NonnullRefPtr<Program> parse_program(bool starts_in_strict_mode = false);
 
+    // In this mode, the bodies of functions are only checked for errors and then discarded, keeping just their source.
+    // They are parsed again when they're first called, which saves the memory of the AST of functions that never are.
+    void set_parse_function_bodies_lazily(bool value) { m_parse_function_bodies_lazily = value; }
+    static NonnullRefPtr<BlockStatement> parse_lazy_function_body(LazyFunctionBody const&);
+
     template<typename FunctionNodeType>
     NonnullRefPtr<FunctionNodeType> parse_function_node(u8 parse_options = FunctionNodeParseOptions::CheckForFunctionAndName);
     Vector<FunctionNode::Parameter> parse_formal_parameters(int& function_length, u8 parse_options = 0);
@@ -170,6 +175,9 @@ private:
     void discard_saved_state();
     Position position() const;
 
+    NonnullRefPtr<LazyFunctionBody> preparse_function_body(bool& is_strict, bool error_on_binding);
+    size_t source_offset_of(StringView) const;
+
     void check_identifier_name_for_assignment_validity(StringView, bool force_strict = false);
 
     bool try_parse_arrow_function_expression_failed_at_position(const Position&) const;
@@ -267,5 +275,13 @@ private:
     FlyString m_filename;
     Vector<ParserState> m_saved_state;
     HashMap<Position, TokenMemoization, PositionKeyTraits> m_token_memoizations;
+    NonnullRefPtrVector<ASTNode> m_function_and_class_nodes;
+
+    bool m_parse_function_bodies_lazily { false };
+    // A copy of the source that lazily parsed function bodies share, and where the lexer's source starts in it.
+    String m_source;
+    size_t m_source_offset { 0 };
+    NonnullRefPtrVector<LazyFunctionBody> m_lazy_function_bodies;
+    HashMap<size_t, NonnullRefPtr<LazyFunctionBody>> m_preparsed_function_bodies;
 };
 }
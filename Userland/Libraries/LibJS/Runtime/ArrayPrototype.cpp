@@ -154,6 +154,25 @@ static Object* array_species_create(GlobalObject& global_object, Object& origina
     return &result.as_object();
 }
 
+// Does "Let kPresent be ? HasProperty(O, Pk). If kPresent is true, then let kValue be ? Get(O, Pk)." for the iterating
+// functions below, and returns an empty value if the element isn't present or an exception was thrown.
+static Value get_element_if_present(VM& vm, Object& object, size_t index)
+{
+    // An element that an Array keeps in simple storage is a plain own data property, so that's what HasProperty() and
+    // Get() would find as well. Holes have to be looked up on the prototype chain, so they take the slow path.
+    if (is<Array>(object) && index <= NumericLimits<u32>::max()) {
+        auto value = object.indexed_properties().get_packed_element(index);
+        if (!value.is_empty())
+            return value;
+    }
+
+    auto property_name = PropertyName { index };
+    auto present = object.has_property(property_name);
+    if (vm.exception() || !present)
+        return {};
+    return object.get(property_name);
+}
+
 // 23.1.3.7 Array.prototype.filter ( callbackfn [ , thisArg ] ), https://tc39.es/ecma262/#sec-array.prototype.filter
 JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::filter)
 {
@@ -190,20 +209,14 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::filter)
     // 7. Repeat, while k < len,
     for (; k < length; ++k) {
         // a. Let Pk be ! ToString(𝔽(k)).
-        auto property_name = PropertyName { k };
-
         // b. Let kPresent be ? HasProperty(O, Pk).
-        auto k_present = object->has_property(property_name);
+        // c. If kPresent is true, then
+        //     i. Let kValue be ? Get(O, Pk).
+        auto k_value = get_element_if_present(vm, *object, k);
         if (vm.exception())
             return {};
 
-        // c. If kPresent is true, then
-        if (k_present) {
-            // i. Let kValue be ? Get(O, Pk).
-            auto k_value = object->get(k);
-            if (vm.exception())
-                return {};
-
+        if (!k_value.is_empty()) {
             // ii. Let selected be ! ToBoolean(? Call(callbackfn, thisArg, « kValue, 𝔽(k), O »)).
             auto selected = vm.call(callback_function.as_function(), this_arg, k_value, Value(k), object);
             if (vm.exception())
@@ -252,20 +265,14 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::for_each)
     // 5. Repeat, while k < len,
     for (size_t k = 0; k < length; ++k) {
         // a. Let Pk be ! ToString(𝔽(k)).
-        auto property_name = PropertyName { k };
-
         // b. Let kPresent be ? HasProperty(O, Pk).
-        auto k_present = object->has_property(property_name);
+        // c. If kPresent is true, then
+        //     i. Let kValue be ? Get(O, Pk).
+        auto k_value = get_element_if_present(vm, *object, k);
         if (vm.exception())
             return {};
 
-        // c. If kPresent is true, then
-        if (k_present) {
-            // i. Let kValue be ? Get(O, Pk).
-            auto k_value = object->get(property_name);
-            if (vm.exception())
-                return {};
-
+        if (!k_value.is_empty()) {
             // ii. Perform ? Call(callbackfn, thisArg, « kValue, 𝔽(k), O »).
             (void)vm.call(callback_function.as_function(), this_arg, k_value, Value(k), object);
             if (vm.exception())
@@ -313,17 +320,13 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::map)
         auto property_name = PropertyName { k };
 
         // b. Let kPresent be ? HasProperty(O, Pk).
-        auto k_present = object->has_property(property_name);
+        // c. If kPresent is true, then
+        //     i. Let kValue be ? Get(O, Pk).
+        auto k_value = get_element_if_present(vm, *object, k);
         if (vm.exception())
             return {};
 
-        // c. If kPresent is true, then
-        if (k_present) {
-            // i. Let kValue be ? Get(O, Pk).
-            auto k_value = object->get(property_name);
-            if (vm.exception())
-                return {};
-
+        if (!k_value.is_empty()) {
             // ii. Let mappedValue be ? Call(callbackfn, thisArg, « kValue, 𝔽(k), O »).
             auto mapped_value = vm.call(callback_function.as_function(), this_arg, k_value, Value(k), object);
             if (vm.exception())
@@ -818,20 +821,14 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::index_of)
 
     // 10. Repeat, while k < len,
     for (; k < length; ++k) {
-        auto property_name = PropertyName { k };
-
         // a. Let kPresent be ? HasProperty(O, ! ToString(𝔽(k))).
-        auto k_present = object->has_property(property_name);
+        // b. If kPresent is true, then
+        //     i. Let elementK be ? Get(O, ! ToString(𝔽(k))).
+        auto element_k = get_element_if_present(vm, *object, k);
         if (vm.exception())
             return {};
 
-        // b. If kPresent is true, then
-        if (k_present) {
-            // i. Let elementK be ? Get(O, ! ToString(𝔽(k))).
-            auto element_k = object->get(property_name);
-            if (vm.exception())
-                return {};
-
+        if (!element_k.is_empty()) {
             // ii. Let same be IsStrictlyEqual(searchElement, elementK).
             auto same = strict_eq(search_element, element_k);
 
@@ -1237,17 +1234,12 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::sort)
 
     MarkedValueList items(vm.heap());
     for (size_t k = 0; k < length; ++k) {
-        auto k_present = object->has_property(k);
+        auto k_value = get_element_if_present(vm, *object, k);
         if (vm.exception())
             return {};
 
-        if (k_present) {
-            auto k_value = object->get(k);
-            if (vm.exception())
-                return {};
-
+        if (!k_value.is_empty())
             items.append(k_value);
-        }
     }
 
     // Perform sorting by merge sort. This isn't as efficient compared to quick sort, but
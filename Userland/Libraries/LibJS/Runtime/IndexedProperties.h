@@ -140,6 +140,18 @@ public:
 
     Vector<u32> indices() const;
 
+    // Simple storage only ever holds plain data properties with default attributes. This returns the one at the given
+    // index if there is one, and an empty value for holes and whenever the storage is generic.
+    Value get_packed_element(u32 index) const
+    {
+        if (!m_storage->is_simple_storage())
+            return {};
+        auto& storage = static_cast<SimpleIndexedPropertyStorage const&>(*m_storage);
+        if (index >= storage.array_like_size())
+            return {};
+        return storage.elements()[index];
+    }
+
     template<typename Callback>
     void for_each_value(Callback callback)
     {
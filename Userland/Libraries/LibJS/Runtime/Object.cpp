@@ -955,12 +955,23 @@ void Object::storage_set(PropertyName const& property_name, ValueAndAttributes c
     }
 
     auto property_name_string_or_symbol = property_name.to_string_or_symbol();
+
+    if (!m_shape->is_unique()) {
+        if (auto* next_shape = m_shape->lookup_put_transition(property_name_string_or_symbol, attributes)) {
+            set_shape(*next_shape);
+            m_storage[next_shape->property_count() - 1] = value;
+            return;
+        }
+    }
+
     auto metadata = shape().lookup(property_name_string_or_symbol);
 
     if (!metadata.has_value()) {
-        if (!m_shape->is_unique() && shape().property_count() > 100) {
+        if (!m_shape->is_unique() && (shape().property_count() > 100 || m_new_shape_transition_count >= 64)) {
             // If you add more than 100 properties to an object, let's stop doing
             // transitions to avoid filling up the heap with shapes.
+            // The same goes for objects that keep adding properties no other object has added before them,
+            // as that's what happens when an object is used as a hash map.
             ensure_shape_is_unique();
         }
 
@@ -968,6 +979,8 @@ void Object::storage_set(PropertyName const& property_name, ValueAndAttributes c
             m_shape->add_property_to_unique_shape(property_name_string_or_symbol, attributes);
             m_storage.resize(m_shape->property_count());
         } else if (m_transitions_enabled) {
+            // The cached transition lookup above failed, so this allocates a new shape.
+            ++m_new_shape_transition_count;
             set_shape(*m_shape->create_put_transition(property_name_string_or_symbol, attributes));
         } else {
             m_shape->add_property_without_transition(property_name, attributes);
@@ -145,6 +145,7 @@ public:
     virtual Value value_of() const { return Value(const_cast<Object*>(this)); }
 
     Value get_direct(size_t index) const { return m_storage[index]; }
+    void put_direct(size_t index, Value value) { m_storage[index] = value; }
 
     const IndexedProperties& indexed_properties() const { return m_indexed_properties; }
     IndexedProperties& indexed_properties() { return m_indexed_properties; }
@@ -196,6 +197,10 @@ private:
     Object const* prototype() const { return shape().prototype(); }
 
     bool m_transitions_enabled { true };
+
+    // Number of put transitions this object had to allocate a new shape for, see storage_set().
+    u8 m_new_shape_transition_count { 0 };
+
     Shape* m_shape { nullptr };
     Vector<Value> m_storage;
     IndexedProperties m_indexed_properties;
@@ -101,6 +101,14 @@ void OrdinaryFunctionObject::visit_edges(Visitor& visitor)
     visitor.visit(m_environment);
 }
 
+const Statement& OrdinaryFunctionObject::body() const
+{
+    // Functions parsed lazily get their body parsed on first use, which is usually the first call.
+    if (is<LazyFunctionBody>(*m_body))
+        return static_cast<const LazyFunctionBody&>(*m_body).body();
+    return m_body;
+}
+
 FunctionEnvironment* OrdinaryFunctionObject::create_environment(FunctionObject& function_being_invoked)
 {
     HashMap<FlyString, Variable> variables;
@@ -181,7 +189,7 @@ Value OrdinaryFunctionObject::execute_function_body()
     if (bytecode_interpreter) {
         prepare_arguments();
         if (!m_bytecode_executable.has_value()) {
-            m_bytecode_executable = Bytecode::Generator::generate(m_body, m_kind == FunctionKind::Generator);
+            m_bytecode_executable = Bytecode::Generator::generate(body(), m_kind == FunctionKind::Generator);
             auto& passes = JS::Bytecode::Interpreter::optimization_pipeline();
             passes.perform(*m_bytecode_executable);
             if constexpr (JS_BYTECODE_DEBUG) {
@@ -212,7 +220,7 @@ Value OrdinaryFunctionObject::execute_function_body()
         if (vm.exception())
             return {};
 
-        return ast_interpreter->execute_statement(global_object(), m_body, ScopeType::Function);
+        return ast_interpreter->execute_statement(global_object(), body(), ScopeType::Function);
     }
 }
 
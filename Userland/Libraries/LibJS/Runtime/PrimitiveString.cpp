@@ -5,6 +5,7 @@
  */
 
 #include <AK/CharacterTypes.h>
+#include <AK/StringBuilder.h>
 #include <AK/Utf16View.h>
 #include <LibJS/Runtime/PrimitiveString.h>
 #include <LibJS/Runtime/VM.h>
@@ -16,14 +17,68 @@ PrimitiveString::PrimitiveString(String string)
 {
 }
 
+PrimitiveString::PrimitiveString(PrimitiveString& lhs, PrimitiveString& rhs)
+    : m_is_rope(true)
+    , m_lhs(&lhs)
+    , m_rhs(&rhs)
+    , m_rope_length(lhs.length_in_bytes() + rhs.length_in_bytes())
+{
+}
+
 PrimitiveString::~PrimitiveString()
 {
 }
 
+void PrimitiveString::visit_edges(Cell::Visitor& visitor)
+{
+    Cell::visit_edges(visitor);
+    visitor.visit(m_lhs);
+    visitor.visit(m_rhs);
+}
+
+void PrimitiveString::resolve_rope() const
+{
+    VERIFY(m_is_rope);
+
+    // Ropes that were built by appending to the same string over and over again are as deep as they are long, so walk
+    // them with an explicit stack rather than recursively.
+    StringBuilder builder(m_rope_length);
+    bool is_ascii = true;
+    Vector<PrimitiveString const*, 32> pieces;
+    pieces.append(this);
+    while (!pieces.is_empty()) {
+        auto const* piece = pieces.take_last();
+        if (piece->m_is_rope) {
+            pieces.append(piece->m_rhs);
+            pieces.append(piece->m_lhs);
+            continue;
+        }
+        builder.append(piece->m_string);
+        if (is_ascii) {
+            for (auto ch : piece->m_string.bytes()) {
+                if (!AK::is_ascii(ch)) {
+                    is_ascii = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    m_string = builder.to_string();
+    // Like js_string() does, re-encode non-ASCII strings so that a surrogate pair that got split across the two halves
+    // ends up as a single code point.
+    if (!is_ascii)
+        m_string = Utf16View { AK::utf8_to_utf16(m_string) }.to_utf8(Utf16View::AllowInvalidCodeUnits::Yes);
+
+    m_is_rope = false;
+    m_lhs = nullptr;
+    m_rhs = nullptr;
+}
+
 Vector<u16> const& PrimitiveString::utf16_string() const
 {
-    if (m_utf16_string.is_empty() && !m_string.is_empty())
-        m_utf16_string = AK::utf8_to_utf16(m_string);
+    if (m_utf16_string.is_empty() && !is_empty())
+        m_utf16_string = AK::utf8_to_utf16(string());
     return m_utf16_string;
 }
 
@@ -82,4 +137,23 @@ PrimitiveString* js_string(VM& vm, String string)
     return js_string(vm.heap(), move(string));
 }
 
+PrimitiveString* js_rope_string(VM& vm, PrimitiveString& lhs, PrimitiveString& rhs)
+{
+    if (lhs.is_empty())
+        return &rhs;
+    if (rhs.is_empty())
+        return &lhs;
+
+    // A rope costs more than just copying a couple of bytes, so short strings are still concatenated right away.
+    static constexpr size_t min_rope_length = 32;
+    if (lhs.length_in_bytes() + rhs.length_in_bytes() < min_rope_length) {
+        StringBuilder builder(lhs.length_in_bytes() + rhs.length_in_bytes());
+        builder.append(lhs.string());
+        builder.append(rhs.string());
+        return js_string(vm, builder.to_string());
+    }
+
+    return vm.heap().allocate_without_global_object<PrimitiveString>(lhs, rhs);
+}
+
 }
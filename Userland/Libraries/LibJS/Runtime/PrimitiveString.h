@@ -15,17 +15,37 @@ namespace JS {
 class PrimitiveString final : public Cell {
 public:
     explicit PrimitiveString(String);
+    PrimitiveString(PrimitiveString& lhs, PrimitiveString& rhs);
     virtual ~PrimitiveString();
 
-    String const& string() const { return m_string; }
+    String const& string() const
+    {
+        if (m_is_rope)
+            resolve_rope();
+        return m_string;
+    }
+
+    // These don't flatten a rope.
+    bool is_empty() const { return length_in_bytes() == 0; }
+    size_t length_in_bytes() const { return m_is_rope ? m_rope_length : m_string.length(); }
 
     Vector<u16> const& utf16_string() const;
     Utf16View utf16_string_view() const;
 
 private:
     virtual const char* class_name() const override { return "PrimitiveString"; }
+    virtual void visit_edges(Cell::Visitor&) override;
+
+    void resolve_rope() const;
 
-    String m_string;
+    // A rope is the concatenation of two other strings, which is only put together once someone looks at the contents.
+    // That makes repeatedly appending to a string linear instead of quadratic.
+    mutable bool m_is_rope { false };
+    mutable PrimitiveString* m_lhs { nullptr };
+    mutable PrimitiveString* m_rhs { nullptr };
+    size_t m_rope_length { 0 };
+
+    mutable String m_string;
     mutable Vector<u16> m_utf16_string;
 };
 
@@ -35,4 +55,6 @@ PrimitiveString* js_string(VM&, Utf16View const&);
 PrimitiveString* js_string(Heap&, String);
 PrimitiveString* js_string(VM&, String);
 
+PrimitiveString* js_rope_string(VM&, PrimitiveString& lhs, PrimitiveString& rhs);
+
 }
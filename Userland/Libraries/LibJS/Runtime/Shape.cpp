@@ -46,6 +46,15 @@ Shape* Shape::create_put_transition(const StringOrSymbol& property_name, Propert
     return new_shape;
 }
 
+Shape* Shape::lookup_put_transition(StringOrSymbol const& property_name, PropertyAttributes attributes)
+{
+    // Configure transitions are cached under the same key, but those are for properties this shape already has.
+    auto* existing_shape = get_or_prune_cached_forward_transition({ property_name, attributes });
+    if (!existing_shape || existing_shape->m_transition_type != TransitionType::Put)
+        return nullptr;
+    return existing_shape;
+}
+
 Shape* Shape::create_configure_transition(const StringOrSymbol& property_name, PropertyAttributes attributes)
 {
     TransitionKey key { property_name, attributes };
@@ -117,7 +126,7 @@ Optional<PropertyMetadata> Shape::lookup(const StringOrSymbol& property_name) co
     return property;
 }
 
-FLATTEN HashMap<StringOrSymbol, PropertyMetadata> const& Shape::property_table() const
+FLATTEN FlatHashMap<StringOrSymbol, PropertyMetadata> const& Shape::property_table() const
 {
     ensure_property_table();
     return *m_property_table;
@@ -144,20 +153,27 @@ void Shape::ensure_property_table() const
 {
     if (m_property_table)
         return;
-    m_property_table = make<HashMap<StringOrSymbol, PropertyMetadata>>();
+    m_property_table = make<FlatHashMap<StringOrSymbol, PropertyMetadata>>();
 
     u32 next_offset = 0;
 
+    // The chain is collected from this shape backwards, and then replayed oldest transition first.
     Vector<const Shape*, 64> transition_chain;
+    transition_chain.append(this);
     for (auto* shape = m_previous; shape; shape = shape->m_previous) {
         if (shape->m_property_table) {
-            *m_property_table = *shape->m_property_table;
+            // Along a chain of transitions, the previous shape is usually only passed through on the way to this one,
+            // so take its property table over rather than keeping a copy per shape. If the previous shape does get
+            // looked up again, it rebuilds its table from its own predecessors.
+            if (shape == m_previous && shape->can_rebuild_property_table())
+                m_property_table = move(shape->m_property_table);
+            else
+                *m_property_table = *shape->m_property_table;
             next_offset = shape->m_property_count;
             break;
         }
         transition_chain.append(shape);
     }
-    transition_chain.append(this);
 
     for (ssize_t i = transition_chain.size() - 1; i >= 0; --i) {
         auto* shape = transition_chain[i];
@@ -211,6 +227,7 @@ void Shape::add_property_without_transition(StringOrSymbol const& property_name,
 {
     VERIFY(property_name.is_valid());
     ensure_property_table();
+    m_has_properties_outside_transition_chain = true;
     if (m_property_table->set(property_name, { m_property_count, attributes }) == AK::HashSetResult::InsertedNewEntry)
         ++m_property_count;
 }
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/FlatHashMap.h>
 #include <AK/HashMap.h>
 #include <AK/OwnPtr.h>
 #include <AK/WeakPtr.h>
@@ -54,6 +55,10 @@ public:
     Shape(Shape& previous_shape, Object* new_prototype);
 
     Shape* create_put_transition(const StringOrSymbol&, PropertyAttributes attributes);
+
+    // An existing put transition means that this shape doesn't have the property yet, so objects that follow a known
+    // chain of transitions never need the property tables of the shapes along the way.
+    Shape* lookup_put_transition(StringOrSymbol const&, PropertyAttributes attributes);
     Shape* create_configure_transition(const StringOrSymbol&, PropertyAttributes attributes);
     Shape* create_prototype_transition(Object* new_prototype);
 
@@ -69,7 +74,7 @@ public:
     const Object* prototype() const { return m_prototype; }
 
     Optional<PropertyMetadata> lookup(const StringOrSymbol&) const;
-    const HashMap<StringOrSymbol, PropertyMetadata>& property_table() const;
+    const FlatHashMap<StringOrSymbol, PropertyMetadata>& property_table() const;
     size_t property_count() const;
 
     struct Property {
@@ -91,14 +96,17 @@ private:
 
     Shape* get_or_prune_cached_forward_transition(TransitionKey const&);
     void ensure_property_table() const;
+    bool can_rebuild_property_table() const { return m_transition_type != TransitionType::Invalid && !m_unique && !m_has_properties_outside_transition_chain; }
 
     PropertyAttributes m_attributes { 0 };
     TransitionType m_transition_type : 6 { TransitionType::Invalid };
     bool m_unique : 1 { false };
+    // Properties added without a transition only exist in the property table, so it can't be rebuilt from the chain.
+    bool m_has_properties_outside_transition_chain : 1 { false };
 
     Object* m_global_object { nullptr };
 
-    mutable OwnPtr<HashMap<StringOrSymbol, PropertyMetadata>> m_property_table;
+    mutable OwnPtr<FlatHashMap<StringOrSymbol, PropertyMetadata>> m_property_table;
 
     HashMap<TransitionKey, WeakPtr<Shape>> m_forward_transitions;
     Shape* m_previous { nullptr };
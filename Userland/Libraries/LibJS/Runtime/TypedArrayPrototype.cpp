@@ -6,6 +6,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/QuickSort.h>
 #include <LibJS/Runtime/AbstractOperations.h>
 #include <LibJS/Runtime/ArrayIterator.h>
 #include <LibJS/Runtime/GlobalObject.h>
@@ -129,6 +130,104 @@ static void for_each_item(VM& vm, GlobalObject& global_object, const String& nam
     }
 }
 
+// Calls the callback with the typed array as its concrete TypedArray<T>, so it can work on the raw elements in its buffer.
+template<typename Callback>
+static decltype(auto) visit_typed_array(TypedArrayBase& typed_array, Callback callback)
+{
+#define __JS_ENUMERATE(ClassName, snake_name, PrototypeName, ConstructorName, Type) \
+    if (is<ClassName>(typed_array))                                                 \
+        return callback(static_cast<TypedArray<Type>&>(typed_array));
+    JS_ENUMERATE_TYPED_ARRAYS
+#undef __JS_ENUMERATE
+
+    VERIFY_NOT_REACHED();
+}
+
+enum class SearchDirection {
+    Forward,
+    Backward,
+};
+
+// Searches the elements in [from, to) for a Number by comparing the raw elements, instead of creating a Value for each one.
+// SameValueZero and IsStrictlyEqual only differ for NaN on Numbers, so nan_is_found picks between the two.
+template<typename T>
+static Optional<u32> find_number_in_typed_array(TypedArray<T>& typed_array, double search_element, u32 from, u32 to, SearchDirection direction, bool nan_is_found)
+{
+    using ElementType = typename TypedArray<T>::UnderlyingBufferDataType;
+
+    if (from >= to)
+        return {};
+    auto elements = typed_array.data().slice(from, to - from);
+
+    auto find = [&](auto matches) -> Optional<u32> {
+        if (direction == SearchDirection::Forward) {
+            for (size_t i = 0; i < elements.size(); ++i) {
+                if (matches(elements[i]))
+                    return from + i;
+            }
+        } else {
+            for (size_t i = elements.size(); i > 0; --i) {
+                if (matches(elements[i - 1]))
+                    return from + i - 1;
+            }
+        }
+        return {};
+    };
+
+    if (isnan(search_element)) {
+        if constexpr (IsFloatingPoint<ElementType>) {
+            if (nan_is_found)
+                return find([](ElementType element) { return isnan(element); });
+        }
+        return {};
+    }
+
+    // A value the element type can't represent can't be in the array.
+    if constexpr (!IsFloatingPoint<ElementType>) {
+        if (search_element < static_cast<double>(NumericLimits<ElementType>::min()) || search_element > static_cast<double>(NumericLimits<ElementType>::max()))
+            return {};
+    }
+    auto needle = static_cast<ElementType>(search_element);
+    if (static_cast<double>(needle) != search_element)
+        return {};
+
+    if constexpr (sizeof(ElementType) == 1) {
+        if (direction == SearchDirection::Forward) {
+            auto const* match = static_cast<ElementType const*>(__builtin_memchr(elements.data(), static_cast<u8>(needle), elements.size()));
+            if (!match)
+                return {};
+            return from + (match - elements.data());
+        }
+    }
+
+    // +0 and -0 compare equal here, as they do for both SameValueZero and IsStrictlyEqual.
+    return find([needle](ElementType element) { return element == needle; });
+}
+
+// Sorts the elements as their underlying type, which orders them the same way as the default comparison of
+// %TypedArray%.prototype.sort: numerically, with -0 before +0 and NaN last.
+template<typename T>
+static void sort_typed_array_elements(TypedArray<T>& typed_array)
+{
+    using ElementType = typename TypedArray<T>::UnderlyingBufferDataType;
+
+    auto elements = typed_array.data();
+    if (elements.size() <= 1)
+        return;
+
+    if constexpr (IsFloatingPoint<ElementType>) {
+        quick_sort(elements, [](ElementType a, ElementType b) {
+            if (isnan(b))
+                return !isnan(a);
+            if (a == b)
+                return signbit(a) && !signbit(b);
+            return a < b;
+        });
+    } else {
+        quick_sort(elements);
+    }
+}
+
 // 23.2.4.1 TypedArraySpeciesCreate ( exemplar, argumentList ), https://tc39.es/ecma262/#typedarray-species-create
 static TypedArrayBase* typed_array_species_create(GlobalObject& global_object, TypedArrayBase const& exemplar, MarkedValueList arguments)
 {
@@ -266,10 +365,25 @@ JS_DEFINE_NATIVE_FUNCTION(TypedArrayPrototype::fill)
         return {};
     }
 
-    for (; k < final; ++k) {
-        typed_array->set(k, value, Object::ShouldThrowExceptions::Yes);
-        if (vm.exception())
-            return {};
+    if (k >= final)
+        return typed_array;
+
+    // The value is already a Number or BigInt, so storing it has no side effects. Store it into the first element, and then
+    // copy that element's bytes over the rest of the range, instead of converting the value again for every element.
+    auto element_size = typed_array->element_size();
+    auto first_byte_index = typed_array->byte_offset() + k * element_size;
+    typed_array->set_value_in_buffer(first_byte_index, value, ArrayBuffer::Unordered);
+
+    auto* bytes = typed_array->viewed_array_buffer()->buffer().data() + first_byte_index;
+    size_t byte_count = (final - k) * element_size;
+    if (element_size == 1) {
+        __builtin_memset(bytes, bytes[0], byte_count);
+    } else {
+        for (size_t filled = element_size; filled < byte_count;) {
+            auto chunk_size = min(filled, byte_count - filled);
+            __builtin_memcpy(bytes + filled, bytes, chunk_size);
+            filled += chunk_size;
+        }
     }
 
     return typed_array;
@@ -345,6 +459,15 @@ JS_DEFINE_NATIVE_FUNCTION(TypedArrayPrototype::includes)
     }
 
     auto search_element = vm.argument(0);
+    if (typed_array->content_type() == TypedArrayBase::ContentType::Number && !typed_array->viewed_array_buffer()->is_detached()) {
+        if (!search_element.is_number())
+            return Value(false);
+        auto index = visit_typed_array(*typed_array, [&](auto& array) {
+            return find_number_in_typed_array(array, search_element.as_double(), k, length, SearchDirection::Forward, true);
+        });
+        return Value(index.has_value());
+    }
+
     for (; k < length; ++k) {
         auto element_k = typed_array->get(k);
 
@@ -388,6 +511,15 @@ JS_DEFINE_NATIVE_FUNCTION(TypedArrayPrototype::index_of)
     }
 
     auto search_element = vm.argument(0);
+    if (typed_array->content_type() == TypedArrayBase::ContentType::Number && !typed_array->viewed_array_buffer()->is_detached()) {
+        if (!search_element.is_number())
+            return Value(-1);
+        auto index = visit_typed_array(*typed_array, [&](auto& array) {
+            return find_number_in_typed_array(array, search_element.as_double(), k, length, SearchDirection::Forward, false);
+        });
+        return index.has_value() ? Value(*index) : Value(-1);
+    }
+
     for (; k < length; ++k) {
         auto k_present = typed_array->has_property(k);
         if (k_present) {
@@ -436,6 +568,15 @@ JS_DEFINE_NATIVE_FUNCTION(TypedArrayPrototype::last_index_of)
     }
 
     auto search_element = vm.argument(0);
+    if (typed_array->content_type() == TypedArrayBase::ContentType::Number && !typed_array->viewed_array_buffer()->is_detached()) {
+        if (!search_element.is_number() || k < 0)
+            return Value(-1);
+        auto index = visit_typed_array(*typed_array, [&](auto& array) {
+            return find_number_in_typed_array(array, search_element.as_double(), 0, k + 1, SearchDirection::Backward, false);
+        });
+        return index.has_value() ? Value(*index) : Value(-1);
+    }
+
     for (; k >= 0; --k) {
         auto k_present = typed_array->has_property(k);
         if (k_present) {
@@ -701,16 +842,9 @@ JS_DEFINE_NATIVE_FUNCTION(TypedArrayPrototype::set)
             return {};
         }
 
-        size_t source_byte_index;
-        bool same = false;
         // FIXME: Step 19: If both IsSharedArrayBuffer(srcBuffer) and IsSharedArrayBuffer(targetBuffer) are true...
-        same = same_value(source_buffer, target_buffer);
-        if (same) {
-            // FIXME: Implement this: Step 21
-            TODO();
-        } else {
-            source_byte_index = source_byte_offset;
-        }
+        auto same = same_value(source_buffer, target_buffer);
+        size_t source_byte_index = source_byte_offset;
         Checked<size_t> checked_target_byte_index(static_cast<size_t>(target_offset));
         checked_target_byte_index *= typed_array->element_size();
         checked_target_byte_index += target_byte_offset;
@@ -729,9 +863,21 @@ JS_DEFINE_NATIVE_FUNCTION(TypedArrayPrototype::set)
         }
         auto limit = checked_limit.value();
 
-        if (source_typed_array.element_size() == typed_array->element_size()) {
+        if (source_typed_array.element_name() == typed_array->element_name()) {
             // FIXME: SharedBuffers use a different mechanism, implement that when SharedBuffers are implemented.
-            target_buffer->buffer().overwrite(target_byte_index, source_buffer->buffer().data(), limit - target_byte_index);
+            // This also covers step 21 for arrays of the same type: memmove reads the source as if it had been cloned first.
+            __builtin_memmove(target_buffer->buffer().data() + target_byte_index, source_buffer->buffer().data() + source_byte_index, limit - target_byte_index);
+        } else if (same) {
+            // 21. Instead of cloning the source buffer, read all of the source's values before any of them can be overwritten.
+            MarkedValueList values(vm.heap());
+            for (u32 i = 0; i < source_length; ++i) {
+                values.append(source_typed_array.get_value_from_buffer(source_byte_index, ArrayBuffer::Unordered));
+                source_byte_index += source_typed_array.element_size();
+            }
+            for (auto& value : values) {
+                typed_array->set_value_in_buffer(target_byte_index, value, ArrayBuffer::Unordered);
+                target_byte_index += typed_array->element_size();
+            }
         } else {
             while (target_byte_index < limit) {
                 auto value = source_typed_array.get_value_from_buffer(source_byte_index, ArrayBuffer::Unordered);
@@ -893,9 +1039,15 @@ JS_DEFINE_NATIVE_FUNCTION(TypedArrayPrototype::slice)
 
             auto& source_buffer = *typed_array->viewed_array_buffer();
             auto& target_buffer = *new_array->viewed_array_buffer();
-            for (; target_byte_index < limit.value(); ++source_byte_index, ++target_byte_index) {
-                auto value = source_buffer.get_value<u8>(source_byte_index.value(), true, ArrayBuffer::Unordered);
-                target_buffer.set_value<u8>(target_byte_index, value, true, ArrayBuffer::Unordered);
+            if (&source_buffer != &target_buffer) {
+                __builtin_memcpy(target_buffer.buffer().data() + target_byte_index, source_buffer.buffer().data() + source_byte_index.value(), limit.value() - target_byte_index);
+            } else {
+                // A species constructor can return a view on the source's own buffer, in which case the bytes have to be
+                // copied one at a time in ascending order, exactly as the spec does.
+                for (; target_byte_index < limit.value(); ++source_byte_index, ++target_byte_index) {
+                    auto value = source_buffer.get_value<u8>(source_byte_index.value(), true, ArrayBuffer::Unordered);
+                    target_buffer.set_value<u8>(target_byte_index, value, true, ArrayBuffer::Unordered);
+                }
             }
         }
     }
@@ -1010,6 +1162,12 @@ JS_DEFINE_NATIVE_FUNCTION(TypedArrayPrototype::sort)
     if (!typed_array)
         return {};
 
+    // Without a comparator, nothing observable happens while sorting, so the elements can be sorted in place.
+    if (compare_fn.is_undefined()) {
+        visit_typed_array(*typed_array, [](auto& array) { sort_typed_array_elements(array); });
+        return typed_array;
+    }
+
     auto length = typed_array->array_length();
 
     MarkedValueList items(vm.heap());
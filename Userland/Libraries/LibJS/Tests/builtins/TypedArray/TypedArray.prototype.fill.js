@@ -55,3 +55,26 @@ test("basic functionality", () => {
         expect(typedArray[2]).toBe(0n);
     });
 });
+
+test("filling a range of many elements", () => {
+    TYPED_ARRAYS.forEach(T => {
+        const typedArray = new T(100);
+        typedArray.fill(7, 3, 97);
+
+        expect(typedArray[2]).toBe(0);
+        for (let i = 3; i < 97; ++i) expect(typedArray[i]).toBe(7);
+        expect(typedArray[97]).toBe(0);
+    });
+
+    BIGINT_TYPED_ARRAYS.forEach(T => {
+        const typedArray = new T(37);
+        typedArray.fill(-1n, 1);
+
+        expect(typedArray[0]).toBe(0n);
+        expect(typedArray[36]).toBe(typedArray[1]);
+    });
+
+    const view = new Uint16Array(new ArrayBuffer(16), 4, 5);
+    view.fill(0x1234);
+    expect(Array.from(new Uint16Array(view.buffer))).toEqual([0, 0, 0x1234, 0x1234, 0x1234, 0x1234, 0x1234, 0]);
+});
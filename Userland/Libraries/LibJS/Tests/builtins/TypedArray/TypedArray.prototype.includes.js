@@ -42,3 +42,16 @@ test("basic functionality", () => {
         expect(typedArray.includes(2n, -2)).toBe(true);
     });
 });
+
+test("NaN and zeros", () => {
+    [Float32Array, Float64Array].forEach(T => {
+        const typedArray = new T([1, NaN, -0]);
+
+        expect(typedArray.includes(NaN)).toBeTrue();
+        expect(typedArray.indexOf(NaN)).toBe(-1);
+        expect(typedArray.includes(0)).toBeTrue();
+        expect(typedArray.includes(NaN, 2)).toBeFalse();
+    });
+
+    expect(new Uint8Array([1, 2]).includes(NaN)).toBeFalse();
+});
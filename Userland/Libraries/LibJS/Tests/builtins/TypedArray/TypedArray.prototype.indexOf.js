@@ -42,3 +42,25 @@ test("basic functionality", () => {
         expect(typedArray.indexOf(2n, -2)).toBe(1);
     });
 });
+
+test("values the element type can't hold are never found", () => {
+    TYPED_ARRAYS.forEach(T => {
+        const typedArray = new T([0, 1, 255, 0]);
+
+        expect(typedArray.indexOf(1.5)).toBe(-1);
+        expect(typedArray.indexOf(NaN)).toBe(-1);
+        expect(typedArray.indexOf(2 ** 40)).toBe(-1);
+        expect(typedArray.indexOf("1")).toBe(-1);
+        expect(typedArray.indexOf(-0)).toBe(0);
+        expect(typedArray.indexOf(0, 1)).toBe(3);
+    });
+
+    const int8Array = new Int8Array([1, -1]);
+    expect(int8Array.indexOf(-1)).toBe(1);
+    expect(int8Array.indexOf(255)).toBe(-1);
+
+    const float32Array = new Float32Array([0.1, 0.5]);
+    expect(float32Array.indexOf(0.1)).toBe(-1);
+    expect(float32Array.indexOf(Math.fround(0.1))).toBe(0);
+    expect(float32Array.indexOf(0.5)).toBe(1);
+});
@@ -42,3 +42,16 @@ test("basic functionality", () => {
         expect(typedArray.lastIndexOf(2n, -2)).toBe(1);
     });
 });
+
+test("searches backwards from the given index", () => {
+    TYPED_ARRAYS.forEach(T => {
+        const typedArray = new T([7, 8, 7, 8]);
+
+        expect(typedArray.lastIndexOf(7)).toBe(2);
+        expect(typedArray.lastIndexOf(7, 1)).toBe(0);
+        expect(typedArray.lastIndexOf(8, -3)).toBe(1);
+        expect(typedArray.lastIndexOf(8, -4)).toBe(-1);
+        expect(typedArray.lastIndexOf(7.5)).toBe(-1);
+        expect(typedArray.lastIndexOf(7, -5)).toBe(-1);
+    });
+});
@@ -0,0 +1,68 @@
+const TYPED_ARRAYS = [
+    Uint8Array,
+    Uint8ClampedArray,
+    Uint16Array,
+    Uint32Array,
+    Int8Array,
+    Int16Array,
+    Int32Array,
+    Float32Array,
+    Float64Array,
+];
+
+const BIGINT_TYPED_ARRAYS = [BigUint64Array, BigInt64Array];
+
+test("basic functionality", () => {
+    TYPED_ARRAYS.forEach(T => {
+        expect(T.prototype.set).toHaveLength(1);
+
+        const typedArray = new T(5);
+        expect(typedArray.set([1, 2], 1)).toBeUndefined();
+        expect(Array.from(typedArray)).toEqual([0, 1, 2, 0, 0]);
+
+        typedArray.set(new T([3, 4]), 3);
+        expect(Array.from(typedArray)).toEqual([0, 1, 2, 3, 4]);
+    });
+
+    BIGINT_TYPED_ARRAYS.forEach(T => {
+        const typedArray = new T(3);
+        typedArray.set(new T([1n, 2n]), 1);
+        expect(Array.from(typedArray)).toEqual([0n, 1n, 2n]);
+    });
+});
+
+test("copies from the source's own offset", () => {
+    const source = new Uint8Array([1, 2, 3, 4]).subarray(2);
+    const target = new Uint8Array(2);
+    target.set(source);
+    expect(Array.from(target)).toEqual([3, 4]);
+});
+
+test("source and target of different types with the same element size", () => {
+    const target = new Float32Array(2);
+    target.set(new Int32Array([1, -2]));
+    expect(Array.from(target)).toEqual([1, -2]);
+});
+
+test("source and target viewing the same buffer", () => {
+    const typedArray = new Uint8Array([1, 2, 3, 4, 5]);
+    typedArray.set(typedArray.subarray(0, 4), 1);
+    expect(Array.from(typedArray)).toEqual([1, 1, 2, 3, 4]);
+
+    const buffer = new ArrayBuffer(8);
+    const bytes = new Uint8Array(buffer);
+    bytes.set([1, 2, 3, 4]);
+    const words = new Uint16Array(buffer);
+    words.set(bytes.subarray(0, 4));
+    expect(Array.from(words)).toEqual([1, 2, 3, 4]);
+});
+
+test("errors", () => {
+    expect(() => {
+        new Uint8Array(2).set([1, 2, 3]);
+    }).toThrow(RangeError);
+
+    expect(() => {
+        new Uint8Array(2).set(new BigInt64Array(1));
+    }).toThrowWithMessage(TypeError, "Copy between arrays of different content types is prohibited");
+});
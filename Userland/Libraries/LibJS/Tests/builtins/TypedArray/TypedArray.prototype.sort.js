@@ -51,3 +51,17 @@ test("basic functionality", () => {
         expect(typedArray[2]).toBe(1n);
     });
 });
+
+test("default sort order of floating point values", () => {
+    [Float32Array, Float64Array].forEach(T => {
+        const typedArray = new T([NaN, 1, -0, 0, -Infinity, NaN, -2, 0, -0, Infinity]);
+        typedArray.sort();
+
+        expect(Array.from(typedArray)).toEqual([-Infinity, -2, -0, -0, 0, 0, 1, Infinity, NaN, NaN]);
+    });
+});
+
+test("default sort order of signed values", () => {
+    expect(Array.from(new Int8Array([5, -128, 127, -1, 0]).sort())).toEqual([-128, -1, 0, 5, 127]);
+    expect(Array.from(new BigInt64Array([5n, -1n, 0n]).sort())).toEqual([-1n, 0n, 5n]);
+});
@@ -0,0 +1,61 @@
+test("object used as a hash map keeps its properties in insertion order", () => {
+    const o = {};
+    for (let i = 0; i < 500; ++i) o["key" + i] = i;
+
+    const keys = Object.keys(o);
+    expect(keys).toHaveLength(500);
+    for (let i = 0; i < 500; ++i) {
+        expect(keys[i]).toBe("key" + i);
+        expect(o["key" + i]).toBe(i);
+    }
+
+    delete o.key0;
+    delete o.key250;
+    o.key0 = "again";
+    expect(Object.keys(o)).toHaveLength(499);
+    expect(Object.keys(o)[498]).toBe("key0");
+    expect(o.key0).toBe("again");
+    expect(o.key1).toBe(1);
+    expect(o.key499).toBe(499);
+    expect(o.hasOwnProperty("key250")).toBeFalse();
+});
+
+test("objects following the same transitions share their shape's layout", () => {
+    const make = i => {
+        const o = {};
+        o.a = i;
+        o.b = i + 1;
+        o.c = i + 2;
+        return o;
+    };
+    const objects = [];
+    for (let i = 0; i < 100; ++i) objects.push(make(i));
+    for (let i = 0; i < 100; ++i) {
+        expect(Object.keys(objects[i])).toEqual(["a", "b", "c"]);
+        expect(objects[i].a).toBe(i);
+        expect(objects[i].b).toBe(i + 1);
+        expect(objects[i].c).toBe(i + 2);
+    }
+
+    // Looking up a property on a shape that was passed through must still work.
+    const first = {};
+    first.a = "first";
+    expect(first.a).toBe("first");
+    expect(Object.keys(first)).toEqual(["a"]);
+});
+
+test("reconfiguring a property doesn't reuse a put transition", () => {
+    const a = {};
+    a.x = 1;
+    a.y = 2;
+    Object.defineProperty(a, "x", { value: 3, enumerable: false });
+
+    const b = {};
+    b.x = 1;
+    b.y = 2;
+    Object.defineProperty(b, "x", { value: 4, enumerable: false });
+    expect(b.x).toBe(4);
+    expect(b.y).toBe(2);
+    expect(Object.keys(b)).toEqual(["y"]);
+    expect(Object.getOwnPropertyNames(b)).toEqual(["x", "y"]);
+});
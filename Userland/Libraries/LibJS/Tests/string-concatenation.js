@@ -0,0 +1,30 @@
+test("repeatedly appending produces the right string", () => {
+    let s = "";
+    for (let i = 0; i < 1000; ++i) s += i % 10;
+    expect(s).toHaveLength(1000);
+    expect(s.substring(0, 12)).toBe("012345678901");
+    expect(s.endsWith("6789")).toBeTrue();
+});
+
+test("prepending and appending can be mixed", () => {
+    let s = "-".repeat(40);
+    s = "a" + s + "b";
+    s = "<" + s + ">";
+    expect(s).toBe("<a" + "-".repeat(40) + "b>");
+    expect(s === `<a${"-".repeat(40)}b>`).toBeTrue();
+});
+
+test("template literals with long parts", () => {
+    let s = "";
+    for (let i = 0; i < 100; ++i) s = `${s}<${i}>`;
+    expect(s.startsWith("<0><1><2>")).toBeTrue();
+    expect(s.endsWith("<98><99>")).toBeTrue();
+});
+
+test("surrogate pairs split across the two halves are joined", () => {
+    const padding = "a".repeat(40);
+    const s = padding + "\ud83d" + ("\ude00" + padding);
+    expect(s).toHaveLength(82);
+    expect(s.codePointAt(40)).toBe(0x1f600);
+    expect(s).toBe(padding + "😀" + padding);
+});
@@ -61,11 +61,41 @@ Value Document::get_or_load_value(u32 index)
     if (value)
         return value;
 
+    for (size_t i = 0; i < m_cached_streams.size(); i++) {
+        if (m_cached_streams[i].index != index)
+            continue;
+        auto cached_stream = m_cached_streams.take(i);
+        m_cached_streams.append(cached_stream);
+        return cached_stream.stream;
+    }
+
     auto object = m_parser->parse_object_with_index(index);
+    if (object.is_object() && object.as_object()->is_stream()) {
+        cache_stream(index, object_cast<StreamObject>(object.as_object()));
+        return object;
+    }
+
     m_values.set(index, object);
     return object;
 }
 
+void Document::cache_stream(u32 index, NonnullRefPtr<StreamObject> const& stream)
+{
+    m_cached_streams.append({ index, stream });
+
+    // Streams only take up memory once they have been decoded, which happens after they were cached, so tally
+    // them up again every time. The most recently used streams are at the end.
+    size_t cached_bytes = 0;
+    size_t streams_to_keep = 0;
+    for (size_t i = m_cached_streams.size(); i-- > 0;) {
+        cached_bytes += m_cached_streams[i].stream->decoded_size();
+        if (streams_to_keep > 0 && (cached_bytes > max_cached_stream_bytes || streams_to_keep == max_cached_streams))
+            break;
+        streams_to_keep++;
+    }
+    m_cached_streams.remove(0, m_cached_streams.size() - streams_to_keep);
+}
+
 u32 Document::get_first_page_index() const
 {
     // FIXME: A PDF can have a different default first page, which
@@ -125,6 +125,8 @@ private:
     bool build_page_tree();
     bool add_page_tree_node_to_page_tree(NonnullRefPtr<DictObject> const& page_tree);
 
+    void cache_stream(u32 index, NonnullRefPtr<StreamObject> const&);
+
     void build_outline();
     NonnullRefPtr<OutlineItem> build_outline_item(NonnullRefPtr<DictObject> const& outline_item_dict);
     NonnullRefPtrVector<OutlineItem> build_outline_item_chain(Value const& first_ref, Value const& last_ref);
@@ -134,6 +136,17 @@ private:
     Vector<u32> m_page_object_indices;
     HashMap<u32, Page> m_pages;
     HashMap<u32, Value> m_values;
+
+    // Decoded streams can be large, so unlike other values only the most recently used ones are kept
+    // around. Anything that is still holding on to a dropped stream can keep using it, and the next
+    // lookup of its index parses (and eventually decodes) it again.
+    static constexpr size_t max_cached_stream_bytes = 32 * MiB;
+    static constexpr size_t max_cached_streams = 256;
+    struct CachedStream {
+        u32 index;
+        NonnullRefPtr<StreamObject> stream;
+    };
+    Vector<CachedStream> m_cached_streams;
     RefPtr<OutlineDict> m_outline;
 };
 
@@ -6,6 +6,7 @@
 
 #include <AK/Hex.h>
 #include <LibPDF/Document.h>
+#include <LibPDF/Filter.h>
 #include <LibPDF/Object.h>
 
 namespace PDF {
@@ -94,6 +95,19 @@ String DictObject::to_string(int indent) const
     return builder.to_string();
 }
 
+ReadonlyBytes EncodedStreamObject::bytes() const
+{
+    if (!m_buffer.has_value()) {
+        auto maybe_bytes = Filter::decode(m_encoded_bytes, m_filter);
+        if (!maybe_bytes.has_value()) {
+            dbgln("Failed to decode {} stream", m_filter);
+            maybe_bytes = ByteBuffer {};
+        }
+        m_buffer = maybe_bytes.release_value();
+    }
+    return m_buffer->bytes();
+}
+
 String StreamObject::to_string(int indent) const
 {
     StringBuilder builder;
@@ -165,6 +165,8 @@ public:
 
     [[nodiscard]] ALWAYS_INLINE NonnullRefPtr<DictObject> dict() const { return m_dict; }
     [[nodiscard]] virtual ReadonlyBytes bytes() const = 0;
+    // How much memory the contents take up on top of the bytes of the file itself.
+    [[nodiscard]] virtual size_t decoded_size() const { return 0; }
 
     ALWAYS_INLINE bool is_stream() const override { return true; }
     ALWAYS_INLINE const char* type_name() const override { return "stream"; }
@@ -192,18 +194,25 @@ private:
 
 class EncodedStreamObject final : public StreamObject {
 public:
-    EncodedStreamObject(NonnullRefPtr<DictObject> const& dict, ByteBuffer&& buffer)
+    EncodedStreamObject(NonnullRefPtr<DictObject> const& dict, ReadonlyBytes const& encoded_bytes, FlyString const& filter)
         : StreamObject(dict)
-        , m_buffer(buffer)
+        , m_encoded_bytes(encoded_bytes)
+        , m_filter(filter)
     {
     }
 
     virtual ~EncodedStreamObject() override = default;
 
-    [[nodiscard]] ALWAYS_INLINE virtual ReadonlyBytes bytes() const override { return m_buffer.bytes(); }
+    // The filter is only run the first time the contents are asked for, as many streams (fonts, images on
+    // pages that are never shown, ...) are parsed without ever being read.
+    [[nodiscard]] virtual ReadonlyBytes bytes() const override;
+
+    [[nodiscard]] virtual size_t decoded_size() const override { return m_buffer.has_value() ? m_buffer->size() : 0; }
 
 private:
-    ByteBuffer m_buffer;
+    ReadonlyBytes m_encoded_bytes;
+    FlyString m_filter;
+    mutable Optional<ByteBuffer> m_buffer;
 };
 
 class IndirectValue final : public Object {
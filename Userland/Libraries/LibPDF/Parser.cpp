@@ -10,7 +10,6 @@
 #include <AK/TypeCasts.h>
 #include <LibPDF/CommonNames.h>
 #include <LibPDF/Document.h>
-#include <LibPDF/Filter.h>
 #include <LibPDF/Parser.h>
 #include <LibTextCodec/Decoder.h>
 #include <ctype.h>
@@ -1058,10 +1057,7 @@ RefPtr<StreamObject> Parser::parse_stream(NonnullRefPtr<DictObject> dict)
 
     if (dict->contains(CommonNames::Filter)) {
         auto filter_type = dict->get_name(m_document, CommonNames::Filter)->name();
-        auto maybe_bytes = Filter::decode(bytes, filter_type);
-        if (!maybe_bytes.has_value())
-            return {};
-        return make_object<EncodedStreamObject>(dict, move(maybe_bytes.value()));
+        return make_object<EncodedStreamObject>(dict, bytes, filter_type);
     }
 
     return make_object<PlainTextStreamObject>(dict, bytes);
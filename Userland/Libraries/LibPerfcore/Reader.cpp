@@ -0,0 +1,448 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/CharacterTypes.h>
+#include <AK/StringBuilder.h>
+#include <Kernel/API/Perfcore.h>
+#include <LibPerfcore/Reader.h>
+#include <serenity.h>
+#include <string.h>
+
+namespace Perfcore {
+
+bool Reader::consume(char ch)
+{
+    if (peek() != ch)
+        return false;
+    ++m_offset;
+    return true;
+}
+
+bool Reader::consume(StringView string)
+{
+    if (m_bytes.size() - m_offset < string.length())
+        return false;
+    if (StringView { m_bytes.offset_pointer(m_offset), string.length() } != string)
+        return false;
+    m_offset += string.length();
+    return true;
+}
+
+void Reader::skip_whitespace()
+{
+    while (!at_end() && is_ascii_space(peek()))
+        ++m_offset;
+}
+
+// Expects the opening brace to be consumed already, and calls back with every key, positioned at its value.
+template<typename Callback>
+bool Reader::parse_members(Callback callback)
+{
+    skip_whitespace();
+    if (consume('}'))
+        return true;
+    for (;;) {
+        skip_whitespace();
+        auto key = parse_string(m_key_storage);
+        if (!key.has_value())
+            return false;
+        skip_whitespace();
+        if (!consume(':'))
+            return false;
+        skip_whitespace();
+        if (!callback(key.value()))
+            return false;
+        skip_whitespace();
+        if (consume(','))
+            continue;
+        return consume('}');
+    }
+}
+
+// Expects the opening bracket to be consumed already, and calls back positioned at every element.
+template<typename Callback>
+bool Reader::parse_elements(Callback callback)
+{
+    skip_whitespace();
+    if (consume(']'))
+        return true;
+    for (;;) {
+        skip_whitespace();
+        if (!callback())
+            return false;
+        skip_whitespace();
+        if (consume(','))
+            continue;
+        return consume(']');
+    }
+}
+
+// Strings without escapes are returned as they are in the file, the others are unescaped into the storage.
+Optional<StringView> Reader::parse_string(String& unescaped_storage)
+{
+    if (!consume('"'))
+        return {};
+    size_t start = m_offset;
+    while (!at_end() && peek() != '"' && peek() != '\\')
+        ++m_offset;
+    if (consume('"'))
+        return StringView { m_bytes.offset_pointer(start), m_offset - start - 1 };
+
+    StringBuilder builder;
+    builder.append(StringView { m_bytes.offset_pointer(start), m_offset - start });
+    while (!at_end()) {
+        char ch = m_bytes[m_offset++];
+        if (ch == '"') {
+            unescaped_storage = builder.to_string();
+            return unescaped_storage.view();
+        }
+        if (ch != '\\') {
+            builder.append(ch);
+            continue;
+        }
+        if (at_end())
+            return {};
+        char escaped = m_bytes[m_offset++];
+        switch (escaped) {
+        case 'b':
+            builder.append('\b');
+            break;
+        case 'f':
+            builder.append('\f');
+            break;
+        case 'n':
+            builder.append('\n');
+            break;
+        case 'r':
+            builder.append('\r');
+            break;
+        case 't':
+            builder.append('\t');
+            break;
+        case 'u': {
+            if (m_bytes.size() - m_offset < 4)
+                return {};
+            u32 code_point = 0;
+            for (size_t i = 0; i < 4; ++i) {
+                char digit = m_bytes[m_offset++];
+                if (!is_ascii_hex_digit(digit))
+                    return {};
+                code_point = (code_point << 4) | parse_ascii_hex_digit(digit);
+            }
+            builder.append_code_point(code_point);
+            break;
+        }
+        default:
+            builder.append(escaped);
+            break;
+        }
+    }
+    return {};
+}
+
+template<typename T>
+bool Reader::parse_number(T& value)
+{
+    bool is_negative = consume('-');
+    if (!is_ascii_digit(peek()))
+        return false;
+    u64 number = 0;
+    while (is_ascii_digit(peek()))
+        number = number * 10 + parse_ascii_digit(m_bytes[m_offset++]);
+    // The kernel only writes integers, but let's not choke on a fraction or an exponent.
+    while (peek() == '.' || peek() == 'e' || peek() == 'E' || peek() == '+' || peek() == '-' || is_ascii_digit(peek()))
+        ++m_offset;
+    value = static_cast<T>(is_negative ? -number : number);
+    return true;
+}
+
+bool Reader::skip_value()
+{
+    switch (peek()) {
+    case '{':
+        ++m_offset;
+        return parse_members([this](StringView) { return skip_value(); });
+    case '[':
+        ++m_offset;
+        return parse_elements([this] { return skip_value(); });
+    case '"':
+        return parse_string(m_value_storage).has_value();
+    case 't':
+        return consume("true"sv);
+    case 'f':
+        return consume("false"sv);
+    case 'n':
+        return consume("null"sv);
+    default: {
+        i64 ignored;
+        return parse_number(ignored);
+    }
+    }
+}
+
+bool Reader::parse_json_event(Event& event)
+{
+    if (!consume('{'))
+        return false;
+    return parse_members([&](StringView key) {
+        if (key == "type"sv) {
+            auto type = parse_string(m_type_storage);
+            if (!type.has_value())
+                return false;
+            event.type = type.value();
+            return true;
+        }
+        if (key == "counter"sv) {
+            auto counter = parse_string(m_counter_storage);
+            if (!counter.has_value())
+                return false;
+            event.counter = counter.value();
+            return true;
+        }
+        if (key == "name"sv || key == "executable"sv) {
+            auto string = parse_string(m_value_storage);
+            if (!string.has_value())
+                return false;
+            (key == "name"sv ? event.name : event.executable) = string.value();
+            return true;
+        }
+        if (key == "stack"sv) {
+            if (!consume('['))
+                return false;
+            return parse_elements([&] {
+                FlatPtr address;
+                if (!parse_number(address))
+                    return false;
+                event.stack.append(address);
+                return true;
+            });
+        }
+        if (key == "timestamp"sv)
+            return parse_number(event.timestamp);
+        if (key == "lost_samples"sv)
+            return parse_number(event.lost_samples);
+        if (key == "pid"sv)
+            return parse_number(event.pid);
+        if (key == "tid"sv)
+            return parse_number(event.tid);
+        if (key == "ptr"sv)
+            return parse_number(event.ptr);
+        if (key == "size"sv)
+            return parse_number(event.size);
+        if (key == "parent_pid"sv)
+            return parse_number(event.parent_pid);
+        if (key == "parent_tid"sv)
+            return parse_number(event.parent_tid);
+        if (key == "next_pid"sv)
+            return parse_number(event.next_pid);
+        if (key == "next_tid"sv)
+            return parse_number(event.next_tid);
+        return skip_value();
+    });
+}
+
+bool Reader::is_binary(ReadonlyBytes bytes)
+{
+    return bytes.size() > sizeof(perfcore_magic) && !memcmp(bytes.data(), perfcore_magic, sizeof(perfcore_magic));
+}
+
+Result<void, String> Reader::for_each_event(Function<void(Event const&)> callback)
+{
+    if (is_binary(m_bytes))
+        return for_each_binary_event(callback);
+    return for_each_json_event(callback);
+}
+
+template<typename T>
+bool Reader::read_varint(T& value)
+{
+    u64 result = 0;
+    for (size_t shift = 0; shift < 64; shift += 7) {
+        if (at_end())
+            return false;
+        u8 byte = m_bytes[m_offset++];
+        result |= (u64)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            value = static_cast<T>(result);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Reader::read_string_id(String& string)
+{
+    size_t id;
+    if (!read_varint(id) || id >= m_strings.size())
+        return false;
+    string = m_strings[id];
+    return true;
+}
+
+static StringView event_type_name(u32 type)
+{
+    switch (type) {
+    case PERF_EVENT_SAMPLE:
+        return "sample"sv;
+    case PERF_EVENT_MALLOC:
+        return "malloc"sv;
+    case PERF_EVENT_FREE:
+        return "free"sv;
+    case PERF_EVENT_MMAP:
+        return "mmap"sv;
+    case PERF_EVENT_MUNMAP:
+        return "munmap"sv;
+    case PERF_EVENT_PROCESS_CREATE:
+        return "process_create"sv;
+    case PERF_EVENT_PROCESS_EXEC:
+        return "process_exec"sv;
+    case PERF_EVENT_PROCESS_EXIT:
+        return "process_exit"sv;
+    case PERF_EVENT_THREAD_CREATE:
+        return "thread_create"sv;
+    case PERF_EVENT_THREAD_EXIT:
+        return "thread_exit"sv;
+    case PERF_EVENT_CONTEXT_SWITCH:
+        return "context_switch"sv;
+    case PERF_EVENT_KMALLOC:
+        return "kmalloc"sv;
+    case PERF_EVENT_KFREE:
+        return "kfree"sv;
+    case PERF_EVENT_PAGE_FAULT:
+        return "page_fault"sv;
+    case PERF_EVENT_PMC_SAMPLE:
+        return "pmc_sample"sv;
+    default:
+        return {};
+    }
+}
+
+bool Reader::read_binary_event(Event& event)
+{
+    u32 type;
+    size_t stack_id;
+    u64 zigzag_timestamp_delta;
+    if (!read_varint(type) || !read_varint(event.pid) || !read_varint(event.tid) || !read_varint(zigzag_timestamp_delta)
+        || !read_varint(event.lost_samples) || !read_varint(stack_id))
+        return false;
+
+    event.type = event_type_name(type);
+    if (event.type.is_null())
+        return false;
+    m_last_timestamp += (zigzag_timestamp_delta >> 1) ^ -(zigzag_timestamp_delta & 1);
+    event.timestamp = m_last_timestamp;
+    if (stack_id >= m_stacks.size())
+        return false;
+    event.stack.append(m_stacks[stack_id].data(), m_stacks[stack_id].size());
+
+    switch (type) {
+    case PERF_EVENT_MALLOC:
+    case PERF_EVENT_MUNMAP:
+    case PERF_EVENT_KMALLOC:
+    case PERF_EVENT_KFREE:
+        return read_varint(event.ptr) && read_varint(event.size);
+    case PERF_EVENT_FREE:
+        return read_varint(event.ptr);
+    case PERF_EVENT_MMAP:
+        return read_varint(event.ptr) && read_varint(event.size) && read_string_id(event.name);
+    case PERF_EVENT_PROCESS_CREATE:
+        return read_varint(event.parent_pid) && read_string_id(event.executable);
+    case PERF_EVENT_PROCESS_EXEC:
+        return read_string_id(event.executable);
+    case PERF_EVENT_THREAD_CREATE:
+        return read_varint(event.parent_tid);
+    case PERF_EVENT_CONTEXT_SWITCH:
+        return read_varint(event.next_pid) && read_varint(event.next_tid);
+    case PERF_EVENT_PMC_SAMPLE: {
+        size_t counter;
+        if (!read_varint(counter) || counter >= array_size(perfcore_pmc_counter_names))
+            return false;
+        event.counter = perfcore_pmc_counter_names[counter];
+        return true;
+    }
+    default:
+        return true;
+    }
+}
+
+Result<void, String> Reader::for_each_binary_event(Function<void(Event const&)>& callback)
+{
+    m_offset = sizeof(perfcore_magic);
+    if (m_bytes[m_offset++] != perfcore_version)
+        return String::formatted("Unsupported perfcore version {}", m_bytes[m_offset - 1]);
+
+    Event event;
+    while (!at_end()) {
+        auto record_type = (PerfcoreRecordType)m_bytes[m_offset++];
+        bool is_valid = false;
+        switch (record_type) {
+        case PerfcoreRecordType::Stack: {
+            size_t frame_count;
+            if (!read_varint(frame_count) || frame_count > m_bytes.size() - m_offset)
+                break;
+            Vector<FlatPtr> stack;
+            stack.ensure_capacity(frame_count);
+            is_valid = true;
+            for (size_t i = 0; i < frame_count && is_valid; ++i) {
+                FlatPtr address = 0;
+                is_valid = read_varint(address);
+                stack.unchecked_append(address);
+            }
+            m_stacks.append(move(stack));
+            break;
+        }
+        case PerfcoreRecordType::String: {
+            size_t length;
+            if (!read_varint(length) || length > m_bytes.size() - m_offset)
+                break;
+            m_strings.append(StringView { m_bytes.offset_pointer(m_offset), length });
+            m_offset += length;
+            is_valid = true;
+            break;
+        }
+        case PerfcoreRecordType::Event:
+            event = {};
+            is_valid = read_binary_event(event);
+            if (is_valid)
+                callback(event);
+            break;
+        }
+        if (!is_valid)
+            return String::formatted("Invalid perfcore format (at offset {})", m_offset);
+    }
+    return {};
+}
+
+Result<void, String> Reader::for_each_json_event(Function<void(Event const&)>& callback)
+{
+    skip_whitespace();
+    if (!consume('{'))
+        return String { "Invalid perfcore format (not a JSON object)" };
+
+    bool has_events = false;
+    bool is_valid = parse_members([&](StringView key) {
+        if (key != "events"sv)
+            return skip_value();
+        if (!consume('['))
+            return false;
+        has_events = true;
+        Event event;
+        return parse_elements([&] {
+            event = {};
+            if (!parse_json_event(event))
+                return false;
+            callback(event);
+            return true;
+        });
+    });
+    if (!is_valid)
+        return String::formatted("Invalid perfcore format (at offset {})", m_offset);
+    if (!has_events)
+        return String { "Malformed profile (events is not an array)" };
+    return {};
+}
+
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/Optional.h>
+#include <AK/Result.h>
+#include <AK/Span.h>
+#include <AK/String.h>
+#include <AK/StringView.h>
+#include <AK/Vector.h>
+
+namespace Perfcore {
+
+struct Event {
+    StringView type;
+    u64 timestamp { 0 };
+    u32 lost_samples { 0 };
+    int pid { 0 };
+    int tid { 0 };
+    FlatPtr ptr { 0 };
+    size_t size { 0 };
+    String name;
+    String executable;
+    int parent_pid { 0 };
+    int parent_tid { 0 };
+    int next_pid { 0 };
+    int next_tid { 0 };
+    StringView counter;
+    // Innermost frame first.
+    Vector<FlatPtr, 64> stack;
+};
+
+// Reads the events of a perfcore file one at a time, straight out of its bytes, so a long capture
+// can be loaded without first building a JSON tree or similar of the whole file. Both the binary
+// format the kernel writes (see Kernel/API/Perfcore.h) and the JSON format it used to write are understood.
+class Reader {
+public:
+    explicit Reader(ReadonlyBytes bytes)
+        : m_bytes(bytes)
+    {
+    }
+
+    static bool is_binary(ReadonlyBytes);
+
+    // The event passed to the callback is only valid until it returns.
+    Result<void, String> for_each_event(Function<void(Event const&)>);
+
+private:
+    Result<void, String> for_each_binary_event(Function<void(Event const&)>&);
+    Result<void, String> for_each_json_event(Function<void(Event const&)>&);
+
+    bool at_end() const { return m_offset >= m_bytes.size(); }
+    char peek() const { return at_end() ? 0 : m_bytes[m_offset]; }
+    bool consume(char);
+    bool consume(StringView);
+
+    template<typename T>
+    bool read_varint(T&);
+    bool read_string_id(String&);
+    bool read_binary_event(Event&);
+
+    void skip_whitespace();
+    template<typename Callback>
+    bool parse_members(Callback);
+    template<typename Callback>
+    bool parse_elements(Callback);
+    Optional<StringView> parse_string(String& unescaped_storage);
+    template<typename T>
+    bool parse_number(T&);
+    bool skip_value();
+    bool parse_json_event(Event&);
+
+    ReadonlyBytes m_bytes;
+    size_t m_offset { 0 };
+
+    Vector<Vector<FlatPtr>> m_stacks;
+    Vector<String> m_strings;
+    u64 m_last_timestamp { 0 };
+
+    String m_key_storage;
+    String m_type_storage;
+    String m_counter_storage;
+    String m_value_storage;
+};
+
+}
@@ -48,6 +48,8 @@ void Request::stream_into(OutputStream& stream)
         if (m_internal_stream_data->read_stream.eof() && m_internal_stream_data->request_done) {
             m_internal_stream_data->read_notifier->close();
             user_on_finish(m_internal_stream_data->success, m_internal_stream_data->total_size);
+            // Let go of whatever the callbacks captured (which may well include this request) now that we're done.
+            m_internal_stream_data->read_notifier->on_ready_to_read = nullptr;
         } else {
             m_internal_stream_data->read_stream.handle_any_error();
         }
@@ -89,6 +91,43 @@ void Request::set_should_buffer_all_input(bool value)
     stream_into(m_internal_buffered_data->payload_stream);
 }
 
+void Request::set_unbuffered_request_callbacks(HeadersReceived on_headers_received, DataReceived on_data_received, RequestFinished on_finish)
+{
+    VERIFY(!m_internal_stream_data);
+    VERIFY(!m_internal_buffered_data);
+    VERIFY(on_data_received);
+
+    m_internal_unbuffered_data = make<InternalUnbufferedData>(move(on_data_received), [this](ReadonlyBytes data) {
+        auto& unbuffered_data = *m_internal_unbuffered_data;
+        if (!unbuffered_data.received_headers) {
+            unbuffered_data.data_received_before_headers.append(data.data(), data.size());
+            return;
+        }
+        unbuffered_data.on_data_received(data);
+    });
+
+    this->on_headers_received = [this, on_headers_received = move(on_headers_received)](auto& response_headers, auto response_code) {
+        auto& unbuffered_data = *m_internal_unbuffered_data;
+        unbuffered_data.received_headers = true;
+        if (on_headers_received)
+            on_headers_received(response_headers, response_code);
+        if (!unbuffered_data.data_received_before_headers.is_empty()) {
+            auto data = move(unbuffered_data.data_received_before_headers);
+            unbuffered_data.on_data_received(data);
+        }
+    };
+
+    this->on_finish = [this, on_finish = move(on_finish)](bool success, u32 total_size) {
+        // Whoever is on the other end can count on the headers coming first, even if there weren't any.
+        if (success && !m_internal_unbuffered_data->received_headers)
+            this->on_headers_received({}, {});
+        if (on_finish)
+            on_finish(success, total_size);
+    };
+
+    stream_into(m_internal_unbuffered_data->stream);
+}
+
 void Request::did_finish(Badge<RequestClient>, bool success, u32 total_size)
 {
     if (!on_finish)
@@ -43,6 +43,14 @@ public:
     /// Note: Will override `on_finish', and `on_headers_received', and expects `on_buffered_request_finish' to be set!
     void set_should_buffer_all_input(bool);
 
+    using HeadersReceived = Function<void(const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> response_code)>;
+    using DataReceived = Function<void(ReadonlyBytes)>;
+    using RequestFinished = Function<void(bool success, u32 total_size)>;
+
+    /// Hands the payload over piece by piece as it is read from the pipe, instead of keeping it all until the request is done.
+    /// Note: Will override `on_finish', and `on_headers_received'.
+    void set_unbuffered_request_callbacks(HeadersReceived, DataReceived, RequestFinished);
+
     /// Note: Must be set before `set_should_buffer_all_input(true)`.
     Function<void(bool success, u32 total_size, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> response_code, ReadonlyBytes payload)> on_buffered_request_finish;
     Function<void(bool success, u32 total_size)> on_finish;
@@ -91,8 +99,49 @@ private:
         bool request_done { false };
     };
 
+    // Passes everything written to it on to a callback, so that the unbuffered callbacks can sit on top of stream_into().
+    class CallbackOutputStream final : public OutputStream {
+    public:
+        explicit CallbackOutputStream(DataReceived callback)
+            : m_callback(move(callback))
+        {
+        }
+
+        virtual size_t write(ReadonlyBytes bytes) override
+        {
+            if (!bytes.is_empty())
+                m_callback(bytes);
+            return bytes.size();
+        }
+
+        virtual bool write_or_error(ReadonlyBytes bytes) override
+        {
+            write(bytes);
+            return true;
+        }
+
+    private:
+        DataReceived m_callback;
+    };
+
+    struct InternalUnbufferedData {
+        InternalUnbufferedData(DataReceived on_data_received, DataReceived write_callback)
+            : on_data_received(move(on_data_received))
+            , stream(move(write_callback))
+        {
+        }
+
+        DataReceived on_data_received;
+        CallbackOutputStream stream;
+        // The payload comes through the pipe and the headers over IPC, so the start of the payload may well get here
+        // first. It's held back until the headers are in.
+        bool received_headers { false };
+        ByteBuffer data_received_before_headers;
+    };
+
     OwnPtr<InternalBufferedData> m_internal_buffered_data;
     OwnPtr<InternalStreamData> m_internal_stream_data;
+    OwnPtr<InternalUnbufferedData> m_internal_unbuffered_data;
 };
 
 }
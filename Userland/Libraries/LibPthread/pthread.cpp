@@ -19,6 +19,7 @@
 #include <signal.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/internals.h>
 #include <sys/mman.h>
 #include <syscall.h>
 #include <time.h>
@@ -90,6 +91,7 @@ static int create_thread(pthread_t* thread, void* (*entry)(void*), void* argumen
 [[noreturn]] static void exit_thread(void* code, void* stack_location, size_t stack_size)
 {
     __pthread_key_destroy_for_current_thread();
+    __malloc_release_caches_for_current_thread();
     syscall(SC_exit_thread, code, stack_location, stack_size);
     VERIFY_NOT_REACHED();
 }
@@ -575,8 +577,6 @@ int pthread_equal(pthread_t t1, pthread_t t2)
     return t1 == t2;
 }
 
-// FIXME: Use the fancy futex mechanism above to write an rw lock.
-//        For the time being, let's just use a less-than-good lock to get things working.
 int pthread_rwlock_destroy(pthread_rwlock_t* rl)
 {
     if (!rl)
@@ -584,18 +584,29 @@ int pthread_rwlock_destroy(pthread_rwlock_t* rl)
     return 0;
 }
 
-// In a very non-straightforward way, this value is composed of two 32-bit integers
-// the top 32 bits are reserved for the ID of write-locking thread (if any)
-// and the bottom 32 bits are:
-//     top 2 bits (30,31): reader wake mask, writer wake mask
-//     middle 16 bits: information
-//        bit 16: someone is waiting to write
-//        bit 17: locked for write
-//     bottom 16 bits (0..15): reader count
-constexpr static u32 reader_wake_mask = 1 << 30;
-constexpr static u32 writer_wake_mask = 1 << 31;
-constexpr static u32 writer_locked_mask = 1 << 17;
-constexpr static u32 writer_intent_mask = 1 << 16;
+// The lock is made up of two 32-bit integers: the bottom one is the futex word, and the top one holds the ID of
+// the thread that locked it for writing (if any).
+// The futex word has these bits:
+//     bit 31: someone is (about to be) sleeping on the futex, so whoever unlocks it has to wake them
+//     bit 30: locked for writing
+//     bit 29: a writer is waiting, which keeps new readers out so that writers don't starve
+//     bits 0..28: reader count
+// Everyone waiting is woken up together and then races for the lock again, which keeps this simple.
+constexpr static u32 rwlock_has_waiters = 1u << 31;
+constexpr static u32 rwlock_write_locked = 1u << 30;
+constexpr static u32 rwlock_writer_waiting = 1u << 29;
+constexpr static u32 rwlock_reader_count_mask = rwlock_writer_waiting - 1;
+
+static u32* rwlock_futex_word(pthread_rwlock_t* lockp)
+{
+    return reinterpret_cast<u32*>(lockp);
+}
+
+static i32* rwlock_writer_id(pthread_rwlock_t* lockp)
+{
+    return reinterpret_cast<i32*>(lockp) + 1;
+}
+
 int pthread_rwlock_init(pthread_rwlock_t* __restrict lockp, const pthread_rwlockattr_t* __restrict attr)
 {
     // Just ignore the attributes. use defaults for now.
@@ -606,100 +617,60 @@ int pthread_rwlock_init(pthread_rwlock_t* __restrict lockp, const pthread_rwlock
     return 0;
 }
 
-// Note that this function does not care about the top 32 bits at all.
-static int rwlock_rdlock_maybe_timed(u32* lockp, const struct timespec* timeout = nullptr, bool only_once = false, int value_if_timeout = -1, int value_if_okay = -2)
-{
-    auto current = AK::atomic_load(lockp);
-    for (; !only_once;) {
-        // First, see if this is locked for writing
-        // if it's not, try to add to the counter.
-        // If someone is waiting to write, and there is one or no other readers, let them have the lock.
-        if (!(current & writer_locked_mask)) {
-            auto count = (u16)current;
-            if (!(current & writer_intent_mask) || count > 1) {
-                ++count;
-                auto desired = (current << 16) | count;
-                auto did_exchange = AK::atomic_compare_exchange_strong(lockp, current, desired, AK::MemoryOrder::memory_order_acquire);
-                if (!did_exchange)
-                    continue; // tough luck, try again.
-                return value_if_okay;
-            }
-        }
-
-        // If no one else is waiting for the read wake bit, set it.
-        if (!(current & reader_wake_mask)) {
-            auto desired = current | reader_wake_mask;
-            auto did_exchange = AK::atomic_compare_exchange_strong(lockp, current, desired, AK::MemoryOrder::memory_order_acquire);
-            if (!did_exchange)
-                continue; // Something interesting happened!
-
-            current = desired;
-        }
+// Marks the lock as having waiters and sleeps until it changes, unless it already changed from `current`.
+static int rwlock_wait(u32* word, u32 current, u32 extra_bits, const struct timespec* abstime)
+{
+    u32 desired = current | rwlock_has_waiters | extra_bits;
+    if (desired != current && !AK::atomic_compare_exchange_strong(word, current, desired, AK::MemoryOrder::memory_order_relaxed))
+        return 0;
+    if (futex_wait(word, desired, abstime, CLOCK_REALTIME) < 0 && errno == ETIMEDOUT)
+        return ETIMEDOUT;
+    return 0;
+}
 
-        // Seems like someone is writing (or is interested in writing and we let them have the lock)
-        // wait until they're done.
-        auto rc = futex(lockp, FUTEX_WAIT_BITSET, current, timeout, nullptr, reader_wake_mask);
-        if (rc < 0 && errno == ETIMEDOUT && timeout) {
-            return value_if_timeout;
-        }
-        if (rc < 0 && errno != EAGAIN) {
-            // Something broke. let's just bail out.
-            return errno;
+static int rwlock_rdlock(pthread_rwlock_t* lockp, const struct timespec* abstime, bool only_once)
+{
+    auto* word = rwlock_futex_word(lockp);
+    for (;;) {
+        auto current = AK::atomic_load(word, AK::MemoryOrder::memory_order_relaxed);
+        if (!(current & (rwlock_write_locked | rwlock_writer_waiting))) {
+            VERIFY((current & rwlock_reader_count_mask) != rwlock_reader_count_mask);
+            if (AK::atomic_compare_exchange_strong(word, current, current + 1, AK::MemoryOrder::memory_order_acquire))
+                return 0;
+            continue;
         }
-        errno = 0;
-        // Reload the 'current' value
-        current = AK::atomic_load(lockp);
+        if (only_once)
+            return EBUSY;
+        if (auto rc = rwlock_wait(word, current, 0, abstime); rc != 0)
+            return rc;
     }
-    return value_if_timeout;
 }
 
-static int rwlock_wrlock_maybe_timed(pthread_rwlock_t* lockval_p, const struct timespec* timeout = nullptr, bool only_once = false, int value_if_timeout = -1, int value_if_okay = -2)
+static int rwlock_wrlock(pthread_rwlock_t* lockp, const struct timespec* abstime, bool only_once)
 {
-    u32* lockp = reinterpret_cast<u32*>(lockval_p);
-    auto current = AK::atomic_load(lockp);
-    for (; !only_once;) {
-        // First, see if this is locked for writing, and if there are any readers.
-        // if not, lock it.
-        // If someone is waiting to write, let them have the lock.
-        if (!(current & writer_locked_mask) && ((u16)current) == 0) {
-            if (!(current & writer_intent_mask)) {
-                auto desired = current | writer_locked_mask | writer_intent_mask;
-                auto did_exchange = AK::atomic_compare_exchange_strong(lockp, current, desired, AK::MemoryOrder::memory_order_acquire);
-                if (!did_exchange)
-                    continue;
-
+    auto* word = rwlock_futex_word(lockp);
+    for (;;) {
+        auto current = AK::atomic_load(word, AK::MemoryOrder::memory_order_relaxed);
+        if (!(current & (rwlock_write_locked | rwlock_reader_count_mask))) {
+            // Other writers that are still waiting will set the writer-waiting bit again once they wake up.
+            auto desired = (current & rwlock_has_waiters) | rwlock_write_locked;
+            if (AK::atomic_compare_exchange_strong(word, current, desired, AK::MemoryOrder::memory_order_acquire)) {
                 // Now that we've locked the value, it's safe to set our thread ID.
-                AK::atomic_store(reinterpret_cast<i32*>(lockval_p) + 1, pthread_self());
-                return value_if_okay;
+                AK::atomic_store(rwlock_writer_id(lockp), pthread_self(), AK::MemoryOrder::memory_order_relaxed);
+                return 0;
             }
+            continue;
         }
-
-        // That didn't work, if no one else is waiting for the write bit, set it.
-        if (!(current & writer_wake_mask)) {
-            auto desired = current | writer_wake_mask | writer_intent_mask;
-            auto did_exchange = AK::atomic_compare_exchange_strong(lockp, current, desired, AK::MemoryOrder::memory_order_acquire);
-            if (!did_exchange)
-                continue; // Something interesting happened!
-
-            current = desired;
+        if (only_once)
+            return EBUSY;
+        if (auto rc = rwlock_wait(word, current, rwlock_writer_waiting, abstime); rc != 0) {
+            // The writer-waiting bit may have been ours, so don't leave the readers shut out for nothing.
+            auto previous = AK::atomic_fetch_and(word, ~rwlock_writer_waiting, AK::MemoryOrder::memory_order_relaxed);
+            if (previous & rwlock_has_waiters)
+                futex_wake(word, INT32_MAX);
+            return rc;
         }
-
-        // Seems like someone is writing (or is interested in writing and we let them have the lock)
-        // wait until they're done.
-        auto rc = futex(lockp, FUTEX_WAIT_BITSET, current, timeout, nullptr, writer_wake_mask);
-        if (rc < 0 && errno == ETIMEDOUT && timeout) {
-            return value_if_timeout;
-        }
-        if (rc < 0 && errno != EAGAIN) {
-            // Something broke. let's just bail out.
-            return errno;
-        }
-        errno = 0;
-        // Reload the 'current' value
-        current = AK::atomic_load(lockp);
     }
-
-    return value_if_timeout;
 }
 
 int pthread_rwlock_rdlock(pthread_rwlock_t* lockp)
@@ -707,85 +678,71 @@ int pthread_rwlock_rdlock(pthread_rwlock_t* lockp)
     if (!lockp)
         return EINVAL;
 
-    return rwlock_rdlock_maybe_timed(reinterpret_cast<u32*>(lockp), nullptr, false, 0, 0);
+    return rwlock_rdlock(lockp, nullptr, false);
 }
 int pthread_rwlock_timedrdlock(pthread_rwlock_t* __restrict lockp, const struct timespec* __restrict timespec)
 {
     if (!lockp)
         return EINVAL;
 
-    auto rc = rwlock_rdlock_maybe_timed(reinterpret_cast<u32*>(lockp), timespec);
-    if (rc == -1) // "ok"
-        return 0;
-    if (rc == -2) // "timed out"
-        return 1;
-    return rc;
+    return rwlock_rdlock(lockp, timespec, false);
 }
 int pthread_rwlock_timedwrlock(pthread_rwlock_t* __restrict lockp, const struct timespec* __restrict timespec)
 {
     if (!lockp)
         return EINVAL;
 
-    auto rc = rwlock_wrlock_maybe_timed(lockp, timespec);
-    if (rc == -1) // "ok"
-        return 0;
-    if (rc == -2) // "timed out"
-        return 1;
-    return rc;
+    return rwlock_wrlock(lockp, timespec, false);
 }
 int pthread_rwlock_tryrdlock(pthread_rwlock_t* lockp)
 {
     if (!lockp)
         return EINVAL;
 
-    return rwlock_rdlock_maybe_timed(reinterpret_cast<u32*>(lockp), nullptr, true, EBUSY, 0);
+    return rwlock_rdlock(lockp, nullptr, true);
 }
 int pthread_rwlock_trywrlock(pthread_rwlock_t* lockp)
 {
     if (!lockp)
         return EINVAL;
 
-    return rwlock_wrlock_maybe_timed(lockp, nullptr, true, EBUSY, 0);
+    return rwlock_wrlock(lockp, nullptr, true);
 }
-int pthread_rwlock_unlock(pthread_rwlock_t* lockval_p)
+int pthread_rwlock_unlock(pthread_rwlock_t* lockp)
 {
-    if (!lockval_p)
+    if (!lockp)
         return EINVAL;
 
     // This is a weird API, we don't really know whether we're unlocking write or read...
-    auto lockp = reinterpret_cast<u32*>(lockval_p);
-    auto current = AK::atomic_load(lockp, AK::MemoryOrder::memory_order_relaxed);
-    if (current & writer_locked_mask) {
+    auto* word = rwlock_futex_word(lockp);
+    auto current = AK::atomic_load(word, AK::MemoryOrder::memory_order_relaxed);
+    u32 previous;
+    if (current & rwlock_write_locked) {
         // If this lock is locked for writing, its owner better be us!
-        auto owner_id = AK::atomic_load(reinterpret_cast<i32*>(lockval_p) + 1);
-        auto my_id = pthread_self();
-        if (owner_id != my_id)
+        if (AK::atomic_load(rwlock_writer_id(lockp), AK::MemoryOrder::memory_order_relaxed) != pthread_self())
             return EINVAL; // you don't own this lock, silly.
-
-        // Now just unlock it.
-        auto desired = current & ~(writer_locked_mask | writer_intent_mask);
-        AK::atomic_store(lockp, desired, AK::MemoryOrder::memory_order_release);
-        // Then wake both readers and writers, if any.
-        auto rc = futex(lockp, FUTEX_WAKE_BITSET, current, nullptr, nullptr, (current & writer_wake_mask) | reader_wake_mask);
-        if (rc < 0)
-            return errno;
-        return 0;
-    }
-
-    for (;;) {
-        auto count = (u16)current;
-        if (!count) {
-            // Are you crazy? this isn't even locked!
-            return EINVAL;
+        AK::atomic_store(rwlock_writer_id(lockp), 0, AK::MemoryOrder::memory_order_relaxed);
+        previous = AK::atomic_fetch_and(word, ~(rwlock_write_locked | rwlock_has_waiters), AK::MemoryOrder::memory_order_release);
+    } else {
+        for (;;) {
+            if (!(current & rwlock_reader_count_mask)) {
+                // Are you crazy? this isn't even locked!
+                return EINVAL;
+            }
+            auto desired = current - 1;
+            // The last reader out wakes up whoever is waiting.
+            if (!(desired & rwlock_reader_count_mask))
+                desired &= ~rwlock_has_waiters;
+            if (AK::atomic_compare_exchange_strong(word, current, desired, AK::MemoryOrder::memory_order_release))
+                break;
         }
-        --count;
-        auto desired = (current << 16) | count;
-        auto did_exchange = AK::atomic_compare_exchange_strong(lockp, current, desired, AK::MemoryOrder::memory_order_release);
-        if (!did_exchange)
-            continue; // tough luck, try again.
+        previous = current;
+        if ((previous & rwlock_reader_count_mask) > 1)
+            return 0;
     }
 
-    // Finally, unlocked at last!
+    if (previous & rwlock_has_waiters)
+        futex_wake(word, INT32_MAX);
     return 0;
 }
 int pthread_rwlock_wrlock(pthread_rwlock_t* lockp)
@@ -793,7 +750,7 @@ int pthread_rwlock_wrlock(pthread_rwlock_t* lockp)
     if (!lockp)
         return EINVAL;
 
-    return rwlock_wrlock_maybe_timed(lockp, nullptr, false, 0, 0);
+    return rwlock_wrlock(lockp, nullptr, false);
 }
 int pthread_rwlockattr_destroy(pthread_rwlockattr_t*)
 {
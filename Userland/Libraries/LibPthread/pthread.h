@@ -78,7 +78,7 @@ int pthread_setschedparam(pthread_t thread, int policy, const struct sched_param
 
 // FIXME: Actually implement this!
 #define PTHREAD_RWLOCK_INITIALIZER \
-    NULL
+    0
 
 #define PTHREAD_KEYS_MAX 64
 #define PTHREAD_DESTRUCTOR_ITERATIONS 4
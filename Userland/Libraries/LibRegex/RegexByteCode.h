@@ -335,6 +335,9 @@ public:
 
     void insert_bytecode_alternation(ByteCode&& left, ByteCode&& right)
     {
+        // An alternation of single characters, like a|b|[cd], is a character class, which one Compare matches without forking.
+        if (insert_merged_character_compares(left, right))
+            return;
 
         // FORKJUMP _ALT
         // REGEXP ALT2
@@ -462,6 +465,8 @@ public:
     OpCode& get_opcode(MatchState& state) const;
 
 private:
+    bool insert_merged_character_compares(ByteCode const& left, ByteCode const& right);
+
     void insert_string(StringView const& view)
     {
         empend((ByteCodeValueType)view.length());
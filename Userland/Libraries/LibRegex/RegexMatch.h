@@ -230,6 +230,40 @@ public:
             });
     }
 
+    // Finds the first index at or after start where the code points of needle occur. Byte strings are searched with
+    // memmem, and UTF-32 strings code point by code point. For the other kinds of view, and needles outside of ASCII,
+    // that's not cheap to tell, so start itself is returned as a possible position.
+    Optional<size_t> find_code_points(Span<u32 const> needle, size_t start) const
+    {
+        if (needle.is_empty() || start >= length())
+            return start;
+        for (auto code_point : needle) {
+            if (code_point > 0x7f)
+                return start;
+        }
+        return m_view.visit(
+            [&](StringView view) -> Optional<size_t> {
+                Vector<u8, 32> bytes;
+                for (auto code_point : needle)
+                    bytes.append(static_cast<u8>(code_point));
+                auto result = AK::memmem_optional(view.characters_without_null_termination() + start, view.length() - start, bytes.data(), bytes.size());
+                if (!result.has_value())
+                    return {};
+                return start + result.value();
+            },
+            [&](Utf32View const& view) -> Optional<size_t> {
+                for (size_t index = start; index + needle.size() <= view.length(); ++index) {
+                    size_t matched = 0;
+                    while (matched < needle.size() && view[index + matched] == needle[matched])
+                        ++matched;
+                    if (matched == needle.size())
+                        return index;
+                }
+                return {};
+            },
+            [&](auto const&) -> Optional<size_t> { return start; });
+    }
+
     u32 operator[](size_t index) const
     {
         return m_view.visit(
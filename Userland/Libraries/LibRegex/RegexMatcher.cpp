@@ -27,8 +27,10 @@ Regex<Parser>::Regex(StringView pattern, typename ParserTraits<Parser>::OptionsT
     Parser parser(lexer, regex_options);
     parser_result = parser.parse();
 
-    if (parser_result.error == regex::Error::NoError)
+    if (parser_result.error == regex::Error::NoError) {
+        run_optimization_passes();
         matcher = make<Matcher<Parser>>(*this, regex_options);
+    }
 }
 
 template<class Parser>
@@ -142,6 +144,16 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const views, Optional
     if (input.regex_options.has_flag_set(AllFlags::Internal_Stateful))
         continue_search = false;
 
+    // Case insensitive matching compares lowercased characters, so the prefix can't be searched for as it is.
+    auto& optimization_data = m_pattern.optimization_data;
+    bool can_skip_to_prefix = continue_search && !optimization_data.literal_prefix.is_empty() && !input.regex_options.has_flag_set(AllFlags::Insensitive);
+    bool can_skip_unanchored_positions = continue_search && optimization_data.anchored_at_start && !input.regex_options.has_flag_set(AllFlags::MatchNotBeginOfLine);
+    // The backtracking VM rejects matches at the start or end of a line after the fact, and tries again from the next
+    // position. The non-backtracking matcher doesn't know how to give up a match it found, so it leaves those to it.
+    bool can_match_without_backtracking = optimization_data.can_match_without_backtracking
+        && !input.regex_options.has_flag_set(AllFlags::MatchNotBeginOfLine)
+        && !input.regex_options.has_flag_set(AllFlags::MatchNotEndOfLine);
+
     for (auto& view : views) {
         if (lines_to_skip != 0) {
             ++input.line;
@@ -183,6 +195,20 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const views, Optional
         }
 
         for (; view_index < view_length; ++view_index) {
+            // Only a search tries more than the first position, and a pattern anchored with ^ can't match after it.
+            if (can_skip_unanchored_positions && view_index > 0)
+                break;
+
+            // Skip ahead to where the literal prefix of the pattern occurs, without running the VM on the positions in between.
+            if (can_skip_to_prefix) {
+                auto candidate = view.find_code_points(optimization_data.literal_prefix, view_index);
+                if (!candidate.has_value())
+                    break;
+                view_index = candidate.value();
+                if (view_index >= view_length)
+                    break;
+            }
+
             auto& match_length_minimum = m_pattern.parser_result.match_length_minimum;
             // FIXME: More performant would be to know the remaining minimum string
             //        length needed to match from the current position onwards within
@@ -199,7 +225,17 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const views, Optional
             state.string_position = view_index;
             state.instruction_position = 0;
 
-            auto success = execute(input, state, output, 0);
+            Optional<bool> success;
+            if (can_match_without_backtracking) {
+                // A search goes through the rest of the view at once, so if it finds nothing, there is nothing left to find.
+                auto match_start = execute_without_backtracking(input, state, output, continue_search && !can_skip_unanchored_positions);
+                if (!match_start.has_value())
+                    break;
+                view_index = match_start.value();
+                success = true;
+            } else {
+                success = execute(input, state, output, 0);
+            }
             if (!success.has_value())
                 return { false, 0, {}, {}, {}, output.operations };
 
@@ -40,6 +40,19 @@ struct RegexResult final {
 template<class Parser>
 class Regex;
 
+// What the optimizer found out about a pattern, which lets the matcher skip the positions where it can't match.
+struct OptimizationData {
+    // The code points every match starts with.
+    Vector<u32> literal_prefix;
+    // Whether the pattern starts with ^, so it can only match at the start of a line.
+    bool anchored_at_start { false };
+    // Whether the pattern has no backreferences and no lookarounds, which lets the matcher follow all paths through it
+    // at once, in time linear in the length of the input, instead of backtracking.
+    bool can_match_without_backtracking { false };
+    // The names of the named capture groups, which the non-backtracking matcher keeps after the numbered ones.
+    Vector<StringView> named_capture_groups;
+};
+
 template<class Parser>
 class Matcher final {
 
@@ -62,6 +75,7 @@ public:
 private:
     Optional<bool> execute(MatchInput const& input, MatchState& state, MatchOutput& output, size_t recursion_level) const;
     ALWAYS_INLINE Optional<bool> execute_low_prio_forks(MatchInput const& input, MatchState& original_state, MatchOutput& output, Vector<MatchState> states, size_t recursion_level) const;
+    Optional<size_t> execute_without_backtracking(MatchInput const& input, MatchState& state, MatchOutput& output, bool search) const;
 
     Regex<Parser> const& m_pattern;
     typename ParserTraits<Parser>::OptionsType const m_regex_options;
@@ -72,6 +86,7 @@ class Regex final {
 public:
     String pattern_value;
     regex::Parser::Result parser_result;
+    OptimizationData optimization_data;
     OwnPtr<Matcher<Parser>> matcher { nullptr };
     mutable size_t start_offset { 0 };
 
@@ -84,6 +99,8 @@ public:
     void print_bytecode(FILE* f = stdout) const;
     String error_string(Optional<String> message = {}) const;
 
+    void run_optimization_passes();
+
     RegexResult match(RegexStringView const view, Optional<typename ParserTraits<Parser>::OptionsType> regex_options = {}) const
     {
         if (!matcher || parser_result.error != Error::NoError)
@@ -0,0 +1,336 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "RegexByteCode.h"
+#include "RegexMatcher.h"
+#include "RegexParser.h"
+#include <AK/NumericLimits.h>
+
+namespace regex {
+
+static constexpr size_t unset_position = NumericLimits<size_t>::max();
+
+namespace {
+
+// One path through the pattern. All the paths are at the same position in the input, and they are kept in the order
+// the backtracking VM would try them in, so the first one to reach the end is the match the backtracking VM finds.
+struct Thread {
+    size_t instruction_position { 0 };
+    // How many characters of a string comparison the thread has matched so far.
+    size_t string_offset { 0 };
+    size_t match_start { 0 };
+    // The left and right positions of each capture group, numbered groups first.
+    Vector<size_t> captures;
+};
+
+/**
+ * Runs the bytecode as a Thompson NFA: instead of following one path until it
+ * fails and then backtracking, it advances every path by one character at a
+ * time. Two paths at the same instruction and position will match exactly the
+ * same way from there on, so only the one with the higher priority is kept,
+ * which bounds the work per character by the size of the bytecode.
+ */
+class NFASimulation {
+public:
+    NFASimulation(ByteCode const& bytecode, MatchInput const& input, MatchOutput& output, size_t numbered_capture_groups, Vector<StringView> const& named_capture_groups)
+        : m_bytecode(bytecode)
+        , m_input(input)
+        , m_output(output)
+        , m_numbered_capture_groups(numbered_capture_groups)
+        , m_named_capture_groups(named_capture_groups)
+    {
+        m_visited.resize(bytecode.size() + 1);
+    }
+
+    Optional<Thread> run(size_t start_position, bool search, size_t& end_position);
+
+private:
+    size_t slot_count() const { return m_numbered_capture_groups + m_named_capture_groups.size(); }
+    bool visit(size_t key);
+    void add_thread(Vector<Thread>& list, size_t instruction_position, size_t match_start, Vector<size_t>& captures, size_t position);
+    void add_thread_with_capture(Vector<Thread>& list, size_t instruction_position, size_t match_start, Vector<size_t>& captures, size_t position, size_t index, size_t value);
+    void step(Thread& thread, Vector<Thread>& next, size_t position);
+    bool compare_string_character(size_t instruction_position, size_t string_offset, size_t position) const;
+    Optional<size_t> named_capture_group_slot(StringView name) const;
+
+    ByteCode const& m_bytecode;
+    MatchInput const& m_input;
+    MatchOutput& m_output;
+    size_t m_numbered_capture_groups { 0 };
+    Vector<StringView> const& m_named_capture_groups;
+
+    // The generation a thread was last added at, by instruction. Every list of threads gets a generation of its own.
+    Vector<size_t> m_visited;
+    size_t m_generation { 0 };
+    MatchState m_scratch_state;
+};
+
+bool NFASimulation::visit(size_t key)
+{
+    if (m_visited[key] == m_generation)
+        return false;
+    m_visited[key] = m_generation;
+    return true;
+}
+
+Optional<size_t> NFASimulation::named_capture_group_slot(StringView name) const
+{
+    for (size_t i = 0; i < m_named_capture_groups.size(); ++i) {
+        if (m_named_capture_groups[i] == name)
+            return m_numbered_capture_groups + i;
+    }
+    return {};
+}
+
+void NFASimulation::add_thread_with_capture(Vector<Thread>& list, size_t instruction_position, size_t match_start, Vector<size_t>& captures, size_t position, size_t index, size_t value)
+{
+    auto previous_value = captures[index];
+    captures[index] = value;
+    add_thread(list, instruction_position, match_start, captures, position);
+    captures[index] = previous_value;
+}
+
+// Follows the instructions that don't consume anything, in the order the backtracking VM would, up to the next
+// comparison or the end of the bytecode.
+void NFASimulation::add_thread(Vector<Thread>& list, size_t instruction_position, size_t match_start, Vector<size_t>& captures, size_t position)
+{
+    if (instruction_position >= m_bytecode.size()) {
+        if (visit(m_bytecode.size()))
+            list.append({ m_bytecode.size(), 0, match_start, captures });
+        return;
+    }
+    if (!visit(instruction_position))
+        return;
+
+    m_scratch_state.instruction_position = instruction_position;
+    m_scratch_state.string_position = position;
+    auto& opcode = m_bytecode.get_opcode(m_scratch_state);
+    auto next_position = instruction_position + opcode.size();
+
+    switch (opcode.opcode_id()) {
+    case OpCodeId::Compare:
+        list.append({ instruction_position, 0, match_start, captures });
+        return;
+    case OpCodeId::Jump:
+        add_thread(list, next_position + static_cast<OpCode_Jump const&>(opcode).offset(), match_start, captures, position);
+        return;
+    case OpCodeId::ForkJump: {
+        auto target = next_position + static_cast<OpCode_ForkJump const&>(opcode).offset();
+        add_thread(list, target, match_start, captures, position);
+        add_thread(list, next_position, match_start, captures, position);
+        return;
+    }
+    case OpCodeId::ForkStay: {
+        auto target = next_position + static_cast<OpCode_ForkStay const&>(opcode).offset();
+        add_thread(list, next_position, match_start, captures, position);
+        add_thread(list, target, match_start, captures, position);
+        return;
+    }
+    case OpCodeId::SaveLeftCaptureGroup: {
+        auto id = static_cast<OpCode_SaveLeftCaptureGroup const&>(opcode).id();
+        VERIFY(id < m_numbered_capture_groups);
+        add_thread_with_capture(list, next_position, match_start, captures, position, id * 2, position);
+        return;
+    }
+    case OpCodeId::SaveRightCaptureGroup: {
+        auto id = static_cast<OpCode_SaveRightCaptureGroup const&>(opcode).id();
+        VERIFY(id < m_numbered_capture_groups);
+        add_thread_with_capture(list, next_position, match_start, captures, position, id * 2 + 1, position);
+        return;
+    }
+    case OpCodeId::SaveLeftNamedCaptureGroup:
+    case OpCodeId::SaveRightNamedCaptureGroup: {
+        auto is_left = opcode.opcode_id() == OpCodeId::SaveLeftNamedCaptureGroup;
+        auto name = is_left ? static_cast<OpCode_SaveLeftNamedCaptureGroup const&>(opcode).name() : static_cast<OpCode_SaveRightNamedCaptureGroup const&>(opcode).name();
+        auto slot = named_capture_group_slot(name);
+        if (!slot.has_value()) {
+            add_thread(list, next_position, match_start, captures, position);
+            return;
+        }
+        add_thread_with_capture(list, next_position, match_start, captures, position, slot.value() * 2 + (is_left ? 0 : 1), position);
+        return;
+    }
+    case OpCodeId::ClearCaptureGroup:
+    case OpCodeId::ClearNamedCaptureGroup: {
+        Optional<size_t> slot;
+        if (opcode.opcode_id() == OpCodeId::ClearCaptureGroup)
+            slot = static_cast<OpCode_ClearCaptureGroup const&>(opcode).id();
+        else
+            slot = named_capture_group_slot(static_cast<OpCode_ClearNamedCaptureGroup const&>(opcode).name());
+        if (!slot.has_value() || slot.value() >= slot_count()) {
+            add_thread(list, next_position, match_start, captures, position);
+            return;
+        }
+        auto previous_right = captures[slot.value() * 2 + 1];
+        captures[slot.value() * 2 + 1] = unset_position;
+        add_thread_with_capture(list, next_position, match_start, captures, position, slot.value() * 2, unset_position);
+        captures[slot.value() * 2 + 1] = previous_right;
+        return;
+    }
+    case OpCodeId::CheckBegin:
+    case OpCodeId::CheckEnd:
+    case OpCodeId::CheckBoundary:
+        if (opcode.execute(m_input, m_scratch_state, m_output) == ExecutionResult::Continue)
+            add_thread(list, next_position, match_start, captures, position);
+        return;
+    default:
+        // An Exit before the end of the bytecode fails the path, and nothing else gets past the optimizer.
+        return;
+    }
+}
+
+bool NFASimulation::compare_string_character(size_t instruction_position, size_t string_offset, size_t position) const
+{
+    // Compare, argument count, arguments size, String, length, characters...
+    u32 ch = m_bytecode[instruction_position + 5 + string_offset];
+    auto subject = m_input.view.substring_view(position, 1);
+    Optional<String> str;
+    Vector<u16> utf16;
+    auto expected = subject.construct_as_same({ &ch, 1 }, str, utf16);
+    if (m_input.regex_options & AllFlags::Insensitive)
+        return subject.equals_ignoring_case(expected);
+    return subject.equals(expected);
+}
+
+void NFASimulation::step(Thread& thread, Vector<Thread>& next, size_t position)
+{
+    auto instruction_position = thread.instruction_position;
+    auto compares_string = static_cast<CharacterCompareType>(m_bytecode[instruction_position + 3]) == CharacterCompareType::String;
+
+    if (compares_string) {
+        if (!compare_string_character(instruction_position, thread.string_offset, position))
+            return;
+        auto length = m_bytecode[instruction_position + 4];
+        if (thread.string_offset + 1 == length) {
+            add_thread(next, instruction_position + length + 5, thread.match_start, thread.captures, position + 1);
+            return;
+        }
+        // The string is part of the instruction, so the keys past its start tell the progress through it apart.
+        if (visit(instruction_position + thread.string_offset + 1))
+            next.append({ instruction_position, thread.string_offset + 1, thread.match_start, move(thread.captures) });
+        return;
+    }
+
+    m_scratch_state.instruction_position = instruction_position;
+    m_scratch_state.string_position = position;
+    auto& opcode = m_bytecode.get_opcode(m_scratch_state);
+    if (opcode.execute(m_input, m_scratch_state, m_output) == ExecutionResult::Continue && m_scratch_state.string_position == position + 1)
+        add_thread(next, instruction_position + opcode.size(), thread.match_start, thread.captures, position + 1);
+}
+
+Optional<Thread> NFASimulation::run(size_t start_position, bool search, size_t& end_position)
+{
+    auto view_length = m_input.view.length();
+    Vector<Thread> current;
+    Vector<Thread> next;
+    Optional<Thread> match;
+
+    Vector<size_t> captures;
+    captures.ensure_capacity(slot_count() * 2);
+    for (size_t i = 0; i < slot_count() * 2; ++i)
+        captures.unchecked_append(unset_position);
+
+    size_t position = start_position;
+    m_generation = position + 1;
+    add_thread(current, 0, position, captures, position);
+
+    for (;;) {
+        m_generation = position + 2;
+        for (auto& thread : current) {
+            ++m_output.operations;
+            if (thread.instruction_position == m_bytecode.size()) {
+                // The threads after this one have a lower priority, so they can't change the match anymore.
+                match = move(thread);
+                end_position = position;
+                break;
+            }
+            if (position < view_length)
+                step(thread, next, position);
+        }
+
+        if (position >= view_length)
+            break;
+
+        // Searching for a match is the same as trying to match at every position, with a lower priority than all the
+        // attempts that started before it. Once there is a match, a later start can't beat it.
+        if (search && !match.has_value() && position + 1 < view_length)
+            add_thread(next, 0, position + 1, captures, position + 1);
+
+        if (next.is_empty())
+            break;
+
+        swap(current, next);
+        next.clear_with_capacity();
+        ++position;
+    }
+
+    return match;
+}
+
+}
+
+template<class Parser>
+Optional<size_t> Matcher<Parser>::execute_without_backtracking(MatchInput const& input, MatchState& state, MatchOutput& output, bool search) const
+{
+    auto& named_capture_groups = m_pattern.optimization_data.named_capture_groups;
+    auto numbered_capture_groups = m_pattern.parser_result.capture_groups_count + 1;
+
+    NFASimulation simulation(m_pattern.parser_result.bytecode, input, output, numbered_capture_groups, named_capture_groups);
+    size_t end_position = 0;
+    auto match = simulation.run(state.string_position, search, end_position);
+    if (!match.has_value()) {
+        // The backtracking VM leaves the position at the start of the view when it fails, which is where a stateful
+        // match starts over from.
+        state.string_position = 0;
+        return {};
+    }
+
+    state.string_position = end_position;
+
+    auto& captures = match->captures;
+    auto make_match = [&](size_t slot) -> Optional<Match> {
+        auto left = captures[slot * 2];
+        auto right = captures[slot * 2 + 1];
+        if (left == unset_position || right == unset_position || right < left)
+            return {};
+        auto view = input.view.substring_view(left, right - left);
+        if (input.regex_options & AllFlags::StringCopyMatches)
+            return Match { view.to_string(), input.line, left, input.global_offset + left };
+        return Match { view, input.line, left, input.global_offset + left };
+    };
+
+    if (state.capture_group_matches.size() <= input.match_index)
+        state.capture_group_matches.resize(input.match_index + 1);
+    auto& groups = state.capture_group_matches[input.match_index];
+    if (groups.size() < numbered_capture_groups)
+        groups.resize(numbered_capture_groups);
+    for (size_t id = 0; id < numbered_capture_groups; ++id) {
+        if (auto capture = make_match(id); capture.has_value())
+            groups[id] = capture.release_value();
+        else
+            groups[id].reset();
+    }
+
+    if (!named_capture_groups.is_empty()) {
+        if (state.named_capture_group_matches.size() <= input.match_index)
+            state.named_capture_group_matches.resize(input.match_index + 1);
+        auto& named_groups = state.named_capture_group_matches[input.match_index];
+        for (size_t i = 0; i < named_capture_groups.size(); ++i) {
+            if (auto capture = make_match(numbered_capture_groups + i); capture.has_value())
+                named_groups.set(named_capture_groups[i], capture.release_value());
+            else
+                named_groups.remove(named_capture_groups[i]);
+        }
+    }
+
+    return match->match_start;
+}
+
+template Optional<size_t> Matcher<PosixBasicParser>::execute_without_backtracking(MatchInput const&, MatchState&, MatchOutput&, bool) const;
+template Optional<size_t> Matcher<PosixExtendedParser>::execute_without_backtracking(MatchInput const&, MatchState&, MatchOutput&, bool) const;
+template Optional<size_t> Matcher<ECMA262Parser>::execute_without_backtracking(MatchInput const&, MatchState&, MatchOutput&, bool) const;
+
+}
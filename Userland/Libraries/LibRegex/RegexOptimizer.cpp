@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "RegexByteCode.h"
+#include "RegexMatcher.h"
+#include "RegexParser.h"
+
+namespace regex {
+
+// Returns whether the bytecode is a single Compare whose arguments each match exactly one character.
+static bool is_single_character_compare(ByteCode const& bytecode)
+{
+    if (bytecode.size() < 3 || bytecode[0] != static_cast<ByteCodeValueType>(OpCodeId::Compare))
+        return false;
+    auto arguments_count = bytecode[1];
+    auto arguments_size = bytecode[2];
+    if (bytecode.size() != arguments_size + 3)
+        return false;
+
+    size_t offset = 3;
+    for (size_t i = 0; i < arguments_count; ++i) {
+        switch (static_cast<CharacterCompareType>(bytecode[offset++])) {
+        case CharacterCompareType::AnyChar:
+            break;
+        case CharacterCompareType::Char:
+        case CharacterCompareType::CharClass:
+        case CharacterCompareType::CharRange:
+            ++offset;
+            break;
+        default:
+            // Inversions apply to the arguments around them, and strings and references match more than one character.
+            return false;
+        }
+    }
+    return offset == bytecode.size();
+}
+
+bool ByteCode::insert_merged_character_compares(ByteCode const& left, ByteCode const& right)
+{
+    if (!is_single_character_compare(left) || !is_single_character_compare(right))
+        return false;
+
+    // Both alternatives consume exactly one character, so which one matches first makes no difference.
+    empend(static_cast<ByteCodeValueType>(OpCodeId::Compare));
+    empend(left[1] + right[1]);
+    empend(left[2] + right[2]);
+    for (size_t i = 3; i < left.size(); ++i)
+        append(left[i]);
+    for (size_t i = 3; i < right.size(); ++i)
+        append(right[i]);
+    return true;
+}
+
+// Finds the literal code points every match has to start with, by following the bytecode from the start up to the
+// first instruction that forks, jumps or matches anything but a literal. Capture group bookkeeping doesn't consume
+// anything, so it doesn't end the prefix.
+static OptimizationData analyze_match_start(ByteCode const& bytecode)
+{
+    OptimizationData data;
+    MatchState state;
+    while (state.instruction_position < bytecode.size()) {
+        auto& opcode = bytecode.get_opcode(state);
+        switch (opcode.opcode_id()) {
+        case OpCodeId::SaveLeftCaptureGroup:
+        case OpCodeId::SaveRightCaptureGroup:
+        case OpCodeId::SaveLeftNamedCaptureGroup:
+        case OpCodeId::SaveRightNamedCaptureGroup:
+        case OpCodeId::ClearCaptureGroup:
+        case OpCodeId::ClearNamedCaptureGroup:
+            break;
+        case OpCodeId::CheckBegin:
+            if (!data.literal_prefix.is_empty())
+                return data;
+            data.anchored_at_start = true;
+            break;
+        case OpCodeId::Compare: {
+            auto& compare = static_cast<OpCode_Compare const&>(opcode);
+            if (compare.arguments_count() != 1)
+                return data;
+            auto type = static_cast<CharacterCompareType>(compare.argument(2));
+            if (type == CharacterCompareType::Char) {
+                data.literal_prefix.append(compare.argument(3));
+            } else if (type == CharacterCompareType::String) {
+                auto length = compare.argument(3);
+                for (size_t i = 0; i < length; ++i)
+                    data.literal_prefix.append(compare.argument(4 + i));
+            } else {
+                return data;
+            }
+            break;
+        }
+        default:
+            return data;
+        }
+        state.instruction_position += opcode.size();
+    }
+    return data;
+}
+
+// Backreferences need the text an earlier path matched, and lookarounds fail or restore forks of their own, so only the
+// backtracking VM can run them. Everything else only ever looks at the current position, which makes the paths
+// through the pattern independent of each other.
+static bool can_match_without_backtracking(ByteCode const& bytecode, Vector<StringView>& named_capture_groups)
+{
+    MatchState state;
+    while (state.instruction_position < bytecode.size()) {
+        auto& opcode = bytecode.get_opcode(state);
+        switch (opcode.opcode_id()) {
+        case OpCodeId::Save:
+        case OpCodeId::Restore:
+        case OpCodeId::GoBack:
+        case OpCodeId::FailForks:
+            return false;
+        case OpCodeId::SaveLeftNamedCaptureGroup: {
+            auto name = static_cast<OpCode_SaveLeftNamedCaptureGroup const&>(opcode).name();
+            if (!named_capture_groups.contains_slow(name))
+                named_capture_groups.append(name);
+            break;
+        }
+        case OpCodeId::Compare: {
+            auto& compare = static_cast<OpCode_Compare const&>(opcode);
+            size_t offset = state.instruction_position + 3;
+            for (size_t i = 0; i < compare.arguments_count(); ++i) {
+                switch (static_cast<CharacterCompareType>(bytecode[offset++])) {
+                case CharacterCompareType::Inverse:
+                case CharacterCompareType::TemporaryInverse:
+                case CharacterCompareType::AnyChar:
+                    break;
+                case CharacterCompareType::Char:
+                case CharacterCompareType::CharClass:
+                case CharacterCompareType::CharRange:
+                    ++offset;
+                    break;
+                case CharacterCompareType::String: {
+                    // The matcher steps through a string one character at a time, which it can only do if the string
+                    // is all there is to compare.
+                    auto length = bytecode[offset++];
+                    if (compare.arguments_count() != 1 || length == 0)
+                        return false;
+                    offset += length;
+                    break;
+                }
+                default:
+                    return false;
+                }
+            }
+            break;
+        }
+        default:
+            break;
+        }
+        state.instruction_position += opcode.size();
+    }
+    return true;
+}
+
+template<typename Parser>
+void Regex<Parser>::run_optimization_passes()
+{
+    optimization_data = analyze_match_start(parser_result.bytecode);
+    optimization_data.can_match_without_backtracking = can_match_without_backtracking(parser_result.bytecode, optimization_data.named_capture_groups);
+}
+
+template void Regex<PosixBasicParser>::run_optimization_passes();
+template void Regex<PosixExtendedParser>::run_optimization_passes();
+template void Regex<ECMA262Parser>::run_optimization_passes();
+
+}
@@ -10,8 +10,10 @@
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/RefCounted.h>
 #include <AK/RefPtr.h>
+#include <AK/Span.h>
 #include <AK/String.h>
 #include <LibSQL/AST/Token.h>
+#include <LibSQL/ColumnVector.h>
 #include <LibSQL/Forward.h>
 #include <LibSQL/SQLResult.h>
 #include <LibSQL/Type.h>
@@ -295,7 +297,26 @@ private:
 // Expressions
 //==================================================================================================
 
+/**
+ * Expressions are evaluated over a batch of rows at a time. The selection
+ * holds the indices of the rows in the batch that are still taking part; the
+ * ColumnVector an expression evaluates to has one value per selected row.
+ * Evaluation stops at the first error, which is left in the context.
+ */
+struct ExecutionContext {
+    RefPtr<TableDef> table;
+    Span<Row const> rows;
+    Vector<size_t> selection;
+    Optional<SQLError> error;
+
+    size_t size() const { return selection.size(); }
+    ColumnVector load_column(size_t column_index) const;
+    ColumnVector fail(SQLErrorCode, String argument = {});
+};
+
 class Expression : public ASTNode {
+public:
+    virtual ColumnVector evaluate(ExecutionContext&) const;
 };
 
 class ErrorExpression final : public Expression {
@@ -309,6 +330,7 @@ public:
     }
 
     double value() const { return m_value; }
+    ColumnVector evaluate(ExecutionContext&) const override;
 
 private:
     double m_value;
@@ -322,6 +344,7 @@ public:
     }
 
     const String& value() const { return m_value; }
+    ColumnVector evaluate(ExecutionContext&) const override;
 
 private:
     String m_value;
@@ -341,6 +364,8 @@ private:
 };
 
 class NullLiteral : public Expression {
+public:
+    ColumnVector evaluate(ExecutionContext&) const override;
 };
 
 class NestedExpression : public Expression {
@@ -416,6 +441,7 @@ public:
     const String& schema_name() const { return m_schema_name; }
     const String& table_name() const { return m_table_name; }
     const String& column_name() const { return m_column_name; }
+    ColumnVector evaluate(ExecutionContext&) const override;
 
 private:
     String m_schema_name;
@@ -439,6 +465,7 @@ public:
     }
 
     UnaryOperator type() const { return m_type; }
+    ColumnVector evaluate(ExecutionContext&) const override;
 
 private:
     UnaryOperator m_type;
@@ -475,6 +502,7 @@ public:
     }
 
     BinaryOperator type() const { return m_type; }
+    ColumnVector evaluate(ExecutionContext&) const override;
 
 private:
     BinaryOperator m_type;
@@ -488,6 +516,7 @@ public:
     }
 
     const NonnullRefPtrVector<Expression>& expressions() const { return m_expressions; }
+    ColumnVector evaluate(ExecutionContext&) const override;
 
 private:
     NonnullRefPtrVector<Expression> m_expressions;
@@ -592,6 +621,8 @@ public:
         : InvertibleNestedExpression(move(expression), invert_expression)
     {
     }
+
+    ColumnVector evaluate(ExecutionContext&) const override;
 };
 
 class IsExpression : public InvertibleNestedDoubleExpression {
@@ -886,6 +917,8 @@ public:
     bool has_selection() const { return !m_select_statement.is_null(); }
     const RefPtr<Select>& select_statement() const { return m_select_statement; }
 
+    RefPtr<SQLResult> execute(NonnullRefPtr<Database>) const override;
+
 private:
     RefPtr<CommonTableExpressionList> m_common_table_expression_list;
     ConflictResolution m_conflict_resolution;
@@ -978,6 +1011,8 @@ public:
     const NonnullRefPtrVector<OrderingTerm>& ordering_term_list() const { return m_ordering_term_list; }
     const RefPtr<LimitClause>& limit_clause() const { return m_limit_clause; }
 
+    RefPtr<SQLResult> execute(NonnullRefPtr<Database>) const override;
+
 private:
     RefPtr<CommonTableExpressionList> m_common_table_expression_list;
     bool m_select_all;
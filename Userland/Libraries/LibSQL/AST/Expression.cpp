@@ -0,0 +1,429 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibSQL/AST/AST.h>
+#include <LibSQL/Meta.h>
+#include <LibSQL/Row.h>
+#include <stdlib.h>
+
+namespace SQL::AST {
+
+ColumnVector ExecutionContext::load_column(size_t column_index) const
+{
+    VERIFY(table);
+    ColumnVector column(table->columns()[column_index].type(), size());
+    for (size_t ix = 0; ix < size(); ++ix)
+        column.set_value(ix, rows[selection[ix]][column_index]);
+    return column;
+}
+
+ColumnVector ExecutionContext::fail(SQLErrorCode code, String argument)
+{
+    if (!error.has_value())
+        error = SQLError { code, move(argument) };
+    return ColumnVector(SQLType::Integer, size());
+}
+
+ColumnVector Expression::evaluate(ExecutionContext& context) const
+{
+    return context.fail(SQLErrorCode::NotYetImplemented, "Expression");
+}
+
+ColumnVector NumericLiteral::evaluate(ExecutionContext& context) const
+{
+    // Whole numbers are integers, so that arithmetic on integer columns stays in integers.
+    if (m_value >= NumericLimits<int>::min() && m_value <= NumericLimits<int>::max() && static_cast<double>(static_cast<int>(m_value)) == m_value) {
+        Value value(SQLType::Integer);
+        value = static_cast<int>(m_value);
+        return ColumnVector::from_value(value, context.size());
+    }
+    Value value(SQLType::Float);
+    value = m_value;
+    return ColumnVector::from_value(value, context.size());
+}
+
+ColumnVector StringLiteral::evaluate(ExecutionContext& context) const
+{
+    Value value(SQLType::Text);
+    value = m_value;
+    return ColumnVector::from_value(value, context.size());
+}
+
+ColumnVector NullLiteral::evaluate(ExecutionContext& context) const
+{
+    ColumnVector column(SQLType::Integer, context.size());
+    for (size_t ix = 0; ix < column.size(); ++ix)
+        column.set_null(ix);
+    return column;
+}
+
+ColumnVector ColumnNameExpression::evaluate(ExecutionContext& context) const
+{
+    if (context.table) {
+        auto columns = context.table->columns();
+        for (size_t ix = 0; ix < columns.size(); ++ix) {
+            if (columns[ix].name() == column_name())
+                return context.load_column(ix);
+        }
+    }
+    return context.fail(SQLErrorCode::ColumnDoesNotExist, column_name());
+}
+
+ColumnVector ChainedExpression::evaluate(ExecutionContext& context) const
+{
+    // A single parenthesized expression; a list of them is only meaningful as the operand of IN.
+    if (expressions().size() != 1)
+        return Expression::evaluate(context);
+    return expressions()[0].evaluate(context);
+}
+
+ColumnVector NullExpression::evaluate(ExecutionContext& context) const
+{
+    auto operand = expression()->evaluate(context);
+    ColumnVector result(SQLType::Integer, operand.size());
+    auto& integers = result.integers();
+    for (size_t ix = 0; ix < operand.size(); ++ix)
+        integers[ix] = operand.is_null(ix) != invert_expression();
+    return result;
+}
+
+static double text_to_double(String const& text)
+{
+    char* end_pointer;
+    return strtod(text.characters(), &end_pointer);
+}
+
+// Text is converted to a number wherever one is expected, like SQLite does. Text that isn't a number becomes 0.
+static ColumnVector to_numeric(ColumnVector const& column)
+{
+    if (column.is_numeric())
+        return column;
+    ColumnVector result(SQLType::Float, column.size());
+    auto& strings = column.strings();
+    auto& floats = result.floats();
+    for (size_t ix = 0; ix < column.size(); ++ix) {
+        if (column.is_null(ix))
+            result.set_null(ix);
+        else
+            floats[ix] = text_to_double(strings[ix]);
+    }
+    return result;
+}
+
+static ColumnVector to_integers(ColumnVector const& column)
+{
+    auto numeric = to_numeric(column);
+    if (numeric.type() == SQLType::Integer)
+        return numeric;
+    ColumnVector result(SQLType::Integer, numeric.size());
+    auto& floats = numeric.floats();
+    auto& integers = result.integers();
+    for (size_t ix = 0; ix < numeric.size(); ++ix) {
+        if (numeric.is_null(ix))
+            result.set_null(ix);
+        else
+            integers[ix] = static_cast<int>(floats[ix]);
+    }
+    return result;
+}
+
+static ColumnVector to_text(ColumnVector const& column)
+{
+    if (column.type() == SQLType::Text)
+        return column;
+    ColumnVector result(SQLType::Text, column.size());
+    auto& strings = result.strings();
+    for (size_t ix = 0; ix < column.size(); ++ix) {
+        if (column.is_null(ix))
+            result.set_null(ix);
+        else
+            strings[ix] = column.value(ix).to_string().value();
+    }
+    return result;
+}
+
+// Applies the operation to every pair of values, and makes the result null wherever either of the operands is.
+// The operation also runs for the null slots, so that the loop doesn't branch.
+template<typename Result, typename Left, typename Right, typename Operation>
+static void apply(ColumnVector const& lhs, ColumnVector const& rhs, ColumnVector& result, Vector<Left> const& left, Vector<Right> const& right, Vector<Result>& output, Operation operation)
+{
+    for (size_t ix = 0; ix < output.size(); ++ix)
+        output[ix] = operation(left[ix], right[ix]);
+    for (size_t ix = 0; ix < output.size(); ++ix) {
+        if (lhs.is_null(ix) || rhs.is_null(ix))
+            result.set_null(ix);
+    }
+}
+
+static ColumnVector evaluate_arithmetic(BinaryOperator type, ColumnVector const& lhs_column, ColumnVector const& rhs_column)
+{
+    auto lhs = to_numeric(lhs_column);
+    auto rhs = to_numeric(rhs_column);
+    if (type == BinaryOperator::Modulo) {
+        lhs = to_integers(lhs);
+        rhs = to_integers(rhs);
+    }
+
+    if (lhs.type() == SQLType::Integer && rhs.type() == SQLType::Integer) {
+        ColumnVector result(SQLType::Integer, lhs.size());
+        auto& left = lhs.integers();
+        auto& right = rhs.integers();
+        auto& output = result.integers();
+        switch (type) {
+        case BinaryOperator::Multiplication:
+            apply(lhs, rhs, result, left, right, output, [](int a, int b) { return static_cast<int>(static_cast<i64>(a) * b); });
+            break;
+        case BinaryOperator::Plus:
+            apply(lhs, rhs, result, left, right, output, [](int a, int b) { return static_cast<int>(static_cast<i64>(a) + b); });
+            break;
+        case BinaryOperator::Minus:
+            apply(lhs, rhs, result, left, right, output, [](int a, int b) { return static_cast<int>(static_cast<i64>(a) - b); });
+            break;
+        case BinaryOperator::Division:
+        case BinaryOperator::Modulo: {
+            // Dividing by zero gives NULL.
+            bool is_division = type == BinaryOperator::Division;
+            apply(lhs, rhs, result, left, right, output, [is_division](int a, int b) {
+                if (b == 0 || (b == -1 && a == NumericLimits<int>::min()))
+                    return 0;
+                return is_division ? a / b : a % b;
+            });
+            for (size_t ix = 0; ix < right.size(); ++ix) {
+                if (right[ix] == 0)
+                    result.set_null(ix);
+            }
+            break;
+        }
+        default:
+            VERIFY_NOT_REACHED();
+        }
+        return result;
+    }
+
+    lhs = lhs.to_floats();
+    rhs = rhs.to_floats();
+    ColumnVector result(SQLType::Float, lhs.size());
+    auto& left = lhs.floats();
+    auto& right = rhs.floats();
+    auto& output = result.floats();
+    switch (type) {
+    case BinaryOperator::Multiplication:
+        apply(lhs, rhs, result, left, right, output, [](double a, double b) { return a * b; });
+        break;
+    case BinaryOperator::Plus:
+        apply(lhs, rhs, result, left, right, output, [](double a, double b) { return a + b; });
+        break;
+    case BinaryOperator::Minus:
+        apply(lhs, rhs, result, left, right, output, [](double a, double b) { return a - b; });
+        break;
+    case BinaryOperator::Division:
+        apply(lhs, rhs, result, left, right, output, [](double a, double b) { return b != 0.0 ? a / b : 0.0; });
+        for (size_t ix = 0; ix < right.size(); ++ix) {
+            if (right[ix] == 0.0)
+                result.set_null(ix);
+        }
+        break;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+    return result;
+}
+
+static ColumnVector evaluate_bitwise(BinaryOperator type, ColumnVector const& lhs_column, ColumnVector const& rhs_column)
+{
+    auto lhs = to_integers(lhs_column);
+    auto rhs = to_integers(rhs_column);
+    ColumnVector result(SQLType::Integer, lhs.size());
+    auto& left = lhs.integers();
+    auto& right = rhs.integers();
+    auto& output = result.integers();
+    switch (type) {
+    case BinaryOperator::ShiftLeft:
+        apply(lhs, rhs, result, left, right, output, [](int a, int b) { return (b < 0 || b >= 32) ? 0 : static_cast<int>(static_cast<u32>(a) << b); });
+        break;
+    case BinaryOperator::ShiftRight:
+        apply(lhs, rhs, result, left, right, output, [](int a, int b) { return (b < 0 || b >= 32) ? (a < 0 ? -1 : 0) : a >> b; });
+        break;
+    case BinaryOperator::BitwiseAnd:
+        apply(lhs, rhs, result, left, right, output, [](int a, int b) { return a & b; });
+        break;
+    case BinaryOperator::BitwiseOr:
+        apply(lhs, rhs, result, left, right, output, [](int a, int b) { return a | b; });
+        break;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+    return result;
+}
+
+static bool comparison_holds(BinaryOperator type, int comparison)
+{
+    switch (type) {
+    case BinaryOperator::LessThan:
+        return comparison < 0;
+    case BinaryOperator::LessThanEquals:
+        return comparison <= 0;
+    case BinaryOperator::GreaterThan:
+        return comparison > 0;
+    case BinaryOperator::GreaterThanEquals:
+        return comparison >= 0;
+    case BinaryOperator::Equals:
+        return comparison == 0;
+    case BinaryOperator::NotEquals:
+        return comparison != 0;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+template<typename T>
+static int three_way_compare(T const& a, T const& b)
+{
+    return (a < b) ? -1 : ((b < a) ? 1 : 0);
+}
+
+static ColumnVector evaluate_comparison(BinaryOperator type, ColumnVector const& lhs, ColumnVector const& rhs)
+{
+    ColumnVector result(SQLType::Integer, lhs.size());
+    auto& output = result.integers();
+
+    // The comparison is looked up once for the whole batch, so that the loops below only compare.
+    bool less = comparison_holds(type, -1);
+    bool equal = comparison_holds(type, 0);
+    bool greater = comparison_holds(type, 1);
+    auto outcome = [&](int comparison) -> int { return comparison < 0 ? less : (comparison == 0 ? equal : greater); };
+
+    if (lhs.type() == SQLType::Integer && rhs.type() == SQLType::Integer) {
+        apply(lhs, rhs, result, lhs.integers(), rhs.integers(), output, [&](int a, int b) { return outcome(three_way_compare(a, b)); });
+    } else if (lhs.is_numeric() && rhs.is_numeric()) {
+        auto left = lhs.to_floats();
+        auto right = rhs.to_floats();
+        apply(left, right, result, left.floats(), right.floats(), output, [&](double a, double b) { return outcome(three_way_compare(a, b)); });
+    } else if (lhs.type() == SQLType::Text && rhs.type() == SQLType::Text) {
+        apply(lhs, rhs, result, lhs.strings(), rhs.strings(), output, [&](String const& a, String const& b) { return outcome(three_way_compare(a, b)); });
+    } else {
+        // Like in SQLite, numbers are less than text.
+        int value = outcome(lhs.is_numeric() ? -1 : 1);
+        for (size_t ix = 0; ix < output.size(); ++ix) {
+            output[ix] = value;
+            if (lhs.is_null(ix) || rhs.is_null(ix))
+                result.set_null(ix);
+        }
+    }
+    return result;
+}
+
+static ColumnVector evaluate_logical(BinaryOperator type, ColumnVector const& lhs, ColumnVector const& rhs)
+{
+    // Three-valued logic: the result is only NULL if it depends on an operand that is NULL.
+    bool is_and = type == BinaryOperator::And;
+    ColumnVector result(SQLType::Integer, lhs.size());
+    auto& output = result.integers();
+    for (size_t ix = 0; ix < lhs.size(); ++ix) {
+        bool left = lhs.is_true(ix);
+        bool right = rhs.is_true(ix);
+        bool decided_by_left = !lhs.is_null(ix) && left != is_and;
+        bool decided_by_right = !rhs.is_null(ix) && right != is_and;
+        if (decided_by_left || decided_by_right)
+            output[ix] = !is_and;
+        else if (lhs.is_null(ix) || rhs.is_null(ix))
+            result.set_null(ix);
+        else
+            output[ix] = is_and;
+    }
+    return result;
+}
+
+static ColumnVector evaluate_concatenation(ColumnVector const& lhs_column, ColumnVector const& rhs_column)
+{
+    auto lhs = to_text(lhs_column);
+    auto rhs = to_text(rhs_column);
+    ColumnVector result(SQLType::Text, lhs.size());
+    apply(lhs, rhs, result, lhs.strings(), rhs.strings(), result.strings(), [](String const& a, String const& b) { return String::formatted("{}{}", a, b); });
+    return result;
+}
+
+ColumnVector BinaryOperatorExpression::evaluate(ExecutionContext& context) const
+{
+    auto lhs_column = lhs()->evaluate(context);
+    if (context.error.has_value())
+        return lhs_column;
+    auto rhs_column = rhs()->evaluate(context);
+    if (context.error.has_value())
+        return rhs_column;
+
+    switch (type()) {
+    case BinaryOperator::Concatenate:
+        return evaluate_concatenation(lhs_column, rhs_column);
+    case BinaryOperator::Multiplication:
+    case BinaryOperator::Division:
+    case BinaryOperator::Modulo:
+    case BinaryOperator::Plus:
+    case BinaryOperator::Minus:
+        return evaluate_arithmetic(type(), lhs_column, rhs_column);
+    case BinaryOperator::ShiftLeft:
+    case BinaryOperator::ShiftRight:
+    case BinaryOperator::BitwiseAnd:
+    case BinaryOperator::BitwiseOr:
+        return evaluate_bitwise(type(), lhs_column, rhs_column);
+    case BinaryOperator::LessThan:
+    case BinaryOperator::LessThanEquals:
+    case BinaryOperator::GreaterThan:
+    case BinaryOperator::GreaterThanEquals:
+    case BinaryOperator::Equals:
+    case BinaryOperator::NotEquals:
+        return evaluate_comparison(type(), lhs_column, rhs_column);
+    case BinaryOperator::And:
+    case BinaryOperator::Or:
+        return evaluate_logical(type(), lhs_column, rhs_column);
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+ColumnVector UnaryOperatorExpression::evaluate(ExecutionContext& context) const
+{
+    auto operand = expression()->evaluate(context);
+    if (context.error.has_value())
+        return operand;
+
+    switch (type()) {
+    case UnaryOperator::Plus:
+        return operand;
+    case UnaryOperator::Minus: {
+        auto result = to_numeric(operand);
+        if (result.type() == SQLType::Integer) {
+            for (auto& value : result.integers())
+                value = static_cast<int>(-static_cast<i64>(value));
+        } else {
+            for (auto& value : result.floats())
+                value = -value;
+        }
+        return result;
+    }
+    case UnaryOperator::BitwiseNot: {
+        auto result = to_integers(operand);
+        for (auto& value : result.integers())
+            value = ~value;
+        return result;
+    }
+    case UnaryOperator::Not: {
+        ColumnVector result(SQLType::Integer, operand.size());
+        auto& output = result.integers();
+        for (size_t ix = 0; ix < operand.size(); ++ix) {
+            if (operand.is_null(ix))
+                result.set_null(ix);
+            else
+                output[ix] = !operand.is_true(ix);
+        }
+        return result;
+    }
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+}
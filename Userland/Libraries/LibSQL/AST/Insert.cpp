@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibSQL/AST/AST.h>
+#include <LibSQL/Database.h>
+#include <LibSQL/Meta.h>
+#include <LibSQL/Row.h>
+
+namespace SQL::AST {
+
+RefPtr<SQLResult> Insert::execute(NonnullRefPtr<Database> database) const
+{
+    if (!common_table_expression_list().is_null())
+        return SQLResult::construct(SQLCommand::Insert, SQLErrorCode::NotYetImplemented, "WITH");
+    if (!has_expressions())
+        return SQLResult::construct(SQLCommand::Insert, SQLErrorCode::NotYetImplemented, has_selection() ? "INSERT ... SELECT" : "DEFAULT VALUES");
+
+    auto schema_name = (!m_schema_name.is_null() && !m_schema_name.is_empty()) ? m_schema_name : "default";
+    auto table_def = database->get_table(schema_name, m_table_name);
+    if (!table_def)
+        return SQLResult::construct(SQLCommand::Insert, SQLErrorCode::TableDoesNotExist, m_table_name);
+
+    auto table_columns = table_def->columns();
+    Vector<size_t> column_indices;
+    if (m_column_names.is_empty()) {
+        for (size_t ix = 0; ix < table_columns.size(); ++ix)
+            column_indices.append(ix);
+    } else {
+        for (auto& column_name : m_column_names) {
+            Optional<size_t> column_index;
+            for (size_t ix = 0; ix < table_columns.size() && !column_index.has_value(); ++ix) {
+                if (table_columns[ix].name() == column_name)
+                    column_index = ix;
+            }
+            if (!column_index.has_value())
+                return SQLResult::construct(SQLCommand::Insert, SQLErrorCode::ColumnDoesNotExist, column_name);
+            column_indices.append(column_index.value());
+        }
+    }
+
+    // All rows are checked before the first one is inserted, so that a bad row doesn't leave the ones before it behind.
+    Vector<Row> rows;
+    ExecutionContext context;
+    context.selection.append(0);
+    for (auto& chained_expression : m_chained_expressions) {
+        auto& values = chained_expression.expressions();
+        if (values.size() != column_indices.size())
+            return SQLResult::construct(SQLCommand::Insert, SQLErrorCode::InvalidNumberOfValues, "");
+
+        Row row(table_def);
+        for (size_t ix = 0; ix < values.size(); ++ix) {
+            auto value = values[ix].evaluate(context).value(0);
+            if (context.error.has_value())
+                return SQLResult::construct(SQLCommand::Insert, context.error->code, context.error->error_argument);
+            auto& element = row[column_indices[ix]];
+            if (!element.can_cast(value))
+                return SQLResult::construct(SQLCommand::Insert, SQLErrorCode::InvalidType, value.type_name());
+            element = value;
+        }
+        rows.append(move(row));
+    }
+
+    for (auto& row : rows)
+        database->insert(row);
+    return SQLResult::construct(SQLCommand::Insert, 0, rows.size());
+}
+
+}
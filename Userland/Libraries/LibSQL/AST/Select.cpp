@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/QuickSort.h>
+#include <AK/TypeCasts.h>
+#include <LibSQL/AST/AST.h>
+#include <LibSQL/Database.h>
+#include <LibSQL/Meta.h>
+#include <LibSQL/Row.h>
+
+namespace SQL::AST {
+
+// The number of rows that are read from the table and run through the expressions together.
+static constexpr size_t batch_size = 1024;
+
+// Splits the WHERE clause into the terms that are ANDed together.
+static void collect_conjuncts(Expression const& expression, Vector<Expression const*>& conjuncts)
+{
+    if (is<BinaryOperatorExpression>(expression)) {
+        auto& binary_expression = static_cast<BinaryOperatorExpression const&>(expression);
+        if (binary_expression.type() == BinaryOperator::And) {
+            collect_conjuncts(binary_expression.lhs(), conjuncts);
+            collect_conjuncts(binary_expression.rhs(), conjuncts);
+            return;
+        }
+    }
+    if (is<ChainedExpression>(expression)) {
+        auto& chained_expression = static_cast<ChainedExpression const&>(expression);
+        if (chained_expression.expressions().size() == 1) {
+            collect_conjuncts(chained_expression.expressions()[0], conjuncts);
+            return;
+        }
+    }
+    conjuncts.append(&expression);
+}
+
+// A rough estimate of the work it takes to evaluate the expression for one row. Loading a column costs more than
+// using a constant, and text costs more than numbers.
+static size_t estimated_cost(Expression const& expression, TableDef const& table)
+{
+    if (is<NumericLiteral>(expression) || is<NullLiteral>(expression))
+        return 1;
+    if (is<StringLiteral>(expression))
+        return 2;
+    if (is<ColumnNameExpression>(expression)) {
+        auto& column_name = static_cast<ColumnNameExpression const&>(expression).column_name();
+        for (auto& column : table.columns()) {
+            if (column.name() == column_name)
+                return column.type() == SQLType::Text ? 8 : 4;
+        }
+        return 4;
+    }
+    if (is<ChainedExpression>(expression)) {
+        size_t cost = 0;
+        for (auto& element : static_cast<ChainedExpression const&>(expression).expressions())
+            cost += estimated_cost(element, table);
+        return cost;
+    }
+    if (is<NestedExpression>(expression))
+        return 1 + estimated_cost(static_cast<NestedExpression const&>(expression).expression(), table);
+    if (is<BinaryOperatorExpression>(expression)) {
+        auto& binary_expression = static_cast<BinaryOperatorExpression const&>(expression);
+        size_t cost = binary_expression.type() == BinaryOperator::Concatenate ? 16 : 1;
+        return cost + estimated_cost(binary_expression.lhs(), table) + estimated_cost(binary_expression.rhs(), table);
+    }
+    // Expressions we can't evaluate will fail, and the sooner the better.
+    return 0;
+}
+
+/**
+ * The plan for a SELECT over a single table. The only way to get at the rows
+ * of a table is to scan it, since tables don't have indexes of their own yet;
+ * what the planner decides is the order of the terms of the WHERE clause.
+ * They are evaluated cheapest first, and every term is only evaluated for the
+ * rows that all of the terms before it selected.
+ */
+struct QueryPlan {
+    RefPtr<TableDef> table;
+    Vector<Expression const*> filters;
+    size_t offset { 0 };
+    Optional<size_t> limit;
+};
+
+static Optional<int> evaluate_constant(Expression const& expression, ExecutionContext& context)
+{
+    ExecutionContext constant_context;
+    constant_context.selection.append(0);
+    auto result = expression.evaluate(constant_context);
+    if (constant_context.error.has_value()) {
+        context.error = constant_context.error;
+        return {};
+    }
+    return result.value(0).to_int();
+}
+
+static void filter(ExecutionContext& context, QueryPlan const& plan)
+{
+    for (auto* term : plan.filters) {
+        if (context.selection.is_empty())
+            return;
+        auto result = term->evaluate(context);
+        if (context.error.has_value())
+            return;
+        Vector<size_t> selection;
+        selection.ensure_capacity(context.size());
+        for (size_t ix = 0; ix < context.size(); ++ix) {
+            if (result.is_true(ix))
+                selection.unchecked_append(context.selection[ix]);
+        }
+        context.selection = move(selection);
+    }
+}
+
+RefPtr<SQLResult> Select::execute(NonnullRefPtr<Database> database) const
+{
+    if (!common_table_expression_list().is_null())
+        return SQLResult::construct(SQLCommand::Select, SQLErrorCode::NotYetImplemented, "WITH");
+    if (!select_all())
+        return SQLResult::construct(SQLCommand::Select, SQLErrorCode::NotYetImplemented, "DISTINCT");
+    if (!group_by_clause().is_null())
+        return SQLResult::construct(SQLCommand::Select, SQLErrorCode::NotYetImplemented, "GROUP BY");
+    if (!ordering_term_list().is_empty())
+        return SQLResult::construct(SQLCommand::Select, SQLErrorCode::NotYetImplemented, "ORDER BY");
+    if (table_or_subquery_list().size() > 1)
+        return SQLResult::construct(SQLCommand::Select, SQLErrorCode::NotYetImplemented, "Joins");
+
+    QueryPlan plan;
+    if (!table_or_subquery_list().is_empty()) {
+        auto& table_or_subquery = table_or_subquery_list()[0];
+        if (!table_or_subquery.is_table())
+            return SQLResult::construct(SQLCommand::Select, SQLErrorCode::NotYetImplemented, "Subqueries");
+        auto schema_name = table_or_subquery.schema_name().is_empty() ? String("default") : table_or_subquery.schema_name();
+        plan.table = database->get_table(schema_name, table_or_subquery.table_name());
+        if (!plan.table)
+            return SQLResult::construct(SQLCommand::Select, SQLErrorCode::TableDoesNotExist, table_or_subquery.table_name());
+    }
+
+    if (!where_clause().is_null()) {
+        collect_conjuncts(*where_clause(), plan.filters);
+        if (plan.table) {
+            auto& table = *plan.table;
+            quick_sort(plan.filters, [&](auto* a, auto* b) { return estimated_cost(*a, table) < estimated_cost(*b, table); });
+        }
+    }
+
+    ExecutionContext limit_context;
+    if (!limit_clause().is_null()) {
+        // Like in SQLite, a negative limit means there is none.
+        auto limit = evaluate_constant(limit_clause()->limit_expression(), limit_context);
+        if (limit.has_value() && limit.value() >= 0)
+            plan.limit = limit.value();
+        if (!limit_clause()->offset_expression().is_null()) {
+            auto offset = evaluate_constant(*limit_clause()->offset_expression(), limit_context);
+            if (offset.has_value() && offset.value() > 0)
+                plan.offset = offset.value();
+        }
+        if (limit_context.error.has_value())
+            return SQLResult::construct(SQLCommand::Select, limit_context.error->code, limit_context.error->error_argument);
+    }
+
+    auto result = SQLResult::construct(SQLCommand::Select);
+    Optional<SQLError> error;
+    size_t rows_to_skip = plan.offset;
+    size_t rows_produced = 0;
+
+    auto process_batch = [&](Span<Row const> rows, size_t row_count) {
+        ExecutionContext context { plan.table, rows, {}, {} };
+        context.selection.ensure_capacity(row_count);
+        for (size_t ix = 0; ix < row_count; ++ix)
+            context.selection.unchecked_append(ix);
+
+        filter(context, plan);
+        if (context.error.has_value()) {
+            error = context.error;
+            return IterationDecision::Break;
+        }
+
+        auto skip = min(rows_to_skip, context.size());
+        rows_to_skip -= skip;
+        context.selection.remove(0, skip);
+        if (plan.limit.has_value())
+            context.selection.shrink(min(context.size(), plan.limit.value() - rows_produced));
+        if (context.selection.is_empty())
+            return (plan.limit.has_value() && rows_produced == plan.limit.value()) ? IterationDecision::Break : IterationDecision::Continue;
+
+        Vector<ColumnVector> columns;
+        TupleDescriptor descriptor;
+        for (auto& result_column : result_column_list()) {
+            if (result_column.type() == ResultType::Expression) {
+                columns.append(result_column.expression()->evaluate(context));
+                if (context.error.has_value()) {
+                    error = context.error;
+                    return IterationDecision::Break;
+                }
+                auto name = result_column.column_alias();
+                if (name.is_empty() && is<ColumnNameExpression>(*result_column.expression()))
+                    name = static_cast<ColumnNameExpression const&>(*result_column.expression()).column_name();
+                descriptor.append({ name, columns.last().type(), Order::Ascending });
+                continue;
+            }
+            if (!plan.table) {
+                error = SQLError { SQLErrorCode::SyntaxError, "No tables specified" };
+                return IterationDecision::Break;
+            }
+            auto table_columns = plan.table->columns();
+            for (size_t ix = 0; ix < table_columns.size(); ++ix) {
+                columns.append(context.load_column(ix));
+                descriptor.append({ table_columns[ix].name(), table_columns[ix].type(), Order::Ascending });
+            }
+        }
+
+        for (size_t row = 0; row < context.size(); ++row) {
+            Tuple tuple(descriptor);
+            for (size_t column = 0; column < columns.size(); ++column)
+                tuple[column] = columns[column].value(row);
+            result->append(tuple);
+        }
+        rows_produced += context.size();
+        return (plan.limit.has_value() && rows_produced == plan.limit.value()) ? IterationDecision::Break : IterationDecision::Continue;
+    };
+
+    if (plan.limit.has_value() && plan.limit.value() == 0) {
+        // Nothing to produce.
+    } else if (plan.table) {
+        database->scan(*plan.table, batch_size, [&](Span<Row const> rows) { return process_batch(rows, rows.size()); });
+    } else {
+        // A SELECT without a FROM clause produces a single row.
+        process_batch({}, 1);
+    }
+
+    if (error.has_value())
+        return SQLResult::construct(SQLCommand::Select, error->code, error->error_argument);
+    return result;
+}
+
+}
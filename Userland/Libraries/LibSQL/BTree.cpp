@@ -70,6 +70,89 @@ bool BTree::insert(Key const& key)
     return m_root->insert(key);
 }
 
+bool BTree::bulk_load(Vector<Key> const& keys)
+{
+    if (!m_root)
+        initialize_root();
+    VERIFY(m_root);
+    if (m_root->size() > 0)
+        return false;
+    for (size_t ix = 1; ix < keys.size(); ix++) {
+        auto order = keys[ix - 1].compare(keys[ix]);
+        if (order > 0 || (order == 0 && !duplicates_allowed()))
+            return false;
+    }
+    if (keys.is_empty())
+        return true;
+
+    // The tree is built one level at a time, starting with the leaves. The
+    // keys that separate the nodes of a level become the keys of the level
+    // above it, and the nodes become their children.
+    Vector<Key> separators;
+    Vector<u32> children;
+    children.resize(keys.size() + 1);
+    auto level_keys = keys.span();
+    bool is_leaf = true;
+    while (true) {
+        // A node holding level_keys[begin, end) has children[begin, end] as
+        // its down pointers, and level_keys[end] goes up a level.
+        Vector<size_t> node_ends;
+        size_t begin = 0;
+        auto node_size = TreeNode::packed_node_overhead(is_leaf);
+        ByteBuffer previous_key;
+        ByteBuffer key;
+        for (size_t ix = 0; ix < level_keys.size(); ix++) {
+            key.clear();
+            level_keys[ix].serialize(key);
+            auto entry_size = TreeNode::packed_entry_size(descriptor(), previous_key, key, is_leaf);
+            if (ix > begin && node_size + entry_size > BLOCKSIZE) {
+                node_ends.append(ix);
+                begin = ix + 1;
+                node_size = TreeNode::packed_node_overhead(is_leaf);
+                previous_key.clear();
+                continue;
+            }
+            node_size += entry_size;
+            swap(previous_key, key);
+        }
+        if (begin == level_keys.size()) {
+            // The last key went up a level, which would leave the last node
+            // empty. Send the key before it up instead, and give the last
+            // node the last key.
+            auto previous_begin = node_ends.size() > 1 ? node_ends[node_ends.size() - 2] + 1 : 0;
+            VERIFY(node_ends.last() - previous_begin >= 2);
+            node_ends.last()--;
+        }
+        node_ends.append(level_keys.size());
+
+        auto is_root = node_ends.size() == 1;
+        Vector<Key> next_level_keys;
+        Vector<u32> node_pointers;
+        ByteBuffer buffer;
+        begin = 0;
+        for (auto end : node_ends) {
+            buffer.clear();
+            TreeNode::serialize_packed(buffer, descriptor(), level_keys.slice(begin, end - begin), children.span().slice(begin, end - begin + 1), is_leaf);
+            auto node_pointer = is_root ? pointer() : new_record_pointer();
+            add_to_write_ahead_log(node_pointer, buffer);
+            node_pointers.append(node_pointer);
+            if (end < level_keys.size())
+                next_level_keys.append(level_keys[end]);
+            begin = end + 1;
+        }
+
+        if (is_root) {
+            size_t offset = 0;
+            m_root = make<TreeNode>(*this, nullptr, pointer(), buffer, offset);
+            return true;
+        }
+        separators = move(next_level_keys);
+        level_keys = separators.span();
+        children = move(node_pointers);
+        is_leaf = false;
+    }
+}
+
 bool BTree::update_key_pointer(Key const& key)
 {
     if (!m_root)
@@ -31,6 +31,11 @@ namespace SQL {
  *
  * The classes implementing the B-Tree functionality are BTree, TreeNode,
  * BTreeIterator, and DownPointer (a smart pointer-like helper class).
+ *
+ * TreeNodes are stored prefix-compressed: every key only stores the bytes
+ * in which it differs from the key before it in the node, without the zero
+ * bytes it ends with. A node is split when it no longer fits in a block, so
+ * the number of keys in a node depends on how well they compress.
  */
 class DownPointer {
 public:
@@ -66,7 +71,6 @@ public:
     [[nodiscard]] TreeNode* down_node(size_t);
     [[nodiscard]] bool is_leaf() const { return m_is_leaf; }
 
-    [[nodiscard]] size_t max_keys_in_node();
     Key const& operator[](size_t) const;
     bool insert(Key const&);
     bool update_key_pointer(Key const&);
@@ -83,6 +87,10 @@ private:
     void split();
     void list_node(int);
 
+    static void serialize_packed(ByteBuffer&, TupleDescriptor const&, Span<Key const> entries, Span<u32 const> down, bool is_leaf);
+    static size_t packed_entry_size(TupleDescriptor const&, ReadonlyBytes previous_key, ReadonlyBytes key, bool is_leaf);
+    static size_t packed_node_overhead(bool is_leaf) { return is_leaf ? sizeof(u32) : 2 * sizeof(u32); }
+
     BTree& m_tree;
     TreeNode* m_up;
     Vector<Key> m_entries;
@@ -101,6 +109,11 @@ public:
 
     u32 root() const { return (m_root) ? m_root->pointer() : 0; }
     bool insert(Key const&);
+
+    // Builds the tree bottom-up from keys that are in sort order, packing as many of them into every node as fit.
+    // This only works on an empty tree, and is much faster than inserting the keys one by one.
+    bool bulk_load(Vector<Key> const&);
+
     bool update_key_pointer(Key const&);
     Optional<u32> get(Key&);
     BTreeIterator find(Key const& key);
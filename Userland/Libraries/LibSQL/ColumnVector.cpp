@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibSQL/ColumnVector.h>
+
+namespace SQL {
+
+static Variant<Vector<int>, Vector<double>, Vector<String>> make_storage(SQLType type, size_t size)
+{
+    switch (type) {
+    case SQLType::Integer: {
+        Vector<int> integers;
+        integers.resize(size);
+        return integers;
+    }
+    case SQLType::Float: {
+        Vector<double> floats;
+        floats.resize(size);
+        return floats;
+    }
+    case SQLType::Text: {
+        Vector<String> strings;
+        strings.resize(size);
+        return strings;
+    }
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+ColumnVector::ColumnVector(SQLType type, size_t size)
+    : m_type(type)
+    , m_data(make_storage(type, size))
+{
+    m_nulls.resize(size);
+}
+
+ColumnVector ColumnVector::from_value(Value const& value, size_t size)
+{
+    ColumnVector vector(value.type(), size);
+    for (size_t ix = 0; ix < size; ++ix)
+        vector.set_value(ix, value);
+    return vector;
+}
+
+double ColumnVector::to_double(size_t ix) const
+{
+    switch (m_type) {
+    case SQLType::Integer:
+        return integers()[ix];
+    case SQLType::Float:
+        return floats()[ix];
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+bool ColumnVector::is_true(size_t ix) const
+{
+    if (m_nulls[ix])
+        return false;
+    switch (m_type) {
+    case SQLType::Integer:
+        return integers()[ix] != 0;
+    case SQLType::Float:
+        return floats()[ix] != 0.0;
+    case SQLType::Text: {
+        // Like in SQLite, text is true if it starts with a non-zero number.
+        char* end_pointer;
+        return strtod(strings()[ix].characters(), &end_pointer) != 0.0;
+    }
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+ColumnVector ColumnVector::to_floats() const
+{
+    if (m_type != SQLType::Integer)
+        return *this;
+    ColumnVector result(SQLType::Float, size());
+    auto& from = integers();
+    auto& to = result.floats();
+    for (size_t ix = 0; ix < size(); ++ix)
+        to[ix] = from[ix];
+    result.m_nulls = m_nulls;
+    return result;
+}
+
+Value ColumnVector::value(size_t ix) const
+{
+    Value value(m_type);
+    if (m_nulls[ix])
+        return value;
+    switch (m_type) {
+    case SQLType::Integer:
+        value = integers()[ix];
+        break;
+    case SQLType::Float:
+        value = floats()[ix];
+        break;
+    case SQLType::Text:
+        value = strings()[ix];
+        break;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+    return value;
+}
+
+void ColumnVector::set_value(size_t ix, Value const& value)
+{
+    m_nulls[ix] = value.is_null();
+    if (value.is_null())
+        return;
+    switch (m_type) {
+    case SQLType::Integer:
+        integers()[ix] = value.to_int().value();
+        break;
+    case SQLType::Float:
+        floats()[ix] = value.to_double().value();
+        break;
+    case SQLType::Text:
+        strings()[ix] = value.to_string().value();
+        break;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/String.h>
+#include <AK/Variant.h>
+#include <AK/Vector.h>
+#include <LibSQL/Type.h>
+#include <LibSQL/Value.h>
+
+namespace SQL {
+
+/**
+ * A ColumnVector holds one value of the same type for every row of a batch.
+ * Expressions are evaluated over whole ColumnVectors at once, so that the
+ * work per row is a tight loop over a plain array instead of a walk over the
+ * expression tree and a Value per row.
+ */
+class ColumnVector {
+public:
+    ColumnVector(SQLType, size_t size);
+
+    static ColumnVector from_value(Value const&, size_t size);
+
+    [[nodiscard]] SQLType type() const { return m_type; }
+    [[nodiscard]] size_t size() const { return m_nulls.size(); }
+    [[nodiscard]] bool is_numeric() const { return m_type != SQLType::Text; }
+
+    [[nodiscard]] bool is_null(size_t ix) const { return m_nulls[ix]; }
+    void set_null(size_t ix) { m_nulls[ix] = true; }
+
+    [[nodiscard]] Vector<int>& integers() { return m_data.get<Vector<int>>(); }
+    [[nodiscard]] Vector<int> const& integers() const { return m_data.get<Vector<int>>(); }
+    [[nodiscard]] Vector<double>& floats() { return m_data.get<Vector<double>>(); }
+    [[nodiscard]] Vector<double> const& floats() const { return m_data.get<Vector<double>>(); }
+    [[nodiscard]] Vector<String>& strings() { return m_data.get<Vector<String>>(); }
+    [[nodiscard]] Vector<String> const& strings() const { return m_data.get<Vector<String>>(); }
+
+    [[nodiscard]] double to_double(size_t ix) const;
+    [[nodiscard]] bool is_true(size_t ix) const;
+
+    // Copies the vector into one of type Float, if it holds integers.
+    [[nodiscard]] ColumnVector to_floats() const;
+
+    [[nodiscard]] Value value(size_t ix) const;
+    void set_value(size_t ix, Value const&);
+
+private:
+    SQLType m_type;
+    Variant<Vector<int>, Vector<double>, Vector<String>> m_data;
+    Vector<bool> m_nulls;
+};
+
+}
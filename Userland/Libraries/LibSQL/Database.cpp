@@ -120,6 +120,28 @@ Vector<Row> Database::select_all(TableDef const& table)
     return ret;
 }
 
+// Reads the rows of the table batch_size at a time, so that they don't all have to be in memory at once, and hands
+// every batch to the callback until it returns IterationDecision::Break.
+void Database::scan(TableDef const& table, size_t batch_size, Function<IterationDecision(Span<Row const>)> callback)
+{
+    VERIFY(m_table_cache.get(table.key().hash()).has_value());
+    VERIFY(batch_size > 0);
+    Vector<Row> batch;
+    batch.ensure_capacity(batch_size);
+    for (auto pointer = table.pointer(); pointer;) {
+        auto buffer_or_error = m_heap->read_block(pointer);
+        if (buffer_or_error.is_error())
+            VERIFY_NOT_REACHED();
+        batch.empend(table, pointer, buffer_or_error.value());
+        pointer = batch.last().next_pointer();
+        if (batch.size() == batch_size || !pointer) {
+            if (callback(batch.span()) == IterationDecision::Break)
+                return;
+            batch.clear_with_capacity();
+        }
+    }
+}
+
 Vector<Row> Database::match(TableDef const& table, Key const& key)
 {
     VERIFY(m_table_cache.get(table.key().hash()).has_value());
@@ -160,7 +182,7 @@ bool Database::update(Row& tuple)
     VERIFY(m_table_cache.get(tuple.table()->key().hash()).has_value());
     ByteBuffer buffer;
     tuple.serialize(buffer);
-    m_heap->add_to_wal(tuple.pointer(), buffer);
+    m_heap->write_block(tuple.pointer(), buffer);
 
     // TODO update indexes defined on table.
     return true;
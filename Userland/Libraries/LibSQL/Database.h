@@ -6,7 +6,10 @@
 
 #pragma once
 
+#include <AK/Function.h>
+#include <AK/IterationDecision.h>
 #include <AK/RefPtr.h>
+#include <AK/Span.h>
 #include <AK/String.h>
 #include <LibCore/Object.h>
 #include <LibSQL/Forward.h>
@@ -27,6 +30,7 @@ public:
     ~Database() override = default;
 
     void commit() { m_heap->flush(); }
+    void commit(Function<void(bool)> on_durable) { m_heap->commit(move(on_durable)); }
 
     void add_schema(SchemaDef const&);
     static Key get_schema_key(String const&);
@@ -37,6 +41,7 @@ public:
     RefPtr<TableDef> get_table(String const&, String const&);
 
     Vector<Row> select_all(TableDef const&);
+    void scan(TableDef const&, size_t batch_size, Function<IterationDecision(Span<Row const>)>);
     Vector<Row> match(TableDef const&, Key const&);
     bool insert(Row&);
     bool update(Row&);
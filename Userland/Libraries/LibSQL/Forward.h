@@ -10,6 +10,7 @@ namespace SQL {
 class BTree;
 class BTreeIterator;
 class ColumnDef;
+class ColumnVector;
 class Database;
 class HashBucket;
 class HashDirectoryNode;
@@ -29,6 +30,7 @@ class Tuple;
 class TupleDescriptor;
 struct TupleElement;
 class Value;
+class WriteAheadLog;
 }
 
 namespace SQL::AST {
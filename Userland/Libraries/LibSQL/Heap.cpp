@@ -10,8 +10,10 @@
 #include <LibCore/IODevice.h>
 #include <LibSQL/Heap.h>
 #include <LibSQL/Serialize.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 namespace SQL {
 
@@ -37,67 +39,212 @@ Heap::Heap(String file_name)
         VERIFY_NOT_REACHED();
     }
     m_file = file_or_error.value();
-    if (file_size > 0)
+
+    // Whatever was committed to the log but not yet checkpointed is part of the Heap as well.
+    m_wal = make<WriteAheadLog>(String::formatted("{}-wal", name()));
+    if (!m_wal->is_empty()) {
+        m_next_block = max(m_next_block, m_wal->committed_block_count());
+        m_end_of_file = max(m_end_of_file, m_wal->highest_block() + 1);
+    }
+
+    if (file_size > 0 || !m_wal->is_empty())
         read_zero_block();
     else
         initialize_zero_block();
+
+    // The zero block is rewritten whenever one of the roots changes, so keep it around.
+    if (!pin_block(0))
+        VERIFY_NOT_REACHED();
+}
+
+Heap::~Heap()
+{
+    // Whoever is waiting for a commit is going away with us, but the commit itself still gets synced.
+    m_pending_commits.clear();
+    flush();
+    if (checkpoint())
+        unlink(m_wal->file_name().characters());
 }
 
 Result<ByteBuffer, String> Heap::read_block(u32 block)
 {
-    auto buffer_or_empty = m_write_ahead_log.get(block);
-    if (buffer_or_empty.has_value())
-        return buffer_or_empty.value();
+    auto page_or_error = fetch_page(block);
+    if (page_or_error.is_error())
+        return page_or_error.error();
+    return page_or_error.value()->buffer;
+}
+
+bool Heap::write_block(u32 block, ByteBuffer const& buffer)
+{
+    VERIFY(block < m_next_block);
+    VERIFY(buffer.size() <= BLOCKSIZE);
+    dbgln_if(SQL_DEBUG, "Write heap block {} size {}", block, buffer.size());
+    auto* page = find_page(block);
+    if (!page)
+        page = &allocate_page(block);
+    page->buffer = buffer;
+    page->dirty = true;
+    page->referenced = true;
+    return true;
+}
+
+bool Heap::pin_block(u32 block)
+{
+    auto page_or_error = fetch_page(block);
+    if (page_or_error.is_error())
+        return false;
+    page_or_error.value()->pin_count++;
+    return true;
+}
+
+void Heap::unpin_block(u32 block)
+{
+    auto* page = find_page(block);
+    VERIFY(page && page->pin_count > 0);
+    page->pin_count--;
+}
+
+void Heap::set_cache_capacity(size_t capacity)
+{
+    VERIFY(capacity > 0);
+    m_cache_capacity = capacity;
+    while (m_pages.size() > m_cache_capacity) {
+        auto victim = find_victim();
+        if (!victim.has_value())
+            break;
+        auto& page = m_pages[victim.value()];
+        if (!write_back(page))
+            VERIFY_NOT_REACHED();
+        m_page_index.remove(page.block);
+
+        // Fill the hole with the last page, so that the pages stay contiguous.
+        auto last_index = m_pages.size() - 1;
+        if (victim.value() != last_index) {
+            m_pages[victim.value()] = m_pages.take_last();
+            m_page_index.set(m_pages[victim.value()].block, victim.value());
+        } else {
+            m_pages.take_last();
+        }
+        m_clock_hand = 0;
+    }
+}
+
+Heap::Page* Heap::find_page(u32 block)
+{
+    auto index = m_page_index.get(block);
+    if (!index.has_value())
+        return nullptr;
+    return &m_pages[index.value()];
+}
+
+Result<Heap::Page*, String> Heap::fetch_page(u32 block)
+{
+    if (auto* page = find_page(block); page) {
+        page->referenced = true;
+        return page;
+    }
 
     VERIFY(block < m_next_block);
+    ByteBuffer buffer;
+    if (auto buffer_or_empty = m_wal->read_page(block); buffer_or_empty.has_value()) {
+        buffer = buffer_or_empty.release_value();
+    } else {
+        auto buffer_or_error = read_block_from_file(block);
+        if (buffer_or_error.is_error())
+            return buffer_or_error.error();
+        buffer = buffer_or_error.release_value();
+    }
+    auto& page = allocate_page(block);
+    page.buffer = move(buffer);
+    page.referenced = true;
+    return &page;
+}
+
+Heap::Page& Heap::allocate_page(u32 block)
+{
+    VERIFY(!m_page_index.contains(block));
+    size_t index = m_pages.size();
+    Optional<size_t> victim;
+    if (m_pages.size() >= m_cache_capacity)
+        victim = find_victim();
+    if (victim.has_value()) {
+        index = victim.value();
+        auto& page = m_pages[index];
+        if (!write_back(page))
+            VERIFY_NOT_REACHED();
+        m_page_index.remove(page.block);
+        page = {};
+    } else {
+        // Either the cache hasn't filled up yet, or every page in it is pinned. In the latter case the cache is
+        // allowed to grow past its capacity rather than failing.
+        m_pages.append({});
+    }
+    auto& page = m_pages[index];
+    page.block = block;
+    m_page_index.set(block, index);
+    return page;
+}
+
+Optional<size_t> Heap::find_victim()
+{
+    // Sweep the clock hand over the pages, giving each page that was accessed since the last sweep a second chance.
+    // After two full turns every unpinned page has had its reference bit cleared, so if none was found, all are pinned.
+    for (size_t step = 0; step < 2 * m_pages.size(); ++step) {
+        auto index = m_clock_hand;
+        m_clock_hand = (m_clock_hand + 1) % m_pages.size();
+        auto& page = m_pages[index];
+        if (page.pin_count > 0)
+            continue;
+        if (page.referenced) {
+            page.referenced = false;
+            continue;
+        }
+        return index;
+    }
+    return {};
+}
+
+bool Heap::write_back(Page& page)
+{
+    if (!page.dirty)
+        return true;
+    dbgln_if(SQL_DEBUG, "Writing back block {} to {}", page.block, m_wal->file_name());
+    if (!m_wal->append_page(page.block, page.buffer))
+        return false;
+    page.dirty = false;
+    return true;
+}
+
+Result<ByteBuffer, String> Heap::read_block_from_file(u32 block)
+{
     dbgln_if(SQL_DEBUG, "Read heap block {}", block);
-    if (!seek_block(block))
-        VERIFY_NOT_REACHED();
-    auto ret = m_file->read(BLOCKSIZE);
-    if (ret.is_empty())
+    if (block >= m_end_of_file) {
+        warnln("Reading block {} of file {} which is beyond the end of the file", block, name());
+        return String("Could not read block");
+    }
+    auto buffer = ByteBuffer::create_uninitialized(BLOCKSIZE);
+    auto nread = pread(m_file->fd(), buffer.data(), BLOCKSIZE, static_cast<off_t>(block) * BLOCKSIZE);
+    if (nread != BLOCKSIZE)
         return String("Could not read block");
-    return ret;
+    return buffer;
 }
 
-bool Heap::write_block(u32 block, ByteBuffer& buffer)
+bool Heap::write_block_to_file(u32 block, ByteBuffer& buffer)
 {
-    VERIFY(block < m_next_block);
-    if (!seek_block(block))
-        VERIFY_NOT_REACHED();
-    dbgln_if(SQL_DEBUG, "Write heap block {} size {}", block, buffer.size());
     VERIFY(buffer.size() <= BLOCKSIZE);
     auto sz = buffer.size();
     if (sz < BLOCKSIZE) {
         buffer.resize(BLOCKSIZE);
         memset(buffer.offset_pointer((int)sz), 0, BLOCKSIZE - sz);
     }
-    if (m_file->write(buffer.data(), (int)buffer.size())) {
-        if (block == m_end_of_file)
-            m_end_of_file++;
-        return true;
-    }
-    return false;
-}
-
-bool Heap::seek_block(u32 block)
-{
-    if (block == m_end_of_file) {
-        off_t pos;
-        if (!m_file->seek(0, Core::SeekMode::FromEndPosition, &pos)) {
-            warnln("Could not seek block {} from file {}, which is at the end of the file", block, name());
-            warnln("FD: {} Position: {} error: {}", m_file->fd(), pos, m_file->error_string());
-            return false;
-        }
-    } else if (block > m_end_of_file) {
-        warnln("Seeking block {} of file {} which is beyond the end of the file", block, name());
+    // Blocks that are written back out of order leave a hole in the file, which reads back as zeros.
+    auto nwritten = pwrite(m_file->fd(), buffer.data(), BLOCKSIZE, static_cast<off_t>(block) * BLOCKSIZE);
+    if (nwritten != BLOCKSIZE) {
+        warnln("Could not write block {} of file {}: {}", block, name(), strerror(errno));
         return false;
-    } else {
-        if (!m_file->seek(block * BLOCKSIZE)) {
-            warnln("Could not seek block {} of file {}. The current size is {} blocks",
-                block, name(), m_end_of_file);
-            return false;
-        }
     }
+    if (block >= m_end_of_file)
+        m_end_of_file = block + 1;
     return true;
 }
 
@@ -120,20 +267,88 @@ u32 Heap::new_record_pointer()
 
 void Heap::flush()
 {
-    Vector<u32> blocks;
-    for (auto& wal_entry : m_write_ahead_log) {
-        blocks.append(wal_entry.key);
+    commit_dirty_pages();
+    sync_pending_commits();
+}
+
+void Heap::commit(Function<void(bool)> on_durable)
+{
+    commit_dirty_pages();
+    m_pending_commits.append(move(on_durable));
+    if (m_sync_scheduled)
+        return;
+    m_sync_scheduled = true;
+    deferred_invoke([this](auto&) {
+        sync_pending_commits();
+    });
+}
+
+void Heap::commit_dirty_pages()
+{
+    // Append the dirty pages in block order, so that a checkpoint mostly extends the file sequentially.
+    Vector<size_t> dirty_pages;
+    for (size_t index = 0; index < m_pages.size(); ++index) {
+        if (m_pages[index].dirty)
+            dirty_pages.append(index);
+    }
+    quick_sort(dirty_pages, [&](auto a, auto b) { return m_pages[a].block < m_pages[b].block; });
+    for (auto index : dirty_pages) {
+        dbgln_if(SQL_DEBUG, "Committing block {} to {}", m_pages[index].block, m_wal->file_name());
+        if (!write_back(m_pages[index]))
+            m_commit_failed = true;
     }
+
+    if (!m_wal->has_uncommitted_frames())
+        return;
+    if (!m_wal->append_commit(m_next_block))
+        m_commit_failed = true;
+    m_needs_sync = true;
+}
+
+void Heap::sync_pending_commits()
+{
+    m_sync_scheduled = false;
+    if (m_needs_sync) {
+        m_needs_sync = false;
+        if (!m_wal->sync())
+            m_commit_failed = true;
+    }
+    auto success = !m_commit_failed;
+    m_commit_failed = false;
+
+    auto pending_commits = move(m_pending_commits);
+    for (auto& on_durable : pending_commits)
+        on_durable(success);
+
+    if (success && m_wal->frame_count() >= checkpoint_threshold)
+        checkpoint();
+}
+
+bool Heap::checkpoint()
+{
+    // Only committed blocks may end up in the Heap's file.
+    if (m_wal->has_uncommitted_frames())
+        return false;
+    if (m_wal->is_empty())
+        return true;
+
+    dbgln_if(SQL_DEBUG, "Checkpointing {} blocks from {} into {}", m_wal->page_offsets().size(), m_wal->file_name(), name());
+    Vector<u32> blocks;
+    for (auto& it : m_wal->page_offsets())
+        blocks.append(it.key);
     quick_sort(blocks);
-    for (auto& block : blocks) {
-        auto buffer_or_empty = m_write_ahead_log.get(block);
-        if (buffer_or_empty->is_empty()) {
-            VERIFY_NOT_REACHED();
-        }
-        dbgln_if(SQL_DEBUG, "Flushing block {} to {}", block, name());
-        write_block(block, buffer_or_empty.value());
+    for (auto block : blocks) {
+        auto buffer = m_wal->read_page(block);
+        if (!buffer.has_value() || !write_block_to_file(block, buffer.value()))
+            return false;
+    }
+
+    // The log may only be emptied once the blocks copied from it can't get lost anymore.
+    if (fsync(m_file->fd()) != 0) {
+        warnln("Could not sync {}: {}", name(), strerror(errno));
+        return false;
     }
-    m_write_ahead_log.clear();
+    return m_wal->reset();
 }
 
 constexpr static const char* FILE_ID = "SerenitySQL ";
@@ -199,7 +414,7 @@ void Heap::update_zero_block()
     buffer.overwrite(FREE_LIST_OFFSET, &m_free_list, sizeof(u32));
     buffer.overwrite(USER_VALUES_OFFSET, m_user_values.data(), m_user_values.size() * sizeof(u32));
 
-    add_to_wal(0, buffer);
+    write_block(0, buffer);
 }
 
 void Heap::initialize_zero_block()
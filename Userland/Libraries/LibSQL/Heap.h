@@ -7,13 +7,16 @@
 #pragma once
 
 #include <AK/Debug.h>
+#include <AK/Function.h>
 #include <AK/HashMap.h>
+#include <AK/OwnPtr.h>
 #include <AK/String.h>
 #include <AK/Vector.h>
 #include <LibCore/File.h>
 #include <LibCore/Object.h>
 #include <LibSQL/Meta.h>
 #include <LibSQL/Serialize.h>
+#include <LibSQL/WriteAheadLog.h>
 
 namespace SQL {
 
@@ -29,17 +32,32 @@ constexpr static u32 BLOCKSIZE = 1024;
  * assumed that a single SQL database is backed by a single Heap.
  *
  * Currently only B-Trees and tuple stores are implemented.
+ *
+ * Blocks are accessed through a bounded cache of pages. Writes only dirty the
+ * cached page. Eviction uses the CLOCK algorithm, which approximates LRU
+ * without having to reorder a list on every access, and never picks a page
+ * that is pinned.
+ *
+ * Dirty pages never go straight to the Heap's file. Committing appends them
+ * to the WriteAheadLog, followed by a commit frame, and dirty pages that are
+ * evicted before that are appended without one. Once the log has grown past
+ * checkpoint_threshold frames, and when the Heap is closed, the latest
+ * version of every block in it is copied into the Heap's file and the log is
+ * emptied.
  */
 class Heap : public Core::Object {
     C_OBJECT(Heap);
 
 public:
+    static constexpr size_t default_cache_capacity = 512;
+    static constexpr size_t checkpoint_threshold = 1000;
+
     explicit Heap(String);
-    virtual ~Heap() override { flush(); }
+    virtual ~Heap() override;
 
     u32 size() const { return m_end_of_file; }
     Result<ByteBuffer, String> read_block(u32);
-    bool write_block(u32, ByteBuffer&);
+    bool write_block(u32, ByteBuffer const&);
     u32 new_record_pointer();
     [[nodiscard]] bool has_block(u32 block) const { return block < size(); }
 
@@ -81,11 +99,42 @@ public:
         update_zero_block();
     }
 
-    void add_to_wal(u32 block, ByteBuffer& buffer) { m_write_ahead_log.set(block, buffer); }
+    // Pinned blocks stay in the cache until they have been unpinned as many times as they were pinned.
+    bool pin_block(u32);
+    void unpin_block(u32);
+
+    size_t cache_capacity() const { return m_cache_capacity; }
+    void set_cache_capacity(size_t);
+    size_t cached_page_count() const { return m_page_index.size(); }
+
+    // Commits the dirty pages and waits for them to be on disk.
     void flush();
 
+    // Commits the dirty pages and calls on_durable once they are on disk. The log is synced from the event loop, so
+    // that all the commits made until then share a single fsync().
+    void commit(Function<void(bool)> on_durable);
+
+    bool checkpoint();
+    WriteAheadLog const& write_ahead_log() const { return *m_wal; }
+
 private:
-    bool seek_block(u32);
+    struct Page {
+        ByteBuffer buffer;
+        u32 block { 0 };
+        u32 pin_count { 0 };
+        bool dirty { false };
+        bool referenced { false };
+    };
+
+    Page* find_page(u32);
+    Result<Page*, String> fetch_page(u32);
+    Page& allocate_page(u32);
+    Optional<size_t> find_victim();
+    bool write_back(Page&);
+    void commit_dirty_pages();
+    void sync_pending_commits();
+    Result<ByteBuffer, String> read_block_from_file(u32);
+    bool write_block_to_file(u32, ByteBuffer&);
     void read_zero_block();
     void initialize_zero_block();
     void update_zero_block();
@@ -99,7 +148,17 @@ private:
     u32 m_table_columns_root { 0 };
     u32 m_version { 0x00000001 };
     Array<u32, 16> m_user_values;
-    HashMap<u32, ByteBuffer> m_write_ahead_log;
+
+    Vector<Page> m_pages;
+    HashMap<u32, size_t> m_page_index;
+    size_t m_clock_hand { 0 };
+    size_t m_cache_capacity { default_cache_capacity };
+
+    OwnPtr<WriteAheadLog> m_wal;
+    Vector<Function<void(bool)>> m_pending_commits;
+    bool m_needs_sync { false };
+    bool m_sync_scheduled { false };
+    bool m_commit_failed { false };
 };
 
 }
@@ -40,7 +40,13 @@ void Index::add_to_write_ahead_log(IndexNode* node)
     VERIFY(node->pointer());
     ByteBuffer buffer;
     node->serialize(buffer);
-    m_heap.add_to_wal(node->pointer(), buffer);
+    m_heap.write_block(node->pointer(), buffer);
+}
+
+void Index::add_to_write_ahead_log(u32 pointer, ByteBuffer const& buffer)
+{
+    VERIFY(pointer);
+    m_heap.write_block(pointer, buffer);
 }
 
 }
@@ -52,6 +52,7 @@ protected:
     u32 new_record_pointer() { return m_heap.new_record_pointer(); }
     ByteBuffer read_block(u32);
     void add_to_write_ahead_log(IndexNode*);
+    void add_to_write_ahead_log(u32 pointer, ByteBuffer const&);
 
 private:
     Heap& m_heap;
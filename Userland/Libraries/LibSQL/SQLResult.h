@@ -50,8 +50,12 @@ constexpr char const* command_tag(SQLCommand command)
     S(SchemaExists, "Schema '{}' already exist")                  \
     S(TableDoesNotExist, "Table '{}' does not exist")             \
     S(TableExists, "Table '{}' already exist")                    \
+    S(ColumnDoesNotExist, "Column '{}' does not exist")           \
     S(InvalidType, "Invalid type '{}'")                           \
-    S(InvalidDatabaseName, "Invalid database name '{}'")
+    S(InvalidDatabaseName, "Invalid database name '{}'")          \
+    S(InvalidNumberOfValues, "Number of values does not match")   \
+    S(NotYetImplemented, "'{}' is not yet implemented")           \
+    S(CommitFailed, "Could not commit to database '{}'")
 
 enum class SQLErrorCode {
 #undef __ENUMERATE_SQL_ERROR
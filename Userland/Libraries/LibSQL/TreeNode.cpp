@@ -13,6 +13,42 @@
 
 namespace SQL {
 
+// Set in the key count of nodes stored in the prefix-compressed format, which
+// is the only one that is written. Nodes without it store every key in full.
+constexpr static u32 PACKED_NODE = 0x80000000;
+constexpr static u32 PACKED_LEAF_NODE = 0x40000000;
+constexpr static u32 PACKED_NODE_FLAGS = PACKED_NODE | PACKED_LEAF_NODE;
+
+// The length of the values in a serialized key, which follow its u32 pointer.
+static size_t key_values_length(TupleDescriptor const& descriptor)
+{
+    return descriptor.data_length() - sizeof(u32);
+}
+
+// Prefix and suffix lengths are stored as a single byte when keys are short enough.
+static size_t packed_length_size(size_t values_length)
+{
+    return values_length <= NumericLimits<u8>::max() ? sizeof(u8) : sizeof(u16);
+}
+
+struct PackedKeyExtent {
+    size_t prefix;
+    size_t suffix;
+};
+
+// The number of leading bytes key shares with previous_key, and the number of bytes after those up to the trailing
+// zeros in key.
+static PackedKeyExtent packed_key_extent(ReadonlyBytes previous_key, ReadonlyBytes key)
+{
+    size_t prefix = 0;
+    while (prefix < previous_key.size() && prefix < key.size() && previous_key[prefix] == key[prefix])
+        prefix++;
+    auto end = key.size();
+    while (end > prefix && key[end - 1] == 0)
+        end--;
+    return { prefix, end - prefix };
+}
+
 DownPointer::DownPointer(TreeNode* owner, u32 pointer)
     : m_owner(owner)
     , m_pointer(pointer)
@@ -112,25 +148,69 @@ TreeNode::TreeNode(BTree& tree, TreeNode* up, u32 pointer, ByteBuffer& buffer, s
 {
     u32 nodes;
     deserialize_from<u32>(buffer, at_offset, nodes);
-    dbgln_if(SQL_DEBUG, "Deserializing node. Size {}", nodes);
-    if (nodes > 0) {
-        for (u32 i = 0; i < nodes; i++) {
-            u32 left;
-            deserialize_from<u32>(buffer, at_offset, left);
-            dbgln_if(SQL_DEBUG, "Down[{}] {}", i, left);
-            if (!m_down.is_empty())
-                VERIFY((left == 0) == m_is_leaf);
-            else
-                m_is_leaf = (left == 0);
-            m_entries.append(Key(m_tree.descriptor(), buffer, at_offset));
-            m_down.empend(this, left);
+    dbgln_if(SQL_DEBUG, "Deserializing node. Size {}", nodes & ~PACKED_NODE_FLAGS);
+    if ((nodes & PACKED_NODE) == 0) {
+        if (nodes > 0) {
+            for (u32 i = 0; i < nodes; i++) {
+                u32 left;
+                deserialize_from<u32>(buffer, at_offset, left);
+                dbgln_if(SQL_DEBUG, "Down[{}] {}", i, left);
+                if (!m_down.is_empty())
+                    VERIFY((left == 0) == m_is_leaf);
+                else
+                    m_is_leaf = (left == 0);
+                m_entries.append(Key(m_tree.descriptor(), buffer, at_offset));
+                m_down.empend(this, left);
+            }
+            u32 right;
+            deserialize_from<u32>(buffer, at_offset, right);
+            dbgln_if(SQL_DEBUG, "Right {}", right);
+            VERIFY((right == 0) == m_is_leaf);
+            m_down.empend(this, right);
         }
-        u32 right;
-        deserialize_from<u32>(buffer, at_offset, right);
-        dbgln_if(SQL_DEBUG, "Right {}", right);
-        VERIFY((right == 0) == m_is_leaf);
-        m_down.empend(this, right);
+        return;
+    }
+
+    m_is_leaf = (nodes & PACKED_LEAF_NODE) != 0;
+    nodes &= ~PACKED_NODE_FLAGS;
+    auto values_length = key_values_length(m_tree.descriptor());
+    auto length_size = packed_length_size(values_length);
+    auto read_length = [&]() -> size_t {
+        if (length_size == sizeof(u8)) {
+            u8 length;
+            deserialize_from<u8>(buffer, at_offset, length);
+            return length;
+        }
+        u16 length;
+        deserialize_from<u16>(buffer, at_offset, length);
+        return length;
+    };
+
+    // The key being rebuilt: its pointer, followed by its values. The prefix it shares with the previous key is
+    // still in place.
+    auto key_buffer = ByteBuffer::create_zeroed(sizeof(u32) + values_length);
+    for (u32 i = 0; i < nodes; i++) {
+        u32 left = 0;
+        if (!m_is_leaf)
+            deserialize_from<u32>(buffer, at_offset, left);
+        u32 key_pointer;
+        deserialize_from<u32>(buffer, at_offset, key_pointer);
+        auto prefix = read_length();
+        auto suffix = read_length();
+        VERIFY(prefix + suffix <= values_length);
+        key_buffer.overwrite(0, &key_pointer, sizeof(u32));
+        key_buffer.overwrite(sizeof(u32) + prefix, buffer.offset_pointer(at_offset), suffix);
+        at_offset += suffix;
+        memset(key_buffer.offset_pointer(sizeof(u32) + prefix + suffix), 0, values_length - prefix - suffix);
+
+        size_t key_offset = 0;
+        m_entries.append(Key(m_tree.descriptor(), key_buffer, key_offset));
+        m_down.empend(this, left);
     }
+    u32 right = 0;
+    if (!m_is_leaf)
+        deserialize_from<u32>(buffer, at_offset, right);
+    m_down.empend(this, right);
 }
 
 bool TreeNode::insert(Key const& key)
@@ -179,16 +259,6 @@ bool TreeNode::insert_in_leaf(Key const& key)
     return true;
 }
 
-size_t TreeNode::max_keys_in_node()
-{
-    auto descriptor = m_tree.descriptor();
-    auto key_size = descriptor.data_length() + sizeof(u32);
-    auto ret = (BLOCKSIZE - 2 * sizeof(u32)) / key_size;
-    if ((ret % 2) == 0)
-        --ret;
-    return ret;
-}
-
 Key const& TreeNode::operator[](size_t ix) const
 {
     VERIFY(ix < size());
@@ -265,18 +335,61 @@ Optional<u32> TreeNode::get(Key& key)
 
 void TreeNode::serialize(ByteBuffer& buffer) const
 {
-    u32 sz = size();
-    serialize_to<u32>(buffer, sz);
-    if (sz > 0) {
-        for (auto ix = 0u; ix < size(); ix++) {
-            auto& entry = m_entries[ix];
-            dbgln_if(SQL_DEBUG, "Serializing Left[{}] = {}", ix, m_down[ix].pointer());
-            serialize_to<u32>(buffer, is_leaf() ? 0u : m_down[ix].pointer());
-            entry.serialize(buffer);
-        }
-        dbgln_if(SQL_DEBUG, "Serializing Right = {}", m_down[size()].pointer());
-        serialize_to<u32>(buffer, is_leaf() ? 0u : m_down[size()].pointer());
+    if (size() == 0) {
+        serialize_to<u32>(buffer, 0u);
+        return;
+    }
+    Vector<u32> down;
+    down.ensure_capacity(m_down.size());
+    for (auto& down_pointer : m_down)
+        down.append(is_leaf() ? 0u : down_pointer.pointer());
+    serialize_packed(buffer, m_tree.descriptor(), m_entries.span(), down.span(), is_leaf());
+}
+
+void TreeNode::serialize_packed(ByteBuffer& buffer, TupleDescriptor const& descriptor, Span<Key const> entries, Span<u32 const> down, bool is_leaf)
+{
+    VERIFY(down.size() == entries.size() + 1);
+    serialize_to<u32>(buffer, (u32)entries.size() | PACKED_NODE | (is_leaf ? PACKED_LEAF_NODE : 0));
+    auto values_length = key_values_length(descriptor);
+    auto length_size = packed_length_size(values_length);
+    auto write_length = [&](size_t length) {
+        if (length_size == sizeof(u8))
+            serialize_to<u8>(buffer, (u8)length);
+        else
+            serialize_to<u16>(buffer, (u16)length);
+    };
+
+    ByteBuffer previous_key;
+    ByteBuffer key;
+    for (auto ix = 0u; ix < entries.size(); ix++) {
+        dbgln_if(SQL_DEBUG, "Serializing Left[{}] = {}", ix, down[ix]);
+        if (!is_leaf)
+            serialize_to<u32>(buffer, down[ix]);
+        key.clear();
+        entries[ix].serialize(key);
+        VERIFY(key.size() <= sizeof(u32) + values_length);
+        buffer.append(key.data(), sizeof(u32));
+
+        auto values = key.bytes().slice(sizeof(u32));
+        auto [prefix, suffix] = packed_key_extent(previous_key.bytes().slice(min(previous_key.size(), sizeof(u32))), values);
+        write_length(prefix);
+        write_length(suffix);
+        buffer.append(values.slice(prefix, suffix));
+        swap(previous_key, key);
     }
+    dbgln_if(SQL_DEBUG, "Serializing Right = {}", down[entries.size()]);
+    if (!is_leaf)
+        serialize_to<u32>(buffer, down[entries.size()]);
+}
+
+size_t TreeNode::packed_entry_size(TupleDescriptor const& descriptor, ReadonlyBytes previous_key, ReadonlyBytes key, bool is_leaf)
+{
+    auto previous_values = previous_key.slice(min(previous_key.size(), sizeof(u32)));
+    auto [prefix, suffix] = packed_key_extent(previous_values, key.slice(sizeof(u32)));
+    auto size = sizeof(u32) + 2 * packed_length_size(key_values_length(descriptor)) + suffix;
+    if (!is_leaf)
+        size += sizeof(u32);
+    return size;
 }
 
 void TreeNode::just_insert(Key const& key, TreeNode* right)
@@ -284,48 +397,45 @@ void TreeNode::just_insert(Key const& key, TreeNode* right)
     dbgln_if(SQL_DEBUG, "[#{}] just_insert({}, right = {})",
         pointer(), (String)key, (right) ? right->pointer() : 0);
     dump_if(SQL_DEBUG, "Before");
-    for (auto ix = 0u; ix < size(); ix++) {
-        if (key < m_entries[ix]) {
-            m_entries.insert(ix, key);
-            VERIFY(is_leaf() == (right == nullptr));
-            m_down.insert(ix + 1, DownPointer(this, right));
-            if (size() > max_keys_in_node()) {
-                split();
-            } else {
-                dump_if(SQL_DEBUG, "To WAL");
-                tree().add_to_write_ahead_log(this);
-            }
-            return;
-        }
-    }
-    m_entries.append(key);
-    m_down.empend(this, right);
-
-    if (size() > max_keys_in_node()) {
+    VERIFY(is_leaf() == (right == nullptr));
+    size_t ix = 0;
+    while (ix < size() && !(key < m_entries[ix]))
+        ix++;
+    m_entries.insert(ix, key);
+    m_down.insert(ix + 1, DownPointer(this, right));
+
+    ByteBuffer buffer;
+    serialize(buffer);
+    if (buffer.size() > BLOCKSIZE) {
         split();
     } else {
         dump_if(SQL_DEBUG, "To WAL");
-        tree().add_to_write_ahead_log(this);
+        tree().add_to_write_ahead_log(pointer(), buffer);
     }
 }
 
 void TreeNode::split()
 {
     dump_if(SQL_DEBUG, "Splitting node");
+    VERIFY(size() >= 3);
     if (!m_up)
         // Make new m_up. This is the new root node.
         m_up = m_tree.new_root();
 
+    // The median key moves one level up. The keys after it move to a new
+    // node to the right of this one.
+    auto median_index = (size() - 1) / 2;
+
     // Take the left pointer for the new node:
-    DownPointer left = m_down.take(max_keys_in_node() / 2 + 1);
+    DownPointer left = m_down.take(median_index + 1);
 
     // Create the new right node:
     auto* new_node = new TreeNode(tree(), m_up, left);
 
     // Move the rightmost keys from this node to the new right node:
-    while (m_entries.size() > max_keys_in_node() / 2 + 1) {
-        auto entry = m_entries.take(max_keys_in_node() / 2 + 1);
-        auto down = m_down.take(max_keys_in_node() / 2 + 1);
+    while (m_entries.size() > median_index + 1) {
+        auto entry = m_entries.take(median_index + 1);
+        auto down = m_down.take(median_index + 1);
 
         // Reparent to new right node:
         if (down.m_node != nullptr) {
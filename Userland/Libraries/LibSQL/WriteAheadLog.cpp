@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/Format.h>
+#include <LibCrypto/Checksum/CRC32.h>
+#include <LibSQL/Heap.h>
+#include <LibSQL/WriteAheadLog.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace SQL {
+
+constexpr static u32 FRAME_MAGIC = 0x4c415753; // "SWAL"
+constexpr static u32 PAGE_FRAME = 1;
+constexpr static u32 COMMIT_FRAME = 2;
+
+// Every frame starts with four u32s: the magic, the kind of frame, its value (the block number for a page frame, the
+// block count for a commit frame), and the CRC32 of the three before it and the block that follows in a page frame.
+constexpr static size_t FRAME_HEADER_SIZE = 4 * sizeof(u32);
+constexpr static size_t FRAME_CHECKSUMMED_HEADER_SIZE = 3 * sizeof(u32);
+
+static u32 frame_checksum(ReadonlyBytes header, ReadonlyBytes page)
+{
+    Crypto::Checksum::CRC32 crc { header.trim(FRAME_CHECKSUMMED_HEADER_SIZE) };
+    if (!page.is_empty())
+        crc.update(page);
+    return crc.digest();
+}
+
+static void write_frame_header(Bytes header, u32 kind, u32 value, ReadonlyBytes page)
+{
+    u32 fields[3] = { FRAME_MAGIC, kind, value };
+    memcpy(header.data(), fields, sizeof(fields));
+    u32 checksum = frame_checksum(header, page);
+    memcpy(header.offset(FRAME_CHECKSUMMED_HEADER_SIZE), &checksum, sizeof(u32));
+}
+
+WriteAheadLog::WriteAheadLog(String file_name)
+    : m_file_name(move(file_name))
+{
+    m_fd = open(m_file_name.characters(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (m_fd < 0) {
+        warnln("Couldn't open '{}': {}", m_file_name, strerror(errno));
+        VERIFY_NOT_REACHED();
+    }
+    recover();
+}
+
+WriteAheadLog::~WriteAheadLog()
+{
+    close(m_fd);
+}
+
+void WriteAheadLog::recover()
+{
+    struct stat stat_buffer;
+    if (fstat(m_fd, &stat_buffer) != 0) {
+        perror("fstat");
+        VERIFY_NOT_REACHED();
+    }
+    off_t file_size = stat_buffer.st_size;
+
+    // Pages are only taken over once the commit frame that follows them has been read.
+    HashMap<u32, off_t> uncommitted_offsets;
+    size_t uncommitted_frame_count = 0;
+    off_t offset = 0;
+    auto page = ByteBuffer::create_uninitialized(BLOCKSIZE);
+    while (offset + (off_t)FRAME_HEADER_SIZE <= file_size) {
+        u8 header[FRAME_HEADER_SIZE];
+        if (pread(m_fd, header, FRAME_HEADER_SIZE, offset) != FRAME_HEADER_SIZE)
+            break;
+        u32 fields[4];
+        memcpy(fields, header, sizeof(fields));
+        if (fields[0] != FRAME_MAGIC)
+            break;
+
+        ReadonlyBytes header_bytes { header, FRAME_HEADER_SIZE };
+        if (fields[1] == PAGE_FRAME) {
+            if (offset + (off_t)(FRAME_HEADER_SIZE + BLOCKSIZE) > file_size)
+                break;
+            if (pread(m_fd, page.data(), BLOCKSIZE, offset + FRAME_HEADER_SIZE) != BLOCKSIZE)
+                break;
+            if (frame_checksum(header_bytes, page) != fields[3])
+                break;
+            uncommitted_offsets.set(fields[2], offset + FRAME_HEADER_SIZE);
+            uncommitted_frame_count++;
+            offset += FRAME_HEADER_SIZE + BLOCKSIZE;
+        } else if (fields[1] == COMMIT_FRAME) {
+            if (frame_checksum(header_bytes, {}) != fields[3])
+                break;
+            offset += FRAME_HEADER_SIZE;
+            for (auto& it : uncommitted_offsets) {
+                m_page_offsets.set(it.key, it.value);
+                m_highest_block = max(m_highest_block, it.key);
+            }
+            uncommitted_offsets.clear();
+            m_frame_count += uncommitted_frame_count + 1;
+            uncommitted_frame_count = 0;
+            m_committed_block_count = fields[2];
+            m_committed_offset = offset;
+        } else {
+            break;
+        }
+    }
+
+    if (m_committed_offset != file_size) {
+        dbgln_if(SQL_DEBUG, "Discarding {} bytes after the last commit in {}", file_size - m_committed_offset, m_file_name);
+        if (ftruncate(m_fd, m_committed_offset) != 0) {
+            perror("ftruncate");
+            VERIFY_NOT_REACHED();
+        }
+    }
+    m_end_offset = m_committed_offset;
+    dbgln_if(SQL_DEBUG, "Recovered {} blocks from {}", m_page_offsets.size(), m_file_name);
+}
+
+Optional<ByteBuffer> WriteAheadLog::read_page(u32 block) const
+{
+    auto offset = m_page_offsets.get(block);
+    if (!offset.has_value())
+        return {};
+    auto buffer = ByteBuffer::create_uninitialized(BLOCKSIZE);
+    if (pread(m_fd, buffer.data(), BLOCKSIZE, offset.value()) != BLOCKSIZE) {
+        warnln("Could not read block {} from {}: {}", block, m_file_name, strerror(errno));
+        return {};
+    }
+    return buffer;
+}
+
+bool WriteAheadLog::append(ReadonlyBytes bytes)
+{
+    while (!bytes.is_empty()) {
+        auto nwritten = pwrite(m_fd, bytes.data(), bytes.size(), m_end_offset);
+        if (nwritten < 0) {
+            if (errno == EINTR)
+                continue;
+            warnln("Could not append to {}: {}", m_file_name, strerror(errno));
+            return false;
+        }
+        m_end_offset += nwritten;
+        bytes = bytes.slice(nwritten);
+    }
+    return true;
+}
+
+bool WriteAheadLog::append_page(u32 block, ReadonlyBytes page)
+{
+    VERIFY(page.size() <= BLOCKSIZE);
+    u8 frame[FRAME_HEADER_SIZE + BLOCKSIZE] {};
+    memcpy(frame + FRAME_HEADER_SIZE, page.data(), page.size());
+    Bytes frame_bytes { frame, sizeof(frame) };
+    write_frame_header(frame_bytes, PAGE_FRAME, block, frame_bytes.slice(FRAME_HEADER_SIZE));
+
+    auto page_offset = m_end_offset + FRAME_HEADER_SIZE;
+    if (!append(frame_bytes))
+        return false;
+    m_page_offsets.set(block, page_offset);
+    m_highest_block = max(m_highest_block, block);
+    m_frame_count++;
+    return true;
+}
+
+bool WriteAheadLog::append_commit(u32 block_count)
+{
+    u8 frame[FRAME_HEADER_SIZE];
+    write_frame_header({ frame, FRAME_HEADER_SIZE }, COMMIT_FRAME, block_count, {});
+    if (!append({ frame, FRAME_HEADER_SIZE }))
+        return false;
+    m_frame_count++;
+    m_committed_offset = m_end_offset;
+    m_committed_block_count = block_count;
+    return true;
+}
+
+bool WriteAheadLog::sync()
+{
+    if (fsync(m_fd) != 0) {
+        warnln("Could not sync {}: {}", m_file_name, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool WriteAheadLog::reset()
+{
+    VERIFY(!has_uncommitted_frames());
+    if (ftruncate(m_fd, 0) != 0) {
+        warnln("Could not truncate {}: {}", m_file_name, strerror(errno));
+        return false;
+    }
+    m_end_offset = 0;
+    m_committed_offset = 0;
+    m_frame_count = 0;
+    m_committed_block_count = 0;
+    m_highest_block = 0;
+    m_page_offsets.clear();
+    return true;
+}
+
+}
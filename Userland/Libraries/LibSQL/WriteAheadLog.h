@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/HashMap.h>
+#include <AK/Noncopyable.h>
+#include <AK/Optional.h>
+#include <AK/String.h>
+#include <sys/types.h>
+
+namespace SQL {
+
+/**
+ * The WriteAheadLog is an append-only file next to a Heap's file, that
+ * holds the blocks changed since the Heap was last checkpointed.
+ *
+ * It is a sequence of frames. A page frame holds a new version of a block,
+ * and a commit frame marks all the frames before it as committed. Every
+ * frame carries a CRC32 of its contents, so that a frame that was only
+ * partially written when the system went down is recognized. When the log
+ * is opened, everything after the last intact commit frame is discarded.
+ *
+ * The log keeps the file offset of the latest version of every block it
+ * holds, so blocks can be read back from it until they are checkpointed
+ * into the Heap's file.
+ */
+class WriteAheadLog {
+    AK_MAKE_NONCOPYABLE(WriteAheadLog);
+    AK_MAKE_NONMOVABLE(WriteAheadLog);
+
+public:
+    explicit WriteAheadLog(String file_name);
+    ~WriteAheadLog();
+
+    String const& file_name() const { return m_file_name; }
+
+    // The number of blocks the Heap had when the last transaction in the log was committed, or 0 if it holds none.
+    u32 committed_block_count() const { return m_committed_block_count; }
+    u32 highest_block() const { return m_highest_block; }
+    size_t frame_count() const { return m_frame_count; }
+    bool is_empty() const { return m_end_offset == 0; }
+    bool has_uncommitted_frames() const { return m_end_offset != m_committed_offset; }
+
+    bool contains(u32 block) const { return m_page_offsets.contains(block); }
+    HashMap<u32, off_t> const& page_offsets() const { return m_page_offsets; }
+    Optional<ByteBuffer> read_page(u32 block) const;
+
+    bool append_page(u32 block, ReadonlyBytes);
+    bool append_commit(u32 block_count);
+    bool sync();
+
+    // Empties the log once all of its blocks have been checkpointed into the Heap's file.
+    bool reset();
+
+private:
+    void recover();
+    bool append(ReadonlyBytes);
+
+    String m_file_name;
+    int m_fd { -1 };
+    off_t m_end_offset { 0 };
+    off_t m_committed_offset { 0 };
+    size_t m_frame_count { 0 };
+    u32 m_committed_block_count { 0 };
+    u32 m_highest_block { 0 };
+    HashMap<u32, off_t> m_page_offsets;
+};
+
+}
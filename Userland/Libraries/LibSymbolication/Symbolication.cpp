@@ -5,6 +5,7 @@
  */
 
 #include <AK/Checked.h>
+#include <AK/HashMap.h>
 #include <AK/JsonArray.h>
 #include <AK/JsonObject.h>
 #include <AK/JsonValue.h>
@@ -18,6 +19,8 @@ namespace Symbolication {
 struct CachedELF {
     NonnullRefPtr<MappedFile> mapped_file;
     NonnullOwnPtr<Debug::DebugInfo> debug_info;
+    // Resolving the source positions is what's expensive, and the same few addresses keep coming back.
+    HashMap<FlatPtr, Symbol> symbols {};
 };
 
 static HashMap<String, OwnPtr<CachedELF>> s_cache;
@@ -58,35 +61,37 @@ Optional<FlatPtr> kernel_base()
     return s_kernel_base;
 }
 
-Optional<Symbol> symbolicate(String const& path, FlatPtr address)
+static CachedELF* cached_elf_for(String const& path)
 {
-    if (!s_cache.contains(path)) {
-        auto mapped_file = MappedFile::map(path);
-        if (mapped_file.is_error()) {
-            dbgln("Failed to map {}: {}", path, mapped_file.error().string());
-            s_cache.set(path, {});
-            return {};
-        }
-        auto elf = make<ELF::Image>(mapped_file.value()->bytes());
-        if (!elf->is_valid()) {
-            dbgln("ELF not valid: {}", path);
-            s_cache.set(path, {});
-            {};
-        }
-        auto cached_elf = make<CachedELF>(mapped_file.release_value(), make<Debug::DebugInfo>(move(elf)));
-        s_cache.set(path, move(cached_elf));
+    if (auto it = s_cache.find(path); it != s_cache.end())
+        return it->value;
+
+    auto mapped_file = MappedFile::map(path);
+    if (mapped_file.is_error()) {
+        dbgln("Failed to map {}: {}", path, mapped_file.error().string());
+        s_cache.set(path, {});
+        return nullptr;
     }
+    auto elf = make<ELF::Image>(mapped_file.value()->bytes());
+    if (!elf->is_valid()) {
+        dbgln("ELF not valid: {}", path);
+        s_cache.set(path, {});
+        return nullptr;
+    }
+    auto cached_elf = make<CachedELF>(mapped_file.release_value(), make<Debug::DebugInfo>(move(elf)));
+    auto* cached_elf_ptr = cached_elf.ptr();
+    s_cache.set(path, move(cached_elf));
+    return cached_elf_ptr;
+}
 
-    auto it = s_cache.find(path);
-    VERIFY(it != s_cache.end());
-    auto& cached_elf = it->value;
-
-    if (!cached_elf)
-        return {};
+static Symbol const& symbolicate(CachedELF& cached_elf, FlatPtr address)
+{
+    if (auto it = cached_elf.symbols.find(address); it != cached_elf.symbols.end())
+        return it->value;
 
     u32 offset = 0;
-    auto symbol = cached_elf->debug_info->elf().symbolicate(address, &offset);
-    auto source_position_with_inlines = cached_elf->debug_info->get_source_position_with_inlines(address);
+    auto symbol = cached_elf.debug_info->elf().symbolicate(address, &offset);
+    auto source_position_with_inlines = cached_elf.debug_info->get_source_position_with_inlines(address);
 
     Vector<Debug::DebugInfo::SourcePosition> positions;
     for (auto& position : source_position_with_inlines.inline_chain) {
@@ -98,12 +103,36 @@ Optional<Symbol> symbolicate(String const& path, FlatPtr address)
         positions.insert(0, source_position_with_inlines.source_position.value());
     }
 
-    return Symbol {
-        .address = address,
-        .name = move(symbol),
-        .offset = offset,
-        .source_positions = move(positions),
-    };
+    cached_elf.symbols.set(address,
+        Symbol {
+            .address = address,
+            .name = move(symbol),
+            .offset = offset,
+            .source_positions = move(positions),
+        });
+    return cached_elf.symbols.find(address)->value;
+}
+
+Optional<Symbol> symbolicate(String const& path, FlatPtr address)
+{
+    auto* cached_elf = cached_elf_for(path);
+    if (!cached_elf)
+        return {};
+    return symbolicate(*cached_elf, address);
+}
+
+Vector<Symbol> symbolicate(String const& path, Span<FlatPtr const> addresses)
+{
+    Vector<Symbol> symbols;
+    symbols.ensure_capacity(addresses.size());
+    auto* cached_elf = cached_elf_for(path);
+    for (auto address : addresses) {
+        if (cached_elf)
+            symbols.unchecked_append(symbolicate(*cached_elf, address));
+        else
+            symbols.unchecked_append(Symbol { .address = address, .source_positions = {} });
+    }
+    return symbols;
 }
 
 Vector<Symbol> symbolicate_thread(pid_t pid, pid_t tid)
@@ -185,46 +214,65 @@ Vector<Symbol> symbolicate_thread(pid_t pid, pid_t tid)
         }
     }
 
+    // Look up all frames in the same library at once, so each library only has to be found in the cache once.
+    struct FrameInRegion {
+        size_t frame_index { 0 };
+        FlatPtr adjusted_address { 0 };
+    };
+    Vector<Vector<FrameInRegion>> frames_by_region;
+    frames_by_region.resize(regions.size());
+
     Vector<Symbol> symbols;
+    symbols.ensure_capacity(stack.size());
     bool first_frame = true;
 
     for (auto address : stack) {
-        const RegionWithSymbols* found_region = nullptr;
-        for (auto& region : regions) {
+        Optional<size_t> found_region_index;
+        for (size_t i = 0; i < regions.size(); ++i) {
+            auto& region = regions[i];
             FlatPtr region_end;
             if (Checked<FlatPtr>::addition_would_overflow(region.base, region.size))
                 region_end = NumericLimits<FlatPtr>::max();
             else
                 region_end = region.base + region.size;
             if (address >= region.base && address < region_end) {
-                found_region = &region;
+                found_region_index = i;
                 break;
             }
         }
 
-        if (!found_region) {
+        if (!found_region_index.has_value()) {
             outln("{:p}  ??", address);
             continue;
         }
 
-        FlatPtr adjusted_address = address - found_region->base;
+        FlatPtr adjusted_address = address - regions[found_region_index.value()].base;
 
         // We're subtracting 1 from the address because this is the return address,
         // i.e. it is one instruction past the call instruction.
         // However, because the first frame represents the current
         // instruction pointer rather than the return address we don't
         // subtract 1 for that.
-        auto result = symbolicate(found_region->path, adjusted_address - (first_frame ? 0 : 1));
+        frames_by_region[found_region_index.value()].append({ symbols.size(), adjusted_address - (first_frame ? 0 : 1) });
         first_frame = false;
-        if (!result.has_value()) {
-            symbols.append(Symbol {
-                .address = address,
-                .source_positions = {},
-            });
+        symbols.unchecked_append(Symbol { .address = address, .source_positions = {} });
+    }
+
+    for (size_t i = 0; i < regions.size(); ++i) {
+        auto& frames = frames_by_region[i];
+        if (frames.is_empty())
             continue;
+        Vector<FlatPtr> addresses;
+        addresses.ensure_capacity(frames.size());
+        for (auto& frame : frames)
+            addresses.unchecked_append(frame.adjusted_address);
+        auto region_symbols = symbolicate(regions[i].path, addresses);
+        for (size_t j = 0; j < frames.size(); ++j) {
+            auto& symbol = symbols[frames[j].frame_index];
+            // Frames that couldn't be resolved keep their unadjusted address.
+            if (!region_symbols[j].name.is_null())
+                symbol = move(region_symbols[j]);
         }
-
-        symbols.append(result.value());
     }
     return symbols;
 }
@@ -21,5 +21,8 @@ struct Symbol {
 Optional<FlatPtr> kernel_base();
 Vector<Symbol> symbolicate_thread(pid_t pid, pid_t tid);
 Optional<Symbol> symbolicate(String const& path, FlatPtr address);
+// Resolves many addresses in the same ELF at once, which is a lot cheaper than looking them up one by one.
+// The symbols are in the order of the addresses, those that couldn't be resolved only have their address set.
+Vector<Symbol> symbolicate(String const& path, Span<FlatPtr const> addresses);
 
 }
@@ -22,6 +22,10 @@ enum class CipherSuite {
     RSA_WITH_AES_128_GCM_SHA256 = 0x009C,
     RSA_WITH_AES_256_GCM_SHA384 = 0x009D,
 
+    // RFC 4492 - ECDHE with AES-CBC
+    ECDHE_RSA_WITH_AES_128_CBC_SHA = 0xC013,
+    ECDHE_RSA_WITH_AES_256_CBC_SHA = 0xC014,
+
     // All recommended cipher suites (according to https://ciphersuite.info/cs/)
     // RFC 5288 - DH, DHE and RSA for AES-GCM
     DHE_DSS_WITH_AES_128_GCM_SHA256 = 0x00A2,
@@ -30,6 +34,8 @@ enum class CipherSuite {
     // RFC 5289 - ECDHE for AES-GCM
     ECDHE_ECDSA_WITH_AES_128_GCM_SHA256 = 0xC02B,
     ECDHE_ECDSA_WITH_AES_256_GCM_SHA384 = 0xC02C,
+    ECDHE_RSA_WITH_AES_128_GCM_SHA256 = 0xC02F,
+    ECDHE_RSA_WITH_AES_256_GCM_SHA384 = 0xC030,
 
     // RFC 5487 - Pre-shared keys
     DHE_PSK_WITH_AES_128_GCM_SHA256 = 0x00AA,
@@ -91,6 +97,23 @@ enum class HashAlgorithm : u8 {
     SHA512 = 6,
 };
 
+// Defined in RFC 4492 section 5.4
+enum class ECCurveType : u8 {
+    ExplicitPrime = 1,
+    ExplicitChar2 = 2,
+    NamedCurve = 3,
+};
+
+// Defined in RFC 8422 section 5.1.1, only listing the groups we support
+enum class NamedCurve : u16 {
+    x25519 = 0x001d,
+};
+
+// Defined in RFC 8422 section 5.1.2
+enum class ECPointFormat : u8 {
+    Uncompressed = 0,
+};
+
 // Defined in RFC 5246 section 7.4.1.4.1
 enum class SignatureAlgorithm : u8 {
     Anonymous = 0,
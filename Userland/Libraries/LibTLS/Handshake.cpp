@@ -34,6 +34,7 @@ ByteBuffer TLSv12::build_hello()
     builder.append(version);
     builder.append(m_context.local_random, sizeof(m_context.local_random));
 
+    offer_cached_session();
     builder.append(m_context.session_id_size);
     if (m_context.session_id_size)
         builder.append(m_context.session_id, m_context.session_id_size);
@@ -77,6 +78,18 @@ ByteBuffer TLSv12::build_hello()
     if (sni_length)
         extension_length += sni_length + 9;
 
+    // supported_groups: 2b extension ID, 2b extension length, 2b vector length, 2b for our only group (x25519)
+    // ec_point_formats: 2b extension ID, 2b extension length, 1b vector length, 1b for the uncompressed format
+    extension_length += 8 + 6;
+
+    // session_ticket: 2b extension ID, 2b extension length, and the ticket we're resuming with (if any)
+    ReadonlyBytes session_ticket;
+    if (m_context.options.use_session_resumption) {
+        if (m_context.offered_session.has_value())
+            session_ticket = m_context.offered_session->ticket;
+        extension_length += 4 + session_ticket.size();
+    }
+
     builder.append((u16)extension_length);
 
     if (sni_length) {
@@ -105,9 +118,42 @@ ByteBuffer TLSv12::build_hello()
         builder.append((u8)entry.signature);
     }
 
+    // supported_groups extension
+    builder.append((u16)HandshakeExtension::SupportedGroups);
+    builder.append((u16)4);
+    builder.append((u16)2);
+    builder.append((u16)NamedCurve::x25519);
+
+    // ec_point_formats extension
+    builder.append((u16)HandshakeExtension::ECPointFormats);
+    builder.append((u16)2);
+    builder.append((u8)1);
+    builder.append((u8)ECPointFormat::Uncompressed);
+
+    if (m_context.options.use_session_resumption) {
+        // session_ticket extension, which is empty when we'd like to get a ticket for a new session
+        builder.append((u16)HandshakeExtension::SessionTicket);
+        builder.append((u16)session_ticket.size());
+        builder.append(session_ticket);
+    }
+
     if (alpn_length) {
-        // TODO
-        VERIFY_NOT_REACHED();
+        // ALPN extension
+        builder.append((u16)HandshakeExtension::ApplicationLayerProtocolNegotiation);
+        // extension length
+        builder.append((u16)(alpn_length + 2));
+        // ProtocolNameList length
+        builder.append((u16)alpn_length);
+        auto append_protocol_name = [&](const String& name) {
+            builder.append((u8)name.length());
+            builder.append((const u8*)name.characters(), name.length());
+        };
+        if (alpn_negotiated_length) {
+            append_protocol_name(m_context.negotiated_alpn);
+        } else {
+            for (auto& alpn : m_context.alpn)
+                append_protocol_name(alpn);
+        }
     }
 
     // set the "length" field of the packet
@@ -193,7 +239,6 @@ ssize_t TLSv12::handle_handshake_finished(ReadonlyBytes buffer, WritePacketStage
 
     // TODO: Compare Hashes
     dbgln_if(TLS_DEBUG, "FIXME: handle_handshake_finished :: Check message validity");
-    m_context.connection_status = ConnectionStatus::Established;
 
     if (m_handshake_timeout_timer) {
         // Disable the handshake timeout timer as handshake has been established.
@@ -202,6 +247,16 @@ ssize_t TLSv12::handle_handshake_finished(ReadonlyBytes buffer, WritePacketStage
         m_handshake_timeout_timer = nullptr;
     }
 
+    if (m_context.is_resumed_session) {
+        // RFC 5246 section 7.3: In an abbreviated handshake the server finishes first, and we still have to send our
+        // own ChangeCipherSpec and Finished messages before the connection is established.
+        write_packets = WritePacketStage::Finished;
+        return index + size;
+    }
+
+    m_context.connection_status = ConnectionStatus::Established;
+    cache_session();
+
     if (on_tls_ready_to_write)
         on_tls_ready_to_write(*this);
 
@@ -322,6 +377,15 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
                 payload_res = handle_server_key_exchange(buffer.slice(1, payload_size));
             }
             break;
+        case NewSessionTicket:
+            // RFC 5077 section 3.3: Sent right before the server's ChangeCipherSpec, if it promised one in its hello.
+            if (m_context.is_server || m_context.connection_status < ConnectionStatus::Negotiating || m_context.cipher_spec_set) {
+                payload_res = (i8)Error::UnexpectedMessage;
+                break;
+            }
+            dbgln_if(TLS_DEBUG, "new session ticket");
+            payload_res = handle_new_session_ticket(buffer.slice(1, payload_size));
+            break;
         case CertificateRequest:
             if (m_context.handshake_messages[6] >= 1) {
                 dbgln("unexpected certificate request message");
@@ -523,6 +587,9 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
                 write_packet(packet);
             }
             m_context.connection_status = ConnectionStatus::Established;
+            cache_session();
+            if (on_tls_ready_to_write)
+                on_tls_ready_to_write(*this);
             break;
         }
         payload_size++;
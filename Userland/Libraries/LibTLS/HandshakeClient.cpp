@@ -7,8 +7,10 @@
 #include <AK/Debug.h>
 #include <AK/Random.h>
 #include <LibCrypto/ASN1/DER.h>
+#include <LibCrypto/Curves/X25519.h>
 #include <LibCrypto/PK/Code/EMSA_PSS.h>
 #include <LibTLS/TLSv12.h>
+#include <string.h>
 
 namespace TLS {
 
@@ -224,6 +226,46 @@ void TLSv12::build_rsa_pre_master_secret(PacketBuilder& builder)
     builder.append(outbuf);
 }
 
+void TLSv12::build_ecdhe_rsa_pre_master_secret(PacketBuilder& builder)
+{
+    // The server's public key was checked against its certificate when we got its key exchange message.
+    if (m_context.server_ecdhe_public_key.size() != Crypto::Curves::X25519::key_size) {
+        dbgln("No server key exchange message for ECDHE");
+        alert(AlertLevel::Critical, AlertDescription::HandshakeFailure);
+        return;
+    }
+
+    u8 private_key[Crypto::Curves::X25519::key_size];
+    u8 public_key[Crypto::Curves::X25519::key_size];
+    u8 shared_secret[Crypto::Curves::X25519::key_size];
+    Crypto::Curves::X25519::generate_private_key({ private_key, sizeof(private_key) });
+    Crypto::Curves::X25519::generate_public_key({ private_key, sizeof(private_key) }, { public_key, sizeof(public_key) });
+    auto is_valid = Crypto::Curves::X25519::compute_shared_secret({ private_key, sizeof(private_key) }, m_context.server_ecdhe_public_key, { shared_secret, sizeof(shared_secret) });
+    explicit_bzero(private_key, sizeof(private_key));
+    if (!is_valid) {
+        dbgln("Server sent a low order X25519 public key");
+        alert(AlertLevel::Critical, AlertDescription::IllegalParameter);
+        return;
+    }
+
+    m_context.premaster_key = ByteBuffer::copy(shared_secret, sizeof(shared_secret));
+    explicit_bzero(shared_secret, sizeof(shared_secret));
+    if constexpr (TLS_DEBUG) {
+        dbgln("PreMaster secret");
+        print_buffer(m_context.premaster_key);
+    }
+
+    if (!compute_master_secret_from_pre_master_secret(48)) {
+        dbgln("oh noes we could not derive a master key :(");
+        return;
+    }
+
+    // RFC 8422 section 5.7: ClientECDiffieHellmanPublic, a one byte length followed by the point.
+    builder.append_u24(sizeof(public_key) + 1);
+    builder.append((u8)sizeof(public_key));
+    builder.append(public_key, sizeof(public_key));
+}
+
 ByteBuffer TLSv12::build_certificate()
 {
     PacketBuilder builder { MessageType::Handshake, m_context.options.version };
@@ -304,11 +346,13 @@ ByteBuffer TLSv12::build_client_key_exchange()
         TODO();
         break;
     case KeyExchangeAlgorithm::ECDHE_RSA:
+        build_ecdhe_rsa_pre_master_secret(builder);
+        break;
     case KeyExchangeAlgorithm::ECDH_ECDSA:
     case KeyExchangeAlgorithm::ECDH_RSA:
     case KeyExchangeAlgorithm::ECDHE_ECDSA:
     case KeyExchangeAlgorithm::ECDH_anon:
-        dbgln("Client key exchange for ECDHE algorithms is not implemented");
+        dbgln("Client key exchange for ECDH(E) algorithms other than ECDHE_RSA is not implemented");
         TODO();
         break;
     default:
@@ -10,6 +10,9 @@
 
 #include <LibCore/Timer.h>
 #include <LibCrypto/ASN1/DER.h>
+#include <LibCrypto/Curves/X25519.h>
+#include <LibCrypto/Hash/HashManager.h>
+#include <LibCrypto/NumberTheory/ModularFunctions.h>
 #include <LibCrypto/PK/Code/EMSA_PSS.h>
 #include <LibTLS/TLSv12.h>
 
@@ -81,6 +84,17 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
     m_context.cipher = cipher;
     dbgln_if(TLS_DEBUG, "Cipher: {}", (u16)cipher);
 
+    // The server resumes the session we offered by echoing its session ID back, and must then stick to its cipher.
+    if (m_context.offered_session.has_value()) {
+        auto& offered_session = m_context.offered_session.value();
+        m_context.is_resumed_session = session_length == offered_session.session_id_size
+            && memcmp(m_context.session_id, offered_session.session_id, session_length) == 0;
+        if (m_context.is_resumed_session && cipher != offered_session.cipher) {
+            dbgln("Server resumed a session with a different cipher");
+            return (i8)Error::UnexpectedMessage;
+        }
+    }
+
     // Simplification: We only support handshake hash functions via HMAC
     m_context.handshake_hash.initialize(hmac_hash());
 
@@ -144,28 +158,26 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
                 dbgln("SNI host_name: {}", m_context.extensions.SNI);
             }
         } else if (extension_type == HandshakeExtension::ApplicationLayerProtocolNegotiation && m_context.alpn.size()) {
-            if (buffer.size() - res > 2) {
-                auto alpn_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(res)));
-                if (alpn_length && alpn_length <= extension_length - 2) {
-                    const u8* alpn = buffer.offset_pointer(res + 2);
-                    size_t alpn_position = 0;
-                    while (alpn_position < alpn_length) {
-                        u8 alpn_size = alpn[alpn_position++];
-                        if (alpn_size + alpn_position >= extension_length)
-                            break;
-                        String alpn_str { (const char*)alpn + alpn_position, alpn_length };
-                        if (alpn_size && m_context.alpn.contains_slow(alpn_str)) {
-                            m_context.negotiated_alpn = alpn_str;
-                            dbgln("negotiated alpn: {}", alpn_str);
-                            break;
-                        }
-                        alpn_position += alpn_length;
-                        if (!m_context.is_server) // server hello must contain one ALPN
-                            break;
-                    }
-                }
+            // RFC 7301, 3.1: The server hello contains a ProtocolNameList with exactly one of the protocols we offered.
+            if (extension_length >= 3) {
+                auto alpn_list_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(res)));
+                u8 alpn_size = buffer[res + 2];
+                if (alpn_list_length != extension_length - 2 || alpn_size + 1 != alpn_list_length)
+                    return (i8)Error::BrokenPacket;
+                String alpn { (const char*)buffer.offset_pointer(res + 3), alpn_size };
+                if (!m_context.alpn.contains_slow(alpn))
+                    return (i8)Error::NotUnderstood;
+                m_context.negotiated_alpn = alpn;
+                dbgln_if(TLS_DEBUG, "Negotiated ALPN: {}", alpn);
             }
             res += extension_length;
+        } else if (extension_type == HandshakeExtension::ECPointFormats) {
+            // RFC 8422 section 5.2: We only offered the uncompressed format, so there's nothing to pick from.
+            res += extension_length;
+        } else if (extension_type == HandshakeExtension::SessionTicket) {
+            // RFC 5077 section 3.2: An empty extension, promising a NewSessionTicket message.
+            dbgln_if(TLS_DEBUG, "Server will send a new session ticket");
+            res += extension_length;
         } else if (extension_type == HandshakeExtension::SignatureAlgorithms) {
             dbgln("supported signatures: ");
             print_buffer(buffer.slice(res, extension_length));
@@ -177,6 +189,15 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         }
     }
 
+    if (m_context.is_resumed_session) {
+        // The server skips straight to ChangeCipherSpec and Finished, with keys derived from the old master secret.
+        dbgln_if(TLS_DEBUG, "Resuming session");
+        m_context.master_key = m_context.offered_session->master_key;
+        if (!expand_key())
+            return (i8)Error::UnknownError;
+        m_context.connection_status = ConnectionStatus::KeyExchange;
+    }
+
     return res;
 }
 
@@ -193,13 +214,36 @@ ssize_t TLSv12::handle_server_hello_done(ReadonlyBytes buffer)
     return size + 3;
 }
 
+ssize_t TLSv12::handle_new_session_ticket(ReadonlyBytes buffer)
+{
+    // RFC 5077 section 3.3: A u32 lifetime hint in seconds, then the opaque ticket with a u16 length.
+    if (buffer.size() < 3)
+        return (i8)Error::NeedMoreData;
+
+    size_t size = buffer[0] * 0x10000 + buffer[1] * 0x100 + buffer[2];
+    if (buffer.size() - 3 < size)
+        return (i8)Error::NeedMoreData;
+    if (size < 6)
+        return (i8)Error::BrokenPacket;
+
+    auto lifetime = AK::convert_between_host_and_network_endian(ByteReader::load32(buffer.offset_pointer(3)));
+    u16 ticket_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(7)));
+    if (ticket_length != size - 6)
+        return (i8)Error::BrokenPacket;
+
+    // An empty ticket means the server won't give us one after all.
+    m_context.new_session_ticket = ByteBuffer::copy(buffer.slice(9, ticket_length));
+    m_context.new_session_ticket_lifetime = lifetime;
+    return size + 3;
+}
+
 ByteBuffer TLSv12::build_server_key_exchange()
 {
     dbgln("FIXME: build_server_key_exchange");
     return {};
 }
 
-ssize_t TLSv12::handle_server_key_exchange(ReadonlyBytes)
+ssize_t TLSv12::handle_server_key_exchange(ReadonlyBytes buffer)
 {
     switch (get_key_exchange_algorithm(m_context.cipher)) {
     case KeyExchangeAlgorithm::RSA:
@@ -222,11 +266,12 @@ ssize_t TLSv12::handle_server_key_exchange(ReadonlyBytes)
         TODO();
         break;
     case KeyExchangeAlgorithm::ECDHE_RSA:
+        return handle_ecdhe_rsa_server_key_exchange(buffer);
     case KeyExchangeAlgorithm::ECDH_ECDSA:
     case KeyExchangeAlgorithm::ECDH_RSA:
     case KeyExchangeAlgorithm::ECDHE_ECDSA:
     case KeyExchangeAlgorithm::ECDH_anon:
-        dbgln("Server key exchange for ECDHE algorithms is not implemented");
+        dbgln("Server key exchange for ECDH(E) algorithms other than ECDHE_RSA is not implemented");
         TODO();
         break;
     default:
@@ -237,4 +282,124 @@ ssize_t TLSv12::handle_server_key_exchange(ReadonlyBytes)
     return 0;
 }
 
+ssize_t TLSv12::handle_ecdhe_rsa_server_key_exchange(ReadonlyBytes buffer)
+{
+    // RFC 8422 section 5.4: ServerECDHParams followed by a signature over both randoms and the params.
+    if (buffer.size() < 3)
+        return (i8)Error::NeedMoreData;
+
+    size_t size = buffer[0] * 0x10000 + buffer[1] * 0x100 + buffer[2];
+    if (buffer.size() - 3 < size)
+        return (i8)Error::NeedMoreData;
+
+    auto message = buffer.slice(3, size);
+    if (message.size() < 4)
+        return (i8)Error::BrokenPacket;
+
+    auto curve_type = (ECCurveType)message[0];
+    auto curve = (NamedCurve)AK::convert_between_host_and_network_endian(ByteReader::load16(message.offset_pointer(1)));
+    if (curve_type != ECCurveType::NamedCurve || curve != NamedCurve::x25519) {
+        dbgln("Server picked an unsupported curve: type {}, curve {}", (u8)curve_type, (u16)curve);
+        return (i8)Error::NotUnderstood;
+    }
+
+    size_t point_length = message[3];
+    if (point_length != Crypto::Curves::X25519::key_size || message.size() < 4 + point_length + 4)
+        return (i8)Error::BrokenPacket;
+
+    auto params = message.slice(0, 4 + point_length);
+    auto hash_algorithm = (HashAlgorithm)message[params.size()];
+    auto signature_algorithm = (SignatureAlgorithm)message[params.size() + 1];
+    u16 signature_length = AK::convert_between_host_and_network_endian(ByteReader::load16(message.offset_pointer(params.size() + 2)));
+    if (message.size() - params.size() - 4 != signature_length)
+        return (i8)Error::BrokenPacket;
+
+    if (signature_algorithm != SignatureAlgorithm::RSA) {
+        dbgln("Server key exchange signed with unsupported algorithm {}", (u8)signature_algorithm);
+        return (i8)Error::NotUnderstood;
+    }
+
+    if (!verify_rsa_server_key_exchange_signature(params, hash_algorithm, message.slice(params.size() + 4, signature_length))) {
+        dbgln("Server key exchange signature could not be verified");
+        return (i8)Error::NotVerified;
+    }
+
+    m_context.server_ecdhe_public_key = ByteBuffer::copy(params.slice(4));
+    return size + 3;
+}
+
+// Checks an RSASSA-PKCS1-v1_5 signature (RFC 8017 section 8.2.2) over client_random + server_random + params, with
+// the public key from the server's certificate.
+bool TLSv12::verify_rsa_server_key_exchange_signature(ReadonlyBytes params, HashAlgorithm hash_algorithm, ReadonlyBytes signature)
+{
+    // The DER encoded DigestInfo prefixes from RFC 8017 section 9.2, note 1.
+    static constexpr u8 sha1_prefix[] { 0x30, 0x21, 0x30, 0x09, 0x06, 0x05, 0x2b, 0x0e, 0x03, 0x02, 0x1a, 0x05, 0x00, 0x04, 0x14 };
+    static constexpr u8 sha256_prefix[] { 0x30, 0x31, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02, 0x01, 0x05, 0x00, 0x04, 0x20 };
+    static constexpr u8 sha384_prefix[] { 0x30, 0x41, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02, 0x02, 0x05, 0x00, 0x04, 0x30 };
+    static constexpr u8 sha512_prefix[] { 0x30, 0x51, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02, 0x03, 0x05, 0x00, 0x04, 0x40 };
+
+    ReadonlyBytes digest_info_prefix;
+    Crypto::Hash::HashKind hash_kind;
+    switch (hash_algorithm) {
+    case HashAlgorithm::SHA1:
+        digest_info_prefix = { sha1_prefix, sizeof(sha1_prefix) };
+        hash_kind = Crypto::Hash::HashKind::SHA1;
+        break;
+    case HashAlgorithm::SHA256:
+        digest_info_prefix = { sha256_prefix, sizeof(sha256_prefix) };
+        hash_kind = Crypto::Hash::HashKind::SHA256;
+        break;
+    case HashAlgorithm::SHA384:
+        digest_info_prefix = { sha384_prefix, sizeof(sha384_prefix) };
+        hash_kind = Crypto::Hash::HashKind::SHA384;
+        break;
+    case HashAlgorithm::SHA512:
+        digest_info_prefix = { sha512_prefix, sizeof(sha512_prefix) };
+        hash_kind = Crypto::Hash::HashKind::SHA512;
+        break;
+    default:
+        dbgln("Server key exchange signed with unsupported hash {}", (u8)hash_algorithm);
+        return false;
+    }
+
+    auto certificate_index = verify_chain_and_get_matching_certificate(m_context.extensions.SNI);
+    if (!certificate_index.has_value()) {
+        dbgln("certificate verification failed :(");
+        return false;
+    }
+    auto& certificate = m_context.certificates[certificate_index.value()];
+
+    Crypto::Hash::Manager hash;
+    hash.initialize(hash_kind);
+    hash.update(m_context.local_random, sizeof(m_context.local_random));
+    hash.update(m_context.remote_random, sizeof(m_context.remote_random));
+    hash.update(params.data(), params.size());
+    auto digest = hash.digest();
+
+    auto& modulus = certificate.public_key.modulus();
+    auto key_size = certificate.public_key.length();
+    if (signature.size() != key_size)
+        return false;
+
+    // EM = 0x00 || 0x01 || PS (0xff bytes) || 0x00 || DigestInfo, where PS is at least eight bytes long.
+    auto encoded_length = digest_info_prefix.size() + digest.data_length();
+    if (key_size < encoded_length + 11)
+        return false;
+
+    Vector<u8, 512> expected;
+    expected.resize(key_size);
+    expected[0] = 0x00;
+    expected[1] = 0x01;
+    __builtin_memset(expected.data() + 2, 0xff, key_size - encoded_length - 3);
+    expected[key_size - encoded_length - 1] = 0x00;
+    digest_info_prefix.copy_to(expected.span().slice(key_size - encoded_length));
+    __builtin_memcpy(expected.data() + key_size - digest.data_length(), digest.immutable_data(), digest.data_length());
+
+    auto signature_integer = Crypto::UnsignedBigInteger::import_data(signature.data(), signature.size());
+    if (!(signature_integer < modulus))
+        return false;
+    auto decoded = Crypto::NumberTheory::ModularPower(signature_integer, certificate.public_key.public_exponent(), modulus);
+    return decoded == Crypto::UnsignedBigInteger::import_data(expected.data(), expected.size());
+}
+
 }
@@ -37,7 +37,11 @@ void TLSv12::alert(AlertLevel level, AlertDescription code)
 
 void TLSv12::write_packet(ByteBuffer& packet)
 {
-    m_context.tls_buffer.append(packet.data(), packet.size());
+    // Nothing uses the packet once it's been handed over, so take it as it is when nothing else is queued.
+    if (m_context.tls_buffer.is_empty())
+        m_context.tls_buffer = move(packet);
+    else
+        m_context.tls_buffer.append(packet.data(), packet.size());
     if (m_context.connection_status > ConnectionStatus::Disconnected) {
         if (!m_has_scheduled_write_flush) {
             dbgln_if(TLS_DEBUG, "Scheduling write of {}", m_context.tls_buffer.size());
@@ -92,15 +96,7 @@ void TLSv12::update_packet(ByteBuffer& packet)
                 });
 
             if (m_context.crypto.created == 1) {
-                // `buffer' will continue to be encrypted
-                auto buffer = ByteBuffer::create_uninitialized(length);
-                size_t buffer_position = 0;
                 auto iv_size = iv_length();
-
-                // copy the packet, sans the header
-                buffer.overwrite(buffer_position, packet.offset_pointer(header_size), packet.size() - header_size);
-                buffer_position += packet.size() - header_size;
-
                 ByteBuffer ct;
 
                 m_cipher_local.visit(
@@ -162,31 +158,35 @@ void TLSv12::update_packet(ByteBuffer& packet)
                         // copy the header over
                         ct.overwrite(0, packet.data(), header_size - 2);
 
+                        // The plaintext, its MAC and the padding are laid out where the ciphertext goes, and encrypted in place.
+                        auto view = ct.bytes().slice(header_size + iv_size, length);
+                        size_t view_position = packet.size() - header_size;
+                        packet.bytes().slice(header_size).copy_to(view);
+
                         // get the appropricate HMAC value for the entire packet
                         auto mac = hmac_message(packet, {}, mac_size, true);
 
                         // write the MAC
-                        buffer.overwrite(buffer_position, mac.data(), mac.size());
-                        buffer_position += mac.size();
+                        mac.bytes().copy_to(view.slice(view_position));
+                        view_position += mac.size();
 
                         // Apply the padding (a packet MUST always be padded)
-                        memset(buffer.offset_pointer(buffer_position), padding - 1, padding);
-                        buffer_position += padding;
+                        memset(view.offset(view_position), padding - 1, padding);
+                        view_position += padding;
 
-                        VERIFY(buffer_position == buffer.size());
+                        VERIFY(view_position == view.size());
 
-                        auto iv = ByteBuffer::create_uninitialized(iv_size);
-                        fill_with_random(iv.data(), iv.size());
+                        u8 iv[16];
+                        VERIFY(iv_size <= sizeof(iv));
+                        fill_with_random(iv, iv_size);
 
                         // write it into the ciphertext portion of the message
-                        ct.overwrite(header_size, iv.data(), iv.size());
+                        ct.overwrite(header_size, iv, iv_size);
 
                         VERIFY(header_size + iv_size + length == ct.size());
                         VERIFY(length % block_size == 0);
 
-                        // get a block to encrypt into
-                        auto view = ct.bytes().slice(header_size + iv_size, length);
-                        cbc.encrypt(buffer, view, iv);
+                        cbc.encrypt(view, view, { iv, iv_size });
                     });
 
                 // store the correct ciphertext length into the packet
@@ -195,7 +195,7 @@ void TLSv12::update_packet(ByteBuffer& packet)
                 ByteReader::store(ct.offset_pointer(header_size - 2), AK::convert_between_host_and_network_endian(ct_length));
 
                 // replace the packet with the ciphertext
-                packet = ct;
+                packet = move(ct);
             }
         }
     }
@@ -272,7 +272,7 @@ ByteBuffer TLSv12::hmac_message(const ReadonlyBytes& buf, const Optional<Readonl
     return mac;
 }
 
-ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
+ssize_t TLSv12::handle_message(Bytes buffer)
 {
     auto res { 5ll };
     size_t header_size = res;
@@ -309,8 +309,7 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
     dbgln_if(TLS_DEBUG, "message type: {}, length: {}", (u8)type, length);
     auto plain = buffer.slice(buffer_position, buffer.size() - buffer_position);
 
-    ByteBuffer decrypted;
-
+    // Records are decrypted in place, so `plain' ends up pointing into the caller's buffer either way.
     if (m_context.cipher_spec_set && type != MessageType::ChangeCipher) {
         if constexpr (TLS_DEBUG) {
             dbgln("Encrypted: ");
@@ -332,7 +331,6 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
 
                 auto packet_length = length - iv_length() - 16;
                 auto payload = plain;
-                decrypted = ByteBuffer::create_uninitialized(packet_length);
 
                 // AEAD AAD (13)
                 // Seq. no (8)
@@ -365,12 +363,12 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
                 nonce.copy_to(iv_bytes.slice(4));
                 memset(iv_bytes.offset(12), 0, 4);
 
-                auto ciphertext = payload.slice(0, payload.size() - 16);
-                auto tag = payload.slice(ciphertext.size());
+                auto ciphertext = payload.slice(0, packet_length);
+                auto tag = payload.slice(ciphertext.size(), 16);
 
                 auto consistency = gcm.decrypt(
                     ciphertext,
-                    decrypted,
+                    ciphertext,
                     iv_bytes,
                     aad_bytes,
                     tag);
@@ -384,23 +382,28 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
                     return;
                 }
 
-                plain = decrypted;
+                plain = ciphertext;
             },
             [&](Crypto::Cipher::AESCipher::CBCMode& cbc) {
                 VERIFY(!is_aead());
                 auto iv_size = iv_length();
+                if (length < iv_size || (length - iv_size) % cbc.cipher().block_size() != 0) {
+                    dbgln("broken packet");
+                    auto packet = build_alert(true, (u8)AlertDescription::DecryptError);
+                    write_packet(packet);
+                    return_value = Error::BrokenPacket;
+                    return;
+                }
 
-                decrypted = cbc.create_aligned_buffer(length - iv_size);
                 auto iv = buffer.slice(header_size, iv_size);
-
-                Bytes decrypted_span = decrypted;
-                cbc.decrypt(buffer.slice(header_size + iv_size, length - iv_size), decrypted_span, iv);
+                auto decrypted_span = buffer.slice(header_size + iv_size, length - iv_size);
+                cbc.decrypt(decrypted_span, decrypted_span, iv);
 
                 length = decrypted_span.size();
 
                 if constexpr (TLS_DEBUG) {
                     dbgln("Decrypted: ");
-                    print_buffer(decrypted);
+                    print_buffer(decrypted_span);
                 }
 
                 auto mac_size = mac_length();
@@ -432,7 +435,7 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
                     return_value = Error::IntegrityCheckFailed;
                     return;
                 }
-                plain = decrypted.bytes().slice(0, length);
+                plain = decrypted_span.slice(0, length);
             });
 
         if (return_value != Error::NoError) {
@@ -489,7 +492,8 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
 
             if (code == (u8)AlertDescription::CloseNotify) {
                 res += 2;
-                alert(AlertLevel::Critical, AlertDescription::CloseNotify);
+                // RFC 5246 section 7.2.1: close_notify is sent as a warning, as a fatal alert would invalidate the session.
+                alert(AlertLevel::Warning, AlertDescription::CloseNotify);
                 m_context.connection_finished = true;
                 if (!m_context.cipher_spec_set) {
                     // AWS CloudFront hits this.
@@ -61,12 +61,19 @@ bool TLSv12::write(ReadonlyBytes buffer)
         return false;
     }
 
-    PacketBuilder builder { MessageType::ApplicationData, m_context.options.version, buffer.size() };
-    builder.append(buffer);
-    auto packet = builder.build();
+    // RFC 5246 section 6.2.1: Records can't carry more than 2^14 bytes, so larger writes are split up.
+    constexpr size_t max_plaintext_length = 16 * KiB;
+    while (!buffer.is_empty()) {
+        auto fragment = buffer.slice(0, min(buffer.size(), max_plaintext_length));
+        buffer = buffer.slice(fragment.size());
 
-    update_packet(packet);
-    write_packet(packet);
+        PacketBuilder builder { MessageType::ApplicationData, m_context.options.version, fragment.size() };
+        builder.append(fragment);
+        auto packet = builder.build();
+
+        update_packet(packet);
+        write_packet(packet);
+    }
 
     return true;
 }
@@ -74,6 +81,7 @@ bool TLSv12::write(ReadonlyBytes buffer)
 bool TLSv12::connect(const String& hostname, int port)
 {
     set_sni(hostname);
+    m_context.session_cache_key = String::formatted("{}:{}", hostname, port);
     return Core::Socket::connect(hostname, port);
 }
 
@@ -136,8 +144,20 @@ bool TLSv12::common_connect(const struct sockaddr* saddr, socklen_t length)
     return true;
 }
 
+void TLSv12::set_reading_paused(bool paused)
+{
+    Core::Socket::set_reading_paused(paused);
+
+    // Whatever was decrypted before reading was paused is still waiting for the client.
+    if (!paused && m_context.application_buffer.size() > 0)
+        deferred_invoke([&](auto&) { read_from_socket(); });
+}
+
 void TLSv12::read_from_socket()
 {
+    if (is_reading_paused())
+        return;
+
     auto did_schedule_read = false;
     auto notify_client_for_app_data = [&] {
         if (m_context.application_buffer.size() > 0) {
@@ -154,6 +174,10 @@ void TLSv12::read_from_socket()
     // since we won't be consuming things if the connection is terminated.
     notify_client_for_app_data();
 
+    // The client may have paused reading while it was told about what we already had.
+    if (is_reading_paused())
+        return;
+
     if (!check_connection_state(true))
         return;
 
@@ -189,6 +213,7 @@ bool TLSv12::check_connection_state(bool read)
     }
     if (m_context.critical_error) {
         dbgln_if(TLS_DEBUG, "CRITICAL ERROR {} :(", m_context.critical_error);
+        forget_cached_session();
 
         if (on_tls_error)
             on_tls_error((AlertDescription)m_context.critical_error);
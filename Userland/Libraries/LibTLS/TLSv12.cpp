@@ -6,6 +6,8 @@
 
 #include <AK/Debug.h>
 #include <AK/Endian.h>
+#include <AK/HashMap.h>
+#include <AK/Random.h>
 #include <LibCore/ConfigFile.h>
 #include <LibCore/DateTime.h>
 #include <LibCore/File.h>
@@ -109,6 +111,93 @@ bool Certificate::is_valid() const
     return true;
 }
 
+// RFC 5246 section F.1.4 suggests an upper limit of 24 hours on session lifetimes; we don't keep them quite as long.
+static constexpr time_t max_session_lifetime_in_seconds = 60 * 60;
+static constexpr size_t max_cached_sessions = 64;
+
+static HashMap<String, SessionState>& session_cache()
+{
+    static HashMap<String, SessionState> cache;
+    return cache;
+}
+
+void TLSv12::offer_cached_session()
+{
+    m_context.offered_session.clear();
+    m_context.is_resumed_session = false;
+    m_context.session_id_size = 0;
+    m_context.new_session_ticket.clear();
+    m_context.new_session_ticket_lifetime = 0;
+
+    if (!m_context.options.use_session_resumption || m_context.session_cache_key.is_null())
+        return;
+
+    auto it = session_cache().find(m_context.session_cache_key);
+    if (it == session_cache().end())
+        return;
+
+    auto& session = it->value;
+    if (session.expiry_timestamp <= Core::DateTime::now().timestamp() || !m_context.options.usable_cipher_suites.contains_slow(session.cipher)) {
+        session_cache().remove(it);
+        return;
+    }
+
+    m_context.offered_session = session;
+    if (!session.ticket.is_empty()) {
+        // RFC 5077 section 3.4: The server echoes a session ID we make up if it accepts the ticket.
+        fill_with_random(m_context.offered_session->session_id, sizeof(m_context.offered_session->session_id));
+        m_context.offered_session->session_id_size = sizeof(m_context.offered_session->session_id);
+    }
+    memcpy(m_context.session_id, m_context.offered_session->session_id, m_context.offered_session->session_id_size);
+    m_context.session_id_size = m_context.offered_session->session_id_size;
+    dbgln_if(TLS_DEBUG, "Offering to resume session for {}", m_context.session_cache_key);
+}
+
+void TLSv12::cache_session()
+{
+    if (!m_context.options.use_session_resumption || m_context.session_cache_key.is_null())
+        return;
+
+    SessionState session;
+    if (m_context.is_resumed_session) {
+        // The ticket may have been renewed, but everything else stays as it was.
+        session = m_context.offered_session.release_value();
+    } else {
+        memcpy(session.session_id, m_context.session_id, m_context.session_id_size);
+        session.session_id_size = m_context.session_id_size;
+        session.cipher = m_context.cipher;
+        session.master_key = m_context.master_key;
+    }
+
+    time_t lifetime = max_session_lifetime_in_seconds;
+    if (!m_context.new_session_ticket.is_empty()) {
+        session.ticket = move(m_context.new_session_ticket);
+        if (m_context.new_session_ticket_lifetime)
+            lifetime = min(lifetime, (time_t)m_context.new_session_ticket_lifetime);
+    }
+    if (session.session_id_size == 0 && session.ticket.is_empty())
+        return;
+    session.expiry_timestamp = Core::DateTime::now().timestamp() + lifetime;
+
+    auto& cache = session_cache();
+    if (cache.size() >= max_cached_sessions && !cache.contains(m_context.session_cache_key)) {
+        auto oldest = cache.begin();
+        for (auto it = cache.begin(); it != cache.end(); ++it) {
+            if (it->value.expiry_timestamp < oldest->value.expiry_timestamp)
+                oldest = it;
+        }
+        cache.remove(oldest);
+    }
+    cache.set(m_context.session_cache_key, move(session));
+}
+
+void TLSv12::forget_cached_session()
+{
+    // RFC 5246 section 7.2.2: A session that ended with a fatal alert must not be resumed.
+    if (!m_context.session_cache_key.is_null())
+        session_cache().remove(m_context.session_cache_key);
+}
+
 void TLSv12::try_disambiguate_error() const
 {
     dbgln("Possible failure cause(s): ");
@@ -183,6 +272,26 @@ void TLSv12::set_root_certificates(Vector<Certificate> certificates)
     m_context.root_ceritificates = move(certificates);
 }
 
+void TLSv12::add_alpn(const StringView& alpn)
+{
+    if (m_context.is_server || m_context.connection_status != ConnectionStatus::Disconnected) {
+        dbgln("invalid state for add_alpn");
+        return;
+    }
+    if (alpn.is_empty() || alpn.length() > 255 || has_alpn(alpn))
+        return;
+    m_context.alpn.append(alpn);
+}
+
+bool TLSv12::has_alpn(const StringView& alpn) const
+{
+    for (auto& protocol : m_context.alpn) {
+        if (protocol == alpn)
+            return true;
+    }
+    return false;
+}
+
 bool Context::verify_chain() const
 {
     if (!options.validate_certificates)
@@ -7,7 +7,13 @@
 
 #include <LibTest/Macros.h> // intentionally first -- we redefine VERIFY and friends in here
 
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <AK/LexicalPath.h>
+#include <AK/Math.h>
+#include <AK/QuickSort.h>
 #include <LibCore/ArgsParser.h>
+#include <LibCore/File.h>
 #include <LibTest/TestSuite.h>
 #include <stdlib.h>
 #include <sys/time.h>
@@ -22,7 +28,9 @@ public:
 
     void restart() { gettimeofday(&m_started, nullptr); }
 
-    u64 elapsed_milliseconds()
+    u64 elapsed_milliseconds() { return elapsed_microseconds() / 1000; }
+
+    u64 elapsed_microseconds()
     {
         struct timeval now = {};
         gettimeofday(&now, nullptr);
@@ -30,7 +38,7 @@ public:
         struct timeval delta = {};
         timersub(&now, &m_started, &delta);
 
-        return delta.tv_sec * 1000 + delta.tv_usec / 1000;
+        return delta.tv_sec * 1000000 + delta.tv_usec;
     }
 
 private:
@@ -63,6 +71,11 @@ int TestSuite::main(const String& suite_name, int argc, char** argv)
     args_parser.add_option(do_tests_only, "Only run tests.", "tests", 0);
     args_parser.add_option(do_benchmarks_only, "Only run benchmarks.", "bench", 0);
     args_parser.add_option(do_list_cases, "List available test cases.", "list", 0);
+    args_parser.add_option(m_benchmark_warmup_count, "Run each benchmark this many times before measuring it.", "bench-warmup", 0, "count");
+    args_parser.add_option(m_benchmark_iteration_count, "Measure each benchmark this many times.", "bench-iterations", 0, "count");
+    args_parser.add_option(m_benchmark_json_path, "Write the benchmark statistics to a JSON file.", "bench-json", 0, "path");
+    args_parser.add_option(m_benchmark_baseline_path, "Compare the benchmarks with a JSON file written by an earlier run.", "bench-baseline", 0, "path");
+    args_parser.add_option(m_benchmark_max_regression_percent, "Fail benchmarks whose median got this much slower than the baseline.", "bench-max-regression", 0, "percent");
     args_parser.add_positional_argument(search_string, "Only run matching cases.", "pattern", Core::ArgsParser::Required::No);
     args_parser.parse(argc, argv);
 
@@ -76,9 +89,19 @@ int TestSuite::main(const String& suite_name, int argc, char** argv)
         return 0;
     }
 
+    if (m_benchmark_warmup_count < 0 || m_benchmark_iteration_count < 1) {
+        warnln("Need at least one benchmark iteration, and no negative number of warm-up runs");
+        return 1;
+    }
+
     outln("Running {} cases out of {}.", matching_tests.size(), m_cases.size());
 
-    return run(matching_tests);
+    auto failed_count = run(matching_tests);
+    if (!m_benchmark_json_path.is_empty() && !write_benchmark_results(m_benchmark_json_path))
+        failed_count++;
+    if (!m_benchmark_baseline_path.is_empty())
+        failed_count += compare_benchmark_results_with_baseline(m_benchmark_baseline_path);
+    return failed_count;
 }
 
 NonnullRefPtrVector<TestCase> TestSuite::find_cases(const String& search, bool find_tests, bool find_benchmarks)
@@ -114,16 +137,14 @@ int TestSuite::run(const NonnullRefPtrVector<TestCase>& tests)
         warnln("Running {} '{}'.", test_type, t.name());
         m_current_test_case_passed = true;
 
-        TestElapsedTimer timer;
-        t.func()();
-        const auto time = timer.elapsed_milliseconds();
-
-        dbgln("{} {} '{}' in {}ms", m_current_test_case_passed ? "Completed" : "Failed", test_type, t.name(), time);
-
         if (t.is_benchmark()) {
-            m_benchtime += time;
+            run_benchmark(t);
             benchmark_count++;
         } else {
+            TestElapsedTimer timer;
+            t.func()();
+            const auto time = timer.elapsed_milliseconds();
+            dbgln("{} {} '{}' in {}ms", m_current_test_case_passed ? "Completed" : "Failed", test_type, t.name(), time);
             m_testtime += time;
             test_count++;
         }
@@ -145,4 +166,144 @@ int TestSuite::run(const NonnullRefPtrVector<TestCase>& tests)
     return (int)test_failed_count;
 }
 
+void TestSuite::run_benchmark(const TestCase& benchmark)
+{
+    TestElapsedTimer timer;
+
+    for (int i = 0; i < m_benchmark_warmup_count && m_current_test_case_passed; ++i)
+        benchmark.func()();
+
+    BenchmarkResult result { benchmark.name(), {}, true };
+    for (int i = 0; i < m_benchmark_iteration_count && m_current_test_case_passed; ++i) {
+        TestElapsedTimer iteration_timer;
+        benchmark.func()();
+        result.samples.append(iteration_timer.elapsed_microseconds());
+    }
+    result.passed = m_current_test_case_passed;
+    quick_sort(result.samples);
+    m_benchtime += timer.elapsed_milliseconds();
+
+    if (result.samples.is_empty()) {
+        dbgln("Failed benchmark '{}' while warming up", result.name);
+        return;
+    }
+
+    if (result.samples.size() == 1) {
+        dbgln("{} benchmark '{}' in {}ms", result.passed ? "Completed" : "Failed", result.name, result.samples[0] / 1000);
+    } else {
+        dbgln("{} benchmark '{}' in {} iterations: median {}us, mean {:.0}us, min {}us, max {}us, standard deviation {:.0}us",
+            result.passed ? "Completed" : "Failed",
+            result.name,
+            result.samples.size(),
+            result.median(),
+            result.mean(),
+            result.samples.first(),
+            result.samples.last(),
+            result.standard_deviation());
+    }
+
+    m_benchmark_results.append(move(result));
+}
+
+u64 TestSuite::BenchmarkResult::median() const
+{
+    auto middle = samples.size() / 2;
+    if (samples.size() % 2 == 0)
+        return (samples[middle - 1] + samples[middle]) / 2;
+    return samples[middle];
+}
+
+double TestSuite::BenchmarkResult::mean() const
+{
+    u64 sum = 0;
+    for (auto sample : samples)
+        sum += sample;
+    return static_cast<double>(sum) / samples.size();
+}
+
+double TestSuite::BenchmarkResult::standard_deviation() const
+{
+    auto average = mean();
+    double sum_of_squares = 0;
+    for (auto sample : samples)
+        sum_of_squares += (sample - average) * (sample - average);
+    return AK::sqrt(sum_of_squares / samples.size());
+}
+
+bool TestSuite::write_benchmark_results(const String& path) const
+{
+    JsonArray benchmarks;
+    for (auto& result : m_benchmark_results) {
+        JsonObject benchmark;
+        benchmark.set("name", result.name);
+        benchmark.set("passed", result.passed);
+        benchmark.set("iterations", result.samples.size());
+        benchmark.set("median_us", result.median());
+        benchmark.set("mean_us", result.mean());
+        benchmark.set("min_us", result.samples.first());
+        benchmark.set("max_us", result.samples.last());
+        benchmark.set("standard_deviation_us", result.standard_deviation());
+        benchmarks.append(move(benchmark));
+    }
+
+    JsonObject report;
+    report.set("suite", LexicalPath::basename(m_suite_name));
+    report.set("benchmarks", move(benchmarks));
+
+    auto file_or_error = Core::File::open(path, Core::OpenMode::WriteOnly);
+    if (file_or_error.is_error()) {
+        warnln("Failed to open {}: {}", path, file_or_error.error());
+        return false;
+    }
+    auto json = report.to_string();
+    if (!file_or_error.value()->write(json)) {
+        warnln("Failed to write {}: {}", path, file_or_error.value()->error_string());
+        return false;
+    }
+    return true;
+}
+
+size_t TestSuite::compare_benchmark_results_with_baseline(const String& path) const
+{
+    auto file_or_error = Core::File::open(path, Core::OpenMode::ReadOnly);
+    if (file_or_error.is_error()) {
+        // A benchmark suite that is new has nothing to compare with yet.
+        warnln("No benchmark baseline in {}: {}", path, file_or_error.error());
+        return 0;
+    }
+    auto json = JsonValue::from_string(file_or_error.value()->read_all());
+    if (!json.has_value() || !json->is_object() || !json->as_object().get("benchmarks").is_array()) {
+        warnln("Invalid benchmark baseline in {}", path);
+        return 1;
+    }
+
+    HashMap<String, u64> baseline_medians;
+    json->as_object().get("benchmarks").as_array().for_each([&](auto& benchmark) {
+        if (!benchmark.is_object())
+            return;
+        auto& name = benchmark.as_object().get("name");
+        auto& median = benchmark.as_object().get("median_us");
+        if (name.is_string() && median.is_number())
+            baseline_medians.set(name.as_string(), median.to_u64());
+    });
+
+    size_t regression_count = 0;
+    for (auto& result : m_benchmark_results) {
+        auto baseline_median = baseline_medians.get(result.name);
+        if (!baseline_median.has_value() || baseline_median.value() == 0)
+            continue;
+        auto change_percent = (static_cast<double>(result.median()) - baseline_median.value()) * 100 / baseline_median.value();
+        bool regressed = change_percent > m_benchmark_max_regression_percent;
+        if (regressed)
+            regression_count++;
+        dbgln("{} benchmark '{}': median {}us, was {}us ({:+.1}%)",
+            regressed ? "Regressed" : "Compared",
+            result.name,
+            result.median(),
+            baseline_median.value(),
+            change_percent);
+    }
+    return regression_count;
+}
+
 }
@@ -13,6 +13,7 @@
 #include <AK/Function.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/String.h>
+#include <AK/Vector.h>
 #include <LibTest/TestCase.h>
 
 namespace Test {
@@ -44,12 +45,35 @@ public:
     void current_test_case_did_fail() { m_current_test_case_passed = false; }
 
 private:
+    struct BenchmarkResult {
+        String name;
+        // The time every measured run took, in microseconds, from fastest to slowest.
+        Vector<u64> samples;
+        bool passed { true };
+
+        u64 median() const;
+        double mean() const;
+        double standard_deviation() const;
+    };
+
+    void run_benchmark(const TestCase&);
+    bool write_benchmark_results(const String& path) const;
+    // Returns the number of benchmarks that got slower than the baseline allows.
+    size_t compare_benchmark_results_with_baseline(const String& path) const;
+
     static TestSuite* s_global;
     NonnullRefPtrVector<TestCase> m_cases;
     u64 m_testtime = 0;
     u64 m_benchtime = 0;
     String m_suite_name;
     bool m_current_test_case_passed = true;
+
+    int m_benchmark_warmup_count { 0 };
+    int m_benchmark_iteration_count { 1 };
+    String m_benchmark_json_path;
+    String m_benchmark_baseline_path;
+    int m_benchmark_max_regression_percent { 10 };
+    Vector<BenchmarkResult> m_benchmark_results;
 };
 
 }
@@ -7,77 +7,68 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
 #include <AK/Function.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/Optional.h>
-#include <AK/Queue.h>
 #include <LibCore/Event.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/Object.h>
-#include <LibThreading/Thread.h>
+#include <LibThreading/ThreadPool.h>
 
 namespace Threading {
 
+// Runs the action on the ThreadPool, and then calls on_complete with its result from the event loop.
 template<typename Result>
-class BackgroundAction;
-
-class BackgroundActionBase {
-    template<typename Result>
-    friend class BackgroundAction;
-
-private:
-    BackgroundActionBase() { }
-
-    static void enqueue_work(Function<void()>);
-    static Thread& background_thread();
-};
-
-template<typename Result>
-class BackgroundAction final : public Core::Object
-    , private BackgroundActionBase {
+class BackgroundAction final : public Core::Object {
     C_OBJECT(BackgroundAction);
 
 public:
     static NonnullRefPtr<BackgroundAction<Result>> create(
         Function<Result(BackgroundAction&)> action,
-        Function<void(Result)> on_complete = nullptr)
+        Function<void(Result)> on_complete = nullptr,
+        WorkPriority priority = WorkPriority::Normal)
     {
-        return adopt_ref(*new BackgroundAction(move(action), move(on_complete)));
+        return adopt_ref(*new BackgroundAction(move(action), move(on_complete), priority));
     }
 
+    // An action that is cancelled before it got to run is dropped without calling either of its functions.
+    // Once it's running, it's up to the action to check is_cancelled().
     void cancel()
     {
-        m_cancelled = true;
+        m_cancelled.store(true, AK::MemoryOrder::memory_order_relaxed);
     }
 
     bool is_cancelled() const
     {
-        return m_cancelled;
+        return m_cancelled.load(AK::MemoryOrder::memory_order_relaxed);
     }
 
     virtual ~BackgroundAction() { }
 
 private:
-    BackgroundAction(Function<Result(BackgroundAction&)> action, Function<void(Result)> on_complete)
-        : Core::Object(&background_thread())
-        , m_action(move(action))
+    BackgroundAction(Function<Result(BackgroundAction&)> action, Function<void(Result)> on_complete, WorkPriority priority)
+        : m_action(move(action))
         , m_on_complete(move(on_complete))
     {
-        enqueue_work([this] {
-            m_result = m_action(*this);
-            if (m_on_complete) {
-                Core::EventLoop::current().post_event(*this, make<Core::DeferredInvocationEvent>([this](auto&) {
-                    m_on_complete(m_result.release_value());
-                    this->remove_from_parent();
-                }));
-                Core::EventLoop::wake();
-            } else {
-                this->remove_from_parent();
-            }
-        });
+        // The queued work keeps the action alive until it has completed, as the worker threads can't safely share
+        // a parent object to hang it off.
+        ThreadPool::enqueue([self = NonnullRefPtr(*this)]() mutable {
+            if (self->is_cancelled())
+                return;
+            self->m_result = self->m_action(*self);
+            if (!self->m_on_complete)
+                return;
+            auto& action = *self;
+            Core::EventLoop::current().post_event(action, make<Core::DeferredInvocationEvent>([self = move(self)](auto&) mutable {
+                self->m_on_complete(self->m_result.release_value());
+            }));
+            Core::EventLoop::wake();
+        },
+            priority);
     }
 
-    bool m_cancelled { false };
+    Atomic<bool> m_cancelled { false };
     Function<Result(BackgroundAction&)> m_action;
     Function<void(Result)> m_on_complete;
     Optional<Result> m_result;
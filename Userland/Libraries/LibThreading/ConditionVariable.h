@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Noncopyable.h>
+#include <LibThreading/Mutex.h>
+#include <pthread.h>
+
+namespace Threading {
+
+class ConditionVariable {
+    AK_MAKE_NONCOPYABLE(ConditionVariable);
+    AK_MAKE_NONMOVABLE(ConditionVariable);
+
+public:
+    ConditionVariable() { pthread_cond_init(&m_condition, nullptr); }
+    ~ConditionVariable() { pthread_cond_destroy(&m_condition); }
+
+    // The mutex has to be locked (exactly once) by the calling thread, and is locked again when this returns.
+    // As wakeups can be spurious, this should be called in a loop; wait_while() does that.
+    void wait(Mutex& mutex) { pthread_cond_wait(&m_condition, &mutex.m_mutex); }
+
+    template<typename Condition>
+    void wait_while(Mutex& mutex, Condition condition)
+    {
+        while (condition())
+            wait(mutex);
+    }
+
+    void signal() { pthread_cond_signal(&m_condition); }
+    void broadcast() { pthread_cond_broadcast(&m_condition); }
+
+private:
+    pthread_cond_t m_condition;
+};
+
+}
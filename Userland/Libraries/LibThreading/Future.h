@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/Noncopyable.h>
+#include <AK/Optional.h>
+#include <LibThreading/TaskGroup.h>
+
+namespace Threading {
+
+// Starts computing a value on the ThreadPool as soon as it's created. If no pool thread got to it by the time it's
+// awaited, it's computed on the awaiting thread instead.
+template<typename T>
+class Future {
+    AK_MAKE_NONCOPYABLE(Future);
+    AK_MAKE_NONMOVABLE(Future);
+
+public:
+    explicit Future(Function<T()> function)
+    {
+        m_group.spawn([this, function = move(function)] {
+            m_value = function();
+        });
+    }
+
+    T& await()
+    {
+        m_group.wait();
+        return m_value.value();
+    }
+
+private:
+    Optional<T> m_value;
+    TaskGroup m_group;
+};
+
+}
@@ -29,6 +29,8 @@ public:
     void unlock();
 
 private:
+    friend class ConditionVariable;
+
 #ifdef __serenity__
     pthread_mutex_t m_mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
 #else
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Noncopyable.h>
+#include <AK/Types.h>
+#include <pthread.h>
+
+namespace Threading {
+
+// Lets any number of readers in at once, but only one writer and no readers while it's in there.
+// Waiting writers keep new readers out, so a steady stream of readers can't starve them.
+class RWLock {
+    AK_MAKE_NONCOPYABLE(RWLock);
+    AK_MAKE_NONMOVABLE(RWLock);
+
+public:
+    RWLock() { pthread_rwlock_init(&m_rwlock, nullptr); }
+    ~RWLock() { pthread_rwlock_destroy(&m_rwlock); }
+
+    void lock_read() { pthread_rwlock_rdlock(&m_rwlock); }
+    void lock_write() { pthread_rwlock_wrlock(&m_rwlock); }
+    void unlock() { pthread_rwlock_unlock(&m_rwlock); }
+
+private:
+    pthread_rwlock_t m_rwlock;
+};
+
+class RWLockReadLocker {
+public:
+    ALWAYS_INLINE explicit RWLockReadLocker(RWLock& lock)
+        : m_lock(lock)
+    {
+        m_lock.lock_read();
+    }
+    ALWAYS_INLINE ~RWLockReadLocker() { m_lock.unlock(); }
+
+private:
+    RWLock& m_lock;
+};
+
+class RWLockWriteLocker {
+public:
+    ALWAYS_INLINE explicit RWLockWriteLocker(RWLock& lock)
+        : m_lock(lock)
+    {
+        m_lock.lock_write();
+    }
+    ALWAYS_INLINE ~RWLockWriteLocker() { m_lock.unlock(); }
+
+private:
+    RWLock& m_lock;
+};
+
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibThreading/ReadAheadStream.h>
+
+namespace Threading {
+
+ReadAheadStream::ReadAheadStream(InputStream& stream, size_t chunk_size, size_t chunk_count)
+    : m_stream(stream)
+    , m_chunk_size(chunk_size)
+    , m_chunk_count(chunk_count)
+{
+    VERIFY(chunk_size > 0 && chunk_count > 0);
+    m_thread = Thread::construct([this] {
+        read_ahead();
+        return 0;
+    },
+        "ReadAheadStream");
+    m_thread->start();
+}
+
+ReadAheadStream::~ReadAheadStream()
+{
+    {
+        MutexLocker locker(m_mutex);
+        m_stopping = true;
+        m_condition.broadcast();
+    }
+    (void)m_thread->join();
+}
+
+void ReadAheadStream::read_ahead()
+{
+    for (;;) {
+        auto chunk = ByteBuffer::create_uninitialized(m_chunk_size);
+        size_t nread = 0;
+        bool reached_end = false;
+        while (nread < m_chunk_size) {
+            auto nread_now = m_stream.read(chunk.bytes().slice(nread));
+            if (nread_now == 0) {
+                reached_end = true;
+                break;
+            }
+            nread += nread_now;
+        }
+        bool failed = m_stream.handle_any_error();
+        chunk.resize(nread);
+
+        MutexLocker locker(m_mutex);
+        m_condition.wait_while(m_mutex, [&] { return m_chunks.size() >= m_chunk_count && !m_stopping; });
+        if (m_stopping)
+            return;
+        if (!chunk.is_empty())
+            m_chunks.enqueue(move(chunk));
+        m_reached_end = reached_end || failed;
+        m_failed = failed;
+        m_condition.broadcast();
+        if (m_reached_end)
+            return;
+    }
+}
+
+bool ReadAheadStream::next_chunk()
+{
+    MutexLocker locker(m_mutex);
+    m_condition.wait_while(m_mutex, [&] { return m_chunks.is_empty() && !m_reached_end; });
+    if (m_chunks.is_empty()) {
+        if (m_failed)
+            set_fatal_error();
+        return false;
+    }
+    m_current_chunk = m_chunks.dequeue();
+    m_offset_in_current_chunk = 0;
+    m_condition.broadcast();
+    return true;
+}
+
+size_t ReadAheadStream::read(Bytes bytes)
+{
+    if (has_any_error())
+        return 0;
+
+    size_t nread = 0;
+    while (nread < bytes.size()) {
+        if (m_offset_in_current_chunk == m_current_chunk.size() && !next_chunk())
+            break;
+        auto available = m_current_chunk.bytes().slice(m_offset_in_current_chunk);
+        auto ncopied = available.copy_trimmed_to(bytes.slice(nread));
+        m_offset_in_current_chunk += ncopied;
+        nread += ncopied;
+    }
+    return nread;
+}
+
+bool ReadAheadStream::unreliable_eof() const
+{
+    if (m_offset_in_current_chunk < m_current_chunk.size())
+        return false;
+    MutexLocker locker(m_mutex);
+    return m_chunks.is_empty() && m_reached_end;
+}
+
+bool ReadAheadStream::read_or_error(Bytes bytes)
+{
+    if (read(bytes) < bytes.size()) {
+        set_fatal_error();
+        return false;
+    }
+    return true;
+}
+
+bool ReadAheadStream::discard_or_error(size_t count)
+{
+    while (count > 0) {
+        if (m_offset_in_current_chunk == m_current_chunk.size() && !next_chunk()) {
+            set_fatal_error();
+            return false;
+        }
+        auto ndiscarded = min(count, m_current_chunk.size() - m_offset_in_current_chunk);
+        m_offset_in_current_chunk += ndiscarded;
+        count -= ndiscarded;
+    }
+    return true;
+}
+
+}
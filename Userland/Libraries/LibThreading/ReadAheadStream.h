@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Queue.h>
+#include <AK/Stream.h>
+#include <LibThreading/ConditionVariable.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/Thread.h>
+
+namespace Threading {
+
+// Reads another stream on a thread of its own, so that whatever produces its data (a decompressor, say) keeps
+// running while the reader of this stream is busy with the data it already got. Up to chunk_count chunks of
+// chunk_size bytes are read ahead.
+// Errors of the other stream are handled on that thread, and show up as a fatal error of this one once all
+// data before them has been read.
+class ReadAheadStream final : public InputStream {
+public:
+    explicit ReadAheadStream(InputStream&, size_t chunk_size = 64 * KiB, size_t chunk_count = 4);
+    virtual ~ReadAheadStream() override;
+
+    virtual size_t read(Bytes) override;
+    virtual bool unreliable_eof() const override;
+    virtual bool read_or_error(Bytes) override;
+    virtual bool discard_or_error(size_t count) override;
+
+private:
+    void read_ahead();
+    bool next_chunk();
+
+    InputStream& m_stream;
+    size_t m_chunk_size { 0 };
+    size_t m_chunk_count { 0 };
+    RefPtr<Thread> m_thread;
+
+    mutable Mutex m_mutex;
+    ConditionVariable m_condition;
+    Queue<ByteBuffer> m_chunks;
+    bool m_reached_end { false };
+    bool m_failed { false };
+    bool m_stopping { false };
+
+    // Only touched by the reading thread.
+    ByteBuffer m_current_chunk;
+    size_t m_offset_in_current_chunk { 0 };
+};
+
+}
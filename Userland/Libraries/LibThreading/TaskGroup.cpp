@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibThreading/TaskGroup.h>
+
+namespace Threading {
+
+TaskGroup::State::State()
+{
+    pthread_mutex_init(&mutex, nullptr);
+    pthread_cond_init(&condition, nullptr);
+}
+
+TaskGroup::State::~State()
+{
+    pthread_cond_destroy(&condition);
+    pthread_mutex_destroy(&mutex);
+}
+
+bool TaskGroup::State::run_one_task()
+{
+    pthread_mutex_lock(&mutex);
+    if (tasks.is_empty()) {
+        pthread_mutex_unlock(&mutex);
+        return false;
+    }
+    auto task = tasks.dequeue();
+    pthread_mutex_unlock(&mutex);
+
+    task();
+
+    pthread_mutex_lock(&mutex);
+    if (--unfinished_task_count == 0)
+        pthread_cond_broadcast(&condition);
+    pthread_mutex_unlock(&mutex);
+    return true;
+}
+
+TaskGroup::TaskGroup()
+    : m_state(adopt_ref(*new State))
+{
+}
+
+void TaskGroup::spawn(Function<void()> task)
+{
+    pthread_mutex_lock(&m_state->mutex);
+    m_state->tasks.enqueue(move(task));
+    ++m_state->unfinished_task_count;
+    pthread_mutex_unlock(&m_state->mutex);
+
+    // Every task gets a turn on the pool, which may well find that somebody else already ran it.
+    ThreadPool::enqueue([state = m_state]() mutable { state->run_one_task(); }, WorkPriority::High);
+}
+
+void TaskGroup::wait()
+{
+    while (m_state->run_one_task())
+        ;
+
+    pthread_mutex_lock(&m_state->mutex);
+    while (m_state->unfinished_task_count > 0)
+        pthread_cond_wait(&m_state->condition, &m_state->mutex);
+    pthread_mutex_unlock(&m_state->mutex);
+}
+
+}
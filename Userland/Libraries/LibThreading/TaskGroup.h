@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/Noncopyable.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Queue.h>
+#include <AK/RefCounted.h>
+#include <AK/StdLibExtras.h>
+#include <LibThreading/ThreadPool.h>
+#include <pthread.h>
+
+namespace Threading {
+
+// A set of tasks that run on the ThreadPool and can be waited for together.
+// While waiting, the calling thread runs the tasks that no pool thread has picked up yet itself, so waiting from a
+// task that's already running on the pool (or while the pool is busy with other work) can't deadlock.
+class TaskGroup {
+    AK_MAKE_NONCOPYABLE(TaskGroup);
+    AK_MAKE_NONMOVABLE(TaskGroup);
+
+public:
+    TaskGroup();
+    ~TaskGroup() { wait(); }
+
+    void spawn(Function<void()>);
+    void wait();
+
+private:
+    // The pool threads may still get to their share of the work after the group is gone.
+    class State : public RefCounted<State> {
+    public:
+        State();
+        ~State();
+
+        bool run_one_task();
+
+        pthread_mutex_t mutex;
+        pthread_cond_t condition;
+        Queue<Function<void()>> tasks;
+        size_t unfinished_task_count { 0 };
+    };
+
+    NonnullRefPtr<State> m_state;
+};
+
+// Calls callback(i) for every i in [begin, end), spread across the ThreadPool in chunks of at least grain_size.
+template<typename Callback>
+void parallel_for(size_t begin, size_t end, Callback callback, size_t grain_size = 1)
+{
+    if (begin >= end)
+        return;
+    size_t count = end - begin;
+    // A few chunks per thread even out differences in how long each of them takes.
+    size_t chunk_count = min(ceil_div(count, max(grain_size, (size_t)1)), ThreadPool::max_thread_count() * 4);
+    if (chunk_count <= 1) {
+        for (size_t i = begin; i < end; ++i)
+            callback(i);
+        return;
+    }
+
+    size_t chunk_size = ceil_div(count, chunk_count);
+    TaskGroup group;
+    for (size_t chunk_begin = begin; chunk_begin < end; chunk_begin += chunk_size) {
+        size_t chunk_end = min(chunk_begin + chunk_size, end);
+        group.spawn([&callback, chunk_begin, chunk_end] {
+            for (size_t i = chunk_begin; i < chunk_end; ++i)
+                callback(i);
+        });
+    }
+    group.wait();
+}
+
+}
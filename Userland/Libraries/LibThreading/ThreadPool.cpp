@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2019-2020, Sergey Bugaev <bugaevc@serenityos.org>
+ * Copyright (c) 2021, Andreas Kling <kling@serenityos.org>
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/Optional.h>
+#include <AK/Queue.h>
+#include <LibThreading/Thread.h>
+#include <LibThreading/ThreadPool.h>
+#include <unistd.h>
+
+static constexpr size_t priority_count = 3;
+
+static pthread_mutex_t s_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_condition = PTHREAD_COND_INITIALIZER;
+// One queue per priority, the highest one last.
+static Array<Queue<Function<void()>>, priority_count>* s_queues;
+static size_t s_queued_work_count;
+static size_t s_idle_thread_count;
+static size_t s_thread_count;
+static size_t s_max_thread_count;
+
+// Must be called with s_mutex held.
+static Optional<Function<void()>> dequeue_work()
+{
+    for (size_t i = priority_count; i > 0; --i) {
+        auto& queue = s_queues->at(i - 1);
+        if (!queue.is_empty()) {
+            --s_queued_work_count;
+            return queue.dequeue();
+        }
+    }
+    return {};
+}
+
+static intptr_t background_thread_func()
+{
+    while (true) {
+        pthread_mutex_lock(&s_mutex);
+
+        ++s_idle_thread_count;
+        auto work = dequeue_work();
+        while (!work.has_value()) {
+            pthread_cond_wait(&s_condition, &s_mutex);
+            work = dequeue_work();
+        }
+        --s_idle_thread_count;
+
+        pthread_mutex_unlock(&s_mutex);
+
+        work.value()();
+    }
+}
+
+// Must be called with s_mutex held.
+static void spawn_thread()
+{
+    auto& thread = Threading::Thread::construct(background_thread_func).leak_ref();
+    thread.set_name("Background thread");
+    thread.start();
+    ++s_thread_count;
+}
+
+// Must be called with s_mutex held.
+static void init()
+{
+    s_queues = new Array<Queue<Function<void()>>, priority_count>;
+    long processor_count = sysconf(_SC_NPROCESSORS_ONLN);
+    s_max_thread_count = processor_count > 0 ? processor_count : 1;
+}
+
+// Must be called with s_mutex held.
+static void init_if_needed()
+{
+    if (s_queues == nullptr)
+        init();
+}
+
+void Threading::ThreadPool::enqueue(Function<void()> work, WorkPriority priority)
+{
+    pthread_mutex_lock(&s_mutex);
+
+    init_if_needed();
+
+    s_queues->at(static_cast<size_t>(priority)).enqueue(move(work));
+    ++s_queued_work_count;
+
+    // Idle threads that have been woken up but didn't get to dequeue anything yet still count as idle.
+    if (s_queued_work_count > s_idle_thread_count && s_thread_count < s_max_thread_count)
+        spawn_thread();
+
+    pthread_cond_signal(&s_condition);
+    pthread_mutex_unlock(&s_mutex);
+}
+
+size_t Threading::ThreadPool::max_thread_count()
+{
+    pthread_mutex_lock(&s_mutex);
+    init_if_needed();
+    auto count = s_max_thread_count;
+    pthread_mutex_unlock(&s_mutex);
+    return count;
+}
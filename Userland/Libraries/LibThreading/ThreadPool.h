@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+
+namespace Threading {
+
+// Work of a higher priority is started before any waiting work of a lower priority, but never interrupts it.
+enum class WorkPriority {
+    Low,
+    Normal,
+    High,
+};
+
+// The process-wide pool of threads that BackgroundAction, TaskGroup and Future run their work on. It has up to
+// one thread per CPU, and is only grown while all of its threads are busy.
+namespace ThreadPool {
+
+void enqueue(Function<void()>, WorkPriority = WorkPriority::Normal);
+size_t max_thread_count();
+
+}
+
+}
@@ -42,7 +42,8 @@ u8 BitStream::read_f8()
     if (!m_current_byte.has_value())
         return read_byte();
 
-    auto high_bits = m_current_byte.value() & ((1u << m_current_bit_position) - 1);
+    // The bits left in the current byte, including the one at m_current_bit_position, are the high bits.
+    auto high_bits = m_current_byte.value() & ((1u << (m_current_bit_position + 1)) - 1);
     u8 remaining_bits = 7 - m_current_bit_position;
     m_current_byte = read_byte();
     m_current_bit_position = 7;
@@ -53,7 +54,25 @@ u8 BitStream::read_f8()
 
 u16 BitStream::read_f16()
 {
-    return (read_f8() << 8u) | read_f8();
+    u16 high_byte = read_f8();
+    return (high_byte << 8u) | read_f8();
+}
+
+u32 BitStream::read_f32()
+{
+    u32 high_half = read_f16();
+    return (high_half << 16u) | read_f16();
+}
+
+Optional<BitStream> BitStream::split_off(size_t size)
+{
+    VERIFY(!m_current_byte.has_value());
+    if (size > m_bytes_remaining)
+        return {};
+    BitStream stream { m_data_ptr, size };
+    m_data_ptr += size;
+    m_bytes_remaining -= size;
+    return stream;
 }
 
 /* 9.2.1 */
@@ -26,6 +26,11 @@ public:
     u8 read_f(size_t n);
     u8 read_f8();
     u16 read_f16();
+    u32 read_f32();
+
+    // Splits the next size bytes off into a stream of their own, so they can be read independently of this one.
+    // This stream must be at a byte boundary.
+    Optional<BitStream> split_off(size_t size);
 
     /* (9.2) */
     bool init_bool(size_t bytes);
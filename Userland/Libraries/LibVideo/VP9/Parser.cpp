@@ -7,6 +7,7 @@
 #include "Parser.h"
 #include "Decoder.h"
 #include "Utilities.h"
+#include <AK/ScopeGuard.h>
 
 namespace Video::VP9 {
 
@@ -764,15 +765,31 @@ bool Parser::decode_tiles()
     auto tile_rows = 1 << m_tile_rows_log2;
     allocate_tile_data();
     SAFE_CALL(clear_above_context());
+
+    // Find where every tile's data is before decoding any of them, so that each tile is read from its own stream.
+    Vector<BitStream> tile_bit_streams;
+    tile_bit_streams.ensure_capacity(tile_rows * tile_cols);
     for (auto tile_row = 0; tile_row < tile_rows; tile_row++) {
         for (auto tile_col = 0; tile_col < tile_cols; tile_col++) {
             auto last_tile = (tile_row == tile_rows - 1) && (tile_col == tile_cols - 1);
-            auto tile_size = last_tile ? m_bit_stream->bytes_remaining() : m_bit_stream->read_f(32);
+            auto tile_size = last_tile ? m_bit_stream->bytes_remaining() : m_bit_stream->read_f32();
+            auto tile_bit_stream = m_bit_stream->split_off(tile_size);
+            if (!tile_bit_stream.has_value())
+                return false;
+            tile_bit_streams.unchecked_append(tile_bit_stream.release_value());
+        }
+    }
+
+    auto frame_bit_stream = m_bit_stream.release_nonnull();
+    ScopeGuard restore_frame_bit_stream = [&] { m_bit_stream = move(frame_bit_stream); };
+    for (auto tile_row = 0; tile_row < tile_rows; tile_row++) {
+        for (auto tile_col = 0; tile_col < tile_cols; tile_col++) {
+            m_bit_stream = make<BitStream>(tile_bit_streams[tile_row * tile_cols + tile_col]);
             m_mi_row_start = get_tile_offset(tile_row, m_mi_rows, m_tile_rows_log2);
             m_mi_row_end = get_tile_offset(tile_row + 1, m_mi_rows, m_tile_rows_log2);
             m_mi_col_start = get_tile_offset(tile_col, m_mi_cols, m_tile_cols_log2);
             m_mi_col_end = get_tile_offset(tile_col + 1, m_mi_cols, m_tile_cols_log2);
-            SAFE_CALL(m_bit_stream->init_bool(tile_size));
+            SAFE_CALL(m_bit_stream->init_bool(m_bit_stream->bytes_remaining()));
             SAFE_CALL(decode_tile());
             SAFE_CALL(m_bit_stream->exit_bool());
         }
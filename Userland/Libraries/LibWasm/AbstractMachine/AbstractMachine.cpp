@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <LibThreading/TaskGroup.h>
 #include <LibWasm/AbstractMachine/AbstractMachine.h>
 #include <LibWasm/AbstractMachine/BytecodeInterpreter.h>
 #include <LibWasm/AbstractMachine/Configuration.h>
@@ -23,6 +24,15 @@ Optional<FunctionAddress> Store::allocate(ModuleInstance& module, Module::Functi
     return address;
 }
 
+RefPtr<CompiledFunction> WasmFunction::compiled_code(Store& store)
+{
+    if (!m_has_tried_compiling) {
+        m_has_tried_compiling = true;
+        m_compiled_code = compile_function(store, m_module, m_type, m_code.locals(), m_code.body());
+    }
+    return m_compiled_code;
+}
+
 Optional<FunctionAddress> Store::allocate(HostFunction&& function)
 {
     FunctionAddress address { m_functions.size() };
@@ -318,6 +328,22 @@ InstantiationResult AbstractMachine::instantiate(Module const& module, Vector<Ex
         }
     });
 
+    if (!instantiation_result.has_value()) {
+        // Compile the module's own functions up front instead of on their first call, spread across the ThreadPool.
+        // Compiling only reads from the store, and every function only writes its own compiled code.
+        Vector<WasmFunction*> functions_to_compile;
+        for (auto& address : main_module_instance.functions()) {
+            auto* function = m_store.get(address);
+            if (!function)
+                continue;
+            if (auto* wasm_function = function->get_pointer<WasmFunction>(); wasm_function && &wasm_function->module() == &main_module_instance)
+                functions_to_compile.append(wasm_function);
+        }
+        Threading::parallel_for(0, functions_to_compile.size(), [&](size_t i) {
+            (void)functions_to_compile[i]->compiled_code(m_store);
+        });
+    }
+
     module.for_each_section_of_type<StartSection>([&](StartSection const& section) {
         auto& functions = main_module_instance.functions();
         auto index = section.function().index();
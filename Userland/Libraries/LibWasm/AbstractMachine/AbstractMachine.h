@@ -11,6 +11,7 @@
 #include <AK/HashTable.h>
 #include <AK/OwnPtr.h>
 #include <AK/Result.h>
+#include <LibWasm/AbstractMachine/Compiler.h>
 #include <LibWasm/Types.h>
 
 namespace Wasm {
@@ -291,10 +292,15 @@ public:
     auto& module() const { return m_module; }
     auto& code() const { return m_code; }
 
+    // Compiles the function the first time it's called; returns null if it can't be compiled.
+    RefPtr<CompiledFunction> compiled_code(Store&);
+
 private:
     FunctionType m_type;
     ModuleInstance const& m_module;
     Module::Function const& m_code;
+    RefPtr<CompiledFunction> m_compiled_code;
+    bool m_has_tried_compiling { false };
 };
 
 class HostFunction {
@@ -358,6 +364,14 @@ public:
                 return false;
         }
         auto previous_size = m_size;
+        // Growing past the capacity of the buffer moves (and copies) all of the memory, so the capacity at least doubles
+        // each time. Anything more up front would cost memory the module may never use.
+        if (new_size > m_data.capacity()) {
+            // The largest memory is 4 GiB, which doesn't fit in a size_t on 32-bit targets, so this is worked out in u64.
+            auto max_size = static_cast<u64>(m_type.limits().max().value_or(65536)) * Constants::page_size;
+            auto new_capacity = clamp(static_cast<u64>(m_data.capacity()) * 2, static_cast<u64>(new_size), max_size);
+            m_data.ensure_capacity(static_cast<size_t>(min(new_capacity, static_cast<u64>(NumericLimits<size_t>::max()))));
+        }
         m_data.resize(new_size);
         m_size = new_size;
         // The spec requires that we zero out everything on grow
@@ -451,11 +465,12 @@ private:
 
 class Frame {
 public:
-    explicit Frame(ModuleInstance const& module, Vector<Value> locals, Expression const& expression, size_t arity)
+    explicit Frame(ModuleInstance const& module, Vector<Value> locals, Expression const& expression, size_t arity, RefPtr<CompiledFunction> compiled_code = {})
         : m_module(module)
         , m_locals(move(locals))
         , m_expression(expression)
         , m_arity(arity)
+        , m_compiled_code(move(compiled_code))
     {
     }
 
@@ -464,12 +479,14 @@ public:
     auto& locals() { return m_locals; }
     auto& expression() const { return m_expression; }
     auto arity() const { return m_arity; }
+    auto& compiled_code() const { return m_compiled_code; }
 
 private:
     ModuleInstance const& m_module;
     Vector<Value> m_locals;
     Expression const& m_expression;
     size_t m_arity { 0 };
+    RefPtr<CompiledFunction> m_compiled_code;
 };
 
 class Stack {
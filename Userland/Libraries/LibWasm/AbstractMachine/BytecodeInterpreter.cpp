@@ -34,6 +34,9 @@ void BytecodeInterpreter::interpret(Configuration& configuration)
 {
     m_stack_info = {};
     m_trap.clear();
+    if (auto& compiled_code = configuration.frame().compiled_code(); compiled_code && can_run_compiled_code())
+        return interpret_compiled(configuration, *compiled_code);
+
     auto& instructions = configuration.frame().expression().instructions();
     auto max_ip_value = InstructionPointer { instructions.size() };
     auto& current_ip_value = configuration.ip();
@@ -877,7 +880,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     case Instructions::f64_le.value():
         BINARY_NUMERIC_OPERATION(double, <=, i32);
     case Instructions::f64_ge.value():
-        BINARY_NUMERIC_OPERATION(double, >, i32);
+        BINARY_NUMERIC_OPERATION(double, >=, i32);
     case Instructions::i32_clz.value():
         UNARY_NUMERIC_OPERATION(i32, clz);
     case Instructions::i32_ctz.value():
@@ -895,7 +898,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     case Instructions::i32_divu.value():
         BINARY_NUMERIC_OPERATION(u32, /, i32, TRAP_IF_NOT(rhs.value() != 0));
     case Instructions::i32_rems.value():
-        BINARY_NUMERIC_OPERATION(i32, %, i32, TRAP_IF_NOT(!(Checked<i32>(lhs.value()) /= rhs.value()).has_overflow()));
+        BINARY_NUMERIC_OPERATION(i32, %, i32, TRAP_IF_NOT(rhs.value() != 0); if (rhs.value() == -1) rhs = 1);
     case Instructions::i32_remu.value():
         BINARY_NUMERIC_OPERATION(u32, %, i32, TRAP_IF_NOT(rhs.value() != 0));
     case Instructions::i32_and.value():
@@ -907,7 +910,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     case Instructions::i32_shl.value():
         BINARY_NUMERIC_OPERATION(u32, <<, i32, (rhs = rhs.value() % 32));
     case Instructions::i32_shrs.value():
-        BINARY_NUMERIC_OPERATION(u32, >>, i32, (rhs = rhs.value() % 32)); // FIXME: eh, shouldn't we keep lhs as signed?
+        BINARY_NUMERIC_OPERATION(i32, >>, i32, (rhs = rhs.value() & 31));
     case Instructions::i32_shru.value():
         BINARY_NUMERIC_OPERATION(u32, >>, i32, (rhs = rhs.value() % 32));
     case Instructions::i32_rotl.value():
@@ -931,7 +934,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     case Instructions::i64_divu.value():
         OVF_CHECKED_BINARY_NUMERIC_OPERATION(u64, /, i64, TRAP_IF_NOT(rhs.value() != 0));
     case Instructions::i64_rems.value():
-        BINARY_NUMERIC_OPERATION(i64, %, i64, TRAP_IF_NOT(!(Checked<i32>(lhs.value()) /= rhs.value()).has_overflow()));
+        BINARY_NUMERIC_OPERATION(i64, %, i64, TRAP_IF_NOT(rhs.value() != 0); if (rhs.value() == -1) rhs = 1);
     case Instructions::i64_remu.value():
         BINARY_NUMERIC_OPERATION(u64, %, i64, TRAP_IF_NOT(rhs.value() != 0));
     case Instructions::i64_and.value():
@@ -943,7 +946,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     case Instructions::i64_shl.value():
         BINARY_NUMERIC_OPERATION(u64, <<, i64, (rhs = rhs.value() % 64));
     case Instructions::i64_shrs.value():
-        BINARY_NUMERIC_OPERATION(u64, >>, i64, (rhs = rhs.value() % 64)); // FIXME: eh, shouldn't we keep lhs as signed?
+        BINARY_NUMERIC_OPERATION(i64, >>, i64, (rhs = rhs.value() & 63));
     case Instructions::i64_shru.value():
         BINARY_NUMERIC_OPERATION(u64, >>, i64, (rhs = rhs.value() % 64));
     case Instructions::i64_rotl.value():
@@ -961,7 +964,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     case Instructions::f32_trunc.value():
         UNARY_NUMERIC_OPERATION(float, truncf);
     case Instructions::f32_nearest.value():
-        UNARY_NUMERIC_OPERATION(float, roundf);
+        UNARY_NUMERIC_OPERATION(float, nearbyintf);
     case Instructions::f32_sqrt.value():
         UNARY_NUMERIC_OPERATION(float, sqrtf);
     case Instructions::f32_add.value():
@@ -989,7 +992,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     case Instructions::f64_trunc.value():
         UNARY_NUMERIC_OPERATION(double, trunc);
     case Instructions::f64_nearest.value():
-        UNARY_NUMERIC_OPERATION(double, round);
+        UNARY_NUMERIC_OPERATION(double, nearbyint);
     case Instructions::f64_sqrt.value():
         UNARY_NUMERIC_OPERATION(double, sqrt);
     case Instructions::f64_add.value():
@@ -1051,7 +1054,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     case Instructions::f32_convert_si64.value():
         UNARY_MAP(i64, float, float);
     case Instructions::f32_convert_ui64.value():
-        UNARY_MAP(u32, float, float);
+        UNARY_MAP(u64, float, float);
     case Instructions::f32_demote_f64.value():
         UNARY_MAP(double, float, float);
     case Instructions::f64_convert_si32.value():
@@ -1116,6 +1119,690 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     }
 }
 
+template<typename T>
+ALWAYS_INLINE static T from_slot(u64 slot)
+{
+    if constexpr (IsSame<T, float>)
+        return bit_cast<float>(static_cast<u32>(slot));
+    else if constexpr (IsSame<T, double>)
+        return bit_cast<double>(slot);
+    else
+        return static_cast<T>(slot);
+}
+
+template<typename T>
+ALWAYS_INLINE static u64 to_slot(T value)
+{
+    if constexpr (IsSame<T, float>)
+        return bit_cast<u32>(value);
+    else if constexpr (IsSame<T, double>)
+        return bit_cast<u64>(value);
+    else if constexpr (sizeof(T) <= sizeof(u32))
+        return static_cast<u32>(value);
+    else
+        return static_cast<u64>(value);
+}
+
+static u64 value_to_slot(Value const& value)
+{
+    return value.value().visit(
+        [](Reference const&) -> u64 { VERIFY_NOT_REACHED(); },
+        [](auto value) { return to_slot(value); });
+}
+
+static Value slot_to_value(ValueType const& type, u64 slot)
+{
+    switch (type.kind()) {
+    case ValueType::I32:
+        return Value(from_slot<i32>(slot));
+    case ValueType::I64:
+        return Value(from_slot<i64>(slot));
+    case ValueType::F32:
+        return Value(from_slot<float>(slot));
+    case ValueType::F64:
+        return Value(from_slot<double>(slot));
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+static bool has_same_kinds(Vector<ValueType> const& values, Vector<ValueType> const& types)
+{
+    if (values.size() != types.size())
+        return false;
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (values[i].kind() != types[i].kind())
+            return false;
+    }
+    return true;
+}
+
+template<typename T>
+ALWAYS_INLINE static T read_from_memory(u8 const* data)
+{
+    T value;
+    __builtin_memcpy(&value, data, sizeof(T));
+    return AK::convert_between_host_and_little_endian(value);
+}
+
+template<typename T>
+ALWAYS_INLINE static void write_to_memory(u8* data, T value)
+{
+    value = AK::convert_between_host_and_little_endian(value);
+    __builtin_memcpy(data, &value, sizeof(T));
+}
+
+void BytecodeInterpreter::interpret_compiled(Configuration& configuration, CompiledFunction const& function)
+{
+    auto& locals = configuration.frame().locals();
+    for (size_t i = 0; i < function.parameter_count(); ++i)
+        TRAP_IF_NOT(i < locals.size() && locals[i].type().kind() == function.local_types()[i].kind());
+
+    auto base = m_slots_in_use;
+    if (m_slots.size() < base + function.slot_count())
+        m_slots.resize(base + function.slot_count());
+    for (size_t i = 0; i < function.parameter_count(); ++i)
+        m_slots[base + i] = value_to_slot(locals[i]);
+
+    run_compiled(configuration, function, base);
+    m_slots_in_use = base;
+    if (m_trap.has_value())
+        return;
+
+    // Configuration::execute() takes the results off the stack, like after interpreting the function.
+    for (size_t i = 0; i < function.result_types().size(); ++i)
+        configuration.stack().push(slot_to_value(function.result_types()[i], m_slots[base + i]));
+}
+
+void BytecodeInterpreter::call_from_compiled(Configuration& configuration, FunctionAddress address, size_t base, size_t& stack_pointer)
+{
+    TRAP_IF_NOT(m_stack_info.size_free() >= Constants::minimum_stack_space_to_keep_free);
+
+    auto instance = configuration.store().get(address);
+    TRAP_IF_NOT(instance);
+    if (auto* wasm_function = instance->get_pointer<WasmFunction>()) {
+        if (auto compiled_code = wasm_function->compiled_code(configuration.store())) {
+            // The arguments are on top of the stack, which is exactly where the callee's locals start.
+            auto callee_base = base + stack_pointer - compiled_code->parameter_count();
+            auto slots_in_use = m_slots_in_use;
+            run_compiled(configuration, *compiled_code, callee_base);
+            m_slots_in_use = slots_in_use;
+            stack_pointer = callee_base - base + compiled_code->result_types().size();
+            return;
+        }
+    }
+
+    // Host functions and functions that can't be compiled are called with Values.
+    FunctionType const* type { nullptr };
+    instance->visit([&](auto const& function) { type = &function.type(); });
+    auto& parameters = type->parameters();
+    TRAP_IF_NOT(all_of(parameters, [](auto& type) { return type.is_numeric(); }));
+    TRAP_IF_NOT(all_of(type->results(), [](auto& type) { return type.is_numeric(); }));
+    Vector<Value> arguments;
+    arguments.ensure_capacity(parameters.size());
+    stack_pointer -= parameters.size();
+    for (size_t i = 0; i < parameters.size(); ++i)
+        arguments.unchecked_append(slot_to_value(parameters[i], m_slots[base + stack_pointer + i]));
+
+    Result result { Trap { ""sv } };
+    {
+        CallFrameHandle handle { *this, configuration };
+        result = configuration.call(*this, address, move(arguments));
+    }
+
+    if (result.is_trap()) {
+        m_trap = move(result.trap());
+        return;
+    }
+
+    TRAP_IF_NOT(result.values().size() == type->results().size());
+    for (auto& value : result.values()) {
+        TRAP_IF_NOT(value.type().is_numeric());
+        m_slots[base + stack_pointer++] = value_to_slot(value);
+    }
+}
+
+#define COMPILED_UNARY_OPERATION(type, result_type, ...)               \
+    {                                                                  \
+        [[maybe_unused]] auto value = from_slot<type>(slots[sp - 1]); \
+        slots[sp - 1] = to_slot<result_type>(__VA_ARGS__);             \
+        continue;                                                      \
+    }
+
+#define COMPILED_CHECKED_UNARY_OPERATION(type, result_type, ...) \
+    {                                                            \
+        auto value = from_slot<type>(slots[sp - 1]);             \
+        auto result = __VA_ARGS__;                               \
+        if (m_trap.has_value())                                  \
+            return;                                              \
+        slots[sp - 1] = to_slot<result_type>(result);            \
+        continue;                                                \
+    }
+
+#define COMPILED_BINARY_OPERATION(type, result_type, ...)  \
+    {                                                      \
+        auto rhs = from_slot<type>(slots[--sp]);           \
+        auto lhs = from_slot<type>(slots[sp - 1]);         \
+        slots[sp - 1] = to_slot<result_type>(__VA_ARGS__); \
+        continue;                                          \
+    }
+
+#define COMPILED_LOAD(read_type, push_type)                                                         \
+    {                                                                                               \
+        auto address = static_cast<u64>(from_slot<u32>(slots[sp - 1])) + instruction.immediate;    \
+        if (address + sizeof(read_type) > memory_size) [[unlikely]] {                               \
+            m_trap = Trap { "Memory access out of bounds" };                                        \
+            return;                                                                                 \
+        }                                                                                           \
+        auto value = read_from_memory<MakeUnsigned<read_type>>(memory_data + address);              \
+        slots[sp - 1] = to_slot<push_type>(static_cast<read_type>(value));                          \
+        continue;                                                                                   \
+    }
+
+#define COMPILED_STORE(pop_type, store_type)                                                   \
+    {                                                                                          \
+        auto value = static_cast<store_type>(from_slot<pop_type>(slots[--sp]));                \
+        auto address = static_cast<u64>(from_slot<u32>(slots[--sp])) + instruction.immediate; \
+        if (address + sizeof(store_type) > memory_size) [[unlikely]] {                         \
+            m_trap = Trap { "Memory access out of bounds" };                                   \
+            return;                                                                            \
+        }                                                                                      \
+        write_to_memory(memory_data + address, value);                                         \
+        continue;                                                                              \
+    }
+
+void BytecodeInterpreter::run_compiled(Configuration& configuration, CompiledFunction const& function, size_t base)
+{
+    auto slot_count = base + function.slot_count();
+    if (m_slots.size() < slot_count)
+        m_slots.resize(slot_count);
+    m_slots_in_use = slot_count;
+    auto* slots = m_slots.data() + base;
+    for (size_t i = function.parameter_count(); i < function.local_types().size(); ++i)
+        slots[i] = 0;
+
+    auto& store = configuration.store();
+    // Loads and stores only need to know where the memory is and how large it is, which can only change when the
+    // memory grows, or during calls.
+    MemoryInstance* memory = nullptr;
+    u8* memory_data = nullptr;
+    u64 memory_size = 0;
+    auto reload_memory = [&] {
+        memory = store.get(MemoryAddress { *function.memory_address() });
+        memory_data = memory->data().data();
+        memory_size = memory->size();
+    };
+    if (function.memory_address().has_value()) {
+        TRAP_IF_NOT(store.get(MemoryAddress { *function.memory_address() }));
+        reload_memory();
+    }
+
+    auto* instructions = function.instructions().data();
+    auto* branch_targets = function.branch_targets().data();
+    size_t sp = function.local_types().size();
+    size_t ip = 0;
+    auto const should_limit_instruction_count = configuration.should_limit_instruction_count();
+    u64 executed_instructions = 0;
+
+    auto branch = [&](BranchTarget const& target) {
+        for (size_t i = 0; i < target.arity; ++i)
+            slots[target.stack_pointer + i] = slots[sp - target.arity + i];
+        sp = target.stack_pointer + target.arity;
+        ip = target.ip;
+    };
+
+    auto call = [&](FunctionAddress address) {
+        call_from_compiled(configuration, address, base, sp);
+        // The call may have grown the slots or the memory, or allocated new memories.
+        slots = m_slots.data() + base;
+        if (memory)
+            reload_memory();
+    };
+
+    for (;;) {
+        if (should_limit_instruction_count) {
+            if (executed_instructions++ >= Constants::max_allowed_executed_instructions_per_call) [[unlikely]] {
+                m_trap = Trap { "Exceeded maximum allowed number of instructions" };
+                return;
+            }
+        }
+
+        auto& instruction = instructions[ip++];
+        switch (instruction.opcode.value()) {
+        case Instructions::unreachable.value():
+            m_trap = Trap { "Unreachable" };
+            return;
+        case Instructions::return_.value(): {
+            auto result_count = function.result_types().size();
+            for (size_t i = 0; i < result_count; ++i)
+                slots[i] = slots[sp - result_count + i];
+            return;
+        }
+        case Instructions::if_.value():
+            if (from_slot<i32>(slots[--sp]) == 0)
+                ip = instruction.immediate;
+            continue;
+        case Instructions::structured_else.value():
+            ip = instruction.immediate;
+            continue;
+        case Instructions::br.value():
+            branch(branch_targets[instruction.index]);
+            continue;
+        case Instructions::br_if.value():
+            if (from_slot<i32>(slots[--sp]) != 0)
+                branch(branch_targets[instruction.index]);
+            continue;
+        case Instructions::br_table.value(): {
+            auto index = min<u64>(from_slot<u32>(slots[--sp]), instruction.immediate);
+            branch(branch_targets[instruction.index + index]);
+            continue;
+        }
+        case Instructions::call.value():
+            call(FunctionAddress { instruction.immediate });
+            if (m_trap.has_value())
+                return;
+            continue;
+        case Instructions::call_indirect.value(): {
+            auto index = from_slot<u32>(slots[--sp]);
+            auto* table = store.get(TableAddress { instruction.immediate });
+            TRAP_IF_NOT(table);
+            TRAP_IF_NOT(index < table->elements().size());
+            auto& element = table->elements()[index];
+            TRAP_IF_NOT(element.has_value());
+            TRAP_IF_NOT(element->ref().has<Reference::Func>());
+            auto address = element->ref().get<Reference::Func>().address;
+            auto* callee = store.get(address);
+            TRAP_IF_NOT(callee);
+            FunctionType const* callee_type { nullptr };
+            callee->visit([&](auto const& function) { callee_type = &function.type(); });
+            auto& expected_type = function.module().types()[instruction.index];
+            TRAP_IF_NOT(has_same_kinds(callee_type->parameters(), expected_type.parameters()));
+            TRAP_IF_NOT(has_same_kinds(callee_type->results(), expected_type.results()));
+            call(address);
+            if (m_trap.has_value())
+                return;
+            continue;
+        }
+        case Instructions::drop.value():
+            --sp;
+            continue;
+        case Instructions::select.value(): {
+            auto condition = from_slot<i32>(slots[--sp]);
+            auto rhs = slots[--sp];
+            if (condition == 0)
+                slots[sp - 1] = rhs;
+            continue;
+        }
+        case Instructions::local_get.value():
+            slots[sp++] = slots[instruction.index];
+            continue;
+        case Instructions::local_set.value():
+            slots[instruction.index] = slots[--sp];
+            continue;
+        case Instructions::local_tee.value():
+            slots[instruction.index] = slots[sp - 1];
+            continue;
+        case Instructions::global_get.value(): {
+            auto* global = store.get(GlobalAddress { instruction.immediate });
+            slots[sp++] = value_to_slot(global->value());
+            continue;
+        }
+        case Instructions::global_set.value(): {
+            auto* global = store.get(GlobalAddress { instruction.immediate });
+            global->set_value(slot_to_value(global->value().type(), slots[--sp]));
+            continue;
+        }
+        case Instructions::i32_load.value():
+            COMPILED_LOAD(i32, i32);
+        case Instructions::i64_load.value():
+            COMPILED_LOAD(i64, i64);
+        case Instructions::f32_load.value():
+            COMPILED_LOAD(u32, u32);
+        case Instructions::f64_load.value():
+            COMPILED_LOAD(u64, u64);
+        case Instructions::i32_load8_s.value():
+            COMPILED_LOAD(i8, i32);
+        case Instructions::i32_load8_u.value():
+            COMPILED_LOAD(u8, i32);
+        case Instructions::i32_load16_s.value():
+            COMPILED_LOAD(i16, i32);
+        case Instructions::i32_load16_u.value():
+            COMPILED_LOAD(u16, i32);
+        case Instructions::i64_load8_s.value():
+            COMPILED_LOAD(i8, i64);
+        case Instructions::i64_load8_u.value():
+            COMPILED_LOAD(u8, i64);
+        case Instructions::i64_load16_s.value():
+            COMPILED_LOAD(i16, i64);
+        case Instructions::i64_load16_u.value():
+            COMPILED_LOAD(u16, i64);
+        case Instructions::i64_load32_s.value():
+            COMPILED_LOAD(i32, i64);
+        case Instructions::i64_load32_u.value():
+            COMPILED_LOAD(u32, i64);
+        case Instructions::i32_store.value():
+            COMPILED_STORE(u32, u32);
+        case Instructions::i64_store.value():
+            COMPILED_STORE(u64, u64);
+        case Instructions::f32_store.value():
+            COMPILED_STORE(u32, u32);
+        case Instructions::f64_store.value():
+            COMPILED_STORE(u64, u64);
+        case Instructions::i32_store8.value():
+            COMPILED_STORE(u32, u8);
+        case Instructions::i32_store16.value():
+            COMPILED_STORE(u32, u16);
+        case Instructions::i64_store8.value():
+            COMPILED_STORE(u64, u8);
+        case Instructions::i64_store16.value():
+            COMPILED_STORE(u64, u16);
+        case Instructions::i64_store32.value():
+            COMPILED_STORE(u64, u32);
+        case Instructions::memory_size.value():
+            slots[sp++] = to_slot<i32>(memory->size() / Constants::page_size);
+            continue;
+        case Instructions::memory_grow.value(): {
+            auto old_pages = memory->size() / Constants::page_size;
+            auto new_pages = from_slot<u32>(slots[sp - 1]);
+            if (memory->grow(static_cast<size_t>(new_pages) * Constants::page_size))
+                slots[sp - 1] = to_slot<i32>(old_pages);
+            else
+                slots[sp - 1] = to_slot<i32>(-1);
+            reload_memory();
+            continue;
+        }
+        case Instructions::i32_const.value():
+        case Instructions::i64_const.value():
+        case Instructions::f32_const.value():
+        case Instructions::f64_const.value():
+            slots[sp++] = instruction.immediate;
+            continue;
+        case Instructions::i32_eqz.value():
+            COMPILED_UNARY_OPERATION(i32, i32, value == 0);
+        case Instructions::i32_eq.value():
+            COMPILED_BINARY_OPERATION(i32, i32, lhs == rhs);
+        case Instructions::i32_ne.value():
+            COMPILED_BINARY_OPERATION(i32, i32, lhs != rhs);
+        case Instructions::i32_lts.value():
+            COMPILED_BINARY_OPERATION(i32, i32, lhs < rhs);
+        case Instructions::i32_ltu.value():
+            COMPILED_BINARY_OPERATION(u32, i32, lhs < rhs);
+        case Instructions::i32_gts.value():
+            COMPILED_BINARY_OPERATION(i32, i32, lhs > rhs);
+        case Instructions::i32_gtu.value():
+            COMPILED_BINARY_OPERATION(u32, i32, lhs > rhs);
+        case Instructions::i32_les.value():
+            COMPILED_BINARY_OPERATION(i32, i32, lhs <= rhs);
+        case Instructions::i32_leu.value():
+            COMPILED_BINARY_OPERATION(u32, i32, lhs <= rhs);
+        case Instructions::i32_ges.value():
+            COMPILED_BINARY_OPERATION(i32, i32, lhs >= rhs);
+        case Instructions::i32_geu.value():
+            COMPILED_BINARY_OPERATION(u32, i32, lhs >= rhs);
+        case Instructions::i64_eqz.value():
+            COMPILED_UNARY_OPERATION(i64, i32, value == 0);
+        case Instructions::i64_eq.value():
+            COMPILED_BINARY_OPERATION(i64, i32, lhs == rhs);
+        case Instructions::i64_ne.value():
+            COMPILED_BINARY_OPERATION(i64, i32, lhs != rhs);
+        case Instructions::i64_lts.value():
+            COMPILED_BINARY_OPERATION(i64, i32, lhs < rhs);
+        case Instructions::i64_ltu.value():
+            COMPILED_BINARY_OPERATION(u64, i32, lhs < rhs);
+        case Instructions::i64_gts.value():
+            COMPILED_BINARY_OPERATION(i64, i32, lhs > rhs);
+        case Instructions::i64_gtu.value():
+            COMPILED_BINARY_OPERATION(u64, i32, lhs > rhs);
+        case Instructions::i64_les.value():
+            COMPILED_BINARY_OPERATION(i64, i32, lhs <= rhs);
+        case Instructions::i64_leu.value():
+            COMPILED_BINARY_OPERATION(u64, i32, lhs <= rhs);
+        case Instructions::i64_ges.value():
+            COMPILED_BINARY_OPERATION(i64, i32, lhs >= rhs);
+        case Instructions::i64_geu.value():
+            COMPILED_BINARY_OPERATION(u64, i32, lhs >= rhs);
+        case Instructions::f32_eq.value():
+            COMPILED_BINARY_OPERATION(float, i32, lhs == rhs);
+        case Instructions::f32_ne.value():
+            COMPILED_BINARY_OPERATION(float, i32, lhs != rhs);
+        case Instructions::f32_lt.value():
+            COMPILED_BINARY_OPERATION(float, i32, lhs < rhs);
+        case Instructions::f32_gt.value():
+            COMPILED_BINARY_OPERATION(float, i32, lhs > rhs);
+        case Instructions::f32_le.value():
+            COMPILED_BINARY_OPERATION(float, i32, lhs <= rhs);
+        case Instructions::f32_ge.value():
+            COMPILED_BINARY_OPERATION(float, i32, lhs >= rhs);
+        case Instructions::f64_eq.value():
+            COMPILED_BINARY_OPERATION(double, i32, lhs == rhs);
+        case Instructions::f64_ne.value():
+            COMPILED_BINARY_OPERATION(double, i32, lhs != rhs);
+        case Instructions::f64_lt.value():
+            COMPILED_BINARY_OPERATION(double, i32, lhs < rhs);
+        case Instructions::f64_gt.value():
+            COMPILED_BINARY_OPERATION(double, i32, lhs > rhs);
+        case Instructions::f64_le.value():
+            COMPILED_BINARY_OPERATION(double, i32, lhs <= rhs);
+        case Instructions::f64_ge.value():
+            COMPILED_BINARY_OPERATION(double, i32, lhs >= rhs);
+        case Instructions::i32_clz.value():
+            COMPILED_UNARY_OPERATION(u32, i32, clz(value));
+        case Instructions::i32_ctz.value():
+            COMPILED_UNARY_OPERATION(u32, i32, ctz(value));
+        case Instructions::i32_popcnt.value():
+            COMPILED_UNARY_OPERATION(u32, i32, __builtin_popcount(value));
+        case Instructions::i32_add.value():
+            COMPILED_BINARY_OPERATION(u32, u32, lhs + rhs);
+        case Instructions::i32_sub.value():
+            COMPILED_BINARY_OPERATION(u32, u32, lhs - rhs);
+        case Instructions::i32_mul.value():
+            COMPILED_BINARY_OPERATION(u32, u32, lhs * rhs);
+        case Instructions::i32_divs.value():
+            TRAP_IF_NOT(from_slot<i32>(slots[sp - 1]) != 0);
+            TRAP_IF_NOT(from_slot<i32>(slots[sp - 2]) != NumericLimits<i32>::min() || from_slot<i32>(slots[sp - 1]) != -1);
+            COMPILED_BINARY_OPERATION(i32, i32, lhs / rhs);
+        case Instructions::i32_divu.value():
+            TRAP_IF_NOT(from_slot<u32>(slots[sp - 1]) != 0);
+            COMPILED_BINARY_OPERATION(u32, u32, lhs / rhs);
+        case Instructions::i32_rems.value():
+            TRAP_IF_NOT(from_slot<i32>(slots[sp - 1]) != 0);
+            COMPILED_BINARY_OPERATION(i32, i32, rhs == -1 ? 0 : lhs % rhs);
+        case Instructions::i32_remu.value():
+            TRAP_IF_NOT(from_slot<u32>(slots[sp - 1]) != 0);
+            COMPILED_BINARY_OPERATION(u32, u32, lhs % rhs);
+        case Instructions::i32_and.value():
+            COMPILED_BINARY_OPERATION(u32, u32, lhs & rhs);
+        case Instructions::i32_or.value():
+            COMPILED_BINARY_OPERATION(u32, u32, lhs | rhs);
+        case Instructions::i32_xor.value():
+            COMPILED_BINARY_OPERATION(u32, u32, lhs ^ rhs);
+        case Instructions::i32_shl.value():
+            COMPILED_BINARY_OPERATION(u32, u32, lhs << (rhs % 32));
+        case Instructions::i32_shrs.value():
+            COMPILED_BINARY_OPERATION(i32, i32, lhs >> (rhs & 31));
+        case Instructions::i32_shru.value():
+            COMPILED_BINARY_OPERATION(u32, u32, lhs >> (rhs % 32));
+        case Instructions::i32_rotl.value():
+            COMPILED_BINARY_OPERATION(u32, u32, rotl(lhs, rhs));
+        case Instructions::i32_rotr.value():
+            COMPILED_BINARY_OPERATION(u32, u32, rotr(lhs, rhs));
+        case Instructions::i64_clz.value():
+            COMPILED_UNARY_OPERATION(u64, i64, clz(value));
+        case Instructions::i64_ctz.value():
+            COMPILED_UNARY_OPERATION(u64, i64, ctz(value));
+        case Instructions::i64_popcnt.value():
+            COMPILED_UNARY_OPERATION(u64, i64, __builtin_popcountll(value));
+        case Instructions::i64_add.value():
+            COMPILED_BINARY_OPERATION(u64, u64, lhs + rhs);
+        case Instructions::i64_sub.value():
+            COMPILED_BINARY_OPERATION(u64, u64, lhs - rhs);
+        case Instructions::i64_mul.value():
+            COMPILED_BINARY_OPERATION(u64, u64, lhs * rhs);
+        case Instructions::i64_divs.value():
+            TRAP_IF_NOT(from_slot<i64>(slots[sp - 1]) != 0);
+            TRAP_IF_NOT(from_slot<i64>(slots[sp - 2]) != NumericLimits<i64>::min() || from_slot<i64>(slots[sp - 1]) != -1);
+            COMPILED_BINARY_OPERATION(i64, i64, lhs / rhs);
+        case Instructions::i64_divu.value():
+            TRAP_IF_NOT(from_slot<u64>(slots[sp - 1]) != 0);
+            COMPILED_BINARY_OPERATION(u64, u64, lhs / rhs);
+        case Instructions::i64_rems.value():
+            TRAP_IF_NOT(from_slot<i64>(slots[sp - 1]) != 0);
+            COMPILED_BINARY_OPERATION(i64, i64, rhs == -1 ? 0 : lhs % rhs);
+        case Instructions::i64_remu.value():
+            TRAP_IF_NOT(from_slot<u64>(slots[sp - 1]) != 0);
+            COMPILED_BINARY_OPERATION(u64, u64, lhs % rhs);
+        case Instructions::i64_and.value():
+            COMPILED_BINARY_OPERATION(u64, u64, lhs & rhs);
+        case Instructions::i64_or.value():
+            COMPILED_BINARY_OPERATION(u64, u64, lhs | rhs);
+        case Instructions::i64_xor.value():
+            COMPILED_BINARY_OPERATION(u64, u64, lhs ^ rhs);
+        case Instructions::i64_shl.value():
+            COMPILED_BINARY_OPERATION(u64, u64, lhs << (rhs % 64));
+        case Instructions::i64_shrs.value():
+            COMPILED_BINARY_OPERATION(i64, i64, lhs >> (rhs & 63));
+        case Instructions::i64_shru.value():
+            COMPILED_BINARY_OPERATION(u64, u64, lhs >> (rhs % 64));
+        case Instructions::i64_rotl.value():
+            COMPILED_BINARY_OPERATION(u64, u64, rotl(lhs, rhs));
+        case Instructions::i64_rotr.value():
+            COMPILED_BINARY_OPERATION(u64, u64, rotr(lhs, rhs));
+        case Instructions::f32_abs.value():
+            COMPILED_UNARY_OPERATION(float, float, fabsf(value));
+        case Instructions::f32_neg.value():
+            COMPILED_UNARY_OPERATION(float, float, -value);
+        case Instructions::f32_ceil.value():
+            COMPILED_UNARY_OPERATION(float, float, ceilf(value));
+        case Instructions::f32_floor.value():
+            COMPILED_UNARY_OPERATION(float, float, floorf(value));
+        case Instructions::f32_trunc.value():
+            COMPILED_UNARY_OPERATION(float, float, truncf(value));
+        case Instructions::f32_nearest.value():
+            COMPILED_UNARY_OPERATION(float, float, nearbyintf(value));
+        case Instructions::f32_sqrt.value():
+            COMPILED_UNARY_OPERATION(float, float, sqrtf(value));
+        case Instructions::f32_add.value():
+            COMPILED_BINARY_OPERATION(float, float, lhs + rhs);
+        case Instructions::f32_sub.value():
+            COMPILED_BINARY_OPERATION(float, float, lhs - rhs);
+        case Instructions::f32_mul.value():
+            COMPILED_BINARY_OPERATION(float, float, lhs * rhs);
+        case Instructions::f32_div.value():
+            COMPILED_BINARY_OPERATION(float, float, lhs / rhs);
+        case Instructions::f32_min.value():
+            COMPILED_BINARY_OPERATION(float, float, float_min(lhs, rhs));
+        case Instructions::f32_max.value():
+            COMPILED_BINARY_OPERATION(float, float, float_max(lhs, rhs));
+        case Instructions::f32_copysign.value():
+            COMPILED_BINARY_OPERATION(float, float, copysignf(lhs, rhs));
+        case Instructions::f64_abs.value():
+            COMPILED_UNARY_OPERATION(double, double, fabs(value));
+        case Instructions::f64_neg.value():
+            COMPILED_UNARY_OPERATION(double, double, -value);
+        case Instructions::f64_ceil.value():
+            COMPILED_UNARY_OPERATION(double, double, ceil(value));
+        case Instructions::f64_floor.value():
+            COMPILED_UNARY_OPERATION(double, double, floor(value));
+        case Instructions::f64_trunc.value():
+            COMPILED_UNARY_OPERATION(double, double, trunc(value));
+        case Instructions::f64_nearest.value():
+            COMPILED_UNARY_OPERATION(double, double, nearbyint(value));
+        case Instructions::f64_sqrt.value():
+            COMPILED_UNARY_OPERATION(double, double, sqrt(value));
+        case Instructions::f64_add.value():
+            COMPILED_BINARY_OPERATION(double, double, lhs + rhs);
+        case Instructions::f64_sub.value():
+            COMPILED_BINARY_OPERATION(double, double, lhs - rhs);
+        case Instructions::f64_mul.value():
+            COMPILED_BINARY_OPERATION(double, double, lhs * rhs);
+        case Instructions::f64_div.value():
+            COMPILED_BINARY_OPERATION(double, double, lhs / rhs);
+        case Instructions::f64_min.value():
+            COMPILED_BINARY_OPERATION(double, double, float_min(lhs, rhs));
+        case Instructions::f64_max.value():
+            COMPILED_BINARY_OPERATION(double, double, float_max(lhs, rhs));
+        case Instructions::f64_copysign.value():
+            COMPILED_BINARY_OPERATION(double, double, copysign(lhs, rhs));
+        case Instructions::i32_wrap_i64.value():
+            COMPILED_UNARY_OPERATION(u64, u32, value);
+        case Instructions::i32_trunc_sf32.value():
+            COMPILED_CHECKED_UNARY_OPERATION(float, i32, (checked_signed_truncate<float, i32>(value)));
+        case Instructions::i32_trunc_uf32.value():
+            COMPILED_CHECKED_UNARY_OPERATION(float, u32, (checked_unsigned_truncate<float, i32>(value)));
+        case Instructions::i32_trunc_sf64.value():
+            COMPILED_CHECKED_UNARY_OPERATION(double, i32, (checked_signed_truncate<double, i32>(value)));
+        case Instructions::i32_trunc_uf64.value():
+            COMPILED_CHECKED_UNARY_OPERATION(double, u32, (checked_unsigned_truncate<double, i32>(value)));
+        case Instructions::i64_trunc_sf32.value():
+            COMPILED_CHECKED_UNARY_OPERATION(float, i64, (checked_signed_truncate<float, i64>(value)));
+        case Instructions::i64_trunc_uf32.value():
+            COMPILED_CHECKED_UNARY_OPERATION(float, u64, (checked_unsigned_truncate<float, i64>(value)));
+        case Instructions::i64_trunc_sf64.value():
+            COMPILED_CHECKED_UNARY_OPERATION(double, i64, (checked_signed_truncate<double, i64>(value)));
+        case Instructions::i64_trunc_uf64.value():
+            COMPILED_CHECKED_UNARY_OPERATION(double, u64, (checked_unsigned_truncate<double, i64>(value)));
+        case Instructions::i64_extend_si32.value():
+            COMPILED_UNARY_OPERATION(i32, i64, value);
+        case Instructions::i64_extend_ui32.value():
+            COMPILED_UNARY_OPERATION(u32, u64, value);
+        case Instructions::f32_convert_si32.value():
+            COMPILED_UNARY_OPERATION(i32, float, value);
+        case Instructions::f32_convert_ui32.value():
+            COMPILED_UNARY_OPERATION(u32, float, value);
+        case Instructions::f32_convert_si64.value():
+            COMPILED_UNARY_OPERATION(i64, float, value);
+        case Instructions::f32_convert_ui64.value():
+            COMPILED_UNARY_OPERATION(u64, float, value);
+        case Instructions::f32_demote_f64.value():
+            COMPILED_UNARY_OPERATION(double, float, value);
+        case Instructions::f64_convert_si32.value():
+            COMPILED_UNARY_OPERATION(i32, double, value);
+        case Instructions::f64_convert_ui32.value():
+            COMPILED_UNARY_OPERATION(u32, double, value);
+        case Instructions::f64_convert_si64.value():
+            COMPILED_UNARY_OPERATION(i64, double, value);
+        case Instructions::f64_convert_ui64.value():
+            COMPILED_UNARY_OPERATION(u64, double, value);
+        case Instructions::f64_promote_f32.value():
+            COMPILED_UNARY_OPERATION(float, double, value);
+        case Instructions::i32_reinterpret_f32.value():
+        case Instructions::i64_reinterpret_f64.value():
+        case Instructions::f32_reinterpret_i32.value():
+        case Instructions::f64_reinterpret_i64.value():
+            // The slots already hold the bits.
+            continue;
+        case Instructions::i32_extend8_s.value():
+            COMPILED_UNARY_OPERATION(i8, i32, value);
+        case Instructions::i32_extend16_s.value():
+            COMPILED_UNARY_OPERATION(i16, i32, value);
+        case Instructions::i64_extend8_s.value():
+            COMPILED_UNARY_OPERATION(i8, i64, value);
+        case Instructions::i64_extend16_s.value():
+            COMPILED_UNARY_OPERATION(i16, i64, value);
+        case Instructions::i64_extend32_s.value():
+            COMPILED_UNARY_OPERATION(i32, i64, value);
+        case Instructions::i32_trunc_sat_f32_s.value():
+            COMPILED_UNARY_OPERATION(float, i32, saturating_truncate<i32>(value));
+        case Instructions::i32_trunc_sat_f32_u.value():
+            COMPILED_UNARY_OPERATION(float, u32, saturating_truncate<u32>(value));
+        case Instructions::i32_trunc_sat_f64_s.value():
+            COMPILED_UNARY_OPERATION(double, i32, saturating_truncate<i32>(value));
+        case Instructions::i32_trunc_sat_f64_u.value():
+            COMPILED_UNARY_OPERATION(double, u32, saturating_truncate<u32>(value));
+        case Instructions::i64_trunc_sat_f32_s.value():
+            COMPILED_UNARY_OPERATION(float, i64, saturating_truncate<i64>(value));
+        case Instructions::i64_trunc_sat_f32_u.value():
+            COMPILED_UNARY_OPERATION(float, u64, saturating_truncate<u64>(value));
+        case Instructions::i64_trunc_sat_f64_s.value():
+            COMPILED_UNARY_OPERATION(double, i64, saturating_truncate<i64>(value));
+        case Instructions::i64_trunc_sat_f64_u.value():
+            COMPILED_UNARY_OPERATION(double, u64, saturating_truncate<u64>(value));
+        default:
+            VERIFY_NOT_REACHED();
+        }
+    }
+}
+
 void DebuggerBytecodeInterpreter::interpret(Configuration& configuration, InstructionPointer& ip, Instruction const& instruction)
 {
     if (pre_interpret_hook) {
@@ -34,6 +34,11 @@ struct BytecodeInterpreter : public Interpreter {
 
 protected:
     virtual void interpret(Configuration&, InstructionPointer&, Instruction const&);
+    // Compiled code runs whole functions at a time, so it can't be used while something looks at every instruction.
+    virtual bool can_run_compiled_code() const { return true; }
+    void interpret_compiled(Configuration&, CompiledFunction const&);
+    void run_compiled(Configuration&, CompiledFunction const&, size_t base);
+    void call_from_compiled(Configuration&, FunctionAddress, size_t base, size_t& stack_pointer);
     void branch_to_label(Configuration&, LabelIndex);
     template<typename ReadT, typename PushT>
     void load_and_push(Configuration&, Instruction const&);
@@ -59,6 +64,9 @@ protected:
 
     Optional<Trap> m_trap;
     StackInfo m_stack_info;
+    // The slots of all compiled functions that are running, each one's after its caller's.
+    Vector<u64> m_slots;
+    size_t m_slots_in_use { 0 };
 };
 
 struct DebuggerBytecodeInterpreter : public BytecodeInterpreter {
@@ -69,6 +77,7 @@ struct DebuggerBytecodeInterpreter : public BytecodeInterpreter {
 
 private:
     virtual void interpret(Configuration&, InstructionPointer&, Instruction const&) override;
+    virtual bool can_run_compiled_code() const override { return !pre_interpret_hook && !post_interpret_hook; }
 };
 
 }
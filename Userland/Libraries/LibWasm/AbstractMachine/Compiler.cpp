@@ -0,0 +1,581 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <LibWasm/AbstractMachine/AbstractMachine.h>
+#include <LibWasm/AbstractMachine/Compiler.h>
+#include <LibWasm/Printer/Printer.h>
+
+namespace Wasm {
+
+namespace {
+
+struct ControlFrame {
+    enum class Kind {
+        Function,
+        Block,
+        Loop,
+        If,
+    };
+
+    Kind kind { Kind::Block };
+    size_t stack_height { 0 };
+    size_t arity { 0 };
+    size_t loop_ip { 0 };
+    // The branch targets and jumps that continue after the end of this frame, which isn't known yet.
+    Vector<size_t> pending_targets;
+    Vector<size_t> pending_jumps;
+    // The jump an if takes when its condition is false, until we know where the else branch starts.
+    Optional<size_t> pending_else;
+};
+
+class FunctionCompiler {
+public:
+    FunctionCompiler(Store& store, ModuleInstance const& module, FunctionType const& type, Vector<ValueType> const& locals)
+        : m_store(store)
+        , m_module(module)
+        , m_type(type)
+    {
+        m_local_types.extend(type.parameters());
+        m_local_types.extend(locals);
+    }
+
+    RefPtr<CompiledFunction> compile(Expression const&);
+
+private:
+    bool compile(Instruction const&);
+    bool enter(ControlFrame::Kind, BlockType const&);
+    bool leave();
+    Optional<u32> add_branch_target(LabelIndex);
+
+    bool pop(size_t count = 1)
+    {
+        if (m_stack_height < frame().stack_height + count)
+            return false;
+        m_stack_height -= count;
+        return true;
+    }
+
+    void push(size_t count = 1)
+    {
+        m_stack_height += count;
+        m_max_stack_height = max(m_max_stack_height, m_stack_height);
+    }
+
+    size_t emit(OpCode opcode, u32 index = 0, u64 immediate = 0)
+    {
+        m_instructions.append({ opcode, index, immediate });
+        return m_instructions.size() - 1;
+    }
+
+    ControlFrame& frame() { return m_frames.last(); }
+
+    FunctionType const* function_type(FunctionAddress address) const
+    {
+        auto* function = m_store.get(address);
+        if (!function)
+            return nullptr;
+        FunctionType const* type { nullptr };
+        function->visit([&](auto const& function) { type = &function.type(); });
+        return type;
+    }
+
+    static bool has_reference_types(Vector<ValueType> const& types)
+    {
+        return any_of(types, [](auto& type) { return type.is_reference(); });
+    }
+
+    Store& m_store;
+    ModuleInstance const& m_module;
+    FunctionType const& m_type;
+    Vector<ValueType> m_local_types;
+    Vector<CompiledInstruction> m_instructions;
+    Vector<BranchTarget> m_branch_targets;
+    Vector<ControlFrame> m_frames;
+    size_t m_stack_height { 0 };
+    size_t m_max_stack_height { 0 };
+    // Code after an unconditional branch never runs, so it isn't compiled either; this counts the blocks
+    // that open inside such code, to find the end that makes the code reachable again.
+    bool m_unreachable { false };
+    size_t m_unreachable_depth { 0 };
+};
+
+RefPtr<CompiledFunction> FunctionCompiler::compile(Expression const& body)
+{
+    if (has_reference_types(m_local_types) || has_reference_types(m_type.results()))
+        return {};
+
+    m_frames.append({ ControlFrame::Kind::Function, 0, m_type.results().size(), 0, {}, {}, {} });
+    for (auto& instruction : body.instructions()) {
+        if (!compile(instruction)) {
+            dbgln_if(WASM_TRACE_DEBUG, "Can't compile instruction {}, falling back to the interpreter", instruction_name(instruction.opcode()));
+            return {};
+        }
+    }
+    if (m_frames.size() != 1)
+        return {};
+
+    // Falling off the end of the function and branching to its outermost label both return.
+    if (!m_unreachable && !pop(frame().arity))
+        return {};
+    for (auto index : frame().pending_targets)
+        m_branch_targets[index].ip = m_instructions.size();
+    emit(Instructions::return_);
+
+    Optional<u64> memory_address;
+    if (!m_module.memories().is_empty())
+        memory_address = m_module.memories().first().value();
+
+    return adopt_ref(*new CompiledFunction(m_module, move(m_instructions), move(m_branch_targets), move(m_local_types), m_type.parameters().size(), m_type.results(), m_max_stack_height, memory_address));
+}
+
+bool FunctionCompiler::enter(ControlFrame::Kind kind, BlockType const& block_type)
+{
+    size_t arity = 0;
+    if (block_type.kind() == BlockType::Index)
+        return false;
+    if (block_type.kind() == BlockType::Type) {
+        if (block_type.value_type().is_reference())
+            return false;
+        arity = 1;
+    }
+    m_frames.append({ kind, m_stack_height, arity, m_instructions.size(), {}, {}, {} });
+    return true;
+}
+
+bool FunctionCompiler::leave()
+{
+    if (m_frames.size() < 2)
+        return false;
+    if (!m_unreachable && (m_stack_height != frame().stack_height + frame().arity))
+        return false;
+
+    auto end_ip = m_instructions.size();
+    for (auto index : frame().pending_targets)
+        m_branch_targets[index].ip = end_ip;
+    for (auto index : frame().pending_jumps)
+        m_instructions[index].immediate = end_ip;
+    if (frame().pending_else.has_value())
+        m_instructions[*frame().pending_else].immediate = end_ip;
+
+    m_stack_height = frame().stack_height;
+    auto arity = frame().arity;
+    m_frames.take_last();
+    push(arity);
+    m_unreachable = false;
+    return true;
+}
+
+Optional<u32> FunctionCompiler::add_branch_target(LabelIndex label)
+{
+    if (label.value() >= m_frames.size())
+        return {};
+    auto& target_frame = m_frames[m_frames.size() - label.value() - 1];
+    BranchTarget target;
+    // Branching to a loop starts its next iteration, which takes no values.
+    target.arity = target_frame.kind == ControlFrame::Kind::Loop ? 0 : target_frame.arity;
+    target.stack_pointer = m_local_types.size() + target_frame.stack_height;
+    if (m_stack_height < frame().stack_height + target.arity)
+        return {};
+
+    auto index = m_branch_targets.size();
+    if (target_frame.kind == ControlFrame::Kind::Loop)
+        target.ip = target_frame.loop_ip;
+    else
+        target_frame.pending_targets.append(index);
+    m_branch_targets.append(target);
+    return index;
+}
+
+bool FunctionCompiler::compile(Instruction const& instruction)
+{
+    auto opcode = instruction.opcode();
+
+    if (m_unreachable) {
+        switch (opcode.value()) {
+        case Instructions::block.value():
+        case Instructions::loop.value():
+        case Instructions::if_.value():
+            ++m_unreachable_depth;
+            return true;
+        case Instructions::structured_else.value():
+            if (m_unreachable_depth != 0)
+                return true;
+            break;
+        case Instructions::structured_end.value():
+            if (m_unreachable_depth != 0) {
+                --m_unreachable_depth;
+                return true;
+            }
+            break;
+        default:
+            return true;
+        }
+    }
+
+    switch (opcode.value()) {
+    case Instructions::unreachable.value():
+    case Instructions::return_.value():
+        emit(opcode);
+        m_unreachable = true;
+        return true;
+    case Instructions::nop.value():
+        return true;
+    case Instructions::block.value():
+        return enter(ControlFrame::Kind::Block, instruction.arguments().get<Instruction::StructuredInstructionArgs>().block_type);
+    case Instructions::loop.value():
+        return enter(ControlFrame::Kind::Loop, instruction.arguments().get<Instruction::StructuredInstructionArgs>().block_type);
+    case Instructions::if_.value(): {
+        if (!pop())
+            return false;
+        auto jump = emit(Instructions::if_);
+        if (!enter(ControlFrame::Kind::If, instruction.arguments().get<Instruction::StructuredInstructionArgs>().block_type))
+            return false;
+        frame().pending_else = jump;
+        return true;
+    }
+    case Instructions::structured_else.value(): {
+        if (frame().kind != ControlFrame::Kind::If || !frame().pending_else.has_value())
+            return false;
+        if (!m_unreachable) {
+            if (m_stack_height != frame().stack_height + frame().arity)
+                return false;
+            frame().pending_jumps.append(emit(Instructions::structured_else));
+        }
+        m_instructions[*frame().pending_else].immediate = m_instructions.size();
+        frame().pending_else.clear();
+        m_stack_height = frame().stack_height;
+        m_unreachable = false;
+        return true;
+    }
+    case Instructions::structured_end.value():
+        return leave();
+    case Instructions::br.value(): {
+        auto target = add_branch_target(instruction.arguments().get<LabelIndex>());
+        if (!target.has_value())
+            return false;
+        emit(opcode, *target);
+        m_unreachable = true;
+        return true;
+    }
+    case Instructions::br_if.value(): {
+        if (!pop())
+            return false;
+        auto target = add_branch_target(instruction.arguments().get<LabelIndex>());
+        if (!target.has_value())
+            return false;
+        emit(opcode, *target);
+        return true;
+    }
+    case Instructions::br_table.value(): {
+        if (!pop())
+            return false;
+        auto& arguments = instruction.arguments().get<Instruction::TableBranchArgs>();
+        // The targets are stored next to each other, with the default one last.
+        auto first_target = m_branch_targets.size();
+        for (auto& label : arguments.labels) {
+            if (!add_branch_target(label).has_value())
+                return false;
+        }
+        if (!add_branch_target(arguments.default_).has_value())
+            return false;
+        emit(opcode, first_target, arguments.labels.size());
+        m_unreachable = true;
+        return true;
+    }
+    case Instructions::call.value(): {
+        auto index = instruction.arguments().get<FunctionIndex>();
+        if (index.value() >= m_module.functions().size())
+            return false;
+        auto address = m_module.functions()[index.value()];
+        auto* type = function_type(address);
+        if (!type || has_reference_types(type->parameters()) || has_reference_types(type->results()))
+            return false;
+        if (!pop(type->parameters().size()))
+            return false;
+        push(type->results().size());
+        emit(opcode, 0, address.value());
+        return true;
+    }
+    case Instructions::call_indirect.value(): {
+        auto& arguments = instruction.arguments().get<Instruction::IndirectCallArgs>();
+        if (arguments.table.value() >= m_module.tables().size() || arguments.type.value() >= m_module.types().size())
+            return false;
+        auto& type = m_module.types()[arguments.type.value()];
+        if (has_reference_types(type.parameters()) || has_reference_types(type.results()))
+            return false;
+        if (!pop(1 + type.parameters().size()))
+            return false;
+        push(type.results().size());
+        emit(opcode, arguments.type.value(), m_module.tables()[arguments.table.value()].value());
+        return true;
+    }
+    case Instructions::drop.value():
+        if (!pop())
+            return false;
+        emit(opcode);
+        return true;
+    case Instructions::select_typed.value():
+        if (has_reference_types(instruction.arguments().get<Vector<ValueType>>()))
+            return false;
+        [[fallthrough]];
+    case Instructions::select.value():
+        if (!pop(3))
+            return false;
+        push();
+        emit(Instructions::select);
+        return true;
+    case Instructions::local_get.value():
+    case Instructions::local_set.value():
+    case Instructions::local_tee.value(): {
+        auto index = instruction.arguments().get<LocalIndex>();
+        if (index.value() >= m_local_types.size())
+            return false;
+        if (opcode == Instructions::local_get)
+            push();
+        else if (opcode == Instructions::local_set && !pop())
+            return false;
+        else if (opcode == Instructions::local_tee && m_stack_height == frame().stack_height)
+            return false;
+        emit(opcode, index.value());
+        return true;
+    }
+    case Instructions::global_get.value():
+    case Instructions::global_set.value(): {
+        auto index = instruction.arguments().get<GlobalIndex>();
+        if (index.value() >= m_module.globals().size())
+            return false;
+        auto address = m_module.globals()[index.value()];
+        auto* global = m_store.get(address);
+        if (!global || global->value().type().is_reference())
+            return false;
+        if (opcode == Instructions::global_get)
+            push();
+        else if (!global->is_mutable() || !pop())
+            return false;
+        emit(opcode, 0, address.value());
+        return true;
+    }
+    case Instructions::i32_load.value():
+    case Instructions::i64_load.value():
+    case Instructions::f32_load.value():
+    case Instructions::f64_load.value():
+    case Instructions::i32_load8_s.value():
+    case Instructions::i32_load8_u.value():
+    case Instructions::i32_load16_s.value():
+    case Instructions::i32_load16_u.value():
+    case Instructions::i64_load8_s.value():
+    case Instructions::i64_load8_u.value():
+    case Instructions::i64_load16_s.value():
+    case Instructions::i64_load16_u.value():
+    case Instructions::i64_load32_s.value():
+    case Instructions::i64_load32_u.value():
+        if (m_module.memories().is_empty() || !pop())
+            return false;
+        push();
+        emit(opcode, 0, instruction.arguments().get<Instruction::MemoryArgument>().offset);
+        return true;
+    case Instructions::i32_store.value():
+    case Instructions::i64_store.value():
+    case Instructions::f32_store.value():
+    case Instructions::f64_store.value():
+    case Instructions::i32_store8.value():
+    case Instructions::i32_store16.value():
+    case Instructions::i64_store8.value():
+    case Instructions::i64_store16.value():
+    case Instructions::i64_store32.value():
+        if (m_module.memories().is_empty() || !pop(2))
+            return false;
+        emit(opcode, 0, instruction.arguments().get<Instruction::MemoryArgument>().offset);
+        return true;
+    case Instructions::memory_size.value():
+        if (m_module.memories().is_empty())
+            return false;
+        push();
+        emit(opcode);
+        return true;
+    case Instructions::memory_grow.value():
+        if (m_module.memories().is_empty() || !pop())
+            return false;
+        push();
+        emit(opcode);
+        return true;
+    case Instructions::i32_const.value():
+        push();
+        emit(opcode, 0, static_cast<u32>(instruction.arguments().get<i32>()));
+        return true;
+    case Instructions::i64_const.value():
+        push();
+        emit(opcode, 0, static_cast<u64>(instruction.arguments().get<i64>()));
+        return true;
+    case Instructions::f32_const.value():
+        push();
+        emit(opcode, 0, bit_cast<u32>(instruction.arguments().get<float>()));
+        return true;
+    case Instructions::f64_const.value():
+        push();
+        emit(opcode, 0, bit_cast<u64>(instruction.arguments().get<double>()));
+        return true;
+    case Instructions::i32_eqz.value():
+    case Instructions::i64_eqz.value():
+    case Instructions::i32_clz.value():
+    case Instructions::i32_ctz.value():
+    case Instructions::i32_popcnt.value():
+    case Instructions::i64_clz.value():
+    case Instructions::i64_ctz.value():
+    case Instructions::i64_popcnt.value():
+    case Instructions::f32_abs.value():
+    case Instructions::f32_neg.value():
+    case Instructions::f32_ceil.value():
+    case Instructions::f32_floor.value():
+    case Instructions::f32_trunc.value():
+    case Instructions::f32_nearest.value():
+    case Instructions::f32_sqrt.value():
+    case Instructions::f64_abs.value():
+    case Instructions::f64_neg.value():
+    case Instructions::f64_ceil.value():
+    case Instructions::f64_floor.value():
+    case Instructions::f64_trunc.value():
+    case Instructions::f64_nearest.value():
+    case Instructions::f64_sqrt.value():
+    case Instructions::i32_wrap_i64.value():
+    case Instructions::i32_trunc_sf32.value():
+    case Instructions::i32_trunc_uf32.value():
+    case Instructions::i32_trunc_sf64.value():
+    case Instructions::i32_trunc_uf64.value():
+    case Instructions::i64_extend_si32.value():
+    case Instructions::i64_extend_ui32.value():
+    case Instructions::i64_trunc_sf32.value():
+    case Instructions::i64_trunc_uf32.value():
+    case Instructions::i64_trunc_sf64.value():
+    case Instructions::i64_trunc_uf64.value():
+    case Instructions::f32_convert_si32.value():
+    case Instructions::f32_convert_ui32.value():
+    case Instructions::f32_convert_si64.value():
+    case Instructions::f32_convert_ui64.value():
+    case Instructions::f32_demote_f64.value():
+    case Instructions::f64_convert_si32.value():
+    case Instructions::f64_convert_ui32.value():
+    case Instructions::f64_convert_si64.value():
+    case Instructions::f64_convert_ui64.value():
+    case Instructions::f64_promote_f32.value():
+    case Instructions::i32_reinterpret_f32.value():
+    case Instructions::i64_reinterpret_f64.value():
+    case Instructions::f32_reinterpret_i32.value():
+    case Instructions::f64_reinterpret_i64.value():
+    case Instructions::i32_extend8_s.value():
+    case Instructions::i32_extend16_s.value():
+    case Instructions::i64_extend8_s.value():
+    case Instructions::i64_extend16_s.value():
+    case Instructions::i64_extend32_s.value():
+    case Instructions::i32_trunc_sat_f32_s.value():
+    case Instructions::i32_trunc_sat_f32_u.value():
+    case Instructions::i32_trunc_sat_f64_s.value():
+    case Instructions::i32_trunc_sat_f64_u.value():
+    case Instructions::i64_trunc_sat_f32_s.value():
+    case Instructions::i64_trunc_sat_f32_u.value():
+    case Instructions::i64_trunc_sat_f64_s.value():
+    case Instructions::i64_trunc_sat_f64_u.value():
+        if (!pop())
+            return false;
+        push();
+        emit(opcode);
+        return true;
+    case Instructions::i32_eq.value():
+    case Instructions::i32_ne.value():
+    case Instructions::i32_lts.value():
+    case Instructions::i32_ltu.value():
+    case Instructions::i32_gts.value():
+    case Instructions::i32_gtu.value():
+    case Instructions::i32_les.value():
+    case Instructions::i32_leu.value():
+    case Instructions::i32_ges.value():
+    case Instructions::i32_geu.value():
+    case Instructions::i64_eq.value():
+    case Instructions::i64_ne.value():
+    case Instructions::i64_lts.value():
+    case Instructions::i64_ltu.value():
+    case Instructions::i64_gts.value():
+    case Instructions::i64_gtu.value():
+    case Instructions::i64_les.value():
+    case Instructions::i64_leu.value():
+    case Instructions::i64_ges.value():
+    case Instructions::i64_geu.value():
+    case Instructions::f32_eq.value():
+    case Instructions::f32_ne.value():
+    case Instructions::f32_lt.value():
+    case Instructions::f32_gt.value():
+    case Instructions::f32_le.value():
+    case Instructions::f32_ge.value():
+    case Instructions::f64_eq.value():
+    case Instructions::f64_ne.value():
+    case Instructions::f64_lt.value():
+    case Instructions::f64_gt.value():
+    case Instructions::f64_le.value():
+    case Instructions::f64_ge.value():
+    case Instructions::i32_add.value():
+    case Instructions::i32_sub.value():
+    case Instructions::i32_mul.value():
+    case Instructions::i32_divs.value():
+    case Instructions::i32_divu.value():
+    case Instructions::i32_rems.value():
+    case Instructions::i32_remu.value():
+    case Instructions::i32_and.value():
+    case Instructions::i32_or.value():
+    case Instructions::i32_xor.value():
+    case Instructions::i32_shl.value():
+    case Instructions::i32_shrs.value():
+    case Instructions::i32_shru.value():
+    case Instructions::i32_rotl.value():
+    case Instructions::i32_rotr.value():
+    case Instructions::i64_add.value():
+    case Instructions::i64_sub.value():
+    case Instructions::i64_mul.value():
+    case Instructions::i64_divs.value():
+    case Instructions::i64_divu.value():
+    case Instructions::i64_rems.value():
+    case Instructions::i64_remu.value():
+    case Instructions::i64_and.value():
+    case Instructions::i64_or.value():
+    case Instructions::i64_xor.value():
+    case Instructions::i64_shl.value():
+    case Instructions::i64_shrs.value():
+    case Instructions::i64_shru.value():
+    case Instructions::i64_rotl.value():
+    case Instructions::i64_rotr.value():
+    case Instructions::f32_add.value():
+    case Instructions::f32_sub.value():
+    case Instructions::f32_mul.value():
+    case Instructions::f32_div.value():
+    case Instructions::f32_min.value():
+    case Instructions::f32_max.value():
+    case Instructions::f32_copysign.value():
+    case Instructions::f64_add.value():
+    case Instructions::f64_sub.value():
+    case Instructions::f64_mul.value():
+    case Instructions::f64_div.value():
+    case Instructions::f64_min.value():
+    case Instructions::f64_max.value():
+    case Instructions::f64_copysign.value():
+        if (!pop(2))
+            return false;
+        push();
+        emit(opcode);
+        return true;
+    default:
+        // Reference, table and bulk memory instructions.
+        return false;
+    }
+}
+
+}
+
+RefPtr<CompiledFunction> compile_function(Store& store, ModuleInstance const& module, FunctionType const& type, Vector<ValueType> const& locals, Expression const& body)
+{
+    return FunctionCompiler { store, module, type, locals }.compile(body);
+}
+
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/RefCounted.h>
+#include <AK/RefPtr.h>
+#include <AK/Vector.h>
+#include <LibWasm/Opcode.h>
+#include <LibWasm/Types.h>
+
+namespace Wasm {
+
+class ModuleInstance;
+class Store;
+
+// One instruction of a compiled function. Everything the instruction needs is decoded ahead of time:
+// indices are resolved to store addresses, constants are stored as the bits of their stack slot, and
+// branches refer to an entry in the function's branch target table.
+struct CompiledInstruction {
+    OpCode opcode { 0 };
+    // The local index, the first branch target of a branch, or the type index of an indirect call.
+    u32 index { 0 };
+    // The constant, memory offset, store address, number of branch targets or instruction to jump to.
+    u64 immediate { 0 };
+};
+
+struct BranchTarget {
+    u32 ip { 0 };
+    // The number of values the branch takes from the top of the stack along to the target.
+    u32 arity { 0 };
+    // The slot the values end up at, which is where the stack of the target block starts.
+    u32 stack_pointer { 0 };
+};
+
+// A function lowered to a flat instruction list that runs on untyped 64-bit slots instead of
+// a stack of Values. The first slots hold the locals, and the value stack follows them; since the
+// height of the stack is known statically at every instruction, so is the number of slots needed.
+// Structured control flow is gone: blocks and loops don't emit anything, and branches jump
+// directly to where execution continues.
+class CompiledFunction : public RefCounted<CompiledFunction> {
+public:
+    CompiledFunction(ModuleInstance const& module, Vector<CompiledInstruction> instructions, Vector<BranchTarget> branch_targets, Vector<ValueType> local_types, size_t parameter_count, Vector<ValueType> result_types, size_t max_stack_height, Optional<u64> memory_address)
+        : m_module(module)
+        , m_instructions(move(instructions))
+        , m_branch_targets(move(branch_targets))
+        , m_local_types(move(local_types))
+        , m_parameter_count(parameter_count)
+        , m_result_types(move(result_types))
+        , m_max_stack_height(max_stack_height)
+        , m_memory_address(memory_address)
+    {
+    }
+
+    auto& module() const { return m_module; }
+    auto& instructions() const { return m_instructions; }
+    auto& branch_targets() const { return m_branch_targets; }
+    auto& local_types() const { return m_local_types; }
+    auto parameter_count() const { return m_parameter_count; }
+    auto& result_types() const { return m_result_types; }
+    auto slot_count() const { return m_local_types.size() + m_max_stack_height; }
+    auto& memory_address() const { return m_memory_address; }
+
+private:
+    ModuleInstance const& m_module;
+    Vector<CompiledInstruction> m_instructions;
+    Vector<BranchTarget> m_branch_targets;
+    Vector<ValueType> m_local_types;
+    size_t m_parameter_count { 0 };
+    Vector<ValueType> m_result_types;
+    size_t m_max_stack_height { 0 };
+    Optional<u64> m_memory_address;
+};
+
+// Returns null if the function uses something the compiled form can't express, such as reference
+// types or table instructions; such functions keep running in the instruction-by-instruction interpreter.
+RefPtr<CompiledFunction> compile_function(Store&, ModuleInstance const&, FunctionType const&, Vector<ValueType> const& locals, Expression const& body);
+
+}
@@ -7,6 +7,7 @@
 #include <AK/LEB128.h>
 #include <AK/ScopeGuard.h>
 #include <AK/ScopeLogger.h>
+#include <LibThreading/TaskGroup.h>
 #include <LibWasm/Types.h>
 
 namespace Wasm {
@@ -1132,10 +1133,88 @@ ParseResult<CodeSection::Code> CodeSection::Code::parse(InputStream& stream)
     return Code { static_cast<u32>(size), func.release_value() };
 }
 
+// Function bodies are parsed in batches of this many on the ThreadPool; most of them are small.
+static constexpr size_t code_bodies_per_task = 16;
+
+// Reads the bytes of a function body in chunks, so that a bogus size doesn't make us allocate more than the input holds.
+static ParseResult<ByteBuffer> read_code_body(InputStream& stream, size_t size)
+{
+    ByteBuffer body;
+    while (body.size() < size) {
+        auto offset = body.size();
+        auto chunk_size = min(size - offset, 64 * KiB);
+        body.resize(offset + chunk_size);
+        for (size_t nread = 0; nread < chunk_size;) {
+            auto count = stream.read(body.bytes().slice(offset + nread, chunk_size - nread));
+            if (count == 0)
+                return with_eof_check(stream, ParseError::InvalidInput);
+            nread += count;
+        }
+    }
+    return body;
+}
+
+// Once its size is known, a function body is a self-contained range of bytes, so any thread can parse it.
+static ParseResult<CodeSection::Code> parse_code_body(ReadonlyBytes body)
+{
+    InputMemoryStream stream { body };
+    ScopeGuard drain_errors {
+        [&] {
+            stream.handle_any_error();
+        }
+    };
+    auto func = CodeSection::Func::parse(stream);
+    if (func.is_error())
+        return func.error();
+    return CodeSection::Code { static_cast<u32>(body.size()), func.release_value() };
+}
+
+// Gathers the results of function bodies parsed out of order, reporting the error of the first body that failed.
+static ParseResult<Vector<CodeSection::Code>> collect_code_bodies(Vector<Optional<CodeSection::Code>>& functions, Vector<Optional<ParseError>> const& errors)
+{
+    Vector<CodeSection::Code> result;
+    result.ensure_capacity(functions.size());
+    for (size_t i = 0; i < functions.size(); ++i) {
+        if (errors[i].has_value())
+            return *errors[i];
+        result.unchecked_append(functions[i].release_value());
+    }
+    return result;
+}
+
 ParseResult<CodeSection> CodeSection::parse(InputStream& stream)
 {
     ScopeLogger<WASM_BINPARSER_DEBUG> logger("CodeSection");
-    auto result = parse_vector<Code>(stream);
+    size_t count;
+    if (!LEB128::read_unsigned(stream, count))
+        return with_eof_check(stream, ParseError::ExpectedSize);
+
+    Vector<ByteBuffer> bodies;
+    for (size_t i = 0; i < count; ++i) {
+        size_t size;
+        if (!LEB128::read_unsigned(stream, size))
+            return with_eof_check(stream, ParseError::InvalidSize);
+        auto body = read_code_body(stream, size);
+        if (body.is_error())
+            return body.error();
+        bodies.append(body.release_value());
+    }
+
+    Vector<Optional<Code>> functions;
+    functions.resize(bodies.size());
+    Vector<Optional<ParseError>> errors;
+    errors.resize(bodies.size());
+    Threading::parallel_for(
+        0, bodies.size(), [&](size_t i) {
+            auto result = parse_code_body(bodies[i]);
+            if (result.is_error())
+                errors[i] = result.error();
+            else
+                functions[i] = result.release_value();
+        },
+        code_bodies_per_task);
+
+    auto result = collect_code_bodies(functions, errors);
     if (result.is_error())
         return result.error();
     return CodeSection { result.release_value() };
@@ -1207,6 +1286,49 @@ ParseResult<DataCountSection> DataCountSection::parse([[maybe_unused]] InputStre
     return DataCountSection { value };
 }
 
+template<typename Section>
+static ParseResult<Module::AnySection> parse_section(InputStream& stream)
+{
+    auto section = Section::parse(stream);
+    if (section.is_error())
+        return section.error();
+    return Module::AnySection { section.release_value() };
+}
+
+static ParseResult<Module::AnySection> parse_section(u8 section_id, InputStream& stream)
+{
+    switch (section_id) {
+    case CustomSection::section_id:
+        return parse_section<CustomSection>(stream);
+    case TypeSection::section_id:
+        return parse_section<TypeSection>(stream);
+    case ImportSection::section_id:
+        return parse_section<ImportSection>(stream);
+    case FunctionSection::section_id:
+        return parse_section<FunctionSection>(stream);
+    case TableSection::section_id:
+        return parse_section<TableSection>(stream);
+    case MemorySection::section_id:
+        return parse_section<MemorySection>(stream);
+    case GlobalSection::section_id:
+        return parse_section<GlobalSection>(stream);
+    case ExportSection::section_id:
+        return parse_section<ExportSection>(stream);
+    case StartSection::section_id:
+        return parse_section<StartSection>(stream);
+    case ElementSection::section_id:
+        return parse_section<ElementSection>(stream);
+    case CodeSection::section_id:
+        return parse_section<CodeSection>(stream);
+    case DataSection::section_id:
+        return parse_section<DataSection>(stream);
+    case DataCountSection::section_id:
+        return parse_section<DataCountSection>(stream);
+    default:
+        return ParseError::InvalidIndex;
+    }
+}
+
 ParseResult<Module> Module::parse(InputStream& stream)
 {
     ScopeLogger<WASM_BINPARSER_DEBUG> logger("Module");
@@ -1243,117 +1365,166 @@ ParseResult<Module> Module::parse(InputStream& stream)
             }
         };
 
-        switch (section_id) {
-        case CustomSection::section_id: {
-            if (auto section = CustomSection::parse(section_stream); !section.is_error()) {
-                sections.append(section.release_value());
-                continue;
-            } else {
-                return section.error();
-            }
-        }
-        case TypeSection::section_id: {
-            if (auto section = TypeSection::parse(section_stream); !section.is_error()) {
-                sections.append(section.release_value());
-                continue;
-            } else {
-                return section.error();
-            }
-        }
-        case ImportSection::section_id: {
-            if (auto section = ImportSection::parse(section_stream); !section.is_error()) {
-                sections.append(section.release_value());
-                continue;
-            } else {
-                return section.error();
-            }
-        }
-        case FunctionSection::section_id: {
-            if (auto section = FunctionSection::parse(section_stream); !section.is_error()) {
-                sections.append(section.release_value());
-                continue;
-            } else {
-                return section.error();
-            }
-        }
-        case TableSection::section_id: {
-            if (auto section = TableSection::parse(section_stream); !section.is_error()) {
-                sections.append(section.release_value());
-                continue;
-            } else {
-                return section.error();
-            }
-        }
-        case MemorySection::section_id: {
-            if (auto section = MemorySection::parse(section_stream); !section.is_error()) {
-                sections.append(section.release_value());
-                continue;
-            } else {
-                return section.error();
-            }
-        }
-        case GlobalSection::section_id: {
-            if (auto section = GlobalSection::parse(section_stream); !section.is_error()) {
-                sections.append(section.release_value());
-                continue;
-            } else {
-                return section.error();
-            }
-        }
-        case ExportSection::section_id: {
-            if (auto section = ExportSection::parse(section_stream); !section.is_error()) {
-                sections.append(section.release_value());
-                continue;
-            } else {
-                return section.error();
-            }
-        }
-        case StartSection::section_id: {
-            if (auto section = StartSection::parse(section_stream); !section.is_error()) {
-                sections.append(section.release_value());
-                continue;
-            } else {
-                return section.error();
-            }
-        }
-        case ElementSection::section_id: {
-            if (auto section = ElementSection::parse(section_stream); !section.is_error()) {
-                sections.append(section.release_value());
-                continue;
-            } else {
-                return section.error();
-            }
+        auto section = parse_section(section_id, section_stream);
+        if (section.is_error())
+            return section.error();
+        sections.append(section.release_value());
+    }
+
+    return Module { move(sections) };
+}
+
+StreamingModuleParser::StreamingModuleParser() = default;
+
+StreamingModuleParser::~StreamingModuleParser() = default;
+
+Optional<ParseError> StreamingModuleParser::append(ReadonlyBytes bytes)
+{
+    if (m_error.has_value())
+        return m_error;
+
+    m_buffer.append(bytes);
+    m_error = parse_available_bytes();
+
+    // Only drop what has been parsed once it makes up most of the buffer, so that a section arriving in many small
+    // pieces isn't copied over and over again.
+    if (m_offset > 0 && m_offset >= m_buffer.size() / 2) {
+        m_buffer = ByteBuffer::copy(m_buffer.bytes().slice(m_offset));
+        m_offset = 0;
+    }
+    return m_error;
+}
+
+Optional<ParseError> StreamingModuleParser::parse_available_bytes()
+{
+    if (!m_has_parsed_header) {
+        auto bytes = m_buffer.bytes().slice(m_offset);
+        if (bytes.size() < 8)
+            return {};
+        if (bytes.slice(0, 4) != Module::wasm_magic.span())
+            return ParseError::InvalidModuleMagic;
+        if (bytes.slice(4, 4) != Module::wasm_version.span())
+            return ParseError::InvalidModuleVersion;
+        m_offset += 8;
+        m_has_parsed_header = true;
+    }
+
+    for (;;) {
+        if (m_next_code_body < m_code_bodies.size()) {
+            if (auto error = parse_code_bodies(); error.has_value())
+                return error;
+            if (m_next_code_body < m_code_bodies.size())
+                return {};
+            if (m_code_section_bytes_left != 0)
+                return ParseError::InvalidSize;
         }
-        case CodeSection::section_id: {
-            if (auto section = CodeSection::parse(section_stream); !section.is_error()) {
-                sections.append(section.release_value());
-                continue;
-            } else {
-                return section.error();
+
+        auto bytes = m_buffer.bytes().slice(m_offset);
+        if (bytes.is_empty())
+            return {};
+
+        InputMemoryStream stream { bytes };
+        ScopeGuard drain_errors {
+            [&] {
+                stream.handle_any_error();
             }
+        };
+        u8 section_id;
+        stream >> section_id;
+        // Note: LEB128 rewinds memory streams it runs out of bytes in, which doesn't work when that happens right at
+        //       the end, so it only gets to see a plain InputStream here.
+        size_t section_size;
+        if (!LEB128::read_unsigned(static_cast<InputStream&>(stream), section_size))
+            return stream.unreliable_eof() ? Optional<ParseError> {} : ParseError::ExpectedSize;
+        auto header_size = stream.offset();
+
+        if (section_id == CodeSection::section_id) {
+            if (m_code_section_position.has_value())
+                return ParseError::InvalidIndex;
+            size_t count;
+            if (!LEB128::read_unsigned(static_cast<InputStream&>(stream), count))
+                return stream.unreliable_eof() ? Optional<ParseError> {} : ParseError::ExpectedSize;
+            auto count_size = stream.offset() - header_size;
+            // Every function body takes up at least a byte for its size.
+            if (count_size + count > section_size)
+                return ParseError::InvalidSize;
+
+            m_code_section_position = m_sections.size();
+            m_code_section_bytes_left = section_size - count_size;
+            m_code_bodies.resize(count);
+            m_code_body_errors.resize(count);
+            m_code_body_tasks = make<Threading::TaskGroup>();
+            m_offset += stream.offset();
+            if (count == 0 && m_code_section_bytes_left != 0)
+                return ParseError::InvalidSize;
+            continue;
         }
-        case DataSection::section_id: {
-            if (auto section = DataSection::parse(section_stream); !section.is_error()) {
-                sections.append(section.release_value());
-                continue;
-            } else {
-                return section.error();
+
+        if (bytes.size() - header_size < section_size)
+            return {};
+        InputMemoryStream section_stream { bytes.slice(header_size, section_size) };
+        ScopeGuard drain_section_errors {
+            [&] {
+                section_stream.handle_any_error();
             }
-        }
-        case DataCountSection::section_id: {
-            if (auto section = DataCountSection::parse(section_stream); !section.is_error()) {
-                sections.append(section.release_value());
-                continue;
-            } else {
-                return section.error();
+        };
+        auto section = parse_section(section_id, section_stream);
+        if (section.is_error())
+            return section.error();
+        m_sections.append(section.release_value());
+        m_offset += header_size + section_size;
+    }
+}
+
+Optional<ParseError> StreamingModuleParser::parse_code_bodies()
+{
+    while (m_next_code_body < m_code_bodies.size()) {
+        auto bytes = m_buffer.bytes().slice(m_offset);
+        InputMemoryStream stream { bytes };
+        ScopeGuard drain_errors {
+            [&] {
+                stream.handle_any_error();
             }
-        }
-        default:
-            return with_eof_check(stream, ParseError::InvalidIndex);
-        }
+        };
+        size_t size;
+        if (!LEB128::read_unsigned(static_cast<InputStream&>(stream), size))
+            return stream.unreliable_eof() ? Optional<ParseError> {} : ParseError::InvalidSize;
+        auto header_size = stream.offset();
+        if (header_size > m_code_section_bytes_left || size > m_code_section_bytes_left - header_size)
+            return ParseError::InvalidSize;
+        if (bytes.size() - header_size < size)
+            return {};
+
+        auto index = m_next_code_body++;
+        m_code_body_tasks->spawn([this, index, body = ByteBuffer::copy(bytes.slice(header_size, size))] {
+            auto result = parse_code_body(body);
+            if (result.is_error())
+                m_code_body_errors[index] = result.error();
+            else
+                m_code_bodies[index] = result.release_value();
+        });
+        m_offset += header_size + size;
+        m_code_section_bytes_left -= header_size + size;
     }
+    return {};
+}
 
-    return Module { move(sections) };
+ParseResult<Module> StreamingModuleParser::finish()
+{
+    if (m_code_body_tasks)
+        m_code_body_tasks->wait();
+    if (m_error.has_value())
+        return *m_error;
+    if (!m_has_parsed_header || m_offset != m_buffer.size() || m_next_code_body < m_code_bodies.size())
+        return ParseError::UnexpectedEof;
+
+    if (m_code_section_position.has_value()) {
+        auto functions = collect_code_bodies(m_code_bodies, m_code_body_errors);
+        if (functions.is_error())
+            return functions.error();
+        m_sections.insert(*m_code_section_position, CodeSection { functions.release_value() });
+    }
+    return Module { move(m_sections) };
 }
 
 void Module::populate_sections()
@@ -0,0 +1,146 @@
+// Every function here can be compiled, so invoke() runs the compiled code, while
+// invokeInterpreted() runs the same function one instruction at a time. Both have to give the
+// same results, and trap on the same instructions.
+
+// Each export takes no parameters and returns (or traps on) a single constant expression.
+// The module has one page of memory that can't grow.
+// prettier-ignore
+const binary = new Uint8Array([
+        0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x68, 0x1a, 0x60, 0x00, 0x01, 0x7f, 0x60,
+        0x00, 0x01, 0x7e, 0x60, 0x00, 0x01, 0x7f, 0x60, 0x00, 0x01, 0x7f, 0x60, 0x00, 0x01, 0x7e, 0x60,
+        0x00, 0x01, 0x7e, 0x60, 0x00, 0x01, 0x7d, 0x60, 0x00, 0x01, 0x7d, 0x60, 0x00, 0x01, 0x7d, 0x60,
+        0x00, 0x01, 0x7c, 0x60, 0x00, 0x01, 0x7c, 0x60, 0x00, 0x01, 0x7c, 0x60, 0x00, 0x01, 0x7f, 0x60,
+        0x00, 0x01, 0x7f, 0x60, 0x00, 0x01, 0x7f, 0x60, 0x00, 0x01, 0x7d, 0x60, 0x00, 0x01, 0x7d, 0x60,
+        0x00, 0x01, 0x7c, 0x60, 0x00, 0x01, 0x7f, 0x60, 0x00, 0x01, 0x7f, 0x60, 0x00, 0x01, 0x7e, 0x60,
+        0x00, 0x01, 0x7f, 0x60, 0x00, 0x01, 0x7f, 0x60, 0x00, 0x01, 0x7f, 0x60, 0x00, 0x00, 0x60, 0x00,
+        0x01, 0x7f, 0x03, 0x1b, 0x1a, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a,
+        0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x05,
+        0x04, 0x01, 0x01, 0x01, 0x01, 0x07, 0x9d, 0x04, 0x1a, 0x12, 0x69, 0x33, 0x32, 0x5f, 0x72, 0x65,
+        0x6d, 0x5f, 0x73, 0x5f, 0x6f, 0x76, 0x65, 0x72, 0x66, 0x6c, 0x6f, 0x77, 0x00, 0x00, 0x12, 0x69,
+        0x36, 0x34, 0x5f, 0x72, 0x65, 0x6d, 0x5f, 0x73, 0x5f, 0x6f, 0x76, 0x65, 0x72, 0x66, 0x6c, 0x6f,
+        0x77, 0x00, 0x01, 0x09, 0x69, 0x33, 0x32, 0x5f, 0x73, 0x68, 0x72, 0x5f, 0x73, 0x00, 0x02, 0x11,
+        0x69, 0x33, 0x32, 0x5f, 0x73, 0x68, 0x72, 0x5f, 0x73, 0x5f, 0x77, 0x72, 0x61, 0x70, 0x70, 0x65,
+        0x64, 0x00, 0x03, 0x09, 0x69, 0x36, 0x34, 0x5f, 0x73, 0x68, 0x72, 0x5f, 0x73, 0x00, 0x04, 0x11,
+        0x69, 0x36, 0x34, 0x5f, 0x73, 0x68, 0x72, 0x5f, 0x73, 0x5f, 0x77, 0x72, 0x61, 0x70, 0x70, 0x65,
+        0x64, 0x00, 0x05, 0x0f, 0x66, 0x33, 0x32, 0x5f, 0x6e, 0x65, 0x61, 0x72, 0x65, 0x73, 0x74, 0x5f,
+        0x32, 0x5f, 0x35, 0x00, 0x06, 0x0f, 0x66, 0x33, 0x32, 0x5f, 0x6e, 0x65, 0x61, 0x72, 0x65, 0x73,
+        0x74, 0x5f, 0x33, 0x5f, 0x35, 0x00, 0x07, 0x15, 0x66, 0x33, 0x32, 0x5f, 0x6e, 0x65, 0x61, 0x72,
+        0x65, 0x73, 0x74, 0x5f, 0x6d, 0x69, 0x6e, 0x75, 0x73, 0x5f, 0x32, 0x5f, 0x35, 0x00, 0x08, 0x0f,
+        0x66, 0x36, 0x34, 0x5f, 0x6e, 0x65, 0x61, 0x72, 0x65, 0x73, 0x74, 0x5f, 0x32, 0x5f, 0x35, 0x00,
+        0x09, 0x0f, 0x66, 0x36, 0x34, 0x5f, 0x6e, 0x65, 0x61, 0x72, 0x65, 0x73, 0x74, 0x5f, 0x33, 0x5f,
+        0x35, 0x00, 0x0a, 0x15, 0x66, 0x36, 0x34, 0x5f, 0x6e, 0x65, 0x61, 0x72, 0x65, 0x73, 0x74, 0x5f,
+        0x6d, 0x69, 0x6e, 0x75, 0x73, 0x5f, 0x32, 0x5f, 0x35, 0x00, 0x0b, 0x0c, 0x66, 0x36, 0x34, 0x5f,
+        0x67, 0x65, 0x5f, 0x65, 0x71, 0x75, 0x61, 0x6c, 0x00, 0x0c, 0x14, 0x66, 0x36, 0x34, 0x5f, 0x67,
+        0x65, 0x5f, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x5f, 0x7a, 0x65, 0x72, 0x6f, 0x65, 0x73, 0x00,
+        0x0d, 0x0a, 0x66, 0x36, 0x34, 0x5f, 0x67, 0x65, 0x5f, 0x6e, 0x61, 0x6e, 0x00, 0x0e, 0x1b, 0x66,
+        0x33, 0x32, 0x5f, 0x63, 0x6f, 0x6e, 0x76, 0x65, 0x72, 0x74, 0x5f, 0x69, 0x36, 0x34, 0x5f, 0x75,
+        0x5f, 0x61, 0x62, 0x6f, 0x76, 0x65, 0x5f, 0x75, 0x33, 0x32, 0x00, 0x0f, 0x1a, 0x66, 0x33, 0x32,
+        0x5f, 0x63, 0x6f, 0x6e, 0x76, 0x65, 0x72, 0x74, 0x5f, 0x69, 0x36, 0x34, 0x5f, 0x75, 0x5f, 0x72,
+        0x6f, 0x75, 0x6e, 0x64, 0x69, 0x6e, 0x67, 0x00, 0x10, 0x15, 0x66, 0x36, 0x34, 0x5f, 0x63, 0x6f,
+        0x6e, 0x76, 0x65, 0x72, 0x74, 0x5f, 0x69, 0x36, 0x34, 0x5f, 0x75, 0x5f, 0x6d, 0x61, 0x78, 0x00,
+        0x11, 0x12, 0x69, 0x33, 0x32, 0x5f, 0x64, 0x69, 0x76, 0x5f, 0x73, 0x5f, 0x6f, 0x76, 0x65, 0x72,
+        0x66, 0x6c, 0x6f, 0x77, 0x00, 0x12, 0x11, 0x69, 0x33, 0x32, 0x5f, 0x64, 0x69, 0x76, 0x5f, 0x75,
+        0x5f, 0x62, 0x79, 0x5f, 0x7a, 0x65, 0x72, 0x6f, 0x00, 0x13, 0x11, 0x69, 0x36, 0x34, 0x5f, 0x72,
+        0x65, 0x6d, 0x5f, 0x73, 0x5f, 0x62, 0x79, 0x5f, 0x7a, 0x65, 0x72, 0x6f, 0x00, 0x14, 0x13, 0x69,
+        0x33, 0x32, 0x5f, 0x74, 0x72, 0x75, 0x6e, 0x63, 0x5f, 0x66, 0x33, 0x32, 0x5f, 0x73, 0x5f, 0x6e,
+        0x61, 0x6e, 0x00, 0x15, 0x1c, 0x69, 0x33, 0x32, 0x5f, 0x74, 0x72, 0x75, 0x6e, 0x63, 0x5f, 0x66,
+        0x36, 0x34, 0x5f, 0x73, 0x5f, 0x6f, 0x75, 0x74, 0x5f, 0x6f, 0x66, 0x5f, 0x72, 0x61, 0x6e, 0x67,
+        0x65, 0x00, 0x16, 0x16, 0x69, 0x33, 0x32, 0x5f, 0x6c, 0x6f, 0x61, 0x64, 0x5f, 0x6f, 0x75, 0x74,
+        0x5f, 0x6f, 0x66, 0x5f, 0x62, 0x6f, 0x75, 0x6e, 0x64, 0x73, 0x00, 0x17, 0x0b, 0x75, 0x6e, 0x72,
+        0x65, 0x61, 0x63, 0x68, 0x61, 0x62, 0x6c, 0x65, 0x00, 0x18, 0x18, 0x6d, 0x65, 0x6d, 0x6f, 0x72,
+        0x79, 0x5f, 0x67, 0x72, 0x6f, 0x77, 0x5f, 0x70, 0x61, 0x73, 0x74, 0x5f, 0x6d, 0x61, 0x78, 0x69,
+        0x6d, 0x75, 0x6d, 0x00, 0x19, 0x0a, 0xa9, 0x02, 0x1a, 0x0b, 0x00, 0x41, 0x80, 0x80, 0x80, 0x80,
+        0x78, 0x41, 0x7f, 0x6f, 0x0b, 0x10, 0x00, 0x42, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+        0x80, 0x7f, 0x42, 0x7f, 0x81, 0x0b, 0x07, 0x00, 0x41, 0x78, 0x41, 0x01, 0x75, 0x0b, 0x07, 0x00,
+        0x41, 0x78, 0x41, 0x21, 0x75, 0x0b, 0x07, 0x00, 0x42, 0x78, 0x42, 0x01, 0x87, 0x0b, 0x08, 0x00,
+        0x42, 0x78, 0x42, 0xc1, 0x00, 0x87, 0x0b, 0x08, 0x00, 0x43, 0x00, 0x00, 0x20, 0x40, 0x90, 0x0b,
+        0x08, 0x00, 0x43, 0x00, 0x00, 0x60, 0x40, 0x90, 0x0b, 0x08, 0x00, 0x43, 0x00, 0x00, 0x20, 0xc0,
+        0x90, 0x0b, 0x0c, 0x00, 0x44, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x40, 0x9e, 0x0b, 0x0c,
+        0x00, 0x44, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x40, 0x9e, 0x0b, 0x0c, 0x00, 0x44, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0xc0, 0x9e, 0x0b, 0x15, 0x00, 0x44, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0xf8, 0x3f, 0x44, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf8, 0x3f, 0x66, 0x0b, 0x15,
+        0x00, 0x44, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x44, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x80, 0x66, 0x0b, 0x15, 0x00, 0x44, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf8, 0x7f,
+        0x44, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf8, 0x7f, 0x66, 0x0b, 0x09, 0x00, 0x42, 0x81, 0x80,
+        0x80, 0x80, 0x10, 0xb5, 0x0b, 0x0e, 0x00, 0x42, 0x81, 0x80, 0x80, 0x80, 0x80, 0x90, 0x80, 0x80,
+        0x80, 0x7f, 0xb5, 0x0b, 0x05, 0x00, 0x42, 0x7f, 0xba, 0x0b, 0x0b, 0x00, 0x41, 0x80, 0x80, 0x80,
+        0x80, 0x78, 0x41, 0x7f, 0x6d, 0x0b, 0x07, 0x00, 0x41, 0x01, 0x41, 0x00, 0x6e, 0x0b, 0x07, 0x00,
+        0x42, 0x01, 0x42, 0x00, 0x81, 0x0b, 0x08, 0x00, 0x43, 0x00, 0x00, 0xc0, 0x7f, 0xa8, 0x0b, 0x0c,
+        0x00, 0x44, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe0, 0x41, 0xaa, 0x0b, 0x09, 0x00, 0x41, 0xfe,
+        0xff, 0x03, 0x28, 0x02, 0x00, 0x0b, 0x03, 0x00, 0x00, 0x0b, 0x06, 0x00, 0x41, 0x01, 0x40, 0x00,
+        0x0b,
+]);
+
+const module = parseWebAssemblyModule(binary);
+
+function run(invoke, name) {
+    try {
+        return { value: invoke.call(module, module.getExport(name)) };
+    } catch (error) {
+        return { error: error.message };
+    }
+}
+
+function expectValue(name, value) {
+    expect(run(module.invoke, name)).toEqual({ value });
+    expect(run(module.invokeInterpreted, name)).toEqual({ value });
+}
+
+// Integer arithmetic traps are reported with the condition that failed, which each path spells
+// differently, so only the traps that have a name are compared by their reason.
+function expectTrap(name, reason) {
+    for (const invoke of [module.invoke, module.invokeInterpreted]) {
+        const result = run(invoke, name);
+        expect(result.value).toBeUndefined();
+        expect(result.error.startsWith("Execution trapped: ")).toBeTrue();
+        if (reason !== undefined) expect(result.error).toBe(`Execution trapped: ${reason}`);
+    }
+}
+
+test("rem_s of the smallest integer by -1 is zero", () => {
+    expectValue("i32_rem_s_overflow", 0);
+    expectValue("i64_rem_s_overflow", 0);
+});
+
+test("shr_s keeps the sign and wraps the shift count", () => {
+    expectValue("i32_shr_s", -4);
+    expectValue("i32_shr_s_wrapped", -4);
+    expectValue("i64_shr_s", -4);
+    expectValue("i64_shr_s_wrapped", -4);
+});
+
+test("nearest rounds halfway cases to even", () => {
+    expectValue("f32_nearest_2_5", 2);
+    expectValue("f32_nearest_3_5", 4);
+    expectValue("f32_nearest_minus_2_5", -2);
+    expectValue("f64_nearest_2_5", 2);
+    expectValue("f64_nearest_3_5", 4);
+    expectValue("f64_nearest_minus_2_5", -2);
+});
+
+test("f64.ge holds for equal operands", () => {
+    expectValue("f64_ge_equal", 1);
+    expectValue("f64_ge_signed_zeroes", 1);
+    expectValue("f64_ge_nan", 0);
+});
+
+test("convert_i64_u uses all 64 bits", () => {
+    expectValue("f32_convert_i64_u_above_u32", 4294967296);
+    // 2^63 + 2^39 + 1 is just above halfway between two floats, so it rounds up, not to even.
+    expectValue("f32_convert_i64_u_rounding", 9223373136366403584);
+    expectValue("f64_convert_i64_u_max", 18446744073709551616);
+});
+
+test("both paths trap in the same places", () => {
+    expectTrap("i32_div_s_overflow");
+    expectTrap("i32_div_u_by_zero");
+    expectTrap("i64_rem_s_by_zero");
+    expectTrap("i32_trunc_f32_s_nan", "Signed truncation undefined behaviour");
+    expectTrap("i32_trunc_f64_s_out_of_range", "Signed truncation out of range");
+    expectTrap("i32_load_out_of_bounds", "Memory access out of bounds");
+    expectTrap("unreachable", "Unreachable");
+});
+
+test("memory.grow past the maximum fails without trapping", () => {
+    expectValue("memory_grow_past_maximum", -1);
+});
@@ -0,0 +1,48 @@
+// A memory without a declared maximum may grow up to 4 GiB, which has to be handled without
+// reserving that much up front, and without overflowing on 32-bit targets.
+//
+// (memory 1)
+// (func (export "grow") (param i32) (result i32) (memory.grow (local.get 0)))
+// (func (export "size") (result i32) (memory.size))
+// (func (export "store_and_load_last_word") (param i32) (result i32)
+//     (i32.store (i32.sub (i32.shl (memory.size) (i32.const 16)) (i32.const 4)) (local.get 0))
+//     (i32.load (i32.sub (i32.shl (memory.size) (i32.const 16)) (i32.const 4))))
+// prettier-ignore
+const binary = new Uint8Array([
+        0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x0f, 0x03, 0x60, 0x01, 0x7f, 0x01, 0x7f,
+        0x60, 0x00, 0x01, 0x7f, 0x60, 0x01, 0x7f, 0x01, 0x7f, 0x03, 0x04, 0x03, 0x00, 0x01, 0x02, 0x05,
+        0x03, 0x01, 0x00, 0x01, 0x07, 0x2a, 0x03, 0x04, 0x67, 0x72, 0x6f, 0x77, 0x00, 0x00, 0x04, 0x73,
+        0x69, 0x7a, 0x65, 0x00, 0x01, 0x18, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x5f, 0x61, 0x6e, 0x64, 0x5f,
+        0x6c, 0x6f, 0x61, 0x64, 0x5f, 0x6c, 0x61, 0x73, 0x74, 0x5f, 0x77, 0x6f, 0x72, 0x64, 0x00, 0x02,
+        0x0a, 0x28, 0x03, 0x06, 0x00, 0x20, 0x00, 0x40, 0x00, 0x0b, 0x04, 0x00, 0x3f, 0x00, 0x0b, 0x1a,
+        0x00, 0x3f, 0x00, 0x41, 0x10, 0x74, 0x41, 0x04, 0x6b, 0x20, 0x00, 0x36, 0x02, 0x00, 0x3f, 0x00,
+        0x41, 0x10, 0x74, 0x41, 0x04, 0x6b, 0x28, 0x02, 0x00, 0x0b,
+]);
+
+const module = parseWebAssemblyModule(binary);
+const grow = module.getExport("grow");
+const size = module.getExport("size");
+const storeAndLoadLastWord = module.getExport("store_and_load_last_word");
+
+test("memory without a maximum grows several times", () => {
+    let pages = 1;
+    for (const delta of [1, 2, 16, 100, 1]) {
+        expect(module.invoke(grow, delta)).toBe(pages);
+        pages += delta;
+        expect(module.invoke(size)).toBe(pages);
+        expect(module.invoke(storeAndLoadLastWord, pages)).toBe(pages);
+        expect(module.invokeInterpreted(storeAndLoadLastWord, pages + 1)).toBe(pages + 1);
+    }
+
+    expect(module.invokeInterpreted(grow, 3)).toBe(pages);
+    pages += 3;
+    expect(module.invokeInterpreted(size)).toBe(pages);
+    expect(module.invoke(storeAndLoadLastWord, pages)).toBe(pages);
+});
+
+test("memory without a maximum can't grow past 4 GiB", () => {
+    const pages = module.invoke(size);
+    expect(module.invoke(grow, 65536)).toBe(-1);
+    expect(module.invokeInterpreted(grow, 65536)).toBe(-1);
+    expect(module.invoke(size)).toBe(pages);
+});
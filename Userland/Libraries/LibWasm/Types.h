@@ -6,16 +6,23 @@
 
 #pragma once
 
+#include <AK/ByteBuffer.h>
 #include <AK/Debug.h>
 #include <AK/DistinctNumeric.h>
 #include <AK/MemoryStream.h>
+#include <AK/Noncopyable.h>
 #include <AK/NonnullOwnPtrVector.h>
+#include <AK/OwnPtr.h>
 #include <AK/Result.h>
 #include <AK/String.h>
 #include <AK/Variant.h>
 #include <LibWasm/Constants.h>
 #include <LibWasm/Opcode.h>
 
+namespace Threading {
+class TaskGroup;
+}
+
 namespace Wasm {
 
 enum class ParseError {
@@ -1033,4 +1040,38 @@ private:
     Vector<AnySection> m_sections;
     Vector<Function> m_functions;
 };
+
+// Parses a module while its bytes are still arriving: every section is parsed as soon as all of it is there, and
+// function bodies are handed to the ThreadPool one by one as they come in, instead of after the whole code section.
+class StreamingModuleParser {
+    AK_MAKE_NONCOPYABLE(StreamingModuleParser);
+    AK_MAKE_NONMOVABLE(StreamingModuleParser);
+
+public:
+    StreamingModuleParser();
+    ~StreamingModuleParser();
+
+    // Returns the first error found so far; once there is one, everything appended after it is ignored.
+    Optional<ParseError> append(ReadonlyBytes);
+    ParseResult<Module> finish();
+
+private:
+    Optional<ParseError> parse_available_bytes();
+    Optional<ParseError> parse_code_bodies();
+
+    ByteBuffer m_buffer;
+    size_t m_offset { 0 };
+    bool m_has_parsed_header { false };
+    Optional<ParseError> m_error;
+    Vector<Module::AnySection> m_sections;
+
+    // The code section is assembled in finish(), at the position it had among the other sections.
+    Optional<size_t> m_code_section_position;
+    size_t m_code_section_bytes_left { 0 };
+    size_t m_next_code_body { 0 };
+    Vector<Optional<CodeSection::Code>> m_code_bodies;
+    Vector<Optional<ParseError>> m_code_body_errors;
+    // Declared last, so that it's destroyed first and waits for the tasks that write into the vectors above.
+    OwnPtr<Threading::TaskGroup> m_code_body_tasks;
+};
 }
@@ -4,52 +4,67 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include <LibWeb/CSS/CSSStyleRule.h>
 #include <LibWeb/CSS/StyleInvalidator.h>
 #include <LibWeb/DOM/Document.h>
 #include <LibWeb/DOM/Element.h>
+#include <LibWeb/HTML/AttributeNames.h>
 
 namespace Web::CSS {
 
-StyleInvalidator::StyleInvalidator(DOM::Document& document)
-    : m_document(document)
+StyleInvalidator::StyleInvalidator(DOM::Element& element, FlyString const& attribute_name)
+    : m_element(element)
+    , m_attribute_name(attribute_name)
 {
-    if (!m_document.should_invalidate_styles_on_attribute_changes())
+    if (!m_element.document().should_invalidate_styles_on_attribute_changes())
         return;
-    auto& style_resolver = m_document.style_resolver();
-    m_document.for_each_in_inclusive_subtree_of_type<DOM::Element>([&](auto& element) {
-        m_elements_and_matching_rules_before.set(&element, style_resolver.collect_matching_rules(element));
-        return IterationDecision::Continue;
-    });
+    if (m_attribute_name == HTML::AttributeNames::class_)
+        m_classes_before = m_element.class_names();
+    else if (m_attribute_name == HTML::AttributeNames::id)
+        m_id_before = m_element.attribute(HTML::AttributeNames::id);
 }
 
 StyleInvalidator::~StyleInvalidator()
 {
-    if (!m_document.should_invalidate_styles_on_attribute_changes())
+    if (!m_element.document().should_invalidate_styles_on_attribute_changes())
         return;
-    auto& style_resolver = m_document.style_resolver();
-    m_document.for_each_in_inclusive_subtree_of_type<DOM::Element>([&](auto& element) {
-        auto maybe_matching_rules_before = m_elements_and_matching_rules_before.get(&element);
-        if (!maybe_matching_rules_before.has_value()) {
-            element.set_needs_style_update(true);
-            return IterationDecision::Continue;
-        }
-        auto& matching_rules_before = maybe_matching_rules_before.value();
-        auto matching_rules_after = style_resolver.collect_matching_rules(element);
-        if (matching_rules_before.size() != matching_rules_after.size()) {
-            element.set_needs_style_update(true);
-            return IterationDecision::Continue;
+    if (!attribute_change_affects_style())
+        return;
+
+    m_element.invalidate_style();
+    if (!m_element.document().style_resolver().has_sibling_combinators())
+        return;
+    for (auto* sibling = m_element.next_element_sibling(); sibling; sibling = sibling->next_element_sibling())
+        sibling->invalidate_style();
+}
+
+bool StyleInvalidator::attribute_change_affects_style() const
+{
+    auto& style_resolver = m_element.document().style_resolver();
+    if (style_resolver.is_attribute_used_in_selectors(m_attribute_name))
+        return true;
+
+    if (m_attribute_name == HTML::AttributeNames::class_) {
+        auto& classes_after = m_element.class_names();
+        for (auto& class_name : m_classes_before) {
+            if (!classes_after.contains_slow(class_name) && style_resolver.is_class_used_in_selectors(class_name))
+                return true;
         }
-        style_resolver.sort_matching_rules(matching_rules_before);
-        style_resolver.sort_matching_rules(matching_rules_after);
-        for (size_t i = 0; i < matching_rules_before.size(); ++i) {
-            if (matching_rules_before[i].rule != matching_rules_after[i].rule) {
-                element.set_needs_style_update(true);
-                break;
-            }
+        for (auto& class_name : classes_after) {
+            if (!m_classes_before.contains_slow(class_name) && style_resolver.is_class_used_in_selectors(class_name))
+                return true;
         }
-        return IterationDecision::Continue;
-    });
+        return false;
+    }
+
+    if (m_attribute_name == HTML::AttributeNames::id) {
+        auto id_after = m_element.attribute(HTML::AttributeNames::id);
+        if (id_after == m_id_before)
+            return false;
+        return (!m_id_before.is_null() && style_resolver.is_id_used_in_selectors(m_id_before))
+            || (!id_after.is_null() && style_resolver.is_id_used_in_selectors(id_after));
+    }
+
+    return false;
 }
 
 }
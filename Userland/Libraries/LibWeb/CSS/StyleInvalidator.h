@@ -6,21 +6,29 @@
 
 #pragma once
 
-#include <AK/HashMap.h>
+#include <AK/FlyString.h>
+#include <AK/Vector.h>
 #include <LibWeb/CSS/StyleResolver.h>
 #include <LibWeb/DOM/Document.h>
 #include <LibWeb/DOM/Element.h>
 
 namespace Web::CSS {
 
+// Marks the elements whose style may be affected by changing an attribute of an element, for the lifetime of the invalidator.
+// Only the element's subtree, and if there are sibling combinators its following siblings' subtrees, can be affected, and
+// only if some selector looks at the attribute, or at one of the classes or ids that were added or removed.
 class StyleInvalidator {
 public:
-    explicit StyleInvalidator(DOM::Document&);
+    StyleInvalidator(DOM::Element&, FlyString const& attribute_name);
     ~StyleInvalidator();
 
 private:
-    DOM::Document& m_document;
-    HashMap<DOM::Element*, Vector<MatchingRule>> m_elements_and_matching_rules_before;
+    bool attribute_change_affects_style() const;
+
+    DOM::Element& m_element;
+    FlyString m_attribute_name;
+    Vector<FlyString> m_classes_before;
+    String m_id_before;
 };
 
 }
@@ -6,6 +6,9 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/AnyOf.h>
+#include <AK/Array.h>
+#include <AK/HashFunctions.h>
 #include <AK/QuickSort.h>
 #include <LibWeb/CSS/CSSStyleRule.h>
 #include <LibWeb/CSS/Parser/DeprecatedCSSParser.h>
@@ -16,6 +19,7 @@
 #include <LibWeb/DOM/Document.h>
 #include <LibWeb/DOM/Element.h>
 #include <LibWeb/Dump.h>
+#include <LibWeb/HTML/AttributeNames.h>
 #include <ctype.h>
 #include <stdio.h>
 
@@ -63,9 +67,149 @@ void StyleResolver::for_each_stylesheet(Callback callback) const
     }
 }
 
-Vector<MatchingRule> StyleResolver::collect_matching_rules(DOM::Element const& element) const
+enum class AncestorHashKind : u32 {
+    TagName = 1,
+    Id,
+    Class,
+};
+
+static u32 ancestor_hash(AncestorHashKind kind, u32 name_hash)
 {
-    Vector<MatchingRule> matching_rules;
+    return pair_int_hash(static_cast<u32>(kind), name_hash);
+}
+
+// A Bloom filter of the tag names, ids and classes of an element's ancestors.
+class AncestorFilter {
+public:
+    explicit AncestorFilter(DOM::Element const& element)
+    {
+        // Walk the ancestors the same way SelectorEngine does for descendant and child combinators.
+        for (auto* ancestor = element.parent(); ancestor; ancestor = ancestor->parent()) {
+            if (!is<DOM::Element>(*ancestor))
+                continue;
+            auto& ancestor_element = verify_cast<DOM::Element>(*ancestor);
+            add(ancestor_hash(AncestorHashKind::TagName, ancestor_element.local_name().hash()));
+            if (auto id = ancestor_element.attribute(HTML::AttributeNames::id); !id.is_null())
+                add(ancestor_hash(AncestorHashKind::Id, id.hash()));
+            for (auto& class_name : ancestor_element.class_names())
+                add(ancestor_hash(AncestorHashKind::Class, class_name.hash()));
+        }
+    }
+
+    bool may_contain(u32 hash) const
+    {
+        return is_bit_set(hash) && is_bit_set(hash >> 16);
+    }
+
+private:
+    static constexpr size_t bit_count = 1024;
+
+    void add(u32 hash)
+    {
+        set_bit(hash);
+        set_bit(hash >> 16);
+    }
+
+    void set_bit(u32 hash) { m_bits[(hash % bit_count) / 64] |= 1ull << (hash % 64); }
+    bool is_bit_set(u32 hash) const { return m_bits[(hash % bit_count) / 64] & (1ull << (hash % 64)); }
+
+    Array<u64, bit_count / 64> m_bits {};
+};
+
+// Every compound selector on the left of a descendant or child combinator has to match an ancestor of the element.
+// Siblings share the element's (or its ancestors') parent, so this holds even when there's a sibling combinator further right.
+static Vector<u32> ancestor_hashes_for_selector(Selector const& selector)
+{
+    Vector<u32> hashes;
+    auto& complex_selectors = selector.complex_selectors();
+    for (size_t i = 1; i < complex_selectors.size(); ++i) {
+        auto relation = complex_selectors[i].relation;
+        if (relation != Selector::ComplexSelector::Relation::Descendant && relation != Selector::ComplexSelector::Relation::ImmediateChild)
+            continue;
+        for (auto& simple_selector : complex_selectors[i - 1].compound_selector) {
+            if (simple_selector.type == Selector::SimpleSelector::Type::TagName)
+                hashes.append(ancestor_hash(AncestorHashKind::TagName, simple_selector.value.hash()));
+            else if (simple_selector.type == Selector::SimpleSelector::Type::Id)
+                hashes.append(ancestor_hash(AncestorHashKind::Id, simple_selector.value.hash()));
+            else if (simple_selector.type == Selector::SimpleSelector::Type::Class)
+                hashes.append(ancestor_hash(AncestorHashKind::Class, simple_selector.value.hash()));
+        }
+    }
+    return hashes;
+}
+
+static Selector::SimpleSelector const* find_simple_selector(Selector::ComplexSelector::CompoundSelector const& compound_selector, Selector::SimpleSelector::Type type)
+{
+    for (auto& simple_selector : compound_selector) {
+        if (simple_selector.type == type)
+            return &simple_selector;
+    }
+    return nullptr;
+}
+
+// Collects the class names, ids and attribute names that a selector looks at. Attribute names are lowercased, since
+// HTML attribute names are case-insensitive.
+static void collect_selector_dependencies(Selector const& selector, HashTable<FlyString>& class_names, HashTable<FlyString>& ids, HashTable<FlyString>& attribute_names, bool& has_sibling_combinators, bool& has_hover_pseudo_class)
+{
+    for (auto& complex_selector : selector.complex_selectors()) {
+        if (complex_selector.relation == Selector::ComplexSelector::Relation::AdjacentSibling || complex_selector.relation == Selector::ComplexSelector::Relation::GeneralSibling)
+            has_sibling_combinators = true;
+
+        for (auto& simple_selector : complex_selector.compound_selector) {
+            switch (simple_selector.type) {
+            case Selector::SimpleSelector::Type::Id:
+                ids.set(simple_selector.value);
+                break;
+            case Selector::SimpleSelector::Type::Class:
+                class_names.set(simple_selector.value);
+                break;
+            case Selector::SimpleSelector::Type::Attribute:
+                attribute_names.set(simple_selector.attribute.name.to_lowercase());
+                break;
+            case Selector::SimpleSelector::Type::PseudoClass:
+                // Some pseudo-classes are matched by looking at attributes, see SelectorEngine.
+                switch (simple_selector.pseudo_class.type) {
+                case Selector::SimpleSelector::PseudoClass::Type::Link:
+                    attribute_names.set(HTML::AttributeNames::href);
+                    break;
+                case Selector::SimpleSelector::PseudoClass::Type::Disabled:
+                case Selector::SimpleSelector::PseudoClass::Type::Enabled:
+                    attribute_names.set(HTML::AttributeNames::disabled);
+                    break;
+                case Selector::SimpleSelector::PseudoClass::Type::Checked:
+                    attribute_names.set(HTML::AttributeNames::checked);
+                    break;
+                case Selector::SimpleSelector::PseudoClass::Type::Hover:
+                    has_hover_pseudo_class = true;
+                    break;
+                case Selector::SimpleSelector::PseudoClass::Type::Not:
+                    for (auto& not_selector : simple_selector.pseudo_class.not_selector)
+                        collect_selector_dependencies(not_selector, class_names, ids, attribute_names, has_sibling_combinators, has_hover_pseudo_class);
+                    break;
+                default:
+                    break;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+}
+
+void StyleResolver::invalidate_rule_cache()
+{
+    m_rule_cache = nullptr;
+}
+
+StyleResolver::RuleCache const& StyleResolver::rule_cache() const
+{
+    // Whether the quirks mode style sheet applies isn't known until the document has been parsed far enough.
+    if (m_rule_cache && m_rule_cache->includes_quirks_mode_stylesheet == document().in_quirks_mode())
+        return *m_rule_cache;
+
+    m_rule_cache = make<RuleCache>();
+    m_rule_cache->includes_quirks_mode_stylesheet = document().in_quirks_mode();
 
     size_t style_sheet_index = 0;
     for_each_stylesheet([&](auto& sheet) {
@@ -75,17 +219,110 @@ Vector<MatchingRule> StyleResolver::collect_matching_rules(DOM::Element const& e
         static_cast<CSSStyleSheet const&>(sheet).for_each_effective_style_rule([&](auto& rule) {
             size_t selector_index = 0;
             for (auto& selector : rule.selectors()) {
-                if (SelectorEngine::matches(selector, element)) {
-                    matching_rules.append({ rule, style_sheet_index, rule_index, selector_index, selector.specificity() });
-                    break;
-                }
+                RuleCandidate candidate { { rule, style_sheet_index, rule_index, selector_index, selector.specificity() }, ancestor_hashes_for_selector(selector) };
                 ++selector_index;
+
+                collect_selector_dependencies(selector, m_rule_cache->class_names_used_in_selectors, m_rule_cache->ids_used_in_selectors, m_rule_cache->attribute_names_used_in_selectors, m_rule_cache->has_sibling_combinators, m_rule_cache->has_hover_pseudo_class);
+
+                if (selector.complex_selectors().is_empty()) {
+                    m_rule_cache->other_rules.append(move(candidate));
+                    continue;
+                }
+                auto& rightmost_compound_selector = selector.complex_selectors().last().compound_selector;
+                if (auto* id = find_simple_selector(rightmost_compound_selector, Selector::SimpleSelector::Type::Id))
+                    m_rule_cache->rules_by_id.ensure(id->value).append(move(candidate));
+                else if (auto* class_name = find_simple_selector(rightmost_compound_selector, Selector::SimpleSelector::Type::Class))
+                    m_rule_cache->rules_by_class.ensure(class_name->value).append(move(candidate));
+                else if (auto* tag_name = find_simple_selector(rightmost_compound_selector, Selector::SimpleSelector::Type::TagName))
+                    m_rule_cache->rules_by_tag_name.ensure(tag_name->value).append(move(candidate));
+                else
+                    m_rule_cache->other_rules.append(move(candidate));
             }
             ++rule_index;
         });
         ++style_sheet_index;
     });
 
+    return *m_rule_cache;
+}
+
+bool StyleResolver::is_class_used_in_selectors(FlyString const& class_name) const
+{
+    return rule_cache().class_names_used_in_selectors.contains(class_name);
+}
+
+bool StyleResolver::is_id_used_in_selectors(FlyString const& id) const
+{
+    return rule_cache().ids_used_in_selectors.contains(id);
+}
+
+bool StyleResolver::is_attribute_used_in_selectors(FlyString const& attribute_name) const
+{
+    return rule_cache().attribute_names_used_in_selectors.contains(attribute_name.to_lowercase());
+}
+
+bool StyleResolver::has_sibling_combinators() const
+{
+    return rule_cache().has_sibling_combinators;
+}
+
+bool StyleResolver::is_hover_pseudo_class_used_in_selectors() const
+{
+    return rule_cache().has_hover_pseudo_class;
+}
+
+Vector<MatchingRule> StyleResolver::collect_matching_rules(DOM::Element const& element) const
+{
+    auto& rule_cache = this->rule_cache();
+
+    Vector<RuleCandidate const*> candidates;
+    auto add_candidates = [&](auto const& rules_by_name, FlyString const& name) {
+        auto it = rules_by_name.find(name);
+        if (it == rules_by_name.end())
+            return;
+        for (auto& candidate : it->value)
+            candidates.append(&candidate);
+    };
+
+    if (auto id = element.attribute(HTML::AttributeNames::id); !id.is_null())
+        add_candidates(rule_cache.rules_by_id, id);
+    for (auto& class_name : element.class_names())
+        add_candidates(rule_cache.rules_by_class, class_name);
+    add_candidates(rule_cache.rules_by_tag_name, element.local_name());
+    for (auto& candidate : rule_cache.other_rules)
+        candidates.append(&candidate);
+
+    // Go through the candidates in style sheet and rule order, so that a rule is matched by its first matching selector.
+    quick_sort(candidates, [](auto* a, auto* b) {
+        auto& a_rule = a->matching_rule;
+        auto& b_rule = b->matching_rule;
+        if (a_rule.style_sheet_index != b_rule.style_sheet_index)
+            return a_rule.style_sheet_index < b_rule.style_sheet_index;
+        if (a_rule.rule_index != b_rule.rule_index)
+            return a_rule.rule_index < b_rule.rule_index;
+        return a_rule.selector_index < b_rule.selector_index;
+    });
+
+    Vector<MatchingRule> matching_rules;
+    Optional<AncestorFilter> ancestor_filter;
+    for (auto* candidate : candidates) {
+        auto& matching_rule = candidate->matching_rule;
+        if (!matching_rules.is_empty() && matching_rules.last().style_sheet_index == matching_rule.style_sheet_index && matching_rules.last().rule_index == matching_rule.rule_index)
+            continue;
+
+        if (!candidate->ancestor_hashes.is_empty()) {
+            if (!ancestor_filter.has_value())
+                ancestor_filter.emplace(element);
+            auto rejected = any_of(candidate->ancestor_hashes, [&](auto hash) { return !ancestor_filter->may_contain(hash); });
+            if (rejected)
+                continue;
+        }
+
+        auto& selector = matching_rule.rule->selectors()[matching_rule.selector_index];
+        if (SelectorEngine::matches(selector, element))
+            matching_rules.append(matching_rule);
+    }
+
     return matching_rules;
 }
 
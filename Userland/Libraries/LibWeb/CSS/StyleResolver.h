@@ -6,6 +6,9 @@
 
 #pragma once
 
+#include <AK/FlyString.h>
+#include <AK/HashMap.h>
+#include <AK/HashTable.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/OwnPtr.h>
 #include <LibWeb/CSS/CSSStyleDeclaration.h>
@@ -43,11 +46,47 @@ public:
 
     static bool is_inherited_property(CSS::PropertyID);
 
+    // Has to be called whenever the set of style rules changes, e.g. when a style sheet or an @import finishes loading.
+    void invalidate_rule_cache();
+
+    // What the selectors of all style rules look at, so that changes nothing can observe don't cause style updates.
+    bool is_class_used_in_selectors(FlyString const&) const;
+    bool is_id_used_in_selectors(FlyString const&) const;
+    bool is_attribute_used_in_selectors(FlyString const&) const;
+    bool has_sibling_combinators() const;
+    bool is_hover_pseudo_class_used_in_selectors() const;
+
 private:
     template<typename Callback>
     void for_each_stylesheet(Callback) const;
 
+    // A selector of a rule, along with hashes of the names that the selector requires some ancestor of the element to have.
+    // If the element's ancestors don't have one of those names, the selector can't match and SelectorEngine doesn't need to run.
+    struct RuleCandidate {
+        MatchingRule matching_rule;
+        Vector<u32> ancestor_hashes;
+    };
+
+    // Selectors bucketed by the most specific simple selector in their rightmost compound selector. An element can only be
+    // matched by selectors from the buckets of its id, its classes and its tag name, or by the ones that fit no bucket.
+    struct RuleCache {
+        HashMap<FlyString, Vector<RuleCandidate>> rules_by_id;
+        HashMap<FlyString, Vector<RuleCandidate>> rules_by_class;
+        HashMap<FlyString, Vector<RuleCandidate>> rules_by_tag_name;
+        Vector<RuleCandidate> other_rules;
+
+        HashTable<FlyString> class_names_used_in_selectors;
+        HashTable<FlyString> ids_used_in_selectors;
+        HashTable<FlyString> attribute_names_used_in_selectors;
+        bool has_sibling_combinators { false };
+        bool has_hover_pseudo_class { false };
+        bool includes_quirks_mode_stylesheet { false };
+    };
+
+    RuleCache const& rule_cache() const;
+
     DOM::Document& m_document;
+    mutable OwnPtr<RuleCache> m_rule_cache;
 };
 
 }
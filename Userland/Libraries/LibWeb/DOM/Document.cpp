@@ -7,6 +7,7 @@
  */
 
 #include <AK/CharacterTypes.h>
+#include <AK/HashTable.h>
 #include <AK/StringBuilder.h>
 #include <AK/Utf8View.h>
 #include <LibCore/Timer.h>
@@ -72,6 +73,10 @@ Document::Document(const URL& url)
     m_forced_layout_timer = Core::Timer::create_single_shot(0, [this] {
         force_layout();
     });
+
+    m_layout_update_timer = Core::Timer::create_single_shot(0, [this] {
+        update_layout();
+    });
 }
 
 Document::~Document()
@@ -157,6 +162,13 @@ void Document::schedule_forced_layout()
     m_forced_layout_timer->start();
 }
 
+void Document::schedule_layout_update()
+{
+    if (m_layout_update_timer->is_active())
+        return;
+    m_layout_update_timer->start();
+}
+
 bool Document::is_child_allowed(const Node& node) const
 {
     switch (node.type()) {
@@ -492,7 +504,36 @@ void Document::set_hovered_node(Node* node)
     RefPtr<Node> old_hovered_node = move(m_hovered_node);
     m_hovered_node = node;
 
-    invalidate_style();
+    if (!style_resolver().is_hover_pseudo_class_used_in_selectors())
+        return;
+
+    // :hover matches the hovered node and its ancestors, so only the nodes below the closest common ancestor of the old and
+    // the new hovered node change their state. Restyling the topmost of those on each side covers the rest of them.
+    HashTable<Node const*> old_ancestors;
+    for (auto* ancestor = old_hovered_node.ptr(); ancestor; ancestor = ancestor->parent())
+        old_ancestors.set(ancestor);
+    Node const* common_ancestor = nullptr;
+    for (auto* ancestor = node; ancestor; ancestor = ancestor->parent()) {
+        if (old_ancestors.contains(ancestor)) {
+            common_ancestor = ancestor;
+            break;
+        }
+    }
+
+    auto invalidate_below_common_ancestor = [&](Node* hovered_node) {
+        if (!hovered_node || hovered_node == common_ancestor)
+            return;
+        auto* topmost_changed_node = hovered_node;
+        while (topmost_changed_node->parent() && topmost_changed_node->parent() != common_ancestor)
+            topmost_changed_node = topmost_changed_node->parent();
+        topmost_changed_node->invalidate_style();
+        if (!style_resolver().has_sibling_combinators())
+            return;
+        for (auto* sibling = topmost_changed_node->next_sibling(); sibling; sibling = sibling->next_sibling())
+            sibling->invalidate_style();
+    };
+    invalidate_below_common_ancestor(old_hovered_node.ptr());
+    invalidate_below_common_ancestor(node);
 }
 
 NonnullRefPtr<HTMLCollection> Document::get_elements_by_name(String const& name)
@@ -671,6 +712,7 @@ JS::Interpreter& Document::interpreter()
 JS::Value Document::run_javascript(const StringView& source, const StringView& filename)
 {
     auto parser = JS::Parser(JS::Lexer(source, filename));
+    parser.set_parse_function_bodies_lazily(true);
     auto program = parser.parse_program();
     if (parser.has_errors()) {
         parser.print_errors(false);
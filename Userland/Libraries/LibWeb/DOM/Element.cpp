@@ -72,7 +72,7 @@ ExceptionOr<void> Element::set_attribute(const FlyString& name, const String& va
     if (name.is_empty())
         return InvalidCharacterError::create("Attribute name must not be empty");
 
-    CSS::StyleInvalidator style_invalidator(document());
+    CSS::StyleInvalidator style_invalidator(*this, name);
 
     if (auto* attribute = find_attribute(name))
         attribute->set_value(value);
@@ -85,9 +85,11 @@ ExceptionOr<void> Element::set_attribute(const FlyString& name, const String& va
 
 void Element::remove_attribute(const FlyString& name)
 {
-    CSS::StyleInvalidator style_invalidator(document());
+    CSS::StyleInvalidator style_invalidator(*this, name);
 
     m_attributes.remove_first_matching([&](auto& attribute) { return attribute.name() == name; });
+    if (name == HTML::AttributeNames::class_)
+        m_classes.clear();
 }
 
 bool Element::has_class(const FlyString& class_name, CaseSensitivity case_sensitivity) const
@@ -168,6 +170,7 @@ enum class StyleDifference {
     None,
     NeedsRepaint,
     NeedsRelayout,
+    NeedsLayoutTreeRebuild,
 };
 
 static StyleDifference compute_style_difference(const CSS::StyleProperties& old_style, const CSS::StyleProperties& new_style, const Document& document)
@@ -175,22 +178,20 @@ static StyleDifference compute_style_difference(const CSS::StyleProperties& old_
     if (old_style == new_style)
         return StyleDifference::None;
 
-    bool needs_repaint = false;
-    bool needs_relayout = false;
+    // These decide which kind of layout node the element gets, see Element::create_layout_node().
+    if (new_style.display() != old_style.display() || new_style.float_() != old_style.float_())
+        return StyleDifference::NeedsLayoutTreeRebuild;
 
-    if (new_style.display() != old_style.display())
-        needs_relayout = true;
+    bool needs_repaint = false;
 
     if (new_style.color_or_fallback(CSS::PropertyID::Color, document, Color::Black) != old_style.color_or_fallback(CSS::PropertyID::Color, document, Color::Black))
         needs_repaint = true;
     else if (new_style.color_or_fallback(CSS::PropertyID::BackgroundColor, document, Color::Black) != old_style.color_or_fallback(CSS::PropertyID::BackgroundColor, document, Color::Black))
         needs_repaint = true;
 
-    if (needs_relayout)
-        return StyleDifference::NeedsRelayout;
     if (needs_repaint)
         return StyleDifference::NeedsRepaint;
-    return StyleDifference::None;
+    return StyleDifference::NeedsRelayout;
 }
 
 void Element::recompute_style()
@@ -209,19 +210,20 @@ void Element::recompute_style()
         return;
     }
 
-    auto diff = StyleDifference::NeedsRelayout;
+    auto diff = StyleDifference::NeedsLayoutTreeRebuild;
     if (old_specified_css_values)
         diff = compute_style_difference(*old_specified_css_values, *new_specified_css_values, document());
     if (diff == StyleDifference::None)
         return;
     layout_node()->apply_style(*new_specified_css_values);
-    if (diff == StyleDifference::NeedsRelayout) {
+    if (diff == StyleDifference::NeedsLayoutTreeRebuild) {
         document().schedule_forced_layout();
         return;
     }
     if (diff == StyleDifference::NeedsRepaint) {
         layout_node()->set_needs_display();
     }
+    // The existing layout tree can be kept otherwise, Document::update_style() lays it out again once all styles are up to date.
 }
 
 NonnullRefPtr<CSS::StyleProperties> Element::computed_style()
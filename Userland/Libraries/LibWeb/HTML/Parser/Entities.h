@@ -17,6 +17,9 @@ struct EntityMatch {
     StringView entity;
 };
 
+// "CounterClockwiseContourIntegral;"
+constexpr size_t longest_entity_name_length = 32;
+
 Optional<EntityMatch> code_points_from_entity(const StringView&);
 
 }
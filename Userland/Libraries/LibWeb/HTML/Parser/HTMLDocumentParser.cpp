@@ -6,6 +6,7 @@
 
 #include <AK/Debug.h>
 #include <AK/SourceLocation.h>
+#include <AK/TemporaryChange.h>
 #include <AK/Utf32View.h>
 #include <LibTextCodec/Decoder.h>
 #include <LibWeb/DOM/Comment.h>
@@ -23,6 +24,7 @@
 #include <LibWeb/HTML/HTMLTemplateElement.h>
 #include <LibWeb/HTML/Parser/HTMLDocumentParser.h>
 #include <LibWeb/HTML/Parser/HTMLEncodingDetection.h>
+#include <LibWeb/HTML/Parser/HTMLPreloadScanner.h>
 #include <LibWeb/HTML/Parser/HTMLToken.h>
 #include <LibWeb/Namespace.h>
 #include <LibWeb/SVG/TagNames.h>
@@ -118,12 +120,46 @@ HTMLDocumentParser::~HTMLDocumentParser()
 void HTMLDocumentParser::run(const URL& url)
 {
     m_document->set_url(url);
-    m_document->set_source(m_tokenizer.source());
+    m_is_running = true;
+    process_tokens();
+}
+
+void HTMLDocumentParser::append_input(const StringView& input)
+{
+    if (m_has_finished)
+        return;
+    m_tokenizer.append_input(input);
+    if (m_is_running)
+        process_tokens();
+}
+
+void HTMLDocumentParser::insert_eof()
+{
+    if (m_has_finished)
+        return;
+    m_tokenizer.insert_eof();
+    if (m_is_running)
+        process_tokens();
+}
+
+void HTMLDocumentParser::process_tokens()
+{
+    // Input that arrives while a token is being processed (a script can spin the event loop) is picked up by the
+    // loop that is already running.
+    if (m_is_processing_tokens || m_has_finished)
+        return;
+    TemporaryChange change(m_is_processing_tokens, true);
 
     for (;;) {
         auto optional_token = m_tokenizer.next_token();
-        if (!optional_token.has_value())
+        if (!optional_token.has_value()) {
+            if (!m_tokenizer.has_inserted_eof()) {
+                // Let whatever text we have so far show up while we wait for the rest.
+                flush_character_insertions();
+                return;
+            }
             break;
+        }
         auto& token = optional_token.value();
 
         dbgln_if(PARSER_DEBUG, "[{}] {}", insertion_mode_name(), token.to_string());
@@ -148,8 +184,12 @@ void HTMLDocumentParser::run(const URL& url)
     }
 
     flush_character_insertions();
+    the_end();
+}
 
-    // "The end"
+void HTMLDocumentParser::the_end()
+{
+    m_document->set_source(m_tokenizer.source());
 
     m_document->set_ready_state("interactive");
 
@@ -177,6 +217,8 @@ void HTMLDocumentParser::run(const URL& url)
 
     m_document->set_ready_for_post_load_tasks(true);
     m_document->completely_finish_loading();
+
+    m_has_finished = true;
 }
 
 void HTMLDocumentParser::process_using_the_rules_for(InsertionMode mode, HTMLToken& token)
@@ -1855,6 +1897,17 @@ void HTMLDocumentParser::adjust_foreign_attributes(HTMLToken& token)
     token.adjust_foreign_attribute("xmlns:xlink", "xmlns", "xlink", Namespace::XMLNS);
 }
 
+void HTMLDocumentParser::run_the_preload_scanner()
+{
+    // The scanner goes all the way to the end, so later scripts wouldn't find anything new.
+    if (m_did_run_preload_scanner || m_parsing_fragment || !document().browsing_context())
+        return;
+    m_did_run_preload_scanner = true;
+
+    HTMLPreloadScanner scanner(document(), m_tokenizer.unconsumed_input());
+    scanner.run();
+}
+
 void HTMLDocumentParser::increment_script_nesting_level()
 {
     ++m_script_nesting_level;
@@ -1888,6 +1941,11 @@ void HTMLDocumentParser::handle_text(HTMLToken& token)
         NonnullRefPtr<HTMLScriptElement> script = verify_cast<HTMLScriptElement>(current_node());
         m_stack_of_open_elements.pop();
         m_insertion_mode = m_original_insertion_mode;
+
+        // Preparing the script may block on fetching it, so get everything after it started loading in the meantime.
+        if (script->has_attribute(HTML::AttributeNames::src))
+            run_the_preload_scanner();
+
         // FIXME: Handle tokenizer insertion point stuff here.
         increment_script_nesting_level();
         script->prepare_script({});
@@ -50,6 +50,12 @@ public:
 
     void run(const URL&);
 
+    // The input can also arrive in pieces, before or after the parser starts running. Once some has been appended,
+    // the parser waits for more whenever it runs out, until insert_eof() says there won't be any.
+    void append_input(const StringView&);
+    void insert_eof();
+    bool has_finished() const { return m_has_finished; }
+
     DOM::Document& document();
 
     static NonnullRefPtrVector<DOM::Node> parse_html_fragment(DOM::Element& context_element, const StringView&);
@@ -69,6 +75,9 @@ private:
 
     DOM::QuirksMode which_quirks_mode(const HTMLToken&) const;
 
+    void process_tokens();
+    void the_end();
+
     void handle_initial(HTMLToken&);
     void handle_before_html(HTMLToken&);
     void handle_before_head(HTMLToken&);
@@ -125,6 +134,7 @@ private:
     void decrement_script_nesting_level();
     size_t script_nesting_level() const { return m_script_nesting_level; }
     void reset_the_insertion_mode_appropriately();
+    void run_the_preload_scanner();
 
     void adjust_mathml_attributes(HTMLToken&);
     void adjust_svg_tag_names(HTMLToken&);
@@ -159,6 +169,10 @@ private:
     bool m_aborted { false };
     bool m_parser_pause_flag { false };
     bool m_stop_parsing { false };
+    bool m_did_run_preload_scanner { false };
+    bool m_is_running { false };
+    bool m_is_processing_tokens { false };
+    bool m_has_finished { false };
     size_t m_script_nesting_level { 0 };
 
     NonnullRefPtr<DOM::Document> m_document;
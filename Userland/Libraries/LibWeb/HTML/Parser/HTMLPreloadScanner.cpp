@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <LibWeb/DOM/Document.h>
+#include <LibWeb/HTML/AttributeNames.h>
+#include <LibWeb/HTML/Parser/HTMLPreloadScanner.h>
+#include <LibWeb/HTML/TagNames.h>
+#include <LibWeb/Loader/LoadRequest.h>
+#include <LibWeb/Loader/ResourceLoader.h>
+
+namespace Web::HTML {
+
+HTMLPreloadScanner::HTMLPreloadScanner(DOM::Document& document, StringView const& input)
+    : m_document(document)
+    , m_tokenizer(input, "utf-8")
+{
+}
+
+static bool is_preloadable_script_type(StringView const& type)
+{
+    // Only the common spellings, anything else is left to the script element to figure out.
+    return type.is_empty()
+        || type.equals_ignoring_case("text/javascript")
+        || type.equals_ignoring_case("application/javascript");
+}
+
+static bool is_stylesheet_relationship(StringView const& rel)
+{
+    bool is_stylesheet = false;
+    for (auto& part : rel.split_view(' ')) {
+        if (part == "alternate")
+            return false;
+        if (part == "stylesheet")
+            is_stylesheet = true;
+    }
+    return is_stylesheet;
+}
+
+void HTMLPreloadScanner::run()
+{
+    for (;;) {
+        auto optional_token = m_tokenizer.next_token();
+        if (!optional_token.has_value())
+            break;
+        auto& token = optional_token.value();
+        if (token.is_end_of_file())
+            break;
+        if (!token.is_start_tag())
+            continue;
+
+        auto& tag_name = token.tag_name();
+
+        // The contents of these elements are text, and tags in there would only lead us astray.
+        if (tag_name == HTML::TagNames::script)
+            m_tokenizer.switch_to(HTMLTokenizer::State::ScriptData);
+        else if (tag_name.is_one_of(HTML::TagNames::style, HTML::TagNames::xmp, HTML::TagNames::iframe, HTML::TagNames::noembed, HTML::TagNames::noframes, HTML::TagNames::noscript))
+            m_tokenizer.switch_to(HTMLTokenizer::State::RAWTEXT);
+        else if (tag_name.is_one_of(HTML::TagNames::textarea, HTML::TagNames::title))
+            m_tokenizer.switch_to(HTMLTokenizer::State::RCDATA);
+        else if (tag_name == HTML::TagNames::plaintext)
+            break;
+
+        if (tag_name == HTML::TagNames::script) {
+            if (token.has_attribute(HTML::AttributeNames::src) && is_preloadable_script_type(token.attribute(HTML::AttributeNames::type).trim_whitespace()))
+                preload(Resource::Type::Generic, token.attribute(HTML::AttributeNames::src));
+        } else if (tag_name == HTML::TagNames::link) {
+            if (token.has_attribute(HTML::AttributeNames::href) && is_stylesheet_relationship(token.attribute(HTML::AttributeNames::rel)))
+                preload(Resource::Type::Generic, token.attribute(HTML::AttributeNames::href));
+        } else if (tag_name == HTML::TagNames::img) {
+            if (token.has_attribute(HTML::AttributeNames::src))
+                preload(Resource::Type::Image, token.attribute(HTML::AttributeNames::src));
+        }
+    }
+}
+
+void HTMLPreloadScanner::preload(Resource::Type type, StringView const& url_string)
+{
+    auto url = m_document.complete_url(url_string);
+    if (!url.is_valid())
+        return;
+
+    // Local files aren't cached, so loading them early would only mean loading them twice.
+    if (url.protocol() == "file")
+        return;
+
+    dbgln_if(PARSER_DEBUG, "HTMLPreloadScanner: Preloading {}", url);
+    auto request = LoadRequest::create_for_url_on_page(url, m_document.page());
+    ResourceLoader::the().load_resource(type, request);
+}
+
+}
@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <LibWeb/Forward.h>
+#include <LibWeb/HTML/Parser/HTMLTokenizer.h>
+#include <LibWeb/Loader/Resource.h>
+
+namespace Web::HTML {
+
+// Looks ahead over input the parser hasn't gotten to yet while it's blocked, and starts loading the scripts,
+// style sheets and images it finds. By the time the parser creates their elements, the resources are already
+// on their way or waiting in the ResourceLoader's cache.
+// This only looks at tokens, so it can't know about anything that depends on the tree, or on scripts.
+class HTMLPreloadScanner {
+public:
+    HTMLPreloadScanner(DOM::Document&, StringView const& input);
+
+    void run();
+
+private:
+    void preload(Resource::Type, StringView const& url);
+
+    DOM::Document& m_document;
+    HTMLTokenizer m_tokenizer;
+};
+
+}
@@ -182,8 +182,10 @@ static inline void log_parse_error(SourceLocation const& location = SourceLocati
 
 Optional<u32> HTMLTokenizer::next_code_point()
 {
-    if (m_utf8_iterator == m_utf8_view.end())
+    if (m_utf8_iterator == m_utf8_view.end()) {
+        m_ran_out_of_input = !m_has_inserted_eof;
         return {};
+    }
     skip(1);
     dbgln_if(TOKENIZER_TRACE_DEBUG, "(Tokenizer) Next code_point: {}", (char)*m_prev_utf8_iterator);
     return *m_prev_utf8_iterator;
@@ -210,8 +212,10 @@ Optional<u32> HTMLTokenizer::peek_code_point(size_t offset) const
     auto it = m_utf8_iterator;
     for (size_t i = 0; i < offset && it != m_utf8_view.end(); ++i)
         ++it;
-    if (it == m_utf8_view.end())
+    if (it == m_utf8_view.end()) {
+        m_ran_out_of_input = !m_has_inserted_eof;
         return {};
+    }
     return *it;
 }
 
@@ -225,6 +229,53 @@ HTMLToken::Position HTMLTokenizer::nth_last_position(size_t n)
 }
 
 Optional<HTMLToken> HTMLTokenizer::next_token()
+{
+    if (m_has_inserted_eof || !m_queued_tokens.is_empty())
+        return next_token_from_input();
+
+    // Without the rest of the input there's no telling how a token that runs into the end of it will turn out, so
+    // it's left for when there is more.
+    auto checkpoint = create_checkpoint();
+    m_ran_out_of_input = false;
+    auto token = next_token_from_input();
+    if (!m_ran_out_of_input)
+        return token;
+    restore_checkpoint(move(checkpoint));
+    return {};
+}
+
+HTMLTokenizer::Checkpoint HTMLTokenizer::create_checkpoint() const
+{
+    return Checkpoint {
+        .state = m_state,
+        .return_state = m_return_state,
+        .byte_offset = m_utf8_view.byte_offset_of(m_utf8_iterator),
+        .temporary_buffer = m_temporary_buffer,
+        .current_builder = m_current_builder.to_string(),
+        .last_emitted_start_tag_name = m_last_emitted_start_tag_name,
+        .character_reference_code = m_character_reference_code,
+        .position = m_source_positions.last(),
+    };
+}
+
+void HTMLTokenizer::restore_checkpoint(Checkpoint&& checkpoint)
+{
+    m_state = checkpoint.state;
+    m_return_state = checkpoint.return_state;
+    m_utf8_iterator = m_utf8_view.iterator_at_byte_offset(checkpoint.byte_offset);
+    m_prev_utf8_iterator = m_utf8_iterator;
+    m_temporary_buffer = move(checkpoint.temporary_buffer);
+    m_current_builder.clear();
+    m_current_builder.append(checkpoint.current_builder);
+    m_last_emitted_start_tag_name = move(checkpoint.last_emitted_start_tag_name);
+    m_character_reference_code = checkpoint.character_reference_code;
+    m_source_positions.clear();
+    m_source_positions.append(checkpoint.position);
+    m_queued_tokens.clear();
+    m_has_emitted_eof = false;
+}
+
+Optional<HTMLToken> HTMLTokenizer::next_token_from_input()
 {
     {
         auto last_position = m_source_positions.last();
@@ -1567,8 +1618,13 @@ _StartOfFunction:
             BEGIN_STATE(NamedCharacterReference)
             {
                 size_t byte_offset = m_utf8_view.byte_offset_of(m_prev_utf8_iterator);
+                auto decoded_input = m_decoded_input.string_view();
+
+                // A longer entity name may still be on its way.
+                if (!m_has_inserted_eof && decoded_input.length() - byte_offset <= longest_entity_name_length)
+                    m_ran_out_of_input = true;
 
-                auto match = HTML::code_points_from_entity(m_decoded_input.substring_view(byte_offset, m_decoded_input.length() - byte_offset - 1));
+                auto match = HTML::code_points_from_entity(decoded_input.substring_view(byte_offset, decoded_input.length() - byte_offset - 1));
 
                 if (match.has_value()) {
                     skip(match->entity.length() - 1);
@@ -2679,15 +2735,74 @@ void HTMLTokenizer::create_new_token(HTMLToken::Type type)
 }
 
 HTMLTokenizer::HTMLTokenizer(StringView const& input, String const& encoding)
+    : m_decoder(TextCodec::decoder_for(encoding))
+    , m_encoding(TextCodec::get_standardized_encoding(encoding).value_or(encoding))
 {
-    auto* decoder = TextCodec::decoder_for(encoding);
-    VERIFY(decoder);
-    m_decoded_input = decoder->to_utf8(input);
-    m_utf8_view = Utf8View(m_decoded_input);
+    VERIFY(m_decoder);
+    m_decoded_input.append(m_decoder->to_utf8(input));
+    m_utf8_view = Utf8View(m_decoded_input.string_view());
     m_utf8_iterator = m_utf8_view.begin();
     m_source_positions.empend(0u, 0u);
 }
 
+// How many bytes at the end of the input are the start of a sequence that isn't complete yet.
+static size_t incomplete_sequence_length(ReadonlyBytes input, String const& encoding)
+{
+    if (encoding.equals_ignoring_case("UTF-8")) {
+        for (size_t i = 1; i <= min<size_t>(input.size(), 4); ++i) {
+            u8 byte = input[input.size() - i];
+            if ((byte & 0xc0) == 0x80)
+                continue;
+            size_t sequence_length = 1;
+            if ((byte & 0xe0) == 0xc0)
+                sequence_length = 2;
+            else if ((byte & 0xf0) == 0xe0)
+                sequence_length = 3;
+            else if ((byte & 0xf8) == 0xf0)
+                sequence_length = 4;
+            return sequence_length > i ? i : 0;
+        }
+        return 0;
+    }
+    if (encoding.equals_ignoring_case("UTF-16BE"))
+        return input.size() % 2;
+    return 0;
+}
+
+void HTMLTokenizer::append_input(StringView const& input)
+{
+    VERIFY(!m_has_emitted_eof);
+    m_has_inserted_eof = false;
+
+    m_undecoded_input.append(input.characters_without_null_termination(), input.length());
+    auto decodable_length = m_undecoded_input.size() - incomplete_sequence_length(m_undecoded_input, m_encoding);
+    if (decodable_length == 0)
+        return;
+    append_decoded_input(m_decoder->to_utf8(StringView { m_undecoded_input.data(), decodable_length }));
+    m_undecoded_input = m_undecoded_input.slice(decodable_length, m_undecoded_input.size() - decodable_length);
+}
+
+void HTMLTokenizer::insert_eof()
+{
+    if (m_has_inserted_eof)
+        return;
+    // Whatever is left over won't be completed anymore.
+    if (!m_undecoded_input.is_empty()) {
+        append_decoded_input(m_decoder->to_utf8(StringView { m_undecoded_input }));
+        m_undecoded_input.clear();
+    }
+    m_has_inserted_eof = true;
+}
+
+void HTMLTokenizer::append_decoded_input(StringView const& input)
+{
+    auto byte_offset = m_utf8_view.byte_offset_of(m_utf8_iterator);
+    m_decoded_input.append(input);
+    m_utf8_view = Utf8View(m_decoded_input.string_view());
+    m_utf8_iterator = m_utf8_view.iterator_at_byte_offset(byte_offset);
+    m_prev_utf8_iterator = m_utf8_iterator;
+}
+
 void HTMLTokenizer::will_switch_to([[maybe_unused]] State new_state)
 {
     dbgln_if(TOKENIZER_TRACE_DEBUG, "[{}] Switch to {}", state_name(m_state), state_name(new_state));
@@ -6,11 +6,13 @@
 
 #pragma once
 
+#include <AK/ByteBuffer.h>
 #include <AK/Queue.h>
 #include <AK/StringBuilder.h>
 #include <AK/StringView.h>
 #include <AK/Types.h>
 #include <AK/Utf8View.h>
+#include <LibTextCodec/Decoder.h>
 #include <LibWeb/Forward.h>
 #include <LibWeb/HTML/Parser/HTMLToken.h>
 
@@ -108,8 +110,15 @@ public:
 #undef __ENUMERATE_TOKENIZER_STATE
     };
 
+    // Returns nothing once the end of the file has been emitted, or while waiting for more input.
     Optional<HTMLToken> next_token();
 
+    // Input can also arrive in pieces, in the same encoding as the input the tokenizer was created with. Once some
+    // has been appended, running out of input means waiting for more until insert_eof() says there won't be any.
+    void append_input(StringView const&);
+    void insert_eof();
+    bool has_inserted_eof() const { return m_has_inserted_eof; }
+
     void switch_to(Badge<HTMLDocumentParser>, State new_state);
     void switch_to(State new_state)
     {
@@ -119,9 +128,29 @@ public:
     void set_blocked(bool b) { m_blocked = b; }
     bool is_blocked() const { return m_blocked; }
 
-    String source() const { return m_decoded_input; }
+    String source() const { return m_decoded_input.to_string(); }
+
+    // The part of the input that hasn't been turned into tokens yet.
+    StringView unconsumed_input() const { return m_decoded_input.string_view().substring_view(m_utf8_view.byte_offset_of(m_utf8_iterator)); }
 
 private:
+    // Where a token started, so that tokenizing can start over from there if the input runs out in the middle of it.
+    struct Checkpoint {
+        State state;
+        State return_state;
+        size_t byte_offset;
+        Vector<u32> temporary_buffer;
+        String current_builder;
+        Optional<String> last_emitted_start_tag_name;
+        u32 character_reference_code;
+        HTMLToken::Position position;
+    };
+
+    Optional<HTMLToken> next_token_from_input();
+    Checkpoint create_checkpoint() const;
+    void restore_checkpoint(Checkpoint&&);
+    void append_decoded_input(StringView const&);
+
     void skip(size_t count);
     Optional<u32> next_code_point();
     Optional<u32> peek_code_point(size_t offset) const;
@@ -156,7 +185,11 @@ private:
 
     Vector<u32> m_temporary_buffer;
 
-    String m_decoded_input;
+    TextCodec::Decoder* m_decoder { nullptr };
+    String m_encoding;
+    // The end of the input so far, if it is the start of a sequence of bytes that only decodes with the rest of it.
+    ByteBuffer m_undecoded_input;
+    StringBuilder m_decoded_input;
 
     Utf8View m_utf8_view;
     Utf8CodePointIterator m_utf8_iterator;
@@ -168,6 +201,8 @@ private:
     Optional<String> m_last_emitted_start_tag_name;
 
     bool m_has_emitted_eof { false };
+    bool m_has_inserted_eof { true };
+    mutable bool m_ran_out_of_input { false };
 
     Queue<HTMLToken> m_queued_tokens;
 
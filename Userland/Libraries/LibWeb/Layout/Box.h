@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Optional.h>
 #include <AK/OwnPtr.h>
 #include <LibGfx/Rect.h>
 #include <LibWeb/Layout/LineBox.h>
@@ -132,6 +133,48 @@ public:
 
     BorderRadiusData normalized_border_radius_data();
 
+    // Everything outside of a box that establishes an independent formatting context which its layout depends on.
+    struct LayoutCacheKey {
+        LayoutMode layout_mode { LayoutMode::Default };
+        Gfx::FloatSize size;
+        Gfx::FloatSize containing_block_size;
+        Gfx::IntSize viewport_size;
+        float root_font_size { 0 };
+
+        bool operator==(const LayoutCacheKey& other) const
+        {
+            return layout_mode == other.layout_mode
+                && size == other.size
+                && containing_block_size == other.containing_block_size
+                && viewport_size == other.viewport_size
+                && root_font_size == other.root_font_size;
+        }
+    };
+
+    struct CachedLayout {
+        LayoutCacheKey key;
+        Gfx::FloatSize size;
+    };
+
+    struct CachedShrinkToFitWidths {
+        LayoutCacheKey key;
+        float preferred_width { 0 };
+        float preferred_minimum_width { 0 };
+    };
+
+    // The last layout of this box, which still describes the geometry of its descendants.
+    const Optional<CachedLayout>& cached_layout() const { return m_cached_layout; }
+    void set_cached_layout(CachedLayout cached_layout) { m_cached_layout = cached_layout; }
+
+    const Optional<CachedShrinkToFitWidths>& cached_shrink_to_fit_widths() const { return m_cached_shrink_to_fit_widths; }
+    void set_cached_shrink_to_fit_widths(CachedShrinkToFitWidths widths) { m_cached_shrink_to_fit_widths = widths; }
+
+    void invalidate_cached_layout()
+    {
+        m_cached_layout.clear();
+        m_cached_shrink_to_fit_widths.clear();
+    }
+
 protected:
     Box(DOM::Document& document, DOM::Node* node, NonnullRefPtr<CSS::StyleProperties> style)
         : NodeWithStyleAndBoxModelMetrics(document, node, move(style))
@@ -159,6 +202,9 @@ private:
     WeakPtr<LineBoxFragment> m_containing_line_box_fragment;
 
     OwnPtr<StackingContext> m_stacking_context;
+
+    Optional<CachedLayout> m_cached_layout;
+    Optional<CachedShrinkToFitWidths> m_cached_shrink_to_fit_widths;
 };
 
 template<>
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <LibWeb/DOM/Document.h>
 #include <LibWeb/Dump.h>
 #include <LibWeb/Layout/BlockFormattingContext.h>
 #include <LibWeb/Layout/Box.h>
@@ -14,6 +15,7 @@
 #include <LibWeb/Layout/TableBox.h>
 #include <LibWeb/Layout/TableCellBox.h>
 #include <LibWeb/Layout/TableFormattingContext.h>
+#include <LibWeb/Page/BrowsingContext.h>
 
 namespace Web::Layout {
 
@@ -65,22 +67,71 @@ bool FormattingContext::creates_block_formatting_context(const Box& box)
     return false;
 }
 
+static Box::LayoutCacheKey layout_cache_key(const Box& box, LayoutMode layout_mode)
+{
+    Box::LayoutCacheKey key;
+    key.layout_mode = layout_mode;
+    key.size = box.size();
+    if (auto* containing_block = box.containing_block())
+        key.containing_block_size = containing_block->size();
+    key.viewport_size = box.browsing_context().viewport_rect().size();
+    if (auto* document_element = box.document().document_element(); document_element && document_element->layout_node())
+        key.root_font_size = document_element->layout_node()->font_size();
+    return key;
+}
+
+// Absolutely positioned boxes are sized against their containing block, which the cache key only covers if it's the box itself.
+static bool contains_its_absolutely_positioned_descendants(const Box& box, const Node& node)
+{
+    for (auto* child = node.first_child(); child; child = child->next_sibling()) {
+        if (child->is_absolutely_positioned()) {
+            auto* containing_block = child->containing_block();
+            if (!containing_block || !box.is_inclusive_ancestor_of(*containing_block))
+                return false;
+        }
+        // Nested boxes with a cached layout were already checked when their layout was stored.
+        if (is<Box>(*child) && verify_cast<Box>(*child).cached_layout().has_value())
+            continue;
+        if (!contains_its_absolutely_positioned_descendants(box, *child))
+            return false;
+    }
+    return true;
+}
+
+template<typename FormattingContextType>
+void FormattingContext::layout_independent_formatting_context(Box& box, LayoutMode layout_mode)
+{
+    // A box that establishes an independent formatting context is a relayout boundary: nothing outside of it
+    // affects its layout except for what goes into the cache key. If that didn't change since the last layout
+    // and nothing inside was invalidated, the boxes inside still have the geometry the last layout gave them.
+    auto key = layout_cache_key(box, layout_mode);
+    if (auto& cached_layout = box.cached_layout(); cached_layout.has_value() && cached_layout->key == key) {
+        box.set_size(cached_layout->size);
+        return;
+    }
+
+    FormattingContextType context(box, this);
+    context.run(box, layout_mode);
+
+    if (contains_its_absolutely_positioned_descendants(box, box))
+        box.set_cached_layout({ key, box.size() });
+    else
+        box.invalidate_cached_layout();
+}
+
 void FormattingContext::layout_inside(Box& box, LayoutMode layout_mode)
 {
     if (creates_block_formatting_context(box)) {
-        BlockFormattingContext context(box, this);
-        context.run(box, layout_mode);
+        layout_independent_formatting_context<BlockFormattingContext>(box, layout_mode);
         return;
     }
     if (box.computed_values().display() == CSS::Display::Flex) {
-        FlexFormattingContext context(box, this);
-        context.run(box, layout_mode);
+        layout_independent_formatting_context<FlexFormattingContext>(box, layout_mode);
         return;
     }
 
     if (is<TableBox>(box)) {
-        TableFormattingContext context(box, this);
-        context.run(box, layout_mode);
+        layout_independent_formatting_context<TableFormattingContext>(box, layout_mode);
     } else if (box.children_are_inline()) {
         InlineFormattingContext context(box, this);
         context.run(box, layout_mode);
@@ -108,6 +159,12 @@ static float greatest_child_width(const Box& box)
 
 FormattingContext::ShrinkToFitResult FormattingContext::calculate_shrink_to_fit_widths(Box& box)
 {
+    // The preferred widths only change with the inputs of the layouts that measure them, so as long as the box's
+    // cached layout is valid, we don't have to lay it out twice more just to find out it has the same width.
+    auto key = layout_cache_key(box, LayoutMode::Default);
+    if (auto& cached_widths = box.cached_shrink_to_fit_widths(); cached_widths.has_value() && cached_widths->key == key)
+        return { cached_widths->preferred_width, cached_widths->preferred_minimum_width };
+
     // Calculate the preferred width by formatting the content without breaking lines
     // other than where explicit line breaks occur.
     layout_inside(box, LayoutMode::OnlyRequiredLineBreaks);
@@ -119,6 +176,9 @@ FormattingContext::ShrinkToFitResult FormattingContext::calculate_shrink_to_fit_
     layout_inside(box, LayoutMode::AllPossibleLineBreaks);
     float preferred_minimum_width = greatest_child_width(box);
 
+    if (box.cached_layout().has_value())
+        box.set_cached_shrink_to_fit_widths({ key, preferred_width, preferred_minimum_width });
+
     return { preferred_width, preferred_minimum_width };
 }
 
@@ -33,6 +33,9 @@ protected:
 
     void layout_inside(Box&, LayoutMode);
 
+    template<typename FormattingContextType>
+    void layout_independent_formatting_context(Box&, LayoutMode);
+
     struct ShrinkToFitResult {
         float preferred_width { 0 };
         float preferred_minimum_width { 0 };
@@ -151,6 +151,14 @@ void Node::set_needs_display()
     }
 }
 
+void Node::set_needs_layout()
+{
+    for (auto* node = this; node; node = node->parent()) {
+        if (is<Box>(*node))
+            verify_cast<Box>(*node).invalidate_cached_layout();
+    }
+}
+
 Gfx::FloatPoint Node::box_type_agnostic_position() const
 {
     if (is<Box>(*this))
@@ -219,6 +227,8 @@ void NodeWithStyle::apply_style(const CSS::StyleProperties& specified_style)
 {
     auto& computed_values = static_cast<CSS::MutableComputedValues&>(m_computed_values);
 
+    set_needs_layout();
+
     m_font = specified_style.font();
     m_line_height = specified_style.line_height(*this);
 
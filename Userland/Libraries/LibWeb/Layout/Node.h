@@ -136,6 +136,9 @@ public:
 
     virtual void set_needs_display();
 
+    // Drops the cached layout of this node and every box containing it, so the next layout can't skip over it.
+    void set_needs_layout();
+
     bool children_are_inline() const { return m_children_are_inline; }
     void set_children_are_inline(bool value) { m_children_are_inline = value; }
 
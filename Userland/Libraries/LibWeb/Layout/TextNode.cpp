@@ -208,7 +208,13 @@ void TextNode::split_into_lines_by_rules(InlineFormattingContext& context, Layou
     containing_block.ensure_last_line_box();
     float available_width = context.available_width_at_line(line_boxes.size() - 1) - line_boxes.last().width();
 
+    auto previous_text_for_rendering = m_text_for_rendering;
     compute_text_for_rendering(do_collapse, line_boxes.last().is_empty_or_ends_in_whitespace());
+    if (m_text_for_rendering != previous_text_for_rendering || m_chunk_widths_font != &font) {
+        m_chunk_widths.clear();
+        m_chunk_widths_font = font;
+    }
+
     ChunkIterator iterator(m_text_for_rendering, layout_mode, do_wrap_lines, do_wrap_breaks);
 
     for (;;) {
@@ -232,7 +238,7 @@ void TextNode::split_into_lines_by_rules(InlineFormattingContext& context, Layou
                 chunk.view = chunk.view.substring_view(1, chunk.view.byte_length() - 1);
             }
 
-            chunk_width = font.width(chunk.view) + font.glyph_spacing();
+            chunk_width = this->chunk_width(font, chunk) + font.glyph_spacing();
 
             if (line_boxes.last().width() > 0 && chunk_width > available_width) {
                 containing_block.add_line_box();
@@ -242,7 +248,7 @@ void TextNode::split_into_lines_by_rules(InlineFormattingContext& context, Layou
                     continue;
             }
         } else {
-            chunk_width = font.width(chunk.view);
+            chunk_width = this->chunk_width(font, chunk);
         }
 
         line_boxes.last().add_fragment(*this, chunk.start, chunk.length, chunk_width, font.glyph_height());
@@ -260,6 +266,16 @@ void TextNode::split_into_lines_by_rules(InlineFormattingContext& context, Layou
     }
 }
 
+int TextNode::chunk_width(Gfx::Font const& font, Chunk const& chunk)
+{
+    u64 key = (static_cast<u64>(chunk.start) << 32) | chunk.length;
+    if (auto width = m_chunk_widths.get(key); width.has_value())
+        return *width;
+    auto width = font.width(chunk.view);
+    m_chunk_widths.set(key, width);
+    return width;
+}
+
 void TextNode::split_into_lines(InlineFormattingContext& context, LayoutMode layout_mode)
 {
     bool do_collapse = true;
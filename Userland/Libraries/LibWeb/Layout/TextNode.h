@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/HashMap.h>
 #include <AK/Utf8View.h>
 #include <LibWeb/DOM/Text.h>
 #include <LibWeb/Layout/Node.h>
@@ -64,8 +65,14 @@ private:
     void split_into_lines_by_rules(InlineFormattingContext&, LayoutMode, bool do_collapse, bool do_wrap_lines, bool do_wrap_breaks);
     void paint_cursor_if_needed(PaintContext&, const LineBoxFragment&) const;
     void paint_text_decoration(Gfx::Painter&, LineBoxFragment const&) const;
+    int chunk_width(Gfx::Font const&, Chunk const&);
 
     String m_text_for_rendering;
+
+    // The same text is split into lines by every layout pass (and by the intrinsic sizing passes in between), so the
+    // measured width of each chunk is kept until the text or the font changes. Keyed by the chunk's start and length.
+    HashMap<u64, int> m_chunk_widths;
+    RefPtr<Gfx::Font const> m_chunk_widths_font;
 };
 
 template<>
@@ -126,6 +126,10 @@ RefPtr<Node> TreeBuilder::build(DOM::Node& dom_node)
 
     create_layout_tree(dom_node);
 
+    // The boxes the new subtree was inserted into can't reuse their cached layout.
+    if (dom_node.parent() && dom_node.layout_node())
+        dom_node.layout_node()->set_needs_layout();
+
     if (auto* root = dom_node.document().layout_node())
         fixup_tables(*root);
 
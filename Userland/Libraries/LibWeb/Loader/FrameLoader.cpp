@@ -10,11 +10,13 @@
 #include <LibGemini/Document.h>
 #include <LibGfx/ImageDecoder.h>
 #include <LibMarkdown/Document.h>
+#include <LibTextCodec/Decoder.h>
 #include <LibWeb/DOM/Document.h>
 #include <LibWeb/DOM/ElementFactory.h>
 #include <LibWeb/DOM/Text.h>
 #include <LibWeb/HTML/HTMLIFrameElement.h>
 #include <LibWeb/HTML/Parser/HTMLDocumentParser.h>
+#include <LibWeb/HTML/Parser/HTMLEncodingDetection.h>
 #include <LibWeb/Loader/FrameLoader.h>
 #include <LibWeb/Loader/ResourceLoader.h>
 #include <LibWeb/Namespace.h>
@@ -151,6 +153,12 @@ bool FrameLoader::load(const LoadRequest& request, Type type)
             page->client().page_did_start_loading(url);
     }
 
+    // The load may have been started by a script in the document we're replacing, in which case its parser is
+    // still running further up the stack.
+    if (m_parser)
+        ResourceLoader::the().deferred_invoke([parser = move(m_parser)](auto&) {});
+    m_streaming = Streaming::Undecided;
+
     set_resource(ResourceLoader::the().load_resource(Resource::Type::Generic, request));
 
     if (type == Type::IFrame)
@@ -233,10 +241,57 @@ void FrameLoader::load_error_page(const URL& failed_url, const String& error)
         });
 }
 
+void FrameLoader::resource_did_receive_data(ReadonlyBytes data)
+{
+    if (m_streaming == Streaming::Yes) {
+        if (m_parser) {
+            m_parser->append_input(StringView { data });
+            finish_streamed_document_if_parsed();
+        }
+        return;
+    }
+
+    if (m_streaming == Streaming::No)
+        return;
+    if (resource()->mime_type() != "text/html" || resource()->response_headers().contains("Location")) {
+        m_streaming = Streaming::No;
+        return;
+    }
+
+    // Without an encoding from the Content-Type header, look for a <meta charset> in the first 1024 bytes. If there
+    // isn't one, the encoding is sniffed from the whole document once it has been loaded.
+    auto& data_so_far = resource()->encoded_data();
+    auto encoding = resource()->encoding();
+    if (!encoding.has_value()) {
+        if (data_so_far.size() < 1024)
+            return;
+        encoding = HTML::run_prescan_byte_stream_algorithm(data_so_far);
+    }
+    if (!encoding.has_value() || !TextCodec::decoder_for(encoding.value())) {
+        m_streaming = Streaming::No;
+        return;
+    }
+
+    m_streaming = Streaming::Yes;
+    auto document = create_document_for_resource();
+    m_parser = make<HTML::HTMLDocumentParser>(document, StringView {}, encoding.value());
+    m_parser->append_input(StringView { data_so_far });
+    m_parser->run(document->url());
+    finish_streamed_document_if_parsed();
+}
+
 void FrameLoader::resource_did_load()
 {
     auto url = resource()->url();
 
+    if (m_streaming == Streaming::Yes) {
+        if (m_parser) {
+            m_parser->insert_eof();
+            finish_streamed_document_if_parsed();
+        }
+        return;
+    }
+
     // FIXME: Also check HTTP status code before redirecting
     auto location = resource()->response_headers().get("Location");
     if (location.has_value()) {
@@ -256,6 +311,17 @@ void FrameLoader::resource_did_load()
         return;
     }
 
+    auto document = create_document_for_resource();
+    if (!parse_document(*document, resource()->encoded_data())) {
+        load_error_page(url, "Failed to parse content.");
+        return;
+    }
+
+    document_did_finish_loading();
+}
+
+NonnullRefPtr<DOM::Document> FrameLoader::create_document_for_resource()
+{
     if (resource()->has_encoding()) {
         dbgln("This content has MIME type '{}', encoding '{}'", resource()->mime_type(), resource()->encoding().value());
     } else {
@@ -263,22 +329,35 @@ void FrameLoader::resource_did_load()
     }
 
     auto document = DOM::Document::create();
-    document->set_url(url);
+    document->set_url(resource()->url());
     document->set_encoding(resource()->encoding());
     document->set_content_type(resource()->mime_type());
 
     browsing_context().set_document(document);
 
-    if (!parse_document(*document, resource()->encoded_data())) {
-        load_error_page(url, "Failed to parse content.");
-        return;
-    }
-
     // FIXME: Support multiple instances of the Set-Cookie response header.
     auto set_cookie = resource()->response_headers().get("Set-Cookie");
     if (set_cookie.has_value())
         document->set_cookie(set_cookie.value(), Cookie::Source::Http);
 
+    return document;
+}
+
+void FrameLoader::finish_streamed_document_if_parsed()
+{
+    // If a script spins the event loop while the parser is running, whoever called into the parser first sees it
+    // finish, once it is no longer on the stack.
+    if (!m_parser || !m_parser->has_finished())
+        return;
+    m_parser = nullptr;
+    m_redirects_count = 0;
+    document_did_finish_loading();
+}
+
+void FrameLoader::document_did_finish_loading()
+{
+    auto url = resource()->url();
+
     if (!url.fragment().is_empty())
         browsing_context().scroll_to_anchor(url.fragment());
 
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/Forward.h>
+#include <AK/OwnPtr.h>
 #include <LibWeb/Forward.h>
 #include <LibWeb/Loader/Resource.h>
 
@@ -36,14 +37,28 @@ public:
 
 private:
     // ^ResourceClient
+    virtual void resource_did_receive_data(ReadonlyBytes) override;
     virtual void resource_did_load() override;
     virtual void resource_did_fail() override;
 
     void load_error_page(const URL& failed_url, const String& error_message);
     bool parse_document(DOM::Document&, const ByteBuffer& data);
+    NonnullRefPtr<DOM::Document> create_document_for_resource();
+    void finish_streamed_document_if_parsed();
+    void document_did_finish_loading();
 
     BrowsingContext& m_browsing_context;
     size_t m_redirects_count { 0 };
+
+    // Parses an HTML document as it comes in, so that it can show up (and its subresources start loading) before
+    // all of it has arrived.
+    enum class Streaming {
+        Undecided,
+        Yes,
+        No,
+    };
+    Streaming m_streaming { Streaming::Undecided };
+    OwnPtr<HTML::HTMLDocumentParser> m_parser;
 };
 
 }
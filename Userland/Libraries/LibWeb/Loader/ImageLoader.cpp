@@ -9,6 +9,7 @@
 #include <LibGfx/Bitmap.h>
 #include <LibWeb/DOM/Document.h>
 #include <LibWeb/DOM/Element.h>
+#include <LibWeb/Layout/Node.h>
 #include <LibWeb/Loader/ImageLoader.h>
 #include <LibWeb/Loader/ResourceLoader.h>
 
@@ -95,6 +96,12 @@ void ImageLoader::animate()
         on_animate();
 }
 
+void ImageLoader::resource_did_redecode()
+{
+    if (auto* layout_node = m_owner_element.layout_node())
+        layout_node->set_needs_display();
+}
+
 void ImageLoader::resource_did_fail()
 {
     dbgln("ImageLoader: Resource did fail. URL: {}", resource()->url());
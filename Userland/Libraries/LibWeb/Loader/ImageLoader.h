@@ -39,6 +39,7 @@ private:
     virtual void resource_did_load() override;
     virtual void resource_did_fail() override;
     virtual bool is_visible_in_viewport() const override { return m_visible_in_viewport; }
+    virtual void resource_did_redecode() override;
 
     void animate();
 
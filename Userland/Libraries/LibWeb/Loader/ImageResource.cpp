@@ -40,19 +40,46 @@ static ImageDecoderClient::Client& image_decoder_client()
     return *image_decoder_client;
 }
 
+void ImageResource::did_receive_all_data()
+{
+    m_has_received_all_data = true;
+    decode_if_needed();
+    if (!m_pending_decode_id.has_value())
+        did_finish_loading();
+}
+
+bool ImageResource::is_visible_in_viewport() const
+{
+    bool visible_in_viewport = false;
+    const_cast<ImageResource&>(*this).for_each_client([&](auto& client) {
+        if (static_cast<const ImageResourceClient&>(client).is_visible_in_viewport())
+            visible_in_viewport = true;
+    });
+    return visible_in_viewport;
+}
+
 void ImageResource::decode_if_needed() const
 {
-    if (!has_encoded_data())
+    if (!m_has_received_all_data || !has_encoded_data())
         return;
 
-    if (m_has_attempted_decode)
+    if (m_has_attempted_decode || m_pending_decode_id.has_value())
         return;
 
     if (!m_decoded_frames.is_empty())
         return;
 
-    NonnullRefPtr decoder = image_decoder_client();
-    auto image = decoder->decode_image(encoded_data());
+    m_pending_decode_id = image_decoder_client().start_decoding_image(
+        encoded_data(),
+        [self = NonnullRefPtr(const_cast<ImageResource&>(*this))](auto image) mutable {
+            self->did_decode(move(image));
+        },
+        is_visible_in_viewport());
+}
+
+void ImageResource::did_decode(Optional<ImageDecoderClient::DecodedImage> image)
+{
+    m_pending_decode_id.clear();
 
     if (image.has_value()) {
         m_loop_count = image.value().loop_count;
@@ -66,6 +93,15 @@ void ImageResource::decode_if_needed() const
     }
 
     m_has_attempted_decode = true;
+
+    if (!is_loaded()) {
+        did_finish_loading();
+        return;
+    }
+
+    for_each_client([](auto& client) {
+        static_cast<ImageResourceClient&>(client).resource_did_redecode();
+    });
 }
 
 const Gfx::Bitmap* ImageResource::bitmap(size_t frame_index) const
@@ -78,11 +114,10 @@ const Gfx::Bitmap* ImageResource::bitmap(size_t frame_index) const
 
 void ImageResource::update_volatility()
 {
-    bool visible_in_viewport = false;
-    for_each_client([&](auto& client) {
-        if (static_cast<const ImageResourceClient&>(client).is_visible_in_viewport())
-            visible_in_viewport = true;
-    });
+    bool visible_in_viewport = is_visible_in_viewport();
+
+    if (m_pending_decode_id.has_value())
+        image_decoder_client().set_image_visible(m_pending_decode_id.value(), visible_in_viewport);
 
     if (!visible_in_viewport) {
         for (auto& frame : m_decoded_frames) {
@@ -108,6 +143,7 @@ void ImageResource::update_volatility()
 
     m_decoded_frames.clear();
     m_has_attempted_decode = false;
+    decode_if_needed();
 }
 
 ImageResourceClient::~ImageResourceClient()
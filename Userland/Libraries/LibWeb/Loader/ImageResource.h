@@ -8,6 +8,10 @@
 
 #include <LibWeb/Loader/Resource.h>
 
+namespace ImageDecoderClient {
+struct DecodedImage;
+}
+
 namespace Web {
 
 class ImageResource final : public Resource {
@@ -44,12 +48,20 @@ public:
 private:
     explicit ImageResource(const LoadRequest&);
 
+    // ^Resource
+    virtual void did_receive_all_data() override;
+
+    bool is_visible_in_viewport() const;
     void decode_if_needed() const;
+    void did_decode(Optional<ImageDecoderClient::DecodedImage>);
 
     mutable bool m_animated { false };
     mutable int m_loop_count { 0 };
     mutable Vector<Frame> m_decoded_frames;
     mutable bool m_has_attempted_decode { false };
+    bool m_has_received_all_data { false };
+    // The image is decoded out of process, and the clients are only told that it has loaded once it has been decoded.
+    mutable Optional<i32> m_pending_decode_id;
 };
 
 class ImageResourceClient : public ResourceClient {
@@ -58,6 +70,9 @@ public:
 
     virtual bool is_visible_in_viewport() const { return false; }
 
+    // Called when the image has been decoded again, after the memory of its frames was purged.
+    virtual void resource_did_redecode() { }
+
 protected:
     ImageResource* resource() { return static_cast<ImageResource*>(ResourceClient::resource()); }
     const ImageResource* resource() const { return static_cast<const ImageResource*>(ResourceClient::resource()); }
@@ -65,13 +65,12 @@ static String mime_type_from_content_type(const String& content_type)
     return content_type;
 }
 
-void Resource::did_load(Badge<ResourceLoader>, ReadonlyBytes data, const HashMap<String, String, CaseInsensitiveStringTraits>& headers, Optional<u32> status_code)
+void Resource::did_receive_headers(Badge<ResourceLoader>, const HashMap<String, String, CaseInsensitiveStringTraits>& headers, Optional<u32> status_code)
 {
-    VERIFY(!m_loaded);
-    m_encoded_data = ByteBuffer::copy(data);
+    VERIFY(!m_received_headers);
     m_response_headers = headers;
     m_status_code = move(status_code);
-    m_loaded = true;
+    m_received_headers = true;
 
     auto content_type = headers.get("Content-Type");
 
@@ -98,6 +97,28 @@ void Resource::did_load(Badge<ResourceLoader>, ReadonlyBytes data, const HashMap
             m_encoding = encoding.value();
         }
     }
+}
+
+void Resource::did_receive_data(Badge<ResourceLoader>, ReadonlyBytes data)
+{
+    VERIFY(m_received_headers && !m_loaded);
+    m_encoded_data.append(data.data(), data.size());
+
+    for_each_client([&](auto& client) {
+        client.resource_did_receive_data(data);
+    });
+}
+
+void Resource::did_load(Badge<ResourceLoader>)
+{
+    VERIFY(m_received_headers && !m_loaded);
+    did_receive_all_data();
+}
+
+void Resource::did_finish_loading()
+{
+    VERIFY(!m_loaded);
+    m_loaded = true;
 
     for_each_client([](auto& client) {
         client.resource_did_load();
@@ -137,6 +158,10 @@ void ResourceClient::set_resource(Resource* resource)
 
         m_resource->register_client({}, *this);
 
+        // Make sure that clients of resources that are still loading catch up on what was received so far.
+        if (!resource->is_loaded() && resource->has_encoded_data())
+            resource_did_receive_data(resource->encoded_data());
+
         // Make sure that reused resources also have their load callback fired.
         if (resource->is_loaded())
             resource_did_load();
@@ -58,16 +58,24 @@ public:
 
     void for_each_client(Function<void(ResourceClient&)>);
 
-    void did_load(Badge<ResourceLoader>, ReadonlyBytes data, const HashMap<String, String, CaseInsensitiveStringTraits>& headers, Optional<u32> status_code);
+    void did_receive_headers(Badge<ResourceLoader>, const HashMap<String, String, CaseInsensitiveStringTraits>& headers, Optional<u32> status_code);
+    void did_receive_data(Badge<ResourceLoader>, ReadonlyBytes data);
+    void did_load(Badge<ResourceLoader>);
     void did_fail(Badge<ResourceLoader>, const String& error, Optional<u32> status_code);
 
 protected:
     explicit Resource(Type, const LoadRequest&);
 
+    // Called once all of the data has arrived. Resources that have to do something with it before they can be used
+    // (like decoding an image) can hold off on telling their clients until they're done.
+    virtual void did_receive_all_data() { did_finish_loading(); }
+    void did_finish_loading();
+
 private:
     LoadRequest m_request;
     ByteBuffer m_encoded_data;
     Type m_type { Type::Generic };
+    bool m_received_headers { false };
     bool m_loaded { false };
     bool m_failed { false };
     String m_error;
@@ -83,6 +91,9 @@ class ResourceClient : public Weakable<ResourceClient> {
 public:
     virtual ~ResourceClient();
 
+    // Called with each piece of the body as it comes in, before the resource is loaded. A client that comes along
+    // in the middle gets everything received so far in one piece.
+    virtual void resource_did_receive_data(ReadonlyBytes) { }
     virtual void resource_did_load() { }
     virtual void resource_did_fail() { }
 
@@ -51,6 +51,11 @@ void ResourceLoader::load_sync(const LoadRequest& request, Function<void(Readonl
     loop.exec();
 }
 
+static bool is_network_protocol(const String& protocol)
+{
+    return protocol == "http" || protocol == "https" || protocol == "gemini";
+}
+
 static HashMap<LoadRequest, NonnullRefPtr<Resource>> s_resource_cache;
 
 RefPtr<Resource> ResourceLoader::load_resource(Resource::Type type, const LoadRequest& request)
@@ -77,10 +82,16 @@ RefPtr<Resource> ResourceLoader::load_resource(Resource::Type type, const LoadRe
     if (use_cache)
         s_resource_cache.set(request, resource);
 
-    load(
+    load_streaming(
         request,
-        [=](auto data, auto& headers, auto status_code) {
-            const_cast<Resource&>(*resource).did_load({}, data, headers, status_code);
+        [=](auto& headers, auto status_code) {
+            const_cast<Resource&>(*resource).did_receive_headers({}, headers, status_code);
+        },
+        [=](auto data) {
+            const_cast<Resource&>(*resource).did_receive_data({}, data);
+        },
+        [=] {
+            const_cast<Resource&>(*resource).did_load({});
         },
         [=](auto& error, auto status_code) {
             const_cast<Resource&>(*resource).did_fail({}, error, status_code);
@@ -89,20 +100,50 @@ RefPtr<Resource> ResourceLoader::load_resource(Resource::Type type, const LoadRe
     return resource;
 }
 
+namespace {
+
+class ResourceWaiter final : public ResourceClient {
+public:
+    ResourceWaiter(Resource& resource, Core::EventLoop& loop)
+        : m_type(resource.type())
+        , m_loop(loop)
+    {
+        set_resource(&resource);
+    }
+
+private:
+    virtual void resource_did_load() override { m_loop.quit(0); }
+    virtual void resource_did_fail() override { m_loop.quit(0); }
+    virtual Resource::Type client_type() const override { return m_type; }
+
+    Resource::Type m_type;
+    Core::EventLoop& m_loop;
+};
+
+}
+
+RefPtr<Resource> ResourceLoader::load_resource_sync(Resource::Type type, const LoadRequest& request)
+{
+    // The loop has to exist before the load starts, so that it picks up the events that finish it.
+    Core::EventLoop loop;
+
+    auto resource = load_resource(type, request);
+    if (!resource)
+        return nullptr;
+
+    // A resource that is already in the cache may have been loaded, or be loading, before we got here.
+    ResourceWaiter waiter(*resource, loop);
+    if (!resource->is_loaded() && !resource->is_failed())
+        loop.exec();
+    return resource;
+}
+
 void ResourceLoader::load(const LoadRequest& request, Function<void(ReadonlyBytes, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> status_code)> success_callback, Function<void(const String&, Optional<u32> status_code)> error_callback)
 {
     auto& url = request.url();
 
-    if (is_port_blocked(url.port())) {
-        dbgln("ResourceLoader::load: Error: blocked port {} from URL {}", url.port(), url);
+    if (!can_load(url, error_callback))
         return;
-    }
-
-    if (ContentFilter::the().is_filtered(url)) {
-        dbgln("\033[32;1mResourceLoader::load: URL was filtered! {}\033[0m", url);
-        error_callback("URL was filtered", {});
-        return;
-    }
 
     if (url.protocol() == "about") {
         dbgln("Loading about: URL {}", url);
@@ -147,25 +188,15 @@ void ResourceLoader::load(const LoadRequest& request, Function<void(ReadonlyByte
         return;
     }
 
-    if (url.protocol() == "http" || url.protocol() == "https" || url.protocol() == "gemini") {
-        HashMap<String, String> headers;
-        headers.set("User-Agent", m_user_agent);
-        headers.set("Accept-Encoding", "gzip, deflate");
-
-        for (auto& it : request.headers()) {
-            headers.set(it.key, it.value);
-        }
-
-        auto protocol_request = protocol_client().start_request(request.method(), url, headers, request.body());
+    if (is_network_protocol(url.protocol())) {
+        auto protocol_request = start_network_request(request);
         if (!protocol_request) {
             if (error_callback)
                 error_callback("Failed to initiate load", {});
             return;
         }
         protocol_request->on_buffered_request_finish = [this, success_callback = move(success_callback), error_callback = move(error_callback), protocol_request](bool success, auto, auto& response_headers, auto status_code, ReadonlyBytes payload) {
-            --m_pending_loads;
-            if (on_load_counter_change)
-                on_load_counter_change();
+            did_finish_network_request();
             if (!success) {
                 if (error_callback)
                     error_callback("HTTP load failed", {});
@@ -178,12 +209,6 @@ void ResourceLoader::load(const LoadRequest& request, Function<void(ReadonlyByte
             success_callback(payload, response_headers, status_code);
         };
         protocol_request->set_should_buffer_all_input(true);
-        protocol_request->on_certificate_requested = []() -> Protocol::Request::CertificateAndKey {
-            return {};
-        };
-        ++m_pending_loads;
-        if (on_load_counter_change)
-            on_load_counter_change();
         return;
     }
 
@@ -191,6 +216,93 @@ void ResourceLoader::load(const LoadRequest& request, Function<void(ReadonlyByte
         error_callback(String::formatted("Protocol not implemented: {}", url.protocol()), {});
 }
 
+void ResourceLoader::load_streaming(const LoadRequest& request, Function<void(const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> status_code)> on_headers, Function<void(ReadonlyBytes)> on_data, Function<void()> on_complete, Function<void(const String&, Optional<u32> status_code)> error_callback)
+{
+    auto& url = request.url();
+
+    // Everything that doesn't come over the network is at hand all at once anyway.
+    if (!is_network_protocol(url.protocol())) {
+        load(
+            request,
+            [on_headers = move(on_headers), on_data = move(on_data), on_complete = move(on_complete)](auto data, auto& response_headers, auto status_code) {
+                on_headers(response_headers, status_code);
+                if (!data.is_empty())
+                    on_data(data);
+                on_complete();
+            },
+            move(error_callback));
+        return;
+    }
+
+    if (!can_load(url, error_callback))
+        return;
+
+    auto protocol_request = start_network_request(request);
+    if (!protocol_request) {
+        if (error_callback)
+            error_callback("Failed to initiate load", {});
+        return;
+    }
+    protocol_request->set_unbuffered_request_callbacks(
+        move(on_headers),
+        move(on_data),
+        [this, on_complete = move(on_complete), error_callback = move(error_callback), protocol_request](bool success, auto) {
+            did_finish_network_request();
+            if (!success) {
+                if (error_callback)
+                    error_callback("HTTP load failed", {});
+                return;
+            }
+            on_complete();
+        });
+}
+
+bool ResourceLoader::can_load(const URL& url, Function<void(const String&, Optional<u32> status_code)> const& error_callback)
+{
+    if (is_port_blocked(url.port())) {
+        dbgln("ResourceLoader::load: Error: blocked port {} from URL {}", url.port(), url);
+        return false;
+    }
+
+    if (ContentFilter::the().is_filtered(url)) {
+        dbgln("\033[32;1mResourceLoader::load: URL was filtered! {}\033[0m", url);
+        error_callback("URL was filtered", {});
+        return false;
+    }
+
+    return true;
+}
+
+RefPtr<Protocol::Request> ResourceLoader::start_network_request(const LoadRequest& request)
+{
+    HashMap<String, String> headers;
+    headers.set("User-Agent", m_user_agent);
+    headers.set("Accept-Encoding", "gzip, deflate, zstd");
+
+    for (auto& it : request.headers()) {
+        headers.set(it.key, it.value);
+    }
+
+    auto protocol_request = protocol_client().start_request(request.method(), request.url(), headers, request.body());
+    if (!protocol_request)
+        return nullptr;
+
+    protocol_request->on_certificate_requested = []() -> Protocol::Request::CertificateAndKey {
+        return {};
+    };
+    ++m_pending_loads;
+    if (on_load_counter_change)
+        on_load_counter_change();
+    return protocol_request;
+}
+
+void ResourceLoader::did_finish_network_request()
+{
+    --m_pending_loads;
+    if (on_load_counter_change)
+        on_load_counter_change();
+}
+
 void ResourceLoader::load(const URL& url, Function<void(ReadonlyBytes, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> status_code)> success_callback, Function<void(const String&, Optional<u32> status_code)> error_callback)
 {
     LoadRequest request;
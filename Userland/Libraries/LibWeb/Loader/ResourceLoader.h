@@ -12,6 +12,7 @@
 #include <LibWeb/Loader/Resource.h>
 
 namespace Protocol {
+class Request;
 class RequestClient;
 }
 
@@ -31,11 +32,15 @@ public:
     static ResourceLoader& the();
 
     RefPtr<Resource> load_resource(Resource::Type, const LoadRequest&);
+    RefPtr<Resource> load_resource_sync(Resource::Type, const LoadRequest&);
 
     void load(const LoadRequest&, Function<void(ReadonlyBytes, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> status_code)> success_callback, Function<void(const String&, Optional<u32> status_code)> error_callback = nullptr);
     void load(const URL&, Function<void(ReadonlyBytes, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> status_code)> success_callback, Function<void(const String&, Optional<u32> status_code)> error_callback = nullptr);
     void load_sync(const LoadRequest&, Function<void(ReadonlyBytes, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> status_code)> success_callback, Function<void(const String&, Optional<u32> status_code)> error_callback = nullptr);
 
+    // Like load(), but hands the body over piece by piece as it comes in, rather than all at once when it's done.
+    void load_streaming(const LoadRequest&, Function<void(const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> status_code)> on_headers, Function<void(ReadonlyBytes)> on_data, Function<void()> on_complete, Function<void(const String&, Optional<u32> status_code)> error_callback = nullptr);
+
     Function<void()> on_load_counter_change;
 
     int pending_loads() const { return m_pending_loads; }
@@ -50,6 +55,9 @@ public:
 private:
     ResourceLoader();
     static bool is_port_blocked(int port);
+    bool can_load(const URL&, Function<void(const String&, Optional<u32> status_code)> const& error_callback);
+    RefPtr<Protocol::Request> start_network_request(const LoadRequest&);
+    void did_finish_network_request();
 
     int m_pending_loads { 0 };
 
@@ -142,15 +142,17 @@ void BrowsingContext::set_viewport_scroll_offset(const Gfx::IntPoint& offset)
 
 void BrowsingContext::set_needs_display(const Gfx::IntRect& rect)
 {
-    if (!viewport_rect().intersects(rect))
-        return;
-
+    // The page client is told about invalidations outside of the viewport as well, since it may keep around
+    // what it painted there earlier.
     if (is_top_level()) {
         if (m_page)
             m_page->client().page_did_invalidate(to_top_level_rect(rect));
         return;
     }
 
+    if (!viewport_rect().intersects(rect))
+        return;
+
     if (host_element() && host_element()->layout_node())
         host_element()->layout_node()->set_needs_display();
 }
@@ -5,16 +5,22 @@
  */
 
 #include <AK/Array.h>
-#include <AK/MemoryStream.h>
+#include <AK/Endian.h>
 #include <AK/NumericLimits.h>
 #include <AudioServer/ClientConnection.h>
 #include <AudioServer/Mixer.h>
+#include <LibCore/ConfigFile.h>
 #include <pthread.h>
 #include <strings.h>
 
 namespace AudioServer {
 
-u8 Mixer::m_zero_filled_buffer[4096];
+using AK::SIMD::f64x2;
+
+// A frame is a left and a right sample, so the mixer can work on whole frames at once.
+static_assert(sizeof(Audio::Frame) == sizeof(f64x2));
+
+u8 Mixer::m_zero_filled_buffer[max_period_frames * 2 * sizeof(i16)];
 
 Mixer::Mixer()
     : m_device(Core::File::construct("/dev/audio", this))
@@ -25,6 +31,9 @@ Mixer::Mixer()
           },
           "AudioServer[mixer]"))
 {
+    auto config = Core::ConfigFile::get_for_system("AudioServer");
+    m_period_frames = clamp(config->read_num_entry("Mixer", "PeriodFrames", m_period_frames), 32, (int)max_period_frames);
+
     if (!m_device->open(Core::OpenMode::WriteOnly)) {
         dbgln("Can't open audio device: {}", m_device->error_string());
         return;
@@ -58,57 +67,40 @@ void Mixer::mix()
     for (;;) {
         if (active_mix_queues.is_empty() || m_added_queue) {
             pthread_mutex_lock(&m_pending_mutex);
-            pthread_cond_wait(&m_pending_cond, &m_pending_mutex);
+            while (active_mix_queues.is_empty() && m_pending_mixing.is_empty())
+                pthread_cond_wait(&m_pending_cond, &m_pending_mutex);
             active_mix_queues.extend(move(m_pending_mixing));
-            pthread_mutex_unlock(&m_pending_mutex);
             m_added_queue = false;
+            pthread_mutex_unlock(&m_pending_mutex);
         }
 
         active_mix_queues.remove_all_matching([&](auto& entry) { return !entry->client(); });
 
-        Audio::Frame mixed_buffer[1024];
-        auto mixed_buffer_length = (int)(sizeof(mixed_buffer) / sizeof(Audio::Frame));
+        alignas(f64x2) f64x2 mixed_buffer[max_period_frames] {};
 
         // Mix the buffers together into the output
-        for (auto& queue : active_mix_queues) {
-            if (!queue->client()) {
-                queue->clear();
-                continue;
-            }
-
-            for (int i = 0; i < mixed_buffer_length; ++i) {
-                auto& mixed_sample = mixed_buffer[i];
-                Audio::Frame sample;
-                if (!queue->get_next_sample(sample))
-                    break;
-                mixed_sample += sample;
-            }
-        }
+        for (auto& queue : active_mix_queues)
+            queue->mix_into(mixed_buffer, m_period_frames);
 
+        auto output_size = m_period_frames * 2 * sizeof(i16);
         if (m_muted) {
-            m_device->write(m_zero_filled_buffer, sizeof(m_zero_filled_buffer));
-        } else {
-            Array<u8, 4096> buffer;
-            OutputMemoryStream stream { buffer };
-
-            for (int i = 0; i < mixed_buffer_length; ++i) {
-                auto& mixed_sample = mixed_buffer[i];
-
-                mixed_sample.scale(m_main_volume);
-                mixed_sample.clip();
-
-                LittleEndian<i16> out_sample;
-                out_sample = mixed_sample.left * NumericLimits<i16>::max();
-                stream << out_sample;
-
-                out_sample = mixed_sample.right * NumericLimits<i16>::max();
-                stream << out_sample;
-            }
+            m_device->write(m_zero_filled_buffer, output_size);
+            continue;
+        }
 
-            VERIFY(stream.is_end());
-            VERIFY(!stream.has_any_error());
-            m_device->write(stream.data(), stream.size());
+        double volume = m_main_volume / 100.0;
+        f64x2 scale { volume, volume };
+        f64x2 max_sample { NumericLimits<i16>::max(), NumericLimits<i16>::max() };
+        Array<LittleEndian<i16>, max_period_frames * 2> output;
+        for (size_t i = 0; i < m_period_frames; ++i) {
+            auto frame = mixed_buffer[i] * scale;
+            frame[0] = clamp(frame[0], -1.0, 1.0);
+            frame[1] = clamp(frame[1], -1.0, 1.0);
+            frame *= max_sample;
+            output[i * 2] = static_cast<i16>(frame[0]);
+            output[i * 2 + 1] = static_cast<i16>(frame[1]);
         }
+        m_device->write((u8 const*)output.data(), output_size);
     }
 }
 
@@ -143,6 +135,62 @@ BufferQueue::BufferQueue(ClientConnection& client)
 void BufferQueue::enqueue(NonnullRefPtr<Audio::Buffer>&& buffer)
 {
     m_remaining_samples += buffer->sample_count();
-    m_queue.enqueue(move(buffer));
+    bool enqueued = m_queue.try_enqueue(move(buffer));
+    VERIFY(enqueued);
+    ++m_enqueued_buffers;
+}
+
+bool BufferQueue::dequeue_next_buffer()
+{
+    for (;;) {
+        auto buffer = m_queue.try_dequeue();
+        if (!buffer.has_value())
+            return false;
+        auto sequence_number = m_dequeued_buffers++;
+        if (sequence_number < m_drop_buffers_before)
+            continue;
+        m_current = buffer.release_value();
+        m_current_sequence_number = sequence_number;
+        m_position = 0;
+        m_playing_buffer_id = m_current->id();
+        return true;
+    }
+}
+
+void BufferQueue::mix_into(f64x2* output, size_t frame_count)
+{
+    if (m_current && m_current_sequence_number < m_drop_buffers_before) {
+        m_current = nullptr;
+        m_playing_buffer_id = -1;
+    }
+
+    if (m_paused)
+        return;
+
+    size_t mixed_frames = 0;
+    while (mixed_frames < frame_count) {
+        if (!m_current && !dequeue_next_buffer())
+            break;
+
+        auto frames = min(frame_count - mixed_frames, (size_t)(m_current->sample_count() - m_position));
+        auto* samples = m_current->samples() + m_position;
+        for (size_t i = 0; i < frames; ++i) {
+            f64x2 frame;
+            __builtin_memcpy(&frame, &samples[i], sizeof(frame));
+            output[mixed_frames + i] += frame;
+        }
+        mixed_frames += frames;
+        m_position += frames;
+
+        if (m_position >= m_current->sample_count()) {
+            if (auto* client = m_client.ptr())
+                client->did_finish_playing_buffer({}, m_current->id());
+            m_current = nullptr;
+            m_playing_buffer_id = -1;
+        }
+    }
+
+    m_remaining_samples -= mixed_frames;
+    m_played_samples += mixed_frames;
 }
 }
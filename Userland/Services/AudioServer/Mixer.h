@@ -11,8 +11,9 @@
 #include <AK/Badge.h>
 #include <AK/ByteBuffer.h>
 #include <AK/NonnullRefPtrVector.h>
-#include <AK/Queue.h>
 #include <AK/RefCounted.h>
+#include <AK/SIMD.h>
+#include <AK/SPSCQueue.h>
 #include <AK/WeakPtr.h>
 #include <LibAudio/Buffer.h>
 #include <LibCore/File.h>
@@ -23,46 +24,29 @@ namespace AudioServer {
 
 class ClientConnection;
 
+// The buffers a client has handed us, on their way from the client's IPC thread to the mixer thread. The IPC thread
+// is the only one to enqueue and the mixer thread the only one to dequeue, so the two never have to wait on each other.
 class BufferQueue : public RefCounted<BufferQueue> {
 public:
     explicit BufferQueue(ClientConnection&);
     ~BufferQueue() { }
 
+    // Only to be called from the IPC thread.
     bool is_full() const { return m_queue.size() >= 3; }
     void enqueue(NonnullRefPtr<Audio::Buffer>&&);
 
-    bool get_next_sample(Audio::Frame& sample)
-    {
-        if (m_paused)
-            return false;
-
-        while (!m_current && !m_queue.is_empty())
-            m_current = m_queue.dequeue();
-
-        if (!m_current)
-            return false;
-
-        sample = m_current->samples()[m_position++];
-        --m_remaining_samples;
-        ++m_played_samples;
-
-        if (m_position >= m_current->sample_count()) {
-            m_client->did_finish_playing_buffer({}, m_current->id());
-            m_current = nullptr;
-            m_position = 0;
-        }
-        return true;
-    }
+    // Only to be called from the mixer thread. Adds up to frame_count frames to the output.
+    void mix_into(AK::SIMD::f64x2* output, size_t frame_count);
 
     ClientConnection* client() { return m_client.ptr(); }
 
+    // The mixer thread drops the buffers that were enqueued so far the next time it gets to this queue.
+    // The counters are reset right away, though the mixer may still count one more period on top.
     void clear(bool paused = false)
     {
-        m_queue.clear();
-        m_position = 0;
+        m_drop_buffers_before = m_enqueued_buffers.load();
         m_remaining_samples = 0;
         m_played_samples = 0;
-        m_current = nullptr;
         m_paused = paused;
     }
 
@@ -71,22 +55,27 @@ public:
         m_paused = paused;
     }
 
-    int get_remaining_samples() const { return m_remaining_samples; }
+    int get_remaining_samples() const { return max(m_remaining_samples.load(), 0); }
     int get_played_samples() const { return m_played_samples; }
-    int get_playing_buffer() const
-    {
-        if (m_current)
-            return m_current->id();
-        return -1;
-    }
+    int get_playing_buffer() const { return m_playing_buffer_id; }
 
 private:
+    bool dequeue_next_buffer();
+
+    SPSCQueue<RefPtr<Audio::Buffer>, 4> m_queue;
+    Atomic<u64> m_enqueued_buffers { 0 };
+    Atomic<u64> m_drop_buffers_before { 0 };
+    Atomic<int> m_remaining_samples { 0 };
+    Atomic<int> m_played_samples { 0 };
+    Atomic<i32> m_playing_buffer_id { -1 };
+    Atomic<bool> m_paused { false };
+
+    // These belong to the mixer thread.
     RefPtr<Audio::Buffer> m_current;
-    Queue<NonnullRefPtr<Audio::Buffer>> m_queue;
+    u64 m_current_sequence_number { 0 };
+    u64 m_dequeued_buffers { 0 };
     int m_position { 0 };
-    int m_remaining_samples { 0 };
-    int m_played_samples { 0 };
-    bool m_paused { false };
+
     WeakPtr<ClientConnection> m_client;
 };
 
@@ -104,6 +93,9 @@ public:
     bool is_muted() const { return m_muted; }
     void set_muted(bool);
 
+    // The mixer never writes more than this many frames to the device at once.
+    static constexpr size_t max_period_frames = 1024;
+
 private:
     Vector<NonnullRefPtr<BufferQueue>> m_pending_mixing;
     Atomic<bool> m_added_queue { false };
@@ -114,10 +106,13 @@ private:
 
     NonnullRefPtr<Threading::Thread> m_sound_thread;
 
-    bool m_muted { false };
-    int m_main_volume { 100 };
+    // How many frames the mixer writes to the device at once, which bounds how much latency it adds.
+    size_t m_period_frames { 256 };
+
+    Atomic<bool> m_muted { false };
+    Atomic<int> m_main_volume { 100 };
 
-    static u8 m_zero_filled_buffer[4096];
+    static u8 m_zero_filled_buffer[max_period_frames * 2 * sizeof(i16)];
 
     void mix();
 };
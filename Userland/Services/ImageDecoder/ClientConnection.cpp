@@ -9,6 +9,7 @@
 #include <ImageDecoder/ImageDecoderClientEndpoint.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/ImageDecoder.h>
+#include <LibThreading/BackgroundAction.h>
 
 namespace ImageDecoder {
 
@@ -30,37 +31,124 @@ void ClientConnection::die()
     exit(0);
 }
 
-Messages::ImageDecoderServer::DecodeImageResponse ClientConnection::decode_image(Core::AnonymousBuffer const& encoded_buffer)
+Optional<ClientConnection::DecodedImage> ClientConnection::decode(Core::AnonymousBuffer const& encoded_buffer, Gfx::IntSize ideal_size)
 {
     if (!encoded_buffer.is_valid()) {
         dbgln_if(IMAGE_DECODER_DEBUG, "Encoded data is invalid");
-        return nullptr;
+        return {};
     }
 
     auto decoder = Gfx::ImageDecoder::try_create(ReadonlyBytes { encoded_buffer.data<u8>(), encoded_buffer.size() });
 
     if (!decoder) {
         dbgln_if(IMAGE_DECODER_DEBUG, "Could not find suitable image decoder plugin for data");
-        return { false, 0, Vector<Gfx::ShareableBitmap> {}, Vector<u32> {} };
+        return {};
     }
 
+    decoder->set_ideal_size(ideal_size);
+
     if (!decoder->frame_count()) {
         dbgln_if(IMAGE_DECODER_DEBUG, "Could not decode image from encoded data");
-        return { false, 0, Vector<Gfx::ShareableBitmap> {}, Vector<u32> {} };
+        return {};
     }
 
-    Vector<Gfx::ShareableBitmap> bitmaps;
-    Vector<u32> durations;
+    DecodedImage image;
     for (size_t i = 0; i < decoder->frame_count(); ++i) {
         auto frame = decoder->frame(i);
         if (frame.image)
-            bitmaps.append(frame.image->to_shareable_bitmap());
+            image.bitmaps.append(frame.image->to_shareable_bitmap());
         else
-            bitmaps.append(Gfx::ShareableBitmap {});
-        durations.append(frame.duration);
+            image.bitmaps.append(Gfx::ShareableBitmap {});
+        image.durations.append(frame.duration);
+    }
+    image.is_animated = decoder->is_animated();
+    image.loop_count = decoder->loop_count();
+    return image;
+}
+
+Messages::ImageDecoderServer::DecodeImageResponse ClientConnection::decode_image(Core::AnonymousBuffer const& encoded_buffer)
+{
+    if (!encoded_buffer.is_valid())
+        return nullptr;
+
+    auto image = decode(encoded_buffer, {});
+    if (!image.has_value())
+        return { false, 0, Vector<Gfx::ShareableBitmap> {}, Vector<u32> {} };
+    return { image->is_animated, image->loop_count, move(image->bitmaps), move(image->durations) };
+}
+
+void ClientConnection::start_decoding_image(i32 image_id, Core::AnonymousBuffer const& encoded_buffer, Gfx::IntSize const& ideal_size, bool is_visible)
+{
+    {
+        Threading::MutexLocker locker(m_pending_requests_lock);
+        auto& requests = is_visible ? m_pending_visible_requests : m_pending_other_requests;
+        requests.append({ image_id, encoded_buffer, ideal_size });
     }
+    enqueue_decode(is_visible);
+}
+
+void ClientConnection::set_image_visible(i32 image_id, bool is_visible)
+{
+    bool did_move_request = false;
+    {
+        Threading::MutexLocker locker(m_pending_requests_lock);
+        auto& from = is_visible ? m_pending_other_requests : m_pending_visible_requests;
+        auto& to = is_visible ? m_pending_visible_requests : m_pending_other_requests;
+        for (size_t i = 0; i < from.size(); ++i) {
+            if (from[i].image_id == image_id) {
+                to.append(from.take(i));
+                did_move_request = true;
+                break;
+            }
+        }
+    }
+    // The piece of work that was queued for the image may be stuck behind lower priority work in the ThreadPool,
+    // so queue another one that isn't. Whichever gets to run last finds nothing left to do.
+    if (is_visible && did_move_request)
+        enqueue_decode(true);
+}
+
+void ClientConnection::cancel_decoding_image(i32 image_id)
+{
+    Threading::MutexLocker locker(m_pending_requests_lock);
+    m_pending_visible_requests.remove_first_matching([&](auto& request) { return request.image_id == image_id; });
+    m_pending_other_requests.remove_first_matching([&](auto& request) { return request.image_id == image_id; });
+}
 
-    return { decoder->is_animated(), static_cast<u32>(decoder->loop_count()), bitmaps, durations };
+void ClientConnection::enqueue_decode(bool is_visible)
+{
+    Threading::BackgroundAction<Optional<DecodeResult>>::create(
+        [self = NonnullRefPtr(*this)](auto&) mutable -> Optional<DecodeResult> {
+            auto request = self->take_next_request();
+            if (!request.has_value())
+                return {};
+            return DecodeResult { request->image_id, decode(request->encoded_data, request->ideal_size) };
+        },
+        [self = NonnullRefPtr(*this)](auto result) mutable {
+            if (result.has_value())
+                self->did_decode(result.release_value());
+        },
+        is_visible ? Threading::WorkPriority::High : Threading::WorkPriority::Low);
+}
+
+Optional<ClientConnection::DecodeRequest> ClientConnection::take_next_request()
+{
+    Threading::MutexLocker locker(m_pending_requests_lock);
+    if (!m_pending_visible_requests.is_empty())
+        return m_pending_visible_requests.take_first();
+    if (!m_pending_other_requests.is_empty())
+        return m_pending_other_requests.take_first();
+    return {};
+}
+
+void ClientConnection::did_decode(DecodeResult result)
+{
+    if (!result.image.has_value()) {
+        async_did_fail_to_decode_image(result.image_id);
+        return;
+    }
+    auto& image = result.image.value();
+    async_did_decode_image(result.image_id, image.is_animated, image.loop_count, move(image.bitmaps), move(image.durations));
 }
 
 }
@@ -7,10 +7,13 @@
 #pragma once
 
 #include <AK/HashMap.h>
+#include <AK/Optional.h>
+#include <AK/Vector.h>
 #include <ImageDecoder/Forward.h>
 #include <ImageDecoder/ImageDecoderClientEndpoint.h>
 #include <ImageDecoder/ImageDecoderServerEndpoint.h>
 #include <LibIPC/ClientConnection.h>
+#include <LibThreading/Mutex.h>
 #include <LibWeb/Forward.h>
 
 namespace ImageDecoder {
@@ -26,7 +29,41 @@ public:
     virtual void die() override;
 
 private:
+    struct DecodedImage {
+        bool is_animated { false };
+        u32 loop_count { 0 };
+        Vector<Gfx::ShareableBitmap> bitmaps;
+        Vector<u32> durations;
+    };
+
+    struct DecodeRequest {
+        i32 image_id { 0 };
+        Core::AnonymousBuffer encoded_data;
+        Gfx::IntSize ideal_size;
+    };
+
+    struct DecodeResult {
+        i32 image_id { 0 };
+        Optional<DecodedImage> image;
+    };
+
     virtual Messages::ImageDecoderServer::DecodeImageResponse decode_image(Core::AnonymousBuffer const&) override;
+    virtual void start_decoding_image(i32 image_id, Core::AnonymousBuffer const&, Gfx::IntSize const& ideal_size, bool is_visible) override;
+    virtual void set_image_visible(i32 image_id, bool is_visible) override;
+    virtual void cancel_decoding_image(i32 image_id) override;
+
+    static Optional<DecodedImage> decode(Core::AnonymousBuffer const&, Gfx::IntSize ideal_size);
+
+    void enqueue_decode(bool is_visible);
+    Optional<DecodeRequest> take_next_request();
+    void did_decode(DecodeResult);
+
+    // The images that are waiting for a thread to decode them. The ThreadPool gets one piece of work per image, which
+    // decodes whichever image is first in line when a thread gets to it, so that a visible image doesn't have to wait
+    // for the ones that were queued before it became visible.
+    Threading::Mutex m_pending_requests_lock;
+    Vector<DecodeRequest> m_pending_visible_requests;
+    Vector<DecodeRequest> m_pending_other_requests;
 };
 
 }
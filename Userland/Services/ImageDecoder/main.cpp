@@ -11,8 +11,7 @@
 
 int main(int, char**)
 {
-    Core::EventLoop event_loop;
-    if (pledge("stdio recvfd sendfd unix", nullptr) < 0) {
+    if (pledge("stdio recvfd sendfd unix accept proc sigaction thread", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -21,9 +20,18 @@ int main(int, char**)
         return 1;
     }
 
+    // Every client gets a fork of this process, which has already been linked.
+    Core::LocalSocket::fork_for_each_connection_from_system_server();
+
+    Core::EventLoop event_loop;
+    if (pledge("stdio recvfd sendfd unix thread", nullptr) < 0) {
+        perror("pledge");
+        return 1;
+    }
+
     auto socket = Core::LocalSocket::take_over_accepted_socket_from_system_server();
     IPC::new_client_connection<ImageDecoder::ClientConnection>(socket.release_nonnull(), 1);
-    if (pledge("stdio recvfd sendfd", nullptr) < 0) {
+    if (pledge("stdio recvfd sendfd thread", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -8,6 +8,7 @@
 #include "DNSPacket.h"
 #include "LookupServer.h"
 #include <AK/IPv4Address.h>
+#include <AK/IPv6Address.h>
 
 namespace LookupServer {
 
@@ -40,8 +41,28 @@ Messages::LookupServer::LookupNameResponse ClientConnection::lookup_name(String
     return { 0, move(addresses) };
 }
 
+Messages::LookupServer::LookupNameIpv6Response ClientConnection::lookup_name_ipv6(String const& name)
+{
+    auto answers = LookupServer::the().lookup(name, DNSRecordType::AAAA);
+    Vector<String> addresses;
+    for (auto& answer : answers) {
+        if (answer.record_data().length() == sizeof(IPv6Address))
+            addresses.append(answer.record_data());
+    }
+    if (addresses.is_empty())
+        return { 1, Vector<String>() };
+    return { 0, move(addresses) };
+}
+
 Messages::LookupServer::LookupAddressResponse ClientConnection::lookup_address(String const& address)
 {
+    if (address.length() == sizeof(IPv6Address)) {
+        IPv6Address ip_address { (const u8*)address.characters() };
+        auto answers = LookupServer::the().lookup(String::formatted("{}.ip6.arpa", ip_address.to_string_reversed()), DNSRecordType::PTR);
+        if (answers.is_empty())
+            return { 1, String() };
+        return { 0, answers[0].record_data() };
+    }
     if (address.length() != 4)
         return { 1, String() };
     IPv4Address ip_address { (const u8*)address.characters() };
@@ -26,6 +26,7 @@ public:
 private:
     virtual Messages::LookupServer::LookupNameResponse lookup_name(String const&) override;
     virtual Messages::LookupServer::LookupAddressResponse lookup_address(String const&) override;
+    virtual Messages::LookupServer::LookupNameIpv6Response lookup_name_ipv6(String const&) override;
 };
 
 }
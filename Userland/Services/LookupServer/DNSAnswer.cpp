@@ -26,6 +26,15 @@ bool DNSAnswer::has_expired() const
     return time(nullptr) >= m_received_time + m_ttl;
 }
 
+u32 DNSAnswer::remaining_ttl() const
+{
+    auto expiry_time = m_received_time + m_ttl;
+    auto now = time(nullptr);
+    if (now >= expiry_time)
+        return 0;
+    return expiry_time - now;
+}
+
 }
 
 void AK::Formatter<LookupServer::DNSRecordType>::format(AK::FormatBuilder& builder, LookupServer::DNSRecordType value)
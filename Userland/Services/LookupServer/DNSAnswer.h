@@ -45,6 +45,8 @@ public:
     bool mdns_cache_flush() const { return m_mdns_cache_flush; }
 
     bool has_expired() const;
+    // The part of the TTL that is left since we received the answer, which is what we should pass on when answering from a cache.
+    u32 remaining_ttl() const;
 
 private:
     DNSName m_name;
@@ -117,8 +117,9 @@ Optional<DNSPacket> DNSPacket::from_raw_packet(const u8* raw_data, size_t raw_si
     packet.m_query_or_response = header.is_response();
     packet.m_code = header.response_code();
 
-    // FIXME: Should we parse further in this case?
-    if (packet.code() != Code::NOERROR)
+    // NXDOMAIN responses still carry the question and an SOA record saying how long the name is known not to exist.
+    // FIXME: Should we parse further in other cases?
+    if (packet.code() != Code::NOERROR && packet.code() != Code::NXDOMAIN)
         return packet;
 
     size_t offset = sizeof(DNSPacketHeader);
@@ -176,6 +177,28 @@ Optional<DNSPacket> DNSPacket::from_raw_packet(const u8* raw_data, size_t raw_si
         offset += record.data_length();
     }
 
+    for (u16 i = 0; i < header.authority_count(); ++i) {
+        DNSName::parse(raw_data, offset, raw_size);
+        if (offset + sizeof(DNSRecordWithoutName) > raw_size)
+            break;
+
+        auto& record = *(const DNSRecordWithoutName*)(&raw_data[offset]);
+        offset += sizeof(DNSRecordWithoutName);
+
+        if ((DNSRecordType)record.type() == DNSRecordType::SOA) {
+            // The SOA data is MNAME, RNAME, SERIAL, REFRESH, RETRY, EXPIRE and MINIMUM.
+            size_t soa_offset = offset;
+            DNSName::parse(raw_data, soa_offset, raw_size);
+            DNSName::parse(raw_data, soa_offset, raw_size);
+            if (soa_offset + 5 * sizeof(u32) <= raw_size) {
+                auto& minimum = *(const NetworkOrdered<u32>*)(&raw_data[soa_offset + 4 * sizeof(u32)]);
+                packet.m_negative_ttl = min(record.ttl(), (u32)minimum);
+                dbgln_if(LOOKUPSERVER_DEBUG, "Authority #{}: SOA, ttl={}, minimum={}", i, record.ttl(), (u32)minimum);
+            }
+        }
+        offset += record.data_length();
+    }
+
     return packet;
 }
 
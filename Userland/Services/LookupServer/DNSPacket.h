@@ -56,6 +56,10 @@ public:
         return m_answers.size();
     }
 
+    // How long a resolver may remember that this response has no answers, taken from the SOA record in the
+    // authority section (RFC 2308, section 5). Responses without one mustn't be cached at all.
+    Optional<u32> negative_ttl() const { return m_negative_ttl; }
+
     void add_question(const DNSQuestion&);
     void add_answer(const DNSAnswer&);
 
@@ -84,6 +88,7 @@ private:
     bool m_recursion_available { true };
     Vector<DNSQuestion> m_questions;
     Vector<DNSAnswer> m_answers;
+    Optional<u32> m_negative_ttl;
 };
 
 }
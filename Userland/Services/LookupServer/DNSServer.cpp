@@ -11,29 +11,42 @@
 
 namespace LookupServer {
 
+// How many requests we take off the socket in one go.
+static constexpr size_t max_requests_per_batch = 32;
+
 DNSServer::DNSServer(Object* parent)
     : Core::UDPServer(parent)
 {
     bind(IPv4Address(), 53);
     on_ready_to_receive = [this]() {
-        handle_client();
+        handle_clients();
     };
 }
 
-void DNSServer::handle_client()
+void DNSServer::handle_clients()
+{
+    auto requests = receive_batch(1024, max_requests_per_batch);
+    Vector<Datagram> responses;
+    for (auto& request : requests) {
+        auto response = handle_request(request.data);
+        if (response.has_value())
+            responses.append({ response->to_byte_buffer(), request.address });
+    }
+    send_batch(responses);
+}
+
+Optional<DNSPacket> DNSServer::handle_request(const ByteBuffer& buffer)
 {
-    sockaddr_in client_address;
-    auto buffer = receive(1024, client_address);
     auto optional_request = DNSPacket::from_raw_packet(buffer.data(), buffer.size());
     if (!optional_request.has_value()) {
         dbgln("Got an invalid DNS packet");
-        return;
+        return {};
     }
     auto& request = optional_request.value();
 
     if (!request.is_query()) {
         dbgln("It's not a request");
-        return;
+        return {};
     }
 
     LookupServer& lookup_server = LookupServer::the();
@@ -57,8 +70,7 @@ void DNSServer::handle_client()
     else
         response.set_code(DNSPacket::Code::NOERROR);
 
-    buffer = response.to_byte_buffer();
-    sendto(fd(), buffer.data(), buffer.size(), 0, (const sockaddr*)&client_address, sizeof(client_address));
+    return response;
 }
 
 }
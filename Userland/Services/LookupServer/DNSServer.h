@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "DNSPacket.h"
 #include <LibCore/UDPServer.h>
 
 namespace LookupServer {
@@ -16,7 +17,8 @@ class DNSServer : public Core::UDPServer {
 private:
     explicit DNSServer(Object* parent = nullptr);
 
-    void handle_client();
+    void handle_clients();
+    Optional<DNSPacket> handle_request(const ByteBuffer&);
 };
 
 }
@@ -10,14 +10,18 @@
 #include <AK/ByteBuffer.h>
 #include <AK/Debug.h>
 #include <AK/HashMap.h>
+#include <AK/IPv6Address.h>
 #include <AK/Random.h>
 #include <AK/String.h>
 #include <AK/StringBuilder.h>
 #include <LibCore/ConfigFile.h>
+#include <LibCore/ElapsedTimer.h>
 #include <LibCore/File.h>
 #include <LibCore/LocalServer.h>
 #include <LibCore/LocalSocket.h>
 #include <LibCore/UDPSocket.h>
+#include <errno.h>
+#include <poll.h>
 #include <stdio.h>
 #include <time.h>
 #include <unistd.h>
@@ -27,6 +31,8 @@ namespace LookupServer {
 static LookupServer* s_the;
 // NOTE: This is the TTL we return for the hostname or answers from /etc/hosts.
 static constexpr u32 s_static_ttl = 86400;
+// NOTE: This is how many names each of the caches remembers at most.
+static constexpr size_t s_max_cache_size = 256;
 
 LookupServer& LookupServer::the()
 {
@@ -74,6 +80,9 @@ LookupServer::LookupServer()
     }
     m_mdns = MulticastDNS::construct(this);
 
+    m_cache_statistics_timer = Core::Timer::create_repeating(10 * 60 * 1000, [this] { log_cache_statistics(); }, this);
+    m_cache_statistics_timer->start();
+
     m_local_server = Core::LocalServer::construct(this);
     m_local_server->on_ready_to_accept = [this]() {
         auto socket = m_local_server->accept();
@@ -124,6 +133,14 @@ void LookupServer::load_etc_hosts()
         if (fields.size() > 2)
             dbgln("Line {} from '/etc/hosts' ('{}') has more than two parts, only the first two are used.", line_number, original_line);
 
+        DNSName name { fields[1] };
+
+        if (auto maybe_ipv6_address = IPv6Address::from_string(fields[0]); maybe_ipv6_address.has_value()) {
+            add_answer(name, DNSRecordType::AAAA, String { (const char*)maybe_ipv6_address->data(), sizeof(IPv6Address) });
+            add_answer(String::formatted("{}.ip6.arpa", maybe_ipv6_address->to_string_reversed()), DNSRecordType::PTR, name.as_string());
+            continue;
+        }
+
         auto maybe_address = IPv4Address::from_string(fields[0]);
         if (!maybe_address.has_value()) {
             dbgln("Failed to parse line {} from '/etc/hosts': '{}'", line_number, original_line);
@@ -132,7 +149,6 @@ void LookupServer::load_etc_hosts()
 
         auto raw_addr = maybe_address->to_in_addr_t();
 
-        DNSName name { fields[1] };
         add_answer(name, DNSRecordType::A, String { (const char*)&raw_addr, sizeof(raw_addr) });
 
         StringBuilder builder;
@@ -154,12 +170,12 @@ Vector<DNSAnswer> LookupServer::lookup(const DNSName& name, DNSRecordType record
     dbgln_if(LOOKUPSERVER_DEBUG, "Got request for '{}'", name.as_string());
 
     Vector<DNSAnswer> answers;
-    auto add_answer = [&](const DNSAnswer& answer) {
+    auto add_answer = [&](const DNSAnswer& answer, u32 ttl) {
         DNSAnswer answer_with_original_case {
             name,
             answer.type(),
             answer.class_code(),
-            answer.ttl(),
+            ttl,
             answer.record_data(),
             answer.mdns_cache_flush(),
         };
@@ -170,7 +186,7 @@ Vector<DNSAnswer> LookupServer::lookup(const DNSName& name, DNSRecordType record
     if (auto local_answers = m_etc_hosts.get(name); local_answers.has_value()) {
         for (auto& answer : local_answers.value()) {
             if (answer.type() == record_type)
-                add_answer(answer);
+                add_answer(answer, answer.ttl());
         }
         if (!answers.is_empty())
             return answers;
@@ -185,19 +201,32 @@ Vector<DNSAnswer> LookupServer::lookup(const DNSName& name, DNSRecordType record
         answers.append(move(answer));
         return answers;
     }
+    if (record_type == DNSRecordType::AAAA && get_hostname() == name) {
+        auto address = IPv6Address::from_string("::1"sv).value();
+        DNSAnswer answer { name, DNSRecordType::AAAA, DNSRecordClass::IN, s_static_ttl, String { (const char*)address.data(), sizeof(address) }, false };
+        answers.append(move(answer));
+        return answers;
+    }
 
-    // Third, try our cache.
+    // Third, try our cache. Whoever we pass the answers on to may cache them too, so they get the TTL that is left.
     if (auto cached_answers = m_lookup_cache.get(name); cached_answers.has_value()) {
         for (auto& answer : cached_answers.value()) {
-            // TODO: Actually remove expired answers from the cache.
             if (answer.type() == record_type && !answer.has_expired()) {
                 dbgln_if(LOOKUPSERVER_DEBUG, "Cache hit: {} -> {}", name.as_string(), answer.record_data());
-                add_answer(answer);
+                add_answer(answer, answer.remaining_ttl());
             }
         }
-        if (!answers.is_empty())
+        if (!answers.is_empty()) {
+            ++m_cache_statistics.hits;
             return answers;
+        }
     }
+    if (is_in_negative_cache(name, record_type)) {
+        dbgln_if(LOOKUPSERVER_DEBUG, "Negative cache hit: {}", name.as_string());
+        ++m_cache_statistics.negative_hits;
+        return {};
+    }
+    ++m_cache_statistics.misses;
 
     // Fourth, look up .local names using mDNS instead of DNS nameservers.
     if (name.as_string().ends_with(".local")) {
@@ -208,100 +237,54 @@ Vector<DNSAnswer> LookupServer::lookup(const DNSName& name, DNSRecordType record
     }
 
     // Fifth, ask the upstream nameservers.
-    for (auto& nameserver : m_nameservers) {
-        dbgln_if(LOOKUPSERVER_DEBUG, "Doing lookup using nameserver '{}'", nameserver);
-        bool did_get_response = false;
-        int retries = 3;
-        Vector<DNSAnswer> upstream_answers;
-        do {
-            upstream_answers = lookup(name, nameserver, did_get_response, record_type);
-            if (did_get_response)
-                break;
-        } while (--retries);
-        if (!upstream_answers.is_empty()) {
-            for (auto& answer : upstream_answers)
-                add_answer(answer);
-            break;
-        } else {
-            if (!did_get_response)
-                dbgln("Never got a response from '{}', trying next nameserver", nameserver);
-            else
-                dbgln("Received response from '{}' but no result(s), trying next nameserver", nameserver);
-        }
-    }
+    for (auto& answer : lookup_upstream(name, record_type))
+        add_answer(answer, answer.ttl());
 
     // Sixth, fail.
     if (answers.is_empty()) {
-        dbgln("Tried all nameservers but never got a response :(");
+        dbgln("Tried all nameservers but never got an answer for '{}' :(", name.as_string());
         return {};
     }
 
     return answers;
 }
 
-Vector<DNSAnswer> LookupServer::lookup(const DNSName& name, const String& nameserver, bool& did_get_response, DNSRecordType record_type, ShouldRandomizeCase should_randomize_case)
-{
-    DNSPacket request;
-    request.set_is_query();
-    request.set_id(get_random_uniform(UINT16_MAX));
-    DNSName name_in_question = name;
-    if (should_randomize_case == ShouldRandomizeCase::Yes)
-        name_in_question.randomize_case();
-    request.add_question({ name_in_question, record_type, DNSRecordClass::IN, false });
+namespace {
 
-    auto buffer = request.to_byte_buffer();
-
-    auto udp_socket = Core::UDPSocket::construct();
-    udp_socket->set_blocking(true);
-
-    struct timeval timeout {
-        1, 0
-    };
-
-    int rc = setsockopt(udp_socket->fd(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
-    if (rc < 0) {
-        perror("setsockopt(SOL_SOCKET, SO_RCVTIMEO)");
-        return {};
-    }
-
-    if (!udp_socket->connect(nameserver, 53))
-        return {};
-
-    if (!udp_socket->write(buffer))
-        return {};
-
-    u8 response_buffer[4096];
-    int nrecv = udp_socket->read(response_buffer, sizeof(response_buffer));
-    if (nrecv == 0)
-        return {};
-
-    did_get_response = true;
-
-    auto o_response = DNSPacket::from_raw_packet(response_buffer, nrecv);
-    if (!o_response.has_value())
-        return {};
+// A question we sent to one of the upstream nameservers and are waiting to hear back about.
+struct UpstreamQuery {
+    String nameserver;
+    RefPtr<Core::UDPSocket> socket;
+    DNSPacket request;
+    ShouldRandomizeCase should_randomize_case { ShouldRandomizeCase::Yes };
+};
 
-    auto& response = o_response.value();
+}
 
-    if (response.id() != request.id()) {
-        dbgln("LookupServer: ID mismatch ({} vs {}) :(", response.id(), request.id());
-        return {};
-    }
+static bool send_query(UpstreamQuery& query, const DNSName& name, DNSRecordType record_type)
+{
+    query.request = {};
+    query.request.set_is_query();
+    query.request.set_id(get_random_uniform(UINT16_MAX));
+    DNSName name_in_question = name;
+    if (query.should_randomize_case == ShouldRandomizeCase::Yes)
+        name_in_question.randomize_case();
+    query.request.add_question({ name_in_question, record_type, DNSRecordClass::IN, false });
 
-    if (response.code() == DNSPacket::Code::REFUSED) {
-        if (should_randomize_case == ShouldRandomizeCase::Yes) {
-            // Retry with 0x20 case randomization turned off.
-            return lookup(name, nameserver, did_get_response, record_type, ShouldRandomizeCase::No);
-        }
-        return {};
-    }
+    query.socket = Core::UDPSocket::construct();
+    if (!query.socket->connect(query.nameserver, 53))
+        return false;
+    return query.socket->write(query.request.to_byte_buffer());
+}
 
+// Verify the questions in our request and in their response match exactly, including case.
+static bool response_matches_request(const DNSPacket& response, const DNSPacket& request)
+{
     if (response.question_count() != request.question_count()) {
         dbgln("LookupServer: Question count ({} vs {}) :(", response.question_count(), request.question_count());
-        return {};
+        return false;
     }
 
-    // Verify the questions in our request and in their response match exactly, including case.
     for (size_t i = 0; i < request.question_count(); ++i) {
         auto& request_question = request.questions()[i];
         auto& response_question = response.questions()[i];
@@ -312,24 +295,121 @@ Vector<DNSAnswer> LookupServer::lookup(const DNSName& name, const String& namese
             dbgln("Request and response questions do not match");
             dbgln("   Request: name=_{}_, type={}, class={}", request_question.name().as_string(), response_question.record_type(), response_question.class_code());
             dbgln("  Response: name=_{}_, type={}, class={}", response_question.name().as_string(), response_question.record_type(), response_question.class_code());
-            return {};
+            return false;
         }
     }
+    return true;
+}
 
-    if (response.answer_count() < 1) {
-        dbgln("LookupServer: No answers :(");
-        return {};
-    }
+Vector<DNSAnswer> LookupServer::lookup_upstream(const DNSName& name, DNSRecordType record_type)
+{
+    // Ask all nameservers at once and go with the first one that answers, so a slow or unreachable nameserver
+    // doesn't hold up every lookup until it times out.
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        Vector<UpstreamQuery> queries;
+        for (auto& nameserver : m_nameservers) {
+            dbgln_if(LOOKUPSERVER_DEBUG, "Doing lookup using nameserver '{}'", nameserver);
+            UpstreamQuery query;
+            query.nameserver = nameserver;
+            if (send_query(query, name, record_type))
+                queries.append(move(query));
+        }
 
-    Vector<DNSAnswer, 8> answers;
-    for (auto& answer : response.answers()) {
-        put_in_cache(answer);
-        if (answer.type() != record_type)
-            continue;
-        answers.append(answer);
-    }
+        bool did_get_response = false;
+        Core::ElapsedTimer timer;
+        timer.start();
+        while (!queries.is_empty()) {
+            int time_left = 1000 - timer.elapsed();
+            if (time_left <= 0)
+                break;
 
-    return answers;
+            Vector<pollfd> poll_fds;
+            for (auto& query : queries)
+                poll_fds.append({ query.socket->fd(), POLLIN, 0 });
+            int rc = poll(poll_fds.data(), poll_fds.size(), time_left);
+            if (rc < 0) {
+                if (errno == EINTR)
+                    continue;
+                perror("poll");
+                break;
+            }
+            if (rc == 0)
+                break;
+
+            // Go backwards so that nameservers we give up on can be removed along the way.
+            for (size_t i = poll_fds.size(); i-- > 0;) {
+                if (!poll_fds[i].revents)
+                    continue;
+                auto& query = queries[i];
+
+                u8 response_buffer[4096];
+                int nrecv = query.socket->read(response_buffer, sizeof(response_buffer));
+                if (nrecv <= 0) {
+                    queries.remove(i);
+                    continue;
+                }
+
+                did_get_response = true;
+
+                auto o_response = DNSPacket::from_raw_packet(response_buffer, nrecv);
+                if (!o_response.has_value())
+                    continue;
+                auto& response = o_response.value();
+
+                if (response.id() != query.request.id()) {
+                    dbgln("LookupServer: ID mismatch ({} vs {}) :(", response.id(), query.request.id());
+                    continue;
+                }
+
+                if (response.code() == DNSPacket::Code::REFUSED) {
+                    if (query.should_randomize_case == ShouldRandomizeCase::Yes) {
+                        // Retry with 0x20 case randomization turned off.
+                        query.should_randomize_case = ShouldRandomizeCase::No;
+                        if (send_query(query, name, record_type))
+                            continue;
+                    }
+                    queries.remove(i);
+                    continue;
+                }
+
+                if (!response_matches_request(response, query.request))
+                    continue;
+
+                // Something like SERVFAIL doesn't say anything about the name, so see what the others have to say.
+                if (response.code() != DNSPacket::Code::NOERROR && response.code() != DNSPacket::Code::NXDOMAIN) {
+                    dbgln("Received response code {} from '{}'", (u8)response.code(), query.nameserver);
+                    queries.remove(i);
+                    continue;
+                }
+
+                Vector<DNSAnswer> answers;
+                for (auto& answer : response.answers()) {
+                    put_in_cache(answer);
+                    if (answer.type() != record_type)
+                        continue;
+                    answers.append(answer);
+                }
+
+                // If the response only followed a CNAME to a name without the records we want, the empty result is about
+                // that name rather than this one.
+                if (response.answer_count() == 0) {
+                    dbgln("Received response from '{}' but no result(s)", query.nameserver);
+                    if (auto negative_ttl = response.negative_ttl(); negative_ttl.has_value()) {
+                        Optional<DNSRecordType> missing_record_type;
+                        if (response.code() == DNSPacket::Code::NOERROR)
+                            missing_record_type = record_type;
+                        put_in_negative_cache(name, missing_record_type, negative_ttl.value());
+                    }
+                }
+                return answers;
+            }
+        }
+
+        if (did_get_response)
+            break;
+        dbgln("Never got a response from any nameserver, retrying");
+    }
+    return {};
 }
 
 void LookupServer::put_in_cache(const DNSAnswer& answer)
@@ -339,7 +419,9 @@ void LookupServer::put_in_cache(const DNSAnswer& answer)
 
     // Prevent the cache from growing too big.
     // TODO: Evict least used entries.
-    if (m_lookup_cache.size() >= 256)
+    if (m_lookup_cache.size() >= s_max_cache_size)
+        purge_expired_cache_entries();
+    if (m_lookup_cache.size() >= s_max_cache_size)
         m_lookup_cache.remove(m_lookup_cache.begin());
 
     auto it = m_lookup_cache.find(answer.name());
@@ -364,4 +446,71 @@ void LookupServer::put_in_cache(const DNSAnswer& answer)
     }
 }
 
+void LookupServer::put_in_negative_cache(const DNSName& name, Optional<DNSRecordType> record_type, u32 ttl)
+{
+    if (ttl == 0)
+        return;
+
+    if (m_negative_cache.size() >= s_max_cache_size)
+        purge_expired_cache_entries();
+    if (m_negative_cache.size() >= s_max_cache_size)
+        m_negative_cache.remove(m_negative_cache.begin());
+
+    NegativeCacheEntry entry { record_type, time(nullptr) + ttl };
+    auto it = m_negative_cache.find(name);
+    if (it == m_negative_cache.end())
+        m_negative_cache.set(name, { entry });
+    else
+        it->value.append(entry);
+}
+
+bool LookupServer::is_in_negative_cache(const DNSName& name, DNSRecordType record_type) const
+{
+    auto entries = m_negative_cache.get(name);
+    if (!entries.has_value())
+        return false;
+    auto now = time(nullptr);
+    for (auto& entry : entries.value()) {
+        if (now < entry.expiry_time && (!entry.record_type.has_value() || entry.record_type == record_type))
+            return true;
+    }
+    return false;
+}
+
+void LookupServer::purge_expired_cache_entries()
+{
+    auto now = time(nullptr);
+    Vector<DNSName> empty_names;
+
+    for (auto& it : m_lookup_cache) {
+        it.value.remove_all_matching([](auto& answer) { return answer.has_expired(); });
+        if (it.value.is_empty())
+            empty_names.append(it.key);
+    }
+    for (auto& name : empty_names)
+        m_lookup_cache.remove(name);
+
+    empty_names.clear();
+    for (auto& it : m_negative_cache) {
+        it.value.remove_all_matching([&](auto& entry) { return now >= entry.expiry_time; });
+        if (it.value.is_empty())
+            empty_names.append(it.key);
+    }
+    for (auto& name : empty_names)
+        m_negative_cache.remove(name);
+}
+
+void LookupServer::log_cache_statistics()
+{
+    auto& statistics = m_cache_statistics;
+    if (statistics.hits == m_logged_cache_statistics.hits && statistics.negative_hits == m_logged_cache_statistics.negative_hits && statistics.misses == m_logged_cache_statistics.misses)
+        return;
+    m_logged_cache_statistics = statistics;
+
+    auto lookups = statistics.hits + statistics.negative_hits + statistics.misses;
+    dbgln("Cache: {} lookups, {} hits, {} negative hits, {} misses ({}% hit rate), {} names cached, {} names cached as missing",
+        lookups, statistics.hits, statistics.negative_hits, statistics.misses, (statistics.hits + statistics.negative_hits) * 100 / lookups,
+        m_lookup_cache.size(), m_negative_cache.size());
+}
+
 }
@@ -12,6 +12,8 @@
 #include "MulticastDNS.h"
 #include <LibCore/FileWatcher.h>
 #include <LibCore/Object.h>
+#include <LibCore/Timer.h>
+#include <time.h>
 
 namespace LookupServer {
 
@@ -27,10 +29,21 @@ public:
 private:
     LookupServer();
 
+    // Remembers that a lookup came back empty (RFC 2308). Without a record type, the name doesn't exist at all
+    // (NXDOMAIN); with one, it only has no records of that type (NODATA).
+    struct NegativeCacheEntry {
+        Optional<DNSRecordType> record_type;
+        time_t expiry_time { 0 };
+    };
+
     void load_etc_hosts();
     void put_in_cache(const DNSAnswer&);
+    void put_in_negative_cache(const DNSName&, Optional<DNSRecordType>, u32 ttl);
+    bool is_in_negative_cache(const DNSName&, DNSRecordType) const;
+    void purge_expired_cache_entries();
+    void log_cache_statistics();
 
-    Vector<DNSAnswer> lookup(const DNSName& hostname, const String& nameserver, bool& did_get_response, DNSRecordType record_type, ShouldRandomizeCase = ShouldRandomizeCase::Yes);
+    Vector<DNSAnswer> lookup_upstream(const DNSName&, DNSRecordType);
 
     RefPtr<Core::LocalServer> m_local_server;
     RefPtr<DNSServer> m_dns_server;
@@ -39,6 +52,16 @@ private:
     RefPtr<Core::FileWatcher> m_file_watcher;
     HashMap<DNSName, Vector<DNSAnswer>, DNSName::Traits> m_etc_hosts;
     HashMap<DNSName, Vector<DNSAnswer>, DNSName::Traits> m_lookup_cache;
+    HashMap<DNSName, Vector<NegativeCacheEntry>, DNSName::Traits> m_negative_cache;
+
+    struct CacheStatistics {
+        u64 hits { 0 };
+        u64 negative_hits { 0 };
+        u64 misses { 0 };
+    };
+    CacheStatistics m_cache_statistics;
+    CacheStatistics m_logged_cache_statistics;
+    RefPtr<Core::Timer> m_cache_statistics_timer;
 };
 
 }
@@ -52,16 +52,17 @@ MulticastDNS::MulticastDNS(Object* parent)
 
 void MulticastDNS::handle_packet()
 {
-    auto buffer = receive(1024);
-    auto optional_packet = DNSPacket::from_raw_packet(buffer.data(), buffer.size());
-    if (!optional_packet.has_value()) {
-        dbgln("Got an invalid mDNS packet");
-        return;
-    }
-    auto& packet = optional_packet.value();
+    for (auto& datagram : receive_batch(1024, 32)) {
+        auto optional_packet = DNSPacket::from_raw_packet(datagram.data.data(), datagram.data.size());
+        if (!optional_packet.has_value()) {
+            dbgln("Got an invalid mDNS packet");
+            continue;
+        }
+        auto& packet = optional_packet.value();
 
-    if (packet.is_query())
-        handle_query(packet);
+        if (packet.is_query())
+            handle_query(packet);
+    }
 }
 
 void MulticastDNS::handle_query(const DNSPacket& packet)
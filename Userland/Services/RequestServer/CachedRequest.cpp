@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/Timer.h>
+#include <RequestServer/CachedRequest.h>
+
+namespace RequestServer {
+
+CachedRequest::CachedRequest(ClientConnection& client, NonnullRefPtr<CachedResponse> response, NonnullOwnPtr<OutputFileStream>&& output_stream)
+    : Request(client, move(output_stream))
+    , m_response(move(response))
+    , m_start_timer(Core::Timer::create_single_shot(0, [this] { send_cached_response(m_response); }))
+{
+    // The client only learns the request's id once start_request() returns, so nothing can be sent before that.
+    m_start_timer->start();
+}
+
+CachedRequest::~CachedRequest()
+{
+}
+
+NonnullOwnPtr<CachedRequest> CachedRequest::create(ClientConnection& client, NonnullRefPtr<CachedResponse> response, NonnullOwnPtr<OutputFileStream>&& output_stream)
+{
+    return adopt_own(*new CachedRequest(client, move(response), move(output_stream)));
+}
+
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullOwnPtr.h>
+#include <LibCore/Forward.h>
+#include <RequestServer/HttpCache.h>
+#include <RequestServer/Request.h>
+
+namespace RequestServer {
+
+// A request answered from the HTTP cache without contacting the origin server.
+class CachedRequest final : public Request {
+public:
+    virtual ~CachedRequest() override;
+    static NonnullOwnPtr<CachedRequest> create(ClientConnection&, NonnullRefPtr<CachedResponse>, NonnullOwnPtr<OutputFileStream>&&);
+
+private:
+    explicit CachedRequest(ClientConnection&, NonnullRefPtr<CachedResponse>, NonnullOwnPtr<OutputFileStream>&&);
+
+    NonnullRefPtr<CachedResponse> m_response;
+    NonnullRefPtr<Core::Timer> m_start_timer;
+};
+
+}
@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Debug.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/String.h>
+#include <AK/URL.h>
+#include <AK/Vector.h>
+#include <AK/WeakPtr.h>
+#include <LibCore/TCPSocket.h>
+#include <LibCore/Timer.h>
+#include <LibHTTP/Http2Connection.h>
+#include <LibTLS/TLSv12.h>
+
+namespace RequestServer {
+
+// Keeps the connections to an origin open once a job is done with them, so the next job doesn't have to connect (and
+// for HTTPS, negotiate TLS) all over again. Jobs beyond the per-origin limit wait for one of the connections to be released.
+// HTTPS connections on which the server picked HTTP/2 are shared by as many jobs at once as the server allows.
+template<typename JobType, typename SocketType>
+class ConnectionCache {
+public:
+    static constexpr size_t max_connections_per_origin = 6;
+    static constexpr int idle_timeout_ms = 10'000;
+    static constexpr bool can_use_http2 = IsSame<SocketType, TLS::TLSv12>;
+
+    static ConnectionCache& the()
+    {
+        static ConnectionCache cache;
+        return cache;
+    }
+
+    void start_job(URL const& url, JobType& job)
+    {
+        auto key = String::formatted("{}:{}", url.host(), url.port());
+        auto& origin = m_origins.ensure(key);
+        for (auto& connection : origin.connections) {
+            if (connection.http2 && connection.http2->can_open_stream()) {
+                dbgln_if(CONNECTION_CACHE_DEBUG, "ConnectionCache: Starting a stream on an HTTP/2 connection to {}", key);
+                start_job_on_http2(connection, job);
+                return;
+            }
+        }
+        for (auto& connection : origin.connections) {
+            if (!connection.is_in_use) {
+                dbgln_if(CONNECTION_CACHE_DEBUG, "ConnectionCache: Reusing a connection to {}", key);
+                start_job_on(key, connection, job);
+                return;
+            }
+        }
+        if (origin.connections.size() < max_connections_per_origin) {
+            origin.connections.append(make<Connection>(SocketType::construct(nullptr)));
+            start_job_on(key, origin.connections.last(), job);
+            return;
+        }
+        dbgln_if(CONNECTION_CACHE_DEBUG, "ConnectionCache: All connections to {} are in use, queueing job", key);
+        origin.pending_jobs.append(job.template make_weak_ptr<JobType>());
+    }
+
+private:
+    struct Connection {
+        explicit Connection(NonnullRefPtr<SocketType> socket)
+            : socket(move(socket))
+        {
+        }
+
+        NonnullRefPtr<SocketType> socket;
+        // Set once the server picks HTTP/2, after which the connection is never handed to a single job again.
+        RefPtr<HTTP::Http2Connection> http2;
+        RefPtr<Core::Timer> idle_timer;
+        bool is_in_use { false };
+    };
+
+    struct Origin {
+        NonnullOwnPtrVector<Connection> connections;
+        Vector<WeakPtr<JobType>> pending_jobs;
+    };
+
+    ConnectionCache() = default;
+
+    void start_job_on(String const& key, Connection& connection, JobType& job)
+    {
+        connection.is_in_use = true;
+        if (connection.idle_timer)
+            connection.idle_timer->stop();
+        stop_watching_idle_connection(connection.socket);
+
+        job.on_socket_released = [this, key, socket = connection.socket.ptr()](bool can_reuse_connection) {
+            release(key, *socket, can_reuse_connection);
+        };
+        if constexpr (can_use_http2) {
+            job.on_http2_connection_established = [this, key, socket = connection.socket.ptr()](auto& http2_connection) {
+                did_establish_http2_connection(key, *socket, http2_connection);
+            };
+        }
+        job.start(connection.socket);
+    }
+
+    void start_job_on_http2(Connection& connection, JobType& job)
+    {
+        if (connection.idle_timer)
+            connection.idle_timer->stop();
+        job.on_socket_released = nullptr;
+        if constexpr (can_use_http2)
+            job.start(*connection.http2);
+    }
+
+    void did_establish_http2_connection(String const& key, SocketType& socket, HTTP::Http2Connection& http2_connection)
+    {
+        auto it = m_origins.find(key);
+        if (it == m_origins.end())
+            return;
+        auto& origin = it->value;
+        auto index = find_connection(origin, socket);
+        if (!index.has_value())
+            return;
+        dbgln_if(CONNECTION_CACHE_DEBUG, "ConnectionCache: Server picked HTTP/2 for a connection to {}", key);
+
+        auto& connection = origin.connections[*index];
+        connection.http2 = http2_connection;
+        http2_connection.on_idle = [this, key, &socket] {
+            did_become_idle(key, socket);
+        };
+        http2_connection.on_closed = [this, key, &socket] {
+            remove_closed_connection(key, socket);
+        };
+
+        // The jobs that were waiting for a connection can share this one.
+        while (!origin.pending_jobs.is_empty() && http2_connection.can_open_stream()) {
+            auto job = origin.pending_jobs.take_first();
+            if (job)
+                start_job_on_http2(connection, *job);
+        }
+    }
+
+    void did_become_idle(String const& key, SocketType& socket)
+    {
+        auto it = m_origins.find(key);
+        if (it == m_origins.end())
+            return;
+        auto index = find_connection(it->value, socket);
+        if (!index.has_value())
+            return;
+        start_idle_timer(key, it->value.connections[*index]);
+    }
+
+    void start_idle_timer(String const& key, Connection& connection)
+    {
+        if (!connection.idle_timer) {
+            connection.idle_timer = Core::Timer::create_single_shot(idle_timeout_ms, [this, key, socket = connection.socket.ptr()] {
+                remove_idle_connection(key, *socket);
+            });
+        }
+        connection.idle_timer->start();
+    }
+
+    void remove_closed_connection(String const& key, SocketType& socket)
+    {
+        auto it = m_origins.find(key);
+        if (it == m_origins.end())
+            return;
+        auto& origin = it->value;
+        auto index = find_connection(origin, socket);
+        if (!index.has_value())
+            return;
+        dbgln_if(CONNECTION_CACHE_DEBUG, "ConnectionCache: An HTTP/2 connection to {} was closed", key);
+        origin.connections.remove(*index);
+
+        while (!origin.pending_jobs.is_empty()) {
+            auto job = origin.pending_jobs.take_first();
+            if (!job)
+                continue;
+            origin.connections.append(make<Connection>(SocketType::construct(nullptr)));
+            start_job_on(key, origin.connections.last(), *job);
+            return;
+        }
+        if (origin.connections.is_empty())
+            m_origins.remove(it);
+    }
+
+    Optional<size_t> find_connection(Origin const& origin, SocketType const& socket) const
+    {
+        for (size_t i = 0; i < origin.connections.size(); ++i) {
+            if (origin.connections[i].socket.ptr() == &socket)
+                return i;
+        }
+        return {};
+    }
+
+    void release(String const& key, SocketType& socket, bool can_reuse_connection)
+    {
+        auto it = m_origins.find(key);
+        if (it == m_origins.end())
+            return;
+        auto& origin = it->value;
+        auto index = find_connection(origin, socket);
+        if (!index.has_value())
+            return;
+
+        if (!can_reuse_connection) {
+            dbgln_if(CONNECTION_CACHE_DEBUG, "ConnectionCache: Closing a connection to {}", key);
+            origin.connections.remove(*index);
+        } else {
+            origin.connections[*index].is_in_use = false;
+        }
+
+        while (!origin.pending_jobs.is_empty()) {
+            auto job = origin.pending_jobs.take_first();
+            if (!job)
+                continue;
+            if (can_reuse_connection) {
+                start_job_on(key, origin.connections[*index], *job);
+            } else {
+                origin.connections.append(make<Connection>(SocketType::construct(nullptr)));
+                start_job_on(key, origin.connections.last(), *job);
+            }
+            return;
+        }
+
+        if (!can_reuse_connection) {
+            if (origin.connections.is_empty())
+                m_origins.remove(it);
+            return;
+        }
+
+        auto& connection = origin.connections[*index];
+        watch_idle_connection(key, connection.socket);
+        start_idle_timer(key, connection);
+    }
+
+    void remove_idle_connection(String const& key, SocketType& socket)
+    {
+        auto it = m_origins.find(key);
+        if (it == m_origins.end())
+            return;
+        auto index = find_connection(it->value, socket);
+        if (!index.has_value())
+            return;
+        auto& connection = it->value.connections[*index];
+        if (connection.http2 ? connection.http2->stream_count() != 0 : connection.is_in_use)
+            return;
+        dbgln_if(CONNECTION_CACHE_DEBUG, "ConnectionCache: Dropping an idle connection to {}", key);
+        if (connection.http2) {
+            connection.http2->on_idle = nullptr;
+            connection.http2->on_closed = nullptr;
+            connection.http2->close();
+        }
+        it->value.connections.remove(*index);
+        if (it->value.connections.is_empty() && it->value.pending_jobs.is_empty())
+            m_origins.remove(it);
+    }
+
+    // An idle connection can't be reused once the server closes it or sends anything unasked.
+    void watch_idle_connection(String const& key, SocketType& socket)
+    {
+        auto schedule_removal = [this, key, &socket] {
+            // Deferred, since this runs in one of the socket's own callbacks.
+            socket.deferred_invoke([this, key](auto& object) {
+                remove_idle_connection(key, static_cast<SocketType&>(object));
+            });
+        };
+        if constexpr (IsSame<SocketType, TLS::TLSv12>) {
+            socket.on_tls_ready_to_read = [schedule_removal](auto&) { schedule_removal(); };
+            socket.on_tls_finished = [schedule_removal] { schedule_removal(); };
+            socket.on_tls_error = [schedule_removal](auto) { schedule_removal(); };
+        } else {
+            socket.on_ready_to_read = move(schedule_removal);
+        }
+    }
+
+    static void stop_watching_idle_connection(SocketType& socket)
+    {
+        if constexpr (IsSame<SocketType, TLS::TLSv12>) {
+            socket.on_tls_ready_to_read = nullptr;
+            socket.on_tls_finished = nullptr;
+            socket.on_tls_error = nullptr;
+        } else {
+            socket.on_ready_to_read = nullptr;
+        }
+    }
+
+    HashMap<String, Origin> m_origins;
+};
+
+}
@@ -8,7 +8,11 @@
 
 namespace RequestServer {
 
+class CachedRequest;
+class CachedResponse;
+class CachingOutputStream;
 class ClientConnection;
+class HttpCache;
 class Request;
 class GeminiProtocol;
 class HttpRequest;
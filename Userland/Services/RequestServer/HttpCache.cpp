@@ -0,0 +1,470 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/StringBuilder.h>
+#include <LibCore/DateTime.h>
+#include <LibCore/File.h>
+#include <RequestServer/HttpCache.h>
+#include <stdio.h>
+#include <unistd.h>
+
+namespace RequestServer {
+
+// Bump the version whenever the layout written by write_to_disk() changes, so stale files are ignored rather than misread.
+static constexpr StringView disk_format_magic = "RequestServer HTTP cache 1";
+
+static Optional<String> find_header(HashMap<String, String> const& headers, StringView const& name)
+{
+    for (auto& it : headers) {
+        if (it.key.equals_ignoring_case(name))
+            return it.value;
+    }
+    return {};
+}
+
+// RFC 7234, 5.2: Maps the lowercased directive names to their (unquoted) arguments.
+static HashMap<String, String> parse_cache_control(Optional<String> const& value)
+{
+    HashMap<String, String> directives;
+    if (!value.has_value())
+        return directives;
+    for (auto& part : value->split_view(',')) {
+        auto directive = part.trim_whitespace();
+        if (directive.is_empty())
+            continue;
+        auto equals = directive.find('=');
+        if (!equals.has_value()) {
+            directives.set(directive.to_lowercase_string(), {});
+            continue;
+        }
+        auto argument = directive.substring_view(*equals + 1).trim_whitespace();
+        if (argument.length() >= 2 && argument.starts_with('"') && argument.ends_with('"'))
+            argument = argument.substring_view(1, argument.length() - 2);
+        directives.set(directive.substring_view(0, *equals).trim_whitespace().to_lowercase_string(), argument);
+    }
+    return directives;
+}
+
+static Optional<time_t> seconds_directive(HashMap<String, String> const& directives, StringView const& name)
+{
+    auto argument = directives.get(name);
+    if (!argument.has_value())
+        return {};
+    auto seconds = argument->to_uint<u64>();
+    if (!seconds.has_value())
+        return {};
+    return static_cast<time_t>(*seconds);
+}
+
+// RFC 7231, 7.1.1.1: Only the preferred IMF-fixdate format is understood, anything else counts as an invalid date.
+static Optional<time_t> parse_http_date(Optional<String> const& value)
+{
+    if (!value.has_value())
+        return {};
+    auto date = Core::DateTime::parse("%a, %d %b %Y %H:%M:%S GMT", value.value());
+    if (!date.has_value())
+        return {};
+    return date->timestamp();
+}
+
+// RFC 7231, 6.1: The status codes that are cacheable by default.
+static bool is_heuristically_cacheable(u32 status_code)
+{
+    switch (status_code) {
+    case 200:
+    case 203:
+    case 204:
+    case 300:
+    case 301:
+    case 404:
+    case 405:
+    case 410:
+    case 414:
+    case 501:
+        return true;
+    default:
+        return false;
+    }
+}
+
+CachedResponse::CachedResponse(URL url, u32 status_code, HashMap<String, String, CaseInsensitiveStringTraits> response_headers, HashMap<String, String, CaseInsensitiveStringTraits> varying_request_headers, ByteBuffer body, time_t request_time, time_t response_time)
+    : m_url(move(url))
+    , m_status_code(status_code)
+    , m_response_headers(move(response_headers))
+    , m_varying_request_headers(move(varying_request_headers))
+    , m_body(move(body))
+    , m_request_time(request_time)
+    , m_response_time(response_time)
+{
+}
+
+bool CachedResponse::matches_variant(HashMap<String, String> const& request_headers) const
+{
+    for (auto& it : m_varying_request_headers) {
+        if (find_header(request_headers, it.key).value_or("") != it.value)
+            return false;
+    }
+    return true;
+}
+
+time_t CachedResponse::freshness_lifetime() const
+{
+    auto directives = parse_cache_control(m_response_headers.get("Cache-Control"));
+    // This is a shared cache, so s-maxage takes precedence over max-age.
+    if (auto s_maxage = seconds_directive(directives, "s-maxage"); s_maxage.has_value())
+        return *s_maxage;
+    if (auto max_age = seconds_directive(directives, "max-age"); max_age.has_value())
+        return *max_age;
+
+    auto date = parse_http_date(m_response_headers.get("Date")).value_or(m_response_time);
+    if (m_response_headers.contains("Expires")) {
+        // Invalid dates, like "0", mean the response has already expired.
+        auto expires = parse_http_date(m_response_headers.get("Expires"));
+        if (!expires.has_value() || *expires <= date)
+            return 0;
+        return *expires - date;
+    }
+
+    // RFC 7234, 4.2.2: Without explicit freshness information, a tenth of the time since the last modification is the
+    // heuristic the RFC suggests.
+    if (is_heuristically_cacheable(m_status_code) || directives.contains("public")) {
+        auto last_modified = parse_http_date(m_response_headers.get("Last-Modified"));
+        if (last_modified.has_value() && *last_modified < date)
+            return (date - *last_modified) / 10;
+    }
+    return 0;
+}
+
+// RFC 7234, 4.2.3: Calculating Age
+time_t CachedResponse::current_age(time_t now) const
+{
+    auto date = parse_http_date(m_response_headers.get("Date")).value_or(m_response_time);
+    time_t age_value = 0;
+    if (auto age = m_response_headers.get("Age"); age.has_value())
+        age_value = age->to_uint<u64>().value_or(0);
+
+    auto apparent_age = max<time_t>(0, m_response_time - date);
+    auto response_delay = m_response_time - m_request_time;
+    auto corrected_age_value = age_value + response_delay;
+    auto corrected_initial_age = max(apparent_age, corrected_age_value);
+    auto resident_time = now - m_response_time;
+    return corrected_initial_age + resident_time;
+}
+
+bool CachedResponse::is_fresh_for(HashMap<String, String> const& request_headers, time_t now) const
+{
+    auto response_directives = parse_cache_control(m_response_headers.get("Cache-Control"));
+    if (response_directives.contains("no-cache"))
+        return false;
+
+    auto request_cache_control = find_header(request_headers, "Cache-Control");
+    auto request_directives = parse_cache_control(request_cache_control);
+    if (request_directives.contains("no-cache"))
+        return false;
+    // RFC 7234, 5.4: Pragma is only looked at when there is no Cache-Control.
+    if (!request_cache_control.has_value()) {
+        auto pragma = find_header(request_headers, "Pragma");
+        if (pragma.has_value() && pragma->contains("no-cache", CaseSensitivity::CaseInsensitive))
+            return false;
+    }
+
+    auto age = current_age(now);
+    auto lifetime = freshness_lifetime();
+    if (auto max_age = seconds_directive(request_directives, "max-age"); max_age.has_value() && age > *max_age)
+        return false;
+    if (auto min_fresh = seconds_directive(request_directives, "min-fresh"); min_fresh.has_value() && lifetime - age < *min_fresh)
+        return false;
+    // FIXME: Serve stale responses when the request allows it with max-stale.
+    return lifetime > age;
+}
+
+bool CachedResponse::has_validators() const
+{
+    return m_response_headers.contains("ETag") || m_response_headers.contains("Last-Modified");
+}
+
+void CachedResponse::add_validators_to(HashMap<String, String>& request_headers) const
+{
+    if (auto etag = m_response_headers.get("ETag"); etag.has_value())
+        request_headers.set("If-None-Match", *etag);
+    if (auto last_modified = m_response_headers.get("Last-Modified"); last_modified.has_value())
+        request_headers.set("If-Modified-Since", *last_modified);
+}
+
+void CachedResponse::update_from_not_modified_response(HashMap<String, String, CaseInsensitiveStringTraits> const& response_headers, time_t request_time, time_t response_time)
+{
+    for (auto& it : response_headers) {
+        // These describe the (empty) message that carried the 304, not the stored response.
+        if (it.key.equals_ignoring_case("Content-Length") || it.key.equals_ignoring_case("Transfer-Encoding") || it.key.equals_ignoring_case("Connection"))
+            continue;
+        m_response_headers.set(it.key, it.value);
+    }
+    m_request_time = request_time;
+    m_response_time = response_time;
+}
+
+HttpCache& HttpCache::the()
+{
+    static HttpCache cache;
+    return cache;
+}
+
+bool HttpCache::is_storable(String const& method, HashMap<String, String> const& request_headers, u32 status_code, HashMap<String, String, CaseInsensitiveStringTraits> const& response_headers)
+{
+    if (!method.equals_ignoring_case("GET"))
+        return false;
+    // Partial content would have to be combined with the other ranges, which we don't do.
+    if (status_code < 200 || status_code == 206 || status_code == 304)
+        return false;
+
+    auto request_directives = parse_cache_control(find_header(request_headers, "Cache-Control"));
+    auto response_directives = parse_cache_control(response_headers.get("Cache-Control"));
+    if (request_directives.contains("no-store") || response_directives.contains("no-store"))
+        return false;
+    if (response_directives.contains("private"))
+        return false;
+    // RFC 7234, 3.2: Responses to authenticated requests can only be shared if the origin server says so.
+    if (find_header(request_headers, "Authorization").has_value()
+        && !response_directives.contains("must-revalidate") && !response_directives.contains("public") && !response_directives.contains("s-maxage"))
+        return false;
+
+    auto vary = response_headers.get("Vary");
+    if (vary.has_value() && vary->trim_whitespace() == "*")
+        return false;
+
+    return response_headers.contains("Expires")
+        || response_directives.contains("max-age")
+        || response_directives.contains("s-maxage")
+        || response_directives.contains("public")
+        || is_heuristically_cacheable(status_code);
+}
+
+RefPtr<CachedResponse> HttpCache::lookup(String const& method, URL const& url, HashMap<String, String> const& request_headers)
+{
+    if (!method.equals_ignoring_case("GET"))
+        return {};
+    // Conditional and range requests are the client's own business, so they always go to the origin server.
+    for (auto name : { "If-Match", "If-None-Match", "If-Modified-Since", "If-Unmodified-Since", "If-Range", "Range" }) {
+        if (find_header(request_headers, name).has_value())
+            return {};
+    }
+
+    auto key = url.to_string();
+    RefPtr<CachedResponse> response;
+    if (auto it = m_responses.find(key); it != m_responses.end()) {
+        response = it->value;
+    } else {
+        response = read_from_disk(key);
+        if (response)
+            add_to_memory(*response);
+    }
+    if (!response || !response->matches_variant(request_headers))
+        return {};
+
+    response->set_last_used(++m_use_counter);
+    return response;
+}
+
+void HttpCache::store(String const& method, URL const& url, HashMap<String, String> const& request_headers, u32 status_code, HashMap<String, String, CaseInsensitiveStringTraits> const& response_headers, ByteBuffer body, time_t request_time, time_t response_time)
+{
+    if (!is_storable(method, request_headers, status_code, response_headers) || body.size() > max_entry_size)
+        return;
+
+    HashMap<String, String, CaseInsensitiveStringTraits> varying_request_headers;
+    if (auto vary = response_headers.get("Vary"); vary.has_value()) {
+        for (auto& part : vary->split_view(',')) {
+            auto name = part.trim_whitespace();
+            if (!name.is_empty())
+                varying_request_headers.set(name, find_header(request_headers, name).value_or(""));
+        }
+    }
+
+    auto response = CachedResponse::create(url, status_code, response_headers, move(varying_request_headers), move(body), request_time, response_time);
+    // A response that is never fresh and can't be revalidated would never be used.
+    if (response->freshness_lifetime() == 0 && !response->has_validators())
+        return;
+
+    dbgln_if(HTTP_CACHE_DEBUG, "HttpCache: Storing {} ({} bytes)", url, response->body().size());
+    write_to_disk(url.to_string(), *response);
+    add_to_memory(move(response));
+}
+
+void HttpCache::did_revalidate(CachedResponse& response, HashMap<String, String, CaseInsensitiveStringTraits> const& response_headers, time_t request_time, time_t response_time)
+{
+    dbgln_if(HTTP_CACHE_DEBUG, "HttpCache: {} was not modified", response.url());
+    response.update_from_not_modified_response(response_headers, request_time, response_time);
+    write_to_disk(response.url().to_string(), response);
+}
+
+void HttpCache::invalidate(URL const& url)
+{
+    auto key = url.to_string();
+    remove_from_memory(key);
+    if (!m_directory.is_null())
+        unlink(path_for(key).characters());
+}
+
+void HttpCache::add_to_memory(NonnullRefPtr<CachedResponse> response)
+{
+    auto key = response->url().to_string();
+    remove_from_memory(key);
+    response->set_last_used(++m_use_counter);
+    m_memory_size += response->body().size();
+    m_responses.set(key, move(response));
+
+    // Evict the least recently used responses. They stay on disk, so they can still be read back later.
+    while (m_memory_size > max_memory_size) {
+        String least_recently_used_key;
+        size_t least_recently_used = NumericLimits<size_t>::max();
+        for (auto& it : m_responses) {
+            if (it.value->last_used() < least_recently_used) {
+                least_recently_used = it.value->last_used();
+                least_recently_used_key = it.key;
+            }
+        }
+        remove_from_memory(least_recently_used_key);
+    }
+}
+
+void HttpCache::remove_from_memory(String const& key)
+{
+    auto it = m_responses.find(key);
+    if (it == m_responses.end())
+        return;
+    m_memory_size -= it->value->body().size();
+    m_responses.remove(it);
+}
+
+String HttpCache::path_for(String const& key) const
+{
+    return String::formatted("{}/{:08x}", m_directory, key.hash());
+}
+
+RefPtr<CachedResponse> HttpCache::read_from_disk(String const& key) const
+{
+    if (m_directory.is_null())
+        return {};
+    auto file_or_error = Core::File::open(path_for(key), Core::OpenMode::ReadOnly);
+    if (file_or_error.is_error())
+        return {};
+    auto contents = file_or_error.value()->read_all();
+    StringView view { reinterpret_cast<char const*>(contents.data()), contents.size() };
+
+    size_t offset = 0;
+    auto read_line = [&]() -> Optional<StringView> {
+        auto newline = view.find('\n', offset);
+        if (!newline.has_value())
+            return {};
+        auto line = view.substring_view(offset, *newline - offset);
+        offset = *newline + 1;
+        return line;
+    };
+    auto read_headers = [&](auto& headers) {
+        for (;;) {
+            auto line = read_line();
+            if (!line.has_value())
+                return false;
+            if (line->is_empty())
+                return true;
+            auto separator = line->find(": ");
+            if (!separator.has_value())
+                return false;
+            headers.set(line->substring_view(0, *separator), line->substring_view(*separator + 2));
+        }
+    };
+
+    auto magic = read_line();
+    if (!magic.has_value() || *magic != disk_format_magic)
+        return {};
+    // Different URLs can end up with the same file name.
+    auto url = read_line();
+    if (!url.has_value() || *url != key)
+        return {};
+    auto status_and_times = read_line();
+    if (!status_and_times.has_value())
+        return {};
+    auto parts = status_and_times->split_view(' ');
+    if (parts.size() != 3)
+        return {};
+    auto status_code = parts[0].to_uint();
+    auto request_time = parts[1].to_uint<u64>();
+    auto response_time = parts[2].to_uint<u64>();
+    if (!status_code.has_value() || !request_time.has_value() || !response_time.has_value())
+        return {};
+
+    HashMap<String, String, CaseInsensitiveStringTraits> response_headers;
+    HashMap<String, String, CaseInsensitiveStringTraits> varying_request_headers;
+    if (!read_headers(response_headers) || !read_headers(varying_request_headers))
+        return {};
+
+    auto body = ByteBuffer::copy(contents.bytes().slice(offset));
+    return CachedResponse::create(key, *status_code, move(response_headers), move(varying_request_headers), move(body), *request_time, *response_time);
+}
+
+void HttpCache::write_to_disk(String const& key, CachedResponse const& response) const
+{
+    if (m_directory.is_null())
+        return;
+
+    StringBuilder builder;
+    builder.append(disk_format_magic);
+    builder.append('\n');
+    builder.append(key);
+    builder.append('\n');
+    builder.appendff("{} {} {}\n", response.status_code(), static_cast<u64>(response.request_time()), static_cast<u64>(response.response_time()));
+    for (auto& it : response.response_headers())
+        builder.appendff("{}: {}\n", it.key, it.value);
+    builder.append('\n');
+    for (auto& it : response.varying_request_headers())
+        builder.appendff("{}: {}\n", it.key, it.value);
+    builder.append('\n');
+    auto header = builder.to_byte_buffer();
+
+    // Write to a temporary file and rename it into place, so other processes never read a partially written response.
+    auto path = path_for(key);
+    auto temporary_path = String::formatted("{}.{}", path, getpid());
+    auto file_or_error = Core::File::open(temporary_path, (Core::OpenMode)(Core::OpenMode::WriteOnly | Core::OpenMode::Truncate));
+    if (file_or_error.is_error()) {
+        dbgln("HttpCache: Unable to open {}: {}", temporary_path, file_or_error.error());
+        return;
+    }
+    auto& file = *file_or_error.value();
+    if (!file.write(header.data(), header.size()) || !file.write(response.body().data(), response.body().size()) || rename(temporary_path.characters(), path.characters()) < 0) {
+        dbgln("HttpCache: Unable to write {}", path);
+        unlink(temporary_path.characters());
+    }
+}
+
+size_t CachingOutputStream::write(ReadonlyBytes bytes)
+{
+    auto nwritten = m_stream.write(bytes);
+    if (m_is_recording) {
+        if (m_recorded_bytes.size() + nwritten > HttpCache::max_entry_size)
+            stop_recording();
+        else
+            m_recorded_bytes.append(bytes.data(), nwritten);
+    }
+    return nwritten;
+}
+
+bool CachingOutputStream::write_or_error(ReadonlyBytes bytes)
+{
+    auto nwritten = write(bytes);
+    if (nwritten < bytes.size()) {
+        set_recoverable_error();
+        return false;
+    }
+    return true;
+}
+
+void CachingOutputStream::stop_recording()
+{
+    m_is_recording = false;
+    m_recorded_bytes.clear();
+}
+
+}
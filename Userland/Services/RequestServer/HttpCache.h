@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/RefCounted.h>
+#include <AK/Stream.h>
+#include <AK/String.h>
+#include <AK/URL.h>
+#include <time.h>
+
+namespace RequestServer {
+
+// A response stored in the HTTP cache, along with what RFC 7234 needs to decide whether it can be reused.
+class CachedResponse : public RefCounted<CachedResponse> {
+public:
+    static NonnullRefPtr<CachedResponse> create(URL url, u32 status_code, HashMap<String, String, CaseInsensitiveStringTraits> response_headers, HashMap<String, String, CaseInsensitiveStringTraits> varying_request_headers, ByteBuffer body, time_t request_time, time_t response_time)
+    {
+        return adopt_ref(*new CachedResponse(move(url), status_code, move(response_headers), move(varying_request_headers), move(body), request_time, response_time));
+    }
+
+    URL const& url() const { return m_url; }
+    u32 status_code() const { return m_status_code; }
+    HashMap<String, String, CaseInsensitiveStringTraits> const& response_headers() const { return m_response_headers; }
+    HashMap<String, String, CaseInsensitiveStringTraits> const& varying_request_headers() const { return m_varying_request_headers; }
+    ByteBuffer const& body() const { return m_body; }
+    time_t request_time() const { return m_request_time; }
+    time_t response_time() const { return m_response_time; }
+
+    // RFC 7234, 4.1: Whether the request selects the same variant as the one this response was stored for.
+    bool matches_variant(HashMap<String, String> const& request_headers) const;
+
+    // RFC 7234, 4.2: Whether this response can be used without contacting the origin server.
+    bool is_fresh_for(HashMap<String, String> const& request_headers, time_t now) const;
+
+    // RFC 7234, 4.2.1: How long this response stays fresh after it was generated.
+    time_t freshness_lifetime() const;
+
+    // RFC 7232: Whether the origin server can be asked to confirm this response is still current.
+    bool has_validators() const;
+    void add_validators_to(HashMap<String, String>& request_headers) const;
+
+    // RFC 7234, 4.3.4: Freshens the stored response with the headers of a 304 (Not Modified) response.
+    void update_from_not_modified_response(HashMap<String, String, CaseInsensitiveStringTraits> const& response_headers, time_t request_time, time_t response_time);
+
+    size_t last_used() const { return m_last_used; }
+    void set_last_used(size_t last_used) { m_last_used = last_used; }
+
+private:
+    CachedResponse(URL, u32 status_code, HashMap<String, String, CaseInsensitiveStringTraits> response_headers, HashMap<String, String, CaseInsensitiveStringTraits> varying_request_headers, ByteBuffer body, time_t request_time, time_t response_time);
+
+    time_t current_age(time_t now) const;
+
+    URL m_url;
+    u32 m_status_code { 0 };
+    HashMap<String, String, CaseInsensitiveStringTraits> m_response_headers;
+    HashMap<String, String, CaseInsensitiveStringTraits> m_varying_request_headers;
+    ByteBuffer m_body;
+    time_t m_request_time { 0 };
+    time_t m_response_time { 0 };
+    size_t m_last_used { 0 };
+};
+
+// A shared cache (in the sense of RFC 7234) for everything fetched over HTTP(S).
+// Responses are kept in memory, and written to disk so that the other RequestServer processes (one per client) can
+// reuse them too.
+class HttpCache {
+public:
+    static HttpCache& the();
+
+    static constexpr size_t max_memory_size = 32 * MiB;
+    static constexpr size_t max_entry_size = 4 * MiB;
+
+    // RFC 7234, 3: Whether a response may be stored at all.
+    static bool is_storable(String const& method, HashMap<String, String> const& request_headers, u32 status_code, HashMap<String, String, CaseInsensitiveStringTraits> const& response_headers);
+
+    // Responses are only ever written to disk if a directory is set.
+    void set_directory(String directory) { m_directory = move(directory); }
+
+    RefPtr<CachedResponse> lookup(String const& method, URL const&, HashMap<String, String> const& request_headers);
+    void store(String const& method, URL const&, HashMap<String, String> const& request_headers, u32 status_code, HashMap<String, String, CaseInsensitiveStringTraits> const& response_headers, ByteBuffer body, time_t request_time, time_t response_time);
+    void did_revalidate(CachedResponse&, HashMap<String, String, CaseInsensitiveStringTraits> const& response_headers, time_t request_time, time_t response_time);
+
+    // RFC 7234, 4.4: Responses are invalidated by unsafe requests to the same URL.
+    void invalidate(URL const&);
+
+private:
+    HttpCache() = default;
+
+    void add_to_memory(NonnullRefPtr<CachedResponse>);
+    void remove_from_memory(String const& key);
+
+    String path_for(String const& key) const;
+    RefPtr<CachedResponse> read_from_disk(String const& key) const;
+    void write_to_disk(String const& key, CachedResponse const&) const;
+
+    HashMap<String, NonnullRefPtr<CachedResponse>> m_responses;
+    size_t m_memory_size { 0 };
+    size_t m_use_counter { 0 };
+    String m_directory;
+};
+
+// Passes everything written to it on to the request's pipe, and keeps a copy of what was passed on for the cache.
+class CachingOutputStream final : public OutputStream {
+public:
+    explicit CachingOutputStream(OutputStream& stream)
+        : m_stream(stream)
+    {
+    }
+
+    virtual size_t write(ReadonlyBytes) override;
+    virtual bool write_or_error(ReadonlyBytes) override;
+
+    bool is_recording() const { return m_is_recording; }
+    void stop_recording();
+    ByteBuffer take_recorded_bytes() { return move(m_recorded_bytes); }
+
+private:
+    OutputStream& m_stream;
+    ByteBuffer m_recorded_bytes;
+    bool m_is_recording { true };
+};
+
+}
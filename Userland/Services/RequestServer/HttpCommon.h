@@ -14,8 +14,12 @@
 #include <AK/String.h>
 #include <AK/Types.h>
 #include <LibHTTP/HttpRequest.h>
+#include <RequestServer/CachedRequest.h>
 #include <RequestServer/ClientConnection.h>
+#include <RequestServer/ConnectionCache.h>
+#include <RequestServer/HttpCache.h>
 #include <RequestServer/Request.h>
+#include <time.h>
 
 namespace RequestServer::Detail {
 
@@ -57,26 +61,48 @@ OwnPtr<Request> start_request(TBadgedProtocol&& protocol, ClientConnection& clie
 {
     using TJob = typename TBadgedProtocol::Type::JobType;
     using TRequest = typename TBadgedProtocol::Type::RequestType;
+    using TSocket = typename TBadgedProtocol::Type::SocketType;
 
     if (pipe_result.is_error()) {
         return {};
     }
 
+    auto output_stream = make<OutputFileStream>(pipe_result.value().write_fd);
+    output_stream->make_unbuffered();
+
+    auto request_time = time(nullptr);
+    auto cached_response = HttpCache::the().lookup(method, url, headers);
+    if (cached_response && cached_response->is_fresh_for(headers, request_time)) {
+        auto cached_request = CachedRequest::create(client, cached_response.release_nonnull(), move(output_stream));
+        cached_request->set_request_fd(pipe_result.value().read_fd);
+        return cached_request;
+    }
+
     HTTP::HttpRequest request;
-    if (method.equals_ignoring_case("post"))
+    if (method.equals_ignoring_case("post")) {
         request.set_method(HTTP::HttpRequest::Method::POST);
-    else
+        HttpCache::the().invalidate(url);
+    } else {
         request.set_method(HTTP::HttpRequest::Method::GET);
+    }
     request.set_url(url);
-    request.set_headers(headers);
+    if (cached_response && cached_response->has_validators()) {
+        auto conditional_headers = headers;
+        cached_response->add_validators_to(conditional_headers);
+        request.set_headers(conditional_headers);
+    } else {
+        cached_response = nullptr;
+        request.set_headers(headers);
+    }
     request.set_body(body);
 
-    auto output_stream = make<OutputFileStream>(pipe_result.value().write_fd);
-    output_stream->make_unbuffered();
-    auto job = TJob::construct(request, *output_stream);
+    auto caching_output_stream = make<CachingOutputStream>(*output_stream);
+    auto job = TJob::construct(request, *caching_output_stream);
     auto protocol_request = TRequest::create_with_job(forward<TBadgedProtocol>(protocol), client, (TJob&)*job, move(output_stream));
     protocol_request->set_request_fd(pipe_result.value().read_fd);
-    job->start();
+    protocol_request->set_cache_context(method, url, headers, request_time, move(cached_response));
+    protocol_request->set_caching_output_stream(move(caching_output_stream));
+    ConnectionCache<TJob, TSocket>::the().start_job(url, *job);
     return protocol_request;
 }
 
@@ -12,6 +12,7 @@
 #include <AK/String.h>
 #include <AK/URL.h>
 #include <LibHTTP/HttpJob.h>
+#include <LibCore/TCPSocket.h>
 #include <RequestServer/ClientConnection.h>
 #include <RequestServer/HttpRequest.h>
 #include <RequestServer/Protocol.h>
@@ -23,6 +24,7 @@ class HttpProtocol final : public Protocol {
 public:
     using JobType = HTTP::HttpJob;
     using RequestType = HttpRequest;
+    using SocketType = Core::TCPSocket;
 
     HttpProtocol();
     ~HttpProtocol() override = default;
@@ -12,6 +12,7 @@
 #include <AK/String.h>
 #include <AK/URL.h>
 #include <LibHTTP/HttpsJob.h>
+#include <LibTLS/TLSv12.h>
 #include <RequestServer/ClientConnection.h>
 #include <RequestServer/HttpsRequest.h>
 #include <RequestServer/Protocol.h>
@@ -23,6 +24,7 @@ class HttpsProtocol final : public Protocol {
 public:
     using JobType = HTTP::HttpsJob;
     using RequestType = HttpsRequest;
+    using SocketType = TLS::TLSv12;
 
     HttpsProtocol();
     ~HttpsProtocol() override = default;
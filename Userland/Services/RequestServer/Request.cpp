@@ -5,6 +5,7 @@
  */
 
 #include <AK/Badge.h>
+#include <LibCore/Timer.h>
 #include <RequestServer/ClientConnection.h>
 #include <RequestServer/Request.h>
 
@@ -29,9 +30,31 @@ void Request::stop()
     m_client.did_finish_request({}, *this, false);
 }
 
+void Request::set_cache_context(String method, URL const& url, HashMap<String, String> request_headers, time_t request_time, RefPtr<CachedResponse> response_being_revalidated)
+{
+    m_method = move(method);
+    m_url = url;
+    m_request_headers = move(request_headers);
+    m_request_time = request_time;
+    m_response_being_revalidated = move(response_being_revalidated);
+}
+
 void Request::set_response_headers(const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers)
 {
-    m_response_headers = response_headers;
+    if (m_response_being_revalidated && m_status_code.has_value() && *m_status_code == 304) {
+        // Headers can be received more than once, but the stored response only needs to be freshened the first time.
+        if (!m_was_not_modified) {
+            HttpCache::the().did_revalidate(*m_response_being_revalidated, response_headers, m_request_time, time(nullptr));
+            m_was_not_modified = true;
+        }
+        // The client didn't make a conditional request, so it gets the stored response instead of the 304.
+        m_status_code = m_response_being_revalidated->status_code();
+        m_response_headers = m_response_being_revalidated->response_headers();
+    } else {
+        m_response_headers = response_headers;
+        if (m_caching_output_stream && (m_method.is_null() || !m_status_code.has_value() || !HttpCache::is_storable(m_method, m_request_headers, *m_status_code, m_response_headers)))
+            m_caching_output_stream->stop_recording();
+    }
     m_client.did_receive_headers({}, *this);
 }
 
@@ -41,9 +64,43 @@ void Request::set_certificate(String, String)
 
 void Request::did_finish(bool success)
 {
+    if (success && m_was_not_modified) {
+        m_cached_response_being_sent = m_response_being_revalidated;
+        send_cached_body();
+        return;
+    }
+    if (success && m_caching_output_stream && m_caching_output_stream->is_recording() && m_status_code.has_value())
+        HttpCache::the().store(m_method, m_url, m_request_headers, *m_status_code, m_response_headers, m_caching_output_stream->take_recorded_bytes(), m_request_time, time(nullptr));
     m_client.did_finish_request({}, *this, success);
 }
 
+void Request::send_cached_response(NonnullRefPtr<CachedResponse> response)
+{
+    m_status_code = response->status_code();
+    m_response_headers = response->response_headers();
+    m_client.did_receive_headers({}, *this);
+    m_cached_response_being_sent = move(response);
+    send_cached_body();
+}
+
+void Request::send_cached_body()
+{
+    auto& body = m_cached_response_being_sent->body();
+    m_cached_body_offset += m_output_stream->write(body.bytes().slice(m_cached_body_offset));
+    if (m_cached_body_offset < body.size()) {
+        // The pipe is full, so try again once the client had a chance to read from it, like HTTP::Job does.
+        if (!m_cached_body_timer)
+            m_cached_body_timer = Core::Timer::create_repeating(50, [this] { send_cached_body(); });
+        if (!m_cached_body_timer->is_active())
+            m_cached_body_timer->start();
+        return;
+    }
+    if (m_cached_body_timer)
+        m_cached_body_timer->stop();
+    did_progress(body.size(), body.size());
+    m_client.did_finish_request({}, *this, true);
+}
+
 void Request::did_progress(Optional<u32> total_size, u32 downloaded_size)
 {
     m_total_size = total_size;
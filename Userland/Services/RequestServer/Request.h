@@ -12,7 +12,9 @@
 #include <AK/Optional.h>
 #include <AK/RefCounted.h>
 #include <AK/URL.h>
+#include <LibCore/Forward.h>
 #include <RequestServer/Forward.h>
+#include <RequestServer/HttpCache.h>
 
 namespace RequestServer {
 
@@ -43,10 +45,19 @@ public:
     void set_downloaded_size(size_t size) { m_downloaded_size = size; }
     const OutputFileStream& output_stream() const { return *m_output_stream; }
 
+    // Lets the HTTP cache store the response, or use it to revalidate a response it already has.
+    void set_cache_context(String method, URL const&, HashMap<String, String> request_headers, time_t request_time, RefPtr<CachedResponse> response_being_revalidated);
+    void set_caching_output_stream(NonnullOwnPtr<CachingOutputStream>&& stream) { m_caching_output_stream = move(stream); }
+
 protected:
     explicit Request(ClientConnection&, NonnullOwnPtr<OutputFileStream>&&);
 
+    // Sends the response's headers and body to the client as if they had just been received, then finishes the request.
+    void send_cached_response(NonnullRefPtr<CachedResponse>);
+
 private:
+    void send_cached_body();
+
     ClientConnection& m_client;
     i32 m_id { 0 };
     int m_request_fd { -1 }; // Passed to client.
@@ -56,6 +67,16 @@ private:
     size_t m_downloaded_size { 0 };
     NonnullOwnPtr<OutputFileStream> m_output_stream;
     HashMap<String, String, CaseInsensitiveStringTraits> m_response_headers;
+
+    String m_method;
+    HashMap<String, String> m_request_headers;
+    time_t m_request_time { 0 };
+    OwnPtr<CachingOutputStream> m_caching_output_stream;
+    RefPtr<CachedResponse> m_response_being_revalidated;
+    bool m_was_not_modified { false };
+    RefPtr<CachedResponse> m_cached_response_being_sent;
+    size_t m_cached_body_offset { 0 };
+    RefPtr<Core::Timer> m_cached_body_timer;
 };
 
 }
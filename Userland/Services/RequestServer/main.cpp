@@ -6,16 +6,20 @@
 
 #include <LibCore/EventLoop.h>
 #include <LibCore/LocalServer.h>
+#include <LibCore/StandardPaths.h>
 #include <LibIPC/ClientConnection.h>
 #include <LibTLS/Certificate.h>
 #include <RequestServer/ClientConnection.h>
 #include <RequestServer/GeminiProtocol.h>
+#include <RequestServer/HttpCache.h>
 #include <RequestServer/HttpProtocol.h>
 #include <RequestServer/HttpsProtocol.h>
+#include <errno.h>
+#include <sys/stat.h>
 
 int main(int, char**)
 {
-    if (pledge("stdio inet accept unix rpath sendfd recvfd", nullptr) < 0) {
+    if (pledge("stdio inet accept unix rpath wpath cpath sendfd recvfd", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -23,9 +27,15 @@ int main(int, char**)
     // Ensure the certificates are read out here.
     [[maybe_unused]] auto& certs = DefaultRootCACertificates::the();
 
+    // The on-disk part of the HTTP cache is shared by all RequestServer processes of the user.
+    auto home_directory = Core::StandardPaths::home_directory();
+    auto cache_directory = String::formatted("{}/.cache/RequestServer", home_directory);
+    mkdir(String::formatted("{}/.cache", home_directory).characters(), 0700);
+    bool has_cache_directory = mkdir(cache_directory.characters(), 0700) == 0 || errno == EEXIST;
+
     Core::EventLoop event_loop;
     // FIXME: Establish a connection to LookupServer and then drop "unix"?
-    if (pledge("stdio inet accept unix sendfd recvfd", nullptr) < 0) {
+    if (pledge("stdio inet accept unix rpath wpath cpath sendfd recvfd", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -33,6 +43,13 @@ int main(int, char**)
         perror("unveil");
         return 1;
     }
+    if (has_cache_directory) {
+        if (unveil(cache_directory.characters(), "rwc") < 0) {
+            perror("unveil");
+            return 1;
+        }
+        RequestServer::HttpCache::the().set_directory(cache_directory);
+    }
     if (unveil(nullptr, nullptr) < 0) {
         perror("unveil");
         return 1;
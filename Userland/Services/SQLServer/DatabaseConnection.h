@@ -19,6 +19,7 @@ class DatabaseConnection final : public Core::Object {
     static RefPtr<DatabaseConnection> connection_for(int connection_id);
     int connection_id() const { return m_connection_id; }
     int client_id() const { return m_client_id; }
+    String const& database_name() const { return m_database_name; }
     RefPtr<SQL::Database> database() { return m_database; }
     void disconnect();
     int sql_statement(String const& sql);
@@ -71,19 +71,33 @@ void SQLStatement::execute()
             report_error(m_result->error());
             return;
         }
-        auto client_connection = ClientConnection::client_connection_for(connection()->client_id());
-        if (!client_connection) {
-            warnln("Cannot return statement execution results. Client disconnected");
-            return;
-        }
-        client_connection->async_execution_success(statement_id(), m_result->has_results(), m_result->updated(), m_result->inserted(), m_result->deleted());
-        if (m_result->has_results()) {
-            m_index = 0;
-            next();
-        }
+
+        // Success is only reported once the statement's changes are on disk. Statements that finish in the same
+        // event loop iteration share the sync.
+        connection()->database()->commit([this, protector = NonnullRefPtr(*this)](bool success) {
+            if (!success) {
+                report_error({ SQL::SQLErrorCode::CommitFailed, connection()->database_name() });
+                return;
+            }
+            did_execute();
+        });
     });
 }
 
+void SQLStatement::did_execute()
+{
+    auto client_connection = ClientConnection::client_connection_for(connection()->client_id());
+    if (!client_connection) {
+        warnln("Cannot return statement execution results. Client disconnected");
+        return;
+    }
+    client_connection->async_execution_success(statement_id(), m_result->has_results(), m_result->updated(), m_result->inserted(), m_result->deleted());
+    if (m_result->has_results()) {
+        m_index = 0;
+        next();
+    }
+}
+
 Optional<SQL::SQLError> SQLStatement::parse()
 {
     auto parser = SQL::AST::Parser(SQL::AST::Lexer(m_sql));
@@ -29,6 +29,7 @@ class SQLStatement final : public Core::Object {
 private:
     SQLStatement(DatabaseConnection&, String sql);
     Optional<SQL::SQLError> parse();
+    void did_execute();
     void next();
     void report_error(SQL::SQLError);
 
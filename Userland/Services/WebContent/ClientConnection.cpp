@@ -36,6 +36,8 @@ ClientConnection::ClientConnection(NonnullRefPtr<Core::LocalSocket> socket, int
     , m_page_host(PageHost::create(*this))
 {
     s_connections.set(client_id, *this);
+    // A single layout or paint can send the client lots of small notifications.
+    set_batches_messages(true);
     m_paint_flush_timer = Core::Timer::create_single_shot(0, [this] { flush_pending_paint_requests(); });
 }
 
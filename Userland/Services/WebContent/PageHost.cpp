@@ -15,6 +15,37 @@
 
 namespace WebContent {
 
+static constexpr int tile_size = 256;
+
+static int tile_index(int coordinate)
+{
+    // Rounds towards negative infinity, so that every coordinate belongs to exactly one tile.
+    if (coordinate >= 0)
+        return coordinate / tile_size;
+    return (coordinate - tile_size + 1) / tile_size;
+}
+
+static u64 tile_key(int column, int row)
+{
+    return (static_cast<u64>(static_cast<u32>(column)) << 32) | static_cast<u32>(row);
+}
+
+static Gfx::IntRect tile_rect(int column, int row)
+{
+    return { column * tile_size, row * tile_size, tile_size, tile_size };
+}
+
+template<typename Callback>
+static void for_each_tile_in(const Gfx::IntRect& content_rect, Callback callback)
+{
+    if (content_rect.is_empty())
+        return;
+    for (int row = tile_index(content_rect.top()); row <= tile_index(content_rect.bottom()); ++row) {
+        for (int column = tile_index(content_rect.left()); column <= tile_index(content_rect.right()); ++column)
+            callback(column, row);
+    }
+}
+
 PageHost::PageHost(ClientConnection& client)
     : m_client(client)
     , m_page(make<Web::Page>(*this))
@@ -44,6 +75,13 @@ Gfx::Palette PageHost::palette() const
 void PageHost::set_palette_impl(const Gfx::PaletteImpl& impl)
 {
     m_palette_impl = impl;
+    m_tiles.clear();
+}
+
+void PageHost::set_should_show_line_box_borders(bool b)
+{
+    m_should_show_line_box_borders = b;
+    m_tiles.clear();
 }
 
 Web::Layout::InitialContainingBlockBox* PageHost::layout_root()
@@ -54,6 +92,64 @@ Web::Layout::InitialContainingBlockBox* PageHost::layout_root()
     return document->layout_node();
 }
 
+void PageHost::paint_into(Web::Layout::InitialContainingBlockBox& layout_root, const Gfx::IntRect& content_rect, Gfx::Bitmap& target)
+{
+    Gfx::Painter painter(target);
+    Web::PaintContext context(painter, palette(), content_rect.top_left());
+    context.set_should_show_line_box_borders(m_should_show_line_box_borders);
+    context.set_viewport_rect(content_rect);
+    layout_root.paint_all_phases(context);
+}
+
+void PageHost::paint_missing_tiles(Web::Layout::InitialContainingBlockBox& layout_root, const Gfx::IntRect& content_rect, Gfx::BitmapFormat format)
+{
+    Gfx::IntRect missing_rect;
+    for_each_tile_in(content_rect, [&](int column, int row) {
+        if (m_tiles.contains(tile_key(column, row)))
+            return;
+        missing_rect = missing_rect.is_empty() ? tile_rect(column, row) : missing_rect.united(tile_rect(column, row));
+    });
+    if (missing_rect.is_empty())
+        return;
+
+    // Walking the layout tree is what's expensive, so all missing tiles are painted in one go and cut up afterwards.
+    auto bitmap = Gfx::Bitmap::try_create(format, missing_rect.size());
+    if (!bitmap)
+        return;
+    Gfx::Painter(*bitmap).fill_rect(bitmap->rect(), Color::White);
+    paint_into(layout_root, missing_rect, *bitmap);
+
+    for_each_tile_in(missing_rect, [&](int column, int row) {
+        auto key = tile_key(column, row);
+        if (m_tiles.contains(key))
+            return;
+        if (auto tile = bitmap->cropped(tile_rect(column, row).translated(-missing_rect.location())))
+            m_tiles.set(key, tile.release_nonnull());
+    });
+}
+
+void PageHost::evict_tiles_far_from(const Gfx::IntRect& content_rect)
+{
+    // Keep the tiles one viewport away in every direction around, which is where scrolling will most likely go next.
+    auto kept_rect = content_rect.inflated(content_rect.width() * 2, content_rect.height() * 2);
+    Vector<u64> evicted_keys;
+    for (auto& it : m_tiles) {
+        auto column = static_cast<i32>(it.key >> 32);
+        auto row = static_cast<i32>(it.key & 0xffffffff);
+        if (!kept_rect.intersects(tile_rect(column, row)))
+            evicted_keys.append(it.key);
+    }
+    for (auto key : evicted_keys)
+        m_tiles.remove(key);
+}
+
+void PageHost::invalidate_tiles(const Gfx::IntRect& content_rect)
+{
+    for_each_tile_in(content_rect, [&](int column, int row) {
+        m_tiles.remove(tile_key(column, row));
+    });
+}
+
 void PageHost::paint(const Gfx::IntRect& content_rect, Gfx::Bitmap& target)
 {
     Gfx::Painter painter(target);
@@ -65,10 +161,22 @@ void PageHost::paint(const Gfx::IntRect& content_rect, Gfx::Bitmap& target)
         return;
     }
 
-    Web::PaintContext context(painter, palette(), content_rect.top_left());
-    context.set_should_show_line_box_borders(m_should_show_line_box_borders);
-    context.set_viewport_rect(content_rect);
-    layout_root->paint_all_phases(context);
+    // Fixed position boxes are painted relative to the viewport, so what a tile shows would depend on the scroll offset.
+    if (m_has_fixed_position_boxes) {
+        paint_into(*layout_root, content_rect, target);
+        return;
+    }
+
+    paint_missing_tiles(*layout_root, content_rect, target.format());
+
+    for_each_tile_in(content_rect, [&](int column, int row) {
+        auto tile = m_tiles.get(tile_key(column, row));
+        if (!tile.has_value())
+            return;
+        painter.blit(tile_rect(column, row).location() - content_rect.location(), *tile.value(), tile.value()->rect());
+    });
+
+    evict_tiles_far_from(content_rect);
 }
 
 void PageHost::set_viewport_rect(const Gfx::IntRect& rect)
@@ -78,11 +186,16 @@ void PageHost::set_viewport_rect(const Gfx::IntRect& rect)
 
 void PageHost::page_did_invalidate(const Gfx::IntRect& content_rect)
 {
+    invalidate_tiles(content_rect);
+    if (!page().top_level_browsing_context().viewport_rect().intersects(content_rect))
+        return;
     m_client.async_did_invalidate_content_rect(content_rect);
 }
 
 void PageHost::page_did_change_selection()
 {
+    // Selection changes don't invalidate the parts of the page they affect.
+    m_tiles.clear();
     m_client.async_did_change_selection();
 }
 
@@ -95,6 +208,17 @@ void PageHost::page_did_layout()
 {
     auto* layout_root = this->layout_root();
     VERIFY(layout_root);
+
+    // We don't know which parts of the page moved, so everything has to be painted again.
+    m_tiles.clear();
+    m_has_fixed_position_boxes = false;
+    layout_root->for_each_in_subtree_of_type<Web::Layout::Box>([&](auto& box) {
+        if (!box.is_fixed_position())
+            return IterationDecision::Continue;
+        m_has_fixed_position_boxes = true;
+        return IterationDecision::Break;
+    });
+
     auto content_size = enclosing_int_rect(layout_root->absolute_rect()).size();
     m_client.async_did_layout(content_size);
 }
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <AK/HashMap.h>
+#include <LibGfx/Bitmap.h>
 #include <LibGfx/Rect.h>
 #include <LibWeb/Page/Page.h>
 
@@ -30,7 +32,7 @@ public:
     void set_viewport_rect(const Gfx::IntRect&);
     void set_screen_rects(const Vector<Gfx::IntRect, 4>& rects, size_t main_screen_index) { m_screen_rect = rects[main_screen_index]; };
 
-    void set_should_show_line_box_borders(bool b) { m_should_show_line_box_borders = b; }
+    void set_should_show_line_box_borders(bool);
 
 private:
     // ^PageClient
@@ -67,11 +69,21 @@ private:
     Web::Layout::InitialContainingBlockBox* layout_root();
     void setup_palette();
 
+    void paint_into(Web::Layout::InitialContainingBlockBox&, const Gfx::IntRect& content_rect, Gfx::Bitmap&);
+    void paint_missing_tiles(Web::Layout::InitialContainingBlockBox&, const Gfx::IntRect& content_rect, Gfx::BitmapFormat);
+    void evict_tiles_far_from(const Gfx::IntRect& content_rect);
+    void invalidate_tiles(const Gfx::IntRect& content_rect);
+
     ClientConnection& m_client;
     NonnullOwnPtr<Web::Page> m_page;
     RefPtr<Gfx::PaletteImpl> m_palette_impl;
     Gfx::IntRect m_screen_rect;
     bool m_should_show_line_box_borders { false };
+
+    // Painted parts of the page, keyed by their column and row. Scrolling and small invalidations only repaint the
+    // tiles that have never been painted or were invalidated, the rest is copied over from here.
+    HashMap<u64, NonnullRefPtr<Gfx::Bitmap>> m_tiles;
+    bool m_has_fixed_position_boxes { false };
 };
 
 }
@@ -6,13 +6,13 @@
 
 #include <LibCore/EventLoop.h>
 #include <LibCore/LocalServer.h>
+#include <LibGfx/FontDatabase.h>
 #include <LibIPC/ClientConnection.h>
 #include <WebContent/ClientConnection.h>
 
 int main(int, char**)
 {
-    Core::EventLoop event_loop;
-    if (pledge("stdio recvfd sendfd accept unix rpath", nullptr) < 0) {
+    if (pledge("stdio recvfd sendfd accept unix rpath proc sigaction", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -37,6 +37,16 @@ int main(int, char**)
         return 1;
     }
 
+    // Every tab gets a fork of this process, which has already been linked and has loaded the fonts.
+    Gfx::FontDatabase::default_font();
+    Core::LocalSocket::fork_for_each_connection_from_system_server();
+
+    Core::EventLoop event_loop;
+    if (pledge("stdio recvfd sendfd accept unix rpath", nullptr) < 0) {
+        perror("pledge");
+        return 1;
+    }
+
     auto socket = Core::LocalSocket::take_over_accepted_socket_from_system_server();
     VERIFY(socket);
     IPC::new_client_connection<WebContent::ClientConnection>(socket.release_nonnull(), 1);
@@ -9,25 +9,29 @@
 #include <AK/Debug.h>
 #include <AK/LexicalPath.h>
 #include <AK/MappedFile.h>
-#include <AK/MemoryStream.h>
 #include <AK/QuickSort.h>
 #include <AK/StringBuilder.h>
 #include <AK/URL.h>
 #include <LibCore/DateTime.h>
 #include <LibCore/DirIterator.h>
 #include <LibCore/File.h>
-#include <LibCore/FileStream.h>
 #include <LibCore/MimeData.h>
 #include <LibHTTP/HttpRequest.h>
 #include <LibHTTP/HttpResponse.h>
 #include <WebServer/Client.h>
 #include <WebServer/Configuration.h>
+#include <errno.h>
+#include <poll.h>
 #include <stdio.h>
+#include <sys/sendfile.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
 namespace WebServer {
 
+static constexpr int keep_alive_timeout_ms = 15000;
+static constexpr int write_timeout_ms = 30000;
+
 Client::Client(NonnullRefPtr<Core::TCPSocket> socket, Core::Object* parent)
     : Core::Object(parent)
     , m_socket(socket)
@@ -44,20 +48,42 @@ void Client::die()
 
 void Client::start()
 {
+    // A connection that's kept alive is closed once it has been idle for a while.
+    m_idle_timer = Core::Timer::create_single_shot(
+        keep_alive_timeout_ms, [this] {
+            die();
+        },
+        this);
+    m_idle_timer->start();
+
     m_socket->on_ready_to_read = [this] {
-        StringBuilder builder;
-        for (;;) {
+        // A request may arrive in pieces, and the next one may arrive along with it; anything after the end of a
+        // request stays buffered in the socket until that one has been handled.
+        while (m_socket->can_read_line()) {
             auto line = m_socket->read_line();
-            if (line.is_empty())
+            if (line.is_null())
                 break;
-            builder.append(line);
-            builder.append("\r\n");
+            if (!line.is_empty()) {
+                m_request_builder.append(line);
+                m_request_builder.append("\r\n");
+                continue;
+            }
+            if (m_request_builder.is_empty())
+                continue;
+
+            auto request = m_request_builder.to_byte_buffer();
+            m_request_builder.clear();
+            dbgln_if(WEBSERVER_DEBUG, "Got raw request: '{}'", String::copy(request));
+            m_keep_alive = false;
+            handle_request(request);
+            if (!m_keep_alive) {
+                die();
+                return;
+            }
+            m_idle_timer->restart();
         }
-
-        auto request = builder.to_byte_buffer();
-        dbgln_if(WEBSERVER_DEBUG, "Got raw request: '{}'", String::copy(request));
-        handle_request(request);
-        die();
+        if (m_socket->eof())
+            die();
     };
 }
 
@@ -75,6 +101,12 @@ void Client::handle_request(ReadonlyBytes raw_request)
         }
     }
 
+    // We speak HTTP/1.0, where connections are only kept alive if the client asks for it.
+    for (auto& header : request.headers()) {
+        if (header.name.equals_ignoring_case("Connection"))
+            m_keep_alive = header.value.equals_ignoring_case("keep-alive");
+    }
+
     if (request.method() != HTTP::HttpRequest::Method::GET) {
         send_error_response(501, request);
         return;
@@ -131,12 +163,45 @@ void Client::handle_request(ReadonlyBytes raw_request)
         return;
     }
 
-    Core::InputFileStream stream { file };
+    send_file_response(file, request, Core::guess_mime_type_based_on_filename(real_path));
+}
+
+void Client::append_connection_header(StringBuilder& builder) const
+{
+    if (m_keep_alive)
+        builder.append("Connection: keep-alive\r\n");
+    else
+        builder.append("Connection: close\r\n");
+}
 
-    send_response(stream, request, Core::guess_mime_type_based_on_filename(real_path));
+bool Client::wait_until_writable()
+{
+    pollfd poll_fd { m_socket->fd(), POLLOUT, 0 };
+    for (;;) {
+        auto rc = poll(&poll_fd, 1, write_timeout_ms);
+        if (rc < 0 && errno == EINTR)
+            continue;
+        return rc > 0;
+    }
+}
+
+// The socket doesn't block, so a response that doesn't fit into its buffer has to wait for the client to catch up.
+bool Client::write_all(ReadonlyBytes bytes)
+{
+    while (!bytes.is_empty()) {
+        auto nwritten = ::write(m_socket->fd(), bytes.data(), bytes.size());
+        if (nwritten < 0) {
+            if (errno == EINTR || (errno == EAGAIN && wait_until_writable()))
+                continue;
+            perror("write");
+            return false;
+        }
+        bytes = bytes.slice(nwritten);
+    }
+    return true;
 }
 
-void Client::send_response(InputStream& response, HTTP::HttpRequest const& request, String const& content_type)
+void Client::send_response_headers(HTTP::HttpRequest const& request, String const& content_type, size_t content_length)
 {
     StringBuilder builder;
     builder.append("HTTP/1.0 200 OK\r\n");
@@ -147,19 +212,48 @@ void Client::send_response(InputStream& response, HTTP::HttpRequest const& reque
     builder.append("Content-Type: ");
     builder.append(content_type);
     builder.append("\r\n");
+    builder.appendff("Content-Length: {}\r\n", content_length);
+    append_connection_header(builder);
     builder.append("\r\n");
 
-    m_socket->write(builder.to_string());
+    write_all(builder.string_view().bytes());
     log_response(200, request);
+}
 
-    char buffer[PAGE_SIZE];
-    do {
-        auto size = response.read({ buffer, sizeof(buffer) });
-        if (response.unreliable_eof() && size == 0)
-            break;
+void Client::send_response(ReadonlyBytes response, HTTP::HttpRequest const& request, String const& content_type)
+{
+    send_response_headers(request, content_type, response.size());
+    if (!write_all(response))
+        m_keep_alive = false;
+}
 
-        m_socket->write({ buffer, size });
-    } while (true);
+void Client::send_file_response(Core::File& file, HTTP::HttpRequest const& request, String const& content_type)
+{
+    struct stat st;
+    if (fstat(file.fd(), &st) < 0) {
+        perror("fstat");
+        send_error_response(500, request);
+        return;
+    }
+    send_response_headers(request, content_type, st.st_size);
+
+    // Let the kernel move the file contents to the socket instead of bouncing them through our buffers.
+    off_t remaining = st.st_size;
+    while (remaining > 0) {
+        auto nsent = sendfile(m_socket->fd(), file.fd(), nullptr, min(remaining, (off_t)(64 * KiB)));
+        if (nsent < 0) {
+            if (errno == EINTR || (errno == EAGAIN && wait_until_writable()))
+                continue;
+            perror("sendfile");
+            break;
+        }
+        if (nsent == 0)
+            break;
+        remaining -= nsent;
+    }
+    // The client can only find the end of the next response if it got all of this one.
+    if (remaining > 0)
+        m_keep_alive = false;
 }
 
 void Client::send_redirect(StringView redirect_path, HTTP::HttpRequest const& request)
@@ -169,9 +263,11 @@ void Client::send_redirect(StringView redirect_path, HTTP::HttpRequest const& re
     builder.append("Location: ");
     builder.append(redirect_path);
     builder.append("\r\n");
+    builder.append("Content-Length: 0\r\n");
+    append_connection_header(builder);
     builder.append("\r\n");
 
-    m_socket->write(builder.to_string());
+    write_all(builder.string_view().bytes());
 
     log_response(301, request);
 }
@@ -272,8 +368,7 @@ void Client::handle_directory_listing(String const& requested_path, String const
     builder.append("</html>\n");
 
     auto response = builder.to_string();
-    InputMemoryStream stream { response.bytes() };
-    send_response(stream, request, "text/html");
+    send_response(response.bytes(), request, "text/html");
 }
 
 void Client::send_error_response(unsigned code, HTTP::HttpRequest const& request, Vector<String> const& headers)
@@ -289,12 +384,12 @@ void Client::send_error_response(unsigned code, HTTP::HttpRequest const& request
         builder.append("\r\n");
     }
 
+    auto body = String::formatted("<!DOCTYPE html><html><body><h1>{} {}</h1></body></html>", code, reason_phrase);
+    builder.appendff("Content-Length: {}\r\n", body.length());
+    append_connection_header(builder);
     builder.append("\r\n");
-    builder.append("<!DOCTYPE html><html><body><h1>");
-    builder.appendff("{} ", code);
-    builder.append(reason_phrase);
-    builder.append("</h1></body></html>");
-    m_socket->write(builder.to_string());
+    builder.append(body);
+    write_all(builder.string_view().bytes());
 
     log_response(code, request);
 }
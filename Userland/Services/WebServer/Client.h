@@ -6,8 +6,10 @@
 
 #pragma once
 
+#include <AK/StringBuilder.h>
 #include <LibCore/Object.h>
 #include <LibCore/TCPSocket.h>
+#include <LibCore/Timer.h>
 #include <LibHTTP/Forward.h>
 
 namespace WebServer {
@@ -22,15 +24,23 @@ private:
     Client(NonnullRefPtr<Core::TCPSocket>, Core::Object* parent);
 
     void handle_request(ReadonlyBytes);
-    void send_response(InputStream&, HTTP::HttpRequest const&, String const& content_type);
+    void send_response_headers(HTTP::HttpRequest const&, String const& content_type, size_t content_length);
+    void send_response(ReadonlyBytes, HTTP::HttpRequest const&, String const& content_type);
+    void send_file_response(Core::File&, HTTP::HttpRequest const&, String const& content_type);
     void send_redirect(StringView redirect, HTTP::HttpRequest const&);
     void send_error_response(unsigned code, HTTP::HttpRequest const&, Vector<String> const& headers = {});
+    void append_connection_header(StringBuilder&) const;
+    bool write_all(ReadonlyBytes);
+    bool wait_until_writable();
     void die();
     void log_response(unsigned code, HTTP::HttpRequest const&);
     void handle_directory_listing(String const& requested_path, String const& real_path, HTTP::HttpRequest const&);
     bool verify_credentials(Vector<HTTP::HttpRequest::Header> const&);
 
     NonnullRefPtr<Core::TCPSocket> m_socket;
+    StringBuilder m_request_builder;
+    bool m_keep_alive { false };
+    RefPtr<Core::Timer> m_idle_timer;
 };
 
 }
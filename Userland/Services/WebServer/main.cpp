@@ -9,13 +9,42 @@
 #include <LibCore/ArgsParser.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/File.h>
-#include <LibCore/TCPServer.h>
+#include <LibCore/Notifier.h>
+#include <LibCore/SocketAddress.h>
+#include <LibCore/TCPSocket.h>
 #include <LibHTTP/HttpRequest.h>
 #include <WebServer/Client.h>
 #include <WebServer/Configuration.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <stdio.h>
+#include <sys/socket.h>
 #include <unistd.h>
 
+static int listen_on(IPv4Address const& address, u16 port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    int option = 1;
+    (void)setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &option, sizeof(option));
+    auto socket_address = Core::SocketAddress(address, port).to_sockaddr_in();
+    if (bind(fd, (sockaddr const*)&socket_address, sizeof(socket_address)) < 0) {
+        perror("bind");
+        close(fd);
+        return -1;
+    }
+    if (listen(fd, 128) < 0) {
+        perror("listen");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
 int main(int argc, char** argv)
 {
     String default_listen_address = "0.0.0.0";
@@ -26,12 +55,14 @@ int main(int argc, char** argv)
     int port = default_port;
     String username;
     String password;
+    int worker_count = max(sysconf(_SC_NPROCESSORS_ONLN), 1l);
 
     Core::ArgsParser args_parser;
     args_parser.add_option(listen_address, "IP address to listen on", "listen-address", 'l', "listen_address");
     args_parser.add_option(port, "Port to listen on", "port", 'p', "port");
     args_parser.add_option(username, "HTTP basic authentication username", "user", 'U', "username");
     args_parser.add_option(password, "HTTP basic authentication password", "pass", 'P', "password");
+    args_parser.add_option(worker_count, "Number of worker processes (default: one per CPU)", "workers", 'w', "count");
     args_parser.add_positional_argument(root_path, "Path to serve the contents of", "path", Core::ArgsParser::Required::No);
     args_parser.parse(argc, argv);
 
@@ -46,6 +77,11 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    if (worker_count < 1) {
+        warnln("Invalid number of workers: {}", worker_count);
+        return 1;
+    }
+
     if (username.is_empty() != password.is_empty()) {
         warnln("Both username and password are required for HTTP basic authentication.");
         return 1;
@@ -58,7 +94,7 @@ int main(int argc, char** argv)
         return 1;
     }
 
-    if (pledge("stdio accept rpath inet unix", nullptr) < 0) {
+    if (pledge("stdio accept rpath inet unix proc", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -68,23 +104,13 @@ int main(int argc, char** argv)
     if (!username.is_empty() && !password.is_empty())
         configuration.set_credentials(HTTP::HttpRequest::BasicAuthenticationCredentials { username, password });
 
-    Core::EventLoop loop;
-
-    auto server = Core::TCPServer::construct();
-
-    server->on_ready_to_accept = [&] {
-        auto client_socket = server->accept();
-        VERIFY(client_socket);
-        auto client = WebServer::Client::construct(client_socket.release_nonnull(), server);
-        client->start();
-    };
-
-    if (!server->listen(ipv4_address.value(), port)) {
+    int server_fd = listen_on(ipv4_address.value(), port);
+    if (server_fd < 0) {
         warnln("Failed to listen on {}:{}", ipv4_address.value(), port);
         return 1;
     }
 
-    outln("Listening on {}:{}", ipv4_address.value(), port);
+    outln("Listening on {}:{} with {} worker(s)", ipv4_address.value(), port, worker_count);
 
     if (unveil("/res/icons", "r") < 0) {
         perror("unveil");
@@ -98,6 +124,42 @@ int main(int argc, char** argv)
 
     unveil(nullptr, nullptr);
 
+    // Every worker process waits for connections on the same listening socket, and whichever gets to accept a
+    // connection serves it. This process is one of the workers.
+    fflush(stdout);
+    for (int i = 1; i < worker_count; ++i) {
+        auto pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (pid == 0)
+            break;
+    }
+
+    Core::EventLoop loop;
+
+    auto server_notifier = Core::Notifier::construct(server_fd, Core::Notifier::Event::Read);
+    server_notifier->on_ready_to_read = [&] {
+        for (;;) {
+            int client_fd = accept4(server_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (client_fd < 0) {
+                if (errno == EINTR)
+                    continue;
+                // Another worker may have beaten us to the connection.
+                if (errno != EAGAIN)
+                    perror("accept");
+                return;
+            }
+            // Headers and body go out in separate writes, so without this the body of a small response on a kept
+            // alive connection waits for the client to acknowledge the headers.
+            int option = 1;
+            (void)setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &option, sizeof(option));
+            auto client = WebServer::Client::construct(Core::TCPSocket::construct(client_fd), server_notifier);
+            client->start();
+        }
+    };
+
     if (pledge("stdio accept rpath", nullptr) < 0) {
         perror("pledge");
         return 1;
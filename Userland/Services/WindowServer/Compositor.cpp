@@ -21,6 +21,7 @@
 #include <LibGfx/Painter.h>
 #include <LibGfx/StylePainter.h>
 #include <LibThreading/BackgroundAction.h>
+#include <LibThreading/TaskGroup.h>
 
 namespace WindowServer {
 
@@ -96,6 +97,7 @@ void CompositorScreenData::init_bitmaps(Compositor& compositor, Screen& screen)
     m_flush_rects.clear_with_capacity();
     m_flush_transparent_rects.clear_with_capacity();
     m_flush_special_rects.clear_with_capacity();
+    m_stale_back_buffer_rects.clear_with_capacity();
 
     auto size = screen.size();
     m_front_bitmap = nullptr;
@@ -330,13 +332,15 @@ void Compositor::compose()
                     if constexpr (is_opaque) {
                         dbgln_if(COMPOSE_DEBUG, "  render wallpaper opaque: {} on screen #{}", screen_render_rect, screen.index());
                         prepare_rect(screen, render_rect);
-                        auto& back_painter = *screen.compositor_screen_data().m_back_painter;
-                        paint_wallpaper(screen, back_painter, render_rect, screen_rect);
+                        screen.compositor_screen_data().m_paint_commands.append([&, render_rect, screen_rect](auto& back_painter, auto&) {
+                            paint_wallpaper(screen, back_painter, render_rect, screen_rect);
+                        });
                     } else {
                         dbgln_if(COMPOSE_DEBUG, "  render wallpaper transparent: {} on screen #{}", screen_render_rect, screen.index());
                         prepare_transparency_rect(screen, render_rect);
-                        auto& temp_painter = *screen.compositor_screen_data().m_temp_painter;
-                        paint_wallpaper(screen, temp_painter, render_rect, screen_rect);
+                        screen.compositor_screen_data().m_paint_commands.append([&, render_rect, screen_rect](auto&, auto& temp_painter) {
+                            paint_wallpaper(screen, temp_painter, render_rect, screen_rect);
+                        });
                     }
                 }
                 return IterationDecision::Continue;
@@ -363,40 +367,29 @@ void Compositor::compose()
 
         dbgln_if(COMPOSE_DEBUG, "  window {} frame rect: {}", window.title(), frame_rect);
 
-        RefPtr<Gfx::Bitmap> backing_store = window.backing_store();
-        auto compose_window_rect = [&](Screen& screen, Gfx::Painter& painter, const Gfx::IntRect& rect) {
-            if (!window.is_fullscreen()) {
-                rect.for_each_intersected(frame_rects, [&](const Gfx::IntRect& intersected_rect) {
-                    Gfx::PainterStateSaver saver(painter);
-                    painter.add_clip_rect(intersected_rect);
-                    painter.translate(transition_offset);
-                    dbgln_if(COMPOSE_DEBUG, "    render frame: {}", intersected_rect);
-                    window.frame().paint(screen, painter, intersected_rect.translated(-transition_offset));
-                    return IterationDecision::Continue;
-                });
-            }
-
-            auto clear_window_rect = [&](const Gfx::IntRect& clear_rect) {
-                auto fill_color = wm.palette().window();
-                if (!window.is_opaque())
-                    fill_color.set_alpha(255 * window.opacity());
-                painter.fill_rect(clear_rect, fill_color);
-            };
-
-            if (!backing_store) {
-                clear_window_rect(window_rect.intersected(rect));
-                return;
-            }
-
-            // Decide where we would paint this window's backing store.
-            // This is subtly different from widow.rect(), because window
-            // size may be different from its backing store size. This
-            // happens when the window has been resized and the client
-            // has not yet attached a new backing store. In this case,
-            // we want to try to blit the backing store at the same place
-            // it was previously, and fill the rest of the window with its
-            // background color.
-            Gfx::IntRect backing_rect;
+        // The paint commands run on other threads, so everything they need to know about the window is looked up
+        // here, while recording them. The window and its backing store outlive the commands, which are all done
+        // before compose() returns.
+        Gfx::Bitmap* backing_store = window.backing_store();
+        auto* frame = window.is_fullscreen() ? nullptr : &window.frame();
+        bool is_opaque = window.is_opaque();
+        float opacity = window.opacity();
+        bool is_unresponsive = window.client() && window.client()->is_unresponsive();
+
+        auto fill_color = wm.palette().window();
+        if (!is_opaque)
+            fill_color.set_alpha(255 * opacity);
+
+        // Decide where we would paint this window's backing store.
+        // This is subtly different from widow.rect(), because window
+        // size may be different from its backing store size. This
+        // happens when the window has been resized and the client
+        // has not yet attached a new backing store. In this case,
+        // we want to try to blit the backing store at the same place
+        // it was previously, and fill the rest of the window with its
+        // background color.
+        Gfx::IntRect backing_rect;
+        if (backing_store) {
             backing_rect.set_size(backing_store->size());
             switch (WindowManager::the().resize_direction_of_window(window)) {
             case ResizeDirection::None:
@@ -420,6 +413,28 @@ void Compositor::compose()
                 backing_rect.set_top(window_rect.top());
                 break;
             }
+        }
+
+        auto compose_window_rect = [=](WindowFrame::PerScaleRenderedCache* frame_cache, Gfx::Painter& painter, const Gfx::IntRect& rect) {
+            if (frame_cache) {
+                rect.for_each_intersected(frame_rects, [&](const Gfx::IntRect& intersected_rect) {
+                    Gfx::PainterStateSaver saver(painter);
+                    painter.add_clip_rect(intersected_rect);
+                    painter.translate(transition_offset);
+                    dbgln_if(COMPOSE_DEBUG, "    render frame: {}", intersected_rect);
+                    frame_cache->paint(*frame, painter, intersected_rect.translated(-transition_offset));
+                    return IterationDecision::Continue;
+                });
+            }
+
+            auto clear_window_rect = [&](const Gfx::IntRect& clear_rect) {
+                painter.fill_rect(clear_rect, fill_color);
+            };
+
+            if (!backing_store) {
+                clear_window_rect(window_rect.intersected(rect));
+                return;
+            }
 
             Gfx::IntRect dirty_rect_in_backing_coordinates = rect.intersected(window_rect)
                                                                  .intersected(backing_rect)
@@ -428,13 +443,13 @@ void Compositor::compose()
             if (!dirty_rect_in_backing_coordinates.is_empty()) {
                 auto dst = backing_rect.location().translated(dirty_rect_in_backing_coordinates.location());
 
-                if (window.client() && window.client()->is_unresponsive()) {
-                    if (window.is_opaque()) {
+                if (is_unresponsive) {
+                    if (is_opaque) {
                         painter.blit_filtered(dst, *backing_store, dirty_rect_in_backing_coordinates, [](Color src) {
                             return src.to_grayscale().darkened(0.75f);
                         });
                     } else {
-                        u8 alpha = 255 * window.opacity();
+                        u8 alpha = 255 * opacity;
                         painter.blit_filtered(dst, *backing_store, dirty_rect_in_backing_coordinates, [&](Color src) {
                             auto color = src.to_grayscale().darkened(0.75f);
                             color.set_alpha(alpha);
@@ -442,7 +457,7 @@ void Compositor::compose()
                         });
                     }
                 } else {
-                    painter.blit(dst, *backing_store, dirty_rect_in_backing_coordinates, window.opacity());
+                    painter.blit(dst, *backing_store, dirty_rect_in_backing_coordinates, opacity);
                 }
             }
 
@@ -450,6 +465,11 @@ void Compositor::compose()
                 clear_window_rect(background_rect);
         };
 
+        // Rendering the frame into its cache has to happen here, the commands only blit from it.
+        auto frame_cache_for = [&](Screen& screen) -> WindowFrame::PerScaleRenderedCache* {
+            return frame ? frame->render_to_cache(screen) : nullptr;
+        };
+
         auto& dirty_rects = window.dirty_rects();
 
         if constexpr (COMPOSE_DEBUG) {
@@ -472,10 +492,11 @@ void Compositor::compose()
                     dbgln_if(COMPOSE_DEBUG, "    render opaque: {} on screen #{}", screen_render_rect, screen->index());
 
                     prepare_rect(*screen, screen_render_rect);
-                    auto& back_painter = *screen->compositor_screen_data().m_back_painter;
-                    Gfx::PainterStateSaver saver(back_painter);
-                    back_painter.add_clip_rect(screen_render_rect);
-                    compose_window_rect(*screen, back_painter, screen_render_rect);
+                    screen->compositor_screen_data().m_paint_commands.append([compose_window_rect, frame_cache = frame_cache_for(*screen), screen_render_rect](auto& back_painter, auto&) {
+                        Gfx::PainterStateSaver saver(back_painter);
+                        back_painter.add_clip_rect(screen_render_rect);
+                        compose_window_rect(frame_cache, back_painter, screen_render_rect);
+                    });
                 }
                 return IterationDecision::Continue;
             });
@@ -493,9 +514,10 @@ void Compositor::compose()
                         continue;
                     dbgln_if(COMPOSE_DEBUG, "    render wallpaper: {} on screen #{}", screen_render_rect, screen->index());
 
-                    auto& temp_painter = *screen->compositor_screen_data().m_temp_painter;
                     prepare_transparency_rect(*screen, screen_render_rect);
-                    paint_wallpaper(*screen, temp_painter, screen_render_rect, screen_rect);
+                    screen->compositor_screen_data().m_paint_commands.append([&, screen, screen_render_rect, screen_rect](auto&, auto& temp_painter) {
+                        paint_wallpaper(*screen, temp_painter, screen_render_rect, screen_rect);
+                    });
                 }
                 return IterationDecision::Continue;
             });
@@ -511,10 +533,11 @@ void Compositor::compose()
                     dbgln_if(COMPOSE_DEBUG, "    render transparent: {} on screen #{}", screen_render_rect, screen->index());
 
                     prepare_transparency_rect(*screen, screen_render_rect);
-                    auto& temp_painter = *screen->compositor_screen_data().m_temp_painter;
-                    Gfx::PainterStateSaver saver(temp_painter);
-                    temp_painter.add_clip_rect(screen_render_rect);
-                    compose_window_rect(*screen, temp_painter, screen_render_rect);
+                    screen->compositor_screen_data().m_paint_commands.append([compose_window_rect, frame_cache = frame_cache_for(*screen), screen_render_rect](auto&, auto& temp_painter) {
+                        Gfx::PainterStateSaver saver(temp_painter);
+                        temp_painter.add_clip_rect(screen_render_rect);
+                        compose_window_rect(frame_cache, temp_painter, screen_render_rect);
+                    });
                 }
                 return IterationDecision::Continue;
             });
@@ -557,6 +580,8 @@ void Compositor::compose()
             return is_overlapping;
         }());
 
+        paint_recorded_commands();
+
         if (!m_overlay_list.is_empty()) {
             // Render everything to the temporary buffer before we copy it back
             render_overlays();
@@ -566,12 +591,17 @@ void Compositor::compose()
         Screen::for_each([&](auto& screen) {
             auto screen_rect = screen.rect();
             auto& screen_data = screen.compositor_screen_data();
-            for (auto& rect : screen_data.m_flush_transparent_rects.rects())
-                screen_data.m_back_painter->blit(rect.location(), *screen_data.m_temp_bitmap, rect.translated(-screen_rect.location()));
+            for (auto& rect : screen_data.m_flush_transparent_rects.rects()) {
+                screen_data.m_paint_commands.append([&screen_data, rect, screen_rect](auto& back_painter, auto&) {
+                    back_painter.blit(rect.location(), *screen_data.m_temp_bitmap, rect.translated(-screen_rect.location()));
+                });
+            }
             return IterationDecision::Continue;
         });
     }
 
+    paint_recorded_commands();
+
     m_invalidated_any = false;
     m_invalidated_window = false;
     m_invalidated_cursor = false;
@@ -600,6 +630,66 @@ void Compositor::compose()
     });
 }
 
+void Compositor::paint_recorded_commands()
+{
+    // Each screen's flush rects are split into horizontal bands that are painted in parallel, with every command
+    // played back on each band. Nothing gets painted outside of the painter's clip rect, so as long as every band
+    // gets its own painters clipped to it, the bands never touch each other's pixels.
+    static constexpr int minimum_pixels_per_band = 256 * 256;
+    Threading::TaskGroup group;
+    Screen::for_each([&](auto& screen) {
+        auto& screen_data = screen.compositor_screen_data();
+        // The flush rects are all known by now, and the commands may paint on top of what's in the back buffer.
+        screen_data.update_stale_back_buffer_rects(screen);
+
+        if (screen_data.m_paint_commands.is_empty())
+            return IterationDecision::Continue;
+
+        Gfx::IntRect bounding_rect;
+        for (auto& rect : screen_data.m_flush_rects.rects())
+            bounding_rect = bounding_rect.united(rect);
+        for (auto& rect : screen_data.m_flush_transparent_rects.rects())
+            bounding_rect = bounding_rect.united(rect);
+        bounding_rect.intersect(screen.rect());
+        if (bounding_rect.is_empty())
+            return IterationDecision::Continue;
+
+        auto screen_location = screen.rect().location();
+        auto paint_band = [&screen_data, screen_location](Gfx::IntRect const& band_rect) {
+            Gfx::Painter back_painter(*screen_data.m_back_bitmap);
+            back_painter.translate(-screen_location);
+            back_painter.add_clip_rect(band_rect);
+            Gfx::Painter temp_painter(*screen_data.m_temp_bitmap);
+            temp_painter.translate(-screen_location);
+            temp_painter.add_clip_rect(band_rect);
+            for (auto& command : screen_data.m_paint_commands)
+                command(back_painter, temp_painter);
+        };
+
+        int band_count = clamp(bounding_rect.width() * bounding_rect.height() / minimum_pixels_per_band, 1, min((int)Threading::ThreadPool::max_thread_count(), bounding_rect.height()));
+        if (band_count <= 1) {
+            paint_band(bounding_rect);
+            return IterationDecision::Continue;
+        }
+
+        dbgln_if(COMPOSE_DEBUG, "Painting {} on screen #{} in {} bands", bounding_rect, screen.index(), band_count);
+        for (int band = 0; band < band_count; ++band) {
+            int top = bounding_rect.top() + bounding_rect.height() * band / band_count;
+            int bottom = bounding_rect.top() + bounding_rect.height() * (band + 1) / band_count;
+            group.spawn([paint_band, band_rect = Gfx::IntRect { bounding_rect.left(), top, bounding_rect.width(), bottom - top }] {
+                paint_band(band_rect);
+            });
+        }
+        return IterationDecision::Continue;
+    });
+    group.wait();
+
+    Screen::for_each([&](auto& screen) {
+        screen.compositor_screen_data().m_paint_commands.clear_with_capacity();
+        return IterationDecision::Continue;
+    });
+}
+
 void Compositor::flush(Screen& screen)
 {
     auto& screen_data = screen.compositor_screen_data();
@@ -660,45 +750,37 @@ void Compositor::flush(Screen& screen)
 
     auto do_flush = [&](Gfx::IntRect rect) {
         VERIFY(screen_rect.contains(rect));
-        rect.translate_by(-screen_rect.location());
-
-        // Almost everything in Compositor is in logical coordinates, with the painters having
-        // a scale applied. But this routine accesses the backbuffer pixels directly, so it
-        // must work in physical coordinates.
-        auto scaled_rect = rect * screen.scale_factor();
-        Gfx::RGBA32* front_ptr = screen_data.m_front_bitmap->scanline(scaled_rect.y()) + scaled_rect.x();
-        Gfx::RGBA32* back_ptr = screen_data.m_back_bitmap->scanline(scaled_rect.y()) + scaled_rect.x();
-        size_t pitch = screen_data.m_back_bitmap->pitch();
 
         // NOTE: The meaning of a flush depends on whether we can flip buffers or not.
         //
-        //       If flipping is supported, flushing means that we've flipped, and now we
-        //       copy the changed bits from the front buffer to the back buffer, to keep
-        //       them in sync.
+        //       If flipping is supported, flushing means that we've flipped, and the
+        //       changed rects are now stale in the back buffer. They're brought up to
+        //       date in the next compose pass, see update_stale_back_buffer_rects().
         //
         //       If flipping is not supported, flushing means that we copy the changed
         //       rects from the backing bitmap to the display framebuffer.
-
-        Gfx::RGBA32* to_ptr;
-        const Gfx::RGBA32* from_ptr;
-
         if (screen_data.m_screen_can_set_buffer) {
-            to_ptr = back_ptr;
-            from_ptr = front_ptr;
-        } else {
-            to_ptr = front_ptr;
-            from_ptr = back_ptr;
+            screen_data.m_stale_back_buffer_rects.add(rect);
+            return;
         }
 
+        rect.translate_by(-screen_rect.location());
+
+        // Almost everything in Compositor is in logical coordinates, with the painters having
+        // a scale applied. But this routine accesses the backbuffer pixels directly, so it
+        // must work in physical coordinates.
+        auto scaled_rect = rect * screen.scale_factor();
+        Gfx::RGBA32* to_ptr = screen_data.m_front_bitmap->scanline(scaled_rect.y()) + scaled_rect.x();
+        const Gfx::RGBA32* from_ptr = screen_data.m_back_bitmap->scanline(scaled_rect.y()) + scaled_rect.x();
+        size_t pitch = screen_data.m_back_bitmap->pitch();
+
         for (int y = 0; y < scaled_rect.height(); ++y) {
             fast_u32_copy(to_ptr, from_ptr, scaled_rect.width());
             from_ptr = (const Gfx::RGBA32*)((const u8*)from_ptr + pitch);
             to_ptr = (Gfx::RGBA32*)((u8*)to_ptr + pitch);
         }
         if (device_can_flush_buffers) {
-            // Whether or not we need to flush buffers, we need to at least track what we modified
-            // so that we can flush these areas next time before we flip buffers. Or, if we don't
-            // support buffer flipping then we will flush them shortly.
+            // We don't support buffer flipping, so we will flush these areas shortly.
             screen.queue_flush_display_rect(rect);
         }
     };
@@ -815,6 +897,37 @@ bool Compositor::set_wallpaper(const String& path, Function<void(bool)>&& callba
     return true;
 }
 
+void CompositorScreenData::update_stale_back_buffer_rects(Screen& screen)
+{
+    if (m_stale_back_buffer_rects.is_empty())
+        return;
+
+    // Whatever is about to be painted doesn't need to be copied, and neither does what's behind the cursor,
+    // which has been restored from the cursor's back bitmap already.
+    auto painted_rects = m_flush_rects.clone();
+    painted_rects.add(m_flush_transparent_rects);
+    painted_rects.add(m_flush_special_rects);
+    auto rects_to_copy = m_stale_back_buffer_rects.shatter(painted_rects);
+    m_stale_back_buffer_rects.clear_with_capacity();
+
+    auto screen_rect = screen.rect();
+    size_t pitch = m_back_bitmap->pitch();
+    for (auto rect : rects_to_copy.rects()) {
+        rect.translate_by(-screen_rect.location());
+        auto scaled_rect = rect * screen.scale_factor();
+        const Gfx::RGBA32* from_ptr = m_front_bitmap->scanline(scaled_rect.y()) + scaled_rect.x();
+        Gfx::RGBA32* to_ptr = m_back_bitmap->scanline(scaled_rect.y()) + scaled_rect.x();
+        for (int y = 0; y < scaled_rect.height(); ++y) {
+            fast_u32_copy(to_ptr, from_ptr, scaled_rect.width());
+            from_ptr = (const Gfx::RGBA32*)((const u8*)from_ptr + pitch);
+            to_ptr = (Gfx::RGBA32*)((u8*)to_ptr + pitch);
+        }
+        // The device has to be told about these before the next flip, like about everything else we paint.
+        if (screen.can_device_flush_buffers())
+            screen.queue_flush_display_rect(rect);
+    }
+}
+
 void CompositorScreenData::flip_buffers(Screen& screen)
 {
     VERIFY(m_screen_can_set_buffer);
@@ -6,8 +6,10 @@
 
 #pragma once
 
+#include <AK/Function.h>
 #include <AK/OwnPtr.h>
 #include <AK/RefPtr.h>
+#include <AK/Vector.h>
 #include <LibCore/Object.h>
 #include <LibGfx/Color.h>
 #include <LibGfx/DisjointRectSet.h>
@@ -54,10 +56,21 @@ struct CompositorScreenData {
     Gfx::DisjointRectSet m_flush_transparent_rects;
     Gfx::DisjointRectSet m_flush_special_rects;
 
+    // With page flipping, the back buffer is a frame behind wherever the frame that's now on screen changed something.
+    // Rather than copying those areas over right after the flip, they're only copied once the next frame is known not
+    // to paint over them anyway, which a window that's redrawn in full every frame always does.
+    Gfx::DisjointRectSet m_stale_back_buffer_rects;
+
+    // What compose() paints into the back and temp bitmaps. It's recorded first, and then played back on several
+    // threads at once by Compositor::paint_recorded_commands().
+    using PaintCommand = Function<void(Gfx::Painter& back_painter, Gfx::Painter& temp_painter)>;
+    Vector<PaintCommand> m_paint_commands;
+
     Gfx::Painter& overlay_painter() { return *m_temp_painter; }
 
     void init_bitmaps(Compositor&, Screen&);
     void flip_buffers(Screen&);
+    void update_stale_back_buffer_rects(Screen&);
     void draw_cursor(Screen&, const Gfx::IntRect&);
     bool restore_cursor_back(Screen&, Gfx::IntRect&);
 
@@ -194,6 +207,7 @@ private:
     void overlays_theme_changed();
 
     void render_overlays();
+    void paint_recorded_commands();
     void add_overlay(Overlay&);
     void remove_overlay(Overlay&);
     void update_fonts();
@@ -377,6 +377,29 @@ auto WindowFrame::render_to_cache(Screen& screen) -> PerScaleRenderedCache*
     return rendered_cache;
 }
 
+// The cached frame pieces are blended onto the screen every time the window is composed, so they're kept premultiplied.
+// Painter can't draw onto premultiplied bitmaps, so the frame is painted into a regular bitmap and copied over.
+static void copy_premultiplied(Gfx::Bitmap& target, const Gfx::IntRect& clip_rect, const Gfx::IntPoint& position, const Gfx::Bitmap& source, const Gfx::IntRect& source_rect)
+{
+    VERIFY(target.format() == Gfx::BitmapFormat::BGRA8888Premultiplied);
+    VERIFY(target.scale() == source.scale());
+
+    auto safe_source_rect = source_rect.intersected(source.rect());
+    auto target_rect = Gfx::IntRect { position + (safe_source_rect.location() - source_rect.location()), safe_source_rect.size() };
+    auto clipped_rect = target_rect.intersected(clip_rect).intersected(target.rect());
+    if (clipped_rect.is_empty())
+        return;
+    auto source_location = safe_source_rect.location() + (clipped_rect.location() - target_rect.location());
+
+    int scale = target.scale();
+    for (int y = 0; y < clipped_rect.height() * scale; ++y) {
+        auto* src = source.scanline(source_location.y() * scale + y) + source_location.x() * scale;
+        auto* dst = target.scanline(clipped_rect.y() * scale + y) + clipped_rect.x() * scale;
+        for (int x = 0; x < clipped_rect.width() * scale; ++x)
+            dst[x] = Gfx::Color::from_rgba(src[x]).premultiplied_value();
+    }
+}
+
 void WindowFrame::PerScaleRenderedCache::render(WindowFrame& frame, Screen& screen)
 {
     if (!m_dirty)
@@ -433,14 +456,14 @@ void WindowFrame::PerScaleRenderedCache::render(WindowFrame& frame, Screen& scre
 
     if (!m_top_bottom || m_top_bottom->width() != frame_rect_including_shadow.width() || m_top_bottom->height() != top_bottom_height || m_top_bottom->scale() != scale) {
         if (top_bottom_height > 0)
-            m_top_bottom = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, { frame_rect_including_shadow.width(), top_bottom_height }, scale);
+            m_top_bottom = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888Premultiplied, { frame_rect_including_shadow.width(), top_bottom_height }, scale);
         else
             m_top_bottom = nullptr;
         m_shadow_dirty = true;
     }
     if (!m_left_right || m_left_right->height() != frame_rect_including_shadow.height() || m_left_right->width() != left_right_width || m_left_right->scale() != scale) {
         if (left_right_width > 0)
-            m_left_right = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, { left_right_width, frame_rect_including_shadow.height() }, scale);
+            m_left_right = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888Premultiplied, { left_right_width, frame_rect_including_shadow.height() }, scale);
         else
             m_left_right = nullptr;
         m_shadow_dirty = true;
@@ -468,12 +491,11 @@ void WindowFrame::PerScaleRenderedCache::render(WindowFrame& frame, Screen& scre
         m_bottom_y = window_rect.y() - frame_rect_including_shadow.y();
         VERIFY(m_bottom_y >= 0);
 
-        Gfx::Painter top_bottom_painter(*m_top_bottom);
-        top_bottom_painter.add_clip_rect({ update_location, { frame_rect_to_update.width(), top_bottom_height - update_location.y() - (frame_rect_including_shadow.bottom() - frame_rect_to_update.bottom()) } });
+        Gfx::IntRect clip_rect { update_location, { frame_rect_to_update.width(), top_bottom_height - update_location.y() - (frame_rect_including_shadow.bottom() - frame_rect_to_update.bottom()) } };
         if (m_bottom_y > 0)
-            top_bottom_painter.blit({ 0, 0 }, *tmp_bitmap, { 0, 0, frame_rect_including_shadow.width(), m_bottom_y }, 1.0, false);
+            copy_premultiplied(*m_top_bottom, clip_rect, { 0, 0 }, *tmp_bitmap, { 0, 0, frame_rect_including_shadow.width(), m_bottom_y });
         if (m_bottom_y < top_bottom_height)
-            top_bottom_painter.blit({ 0, m_bottom_y }, *tmp_bitmap, { 0, frame_rect_including_shadow.height() - (frame_rect_including_shadow.bottom() - window_rect.bottom()), frame_rect_including_shadow.width(), top_bottom_height - m_bottom_y }, 1.0, false);
+            copy_premultiplied(*m_top_bottom, clip_rect, { 0, m_bottom_y }, *tmp_bitmap, { 0, frame_rect_including_shadow.height() - (frame_rect_including_shadow.bottom() - window_rect.bottom()), frame_rect_including_shadow.width(), top_bottom_height - m_bottom_y });
     } else {
         m_bottom_y = 0;
     }
@@ -482,12 +504,11 @@ void WindowFrame::PerScaleRenderedCache::render(WindowFrame& frame, Screen& scre
         m_right_x = window_rect.x() - frame_rect_including_shadow.x();
         VERIFY(m_right_x >= 0);
 
-        Gfx::Painter left_right_painter(*m_left_right);
-        left_right_painter.add_clip_rect({ update_location, { left_right_width - update_location.x() - (frame_rect_including_shadow.right() - frame_rect_to_update.right()), window_rect.height() } });
+        Gfx::IntRect clip_rect { update_location, { left_right_width - update_location.x() - (frame_rect_including_shadow.right() - frame_rect_to_update.right()), window_rect.height() } };
         if (m_right_x > 0)
-            left_right_painter.blit({ 0, 0 }, *tmp_bitmap, { 0, m_bottom_y, m_right_x, window_rect.height() }, 1.0, false);
+            copy_premultiplied(*m_left_right, clip_rect, { 0, 0 }, *tmp_bitmap, { 0, m_bottom_y, m_right_x, window_rect.height() });
         if (m_right_x < left_right_width)
-            left_right_painter.blit({ m_right_x, 0 }, *tmp_bitmap, { (window_rect.right() - frame_rect_including_shadow.x()) + 1, m_bottom_y, frame_rect_including_shadow.width() - (frame_rect_including_shadow.right() - window_rect.right()), window_rect.height() }, 1.0, false);
+            copy_premultiplied(*m_left_right, clip_rect, { m_right_x, 0 }, *tmp_bitmap, { (window_rect.right() - frame_rect_including_shadow.x()) + 1, m_bottom_y, frame_rect_including_shadow.width() - (frame_rect_including_shadow.right() - window_rect.right()), window_rect.height() });
     } else {
         m_right_x = 0;
     }
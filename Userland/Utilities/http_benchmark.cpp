@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <AK/IPv4Address.h>
+#include <AK/NonnullRefPtrVector.h>
+#include <AK/QuickSort.h>
+#include <AK/String.h>
+#include <AK/StringBuilder.h>
+#include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/SocketAddress.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/Thread.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+// Sends GET requests to a web server over a number of concurrent connections, in the spirit of ab and wrk, and
+// reports the throughput and latency it saw.
+
+struct Connection {
+    int fd { -1 };
+    Vector<u8> buffer;
+};
+
+static u64 now_in_microseconds()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000ull + now.tv_nsec / 1000;
+}
+
+static bool connect_to(Connection& connection, Core::SocketAddress const& address)
+{
+    connection.fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (connection.fd < 0) {
+        perror("socket");
+        return false;
+    }
+    auto socket_address = address.to_sockaddr_in();
+    if (connect(connection.fd, (sockaddr const*)&socket_address, sizeof(socket_address)) < 0) {
+        perror("connect");
+        close(connection.fd);
+        connection.fd = -1;
+        return false;
+    }
+    connection.buffer.clear();
+    return true;
+}
+
+static void disconnect(Connection& connection)
+{
+    if (connection.fd >= 0)
+        close(connection.fd);
+    connection.fd = -1;
+}
+
+// Reads more of the response into the connection's buffer; returns false once the server closed the connection.
+static bool receive(Connection& connection)
+{
+    u8 chunk[16 * KiB];
+    for (;;) {
+        auto nread = read(connection.fd, chunk, sizeof(chunk));
+        if (nread < 0 && errno == EINTR)
+            continue;
+        if (nread <= 0)
+            return false;
+        connection.buffer.append(chunk, nread);
+        return true;
+    }
+}
+
+static Optional<size_t> find_end_of_headers(Vector<u8> const& buffer)
+{
+    for (size_t i = 3; i < buffer.size(); ++i) {
+        if (buffer[i - 3] == '\r' && buffer[i - 2] == '\n' && buffer[i - 1] == '\r' && buffer[i] == '\n')
+            return i + 1;
+    }
+    return {};
+}
+
+struct Response {
+    unsigned status { 0 };
+    bool keeps_connection_alive { false };
+};
+
+// Reads one complete response, consuming exactly its bytes from the connection.
+static Optional<Response> receive_response(Connection& connection)
+{
+    Optional<size_t> headers_size;
+    while (!(headers_size = find_end_of_headers(connection.buffer)).has_value()) {
+        if (!receive(connection))
+            return {};
+    }
+
+    Response response;
+    Optional<unsigned> content_length;
+    auto headers = StringView { connection.buffer.data(), *headers_size }.lines();
+    if (headers.is_empty())
+        return {};
+    auto status_line = headers[0].split_view(' ');
+    if (status_line.size() < 2)
+        return {};
+    response.status = status_line[1].to_uint().value_or(0);
+    for (size_t i = 1; i < headers.size(); ++i) {
+        auto separator = headers[i].find(':');
+        if (!separator.has_value())
+            continue;
+        auto name = headers[i].substring_view(0, *separator);
+        auto value = headers[i].substring_view(*separator + 1).trim_whitespace();
+        if (name.equals_ignoring_case("Content-Length"))
+            content_length = value.to_uint();
+        else if (name.equals_ignoring_case("Connection"))
+            response.keeps_connection_alive = value.equals_ignoring_case("keep-alive");
+    }
+
+    // Without a length, the body only ends when the connection does.
+    if (!content_length.has_value()) {
+        while (receive(connection)) { }
+        response.keeps_connection_alive = false;
+        connection.buffer.clear();
+        return response;
+    }
+
+    auto response_size = *headers_size + *content_length;
+    while (connection.buffer.size() < response_size) {
+        if (!receive(connection))
+            return {};
+    }
+    connection.buffer.remove(0, response_size);
+    return response;
+}
+
+int main(int argc, char** argv)
+{
+    char const* address_string = nullptr;
+    String path = "/";
+    int port = 80;
+    int connection_count = 16;
+    int request_count = 10000;
+    bool keep_alive = false;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure how many requests per second a web server answers, and how quickly.");
+    args_parser.add_option(port, "Port to connect to", "port", 'p', "port");
+    args_parser.add_option(connection_count, "Number of concurrent connections", "connections", 'c', "count");
+    args_parser.add_option(request_count, "Number of requests to send in total", "requests", 'n', "count");
+    args_parser.add_option(keep_alive, "Keep connections alive between requests", "keep-alive", 'k');
+    args_parser.add_positional_argument(address_string, "IPv4 address of the server", "address");
+    args_parser.add_positional_argument(path, "Path to request", "path", Core::ArgsParser::Required::No);
+    args_parser.parse(argc, argv);
+
+    auto address = IPv4Address::from_string(address_string);
+    if (!address.has_value()) {
+        warnln("Invalid address: {}", address_string);
+        return 1;
+    }
+    if (connection_count < 1 || request_count < 1) {
+        warnln("Need at least one connection and one request");
+        return 1;
+    }
+    auto server_address = Core::SocketAddress(address.value(), port);
+
+    StringBuilder request_builder;
+    request_builder.appendff("GET {} HTTP/1.0\r\n", path);
+    request_builder.appendff("Host: {}\r\n", address_string);
+    request_builder.append(keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
+    request_builder.append("\r\n");
+    auto request = request_builder.to_string();
+
+    Atomic<int> requests_left = request_count;
+    Atomic<int> failed_requests = 0;
+    Atomic<int> connections_opened = 0;
+    Threading::Mutex latencies_lock;
+    Vector<u64> latencies;
+
+    NonnullRefPtrVector<Threading::Thread> threads;
+    for (int i = 0; i < connection_count; ++i) {
+        threads.append(Threading::Thread::construct([&]() -> intptr_t {
+            Connection connection;
+            Vector<u64> thread_latencies;
+            while (requests_left.fetch_sub(1) > 0) {
+                auto start = now_in_microseconds();
+                if (connection.fd < 0) {
+                    if (!connect_to(connection, server_address)) {
+                        ++failed_requests;
+                        continue;
+                    }
+                    ++connections_opened;
+                }
+                auto response = write(connection.fd, request.characters(), request.length()) == (ssize_t)request.length()
+                    ? receive_response(connection)
+                    : Optional<Response> {};
+                if (!response.has_value() || response->status != 200)
+                    ++failed_requests;
+                else
+                    thread_latencies.append(now_in_microseconds() - start);
+                if (!response.has_value() || !response->keeps_connection_alive)
+                    disconnect(connection);
+            }
+            disconnect(connection);
+
+            Threading::MutexLocker locker(latencies_lock);
+            latencies.extend(move(thread_latencies));
+            return 0;
+        },
+            "http_benchmark"));
+    }
+
+    auto start = now_in_microseconds();
+    for (auto& thread : threads)
+        thread.start();
+    for (auto& thread : threads)
+        (void)thread.join();
+    auto elapsed = now_in_microseconds() - start;
+
+    outln("Requests:        {} ({} failed)", request_count, failed_requests.load());
+    outln("Connections:     {} opened, {} concurrent", connections_opened.load(), connection_count);
+    outln("Time:            {}.{:03}s", elapsed / 1000000, (elapsed / 1000) % 1000);
+    outln("Requests/second: {}", elapsed ? latencies.size() * 1000000ull / elapsed : 0);
+    if (!latencies.is_empty()) {
+        quick_sort(latencies);
+        u64 total = 0;
+        for (auto latency : latencies)
+            total += latency;
+        outln("Latency:         {}us average, {}us median, {}us 99th percentile, {}us max",
+            total / latencies.size(), latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100], latencies.last());
+    }
+    return failed_requests.load() == 0 ? 0 : 1;
+}
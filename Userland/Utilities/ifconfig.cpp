@@ -56,10 +56,13 @@ int main(int argc, char** argv)
             auto ipv4_address = if_object.get("ipv4_address").to_string();
             auto gateway = if_object.get("ipv4_gateway").to_string();
             auto netmask = if_object.get("ipv4_netmask").to_string();
-            auto packets_in = if_object.get("packets_in").to_u32();
-            auto bytes_in = if_object.get("bytes_in").to_u32();
-            auto packets_out = if_object.get("packets_out").to_u32();
-            auto bytes_out = if_object.get("bytes_out").to_u32();
+            auto packets_in = if_object.get("packets_in").to_u64();
+            auto bytes_in = if_object.get("bytes_in").to_u64();
+            auto packets_out = if_object.get("packets_out").to_u64();
+            auto bytes_out = if_object.get("bytes_out").to_u64();
+            auto packets_dropped = if_object.get("receive_queue_full").to_u64() + if_object.get("packets_dropped").to_u64();
+            auto receive_errors = if_object.get("receive_errors").to_u64();
+            auto send_errors = if_object.get("send_errors").to_u64();
             auto mtu = if_object.get("mtu").to_u32();
 
             outln("{}:", name);
@@ -68,8 +71,8 @@ int main(int argc, char** argv)
             outln("\tnetmask: {}", netmask);
             outln("\tgateway: {}", gateway);
             outln("\tclass: {}", class_name);
-            outln("\tRX: {} packets {} bytes ({})", packets_in, bytes_in, human_readable_size(bytes_in));
-            outln("\tTX: {} packets {} bytes ({})", packets_out, bytes_out, human_readable_size(bytes_out));
+            outln("\tRX: {} packets {} bytes ({}) {} dropped {} errors", packets_in, bytes_in, human_readable_size(bytes_in), packets_dropped, receive_errors);
+            outln("\tTX: {} packets {} bytes ({}) {} errors", packets_out, bytes_out, human_readable_size(bytes_out), send_errors);
             outln("\tMTU: {}", mtu);
             outln();
         });
@@ -15,6 +15,7 @@
 #include <LibCore/StandardPaths.h>
 #include <LibJS/AST.h>
 #include <LibJS/Bytecode/BasicBlock.h>
+#include <LibJS/Bytecode/ExecutableCache.h>
 #include <LibJS/Bytecode/Generator.h>
 #include <LibJS/Bytecode/Interpreter.h>
 #include <LibJS/Bytecode/PassManager.h>
@@ -90,6 +91,9 @@ static bool s_dump_ast = false;
 static bool s_dump_bytecode = false;
 static bool s_run_bytecode = false;
 static bool s_opt_bytecode = false;
+static bool s_jit_bytecode = false;
+static char const* s_bytecode_cache_path = nullptr;
+static bool s_parse_function_bodies_lazily = false;
 static bool s_print_last_result = false;
 static RefPtr<Line::Editor> s_editor;
 static String s_history_path = String::formatted("{}/.js-history", Core::StandardPaths::home_directory());
@@ -619,6 +623,7 @@ static bool write_to_file(String const& path)
 static bool parse_and_run(JS::Interpreter& interpreter, StringView const& source)
 {
     auto parser = JS::Parser(JS::Lexer(source));
+    parser.set_parse_function_bodies_lazily(s_parse_function_bodies_lazily);
     auto program = parser.parse_program();
 
     if (s_dump_ast)
@@ -632,12 +637,22 @@ static bool parse_and_run(JS::Interpreter& interpreter, StringView const& source
         vm->throw_exception<JS::SyntaxError>(interpreter.global_object(), error.to_string());
     } else {
         if (s_dump_bytecode || s_run_bytecode) {
-            auto unit = JS::Bytecode::Generator::generate(*program);
-            if (s_opt_bytecode) {
+            Optional<JS::Bytecode::ExecutableCache> cache;
+            Optional<JS::Bytecode::Executable> cached_unit;
+            if (s_bytecode_cache_path) {
+                cache = JS::Bytecode::ExecutableCache(s_bytecode_cache_path);
+                cached_unit = cache->load(source, *program, s_opt_bytecode);
+            }
+
+            bool is_cached = cached_unit.has_value();
+            auto unit = is_cached ? cached_unit.release_value() : JS::Bytecode::Generator::generate(*program);
+            if (!is_cached && s_opt_bytecode) {
                 auto& passes = JS::Bytecode::Interpreter::optimization_pipeline();
                 passes.perform(unit);
                 dbgln("Optimisation passes took {}us", passes.elapsed());
             }
+            if (cache.has_value() && !is_cached)
+                cache->store(source, *program, unit, s_opt_bytecode);
 
             if (s_dump_bytecode) {
                 for (auto& block : unit.basic_blocks)
@@ -907,6 +922,9 @@ int main(int argc, char** argv)
     args_parser.add_option(s_dump_bytecode, "Dump the bytecode", "dump-bytecode", 'd');
     args_parser.add_option(s_run_bytecode, "Run the bytecode", "run-bytecode", 'b');
     args_parser.add_option(s_opt_bytecode, "Optimize the bytecode", "optimize-bytecode", 'p');
+    args_parser.add_option(s_jit_bytecode, "Compile the bytecode to native code where supported", "jit", 'j');
+    args_parser.add_option(s_parse_function_bodies_lazily, "Parse function bodies when they're first called", "lazy-parse", 0);
+    args_parser.add_option(s_bytecode_cache_path, "Reuse bytecode generated for the same script from this directory", "bytecode-cache", 0, "path");
     args_parser.add_option(s_print_last_result, "Print last result", "print-last-result", 'l');
     args_parser.add_option(gc_on_every_allocation, "GC on every allocation", "gc-on-every-allocation", 'g');
     args_parser.add_option(disable_syntax_highlight, "Disable live syntax highlighting", "no-syntax-highlight", 's');
@@ -915,6 +933,8 @@ int main(int argc, char** argv)
 
     bool syntax_highlight = !disable_syntax_highlight;
 
+    JS::Bytecode::Interpreter::set_jit_enabled(s_jit_bytecode);
+
     vm = JS::VM::create();
     // NOTE: These will print out both warnings when using something like Promise.reject().catch(...) -
     // which is, as far as I can tell, correct - a promise is created, rejected without handler, and a
@@ -369,7 +369,7 @@ static int do_file_system_object_long(const char* path)
     if (flag_show_almost_all_dotfiles)
         flags = Core::DirIterator::SkipParentAndBaseDir;
 
-    Core::DirIterator di(path, flags);
+    Core::DirIterator di(path, static_cast<Core::DirIterator::Flags>(flags | Core::DirIterator::WithStat));
 
     if (di.has_error()) {
         if (di.error() == ENOTDIR) {
@@ -408,10 +408,12 @@ static int do_file_system_object_long(const char* path)
         builder.append(metadata.name);
         metadata.path = builder.to_string();
         VERIFY(!metadata.path.is_null());
-        int rc = lstat(metadata.path.characters(), &metadata.stat);
-        if (rc < 0) {
-            perror("lstat");
-            memset(&metadata.stat, 0, sizeof(metadata.stat));
+        metadata.stat = di.current_stat();
+        if (metadata.stat.st_mode == 0) {
+            if (lstat(metadata.path.characters(), &metadata.stat) < 0) {
+                perror("lstat");
+                memset(&metadata.stat, 0, sizeof(metadata.stat));
+            }
         }
         files.append(move(metadata));
     }
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/JsonObjectSerializer.h>
+#include <AK/MappedFile.h>
+#include <AK/StringBuilder.h>
+#include <LibCore/ArgsParser.h>
+#include <LibPerfcore/Reader.h>
+#include <stdio.h>
+#include <unistd.h>
+
+int main(int argc, char** argv)
+{
+    if (pledge("stdio rpath", nullptr) < 0) {
+        perror("pledge");
+        return 1;
+    }
+
+    const char* path = nullptr;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Convert a perfcore file to the JSON format older perfcore files are in.");
+    args_parser.add_positional_argument(path, "Path to perfcore file", "path");
+    args_parser.parse(argc, argv);
+
+    auto file_or_error = MappedFile::map(path);
+    if (file_or_error.is_error()) {
+        warnln("Failed to open {}: {}", path, file_or_error.error());
+        return 1;
+    }
+
+    if (pledge("stdio", nullptr) < 0) {
+        perror("pledge");
+        return 1;
+    }
+
+    out("{{\"events\":[");
+    bool is_first_event = true;
+    Perfcore::Reader reader(file_or_error.value()->bytes());
+    auto result = reader.for_each_event([&](Perfcore::Event const& event) {
+        StringBuilder builder;
+        if (!is_first_event)
+            builder.append(',');
+        is_first_event = false;
+
+        JsonObjectSerializer object(builder);
+        object.add("type", event.type);
+        if (event.type == "malloc"sv || event.type == "munmap"sv || event.type == "kmalloc"sv || event.type == "kfree"sv) {
+            object.add("ptr", static_cast<u64>(event.ptr));
+            object.add("size", static_cast<u64>(event.size));
+        } else if (event.type == "free"sv) {
+            object.add("ptr", static_cast<u64>(event.ptr));
+        } else if (event.type == "mmap"sv) {
+            object.add("ptr", static_cast<u64>(event.ptr));
+            object.add("size", static_cast<u64>(event.size));
+            object.add("name", event.name);
+        } else if (event.type == "process_create"sv) {
+            object.add("parent_pid", event.parent_pid);
+            object.add("executable", event.executable);
+        } else if (event.type == "process_exec"sv) {
+            object.add("executable", event.executable);
+        } else if (event.type == "thread_create"sv) {
+            object.add("parent_tid", event.parent_tid);
+        } else if (event.type == "context_switch"sv) {
+            object.add("next_pid", event.next_pid);
+            object.add("next_tid", event.next_tid);
+        } else if (event.type == "pmc_sample"sv) {
+            object.add("counter", event.counter);
+        }
+        object.add("pid", event.pid);
+        object.add("tid", event.tid);
+        object.add("timestamp", event.timestamp);
+        object.add("lost_samples", event.lost_samples);
+        auto stack_array = object.add_array("stack");
+        for (auto address : event.stack)
+            stack_array.add(static_cast<u64>(address));
+        stack_array.finish();
+        object.finish();
+
+        out("{}", builder.string_view());
+    });
+    outln("]}}");
+
+    if (result.is_error()) {
+        warnln("{}: {}", path, result.error());
+        return 1;
+    }
+    return 0;
+}
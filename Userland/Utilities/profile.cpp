@@ -46,6 +46,14 @@ int main(int argc, char** argv)
                 event_mask |= PERF_EVENT_KFREE;
             else if (event_type == "page_fault")
                 event_mask |= PERF_EVENT_PAGE_FAULT;
+            else if (event_type == "cycles")
+                event_mask |= PERF_EVENT_PMC_CYCLES;
+            else if (event_type == "cache_misses")
+                event_mask |= PERF_EVENT_PMC_CACHE_MISSES;
+            else if (event_type == "branch_misses")
+                event_mask |= PERF_EVENT_PMC_BRANCH_MISSES;
+            else if (event_type == "llc_loads")
+                event_mask |= PERF_EVENT_PMC_LLC_LOADS;
             else {
                 warnln("Unknown event type '{}' specified.", event_type);
                 exit(1);
@@ -56,6 +64,7 @@ int main(int argc, char** argv)
     auto print_types = [] {
         outln();
         outln("Event type can be one of: sample, context_switch, page_fault, kmalloc and kfree.");
+        outln("On CPUs with performance counters, there's also: cycles, cache_misses, branch_misses and llc_loads.");
     };
 
     if (!args_parser.parse(argc, argv, Core::ArgsParser::FailureBehavior::PrintUsage)) {
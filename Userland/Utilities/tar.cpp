@@ -13,6 +13,7 @@
 #include <LibCore/ArgsParser.h>
 #include <LibCore/DirIterator.h>
 #include <LibCore/FileStream.h>
+#include <LibThreading/ReadAheadStream.h>
 #include <fcntl.h>
 #include <stdio.h>
 #include <sys/stat.h>
@@ -60,9 +61,13 @@ int main(int argc, char** argv)
         Core::InputFileStream file_stream(file);
         Compress::GzipDecompressor gzip_stream(file_stream);
 
-        InputStream& file_input_stream = file_stream;
-        InputStream& gzip_input_stream = gzip_stream;
-        Archive::TarInputStream tar_stream((gzip) ? gzip_input_stream : file_input_stream);
+        // Decompress on another thread while this one writes out the files.
+        OwnPtr<Threading::ReadAheadStream> read_ahead_stream;
+        if (gzip)
+            read_ahead_stream = make<Threading::ReadAheadStream>(gzip_stream);
+
+        InputStream& input_stream = read_ahead_stream ? static_cast<InputStream&>(*read_ahead_stream) : file_stream;
+        Archive::TarInputStream tar_stream(input_stream);
         if (!tar_stream.valid()) {
             warnln("the provided file is not a well-formatted ustar file");
             return 1;
@@ -117,6 +122,7 @@ int main(int argc, char** argv)
                 }
             }
         }
+        read_ahead_stream = nullptr;
         file_stream.close();
         return 0;
     }
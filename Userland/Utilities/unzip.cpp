@@ -5,15 +5,35 @@
  */
 
 #include <AK/Assertions.h>
+#include <AK/Atomic.h>
 #include <AK/MappedFile.h>
 #include <AK/NumberFormat.h>
+#include <AK/ScopeGuard.h>
 #include <LibArchive/Zip.h>
 #include <LibCompress/Deflate.h>
 #include <LibCore/ArgsParser.h>
-#include <LibCore/File.h>
+#include <LibThreading/TaskGroup.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+static bool write_all(int fd, ReadonlyBytes bytes)
+{
+    while (!bytes.is_empty()) {
+        auto nwritten = write(fd, bytes.data(), bytes.size());
+        if (nwritten < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        bytes = bytes.slice(nwritten);
+    }
+    return true;
+}
+
+// Files are unpacked on the threads of the ThreadPool, so this sticks to plain file descriptors rather than Core::File.
 static bool unpack_zip_member(Archive::ZipMember zip_member, bool quiet)
 {
     if (zip_member.is_directory) {
@@ -25,11 +45,12 @@ static bool unpack_zip_member(Archive::ZipMember zip_member, bool quiet)
             outln(" extracting: {}", zip_member.name);
         return true;
     }
-    auto new_file = Core::File::construct(zip_member.name);
-    if (!new_file->open(Core::OpenMode::WriteOnly)) {
-        warnln("Can't write file {}: {}", zip_member.name, new_file->error_string());
+    int fd = open(zip_member.name.characters(), O_CREAT | O_WRONLY | O_TRUNC, 0666);
+    if (fd < 0) {
+        warnln("Can't write file {}: {}", zip_member.name, strerror(errno));
         return false;
     }
+    ScopeGuard close_fd = [&] { close(fd); };
 
     if (!quiet)
         outln(" extracting: {}", zip_member.name);
@@ -37,8 +58,8 @@ static bool unpack_zip_member(Archive::ZipMember zip_member, bool quiet)
     // TODO: verify CRC32s match!
     switch (zip_member.compression_method) {
     case Archive::ZipCompressionMethod::Store: {
-        if (!new_file->write(zip_member.compressed_data.data(), zip_member.compressed_data.size())) {
-            warnln("Can't write file contents in {}: {}", zip_member.name, new_file->error_string());
+        if (!write_all(fd, zip_member.compressed_data)) {
+            warnln("Can't write file contents in {}: {}", zip_member.name, strerror(errno));
             return false;
         }
         break;
@@ -53,8 +74,8 @@ static bool unpack_zip_member(Archive::ZipMember zip_member, bool quiet)
             warnln("Failed decompressing file {}", zip_member.name);
             return false;
         }
-        if (!new_file->write(decompressed_data.value().data(), decompressed_data.value().size())) {
-            warnln("Can't write file contents in {}: {}", zip_member.name, new_file->error_string());
+        if (!write_all(fd, decompressed_data.value())) {
+            warnln("Can't write file contents in {}: {}", zip_member.name, strerror(errno));
             return false;
         }
         break;
@@ -63,11 +84,6 @@ static bool unpack_zip_member(Archive::ZipMember zip_member, bool quiet)
         VERIFY_NOT_REACHED();
     }
 
-    if (!new_file->close()) {
-        warnln("Can't close file {}: {}", zip_member.name, new_file->error_string());
-        return false;
-    }
-
     return true;
 }
 
@@ -134,9 +150,23 @@ int main(int argc, char** argv)
         }
     }
 
+    // Directories are created up front and in order, so that the files can be unpacked in any order, and in parallel.
+    Vector<Archive::ZipMember> file_members;
     auto success = zip_file->for_each_member([&](auto zip_member) {
+        if (!zip_member.is_directory) {
+            file_members.append(zip_member);
+            return IterationDecision::Continue;
+        }
         return unpack_zip_member(zip_member, quiet) ? IterationDecision::Continue : IterationDecision::Break;
     });
+    if (!success)
+        return 1;
+
+    Atomic<bool> unpacked_all_files = true;
+    Threading::parallel_for(0, file_members.size(), [&](size_t i) {
+        if (!unpack_zip_member(file_members[i], quiet))
+            unpacked_all_files = false;
+    });
 
-    return success ? 0 : 1;
+    return unpacked_all_files ? 0 : 1;
 }
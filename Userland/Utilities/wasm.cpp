@@ -249,8 +249,17 @@ static Optional<Wasm::Module> parse(StringView const& filename)
         return {};
     }
 
-    auto stream = Core::InputFileStream(result.release_value());
-    auto parse_result = Wasm::Module::parse(stream);
+    // Feed the parser as the file is read, so that it can get to work on the function bodies that are already in.
+    auto file = result.release_value();
+    Wasm::StreamingModuleParser parser;
+    for (;;) {
+        auto buffer = file->read(64 * KiB);
+        if (buffer.is_empty())
+            break;
+        if (parser.append(buffer).has_value())
+            break;
+    }
+    auto parse_result = parser.finish();
     if (parse_result.is_error()) {
         warnln("Something went wrong, either the file is invalid, or there's a bug with LibWasm!");
         warnln("The parse error was {}", Wasm::parse_error_to_string(parse_result.error()));